@@ -0,0 +1,98 @@
+dnl -------------------------------------------------------- -*- autoconf -*-
+dnl Licensed to the Apache Software Foundation (ASF) under one or more
+dnl contributor license agreements.  See the NOTICE file distributed with
+dnl this work for additional information regarding copyright ownership.
+dnl The ASF licenses this file to You under the Apache License, Version 2.0
+dnl (the "License"); you may not use this file except in compliance with
+dnl the License.  You may obtain a copy of the License at
+dnl
+dnl     http://www.apache.org/licenses/LICENSE-2.0
+dnl
+dnl Unless required by applicable law or agreed to in writing, software
+dnl distributed under the License is distributed on an "AS IS" BASIS,
+dnl WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+dnl See the License for the specific language governing permissions and
+dnl limitations under the License.
+
+dnl
+dnl zstd.m4: Trafficserver's zstd autoconf macros
+dnl
+
+dnl
+dnl TS_CHECK_ZSTD: look for zstd libraries and headers
+dnl
+AC_DEFUN([TS_CHECK_ZSTD], [
+enable_zstd=no
+AC_ARG_WITH(zstd, [AC_HELP_STRING([--with-zstd=DIR],[use a specific zstd library])],
+[
+  if test "x$withval" != "xyes" && test "x$withval" != "x"; then
+    zstd_base_dir="$withval"
+    if test "$withval" != "no"; then
+      enable_zstd=yes
+      case "$withval" in
+      *":"*)
+        zstd_include="`echo $withval |sed -e 's/:.*$//'`"
+        zstd_ldflags="`echo $withval |sed -e 's/^.*://'`"
+        AC_MSG_CHECKING(checking for zstd includes in $zstd_include libs in $zstd_ldflags )
+        ;;
+      *)
+        zstd_include="$withval/include"
+        zstd_ldflags="$withval/lib"
+        AC_MSG_CHECKING(checking for zstd includes in $withval)
+        ;;
+      esac
+    fi
+  fi
+])
+
+if test "x$zstd_base_dir" = "x"; then
+  AC_MSG_CHECKING([for zstd location])
+  AC_CACHE_VAL(ats_cv_zstd_dir,[
+  for dir in /usr/local /usr ; do
+    if test -d $dir && test -f $dir/include/zstd.h; then
+      ats_cv_zstd_dir=$dir
+      break
+    fi
+  done
+  ])
+  zstd_base_dir=$ats_cv_zstd_dir
+  if test "x$zstd_base_dir" = "x"; then
+    enable_zstd=no
+    AC_MSG_RESULT([not found])
+  else
+    enable_zstd=yes
+    zstd_include="$zstd_base_dir/include"
+    zstd_ldflags="$zstd_base_dir/lib"
+    AC_MSG_RESULT([$zstd_base_dir])
+  fi
+else
+  if test -d $zstd_include && test -d $zstd_ldflags && test -f $zstd_include/zstd.h; then
+    AC_MSG_RESULT([ok])
+  else
+    AC_MSG_RESULT([not found])
+  fi
+fi
+
+if test "$enable_zstd" != "no"; then
+  saved_ldflags=$LDFLAGS
+  saved_cppflags=$CPPFLAGS
+  zstd_have_headers=0
+  zstd_have_libs=0
+  if test "$zstd_base_dir" != "/usr"; then
+    TS_ADDTO(CPPFLAGS, [-I${zstd_include}])
+    TS_ADDTO(LDFLAGS, [-L${zstd_ldflags}])
+    TS_ADDTO_RPATH(${zstd_ldflags})
+  fi
+  AC_CHECK_LIB([zstd], [ZSTD_compress], [zstd_have_libs=1])
+  if test "$zstd_have_libs" != "0"; then
+    AC_CHECK_HEADERS(zstd.h, [zstd_have_headers=1])
+  fi
+  if test "$zstd_have_headers" != "0"; then
+    AC_SUBST(LIBZSTD, [-lzstd])
+  else
+    enable_zstd=no
+    CPPFLAGS=$saved_cppflags
+    LDFLAGS=$saved_ldflags
+  fi
+fi
+])
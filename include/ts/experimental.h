@@ -47,7 +47,8 @@ typedef enum {
   TS_FETCH_FLAGS_STREAM               = 1 << 1, // enable stream IO
   TS_FETCH_FLAGS_DECHUNK              = 1 << 2, // dechunk body content
   TS_FETCH_FLAGS_NEWLOCK              = 1 << 3, // allocate new lock for fetch sm
-  TS_FETCH_FLAGS_NOT_INTERNAL_REQUEST = 1 << 4  // Allow this fetch to be created as a non-internal request.
+  TS_FETCH_FLAGS_NOT_INTERNAL_REQUEST = 1 << 4, // Allow this fetch to be created as a non-internal request.
+  TS_FETCH_FLAGS_SKIP_BODY            = 1 << 5  // drop the body as it arrives, eg. to only fill the cache
 } TSFetchFlags;
 
 /* Forward declaration of in_addr, any user of these APIs should probably
@@ -416,6 +417,26 @@ tsapi void TSFetchWriteData(TSFetchSM fetch_sm, const void *data, size_t len);
  */
 tsapi ssize_t TSFetchReadData(TSFetchSM fetch_sm, void *buf, size_t len);
 
+/*
+ * Get the reader of the response body, dechunked with TS_FETCH_FLAGS_DECHUNK,
+ * once the header is done. The body data is not copied, the fetch reads at most
+ * a buffer ahead of what is consumed with TSFetchRespConsume().
+ *
+ * @param fetch_sm: returned value of TSFetchCreate().
+ *
+ * return NULL if the response header is not done yet.
+ */
+tsapi TSIOBufferReader TSFetchRespReaderGet(TSFetchSM fetch_sm);
+
+/*
+ * Consume *nbytes* bytes of the reader from TSFetchRespReaderGet(), and let the
+ * fetch read more of the response.
+ *
+ * @param fetch_sm: returned value of TSFetchCreate().
+ * @param nbytes: number of bytes the plugin is done with.
+ */
+tsapi void TSFetchRespConsume(TSFetchSM fetch_sm, int64_t nbytes);
+
 /*
  * Launch FetchSM to do http request, before calling this API,
  * you should append http request header into fetch sm through
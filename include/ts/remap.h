@@ -32,7 +32,7 @@ extern "C" {
 #endif /* __cplusplus */
 
 #define TSREMAP_VMAJOR 3 /* major version number */
-#define TSREMAP_VMINOR 0 /* minor version number */
+#define TSREMAP_VMINOR 1 /* minor version number */
 #define TSREMAP_VERSION ((TSREMAP_VMAJOR << 16) | TSREMAP_VMINOR)
 
 typedef struct _tsremap_api_info {
@@ -57,6 +57,10 @@ typedef struct _tm_remap_request_info {
 
   /* 0 - don't redirect, 1 - use the (new)request URL as a redirect */
   int redirect;
+
+  /* The state of the instance for the calling event thread, created by TSRemapNewThreadInstance().
+     NULL if the plugin does not implement it, or remaps on another thread than an event thread. */
+  void *thread_ih;
 } TSRemapRequestInfo;
 
 /* This is the type returned by the TSRemapDoRemap() callback */
@@ -143,6 +147,17 @@ tsapi void TSRemapDone(void);
 tsapi TSReturnCode TSRemapNewInstance(int argc, char *argv[], void **ih, char *errbuf, int errbuf_size);
 tsapi void TSRemapDeleteInstance(void *);
 
+/* Plugin per thread instance. Create the state of the instance ih for the calling event thread.
+   It is called the first time the instance remaps on each event thread, and the state is passed
+   to TSRemapDoRemap() on that thread in rri->thread_ih, to be used without locks.
+   Optional function, TSRemapDeleteThreadInstance() is required with it.
+   Return: the state, NULL to be called again the next time.
+*/
+tsapi void *TSRemapNewThreadInstance(void *ih);
+
+/* Delete the state thread_ih of the instance ih, before TSRemapDeleteInstance() and on its thread. */
+tsapi void TSRemapDeleteThreadInstance(void *ih, void *thread_ih);
+
 /* Check response code from Origin Server
    os_response_type -> TSServerState
    Remap API plugin can use InkAPI function calls inside TSRemapDoRemap()
@@ -412,6 +412,22 @@ tsapi int TSUrlLengthGet(TSMBuffer bufp, TSMLoc offset);
  */
 tsapi char *TSUrlStringGet(TSMBuffer bufp, TSMLoc offset, int *length);
 
+/**
+    Returns the string representation of the URL located at offset
+    within bufp without copying it. The string is kept in the marshal
+    buffer and is valid until the URL or the buffer is modified or
+    destroyed. It must not be freed. A read only marshal buffer can only
+    return a string that was printed before, otherwise this returns NULL
+    and TSUrlStringGet() has to be used.
+
+    @param bufp marshal buffer containing the URL you want to get.
+    @param offset location of the URL within bufp.
+    @param length string length of the URL.
+    @return The URL as a string, or NULL.
+
+ */
+tsapi const char *TSUrlStringViewGet(TSMBuffer bufp, TSMLoc offset, int *length);
+
 /**
     Retrieves the scheme portion of the URL located at url_loc within
     the marshal buffer bufp. TSUrlSchemeGet() places the length of
@@ -927,6 +943,21 @@ tsapi TSMLoc TSMimeHdrFieldGet(TSMBuffer bufp, TSMLoc hdr, int idx);
  */
 tsapi TSMLoc TSMimeHdrFieldFind(TSMBuffer bufp, TSMLoc hdr, const char *name, int length);
 
+/**
+    Returns the well-known string of the header field name @a str, or
+    nullptr if it is not a well-known name. A field name that is the
+    well-known string is found by TSMimeHdrFieldFind() without comparing
+    strings, so a plugin should resolve the names it looks up often once.
+
+    @param str the field name.
+    @param length string length of @a str. If length is -1, then @a str
+      is assumed to be null-terminated.
+    @return the well-known string, in the same case as the field names
+      that Traffic Server uses.
+
+ */
+tsapi const char *TSMimeHdrStringToWKS(const char *str, int length);
+
 /**
     Returns the TSMLoc location of a specified MIME field from within
     the MIME header located at hdr. The retrieved_str parameter
@@ -1006,6 +1037,16 @@ tsapi TSReturnCode TSMimeHdrFieldValuesClear(TSMBuffer bufp, TSMLoc hdr, TSMLoc
 tsapi int TSMimeHdrFieldValuesCount(TSMBuffer bufp, TSMLoc hdr, TSMLoc field);
 
 tsapi const char *TSMimeHdrFieldValueStringGet(TSMBuffer bufp, TSMLoc hdr, TSMLoc field, int idx, int *value_len_ptr);
+/**
+    Looks up the values of @a count fields of the header @a hdr at
+    once, without allocating a field handle for each of them. The
+    values point into the marshal buffer and are valid until the header
+    is modified.
+
+    @return The number of fields found.
+
+ */
+tsapi int TSMimeHdrFieldsValueGet(TSMBuffer bufp, TSMLoc hdr, TSMimeFieldValueView *fields, int count);
 tsapi int TSMimeHdrFieldValueIntGet(TSMBuffer bufp, TSMLoc hdr, TSMLoc field, int idx);
 tsapi int64_t TSMimeHdrFieldValueInt64Get(TSMBuffer bufp, TSMLoc hdr, TSMLoc field, int idx);
 tsapi unsigned int TSMimeHdrFieldValueUintGet(TSMBuffer bufp, TSMLoc hdr, TSMLoc field, int idx);
@@ -2027,6 +2068,14 @@ tsapi void TSIOBufferProduce(TSIOBuffer bufp, int64_t nbytes);
 
 tsapi TSIOBufferBlock TSIOBufferBlockNext(TSIOBufferBlock blockp);
 tsapi const char *TSIOBufferBlockReadStart(TSIOBufferBlock blockp, TSIOBufferReader readerp, int64_t *avail);
+
+/**
+   Appends @a length bytes of @a blockp, from @a start, to @a bufp by reference. The bytes are not
+   copied, @a bufp shares the data of the block, so it can forward data read from another buffer.
+
+   @return the number of bytes appended, -1 if the range is not in the data of the block.
+ */
+tsapi int64_t TSIOBufferBlockAppend(TSIOBuffer bufp, TSIOBufferBlock blockp, const char *start, int64_t length);
 tsapi int64_t TSIOBufferBlockReadAvail(TSIOBufferBlock blockp, TSIOBufferReader readerp);
 tsapi char *TSIOBufferBlockWriteStart(TSIOBufferBlock blockp, int64_t *avail);
 tsapi int64_t TSIOBufferBlockWriteAvail(TSIOBufferBlock blockp);
@@ -2083,6 +2132,9 @@ tsapi void TSStatIntSet(int the_stat, TSMgmtInt value);
 
 tsapi TSReturnCode TSStatFindName(const char *name, int *idp);
 
+/* Append the stats in the Prometheus text format to bufp, without copying them. Returns the number of bytes. */
+tsapi int64_t TSStatPrometheusWrite(TSIOBuffer bufp);
+
 /* --------------------------------------------------------------------------
    tracing api */
 
@@ -2353,6 +2405,20 @@ tsapi const char *TSVConnSslProtocolGet(TSVConn sslp);
 */
 tsapi const char *TSVConnSslCurveGet(TSVConn sslp);
 
+/**
+   Return the JA3 fingerprint of the ClientHello of an SSL connection, as
+   computed by the core when proxy.config.ssl.server.ja3_fingerprint is set.
+   This is still owned by the core, and must not be free'd.
+
+   @param sslp the SSL connection
+   @param raw if not NULL, set to the JA3 string the fingerprint is the MD5 of,
+   which is not null terminated
+   @param raw_len if not NULL, set to the length of the JA3 string
+
+   @return the fingerprint as 32 hexadecimal digits, NULL if it was not computed
+*/
+tsapi const char *TSVConnSslJa3Get(TSVConn sslp, const char **raw, int *raw_len);
+
 /* NetVC timeout APIs. */
 tsapi void TSVConnInactivityTimeoutSet(TSVConn connp, TSHRTime timeout);
 tsapi void TSVConnInactivityTimeoutCancel(TSVConn connp);
@@ -2573,6 +2639,15 @@ tsapi TSIOBufferReader TSHttpTxnPostBufferReaderGet(TSHttpTxn txnp);
  */
 tsapi TSReturnCode TSHttpTxnServerPush(TSHttpTxn txnp, const char *url, int url_len);
 
+/**
+ * Allocate memory that lives as long as the transaction.
+ * The memory is released all at once when the transaction ends and must not be freed by the caller.
+ *
+ * @param size the number of bytes to allocate.
+ * @return the memory, aligned for any fundamental type.
+ */
+tsapi void *TSHttpTxnArenaAlloc(TSHttpTxn txnp, size_t size);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -108,6 +108,20 @@ public:
     ink_freelist_madvise_init(&this->fl, name, element_size, chunk_size, alignment, advice);
   }
 
+  /** Allocate the memory of this allocator from huge page arenas, see tscore/hugepages.h. */
+  void
+  use_hugepage_arena()
+  {
+    ink_freelist_use_hugepage_arena(fl);
+  }
+
+  /** Place the memory of this allocator on NUMA @a node, see tscore/numa.h. */
+  void
+  set_numa_node(int node)
+  {
+    fl->numa_node = node;
+  }
+
 protected:
   InkFreeList *fl;
 };
@@ -0,0 +1,174 @@
+/** @file
+
+    Bounded Chase-Lev work stealing deque.
+
+    @section license License
+
+    Licensed to the Apache Software Foundation (ASF) under one
+    or more contributor license agreements.  See the NOTICE file
+    distributed with this work for additional information
+    regarding copyright ownership.  The ASF licenses this file
+    to you under the Apache License, Version 2.0 (the
+    "License"); you may not use this file except in compliance
+    with the License.  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+    @section details Details
+
+    This is the deque from "Dynamic Circular Work-Stealing Deque" (Chase, Lev 2005) with the memory
+    orderings of "Correct and Efficient Work-Stealing for Weak Memory Models" (Lê et al. 2013). The
+    buffer does not grow, @c push fails instead when the deque is full and the caller is expected to
+    handle the item some other way.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+
+namespace ts
+{
+/** Single owner, multiple thief deque.
+
+    Only the owning thread may call @c push and @c pop, which work at the bottom of the deque.
+    Any thread, including the owner, may call @c steal which takes from the top. The owner can
+    therefore get FIFO order by taking its own items with @c steal.
+
+    @a T must be trivially copyable, in practice a pointer.
+ */
+template <typename T> class ChaseLevDeque
+{
+  static_assert(std::is_trivially_copyable<T>::value, "ChaseLevDeque items must be trivially copyable");
+
+public:
+  /// Construct a deque holding up to @a capacity items, rounded up to a power of 2.
+  explicit ChaseLevDeque(size_t capacity);
+  ChaseLevDeque(const ChaseLevDeque &) = delete;
+  ChaseLevDeque &operator=(const ChaseLevDeque &) = delete;
+
+  /// Add @a item at the bottom. Owner only.
+  /// @return @c false if the deque is full.
+  bool push(T item);
+
+  /// Take the item at the bottom into @a item. Owner only.
+  /// @return @c false if the deque is empty.
+  bool pop(T &item);
+
+  /// Take the item at the top into @a item. Any thread.
+  /// @return @c false if the deque is empty or another thread took the item first.
+  bool steal(T &item);
+
+  /// Approximate number of items, exact only when called by the owner with no thieves active.
+  size_t size() const;
+
+  bool empty() const;
+
+  size_t capacity() const;
+
+private:
+  alignas(64) std::atomic<int64_t> _top{0};
+  alignas(64) std::atomic<int64_t> _bottom{0};
+  alignas(64) int64_t _mask;
+  std::unique_ptr<std::atomic<T>[]> _buffer;
+};
+
+template <typename T> ChaseLevDeque<T>::ChaseLevDeque(size_t capacity)
+{
+  size_t n = 2;
+  while (n < capacity) {
+    n <<= 1;
+  }
+  _mask = n - 1;
+  _buffer.reset(new std::atomic<T>[n]);
+}
+
+template <typename T>
+bool
+ChaseLevDeque<T>::push(T item)
+{
+  int64_t b = _bottom.load(std::memory_order_relaxed);
+  int64_t t = _top.load(std::memory_order_acquire);
+  if (b - t > _mask) {
+    return false;
+  }
+  _buffer[b & _mask].store(item, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  _bottom.store(b + 1, std::memory_order_relaxed);
+  return true;
+}
+
+template <typename T>
+bool
+ChaseLevDeque<T>::pop(T &item)
+{
+  int64_t b = _bottom.load(std::memory_order_relaxed) - 1;
+  _bottom.store(b, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  int64_t t = _top.load(std::memory_order_relaxed);
+
+  bool found = false;
+  if (t <= b) {
+    item  = _buffer[b & _mask].load(std::memory_order_relaxed);
+    found = true;
+    if (t == b) {
+      // Last item, race the thieves for it.
+      found = _top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+      _bottom.store(b + 1, std::memory_order_relaxed);
+    }
+  } else {
+    _bottom.store(b + 1, std::memory_order_relaxed);
+  }
+  return found;
+}
+
+template <typename T>
+bool
+ChaseLevDeque<T>::steal(T &item)
+{
+  int64_t t = _top.load(std::memory_order_acquire);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  int64_t b = _bottom.load(std::memory_order_acquire);
+
+  if (t < b) {
+    T x = _buffer[t & _mask].load(std::memory_order_relaxed);
+    if (_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+      item = x;
+      return true;
+    }
+  }
+  return false;
+}
+
+template <typename T>
+size_t
+ChaseLevDeque<T>::size() const
+{
+  int64_t b = _bottom.load(std::memory_order_relaxed);
+  int64_t t = _top.load(std::memory_order_relaxed);
+  return b > t ? b - t : 0;
+}
+
+template <typename T>
+bool
+ChaseLevDeque<T>::empty() const
+{
+  return this->size() == 0;
+}
+
+template <typename T>
+size_t
+ChaseLevDeque<T>::capacity() const
+{
+  return _mask + 1;
+}
+
+} // namespace ts
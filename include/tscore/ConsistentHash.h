@@ -25,6 +25,7 @@
 #include <cstdint>
 #include <iostream>
 #include <map>
+#include <vector>
 
 /*
   Helper class to be extended to make ring nodes.
@@ -33,6 +34,8 @@
 struct ATSConsistentHashNode {
   bool available;
   char *name;
+  int32_t load;      // requests in flight to the node, see ATSConsistentHash::acquire()
+  float load_weight; // weight the node was inserted into its ring with
 };
 
 std::ostream &operator<<(std::ostream &os, ATSConsistentHashNode &thing);
@@ -53,10 +56,32 @@ struct ATSConsistentHash {
   ATSConsistentHashNode *lookup_available(const char *url = nullptr, ATSConsistentHashIter *i = nullptr, bool *w = nullptr,
                                           ATSHash64 *h = nullptr);
   ATSConsistentHashNode *lookup_by_hashval(uint64_t hashval, ATSConsistentHashIter *i = nullptr, bool *w = nullptr);
+
+  /*
+    Consistent hashing with bounded loads: like lookup_by_hashval() but the nodes with more than
+    (1 + epsilon) times their share of the requests in flight are passed over for the next one on
+    the ring. The load is what acquire() and release() count.
+   */
+  ATSConsistentHashNode *lookup_bounded(uint64_t hashval, float epsilon, ATSConsistentHashIter *i = nullptr, bool *w = nullptr);
+  bool overloaded(const ATSConsistentHashNode *node, float epsilon) const;
+  void acquire(ATSConsistentHashNode *node);
+  void release(ATSConsistentHashNode *node);
+
+  /*
+    Maglev hashing: fill a lookup table with the nodes inserted so far, each of them getting a share
+    of its slots by weight, after which lookup_bounded() picks the first node from the table in
+    constant time instead of searching the ring. The table is not changed when a node goes down, the
+    lookups after the first still walk the ring from the node picked.
+   */
+  void build_table();
+
   ~ATSConsistentHash();
 
 private:
   int replicas;
   ATSHash64 *hash;
   std::map<uint64_t, ATSConsistentHashNode *> NodeMap;
+  float total_weight = 0;
+  int64_t total_load = 0;
+  std::vector<ATSConsistentHashIter> table; ///< Maglev lookup table, of a prime size.
 };
@@ -149,22 +149,26 @@ CryptoContextBase::finalize(CryptoHash *hash)
 class CryptoContext : public CryptoContextBase
 {
 public:
-  CryptoContext();
-  /// Update the hash with @a data of @a length bytes.
-  bool update(void const *data, int length) override;
-  /// Finalize and extract the @a hash.
-  bool finalize(CryptoHash &hash) override;
-
   enum HashType {
     UNSPECIFIED,
 #if TS_ENABLE_FIPS == 0
     MD5,
     MMH,
+    MURMUR3,
 #endif
     SHA256,
   }; ///< What type of hash we really are.
   static HashType Setting;
 
+  /// A context of the @c Setting type.
+  CryptoContext();
+  /// A context of @a type, or of the @c Setting type if it is @c UNSPECIFIED.
+  explicit CryptoContext(HashType type);
+  /// Update the hash with @a data of @a length bytes.
+  bool update(void const *data, int length) override;
+  /// Finalize and extract the @a hash.
+  bool finalize(CryptoHash &hash) override;
+
   /// Size of storage for placement @c new of hashing context.
   static size_t const OBJ_SIZE = 256;
 
@@ -33,6 +33,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <cstdarg>
 #include "ink_mutex.h"
 #include "Regex.h"
@@ -53,6 +54,19 @@ enum DiagsTagType {
   DiagsTagType_Action = 1
 };
 
+/** The state of the debug tag of a @c Debug call site, cached by @c Diags::on.
+
+    The tag of a call site is checked once. The call site is then registered and its state is
+    recomputed when the debug tags change, so a check of a tag that is not enabled is a load even
+    while debugging is on.
+ */
+struct DiagsTagSite {
+  const char *tag = nullptr;
+  std::atomic<const Diags *> owner{nullptr}; ///< The @c Diags the state is for, if any.
+  std::atomic<bool> enabled{false};
+  bool registered = false;
+};
+
 struct DiagsModeOutput {
   bool to_stdout;
   bool to_stderr;
@@ -152,6 +166,21 @@ public:
     return this->on(mode) && tag_activated(tag, mode);
   }
 
+  /** Check whether the debug @a tag of a call site is enabled, with its state cached in @a site.
+
+      Only a @a constant tag, a literal that is the same at each call from the site, is cached. A
+      site that is called with several tags, as one in an inline function can be, is checked with
+      @c tag_activated for the tags it was not registered with.
+  */
+  bool
+  on(DiagsTagSite &site, const char *tag, bool constant) const
+  {
+    if (site.owner.load(std::memory_order_acquire) == this && site.tag == tag) {
+      return site.enabled.load(std::memory_order_relaxed);
+    }
+    return site_activated(site, tag, constant);
+  }
+
   /////////////////////////////////////
   // low-level tag inquiry functions //
   /////////////////////////////////////
@@ -250,6 +279,9 @@ private:
 
   bool rebind_std_stream(StdStream stream, int new_fd);
 
+  bool site_activated(DiagsTagSite &site, const char *tag, bool constant) const;
+  void refresh_tag_sites(bool release = false) const;
+
   void
   lock() const
   {
@@ -314,20 +346,29 @@ extern inkcoreapi Diags *diags;
 
 #if TS_USE_DIAGS
 
-#define Diag(tag, ...)                                 \
-  do {                                                 \
-    if (unlikely(diags->on())) {                       \
-      const SourceLocation loc = MakeSourceLocation(); \
-      diags->log(tag, DL_Diag, &loc, __VA_ARGS__);     \
-    }                                                  \
+// The state of the tag of this call site, a lambda gives each expansion its own.
+#define DiagsTagSiteOn(tag)                                \
+  diags->on(                                               \
+    []() -> DiagsTagSite & {                               \
+      static DiagsTagSite site;                            \
+      return site;                                         \
+    }(),                                                   \
+    tag, __builtin_constant_p(tag))
+
+#define Diag(tag, ...)                                   \
+  do {                                                   \
+    if (unlikely(diags->on()) && DiagsTagSiteOn(tag)) {  \
+      const SourceLocation loc = MakeSourceLocation();   \
+      diags->print(tag, DL_Diag, &loc, __VA_ARGS__);     \
+    }                                                    \
   } while (0)
 
-#define Debug(tag, ...)                                \
-  do {                                                 \
-    if (unlikely(diags->on())) {                       \
-      const SourceLocation loc = MakeSourceLocation(); \
-      diags->log(tag, DL_Debug, &loc, __VA_ARGS__);    \
-    }                                                  \
+#define Debug(tag, ...)                                  \
+  do {                                                   \
+    if (unlikely(diags->on()) && DiagsTagSiteOn(tag)) {  \
+      const SourceLocation loc = MakeSourceLocation();   \
+      diags->print(tag, DL_Debug, &loc, __VA_ARGS__);    \
+    }                                                    \
   } while (0)
 
 #define SpecificDebug(flag, tag, ...)                                                                       \
@@ -338,7 +379,7 @@ extern inkcoreapi Diags *diags;
     }                                                                                                       \
   } while (0)
 
-#define is_debug_tag_set(_t) unlikely(diags->on(_t, DiagsTagType_Debug))
+#define is_debug_tag_set(_t) unlikely(diags->on() && DiagsTagSiteOn(_t))
 #define is_action_tag_set(_t) unlikely(diags->on(_t, DiagsTagType_Action))
 #define debug_tag_assert(_t, _a) (is_debug_tag_set(_t) ? (ink_release_assert(_a), 0) : 0)
 #define action_tag_assert(_t, _a) (is_action_tag_set(_t) ? (ink_release_assert(_a), 0) : 0)
@@ -30,6 +30,7 @@
 
 #pragma once
 
+#include <cstdint>
 #include <vector>
 #include <string>
 #include <string_view>
@@ -104,12 +105,38 @@ struct HostBranch {
   std::string key;
 };
 
+// The read-only form of the tree of HostBranches that HostLookup::BuildIndex makes.  The nodes
+// are in breadth first order so the children of a node are next to each other, sorted by their
+// label, and a label is kept once no matter how many nodes have it.
+struct HostIndex {
+  struct Node {
+    uint32_t label{0};      ///< Offset of the label in @c labels.
+    uint32_t children{0};   ///< Index of the first child in @c nodes.
+    uint32_t n_children{0}; ///< 0 for a HOST_TERMINAL branch.
+    uint32_t leaves{0};     ///< Index of the first of its leaves in @c leaf_indices.
+    uint32_t n_leaves{0};
+    uint16_t label_len{0};
+    uint8_t type{HostBranch::HOST_TERMINAL}; ///< Of the HostBranch, the children are looked up the same way.
+  };
+
+  std::vector<Node> nodes; ///< The root first.
+  std::string labels;
+  std::vector<int> leaf_indices;
+
+  std::string_view
+  label(Node const &node) const
+  {
+    return {labels.data() + node.label, node.label_len};
+  }
+};
+
 //
 //  End Host Lookup Helper types
 //
 
 struct HostLookupState {
   HostBranch *cur{nullptr};
+  uint32_t node{0}; ///< Instead of @c cur once the index is built.
   int table_level{0};
   int array_index{0};
   std::string_view hostname;      ///< Original host name.
@@ -125,6 +152,8 @@ public:
   HostLookup(std::string_view name);
   void NewEntry(std::string_view match_data, bool domain_record, void *opaque_data_in);
   void AllocateSpace(int num_entries);
+  /// Replace the tree that NewEntry built with the compact index, after the last entry.
+  void BuildIndex();
   bool Match(std::string_view host);
   bool Match(std::string_view host, void **opaque_ptr);
   bool MatchFirst(std::string_view host, HostLookupState *s, void **opaque_ptr);
@@ -146,9 +175,13 @@ private:
   HostBranch *TableNewLevel(HostBranch *from, std::string_view level_data);
   HostBranch *InsertBranch(HostBranch *insert_in, std::string_view level_data);
   HostBranch *FindNextLevel(HostBranch *from, std::string_view level_data, bool bNotProcess = false);
-  bool MatchArray(HostLookupState *s, void **opaque_ptr, LeafIndices &array, bool host_done);
+  uint32_t FindChild(HostIndex::Node const &from, std::string_view level_data) const;
+  bool MatchArray(HostLookupState *s, void **opaque_ptr, const int *leaves, size_t n_leaves, bool host_done);
+  bool MatchNextIndexed(HostLookupState *s, void **opaque_ptr);
   void PrintHostBranch(HostBranch *hb, PrintFunc const &f);
+  void PrintIndexNode(uint32_t node, PrintFunc const &f);
   HostBranch root;          // The top of the search tree
+  HostIndex index;          // Replaces the tree once built
   LeafArray leaf_array;     // array of all leaves in tree
   std::string matcher_name; // Used for Debug/Warning/Error messages
 };
@@ -351,6 +351,20 @@ public:
   */
   self_type &clear();
 
+  /** Compile the map into sorted arrays for lookups.
+
+      @c contains then does a branch free binary search over the arrays of range ends, rather than
+      walking the tree one node at a time. Marking, unmarking, filling or clearing the map drops the
+      arrays, and @c contains goes back to the tree. The client data is copied into the arrays, so
+      set it with @c Node::setData before freezing.
+
+      @return This object.
+  */
+  self_type &freeze();
+
+  /// @return @c true if the map was frozen and not changed since.
+  bool is_frozen() const;
+
   /// Iterator for first element.
   iterator begin() const;
   /// Iterator past last element.
@@ -381,6 +395,12 @@ protected:
 
   ts::detail::Ip4Map *_m4 = nullptr; ///< Map of IPv4 addresses.
   ts::detail::Ip6Map *_m6 = nullptr; ///< Map of IPv6 addresses.
+
+  struct Frozen;              ///< Sorted arrays of the ranges, see @c freeze.
+  Frozen *_frozen = nullptr; ///< The ranges, if frozen.
+
+  /// Drop the sorted arrays, the map changed.
+  void thaw();
 };
 
 inline IpMap &
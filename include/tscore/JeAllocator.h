@@ -61,7 +61,8 @@ namespace jearena
 class JemallocNodumpAllocator
 {
 public:
-  explicit JemallocNodumpAllocator();
+  /// With @a numa_node the arena's memory is bound to that node, see tscore/numa.h.
+  explicit JemallocNodumpAllocator(int numa_node = -1);
 
   void *allocate(InkFreeList *f);
   void deallocate(InkFreeList *f, void *ptr);
@@ -73,11 +74,15 @@ private:
   static void *alloc(extent_hooks_t *extent, void *new_addr, size_t size, size_t alignment, bool *zero, bool *commit,
                      unsigned arena_ind);
 
+  /// Node plus one of each arena created here, indexed by arena, 0 for any.
+  static constexpr unsigned MAX_ARENAS = 4096;
+  static int8_t arena_node_[MAX_ARENAS];
+
   unsigned arena_index_{0};
   int flags_{0};
 #endif /* JEMALLOC_NODUMP_ALLOCATOR_SUPPORTED */
 
-  bool extend_and_setup_arena();
+  bool extend_and_setup_arena(int numa_node);
 };
 
 /**
@@ -85,4 +90,10 @@ private:
  */
 JemallocNodumpAllocator &globalJemallocNodumpAllocator();
 
+/**
+ * JemallocNodumpAllocator for memory on @a numa_node, one arena per node. This is the
+ * singleton above if NUMA local allocation is not enabled.
+ */
+JemallocNodumpAllocator &globalJemallocNodumpAllocator(int numa_node);
+
 } /* namespace jearena */
@@ -0,0 +1,53 @@
+/** @file
+
+  MurmurHash3, the 128 bit variant for 64 bit platforms, as a cache key hash.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#pragma once
+
+#include "tscore/ink_defs.h"
+#include "tscore/CryptoHash.h"
+
+/** MurmurHash3_x64_128 with a zero seed, fed incrementally.
+
+    The result is the same as hashing all the data at once, whatever the split between calls to
+    @c update. It is not a cryptographic hash, it is several times faster than MD5 and as good for
+    spreading cache keys, which is what it is for. Like MMH it depends on byte order, the value is
+    the one of the reference implementation on little endian machines.
+ */
+class MurmurHash3Context : public ats::CryptoContextBase
+{
+public:
+  MurmurHash3Context();
+  /// Update the hash with @a data of @a length bytes.
+  bool update(void const *data, int length) override;
+  /// Finalize and extract the @a hash.
+  bool finalize(CryptoHash &hash) override;
+
+protected:
+  void block(uint64_t k1, uint64_t k2);
+
+  uint64_t _h1     = 0;
+  uint64_t _h2     = 0;
+  uint64_t _length = 0; ///< Bytes hashed so far.
+  uint8_t _tail[16];    ///< Bytes short of a block.
+  int _tail_size = 0;
+};
@@ -90,6 +90,16 @@ public:
    */
   bool exec(std::string_view const &str, int *ovector, int ovecsize);
 
+  /** Execute the regular expression and get the name of the last @c (*MARK) on the matching path.
+   *
+   * @param str String to match against.
+   * @param mark Set to the name of the mark, @c nullptr if the match passed no mark.
+   * @return @c true if the patter matched, @a false if not.
+   *
+   * It is safe to call this method concurrently on the same instance of @a this.
+   */
+  bool exec(std::string_view const &str, const char *&mark);
+
   /// @return The number of groups captured in the last call to @c exec.
   int get_capture_count();
 
@@ -102,6 +112,12 @@ private:
  *
  * This contains a set of patterns (which may be of size 1) and matches if any of the patterns
  * match.
+ *
+ * Anchored patterns are also compiled together into one alternation, each alternative ending with a
+ * @c (*MARK) of its index, so that a match is a single pass over the string rather than one per
+ * pattern. As the alternatives are tried in order at the start of the string, the pattern found is
+ * the same. Patterns that do not combine safely, such as ones with groups, keep the set matching
+ * one pattern at a time.
  */
 class DFA
 {
@@ -125,9 +141,10 @@ public:
 
 private:
   struct Pattern {
-    Pattern(Regex &&rxp, std::string &&s) : _re(std::move(rxp)), _p(std::move(s)) {}
-    Regex _re;      ///< The compile pattern.
-    std::string _p; ///< The original pattern.
+    Pattern(Regex &&rxp, std::string &&s, unsigned flags) : _re(std::move(rxp)), _p(std::move(s)), _flags(flags) {}
+    Regex _re;       ///< The compile pattern.
+    std::string _p;  ///< The original pattern.
+    unsigned _flags; ///< The flags it was compiled with.
   };
 
   /** Compile @a pattern and add it to the pattern set.
@@ -138,5 +155,9 @@ private:
    */
   bool build(std::string_view const &pattern, unsigned flags = 0);
 
+  /// Compile the patterns into @a _combined, if they can be.
+  void combine();
+
   std::vector<Pattern> _patterns;
+  std::unique_ptr<Regex> _combined; ///< All the patterns, as one alternation.
 };
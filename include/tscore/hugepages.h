@@ -21,9 +21,36 @@
 #pragma once
 
 #include <cstring>
+#include <cstdint>
 
 size_t ats_hugepage_size();
 bool ats_hugepage_enabled();
 void ats_hugepage_init(int);
 void *ats_alloc_hugepage(size_t);
 bool ats_free_hugepage(void *, size_t);
+
+/* Huge page arenas are for a few large, long lived allocations, the cache directory and the
+   chunks of the big IO buffer freelists. They try explicit 1GB pages (mode 2 only, for sizes
+   that fill them well), then explicit 2MB pages, then 2MB aligned memory advised for
+   transparent huge pages, so they only fail when there is no memory at all. */
+
+enum HugePageArenaKind {
+  HUGEPAGE_ARENA_NONE, ///< Normal pages, transparent huge pages could not be advised
+  HUGEPAGE_ARENA_THP,  ///< Advised for transparent huge pages
+  HUGEPAGE_ARENA_2M,   ///< Explicit 2MB pages
+  HUGEPAGE_ARENA_1G,   ///< Explicit 1GB pages
+  HUGEPAGE_ARENA_KINDS
+};
+
+/// Granularity arena sizes are rounded up to.
+#define HUGEPAGE_ARENA_ALIGN (static_cast<size_t>(2) << 20)
+
+/// @a mode 0 disables the arenas, 1 uses 2MB pages and 2 adds 1GB pages.
+void ats_hugepage_arena_init(int mode);
+bool ats_hugepage_arena_enabled();
+/// Returns nullptr if the arenas are not enabled.
+void *ats_alloc_hugepage_arena(size_t size);
+/// Returns false if @a ptr did not come from @c ats_alloc_hugepage_arena.
+bool ats_free_hugepage_arena(void *ptr);
+/// Bytes currently allocated in arenas backed by @a kind.
+int64_t ats_hugepage_arena_bytes(HugePageArenaKind kind);
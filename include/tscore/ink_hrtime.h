@@ -36,6 +36,10 @@
 #include <cstdint>
 #include <sys/time.h>
 #include <cstdlib>
+#include <atomic>
+#if defined(__x86_64__)
+#define TS_HAS_TSC_CLOCK 1
+#endif
 typedef int64_t ink_hrtime;
 
 int squid_timestamp_to_buf(char *buf, unsigned int buf_size, long timestamp_sec, long timestamp_usec);
@@ -224,9 +228,61 @@ ink_hrtime_to_timeval(ink_hrtime t)
    which translates to (365 + 0.25)369*24*60*60 seconds   */
 #define NT_TIMEBASE_DIFFERENCE_100NSECS 116444736000000000i64
 
+/** A clock read from the invariant time stamp counter of the CPU, for hosts where @c clock_gettime
+    is a system call rather than a vDSO call. It is off until @c ink_hrtime_tsc_init turns it on,
+    and turns itself off again if the counter strays from @c CLOCK_MONOTONIC.
+
+    The counter is scaled to the monotonic clock at calibration. Reading the real time adds an offset
+    that is taken again from @c CLOCK_REALTIME every @c CHECK_INTERVAL, which is also when the rate
+    of the counter is compared with the monotonic clock.
+ */
+struct InkTscClock {
+  static constexpr int SHIFT                 = 32;
+  static constexpr ink_hrtime CHECK_INTERVAL = HRTIME_SECOND;
+  /// The largest drift from @c CLOCK_MONOTONIC, in millionths, before the clock turns itself off.
+  static constexpr ink_hrtime MAX_DRIFT_PPM  = 1000;
+
+  std::atomic<bool> enabled{false};
+  uint64_t base_tsc    = 0; ///< The counter at calibration.
+  ink_hrtime base_time = 0; ///< @c CLOCK_MONOTONIC at calibration.
+  uint64_t mult        = 0; ///< Nanoseconds per tick, shifted left by @c SHIFT.
+  std::atomic<ink_hrtime> realtime_offset{0};
+  std::atomic<ink_hrtime> next_check{0};
+  // Written only by the thread that moved @c next_check forward.
+  ink_hrtime last_tsc_time  = 0;
+  ink_hrtime last_mono_time = 0;
+};
+
+extern InkTscClock ink_tsc_clock;
+
+/** Calibrate and turn on the TSC clock.
+    @return @c false, with the clock left off, if the CPU has no invariant TSC or calibration fails.
+ */
+bool ink_hrtime_tsc_init();
+/// Compare the TSC clock with the system clocks, if it is time to, see @c InkTscClock.
+void ink_hrtime_tsc_check(ink_hrtime now);
+
+#if TS_HAS_TSC_CLOCK
+static inline ink_hrtime
+ink_get_hrtime_tsc()
+{
+  unsigned __int128 ns = static_cast<unsigned __int128>(__builtin_ia32_rdtsc() - ink_tsc_clock.base_tsc) * ink_tsc_clock.mult;
+  return ink_tsc_clock.base_time + static_cast<ink_hrtime>(ns >> InkTscClock::SHIFT);
+}
+#endif
+
 static inline ink_hrtime
 ink_get_hrtime_internal()
 {
+#if TS_HAS_TSC_CLOCK
+  if (ink_tsc_clock.enabled.load(std::memory_order_acquire)) {
+    ink_hrtime now = ink_get_hrtime_tsc();
+    if (now >= ink_tsc_clock.next_check.load(std::memory_order_relaxed)) {
+      ink_hrtime_tsc_check(now);
+    }
+    return now + ink_tsc_clock.realtime_offset.load(std::memory_order_relaxed);
+  }
+#endif
 #if defined(freebsd) || HAVE_CLOCK_GETTIME
   timespec ts;
   clock_gettime(CLOCK_REALTIME, &ts);
@@ -238,6 +294,26 @@ ink_get_hrtime_internal()
 #endif
 }
 
+/** The time since an unspecified point, which does not jump with changes to the system time.
+    Use this rather than @c ink_get_hrtime_internal to measure intervals.
+ */
+static inline ink_hrtime
+ink_get_hrtime_monotonic()
+{
+#if TS_HAS_TSC_CLOCK
+  if (ink_tsc_clock.enabled.load(std::memory_order_acquire)) {
+    return ink_get_hrtime_tsc();
+  }
+#endif
+#if HAVE_CLOCK_GETTIME
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ink_hrtime_from_timespec(&ts);
+#else
+  return ink_get_hrtime_internal();
+#endif
+}
+
 static inline struct timeval
 ink_gettimeofday()
 {
@@ -164,12 +164,25 @@ union head_p {
 #error "unsupported processor"
 #endif
 
+struct InkAtomicList {
+  InkAtomicList() {}
+  head_p head{};
+  const char *name = nullptr;
+  uint32_t offset  = 0;
+};
+
 struct _InkFreeList {
   head_p head;
   const char *name;
   uint32_t type_size, chunk_size, used, allocated, alignment;
   uint32_t allocated_base, used_base;
   int advice;
+  int numa_node;       // node to place new chunks on, -1 for any
+  bool hugepage_arena; // new chunks come from ats_alloc_hugepage_arena()
+  // Per thread magazines, see ink_freelist_init_magazines().
+  uint32_t mag_index;
+  uint64_t mag_hits, mag_misses;
+  InkAtomicList mag_full, mag_empty;
 };
 
 typedef struct ink_freelist_ops InkFreeListOps;
@@ -178,6 +191,11 @@ typedef struct _InkFreeList InkFreeList;
 const InkFreeListOps *ink_freelist_malloc_ops();
 const InkFreeListOps *ink_freelist_freelist_ops();
 void ink_freelist_init_ops(int nofl_class, int nofl_proxy);
+/*
+ * Put a per thread cache of @a size items in front of every freelist, 0 disables it.
+ * Must be called at startup, after ink_freelist_init_ops().
+ */
+void ink_freelist_init_magazines(uint32_t size);
 
 /*
  * alignment must be a power of 2
@@ -187,6 +205,11 @@ InkFreeList *ink_freelist_create(const char *name, uint32_t type_size, uint32_t
 inkcoreapi void ink_freelist_init(InkFreeList **fl, const char *name, uint32_t type_size, uint32_t chunk_size, uint32_t alignment);
 inkcoreapi void ink_freelist_madvise_init(InkFreeList **fl, const char *name, uint32_t type_size, uint32_t chunk_size,
                                           uint32_t alignment, int advice);
+/*
+ * Allocate the chunks of @a f from huge page arenas, see tscore/hugepages.h. The chunk size is
+ * rounded up to fill whole 2MB pages. Must be called before the first item is allocated.
+ */
+void ink_freelist_use_hugepage_arena(InkFreeList *f);
 inkcoreapi void *ink_freelist_new(InkFreeList *f);
 inkcoreapi void ink_freelist_free(InkFreeList *f, void *item);
 inkcoreapi void ink_freelist_free_bulk(InkFreeList *f, void *head, void *tail, size_t num_item);
@@ -194,13 +217,6 @@ void ink_freelists_dump(FILE *f);
 void ink_freelists_dump_baselinerel(FILE *f);
 void ink_freelists_snap_baseline();
 
-struct InkAtomicList {
-  InkAtomicList() {}
-  head_p head{};
-  const char *name = nullptr;
-  uint32_t offset  = 0;
-};
-
 #if !defined(INK_QUEUE_NT)
 #define INK_ATOMICLIST_EMPTY(_x) (!(TO_PTR(FREELIST_POINTER((_x.head)))))
 #else
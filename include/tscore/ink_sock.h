@@ -62,3 +62,16 @@ int read_socket(int s, char *buffer, int length);
 inkcoreapi uint32_t ink_inet_addr(const char *s);
 
 int bind_unix_domain_socket(const char *path, mode_t mode);
+
+/** Send the @a len bytes at @a data over the Unix domain socket @a s, with the @a nfds descriptors @a fds.
+
+    @return The number of bytes sent, or -1 with errno set.
+ */
+int send_fds(int s, const int *fds, int nfds, const void *data, size_t len);
+
+/** Receive up to @a len bytes into @a data from the Unix domain socket @a s, with up to @a *nfds
+    descriptors into @a fds. @a *nfds is set to the number of descriptors received.
+
+    @return The number of bytes received, 0 at the end of the stream, or -1 with errno set.
+ */
+int recv_fds(int s, int *fds, int *nfds, void *data, size_t len);
@@ -0,0 +1,82 @@
+/** @file
+
+  Allocation accounting by subsystem
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+#pragma once
+
+#include <cstdint>
+
+/* With jemalloc each memory domain gets an arena of its own. While a MemoryDomainScope is alive,
+   ats_malloc, ats_calloc and ats_realloc on that thread allocate from the arena of its domain,
+   so the live bytes of the domain are what jemalloc counts for the arena. ats_free needs no
+   domain. Memory a domain takes from the shared freelists is charged to it explicitly instead.
+   Without jemalloc, or when the domains are not enabled, only the charged bytes are counted. */
+
+enum MemoryDomain {
+  MEMORY_DOMAIN_UNTAGGED, ///< Everything not in a domain below
+  MEMORY_DOMAIN_HOSTDB,   ///< HostDB records
+  MEMORY_DOMAIN_HDR_HEAP, ///< Header heaps too large for the freelists
+  MEMORY_DOMAIN_SSL,      ///< OpenSSL, contexts and sessions
+  MEMORY_DOMAIN_PLUGIN,   ///< TSmalloc and friends
+  MEMORY_DOMAIN_FREELIST, ///< The freelists kept in jemalloc arenas, see JeAllocator.h
+  MEMORY_DOMAINS
+};
+
+/// The domain's name in its statistic, proxy.process.allocator.domain.<name>_bytes.
+const char *ats_memory_domain_name(MemoryDomain domain);
+
+/// Create the arenas if @a enable and jemalloc can, before any scope is entered.
+void ats_memory_domain_init(bool enable);
+bool ats_memory_domain_enabled();
+
+/// Count @a arena, created elsewhere, as part of @a domain.
+void ats_memory_domain_attach_arena(MemoryDomain domain, unsigned arena);
+
+/// Charge (or with negative @a bytes, credit) @a domain with memory taken from a shared freelist.
+void ats_memory_domain_charge(MemoryDomain domain, int64_t bytes);
+
+/// The bytes @a domain has allocated, as of jemalloc's statistics of at most a second ago.
+int64_t ats_memory_domain_live_bytes(MemoryDomain domain);
+
+/// The mallocx() flags of the domain the thread is in, 0 for none. For ats_malloc and friends.
+extern thread_local int ats_memory_domain_flags;
+
+int ats_memory_domain_enter(MemoryDomain domain);
+
+inline void
+ats_memory_domain_leave(int saved_flags)
+{
+  ats_memory_domain_flags = saved_flags;
+}
+
+/// Allocate from @a domain until the end of the scope. Scopes nest.
+class MemoryDomainScope
+{
+public:
+  explicit MemoryDomainScope(MemoryDomain domain) : _saved(ats_memory_domain_enter(domain)) {}
+  ~MemoryDomainScope() { ats_memory_domain_leave(_saved); }
+
+  MemoryDomainScope(const MemoryDomainScope &) = delete;
+  MemoryDomainScope &operator=(const MemoryDomainScope &) = delete;
+
+private:
+  int _saved;
+};
@@ -0,0 +1,50 @@
+/** @file
+
+  Process memory usage and the memory pressure level
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+/* The memory governor of traffic_server sets the level, the subsystems that have to hold back
+   under pressure read it. */
+
+enum MemoryPressure {
+  MEMORY_PRESSURE_NONE,
+  MEMORY_PRESSURE_SOFT, ///< Caches shrink
+  MEMORY_PRESSURE_HARD, ///< New connections and HTTP/2 streams are refused too
+};
+
+extern std::atomic<int> ats_memory_pressure;
+
+inline MemoryPressure
+ats_memory_pressure_level()
+{
+  return static_cast<MemoryPressure>(ats_memory_pressure.load(std::memory_order_relaxed));
+}
+
+/// The resident set size of the process in bytes, 0 if it is not known.
+int64_t ats_memory_rss();
+/// The memory limit of the cgroup of the process in bytes, 0 if it has none.
+int64_t ats_memory_cgroup_limit();
+/// Hand the free memory of the allocator back to the system.
+void ats_malloc_trim();
@@ -0,0 +1,54 @@
+/** @file
+
+  NUMA node helpers
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  @section details Details
+
+  Nodes are numbered by their hwloc logical index. Everything here is a no-op, and every node
+  lookup returns -1, unless NUMA local allocation was enabled with @c ats_numa_init on a build
+  with hwloc and a machine with more than one node.
+ */
+#pragma once
+
+#include <cstddef>
+
+/// Upper bound on the number of nodes per node data structures are sized for.
+#define TS_MAX_NUMA_NODES 8
+
+void ats_numa_init(int enabled);
+bool ats_numa_enabled();
+/// Number of nodes in use, 1 if NUMA local allocation is not enabled.
+int ats_numa_node_count();
+
+/// Node the calling thread has been bound to with @c ats_numa_set_thread_node, or -1.
+int ats_numa_thread_node();
+/// Record that the calling thread runs on @a node.
+void ats_numa_set_thread_node(int node);
+/// Node, or -1, whose CPUs are all of the CPUs the calling thread is bound to.
+int ats_numa_node_of_thread_binding();
+/// Bind the calling thread to the CPUs of @a node and record it.
+bool ats_numa_bind_thread(int node);
+
+/// Bind the pages of [@a addr, @a addr + @a len) to @a node. Must be done before they are touched.
+bool ats_numa_bind_area(void *addr, size_t len, int node);
+
+/// Node of the device behind @a fd, from sysfs, or -1 if unknown.
+int ats_numa_node_of_fd(int fd);
@@ -0,0 +1,199 @@
+/**
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+/**
+ * @file Coroutine.h
+ * @brief Awaitable asynchronous operations, for plugins written as C++20 coroutines.
+ *
+ * Each operation starts when it is constructed and completes on its own, so a coroutine can start
+ * several and then wait for all of them:
+ *
+ * \code
+ * atscppapi::coro::Task
+ * lookup(TSHttpTxn txn)
+ * {
+ *   atscppapi::coro::HostLookup a("a.example.com");
+ *   atscppapi::coro::HostLookup b("b.example.com");
+ *   sockaddr const *addr_a = co_await a;
+ *   sockaddr const *addr_b = co_await b;
+ *   ...
+ *   TSHttpTxnReenable(txn, TS_EVENT_HTTP_CONTINUE);
+ * }
+ * \endcode
+ *
+ * An operation that completes while it is started, such as a host lookup answered from HostDB,
+ * does not suspend the coroutine at all. Otherwise the coroutine is resumed on the event thread
+ * it was suspended on, directly from the callback when that runs on the same thread and with one
+ * event scheduled to that thread when it does not. The coroutine is resumed without the lock of
+ * any plugin continuation held.
+ *
+ * The operations build with C++17. The co_await support and @c Task need a compiler with
+ * coroutines, they are left out if the plugin is not built as C++20.
+ */
+
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <sys/socket.h>
+
+#include "ts/ts.h"
+#include "tscpp/api/noncopyable.h"
+
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+#include <coroutine>
+#include <exception>
+#include <type_traits>
+#define ATSCPPAPI_COROUTINES 1
+#endif
+
+namespace atscppapi
+{
+namespace coro
+{
+struct AwaitState;
+
+/**
+ * @brief The base of the awaitable operations.
+ *
+ * The operation is canceled if it is destroyed before it completes.
+ */
+class Awaitable : noncopyable
+{
+public:
+  /// @return true if the operation completed.
+  bool ready() const;
+
+  /**
+   * Arrange for @a resume to be called with @a address once the operation completes.
+   * @return false if the operation already completed, the caller should not wait.
+   */
+  bool suspend(void (*resume)(void *), void *address);
+
+  ~Awaitable();
+
+protected:
+  Awaitable();
+  AwaitState *state_;
+};
+
+/// Look up the address of a host name.
+class HostLookup : public Awaitable
+{
+public:
+  explicit HostLookup(std::string_view host);
+  /// @return The address found, nullptr if the lookup failed.
+  sockaddr const *result() const;
+};
+
+/// Open a cache object for reading.
+class CacheRead : public Awaitable
+{
+public:
+  explicit CacheRead(TSCacheKey key);
+  /// @return The cache VConnection to read the object from, nullptr if it is not in cache.
+  TSVConn result() const;
+};
+
+/// Fetch a URL through Traffic Server with TSFetchUrl().
+class FetchUrl : public Awaitable
+{
+public:
+  /**
+   * @param request the complete request, with its headers and body.
+   * @param client_addr the client address the request appears to come from.
+   */
+  FetchUrl(std::string_view request, sockaddr const *client_addr);
+  /// @return The complete response, empty if the fetch failed or timed out.
+  std::string_view result() const;
+};
+
+/// Wait for @a timeout milliseconds.
+class Sleep : public Awaitable
+{
+public:
+  explicit Sleep(TSHRTime timeout);
+  void
+  result() const
+  {
+  }
+};
+
+#if ATSCPPAPI_COROUTINES
+/**
+ * @brief The return type of a coroutine that is started by calling it and runs on its own.
+ *
+ * It is not awaitable, the coroutine cleans up after itself when it returns.
+ */
+struct Task {
+  struct promise_type {
+    Task
+    get_return_object()
+    {
+      return {};
+    }
+    std::suspend_never
+    initial_suspend() noexcept
+    {
+      return {};
+    }
+    std::suspend_never
+    final_suspend() noexcept
+    {
+      return {};
+    }
+    void
+    return_void()
+    {
+    }
+    void
+    unhandled_exception()
+    {
+      std::terminate();
+    }
+  };
+};
+
+template <typename Op, typename = std::enable_if_t<std::is_base_of_v<Awaitable, std::remove_reference_t<Op>>>>
+auto
+operator co_await(Op &&op)
+{
+  struct Awaiter {
+    std::remove_reference_t<Op> &op_;
+    bool
+    await_ready() const
+    {
+      return op_.ready();
+    }
+    bool
+    await_suspend(std::coroutine_handle<> handle)
+    {
+      return op_.suspend([](void *address) { std::coroutine_handle<>::from_address(address).resume(); }, handle.address());
+    }
+    decltype(auto)
+    await_resume()
+    {
+      return op_.result();
+    }
+  };
+  return Awaiter{op};
+}
+#endif
+
+} // namespace coro
+} // namespace atscppapi
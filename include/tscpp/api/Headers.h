@@ -24,6 +24,7 @@
 
 #include "tscpp/api/noncopyable.h"
 #include <string>
+#include <string_view>
 
 namespace atscppapi
 {
@@ -139,6 +140,12 @@ public:
    */
   std::string operator*();
 
+  /**
+   * Get the value pointed to by this iterator without copying it.
+   * @return a view into the header, valid until the header is modified.
+   */
+  std::string_view view() const;
+
   /**
    * Advance the iterator to the next header field value
    * @return a reference to a the next iterator
@@ -268,6 +275,19 @@ public:
    */
   HeaderFieldName name() const;
 
+  /**
+   * Get the name of this HeaderField without copying it.
+   * @return a view into the header, valid until the header is modified.
+   */
+  std::string_view nameView() const;
+
+  /**
+   * Get a value of this HeaderField without copying it.
+   * @param index the index of the comma separated value, -1 (the default) for the entire value.
+   * @return a view into the header, valid until the header is modified.
+   */
+  std::string_view valueView(const int index = -1) const;
+
   /**
    * Join all the values of this HeaderField into a single string separated by the join string.
    * @param an optional join string (defaults to ",")
@@ -537,6 +557,14 @@ public:
    */
   std::string value(const std::string &key, size_type index = 0);
 
+  /**
+   * Returns the entire value of the first header with given name without copying it, and without
+   * allocating an iterator.
+   * @param name of header
+   * @return a view into the header, valid until the header is modified. It is empty if there is no such header.
+   */
+  std::string_view valueView(std::string_view key);
+
   /**
    * Returns an iterator to the first HeaderField with the name key.
    * @param key the name of first header field ot find.
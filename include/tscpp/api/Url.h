@@ -22,6 +22,7 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <cstdint>
 #include "tscpp/api/noncopyable.h"
 
@@ -93,6 +94,35 @@ public:
    */
   uint16_t getPort() const;
 
+  /**
+   * The view accessors return the same strings as the std::string ones without copying them. The
+   * views point into the header buffer and are valid until the url is modified.
+   *
+   * @return The full url, or an empty view if the url is in a read only (cached) buffer which
+   * cannot keep a printed url, use getUrlString() for those.
+   */
+  std::string_view getUrlStringView() const;
+
+  /**
+   * @return A view of the path only portion of the url.
+   */
+  std::string_view getPathView() const;
+
+  /**
+   * @return A view of the query only portion of the url.
+   */
+  std::string_view getQueryView() const;
+
+  /**
+   * @return A view of the scheme of the url.
+   */
+  std::string_view getSchemeView() const;
+
+  /**
+   * @return A view of the host only of the url.
+   */
+  std::string_view getHostView() const;
+
   /**
    * Set the path of the url.
    * @param path the path portion of the url to set, this might be something like /foo/bar
@@ -26,10 +26,16 @@
  */
 
 #include <tscore/TSSystemState.h>
+#include "tscore/numa.h"
 
 #include "P_AIO.h"
 
-#if AIO_MODE == AIO_MODE_NATIVE
+#include <atomic>
+#if AIO_MODE == AIO_MODE_IO_URING
+#include <vector>
+#endif
+
+#if AIO_MODE == AIO_MODE_NATIVE || AIO_MODE == AIO_MODE_IO_URING
 #define AIO_PERIOD -HRTIME_MSECONDS(10)
 #else
 
@@ -48,7 +54,22 @@ int num_filedes = 1;
 static ink_mutex insert_mutex;
 
 int thread_is_created = 0;
-#endif // AIO_MODE == AIO_MODE_NATIVE
+#endif // AIO_MODE == AIO_MODE_NATIVE || AIO_MODE == AIO_MODE_IO_URING
+
+#if AIO_MODE == AIO_MODE_IO_URING
+RecInt aio_io_uring_entries = 1024;
+
+// The fixed buffer table shared by all the rings. Each DiskHandler copies it and registers the copy
+// with its own ring when the generation changes.
+static ink_mutex fixed_buffer_mutex;
+static std::vector<iovec> fixed_buffer_table;
+static std::atomic<unsigned> fixed_buffer_table_generation{0};
+
+// The file descriptors whose IO goes on the polled rings, set as the cache opens its spans.
+#define AIO_MAX_POLLED_FD 4096
+static std::atomic<bool> polled_fds[AIO_MAX_POLLED_FD];
+#endif
+
 RecInt cache_config_threads_per_disk = 12;
 RecInt api_config_threads_per_disk   = 12;
 
@@ -60,6 +81,11 @@ uint64_t aio_bytes_read    = 0;
 uint64_t aio_num_write     = 0;
 uint64_t aio_bytes_written = 0;
 
+#if AIO_MODE == AIO_MODE_NATIVE || AIO_MODE == AIO_MODE_IO_URING
+// The operations submitted to the kernel by all the threads and not reaped yet.
+static std::atomic<int> aio_in_flight{0};
+#endif
+
 /*
  * Stats
  */
@@ -158,13 +184,18 @@ ink_aio_init(ts::ModuleVersion v)
                      (int)AIO_STAT_KB_READ_PER_SEC, aio_stats_cb);
   RecRegisterRawStat(aio_rsb, RECT_PROCESS, "proxy.process.cache.KB_write_per_sec", RECD_FLOAT, RECP_PERSISTENT,
                      (int)AIO_STAT_KB_WRITE_PER_SEC, aio_stats_cb);
-#if AIO_MODE != AIO_MODE_NATIVE
+#if AIO_MODE == AIO_MODE_THREAD
   memset(&aio_reqs, 0, MAX_DISKS_POSSIBLE * sizeof(AIO_Reqs *));
   ink_mutex_init(&insert_mutex);
+#elif AIO_MODE == AIO_MODE_IO_URING
+  ink_mutex_init(&fixed_buffer_mutex);
+  REC_ReadConfigInteger(aio_io_uring_entries, "proxy.config.aio.io_uring.entries");
 #endif
   REC_ReadConfigInteger(cache_config_threads_per_disk, "proxy.config.cache.threads_per_disk");
 #if TS_USE_LINUX_NATIVE_AIO
   Warning("Running with Linux AIO, there are known issues with this feature");
+#elif TS_USE_LINUX_IO_URING
+  Note("Running with Linux io_uring, ring entries = %" PRId64, aio_io_uring_entries);
 #endif
 }
 
@@ -178,7 +209,23 @@ ink_aio_start()
   return 0;
 }
 
-#if AIO_MODE != AIO_MODE_NATIVE
+int
+ink_aio_queue_depth()
+{
+#if AIO_MODE == AIO_MODE_THREAD
+  int depth = 0;
+  for (int i = 0; i < num_filedes; ++i) {
+    if (aio_reqs[i]) {
+      depth += aio_reqs[i]->requests_queued;
+    }
+  }
+  return depth;
+#else
+  return aio_in_flight.load(std::memory_order_relaxed);
+#endif
+}
+
+#if AIO_MODE == AIO_MODE_THREAD
 
 static void *aio_thread_main(void *arg);
 
@@ -191,15 +238,18 @@ struct AIOThreadInfo : public Continuation {
   {
     (void)event;
     (void)e;
+    // Run next to the disk if it is known which node that is, otherwise spread out.
+    if (!ats_numa_bind_thread(req->filedes >= 0 ? ats_numa_node_of_fd(req->filedes) : -1)) {
 #if TS_USE_HWLOC
 #if HWLOC_API_VERSION >= 0x20000
-    hwloc_set_membind(ink_get_topology(), hwloc_topology_get_topology_nodeset(ink_get_topology()), HWLOC_MEMBIND_INTERLEAVE,
-                      HWLOC_MEMBIND_THREAD | HWLOC_MEMBIND_BYNODESET);
+      hwloc_set_membind(ink_get_topology(), hwloc_topology_get_topology_nodeset(ink_get_topology()), HWLOC_MEMBIND_INTERLEAVE,
+                        HWLOC_MEMBIND_THREAD | HWLOC_MEMBIND_BYNODESET);
 #else
-    hwloc_set_membind_nodeset(ink_get_topology(), hwloc_topology_get_topology_nodeset(ink_get_topology()), HWLOC_MEMBIND_INTERLEAVE,
-                              HWLOC_MEMBIND_THREAD);
+      hwloc_set_membind_nodeset(ink_get_topology(), hwloc_topology_get_topology_nodeset(ink_get_topology()),
+                                HWLOC_MEMBIND_INTERLEAVE, HWLOC_MEMBIND_THREAD);
 #endif
 #endif
+    }
     aio_thread_main(this);
     delete this;
     return EVENT_DONE;
@@ -491,7 +541,7 @@ aio_thread_main(void *arg)
   }
   return nullptr;
 }
-#else
+#elif AIO_MODE == AIO_MODE_NATIVE
 int
 DiskHandler::startAIOEvent(int /* event ATS_UNUSED */, Event *e)
 {
@@ -513,6 +563,9 @@ Lagain:
     ink_assert(op->action.continuation);
     complete_list.enqueue(op);
   }
+  if (ret > 0) {
+    aio_in_flight.fetch_sub(ret, std::memory_order_relaxed);
+  }
 
   if (ret == MAX_AIO_EVENTS) {
     goto Lagain;
@@ -539,6 +592,9 @@ Lagain:
       ret = io_submit(ctx, num, cbs);
     } while (ret < 0 && ret == -EAGAIN);
 
+    if (ret > 0) {
+      aio_in_flight.fetch_add(ret, std::memory_order_relaxed);
+    }
     if (ret != num) {
       if (ret < 0) {
         Debug("aio", "io_submit failed: %s (%d)", strerror(-ret), -ret);
@@ -557,6 +613,10 @@ Lagain:
       op->handleEvent(EVENT_NONE, nullptr);
     }
   }
+  // A polled ring does not signal the event fd, come straight back to poll it again.
+  if (poll_in_flight > 0 && submit_event == nullptr) {
+    submit_event = trigger_event->ethread->schedule_imm_local(this);
+  }
   return EVENT_CONT;
 }
 
@@ -647,4 +707,324 @@ ink_aio_writev(AIOCallback *op, int /* fromAPI ATS_UNUSED */)
   }
   return 1;
 }
-#endif // AIO_MODE != AIO_MODE_NATIVE
+#else // AIO_MODE == AIO_MODE_IO_URING
+
+void
+ink_aio_register_fixed_buffer(void *buf, size_t len)
+{
+  ink_scoped_mutex_lock lock(fixed_buffer_mutex);
+  fixed_buffer_table.push_back(iovec{buf, len});
+  fixed_buffer_table_generation++;
+}
+
+void
+ink_aio_unregister_fixed_buffer(void *buf)
+{
+  ink_scoped_mutex_lock lock(fixed_buffer_mutex);
+  for (auto spot = fixed_buffer_table.begin(); spot != fixed_buffer_table.end(); ++spot) {
+    if (spot->iov_base == buf) {
+      fixed_buffer_table.erase(spot);
+      fixed_buffer_table_generation++;
+      break;
+    }
+  }
+}
+
+void
+ink_aio_set_polled(int fd)
+{
+  if (fd < 0 || fd >= AIO_MAX_POLLED_FD) {
+    Warning("unable to poll the IO of file descriptor %d, only those below %d can be", fd, AIO_MAX_POLLED_FD);
+    return;
+  }
+  polled_fds[fd].store(true, std::memory_order_release);
+}
+
+int
+DiskHandler::fixed_buffer_index(const ink_aiocb *a) const
+{
+  const char *buf = static_cast<const char *>(a->aio_buf);
+  for (unsigned i = 0; i < fixed_buffers.size(); ++i) {
+    const char *base = static_cast<const char *>(fixed_buffers[i].iov_base);
+    if (buf >= base && buf + a->aio_nbytes <= base + fixed_buffers[i].iov_len) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+DiskHandler::DiskHandler()
+{
+  SET_HANDLER(&DiskHandler::startAIOEvent);
+  int ret = io_uring_queue_init(aio_io_uring_entries, &ring, 0);
+  if (ret < 0) {
+    Fatal("io_uring_queue_init(%" PRId64 ") failed: %s (%d)", aio_io_uring_entries, strerror(-ret), -ret);
+  }
+  ring_ok = true;
+}
+
+DiskHandler::~DiskHandler()
+{
+  if (ring_ok) {
+    io_uring_queue_exit(&ring);
+  }
+  if (poll_ring_ok) {
+    io_uring_queue_exit(&poll_ring);
+  }
+}
+
+struct io_uring *
+DiskHandler::ring_for(const ink_aiocb *a)
+{
+  int fd = a->aio_fildes;
+  if (poll_ring_bad || fd < 0 || fd >= AIO_MAX_POLLED_FD || !polled_fds[fd].load(std::memory_order_acquire)) {
+    return &ring;
+  }
+  if (!poll_ring_ok) {
+    int ret = io_uring_queue_init(aio_io_uring_entries, &poll_ring, IORING_SETUP_IOPOLL);
+    if (ret < 0) {
+      Warning("io_uring_queue_init(%" PRId64 ", IORING_SETUP_IOPOLL) failed, not polling: %s (%d)", aio_io_uring_entries,
+              strerror(-ret), -ret);
+      poll_ring_bad = true;
+      return &ring;
+    }
+    poll_ring_ok = true;
+  }
+  return &poll_ring;
+}
+
+int
+DiskHandler::startAIOEvent(int /* event ATS_UNUSED */, Event *e)
+{
+  SET_HANDLER(&DiskHandler::mainAIOEvent);
+#if HAVE_EVENTFD
+  // Wake the owning thread out of its poll as soon as completions arrive.
+  int ret = io_uring_register_eventfd(&ring, e->ethread->evfd);
+  if (ret < 0) {
+    Debug("aio", "io_uring_register_eventfd failed: %s (%d)", strerror(-ret), -ret);
+  }
+#endif
+  e->schedule_every(AIO_PERIOD);
+  trigger_event = e;
+  return mainAIOEvent(EVENT_INTERVAL, e);
+}
+
+void
+DiskHandler::queue(AIOCallback *op)
+{
+  ink_assert(op->action.continuation);
+  ready_list.enqueue(op);
+  // Everything queued before this event runs is submitted together.
+  if (submit_event == nullptr && trigger_event != nullptr) {
+    submit_event = this_ethread()->schedule_imm_local(this);
+  }
+}
+
+void
+DiskHandler::update_fixed_buffers()
+{
+  unsigned generation = fixed_buffer_table_generation.load(std::memory_order_acquire);
+  if (generation == fixed_buffer_generation) {
+    return;
+  }
+  // The old table may reference memory that has been freed, stop issuing fixed IO against it at
+  // once, but the kernel table can only be replaced when nothing in flight refers to it.
+  fixed_buffers.clear();
+  if (in_flight > 0) {
+    return;
+  }
+  io_uring_unregister_buffers(&ring);
+  {
+    ink_scoped_mutex_lock lock(fixed_buffer_mutex);
+    fixed_buffers = fixed_buffer_table;
+    generation    = fixed_buffer_table_generation.load(std::memory_order_relaxed);
+  }
+  if (!fixed_buffers.empty()) {
+    int ret = io_uring_register_buffers(&ring, fixed_buffers.data(), fixed_buffers.size());
+    if (ret < 0) {
+      Debug("aio", "io_uring_register_buffers(%zu) failed: %s (%d)", fixed_buffers.size(), strerror(-ret), -ret);
+      fixed_buffers.clear();
+    }
+  }
+  fixed_buffer_generation = generation;
+}
+
+void
+DiskHandler::reap(struct io_uring *r, int &flight)
+{
+  struct io_uring_cqe *cqes[MAX_AIO_EVENTS];
+  unsigned count;
+
+  if (flight == 0) {
+    return;
+  }
+  if (r->flags & IORING_SETUP_IOPOLL) {
+    // Nothing completes on a polled ring until it is polled, which peeking one entry does.
+    struct io_uring_cqe *cqe;
+    io_uring_peek_cqe(r, &cqe);
+  }
+  do {
+    count = io_uring_peek_batch_cqe(r, cqes, MAX_AIO_EVENTS);
+    for (unsigned i = 0; i < count; ++i) {
+      AIOCallback *op = static_cast<AIOCallback *>(io_uring_cqe_get_data(cqes[i]));
+      if (cqes[i]->res == -EOPNOTSUPP && r == &poll_ring) {
+        // The device has no poll queues, do this and the rest of its IO the usual way.
+        if (polled_fds[op->aiocb.aio_fildes].exchange(false)) {
+          Warning("unable to poll the IO of file descriptor %d, the device does not support it", op->aiocb.aio_fildes);
+        }
+        ready_list.enqueue(op);
+        continue;
+      }
+      op->aio_result = cqes[i]->res;
+      complete_list.enqueue(op);
+    }
+    io_uring_cq_advance(r, count);
+    flight -= count;
+    aio_in_flight.fetch_sub(count, std::memory_order_relaxed);
+  } while (count == MAX_AIO_EVENTS);
+}
+
+static void
+submit_ring(struct io_uring *r, int num, int &flight)
+{
+  if (num > 0) {
+    // Prepared entries that fail to go in now stay in the submission ring and go with the next submit.
+    flight += num;
+    aio_in_flight.fetch_add(num, std::memory_order_relaxed);
+    int ret;
+    do {
+      ret = io_uring_submit(r);
+    } while (ret == -EINTR);
+
+    if (ret < 0) {
+      Debug("aio", "io_uring_submit failed: %s (%d)", strerror(-ret), -ret);
+    }
+  }
+}
+
+void
+DiskHandler::submit()
+{
+  AIOCallback *op;
+  int num      = 0;
+  int poll_num = 0;
+
+  update_fixed_buffers();
+
+  while ((op = ready_list.dequeue()) != nullptr) {
+    ink_aiocb *a             = &op->aiocb;
+    struct io_uring *r       = ring_for(a);
+    struct io_uring_sqe *sqe = io_uring_get_sqe(r);
+    if (sqe == nullptr) {
+      // The submission ring is full, the rest waits for the next period.
+      ready_list.push(op);
+      break;
+    }
+    // The polled ring has no buffers registered.
+    int index = r == &ring ? fixed_buffer_index(a) : -1;
+    if (a->aio_lio_opcode == LIO_READ) {
+      if (index >= 0) {
+        io_uring_prep_read_fixed(sqe, a->aio_fildes, a->aio_buf, a->aio_nbytes, a->aio_offset, index);
+      } else {
+        io_uring_prep_read(sqe, a->aio_fildes, a->aio_buf, a->aio_nbytes, a->aio_offset);
+      }
+      aio_num_read++;
+      aio_bytes_read += a->aio_nbytes;
+    } else {
+      if (index >= 0) {
+        io_uring_prep_write_fixed(sqe, a->aio_fildes, a->aio_buf, a->aio_nbytes, a->aio_offset, index);
+      } else {
+        io_uring_prep_write(sqe, a->aio_fildes, a->aio_buf, a->aio_nbytes, a->aio_offset);
+      }
+      aio_num_write++;
+      aio_bytes_written += a->aio_nbytes;
+    }
+    io_uring_sqe_set_data(sqe, op);
+    if (r == &ring) {
+      ++num;
+    } else {
+      ++poll_num;
+    }
+  }
+
+  submit_ring(&ring, num, in_flight);
+  submit_ring(&poll_ring, poll_num, poll_in_flight);
+}
+
+int
+DiskHandler::mainAIOEvent(int /* event ATS_UNUSED */, Event *e)
+{
+  AIOCallback *op = nullptr;
+
+  if (e == submit_event) {
+    submit_event = nullptr;
+  }
+
+  reap(&ring, in_flight);
+  reap(&poll_ring, poll_in_flight);
+  submit();
+
+  while ((op = complete_list.dequeue()) != nullptr) {
+    op->mutex = op->action.mutex;
+    MUTEX_TRY_LOCK(lock, op->mutex, trigger_event->ethread);
+    if (!lock.is_locked()) {
+      trigger_event->ethread->schedule_imm(op);
+    } else {
+      op->handleEvent(EVENT_NONE, nullptr);
+    }
+  }
+  return EVENT_CONT;
+}
+
+int
+ink_aio_read(AIOCallback *op, int /* fromAPI ATS_UNUSED */)
+{
+  op->aiocb.aio_lio_opcode = LIO_READ;
+  this_ethread()->diskHandler->queue(op);
+  return 1;
+}
+
+int
+ink_aio_write(AIOCallback *op, int /* fromAPI ATS_UNUSED */)
+{
+  op->aiocb.aio_lio_opcode = LIO_WRITE;
+  this_ethread()->diskHandler->queue(op);
+  return 1;
+}
+
+static int
+aio_queue_vec(AIOCallback *op, int opcode)
+{
+  DiskHandler *dh = this_ethread()->diskHandler;
+  AIOCallback *io = op;
+  int sz          = 0;
+
+  while (io) {
+    io->aiocb.aio_lio_opcode = opcode;
+    dh->queue(io);
+    ++sz;
+    io = io->then;
+  }
+
+  if (sz > 1) {
+    AIOVec *vec = new AIOVec(sz, op);
+    while (--sz >= 0) {
+      op->action = vec;
+      op         = op->then;
+    }
+  }
+  return 1;
+}
+
+int
+ink_aio_readv(AIOCallback *op, int /* fromAPI ATS_UNUSED */)
+{
+  return aio_queue_vec(op, LIO_READ);
+}
+
+int
+ink_aio_writev(AIOCallback *op, int /* fromAPI ATS_UNUSED */)
+{
+  return aio_queue_vec(op, LIO_WRITE);
+}
+#endif // AIO_MODE == AIO_MODE_IO_URING
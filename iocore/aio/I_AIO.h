@@ -40,9 +40,12 @@ static constexpr ts::ModuleVersion AIO_MODULE_PUBLIC_VERSION(1, 0, ts::ModuleVer
 
 #define AIO_MODE_THREAD 0
 #define AIO_MODE_NATIVE 1
+#define AIO_MODE_IO_URING 2
 
 #if TS_USE_LINUX_NATIVE_AIO
 #define AIO_MODE AIO_MODE_NATIVE
+#elif TS_USE_LINUX_IO_URING
+#define AIO_MODE AIO_MODE_IO_URING
 #else
 #define AIO_MODE AIO_MODE_THREAD
 #endif
@@ -66,6 +69,13 @@ typedef struct io_event ink_io_event_t;
 
 #else
 
+#if AIO_MODE == AIO_MODE_IO_URING
+#include <liburing.h>
+#include <vector>
+
+#define MAX_AIO_EVENTS 1024
+#endif
+
 struct ink_aiocb {
   int aio_fildes    = 0;
   void *aio_buf     = nullptr; /* buffer location */
@@ -77,7 +87,9 @@ struct ink_aiocb {
   int aio__pad[1];        /* extension padding */
 };
 
+#if AIO_MODE == AIO_MODE_THREAD
 bool ink_aio_thread_num_set(int thread_num);
+#endif
 
 #endif
 
@@ -98,7 +110,7 @@ struct AIOCallback : public Continuation {
   AIOCallback() {}
 };
 
-#if AIO_MODE == AIO_MODE_NATIVE
+#if AIO_MODE == AIO_MODE_NATIVE || AIO_MODE == AIO_MODE_IO_URING
 
 struct AIOVec : public Continuation {
   Action action;
@@ -115,6 +127,10 @@ struct AIOVec : public Continuation {
   int mainEvent(int event, Event *e);
 };
 
+#endif
+
+#if AIO_MODE == AIO_MODE_NATIVE
+
 struct DiskHandler : public Continuation {
   Event *trigger_event;
   io_context_t ctx;
@@ -133,11 +149,70 @@ struct DiskHandler : public Continuation {
     }
   }
 };
+#elif AIO_MODE == AIO_MODE_IO_URING
+
+/** Per EThread io_uring submission and completion rings.
+
+    Operations queued by @c ink_aio_read / @c ink_aio_write on a thread collect in @a ready_list and
+    are pushed to the kernel with a single @c io_uring_submit at the next @c mainAIOEvent, which is
+    scheduled immediately when the first operation of a batch is queued. Completions are reaped in
+    batches and the ring signals the owning thread's event fd so the event loop wakes up for them.
+ */
+struct DiskHandler : public Continuation {
+  Event *trigger_event = nullptr;
+  Event *submit_event  = nullptr; ///< Pending immediate submission event, if any.
+  struct io_uring ring;
+  bool ring_ok = false;
+  /// Buffers registered with @a ring, indexed by fixed buffer index.
+  std::vector<iovec> fixed_buffers;
+  /// Generation of the fixed buffer table registered with @a ring, 0 if none.
+  unsigned fixed_buffer_generation = 0;
+  int in_flight                    = 0;
+  /// The polled ring, set up for the first operation on a polled file descriptor.
+  struct io_uring poll_ring;
+  bool poll_ring_ok  = false;
+  bool poll_ring_bad = false; ///< The polled ring could not be set up, use @a ring.
+  int poll_in_flight = 0;
+  Que(AIOCallback, link) ready_list;
+  Que(AIOCallback, link) complete_list;
+  int startAIOEvent(int event, Event *e);
+  int mainAIOEvent(int event, Event *e);
+  void queue(AIOCallback *op);
+  DiskHandler();
+  ~DiskHandler() override;
+
+private:
+  void reap(struct io_uring *r, int &count);
+  struct io_uring *ring_for(const ink_aiocb *a);
+  void submit();
+  void update_fixed_buffers();
+  int fixed_buffer_index(const ink_aiocb *a) const;
+};
+
+/** Register a buffer to be used as an io_uring fixed buffer.
+
+    Reads and writes which lie entirely in a registered buffer are issued as fixed buffer
+    operations, saving the kernel from mapping the user pages on every IO. The cache registers
+    its aggregation buffers. Registration failures (e.g. @c RLIMIT_MEMLOCK) are not fatal, the IO
+    simply falls back to the normal path.
+ */
+void ink_aio_register_fixed_buffer(void *buf, size_t len);
+void ink_aio_unregister_fixed_buffer(void *buf);
+
+/** Issue the IO on @a fd, opened with @c O_DIRECT, on polled rings.
+
+    Each DiskHandler then also sets up a ring with @c IORING_SETUP_IOPOLL, on which the kernel
+    polls the device for the completions rather than taking an interrupt for each. The thread
+    reaps that ring on every pass of its event loop while it has IO in flight there.
+ */
+void ink_aio_set_polled(int fd);
 #endif
 
 void ink_aio_init(ts::ModuleVersion version);
 int ink_aio_start();
 void ink_aio_set_callback(Continuation *error_callback);
+/// The operations queued to the disks and not completed yet, over all the disks.
+int ink_aio_queue_depth();
 
 int ink_aio_read(AIOCallback *op,
                  int fromAPI = 0); // fromAPI is a boolean to indicate if this is from a API call such as upload proxy feature
@@ -46,7 +46,7 @@ AIOCallback::ok()
 
 extern Continuation *aio_err_callbck;
 
-#if AIO_MODE == AIO_MODE_NATIVE
+#if AIO_MODE == AIO_MODE_NATIVE || AIO_MODE == AIO_MODE_IO_URING
 
 struct AIOCallbackInternal : public AIOCallback {
   int io_complete(int event, void *data);
@@ -74,7 +74,7 @@ AIOVec::mainEvent(int /* event */, Event *)
   return EVENT_ERROR;
 }
 
-#else /* AIO_MODE != AIO_MODE_NATIVE */
+#else /* AIO_MODE == AIO_MODE_THREAD */
 
 struct AIO_Reqs;
 
@@ -102,7 +102,7 @@ struct AIO_Reqs {
   int requests_queued = 0;
 };
 
-#endif // AIO_MODE == AIO_MODE_NATIVE
+#endif // AIO_MODE == AIO_MODE_NATIVE || AIO_MODE == AIO_MODE_IO_URING
 
 TS_INLINE int
 AIOCallbackInternal::io_complete(int event, void *data)
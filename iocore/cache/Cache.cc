@@ -36,6 +36,7 @@
 #include "InkAPIInternal.h"
 
 #include "tscore/hugepages.h"
+#include "tscore/numa.h"
 
 #include <atomic>
 
@@ -62,9 +63,20 @@ int64_t cache_config_ram_cache_size            = AUTO_SIZE_RAM_CACHE;
 int cache_config_ram_cache_algorithm           = 1;
 int cache_config_ram_cache_compress            = 0;
 int cache_config_ram_cache_compress_percent    = 90;
+int cache_config_ram_cache_compress_threads    = 1;
 int cache_config_ram_cache_use_seen_filter     = 1;
+int cache_config_ram_cache_warm_start          = 0;
+int cache_config_ram_cache_warm_start_rate     = 100;
+int cache_config_tier_promote_hits             = 2;
+int cache_config_tier_demote                   = 1;
 int cache_config_http_max_alts                 = 3;
 int cache_config_dir_sync_frequency            = 60;
+int cache_config_dir_tag_index                 = 0;
+int cache_config_dir_bloom_filter              = 0;
+int64_t cache_config_dir_load_chunk_size       = 8 * 1024 * 1024;
+int cache_config_dir_load_parallel             = 4;
+int cache_config_dir_load_early_serve          = 0;
+int cache_config_key_hash                      = CACHE_KEY_HASH_DEFAULT;
 int cache_config_permit_pinning                = 0;
 int cache_config_select_alternate              = 1;
 int cache_config_max_doc_size                  = 0;
@@ -73,15 +85,20 @@ int64_t cache_config_ram_cache_cutoff          = AGG_SIZE;
 int cache_config_max_disk_errors               = 5;
 int cache_config_hit_evacuate_percent          = 10;
 int cache_config_hit_evacuate_size_limit       = 0;
+int cache_config_hit_evacuate_reads            = 0;
+int64_t cache_config_evacuate_readahead        = 0;
+int64_t cache_config_read_ahead                = 0;
 int cache_config_force_sector_size             = 0;
 int cache_config_target_fragment_size          = DEFAULT_TARGET_FRAGMENT_SIZE;
 int cache_config_agg_write_backlog             = AGG_SIZE * 2;
+int cache_config_agg_write_max_in_flight       = 1;
 int cache_config_enable_checksum               = 0;
 int cache_config_alt_rewrite_max_size          = 4096;
 int cache_config_read_while_writer             = 0;
 int cache_config_mutex_retry_delay             = 2;
 int cache_read_while_writer_retry_delay        = 50;
 int cache_config_read_while_writer_max_retries = 10;
+int cache_config_read_while_writer_push        = 0;
 
 // Globals
 
@@ -116,6 +133,19 @@ struct VolInitInfo {
   AIOCallbackInternal vol_aio[4];
   char *vol_h_f;
 
+  // Directory load, see Vol::read_dir. The directory is read in chunks, several at a time, and
+  // checked a segment at a time as soon as everything up to the end of the segment is in.
+  AIOCallbackInternal *dir_aio = nullptr;
+  int dir_aio_count            = 0;
+  int dir_in_flight            = 0;
+  bool dir_failed              = false;
+  off_t dir_base               = 0; ///< Disk offset of the directory copy being read.
+  size_t dir_chunk             = 0;
+  size_t dir_next              = 0; ///< Next directory byte to ask for.
+  size_t dir_prefix            = 0; ///< Everything before this has been read.
+  uint8_t *dir_chunk_done      = nullptr;
+  int dir_segments_checked     = 0;
+
   VolInitInfo()
   {
     recover_pos = 0;
@@ -129,11 +159,37 @@ struct VolInitInfo {
       i.action = nullptr;
       i.mutex.clear();
     }
+    for (int i = 0; i < dir_aio_count; ++i) {
+      dir_aio[i].action = nullptr;
+      dir_aio[i].mutex.clear();
+    }
+    delete[] dir_aio;
+    ats_free(dir_chunk_done);
     free(vol_h_f);
   }
 };
 
-#if AIO_MODE == AIO_MODE_NATIVE
+// Makes a volume available before its directory is loaded, see Vol::dir_load_register.
+struct VolEarlyServe : public Continuation {
+  Vol *vol;
+
+  int
+  mainEvent(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
+  {
+    if (!vol->cache->cache_read_done) {
+      eventProcessor.schedule_in(this, HRTIME_MSECONDS(5), ET_CALL);
+      return EVENT_CONT;
+    }
+    vol->dir_load_register();
+    mutex.clear();
+    delete this;
+    return EVENT_DONE;
+  }
+
+  explicit VolEarlyServe(Vol *v) : Continuation(v->mutex), vol(v) { SET_HANDLER(&VolEarlyServe::mainEvent); }
+};
+
+#if AIO_MODE == AIO_MODE_NATIVE || AIO_MODE == AIO_MODE_IO_URING
 struct VolInit : public Continuation {
   Vol *vol;
   char *path;
@@ -186,7 +242,7 @@ void cplist_init();
 static void cplist_update();
 int cplist_reconfigure();
 static int create_volume(int volume_number, off_t size_in_blocks, int scheme, CacheVol *cp);
-static void rebuild_host_table(Cache *cache);
+static void rebuild_host_table(Cache *cache, CacheDisk *disk);
 void register_cache_stats(RecRawStatBlock *rsb, const char *prefix);
 
 // Global list of the volumes created
@@ -220,6 +276,21 @@ cache_bytes_used(int volume)
   return used;
 }
 
+void
+ram_cache_set_limit_percent(int percent)
+{
+  EThread *t = this_ethread();
+  for (int i = 0; i < gnvol; i++) {
+    Vol *d = gvol[i];
+    if (d->ram_cache == nullptr) {
+      continue;
+    }
+    MUTEX_TAKE_LOCK(d->mutex, t);
+    d->ram_cache->shrink(percent);
+    MUTEX_UNTAKE_LOCK(d->mutex, t);
+  }
+}
+
 int
 cache_stats_bytes_used_cb(const char *name, RecDataT data_type, RecData *data, RecRawStatBlock *rsb, int id)
 {
@@ -456,6 +527,10 @@ CacheVC::set_http_info(CacheHTTPInfo *ainfo)
   } else {
     f.allow_empty_doc = 0;
   }
+  // Header updates rewrite an object that is already in, only new ones are filtered.
+  if (!f.update && !cache_write_admit(this, field ? field->value_get_int64() : -1)) {
+    f.not_admitted = 1;
+  }
 
   alternate.copy_shallow(ainfo);
   ainfo->clear();
@@ -574,13 +649,10 @@ CacheProcessor::start_internal(int flags)
   ink_assert((int)TS_EVENT_CACHE_SCAN_OPERATION_FAILED == (int)CACHE_EVENT_SCAN_OPERATION_FAILED);
   ink_assert((int)TS_EVENT_CACHE_SCAN_DONE == (int)CACHE_EVENT_SCAN_DONE);
 
-#if AIO_MODE == AIO_MODE_NATIVE
-  int etype            = ET_NET;
-  int n_netthreads     = eventProcessor.n_threads_for_type[etype];
-  EThread **netthreads = eventProcessor.eventthread[etype];
-  for (int i = 0; i < n_netthreads; ++i) {
-    netthreads[i]->diskHandler = new DiskHandler();
-    netthreads[i]->schedule_imm(netthreads[i]->diskHandler);
+#if AIO_MODE == AIO_MODE_NATIVE || AIO_MODE == AIO_MODE_IO_URING
+  for (EThread *et : eventProcessor.active_group_threads(ET_NET)) {
+    et->diskHandler = new DiskHandler();
+    et->schedule_imm(et->diskHandler);
   }
 #endif
 
@@ -664,6 +736,18 @@ CacheProcessor::start_internal(int flags)
         if (sd->hash_base_string) {
           gdisks[gndisks]->hash_base_string = ats_strdup(sd->hash_base_string);
         }
+        if (sd->polled_io) {
+#if AIO_MODE == AIO_MODE_IO_URING
+          // Polling needs the block device underneath, not the page cache.
+          if (fcntl(fd, F_GETFL) & O_DIRECT) {
+            ink_aio_set_polled(fd);
+          } else {
+            Warning("cache unable to poll '%s': It is not opened for direct I/O.", path);
+          }
+#else
+          Warning("cache unable to poll '%s': Polled I/O needs the io_uring disk I/O.", path);
+#endif
+        }
 
         if (sector_size < cache_config_force_sector_size) {
           sector_size = cache_config_force_sector_size;
@@ -679,7 +763,7 @@ CacheProcessor::start_internal(int flags)
 
         off_t skip = ROUND_TO_STORE_BLOCK((sd->offset < START_POS ? START_POS + sd->alignment : sd->offset));
         blocks     = blocks - (skip >> STORE_BLOCK_SHIFT);
-#if AIO_MODE == AIO_MODE_NATIVE
+#if AIO_MODE == AIO_MODE_NATIVE || AIO_MODE == AIO_MODE_IO_URING
         eventProcessor.schedule_imm(new DiskInit(gdisks[gndisks], path, blocks, skip, sector_size, fd, clear));
 #else
         gdisks[gndisks]->open(path, blocks, skip, sector_size, fd, clear);
@@ -872,13 +956,17 @@ CacheProcessor::cacheInitialized()
     }
   }
 
-  // Update stripe version data.
-  if (gnvol) { // start with whatever the first stripe is.
-    cacheProcessor.min_stripe_version = cacheProcessor.max_stripe_version = gvol[0]->header->version;
-  }
-  // scan the rest of the stripes.
-  for (i = 1; i < gnvol; i++) {
+  // Update stripe version data, from the stripes that have their directory.
+  bool have_version = false;
+  for (i = 0; i < gnvol; i++) {
     Vol *v = gvol[i];
+    if (!v->dir_ready) {
+      continue;
+    }
+    if (!have_version) { // start with whatever the first stripe is.
+      cacheProcessor.min_stripe_version = cacheProcessor.max_stripe_version = v->header->version;
+      have_version                                                          = true;
+    }
     if (v->header->version < cacheProcessor.min_stripe_version) {
       cacheProcessor.min_stripe_version = v->header->version;
     }
@@ -887,6 +975,33 @@ CacheProcessor::cacheInitialized()
     }
   }
 
+  // Keep the key hash the objects were stored under, so they can still be found. A different
+  // configured hash takes over once the stripes holding objects are cleared.
+  bool have_key_hash = false;
+  for (i = 0; i < gnvol; i++) {
+    Vol *v = gvol[i];
+    if (!v->dir_ready || v->dir_used_at_load == 0) {
+      continue;
+    }
+    CacheKeyHash key_hash = static_cast<CacheKeyHash>(v->header->key_hash);
+    if (!have_key_hash) {
+      cacheProcessor.key_hash = key_hash;
+      have_key_hash           = true;
+    } else if (key_hash != cacheProcessor.key_hash) {
+      Warning("cache volume '%s' has key hash %d, the other volumes %d, its objects will not be found", v->hash_text.get(),
+              key_hash, cacheProcessor.key_hash);
+    }
+  }
+  if (have_key_hash && cacheProcessor.key_hash != cache_config_key_hash) {
+    Note("cache holds objects under key hash %d, keeping it instead of proxy.config.cache.key_hash = %d until the cache is cleared",
+         cacheProcessor.key_hash, cache_config_key_hash);
+  }
+  for (i = 0; i < gnvol; i++) {
+    if (gvol[i]->dir_ready) {
+      gvol[i]->header->key_hash = cacheProcessor.key_hash;
+    }
+  }
+
   if (caches_ready) {
     Debug("cache_init", "CacheProcessor::cacheInitialized - caches_ready=0x%0X, gnvol=%d", (unsigned int)caches_ready,
           gnvol.load());
@@ -904,6 +1019,9 @@ CacheProcessor::cacheInitialized()
         case RAM_CACHE_ALGORITHM_LRU:
           gvol[i]->ram_cache = new_RamCacheLRU();
           break;
+        case RAM_CACHE_ALGORITHM_WTINYLFU:
+          gvol[i]->ram_cache = new_RamCacheWTinyLFU();
+          break;
         }
       }
       // let us calculate the Size
@@ -930,9 +1048,12 @@ CacheProcessor::cacheInitialized()
           total_direntries += vol_total_direntries;
           CACHE_VOL_SUM_DYN_STAT(cache_direntries_total_stat, vol_total_direntries);
 
-          vol_used_direntries = dir_entries_used(gvol[i]);
-          CACHE_VOL_SUM_DYN_STAT(cache_direntries_used_stat, vol_used_direntries);
-          used_direntries += vol_used_direntries;
+          // With early serving each volume adds its own when its directory is ready.
+          if (!cache_config_dir_load_early_serve) {
+            vol_used_direntries = gvol[i]->dir_used_at_load;
+            CACHE_VOL_SUM_DYN_STAT(cache_direntries_used_stat, vol_used_direntries);
+            used_direntries += vol_used_direntries;
+          }
         }
 
       } else {
@@ -979,9 +1100,12 @@ CacheProcessor::cacheInitialized()
           total_direntries += vol_total_direntries;
           CACHE_VOL_SUM_DYN_STAT(cache_direntries_total_stat, vol_total_direntries);
 
-          vol_used_direntries = dir_entries_used(gvol[i]);
-          CACHE_VOL_SUM_DYN_STAT(cache_direntries_used_stat, vol_used_direntries);
-          used_direntries += vol_used_direntries;
+          // With early serving each volume adds its own when its directory is ready.
+          if (!cache_config_dir_load_early_serve) {
+            vol_used_direntries = gvol[i]->dir_used_at_load;
+            CACHE_VOL_SUM_DYN_STAT(cache_direntries_used_stat, vol_used_direntries);
+            used_direntries += vol_used_direntries;
+          }
         }
       }
       switch (cache_config_ram_cache_compress) {
@@ -998,6 +1122,16 @@ CacheProcessor::cacheInitialized()
       case CACHE_COMPRESSION_LIBLZMA:
 #ifndef HAVE_LZMA_H
         Fatal("lzma not available for RAM cache compression");
+#endif
+        break;
+      case CACHE_COMPRESSION_ZSTD:
+#ifndef HAVE_ZSTD_H
+        Fatal("zstd not available for RAM cache compression");
+#endif
+        break;
+      case CACHE_COMPRESSION_LZ4:
+#ifndef HAVE_LZ4_H
+        Fatal("lz4 not available for RAM cache compression");
 #endif
         break;
       }
@@ -1005,7 +1139,9 @@ CacheProcessor::cacheInitialized()
       GLOBAL_CACHE_SET_DYN_STAT(cache_ram_cache_bytes_total_stat, ram_cache_bytes);
       GLOBAL_CACHE_SET_DYN_STAT(cache_bytes_total_stat, total_cache_bytes);
       GLOBAL_CACHE_SET_DYN_STAT(cache_direntries_total_stat, total_direntries);
-      GLOBAL_CACHE_SET_DYN_STAT(cache_direntries_used_stat, used_direntries);
+      if (!cache_config_dir_load_early_serve) {
+        GLOBAL_CACHE_SET_DYN_STAT(cache_direntries_used_stat, used_direntries);
+      }
       if (!check) {
         dir_sync_init();
       }
@@ -1019,6 +1155,9 @@ CacheProcessor::cacheInitialized()
     CacheProcessor::initialized = CACHE_INITIALIZED;
     CacheProcessor::cache_ready = caches_ready;
     Note("cache enabled");
+    if (cache_config_ram_cache_warm_start) {
+      ram_cache_warm_start();
+    }
   } else {
     CacheProcessor::initialized = CACHE_INIT_FAILED;
     Note("cache disabled");
@@ -1044,7 +1183,9 @@ int
 CacheProcessor::dir_check(bool afix)
 {
   for (int i = 0; i < gnvol; i++) {
-    gvol[i]->dir_check(afix);
+    if (gvol[i]->dir_ready) {
+      gvol[i]->dir_check(afix);
+    }
   }
   return 0;
 }
@@ -1053,7 +1194,9 @@ int
 CacheProcessor::db_check(bool afix)
 {
   for (int i = 0; i < gnvol; i++) {
-    gvol[i]->db_check(afix);
+    if (gvol[i]->dir_ready) {
+      gvol[i]->db_check(afix);
+    }
   }
   return 0;
 }
@@ -1175,10 +1318,12 @@ vol_clear_init(Vol *d)
 {
   size_t dir_len = d->dirlen();
   memset(d->raw_dir, 0, dir_len);
+  memset(d->dirty_segments, DIR_SYNC_ALL, d->segments);
   vol_init_dir(d);
   d->header->magic          = VOL_MAGIC;
   d->header->version._major = CACHE_DB_MAJOR_VERSION;
   d->header->version._minor = CACHE_DB_MINOR_VERSION;
+  d->header->key_hash       = cacheProcessor.key_hash;
   d->scan_pos = d->header->agg_pos = d->header->write_pos = d->start;
   d->header->last_write_pos                               = d->header->write_pos;
   d->header->phase                                        = 0;
@@ -1187,6 +1332,12 @@ vol_clear_init(Vol *d)
   d->header->dirty                                        = 0;
   d->sector_size = d->header->sector_size = d->disk->hw_sector_size;
   *d->footer                              = *d->header;
+  if (d->tag_index) {
+    dir_tag_index_build(d);
+  }
+  if (d->dir_bloom) {
+    dir_bloom_build(d);
+  }
 }
 
 int
@@ -1251,22 +1402,34 @@ Vol::init(char *s, off_t blocks, off_t dir_skip, bool clear)
   int evac_len  = evacuate_size * sizeof(DLL<EvacuationBlock>);
   evacuate      = static_cast<DLL<EvacuationBlock> *>(ats_malloc(evac_len));
   memset(static_cast<void *>(evacuate), 0, evac_len);
+  agg_write_init(cache_config_agg_write_max_in_flight);
 
   Debug("cache_init", "Vol %s: allocating %zu directory bytes for a %lld byte volume (%lf%%)", hash_text.get(), dirlen(),
         (long long)this->len, (double)dirlen() / (double)this->len * 100.0);
 
-  raw_dir = nullptr;
-  if (ats_hugepage_enabled()) {
+  raw_dir = static_cast<char *>(ats_alloc_hugepage_arena(this->dirlen()));
+  if (raw_dir == nullptr && ats_hugepage_enabled()) {
     raw_dir = static_cast<char *>(ats_alloc_hugepage(this->dirlen()));
   }
   if (raw_dir == nullptr) {
     raw_dir = static_cast<char *>(ats_memalign(ats_pagesize(), this->dirlen()));
   }
+  // Keep the directory on the node the disk hangs off, before any of it is touched.
+  ats_numa_bind_area(raw_dir, this->dirlen(), ats_numa_node_of_fd(disk->fd));
 
   dir    = reinterpret_cast<Dir *>(raw_dir + this->headerlen());
   header = reinterpret_cast<VolHeaderFooter *>(raw_dir);
   footer = reinterpret_cast<VolHeaderFooter *>(raw_dir + this->dirlen() - ROUND_TO_STORE_BLOCK(sizeof(VolHeaderFooter)));
 
+  // Neither copy on disk is known to match memory until it has been written once.
+  dirty_segments = static_cast<uint8_t *>(ats_malloc(segments));
+  memset(dirty_segments, DIR_SYNC_ALL, segments);
+
+  GLOBAL_CACHE_SUM_GLOBAL_DYN_STAT(cache_dir_load_volumes_stat, 1);
+  if (cache_config_dir_load_early_serve) {
+    eventProcessor.schedule_imm(new VolEarlyServe(this), ET_CALL);
+  }
+
   if (clear) {
     Note("clearing cache directory '%s'", hash_text.get());
     return clear_dir();
@@ -1295,7 +1458,7 @@ Vol::init(char *s, off_t blocks, off_t dir_skip, bool clear)
     aio->thread           = AIO_CALLBACK_THREAD_ANY;
     aio->then             = (i < 3) ? &(init_info->vol_aio[i + 1]) : nullptr;
   }
-#if AIO_MODE == AIO_MODE_NATIVE
+#if AIO_MODE == AIO_MODE_NATIVE || AIO_MODE == AIO_MODE_IO_URING
   ink_assert(ink_aio_readv(init_info->vol_aio));
 #else
   ink_assert(ink_aio_read(init_info->vol_aio));
@@ -1334,13 +1497,102 @@ Vol::handle_dir_clear(int event, void *data)
   return EVENT_DONE;
 }
 
+void
+Vol::read_dir(off_t base)
+{
+  size_t dir_len  = this->dirlen();
+  size_t chunk    = cache_config_dir_load_chunk_size > 0 ? ROUND_TO_STORE_BLOCK(cache_config_dir_load_chunk_size) : dir_len;
+  int chunks      = static_cast<int>((dir_len + chunk - 1) / chunk);
+  int parallel    = std::min(std::max(cache_config_dir_load_parallel, 1), chunks);
+  VolInitInfo *ii = init_info;
+
+  ii->dir_base       = base;
+  ii->dir_chunk      = chunk;
+  ii->dir_next       = 0;
+  ii->dir_prefix     = 0;
+  ii->dir_aio        = new AIOCallbackInternal[parallel];
+  ii->dir_aio_count  = parallel;
+  ii->dir_chunk_done = static_cast<uint8_t *>(ats_malloc(chunks));
+  memset(ii->dir_chunk_done, 0, chunks);
+  GLOBAL_CACHE_SUM_GLOBAL_DYN_STAT(cache_dir_load_bytes_total_stat, dir_len);
+  Debug("cache_init", "Vol %s: reading %zu directory bytes in %d chunks, %d at a time", hash_text.get(), dir_len, chunks, parallel);
+
+  SET_HANDLER(&Vol::handle_dir_read);
+  for (int i = 0; i < parallel; ++i) {
+    AIOCallback *op      = &ii->dir_aio[i];
+    op->aiocb.aio_fildes = fd;
+    op->action           = this;
+    op->thread           = AIO_CALLBACK_THREAD_ANY;
+    op->then             = nullptr;
+    read_dir_next(op);
+  }
+}
+
+bool
+Vol::read_dir_next(AIOCallback *op)
+{
+  VolInitInfo *ii = init_info;
+  size_t dir_len  = this->dirlen();
+
+  if (ii->dir_failed || ii->dir_next >= dir_len) {
+    return false;
+  }
+  op->aiocb.aio_buf    = raw_dir + ii->dir_next;
+  op->aiocb.aio_nbytes = std::min(ii->dir_chunk, dir_len - ii->dir_next);
+  op->aiocb.aio_offset = ii->dir_base + ii->dir_next;
+  ii->dir_next += op->aiocb.aio_nbytes;
+  ++ii->dir_in_flight;
+  ink_assert(ink_aio_read(op));
+  return true;
+}
+
+void
+Vol::read_dir_done(AIOCallback *op)
+{
+  VolInitInfo *ii = init_info;
+  size_t dir_len  = this->dirlen();
+  size_t seg_len  = buckets * DIR_DEPTH * SIZEOF_DIR;
+
+  ii->dir_chunk_done[(static_cast<char *>(op->aiocb.aio_buf) - raw_dir) / ii->dir_chunk] = 1;
+  GLOBAL_CACHE_SUM_GLOBAL_DYN_STAT(cache_dir_load_bytes_read_stat, op->aiocb.aio_nbytes);
+  while (ii->dir_prefix < dir_len && ii->dir_chunk_done[ii->dir_prefix / ii->dir_chunk]) {
+    ii->dir_prefix = std::min(ii->dir_prefix + ii->dir_chunk, dir_len);
+  }
+
+  // Check every segment that is completely in while the rest is still on its way. A directory with
+  // a bad header is about to be cleared, there is no point.
+  if (ii->dir_prefix < static_cast<size_t>(this->headerlen()) || header->magic != VOL_MAGIC) {
+    return;
+  }
+  while (ii->dir_segments_checked < segments) {
+    size_t seg_end = reinterpret_cast<char *>(dir_segment(ii->dir_segments_checked)) - raw_dir + seg_len;
+    if (seg_end > ii->dir_prefix) {
+      break;
+    }
+    dir_check_segment(ii->dir_segments_checked++, this);
+  }
+}
+
 int
 Vol::handle_dir_read(int event, void *data)
 {
   AIOCallback *op = static_cast<AIOCallback *>(data);
 
   if (event == AIO_EVENT_DONE) {
+    VolInitInfo *ii = init_info;
+    --ii->dir_in_flight;
     if (static_cast<size_t>(op->aio_result) != op->aiocb.aio_nbytes) {
+      ii->dir_failed = true;
+    } else {
+      read_dir_done(op);
+      if (read_dir_next(op)) {
+        return EVENT_CONT;
+      }
+    }
+    if (ii->dir_in_flight > 0) {
+      return EVENT_CONT;
+    }
+    if (ii->dir_failed) {
       Note("Directory read failed: clearing cache directory %s", this->hash_text.get());
       clear_dir();
       return EVENT_DONE;
@@ -1656,7 +1908,7 @@ Ldone : {
   init_info->vol_aio[2].aiocb.aio_offset = ss + dirlen - footerlen;
 
   SET_HANDLER(&Vol::handle_recover_write_dir);
-#if AIO_MODE == AIO_MODE_NATIVE
+#if AIO_MODE == AIO_MODE_NATIVE || AIO_MODE == AIO_MODE_IO_URING
   ink_assert(ink_aio_writev(init_info->vol_aio));
 #else
   ink_assert(ink_aio_write(init_info->vol_aio));
@@ -1719,8 +1971,7 @@ Vol::handle_header_read(int event, void *data)
       if (is_debug_tag_set("cache_init")) {
         Note("using directory A for '%s'", hash_text.get());
       }
-      io.aiocb.aio_offset = skip;
-      ink_assert(ink_aio_read(&io));
+      read_dir(skip);
     }
     // try B
     else if (hf[2]->sync_serial == hf[3]->sync_serial) {
@@ -1728,8 +1979,7 @@ Vol::handle_header_read(int event, void *data)
       if (is_debug_tag_set("cache_init")) {
         Note("using directory B for '%s'", hash_text.get());
       }
-      io.aiocb.aio_offset = skip + this->dirlen();
-      ink_assert(ink_aio_read(&io));
+      read_dir(skip + this->dirlen());
     } else {
       Note("no good directory, clearing '%s' since sync_serials on both A and B copies are invalid", hash_text.get());
       Note("Header A: %d\nFooter A: %d\n Header B: %d\n Footer B %d\n", hf[0]->sync_serial, hf[1]->sync_serial, hf[2]->sync_serial,
@@ -1752,41 +2002,59 @@ Vol::dir_init_done(int /* event ATS_UNUSED */, void * /* data ATS_UNUSED */)
     eventProcessor.schedule_in(this, HRTIME_MSECONDS(5), ET_CALL);
     return EVENT_CONT;
   } else {
-    int vol_no = gnvol++;
-    ink_assert(!gvol[vol_no]);
-    gvol[vol_no] = this;
+    Vol *vol = this; // must be named "vol" to make STAT macros work.
+    dir_tag_index_build(this);
+    dir_bloom_build(this);
+    // Here rather than when the cache is initialized, so the volumes count their entries in parallel.
+    dir_used_at_load = dir_entries_used(this);
+    // a write that failed before the last sync may have left the write limit ahead
+    header->agg_pos = header->write_pos;
     SET_HANDLER(&Vol::aggWrite);
-    if (fd == -1) {
-      cache->vol_initialized(false);
-    } else {
-      cache->vol_initialized(true);
+    dir_ready = true;
+    GLOBAL_CACHE_SUM_GLOBAL_DYN_STAT(cache_dir_load_volumes_ready_stat, 1);
+    if (cache_config_dir_load_early_serve) {
+      CACHE_VOL_SUM_DYN_STAT(cache_direntries_used_stat, dir_used_at_load);
+      GLOBAL_CACHE_SUM_GLOBAL_DYN_STAT(cache_direntries_used_stat, dir_used_at_load);
+      Note("cache volume '%s' is ready", hash_text.get());
+      // Serving started without this volume, it has to go with the key hash already in use.
+      if (CacheProcessor::initialized == CACHE_INITIALIZED && header->key_hash != cacheProcessor.key_hash) {
+        if (dir_used_at_load) {
+          Warning("cache volume '%s' has key hash %d, the cache is using %d, its objects will not be found", hash_text.get(),
+                  header->key_hash, cacheProcessor.key_hash);
+        }
+        header->key_hash = cacheProcessor.key_hash;
+      }
     }
+    dir_load_register();
     return EVENT_DONE;
   }
 }
 
-// explicit pair for random table in build_vol_hash_table
-struct rtable_pair {
-  unsigned int rval; ///< relative value, used to sort.
-  unsigned int idx;  ///< volume mapping table index.
-};
-
-// comparison operator for random table in build_vol_hash_table
-// sorts based on the randomly assigned rval
-static int
-cmprtable(const void *aa, const void *bb)
+void
+Vol::dir_load_register()
 {
-  rtable_pair *a = (rtable_pair *)aa;
-  rtable_pair *b = (rtable_pair *)bb;
-  if (a->rval < b->rval) {
-    return -1;
+  if (dir_registered) {
+    return;
   }
-  if (a->rval > b->rval) {
-    return 1;
+  dir_registered = true;
+
+  int vol_no = gnvol++;
+  ink_assert(!gvol[vol_no]);
+  gvol[vol_no] = this;
+  // With early serving the volume counts as good from the start, until its directory is ready
+  // every lookup in it is a miss.
+  if (fd == -1) {
+    cache->vol_initialized(false);
+  } else {
+    cache->vol_initialized(true);
   }
-  return 0;
 }
 
+// Each volume gets one hash point per VOL_HASH_ALLOC_SIZE of its size, from a random sequence
+// seeded by its hash id, and each slot of the table goes to the volume of the first point at or
+// after the middle of the slot. The points of a volume do not depend on the others, so when a
+// volume goes away only its slots move, each to the volume of the next point, as on a ring.
+// Only the lowest point in each slot is needed, so no ring of all the points is built or sorted.
 void
 build_vol_hash_table(CacheHostRecord *cp)
 {
@@ -1826,18 +2094,16 @@ build_vol_hash_table(CacheHostRecord *cp)
 
   unsigned int *forvol   = static_cast<unsigned int *>(ats_malloc(sizeof(unsigned int) * num_vols));
   unsigned int *gotvol   = static_cast<unsigned int *>(ats_malloc(sizeof(unsigned int) * num_vols));
-  unsigned int *rnd      = static_cast<unsigned int *>(ats_malloc(sizeof(unsigned int) * num_vols));
   unsigned short *ttable = static_cast<unsigned short *>(ats_malloc(sizeof(unsigned short) * VOL_HASH_TABLE_SIZE));
   unsigned short *old_table;
-  unsigned int *rtable_entries = static_cast<unsigned int *>(ats_malloc(sizeof(unsigned int) * num_vols));
-  unsigned int rtable_size     = 0;
+  // lowest hash point in each slot and the vol it belongs to
+  unsigned int *slot_rval  = static_cast<unsigned int *>(ats_malloc(sizeof(unsigned int) * VOL_HASH_TABLE_SIZE));
+  unsigned short *slot_vol = static_cast<unsigned short *>(ats_malloc(sizeof(unsigned short) * VOL_HASH_TABLE_SIZE));
 
   // estimate allocation
   for (int i = 0; i < num_vols; i++) {
     forvol[i] = (VOL_HASH_TABLE_SIZE * (p[i]->len >> STORE_BLOCK_SHIFT)) / total;
     used += forvol[i];
-    rtable_entries[i] = p[i]->len / VOL_HASH_ALLOC_SIZE;
-    rtable_size += rtable_entries[i];
     gotvol[i] = 0;
   }
   // spread around the excess
@@ -1845,39 +2111,41 @@ build_vol_hash_table(CacheHostRecord *cp)
   for (int i = 0; i < extra; i++) {
     forvol[i % num_vols]++;
   }
-  // seed random number generator
-  for (int i = 0; i < num_vols; i++) {
-    uint64_t x = p[i]->hash_id.fold();
-    rnd[i]     = static_cast<unsigned int>(x);
-  }
-  // initialize table to "empty"
+  // initialize slots to "empty"
   for (int i = 0; i < VOL_HASH_TABLE_SIZE; i++) {
-    ttable[i] = VOL_HASH_EMPTY;
+    slot_vol[i] = VOL_HASH_EMPTY;
   }
-  // generate random numbers proportional to allocation
-  rtable_pair *rtable = static_cast<rtable_pair *>(ats_malloc(sizeof(rtable_pair) * rtable_size));
-  int rindex          = 0;
+  unsigned int width    = (1LL << 32) / VOL_HASH_TABLE_SIZE;
+  unsigned int max_rval = 0; // highest point, it takes the slots after it
+  int max_vol           = 0;
+  // generate random numbers proportional to allocation, keeping the lowest in each slot
   for (int i = 0; i < num_vols; i++) {
-    for (int j = 0; j < static_cast<int>(rtable_entries[i]); j++) {
-      rtable[rindex].rval = next_rand(&rnd[i]);
-      rtable[rindex].idx  = i;
-      rindex++;
-    }
-  }
-  ink_assert(rindex == (int)rtable_size);
-  // sort (rand #, vol $ pairs)
-  qsort(rtable, rtable_size, sizeof(rtable_pair), cmprtable);
-  unsigned int width = (1LL << 32) / VOL_HASH_TABLE_SIZE;
-  unsigned int pos; // target position to allocate
-  // select vol with closest random number for each bucket
-  int i = 0; // index moving through the random numbers
-  for (int j = 0; j < VOL_HASH_TABLE_SIZE; j++) {
-    pos = width / 2 + j * width; // position to select closest to
-    while (pos > rtable[i].rval && i < static_cast<int>(rtable_size) - 1) {
-      i++;
-    }
-    ttable[j] = mapping[rtable[i].idx];
-    gotvol[rtable[i].idx]++;
+    unsigned int rnd = static_cast<unsigned int>(p[i]->hash_id.fold());
+    int64_t entries  = p[i]->len / VOL_HASH_ALLOC_SIZE;
+    for (int64_t j = 0; j < entries; j++) {
+      unsigned int rval = next_rand(&rnd);
+      if (rval > max_rval) {
+        max_rval = rval;
+        max_vol  = i;
+      }
+      if (rval < width / 2) {
+        continue;
+      }
+      unsigned int slot = std::min((rval - width / 2) / width, static_cast<unsigned int>(VOL_HASH_TABLE_SIZE - 1));
+      if (slot_vol[slot] == VOL_HASH_EMPTY || rval < slot_rval[slot]) {
+        slot_rval[slot] = rval;
+        slot_vol[slot]  = i;
+      }
+    }
+  }
+  // select vol with closest random number at or after the middle of each slot
+  int next = max_vol;
+  for (int j = VOL_HASH_TABLE_SIZE - 1; j >= 0; j--) {
+    if (slot_vol[j] != VOL_HASH_EMPTY) {
+      next = slot_vol[j];
+    }
+    ttable[j] = mapping[next];
+    gotvol[next]++;
   }
   for (int i = 0; i < num_vols; i++) {
     Debug("cache_init", "build_vol_hash_table index %d mapped to %d requested %d got %d", i, mapping[i], forvol[i], gotvol[i]);
@@ -1890,9 +2158,8 @@ build_vol_hash_table(CacheHostRecord *cp)
   ats_free(p);
   ats_free(forvol);
   ats_free(gotvol);
-  ats_free(rnd);
-  ats_free(rtable_entries);
-  ats_free(rtable);
+  ats_free(slot_rval);
+  ats_free(slot_vol);
 }
 
 void
@@ -1932,7 +2199,9 @@ CacheProcessor::mark_storage_offline(CacheDisk *d, ///< Target disk
   for (p = 0; p < gnvol; p++) {
     if (d->fd == gvol[p]->fd) {
       total_dir_delete += gvol[p]->buckets * gvol[p]->segments * DIR_DEPTH;
-      used_dir_delete += dir_entries_used(gvol[p]);
+      if (gvol[p]->dir_ready) {
+        used_dir_delete += dir_entries_used(gvol[p]);
+      }
       total_bytes_delete += gvol[p]->len - gvol[p]->dirlen();
     }
   }
@@ -1947,7 +2216,7 @@ CacheProcessor::mark_storage_offline(CacheDisk *d, ///< Target disk
   RecIncrGlobalRawStat(cache_rsb, cache_span_offline_stat, 1);
 
   if (theCache) {
-    rebuild_host_table(theCache);
+    rebuild_host_table(theCache, d);
   }
 
   zret = this->has_online_storage();
@@ -2080,7 +2349,7 @@ Cache::open(bool clear, bool /* fix ATS_UNUSED */)
             blocks                      = q->b->len;
 
             bool vol_clear = clear || d->cleared || q->new_block;
-#if AIO_MODE == AIO_MODE_NATIVE
+#if AIO_MODE == AIO_MODE_NATIVE || AIO_MODE == AIO_MODE_IO_URING
             eventProcessor.schedule_imm(new VolInit(cp->vols[vol_no], d->path, blocks, q->b->offset, vol_clear));
 #else
             cp->vols[vol_no]->init(d->path, blocks, q->b->offset, vol_clear);
@@ -2121,7 +2390,7 @@ CacheVC::is_pread_capable()
 
 #define STORE_COLLISION 1
 
-static void
+void
 unmarshal_helper(Doc *doc, Ptr<IOBufferData> &buf, int &okay)
 {
   using UnmarshalFunc           = int(char *buf, int len, RefCountObj *block_ref);
@@ -2130,12 +2399,12 @@ unmarshal_helper(Doc *doc, Ptr<IOBufferData> &buf, int &okay)
 
   // introduced by https://github.com/apache/trafficserver/pull/4874, this is used to distinguish the doc version
   // before and after #4847
-  if (version < CACHE_DB_VERSION) {
+  if (version < CACHE_DB_VERSION_HEAP_FIXUP) {
     unmarshal_func = &HTTPInfo::unmarshal_v24_1;
   }
 
   char *tmp = doc->hdr();
-  int len   = doc->hlen;
+  int len   = doc_alternates_len(doc);
   while (len > 0) {
     int r = unmarshal_func(tmp, len, buf.get());
     if (r < 0) {
@@ -2148,6 +2417,16 @@ unmarshal_helper(Doc *doc, Ptr<IOBufferData> &buf, int &okay)
   }
 }
 
+// Length of the alternates in the header of @a doc, without the summaries behind them.
+int
+doc_alternates_len(Doc *doc)
+{
+  if (ts::VersionNumber(doc->v_major, doc->v_minor) < CACHE_DB_VERSION_ALT_SUMMARY) {
+    return doc->hlen;
+  }
+  return CacheHTTPInfoVector::alternates_length(doc->hdr(), doc->hlen);
+}
+
 // [amc] I think this is where all disk reads from cache funnel through here.
 int
 CacheVC::handleReadDone(int event, Event *e)
@@ -2273,6 +2552,59 @@ Ldone:
   return handleEvent(AIO_EVENT_DONE, nullptr);
 }
 
+// Hands the fragment the merged read was for to handleReadDone in its own buffer, the ones after
+// it stay in readahead_buf for the next reads of the VC.
+int
+CacheVC::handleReadAheadDone(int event, Event *e)
+{
+  if (event == AIO_EVENT_DONE) {
+    if (io.aio_result >= static_cast<int64_t>(readahead_first)) {
+      memcpy(buf->data(), readahead_buf->data(), readahead_first);
+      readahead_len = io.aio_result;
+      io.aio_result = readahead_first;
+    } else {
+      readahead_buf.clear();
+      readahead_len = 0;
+    }
+    io.aiocb.aio_buf    = buf->data();
+    io.aiocb.aio_nbytes = readahead_first;
+    SET_HANDLER(&CacheVC::handleReadDone);
+  }
+  return handleReadDone(event, e);
+}
+
+// How many bytes of the fragments after the one at @a dir are right after it on disk, up to
+// proxy.config.cache.read_ahead bytes and to what is left of the read, so that they are read in
+// the same IO. Only for the data fragments of objects read in order. Called with the volume locked.
+static uint32_t
+read_ahead_len(CacheVC *vc, uint32_t len)
+{
+  if (cache_config_read_ahead <= 0 || vc->vio.op != VIO::READ || vc->read_key != &vc->key || !vc->doc_len ||
+      vc->f.single_fragment) {
+    return 0;
+  }
+  Vol *vol       = vc->vol;
+  int64_t limit  = std::min(std::min(cache_config_read_ahead, static_cast<int64_t>(CACHE_READ_AHEAD_MAX)), vc->vio.ntodo());
+  off_t end      = vol->vol_offset(&vc->dir) + len;
+  uint32_t ahead = 0;
+  CacheKey next  = vc->key;
+
+  while (ahead < limit) {
+    Dir dir, *last_collision = nullptr;
+    next_CacheKey(&next, &next);
+    if (!dir_probe(&next, vol, &dir, &last_collision) || vol->vol_offset(&dir) != end || dir_agg_buf_valid(vol, &dir)) {
+      break;
+    }
+    uint32_t size = dir_approx_size(&dir);
+    if (ahead + size > limit || end + size > static_cast<off_t>(vol->skip + vol->len)) {
+      break;
+    }
+    ahead += size;
+    end += size;
+  }
+  return ahead;
+}
+
 int
 CacheVC::handleRead(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
 {
@@ -2296,11 +2628,9 @@ CacheVC::handleRead(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
   }
   // see if its in the aggregation buffer
   if (dir_agg_buf_valid(vol, &dir)) {
-    int agg_offset = vol->vol_offset(&dir) - vol->header->write_pos;
-    buf            = new_IOBufferData(iobuffer_size_to_index(io.aiocb.aio_nbytes, MAX_BUFFER_SIZE_INDEX), MEMALIGNED);
-    ink_assert((agg_offset + io.aiocb.aio_nbytes) <= (unsigned)vol->agg_buf_pos);
+    buf       = new_IOBufferData(iobuffer_size_to_index(io.aiocb.aio_nbytes, MAX_BUFFER_SIZE_INDEX), MEMALIGNED);
     char *doc = buf->data();
-    char *agg = vol->agg_buffer + agg_offset;
+    char *agg = vol->agg_buf_data(vol->vol_offset(&dir));
     memcpy(doc, agg, io.aiocb.aio_nbytes);
     io.aio_result = io.aiocb.aio_nbytes;
     SET_HANDLER(&CacheVC::handleReadDone);
@@ -2312,11 +2642,34 @@ CacheVC::handleRead(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
   if (static_cast<off_t>(io.aiocb.aio_offset + io.aiocb.aio_nbytes) > static_cast<off_t>(vol->skip + vol->len)) {
     io.aiocb.aio_nbytes = vol->skip + vol->len - io.aiocb.aio_offset;
   }
-  buf              = new_IOBufferData(iobuffer_size_to_index(io.aiocb.aio_nbytes, MAX_BUFFER_SIZE_INDEX), MEMALIGNED);
+  buf = new_IOBufferData(iobuffer_size_to_index(io.aiocb.aio_nbytes, MAX_BUFFER_SIZE_INDEX), MEMALIGNED);
+  // see if it was read along with an earlier fragment
+  if (readahead_len && io.aiocb.aio_offset >= readahead_offset &&
+      io.aiocb.aio_offset + static_cast<off_t>(io.aiocb.aio_nbytes) <= readahead_offset + static_cast<off_t>(readahead_len)) {
+    memcpy(buf->data(), readahead_buf->data() + (io.aiocb.aio_offset - readahead_offset), io.aiocb.aio_nbytes);
+    if (io.aiocb.aio_offset + static_cast<off_t>(io.aiocb.aio_nbytes) == readahead_offset + static_cast<off_t>(readahead_len)) {
+      readahead_buf.clear();
+      readahead_len = 0;
+    }
+    io.aio_result = io.aiocb.aio_nbytes;
+    CACHE_INCREMENT_DYN_STAT(cache_read_ahead_stat);
+    SET_HANDLER(&CacheVC::handleReadDone);
+    return EVENT_RETURN;
+  }
   io.aiocb.aio_buf = buf->data();
   io.action        = this;
   io.thread        = mutex->thread_holding->tt == DEDICATED ? AIO_CALLBACK_THREAD_ANY : mutex->thread_holding;
   SET_HANDLER(&CacheVC::handleReadDone);
+  if (uint32_t ahead = read_ahead_len(this, io.aiocb.aio_nbytes)) {
+    // read the fragments after it in the same IO
+    readahead_first     = io.aiocb.aio_nbytes;
+    readahead_offset    = io.aiocb.aio_offset;
+    readahead_len       = 0;
+    io.aiocb.aio_nbytes = readahead_first + ahead;
+    readahead_buf       = new_xmalloc_IOBufferData(ats_memalign(ats_pagesize(), io.aiocb.aio_nbytes), io.aiocb.aio_nbytes);
+    io.aiocb.aio_buf    = readahead_buf->data();
+    SET_HANDLER(&CacheVC::handleReadAheadDone);
+  }
   ink_assert(ink_aio_read(&io) >= 0);
   CACHE_DEBUG_INCREMENT_DYN_STAT(cache_pread_count_stat);
   return EVENT_CONT;
@@ -2345,7 +2698,12 @@ Cache::lookup(Continuation *cont, const CacheKey *key, CacheFragType type, const
     return ACTION_RESULT_DONE;
   }
 
-  Vol *vol          = key_to_vol(key, hostname, host_len);
+  Vol *vol = key_to_vol(key, hostname, host_len);
+  if (!vol->dir_ready) {
+    // Its directory is still loading, which is the same as not having the object.
+    cont->handleEvent(CACHE_EVENT_LOOKUP_FAILED, nullptr);
+    return ACTION_RESULT_DONE;
+  }
   ProxyMutex *mutex = cont->mutex.get();
   CacheVC *c        = new_CacheVC(cont);
   SET_CONTINUATION_HANDLER(c, &CacheVC::openReadStartHead);
@@ -2457,6 +2815,14 @@ Cache::remove(Continuation *cont, const CacheKey *key, CacheFragType type, const
     return ACTION_RESULT_DONE;
   }
 
+  Vol *vol = key_to_vol(key, hostname, host_len);
+  if (!vol->dir_ready) {
+    if (cont) {
+      cont->handleEvent(CACHE_EVENT_REMOVE_FAILED, nullptr);
+    }
+    return ACTION_RESULT_DONE;
+  }
+
   Ptr<ProxyMutex> mutex;
   if (!cont) {
     cont = new_CacheRemoveCont();
@@ -2464,7 +2830,6 @@ Cache::remove(Continuation *cont, const CacheKey *key, CacheFragType type, const
 
   CACHE_TRY_LOCK(lock, cont->mutex, this_ethread());
   ink_assert(lock.is_locked());
-  Vol *vol = key_to_vol(key, hostname, host_len);
   // coverity[var_decl]
   Dir result;
   dir_clear(&result); // initialized here, set result empty so we can recognize missed lock
@@ -2544,6 +2909,9 @@ cplist_update()
       if (config_vol->number == cp->vol_number) {
         if (cp->scheme == config_vol->scheme) {
           cp->ramcache_enabled = config_vol->ramcache_enabled;
+          cp->tier             = config_vol->tier;
+          cp->admit_hits       = config_vol->admit_hits;
+          cp->admit_size       = config_vol->admit_size;
           config_vol->cachep   = cp;
         } else {
           /* delete this volume from all the disks */
@@ -2611,6 +2979,9 @@ cplist_update()
             memset(new_cp->disk_vols, 0, gndisks * sizeof(DiskVol *));
             new_cp->vol_number = config_vol->number;
             new_cp->scheme     = config_vol->scheme;
+            new_cp->tier       = config_vol->tier;
+            new_cp->admit_hits = config_vol->admit_hits;
+            new_cp->admit_size = config_vol->admit_size;
             config_vol->cachep = new_cp;
             fillExclusiveDisks(config_vol->cachep);
             cp_list.enqueue(new_cp);
@@ -2826,6 +3197,9 @@ cplist_reconfigure()
           delete new_cp;
           return -1;
         }
+        new_cp->tier       = config_vol->tier;
+        new_cp->admit_hits = config_vol->admit_hits;
+        new_cp->admit_size = config_vol->admit_size;
         cp_list.enqueue(new_cp);
         cp_list_len++;
         config_vol->cachep = new_cp;
@@ -2989,17 +3363,40 @@ create_volume(int volume_number, off_t size_in_blocks, int scheme, CacheVol *cp)
   return 0;
 }
 
+// Whether any of the volumes of @a rec are on @a disk.
+static bool
+host_rec_uses_disk(CacheHostRecord *rec, CacheDisk *disk)
+{
+  for (int i = 0; i < rec->num_vols; i++) {
+    if (rec->vols[i]->disk == disk) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Rebuilds the volume tables of the host records with a volume on @a disk, which went offline.
+// The other tables would come out the same, and only the slots of the volumes on @a disk move.
 void
-rebuild_host_table(Cache *cache)
+rebuild_host_table(Cache *cache, CacheDisk *disk)
 {
-  build_vol_hash_table(&cache->hosttable->gen_host_rec);
+  if (host_rec_uses_disk(&cache->hosttable->gen_host_rec, disk)) {
+    build_vol_hash_table(&cache->hosttable->gen_host_rec);
+  }
   if (cache->hosttable->m_numEntries != 0) {
     CacheHostMatcher *hm   = cache->hosttable->getHostMatcher();
     CacheHostRecord *h_rec = hm->getDataArray();
     int h_rec_len          = hm->getNumElements();
     int i;
     for (i = 0; i < h_rec_len; i++) {
-      build_vol_hash_table(&h_rec[i]);
+      if (host_rec_uses_disk(&h_rec[i], disk)) {
+        build_vol_hash_table(&h_rec[i]);
+      }
+    }
+  }
+  for (int t = 1; t < CACHE_TIER_MAX; t++) {
+    if (cache->hosttable->tier_host_rec[t].num_vols && host_rec_uses_disk(&cache->hosttable->tier_host_rec[t], disk)) {
+      build_vol_hash_table(&cache->hosttable->tier_host_rec[t]);
     }
   }
 }
@@ -3039,6 +3436,18 @@ Cache::key_to_vol(const CacheKey *key, const char *hostname, int host_len)
   }
 }
 
+// The volume of @a tier for @a key, nullptr if there is no such tier or all its disks are bad.
+Vol *
+Cache::key_to_tier_vol(const CacheKey *key, int tier)
+{
+  uint32_t h = (key->slice32(2) >> DIR_TAG_WIDTH) % VOL_HASH_TABLE_SIZE;
+
+  if (tier <= 0 || tier >= CACHE_TIER_MAX || !hosttable->tier_host_rec[tier].vol_hash_table) {
+    return nullptr;
+  }
+  return hosttable->tier_host_rec[tier].vols[hosttable->tier_host_rec[tier].vol_hash_table[h]];
+}
+
 static void
 reg_int(const char *str, int stat, RecRawStatBlock *rsb, const char *prefix, RecRawStatSyncCb sync_cb = RecRawStatSyncSum)
 {
@@ -3049,6 +3458,15 @@ reg_int(const char *str, int stat, RecRawStatBlock *rsb, const char *prefix, Rec
 }
 #define REG_INT(_str, _stat) reg_int(_str, (int)_stat, rsb, prefix)
 
+static void
+reg_float(const char *str, int stat, RecRawStatBlock *rsb, const char *prefix, RecRawStatSyncCb sync_cb)
+{
+  char stat_str[256];
+  snprintf(stat_str, sizeof(stat_str), "%s.%s", prefix, str);
+  RecRegisterRawStat(rsb, RECT_PROCESS, stat_str, RECD_FLOAT, RECP_NON_PERSISTENT, stat, sync_cb);
+  DOCACHE_CLEAR_DYN_STAT(stat)
+}
+
 // Register Stats
 void
 register_cache_stats(RecRawStatBlock *rsb, const char *prefix)
@@ -3082,6 +3500,10 @@ register_cache_stats(RecRawStatBlock *rsb, const char *prefix)
   REG_INT("evacuate.active", cache_evacuate_active_stat);
   REG_INT("evacuate.success", cache_evacuate_success_stat);
   REG_INT("evacuate.failure", cache_evacuate_failure_stat);
+  REG_INT("evacuate.readahead", cache_evacuate_readahead_stat);
+  REG_INT("read_ahead", cache_read_ahead_stat);
+  REG_INT("agg.stalls", cache_agg_stalls_stat);
+  REG_INT("agg.stall_time", cache_agg_stall_time_stat);
   REG_INT("scan.active", cache_scan_active_stat);
   REG_INT("scan.success", cache_scan_success_stat);
   REG_INT("scan.failure", cache_scan_failure_stat);
@@ -3093,6 +3515,7 @@ register_cache_stats(RecRawStatBlock *rsb, const char *prefix)
   REG_INT("frags_per_doc.3+", cache_three_plus_plus_fragment_document_count_stat);
   REG_INT("read_busy.success", cache_read_busy_success_stat);
   REG_INT("read_busy.failure", cache_read_busy_failure_stat);
+  REG_INT("read_busy.wakeups", cache_read_busy_wakeups_stat);
   REG_INT("write_bytes_stat", cache_write_bytes_stat);
   REG_INT("vector_marshals", cache_hdr_vector_marshal_stat);
   REG_INT("hdr_marshals", cache_hdr_marshal_stat);
@@ -3103,11 +3526,35 @@ register_cache_stats(RecRawStatBlock *rsb, const char *prefix)
   REG_INT("sync.count", cache_directory_sync_count_stat);
   REG_INT("sync.bytes", cache_directory_sync_bytes_stat);
   REG_INT("sync.time", cache_directory_sync_time_stat);
+  REG_INT("open_dir.lock_contention", cache_open_dir_lock_contention_stat);
+  REG_INT("open_dir.lock_avoided", cache_open_dir_lock_avoided_stat);
   REG_INT("span.errors.read", cache_span_errors_read_stat);
   REG_INT("span.errors.write", cache_span_errors_write_stat);
   REG_INT("span.failing", cache_span_failing_stat);
   REG_INT("span.offline", cache_span_offline_stat);
   REG_INT("span.online", cache_span_online_stat);
+  REG_INT("dir_load.bytes_total", cache_dir_load_bytes_total_stat);
+  REG_INT("dir_load.bytes_read", cache_dir_load_bytes_read_stat);
+  REG_INT("dir_load.volumes", cache_dir_load_volumes_stat);
+  REG_INT("dir_load.volumes_ready", cache_dir_load_volumes_ready_stat);
+  REG_INT("ram_cache.warm_start.objects", cache_ram_cache_warm_objects_stat);
+  REG_INT("ram_cache.warm_start.bytes", cache_ram_cache_warm_bytes_stat);
+  REG_INT("tier.lookups", cache_tier_lookups_stat);
+  for (int t = 0; t < CACHE_TIER_MAX; t++) {
+    char name[64];
+    snprintf(name, sizeof(name), "tier.%d.hits", t);
+    REG_INT(name, cache_tier_hits_stat + t);
+    snprintf(name, sizeof(name), "tier.%d.hit_bytes", t);
+    REG_INT(name, cache_tier_hit_bytes_stat + t);
+  }
+  REG_INT("tier.promotions", cache_tier_promotions_stat);
+  REG_INT("tier.demotions", cache_tier_demotions_stat);
+  REG_INT("tier.copy_failures", cache_tier_copy_failures_stat);
+  REG_INT("dir_bloom.negatives", cache_dir_bloom_negatives_stat);
+  REG_INT("write.admission_rejects", cache_write_admission_rejects_stat);
+  REG_INT("recycled", cache_recycled_stat);
+  reg_float("dir_bloom.false_positive_rate", cache_dir_bloom_false_positive_rate_stat, rsb, prefix, RecRawStatSyncAvg);
+  reg_float("read.alternates", cache_read_alternates_stat, rsb, prefix, RecRawStatSyncAvg);
 }
 
 int
@@ -3136,7 +3583,12 @@ ink_cache_init(ts::ModuleVersion v)
   REC_EstablishStaticConfigInt32(cache_config_ram_cache_algorithm, "proxy.config.cache.ram_cache.algorithm");
   REC_EstablishStaticConfigInt32(cache_config_ram_cache_compress, "proxy.config.cache.ram_cache.compress");
   REC_EstablishStaticConfigInt32(cache_config_ram_cache_compress_percent, "proxy.config.cache.ram_cache.compress_percent");
+  REC_EstablishStaticConfigInt32(cache_config_ram_cache_compress_threads, "proxy.config.cache.ram_cache.compress_threads");
   REC_ReadConfigInt32(cache_config_ram_cache_use_seen_filter, "proxy.config.cache.ram_cache.use_seen_filter");
+  REC_ReadConfigInt32(cache_config_ram_cache_warm_start, "proxy.config.cache.ram_cache.warm_start");
+  REC_ReadConfigInt32(cache_config_ram_cache_warm_start_rate, "proxy.config.cache.ram_cache.warm_start_rate");
+  REC_ReadConfigInt32(cache_config_tier_promote_hits, "proxy.config.cache.tier.promote_hits");
+  REC_ReadConfigInt32(cache_config_tier_demote, "proxy.config.cache.tier.demote");
 
   REC_EstablishStaticConfigInt32(cache_config_http_max_alts, "proxy.config.cache.limits.http.max_alts");
   Debug("cache_init", "proxy.config.cache.limits.http.max_alts = %d", cache_config_http_max_alts);
@@ -3151,6 +3603,30 @@ ink_cache_init(ts::ModuleVersion v)
   REC_EstablishStaticConfigInt32(cache_config_dir_sync_frequency, "proxy.config.cache.dir.sync_frequency");
   Debug("cache_init", "proxy.config.cache.dir.sync_frequency = %d", cache_config_dir_sync_frequency);
 
+  REC_ReadConfigInt32(cache_config_dir_tag_index, "proxy.config.cache.dir.tag_index");
+  Debug("cache_init", "proxy.config.cache.dir.tag_index = %d", cache_config_dir_tag_index);
+  REC_ReadConfigInt32(cache_config_dir_bloom_filter, "proxy.config.cache.dir.bloom_filter");
+  Debug("cache_init", "proxy.config.cache.dir.bloom_filter = %d", cache_config_dir_bloom_filter);
+  REC_ReadConfigInteger(cache_config_dir_load_chunk_size, "proxy.config.cache.dir_load.chunk_size");
+  Debug("cache_init", "proxy.config.cache.dir_load.chunk_size = %" PRId64, cache_config_dir_load_chunk_size);
+  REC_ReadConfigInt32(cache_config_dir_load_parallel, "proxy.config.cache.dir_load.parallel");
+  Debug("cache_init", "proxy.config.cache.dir_load.parallel = %d", cache_config_dir_load_parallel);
+  REC_ReadConfigInt32(cache_config_dir_load_early_serve, "proxy.config.cache.dir_load.early_serve");
+  Debug("cache_init", "proxy.config.cache.dir_load.early_serve = %d", cache_config_dir_load_early_serve);
+  REC_ReadConfigInt32(cache_config_key_hash, "proxy.config.cache.key_hash");
+#if TS_ENABLE_FIPS == 1
+  if (cache_config_key_hash != CACHE_KEY_HASH_DEFAULT) {
+    Warning("proxy.config.cache.key_hash = %d is not available in a FIPS build, using SHA-256", cache_config_key_hash);
+    cache_config_key_hash = CACHE_KEY_HASH_DEFAULT;
+  }
+#endif
+  if (cache_config_key_hash != CACHE_KEY_HASH_DEFAULT && cache_config_key_hash != CACHE_KEY_HASH_MURMUR3) {
+    Warning("invalid proxy.config.cache.key_hash = %d, using 0", cache_config_key_hash);
+    cache_config_key_hash = CACHE_KEY_HASH_DEFAULT;
+  }
+  Debug("cache_init", "proxy.config.cache.key_hash = %d", cache_config_key_hash);
+  cacheProcessor.key_hash = static_cast<CacheKeyHash>(cache_config_key_hash);
+
   REC_EstablishStaticConfigInt32(cache_config_select_alternate, "proxy.config.cache.select_alternate");
   Debug("cache_init", "proxy.config.cache.select_alternate = %d", cache_config_select_alternate);
 
@@ -3167,12 +3643,24 @@ ink_cache_init(ts::ModuleVersion v)
   REC_EstablishStaticConfigInt32(cache_read_while_writer_retry_delay, "proxy.config.cache.read_while_writer_retry.delay");
   Debug("cache_init", "proxy.config.cache.read_while_writer_retry.delay = %dms", cache_read_while_writer_retry_delay);
 
+  REC_EstablishStaticConfigInt32(cache_config_read_while_writer_push, "proxy.config.cache.read_while_writer.push");
+  Debug("cache_init", "proxy.config.cache.read_while_writer.push = %d", cache_config_read_while_writer_push);
+
   REC_EstablishStaticConfigInt32(cache_config_hit_evacuate_percent, "proxy.config.cache.hit_evacuate_percent");
   Debug("cache_init", "proxy.config.cache.hit_evacuate_percent = %d", cache_config_hit_evacuate_percent);
 
   REC_EstablishStaticConfigInt32(cache_config_hit_evacuate_size_limit, "proxy.config.cache.hit_evacuate_size_limit");
   Debug("cache_init", "proxy.config.cache.hit_evacuate_size_limit = %d", cache_config_hit_evacuate_size_limit);
 
+  REC_EstablishStaticConfigInt32(cache_config_hit_evacuate_reads, "proxy.config.cache.hit_evacuate_reads");
+  Debug("cache_init", "proxy.config.cache.hit_evacuate_reads = %d", cache_config_hit_evacuate_reads);
+
+  REC_ReadConfigInteger(cache_config_evacuate_readahead, "proxy.config.cache.evacuate.readahead");
+  Debug("cache_init", "proxy.config.cache.evacuate.readahead = %" PRId64, cache_config_evacuate_readahead);
+
+  REC_ReadConfigInteger(cache_config_read_ahead, "proxy.config.cache.read_ahead");
+  Debug("cache_init", "proxy.config.cache.read_ahead = %" PRId64, cache_config_read_ahead);
+
   REC_EstablishStaticConfigInt32(cache_config_force_sector_size, "proxy.config.cache.force_sector_size");
 
   ink_assert(REC_RegisterConfigUpdateFunc("proxy.config.cache.target_fragment_size", FragmentSizeUpdateCb, nullptr) !=
@@ -3189,6 +3677,10 @@ ink_cache_init(ts::ModuleVersion v)
   REC_EstablishStaticConfigInt32(cache_config_agg_write_backlog, "proxy.config.cache.agg_write_backlog");
   Debug("cache_init", "proxy.config.cache.agg_write_backlog = %d", cache_config_agg_write_backlog);
 
+  REC_ReadConfigInt32(cache_config_agg_write_max_in_flight, "proxy.config.cache.agg_write.max_in_flight");
+  cache_config_agg_write_max_in_flight = std::clamp(cache_config_agg_write_max_in_flight, 1, AGG_WRITES_MAX);
+  Debug("cache_init", "proxy.config.cache.agg_write.max_in_flight = %d", cache_config_agg_write_max_in_flight);
+
   REC_EstablishStaticConfigInt32(cache_config_enable_checksum, "proxy.config.cache.enable_checksum");
   Debug("cache_init", "proxy.config.cache.enable_checksum = %d", cache_config_enable_checksum);
 
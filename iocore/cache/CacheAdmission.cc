@@ -0,0 +1,132 @@
+/** @file
+
+  Cache write admission and recycling of popular objects
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  @section details Details
+
+  A volume with admit_hits in volume.config writes an object larger than its admit_size only once
+  it saw that many writes of it, so objects requested once do not push out the objects that are
+  requested again, nor use up the write bandwidth of the device. The writes are counted in a
+  count-min sketch per stripe.
+
+  The stripe writes are cyclic, everything in front of the write cursor is overwritten unless it is
+  evacuated. With proxy.config.cache.hit_evacuate_reads the small objects that were read that many
+  times since they were written are evacuated when the write cursor gets to them, like pinned
+  objects are, so popular small objects stay in the cache as the large ones go round.
+ */
+
+#include "P_Cache.h"
+
+#define ADMIT_SKETCH_WIDTH (1 << 16)
+#define ADMIT_SKETCH_DEPTH 2
+// Halve the write counts after this many writes so that they follow what is requested now.
+#define ADMIT_SKETCH_AGE (4 * ADMIT_SKETCH_WIDTH)
+
+#define RECYCLE_HITS_ENTRIES (1 << 16)
+#define RECYCLE_HITS_AGE (4 * RECYCLE_HITS_ENTRIES)
+
+/*
+ * Whether the new object @a vc is about to write, of @a size bytes or -1 if unknown, is admitted
+ * to its volume. The volume lock is only tried, the writes are admitted when it is busy.
+ */
+bool
+cache_write_admit(CacheVC *vc, int64_t size)
+{
+  Vol *vol          = vc->vol;
+  ProxyMutex *mutex = vc->mutex.get();
+  CacheVol *cp      = vol->cache_vol;
+
+  if (cp->admit_hits <= 1 || (size >= 0 && size <= cp->admit_size)) {
+    return true;
+  }
+  CACHE_TRY_LOCK(lock, vol->mutex, mutex->thread_holding);
+  if (!lock.is_locked()) {
+    return true;
+  }
+  if (!vol->admit_sketch) {
+    vol->admit_sketch = static_cast<uint8_t *>(ats_calloc(ADMIT_SKETCH_WIDTH * ADMIT_SKETCH_DEPTH, sizeof(uint8_t)));
+  }
+  if (++vol->admit_sketch_age >= ADMIT_SKETCH_AGE) {
+    for (int i = 0; i < ADMIT_SKETCH_WIDTH * ADMIT_SKETCH_DEPTH; i++) {
+      vol->admit_sketch[i] >>= 1;
+    }
+    vol->admit_sketch_age = 0;
+  }
+
+  int writes = UINT8_MAX;
+  for (int row = 0; row < ADMIT_SKETCH_DEPTH; row++) {
+    uint8_t &count = vol->admit_sketch[row * ADMIT_SKETCH_WIDTH + (vc->first_key.slice32(row) & (ADMIT_SKETCH_WIDTH - 1))];
+    if (count < UINT8_MAX) {
+      ++count;
+    }
+    writes = std::min(writes, static_cast<int>(count));
+  }
+  if (writes >= cp->admit_hits) {
+    return true;
+  }
+  CACHE_INCREMENT_DYN_STAT(cache_write_admission_rejects_stat);
+  return false;
+}
+
+/*
+ * Counts a read hit of the single fragment object @a vc, in its volume which is locked.
+ */
+void
+cache_recycle_read_hit(CacheVC *vc)
+{
+  Vol *vol = vc->vol;
+
+  if (!cache_config_hit_evacuate_reads || !vc->f.single_fragment ||
+      (cache_config_hit_evacuate_size_limit && vc->doc_len > static_cast<uint64_t>(cache_config_hit_evacuate_size_limit))) {
+    return;
+  }
+  if (!vol->recycle_hits) {
+    vol->recycle_hits = static_cast<uint8_t *>(ats_calloc(RECYCLE_HITS_ENTRIES, sizeof(uint8_t)));
+  }
+  if (++vol->recycle_hits_age >= RECYCLE_HITS_AGE) {
+    for (int i = 0; i < RECYCLE_HITS_ENTRIES; i++) {
+      vol->recycle_hits[i] >>= 1;
+    }
+    vol->recycle_hits_age = 0;
+  }
+  uint8_t &hits = vol->recycle_hits[dir_offset(&vc->dir) % RECYCLE_HITS_ENTRIES];
+  if (hits < UINT8_MAX) {
+    ++hits;
+  }
+}
+
+/*
+ * Whether the object of @a dir in @a vol was read often enough to be evacuated rather than
+ * overwritten. The counts are by offset, an evacuated object starts again from none.
+ */
+bool
+cache_recycle_popular(Vol *vol, const Dir *dir)
+{
+  if (!vol->recycle_hits || dir_approx_size(dir) > cache_config_target_fragment_size) {
+    return false;
+  }
+  uint8_t &hits = vol->recycle_hits[dir_offset(dir) % RECYCLE_HITS_ENTRIES];
+  if (hits < cache_config_hit_evacuate_reads) {
+    return false;
+  }
+  hits = 0;
+  return true;
+}
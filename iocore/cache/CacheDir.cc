@@ -102,6 +102,7 @@ OpenDir::open_write(CacheVC *cont, int allow_if_writers, int max_writers)
   cont->od           = od;
   cont->write_vector = &od->vector;
   bucket[b].push(od);
+  bucket_entries[b].fetch_add(1, std::memory_order_release);
   return 1;
 }
 
@@ -141,8 +142,8 @@ OpenDir::close_write(CacheVC *cont)
     unsigned int h = cont->first_key.slice32(0);
     int b          = h % OPEN_DIR_BUCKETS;
     bucket[b].remove(cont->od);
-    delayed_readers.append(cont->od->readers);
-    signal_readers(0, nullptr);
+    bucket_entries[b].fetch_sub(1, std::memory_order_release);
+    cont->od->wake_readers();
     cont->od->vector.clear();
     THREAD_FREE(cont->od, openDirEntryAllocator, cont->mutex->thread_holding);
   }
@@ -174,6 +175,34 @@ OpenDirEntry::wait(CacheVC *cont, int msec)
   return EVENT_CONT;
 }
 
+/*
+   The wait flag of a reader is only changed under the volume lock, so a
+   reader whose mutex can not be taken is running and sees it cleared once
+   it has the lock. Otherwise its backstop timer is replaced by an event
+   now, on the thread it was scheduled on.
+   */
+void
+OpenDirEntry::wake_readers()
+{
+  EThread *t = this_ethread();
+  CacheVC *c = nullptr;
+  while ((c = readers.pop())) {
+    c->f.open_read_timeout = 0;
+    c->writer_lock_retry   = 0; // progress was made, the retries count from here
+    CACHE_TRY_LOCK(lock, c->mutex, t);
+    if (!lock.is_locked()) {
+      continue;
+    }
+    EThread *ct = c->trigger ? c->trigger->ethread : t;
+    c->cancel_trigger();
+    c->trigger = ct->schedule_imm(c, EVENT_INTERVAL);
+
+    ProxyMutex *mutex = c->mutex.get();
+    Vol *vol          = c->vol;
+    CACHE_INCREMENT_DYN_STAT(cache_read_busy_wakeups_stat);
+  }
+}
+
 //
 // Cache Directory
 //
@@ -214,6 +243,7 @@ dir_bucket_loop_check(Dir *start_dir, Dir *seg)
 void
 dir_init_segment(int s, Vol *d)
 {
+  dir_segment_dirty(d, s);
   d->header->freelist[s] = 0;
   Dir *seg               = d->dir_segment(s);
   int l, b;
@@ -224,6 +254,9 @@ dir_init_segment(int s, Vol *d)
       dir_free_entry(dir_bucket_row(bucket, l), s, d);
     }
   }
+  for (b = 0; b < d->buckets; b++) {
+    dir_tag_index_update(d, s, b);
+  }
 }
 
 // break the infinite loop in directory entries
@@ -255,6 +288,19 @@ dir_freelist_length(Vol *d, int s)
   return free;
 }
 
+// Break any loop in the buckets and the freelist of segment s, it is cleared if it has one.
+void
+dir_check_segment(int s, Vol *d)
+{
+  Dir *seg = d->dir_segment(s);
+  for (int b = 0; b < d->buckets; b++) {
+    if (dir_bucket_loop_fix(dir_bucket(b, seg), s, d)) {
+      return;
+    }
+  }
+  dir_freelist_length(d, s);
+}
+
 int
 dir_bucket_length(Dir *b, int s, Vol *d)
 {
@@ -302,6 +348,7 @@ inline void
 unlink_from_freelist(Dir *e, int s, Vol *d)
 {
   Dir *seg = d->dir_segment(s);
+  dir_segment_dirty(d, s);
   Dir *p   = dir_from_offset(dir_prev(e), seg);
   if (p) {
     dir_set_next(p, dir_next(e));
@@ -317,9 +364,9 @@ unlink_from_freelist(Dir *e, int s, Vol *d)
 inline Dir *
 dir_delete_entry(Dir *e, Dir *p, int s, Vol *d)
 {
-  Dir *seg         = d->dir_segment(s);
-  int no           = dir_next(e);
-  d->header->dirty = 1;
+  Dir *seg = d->dir_segment(s);
+  int no   = dir_next(e);
+  dir_segment_dirty(d, s);
   if (p) {
     unsigned int fo = d->header->freelist[s];
     unsigned int eo = dir_to_offset(e, seg);
@@ -367,6 +414,7 @@ dir_clean_bucket(Dir *b, int s, Vol *vol)
       }
       if (dir_offset(e)) {
         CACHE_DEC_DIR_USED(vol->mutex);
+        dir_bloom_update(vol, s, (b - seg) / DIR_DEPTH, dir_tag(e), -1);
       }
       e = dir_delete_entry(e, p, s, vol);
       continue;
@@ -382,6 +430,7 @@ dir_clean_segment(int s, Vol *d)
   Dir *seg = d->dir_segment(s);
   for (int64_t i = 0; i < d->buckets; i++) {
     dir_clean_bucket(dir_bucket(i, seg), s, d);
+    dir_tag_index_update(d, s, i);
     ink_assert(!dir_next(dir_bucket(i, seg)) || dir_offset(dir_bucket(i, seg)));
   }
 }
@@ -453,6 +502,7 @@ freelist_pop(int s, Vol *d)
     freelist_clean(s, d);
     return nullptr;
   }
+  dir_segment_dirty(d, s);
   d->header->freelist[s] = dir_next(e);
   // if the freelist if bad, punt.
   if (dir_offset(e)) {
@@ -525,6 +575,7 @@ dir_free_entry(Dir *e, int s, Vol *d)
   Dir *seg        = d->dir_segment(s);
   unsigned int fo = d->header->freelist[s];
   unsigned int eo = dir_to_offset(e, seg);
+  dir_segment_dirty(d, s);
   dir_set_next(e, fo);
   if (fo) {
     dir_set_prev(dir_from_offset(fo, seg), eo);
@@ -546,6 +597,17 @@ dir_probe(const CacheKey *key, Vol *d, Dir *result, Dir **last_collision)
   if (dir_bucket_loop_fix(dir_bucket(b, seg), s, d))
     return 0;
 #endif
+  // A collision must be found in the chain again, only a fresh probe can use the filter or the index.
+  if (d->dir_bloom && !collision &&
+      !dir_bloom_match(d->dir_bloom, d->dir_bloom_mask,
+                       dir_bloom_hash(static_cast<uint64_t>(s) * d->buckets + b, DIR_MASK_TAG(key->slice32(2))))) {
+    DDebug("dir_probe_miss", "filter missed %X %X on vol %d bucket %d", key->slice32(0), key->slice32(1), d->fd, b);
+    return 0;
+  }
+  if (d->tag_index && !collision && !dir_tag_bucket_match(d->tag_index + s * d->buckets + b, DIR_MASK_TAG(key->slice32(2)))) {
+    DDebug("dir_probe_miss", "index missed %X %X on vol %d bucket %d", key->slice32(0), key->slice32(1), d->fd, b);
+    return 0;
+  }
 Lagain:
   e = dir_bucket(b, seg);
   if (dir_offset(e)) {
@@ -577,7 +639,9 @@ Lagain:
           return 1;
         } else { // delete the invalid entry
           CACHE_DEC_DIR_USED(d->mutex);
+          dir_bloom_update(d, s, b, dir_tag(e), -1);
           e = dir_delete_entry(e, p, s, d);
+          dir_tag_index_update(d, s, b);
           continue;
         }
       } else {
@@ -647,8 +711,10 @@ Lfill:
   ink_assert(d->vol_offset(e) < (d->skip + d->len));
   DDebug("dir_insert", "insert %p %X into vol %d bucket %d at %p tag %X %X boffset %" PRId64 "", e, key->slice32(0), d->fd, bi, e,
          key->slice32(1), dir_tag(e), dir_offset(e));
+  dir_tag_index_update(d, s, bi);
+  dir_bloom_update(d, s, bi, dir_tag(e), 1);
   CHECK_DIR(d);
-  d->header->dirty = 1;
+  dir_segment_dirty(d, s);
   CACHE_INC_DIR_USED(d->mutex);
   return 1;
 }
@@ -724,8 +790,12 @@ Lfill:
   ink_assert(d->vol_offset(e) < d->skip + d->len);
   DDebug("dir_overwrite", "overwrite %p %X into vol %d bucket %d at %p tag %X %X boffset %" PRId64 "", e, key->slice32(0), d->fd,
          bi, e, t, dir_tag(e), dir_offset(e));
+  dir_tag_index_update(d, s, bi);
+  if (!res) {
+    dir_bloom_update(d, s, bi, t, 1);
+  }
   CHECK_DIR(d);
-  d->header->dirty = 1;
+  dir_segment_dirty(d, s);
   return res;
 }
 
@@ -755,7 +825,9 @@ dir_delete(const CacheKey *key, Vol *d, Dir *del)
 #endif
       if (dir_compare_tag(e, key) && dir_offset(e) == dir_offset(del)) {
         CACHE_DEC_DIR_USED(d->mutex);
+        dir_bloom_update(d, s, b, dir_tag(e), -1);
         dir_delete_entry(e, p, s, d);
+        dir_tag_index_update(d, s, b);
         CHECK_DIR(d);
         return 1;
       }
@@ -767,6 +839,122 @@ dir_delete(const CacheKey *key, Vol *d, Dir *del)
   return 0;
 }
 
+// Tag index
+
+void
+dir_tag_index_update(Vol *d, int s, int b)
+{
+  if (!d->tag_index) {
+    return;
+  }
+  DirTagBucket *tb = d->tag_index + s * d->buckets + b;
+  Dir *seg         = d->dir_segment(s);
+  Dir *e           = dir_bucket(b, seg);
+  int n            = 0;
+
+  for (auto &t : tb->tag) {
+    t = DIR_TAG_INDEX_NONE;
+  }
+  if (dir_offset(e)) {
+    do {
+      // Chains too long to index (or looping) are always walked.
+      if (n == DIR_TAG_INDEX_TAGS) {
+        tb->count = DIR_TAG_INDEX_NONE;
+        return;
+      }
+      tb->tag[n++] = dir_tag(e);
+      e            = next_dir(e, seg);
+    } while (e);
+  }
+  tb->count = n;
+}
+
+void
+dir_tag_index_build(Vol *d)
+{
+  if (!d->tag_index) {
+    if (!cache_config_dir_tag_index) {
+      return;
+    }
+    size_t len   = sizeof(DirTagBucket) * d->segments * d->buckets;
+    d->tag_index = static_cast<DirTagBucket *>(ats_memalign(64, len));
+    Debug("cache_init", "Vol %s: allocating %zu bytes for the directory tag index", d->hash_text.get(), len);
+  }
+  for (int s = 0; s < d->segments; s++) {
+    for (int b = 0; b < d->buckets; b++) {
+      dir_tag_index_update(d, s, b);
+    }
+  }
+}
+
+// Bloom filter
+
+/*
+   Entries are counted from when they are inserted until they are deleted from their chain. The
+   bulk deletes (dir_clear_range, the purge of an overflowing segment) leave them counted, which
+   costs false positives, never false negatives. It is read without the volume lock, the counters
+   are only changed with it held.
+ */
+void
+dir_bloom_build(Vol *d)
+{
+  if (!d->dir_bloom) {
+    if (!cache_config_dir_bloom_filter) {
+      return;
+    }
+    uint64_t n = 2;
+    while (n < static_cast<uint64_t>(d->direntries()) * cache_config_dir_bloom_filter) {
+      n <<= 1;
+    }
+    d->dir_bloom_mask = n - 1;
+    d->dir_bloom      = new std::atomic<uint8_t>[n / 2]();
+    Debug("cache_init", "Vol %s: allocating %" PRIu64 " bytes for the directory Bloom filter", d->hash_text.get(), n / 2);
+  } else {
+    for (uint64_t i = 0; i <= d->dir_bloom_mask / 2; i++) {
+      d->dir_bloom[i].store(0, std::memory_order_relaxed);
+    }
+  }
+  for (int s = 0; s < d->segments; s++) {
+    Dir *seg = d->dir_segment(s);
+    for (int b = 0; b < d->buckets; b++) {
+      Dir *e = dir_bucket(b, seg);
+      if (!dir_offset(e)) {
+        continue;
+      }
+      int n = 0;
+      do {
+        // Same as dir_clean_bucket, an entry still in a chain without an offset is not counted.
+        if (dir_offset(e)) {
+          dir_bloom_update(d, s, b, dir_tag(e), 1);
+        }
+        e = next_dir(e, seg);
+      } while (e && ++n < d->buckets * DIR_DEPTH);
+    }
+  }
+}
+
+void
+dir_bloom_update(Vol *d, int s, int b, uint32_t tag, int delta)
+{
+  if (!d->dir_bloom) {
+    return;
+  }
+  uint64_t h    = dir_bloom_hash(static_cast<uint64_t>(s) * d->buckets + b, tag);
+  uint64_t step = (h >> 32) | 1;
+  for (int i = 0; i < DIR_BLOOM_HASHES; i++, h += step) {
+    uint64_t c                 = h & d->dir_bloom_mask;
+    std::atomic<uint8_t> &pair = d->dir_bloom[c >> 1];
+    int shift                  = (c & 1) << 2;
+    uint8_t v                  = pair.load(std::memory_order_relaxed);
+    int n                      = (v >> shift) & DIR_BLOOM_COUNT_MAX;
+    // A saturated counter no longer knows how many entries it counts.
+    if (n == DIR_BLOOM_COUNT_MAX || n + delta < 0) {
+      continue;
+    }
+    pair.store((v & ~(DIR_BLOOM_COUNT_MAX << shift)) | ((n + delta) << shift), std::memory_order_relaxed);
+  }
+}
+
 // Lookaside Cache
 
 int
@@ -942,6 +1130,8 @@ sync_cache_dir_on_shutdown()
   size_t buflen = 0;
   bool buf_huge = false;
 
+  ram_cache_snapshot_save();
+
   EThread *t = (EThread *)0xdeadbeef;
   for (int i = 0; i < gnvol; i++) {
     // the process is going down, do a blocking call
@@ -954,6 +1144,10 @@ sync_cache_dir_on_shutdown()
       Debug("cache_dir_sync", "Dir %s: ignoring -- bad disk", d->hash_text.get());
       continue;
     }
+    if (!d->dir_ready) {
+      Debug("cache_dir_sync", "Dir %s: ignoring -- not loaded", d->hash_text.get());
+      continue;
+    }
     size_t dirlen = d->dirlen();
     ink_assert(dirlen > 0); // make clang happy - if not > 0 the vol is seriously messed up
     if (!d->header->dirty && !d->dir_sync_in_progress) {
@@ -966,21 +1160,27 @@ sync_cache_dir_on_shutdown()
     // check if we have data in the agg buffer
     // dont worry about the cachevc s in the agg queue
     // directories have not been inserted for these writes
-    if (d->agg_buf_pos) {
+    if (d->agg_buf_pos || d->agg_writes_in_flight) {
       Debug("cache_dir_sync", "Dir %s: flushing agg buffer first", d->hash_text.get());
 
-      // set write limit
-      d->header->agg_pos = d->header->write_pos + d->agg_buf_pos;
-
-      int r = pwrite(d->fd, d->agg_buffer, d->agg_buf_pos, d->header->write_pos);
-      if (r != d->agg_buf_pos) {
+      // the writes in flight may not land before the process exits, they are written again
+      bool ok = true;
+      for (int w = 0; ok && w < d->agg_writes_in_flight; w++) {
+        AggWrite *aw = &d->agg_writes[(d->agg_write_head + w) % d->agg_writes_max];
+        ssize_t n    = aw->io.aiocb.aio_nbytes;
+        ok           = pwrite(d->fd, aw->buffer, n, aw->io.aiocb.aio_offset) == n;
+      }
+      if (!ok || pwrite(d->fd, d->agg_buffer, d->agg_buf_pos, d->header->agg_pos) != d->agg_buf_pos) {
         ink_assert(!"flushing agg buffer failed");
         continue;
       }
+      // set write limit
+      d->header->agg_pos += d->agg_buf_pos;
+
       d->header->last_write_pos = d->header->write_pos;
-      d->header->write_pos += d->agg_buf_pos;
-      ink_assert(d->header->write_pos == d->header->agg_pos);
-      d->agg_buf_pos = 0;
+      d->header->write_pos      = d->header->agg_pos;
+      d->agg_buf_pos            = 0;
+      d->agg_writes_in_flight   = 0;
       d->header->write_serial++;
     }
 
@@ -1030,6 +1230,76 @@ sync_cache_dir_on_shutdown()
   }
 }
 
+/*
+ * Find the next part of the directory body at or after *pos which the copy being synced is
+ * missing: the rest of the header with the freelists, then each run of segments marked
+ * DIR_SYNC_PENDING. The range is store block aligned and can spill into clean neighbour
+ * segments, which is harmless as their contents match the copy on disk.
+ */
+static bool
+dir_sync_next_range(Vol *vol, off_t *pos, off_t *end)
+{
+  off_t dir_start = vol->headerlen();
+  off_t dir_end   = vol->dirlen() - ROUND_TO_STORE_BLOCK(sizeof(VolHeaderFooter));
+  off_t seg_len   = vol->buckets * DIR_DEPTH * SIZEOF_DIR;
+
+  if (*pos < dir_start) {
+    *end = dir_start;
+    return true;
+  }
+  int s = (*pos - dir_start) / seg_len;
+  while (s < vol->segments && !(vol->dirty_segments[s] & DIR_SYNC_PENDING)) {
+    s++;
+  }
+  if (s >= vol->segments) {
+    return false;
+  }
+  int last = s;
+  while (last < vol->segments && (vol->dirty_segments[last] & DIR_SYNC_PENDING)) {
+    last++;
+  }
+  *pos = std::max(*pos, static_cast<off_t>(ROUND_DOWN_TO_STORE_BLOCK(dir_start + s * seg_len)));
+  *end = std::min(static_cast<off_t>(ROUND_TO_STORE_BLOCK(dir_start + last * seg_len)), dir_end);
+  return true;
+}
+
+/*
+ * Pick the segments which have to be written to directory copy @a B and snapshot them, along with
+ * the header and footer, into @a buf. Segments still pending from a sync that did not complete
+ * are assumed to be missing from both copies. Returns the number of segments to write.
+ */
+static int
+dir_sync_begin(Vol *vol, int B, char *buf)
+{
+  int pending = 0;
+  for (int s = 0; s < vol->segments; s++) {
+    uint8_t &state = vol->dirty_segments[s];
+    if (state & DIR_SYNC_PENDING) {
+      state = DIR_SYNC_ALL;
+    }
+    if (state & DIR_SYNC_COPY(B)) {
+      state = (state & ~DIR_SYNC_COPY(B)) | DIR_SYNC_PENDING;
+      pending++;
+    }
+  }
+  int footerlen = ROUND_TO_STORE_BLOCK(sizeof(VolHeaderFooter));
+  off_t dirlen  = vol->dirlen();
+  memcpy(buf, vol->raw_dir, footerlen);
+  memcpy(buf + dirlen - footerlen, vol->raw_dir + dirlen - footerlen, footerlen);
+  for (off_t pos = footerlen, end = 0; dir_sync_next_range(vol, &pos, &end); pos = end) {
+    memcpy(buf + pos, vol->raw_dir + pos, end - pos);
+  }
+  return pending;
+}
+
+static void
+dir_sync_done(Vol *vol)
+{
+  for (int s = 0; s < vol->segments; s++) {
+    vol->dirty_segments[s] &= ~DIR_SYNC_PENDING;
+  }
+}
+
 int
 CacheSync::mainEvent(int event, Event *e)
 {
@@ -1088,7 +1358,7 @@ Lrestart:
     // recompute hit_evacuate_window
     vol->hit_evacuate_window = (vol->data_blocks * cache_config_hit_evacuate_percent) / 100;
 
-    if (DISK_BAD(vol->disk)) {
+    if (DISK_BAD(vol->disk) || !vol->dir_ready) {
       goto Ldone;
     }
 
@@ -1107,7 +1377,7 @@ Lrestart:
         Debug("cache_dir_sync", "Dir %s not dirty", vol->hash_text.get());
         goto Ldone;
       }
-      if (vol->is_io_in_progress() || vol->agg_buf_pos) {
+      if (vol->is_io_in_progress() || vol->agg_buf_pos || vol->agg_writes_in_flight) {
         Debug("cache_dir_sync", "Dir %s: waiting for agg buffer", vol->hash_text.get());
         vol->dir_sync_waiting = true;
         if (!vol->is_io_in_progress()) {
@@ -1139,22 +1409,25 @@ Lrestart:
       vol->header->sync_serial++;
       vol->footer->sync_serial = vol->header->sync_serial;
       CHECK_DIR(d);
-      memcpy(buf, vol->raw_dir, dirlen);
+      int pending = dir_sync_begin(vol, vol->header->sync_serial & 1, buf);
+      Debug("cache_dir_sync", "Dir %s: %d of %d segments changed", vol->hash_text.get(), pending, vol->segments);
       vol->dir_sync_in_progress = true;
     }
     size_t B    = vol->header->sync_serial & 1;
     off_t start = vol->skip + (B ? dirlen : 0);
+    off_t end   = 0;
 
+    if (writepos && writepos < static_cast<off_t>(dirlen) - headerlen && !dir_sync_next_range(vol, &writepos, &end)) {
+      // the rest of the body is already on disk
+      writepos = dirlen - headerlen;
+    }
     if (!writepos) {
       // write header
       aio_write(vol->fd, buf + writepos, headerlen, start + writepos);
       writepos += headerlen;
     } else if (writepos < static_cast<off_t>(dirlen) - headerlen) {
       // write part of body
-      int l = SYNC_MAX_WRITE;
-      if (writepos + l > static_cast<off_t>(dirlen) - headerlen) {
-        l = dirlen - headerlen - writepos;
-      }
+      int l = std::min(end - writepos, static_cast<off_t>(SYNC_MAX_WRITE));
       aio_write(vol->fd, buf + writepos, l, start + writepos);
       writepos += l;
     } else if (writepos < static_cast<off_t>(dirlen)) {
@@ -1163,6 +1436,7 @@ Lrestart:
       aio_write(vol->fd, buf + writepos, headerlen, start + writepos);
       writepos += headerlen;
     } else {
+      dir_sync_done(vol);
       vol->dir_sync_in_progress = false;
       CACHE_INCREMENT_DYN_STAT(cache_directory_sync_count_stat);
       CACHE_SUM_DYN_STAT(cache_directory_sync_time_stat, Thread::get_hrtime() - start_time);
@@ -1411,6 +1685,7 @@ dir_corrupt_bucket(Dir *b, int s, Vol *d)
   }
   ink_release_assert(e);
   dir_set_next(e, dir_to_offset(e, seg));
+  dir_segment_dirty(d, s);
 }
 
 EXCLUSIVE_REGRESSION_TEST(Cache_dir)(RegressionTest *t, int /* atype ATS_UNUSED */, int *status)
@@ -1447,6 +1722,7 @@ EXCLUSIVE_REGRESSION_TEST(Cache_dir)(RegressionTest *t, int /* atype ATS_UNUSED
 
   // test insert
   rprintf(t, "insert test\n", free);
+  memset(d->dirty_segments, 0, d->segments);
   int inserted = 0;
   int free     = dir_freelist_length(d, s);
   int n        = free;
@@ -1461,6 +1737,14 @@ EXCLUSIVE_REGRESSION_TEST(Cache_dir)(RegressionTest *t, int /* atype ATS_UNUSED
   if (static_cast<unsigned int>(inserted - free) > 1) {
     ret = REGRESSION_TEST_FAILED;
   }
+  // only the changed segment has to be synced, to both copies
+  for (i = 0; i < d->segments; i++) {
+    if (d->dirty_segments[i] != (i == s ? DIR_SYNC_ALL : 0)) {
+      rprintf(t, "segment %d sync state %d\n", i, d->dirty_segments[i]);
+      ret = REGRESSION_TEST_FAILED;
+    }
+  }
+  memset(d->dirty_segments, DIR_SYNC_ALL, d->segments);
 
   // test delete
   rprintf(t, "delete test\n");
@@ -1506,6 +1790,59 @@ EXCLUSIVE_REGRESSION_TEST(Cache_dir)(RegressionTest *t, int /* atype ATS_UNUSED
     rprintf(t, "probe rate = %d / second\n", static_cast<int>((newfree * static_cast<uint64_t>(1000000)) / us));
   }
 
+  // test the tag index gives the same answers as walking the chains
+  rprintf(t, "tag index test\n");
+  DirTagBucket *saved_index  = d->tag_index;
+  int saved_config           = cache_config_dir_tag_index;
+  d->tag_index               = nullptr;
+  cache_config_dir_tag_index = 1;
+  dir_tag_index_build(d);
+  regress_rand_init(13);
+  for (i = 0; i < newfree; i++) {
+    Dir *last_collision = nullptr;
+    regress_rand_CacheKey(&key);
+    if (!dir_probe(&key, d, &dir, &last_collision)) {
+      ret = REGRESSION_TEST_FAILED;
+    }
+  }
+  for (i = 0; i < newfree; i++) {
+    Dir *last_collision = nullptr;
+    regress_rand_CacheKey(&key);
+    int indexed         = dir_probe(&key, d, &dir, &last_collision);
+    DirTagBucket *index = d->tag_index;
+    d->tag_index        = nullptr;
+    last_collision      = nullptr;
+    int walked          = dir_probe(&key, d, &dir, &last_collision);
+    d->tag_index        = index;
+    if (indexed != walked) {
+      ret = REGRESSION_TEST_FAILED;
+    }
+  }
+  ats_memalign_free(d->tag_index);
+  d->tag_index               = saved_index;
+  cache_config_dir_tag_index = saved_config;
+
+  // test the Bloom filter never rules out a key that is in the directory
+  rprintf(t, "bloom filter test\n");
+  std::atomic<uint8_t> *saved_bloom = d->dir_bloom;
+  uint64_t saved_bloom_mask         = d->dir_bloom_mask;
+  saved_config                      = cache_config_dir_bloom_filter;
+  d->dir_bloom                      = nullptr;
+  cache_config_dir_bloom_filter     = 8;
+  dir_bloom_build(d);
+  regress_rand_init(13);
+  for (i = 0; i < newfree; i++) {
+    Dir *last_collision = nullptr;
+    regress_rand_CacheKey(&key);
+    if (!d->dir_bloom_may_contain(&key) || !dir_probe(&key, d, &dir, &last_collision)) {
+      ret = REGRESSION_TEST_FAILED;
+    }
+  }
+  delete[] d->dir_bloom;
+  d->dir_bloom                  = saved_bloom;
+  d->dir_bloom_mask             = saved_bloom_mask;
+  cache_config_dir_bloom_filter = saved_config;
+
   for (int c = 0; c < d->direntries() * 0.75; c++) {
     regress_rand_CacheKey(&key);
     dir_insert(&key, d, &dir);
@@ -90,6 +90,16 @@ CacheHostMatcher::AllocateSpace(int num_entries)
   num_el    = 0;
 }
 
+// void CacheHostMatcher::BuildIndex()
+//
+//   Called once all the entries are in
+//
+void
+CacheHostMatcher::BuildIndex()
+{
+  host_lookup->BuildIndex();
+}
+
 // void CacheHostMatcher::Match(RequestData* rdata, Result* result)
 //
 //  Searches our tree and updates argresult for each element matching
@@ -194,6 +204,9 @@ CacheHostTable::CacheHostTable(Cache *c, CacheType typ)
   ink_release_assert(config_path);
 
   m_numEntries = this->BuildTable(config_path);
+  for (int t = 1; t < CACHE_TIER_MAX; t++) {
+    tier_host_rec[t].Init(type, t);
+  }
 }
 
 CacheHostTable::~CacheHostTable()
@@ -388,6 +401,10 @@ CacheHostTable::BuildTableFromString(const char *config_file_path, char *file_bu
 
   ink_assert(second_pass == numEntries);
 
+  if (hostMatch != nullptr) {
+    hostMatch->BuildIndex();
+  }
+
   if (is_debug_tag_set("matcher")) {
     Print();
   }
@@ -416,7 +433,7 @@ CacheHostTable::BuildTable(const char *config_file_path)
 }
 
 int
-CacheHostRecord::Init(CacheType typ)
+CacheHostRecord::Init(CacheType typ, int tier)
 {
   int i, j;
   extern Queue<CacheVol> cp_list;
@@ -429,15 +446,19 @@ CacheHostRecord::Init(CacheType typ)
   num_cachevols    = 0;
   CacheVol *cachep = cp_list.head;
   for (; cachep; cachep = cachep->link.next) {
-    if (cachep->scheme == type) {
-      Debug("cache_hosting", "Host Record: %p, Volume: %d, size: %" PRId64, this, cachep->vol_number, (int64_t)cachep->size);
+    if (cachep->scheme == type && cachep->tier == tier) {
+      Debug("cache_hosting", "Host Record: %p, Volume: %d, tier: %d, size: %" PRId64, this, cachep->vol_number, tier,
+            (int64_t)cachep->size);
       cp[num_cachevols] = cachep;
       num_cachevols++;
       num_vols += cachep->num_vols;
     }
   }
   if (!num_cachevols) {
-    RecSignalWarning(REC_SIGNAL_CONFIG_ERROR, "error: No volumes found for Cache Type %d", type);
+    // Faster tiers are optional.
+    if (tier == 0) {
+      RecSignalWarning(REC_SIGNAL_CONFIG_ERROR, "error: No volumes found for Cache Type %d", type);
+    }
     return -1;
   }
   vols        = static_cast<Vol **>(ats_malloc(num_vols * sizeof(Vol *)));
@@ -522,6 +543,12 @@ CacheHostRecord::Init(matcher_line *line_info, CacheType typ)
           for (; cachep; cachep = cachep->link.next) {
             if (cachep->vol_number == volume_number) {
               is_vol_present = 1;
+              if (cachep->tier != 0) {
+                RecSignalWarning(REC_SIGNAL_CONFIG_ERROR, "%s discarding %s entry at line %d : volume %d is a tier %d volume",
+                                 "[CacheHosting]", config_file, line_info->line_num, volume_number, cachep->tier);
+                ats_free(val);
+                return -1;
+              }
               if (cachep->scheme == type) {
                 Debug("cache_hosting", "Host Record: %p, Volume: %d, size: %ld", this, volume_number,
                       (long)(cachep->size * STORE_BLOCK_SIZE));
@@ -657,6 +684,9 @@ ConfigVolumes::BuildListFromString(char *config_file_path, char *file_buf)
     int size              = 0;
     int in_percent        = 0;
     bool ramcache_enabled = true;
+    int tier              = 0;
+    int admit_hits        = 0;
+    int64_t admit_size    = 0;
 
     while (true) {
       // skip all blank spaces at beginning of line
@@ -756,6 +786,36 @@ ConfigVolumes::BuildListFromString(char *config_file_path, char *file_buf)
           err = "Unexpected end of line";
           break;
         }
+      } else if (strcasecmp(tmp, "tier") == 0) { // match tier
+        tmp += 5;
+        tier = atoi(tmp);
+        if (!ParseRules::is_digit(*tmp) || tier >= CACHE_TIER_MAX) {
+          err = "Bad Tier";
+          break;
+        }
+        while (ParseRules::is_digit(*tmp)) {
+          tmp++;
+        }
+      } else if (strcasecmp(tmp, "admit_hits") == 0) { // match admit_hits
+        tmp += 11;
+        admit_hits = atoi(tmp);
+        if (!ParseRules::is_digit(*tmp) || admit_hits > UINT8_MAX) {
+          err = "Bad Admission Hits";
+          break;
+        }
+        while (ParseRules::is_digit(*tmp)) {
+          tmp++;
+        }
+      } else if (strcasecmp(tmp, "admit_size") == 0) { // match admit_size
+        tmp += 11;
+        admit_size = strtoll(tmp, nullptr, 10);
+        if (!ParseRules::is_digit(*tmp)) {
+          err = "Bad Admission Size";
+          break;
+        }
+        while (ParseRules::is_digit(*tmp)) {
+          tmp++;
+        }
       }
 
       // ends here
@@ -782,6 +842,9 @@ ConfigVolumes::BuildListFromString(char *config_file_path, char *file_buf)
       configp->size             = size;
       configp->cachep           = nullptr;
       configp->ramcache_enabled = ramcache_enabled;
+      configp->tier             = tier;
+      configp->admit_hits       = admit_hits;
+      configp->admit_size       = admit_size;
       cp_queue.enqueue(configp);
       num_volumes++;
       if (scheme == CACHE_HTTP_TYPE) {
@@ -789,8 +852,8 @@ ConfigVolumes::BuildListFromString(char *config_file_path, char *file_buf)
       } else {
         ink_release_assert(!"Unexpected non-HTTP cache volume");
       }
-      Debug("cache_hosting", "added volume=%d, scheme=%d, size=%d percent=%d, ramcache enabled=%d", volume_number, scheme, size,
-            in_percent, ramcache_enabled);
+      Debug("cache_hosting", "added volume=%d, scheme=%d, size=%d percent=%d, ramcache enabled=%d, tier=%d", volume_number, scheme,
+            size, in_percent, ramcache_enabled, tier);
     }
 
     tmp = bufTok.iterNext(&i_state);
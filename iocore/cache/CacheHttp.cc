@@ -24,6 +24,7 @@
 #include "tscore/ink_config.h"
 #include <cstring>
 #include "P_Cache.h"
+#include "HttpCompat.h"
 
 /*-------------------------------------------------------------------------
   -------------------------------------------------------------------------*/
@@ -59,6 +60,7 @@ CacheHTTPInfoVector::insert(CacheHTTPInfo *info, int index)
   }
 
   data(index).alternate.copy_shallow(info);
+  summary = nullptr;
   return index;
 }
 
@@ -75,6 +77,7 @@ CacheHTTPInfoVector::detach(int idx, CacheHTTPInfo *r)
 
   r->copy_shallow(&data[idx].alternate);
   data[idx].alternate.destroy();
+  summary = nullptr;
 
   for (i = idx; i < (xcount - 1); i++) {
     data[i] = data[i + i];
@@ -92,6 +95,7 @@ CacheHTTPInfoVector::remove(int idx, bool destroy)
   if (destroy) {
     data[idx].alternate.destroy();
   }
+  summary = nullptr;
 
   for (; idx < (xcount - 1); idx++) {
     data[idx] = data[idx + 1];
@@ -116,6 +120,7 @@ CacheHTTPInfoVector::clear(bool destroy)
   xcount = 0;
   data.clear();
   vector_buf.clear();
+  summary = nullptr;
 }
 
 /*-------------------------------------------------------------------------
@@ -170,10 +175,50 @@ CacheHTTPInfoVector::marshal_length()
   for (int i = 0; i < xcount; i++) {
     length += data[i].alternate.marshal_length();
   }
+  if (xcount) {
+    length += xcount * sizeof(CacheAltSummary) + sizeof(CacheAltSummaryTrailer);
+  }
 
   return length;
 }
 
+/*-------------------------------------------------------------------------
+  The same walk over the Vary fields as HttpTransactCache::CalcVariability.
+  -------------------------------------------------------------------------*/
+static void
+alt_summary_fill(CacheAltSummary *s, CacheHTTPInfo *alt)
+{
+  HTTPHdr *request  = alt->request_get();
+  HTTPHdr *response = alt->response_get();
+  StrList vary_list;
+
+  memset(s, 0, sizeof(*s));
+  if (!request->valid() || !response->valid() || !response->presence(MIME_PRESENCE_VARY) ||
+      response->value_get_comma_list(MIME_FIELD_VARY, MIME_LEN_VARY, &vary_list) <= 0) {
+    return;
+  }
+
+  s->vary_names = HttpCompat::vary_header_values_hash(response->field_find(MIME_FIELD_VARY, MIME_LEN_VARY));
+  for (Str *field = vary_list.head; field != nullptr; field = field->next) {
+    if (field->len == 0) {
+      continue;
+    }
+    if (field->str[0] == '*' && field->str[1] == NUL) {
+      s->nvary = CACHE_ALT_SUMMARY_VARY_ALL;
+      return;
+    }
+    if (s->nvary == CACHE_ALT_SUMMARY_VARY_MAX) {
+      s->nvary = CACHE_ALT_SUMMARY_VARY_MANY;
+      return;
+    }
+    const char *name = hdrtoken_string_to_wks(field->str, field->len);
+    if (name == nullptr) {
+      name = field->str;
+    }
+    s->vary[s->nvary++] = HttpCompat::vary_header_values_hash(request->field_find(name, field->len));
+  }
+}
+
 /*-------------------------------------------------------------------------
   -------------------------------------------------------------------------*/
 int
@@ -190,6 +235,22 @@ CacheHTTPInfoVector::marshal(char *buf, int length)
     buf += tmp;
     count++;
   }
+  if (xcount) {
+    CacheAltSummary *s = reinterpret_cast<CacheAltSummary *>(buf);
+    if (summary) {
+      // Unchanged since it was read, as when evacuating, the summaries read with it still hold.
+      memcpy(s, summary, xcount * sizeof(CacheAltSummary));
+      s += xcount;
+    } else {
+      for (int i = 0; i < xcount; i++) {
+        alt_summary_fill(s++, &data[i].alternate);
+      }
+    }
+    CacheAltSummaryTrailer *t = reinterpret_cast<CacheAltSummaryTrailer *>(s);
+    t->magic                  = CACHE_ALT_SUMMARY_MAGIC;
+    t->count                  = xcount;
+    buf                       = reinterpret_cast<char *>(t + 1);
+  }
 
   GLOBAL_CACHE_SUM_GLOBAL_DYN_STAT(cache_hdr_vector_marshal_stat, 1);
   GLOBAL_CACHE_SUM_GLOBAL_DYN_STAT(cache_hdr_marshal_stat, count);
@@ -224,18 +285,20 @@ CacheHTTPInfoVector::unmarshal(const char *buf, int length, RefCountObj *block_p
 /*-------------------------------------------------------------------------
   -------------------------------------------------------------------------*/
 uint32_t
-CacheHTTPInfoVector::get_handles(const char *buf, int length, RefCountObj *block_ptr)
+CacheHTTPInfoVector::get_handles(const char *buf, int length, RefCountObj *block_ptr, bool with_summary)
 {
   ink_assert(!(((intptr_t)buf) & 3)); // buf must be aligned
 
   const char *start = buf;
+  int alt_length    = with_summary ? alternates_length(buf, length) : length;
   CacheHTTPInfo info;
-  xcount = 0;
+  xcount  = 0;
+  summary = nullptr;
 
   vector_buf = block_ptr;
 
-  while (length - (buf - start) > static_cast<int>(sizeof(HTTPCacheAlt))) {
-    int tmp = info.get_handle(const_cast<char *>(buf), length - (buf - start));
+  while (alt_length - (buf - start) > static_cast<int>(sizeof(HTTPCacheAlt))) {
+    int tmp = info.get_handle(const_cast<char *>(buf), alt_length - (buf - start));
     if (tmp < 0) {
       ink_assert(!"CacheHTTPInfoVector::unmarshal get_handle() failed");
       return static_cast<uint32_t>(-1);
@@ -246,5 +309,29 @@ CacheHTTPInfoVector::get_handles(const char *buf, int length, RefCountObj *block
     xcount++;
   }
 
+  // The summaries only count if there is one for each alternate found.
+  if (alt_length < length && buf - start == alt_length &&
+      reinterpret_cast<const CacheAltSummaryTrailer *>(start + length - sizeof(CacheAltSummaryTrailer))->count ==
+        static_cast<uint32_t>(xcount)) {
+    summary = reinterpret_cast<const CacheAltSummary *>(buf);
+    buf     = start + length;
+  }
+
   return (const_cast<caddr_t>(buf) - const_cast<caddr_t>(start));
 }
+
+int
+CacheHTTPInfoVector::alternates_length(const char *buf, int length)
+{
+  if (length < static_cast<int>(sizeof(CacheAltSummaryTrailer))) {
+    return length;
+  }
+
+  auto t                 = reinterpret_cast<const CacheAltSummaryTrailer *>(buf + length - sizeof(CacheAltSummaryTrailer));
+  int64_t summary_length = sizeof(CacheAltSummaryTrailer) + static_cast<int64_t>(t->count) * sizeof(CacheAltSummary);
+
+  if (t->magic != CACHE_ALT_SUMMARY_MAGIC || summary_length > length) {
+    return length;
+  }
+  return length - summary_length;
+}
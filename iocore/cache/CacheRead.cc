@@ -39,6 +39,13 @@ Cache::open_read(Continuation *cont, const CacheKey *key, CacheFragType type, co
   ProxyMutex *mutex = cont->mutex.get();
   OpenDirEntry *od  = nullptr;
   CacheVC *c        = nullptr;
+  if (!vol->dir_ready) {
+    // The directory of the volume is still loading, a miss.
+    goto Lmiss;
+  }
+  if (!vol->open_dir.may_have_writer(key) && !vol->dir_bloom_may_contain(key)) {
+    goto Lbloom_miss;
+  }
   {
     CACHE_TRY_LOCK(lock, vol->mutex, mutex->thread_holding);
     if (!lock.is_locked() || (od = vol->open_read(key)) || dir_probe(key, vol, &result, &last_collision)) {
@@ -53,9 +60,13 @@ Cache::open_read(Continuation *cont, const CacheKey *key, CacheFragType type, co
       c->od                                   = od;
     }
     if (!c) {
+      if (vol->dir_bloom) {
+        CACHE_SUM_DYN_STAT(cache_dir_bloom_false_positive_rate_stat, vol->dir_bloom_may_contain(key));
+      }
       goto Lmiss;
     }
     if (!lock.is_locked()) {
+      CACHE_INCREMENT_DYN_STAT(cache_open_dir_lock_contention_stat);
       CONT_SCHED_LOCK_RETRY(c);
       return &c->_action;
     }
@@ -73,6 +84,9 @@ Cache::open_read(Continuation *cont, const CacheKey *key, CacheFragType type, co
       return &c->_action;
     }
   }
+Lbloom_miss:
+  CACHE_INCREMENT_DYN_STAT(cache_dir_bloom_negatives_stat);
+  CACHE_SUM_DYN_STAT(cache_dir_bloom_false_positive_rate_stat, 0);
 Lmiss:
   CACHE_INCREMENT_DYN_STAT(cache_read_failure_stat);
   cont->handleEvent(CACHE_EVENT_OPEN_READ_FAILED, (void *)-ECACHE_NO_DOC);
@@ -106,6 +120,14 @@ Cache::open_read(Continuation *cont, const CacheKey *key, CacheHTTPHdr *request,
   OpenDirEntry *od  = nullptr;
   CacheVC *c        = nullptr;
 
+  CACHE_INCREMENT_DYN_STAT(cache_tier_lookups_stat);
+  if (!vol->dir_ready) {
+    // The directory of the volume is still loading, a miss.
+    goto Lmiss;
+  }
+  if (!vol->open_dir.may_have_writer(key) && !vol->dir_bloom_may_contain(key)) {
+    goto Lbloom_miss;
+  }
   {
     CACHE_TRY_LOCK(lock, vol->mutex, mutex->thread_holding);
     if (!lock.is_locked() || (od = vol->open_read(key)) || dir_probe(key, vol, &result, &last_collision)) {
@@ -121,11 +143,15 @@ Cache::open_read(Continuation *cont, const CacheKey *key, CacheHTTPHdr *request,
       c->od        = od;
     }
     if (!lock.is_locked()) {
+      CACHE_INCREMENT_DYN_STAT(cache_open_dir_lock_contention_stat);
       SET_CONTINUATION_HANDLER(c, &CacheVC::openReadStartHead);
       CONT_SCHED_LOCK_RETRY(c);
       return &c->_action;
     }
     if (!c) {
+      if (vol->dir_bloom) {
+        CACHE_SUM_DYN_STAT(cache_dir_bloom_false_positive_rate_stat, vol->dir_bloom_may_contain(key));
+      }
       goto Lmiss;
     }
     if (c->od) {
@@ -135,7 +161,7 @@ Cache::open_read(Continuation *cont, const CacheKey *key, CacheHTTPHdr *request,
     c->dir = c->first_dir = result;
     c->last_collision     = last_collision;
     SET_CONTINUATION_HANDLER(c, &CacheVC::openReadStartHead);
-    switch (c->do_read_call(&c->key)) {
+    switch (c->do_tier_read_call()) {
     case EVENT_DONE:
       return ACTION_RESULT_DONE;
     case EVENT_RETURN:
@@ -144,6 +170,9 @@ Cache::open_read(Continuation *cont, const CacheKey *key, CacheHTTPHdr *request,
       return &c->_action;
     }
   }
+Lbloom_miss:
+  CACHE_INCREMENT_DYN_STAT(cache_dir_bloom_negatives_stat);
+  CACHE_SUM_DYN_STAT(cache_dir_bloom_false_positive_rate_stat, 0);
 Lmiss:
   CACHE_INCREMENT_DYN_STAT(cache_read_failure_stat);
   cont->handleEvent(CACHE_EVENT_OPEN_READ_FAILED, (void *)-ECACHE_NO_DOC);
@@ -166,11 +195,12 @@ Lcallreturn:
 uint32_t
 CacheVC::load_http_info(CacheHTTPInfoVector *info, Doc *doc, RefCountObj *block_ptr)
 {
-  uint32_t zret = info->get_handles(doc->hdr(), doc->hlen, block_ptr);
+  ts::VersionNumber version(doc->v_major, doc->v_minor);
+  uint32_t zret = info->get_handles(doc->hdr(), doc->hlen, block_ptr, version >= CACHE_DB_VERSION_ALT_SUMMARY);
   if (!this->f.doc_from_ram_cache && // ram cache is always already fixed up.
                                      // If this is an old object, the object version will be old or 0, in either case this is
-                                     // correct. Forget the 4.2 compatibility, always update older versioned objects.
-      ts::VersionNumber(doc->v_major, doc->v_minor) < CACHE_DB_VERSION) {
+                                     // correct. Forget the 4.2 compatibility, always update objects older than the fix up.
+      version < CACHE_DB_VERSION_HEAP_FIXUP) {
     for (int i = info->xcount - 1; i >= 0; --i) {
       info->data(i).alternate.m_alt->m_response_hdr.m_mime->recompute_accelerators_and_presence_bits();
       info->data(i).alternate.m_alt->m_request_hdr.m_mime->recompute_accelerators_and_presence_bits();
@@ -314,13 +344,29 @@ CacheVC::openReadFromWriter(int event, Event *e)
   intptr_t err = ECACHE_DOC_BUSY;
   DDebug("cache_read_agg", "%p: key: %X In openReadFromWriter", this, first_key.slice32(1));
   if (_action.cancelled) {
+    if (f.open_read_timeout) {
+      CACHE_TRY_LOCK(lock, vol->mutex, mutex->thread_holding);
+      if (!lock.is_locked()) {
+        VC_SCHED_LOCK_RETRY();
+      }
+      stop_waiting_for_writer();
+    }
     od = nullptr; // only open for read so no need to close
     return free_CacheVC(this);
   }
   CACHE_TRY_LOCK(lock, vol->mutex, mutex->thread_holding);
   if (!lock.is_locked()) {
+    CACHE_INCREMENT_DYN_STAT(cache_open_dir_lock_contention_stat);
+    if (!write_vc && !vol->open_dir.may_have_writer(&first_key)) {
+      // The writer is already gone, no need to wait for the lock to find that out.
+      CACHE_INCREMENT_DYN_STAT(cache_open_dir_lock_avoided_stat);
+      od = nullptr;
+      SET_HANDLER(&CacheVC::openReadStartHead);
+      return openReadStartHead(event, e);
+    }
     VC_SCHED_LOCK_RETRY();
   }
+  stop_waiting_for_writer();
   od = vol->open_read(&first_key); // recheck in case the lock failed
   if (!od) {
     MUTEX_RELEASE(lock);
@@ -354,7 +400,7 @@ CacheVC::openReadFromWriter(int event, Event *e)
     if (writer_done()) {
       MUTEX_RELEASE(lock);
       DDebug("cache_read_agg", "%p: key: %X writer %p has left, continuing as normal read", this, first_key.slice32(1), write_vc);
-      od       = nullptr;
+      od = nullptr;
       write_vc = nullptr;
       SET_HANDLER(&CacheVC::openReadStartHead);
       return openReadStartHead(event, e);
@@ -535,6 +581,7 @@ CacheVC::openReadClose(int event, Event * /* e ATS_UNUSED */)
   if (!lock.is_locked()) {
     VC_SCHED_LOCK_RETRY();
   }
+  stop_waiting_for_writer();
   if (f.hit_evacuate && dir_valid(vol, &first_dir) && closed > 0) {
     if (f.single_fragment) {
       vol->force_evacuate_head(&first_dir, dir_pinned(&first_dir));
@@ -562,6 +609,7 @@ CacheVC::openReadReadDone(int event, Event *e)
     if (!lock.is_locked()) {
       VC_SCHED_LOCK_RETRY();
     }
+    stop_waiting_for_writer();
     if (event == AIO_EVENT_DONE && !io.ok()) {
       dir_delete(&earliest_key, vol, &earliest_dir);
       goto Lerror;
@@ -914,6 +962,8 @@ CacheVC::openReadStartEarliest(int /* event ATS_UNUSED */, Event * /* e ATS_UNUS
              vol->offset_to_vol_offset(vol->header->write_pos), vol->header->phase);
       f.hit_evacuate = 1;
     }
+    cache_tier_read_hit(this);
+    cache_recycle_read_hit(this);
     goto Lsuccess;
   Lread:
     if (dir_probe(&key, vol, &earliest_dir, &last_collision) || dir_lookaside_probe(&key, vol, &earliest_dir, nullptr)) {
@@ -1143,6 +1193,7 @@ CacheVC::openReadStartHead(int event, Event *e)
         err = ECACHE_BAD_META_DATA;
         goto Ldone;
       }
+      CACHE_SUM_DYN_STAT(cache_read_alternates_stat, vector.count());
       if (cache_config_select_alternate) {
         alternate_index = HttpTransactCache::SelectFromAlternates(&vector, &request, params);
         if (alternate_index < 0) {
@@ -1198,6 +1249,8 @@ CacheVC::openReadStartHead(int event, Event *e)
              vol->offset_to_vol_offset(vol->header->write_pos), vol->header->phase);
       f.hit_evacuate = 1;
     }
+    cache_tier_read_hit(this);
+    cache_recycle_read_hit(this);
 
     first_buf = buf;
     vol->begin_read(this);
@@ -1231,6 +1284,16 @@ CacheVC::openReadStartHead(int event, Event *e)
     }
   }
 Ldone:
+  if (tier_home && err == ECACHE_NO_DOC) {
+    // The copy in the faster tier is gone, read the one in the home volume.
+    key = first_key = earliest_key = update_key;
+    vector.clear(false);
+    vol            = tier_home;
+    tier_home      = nullptr;
+    buf            = nullptr;
+    last_collision = nullptr;
+    return handleEvent(EVENT_IMMEDIATE, nullptr);
+  }
   if (!f.lookup) {
     CACHE_INCREMENT_DYN_STAT(cache_read_failure_stat);
     _action.continuation->handleEvent(CACHE_EVENT_OPEN_READ_FAILED, (void *)-err);
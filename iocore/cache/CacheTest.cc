@@ -24,6 +24,7 @@
 
 #include "P_Cache.h"
 #include "P_CacheTest.h"
+#include "HttpCompat.h"
 #include <vector>
 #include <cmath>
 #include <cstdlib>
@@ -499,6 +500,62 @@ REGRESSION_TEST(cache_disk_replacement_stability)(RegressionTest *t, int level,
   hr2.vols = nullptr;
 }
 
+// run -R 3 -r cache_disk_failure_stability
+
+REGRESSION_TEST(cache_disk_failure_stability)(RegressionTest *t, int /* atype ATS_UNUSED */, int *pstatus)
+{
+  static int const NUM_VOLS   = 8;
+  static int const failed_idx = 3;
+  CacheDisk good_disk, failed_disk;
+  CacheHostRecord hr;
+  Vol vols[NUM_VOLS];
+  Vol *vol_ptrs[NUM_VOLS];
+  unsigned short before[VOL_HASH_TABLE_SIZE];
+  char buff[2048];
+
+  *pstatus = REGRESSION_TEST_PASSED;
+
+  good_disk.num_errors   = 0;
+  failed_disk.num_errors = 0;
+
+  for (int i = 0; i < NUM_VOLS; ++i) {
+    vol_ptrs[i]  = vols + i;
+    vols[i].disk = i == failed_idx ? &failed_disk : &good_disk;
+    vols[i].len  = 1024ULL * 1024 * 1024 * (64 + 16 * i);
+    snprintf(buff, sizeof(buff), "/dev/sd%c 8192:%" PRIu64, 'a' + i, vols[i].len);
+    CryptoContext().hash_immediate(vols[i].hash_id, buff, strlen(buff));
+  }
+
+  hr.vol_hash_table = nullptr;
+  hr.vols           = vol_ptrs;
+  hr.num_vols       = NUM_VOLS;
+  build_vol_hash_table(&hr);
+  memcpy(before, hr.vol_hash_table, sizeof(before));
+
+  failed_disk.num_errors = cache_config_max_disk_errors;
+  build_vol_hash_table(&hr);
+
+  // Only the slots of the failed volume may move, and all of them must.
+  int moved = 0, failed = 0;
+  for (int i = 0; i < VOL_HASH_TABLE_SIZE; ++i) {
+    if (before[i] == failed_idx) {
+      ++failed;
+    }
+    if (hr.vol_hash_table[i] == failed_idx || (before[i] != hr.vol_hash_table[i] && before[i] != failed_idx)) {
+      *pstatus = REGRESSION_TEST_FAILED;
+    }
+    if (before[i] != hr.vol_hash_table[i]) {
+      ++moved;
+    }
+  }
+  rprintf(t, "Cache failure stability - %d of %d slots moved, the failed volume had %d\n", moved, VOL_HASH_TABLE_SIZE, failed);
+  if (moved != failed) {
+    *pstatus = REGRESSION_TEST_FAILED;
+  }
+
+  hr.vols = nullptr;
+}
+
 static double zipf_alpha        = 1.2;
 static int64_t zipf_bucket_size = 1;
 
@@ -668,8 +725,285 @@ REGRESSION_TEST(ram_cache)(RegressionTest *t, int level, int *pstatus)
   for (int s = 20; s <= 28; s += 4) {
     int64_t cache_size = 1LL << s;
     *pstatus           = REGRESSION_TEST_PASSED;
-    if (!test_RamCache(t, new_RamCacheLRU(), "LRU", cache_size) || !test_RamCache(t, new_RamCacheCLFUS(), "CLFUS", cache_size)) {
+    if (!test_RamCache(t, new_RamCacheLRU(), "LRU", cache_size) || !test_RamCache(t, new_RamCacheCLFUS(), "CLFUS", cache_size) ||
+        !test_RamCache(t, new_RamCacheWTinyLFU(), "W-TinyLFU", cache_size)) {
+      *pstatus = REGRESSION_TEST_FAILED;
+    }
+  }
+}
+
+REGRESSION_TEST(ram_cache_snapshot)(RegressionTest *t, int /* level ATS_UNUSED */, int *pstatus)
+{
+  if (cacheProcessor.IsCacheEnabled() != CACHE_INITIALIZED) {
+    rprintf(t, "cache not initialized");
+    *pstatus = REGRESSION_TEST_FAILED;
+    return;
+  }
+  CacheKey key;
+  Vol *vol             = theCache->key_to_vol(&key, "example.com", sizeof("example.com") - 1);
+  RamCache *cache      = new_RamCacheCLFUS();
+  RamCache *restored   = new_RamCacheCLFUS();
+  Ptr<IOBufferData> d  = make_ptr(new_IOBufferData(BUFFER_SIZE_INDEX_4K));
+  int64_t cache_size   = 1 << 20;
+  constexpr int N_KEYS = 50;
+
+  cache->init(cache_size, vol);
+  restored->init(cache_size, vol);
+  for (int i = 0; i < N_KEYS; i++) {
+    CryptoHash hash;
+    Ptr<IOBufferData> data;
+    hash.u64[0] = hash.u64[1] = i + 1;
+    cache->put(&hash, d.get(), 1 << 12, false, 0, i);
+    // Key i gets i hits.
+    for (int j = 0; j < i; j++) {
+      cache->get(&hash, &data, 0, i);
+    }
+  }
+
+  std::vector<RamCacheSnapshotEntry> entries;
+  cache->snapshot(entries);
+  *pstatus = entries.size() == N_KEYS && entries.front().auxkey2 == N_KEYS - 1 ? REGRESSION_TEST_PASSED : REGRESSION_TEST_FAILED;
+
+  for (auto &e : entries) {
+    restored->put(&e.key, d.get(), e.len, false, e.auxkey1, e.auxkey2);
+    if (!restored->restore_hits(&e.key, e.auxkey1, e.auxkey2, e.hits)) {
       *pstatus = REGRESSION_TEST_FAILED;
     }
   }
+  std::vector<RamCacheSnapshotEntry> again;
+  restored->snapshot(again);
+  if (again.size() != entries.size()) {
+    *pstatus = REGRESSION_TEST_FAILED;
+  }
+  for (size_t i = 0; i < again.size() && i < entries.size(); i++) {
+    if (again[i].key != entries[i].key || again[i].hits != entries[i].hits) {
+      *pstatus = REGRESSION_TEST_FAILED;
+    }
+  }
+  delete cache;
+  delete restored;
+}
+
+REGRESSION_TEST(cache_tier_key)(RegressionTest *t, int /* level ATS_UNUSED */, int *pstatus)
+{
+  CacheKey key, first, again, other_phase, other_offset;
+  Dir dir;
+
+  key.u64[0] = 0x0123456789abcdefULL;
+  key.u64[1] = 0xfedcba9876543210ULL;
+  dir_clear(&dir);
+  dir_set_offset(&dir, 1234);
+  dir_set_phase(&dir, 0);
+  cache_tier_key(&first, &key, &dir);
+  cache_tier_key(&again, &key, &dir);
+  dir_set_phase(&dir, 1);
+  cache_tier_key(&other_phase, &key, &dir);
+  dir_set_offset(&dir, 1235);
+  cache_tier_key(&other_offset, &key, &dir);
+
+  // The key of a copy is stable for one home entry and changes with it.
+  if (first == again && first != key && first != other_phase && first != other_offset && other_phase != other_offset) {
+    *pstatus = REGRESSION_TEST_PASSED;
+  } else {
+    rprintf(t, "tier keys do not follow the home directory entry");
+    *pstatus = REGRESSION_TEST_FAILED;
+  }
+}
+
+REGRESSION_TEST(cache_write_admission)(RegressionTest *t, int /* level ATS_UNUSED */, int *pstatus)
+{
+  CacheVol cache_vol;
+  Vol vol;
+  CacheVC vc;
+
+  cache_vol.admit_hits = 3;
+  cache_vol.admit_size = 4096;
+  cache_vol.vol_rsb    = RecAllocateRawStatBlock(static_cast<int>(cache_stat_count));
+  vol.cache_vol        = &cache_vol;
+  vol.mutex            = new_ProxyMutex();
+  vc.mutex             = new_ProxyMutex();
+  vc.vol               = &vol;
+  vc.first_key.u64[0]  = 0x0123456789abcdefULL;
+  vc.first_key.u64[1]  = 0xfedcba9876543210ULL;
+  SCOPED_MUTEX_LOCK(lock, vc.mutex, this_ethread());
+
+  // Small objects always go in, larger or unknown size ones on their third write.
+  bool small  = cache_write_admit(&vc, 4096);
+  bool first  = cache_write_admit(&vc, 1 << 20);
+  bool second = cache_write_admit(&vc, -1);
+  bool third  = cache_write_admit(&vc, 1 << 20);
+  if (small && !first && !second && third) {
+    *pstatus = REGRESSION_TEST_PASSED;
+  } else {
+    rprintf(t, "admission %d %d %d %d, expected 1 0 0 1", small, first, second, third);
+    *pstatus = REGRESSION_TEST_FAILED;
+  }
+  vc.vol = nullptr;
+}
+
+static void
+alt_summary_hdrs(CacheHTTPInfo *info, const char *request, const char *response)
+{
+  HTTPHdr req, resp;
+  HTTPParser parser;
+  const char *start = request;
+
+  req.create(HTTP_TYPE_REQUEST);
+  http_parser_init(&parser);
+  req.parse_req(&parser, &start, request + strlen(request), true);
+  resp.create(HTTP_TYPE_RESPONSE);
+  http_parser_init(&parser);
+  start = response;
+  resp.parse_resp(&parser, &start, response + strlen(response), true);
+
+  info->create();
+  info->request_set(&req);
+  info->response_set(&resp);
+  req.destroy();
+  resp.destroy();
+}
+
+REGRESSION_TEST(cache_alt_summary)(RegressionTest *t, int /* level ATS_UNUSED */, int *pstatus)
+{
+  CacheHTTPInfoVector vector, loaded;
+  CacheHTTPInfo en, fr, star;
+
+  alt_summary_hdrs(&en, "GET /a HTTP/1.1\r\nAccept-Language: en,  de\r\n\r\n",
+                   "HTTP/1.1 200 OK\r\nVary: accept-language\r\n\r\n");
+  alt_summary_hdrs(&fr, "GET /a HTTP/1.1\r\nAccept-Language: fr\r\n\r\n", "HTTP/1.1 200 OK\r\nVary: accept-language\r\n\r\n");
+  alt_summary_hdrs(&star, "GET /a HTTP/1.1\r\n\r\n", "HTTP/1.1 200 OK\r\nVary: *\r\n\r\n");
+  vector.insert(&en);
+  vector.insert(&fr);
+  vector.insert(&star);
+
+  int len  = vector.marshal_length();
+  char *xx = static_cast<char *>(ats_memalign(8, len));
+  int used = vector.marshal(xx, len);
+
+  for (char *b = xx; b < xx + used;) {
+    int r = HTTPInfo::unmarshal(b, xx + used - b, nullptr);
+    if (r <= 0) {
+      break;
+    }
+    b += r;
+  }
+  bool found = static_cast<int>(loaded.get_handles(xx, used, nullptr, true)) == used && loaded.summary && loaded.count() == 3;
+
+  // The hashes follow do_vary_header_values_match: case and white space between elements do not count.
+  HTTPHdr client;
+  client.create(HTTP_TYPE_REQUEST);
+  MIMEField *field = client.field_create(MIME_FIELD_ACCEPT_LANGUAGE, MIME_LEN_ACCEPT_LANGUAGE);
+  client.field_value_set(field, "EN, De", 6);
+  client.field_attach(field);
+  uint32_t h = HttpCompat::vary_header_values_hash(client.field_find(MIME_FIELD_ACCEPT_LANGUAGE, MIME_LEN_ACCEPT_LANGUAGE));
+
+  if (found && loaded.summary[0].nvary == 1 && loaded.summary[0].vary[0] == h && loaded.summary[1].vary[0] != h &&
+      loaded.summary[0].vary_names == loaded.summary[1].vary_names && loaded.summary[2].nvary == CACHE_ALT_SUMMARY_VARY_ALL &&
+      HttpCompat::vary_header_values_hash(nullptr) == 0) {
+    *pstatus = REGRESSION_TEST_PASSED;
+  } else {
+    rprintf(t, "alternate summaries are not as marshaled");
+    *pstatus = REGRESSION_TEST_FAILED;
+  }
+
+  client.destroy();
+  loaded.clear(false);
+  vector.clear();
+  ats_free(xx);
+}
+
+struct RamCacheTraceOp {
+  uint64_t key;
+  uint32_t size;
+};
+
+// Read a recorded trace, one "<key> <bytes>" request per line, or synthesize one: a Zipf
+// distributed working set interleaved with scans of keys which are requested only once.
+static std::vector<RamCacheTraceOp>
+ram_cache_trace(RegressionTest *t, int64_t cache_size)
+{
+  std::vector<RamCacheTraceOp> trace;
+  const char *path = getenv("TS_RAM_CACHE_TRACE");
+  if (path) {
+    FILE *fp = fopen(path, "r");
+    if (!fp) {
+      rprintf(t, "unable to open trace '%s': %s\n", path, strerror(errno));
+      return trace;
+    }
+    char line[256];
+    while (fgets(line, sizeof(line), fp)) {
+      char *end     = nullptr;
+      uint64_t key  = strtoull(line, &end, 0);
+      uint64_t size = strtoull(end, nullptr, 0);
+      if (end != line) {
+        trace.push_back({key, static_cast<uint32_t>(std::min<uint64_t>(std::max<uint64_t>(size, 1), 1 << 20))});
+      }
+    }
+    fclose(fp);
+    rprintf(t, "RamCache replaying %zu requests from '%s'\n", trace.size(), path);
+    return trace;
+  }
+  int n = cache_size >> 6;
+  build_zipf();
+  srand48(17);
+  uint64_t scan_key = 1ULL << 40;
+  for (int i = 0; i < n; i++) {
+    // coverity[dont_call]
+    uint64_t key = get_zipf(drand48());
+    trace.push_back({key, static_cast<uint32_t>(8192 << (key % 3))});
+    if (i % 4 == 0) {
+      trace.push_back({scan_key++, 16384});
+    }
+  }
+  return trace;
+}
+
+static void
+replay_RamCache(RegressionTest *t, RamCache *cache, const char *name, int64_t cache_size, const std::vector<RamCacheTraceOp> &trace)
+{
+  CacheKey key;
+  Vol *vol = theCache->key_to_vol(&key, "example.com", sizeof("example.com") - 1);
+
+  cache->init(cache_size, vol);
+  int64_t hits    = 0;
+  ink_hrtime from = Thread::get_hrtime_updated();
+  for (const auto &op : trace) {
+    CryptoHash hash;
+    hash.u64[0] = op.key;
+    hash.u64[1] = op.key * 0x9E3779B97F4A7C15ULL;
+    Ptr<IOBufferData> data;
+    if (cache->get(&hash, &data)) {
+      hits++;
+      continue;
+    }
+    IOBufferData *d = THREAD_ALLOC(ioDataAllocator, this_thread());
+    d->alloc(iobuffer_size_to_index(op.size, MAX_BUFFER_SIZE_INDEX));
+    data = make_ptr(d);
+    cache->put(&hash, d, op.size);
+  }
+  ink_hrtime elapsed = std::max(Thread::get_hrtime_updated() - from, static_cast<ink_hrtime>(1));
+  rprintf(t, "RamCache %s size %" PRId64 " hit ratio %f %f ops/sec\n", name, cache_size,
+          trace.empty() ? 0.0 : static_cast<double>(hits) / trace.size(), trace.size() * static_cast<double>(HRTIME_SECOND) / elapsed);
+  delete cache;
+}
+
+// Compare the hit ratio and throughput of the RAM cache policies on the same trace.
+REGRESSION_TEST(ram_cache_replay)(RegressionTest *t, int level, int *pstatus)
+{
+  *pstatus = REGRESSION_TEST_PASSED;
+  if (REGRESSION_TEST_EXTENDED > level) {
+    return;
+  }
+  if (cacheProcessor.IsCacheEnabled() != CACHE_INITIALIZED) {
+    rprintf(t, "cache not initialized");
+    *pstatus = REGRESSION_TEST_FAILED;
+    return;
+  }
+  for (int s = 20; s <= 28; s += 4) {
+    int64_t cache_size                 = 1LL << s;
+    std::vector<RamCacheTraceOp> trace = ram_cache_trace(t, cache_size);
+    replay_RamCache(t, new_RamCacheLRU(), "LRU", cache_size, trace);
+    replay_RamCache(t, new_RamCacheCLFUS(), "CLFUS", cache_size, trace);
+    replay_RamCache(t, new_RamCacheWTinyLFU(), "W-TinyLFU", cache_size, trace);
+  }
 }
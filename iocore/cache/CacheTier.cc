@@ -0,0 +1,343 @@
+/** @file
+
+  Cache volume tiers
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  @section details Details
+
+  Every object is written to its home volume in tier 0, picked by hosting.config as before. The
+  volumes of a faster tier hold copies of the objects read often from the tier below, keyed by
+  the object key mixed with the offset and phase of the home directory entry. Any rewrite or
+  removal of the object in its home volume changes or drops that entry, so a stale copy is never
+  found and ages out of its tier. When a tier is about to overwrite a copy it is moved down to the
+  next slower tier above tier 0, instead of being dropped.
+
+  Only single fragment objects with one alternate are copied, both ways.
+ */
+
+#include "P_Cache.h"
+
+#define TIER_HITS_ENTRIES (1 << 16)
+// Halve the read counts after this many reads so that they follow what is popular now.
+#define TIER_HITS_AGE (4 * TIER_HITS_ENTRIES)
+
+// Copies one object from a volume into a volume of another tier.
+struct CacheTierCopy : public Continuation {
+  Vol *src;
+  Vol *dst;
+  Dir dir;           // of the object in src
+  CacheKey key;      // of the object in src
+  CacheKey tier_key; // of the copy in dst
+  bool demote = false;
+  AIOCallbackInternal io;
+  Ptr<IOBufferData> buf;
+
+  int readStart(int event, Event *e);
+  int readDone(int event, Event *e);
+  int writeStart(int event, Event *e);
+
+  CacheTierCopy(Vol *s, Vol *d, const CacheKey &k) : Continuation(new_ProxyMutex()), src(s), dst(d), tier_key(k) {}
+
+private:
+  int done(bool failed);
+};
+
+int
+CacheTierCopy::done(bool failed)
+{
+  if (failed) {
+    GLOBAL_CACHE_SUM_GLOBAL_DYN_STAT(cache_tier_copy_failures_stat, 1);
+  }
+  buf = nullptr;
+  mutex.clear();
+  delete this;
+  return EVENT_DONE;
+}
+
+int
+CacheTierCopy::readStart(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
+{
+  CACHE_TRY_LOCK(lock, src->mutex, mutex->thread_holding);
+  if (!lock.is_locked()) {
+    eventProcessor.schedule_in(this, HRTIME_MSECONDS(cache_config_mutex_retry_delay), ET_CALL);
+    return EVENT_CONT;
+  }
+  // The object may have moved since it was read.
+  Dir found, *last_collision = nullptr;
+  bool valid                 = false;
+  while (dir_probe(&key, src, &found, &last_collision)) {
+    if (dir_offset(&found) == dir_offset(&dir)) {
+      valid = !dir_agg_buf_valid(src, &found);
+      break;
+    }
+  }
+  if (!valid) {
+    return done(false);
+  }
+  io.aiocb.aio_fildes = src->fd;
+  io.aiocb.aio_offset = src->vol_offset(&dir);
+  io.aiocb.aio_nbytes = dir_approx_size(&dir);
+  if (static_cast<off_t>(io.aiocb.aio_offset + io.aiocb.aio_nbytes) > static_cast<off_t>(src->skip + src->len)) {
+    io.aiocb.aio_nbytes = src->skip + src->len - io.aiocb.aio_offset;
+  }
+  buf              = new_IOBufferData(iobuffer_size_to_index(io.aiocb.aio_nbytes, MAX_BUFFER_SIZE_INDEX), MEMALIGNED);
+  io.aiocb.aio_buf = buf->data();
+  io.action        = this;
+  io.thread        = AIO_CALLBACK_THREAD_ANY;
+  io.then          = nullptr;
+  SET_HANDLER(&CacheTierCopy::readDone);
+  ink_assert(ink_aio_read(&io) >= 0);
+  return EVENT_CONT;
+}
+
+int
+CacheTierCopy::readDone(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
+{
+  {
+    CACHE_TRY_LOCK(lock, src->mutex, mutex->thread_holding);
+    if (!lock.is_locked()) {
+      eventProcessor.schedule_in(this, HRTIME_MSECONDS(cache_config_mutex_retry_delay), ET_CALL);
+      return EVENT_CONT;
+    }
+    Doc *doc = reinterpret_cast<Doc *>(buf->data());
+    // The same checks as a read through a CacheVC, the entry may have been overwritten since.
+    if (!io.ok() || !dir_valid(src, &dir) || doc->magic != DOC_MAGIC || !(doc->first_key == key) ||
+        doc->len > io.aiocb.aio_nbytes || ts::VersionNumber(doc->v_major, doc->v_minor) > CACHE_DB_VERSION ||
+        !doc->single_fragment() || !doc->hlen) {
+      return done(true);
+    }
+    doc->first_key = tier_key;
+  }
+  SET_HANDLER(&CacheTierCopy::writeStart);
+  return handleEvent(EVENT_IMMEDIATE, nullptr);
+}
+
+int
+CacheTierCopy::writeStart(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
+{
+  CACHE_TRY_LOCK(lock, dst->mutex, mutex->thread_holding);
+  if (!lock.is_locked()) {
+    eventProcessor.schedule_in(this, HRTIME_MSECONDS(cache_config_mutex_retry_delay), ET_CALL);
+    return EVENT_CONT;
+  }
+  Vol *vol                   = dst;
+  Doc *doc                   = reinterpret_cast<Doc *>(buf->data());
+  uint32_t agg_len           = vol->round_to_approx_size(doc->len);
+  Dir found, *last_collision = nullptr;
+
+  if (dir_probe(&tier_key, vol, &found, &last_collision)) {
+    return done(false);
+  }
+  // Copies never hold up the writes of the tier.
+  if (!vol->dir_ready || DISK_BAD(vol->disk) || agg_len > AGG_SIZE || vol->agg_todo_size > cache_config_agg_write_backlog) {
+    return done(true);
+  }
+
+  CacheVC *c   = new_CacheVC(vol);
+  c->base_stat = cache_evacuate_active_stat;
+  CACHE_INCREMENT_DYN_STAT(c->base_stat + CACHE_STAT_ACTIVE);
+  CACHE_INCREMENT_DYN_STAT(demote ? cache_tier_demotions_stat : cache_tier_promotions_stat);
+  c->buf          = buf;
+  c->vol          = vol;
+  c->f.evacuator  = 1;
+  c->first_key    = tier_key;
+  c->key          = tier_key;
+  c->earliest_key = zero_key;
+  c->agg_len      = agg_len;
+
+  // The entry of the copy is the one of the object, at the place agg_copy puts it.
+  c->overwrite_dir = dir;
+  dir_set_approx_size(&c->overwrite_dir, agg_len);
+  dir_set_head(&c->overwrite_dir, true);
+  dir_set_pinned(&c->overwrite_dir, 0);
+  SET_CONTINUATION_HANDLER(c, &CacheVC::tierCopyDone);
+  DDebug("cache_tier", "%s %X into tier %d, %d bytes", demote ? "demoting" : "promoting", tier_key.slice32(0),
+         vol->cache_vol->tier, doc->len);
+
+  vol->agg_todo_size += agg_len;
+  vol->agg.enqueue(c);
+  if (!vol->is_io_in_progress()) {
+    vol->aggWrite(EVENT_NONE, nullptr);
+  }
+  return done(false);
+}
+
+// Called by aggWrite once the copy is in the aggregation buffer.
+int
+CacheVC::tierCopyDone(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
+{
+  ink_assert(vol->mutex->thread_holding == this_ethread());
+  dir_insert(&first_key, vol, &dir);
+  return free_CacheVC(this);
+}
+
+void
+cache_tier_key(CacheKey *tier_key, const CacheKey *key, const Dir *dir)
+{
+  uint64_t where = ((static_cast<uint64_t>(dir_offset(dir)) << 1) | dir_phase(dir)) + 1;
+
+  *tier_key = *key;
+  tier_key->u64[0] ^= where * 0x9E3779B97F4A7C15ULL;
+  tier_key->u64[1] ^= where * 0xC2B2AE3D27D4EB4FULL;
+}
+
+// The next tier with volumes above @a tier, or -1.
+int
+cache_tier_faster(Cache *cache, int tier)
+{
+  for (int t = tier + 1; cache->hosttable && t < CACHE_TIER_MAX; t++) {
+    if (cache->hosttable->tier_host_rec[t].vol_hash_table) {
+      return t;
+    }
+  }
+  return -1;
+}
+
+// The next tier with volumes below @a tier, 0 if that is the home tier.
+int
+cache_tier_slower(Cache *cache, int tier)
+{
+  for (int t = tier - 1; cache->hosttable && t > 0; t--) {
+    if (cache->hosttable->tier_host_rec[t].vol_hash_table) {
+      return t;
+    }
+  }
+  return 0;
+}
+
+/*
+ * Sends an HTTP read to the copy in the fastest tier that has one. The home
+ * volume is locked by the caller, each tier is only tried if its lock is free.
+ */
+int
+CacheVC::do_tier_read_call()
+{
+  Cache *cache = vol->cache;
+  CacheKey tier_key;
+
+  if (cache_tier_faster(cache, 0) < 0) {
+    return do_read_call(&key);
+  }
+  cache_tier_key(&tier_key, &first_key, &dir);
+  for (int t = CACHE_TIER_MAX - 1; t > 0; t--) {
+    Vol *tier_vol = cache->key_to_tier_vol(&tier_key, t);
+    if (!tier_vol || !tier_vol->dir_ready) {
+      continue;
+    }
+    CACHE_TRY_LOCK(lock, tier_vol->mutex, mutex->thread_holding);
+    Dir tier_dir, *tier_collision = nullptr;
+    if (!lock.is_locked() || tier_vol->open_read(&tier_key) || !dir_probe(&tier_key, tier_vol, &tier_dir, &tier_collision)) {
+      continue;
+    }
+    tier_home      = vol;
+    update_key     = first_key;
+    vol            = tier_vol;
+    key            = tier_key;
+    first_key      = tier_key;
+    earliest_key   = tier_key;
+    dir            = tier_dir;
+    first_dir      = tier_dir;
+    last_collision = tier_collision;
+    return do_read_call(&key);
+  }
+  return do_read_call(&key);
+}
+
+/*
+ * Counts a read hit of @a vc in the tier of its volume, which is locked.
+ * Objects read often enough are copied into the next faster tier.
+ */
+void
+cache_tier_read_hit(CacheVC *vc)
+{
+  Vol *vol          = vc->vol;
+  ProxyMutex *mutex = vc->mutex.get();
+  int tier          = vol->cache_vol->tier;
+
+  if (vc->frag_type != CACHE_FRAG_TYPE_HTTP) {
+    return;
+  }
+  CACHE_INCREMENT_DYN_STAT(cache_tier_hits_stat + tier);
+  CACHE_SUM_DYN_STAT(cache_tier_hit_bytes_stat + tier, vc->doc_len);
+
+  int faster = cache_tier_faster(vol->cache, tier);
+  if (faster < 0 || !cache_config_tier_promote_hits || !vc->f.single_fragment || vc->vector.count() != 1 ||
+      dir_agg_buf_valid(vol, &vc->dir)) {
+    return;
+  }
+  if (!vol->tier_hits) {
+    vol->tier_hits = static_cast<uint8_t *>(ats_calloc(TIER_HITS_ENTRIES, sizeof(uint8_t)));
+  }
+  if (++vol->tier_hits_age >= TIER_HITS_AGE) {
+    for (int i = 0; i < TIER_HITS_ENTRIES; i++) {
+      vol->tier_hits[i] >>= 1;
+    }
+    vol->tier_hits_age = 0;
+  }
+  uint8_t &hits = vol->tier_hits[vc->first_key.slice32(1) % TIER_HITS_ENTRIES];
+  if (hits < UINT8_MAX) {
+    ++hits;
+  }
+  if (hits < cache_config_tier_promote_hits) {
+    return;
+  }
+  hits = 0;
+
+  CacheKey tier_key;
+  if (vc->tier_home) {
+    tier_key = vc->first_key;
+  } else {
+    cache_tier_key(&tier_key, &vc->first_key, &vc->dir);
+  }
+  Vol *dst = vol->cache->key_to_tier_vol(&tier_key, faster);
+  if (!dst || !dst->dir_ready) {
+    return;
+  }
+  CacheTierCopy *copy = new CacheTierCopy(vol, dst, tier_key);
+  copy->key           = vc->first_key;
+  copy->dir           = vc->dir;
+  SET_CONTINUATION_HANDLER(copy, &CacheTierCopy::readStart);
+  eventProcessor.schedule_imm(copy, ET_CALL);
+}
+
+/*
+ * Called by evacuateDocReadDone on @a vol, which is locked, with the copy in
+ * @a buf that is about to be overwritten.
+ */
+void
+cache_tier_demote(Vol *vol, Ptr<IOBufferData> &buf, const Dir *dir)
+{
+  Doc *doc   = reinterpret_cast<Doc *>(buf->data());
+  int slower = cache_tier_slower(vol->cache, vol->cache_vol->tier);
+  if (slower <= 0) {
+    return;
+  }
+  Vol *dst = vol->cache->key_to_tier_vol(&doc->first_key, slower);
+  if (!dst || !dst->dir_ready) {
+    return;
+  }
+  CacheTierCopy *copy = new CacheTierCopy(vol, dst, doc->first_key);
+  copy->key           = doc->first_key;
+  copy->dir           = *dir;
+  copy->buf           = buf;
+  copy->demote        = true;
+  SET_CONTINUATION_HANDLER(copy, &CacheTierCopy::writeStart);
+  eventProcessor.schedule_imm(copy, ET_CALL);
+}
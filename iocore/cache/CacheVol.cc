@@ -80,6 +80,10 @@ CacheVC::scanVol(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
     goto Ldone;
   }
 Lcont:
+  if (!vol->dir_ready) {
+    // Its directory is still loading, move on to the next one.
+    return scanVol(EVENT_NONE, nullptr);
+  }
   fragment = 0;
   SET_HANDLER(&CacheVC::scanObject);
   eventProcessor.schedule_in(this, HRTIME_MSECONDS(scan_msec_delay));
@@ -248,7 +252,7 @@ CacheVC::scanObject(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
     }
     {
       char *tmp = doc->hdr();
-      int len   = doc->hlen;
+      int len   = doc_alternates_len(doc);
       while (len > 0) {
         int r = HTTPInfo::unmarshal(tmp, len, buf.get());
         if (r < 0) {
@@ -269,6 +269,7 @@ Vol::force_evacuate_head(Dir *evac_dir, int pinned)
   }
   b->f.pinned        = pinned;
   b->f.evacuate_head = 1;
+  b->f.demote        = 0;        // readers and pins keep it in this tier
   b->evac_frags.key  = zero_key; // ensure that the block gets
   // evacuated no matter what
   b->readers = 0; // ensure that the block does not disappear
@@ -280,9 +281,9 @@ Vol::scan_for_pinned_documents()
 {
   if (cache_config_permit_pinning) {
     // we can't evacuate anything between header->write_pos and
-    // header->write_pos + AGG_SIZE.
-    int ps                = this->offset_to_vol_offset(header->write_pos + AGG_SIZE);
-    int pe                = this->offset_to_vol_offset(header->write_pos + 2 * EVACUATION_SIZE + (len / PIN_SCAN_EVERY));
+    // header->agg_pos + AGG_SIZE.
+    int ps                = this->offset_to_vol_offset(header->agg_pos + AGG_SIZE);
+    int pe                = this->offset_to_vol_offset(header->agg_pos + 2 * EVACUATION_SIZE + (len / PIN_SCAN_EVERY));
     int vol_end_offset    = this->offset_to_vol_offset(len + skip);
     int before_end_of_vol = pe < vol_end_offset;
     DDebug("cache_evac", "scan %d %d", ps, pe);
@@ -308,54 +309,145 @@ Vol::scan_for_pinned_documents()
   }
 }
 
+/* The small objects read often in the region the writes are about to
+   reach are moved ahead of them instead of being overwritten. */
+void
+Vol::scan_for_popular_documents()
+{
+  if (!recycle_hits) {
+    return;
+  }
+  int ps                = this->offset_to_vol_offset(header->agg_pos + AGG_SIZE);
+  int pe                = this->offset_to_vol_offset(header->agg_pos + 2 * EVACUATION_SIZE + (len / PIN_SCAN_EVERY));
+  int vol_end_offset    = this->offset_to_vol_offset(len + skip);
+  int before_end_of_vol = pe < vol_end_offset;
+  DDebug("cache_evac", "recycle scan %d %d", ps, pe);
+  for (int i = 0; i < this->direntries(); i++) {
+    if (!dir_is_empty(&dir[i]) && dir_head(&dir[i]) && !dir_pinned(&dir[i])) {
+      int o = dir_offset(&dir[i]);
+      if (dir_phase(&dir[i]) == header->phase) {
+        if (before_end_of_vol || o >= (pe - vol_end_offset)) {
+          continue;
+        }
+      } else {
+        if (o < ps || o >= pe) {
+          continue;
+        }
+      }
+      if (!evacuation_block_exists(&dir[i], this) && cache_recycle_popular(this, &dir[i])) {
+        force_evacuate_head(&dir[i], 0);
+        GLOBAL_CACHE_SUM_GLOBAL_DYN_STAT(cache_recycled_stat, 1);
+      }
+    }
+  }
+}
+
+/* The copies in the region the writes are about to reach are moved to
+   the next slower tier, unless that is the home volume which has them. */
+void
+Vol::scan_for_demotions()
+{
+  if (!cache_config_tier_demote || cache_tier_slower(cache, cache_vol->tier) <= 0) {
+    return;
+  }
+  int ps                = this->offset_to_vol_offset(header->agg_pos + AGG_SIZE);
+  int pe                = this->offset_to_vol_offset(header->agg_pos + 2 * EVACUATION_SIZE + (len / PIN_SCAN_EVERY));
+  int vol_end_offset    = this->offset_to_vol_offset(len + skip);
+  int before_end_of_vol = pe < vol_end_offset;
+  DDebug("cache_evac", "demotion scan %d %d", ps, pe);
+  for (int i = 0; i < this->direntries(); i++) {
+    if (!dir_is_empty(&dir[i]) && dir_head(&dir[i]) && !dir_pinned(&dir[i])) {
+      int o = dir_offset(&dir[i]);
+      if (dir_phase(&dir[i]) == header->phase) {
+        if (before_end_of_vol || o >= (pe - vol_end_offset)) {
+          continue;
+        }
+      } else {
+        if (o < ps || o >= pe) {
+          continue;
+        }
+      }
+      // Objects being evacuated for their readers stay here.
+      if (!evacuation_block_exists(&dir[i], this)) {
+        force_evacuate_head(&dir[i], 0)->f.demote = 1;
+      }
+    }
+  }
+}
+
 /* NOTE:: This state can be called by an AIO thread, so DON'T DON'T
    DON'T schedule any events on this thread using VC_SCHED_XXX or
    mutex->thread_holding->schedule_xxx_local(). ALWAYS use
    eventProcessor.schedule_xxx().
    */
 int
-Vol::aggWriteDone(int event, Event *e)
+AggWrite::aggWriteDone(int event, Event *e)
 {
-  cancel_trigger();
-
   // ensure we have the cacheDirSync lock if we intend to call it later
   // retaking the current mutex recursively is a NOOP
-  CACHE_TRY_LOCK(lock, dir_sync_waiting ? cacheDirSync->mutex : mutex, mutex->thread_holding);
+  CACHE_TRY_LOCK(lock, vol->dir_sync_waiting ? cacheDirSync->mutex : mutex, mutex->thread_holding);
   if (!lock.is_locked()) {
     eventProcessor.schedule_in(this, HRTIME_MSECONDS(cache_config_mutex_retry_delay));
     return EVENT_CONT;
   }
-  if (io.ok()) {
-    header->last_write_pos = header->write_pos;
-    header->write_pos += io.aiocb.aio_nbytes;
-    ink_assert(header->write_pos >= start);
-    DDebug("cache_agg", "Dir %s, Write: %" PRIu64 ", last Write: %" PRIu64 "", hash_text.get(), header->write_pos,
-           header->last_write_pos);
-    ink_assert(header->write_pos == header->agg_pos);
-    if (header->write_pos + EVACUATION_SIZE > scan_pos) {
-      periodic_scan();
-    }
-    agg_buf_pos = 0;
-    header->write_serial++;
-  } else {
-    // delete all the directory entries that we inserted
-    // for fragments is this aggregation buffer
-    Debug("cache_disk_error", "Write error on disk %s\n \
+  done = true;
+  return vol->aggWriteDone(event, e);
+}
+
+/*
+ * Lands the writes that are done in the order they were issued, a write
+ * that finishes before the ones ahead of it waits for them. Called with
+ * the volume lock held.
+ */
+int
+Vol::aggWriteDone(int event, Event *e)
+{
+  cancel_trigger();
+
+  while (agg_writes_in_flight && agg_writes[agg_write_head].done) {
+    AggWrite *w = &agg_writes[agg_write_head];
+    if (w->io.ok()) {
+      header->last_write_pos = header->write_pos;
+      header->write_pos += w->io.aiocb.aio_nbytes;
+      ink_assert(header->write_pos >= start);
+      DDebug("cache_agg", "Dir %s, Write: %" PRIu64 ", last Write: %" PRIu64 "", hash_text.get(), header->write_pos,
+             header->last_write_pos);
+      if (header->write_pos + EVACUATION_SIZE > scan_pos) {
+        periodic_scan();
+      }
+      header->write_serial++;
+      agg_write_adapt(w);
+    } else {
+      // delete all the directory entries that we inserted
+      // for fragments is this aggregation buffer
+      Debug("cache_disk_error", "Write error on disk %s\n \
               write range : [%" PRIu64 " - %" PRIu64 " bytes]  [%" PRIu64 " - %" PRIu64 " blocks] \n",
-          hash_text.get(), (uint64_t)io.aiocb.aio_offset, (uint64_t)io.aiocb.aio_offset + io.aiocb.aio_nbytes,
-          (uint64_t)io.aiocb.aio_offset / CACHE_BLOCK_SIZE,
-          (uint64_t)(io.aiocb.aio_offset + io.aiocb.aio_nbytes) / CACHE_BLOCK_SIZE);
-    Dir del_dir;
-    dir_clear(&del_dir);
-    for (int done = 0; done < agg_buf_pos;) {
-      Doc *doc = reinterpret_cast<Doc *>(agg_buffer + done);
-      dir_set_offset(&del_dir, header->write_pos + done);
-      dir_delete(&doc->key, this, &del_dir);
-      done += round_to_approx_size(doc->len);
+            hash_text.get(), (uint64_t)w->io.aiocb.aio_offset, (uint64_t)w->io.aiocb.aio_offset + w->io.aiocb.aio_nbytes,
+            (uint64_t)w->io.aiocb.aio_offset / CACHE_BLOCK_SIZE,
+            (uint64_t)(w->io.aiocb.aio_offset + w->io.aiocb.aio_nbytes) / CACHE_BLOCK_SIZE);
+      Dir del_dir;
+      dir_clear(&del_dir);
+      for (int done = 0; done < static_cast<int>(w->io.aiocb.aio_nbytes);) {
+        Doc *doc = reinterpret_cast<Doc *>(w->buffer + done);
+        dir_set_offset(&del_dir, header->write_pos + done);
+        dir_delete(&doc->key, this, &del_dir);
+        done += round_to_approx_size(doc->len);
+      }
+      if (agg_writes_in_flight == 1 && !agg_buf_pos) {
+        // nothing was placed after it, the next write goes to the same place
+        header->agg_pos = header->write_pos;
+      } else {
+        header->write_pos += w->io.aiocb.aio_nbytes;
+      }
     }
-    agg_buf_pos = 0;
+    w->done        = false;
+    agg_write_head = (agg_write_head + 1) % agg_writes_max;
+    agg_writes_in_flight--;
   }
-  set_io_not_in_progress();
+  ink_assert(agg_writes_in_flight || header->write_pos == header->agg_pos);
+  // the next buffer to fill is free again if every one was in flight
+  agg_buffer = agg_writes[(agg_write_head + agg_writes_in_flight) % agg_writes_max].buffer;
+
   // callback ready sync CacheVCs
   CacheVC *c = nullptr;
   while ((c = sync.dequeue())) {
@@ -366,16 +458,94 @@ Vol::aggWriteDone(int event, Event *e)
       break;
     }
   }
-  if (dir_sync_waiting) {
+  if (dir_sync_waiting && !agg_writes_in_flight && !agg_buf_pos) {
     dir_sync_waiting = false;
     cacheDirSync->handleEvent(EVENT_IMMEDIATE, nullptr);
   }
-  if (agg.head || sync.head) {
+  // an evacuation read in flight calls aggWrite when it is done
+  if ((agg.head || sync.head || dir_sync_waiting) && !is_io_in_progress()) {
     return aggWrite(event, e);
   }
   return EVENT_CONT;
 }
 
+/*
+ * Sets up the buffers for up to @a max_in_flight aggregation writes, the
+ * first one is allocated with the volume.
+ */
+void
+Vol::agg_write_init(int max_in_flight)
+{
+  for (int i = agg_writes_max; i < max_in_flight; i++) {
+    agg_writes[i].buffer = static_cast<char *>(ats_memalign(ats_pagesize(), AGG_SIZE));
+    memset(agg_writes[i].buffer, 0, AGG_SIZE);
+#if AIO_MODE == AIO_MODE_IO_URING
+    ink_aio_register_fixed_buffer(agg_writes[i].buffer, AGG_SIZE);
+#endif
+  }
+  agg_writes_max = std::max(agg_writes_max, max_in_flight);
+}
+
+/*
+ * With several writes in flight the buffer is written once it holds as
+ * much as the device writes in its fixed latency, so a device with a low
+ * latency gets smaller writes sooner and a slow one full ones. The latency
+ * and bandwidth are a least squares fit of write time on size, over the
+ * recent writes.
+ */
+void
+Vol::agg_write_adapt(AggWrite *w)
+{
+  if (agg_writes_max <= 1) {
+    return;
+  }
+  static constexpr double decay = 0.95;
+  double x                      = static_cast<double>(w->io.aiocb.aio_nbytes);
+  double y                      = static_cast<double>(Thread::get_hrtime() - w->start);
+
+  agg_lat_n  = agg_lat_n * decay + 1;
+  agg_lat_x  = agg_lat_x * decay + x;
+  agg_lat_y  = agg_lat_y * decay + y;
+  agg_lat_xx = agg_lat_xx * decay + x * x;
+  agg_lat_xy = agg_lat_xy * decay + x * y;
+
+  double d = agg_lat_n * agg_lat_xx - agg_lat_x * agg_lat_x;
+  if (agg_lat_n < 8 || d <= 0) {
+    return;
+  }
+  double per_byte = (agg_lat_n * agg_lat_xy - agg_lat_x * agg_lat_y) / d;
+  double latency  = (agg_lat_y - per_byte * agg_lat_x) / agg_lat_n;
+  if (per_byte <= 0 || latency <= 0) {
+    return;
+  }
+  int high_water = static_cast<int>(std::min(latency / per_byte, static_cast<double>(AGG_HIGH_WATER)));
+  high_water     = std::max(high_water, static_cast<int>(AGG_WRITE_SIZE_MIN));
+  if (high_water != agg_high_water) {
+    DDebug("cache_agg", "Dir %s, write size %d, latency %.0fns, %.3fns/byte", hash_text.get(), high_water, latency, per_byte);
+    agg_high_water = high_water;
+  }
+}
+
+/*
+ * The data at @a offset, in the buffer being filled or in one of a write
+ * in flight, see dir_agg_buf_valid.
+ */
+char *
+Vol::agg_buf_data(off_t offset)
+{
+  if (offset >= header->agg_pos) {
+    return agg_buffer + (offset - header->agg_pos);
+  }
+  for (int i = 0; i < agg_writes_in_flight; i++) {
+    AggWrite *w = &agg_writes[(agg_write_head + i) % agg_writes_max];
+    if (offset >= w->io.aiocb.aio_offset && offset < static_cast<off_t>(w->io.aiocb.aio_offset + w->io.aiocb.aio_nbytes)) {
+      return w->buffer + (offset - w->io.aiocb.aio_offset);
+    }
+  }
+  ink_assert(!"no aggregation buffer holds the offset");
+  return nullptr;
+}
+
 CacheVC *
 new_DocEvacuator(int nbytes, Vol *vol)
 {
@@ -586,8 +756,8 @@ evacuate_fragments(CacheKey *key, CacheKey *earliest_key, int force, Vol *vol)
   return i;
 }
 
-int
-Vol::evacuateWrite(CacheVC *evacuator, int event, Event *e)
+void
+Vol::evacuate_enqueue(CacheVC *evacuator)
 {
   // push to front of aggregation write list, so it is written first
 
@@ -601,6 +771,12 @@ Vol::evacuateWrite(CacheVC *evacuator, int event, Event *e)
   }
   ink_assert(evacuator->agg_len <= AGG_SIZE);
   agg.insert(evacuator, after);
+}
+
+int
+Vol::evacuateWrite(CacheVC *evacuator, int event, Event *e)
+{
+  evacuate_enqueue(evacuator);
   return aggWrite(event, e);
 }
 
@@ -614,6 +790,22 @@ Vol::evacuateDocReadDone(int event, Event *e)
   ink_assert(is_io_in_progress());
   set_io_not_in_progress();
   ink_assert(mutex->thread_holding == this_ethread());
+  CacheVC *evacuator = doc_evacuator;
+  doc_evacuator      = nullptr;
+  if (evacuate_doc(evacuator)) {
+    return evacuateWrite(evacuator, event, e);
+  }
+  free_CacheVC(evacuator);
+  return aggWrite(event, e);
+}
+
+/*
+ * Sets up @a doc_evacuator, which has read its document, to be written
+ * at the write cursor. Returns false if the document is not to be kept.
+ */
+bool
+Vol::evacuate_doc(CacheVC *doc_evacuator)
+{
   Doc *doc = reinterpret_cast<Doc *>(doc_evacuator->buf->data());
   CacheKey next_key;
   EvacuationBlock *b = nullptr;
@@ -639,6 +831,13 @@ Vol::evacuateDocReadDone(int event, Event *e)
   if ((b->f.pinned && !b->readers) && doc->pinned < static_cast<uint32_t>(Thread::get_hrtime() / HRTIME_SECOND)) {
     goto Ldone;
   }
+  if (b->f.demote) {
+    // Only whole objects are copied between tiers, anything else is dropped as it would be without tiers.
+    if (dir_head(&b->dir) && dir_compare_tag(&b->dir, &doc->first_key) && doc->single_fragment() && doc->hlen) {
+      cache_tier_demote(this, doc_evacuator->buf, &doc_evacuator->overwrite_dir);
+    }
+    goto Ldone;
+  }
 
   if (dir_head(&b->dir) && b->f.evacuate_head) {
     ink_assert(!b->evac_frags.key.fold());
@@ -687,11 +886,9 @@ Vol::evacuateDocReadDone(int event, Event *e)
     next_CacheKey(&next_key, &doc->key);
     evacuate_fragments(&next_key, &doc_evacuator->earliest_key, !b->readers, this);
   }
-  return evacuateWrite(doc_evacuator, event, e);
+  return true;
 Ldone:
-  free_CacheVC(doc_evacuator);
-  doc_evacuator = nullptr;
-  return aggWrite(event, e);
+  return false;
 }
 
 int
@@ -701,6 +898,8 @@ Vol::evac_range(off_t low, off_t high, int evac_phase)
   off_t e = this->offset_to_vol_offset(high);
   int si  = dir_offset_evac_bucket(s);
   int ei  = dir_offset_evac_bucket(e);
+  // read ahead documents in the range still have to arrive before it is written over
+  bool reading = false;
 
   for (int i = si; i <= ei; i++) {
     EvacuationBlock *b     = evacuate[i].head;
@@ -709,6 +908,9 @@ Vol::evac_range(off_t low, off_t high, int evac_phase)
     for (; b; b = b->link.next) {
       int64_t offset = dir_offset(&b->dir);
       int phase      = dir_phase(&b->dir);
+      if (offset >= s && offset < e && b->f.reading && phase == evac_phase) {
+        reading = true;
+      }
       if (offset >= s && offset < e && !b->f.done && phase == evac_phase) {
         if (offset < first_offset) {
           first        = b;
@@ -736,14 +938,113 @@ Vol::evac_range(off_t low, off_t high, int evac_phase)
       return -1;
     }
   }
-  return 0;
+  return reading ? -1 : 0;
+}
+
+/*
+ * Starts evacuation reads for the documents in the configured distance
+ * past the range evac_range is about to need, each with its own
+ * evacuator, so they are already queued for the aggregation buffer when
+ * the write cursor gets there instead of being read while it waits.
+ */
+void
+Vol::evac_readahead()
+{
+  if (cache_config_evacuate_readahead <= 0) {
+    return;
+  }
+  off_t low  = header->agg_pos + agg_buf_pos + EVACUATION_SIZE;
+  off_t high = low + std::min(cache_config_evacuate_readahead, static_cast<int64_t>(len / 2));
+  off_t vend = skip + len;
+
+  if (low < vend) {
+    evac_readahead_range(low, std::min(high, vend), !header->phase);
+  }
+  if (high > vend) {
+    evac_readahead_range(start + std::max(low - vend, static_cast<off_t>(0)), start + (high - vend), header->phase);
+  }
+}
+
+void
+Vol::evac_readahead_range(off_t low, off_t high, int evac_phase)
+{
+  off_t s = this->offset_to_vol_offset(low);
+  off_t e = this->offset_to_vol_offset(high);
+  int si  = dir_offset_evac_bucket(s);
+  int ei  = dir_offset_evac_bucket(e);
+
+  Vol *vol = this; // for the stat macros
+  for (int i = si; i <= ei; i++) {
+    for (EvacuationBlock *b = evacuate[i].head; b; b = b->link.next) {
+      int64_t offset = dir_offset(&b->dir);
+      int phase      = dir_phase(&b->dir);
+      if (offset < s || offset >= e || b->f.done || phase != evac_phase) {
+        continue;
+      }
+      if (evac_readahead_in_flight >= EVACUATION_READAHEAD_MAX) {
+        return;
+      }
+      b->f.done                = 1;
+      b->f.reading             = 1;
+      CacheVC *evacuator       = new_DocEvacuator(dir_approx_size(&b->dir), this);
+      evacuator->overwrite_dir = b->dir;
+
+      AIOCallback *aio      = &evacuator->io;
+      aio->aiocb.aio_fildes = fd;
+      aio->aiocb.aio_nbytes = dir_approx_size(&b->dir);
+      aio->aiocb.aio_offset = this->vol_offset(&b->dir);
+      if (static_cast<off_t>(aio->aiocb.aio_offset + aio->aiocb.aio_nbytes) > static_cast<off_t>(skip + len)) {
+        aio->aiocb.aio_nbytes = skip + len - aio->aiocb.aio_offset;
+      }
+      aio->aiocb.aio_buf = evacuator->buf->data();
+      aio->action        = evacuator;
+      aio->thread        = AIO_CALLBACK_THREAD_ANY;
+      aio->then          = nullptr;
+      DDebug("cache_evac", "evac_readahead evacuating %X %d", (int)dir_tag(&b->dir), (int)dir_offset(&b->dir));
+      SET_CONTINUATION_HANDLER(evacuator, &CacheVC::evacuateReadAheadDone);
+      evac_readahead_in_flight++;
+      CACHE_INCREMENT_DYN_STAT(cache_evacuate_readahead_stat);
+      ink_assert(ink_aio_read(aio) >= 0);
+    }
+  }
+}
+
+int
+CacheVC::evacuateReadAheadDone(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
+{
+  // The evacuator vc shares the lock with the volume mutex
+  ink_assert(vol->mutex->thread_holding == this_ethread());
+  Vol *v   = vol;
+  Doc *doc = reinterpret_cast<Doc *>(buf->data());
+  set_io_not_in_progress();
+  v->evac_readahead_in_flight--;
+
+  // the block is gone if its last reader closed while the read was in flight
+  EvacuationBlock *b = v->evacuate[dir_evac_bucket(&overwrite_dir)].head;
+  for (; b && dir_offset(&b->dir) != dir_offset(&overwrite_dir); b = b->link.next) {
+    ;
+  }
+  if (b) {
+    b->f.reading = 0;
+  }
+  if (b && io.ok() && doc->magic == DOC_MAGIC && v->evacuate_doc(this)) {
+    SET_HANDLER(&CacheVC::evacuateDocDone);
+    v->evacuate_enqueue(this);
+  } else {
+    free_CacheVC(this);
+  }
+  // aggWrite may be waiting for this read, see evac_range
+  if (!v->is_io_in_progress()) {
+    v->aggWrite(EVENT_IMMEDIATE, nullptr);
+  }
+  return EVENT_DONE;
 }
 
 static int
 agg_copy(char *p, CacheVC *vc)
 {
   Vol *vol = vc->vol;
-  off_t o  = vol->header->write_pos + vol->agg_buf_pos;
+  off_t o  = vol->header->agg_pos + vol->agg_buf_pos;
 
   if (!vc->f.evacuator) {
     Doc *doc                   = reinterpret_cast<Doc *>(p);
@@ -945,6 +1246,8 @@ Vol::periodic_scan()
 {
   evacuate_cleanup();
   scan_for_pinned_documents();
+  scan_for_popular_documents();
+  scan_for_demotions();
   if (header->write_pos == start) {
     scan_pos = start;
   }
@@ -986,16 +1289,21 @@ Vol::aggWrite(int event, void * /* e ATS_UNUSED */)
 
   cancel_trigger();
 
+  // every buffer is being written, or a directory sync waits for them to land
+  if (agg_writes_in_flight == agg_writes_max || (dir_sync_waiting && agg_writes_in_flight)) {
+    return EVENT_CONT;
+  }
+
 Lagain:
   // calculate length of aggregated write
   for (c = static_cast<CacheVC *>(agg.head); c;) {
     int writelen = c->agg_len;
     // [amc] this is checked multiple places, on here was it strictly less.
     ink_assert(writelen <= AGG_SIZE);
-    if (agg_buf_pos + writelen > AGG_SIZE || header->write_pos + agg_buf_pos + writelen > (skip + len)) {
+    if (agg_buf_pos + writelen > AGG_SIZE || header->agg_pos + agg_buf_pos + writelen > (skip + len)) {
       break;
     }
-    DDebug("agg_read", "copying: %d, %" PRIu64 ", key: %d", agg_buf_pos, header->write_pos + agg_buf_pos, c->first_key.slice32(0));
+    DDebug("agg_read", "copying: %d, %" PRIu64 ", key: %d", agg_buf_pos, header->agg_pos + agg_buf_pos, c->first_key.slice32(0));
     int wrotelen = agg_copy(agg_buffer + agg_buf_pos, c);
     ink_assert(writelen == wrotelen);
     agg_todo_size -= writelen;
@@ -1021,7 +1329,7 @@ Lagain:
     if (!agg.head && !sync.head) { // nothing to get
       return EVENT_CONT;
     }
-    if (header->write_pos == start) {
+    if (header->agg_pos == start) {
       // write aggregation too long, bad bad, punt on everything.
       Note("write aggregation exceeds vol size");
       ink_assert(!tocall.head);
@@ -1032,27 +1340,38 @@ Lagain:
       }
       return EVENT_CONT;
     }
-    // start back
+    // start back, once the writes before the end have landed
     if (agg.head) {
+      if (agg_writes_in_flight) {
+        ink_assert(!tocall.head);
+        return EVENT_CONT;
+      }
       agg_wrap();
       goto Lagain;
     }
   }
 
   // evacuate space
-  off_t end = header->write_pos + agg_buf_pos + EVACUATION_SIZE;
-  if (evac_range(header->write_pos, end, !header->phase) < 0) {
+  evac_readahead();
+  off_t end = header->agg_pos + agg_buf_pos + EVACUATION_SIZE;
+  if (evac_range(header->agg_pos, end, !header->phase) < 0 ||
+      (end > skip + len && evac_range(start, start + (end - (skip + len)), header->phase) < 0)) {
+    // writes wait for the documents in the range to be read
+    if (!agg_stall_start) {
+      agg_stall_start = Thread::get_hrtime();
+    }
     goto Lwait;
   }
-  if (end > skip + len) {
-    if (evac_range(start, start + (end - (skip + len)), header->phase) < 0) {
-      goto Lwait;
-    }
+  if (agg_stall_start) {
+    Vol *vol = this;
+    CACHE_INCREMENT_DYN_STAT(cache_agg_stalls_stat);
+    CACHE_SUM_DYN_STAT(cache_agg_stall_time_stat, Thread::get_hrtime() - agg_stall_start);
+    agg_stall_start = 0;
   }
 
   // if agg.head, then we are near the end of the disk, so
   // write down the aggregation in whatever size it is.
-  if (agg_buf_pos < AGG_HIGH_WATER && !agg.head && !sync.head && !dir_sync_waiting) {
+  if (agg_buf_pos < agg_high_water && !agg.head && !sync.head && !dir_sync_waiting) {
     goto Lwait;
   }
 
@@ -1069,22 +1388,30 @@ Lagain:
     d->write_serial = header->write_serial;
   }
 
-  // set write limit
-  header->agg_pos = header->write_pos + agg_buf_pos;
+  {
+    AggWrite *w = &agg_writes[(agg_write_head + agg_writes_in_flight) % agg_writes_max];
+    ink_assert(w->buffer == agg_buffer && !w->done);
+    w->io.aiocb.aio_fildes = fd;
+    w->io.aiocb.aio_offset = header->agg_pos;
+    w->io.aiocb.aio_buf    = agg_buffer;
+    w->io.aiocb.aio_nbytes = agg_buf_pos;
+    w->io.action           = w;
+    /*
+      Callback on AIO thread so that we can issue a new write ASAP
+      as all writes are serialized in the volume.  This is not necessary
+      for reads proceed independently.
+     */
+    w->io.thread = AIO_CALLBACK_THREAD_AIO;
+    w->start     = Thread::get_hrtime();
 
-  io.aiocb.aio_fildes = fd;
-  io.aiocb.aio_offset = header->write_pos;
-  io.aiocb.aio_buf    = agg_buffer;
-  io.aiocb.aio_nbytes = agg_buf_pos;
-  io.action           = this;
-  /*
-    Callback on AIO thread so that we can issue a new write ASAP
-    as all writes are serialized in the volume.  This is not necessary
-    for reads proceed independently.
-   */
-  io.thread = AIO_CALLBACK_THREAD_AIO;
-  SET_HANDLER(&Vol::aggWriteDone);
-  ink_aio_write(&io);
+    // set write limit
+    header->agg_pos += agg_buf_pos;
+    agg_buf_pos = 0;
+    agg_writes_in_flight++;
+    // with every buffer in flight this is the oldest one, nothing is copied to it until it lands
+    agg_buffer = agg_writes[(agg_write_head + agg_writes_in_flight) % agg_writes_max].buffer;
+    ink_aio_write(&w->io);
+  }
 
 Lwait:
   int ret = EVENT_CONT;
@@ -1107,6 +1434,7 @@ CacheVC::openWriteCloseDir(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED *
     if (!lock.is_locked()) {
       SET_HANDLER(&CacheVC::openWriteCloseDir);
       ink_assert(!is_io_in_progress());
+      CACHE_INCREMENT_DYN_STAT(cache_open_dir_lock_contention_stat);
       VC_SCHED_LOCK_RETRY();
     }
     vol->close_write(this);
@@ -1262,6 +1590,9 @@ CacheVC::openWriteCloseDataDone(int event, Event *e)
     fragment++;
     write_pos += write_len;
     dir_insert(&key, vol, &dir);
+    if (od) {
+      od->wake_readers();
+    }
     blocks = iobufferblock_skip(blocks.get(), &offset, &length, write_len);
     next_CacheKey(&key, &key);
     if (length) {
@@ -1359,6 +1690,9 @@ CacheVC::openWriteWriteDone(int event, Event *e)
     write_pos += write_len;
     dir_insert(&key, vol, &dir);
     DDebug("cache_insert", "WriteDone: %X, %X, %d", key.slice32(0), first_key.slice32(0), write_len);
+    if (od) {
+      od->wake_readers();
+    }
     blocks = iobufferblock_skip(blocks.get(), &offset, &length, write_len);
     next_CacheKey(&key, &key);
   }
@@ -1383,6 +1717,10 @@ CacheVC::openWriteMain(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
   cancel_trigger();
   int called_user = 0;
   ink_assert(!is_io_in_progress());
+  if (f.not_admitted) {
+    // Nothing is written, the writer sees an error and closes the write like any failed one.
+    return calluser(VC_EVENT_ERROR);
+  }
 Lagain:
   if (!vio.buffer.writer()) {
     if (calluser(VC_EVENT_WRITE_READY) == EVENT_DONE) {
@@ -1626,6 +1964,7 @@ CacheVC::openWriteStartBegin(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED
     return EVENT_DONE;
   }
   if (err < 0) {
+    CACHE_INCREMENT_DYN_STAT(cache_open_dir_lock_contention_stat);
     VC_SCHED_LOCK_RETRY();
   }
   if (f.overwrite) {
@@ -1649,6 +1988,10 @@ Cache::open_write(Continuation *cont, const CacheKey *key, CacheFragType frag_ty
   }
 
   ink_assert(caches[frag_type] == this);
+  if (!key_to_vol(key, hostname, host_len)->dir_ready) {
+    cont->handleEvent(CACHE_EVENT_OPEN_WRITE_FAILED, (void *)-ECACHE_NOT_READY);
+    return ACTION_RESULT_DONE;
+  }
 
   intptr_t res      = 0;
   CacheVC *c        = new_CacheVC(cont);
@@ -1686,6 +2029,7 @@ Cache::open_write(Continuation *cont, const CacheKey *key, CacheFragType frag_ty
     return ACTION_RESULT_DONE;
   }
   if (res < 0) {
+    CACHE_INCREMENT_DYN_STAT(cache_open_dir_lock_contention_stat);
     SET_CONTINUATION_HANDLER(c, &CacheVC::openWriteStartBegin);
     c->trigger = CONT_SCHED_LOCK_RETRY(c);
     return &c->_action;
@@ -1715,6 +2059,10 @@ Cache::open_write(Continuation *cont, const CacheKey *key, CacheHTTPInfo *info,
   }
 
   ink_assert(caches[type] == this);
+  if (!key_to_vol(key, hostname, host_len)->dir_ready) {
+    cont->handleEvent(CACHE_EVENT_OPEN_WRITE_FAILED, (void *)-ECACHE_NOT_READY);
+    return ACTION_RESULT_DONE;
+  }
   intptr_t err      = 0;
   int if_writers    = (uintptr_t)info == CACHE_ALLOW_MULTIPLE_WRITES;
   CacheVC *c        = new_CacheVC(cont);
@@ -1814,6 +2162,7 @@ Cache::open_write(Continuation *cont, const CacheKey *key, CacheHTTPInfo *info,
       }
     }
     // missed lock
+    CACHE_INCREMENT_DYN_STAT(cache_open_dir_lock_contention_stat);
     SET_CONTINUATION_HANDLER(c, &CacheVC::openWriteStartDone);
     CONT_SCHED_LOCK_RETRY(c);
     return &c->_action;
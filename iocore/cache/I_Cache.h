@@ -40,13 +40,24 @@ static constexpr ts::ModuleVersion CACHE_MODULE_VERSION(1, 0);
 
 #define RAM_CACHE_ALGORITHM_CLFUS 0
 #define RAM_CACHE_ALGORITHM_LRU 1
+#define RAM_CACHE_ALGORITHM_WTINYLFU 2
 
 #define CACHE_COMPRESSION_NONE 0
 #define CACHE_COMPRESSION_FASTLZ 1
 #define CACHE_COMPRESSION_LIBZ 2
 #define CACHE_COMPRESSION_LIBLZMA 3
-
-enum { RAM_HIT_COMPRESS_NONE = 1, RAM_HIT_COMPRESS_FASTLZ, RAM_HIT_COMPRESS_LIBZ, RAM_HIT_COMPRESS_LIBLZMA, RAM_HIT_LAST_ENTRY };
+#define CACHE_COMPRESSION_ZSTD 4
+#define CACHE_COMPRESSION_LZ4 5
+
+enum {
+  RAM_HIT_COMPRESS_NONE = 1,
+  RAM_HIT_COMPRESS_FASTLZ,
+  RAM_HIT_COMPRESS_LIBZ,
+  RAM_HIT_COMPRESS_LIBLZMA,
+  RAM_HIT_COMPRESS_ZSTD,
+  RAM_HIT_COMPRESS_LZ4,
+  RAM_HIT_LAST_ENTRY
+};
 
 struct CacheVC;
 struct CacheDisk;
@@ -157,6 +168,8 @@ struct CacheProcessor : public Processor {
 
   ts::VersionNumber min_stripe_version;
   ts::VersionNumber max_stripe_version;
+  /// The key hash of the stripes holding objects, or the configured one if none do.
+  CacheKeyHash key_hash = CACHE_KEY_HASH_DEFAULT;
 
   CALLBACK_FUNC cb_after_init = nullptr;
   int wait_for_cache          = 0;
@@ -33,7 +33,7 @@
 #define CACHE_ALT_REMOVED -2
 
 static const uint8_t CACHE_DB_MAJOR_VERSION = 24;
-static const uint8_t CACHE_DB_MINOR_VERSION = 2;
+static const uint8_t CACHE_DB_MINOR_VERSION = 3;
 // This is used in various comparisons because otherwise if the minor version is 0,
 // the compile fails because the condition is always true or false. Running it through
 // VersionNumber prevents that.
@@ -44,6 +44,12 @@ static const uint8_t CACHE_DIR_MINOR_VERSION = 0;
 
 #define CACHE_DB_FDS 128
 
+// Hash of the cache keys, as recorded in a stripe header. Stripes from before there was a choice have zero.
+enum CacheKeyHash {
+  CACHE_KEY_HASH_DEFAULT = 0, // MD5, or SHA-256 for FIPS builds
+  CACHE_KEY_HASH_MURMUR3 = 1,
+};
+
 // opcodes
 #define CACHE_OPEN_READ 1
 #define CACHE_OPEN_READ_BUFFER 2
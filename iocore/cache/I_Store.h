@@ -85,6 +85,7 @@ private:
 
 public:
   bool file_pathname = false; // the pathname is a file
+  bool polled_io     = false; ///< Issue the IO of the span on a polled io_uring.
   // v- used as a magic location for copy constructor.
   // we memcpy everything before this member and do explicit assignment for the rest.
   ats_scoped_str pathname;
@@ -271,6 +272,7 @@ struct Store {
   /// Additional configuration key values.
   static const char VOLUME_KEY[];
   static const char HASH_BASE_STRING_KEY[];
+  static const char POLLED_IO_KEY[];
 };
 
 // store either free or in the cache, can be stolen for reconfiguration
@@ -25,6 +25,14 @@
 
 #include "P_CacheHttp.h"
 
+#include <atomic>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
 struct Vol;
 struct InterimCacheVol;
 struct CacheVC;
@@ -54,6 +62,12 @@ struct CacheVC;
 
 #define SYNC_MAX_WRITE (2 * 1024 * 1024)
 #define SYNC_DELAY HRTIME_MSECONDS(500)
+
+// Directory sync segment state. The directory is synced alternately to two copies on disk, a
+// segment only needs to be written to a copy if it changed since that copy was last written.
+#define DIR_SYNC_COPY(_b) (1 << (_b)) // segment changed since copy _b was written
+#define DIR_SYNC_ALL (DIR_SYNC_COPY(0) | DIR_SYNC_COPY(1))
+#define DIR_SYNC_PENDING 0x4 // segment is part of the sync in progress
 #define DO_NOT_REMOVE_THIS 0
 
 // Debugging Options
@@ -219,7 +233,7 @@ struct FreeDir {
 LINK_FORWARD_DECLARATION(CacheVC, opendir_link) // forward declaration
 struct OpenDirEntry {
   DLL<CacheVC, Link_CacheVC_opendir_link> writers; // list of all the current writers
-  DLL<CacheVC, Link_CacheVC_opendir_link> readers; // list of all the current readers - not used
+  DLL<CacheVC, Link_CacheVC_opendir_link> readers; // readers waiting for the writers, see wake_readers
   CacheHTTPInfoVector vector;                      // Vector for the http document. Each writer
                                                    // maintains a pointer to this vector and
                                                    // writes it down to disk.
@@ -237,6 +251,8 @@ struct OpenDirEntry {
   LINK(OpenDirEntry, link);
 
   int wait(CacheVC *c, int msec);
+  /// Reschedule the waiting readers now, a writer has committed a fragment or is gone.
+  void wake_readers();
 
   bool
   has_multiple_writers()
@@ -248,15 +264,52 @@ struct OpenDirEntry {
 struct OpenDir : public Continuation {
   Queue<CacheVC, Link_CacheVC_opendir_link> delayed_readers;
   DLL<OpenDirEntry> bucket[OPEN_DIR_BUCKETS];
+  /// Number of entries in each bucket. Only changed under the volume lock but readable without it.
+  std::atomic<uint32_t> bucket_entries[OPEN_DIR_BUCKETS] = {};
 
   int open_write(CacheVC *c, int allow_if_writers, int max_writers);
   int close_write(CacheVC *c);
   OpenDirEntry *open_read(const CryptoHash *key);
   int signal_readers(int event, Event *e);
 
+  /** Check for an open writer of @a key without the volume lock.
+
+      A false return means there was no writer for @a key when the check was made, the same
+      answer @c open_read would have given under the lock. A true return only means there may be
+      one (another key in the same bucket, or a writer closing concurrently) and @c open_read must
+      be used under the volume lock to find it.
+   */
+  bool
+  may_have_writer(const CryptoHash *key) const
+  {
+    return bucket_entries[key->slice32(0) % OPEN_DIR_BUCKETS].load(std::memory_order_acquire) != 0;
+  }
+
   OpenDir();
 };
 
+// Directory tag index
+//
+// Optional in memory side table with the tags of each bucket chain packed into one 16 byte
+// record, four buckets to a cache line. A probe compares the key tag against the whole record
+// with one vector compare and can report a miss without touching the directory. The on disk
+// directory format is not changed, the index is rebuilt from it when the volume is loaded and
+// kept up to date by every function in CacheDir.cc that changes a bucket chain.
+
+#define DIR_TAG_INDEX_TAGS 7
+#define DIR_TAG_INDEX_NONE 0xFFFF // unused tag lane, or count of a chain too long to index
+
+struct alignas(16) DirTagBucket {
+  uint16_t tag[DIR_TAG_INDEX_TAGS]; // tags of the chain, unused lanes are DIR_TAG_INDEX_NONE
+  uint16_t count;                   // length of the chain or DIR_TAG_INDEX_NONE
+};
+
+static_assert(sizeof(DirTagBucket) == 16, "DirTagBucket must fit a vector register");
+
+// Counting Bloom filter over the (bucket, tag) of the directory entries, two 4 bit counters a byte
+#define DIR_BLOOM_HASHES 4
+#define DIR_BLOOM_COUNT_MAX 15 // a counter that gets here sticks
+
 struct CacheSync : public Continuation {
   int vol_idx    = 0;
   char *buf      = nullptr;
@@ -288,12 +341,17 @@ void dir_lookaside_remove(const CacheKey *key, Vol *d);
 void dir_free_entry(Dir *e, int s, Vol *d);
 void dir_sync_init();
 int check_dir(Vol *d);
+void dir_check_segment(int s, Vol *d);
 void dir_clean_vol(Vol *d);
 void dir_clear_range(off_t start, off_t end, Vol *d);
 int dir_segment_accounted(int s, Vol *d, int offby = 0, int *free = nullptr, int *used = nullptr, int *empty = nullptr,
                           int *valid = nullptr, int *agg_valid = nullptr, int *avg_size = nullptr);
 uint64_t dir_entries_used(Vol *d);
 void sync_cache_dir_on_shutdown();
+void dir_tag_index_build(Vol *d);
+void dir_tag_index_update(Vol *d, int s, int b);
+void dir_bloom_build(Vol *d);
+void dir_bloom_update(Vol *d, int s, int b, uint32_t tag, int delta);
 
 // Global Data
 
@@ -309,6 +367,58 @@ dir_compare_tag(const Dir *e, const CacheKey *key)
   return (dir_tag(e) == DIR_MASK_TAG(key->slice32(2)));
 }
 
+// true if the chain of the bucket may contain an entry with tag @a t
+TS_INLINE bool
+dir_tag_bucket_match(const DirTagBucket *tb, uint32_t t)
+{
+  if (tb->count == DIR_TAG_INDEX_NONE) {
+    return true;
+  }
+#if defined(__SSE2__)
+  __m128i lanes = _mm_load_si128(reinterpret_cast<const __m128i *>(tb));
+  __m128i eq    = _mm_cmpeq_epi16(lanes, _mm_set1_epi16(static_cast<short>(t)));
+  // ignore the count lane
+  return (_mm_movemask_epi8(eq) & 0x3FFF) != 0;
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+  uint16x8_t eq = vceqq_u16(vld1q_u16(reinterpret_cast<const uint16_t *>(tb)), vdupq_n_u16(static_cast<uint16_t>(t)));
+  eq            = vsetq_lane_u16(0, eq, 7);
+  return vmaxvq_u16(eq) != 0;
+#else
+  for (int i = 0; i < DIR_TAG_INDEX_TAGS; i++) {
+    if (tb->tag[i] == t) {
+      return true;
+    }
+  }
+  return false;
+#endif
+}
+
+// The element of the Bloom filter for the entries with tag @a t in the chain of @a bucket of the volume.
+TS_INLINE uint64_t
+dir_bloom_hash(uint64_t bucket, uint32_t t)
+{
+  uint64_t x = (bucket << DIR_TAG_WIDTH) | t;
+  x ^= x >> 30;
+  x *= 0xbf58476d1ce4e5b9ULL;
+  x ^= x >> 27;
+  x *= 0x94d049bb133111ebULL;
+  return x ^ (x >> 31);
+}
+
+// false if no entry hashing to @a h is in the filter, may be called without the volume lock
+TS_INLINE bool
+dir_bloom_match(const std::atomic<uint8_t> *counters, uint64_t mask, uint64_t h)
+{
+  uint64_t step = (h >> 32) | 1;
+  for (int i = 0; i < DIR_BLOOM_HASHES; i++, h += step) {
+    uint64_t c = h & mask;
+    if (!((counters[c >> 1].load(std::memory_order_relaxed) >> ((c & 1) << 2)) & DIR_BLOOM_COUNT_MAX)) {
+      return false;
+    }
+  }
+  return true;
+}
+
 TS_INLINE Dir *
 dir_from_offset(int64_t i, Dir *seg)
 {
@@ -35,7 +35,7 @@ struct CacheHostResult;
 struct Cache;
 
 struct CacheHostRecord {
-  int Init(CacheType typ);
+  int Init(CacheType typ, int tier = 0);
   int Init(matcher_line *line_info, CacheType typ);
   void UpdateMatch(CacheHostResult *r, char *rd);
   void Print();
@@ -75,6 +75,7 @@ public:
   void Match(const char *rdata, int rlen, CacheHostResult *result);
   void AllocateSpace(int num_entries);
   void NewEntry(matcher_line *line_info);
+  void BuildIndex();
   void Print();
 
   int
@@ -137,6 +138,8 @@ public:
   Cache *cache     = nullptr;
   int m_numEntries = 0;
   CacheHostRecord gen_host_rec;
+  // The volumes of each faster tier, shared by all hosts. Tier 0 are the records above.
+  CacheHostRecord tier_host_rec[CACHE_TIER_MAX];
 
 private:
   CacheHostMatcher *hostMatch    = nullptr;
@@ -172,6 +175,9 @@ struct ConfigVol {
   off_t size;
   bool in_percent;
   bool ramcache_enabled;
+  int tier;
+  int admit_hits;
+  int64_t admit_size;
   int percent;
   CacheVol *cachep;
   LINK(ConfigVol, link);
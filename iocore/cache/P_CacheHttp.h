@@ -42,6 +42,28 @@ struct vec_info {
   CacheHTTPInfo alternate;
 };
 
+#define CACHE_ALT_SUMMARY_MAGIC 0x414c5453 // "ALTS"
+#define CACHE_ALT_SUMMARY_VARY_MAX 6
+#define CACHE_ALT_SUMMARY_VARY_MANY 0xfe // More Vary fields than are summarized.
+#define CACHE_ALT_SUMMARY_VARY_ALL 0xff  // Vary: *
+
+/** What is needed to rule an alternate out on its Vary fields without touching its header heaps.
+
+    One is marshaled per alternate behind the alternates of a vector, followed by a
+    @c CacheAltSummaryTrailer. Fields that the configuration says to ignore are hashed
+    as well, the match skips them.
+ */
+struct CacheAltSummary {
+  uint32_t vary_names;                       ///< @c HttpCompat::vary_header_values_hash of the response Vary.
+  uint32_t nvary;                            ///< Number of @a vary hashes, or a @c CACHE_ALT_SUMMARY_VARY_ value.
+  uint32_t vary[CACHE_ALT_SUMMARY_VARY_MAX]; ///< Hash of the request values of each field named by Vary.
+};
+
+struct CacheAltSummaryTrailer {
+  uint32_t magic;
+  uint32_t count;
+};
+
 struct CacheHTTPInfoVector {
   void *magic = nullptr;
 
@@ -61,19 +83,24 @@ struct CacheHTTPInfoVector {
   void
   reset()
   {
-    xcount = 0;
+    xcount  = 0;
+    summary = nullptr;
     data.clear();
   }
   void print(char *buffer, size_t buf_size, bool temps = true);
 
   int marshal_length();
   int marshal(char *buf, int length);
-  uint32_t get_handles(const char *buf, int length, RefCountObj *block_ptr = nullptr);
+  uint32_t get_handles(const char *buf, int length, RefCountObj *block_ptr = nullptr, bool with_summary = false);
   int unmarshal(const char *buf, int length, RefCountObj *block_ptr);
+  /// Length of the alternates of a marshaled vector, without the summaries behind them.
+  static int alternates_length(const char *buf, int length);
 
   CacheArray<vec_info> data;
   int xcount = 0;
   Ptr<RefCountObj> vector_buf;
+  /// One per alternate, nullptr unless the vector was loaded from a doc that has them and not changed since.
+  const CacheAltSummary *summary = nullptr;
 };
 
 TS_INLINE CacheHTTPInfo *
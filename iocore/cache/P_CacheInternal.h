@@ -41,6 +41,9 @@ struct EvacuationBlock;
 
 #define INTEGRAL_FRAGS 4
 
+// most bytes a CacheVC reads along with a fragment, see proxy.config.cache.read_ahead
+#define CACHE_READ_AHEAD_MAX (64 * 1024 * 1024)
+
 #ifdef CACHE_INSPECTOR_PAGES
 #ifdef DEBUG
 #define CACHE_STAT_PAGES
@@ -84,15 +87,20 @@ struct EvacuationBlock;
 
 #define CONT_SCHED_LOCK_RETRY(_c) _c->mutex->thread_holding->schedule_in_local(_c, HRTIME_MSECONDS(cache_config_mutex_retry_delay))
 
-#define VC_SCHED_WRITER_RETRY()                                           \
-  do {                                                                    \
-    ink_assert(!trigger);                                                 \
-    writer_lock_retry++;                                                  \
-    ink_hrtime _t = HRTIME_MSECONDS(cache_read_while_writer_retry_delay); \
-    if (writer_lock_retry > 2)                                            \
-      _t = HRTIME_MSECONDS(cache_read_while_writer_retry_delay) * 2;      \
-    trigger = mutex->thread_holding->schedule_in_local(this, _t);         \
-    return EVENT_CONT;                                                    \
+// With read_while_writer.push the reader also waits on the writer's OpenDirEntry, which wakes it
+// as soon as a fragment is committed. The timer is then only a backstop. Needs the volume lock.
+#define VC_SCHED_WRITER_RETRY()                                                                     \
+  do {                                                                                              \
+    ink_assert(!trigger);                                                                           \
+    writer_lock_retry++;                                                                            \
+    int _ms = cache_read_while_writer_retry_delay;                                                  \
+    if (writer_lock_retry > 2)                                                                      \
+      _ms *= 2;                                                                                     \
+    OpenDirEntry *_od = cache_config_read_while_writer_push ? vol->open_read(&first_key) : nullptr; \
+    if (_od)                                                                                        \
+      return _od->wait(this, _ms);                                                                  \
+    trigger = mutex->thread_holding->schedule_in_local(this, HRTIME_MSECONDS(_ms));                 \
+    return EVENT_CONT;                                                                              \
   } while (0)
 
 // cache stats definitions
@@ -126,6 +134,10 @@ enum {
   cache_evacuate_active_stat,
   cache_evacuate_success_stat,
   cache_evacuate_failure_stat,
+  cache_evacuate_readahead_stat,
+  cache_read_ahead_stat,
+  cache_agg_stalls_stat,
+  cache_agg_stall_time_stat,
   cache_scan_active_stat,
   cache_scan_success_stat,
   cache_scan_failure_stat,
@@ -135,6 +147,7 @@ enum {
   cache_three_plus_plus_fragment_document_count_stat,
   cache_read_busy_success_stat,
   cache_read_busy_failure_stat,
+  cache_read_busy_wakeups_stat,
   cache_gc_bytes_evacuated_stat,
   cache_gc_frags_evacuated_stat,
   cache_write_bytes_stat,
@@ -145,6 +158,9 @@ enum {
   cache_directory_sync_count_stat,
   cache_directory_sync_time_stat,
   cache_directory_sync_bytes_stat,
+  /* Volume lock misses in the open directory paths */
+  cache_open_dir_lock_contention_stat,
+  cache_open_dir_lock_avoided_stat,
   /* AIO read/write error counters */
   cache_span_errors_read_stat,
   cache_span_errors_write_stat,
@@ -155,6 +171,29 @@ enum {
   cache_span_offline_stat,
   cache_span_online_stat,
   cache_span_failing_stat,
+  /* Directory load progress at startup */
+  cache_dir_load_bytes_total_stat,
+  cache_dir_load_bytes_read_stat,
+  cache_dir_load_volumes_stat,
+  cache_dir_load_volumes_ready_stat,
+  /* RAM cache warm start */
+  cache_ram_cache_warm_objects_stat,
+  cache_ram_cache_warm_bytes_stat,
+  /* Volume tiers, the hit counters are per tier */
+  cache_tier_lookups_stat,
+  cache_tier_hits_stat,
+  cache_tier_hit_bytes_stat  = cache_tier_hits_stat + CACHE_TIER_MAX,
+  cache_tier_promotions_stat = cache_tier_hit_bytes_stat + CACHE_TIER_MAX,
+  cache_tier_demotions_stat,
+  cache_tier_copy_failures_stat,
+  /* Directory Bloom filter, the rate is the average of a 0 or 1 per lookup of a missing key */
+  cache_dir_bloom_negatives_stat,
+  cache_dir_bloom_false_positive_rate_stat,
+  /* Write admission and recycling of popular objects */
+  cache_write_admission_rejects_stat,
+  cache_recycled_stat,
+  /* Alternates of the HTTP objects read */
+  cache_read_alternates_stat,
   cache_stat_count
 };
 
@@ -206,26 +245,42 @@ extern RecRawStatBlock *cache_rsb;
 
 // Configuration
 extern int cache_config_dir_sync_frequency;
+extern int cache_config_dir_tag_index;
+extern int cache_config_dir_bloom_filter;
+extern int64_t cache_config_dir_load_chunk_size;
+extern int cache_config_dir_load_parallel;
+extern int cache_config_dir_load_early_serve;
+extern int cache_config_key_hash;
 extern int cache_config_http_max_alts;
 extern int cache_config_permit_pinning;
 extern int cache_config_select_alternate;
 extern int cache_config_max_doc_size;
 extern int cache_config_min_average_object_size;
 extern int cache_config_agg_write_backlog;
+extern int cache_config_agg_write_max_in_flight;
 extern int cache_config_enable_checksum;
 extern int cache_config_alt_rewrite_max_size;
 extern int cache_config_read_while_writer;
 extern int cache_config_agg_write_backlog;
 extern int cache_config_ram_cache_compress;
 extern int cache_config_ram_cache_compress_percent;
+extern int cache_config_ram_cache_compress_threads;
 extern int cache_config_ram_cache_use_seen_filter;
+extern int cache_config_ram_cache_warm_start;
+extern int cache_config_ram_cache_warm_start_rate;
+extern int cache_config_tier_promote_hits;
+extern int cache_config_tier_demote;
 extern int cache_config_hit_evacuate_percent;
 extern int cache_config_hit_evacuate_size_limit;
+extern int cache_config_hit_evacuate_reads;
+extern int64_t cache_config_evacuate_readahead;
+extern int64_t cache_config_read_ahead;
 extern int cache_config_force_sector_size;
 extern int cache_config_target_fragment_size;
 extern int cache_config_mutex_retry_delay;
 extern int cache_read_while_writer_retry_delay;
 extern int cache_config_read_while_writer_max_retries;
+extern int cache_config_read_while_writer_push;
 
 // CacheVC
 struct CacheVC : public CacheVConnection {
@@ -301,14 +356,17 @@ struct CacheVC : public CacheVConnection {
   }
 
   bool writer_done();
+  void stop_waiting_for_writer();
   int calluser(int event);
   int callcont(int event);
   int die();
   int dead(int event, Event *e);
 
   int handleReadDone(int event, Event *e);
+  int handleReadAheadDone(int event, Event *e);
   int handleRead(int event, Event *e);
   int do_read_call(CacheKey *akey);
+  int do_tier_read_call();
   int handleWrite(int event, Event *e);
   int handleWriteLock(int event, Event *e);
   int do_write_call();
@@ -372,6 +430,8 @@ struct CacheVC : public CacheVConnection {
   }
   int evacuateDocDone(int event, Event *e);
   int evacuateReadHead(int event, Event *e);
+  int evacuateReadAheadDone(int event, Event *e);
+  int tierCopyDone(int event, Event *e);
 
   void cancel_trigger();
   int64_t get_object_size() override;
@@ -421,6 +481,7 @@ struct CacheVC : public CacheVConnection {
   Ptr<IOBufferData> first_buf;
   Ptr<IOBufferBlock> blocks; // data available to write
   Ptr<IOBufferBlock> writer_buf;
+  Ptr<IOBufferData> readahead_buf; // fragments read along with the last one read from disk
 
   OpenDirEntry *od;
   AIOCallbackInternal io;
@@ -449,6 +510,7 @@ struct CacheVC : public CacheVConnection {
   uint32_t agg_len;      // for communicating with aggWrite
   uint32_t write_serial; // serial of the final write for SYNC
   Vol *vol;
+  Vol *tier_home; // home volume of a read from a faster tier, update_key is the key there
   Dir *last_collision;
   Event *trigger;
   CacheKey *read_key;
@@ -467,6 +529,9 @@ struct CacheVC : public CacheVConnection {
   uint64_t total_len;    // total length written and available to write
   uint64_t doc_len;      // total_length (of the selected alternate for HTTP)
   uint64_t update_len;
+  off_t readahead_offset;   // disk offset of readahead_buf
+  uint32_t readahead_len;   // bytes in readahead_buf
+  uint32_t readahead_first; // of which the fragment the read was for
   int fragment;
   int scan_msec_delay;
   CacheVC *write_vc;
@@ -489,7 +554,7 @@ struct CacheVC : public CacheVConnection {
       unsigned int update : 1;
       unsigned int remove : 1;
       unsigned int remove_aborted_writers : 1;
-      unsigned int open_read_timeout : 1; // UNUSED
+      unsigned int open_read_timeout : 1; // waiting in OpenDirEntry::readers, under the volume lock
       unsigned int data_done : 1;
       unsigned int read_from_writer_called : 1;
       unsigned int not_from_ram_cache : 1; // entire object was from ram cache
@@ -499,6 +564,7 @@ struct CacheVC : public CacheVConnection {
       unsigned int hit_evacuate : 1;
       unsigned int compressed_in_ram : 1; // compressed state in ram cache
       unsigned int allow_empty_doc : 1;   // used for cache empty http document
+      unsigned int not_admitted : 1;      // refused by the admission filter of the volume
     } f;
   };
   // BTF optimization used to skip reading stuff in cache partition that doesn't contain any
@@ -529,6 +595,11 @@ struct CacheRemoveCont : public Continuation {
   CacheRemoveCont() : Continuation(nullptr) {}
 };
 
+// Docs older than this were marshaled before #4874 and have their alternates unmarshaled the old way.
+constexpr ts::VersionNumber CACHE_DB_VERSION_HEAP_FIXUP(24, 2);
+// Docs from this version on have a CacheAltSummary per alternate behind their vector.
+constexpr ts::VersionNumber CACHE_DB_VERSION_ALT_SUMMARY(24, 3);
+
 // Global Data
 extern ClassAllocator<CacheVC> cacheVConnectionAllocator;
 extern CacheKey zero_key;
@@ -536,7 +607,17 @@ extern CacheSync *cacheDirSync;
 // Function Prototypes
 int cache_write(CacheVC *, CacheHTTPInfoVector *);
 int get_alternate_index(CacheHTTPInfoVector *cache_vector, CacheKey key);
+void unmarshal_helper(Doc *doc, Ptr<IOBufferData> &buf, int &okay);
+int doc_alternates_len(Doc *doc);
 CacheVC *new_DocEvacuator(int nbytes, Vol *d);
+void cache_tier_key(CacheKey *tier_key, const CacheKey *key, const Dir *dir);
+int cache_tier_faster(Cache *cache, int tier);
+int cache_tier_slower(Cache *cache, int tier);
+void cache_tier_read_hit(CacheVC *vc);
+void cache_tier_demote(Vol *vol, Ptr<IOBufferData> &buf, const Dir *dir);
+bool cache_write_admit(CacheVC *vc, int64_t size);
+void cache_recycle_read_hit(CacheVC *vc);
+bool cache_recycle_popular(Vol *vol, const Dir *dir);
 
 // inline Functions
 
@@ -602,6 +683,7 @@ free_CacheVC(CacheVC *cont)
   cont->first_buf.clear();
   cont->blocks.clear();
   cont->writer_buf.clear();
+  cont->readahead_buf.clear();
   cont->alternate_index = CACHE_ALT_INDEX_DEFAULT;
   if (cont->scan_vol_map) {
     ats_free(cont->scan_vol_map);
@@ -663,6 +745,18 @@ CacheVC::do_write_call()
   return handleWrite(EVENT_CALL, nullptr);
 }
 
+// Leave the readers of the writer's OpenDirEntry if it has not woken us, see VC_SCHED_WRITER_RETRY.
+TS_INLINE void
+CacheVC::stop_waiting_for_writer()
+{
+  ink_assert(vol->mutex->thread_holding == this_ethread());
+  if (f.open_read_timeout) {
+    // The writer takes every reader off before the entry goes away.
+    vol->open_read(&first_key)->readers.remove(this);
+    f.open_read_timeout = 0;
+  }
+}
+
 TS_INLINE void
 CacheVC::cancel_trigger()
 {
@@ -817,6 +911,9 @@ Vol::open_write_lock(CacheVC *cont, int allow_if_writers, int max_writers)
 TS_INLINE OpenDirEntry *
 Vol::open_read_lock(CryptoHash *key, EThread *t)
 {
+  if (!open_dir.may_have_writer(key)) {
+    return nullptr;
+  }
   CACHE_TRY_LOCK(lock, mutex, t);
   if (!lock.is_locked()) {
     return nullptr;
@@ -824,6 +921,16 @@ Vol::open_read_lock(CryptoHash *key, EThread *t)
   return open_dir.open_read(key);
 }
 
+TS_INLINE bool
+Vol::dir_bloom_may_contain(const CryptoHash *key) const
+{
+  if (!dir_bloom) {
+    return true;
+  }
+  uint64_t bucket = static_cast<uint64_t>(key->slice32(0) % segments) * buckets + key->slice32(1) % buckets;
+  return dir_bloom_match(dir_bloom, dir_bloom_mask, dir_bloom_hash(bucket, DIR_MASK_TAG(key->slice32(2))));
+}
+
 TS_INLINE int
 Vol::begin_read_lock(CacheVC *cont)
 {
@@ -1006,6 +1113,7 @@ struct Cache {
   int open_done();
 
   Vol *key_to_vol(const CacheKey *key, const char *hostname, int host_len);
+  Vol *key_to_tier_vol(const CacheKey *key, int tier);
 
   Cache() {}
 };
@@ -36,9 +36,11 @@
 #define VOL_MAGIC 0xF1D0F00D
 #define START_BLOCKS 16 // 8k, STORE_BLOCK_SIZE
 #define START_POS ((off_t)START_BLOCKS * CACHE_BLOCK_SIZE)
-#define AGG_SIZE (4 * 1024 * 1024)     // 4MB
-#define AGG_HIGH_WATER (AGG_SIZE / 2)  // 2MB
-#define EVACUATION_SIZE (2 * AGG_SIZE) // 8MB
+#define AGG_SIZE (4 * 1024 * 1024)         // 4MB
+#define AGG_HIGH_WATER (AGG_SIZE / 2)      // 2MB
+#define EVACUATION_SIZE (2 * AGG_SIZE)     // 8MB
+#define AGG_WRITES_MAX 8                   // aggregation writes in flight per volume
+#define AGG_WRITE_SIZE_MIN (AGG_SIZE / 16) // 256KB, smallest write the size adapts to
 #define MAX_VOL_SIZE ((off_t)512 * 1024 * 1024 * 1024 * 1024)
 #define STORE_BLOCKS_PER_CACHE_BLOCK (STORE_BLOCK_SIZE / CACHE_BLOCK_SIZE)
 #define MAX_VOL_BLOCKS (MAX_VOL_SIZE / CACHE_BLOCK_SIZE)
@@ -51,6 +53,7 @@
 #define LOOKASIDE_SIZE 256
 #define EVACUATION_BUCKET_SIZE (2 * EVACUATION_SIZE) // 16MB
 #define RECOVERY_SIZE EVACUATION_SIZE                // 8MB
+#define EVACUATION_READAHEAD_MAX 8                   // evacuation reads ahead of the write cursor
 #define AIO_NOT_IN_PROGRESS 0
 #define AIO_AGG_WRITE_IN_PROGRESS -1
 #define AUTO_SIZE_RAM_CACHE -1                               // 1-1 with directory size
@@ -88,7 +91,7 @@ struct VolHeaderFooter {
   uint32_t write_serial;
   uint32_t dirty;
   uint32_t sector_size;
-  uint32_t unused; // pad out to 8 byte boundary
+  uint32_t key_hash; // CacheKeyHash, also pads out to 8 byte boundary
   uint16_t freelist[1];
 };
 
@@ -106,7 +109,9 @@ struct EvacuationBlock {
       unsigned int done : 1;          // has been evacuated
       unsigned int pinned : 1;        // check pinning timeout
       unsigned int evacuate_head : 1; // check pinning timeout
-      unsigned int unused : 29;
+      unsigned int demote : 1;        // copy to the next slower tier instead of rewriting it here
+      unsigned int reading : 1;       // read ahead of the write cursor in flight
+      unsigned int unused : 27;
     } f;
   };
 
@@ -119,6 +124,19 @@ struct EvacuationBlock {
   LINK(EvacuationBlock, link);
 };
 
+// One aggregation write of a volume and the buffer it writes, see Vol::aggWrite.
+struct AggWrite : public Continuation {
+  Vol *vol     = nullptr;
+  char *buffer = nullptr;
+  AIOCallbackInternal io;
+  ink_hrtime start = 0;
+  bool done        = false;
+
+  int aggWriteDone(int event, Event *e);
+
+  AggWrite() { SET_HANDLER(&AggWrite::aggWriteDone); }
+};
+
 struct Vol : public Continuation {
   char *path = nullptr;
   ats_scoped_str hash_text;
@@ -129,6 +147,8 @@ struct Vol : public Continuation {
   Dir *dir                = nullptr;
   VolHeaderFooter *header = nullptr;
   VolHeaderFooter *footer = nullptr;
+  DirTagBucket *tag_index = nullptr; // optional, see dir_tag_index_build
+  uint8_t *dirty_segments = nullptr; // DIR_SYNC_* bits per segment, see dir_segment_dirty
   int segments            = 0;
   off_t buckets           = 0;
   off_t recover_pos       = 0;
@@ -141,6 +161,10 @@ struct Vol : public Continuation {
   int hit_evacuate_window = 0;
   AIOCallbackInternal io;
 
+  // Counting Bloom filter of the directory, optional, see dir_bloom_build
+  std::atomic<uint8_t> *dir_bloom = nullptr;
+  uint64_t dir_bloom_mask         = 0; // number of counters less one
+
   Queue<CacheVC, Continuation::Link_link> agg;
   Queue<CacheVC, Continuation::Link_link> stat_cache_vcs;
   Queue<CacheVC, Continuation::Link_link> sync;
@@ -148,6 +172,20 @@ struct Vol : public Continuation {
   int agg_todo_size = 0;
   int agg_buf_pos   = 0;
 
+  // Writes in flight land in order from agg_write_head, agg_buffer is the buffer of the next one.
+  AggWrite agg_writes[AGG_WRITES_MAX];
+  int agg_writes_max       = 1;
+  int agg_write_head       = 0;
+  int agg_writes_in_flight = 0;
+  // Size at which the aggregation buffer is written, see agg_write_adapt
+  int agg_high_water = AGG_HIGH_WATER;
+  // Decayed sums of the sizes (x) and latencies (y) of landed writes
+  double agg_lat_n  = 0;
+  double agg_lat_x  = 0;
+  double agg_lat_y  = 0;
+  double agg_lat_xx = 0;
+  double agg_lat_xy = 0;
+
   Event *trigger = nullptr;
 
   OpenDir open_dir;
@@ -156,6 +194,10 @@ struct Vol : public Continuation {
   DLL<EvacuationBlock> *evacuate = nullptr;
   DLL<EvacuationBlock> lookaside[LOOKASIDE_SIZE];
   CacheVC *doc_evacuator = nullptr;
+  // Evacuation reads issued ahead of the write cursor, see evac_readahead
+  int evac_readahead_in_flight = 0;
+  // When aggWrite started waiting on evacuation reads, 0 if it is not
+  ink_hrtime agg_stall_start = 0;
 
   VolInitInfo *init_info = nullptr;
 
@@ -169,6 +211,20 @@ struct Vol : public Continuation {
   bool dir_sync_waiting      = false;
   bool dir_sync_in_progress  = false;
   bool writing_end_marker    = false;
+  bool dir_registered        = false;
+  // Set once the directory is loaded and checked, volumes can be registered before that.
+  std::atomic<bool> dir_ready{false};
+  uint64_t dir_used_at_load = 0;
+
+  // Read counts of the objects in this volume, see cache_tier_read_hit
+  uint8_t *tier_hits     = nullptr;
+  uint32_t tier_hits_age = 0;
+
+  // Write counts for the admission filter and read counts for recycling, see CacheAdmission.cc
+  uint8_t *admit_sketch     = nullptr;
+  uint32_t admit_sketch_age = 0;
+  uint8_t *recycle_hits     = nullptr;
+  uint32_t recycle_hits_age = 0;
 
   CacheKey first_fragment_key;
   int64_t first_fragment_offset = 0;
@@ -190,6 +246,8 @@ struct Vol : public Continuation {
   OpenDirEntry *open_read_lock(CryptoHash *key, EThread *t);
   int close_read(CacheVC *cont);
   int close_read_lock(CacheVC *cont);
+  // false if @a key is certainly not in the directory, without the lock, see dir_bloom_build
+  bool dir_bloom_may_contain(const CryptoHash *key) const;
 
   int clear_dir();
 
@@ -202,6 +260,11 @@ struct Vol : public Continuation {
   int handle_header_read(int event, void *data);
 
   int dir_init_done(int event, void *data);
+  void dir_load_register();
+
+  void read_dir(off_t base);
+  bool read_dir_next(AIOCallback *op);
+  void read_dir_done(AIOCallback *op);
 
   int dir_check(bool fix);
   int db_check(bool fix);
@@ -230,14 +293,23 @@ struct Vol : public Continuation {
   int aggWriteDone(int event, Event *e);
   int aggWrite(int event, void *e);
   void agg_wrap();
+  void agg_write_init(int max_in_flight);
+  void agg_write_adapt(AggWrite *w);
+  char *agg_buf_data(off_t offset);
 
   int evacuateWrite(CacheVC *evacuator, int event, Event *e);
+  void evacuate_enqueue(CacheVC *evacuator);
   int evacuateDocReadDone(int event, Event *e);
+  bool evacuate_doc(CacheVC *evacuator);
   int evacuateDoc(int event, Event *e);
 
   int evac_range(off_t start, off_t end, int evac_phase);
+  void evac_readahead();
+  void evac_readahead_range(off_t low, off_t high, int evac_phase);
   void periodic_scan();
   void scan_for_pinned_documents();
+  void scan_for_demotions();
+  void scan_for_popular_documents();
   void evacuate_cleanup_blocks(int i);
   void evacuate_cleanup();
   EvacuationBlock *force_evacuate_head(Dir *dir, int pinned);
@@ -266,10 +338,32 @@ struct Vol : public Continuation {
     open_dir.mutex = mutex;
     agg_buffer     = (char *)ats_memalign(ats_pagesize(), AGG_SIZE);
     memset(agg_buffer, 0, AGG_SIZE);
+#if AIO_MODE == AIO_MODE_IO_URING
+    ink_aio_register_fixed_buffer(agg_buffer, AGG_SIZE);
+#endif
+    agg_writes[0].buffer = agg_buffer;
+    for (auto &w : agg_writes) {
+      w.vol   = this;
+      w.mutex = mutex;
+    }
     SET_HANDLER(&Vol::aggWrite);
   }
 
-  ~Vol() override { ats_memalign_free(agg_buffer); }
+  ~Vol() override
+  {
+    for (int i = 0; i < agg_writes_max; i++) {
+#if AIO_MODE == AIO_MODE_IO_URING
+      ink_aio_unregister_fixed_buffer(agg_writes[i].buffer);
+#endif
+      ats_memalign_free(agg_writes[i].buffer);
+    }
+    ats_memalign_free(tag_index);
+    delete[] dir_bloom;
+    ats_free(dirty_segments);
+    ats_free(tier_hits);
+    ats_free(admit_sketch);
+    ats_free(recycle_hits);
+  }
 };
 
 struct AIO_Callback_handler : public Continuation {
@@ -278,12 +372,18 @@ struct AIO_Callback_handler : public Continuation {
   AIO_Callback_handler() : Continuation(new_ProxyMutex()) { SET_HANDLER(&AIO_Callback_handler::handle_disk_failure); }
 };
 
+// Number of volume tiers, tier 0 holds every object and faster tiers hold copies of the popular ones.
+#define CACHE_TIER_MAX 3
+
 struct CacheVol {
   int vol_number        = -1;
   int scheme            = 0;
   off_t size            = 0;
   int num_vols          = 0;
   bool ramcache_enabled = true;
+  int tier              = 0;
+  int admit_hits        = 0;
+  int64_t admit_size    = 0;
   Vol **vols            = nullptr;
   DiskVol **disk_vols   = nullptr;
   LINK(CacheVol, link);
@@ -364,6 +464,14 @@ Vol::direntries()
   return this->buckets * DIR_DEPTH * this->segments;
 }
 
+// Note that segment @a s changed and has to be written to both directory copies.
+TS_INLINE void
+dir_segment_dirty(Vol *d, int s)
+{
+  d->header->dirty = 1;
+  d->dirty_segments[s] |= DIR_SYNC_ALL;
+}
+
 TS_INLINE int
 Vol::vol_out_of_phase_valid(Dir *e)
 {
@@ -385,7 +493,7 @@ Vol::vol_out_of_phase_write_valid(Dir *e)
 TS_INLINE int
 Vol::vol_in_phase_valid(Dir *e)
 {
-  return (dir_offset(e) - 1 < ((this->header->write_pos + this->agg_buf_pos - this->start) / CACHE_BLOCK_SIZE));
+  return (dir_offset(e) - 1 < ((this->header->agg_pos + this->agg_buf_pos - this->start) / CACHE_BLOCK_SIZE));
 }
 
 TS_INLINE off_t
@@ -409,7 +517,7 @@ Vol::vol_offset_to_offset(off_t pos)
 TS_INLINE int
 Vol::vol_in_phase_agg_buf_valid(Dir *e)
 {
-  return (this->vol_offset(e) >= this->header->write_pos && this->vol_offset(e) < (this->header->write_pos + this->agg_buf_pos));
+  return (this->vol_offset(e) >= this->header->write_pos && this->vol_offset(e) < (this->header->agg_pos + this->agg_buf_pos));
 }
 // length of the partition not including the offset of location 0.
 TS_INLINE off_t
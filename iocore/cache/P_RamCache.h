@@ -25,6 +25,18 @@
 
 #include "I_Cache.h"
 
+#include <vector>
+
+/// A RAM cache entry as recorded on shutdown to be reloaded from disk on startup.
+struct RamCacheSnapshotEntry {
+  CryptoHash key;
+  uint32_t auxkey1;
+  uint32_t auxkey2;
+  uint32_t len;
+  uint32_t reserved;
+  uint64_t hits;
+};
+
 // Generic Ram Cache interface
 
 class RamCache
@@ -39,8 +51,32 @@ public:
   virtual int64_t size() const                                                                              = 0;
 
   virtual void init(int64_t max_bytes, Vol *vol) = 0;
+  // Limit the cache to percent of the bytes it was initialized with, evicting what is over it, 100 restores the limit.
+  virtual void shrink(int percent) = 0;
+
+  // Entries in memory that are worth reloading after a restart, the hottest first.
+  virtual void
+  snapshot(std::vector<RamCacheSnapshotEntry> & /* entries ATS_UNUSED */) const
+  {
+  }
+  // Restore the access history of an entry reloaded from a snapshot, returns 1 if it is in the cache.
+  virtual int
+  restore_hits(const CryptoHash * /* key ATS_UNUSED */, uint32_t /* auxkey1 ATS_UNUSED */, uint32_t /* auxkey2 ATS_UNUSED */,
+               uint64_t /* hits ATS_UNUSED */)
+  {
+    return 0;
+  }
+
   virtual ~RamCache(){};
 };
 
 RamCache *new_RamCacheLRU();
 RamCache *new_RamCacheCLFUS();
+RamCache *new_RamCacheWTinyLFU();
+
+// Warm start, see RamCacheSnapshot.cc.
+void ram_cache_snapshot_save();
+void ram_cache_warm_start();
+
+// Shrink the RAM caches of all volumes, see RamCache::shrink.
+void ram_cache_set_limit_percent(int percent);
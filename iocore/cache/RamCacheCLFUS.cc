@@ -33,12 +33,26 @@
 #ifdef HAVE_LZMA_H
 #include <lzma.h>
 #endif
+#ifdef HAVE_ZSTD_H
+#include <zstd.h>
+#include <zdict.h>
+#endif
+#ifdef HAVE_LZ4_H
+#include <lz4.h>
+#endif
+#include <algorithm>
+#include <vector>
 
 #define REQUIRED_COMPRESSION 0.9 // must get to this size or declared incompressible
 #define REQUIRED_SHRINK 0.8      // must get to this size or keep original buffer (with padding)
 #define HISTORY_HYSTERIA 10      // extra temporary history
 #define ENTRY_OVERHEAD 256       // per-entry overhead to consider when computing cache value/size
 #define LZMA_BASE_MEMLIMIT (64 * 1024 * 1024)
+#define ZSTD_LEVEL 3
+#define ZSTD_DICT_SIZE (64 * 1024)               // per volume dictionary
+#define ZSTD_DICT_SAMPLE_BYTES (4 * 1024 * 1024) // of entry data to train the dictionary on
+#define ZSTD_DICT_MAX_SAMPLE (16 * 1024)         // bytes taken from each entry
+#define COMPRESS_BATCH 32                        // entries compressed per volume lock release
 //#define CHECK_ACOUNTING 1 // very expensive double checking of all sizes
 
 #define REQUEUE_HITS(_h) ((_h) ? ((_h)-1) : 0)
@@ -70,10 +84,21 @@ struct RamCacheCLFUSEntry {
   Ptr<IOBufferData> data;
 };
 
+// An entry being compressed while the volume lock is released.
+struct RamCacheCLFUSCompressWork {
+  RamCacheCLFUSEntry *e;
+  Ptr<IOBufferData> data; // keeps the source alive and identifies the entry afterwards
+  uint32_t len;
+  CryptoHash key;
+  char *buf;           // compressed data, nullptr on failure
+  uint32_t compressed; // length of buf
+};
+
 class RamCacheCLFUS : public RamCache
 {
 public:
   RamCacheCLFUS() {}
+  ~RamCacheCLFUS() override;
 
   // returns 1 on found/stored, 0 on not found/stored, if provided auxkey1 and auxkey2 must match
   int get(CryptoHash *key, Ptr<IOBufferData> *ret_data, uint32_t auxkey1 = 0, uint32_t auxkey2 = 0) override;
@@ -83,15 +108,19 @@ public:
   int64_t size() const override;
 
   void init(int64_t max_bytes, Vol *vol) override;
+  void shrink(int percent) override;
+  void snapshot(std::vector<RamCacheSnapshotEntry> &entries) const override;
+  int restore_hits(const CryptoHash *key, uint32_t auxkey1, uint32_t auxkey2, uint64_t hits) override;
 
   void compress_entries(EThread *thread, int do_at_most = INT_MAX);
 
   // TODO move it to private.
   Vol *vol = nullptr; // for stats
 private:
-  int64_t _max_bytes = 0;
-  int64_t _bytes     = 0;
-  int64_t _objects   = 0;
+  int64_t _max_bytes  = 0;
+  int64_t _init_bytes = 0;
+  int64_t _bytes      = 0;
+  int64_t _objects    = 0;
 
   double _average_value                         = 0;
   int64_t _history                              = 0;
@@ -106,11 +135,37 @@ private:
   void _resize_hashtable();
   void _victimize(RamCacheCLFUSEntry *e);
   void _move_compressed(RamCacheCLFUSEntry *e);
+  void _compress(int ctype, RamCacheCLFUSCompressWork &w);
+  void _finish_compress(int ctype, RamCacheCLFUSCompressWork &w);
   RamCacheCLFUSEntry *_destroy(RamCacheCLFUSEntry *e);
   void _requeue_victims(Que(RamCacheCLFUSEntry, lru_link) & victims);
   void _tick(); // move CLOCK on history
+
+#ifdef HAVE_ZSTD_H
+  // Only used by the compressor, except for _zstd_ddict and _zstd_dctx which are used under the volume lock.
+  ZSTD_CCtx *_zstd_cctx           = nullptr;
+  ZSTD_DCtx *_zstd_dctx           = nullptr;
+  ZSTD_CDict *_zstd_cdict         = nullptr;
+  ZSTD_DDict *_zstd_ddict         = nullptr;
+  ZSTD_DDict *_zstd_ddict_pending = nullptr;
+  bool _zstd_dict_failed          = false;
+  std::vector<char> _zstd_samples;
+  std::vector<size_t> _zstd_sample_sizes;
+
+  bool _zstd_train(RamCacheCLFUSCompressWork *batch, int nbatch);
+#endif
 };
 
+RamCacheCLFUS::~RamCacheCLFUS()
+{
+#ifdef HAVE_ZSTD_H
+  ZSTD_freeCCtx(_zstd_cctx);
+  ZSTD_freeDCtx(_zstd_dctx);
+  ZSTD_freeCDict(_zstd_cdict);
+  ZSTD_freeDDict(_zstd_ddict);
+#endif
+}
+
 int64_t
 RamCacheCLFUS::size() const
 {
@@ -154,6 +209,16 @@ RamCacheCLFUSCompressor::mainEvent(int /* event ATS_UNUSED */, Event *e)
   case CACHE_COMPRESSION_LIBLZMA:
 #ifndef HAVE_LZMA_H
     Warning("lzma not available for RAM cache compression");
+#endif
+    break;
+  case CACHE_COMPRESSION_ZSTD:
+#ifndef HAVE_ZSTD_H
+    Warning("zstd not available for RAM cache compression");
+#endif
+    break;
+  case CACHE_COMPRESSION_LZ4:
+#ifndef HAVE_LZ4_H
+    Warning("lz4 not available for RAM cache compression");
 #endif
     break;
   }
@@ -165,6 +230,25 @@ RamCacheCLFUSCompressor::mainEvent(int /* event ATS_UNUSED */, Event *e)
 
 ClassAllocator<RamCacheCLFUSEntry> ramCacheCLFUSEntryAllocator("RamCacheCLFUSEntry");
 
+// Compression runs on its own threads if proxy.config.cache.ram_cache.compress_threads is set,
+// otherwise on the task threads. Each volume's compressor stays on one thread.
+static EventType
+ram_cache_compress_event_type()
+{
+  static EventType ET_RAM_CACHE_COMPRESS = ET_TASK;
+  static bool spawned                    = false;
+  if (!spawned) {
+    spawned = true;
+    if (cache_config_ram_cache_compress_threads > 0) {
+      size_t stacksize;
+      REC_ReadConfigInteger(stacksize, "proxy.config.thread.default.stacksize");
+      ET_RAM_CACHE_COMPRESS =
+        eventProcessor.spawn_event_threads("ET_RAM_CACHE_COMPRESS", cache_config_ram_cache_compress_threads, stacksize);
+    }
+  }
+  return ET_RAM_CACHE_COMPRESS;
+}
+
 static const int bucket_sizes[] = {127,      251,      509,       1021,      2039,      4093,       8191,      16381,   32749,
                                    65521,    131071,   262139,    524287,    1048573,   2097143,    4194301,   8388593, 16777213,
                                    33554393, 67108859, 134217689, 268435399, 536870909, 1073741789, 2147483647};
@@ -200,15 +284,41 @@ void
 RamCacheCLFUS::init(int64_t abytes, Vol *avol)
 {
   ink_assert(avol != nullptr);
-  vol              = avol;
-  this->_max_bytes = abytes;
+  vol               = avol;
+  this->_max_bytes  = abytes;
+  this->_init_bytes = abytes;
   DDebug("ram_cache", "initializing ram_cache %" PRId64 " bytes", abytes);
   if (!this->_max_bytes) {
     return;
   }
   this->_resize_hashtable();
   if (cache_config_ram_cache_compress) {
-    eventProcessor.schedule_every(new RamCacheCLFUSCompressor(this), HRTIME_SECOND, ET_TASK);
+    eventProcessor.schedule_every(new RamCacheCLFUSCompressor(this), HRTIME_SECOND, ram_cache_compress_event_type());
+  }
+}
+
+void
+RamCacheCLFUS::shrink(int percent)
+{
+  if (!this->_init_bytes) {
+    return;
+  }
+  this->_max_bytes = std::max<int64_t>(this->_init_bytes * percent / 100, 1);
+  DDebug("ram_cache", "limiting ram_cache to %" PRId64 " bytes", this->_max_bytes);
+  // The evicted entries go to the history like any victim, so they are readmitted as the cache grows back.
+  while (this->_bytes > this->_max_bytes) {
+    RamCacheCLFUSEntry *victim = this->_lru[0].dequeue();
+    if (!victim) {
+      break;
+    }
+    this->_bytes -= victim->size + ENTRY_OVERHEAD;
+    CACHE_SUM_DYN_STAT_THREAD(cache_ram_cache_bytes_stat, -(int64_t)victim->size);
+    if (victim == this->_compressed) {
+      this->_compressed = nullptr;
+    } else {
+      this->_ncompressed--;
+    }
+    this->_victimize(victim);
   }
 }
 
@@ -290,6 +400,31 @@ RamCacheCLFUS::get(CryptoHash *key, Ptr<IOBufferData> *ret_data, uint32_t auxkey
             ram_hit_state = RAM_HIT_COMPRESS_LIBLZMA;
             break;
           }
+#endif
+#ifdef HAVE_ZSTD_H
+          case CACHE_COMPRESSION_ZSTD: {
+            if (!this->_zstd_dctx) {
+              this->_zstd_dctx = ZSTD_createDCtx();
+            }
+            // entries compressed before the dictionary was trained do not use it
+            size_t l = (this->_zstd_ddict && ZSTD_getDictID_fromFrame(e->data->data(), e->compressed_len)) ?
+                         ZSTD_decompress_usingDDict(this->_zstd_dctx, b, e->len, e->data->data(), e->compressed_len, this->_zstd_ddict) :
+                         ZSTD_decompressDCtx(this->_zstd_dctx, b, e->len, e->data->data(), e->compressed_len);
+            if (ZSTD_isError(l) || l != e->len) {
+              goto Lfailed;
+            }
+            ram_hit_state = RAM_HIT_COMPRESS_ZSTD;
+            break;
+          }
+#endif
+#ifdef HAVE_LZ4_H
+          case CACHE_COMPRESSION_LZ4: {
+            if (static_cast<int>(e->len) != LZ4_decompress_safe(e->data->data(), b, e->compressed_len, e->len)) {
+              goto Lfailed;
+            }
+            ram_hit_state = RAM_HIT_COMPRESS_LZ4;
+            break;
+          }
 #endif
           }
           IOBufferData *data = new_xmalloc_IOBufferData(b, e->len);
@@ -417,153 +552,267 @@ RamCacheCLFUS::compress_entries(EThread *thread, int do_at_most)
     return;
   }
   ink_assert(vol != nullptr);
+  int ctype = cache_config_ram_cache_compress;
+  int n     = 0;
+  RamCacheCLFUSCompressWork batch[COMPRESS_BATCH];
   MUTEX_TAKE_LOCK(vol->mutex, thread);
-  if (!this->_compressed) {
-    this->_compressed  = this->_lru[0].head;
-    this->_ncompressed = 0;
-  }
-  float target = (cache_config_ram_cache_compress_percent / 100.0) * this->_objects;
-  int n        = 0;
-  char *b = nullptr, *bb = nullptr;
-  while (this->_compressed && target > this->_ncompressed) {
-    RamCacheCLFUSEntry *e = this->_compressed;
-    if (e->flag_bits.incompressible || e->flag_bits.compressed) {
-      goto Lcontinue;
-    }
-    n++;
-    if (do_at_most < n) {
-      break;
+  while (true) {
+    if (!this->_compressed) {
+      this->_compressed  = this->_lru[0].head;
+      this->_ncompressed = 0;
     }
-    {
-      e->compressed_len = e->size;
-      uint32_t l        = 0;
-      int ctype         = cache_config_ram_cache_compress;
-      switch (ctype) {
-      default:
-        goto Lcontinue;
-      case CACHE_COMPRESSION_FASTLZ:
-        l = static_cast<uint32_t>(static_cast<double>(e->len) * 1.05 + 66);
+    // pick the next batch of entries while holding the lock
+    float target = (cache_config_ram_cache_compress_percent / 100.0) * this->_objects;
+    int nbatch   = 0;
+    while (this->_compressed && target > this->_ncompressed && nbatch < COMPRESS_BATCH && n < do_at_most) {
+      RamCacheCLFUSEntry *e = this->_compressed;
+      if (!e->flag_bits.incompressible && !e->flag_bits.compressed) {
+        RamCacheCLFUSCompressWork &w = batch[nbatch++];
+        w.e                          = e;
+        w.data                       = e->data;
+        w.len                        = e->len;
+        w.key                        = e->key;
+        n++;
+      }
+      if (!e->lru_link.next) {
         break;
+      }
+      this->_compressed = e->lru_link.next;
+      this->_ncompressed++;
+    }
+    if (!nbatch) {
+      break;
+    }
+    // compress the batch without the lock
+    MUTEX_UNTAKE_LOCK(vol->mutex, thread);
+    for (int i = 0; i < nbatch; i++) {
+      this->_compress(ctype, batch[i]);
+    }
+#ifdef HAVE_ZSTD_H
+    bool new_dictionary = ctype == CACHE_COMPRESSION_ZSTD && this->_zstd_train(batch, nbatch);
+#endif
+    MUTEX_TAKE_LOCK(vol->mutex, thread);
+#ifdef HAVE_ZSTD_H
+    if (new_dictionary) {
+      this->_zstd_ddict = this->_zstd_ddict_pending;
+    }
+#endif
+    for (int i = 0; i < nbatch; i++) {
+      this->_finish_compress(ctype, batch[i]);
+    }
+    if (nbatch < COMPRESS_BATCH) {
+      break;
+    }
+  }
+  MUTEX_UNTAKE_LOCK(vol->mutex, thread);
+  return;
+}
+
+// Compress one entry of a batch into a new buffer, the volume lock is not held.
+void
+RamCacheCLFUS::_compress(int ctype, RamCacheCLFUSCompressWork &w)
+{
+  const char *src = w.data->data();
+  uint32_t l      = 0;
+  w.buf           = nullptr;
+  w.compressed    = 0;
+  switch (ctype) {
+  default:
+    return;
+  case CACHE_COMPRESSION_FASTLZ:
+    l = static_cast<uint32_t>(static_cast<double>(w.len) * 1.05 + 66);
+    break;
 #ifdef HAVE_ZLIB_H
-      case CACHE_COMPRESSION_LIBZ:
-        l = static_cast<uint32_t>(compressBound(e->len));
-        break;
+  case CACHE_COMPRESSION_LIBZ:
+    l = static_cast<uint32_t>(compressBound(w.len));
+    break;
 #endif
 #ifdef HAVE_LZMA_H
-      case CACHE_COMPRESSION_LIBLZMA:
-        l = e->len;
-        break;
+  case CACHE_COMPRESSION_LIBLZMA:
+    l = w.len;
+    break;
 #endif
-      }
-      // store transient data for lock release
-      Ptr<IOBufferData> edata = e->data;
-      uint32_t elen           = e->len;
-      CryptoHash key          = e->key;
-      MUTEX_UNTAKE_LOCK(vol->mutex, thread);
-      b           = static_cast<char *>(ats_malloc(l));
-      bool failed = false;
-      switch (ctype) {
-      default:
-        goto Lfailed;
-      case CACHE_COMPRESSION_FASTLZ:
-        if (e->len < 16) {
-          goto Lfailed;
-        }
-        if ((l = fastlz_compress(edata->data(), elen, b)) <= 0) {
-          failed = true;
-        }
-        break;
+#ifdef HAVE_ZSTD_H
+  case CACHE_COMPRESSION_ZSTD:
+    l = static_cast<uint32_t>(ZSTD_compressBound(w.len));
+    break;
+#endif
+#ifdef HAVE_LZ4_H
+  case CACHE_COMPRESSION_LZ4:
+    l = static_cast<uint32_t>(LZ4_compressBound(w.len));
+    break;
+#endif
+  }
+  w.buf       = static_cast<char *>(ats_malloc(l));
+  bool failed = false;
+  switch (ctype) {
+  case CACHE_COMPRESSION_FASTLZ:
+    if (w.len < 16) {
+      failed = true;
+    } else if ((l = fastlz_compress(src, w.len, w.buf)) <= 0) {
+      failed = true;
+    }
+    break;
 #ifdef HAVE_ZLIB_H
-      case CACHE_COMPRESSION_LIBZ: {
-        uLongf ll = l;
-        if ((Z_OK != compress(reinterpret_cast<Bytef *>(b), &ll, reinterpret_cast<Bytef *>(edata->data()), elen))) {
-          failed = true;
-        }
-        l = static_cast<int>(ll);
-        break;
-      }
+  case CACHE_COMPRESSION_LIBZ: {
+    uLongf ll = l;
+    if ((Z_OK != compress(reinterpret_cast<Bytef *>(w.buf), &ll, reinterpret_cast<const Bytef *>(src), w.len))) {
+      failed = true;
+    }
+    l = static_cast<int>(ll);
+    break;
+  }
 #endif
 #ifdef HAVE_LZMA_H
-      case CACHE_COMPRESSION_LIBLZMA: {
-        size_t pos = 0, ll = l;
-        if (LZMA_OK != lzma_easy_buffer_encode(LZMA_PRESET_DEFAULT, LZMA_CHECK_NONE, nullptr,
-                                               reinterpret_cast<uint8_t *>(edata->data()), elen, reinterpret_cast<uint8_t *>(b),
-                                               &pos, ll)) {
-          failed = true;
-        }
-        l = static_cast<int>(pos);
-        break;
-      }
+  case CACHE_COMPRESSION_LIBLZMA: {
+    size_t pos = 0, ll = l;
+    if (LZMA_OK != lzma_easy_buffer_encode(LZMA_PRESET_DEFAULT, LZMA_CHECK_NONE, nullptr, reinterpret_cast<const uint8_t *>(src),
+                                           w.len, reinterpret_cast<uint8_t *>(w.buf), &pos, ll)) {
+      failed = true;
+    }
+    l = static_cast<int>(pos);
+    break;
+  }
 #endif
+#ifdef HAVE_ZSTD_H
+  case CACHE_COMPRESSION_ZSTD: {
+    if (!this->_zstd_cctx) {
+      this->_zstd_cctx = ZSTD_createCCtx();
+    }
+    size_t ll = this->_zstd_cdict ? ZSTD_compress_usingCDict(this->_zstd_cctx, w.buf, l, src, w.len, this->_zstd_cdict) :
+                                    ZSTD_compressCCtx(this->_zstd_cctx, w.buf, l, src, w.len, ZSTD_LEVEL);
+    if (ZSTD_isError(ll)) {
+      failed = true;
+    }
+    l = static_cast<uint32_t>(ll);
+    break;
+  }
+#endif
+#ifdef HAVE_LZ4_H
+  case CACHE_COMPRESSION_LZ4: {
+    int ll = LZ4_compress_default(src, w.buf, w.len, l);
+    if (ll <= 0) {
+      failed = true;
+    }
+    l = static_cast<uint32_t>(ll);
+    break;
+  }
+#endif
+  }
+  if (failed) {
+    ats_free(w.buf);
+    w.buf = nullptr;
+    return;
+  }
+  w.compressed = l;
+}
+
+// Install the result of _compress if the entry is still around, the volume lock is held.
+void
+RamCacheCLFUS::_finish_compress(int ctype, RamCacheCLFUSCompressWork &w)
+{
+  RamCacheCLFUSEntry *e = w.e;
+  char *bb              = nullptr;
+  uint32_t l            = w.compressed;
+  {
+    uint32_t i             = w.key.slice32(3) % this->_nbuckets;
+    RamCacheCLFUSEntry *ee = this->_bucket[i].head;
+    while (ee) {
+      if (ee->key == w.key && ee->data == w.data) {
+        break;
       }
-      MUTEX_TAKE_LOCK(vol->mutex, thread);
-      // see if the entry is till around
-      {
-        if (failed) {
-          goto Lfailed;
-        }
-        uint32_t i             = key.slice32(3) % this->_nbuckets;
-        RamCacheCLFUSEntry *ee = this->_bucket[i].head;
-        while (ee) {
-          if (ee->key == key && ee->data == edata) {
-            break;
-          }
-          ee = ee->hash_link.next;
-        }
-        if (!ee || ee != e) {
-          e = this->_compressed;
-          ats_free(b);
-          goto Lcontinue;
-        }
-      }
-      if (l > REQUIRED_COMPRESSION * e->len) {
-        e->flag_bits.incompressible = true;
-      }
-      if (l > REQUIRED_SHRINK * e->size) {
-        goto Lfailed;
-      }
-      if (l < e->len) {
-        e->flag_bits.compressed = cache_config_ram_cache_compress;
-        bb                      = static_cast<char *>(ats_malloc(l));
-        memcpy(bb, b, l);
-        ats_free(b);
-        e->compressed_len = l;
-        int64_t delta     = (static_cast<int64_t>(l)) - static_cast<int64_t>(e->size);
-        this->_bytes += delta;
-        CACHE_SUM_DYN_STAT_THREAD(cache_ram_cache_bytes_stat, delta);
-        e->size = l;
-      } else {
-        ats_free(b);
-        e->flag_bits.compressed = 0;
-        bb                      = static_cast<char *>(ats_malloc(e->len));
-        memcpy(bb, e->data->data(), e->len);
-        int64_t delta = (static_cast<int64_t>(e->len)) - static_cast<int64_t>(e->size);
-        this->_bytes += delta;
-        CACHE_SUM_DYN_STAT_THREAD(cache_ram_cache_bytes_stat, delta);
-        e->size = e->len;
-        l       = e->len;
-      }
-      e->data            = new_xmalloc_IOBufferData(bb, l);
-      e->data->_mem_type = DEFAULT_ALLOC;
-      check_accounting(this);
+      ee = ee->hash_link.next;
     }
-    goto Lcontinue;
-  Lfailed:
-    ats_free(b);
-    e->flag_bits.incompressible = 1;
-  Lcontinue:;
-    DDebug("ram_cache", "compress %X %d %d %d %d %d %d %d", e->key.slice32(3), e->auxkey1, e->auxkey2, e->flag_bits.incompressible,
-           e->flag_bits.compressed, e->len, e->compressed_len, this->_ncompressed);
-    if (!e->lru_link.next) {
-      break;
+    w.data = nullptr;
+    if (!ee || ee != e) {
+      ats_free(w.buf);
+      return;
     }
-    this->_compressed = e->lru_link.next;
-    this->_ncompressed++;
   }
-  MUTEX_UNTAKE_LOCK(vol->mutex, thread);
-  return;
+  if (!w.buf) {
+    goto Lfailed;
+  }
+  e->compressed_len = e->size;
+  if (l > REQUIRED_COMPRESSION * e->len) {
+    e->flag_bits.incompressible = true;
+  }
+  if (l > REQUIRED_SHRINK * e->size) {
+    goto Lfailed;
+  }
+  if (l < e->len) {
+    e->flag_bits.compressed = ctype;
+    bb                      = static_cast<char *>(ats_malloc(l));
+    memcpy(bb, w.buf, l);
+    ats_free(w.buf);
+    e->compressed_len = l;
+    int64_t delta     = (static_cast<int64_t>(l)) - static_cast<int64_t>(e->size);
+    this->_bytes += delta;
+    CACHE_SUM_DYN_STAT_THREAD(cache_ram_cache_bytes_stat, delta);
+    e->size = l;
+  } else {
+    ats_free(w.buf);
+    e->flag_bits.compressed = 0;
+    bb                      = static_cast<char *>(ats_malloc(e->len));
+    memcpy(bb, e->data->data(), e->len);
+    int64_t delta = (static_cast<int64_t>(e->len)) - static_cast<int64_t>(e->size);
+    this->_bytes += delta;
+    CACHE_SUM_DYN_STAT_THREAD(cache_ram_cache_bytes_stat, delta);
+    e->size = e->len;
+    l       = e->len;
+  }
+  e->data            = new_xmalloc_IOBufferData(bb, l);
+  e->data->_mem_type = DEFAULT_ALLOC;
+  check_accounting(this);
+  goto Ldone;
+Lfailed:
+  ats_free(w.buf);
+  e->flag_bits.incompressible = 1;
+Ldone:
+  DDebug("ram_cache", "compress %X %d %d %d %d %d %d %d", e->key.slice32(3), e->auxkey1, e->auxkey2, e->flag_bits.incompressible,
+         e->flag_bits.compressed, e->len, e->compressed_len, this->_ncompressed);
 }
 
+#ifdef HAVE_ZSTD_H
+// Collect samples from the batch and, once there are enough, train the zstd dictionary for this
+// volume. The dictionary is never replaced as compressed entries refer to it. Returns true if a
+// new dictionary was created and _zstd_ddict_pending has to be installed under the volume lock.
+bool
+RamCacheCLFUS::_zstd_train(RamCacheCLFUSCompressWork *batch, int nbatch)
+{
+  if (this->_zstd_cdict || this->_zstd_dict_failed) {
+    return false;
+  }
+  for (int i = 0; i < nbatch && this->_zstd_samples.size() < ZSTD_DICT_SAMPLE_BYTES; i++) {
+    if (!batch[i].buf) {
+      continue;
+    }
+    const char *src = batch[i].data->data();
+    size_t len      = std::min<size_t>(batch[i].len, ZSTD_DICT_MAX_SAMPLE);
+    this->_zstd_samples.insert(this->_zstd_samples.end(), src, src + len);
+    this->_zstd_sample_sizes.push_back(len);
+  }
+  if (this->_zstd_samples.size() < ZSTD_DICT_SAMPLE_BYTES) {
+    return false;
+  }
+  std::vector<char> dict(ZSTD_DICT_SIZE);
+  size_t l = ZDICT_trainFromBuffer(dict.data(), dict.size(), this->_zstd_samples.data(), this->_zstd_sample_sizes.data(),
+                                   this->_zstd_sample_sizes.size());
+  this->_zstd_samples.clear();
+  this->_zstd_samples.shrink_to_fit();
+  this->_zstd_sample_sizes.clear();
+  this->_zstd_sample_sizes.shrink_to_fit();
+  if (ZDICT_isError(l)) {
+    Warning("unable to train RAM cache zstd dictionary for '%s': %s", vol->hash_text.get(), ZDICT_getErrorName(l));
+    this->_zstd_dict_failed = true;
+    return false;
+  }
+  Debug("ram_cache", "trained a %zu byte zstd dictionary for '%s'", l, vol->hash_text.get());
+  this->_zstd_cdict         = ZSTD_createCDict(dict.data(), l, ZSTD_LEVEL);
+  this->_zstd_ddict_pending = ZSTD_createDDict(dict.data(), l);
+  return true;
+}
+#endif
+
 void RamCacheCLFUS::_requeue_victims(Que(RamCacheCLFUSEntry, lru_link) & victims)
 {
   RamCacheCLFUSEntry *victim = nullptr;
@@ -771,6 +1020,41 @@ RamCacheCLFUS::fixup(const CryptoHash *key, uint32_t old_auxkey1, uint32_t old_a
   return 0;
 }
 
+void
+RamCacheCLFUS::snapshot(std::vector<RamCacheSnapshotEntry> &entries) const
+{
+  size_t first = entries.size();
+  forl_LL(RamCacheCLFUSEntry, e, this->_lru[0])
+  {
+    entries.push_back({e->key, e->auxkey1, e->auxkey2, e->len, 0, e->hits});
+  }
+  // Highest value first, the same order the replacement would keep them in.
+  std::sort(entries.begin() + first, entries.end(), [](const RamCacheSnapshotEntry &a, const RamCacheSnapshotEntry &b) {
+    return CACHE_VALUE_HITS_SIZE(a.hits, a.len) > CACHE_VALUE_HITS_SIZE(b.hits, b.len);
+  });
+}
+
+int
+RamCacheCLFUS::restore_hits(const CryptoHash *key, uint32_t auxkey1, uint32_t auxkey2, uint64_t hits)
+{
+  if (!this->_max_bytes) {
+    return 0;
+  }
+  uint32_t i            = key->slice32(3) % this->_nbuckets;
+  RamCacheCLFUSEntry *e = this->_bucket[i].head;
+  while (e) {
+    if (e->key == *key && e->auxkey1 == auxkey1 && e->auxkey2 == auxkey2) {
+      if (e->flag_bits.lru) {
+        return 0;
+      }
+      e->hits = std::max(e->hits, hits);
+      return 1;
+    }
+    e = e->hash_link.next;
+  }
+  return 0;
+}
+
 RamCache *
 new_RamCacheCLFUS()
 {
@@ -35,9 +35,10 @@ struct RamCacheLRUEntry {
 #define ENTRY_OVERHEAD 128 // per-entry overhead to consider when computing sizes
 
 struct RamCacheLRU : public RamCache {
-  int64_t max_bytes = 0;
-  int64_t bytes     = 0;
-  int64_t objects   = 0;
+  int64_t max_bytes  = 0;
+  int64_t init_bytes = 0;
+  int64_t bytes      = 0;
+  int64_t objects    = 0;
 
   // returns 1 on found/stored, 0 on not found/stored, if provided auxkey1 and auxkey2 must match
   int get(CryptoHash *key, Ptr<IOBufferData> *ret_data, uint32_t auxkey1 = 0, uint32_t auxkey2 = 0) override;
@@ -47,6 +48,7 @@ struct RamCacheLRU : public RamCache {
   int64_t size() const override;
 
   void init(int64_t max_bytes, Vol *vol) override;
+  void shrink(int percent) override;
 
   // private
   uint16_t *seen = nullptr;
@@ -109,8 +111,9 @@ RamCacheLRU::resize_hashtable()
 void
 RamCacheLRU::init(int64_t abytes, Vol *avol)
 {
-  vol       = avol;
-  max_bytes = abytes;
+  vol        = avol;
+  max_bytes  = abytes;
+  init_bytes = abytes;
   DDebug("ram_cache", "initializing ram_cache %" PRId64 " bytes", abytes);
   if (!max_bytes) {
     return;
@@ -118,6 +121,24 @@ RamCacheLRU::init(int64_t abytes, Vol *avol)
   resize_hashtable();
 }
 
+void
+RamCacheLRU::shrink(int percent)
+{
+  // A cache that is disabled stays so, and one that is not is never disabled.
+  if (!init_bytes) {
+    return;
+  }
+  max_bytes = std::max<int64_t>(init_bytes * percent / 100, 1);
+  DDebug("ram_cache", "limiting ram_cache to %" PRId64 " bytes", max_bytes);
+  while (bytes > max_bytes) {
+    RamCacheLRUEntry *e = lru.dequeue();
+    if (!e) {
+      break;
+    }
+    remove(e);
+  }
+}
+
 int
 RamCacheLRU::get(CryptoHash *key, Ptr<IOBufferData> *ret_data, uint32_t auxkey1, uint32_t auxkey2)
 {
@@ -0,0 +1,291 @@
+/** @file
+
+  RAM cache warm start
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  @section details Details
+
+  On shutdown the entries of every RAM cache are written to a snapshot file, keyed by the stripe.
+  Only keys, directory offsets and hit counts are kept, the data is read back from the stripe on
+  the next start. An entry whose directory entry is gone or moved is skipped, so a stale snapshot
+  costs reads but never serves wrong data.
+ */
+
+#include "P_Cache.h"
+#include "tscore/I_Layout.h"
+#include "records/I_RecCore.h"
+
+#include <string>
+
+#define RAM_CACHE_SNAPSHOT_FILE "ram_cache.snap"
+
+static constexpr uint32_t RAM_CACHE_SNAPSHOT_MAGIC   = 0x52435331; // "RCS1"
+static constexpr uint32_t RAM_CACHE_SNAPSHOT_VERSION = 1;
+
+struct RamCacheSnapshotHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t nvols;
+  uint32_t reserved;
+};
+
+struct RamCacheSnapshotVolHeader {
+  uint32_t name_len;
+  uint32_t nentries;
+};
+
+static std::string
+ram_cache_snapshot_path()
+{
+  return Layout::relative_to(RecConfigReadRuntimeDir(), RAM_CACHE_SNAPSHOT_FILE);
+}
+
+// Reads the objects of one stripe's snapshot back into its RAM cache, one at a time.
+struct RamCacheWarmer : public Continuation {
+  Vol *vol;
+  std::vector<RamCacheSnapshotEntry> entries;
+  size_t next      = 0;
+  int loaded       = 0;
+  ink_hrtime delay = 0;
+  AIOCallbackInternal io;
+  Ptr<IOBufferData> buf;
+  Dir dir;
+
+  int mainEvent(int event, Event *e);
+  int readDone(int event, Event *e);
+
+  RamCacheWarmer(Vol *v, std::vector<RamCacheSnapshotEntry> &&e) : Continuation(new_ProxyMutex()), vol(v), entries(std::move(e))
+  {
+    if (cache_config_ram_cache_warm_start_rate > 0) {
+      delay = HRTIME_SECOND / cache_config_ram_cache_warm_start_rate;
+    }
+    SET_HANDLER(&RamCacheWarmer::mainEvent);
+  }
+
+private:
+  bool find(const RamCacheSnapshotEntry &se);
+  void schedule_next(ink_hrtime after);
+};
+
+// The directory entry @a se was at, if it is still there.
+bool
+RamCacheWarmer::find(const RamCacheSnapshotEntry &se)
+{
+  CacheKey key        = se.key;
+  Dir *last_collision = nullptr;
+  uint64_t offset     = (static_cast<uint64_t>(se.auxkey1) << 32) | se.auxkey2;
+
+  while (dir_probe(&key, vol, &dir, &last_collision)) {
+    if (dir_offset(&dir) == static_cast<int64_t>(offset)) {
+      return !dir_agg_buf_valid(vol, &dir);
+    }
+  }
+  return false;
+}
+
+void
+RamCacheWarmer::schedule_next(ink_hrtime after)
+{
+  SET_HANDLER(&RamCacheWarmer::mainEvent);
+  if (after) {
+    eventProcessor.schedule_in(this, after, ET_CALL);
+  } else {
+    eventProcessor.schedule_imm(this, ET_CALL);
+  }
+}
+
+int
+RamCacheWarmer::mainEvent(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
+{
+  if (!vol->dir_ready) {
+    schedule_next(HRTIME_SECOND);
+    return EVENT_CONT;
+  }
+  {
+    CACHE_TRY_LOCK(lock, vol->mutex, mutex->thread_holding);
+    if (!lock.is_locked()) {
+      schedule_next(HRTIME_MSECONDS(cache_config_mutex_retry_delay));
+      return EVENT_CONT;
+    }
+    while (next < entries.size()) {
+      if (!find(entries[next++])) {
+        continue;
+      }
+      io.aiocb.aio_fildes = vol->fd;
+      io.aiocb.aio_offset = vol->vol_offset(&dir);
+      io.aiocb.aio_nbytes = dir_approx_size(&dir);
+      if (static_cast<off_t>(io.aiocb.aio_offset + io.aiocb.aio_nbytes) > static_cast<off_t>(vol->skip + vol->len)) {
+        io.aiocb.aio_nbytes = vol->skip + vol->len - io.aiocb.aio_offset;
+      }
+      buf              = new_IOBufferData(iobuffer_size_to_index(io.aiocb.aio_nbytes, MAX_BUFFER_SIZE_INDEX), MEMALIGNED);
+      io.aiocb.aio_buf = buf->data();
+      io.action        = this;
+      io.thread        = AIO_CALLBACK_THREAD_ANY;
+      io.then          = nullptr;
+      SET_HANDLER(&RamCacheWarmer::readDone);
+      ink_assert(ink_aio_read(&io) >= 0);
+      return EVENT_CONT;
+    }
+  }
+  Note("RAM cache warm start of '%s' done, %d of %zu objects loaded", vol->hash_text.get(), loaded, entries.size());
+  mutex.clear();
+  delete this;
+  return EVENT_DONE;
+}
+
+int
+RamCacheWarmer::readDone(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
+{
+  const RamCacheSnapshotEntry &se = entries[next - 1];
+  {
+    CACHE_TRY_LOCK(lock, vol->mutex, mutex->thread_holding);
+    if (!lock.is_locked()) {
+      eventProcessor.schedule_in(this, HRTIME_MSECONDS(cache_config_mutex_retry_delay), ET_CALL);
+      return EVENT_CONT;
+    }
+    Doc *doc = reinterpret_cast<Doc *>(buf->data());
+    // The same checks as a read through a CacheVC, the entry may have been overwritten since.
+    if (io.ok() && dir_valid(vol, &dir) && doc->magic == DOC_MAGIC && (doc->first_key == se.key || doc->key == se.key) &&
+        doc->len <= io.aiocb.aio_nbytes && ts::VersionNumber(doc->v_major, doc->v_minor) <= CACHE_DB_VERSION) {
+      int okay  = 1;
+      bool copy = cache_config_ram_cache_compress && doc->doc_type == CACHE_FRAG_TYPE_HTTP && doc->hlen;
+      if (!copy && doc->doc_type == CACHE_FRAG_TYPE_HTTP && doc->hlen) {
+        unmarshal_helper(doc, buf, okay);
+      }
+      CryptoHash key = se.key;
+      if (okay && vol->ram_cache->put(&key, buf.get(), doc->len, copy, se.auxkey1, se.auxkey2)) {
+        vol->ram_cache->restore_hits(&key, se.auxkey1, se.auxkey2, se.hits);
+        GLOBAL_CACHE_SUM_GLOBAL_DYN_STAT(cache_ram_cache_warm_objects_stat, 1);
+        GLOBAL_CACHE_SUM_GLOBAL_DYN_STAT(cache_ram_cache_warm_bytes_stat, doc->len);
+        ++loaded;
+      }
+    }
+  }
+  buf = nullptr;
+  schedule_next(delay);
+  return EVENT_CONT;
+}
+
+/*
+ * Called on shutdown, before the directories are synced. The volume
+ * locks are taken the same way sync_cache_dir_on_shutdown does.
+ */
+void
+ram_cache_snapshot_save()
+{
+  if (!cache_config_ram_cache_warm_start) {
+    return;
+  }
+  std::string path = ram_cache_snapshot_path();
+  std::string tmp  = path + ".tmp";
+  FILE *fp         = fopen(tmp.c_str(), "w");
+  if (fp == nullptr) {
+    Warning("unable to write the RAM cache snapshot '%s': %s", tmp.c_str(), strerror(errno));
+    return;
+  }
+
+  RamCacheSnapshotHeader h = {RAM_CACHE_SNAPSHOT_MAGIC, RAM_CACHE_SNAPSHOT_VERSION, 0, 0};
+  bool ok                  = fwrite(&h, sizeof(h), 1, fp) == 1;
+  size_t total             = 0;
+  std::vector<RamCacheSnapshotEntry> entries;
+
+  EThread *t = (EThread *)0xdeadbeef;
+  for (int i = 0; ok && i < gnvol; i++) {
+    Vol *d = gvol[i];
+    if (d->ram_cache == nullptr || !d->dir_ready || DISK_BAD(d->disk)) {
+      continue;
+    }
+    entries.clear();
+    MUTEX_TAKE_LOCK(d->mutex, t);
+    d->ram_cache->snapshot(entries);
+    MUTEX_UNTAKE_LOCK(d->mutex, t);
+
+    RamCacheSnapshotVolHeader vh = {static_cast<uint32_t>(strlen(d->hash_text.get())), static_cast<uint32_t>(entries.size())};
+    ok = fwrite(&vh, sizeof(vh), 1, fp) == 1 && fwrite(d->hash_text.get(), vh.name_len, 1, fp) == 1 &&
+         (entries.empty() || fwrite(entries.data(), sizeof(RamCacheSnapshotEntry), entries.size(), fp) == entries.size());
+    ++h.nvols;
+    total += entries.size();
+  }
+  if (ok) {
+    rewind(fp);
+    ok = fwrite(&h, sizeof(h), 1, fp) == 1;
+  }
+  if (fclose(fp) != 0) {
+    ok = false;
+  }
+  if (!ok || rename(tmp.c_str(), path.c_str()) != 0) {
+    Warning("unable to write the RAM cache snapshot '%s': %s", path.c_str(), strerror(errno));
+    unlink(tmp.c_str());
+    return;
+  }
+  Note("RAM cache snapshot of %zu objects in %u stripes written to '%s'", total, h.nvols, path.c_str());
+}
+
+/*
+ * Called once the cache is initialized. The snapshot is removed once it
+ * is read, the next one is written on the next shutdown.
+ */
+void
+ram_cache_warm_start()
+{
+  std::string path = ram_cache_snapshot_path();
+  FILE *fp         = fopen(path.c_str(), "r");
+  if (fp == nullptr) {
+    Debug("ram_cache", "no RAM cache snapshot at '%s'", path.c_str());
+    return;
+  }
+
+  RamCacheSnapshotHeader h;
+  if (fread(&h, sizeof(h), 1, fp) != 1 || h.magic != RAM_CACHE_SNAPSHOT_MAGIC || h.version != RAM_CACHE_SNAPSHOT_VERSION) {
+    Warning("ignoring RAM cache snapshot '%s', it is not valid", path.c_str());
+    h.nvols = 0;
+  }
+  for (uint32_t n = 0; n < h.nvols; n++) {
+    RamCacheSnapshotVolHeader vh;
+    if (fread(&vh, sizeof(vh), 1, fp) != 1 || vh.name_len >= PATH_NAME_MAX) {
+      Warning("RAM cache snapshot '%s' is truncated", path.c_str());
+      break;
+    }
+    char name[PATH_NAME_MAX];
+    std::vector<RamCacheSnapshotEntry> entries(vh.nentries);
+    if (fread(name, vh.name_len, 1, fp) != 1 ||
+        (vh.nentries && fread(entries.data(), sizeof(RamCacheSnapshotEntry), vh.nentries, fp) != vh.nentries)) {
+      Warning("RAM cache snapshot '%s' is truncated", path.c_str());
+      break;
+    }
+    name[vh.name_len] = '\0';
+
+    Vol *vol = nullptr;
+    for (int i = 0; i < gnvol; i++) {
+      if (strcmp(gvol[i]->hash_text.get(), name) == 0) {
+        vol = gvol[i];
+        break;
+      }
+    }
+    if (vol == nullptr || vol->ram_cache == nullptr || entries.empty()) {
+      Debug("ram_cache", "skipping RAM cache snapshot of '%s'", name);
+      continue;
+    }
+    Debug("ram_cache", "warming the RAM cache of '%s' with %u objects", name, vh.nentries);
+    eventProcessor.schedule_imm(new RamCacheWarmer(vol, std::move(entries)), ET_CALL);
+  }
+  fclose(fp);
+  unlink(path.c_str());
+}
@@ -0,0 +1,406 @@
+/** @file
+
+  W-TinyLFU RAM cache.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+// W-TinyLFU (Einziger, Friedman, Manes: "TinyLFU: A Highly Efficient Cache Admission Policy")
+//
+// New objects go to a small LRU window. Objects pushed out of the window compete for a place in
+// the main segmented LRU against its victim, the one with the higher estimated access frequency
+// wins. Frequencies come from a count-min sketch of 4 bit counters which is halved periodically
+// so that old popularity fades. One-hit wonders of a scan never get past the window.
+
+#include "P_Cache.h"
+
+#define ENTRY_OVERHEAD 128 // per-entry overhead to consider when computing sizes
+
+#define WINDOW_PERCENT 1     // of max_bytes for the window LRU
+#define PROTECTED_PERCENT 80 // of the main segmented LRU for the protected segment
+
+#define SKETCH_DEPTH 4
+#define SKETCH_MAX_COUNT 15
+#define SKETCH_MIN_WIDTH 1024
+#define SKETCH_MAX_WIDTH (1 << 24)
+#define SKETCH_AVERAGE_OBJECT 8192 // used to size the sketch from max_bytes
+#define SKETCH_SAMPLE_FACTOR 10    // counters are halved after this many additions per counter column
+
+enum RamCacheWTinyLFUQueue : uint8_t {
+  WTINYLFU_WINDOW,
+  WTINYLFU_PROBATION,
+  WTINYLFU_PROTECTED,
+  WTINYLFU_QUEUES,
+};
+
+struct RamCacheWTinyLFUEntry {
+  CryptoHash key;
+  uint32_t auxkey1;
+  uint32_t auxkey2;
+  uint32_t size; // including ENTRY_OVERHEAD
+  uint8_t queue;
+  LINK(RamCacheWTinyLFUEntry, lru_link);
+  LINK(RamCacheWTinyLFUEntry, hash_link);
+  Ptr<IOBufferData> data;
+};
+
+struct RamCacheWTinyLFU : public RamCache {
+  int64_t max_bytes  = 0;
+  int64_t init_bytes = 0;
+  int64_t bytes      = 0;
+  int64_t objects    = 0;
+
+  // returns 1 on found/stored, 0 on not found/stored, if provided auxkey1 and auxkey2 must match
+  int get(CryptoHash *key, Ptr<IOBufferData> *ret_data, uint32_t auxkey1 = 0, uint32_t auxkey2 = 0) override;
+  int put(CryptoHash *key, IOBufferData *data, uint32_t len, bool copy = false, uint32_t auxkey1 = 0,
+          uint32_t auxkey2 = 0) override;
+  int fixup(const CryptoHash *key, uint32_t old_auxkey1, uint32_t old_auxkey2, uint32_t new_auxkey1, uint32_t new_auxkey2) override;
+  int64_t size() const override;
+
+  void init(int64_t max_bytes, Vol *vol) override;
+  void shrink(int percent) override;
+
+  ~RamCacheWTinyLFU() override;
+
+  // private
+  Que(RamCacheWTinyLFUEntry, lru_link) lru[WTINYLFU_QUEUES];
+  int64_t queue_bytes[WTINYLFU_QUEUES] = {0, 0, 0};
+  int64_t window_max                   = 0;
+  int64_t protected_max                = 0;
+  DList(RamCacheWTinyLFUEntry, hash_link) *bucket = nullptr;
+  int nbuckets                                    = 0;
+  int ibuckets                                    = 0;
+  Vol *vol                                        = nullptr;
+
+  uint8_t *sketch      = nullptr; // SKETCH_DEPTH rows of sketch_mask + 1 counters
+  uint32_t sketch_mask = 0;
+  int64_t additions    = 0;
+  int64_t sample_size  = 0;
+
+  void resize_hashtable();
+  void enqueue(RamCacheWTinyLFUEntry *e, int queue);
+  void dequeue(RamCacheWTinyLFUEntry *e);
+  void touch(RamCacheWTinyLFUEntry *e);
+  void evict();
+  RamCacheWTinyLFUEntry *remove(RamCacheWTinyLFUEntry *e);
+
+  uint32_t
+  sketch_index(const CryptoHash *key, int row) const
+  {
+    // double hashing over two independent halves of the key
+    return row * (sketch_mask + 1) + ((key->slice32(0) + row * (key->slice32(1) | 1)) & sketch_mask);
+  }
+  int frequency(const CryptoHash *key) const;
+  void increment(const CryptoHash *key);
+};
+
+int64_t
+RamCacheWTinyLFU::size() const
+{
+  int64_t s = 0;
+  for (const auto &q : lru) {
+    forl_LL(RamCacheWTinyLFUEntry, e, q)
+    {
+      s += sizeof(*e);
+      s += sizeof(*e->data);
+      s += e->data->block_size();
+    }
+  }
+  return s;
+}
+
+ClassAllocator<RamCacheWTinyLFUEntry> ramCacheWTinyLFUEntryAllocator("RamCacheWTinyLFUEntry");
+
+static const int bucket_sizes[] = {127,     251,      509,      1021,     2039,      4093,      8191,     16381,
+                                   32749,   65521,    131071,   262139,   524287,    1048573,   2097143,  4194301,
+                                   8388593, 16777213, 33554393, 67108859, 134217689, 268435399, 536870909};
+
+RamCacheWTinyLFU::~RamCacheWTinyLFU()
+{
+  ats_free(sketch);
+}
+
+void
+RamCacheWTinyLFU::resize_hashtable()
+{
+  int anbuckets = bucket_sizes[ibuckets];
+  DDebug("ram_cache", "resize hashtable %d", anbuckets);
+  int64_t s                                           = anbuckets * sizeof(DList(RamCacheWTinyLFUEntry, hash_link));
+  DList(RamCacheWTinyLFUEntry, hash_link) *new_bucket = static_cast<DList(RamCacheWTinyLFUEntry, hash_link) *>(ats_malloc(s));
+  memset(static_cast<void *>(new_bucket), 0, s);
+  if (bucket) {
+    for (int64_t i = 0; i < nbuckets; i++) {
+      RamCacheWTinyLFUEntry *e = nullptr;
+      while ((e = bucket[i].pop())) {
+        new_bucket[e->key.slice32(3) % anbuckets].push(e);
+      }
+    }
+    ats_free(bucket);
+  }
+  bucket   = new_bucket;
+  nbuckets = anbuckets;
+}
+
+void
+RamCacheWTinyLFU::init(int64_t abytes, Vol *avol)
+{
+  vol        = avol;
+  max_bytes  = abytes;
+  init_bytes = abytes;
+  DDebug("ram_cache", "initializing ram_cache %" PRId64 " bytes", abytes);
+  if (!max_bytes) {
+    return;
+  }
+  window_max    = std::max(max_bytes * WINDOW_PERCENT / 100, static_cast<int64_t>(ENTRY_OVERHEAD));
+  protected_max = (max_bytes - window_max) * PROTECTED_PERCENT / 100;
+
+  int64_t width = SKETCH_MIN_WIDTH;
+  while (width < max_bytes / SKETCH_AVERAGE_OBJECT && width < SKETCH_MAX_WIDTH) {
+    width <<= 1;
+  }
+  sketch_mask = width - 1;
+  sample_size = width * SKETCH_SAMPLE_FACTOR;
+  sketch      = static_cast<uint8_t *>(ats_malloc(width * SKETCH_DEPTH));
+  memset(sketch, 0, width * SKETCH_DEPTH);
+  resize_hashtable();
+}
+
+void
+RamCacheWTinyLFU::shrink(int percent)
+{
+  // The sketch keeps the size it was made for, the frequencies stay valid as the cache grows back.
+  if (!init_bytes) {
+    return;
+  }
+  max_bytes     = std::max<int64_t>(init_bytes * percent / 100, 1);
+  window_max    = std::max(max_bytes * WINDOW_PERCENT / 100, static_cast<int64_t>(ENTRY_OVERHEAD));
+  protected_max = (max_bytes - window_max) * PROTECTED_PERCENT / 100;
+  DDebug("ram_cache", "limiting ram_cache to %" PRId64 " bytes", max_bytes);
+  // the probation victims go first, as they would in evict()
+  for (int q : {WTINYLFU_PROBATION, WTINYLFU_PROTECTED, WTINYLFU_WINDOW}) {
+    while (bytes > max_bytes && lru[q].head) {
+      remove(lru[q].head);
+    }
+  }
+}
+
+int
+RamCacheWTinyLFU::frequency(const CryptoHash *key) const
+{
+  int f = SKETCH_MAX_COUNT;
+  for (int row = 0; row < SKETCH_DEPTH; row++) {
+    f = std::min(f, static_cast<int>(sketch[sketch_index(key, row)]));
+  }
+  return f;
+}
+
+void
+RamCacheWTinyLFU::increment(const CryptoHash *key)
+{
+  for (int row = 0; row < SKETCH_DEPTH; row++) {
+    uint8_t &c = sketch[sketch_index(key, row)];
+    if (c < SKETCH_MAX_COUNT) {
+      c++;
+    }
+  }
+  if (++additions >= sample_size) {
+    // age all the counters so that the sketch follows changes in popularity
+    for (uint32_t i = 0; i < (sketch_mask + 1) * SKETCH_DEPTH; i++) {
+      sketch[i] >>= 1;
+    }
+    additions /= 2;
+  }
+}
+
+void
+RamCacheWTinyLFU::enqueue(RamCacheWTinyLFUEntry *e, int queue)
+{
+  e->queue = queue;
+  lru[queue].enqueue(e);
+  queue_bytes[queue] += e->size;
+}
+
+void
+RamCacheWTinyLFU::dequeue(RamCacheWTinyLFUEntry *e)
+{
+  lru[e->queue].remove(e);
+  queue_bytes[e->queue] -= e->size;
+}
+
+// move a hit entry to the most recently used end, promoting it out of probation
+void
+RamCacheWTinyLFU::touch(RamCacheWTinyLFUEntry *e)
+{
+  int queue = e->queue;
+  dequeue(e);
+  if (queue == WTINYLFU_WINDOW) {
+    enqueue(e, WTINYLFU_WINDOW);
+    return;
+  }
+  enqueue(e, WTINYLFU_PROTECTED);
+  while (queue_bytes[WTINYLFU_PROTECTED] > protected_max) {
+    RamCacheWTinyLFUEntry *d = lru[WTINYLFU_PROTECTED].head;
+    dequeue(d);
+    enqueue(d, WTINYLFU_PROBATION);
+  }
+}
+
+RamCacheWTinyLFUEntry *
+RamCacheWTinyLFU::remove(RamCacheWTinyLFUEntry *e)
+{
+  RamCacheWTinyLFUEntry *ret = e->hash_link.next;
+  uint32_t b                 = e->key.slice32(3) % nbuckets;
+  bucket[b].remove(e);
+  dequeue(e);
+  bytes -= e->size;
+  CACHE_SUM_DYN_STAT_THREAD(cache_ram_cache_bytes_stat, -static_cast<int64_t>(e->size));
+  DDebug("ram_cache", "put %X %d %d FREED", e->key.slice32(3), e->auxkey1, e->auxkey2);
+  e->data = nullptr;
+  THREAD_FREE(e, ramCacheWTinyLFUEntryAllocator, this_thread());
+  objects--;
+  return ret;
+}
+
+// move entries beyond the window size to the main cache if they win against its victims
+void
+RamCacheWTinyLFU::evict()
+{
+  while (queue_bytes[WTINYLFU_WINDOW] > window_max) {
+    RamCacheWTinyLFUEntry *c = lru[WTINYLFU_WINDOW].head;
+    dequeue(c);
+    enqueue(c, WTINYLFU_PROBATION);
+    int cf = -1; // computed lazily, only when there is a contest
+    while (bytes > max_bytes) {
+      RamCacheWTinyLFUEntry *v = lru[WTINYLFU_PROBATION].head;
+      if (v == c) {
+        v = v->lru_link.next ? v->lru_link.next : lru[WTINYLFU_PROTECTED].head;
+      }
+      if (!v) {
+        remove(c);
+        break;
+      }
+      if (cf < 0) {
+        cf = frequency(&c->key);
+      }
+      if (cf > frequency(&v->key)) {
+        DDebug("ram_cache", "put %X %d %d ADMITTED over %X", c->key.slice32(3), c->auxkey1, c->auxkey2, v->key.slice32(3));
+        remove(v);
+      } else {
+        DDebug("ram_cache", "put %X %d %d REJECTED", c->key.slice32(3), c->auxkey1, c->auxkey2);
+        remove(c);
+        break;
+      }
+    }
+  }
+  // the window itself can exceed max_bytes with very large objects
+  while (bytes > max_bytes && lru[WTINYLFU_WINDOW].head) {
+    remove(lru[WTINYLFU_WINDOW].head);
+  }
+}
+
+int
+RamCacheWTinyLFU::get(CryptoHash *key, Ptr<IOBufferData> *ret_data, uint32_t auxkey1, uint32_t auxkey2)
+{
+  if (!max_bytes) {
+    return 0;
+  }
+  increment(key);
+  uint32_t i               = key->slice32(3) % nbuckets;
+  RamCacheWTinyLFUEntry *e = bucket[i].head;
+  while (e) {
+    if (e->key == *key && e->auxkey1 == auxkey1 && e->auxkey2 == auxkey2) {
+      touch(e);
+      (*ret_data) = e->data;
+      DDebug("ram_cache", "get %X %d %d HIT", key->slice32(3), auxkey1, auxkey2);
+      CACHE_SUM_DYN_STAT_THREAD(cache_ram_cache_hits_stat, 1);
+      return 1;
+    }
+    e = e->hash_link.next;
+  }
+  DDebug("ram_cache", "get %X %d %d MISS", key->slice32(3), auxkey1, auxkey2);
+  CACHE_SUM_DYN_STAT_THREAD(cache_ram_cache_misses_stat, 1);
+  return 0;
+}
+
+// ignore 'copy' since we don't touch the data
+int
+RamCacheWTinyLFU::put(CryptoHash *key, IOBufferData *data, uint32_t len, bool, uint32_t auxkey1, uint32_t auxkey2)
+{
+  if (!max_bytes) {
+    return 0;
+  }
+  uint32_t i               = key->slice32(3) % nbuckets;
+  RamCacheWTinyLFUEntry *e = bucket[i].head;
+  while (e) {
+    if (e->key == *key) {
+      if (e->auxkey1 == auxkey1 && e->auxkey2 == auxkey2) {
+        touch(e);
+        return 1;
+      } else { // discard when aux keys conflict
+        e = remove(e);
+        continue;
+      }
+    }
+    e = e->hash_link.next;
+  }
+  e          = THREAD_ALLOC(ramCacheWTinyLFUEntryAllocator, this_ethread());
+  e->key     = *key;
+  e->auxkey1 = auxkey1;
+  e->auxkey2 = auxkey2;
+  e->size    = ENTRY_OVERHEAD + data->block_size();
+  e->data    = data;
+  bucket[i].push(e);
+  enqueue(e, WTINYLFU_WINDOW);
+  bytes += e->size;
+  objects++;
+  CACHE_SUM_DYN_STAT_THREAD(cache_ram_cache_bytes_stat, e->size);
+  DDebug("ram_cache", "put %X %d %d len %d INSERTED", key->slice32(3), auxkey1, auxkey2, len);
+  evict();
+  if (objects > nbuckets) {
+    ++ibuckets;
+    resize_hashtable();
+  }
+  return 1;
+}
+
+int
+RamCacheWTinyLFU::fixup(const CryptoHash *key, uint32_t old_auxkey1, uint32_t old_auxkey2, uint32_t new_auxkey1,
+                        uint32_t new_auxkey2)
+{
+  if (!max_bytes) {
+    return 0;
+  }
+  uint32_t i               = key->slice32(3) % nbuckets;
+  RamCacheWTinyLFUEntry *e = bucket[i].head;
+  while (e) {
+    if (e->key == *key && e->auxkey1 == old_auxkey1 && e->auxkey2 == old_auxkey2) {
+      e->auxkey1 = new_auxkey1;
+      e->auxkey2 = new_auxkey2;
+      return 1;
+    }
+    e = e->hash_link.next;
+  }
+  return 0;
+}
+
+RamCache *
+new_RamCacheWTinyLFU()
+{
+  return new RamCacheWTinyLFU;
+}
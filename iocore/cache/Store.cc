@@ -39,6 +39,7 @@
 //
 const char Store::VOLUME_KEY[]           = "volume";
 const char Store::HASH_BASE_STRING_KEY[] = "id";
+const char Store::POLLED_IO_KEY[]        = "poll";
 
 static span_error_t
 make_span_error(int error)
@@ -366,6 +367,7 @@ Store::read_config()
 
     int64_t size   = -1;
     int volume_num = -1;
+    bool polled_io = false;
     const char *e;
     while (nullptr != (e = tokens.getNext())) {
       if (ParseRules::is_digit(*e)) {
@@ -393,6 +395,8 @@ Store::read_config()
           Error("%s failed to load", ts::filename::STORAGE);
           return Result::failure("failed to parse volume number '%s'", e);
         }
+      } else if (0 == strcasecmp(POLLED_IO_KEY, e)) {
+        polled_io = true;
       }
     }
 
@@ -417,6 +421,7 @@ Store::read_config()
     if (volume_num > 0) {
       ns->volume_number_set(volume_num);
     }
+    ns->polled_io = polled_io;
 
     // new Span
     {
@@ -0,0 +1,566 @@
+/** @file
+
+  Disk throughput and directory scalability of the cache.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  @section details Details
+
+  Usage: benchmark_Cache -d dir [-m mix] [-s sizes] [-k keys] [-c concurrency] [-t seconds] [-e threads] [-F] [-j]
+
+  Starts the cache on the storage.config in @a dir, the directory relative paths in it are
+  resolved against too, writes each of @a keys synthetic keys once unless -F is given, and then
+  runs @a concurrency clients for @a seconds, each issuing the next operation of the mix as soon
+  as the last one is done.
+
+  The mix is a list of operation:weight, the operations are read, write, overwrite and remove,
+  "read:70,write:20,overwrite:5,remove:5" by default. The sizes are a list of size:weight, the
+  size of each object written, with an optional k or m suffix, "4k:50,64k:40,1m:10" by default.
+
+  While the clients run, a sampler takes the lock of each stripe every 10ms, recording how long
+  that waited, probes the directory for a random key under the lock, recording how long that
+  took, and records the AIO queue depth and how far the aggregation writes went.
+
+  Reports the latency of each operation, the lock waits and the directory probes, the bytes the
+  aggregation wrote and the AIO queue depth. With -j the times are JSON lines, as the other
+  benchmarks report them, and the rest goes to stderr.
+ */
+
+#include "P_Cache.h"
+#include "P_Net.h"
+#include "RecordsConfig.h"
+#include "tscore/I_Layout.h"
+#include "bench_report.h"
+
+#include "diags.i"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+namespace
+{
+enum Op { OP_READ, OP_WRITE, OP_OVERWRITE, OP_REMOVE, OP_COUNT };
+
+const char *const OP_NAMES[] = {"read", "write", "overwrite", "remove"};
+
+enum Phase { PHASE_FILL, PHASE_RUN, PHASE_STOP };
+
+constexpr ink_hrtime SAMPLE_INTERVAL = HRTIME_MSECOND * 10;
+constexpr int64_t WRITE_WATERMARK    = 64 * 1024;
+
+struct Weighted {
+  int64_t value;
+  int weight;
+};
+
+// Parses "name:weight,...", @a value_of turns each name into its value, false if it is not one.
+template <typename F>
+bool
+parse_weights(const char *spec, std::vector<Weighted> &out, F value_of)
+{
+  std::string s(spec);
+  size_t pos = 0;
+  while (pos < s.size()) {
+    size_t end       = s.find(',', pos);
+    std::string item = s.substr(pos, end == std::string::npos ? std::string::npos : end - pos);
+    size_t colon     = item.find(':');
+    int64_t value;
+    if (colon == std::string::npos || !value_of(item.substr(0, colon), value)) {
+      return false;
+    }
+    int weight = atoi(item.c_str() + colon + 1);
+    if (weight <= 0) {
+      return false;
+    }
+    out.push_back({value, weight});
+    pos = end == std::string::npos ? s.size() : end + 1;
+  }
+  return !out.empty();
+}
+
+bool
+op_of(std::string const &name, int64_t &value)
+{
+  for (int i = 0; i < OP_COUNT; ++i) {
+    if (name == OP_NAMES[i]) {
+      value = i;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool
+size_of(std::string const &name, int64_t &value)
+{
+  char *end;
+  value = strtoll(name.c_str(), &end, 10);
+  if (*end == 'k' || *end == 'K') {
+    value *= 1024;
+    ++end;
+  } else if (*end == 'm' || *end == 'M') {
+    value *= 1024 * 1024;
+    ++end;
+  }
+  return *end == '\0' && value > 0;
+}
+
+// Picks from a weighted list.
+struct Picker {
+  std::vector<Weighted> items;
+  int total = 0;
+
+  void
+  init()
+  {
+    for (auto const &item : items) {
+      total += item.weight;
+    }
+  }
+
+  int64_t
+  pick(std::minstd_rand &rng) const
+  {
+    int r = std::uniform_int_distribution<int>(0, total - 1)(rng);
+    for (auto const &item : items) {
+      if ((r -= item.weight) < 0) {
+        return item.value;
+      }
+    }
+    return items.back().value;
+  }
+};
+
+struct Config {
+  Picker mix;
+  Picker sizes;
+  int keys        = 10000;
+  int concurrency = 32;
+  int seconds     = 10;
+} config;
+
+std::atomic<int> phase{PHASE_FILL};
+std::atomic<int> fill_next{0};
+std::atomic<int> idle{0};
+ink_hrtime run_start = 0;
+char payload[WRITE_WATERMARK];
+
+CacheKey
+make_key(int64_t i)
+{
+  CacheKey key;
+  CryptoContext().hash_immediate(key, &i, sizeof(i));
+  return key;
+}
+
+struct Latencies {
+  std::vector<ink_hrtime> samples;
+  int64_t failures = 0;
+};
+
+// A client, issuing one cache operation after the other on its own mutex.
+struct Client : public Continuation {
+  explicit Client(int id) : Continuation(new_ProxyMutex()), rng(id + 1) { SET_HANDLER(&Client::next_event); }
+
+  int
+  next_event(int /* event ATS_UNUSED */, void * /* data ATS_UNUSED */)
+  {
+    int p = phase.load(std::memory_order_acquire);
+    if (p == PHASE_FILL) {
+      int i = fill_next.fetch_add(1);
+      if (i >= config.keys) {
+        idle.fetch_add(1);
+        return EVENT_DONE;
+      }
+      start(OP_WRITE, i);
+    } else if (p == PHASE_RUN) {
+      start(static_cast<Op>(config.mix.pick(rng)), std::uniform_int_distribution<int>(0, config.keys - 1)(rng));
+    } else {
+      idle.fetch_add(1);
+    }
+    return EVENT_DONE;
+  }
+
+  void
+  start(Op o, int i)
+  {
+    key     = make_key(i);
+    op      = o;
+    started = Thread::get_hrtime_updated();
+    SET_HANDLER(&Client::op_event);
+    switch (op) {
+    case OP_READ:
+      cacheProcessor.open_read(this, &key);
+      break;
+    case OP_WRITE:
+    case OP_OVERWRITE:
+      size = config.sizes.pick(rng);
+      cacheProcessor.open_write(this, &key, CACHE_FRAG_TYPE_NONE, size, op == OP_OVERWRITE ? CACHE_WRITE_OPT_OVERWRITE : 0);
+      break;
+    case OP_REMOVE:
+      cacheProcessor.remove(this, &key);
+      break;
+    default:
+      break;
+    }
+  }
+
+  int
+  op_event(int event, void *data)
+  {
+    switch (event) {
+    case CACHE_EVENT_OPEN_READ:
+      vc     = static_cast<CacheVConnection *>(data);
+      buffer = new_MIOBuffer(BUFFER_SIZE_INDEX_32K);
+      reader = buffer->alloc_reader();
+      vio    = vc->do_io_read(this, vc->get_object_size(), buffer);
+      return EVENT_CONT;
+    case VC_EVENT_READ_READY:
+      reader->consume(reader->read_avail());
+      vio->reenable();
+      return EVENT_CONT;
+    case CACHE_EVENT_OPEN_WRITE:
+      vc     = static_cast<CacheVConnection *>(data);
+      buffer = new_MIOBuffer(BUFFER_SIZE_INDEX_32K);
+      reader = buffer->alloc_reader();
+      filled = 0;
+      fill();
+      vio = vc->do_io_write(this, size, reader);
+      return EVENT_CONT;
+    case VC_EVENT_WRITE_READY:
+      fill();
+      vio->reenable();
+      return EVENT_CONT;
+    case VC_EVENT_READ_COMPLETE:
+    case VC_EVENT_EOS:
+    case VC_EVENT_WRITE_COMPLETE:
+    case CACHE_EVENT_REMOVE:
+      done(true);
+      break;
+    default:
+      // The failures of open_read, open_write and remove, and the errors of the transfers.
+      done(false);
+      break;
+    }
+    return EVENT_DONE;
+  }
+
+  // Keeps the writer a watermark of data ahead of the cache.
+  void
+  fill()
+  {
+    while (filled < size && reader->read_avail() < WRITE_WATERMARK) {
+      int64_t n = std::min(size - filled, WRITE_WATERMARK - reader->read_avail());
+      filled += buffer->write(payload, n);
+    }
+  }
+
+  void
+  done(bool success)
+  {
+    if (vc) {
+      vc->do_io_close(success ? -1 : 1);
+      vc = nullptr;
+    }
+    if (buffer) {
+      free_MIOBuffer(buffer);
+      buffer = nullptr;
+    }
+    // The fill and the operations still running when the run started are not counted.
+    if (started >= run_start && phase.load(std::memory_order_acquire) != PHASE_FILL) {
+      Latencies &l = latencies[op];
+      if (success) {
+        l.samples.push_back(Thread::get_hrtime_updated() - started);
+      } else {
+        ++l.failures;
+      }
+    }
+    // Callbacks can come from within the call that started the operation, start the next one
+    // from the event loop.
+    SET_HANDLER(&Client::next_event);
+    this_ethread()->schedule_imm(this);
+  }
+
+  std::minstd_rand rng;
+  CacheKey key;
+  Op op              = OP_READ;
+  ink_hrtime started = 0;
+  int64_t size       = 0;
+  int64_t filled     = 0;
+
+  CacheVConnection *vc   = nullptr;
+  MIOBuffer *buffer      = nullptr;
+  IOBufferReader *reader = nullptr;
+  VIO *vio               = nullptr;
+
+  Latencies latencies[OP_COUNT];
+};
+
+// Samples the stripes and the AIO queue while the clients run.
+struct Sampler : public Continuation {
+  Sampler() : Continuation(new_ProxyMutex()), rng(0) { SET_HANDLER(&Sampler::sample_event); }
+
+  void
+  start()
+  {
+    for (int i = 0; i < gnvol; ++i) {
+      SCOPED_MUTEX_LOCK(lock, gvol[i]->mutex, this_ethread());
+      write_pos.push_back(gvol[i]->header->write_pos);
+    }
+    event = eventProcessor.schedule_every(this, SAMPLE_INTERVAL, ET_CALL);
+  }
+
+  int
+  sample_event(int /* event ATS_UNUSED */, void * /* data ATS_UNUSED */)
+  {
+    if (stopped.load(std::memory_order_acquire)) {
+      event->cancel();
+      finished.store(true, std::memory_order_release);
+      return EVENT_DONE;
+    }
+
+    int depth = ink_aio_queue_depth();
+    aio_depth_total += depth;
+    aio_depth_max = std::max(aio_depth_max, depth);
+    ++aio_samples;
+
+    EThread *t = this_ethread();
+    for (int i = 0; i < gnvol; ++i) {
+      Vol *vol         = gvol[i];
+      ink_hrtime start = Thread::get_hrtime_updated();
+      MUTEX_TAKE_LOCK(vol->mutex, t);
+      ink_hrtime locked = Thread::get_hrtime_updated();
+      lock_waits.push_back(locked - start);
+
+      // The aggregation writes from write_pos on and wraps to the start of the stripe.
+      off_t pos = vol->header->write_pos;
+      if (pos >= write_pos[i]) {
+        agg_bytes += pos - write_pos[i];
+      } else {
+        agg_bytes += (vol->skip + vol->len - write_pos[i]) + (pos - vol->start);
+      }
+      write_pos[i] = pos;
+
+      CacheKey key = make_key(std::uniform_int_distribution<int>(0, config.keys - 1)(rng));
+      Dir result, *last_collision = nullptr;
+      dir_probe(&key, vol, &result, &last_collision);
+      probes.push_back(Thread::get_hrtime_updated() - locked);
+      MUTEX_UNTAKE_LOCK(vol->mutex, t);
+    }
+    return EVENT_CONT;
+  }
+
+  std::minstd_rand rng;
+  Event *event = nullptr;
+  std::atomic<bool> stopped{false};
+  std::atomic<bool> finished{false};
+
+  std::vector<off_t> write_pos;
+  std::vector<ink_hrtime> lock_waits;
+  std::vector<ink_hrtime> probes;
+  int64_t agg_bytes       = 0;
+  int64_t aio_depth_total = 0;
+  int64_t aio_samples     = 0;
+  int aio_depth_max       = 0;
+};
+
+void
+wait_for_idle_clients()
+{
+  while (idle.load(std::memory_order_acquire) < config.concurrency) {
+    usleep(10000);
+  }
+}
+
+// Reports the latency of @a samples as @a name, with its percentiles for humans.
+void
+report(bool json, const char *name, std::vector<ink_hrtime> &samples, int64_t failures, double run_seconds)
+{
+  ink_hrtime total = 0;
+  for (auto s : samples) {
+    total += s;
+  }
+  bench_report(json, name, samples.size(), static_cast<double>(total) / HRTIME_SECOND);
+
+  if (samples.empty()) {
+    fprintf(json ? stderr : stdout, "  no samples, %" PRId64 " failures\n", failures);
+    return;
+  }
+  std::sort(samples.begin(), samples.end());
+  auto percentile = [&](double p) {
+    return static_cast<double>(samples[static_cast<size_t>((samples.size() - 1) * p)]) / HRTIME_USECOND;
+  };
+  fprintf(json ? stderr : stdout, "  %.1f/s, %" PRId64 " failures, us p50 %.1f p99 %.1f max %.1f\n",
+          run_seconds > 0 ? samples.size() / run_seconds : 0, failures, percentile(0.5), percentile(0.99), percentile(1));
+}
+
+int
+usage(const char *name)
+{
+  fprintf(stderr, "usage: %s -d dir [-m mix] [-s sizes] [-k keys] [-c concurrency] [-t seconds] [-e threads] [-F] [-j]\n", name);
+  return 1;
+}
+} // namespace
+
+int
+main(int argc, char *argv[])
+{
+  const char *dir   = nullptr;
+  const char *mix   = "read:70,write:20,overwrite:5,remove:5";
+  const char *sizes = "4k:50,64k:40,1m:10";
+  int threads       = 4;
+  bool fill         = true;
+  bool json         = false;
+  int opt;
+  while ((opt = getopt(argc, argv, "d:m:s:k:c:t:e:Fj")) != -1) {
+    switch (opt) {
+    case 'd':
+      dir = optarg;
+      break;
+    case 'm':
+      mix = optarg;
+      break;
+    case 's':
+      sizes = optarg;
+      break;
+    case 'k':
+      config.keys = atoi(optarg);
+      break;
+    case 'c':
+      config.concurrency = atoi(optarg);
+      break;
+    case 't':
+      config.seconds = atoi(optarg);
+      break;
+    case 'e':
+      threads = atoi(optarg);
+      break;
+    case 'F':
+      fill = false;
+      break;
+    case 'j':
+      json = true;
+      break;
+    default:
+      return usage(argv[0]);
+    }
+  }
+  if (dir == nullptr || config.keys <= 0 || config.concurrency <= 0 || config.seconds <= 0 || threads <= 0) {
+    return usage(argv[0]);
+  }
+  if (!parse_weights(mix, config.mix.items, op_of)) {
+    fprintf(stderr, "%s: bad mix '%s'\n", argv[0], mix);
+    return 1;
+  }
+  if (!parse_weights(sizes, config.sizes.items, size_of)) {
+    fprintf(stderr, "%s: bad sizes '%s'\n", argv[0], sizes);
+    return 1;
+  }
+  config.mix.init();
+  config.sizes.init();
+
+  init_diags("", nullptr);
+  mime_init();
+  Layout::create();
+  RecProcessInit(RECM_STAND_ALONE);
+  LibRecordsConfigInit();
+  ink_net_init(ts::ModuleVersion(1, 0, ts::ModuleVersion::PRIVATE));
+  statPagesManager.init(); // mutex needs to be initialized before calling netProcessor.init
+  netProcessor.init();
+  eventProcessor.start(threads);
+  ink_aio_init(AIO_MODULE_PUBLIC_VERSION);
+
+  EThread *main_thread = new EThread;
+  main_thread->set_specific();
+  init_buffer_allocators(0);
+
+  Layout::get()->sysconfdir = dir;
+  Layout::get()->prefix     = dir;
+  ink_cache_init(ts::ModuleVersion(1, 0, ts::ModuleVersion::PRIVATE));
+  cacheProcessor.start();
+  for (int i = 0; !CacheProcessor::IsCacheReady(CACHE_FRAG_TYPE_NONE); ++i) {
+    if (i == 6000) {
+      fprintf(stderr, "%s: the cache in %s did not start\n", argv[0], dir);
+      return 1;
+    }
+    usleep(10000);
+  }
+
+  std::vector<Client *> clients;
+  for (int i = 0; i < config.concurrency; ++i) {
+    clients.push_back(new Client(i));
+  }
+  if (fill) {
+    for (auto client : clients) {
+      eventProcessor.schedule_imm(client, ET_CALL);
+    }
+    wait_for_idle_clients();
+  }
+
+  Sampler sampler;
+  run_start = Thread::get_hrtime_updated();
+  idle.store(0);
+  phase.store(PHASE_RUN, std::memory_order_release);
+  for (auto client : clients) {
+    eventProcessor.schedule_imm(client, ET_CALL);
+  }
+  {
+    SCOPED_MUTEX_LOCK(lock, sampler.mutex, main_thread);
+    sampler.start();
+  }
+
+  sleep(config.seconds);
+  phase.store(PHASE_STOP, std::memory_order_release);
+  sampler.stopped.store(true, std::memory_order_release);
+  double run_seconds = static_cast<double>(Thread::get_hrtime_updated() - run_start) / HRTIME_SECOND;
+  wait_for_idle_clients();
+  while (!sampler.finished.load(std::memory_order_acquire)) {
+    usleep(10000);
+  }
+
+  for (int op = 0; op < OP_COUNT; ++op) {
+    std::vector<ink_hrtime> samples;
+    int64_t failures = 0;
+    for (auto client : clients) {
+      auto const &l = client->latencies[op];
+      samples.insert(samples.end(), l.samples.begin(), l.samples.end());
+      failures += l.failures;
+    }
+    if (!samples.empty() || failures) {
+      std::string name = std::string("cache_") + OP_NAMES[op];
+      report(json, name.c_str(), samples, failures, run_seconds);
+    }
+  }
+  report(json, "cache_vol_lock_wait", sampler.lock_waits, 0, run_seconds);
+  report(json, "cache_dir_probe", sampler.probes, 0, run_seconds);
+  bench_report(json, "cache_agg_write_byte", sampler.agg_bytes, run_seconds);
+  fprintf(json ? stderr : stdout, "  aggregation wrote %.1f MB/s; AIO queue depth mean %.1f max %d\n",
+          sampler.agg_bytes / run_seconds / (1024 * 1024),
+          sampler.aio_samples ? static_cast<double>(sampler.aio_depth_total) / sampler.aio_samples : 0, sampler.aio_depth_max);
+
+  // The event threads do not stop, leave without tearing anything down.
+  fflush(stdout);
+  _exit(0);
+}
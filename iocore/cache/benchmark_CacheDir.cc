@@ -0,0 +1,166 @@
+/** @file
+
+  Cost of cache directory lookups.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  @section details Details
+
+  Usage: benchmark_CacheDir [-e entries] [-n iterations] [-j]
+
+  Lays out the directory of a stripe in memory, with no disk behind it, inserts @a entries
+  entries and probes for them and for as many keys that are not there, with the directory alone,
+  with the tag index and with the Bloom filter. With -j the results are JSON lines, for `make bench`.
+ */
+
+#include "P_Cache.h"
+#include "tscore/I_Layout.h"
+#include "bench_report.h"
+
+#include "diags.i"
+
+#include <cstdio>
+#include <cstdlib>
+#include <unistd.h>
+#include <vector>
+
+namespace
+{
+CacheKey
+make_key(uint64_t i)
+{
+  CacheKey key;
+  CryptoContext().hash_immediate(key, &i, sizeof(i));
+  return key;
+}
+
+// A stripe with a directory of about @a entries entries, half of them used once filled.
+Vol *
+make_vol(CacheVol *cache_vol, int entries)
+{
+  Vol *d       = new Vol;
+  d->cache_vol = cache_vol;
+  d->segments  = (entries / DIR_DEPTH + (1 << 14) - 1) / (1 << 14);
+  d->buckets   = (entries / DIR_DEPTH + d->segments - 1) / d->segments;
+  d->len       = static_cast<off_t>(d->direntries()) * 2 * 8000;
+  d->start     = 0;
+
+  d->raw_dir        = static_cast<char *>(ats_memalign(ats_pagesize(), d->dirlen()));
+  d->dir            = reinterpret_cast<Dir *>(d->raw_dir + d->headerlen());
+  d->header         = reinterpret_cast<VolHeaderFooter *>(d->raw_dir);
+  d->footer         = reinterpret_cast<VolHeaderFooter *>(d->raw_dir + d->dirlen() - ROUND_TO_STORE_BLOCK(sizeof(VolHeaderFooter)));
+  d->dirty_segments = static_cast<uint8_t *>(ats_malloc(d->segments));
+  memset(d->raw_dir, 0, d->dirlen());
+  memset(d->dirty_segments, DIR_SYNC_ALL, d->segments);
+  vol_init_dir(d);
+  // Everything before the aggregation position is valid in this phase.
+  d->header->agg_pos = d->len;
+  return d;
+}
+
+// Probes for @a keys, all of them must be found with @a hits. The tags of the entries are short,
+// some of the keys that are not there are found too, as the cache finds them before it reads.
+double
+time_probes(Vol *d, std::vector<CacheKey> const &keys, int iterations, bool hits)
+{
+  int found        = 0;
+  ink_hrtime start = ink_get_hrtime_internal();
+  for (int i = 0; i < iterations; ++i) {
+    for (auto const &key : keys) {
+      Dir result, *last_collision = nullptr;
+      found += dir_probe(&key, d, &result, &last_collision);
+    }
+  }
+  double seconds = static_cast<double>(ink_get_hrtime_internal() - start) / HRTIME_SECOND;
+  if (hits && found != static_cast<int>(keys.size()) * iterations) {
+    fprintf(stderr, "%zu keys inserted, %d found\n", keys.size(), found / iterations);
+    exit(1);
+  }
+  return seconds;
+}
+} // namespace
+
+int
+main(int argc, char *argv[])
+{
+  int entries    = 1 << 20;
+  int iterations = 4;
+  bool json      = false;
+  int opt;
+  while ((opt = getopt(argc, argv, "e:n:j")) != -1) {
+    if (opt == 'e') {
+      entries = atoi(optarg);
+    } else if (opt == 'n') {
+      iterations = atoi(optarg);
+    } else if (opt == 'j') {
+      json = true;
+    } else {
+      fprintf(stderr, "usage: %s [-e entries] [-n iterations] [-j]\n", argv[0]);
+      return 1;
+    }
+  }
+  if (entries < DIR_DEPTH || iterations <= 0) {
+    fprintf(stderr, "%s: the counts must be positive\n", argv[0]);
+    return 1;
+  }
+
+  Layout::create();
+  init_diags("", nullptr);
+  RecProcessInit(RECM_STAND_ALONE);
+  ink_event_system_init(EVENT_SYSTEM_MODULE_PUBLIC_VERSION);
+
+  EThread *main_thread = new EThread;
+  main_thread->set_specific();
+
+  cache_rsb = RecAllocateRawStatBlock(static_cast<int>(cache_stat_count));
+  CacheVol cache_vol;
+  cache_vol.vol_rsb = RecAllocateRawStatBlock(static_cast<int>(cache_stat_count));
+
+  Vol *d = make_vol(&cache_vol, entries);
+  SCOPED_MUTEX_LOCK(lock, d->mutex, main_thread);
+
+  std::vector<CacheKey> hits, misses;
+  for (int i = 0; i < entries / 2; ++i) {
+    CacheKey key = make_key(i);
+    Dir dir;
+    dir_set_offset(&dir, i + 1);
+    dir_set_approx_size(&dir, 8000);
+    dir_set_head(&dir, true);
+    if (dir_insert(&key, d, &dir)) {
+      hits.push_back(key);
+    }
+    misses.push_back(make_key(entries + i));
+  }
+
+  int64_t hit_ops  = static_cast<int64_t>(hits.size()) * iterations;
+  int64_t miss_ops = static_cast<int64_t>(misses.size()) * iterations;
+  bench_report(json, "dir_probe_hit", hit_ops, time_probes(d, hits, iterations, true));
+  bench_report(json, "dir_probe_miss", miss_ops, time_probes(d, misses, iterations, false));
+
+  cache_config_dir_tag_index = 1;
+  dir_tag_index_build(d);
+  bench_report(json, "dir_probe_miss_tag_index", miss_ops, time_probes(d, misses, iterations, false));
+  ats_memalign_free(d->tag_index);
+  d->tag_index = nullptr;
+
+  cache_config_dir_bloom_filter = 8;
+  dir_bloom_build(d);
+  bench_report(json, "dir_probe_miss_bloom_filter", miss_ops, time_probes(d, misses, iterations, false));
+  return 0;
+}
@@ -26,6 +26,8 @@
 
 #include "I_SplitDNS.h"
 
+#include <mutex>
+
 #define SRV_COST (RRFIXEDSZ + 0)
 #define SRV_WEIGHT (RRFIXEDSZ + 2)
 #define SRV_PORT (RRFIXEDSZ + 4)
@@ -44,6 +46,7 @@ int dns_failover_number              = DEFAULT_FAILOVER_NUMBER;
 int dns_failover_period              = DEFAULT_FAILOVER_PERIOD;
 int dns_failover_try_period          = DEFAULT_FAILOVER_TRY_PERIOD;
 int dns_max_dns_in_flight            = MAX_DNS_IN_FLIGHT;
+int dns_batch_size                   = 16;
 int dns_validate_qname               = 0;
 unsigned int dns_handler_initialized = 0;
 int dns_ns_rr                        = 0;
@@ -60,6 +63,13 @@ namespace
 {
 const int tcp_data_length_offset = 2;
 
+// Whether there are UDP connections, else every query goes over TCP or TLS.
+inline bool
+dns_over_udp()
+{
+  return dns_conn_mode == DNS_CONN_MODE::UDP_ONLY || dns_conn_mode == DNS_CONN_MODE::TCP_RETRY;
+}
+
 // Currently only used for A and AAAA.
 inline const char *
 QtypeName(int qtype)
@@ -71,6 +81,67 @@ is_addr_query(int qtype)
 {
   return qtype == T_A || qtype == T_AAAA;
 }
+
+#if HAVE_RECVMMSG || HAVE_SENDMMSG
+using ink_mmsghdr = struct mmsghdr;
+#else
+// Platforms without the batched calls get them emulated one message at a time.
+struct ink_mmsghdr {
+  struct msghdr msg_hdr;
+  unsigned int msg_len;
+};
+#endif
+
+// Upper bounds of the response time buckets in milliseconds, the last bucket has none.
+const int response_time_bucket_ms[DNS_RESPONSE_TIME_BUCKETS - 1] = {1, 5, 10, 50, 100, 500, 1000};
+
+// Both return the number of messages moved, or -errno if there were none.
+int
+dns_recv_batch(int fd, ink_mmsghdr *msgs, int n)
+{
+#if HAVE_RECVMMSG
+  int r = ::recvmmsg(fd, msgs, n, 0, nullptr);
+  return r < 0 ? -errno : r;
+#else
+  int i = 0;
+  for (; i < n; ++i) {
+    int r = socketManager.recvmsg(fd, &msgs[i].msg_hdr, 0);
+    if (r < 0) {
+      return i > 0 ? i : r;
+    }
+    msgs[i].msg_len = r;
+  }
+  return i;
+#endif
+}
+
+int
+dns_send_batch(int fd, ink_mmsghdr *msgs, int n)
+{
+#if HAVE_SENDMMSG
+  int r = ::sendmmsg(fd, msgs, n, 0);
+  return r < 0 ? -errno : r;
+#else
+  int i = 0;
+  for (; i < n; ++i) {
+    int r = socketManager.sendmsg(fd, &msgs[i].msg_hdr, 0);
+    if (r < 0) {
+      return i > 0 ? i : r;
+    }
+    msgs[i].msg_len = r;
+  }
+  return i;
+#endif
+}
+
+std::string
+entry_key(const char *qname, int qname_len, int qtype)
+{
+  std::string key(qname, qname_len);
+  key.push_back(static_cast<char>(qtype >> 8));
+  key.push_back(static_cast<char>(qtype));
+  return key;
+}
 } // namespace
 
 DNSProcessor dnsProcessor;
@@ -211,6 +282,8 @@ DNSProcessor::start(int, size_t stacksize)
   REC_EstablishStaticConfigInt32(dns_failover_number, "proxy.config.dns.failover_number");
   REC_EstablishStaticConfigInt32(dns_failover_period, "proxy.config.dns.failover_period");
   REC_EstablishStaticConfigInt32(dns_max_dns_in_flight, "proxy.config.dns.max_dns_in_flight");
+  REC_ReadConfigInt32(dns_batch_size, "proxy.config.dns.batch_size");
+  dns_batch_size = std::clamp(dns_batch_size, 1, DNS_MAX_BATCH_SIZE);
   REC_EstablishStaticConfigInt32(dns_validate_qname, "proxy.config.dns.validate_query_name");
   REC_EstablishStaticConfigInt32(dns_ns_rr, "proxy.config.dns.round_robin_nameservers");
   REC_ReadConfigStringAlloc(dns_ns_list, "proxy.config.dns.nameservers");
@@ -221,6 +294,13 @@ DNSProcessor::start(int, size_t stacksize)
   int dns_conn_mode_i = 0;
   REC_EstablishStaticConfigInt32(dns_conn_mode_i, "proxy.config.dns.connection_mode");
   dns_conn_mode = static_cast<DNS_CONN_MODE>(dns_conn_mode_i);
+  if (dns_conn_mode == DNS_CONN_MODE::TLS_ONLY) {
+    ats_scoped_str ca_file(REC_ConfigReadString("proxy.config.dns.tls.ca_file"));
+    ats_scoped_str server_name(REC_ConfigReadString("proxy.config.dns.tls.server_name"));
+    if (!DNSConnection::init_tls(ca_file, server_name, REC_ConfigReadInteger("proxy.config.dns.tls.verify"))) {
+      Fatal("unable to set up DNS over TLS, check proxy.config.dns.tls.ca_file");
+    }
+  }
 
   if (dns_thread > 0) {
     // TODO: Hmmm, should we just get a single thread some other way?
@@ -443,6 +523,41 @@ DNSEntry::init(const char *x, int len, int qtype_arg, Continuation *acont, DNSPr
   SET_HANDLER((DNSEntryHandler)&DNSEntry::mainEvent);
 }
 
+/**
+  First dns_rsb stat of the response time histogram of the nameserver at @a addr, registered
+  the first time the nameserver is used. Handlers share the histogram of a nameserver. Returns
+  -1 once MAX_NAMED nameservers have one.
+*/
+static int
+dns_response_time_stats(sockaddr const *addr)
+{
+  static std::mutex lock;
+  static std::unordered_map<std::string, int> stats;
+
+  ip_port_text_buffer ip_text;
+  std::string name = ats_ip_nptop(addr, ip_text, sizeof(ip_text));
+
+  std::lock_guard<std::mutex> guard(lock);
+  if (auto it = stats.find(name); it != stats.end()) {
+    return it->second;
+  }
+  if (stats.size() >= MAX_NAMED) {
+    return -1;
+  }
+  int base = DNS_RESPONSE_TIME_STAT_BASE + stats.size() * DNS_RESPONSE_TIME_BUCKETS;
+  for (int i = 0; i < DNS_RESPONSE_TIME_BUCKETS; ++i) {
+    std::string stat_name = "proxy.process.dns.nameserver." + name + ".response_time.";
+    if (i < DNS_RESPONSE_TIME_BUCKETS - 1) {
+      stat_name += "lt_" + std::to_string(response_time_bucket_ms[i]) + "ms";
+    } else {
+      stat_name += "ge_" + std::to_string(response_time_bucket_ms[i - 1]) + "ms";
+    }
+    RecRegisterRawStat(dns_rsb, RECT_PROCESS, stat_name.c_str(), RECD_INT, RECP_NON_PERSISTENT, base + i, RecRawStatSyncSum);
+  }
+  stats.emplace(name, base);
+  return base;
+}
+
 /**
  Open UDP and/or TCP connections based on dns_conn_mode
  */
@@ -450,7 +565,7 @@ DNSEntry::init(const char *x, int len, int qtype_arg, Continuation *acont, DNSPr
 void
 DNSHandler::open_cons(sockaddr const *target, bool failed, int icon)
 {
-  if (dns_conn_mode != DNS_CONN_MODE::TCP_ONLY) {
+  if (dns_over_udp()) {
     open_con(target, failed, icon, false);
   }
   if (dns_conn_mode != DNS_CONN_MODE::UDP_ONLY) {
@@ -486,6 +601,13 @@ DNSHandler::open_con(sockaddr const *target, bool failed, int icon, bool over_tc
     target = &ip.sa;
   }
   DNSConnection &cur_con = over_tcp ? tcpcon[icon] : udpcon[icon];
+  bool over_tls          = over_tcp && dns_conn_mode == DNS_CONN_MODE::TLS_ONLY;
+  IpEndpoint tls_target;
+  if (over_tls && ats_ip_port_host_order(target) == NAMESERVER_PORT) {
+    ats_ip_copy(&tls_target.sa, target);
+    ats_ip_port_cast(&tls_target.sa) = htons(DNS_TLS_PORT);
+    target                           = &tls_target.sa;
+  }
 
   Debug("dns", "open_con: opening connection %s", ats_ip_nptop(target, ip_text, sizeof ip_text));
 
@@ -497,6 +619,7 @@ DNSHandler::open_con(sockaddr const *target, bool failed, int icon, bool over_tc
                                 .setNonBlockingConnect(true)
                                 .setNonBlockingIo(true)
                                 .setUseTcp(over_tcp)
+                                .setUseTls(over_tls)
                                 .setBindRandomPort(true)
                                 .setLocalIpv6(&local_ipv6.sa)
                                 .setLocalIpv4(&local_ipv4.sa)) < 0) {
@@ -511,10 +634,12 @@ DNSHandler::open_con(sockaddr const *target, bool failed, int icon, bool over_tc
     return;
   } else {
     ns_down[icon] = 0;
-    if (cur_con.eio.start(pd, &cur_con, EVENTIO_READ) < 0) {
+    // A TLS connection also needs to know when it can write, for the handshake and queued queries.
+    if (cur_con.eio.start(pd, &cur_con, over_tls ? EVENTIO_READ | EVENTIO_WRITE : EVENTIO_READ) < 0) {
       Error("[iocore_dns] open_con: Failed to add %d server to epoll list\n", icon);
     } else {
-      cur_con.num = icon;
+      cur_con.num                 = icon;
+      ns_response_time_stat[icon] = dns_response_time_stats(target);
       Debug("dns", "opening connection %s SUCCEEDED for %d", ip_text, icon);
     }
   }
@@ -642,7 +767,7 @@ DNSHandler::retry_named(int ndx, ink_hrtime t, bool reopen)
   if (reopen && ((t - last_primary_reopen) > DNS_PRIMARY_REOPEN_PERIOD)) {
     Debug("dns", "retry_named: reopening DNS connection for index %d", ndx);
     last_primary_reopen = t;
-    if (dns_conn_mode != DNS_CONN_MODE::TCP_ONLY) {
+    if (dns_over_udp()) {
       udpcon[ndx].close();
     }
     if (dns_conn_mode != DNS_CONN_MODE::UDP_ONLY) {
@@ -650,15 +775,15 @@ DNSHandler::retry_named(int ndx, ink_hrtime t, bool reopen)
     }
     open_cons(&m_res->nsaddr_list[ndx].sa, true, ndx);
   }
-  bool over_tcp = dns_conn_mode == DNS_CONN_MODE::TCP_ONLY;
-  int con_fd    = over_tcp ? tcpcon[ndx].fd : udpcon[ndx].fd;
+  bool over_tcp      = !dns_over_udp();
+  DNSConnection &con = over_tcp ? tcpcon[ndx] : udpcon[ndx];
   unsigned char buffer[MAX_DNS_REQUEST_LEN];
   Debug("dns", "trying to resolve '%s' from DNS connection, ndx %d", try_server_names[try_servers], ndx);
   int r       = _ink_res_mkquery(m_res, try_server_names[try_servers], T_A, buffer, over_tcp);
   try_servers = (try_servers + 1) % countof(try_server_names);
   ink_assert(r >= 0);
   if (r >= 0) { // looking for a bounce
-    int res = socketManager.send(con_fd, buffer, r, 0);
+    int res = con.send(buffer, r);
     Debug("dns", "ping result = %d", res);
   }
 }
@@ -674,8 +799,8 @@ DNSHandler::try_primary_named(bool reopen)
   }
   if ((t - last_primary_retry) > DNS_PRIMARY_RETRY_PERIOD) {
     unsigned char buffer[MAX_DNS_REQUEST_LEN];
-    bool over_tcp      = dns_conn_mode == DNS_CONN_MODE::TCP_ONLY;
-    int con_fd         = over_tcp ? tcpcon[0].fd : udpcon[0].fd;
+    bool over_tcp      = !dns_over_udp();
+    DNSConnection &con = over_tcp ? tcpcon[0] : udpcon[0];
     last_primary_retry = t;
     Debug("dns", "trying to resolve '%s' from primary DNS connection", try_server_names[try_servers]);
     int r = _ink_res_mkquery(m_res, try_server_names[try_servers], T_A, buffer, over_tcp);
@@ -688,7 +813,7 @@ DNSHandler::try_primary_named(bool reopen)
     }
     ink_assert(r >= 0);
     if (r >= 0) { // looking for a bounce
-      int res = socketManager.send(con_fd, buffer, r, 0);
+      int res = con.send(buffer, r);
       Debug("dns", "ping result = %d", res);
     }
   }
@@ -740,7 +865,7 @@ DNSHandler::failover()
     }
     switch_named(name_server);
   } else {
-    if (dns_conn_mode != DNS_CONN_MODE::TCP_ONLY) {
+    if (dns_over_udp()) {
       udpcon[0].close();
     }
     if (dns_conn_mode != DNS_CONN_MODE::UDP_ONLY) {
@@ -817,126 +942,178 @@ void
 DNSHandler::recv_dns(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
 {
   DNSConnection *dnsc = nullptr;
-  ip_text_buffer ipbuff1, ipbuff2;
-  Ptr<HostEnt> buf;
   while ((dnsc = static_cast<DNSConnection *>(triggered.dequeue()))) {
-    while (true) {
-      int res;
-      IpEndpoint from_ip;
-      socklen_t from_length = sizeof(from_ip);
-      if (dnsc->opt._use_tcp) {
-        if (dnsc->tcp_data.buf_ptr == nullptr) {
-          dnsc->tcp_data.buf_ptr = make_ptr(dnsBufAllocator.alloc());
-        }
-        if (dnsc->tcp_data.total_length == 0) {
-          // see if TS gets a two-byte size
-          uint16_t tmp = 0;
-          res          = socketManager.recv(dnsc->fd, &tmp, sizeof(tmp), MSG_PEEK);
-          if (res == -EAGAIN || res == 1) {
-            break;
-          }
-          if (res <= 0) {
-            goto Lerror;
-          }
-          // reading total size
-          res = socketManager.recv(dnsc->fd, &(dnsc->tcp_data.total_length), sizeof(dnsc->tcp_data.total_length), 0);
-          if (res == -EAGAIN) {
-            break;
-          }
-          if (res <= 0) {
-            goto Lerror;
-          }
-          dnsc->tcp_data.total_length = ntohs(dnsc->tcp_data.total_length);
-          if (res != sizeof(dnsc->tcp_data.total_length)) {
-            goto Lerror;
-          }
-        }
-        // continue reading data
-        void *buf_start = (char *)dnsc->tcp_data.buf_ptr->buf + dnsc->tcp_data.done_reading;
-        res             = socketManager.recv(dnsc->fd, buf_start, dnsc->tcp_data.total_length - dnsc->tcp_data.done_reading, 0);
-        if (res == -EAGAIN) {
-          break;
-        }
-        if (res <= 0) {
-          goto Lerror;
-        }
-        Debug("dns", "received packet size = %d over TCP", res);
-        dnsc->tcp_data.done_reading += res;
-        if (dnsc->tcp_data.done_reading < dnsc->tcp_data.total_length) {
-          break;
-        }
-        buf = dnsc->tcp_data.buf_ptr;
-        res = dnsc->tcp_data.total_length;
-        dnsc->tcp_data.reset();
-        goto Lsuccess;
+    if (!(dnsc->opt._use_tcp ? recv_tcp(dnsc) : recv_udp(dnsc))) {
+      if (dns_ns_rr) {
+        rr_failure(dnsc->num);
+      } else if (dnsc->num == name_server) {
+        failover();
       }
+    }
+  }
+}
 
-      if (!hostent_cache) {
-        hostent_cache = dnsBufAllocator.alloc();
+/** Read what there is from a TCP connection. Returns false on a connection error. */
+bool
+DNSHandler::recv_tcp(DNSConnection *dnsc)
+{
+  Ptr<HostEnt> buf;
+  while (true) {
+    int res;
+    if (dnsc->tcp_data.buf_ptr == nullptr) {
+      dnsc->tcp_data.buf_ptr = make_ptr(dnsBufAllocator.alloc());
+    }
+    if (dnsc->tcp_data.length_read < sizeof(dnsc->tcp_data.total_length)) {
+      // reading the two-byte size, which may come split over two reads
+      {
+        char *len_start = reinterpret_cast<char *>(&dnsc->tcp_data.total_length) + dnsc->tcp_data.length_read;
+        res             = dnsc->recv(len_start, sizeof(dnsc->tcp_data.total_length) - dnsc->tcp_data.length_read);
       }
-
-      res = socketManager.recvfrom(dnsc->fd, hostent_cache->buf, MAX_DNS_RESPONSE_LEN, 0, &from_ip.sa, &from_length);
-      Debug("dns", "DNSHandler::recv_dns res = [%d]", res);
       if (res == -EAGAIN) {
-        break;
+        return true;
       }
       if (res <= 0) {
-      Lerror:
-        Debug("dns", "named error: %d", res);
-        if (dns_ns_rr) {
-          rr_failure(dnsc->num);
-        } else if (dnsc->num == name_server) {
-          failover();
-        }
-        break;
+        goto Lerror;
       }
+      dnsc->tcp_data.length_read += res;
+      if (dnsc->tcp_data.length_read < sizeof(dnsc->tcp_data.total_length)) {
+        continue;
+      }
+      dnsc->tcp_data.total_length = ntohs(dnsc->tcp_data.total_length);
+    }
+    // continue reading data
+    {
+      void *buf_start = (char *)dnsc->tcp_data.buf_ptr->buf + dnsc->tcp_data.done_reading;
+      res             = dnsc->recv(buf_start, dnsc->tcp_data.total_length - dnsc->tcp_data.done_reading);
+    }
+    if (res == -EAGAIN) {
+      return true;
+    }
+    if (res <= 0) {
+      goto Lerror;
+    }
+    Debug("dns", "received packet size = %d over TCP", res);
+    dnsc->tcp_data.done_reading += res;
+    if (dnsc->tcp_data.done_reading < dnsc->tcp_data.total_length) {
+      return true;
+    }
+    buf = dnsc->tcp_data.buf_ptr;
+    res = dnsc->tcp_data.total_length;
+    dnsc->tcp_data.reset();
+    received(dnsc, buf, res);
+    continue;
+
+  Lerror:
+    Debug("dns", "named error: %d", res);
+    return false;
+  }
+}
+
+/** Read what there is from a UDP connection, up to dns_batch_size responses per call. Returns false on a connection error. */
+bool
+DNSHandler::recv_udp(DNSConnection *dnsc)
+{
+  ProxyMutex *mutex = this->mutex.get();
+  ip_text_buffer ipbuff1, ipbuff2;
+  ink_mmsghdr msgs[DNS_MAX_BATCH_SIZE];
+  struct iovec iov[DNS_MAX_BATCH_SIZE];
+  IpEndpoint from_ip[DNS_MAX_BATCH_SIZE];
+  Ptr<HostEnt> buf;
 
+  while (true) {
+    memset(msgs, 0, sizeof(msgs[0]) * dns_batch_size);
+    for (int i = 0; i < dns_batch_size; ++i) {
+      if (!recv_bufs[i]) {
+        recv_bufs[i] = dnsBufAllocator.alloc();
+      }
+      iov[i].iov_base                = recv_bufs[i]->buf;
+      iov[i].iov_len                 = MAX_DNS_RESPONSE_LEN;
+      msgs[i].msg_hdr.msg_name       = &from_ip[i].sa;
+      msgs[i].msg_hdr.msg_namelen    = sizeof(from_ip[i]);
+      msgs[i].msg_hdr.msg_iov        = &iov[i];
+      msgs[i].msg_hdr.msg_iovlen     = 1;
+      msgs[i].msg_hdr.msg_control    = nullptr;
+      msgs[i].msg_hdr.msg_controllen = 0;
+    }
+
+    int n = dns_recv_batch(dnsc->fd, msgs, dns_batch_size);
+    Debug("dns", "DNSHandler::recv_udp res = [%d]", n);
+    if (n == -EAGAIN) {
+      return true;
+    }
+    if (n <= 0) {
+      Debug("dns", "named error: %d", n);
+      return false;
+    }
+    if (n > 1) {
+      DNS_INCREMENT_DYN_STAT(dns_batch_recvs_stat);
+    }
+
+    for (int i = 0; i < n; ++i) {
+      int res = msgs[i].msg_len;
+      if (res <= 0) {
+        Debug("dns", "named error: %d", res);
+        return false;
+      }
       // verify that this response came from the correct server
-      if (!ats_ip_addr_eq(&dnsc->ip.sa, &from_ip.sa)) {
-        Warning("unexpected DNS response from %s (expected %s)", ats_ip_ntop(&from_ip.sa, ipbuff1, sizeof ipbuff1),
+      if (!ats_ip_addr_eq(&dnsc->ip.sa, &from_ip[i].sa)) {
+        Warning("unexpected DNS response from %s (expected %s)", ats_ip_ntop(&from_ip[i].sa, ipbuff1, sizeof ipbuff1),
                 ats_ip_ntop(&dnsc->ip.sa, ipbuff2, sizeof ipbuff2));
         continue;
       }
-      buf              = hostent_cache;
-      hostent_cache    = nullptr;
+      buf              = recv_bufs[i];
+      recv_bufs[i]     = nullptr;
       buf->packet_size = res;
       Debug("dns", "received packet size = %d", res);
-    Lsuccess:
-      if (dns_ns_rr) {
-        Debug("dns", "round-robin: nameserver %d DNS response code = %d", dnsc->num, get_rcode(buf->buf));
-        if (good_rcode(buf->buf)) {
-          received_one(dnsc->num);
-          if (ns_down[dnsc->num]) {
-            Warning("connection to DNS server %s restored",
-                    ats_ip_ntop(&m_res->nsaddr_list[dnsc->num].sa, ipbuff1, sizeof ipbuff1));
-            ns_down[dnsc->num] = 0;
-          }
-        }
-      } else {
-        if (!dnsc->num) {
-          Debug("dns", "primary DNS response code = %d", get_rcode(buf->buf));
-          if (good_rcode(buf->buf)) {
-            if (name_server) {
-              recover();
-            } else {
-              received_one(name_server);
-            }
-          }
-        }
+      received(dnsc, buf, res);
+    }
+    // Fewer than asked for, the socket is drained.
+    if (n < dns_batch_size) {
+      return true;
+    }
+  }
+}
+
+/** Handle one response read from @a dnsc. */
+void
+DNSHandler::received(DNSConnection *dnsc, Ptr<HostEnt> &buf, int res)
+{
+  ip_text_buffer ipbuff1;
+  if (dns_ns_rr) {
+    Debug("dns", "round-robin: nameserver %d DNS response code = %d", dnsc->num, get_rcode(buf->buf));
+    if (good_rcode(buf->buf)) {
+      received_one(dnsc->num);
+      if (ns_down[dnsc->num]) {
+        Warning("connection to DNS server %s restored", ats_ip_ntop(&m_res->nsaddr_list[dnsc->num].sa, ipbuff1, sizeof ipbuff1));
+        ns_down[dnsc->num] = 0;
       }
-      if (dns_process(this, buf.get(), res)) {
-        if (dnsc->num == name_server) {
+    }
+  } else {
+    if (!dnsc->num) {
+      Debug("dns", "primary DNS response code = %d", get_rcode(buf->buf));
+      if (good_rcode(buf->buf)) {
+        if (name_server) {
+          recover();
+        } else {
           received_one(name_server);
         }
       }
     }
   }
+  if (dns_process(this, buf.get(), res)) {
+    if (dnsc->num == name_server) {
+      received_one(name_server);
+    }
+  }
 }
 
 /** Main event for the DNSHandler. Attempt to read from and write to named. */
 int
 DNSHandler::mainEvent(int event, Event *e)
 {
+  if (e && e == flush_event) {
+    flush_event = nullptr;
+  }
   recv_dns(event, e);
   if (dns_ns_rr) {
     ink_hrtime t = Thread::get_hrtime();
@@ -979,6 +1156,7 @@ DNSHandler::mainEvent(int event, Event *e)
   if (entries.head) {
     write_dns(this);
   }
+  flush_queries();
 
   if (std::any_of(ns_down, ns_down + n_con, [](int f) { return f != 0; })) {
     this_ethread()->schedule_at(this, DNS_PRIMARY_RETRY_PERIOD);
@@ -991,37 +1169,33 @@ DNSHandler::mainEvent(int event, Event *e)
 inline static DNSEntry *
 get_dns(DNSHandler *h, uint16_t id)
 {
-  for (DNSEntry *e = h->entries.head; e; e = static_cast<DNSEntry *>(e->link.next)) {
-    if (e->once_written_flag) {
-      for (int j : e->id) {
-        if (j == id) {
-          return e;
-        } else if (j < 0) {
-          goto Lnext;
-        }
-      }
-    }
-  Lnext:;
+  DNSEntry *e = h->qid_entry[id];
+  return e && e->once_written_flag ? e : nullptr;
+}
+
+/** Add @a e, which is in entries, to the index used to collapse duplicate queries. */
+void
+DNSHandler::index_entry(DNSEntry *e)
+{
+  entry_index.emplace(entry_key(e->qname, e->qname_len, e->qtype), e);
+}
+
+/** Remove @a e from the index, before it leaves entries or its query name changes. */
+void
+DNSHandler::unindex_entry(DNSEntry *e)
+{
+  auto it = entry_index.find(entry_key(e->qname, e->qname_len, e->qtype));
+  if (it != entry_index.end() && it->second == e) {
+    entry_index.erase(it);
   }
-  return nullptr;
 }
 
 /** Find a DNSEntry by query name and type. */
-inline static DNSEntry *
-get_entry(DNSHandler *h, char *qname, int qtype)
+DNSEntry *
+DNSHandler::find_entry(const char *qname, int qname_len, int qtype)
 {
-  for (DNSEntry *e = h->entries.head; e; e = static_cast<DNSEntry *>(e->link.next)) {
-    if (e->qtype == qtype) {
-      if (is_addr_query(qtype)) {
-        if (!strcmp(qname, e->qname)) {
-          return e;
-        }
-      } else if (0 == memcmp(qname, e->qname, e->qname_len)) {
-        return e;
-      }
-    }
-  }
-  return nullptr;
+  auto it = entry_index.find(entry_key(qname, qname_len, qtype));
+  return it != entry_index.end() ? it->second : nullptr;
 }
 
 /** Write up to dns_max_dns_in_flight entries. */
@@ -1045,8 +1219,9 @@ write_dns(DNSHandler *h, bool tcp_retry)
   if (h->in_write_dns) {
     return;
   }
+
   h->in_write_dns = true;
-  bool over_tcp   = (dns_conn_mode == DNS_CONN_MODE::TCP_ONLY) || ((dns_conn_mode == DNS_CONN_MODE::TCP_RETRY) && tcp_retry);
+  bool over_tcp   = !dns_over_udp() || ((dns_conn_mode == DNS_CONN_MODE::TCP_RETRY) && tcp_retry);
   // Debug("dns", "in_flight: %d, dns_max_dns_in_flight: %d", h->in_flight, dns_max_dns_in_flight);
   if (h->in_flight < dns_max_dns_in_flight) {
     DNSEntry *e = h->entries.head;
@@ -1115,10 +1290,16 @@ static bool
 write_dns_event(DNSHandler *h, DNSEntry *e, bool over_tcp)
 {
   ProxyMutex *mutex = h->mutex.get();
-  unsigned char buffer[MAX_DNS_REQUEST_LEN];
-  int offset     = over_tcp ? tcp_data_length_offset : 0;
-  HEADER *header = reinterpret_cast<HEADER *>(buffer + offset);
-  int r          = 0;
+  unsigned char query[MAX_DNS_REQUEST_LEN];
+  DNSHandler::QueryBatch &batch = h->query_batch;
+  bool batched                  = !over_tcp && dns_batch_size > 1;
+  if (batched && batch.n >= dns_batch_size && !h->flush_queries()) {
+    return false;
+  }
+  unsigned char *buffer = batched ? batch.query[batch.n] : query;
+  int offset            = over_tcp ? tcp_data_length_offset : 0;
+  HEADER *header        = reinterpret_cast<HEADER *>(buffer + offset);
+  int r                 = 0;
 
   if ((r = _ink_res_mkquery(h->m_res, e->qname, e->qtype, buffer, over_tcp)) <= 0) {
     Debug("dns", "cannot build query: %s", e->qname);
@@ -1133,10 +1314,23 @@ write_dns_event(DNSHandler *h, DNSEntry *e, bool over_tcp)
     h->release_query_id(e->id[dns_retries - e->retries]);
   }
   e->id[dns_retries - e->retries] = i;
-  int con_fd                      = over_tcp ? h->tcpcon[h->name_server].fd : h->udpcon[h->name_server].fd;
-  Debug("dns", "send query (qtype=%d) for %s to fd %d", e->qtype, e->qname, con_fd);
-
-  int s = socketManager.send(con_fd, buffer, r, 0);
+  h->qid_entry[i]                 = e;
+  DNSConnection &con               = over_tcp ? h->tcpcon[h->name_server] : h->udpcon[h->name_server];
+  Debug("dns", "send query (qtype=%d) for %s to fd %d", e->qtype, e->qname, con.fd);
+
+  int s = r;
+  if (batched) {
+    batch.entry[batch.n] = e;
+    batch.ns[batch.n]    = h->name_server;
+    batch.len[batch.n]   = r;
+    ++batch.n;
+    // The batch goes out from the next mainEvent, with whatever else is written until then.
+    if (!h->flush_event) {
+      h->flush_event = h->mutex->thread_holding->schedule_imm(h);
+    }
+  } else {
+    s = con.send(buffer, r);
+  }
   if (s != r) {
     Debug("dns", "send() failed: qname = %s, %d != %d, nameserver= %d", e->qname, s, r, h->name_server);
     // changed if condition from 'r < 0' to 's < 0' - 8/2001 pas
@@ -1173,6 +1367,86 @@ write_dns_event(DNSHandler *h, DNSEntry *e, bool over_tcp)
   return true;
 }
 
+/**
+  Send the queries batched by write_dns_event, one sendmmsg per nameserver. Entries left unsent
+  are marked as not written, they go out with the next write_dns.
+
+  @return false if a send failed.
+*/
+bool
+DNSHandler::flush_queries()
+{
+  ProxyMutex *mutex = this->mutex.get();
+  QueryBatch &batch = query_batch;
+  bool ok           = true;
+
+  bool done[DNS_MAX_BATCH_SIZE] = {false};
+  ink_mmsghdr msgs[DNS_MAX_BATCH_SIZE];
+  struct iovec iov[DNS_MAX_BATCH_SIZE];
+  DNSEntry *sent_entry[DNS_MAX_BATCH_SIZE];
+
+  for (int first = 0; first < batch.n; ++first) {
+    if (done[first]) {
+      continue;
+    }
+    int ns = batch.ns[first];
+    int n  = 0;
+    for (int i = first; i < batch.n; ++i) {
+      if (done[i] || batch.ns[i] != ns) {
+        continue;
+      }
+      done[i] = true;
+      // The entry may have been finished, retried or failed over since it was batched.
+      DNSEntry *e = batch.entry[i];
+      if (!e || !e->written_flag || e->which_ns != ns) {
+        continue;
+      }
+      memset(&msgs[n], 0, sizeof(msgs[n]));
+      iov[n].iov_base            = batch.query[i];
+      iov[n].iov_len             = batch.len[i];
+      msgs[n].msg_hdr.msg_iov    = &iov[n];
+      msgs[n].msg_hdr.msg_iovlen = 1;
+      sent_entry[n]              = e;
+      ++n;
+    }
+    if (n == 0) {
+      continue;
+    }
+
+    int sent = dns_send_batch(udpcon[ns].fd, msgs, n);
+    Debug("dns", "sent %d of %d queries to nameserver %d", sent, n, ns);
+    if (sent > 1) {
+      DNS_INCREMENT_DYN_STAT(dns_batch_sends_stat);
+    }
+    if (sent < n) {
+      for (int i = std::max(sent, 0); i < n; ++i) {
+        DNSEntry *e = sent_entry[i];
+        if (!e->written_flag) {
+          continue;
+        }
+        e->written_flag = false;
+        --in_flight;
+        DNS_DECREMENT_DYN_STAT(dns_in_flight_stat);
+        if (e->timeout) {
+          e->timeout->cancel();
+          e->timeout = nullptr;
+        }
+      }
+      ok = false;
+      if (sent < 0) {
+        Debug("dns", "sendmmsg() failed: %d, nameserver= %d", sent, ns);
+        if (dns_ns_rr) {
+          rr_failure(ns);
+        } else if (ns == name_server) {
+          failover();
+        }
+      }
+    }
+  }
+  batch.n = 0;
+  return ok;
+}
+
 int
 DNSEntry::delayEvent(int event, Event *e)
 {
@@ -1217,13 +1491,15 @@ DNSEntry::mainEvent(int event, Event *e)
       domains = nullptr;
     }
     Debug("dns", "enqueuing query %s", qname);
-    DNSEntry *dup = get_entry(dnsH, qname, qtype);
+    DNSEntry *dup = dnsH->find_entry(qname, qname_len, qtype);
     if (dup) {
       Debug("dns", "collapsing NS request");
+      DNS_INCREMENT_DYN_STAT(dns_collapsed_lookups_stat);
       dup->dups.enqueue(this);
     } else {
       Debug("dns", "adding first to collapsing queue");
       dnsH->entries.enqueue(this);
+      dnsH->index_entry(this);
       write_dns(dnsH);
     }
     return EVENT_DONE;
@@ -1295,9 +1571,11 @@ dns_result(DNSHandler *h, DNSEntry *e, HostEnt *ent, bool retry, bool tcp_retry)
         if (e->orig_qname_len + strlen(*e->domains) + 2 > MAXDNAME) {
           Debug("dns", "domain too large %.*s + %s", e->orig_qname_len, e->qname, *e->domains);
         } else {
+          h->unindex_entry(e);
           e->qname[e->orig_qname_len] = '.';
           e->qname_len =
             e->orig_qname_len + 1 + ink_strlcpy(e->qname + e->orig_qname_len + 1, *e->domains, MAXDNAME - (e->orig_qname_len + 1));
+          h->index_entry(e);
           ++(e->domains);
           e->retries = dns_retries;
           Debug("dns", "new name = %s retries = %d", e->qname, e->retries);
@@ -1333,7 +1611,13 @@ dns_result(DNSHandler *h, DNSEntry *e, HostEnt *ent, bool retry, bool tcp_retry)
   }
 
   // Remove head node from DNSHandler::entries queue
+  h->unindex_entry(e);
   h->entries.remove(e);
+  for (int i = 0; i < h->query_batch.n; ++i) {
+    if (h->query_batch.entry[i] == e) {
+      h->query_batch.entry[i] = nullptr;
+    }
+  }
   // Release Query ID from DNSHandler
   for (int i : e->id) {
     if (i < 0) {
@@ -1476,7 +1760,15 @@ dns_process(DNSHandler *handler, HostEnt *buf, int len)
   --(handler->in_flight);
   DNS_DECREMENT_DYN_STAT(dns_in_flight_stat);
 
-  DNS_SUM_DYN_STAT(dns_response_time_stat, Thread::get_hrtime() - e->send_time);
+  ink_hrtime response_time = Thread::get_hrtime() - e->send_time;
+  DNS_SUM_DYN_STAT(dns_response_time_stat, response_time);
+  if (e->which_ns >= 0 && e->which_ns < MAX_NAMED && handler->ns_response_time_stat[e->which_ns] >= 0) {
+    int bucket = 0;
+    while (bucket < DNS_RESPONSE_TIME_BUCKETS - 1 && response_time >= HRTIME_MSECONDS(response_time_bucket_ms[bucket])) {
+      ++bucket;
+    }
+    DNS_INCREMENT_DYN_STAT(handler->ns_response_time_stat[e->which_ns] + bucket);
+  }
 
   // retrying over TCP when truncated is set
   if (dns_conn_mode == DNS_CONN_MODE::TCP_RETRY && h->tc == 1) {
@@ -1816,7 +2108,7 @@ ink_dns_init(ts::ModuleVersion v)
   init_called = 1;
   // do one time stuff
   // create a stat block for HostDBStats
-  dns_rsb = RecAllocateRawStatBlock(static_cast<int>(DNS_Stat_Count));
+  dns_rsb = RecAllocateRawStatBlock(static_cast<int>(DNS_RSB_SIZE));
 
   //
   // Register statistics callbacks
@@ -1847,6 +2139,15 @@ ink_dns_init(ts::ModuleVersion v)
 
   RecRegisterRawStat(dns_rsb, RECT_PROCESS, "proxy.process.dns.in_flight", RECD_INT, RECP_NON_PERSISTENT, (int)dns_in_flight_stat,
                      RecRawStatSyncSum);
+
+  RecRegisterRawStat(dns_rsb, RECT_PROCESS, "proxy.process.dns.collapsed_lookups", RECD_INT, RECP_NON_PERSISTENT,
+                     (int)dns_collapsed_lookups_stat, RecRawStatSyncSum);
+
+  RecRegisterRawStat(dns_rsb, RECT_PROCESS, "proxy.process.dns.batch_sends", RECD_INT, RECP_NON_PERSISTENT,
+                     (int)dns_batch_sends_stat, RecRawStatSyncSum);
+
+  RecRegisterRawStat(dns_rsb, RECT_PROCESS, "proxy.process.dns.batch_recvs", RECD_INT, RECP_NON_PERSISTENT,
+                     (int)dns_batch_recvs_stat, RecRawStatSyncSum);
 }
 
 #if TS_HAS_TESTS
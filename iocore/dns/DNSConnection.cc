@@ -31,6 +31,9 @@
 #include "P_DNSConnection.h"
 #include "P_DNSProcessor.h"
 
+#include <openssl/err.h>
+#include <openssl/x509v3.h>
+
 #define SET_TCP_NO_DELAY
 #define SET_NO_LINGER
 #define SET_SO_KEEPALIVE
@@ -43,6 +46,8 @@
 #define ROUNDUP(x, y) ((((x) + ((y)-1)) / (y)) * (y))
 
 DNSConnection::Options const DNSConnection::DEFAULT_OPTIONS;
+SSL_CTX *DNSConnection::tls_ctx = nullptr;
+std::string DNSConnection::tls_server_name;
 
 //
 // Functions
@@ -57,12 +62,28 @@ DNSConnection::DNSConnection()
 DNSConnection::~DNSConnection()
 {
   close();
+  if (tls_session) {
+    SSL_SESSION_free(tls_session);
+  }
 }
 
 int
 DNSConnection::close()
 {
   eio.stop();
+  if (ssl) {
+    if (SSL_is_init_finished(ssl)) {
+      if (SSL_SESSION *session = SSL_get1_session(ssl)) {
+        if (tls_session) {
+          SSL_SESSION_free(tls_session);
+        }
+        tls_session = session;
+      }
+    }
+    SSL_free(ssl);
+    ssl = nullptr;
+  }
+  tls_pending.clear();
   // don't close any of the standards
   if (fd >= 2) {
     int fd_save = fd;
@@ -211,6 +232,10 @@ DNSConnection::connect(sockaddr const *addr, Options const &opt)
     goto Lerror;
   }
 
+  if (opt._use_tls && (res = start_tls(addr)) < 0) {
+    goto Lerror;
+  }
+
   return 0;
 
 Lerror:
@@ -219,3 +244,118 @@ Lerror:
   }
   return res;
 }
+
+bool
+DNSConnection::init_tls(const char *ca_file, const char *server_name, bool verify)
+{
+  SSL_CTX *ctx = SSL_CTX_new(SSLv23_client_method());
+
+  if (ctx == nullptr) {
+    return false;
+  }
+  // RFC 8310 asks for at least TLS 1.2.
+  SSL_CTX_set_options(ctx, SSL_OP_NO_SSLv2 | SSL_OP_NO_SSLv3 | SSL_OP_NO_TLSv1 | SSL_OP_NO_TLSv1_1);
+  SSL_CTX_set_mode(ctx, SSL_MODE_ENABLE_PARTIAL_WRITE | SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER);
+  if (!(ca_file && *ca_file ? SSL_CTX_load_verify_locations(ctx, ca_file, nullptr) : SSL_CTX_set_default_verify_paths(ctx))) {
+    SSL_CTX_free(ctx);
+    return false;
+  }
+  SSL_CTX_set_verify(ctx, verify ? SSL_VERIFY_PEER : SSL_VERIFY_NONE, nullptr);
+
+  tls_ctx         = ctx;
+  tls_server_name = server_name ? server_name : "";
+  return true;
+}
+
+// The nameserver is checked by name if there is one, else by its address.
+int
+DNSConnection::start_tls(sockaddr const *addr)
+{
+  if (tls_ctx == nullptr || (ssl = SSL_new(tls_ctx)) == nullptr || !SSL_set_fd(ssl, fd)) {
+    return -ENOMEM;
+  }
+  SSL_set_connect_state(ssl);
+  X509_VERIFY_PARAM *param = SSL_get0_param(ssl);
+  if (!tls_server_name.empty()) {
+    SSL_set_tlsext_host_name(ssl, tls_server_name.c_str());
+    X509_VERIFY_PARAM_set1_host(param, tls_server_name.c_str(), 0);
+  } else {
+    IpEndpoint target;
+    ats_ip_copy(&target.sa, addr);
+    X509_VERIFY_PARAM_set1_ip(param, ats_ip_addr8_cast(&target.sa), ats_ip_addr_size(&target.sa));
+  }
+  if (tls_session) {
+    SSL_set_session(ssl, tls_session);
+  }
+  return 0;
+}
+
+int
+DNSConnection::tls_error(int ret)
+{
+  int err = SSL_get_error(ssl, ret);
+
+  switch (err) {
+  case SSL_ERROR_WANT_READ:
+  case SSL_ERROR_WANT_WRITE:
+    return -EAGAIN;
+  case SSL_ERROR_ZERO_RETURN:
+    return 0;
+  case SSL_ERROR_SYSCALL:
+    return errno ? -errno : -EPIPE;
+  default: {
+    char buf[256];
+    long verify = SSL_get_verify_result(ssl);
+    if (verify != X509_V_OK) {
+      ip_port_text_buffer b;
+      Warning("DNS over TLS to %s failed verification: %s", ats_ip_nptop(&ip.sa, b, sizeof(b)),
+              X509_verify_cert_error_string(verify));
+    }
+    Debug("dns", "TLS error %d: %s", err, ERR_error_string(ERR_get_error(), buf));
+    return -EIO;
+  }
+  }
+}
+
+// Write the queued queries, which also drives the handshake. Having to wait for the socket is
+// not an error, the next read or write event of the connection comes back here.
+int
+DNSConnection::flush_tls()
+{
+  while (!tls_pending.empty()) {
+    ERR_clear_error();
+    int n = SSL_write(ssl, tls_pending.data(), tls_pending.size());
+    if (n <= 0) {
+      int res = tls_error(n);
+      return res == -EAGAIN ? 0 : (res ? res : -EPIPE);
+    }
+    tls_pending.erase(0, n);
+  }
+  return 0;
+}
+
+int
+DNSConnection::send(const void *buf, int len)
+{
+  if (ssl == nullptr) {
+    return socketManager.send(fd, const_cast<void *>(buf), len, 0);
+  }
+  tls_pending.append(static_cast<const char *>(buf), len);
+  int res = flush_tls();
+  return res < 0 ? res : len;
+}
+
+int
+DNSConnection::recv(void *buf, int len)
+{
+  if (ssl == nullptr) {
+    return socketManager.recv(fd, buf, len, 0);
+  }
+  int res = flush_tls();
+  if (res < 0) {
+    return res;
+  }
+  ERR_clear_error();
+  int n = SSL_read(ssl, buf, len);
+  return n > 0 ? n : tls_error(n);
+}
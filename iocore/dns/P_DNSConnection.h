@@ -33,11 +33,17 @@
 #include "I_EventSystem.h"
 #include "I_DNSProcessor.h"
 
+#include <openssl/ssl.h>
+#include <string>
+
 //
 // Connection
 //
 struct DNSHandler;
-enum class DNS_CONN_MODE { UDP_ONLY, TCP_RETRY, TCP_ONLY };
+enum class DNS_CONN_MODE { UDP_ONLY, TCP_RETRY, TCP_ONLY, TLS_ONLY };
+
+/// Port a TLS connection goes to when the nameserver is given with the plain DNS port.
+const int DNS_TLS_PORT = 853;
 
 struct DNSConnection {
   /// Options for connecting.
@@ -53,6 +59,9 @@ struct DNSConnection {
     /// Use TCP if @c true, use UDP if @c false.
     /// Default: @c false.
     bool _use_tcp = false;
+    /// Run TLS over the TCP connection.
+    /// Default: @c false.
+    bool _use_tls = false;
     /// Bind to a random port.
     /// Default: @c true.
     bool _bind_random_port = true;
@@ -66,6 +75,7 @@ struct DNSConnection {
     Options();
 
     self &setUseTcp(bool p);
+    self &setUseTls(bool p);
     self &setNonBlockingConnect(bool p);
     self &setNonBlockingIo(bool p);
     self &setBindRandomPort(bool p);
@@ -81,17 +91,24 @@ struct DNSConnection {
   EventIO eio;
   InkRand generator;
   DNSHandler *handler = nullptr;
+  SSL *ssl            = nullptr;
+  /// Session of the last TLS connection, resumed by the next one.
+  SSL_SESSION *tls_session = nullptr;
+  /// Queries not written to the TLS connection yet, while it handshakes or the socket is full.
+  std::string tls_pending;
 
   /// TCPData structure is to track the reading progress of a TCP connection
   struct TCPData {
     Ptr<HostEnt> buf_ptr;
     unsigned short total_length = 0;
+    unsigned short length_read  = 0;
     unsigned short done_reading = 0;
     void
     reset()
     {
       buf_ptr.clear();
       total_length = 0;
+      length_read  = 0;
       done_reading = 0;
     }
   } tcp_data;
@@ -104,10 +121,27 @@ struct DNSConnection {
   int close();
   void trigger();
 
+  /// Send a query, returns the number of bytes taken or -errno. A TLS connection queues what it
+  /// cannot write yet and writes it on the next send or read.
+  int send(const void *buf, int len);
+  /// Read a response, returns the number of bytes read, 0 if the server closed, or -errno.
+  int recv(void *buf, int len);
+
+  /// Set up the context of TLS connections, @a server_name is sent and verified if it is set.
+  static bool init_tls(const char *ca_file, const char *server_name, bool verify);
+
   virtual ~DNSConnection();
   DNSConnection();
 
   static Options const DEFAULT_OPTIONS;
+
+private:
+  int start_tls(sockaddr const *addr);
+  int flush_tls();
+  int tls_error(int ret);
+
+  static SSL_CTX *tls_ctx;
+  static std::string tls_server_name;
 };
 
 inline DNSConnection::Options::Options() {}
@@ -131,6 +165,12 @@ DNSConnection::Options::setUseTcp(bool p)
   return *this;
 }
 inline DNSConnection::Options &
+DNSConnection::Options::setUseTls(bool p)
+{
+  _use_tls = p;
+  return *this;
+}
+inline DNSConnection::Options &
 DNSConnection::Options::setBindRandomPort(bool p)
 {
   _bind_random_port = p;
@@ -25,6 +25,10 @@
 
 #include "I_EventSystem.h"
 
+#include <string>
+#include <unordered_map>
+#include <vector>
+
 #define MAX_NAMED 32
 #define DEFAULT_DNS_RETRIES 5
 #define MAX_DNS_RETRIES 9
@@ -38,6 +42,10 @@
 #define DEFAULT_DNS_SEARCH 1
 #define FAILOVER_SOON_RETRY 5
 #define NO_NAMESERVER_SELECTED -1
+// Most queries sent or responses read with one sendmmsg / recvmmsg call.
+#define DNS_MAX_BATCH_SIZE 64
+// Buckets of the per nameserver response time histogram.
+#define DNS_RESPONSE_TIME_BUCKETS 8
 
 //
 // Config
@@ -49,6 +57,7 @@ extern int dns_failover_number;
 extern int dns_failover_period;
 extern int dns_failover_try_period;
 extern int dns_max_dns_in_flight;
+extern int dns_batch_size;
 extern unsigned int dns_sequence_number;
 
 //
@@ -85,9 +94,16 @@ enum DNS_Stats {
   dns_retries_stat,
   dns_max_retries_exceeded_stat,
   dns_in_flight_stat,
+  dns_collapsed_lookups_stat,
+  dns_batch_sends_stat,
+  dns_batch_recvs_stat,
   DNS_Stat_Count
 };
 
+// The response time histograms of up to MAX_NAMED nameservers follow the stats above in dns_rsb.
+#define DNS_RESPONSE_TIME_STAT_BASE DNS_Stat_Count
+#define DNS_RSB_SIZE (DNS_Stat_Count + MAX_NAMED * DNS_RESPONSE_TIME_BUCKETS)
+
 struct HostEnt;
 struct DNSHandler;
 
@@ -168,7 +184,27 @@ struct DNSHandler : public Continuation {
   int in_flight          = 0;
   int name_server        = 0;
   int in_write_dns       = 0;
-  HostEnt *hostent_cache = nullptr;
+
+  // Receive buffers for recv_udp, kept until a response is read into them.
+  HostEnt *recv_bufs[DNS_MAX_BATCH_SIZE] = {nullptr};
+
+  /// UDP queries built by write_dns and sent together by flush_queries.
+  struct QueryBatch {
+    int n = 0;
+    DNSEntry *entry[DNS_MAX_BATCH_SIZE];
+    int ns[DNS_MAX_BATCH_SIZE];
+    int len[DNS_MAX_BATCH_SIZE];
+    unsigned char query[DNS_MAX_BATCH_SIZE][MAX_DNS_REQUEST_LEN];
+  } query_batch;
+  Event *flush_event = nullptr; ///< Pending event to flush query_batch.
+
+  /// The entry each query id in use was sent for.
+  std::vector<DNSEntry *> qid_entry = std::vector<DNSEntry *>(USHRT_MAX + 1, nullptr);
+  /// The head entry of every query name and type in entries, duplicates are collapsed into it.
+  std::unordered_map<std::string, DNSEntry *> entry_index;
+
+  /// First dns_rsb response time stat of each nameserver, or -1.
+  int ns_response_time_stat[MAX_NAMED];
 
   int ns_down[MAX_NAMED];
   int failover_number[MAX_NAMED];
@@ -220,6 +256,13 @@ struct DNSHandler : public Continuation {
   }
 
   void recv_dns(int event, Event *e);
+  bool recv_tcp(DNSConnection *dnsc);
+  bool recv_udp(DNSConnection *dnsc);
+  void received(DNSConnection *dnsc, Ptr<HostEnt> &buf, int len);
+  bool flush_queries();
+  void index_entry(DNSEntry *e);
+  void unindex_entry(DNSEntry *e);
+  DNSEntry *find_entry(const char *qname, int qname_len, int qtype);
   int startEvent(int event, Event *e);
   int startEvent_sdns(int event, Event *e);
   int mainEvent(int event, Event *e);
@@ -238,6 +281,7 @@ struct DNSHandler : public Continuation {
   release_query_id(uint16_t qid)
   {
     qid_in_flight[qid >> 6] &= (uint64_t) ~(0x1ULL << (qid & 0x3F));
+    qid_entry[qid] = nullptr;
   };
 
   void
@@ -298,6 +342,7 @@ DNSHandler::DNSHandler()
     ns_down[i]                 = 1;
     tcpcon[i].handler          = this;
     udpcon[i].handler          = this;
+    ns_response_time_stat[i]   = -1;
   }
   memset(&qid_in_flight, 0, sizeof(qid_in_flight));
   SET_HANDLER(&DNSHandler::startEvent);
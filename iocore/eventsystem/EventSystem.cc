@@ -29,6 +29,60 @@
 ****************************************************************************/
 
 #include "P_EventSystem.h"
+#include "tscore/hugepages.h"
+#include "tscore/memory_domain.h"
+
+#include <string>
+
+namespace
+{
+const char *const hugepage_arena_stat_names[HUGEPAGE_ARENA_KINDS] = {
+  "proxy.process.allocator.hugepage_arena.normal_bytes",
+  "proxy.process.allocator.hugepage_arena.transparent_bytes",
+  "proxy.process.allocator.hugepage_arena.2m_bytes",
+  "proxy.process.allocator.hugepage_arena.1g_bytes",
+};
+
+int
+hugepage_arena_stat_sync(const char *name, RecDataT data_type, RecData *data, RecRawStatBlock *rsb, int id)
+{
+  rsb->global[id]->sum   = ats_hugepage_arena_bytes(static_cast<HugePageArenaKind>(id));
+  rsb->global[id]->count = 1;
+  return RecRawStatSyncSum(name, data_type, data, rsb, id);
+}
+
+void
+register_hugepage_arena_stats()
+{
+  RecRawStatBlock *rsb = RecAllocateRawStatBlock(HUGEPAGE_ARENA_KINDS);
+
+  for (int kind = 0; kind < HUGEPAGE_ARENA_KINDS; ++kind) {
+    RecRegisterRawStat(rsb, RECT_PROCESS, hugepage_arena_stat_names[kind], RECD_INT, RECP_NON_PERSISTENT, kind, nullptr);
+    RecRegisterRawStatSyncCb(hugepage_arena_stat_names[kind], hugepage_arena_stat_sync, rsb, kind);
+  }
+}
+
+int
+memory_domain_stat_sync(const char *name, RecDataT data_type, RecData *data, RecRawStatBlock *rsb, int id)
+{
+  rsb->global[id]->sum   = ats_memory_domain_live_bytes(static_cast<MemoryDomain>(id));
+  rsb->global[id]->count = 1;
+  return RecRawStatSyncSum(name, data_type, data, rsb, id);
+}
+
+void
+register_memory_domain_stats()
+{
+  RecRawStatBlock *rsb = RecAllocateRawStatBlock(MEMORY_DOMAINS);
+
+  for (int domain = 0; domain < MEMORY_DOMAINS; ++domain) {
+    std::string name = std::string("proxy.process.allocator.domain.") + ats_memory_domain_name(static_cast<MemoryDomain>(domain)) +
+                       "_bytes";
+    RecRegisterRawStat(rsb, RECT_PROCESS, name.c_str(), RECD_INT, RECP_NON_PERSISTENT, domain, nullptr);
+    RecRegisterRawStatSyncCb(name.c_str(), memory_domain_stat_sync, rsb, domain);
+  }
+}
+} // namespace
 
 void
 ink_event_system_init(ts::ModuleVersion v)
@@ -42,6 +96,12 @@ ink_event_system_init(ts::ModuleVersion v)
 
   REC_EstablishStaticConfigInt32(thread_freelist_low_watermark, "proxy.config.allocator.thread_freelist_low_watermark");
 
+  REC_EstablishStaticConfigInt32(thread_timer_wheel, "proxy.config.exec_thread.timer_wheel");
+
+  REC_EstablishStaticConfigInt32(thread_profile_enabled, "proxy.config.exec_thread.profile.enabled");
+  REC_EstablishStaticConfigInt32(thread_profile_min_duration, "proxy.config.exec_thread.profile.min_duration");
+  REC_EstablishStaticConfigInt32(thread_profile_stall_threshold, "proxy.config.exec_thread.profile.stall_threshold");
+
 #ifdef MADV_DONTDUMP // This should only exist on Linux 3.4 and higher.
   RecBool dont_dump_enabled = true;
   RecGetRecordBool("proxy.config.allocator.dontdump_iobuffers", &dont_dump_enabled, false);
@@ -52,4 +112,6 @@ ink_event_system_init(ts::ModuleVersion v)
 #endif
 
   init_buffer_allocators(iobuffer_advice);
+  register_hugepage_arena_stats();
+  register_memory_domain_stats();
 }
@@ -0,0 +1,233 @@
+/** @file
+
+  Sampling of the slow continuation handlers of an event thread, see I_HandlerProfile.h
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "P_EventSystem.h"
+#include "tscore/ink_thread.h"
+
+#include <algorithm>
+#include <cstring>
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <map>
+#include <vector>
+
+int thread_profile_enabled         = 0;
+int thread_profile_min_duration    = 100; // usec
+int thread_profile_stall_threshold = 50;  // msec
+
+namespace
+{
+/// The most samples of a stalled loop that are logged.
+constexpr size_t STALL_LOG_SAMPLES = 8;
+
+std::string
+demangle(const char *name)
+{
+  int status = 0;
+  char *s    = abi::__cxa_demangle(name, nullptr, nullptr, &status);
+  std::string result{s && status == 0 ? s : name};
+  free(s);
+  return result;
+}
+
+// Name the handler of a sample the same way for all its samples, without the arguments.
+std::string
+handler_label(const HandlerProfile::Sample &s)
+{
+  std::string label;
+
+  if (s.event == HANDLER_PROFILE_TAIL_EVENT) {
+    label = "waitForActivity";
+  } else if (s.handler_name) {
+    label = s.handler_name;
+    if (label.front() == '&') {
+      label.erase(0, 1);
+    }
+  } else if (s.handler) {
+    Dl_info info;
+    if (dladdr(s.handler, &info) != 0 && info.dli_sname) {
+      label = demangle(info.dli_sname);
+      label = label.substr(0, label.find('('));
+    } else {
+      char buf[32];
+      snprintf(buf, sizeof(buf), "%p", s.handler);
+      label = buf;
+    }
+  } else {
+    label = "unknown";
+  }
+  return label;
+}
+
+std::string
+type_label(const HandlerProfile::Sample &s)
+{
+  return s.type ? demangle(s.type->name()) : std::string{"unknown"};
+}
+} // namespace
+
+HandlerProfile::HandlerProfile()
+{
+  ink_get_thread_name(_thread_name, sizeof(_thread_name));
+}
+
+const void *
+HandlerProfile::handler_address(Continuation *c)
+{
+#if defined(__GNUC__)
+  // A pointer to member function in the Itanium C++ ABI is the code address, or for a virtual
+  // function its offset in the vtable, and the adjustment to this. Where the two are told apart
+  // depends on the architecture.
+  struct {
+    uintptr_t ptr;
+    ptrdiff_t adj;
+  } pmf;
+  static_assert(sizeof(pmf) == sizeof(c->handler), "unexpected pointer to member function layout");
+  memcpy(&pmf, &c->handler, sizeof(pmf));
+#if defined(__arm__) || defined(__aarch64__)
+  bool is_virtual  = pmf.adj & 1;
+  uintptr_t offset = pmf.ptr;
+  ptrdiff_t adj    = pmf.adj >> 1;
+#else
+  bool is_virtual  = pmf.ptr & 1;
+  uintptr_t offset = pmf.ptr - 1;
+  ptrdiff_t adj    = pmf.adj;
+#endif
+  if (!is_virtual) {
+    return reinterpret_cast<const void *>(pmf.ptr);
+  }
+  const char *vtable = *reinterpret_cast<const char *const *>(reinterpret_cast<const char *>(c) + adj);
+  return *reinterpret_cast<const void *const *>(vtable + offset);
+#else
+  return nullptr;
+#endif
+}
+
+void
+HandlerProfile::add(const std::type_info *type, const void *handler, const char *handler_name, int event, ink_hrtime start,
+                    ink_hrtime duration)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  Sample &s      = _samples[_next++ % SAMPLES];
+  s.start        = start;
+  s.duration     = duration;
+  s.type         = type;
+  s.handler      = handler;
+  s.handler_name = handler_name;
+  s.event        = event;
+}
+
+void
+HandlerProfile::loop_done(ink_hrtime loop_start, ink_hrtime busy)
+{
+  if (thread_profile_stall_threshold <= 0 || busy <= HRTIME_MSECONDS(thread_profile_stall_threshold)) {
+    return;
+  }
+  ++_stalls;
+
+  // Log at most one stall a second for each thread.
+  ink_hrtime now = ink_get_hrtime_internal();
+  if (now - _logged_at < HRTIME_SECOND) {
+    return;
+  }
+  _logged_at = now;
+
+  // The samples of this loop are the latest, only this thread adds any.
+  std::vector<Sample> loop;
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (uint64_t i = _next; i > 0 && _next - i < SAMPLES; --i) {
+      const Sample &s = _samples[(i - 1) % SAMPLES];
+      if (s.start < loop_start) {
+        break;
+      }
+      loop.push_back(s);
+    }
+  }
+  std::sort(loop.begin(), loop.end(), [](const Sample &a, const Sample &b) { return a.duration > b.duration; });
+
+  Note("event loop stall on %s: busy for %" PRId64 " ms, %zu slow handlers", _thread_name, ink_hrtime_to_msec(busy), loop.size());
+  for (size_t i = 0; i < loop.size() && i < STALL_LOG_SAMPLES; ++i) {
+    Note("  %s::%s event %d took %" PRId64 " us", type_label(loop[i]).c_str(), handler_label(loop[i]).c_str(), loop[i].event,
+         ink_hrtime_to_usec(loop[i].duration));
+  }
+}
+
+void
+HandlerProfile::dump(std::string &out)
+{
+  std::map<std::string, ink_hrtime> folded;
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    uint64_t n = std::min<uint64_t>(_next, SAMPLES);
+    for (uint64_t i = 0; i < n; ++i) {
+      const Sample &s = _samples[i];
+      std::string stack{_thread_name};
+      stack += ';';
+      stack += type_label(s);
+      stack += ';';
+      stack += handler_label(s);
+      folded[stack] += s.duration;
+    }
+    out += "# ";
+    out += _thread_name;
+    out += ": " + std::to_string(n) + " samples, " + std::to_string(_stalls.load()) + " stalls\n";
+  }
+  for (auto const &[stack, duration] : folded) {
+    out += stack;
+    out += ' ';
+    out += std::to_string(ink_hrtime_to_usec(duration));
+    out += '\n';
+  }
+}
+
+void
+HandlerProfile::dump_all(std::string &out)
+{
+  for (int i = 0; i < eventProcessor.n_thread_groups; ++i) {
+    for (EThread *t : eventProcessor.active_group_threads(i)) {
+      if (HandlerProfile *p = t->profile.load(std::memory_order_acquire)) {
+        p->dump(out);
+      }
+    }
+  }
+}
+
+bool
+HandlerProfile::dump_to_file(const char *path)
+{
+  std::string out;
+  dump_all(out);
+
+  FILE *fp = fopen(path, "w");
+  if (fp == nullptr) {
+    Warning("unable to write the event loop profile to %s: %s", path, strerror(errno));
+    return false;
+  }
+  bool ok = fwrite(out.data(), 1, out.size(), fp) == out.size();
+  ok      = fclose(fp) == 0 && ok;
+  if (!ok) {
+    Warning("unable to write the event loop profile to %s: %s", path, strerror(errno));
+  }
+  return ok;
+}
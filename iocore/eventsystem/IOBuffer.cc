@@ -28,10 +28,13 @@
 #include "tscore/ink_defs.h"
 #include "P_EventSystem.h"
 
+#include <algorithm>
+
 //
 // General Buffer Allocator
 //
 inkcoreapi Allocator ioBufAllocator[DEFAULT_BUFFER_SIZES];
+inkcoreapi Allocator ioBufNumaAllocator[TS_MAX_NUMA_NODES][DEFAULT_BUFFER_SIZES];
 inkcoreapi ClassAllocator<MIOBuffer> ioAllocator("ioAllocator", DEFAULT_BUFFER_NUMBER);
 inkcoreapi ClassAllocator<IOBufferData> ioDataAllocator("ioDataAllocator", DEFAULT_BUFFER_NUMBER);
 inkcoreapi ClassAllocator<IOBufferBlock> ioBlockAllocator("ioBlockAllocator", DEFAULT_BUFFER_NUMBER);
@@ -56,6 +59,24 @@ init_buffer_allocators(int iobuffer_advice)
     auto name = new char[64];
     snprintf(name, 64, "ioBufAllocator[%d]", i);
     ioBufAllocator[i].re_init(name, s, n, a, iobuffer_advice);
+    // The big buffers are the ones that take the TLB misses.
+    bool hugepage_arena = i >= BUFFER_SIZE_INDEX_32K;
+    if (hugepage_arena) {
+      ioBufAllocator[i].use_hugepage_arena();
+    }
+    if (!ats_numa_enabled()) {
+      continue;
+    }
+    ioBufAllocator[i].set_numa_node(0);
+    for (int node = 1; node < ats_numa_node_count(); ++node) {
+      name = new char[64];
+      snprintf(name, 64, "ioBufAllocator[%d][%d]", node, i);
+      ioBufNumaAllocator[node][i].re_init(name, s, n, a, iobuffer_advice);
+      ioBufNumaAllocator[node][i].set_numa_node(node);
+      if (hugepage_arena) {
+        ioBufNumaAllocator[node][i].use_hugepage_arena();
+      }
+    }
   }
 }
 
@@ -133,6 +154,44 @@ MIOBuffer::write(IOBufferBlock const *b, int64_t alen, int64_t offset)
   return alen - len;
 }
 
+int64_t
+MIOBuffer::held_bytes()
+{
+  auto chain_bytes = [](IOBufferBlock *b) {
+    int64_t bytes = 0;
+    for (; b; b = b->next.get()) {
+      bytes += b->block_size();
+    }
+    return bytes;
+  };
+
+  // The readers may still be on blocks before the writer, all the chains end the same way.
+  int64_t bytes = chain_bytes(_writer.get());
+  for (auto &reader : readers) {
+    if (reader.allocated()) {
+      bytes = std::max(bytes, chain_bytes(reader.block.get()));
+    }
+  }
+  return bytes;
+}
+
+int64_t
+MIOBuffer::release_blocks()
+{
+  if (!_writer || is_max_read_avail_more_than(0)) {
+    return 0;
+  }
+  int64_t bytes = held_bytes();
+  _writer       = nullptr;
+  for (auto &reader : readers) {
+    if (reader.allocated()) {
+      reader.block        = nullptr;
+      reader.start_offset = 0;
+    }
+  }
+  return bytes;
+}
+
 bool
 MIOBuffer::is_max_read_avail_more_than(int64_t size)
 {
@@ -153,6 +212,51 @@ MIOBuffer::is_max_read_avail_more_than(int64_t size)
   return false;
 }
 
+//
+// IOBufferSizer
+//
+int
+IOBufferSizer::update(MIOBuffer *buf, int64_t offered, int64_t filled, int64_t min_index, int64_t max_index)
+{
+  // Leave alone the buffers of fixed or xmalloc'ed blocks.
+  if (!BUFFER_SIZE_INDEX_IS_FAST_ALLOCATED(buf->size_index)) {
+    return 0;
+  }
+
+  if (buf != buffer) {
+    buffer      = buf;
+    full_reads  = 0;
+    short_reads = 0;
+    if (BUFFER_SIZE_INDEX_IS_FAST_ALLOCATED(size_index)) {
+      buf->size_index = std::clamp(size_index, min_index, max_index);
+    }
+  }
+
+  int change = 0;
+
+  if (filled >= offered) {
+    short_reads = 0;
+    if (++full_reads >= GROW_AFTER && buf->size_index < max_index) {
+      ++buf->size_index;
+      full_reads = 0;
+      change     = 1;
+    }
+  } else if (filled < buf->block_size() / 4) {
+    full_reads = 0;
+    if (++short_reads >= SHRINK_AFTER && buf->size_index > min_index) {
+      --buf->size_index;
+      short_reads = 0;
+      change      = -1;
+    }
+  } else {
+    full_reads  = 0;
+    short_reads = 0;
+  }
+  size_index = buf->size_index;
+
+  return change;
+}
+
 //
 // IOBufferReader
 //
@@ -214,6 +318,50 @@ IOBufferReader::memchr(char c, int64_t len, int64_t offset)
   return -1;
 }
 
+// Whether @a pattern is at @a offset of the span @a it points to, running over into the next spans.
+static bool
+span_match(IOBufferReader::SpanIterator it, int64_t offset, std::string_view pattern)
+{
+  for (; !pattern.empty() && it != IOBufferReader::SpanIterator(); ++it) {
+    std::string_view span = (*it).substr(offset);
+    size_t n              = std::min(span.size(), pattern.size());
+
+    if (::memcmp(span.data(), pattern.data(), n) != 0) {
+      return false;
+    }
+    pattern.remove_prefix(n);
+    offset = 0;
+  }
+  return pattern.empty();
+}
+
+int64_t
+IOBufferReader::find(std::string_view pattern, int64_t offset)
+{
+  ink_assert(!pattern.empty());
+  int64_t pos = offset; // Position of the current span
+
+  for (auto it = spans(offset).begin(); it != SpanIterator(); ++it) {
+    std::string_view span = *it;
+    const char *s         = span.data();
+    const char *end       = s + span.size();
+
+    while (s < end) {
+      const char *p = static_cast<const char *>(::memchr(s, pattern[0], end - s));
+      if (!p) {
+        break;
+      }
+      if (span_match(it, p - span.data(), pattern)) {
+        return pos + (p - span.data());
+      }
+      s = p + 1;
+    }
+    pos += span.size();
+  }
+
+  return -1;
+}
+
 char *
 IOBufferReader::memcpy(void *ap, int64_t len, int64_t offset)
 {
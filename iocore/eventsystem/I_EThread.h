@@ -27,9 +27,13 @@
 #include "tscore/ink_platform.h"
 #include "tscore/ink_rand.h"
 #include "tscore/I_Version.h"
+#include "tscore/ChaseLevDeque.h"
 #include "I_Thread.h"
 #include "I_PriorityEventQueue.h"
 #include "I_ProtectedQueue.h"
+#include "I_HandlerProfile.h"
+
+#include <atomic>
 
 // TODO: This would be much nicer to have "run-time" configurable (or something),
 // perhaps based on proxy.config.stat_api.max_stats_allowed or other configs. XXX
@@ -313,6 +317,15 @@ public:
   ProtectedQueue EventQueueExternal;
   PriorityEventQueue EventQueue;
 
+  /** Immediate events waiting to run, which idle threads of the same group may steal.
+
+      This is only set for threads in a group with @c ThreadGroupDescriptor::_work_stealing, @c nullptr otherwise.
+  */
+  ts::ChaseLevDeque<Event *> *WorkQueue = nullptr;
+  static constexpr size_t WORK_QUEUE_SIZE = 4096;
+  /// Thread group to steal from, valid only if @a WorkQueue is set.
+  EventType work_group = 0;
+
   static constexpr int NO_ETHREAD_ID = -1;
   int id                             = NO_ETHREAD_ID;
   unsigned int event_types           = 0;
@@ -325,6 +338,8 @@ public:
   void execute_regular();
   void process_queue(Que(Event, link) * NegativeQueue, int *ev_count, int *nq_count);
   void process_event(Event *e, int calling_code);
+  void run_work_queue();
+  bool steal_work();
   void free_event(Event *e);
   LoopTailHandler *tail_cb = &DEFAULT_TAIL_HANDLER;
 
@@ -396,8 +411,10 @@ public:
       Events() {}
     } _events;
 
-    int _count = 0; ///< # of times the loop executed.
-    int _wait  = 0; ///< # of timed wait for events
+    int _count       = 0; ///< # of times the loop executed.
+    int _wait        = 0; ///< # of timed wait for events
+    int _stalls      = 0; ///< # of loops busy longer than proxy.config.exec_thread.profile.stall_threshold
+    ink_hrtime _busy = 0; ///< CPU time the thread used, set when the sample is done.
 
     /// Add @a that to @a this data.
     /// This embodies the custom logic per member concerning whether each is a sum, min, or max.
@@ -428,6 +445,8 @@ public:
     STAT_LOOP_WAIT,       ///< # of loops that did a conditional wait.
     STAT_LOOP_TIME_MIN,   ///< Shortest time spent in loop.
     STAT_LOOP_TIME_MAX,   ///< Longest time spent in loop.
+    STAT_LOOP_BUSY,       ///< CPU time used by the threads.
+    STAT_LOOP_STALLS,     ///< # of loops that stalled.
     N_EVENT_STATS         ///< NOT A VALID STAT INDEX - # of different stat types.
   };
 
@@ -442,6 +461,30 @@ public:
 
   /// Process the last 1000s of data and write out the summaries to @a summary.
   void summarize_stats(EventMetrics summary[N_EVENT_TIMESCALES]);
+
+  /** The percent of a CPU the thread used, smoothed over the last few seconds.
+      The thread updates it from the busy time of each metric block as the block is done, other
+      threads read it to balance the work, see @c EventProcessor::assign_thread_by_load.
+  */
+  std::atomic<int> load{0};
+  ink_hrtime load_cpu_time = 0; ///< CPU time of the thread when @a load was last updated.
+  ink_hrtime load_time     = 0; ///< When @a load was last updated.
+
+  /// The samples of slow handlers, created by the thread the first time it runs with
+  /// proxy.config.exec_thread.profile.enabled.
+  std::atomic<HandlerProfile *> profile{nullptr};
+
+  /// The profile of this thread, call from the thread itself.
+  HandlerProfile *
+  handler_profile()
+  {
+    HandlerProfile *p = profile.load(std::memory_order_relaxed);
+    if (p == nullptr) {
+      p = new HandlerProfile;
+      profile.store(p, std::memory_order_release);
+    }
+    return p;
+  }
   /// Back up the metric pointer, wrapping as needed.
   EventMetrics *
   prev(EventMetrics volatile *current)
@@ -213,6 +213,7 @@ public:
 
   ink_hrtime timeout_at = 0;
   ink_hrtime period     = 0;
+  uint16_t wheel_slot   = 0; ///< Position in the timing wheel of the owning thread, if it has one.
 
   /**
     This field can be set when an event is created. It is returned
@@ -305,6 +305,8 @@ public:
     Que(Event, link) _spawnQueue;                    ///< Events to dispatch when thread is spawned.
     EThread *_thread[MAX_THREADS_IN_EACH_TYPE] = {}; ///< The actual threads in this group.
     std::function<void()> _afterStartCallback  = nullptr;
+    /// Let idle threads steal immediate events from busy ones. Must be set before the group is spawned.
+    bool _work_stealing = false;
   };
 
   /// Storage for per group data.
@@ -329,6 +331,10 @@ public:
 
   Event *schedule(Event *e, EventType etype);
   EThread *assign_thread(EventType etype);
+  /// The less loaded of the next thread in turn and another one of @a etype, see @c EThread::load.
+  EThread *assign_thread_by_load(EventType etype);
+  /// The thread of @a etype with the lowest @c EThread::load.
+  EThread *least_loaded_thread(EventType etype);
   EThread *assign_affinity_by_type(Continuation *cont, EventType etype);
 
   EThread *all_dthreads[MAX_EVENT_THREADS];
@@ -0,0 +1,101 @@
+/** @file
+
+  Sampling of the slow continuation handlers of an event thread
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  @section details Details
+
+  With proxy.config.exec_thread.profile.enabled each event thread times the handlers it calls
+  and keeps those that took at least proxy.config.exec_thread.profile.min_duration in a ring.
+  When a loop of the thread runs for longer than proxy.config.exec_thread.profile.stall_threshold
+  the slowest handlers of that loop are logged. The rings of all the threads can be written out
+  in the folded format of flame graphs, see @c HandlerProfile::dump_all.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <typeinfo>
+
+#include "tscore/ink_hrtime.h"
+
+class Continuation;
+
+extern int thread_profile_enabled;
+extern int thread_profile_min_duration;    // usec
+extern int thread_profile_stall_threshold; // msec
+
+/// Pseudo event of the samples of the time a loop tail handler took beyond its wait.
+#define HANDLER_PROFILE_TAIL_EVENT (-1)
+
+class HandlerProfile
+{
+public:
+  /// Samples kept by each thread, the oldest are overwritten.
+  static constexpr int SAMPLES = 1024;
+
+  struct Sample {
+    ink_hrtime start           = 0;
+    ink_hrtime duration        = 0;
+    const std::type_info *type = nullptr; ///< Of the continuation.
+    const void *handler        = nullptr; ///< Code address of its handler, nullptr if unknown.
+    const char *handler_name   = nullptr; ///< From SET_HANDLER, DEBUG builds only.
+    int event                  = 0;
+  };
+
+  HandlerProfile();
+
+  /// The handler of @a c, as its code address. Call before the handler runs, it may free @a c.
+  static const void *handler_address(Continuation *c);
+
+  /// Keep the call of a handler of @a type if it took long enough.
+  void
+  record(const std::type_info *type, const void *handler, const char *handler_name, int event, ink_hrtime start, ink_hrtime end)
+  {
+    if (end - start >= HRTIME_USECONDS(thread_profile_min_duration)) {
+      add(type, handler, handler_name, event, start, end - start);
+    }
+  }
+
+  /// The loop that started at @a loop_start was busy for @a busy, log it if that is a stall.
+  void loop_done(ink_hrtime loop_start, ink_hrtime busy);
+
+  /// Append the samples of all the event threads to @a out, one "thread;class;handler usec" line
+  /// per handler, which flamegraph.pl takes as is.
+  static void dump_all(std::string &out);
+
+  /// Write the output of @c dump_all to @a path.
+  static bool dump_to_file(const char *path);
+
+private:
+  void add(const std::type_info *type, const void *handler, const char *handler_name, int event, ink_hrtime start,
+           ink_hrtime duration);
+  void dump(std::string &out);
+
+  std::mutex _mutex; ///< The owning thread only takes it to add a sample, others to read them.
+  Sample _samples[SAMPLES];
+  uint64_t _next        = 0; ///< Total samples taken, the next goes at this modulo @c SAMPLES.
+  ink_hrtime _logged_at = 0; ///< The last stall logged.
+  std::atomic<uint64_t> _stalls{0};
+  char _thread_name[32];
+};
@@ -45,6 +45,10 @@
 #include "tscore/Ptr.h"
 #include "tscore/ink_assert.h"
 #include "tscore/ink_resource.h"
+#include "tscore/numa.h"
+
+#include <iterator>
+#include <string_view>
 
 struct MIOBufferAccessor;
 
@@ -110,6 +114,14 @@ enum AllocType {
 #define BUFFER_SIZE_INDEX_FOR_CONSTANT_SIZE(_size) (_size + DEFAULT_BUFFER_SIZES)
 
 inkcoreapi extern Allocator ioBufAllocator[DEFAULT_BUFFER_SIZES];
+// Buffers local to NUMA nodes other than the first, which uses ioBufAllocator.
+inkcoreapi extern Allocator ioBufNumaAllocator[TS_MAX_NUMA_NODES][DEFAULT_BUFFER_SIZES];
+
+inline Allocator &
+ioBufAllocatorForNode(int node, int64_t size_index)
+{
+  return node > 0 ? ioBufNumaAllocator[node][size_index] : ioBufAllocator[size_index];
+}
 
 void init_buffer_allocators(int iobuffer_advice);
 
@@ -215,6 +227,9 @@ public:
   */
   AllocType _mem_type = NO_ALLOC;
 
+  /// NUMA node of the fast allocator the memory came from, -1 for the default one.
+  int8_t _numa_node = -1;
+
   /**
     Points to the allocated memory. This member stores the address of
     the allocated memory. You should not modify its value directly,
@@ -791,6 +806,97 @@ public:
   */
   inkcoreapi int64_t memchr(char c, int64_t len = INT64_MAX, int64_t offset = 0);
 
+  /**
+    Look for @a pattern across the list of IOBufferBlocks, including
+    occurrences split between blocks. The search skips from one
+    occurrence of the first character of the pattern to the next with
+    memchr().
+
+    @param pattern bytes to look for, must not be empty.
+    @param offset number of the bytes to skip over before beginning
+      the search.
+    @return -1 if the pattern is not found, otherwise its position
+      from the current start point of the reader.
+
+  */
+  inkcoreapi int64_t find(std::string_view pattern, int64_t offset = 0);
+
+  /**
+    Iterates over the data available to a reader as contiguous spans,
+    one per IOBufferBlock, without copying it. See spans().
+
+  */
+  class SpanIterator
+  {
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type        = std::string_view;
+    using difference_type   = ptrdiff_t;
+    using pointer           = const std::string_view *;
+    using reference         = std::string_view;
+
+    SpanIterator() = default;
+    SpanIterator(IOBufferBlock *b, int64_t offset, int64_t limit);
+
+    std::string_view operator*() const;
+    SpanIterator &operator++();
+
+    bool
+    operator==(SpanIterator const &that) const
+    {
+      return block == that.block && offset == that.offset;
+    }
+
+    bool
+    operator!=(SpanIterator const &that) const
+    {
+      return !(*this == that);
+    }
+
+  private:
+    void settle();
+
+    IOBufferBlock *block = nullptr; ///< Current block, null at the end
+    int64_t offset       = 0;       ///< Start of the span in the block
+    int64_t limit        = 0;       ///< Bytes left to iterate over
+  };
+
+  struct SpanRange {
+    SpanIterator first;
+
+    SpanIterator
+    begin() const
+    {
+      return first;
+    }
+
+    SpanIterator
+    end() const
+    {
+      return SpanIterator();
+    }
+  };
+
+  /**
+    The data available to the reader as contiguous spans, for scanners
+    that work on runs of bytes rather than byte by byte:
+
+    @code
+      for (std::string_view span : reader->spans()) {
+        ...
+      }
+    @endcode
+
+    The spans stay valid until the reader consumes the data. Consuming
+    while iterating is not supported, add up the bytes used and consume
+    them after the loop.
+
+    @param offset number of the bytes to skip over.
+    @return range of the spans, which honors the size limit of the reader.
+
+  */
+  SpanRange spans(int64_t offset = 0);
+
   /**
     Copies and consumes data. Copies len bytes of data from the buffer
     into the supplied buffer, which must be allocated prior to the call
@@ -1211,6 +1317,16 @@ public:
     water_mark = 0;
   }
 
+  /// The size of the blocks the buffer and its readers hold on to.
+  int64_t held_bytes();
+
+  /** Give up the blocks if there is nothing left to read, keeping the readers and the block size as
+      they are. The next write allocates a block again, as with an empty buffer.
+
+      @return The size of the blocks given up, 0 if there was data to read.
+  */
+  int64_t release_blocks();
+
   int64_t size_index;
 
   /**
@@ -1235,6 +1351,48 @@ public:
   ~MIOBuffer();
 };
 
+/**
+  Adapts the size of the blocks a producer adds to an MIOBuffer to the sizes of the reads that
+  fill it. Reads that take all the space offered mean more data is waiting, after a few of those
+  in a row the buffer adds blocks twice as large. After a few reads in a row that take less than a
+  quarter of a block it adds blocks half as large. The blocks already in the buffer stay as they
+  are.
+
+  The sizer remembers the block size it settled on, and starts the next buffer it sees (the one of
+  the next transaction on a connection, say) with it.
+
+*/
+class IOBufferSizer
+{
+public:
+  /**
+    Account for a read of @a filled bytes into @a buf, which had @a offered bytes of space.
+
+    @param min_index the smallest block size index to shrink to.
+    @param max_index the largest block size index to grow to.
+    @return 1 if the block size grew, -1 if it shrank, 0 otherwise.
+  */
+  int update(MIOBuffer *buf, int64_t offered, int64_t filled, int64_t min_index, int64_t max_index);
+
+  void
+  clear()
+  {
+    buffer      = nullptr;
+    size_index  = BUFFER_SIZE_NOT_ALLOCATED;
+    full_reads  = 0;
+    short_reads = 0;
+  }
+
+  static const int GROW_AFTER   = 2; ///< Full reads in a row before the blocks grow
+  static const int SHRINK_AFTER = 4; ///< Short reads in a row before the blocks shrink
+
+private:
+  MIOBuffer *buffer  = nullptr;                   ///< The buffer of the last read
+  int64_t size_index = BUFFER_SIZE_NOT_ALLOCATED; ///< The block size index settled on
+  int full_reads     = 0;
+  int short_reads    = 0;
+};
+
 /**
   A wrapper for either a reader or a writer of an MIOBuffer.
 
@@ -25,21 +25,35 @@
 
 #include "tscore/ink_platform.h"
 #include "I_Event.h"
+#include "I_TimingWheel.h"
 
 // <5ms, 10, 20, 40, 80, 160, 320, 640, 1280, 2560, 5120
 #define N_PQ_LIST 10
 #define PQ_BUCKET_TIME(_i) (HRTIME_MSECONDS(5) << (_i))
+#define PQ_WHEEL_TICK HRTIME_MSECONDS(1)
 
 class EThread;
 
+/// Use a timing wheel instead of the buckets for threads created from now on.
+extern int thread_timer_wheel;
+
+using EventTimingWheel = TimingWheel<Event, Event::Link_link, &Event::timeout_at, &Event::wheel_slot>;
+
 struct PriorityEventQueue {
   Que(Event, link) after[N_PQ_LIST];
   ink_hrtime last_check_time;
   uint32_t last_check_buckets;
+  /// If set, events are kept here instead of in @a after.
+  EventTimingWheel *wheel = nullptr;
 
   void
   enqueue(Event *e, ink_hrtime now)
   {
+    if (wheel) {
+      e->in_the_priority_queue = 1;
+      wheel->insert(e);
+      return;
+    }
     ink_hrtime t = e->timeout_at - now;
     int i        = 0;
     // equivalent but faster
@@ -90,6 +104,10 @@ struct PriorityEventQueue {
   {
     ink_assert(e->in_the_priority_queue);
     e->in_the_priority_queue = 0;
+    if (wheel) {
+      wheel->remove(e);
+      return;
+    }
     after[e->in_heap].remove(e);
   }
 
@@ -97,7 +115,7 @@ struct PriorityEventQueue {
   dequeue_ready(ink_hrtime t)
   {
     (void)t;
-    Event *e = after[0].dequeue();
+    Event *e = wheel ? wheel->pop_ready() : after[0].dequeue();
     if (e) {
       ink_assert(e->in_the_priority_queue);
       e->in_the_priority_queue = 0;
@@ -110,6 +128,9 @@ struct PriorityEventQueue {
   ink_hrtime
   earliest_timeout()
   {
+    if (wheel) {
+      return wheel->next_expiry();
+    }
     for (int i = 0; i < N_PQ_LIST; i++) {
       if (after[i].head) {
         return last_check_time + (PQ_BUCKET_TIME(i) / 2);
@@ -119,4 +140,5 @@ struct PriorityEventQueue {
   }
 
   PriorityEventQueue();
+  ~PriorityEventQueue();
 };
@@ -25,31 +25,53 @@
 
   Protected Queue, a FIFO queue with the following functionality:
   (1). Multiple threads could be simultaneously trying to enqueue
-       and dequeue. Hence the queue needs to be protected with mutex.
+       and dequeue. Enqueue is a lock free push onto @a al, only the
+       owning thread dequeues.
   (2). In case the queue is empty, dequeue() sleeps for a specified
        amount of time, or until a new element is inserted, whichever
-       is earlier
+       is earlier. With eventfd the owning thread sleeps in poll on
+       @a evfd, the same descriptor the network threads add to their
+       epoll set, otherwise on a condition variable.
+  (3). Producers only wake the owning thread when it is not @a awake,
+       so a busy thread costs them no system call.
 
 
  ****************************************************************************/
 #pragma once
 
+#include <atomic>
+
 #include "tscore/ink_platform.h"
 #include "I_Event.h"
 struct ProtectedQueue {
   void enqueue(Event *e);
   void signal();
-  int try_signal();             // Use non blocking lock and if acquired, signal
+  int try_signal();             // Signal if the owning thread may be sleeping
   void enqueue_local(Event *e); // Safe when called from the same thread
   void remove(Event *e);
   Event *dequeue_local();
   void dequeue_external();       // Dequeue any external events.
-  void wait(ink_hrtime timeout); // Wait for @a timeout nanoseconds on a condition variable if there are no events.
+  void wait(ink_hrtime timeout); // Wait until @a timeout (absolute) if there are no events.
+
+  /** Announce that the owning thread is about to block.
+
+      After this producers wake the thread. @return @c true if there is nothing queued, in which
+      case it is safe to block, @c false if the thread should poll without blocking.
+   */
+  bool prepare_to_sleep();
+  /// The owning thread is running again, producers need not wake it.
+  void wake_up();
 
   InkAtomicList al;
   ink_mutex lock;
   ink_cond might_have_data;
   Que(Event, link) localQueue;
+  /// Whether the owning thread is running and will look at @a al before it blocks.
+  std::atomic<bool> awake{false};
+#if HAVE_EVENTFD
+  /// Wake up descriptor of the owning thread, @c EThread::evfd.
+  int evfd = -1;
+#endif
 
   ProtectedQueue();
 };
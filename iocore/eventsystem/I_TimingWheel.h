@@ -0,0 +1,238 @@
+/** @file
+
+  Hierarchical timing wheel
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  @section details Details
+
+  The wheel has @c LEVELS levels of @c SIZE slots. A slot on level @c L covers @c SIZE^L ticks, so
+  with the default geometry and a 1ms tick the wheel spans a little over 12 days and anything
+  further out is parked in the top level and re-placed when its slot comes around. Insert and
+  remove are O(1), advancing costs one step per tick that has level 0 items plus one cascade per
+  occupied higher level slot that is passed. Occupancy bitmaps let idle stretches be skipped.
+
+  Items are intrusively linked through @a L, the expiry time is read from @a AT and the wheel
+  keeps the slot number in @a SLOT so the item can be found again. An item is never handed out
+  before its expiry time, it may be up to one tick late.
+ */
+
+#pragma once
+
+#include "tscore/ink_hrtime.h"
+#include "tscore/List.h"
+
+template <class T, class L, ink_hrtime T::*AT, uint16_t T::*SLOT> class TimingWheel
+{
+public:
+  static constexpr int BITS   = 6;
+  static constexpr int SIZE   = 1 << BITS;
+  static constexpr int LEVELS = 5;
+
+  /// Values of the @a SLOT member that are not a slot.
+  static constexpr uint16_t NOT_QUEUED = 0;
+  static constexpr uint16_t READY      = 1;
+
+  /// @a tick is the wheel resolution, @a now the current time.
+  TimingWheel(ink_hrtime tick, ink_hrtime now) : _tick(tick), _current(now / tick) {}
+
+  /// Add @a e which must not be queued. If it is already due it goes straight on the ready list.
+  void
+  insert(T *e)
+  {
+    ink_assert(e->*SLOT == NOT_QUEUED);
+    ++_count;
+    place(e);
+  }
+
+  /// Take @a e out of the wheel, it is fine if it is not queued.
+  void
+  remove(T *e)
+  {
+    uint16_t s = e->*SLOT;
+    if (s == NOT_QUEUED) {
+      return;
+    }
+    if (s == READY) {
+      _ready.remove(e);
+      --_ready_count;
+    } else {
+      int level = (s - 2) >> BITS;
+      int idx   = (s - 2) & (SIZE - 1);
+      _slot[level][idx].remove(e);
+      if (_slot[level][idx].empty()) {
+        _used[level] &= ~(uint64_t(1) << idx);
+      }
+    }
+    e->*SLOT = NOT_QUEUED;
+    --_count;
+  }
+
+  /** Move everything that expires by @a now to the ready list.
+
+      Every item taken out of a slot on the way is first offered to @a discard, which returns
+      @c true if it took the item (it is then out of the wheel) so that cancelled items can be
+      dropped without being handed out.
+   */
+  template <typename F>
+  void
+  advance(ink_hrtime now, F &&discard)
+  {
+    uint64_t target = now / _tick;
+
+    while (_current < target) {
+      if (_count == _ready_count) {
+        _current = target;
+        break;
+      }
+      // Step to the next boundary of the lowest occupied level, nothing below it needs a visit.
+      int low = 0;
+      while (low < LEVELS && _used[low] == 0) {
+        ++low;
+      }
+      uint64_t next = low == 0 ? _current + 1 : ((_current >> (BITS * low)) + 1) << (BITS * low);
+      if (next > target) {
+        _current = target;
+        break;
+      }
+      _current = next;
+
+      for (int level = LEVELS - 1; level > 0; --level) {
+        if ((_current & ((uint64_t(1) << (BITS * level)) - 1)) == 0) {
+          cascade(level, (_current >> (BITS * level)) & (SIZE - 1), discard);
+        }
+      }
+      cascade(0, _current & (SIZE - 1), discard);
+    }
+  }
+
+  void
+  advance(ink_hrtime now)
+  {
+    advance(now, [](T *) { return false; });
+  }
+
+  /// Next item that is due, or @c nullptr.
+  T *
+  pop_ready()
+  {
+    T *e = _ready.dequeue();
+    if (e) {
+      e->*SLOT = NOT_QUEUED;
+      --_ready_count;
+      --_count;
+    }
+    return e;
+  }
+
+  /** Earliest time at which @c advance may have something to do.
+
+      This is exact if the next item is on level 0, otherwise it is the time of the next cascade
+      which is never later than the expiry of the items moved by it.
+   */
+  ink_hrtime
+  next_expiry() const
+  {
+    if (_ready_count) {
+      return _current * _tick;
+    }
+    uint64_t best = UINT64_MAX;
+    for (int level = 0; level < LEVELS; ++level) {
+      if (_used[level] == 0) {
+        continue;
+      }
+      uint64_t base = _current >> (BITS * level);
+      int shift     = (base + 1) & (SIZE - 1);
+      uint64_t rot  = (_used[level] >> shift) | (_used[level] << ((SIZE - shift) & (SIZE - 1)));
+      uint64_t t    = (base + __builtin_ctzll(rot) + 1) << (BITS * level);
+      if (t < best) {
+        best = t;
+      }
+    }
+    return best == UINT64_MAX ? HRTIME_FOREVER : static_cast<ink_hrtime>(best * _tick);
+  }
+
+  size_t
+  size() const
+  {
+    return _count;
+  }
+
+  bool
+  empty() const
+  {
+    return _count == 0;
+  }
+
+private:
+  void
+  place(T *e)
+  {
+    // Round up so an item is never early.
+    uint64_t expires = e->*AT > 0 ? (e->*AT + _tick - 1) / _tick : 0;
+    if (expires <= _current) {
+      e->*SLOT = READY;
+      _ready.enqueue(e);
+      ++_ready_count;
+      return;
+    }
+    uint64_t delta = expires - _current;
+    int level      = 0;
+    while (level < LEVELS - 1 && delta >= (uint64_t(1) << (BITS * (level + 1)))) {
+      ++level;
+    }
+    if (level == LEVELS - 1 && delta >= (uint64_t(1) << (BITS * LEVELS))) {
+      expires = _current + (uint64_t(1) << (BITS * LEVELS)) - 1;
+    }
+    int idx  = (expires >> (BITS * level)) & (SIZE - 1);
+    e->*SLOT = static_cast<uint16_t>(2 + (level << BITS) + idx);
+    _slot[level][idx].enqueue(e);
+    _used[level] |= uint64_t(1) << idx;
+  }
+
+  template <typename F>
+  void
+  cascade(int level, int idx, F &discard)
+  {
+    if (!(_used[level] & (uint64_t(1) << idx))) {
+      return;
+    }
+    Queue<T, L> q = _slot[level][idx];
+    _slot[level][idx].clear();
+    _used[level] &= ~(uint64_t(1) << idx);
+
+    T *e;
+    while ((e = q.dequeue()) != nullptr) {
+      e->*SLOT = NOT_QUEUED;
+      if (discard(e)) {
+        --_count;
+      } else {
+        place(e);
+      }
+    }
+  }
+
+  ink_hrtime _tick;
+  uint64_t _current;
+  size_t _count          = 0;
+  size_t _ready_count    = 0;
+  uint64_t _used[LEVELS] = {0};
+  Queue<T, L> _slot[LEVELS][SIZE];
+  Queue<T, L> _ready;
+};
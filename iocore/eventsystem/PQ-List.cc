@@ -23,15 +23,39 @@
 
 #include "P_EventSystem.h"
 
+int thread_timer_wheel = 0;
+
 PriorityEventQueue::PriorityEventQueue()
 {
   last_check_time    = Thread::get_hrtime_updated();
   last_check_buckets = last_check_time / PQ_BUCKET_TIME(0);
+  if (thread_timer_wheel) {
+    wheel = new EventTimingWheel(PQ_WHEEL_TICK, last_check_time);
+  }
+}
+
+PriorityEventQueue::~PriorityEventQueue()
+{
+  delete wheel;
 }
 
 void
 PriorityEventQueue::check_ready(ink_hrtime now, EThread *t)
 {
+  if (wheel) {
+    last_check_time = now;
+    wheel->advance(now, [t](Event *e) {
+      if (!e->cancelled) {
+        return false;
+      }
+      e->in_the_priority_queue = 0;
+      e->cancelled             = 0;
+      EVENT_FREE(e, eventAllocator, t);
+      return true;
+    });
+    return;
+  }
+
   int i, j, k = 0;
   uint32_t check_buckets = static_cast<uint32_t>(now / PQ_BUCKET_TIME(0));
   uint32_t todo_buckets  = check_buckets ^ last_check_buckets;
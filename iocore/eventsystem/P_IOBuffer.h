@@ -26,6 +26,8 @@
 #include "tscore/ink_platform.h"
 #include "tscore/ink_resource.h"
 
+#include <algorithm>
+
 // TODO: I think we're overly aggressive here on making MIOBuffer 64-bit
 // but not sure it's worthwhile changing anything to 32-bit honestly.
 
@@ -235,11 +237,12 @@ IOBufferData::alloc(int64_t size_index, AllocType type)
   }
   _size_index = size_index;
   _mem_type   = type;
+  _numa_node  = ats_numa_thread_node();
   iobuffer_mem_inc(_location, size_index);
   switch (type) {
   case MEMALIGNED:
     if (BUFFER_SIZE_INDEX_IS_FAST_ALLOCATED(size_index)) {
-      _data = (char *)ioBufAllocator[size_index].alloc_void();
+      _data = (char *)ioBufAllocatorForNode(_numa_node, size_index).alloc_void();
       // coverity[dead_error_condition]
     } else if (BUFFER_SIZE_INDEX_IS_XMALLOCED(size_index)) {
       _data = (char *)ats_memalign(ats_pagesize(), index_to_buffer_size(size_index));
@@ -248,7 +251,7 @@ IOBufferData::alloc(int64_t size_index, AllocType type)
   default:
   case DEFAULT_ALLOC:
     if (BUFFER_SIZE_INDEX_IS_FAST_ALLOCATED(size_index)) {
-      _data = (char *)ioBufAllocator[size_index].alloc_void();
+      _data = (char *)ioBufAllocatorForNode(_numa_node, size_index).alloc_void();
     } else if (BUFFER_SIZE_INDEX_IS_XMALLOCED(size_index)) {
       _data = (char *)ats_malloc(BUFFER_SIZE_FOR_XMALLOC(size_index));
     }
@@ -265,7 +268,7 @@ IOBufferData::dealloc()
   switch (_mem_type) {
   case MEMALIGNED:
     if (BUFFER_SIZE_INDEX_IS_FAST_ALLOCATED(_size_index)) {
-      ioBufAllocator[_size_index].free_void(_data);
+      ioBufAllocatorForNode(_numa_node, _size_index).free_void(_data);
     } else if (BUFFER_SIZE_INDEX_IS_XMALLOCED(_size_index)) {
       ::free((void *)_data);
     }
@@ -273,7 +276,7 @@ IOBufferData::dealloc()
   default:
   case DEFAULT_ALLOC:
     if (BUFFER_SIZE_INDEX_IS_FAST_ALLOCATED(_size_index)) {
-      ioBufAllocator[_size_index].free_void(_data);
+      ioBufAllocatorForNode(_numa_node, _size_index).free_void(_data);
     } else if (BUFFER_SIZE_INDEX_IS_XMALLOCED(_size_index)) {
       ats_free(_data);
     }
@@ -282,6 +285,7 @@ IOBufferData::dealloc()
   _data       = nullptr;
   _size_index = BUFFER_SIZE_NOT_ALLOCATED;
   _mem_type   = NO_ALLOC;
+  _numa_node  = -1;
 }
 
 TS_INLINE void
@@ -532,6 +536,51 @@ IOBufferReader::read_avail()
   return t;
 }
 
+TS_INLINE
+IOBufferReader::SpanIterator::SpanIterator(IOBufferBlock *b, int64_t o, int64_t l) : block(b), offset(o), limit(l)
+{
+  settle();
+}
+
+// Move to the first block with data past the offset, or to the end.
+TS_INLINE void
+IOBufferReader::SpanIterator::settle()
+{
+  while (block && limit > 0) {
+    int64_t avail = block->read_avail();
+    if (offset < avail) {
+      return;
+    }
+    offset -= avail;
+    block = block->next.get();
+  }
+  *this = SpanIterator();
+}
+
+TS_INLINE std::string_view
+IOBufferReader::SpanIterator::operator*() const
+{
+  return std::string_view(block->start() + offset, std::min(block->read_avail() - offset, limit));
+}
+
+TS_INLINE IOBufferReader::SpanIterator &
+IOBufferReader::SpanIterator::operator++()
+{
+  limit -= std::min(block->read_avail() - offset, limit);
+  offset = 0;
+  block  = block->next.get();
+  settle();
+  return *this;
+}
+
+TS_INLINE IOBufferReader::SpanRange
+IOBufferReader::spans(int64_t offset)
+{
+  int64_t limit = size_limit == INT64_MAX ? INT64_MAX : size_limit - offset;
+
+  return SpanRange{SpanIterator(block.get(), start_offset + offset, limit)};
+}
+
 TS_INLINE bool
 IOBufferReader::is_read_avail_more_than(int64_t size)
 {
@@ -43,15 +43,27 @@ ProtectedQueue::ProtectedQueue()
 TS_INLINE void
 ProtectedQueue::signal()
 {
+#if HAVE_EVENTFD
+  uint64_t counter = 1;
+  ATS_UNUSED_RETURN(write(evfd, &counter, sizeof(counter)));
+#else
   // Need to get the lock before you can signal the thread
   ink_mutex_acquire(&lock);
   ink_cond_signal(&might_have_data);
   ink_mutex_release(&lock);
+#endif
 }
 
 TS_INLINE int
 ProtectedQueue::try_signal()
 {
+#if HAVE_EVENTFD
+  if (!awake.load()) {
+    signal();
+    return 1;
+  }
+  return 0;
+#else
   // Need to get the lock before you can signal the thread
   if (ink_mutex_try_acquire(&lock)) {
     ink_cond_signal(&might_have_data);
@@ -60,6 +72,22 @@ ProtectedQueue::try_signal()
   } else {
     return 0;
   }
+#endif
+}
+
+TS_INLINE bool
+ProtectedQueue::prepare_to_sleep()
+{
+  // Pairs with the push and load of @a awake in enqueue: either the producer sees the thread
+  // going to sleep and wakes it, or the thread sees the event here.
+  awake.store(false);
+  return INK_ATOMICLIST_EMPTY(al) && localQueue.empty();
+}
+
+TS_INLINE void
+ProtectedQueue::wake_up()
+{
+  awake.store(true, std::memory_order_relaxed);
 }
 
 // Called from the same thread (don't need to signal)
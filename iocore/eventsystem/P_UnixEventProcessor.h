@@ -63,6 +63,38 @@ EventProcessor::assign_thread(EventType etype)
   return tg->_thread[next];
 }
 
+TS_INLINE EThread *
+EventProcessor::assign_thread_by_load(EventType etype)
+{
+  ThreadGroupDescriptor *tg = &thread_group[etype];
+  EThread *t                = assign_thread(etype);
+  EThread *self             = this_ethread();
+
+  // Two choices are enough to keep away from the busy threads, without all the accepts piling
+  // up on the least loaded one until its load catches up.
+  if (tg->_count > 2 && self) {
+    EThread *other = tg->_thread[self->generator.random() % tg->_count];
+    if (other->load.load(std::memory_order_relaxed) < t->load.load(std::memory_order_relaxed)) {
+      t = other;
+    }
+  }
+  return t;
+}
+
+TS_INLINE EThread *
+EventProcessor::least_loaded_thread(EventType etype)
+{
+  ThreadGroupDescriptor *tg = &thread_group[etype];
+  EThread *least            = tg->_thread[0];
+
+  for (int i = 1; i < tg->_count; ++i) {
+    if (tg->_thread[i]->load.load(std::memory_order_relaxed) < least->load.load(std::memory_order_relaxed)) {
+      least = tg->_thread[i];
+    }
+  }
+  return least;
+}
+
 // If thread_holding is the correct type, return it.
 //
 // Otherwise check if there is already an affinity associated with the continuation,
@@ -23,8 +23,8 @@
   @section details Details
 
   ProtectedQueue implements a FIFO queue with the following functionality:
-    -# Multiple threads could be simultaneously trying to enqueue and
-      dequeue. Hence the queue needs to be protected with mutex.
+    -# Multiple threads could be simultaneously trying to enqueue, only the
+      owning thread dequeues. Enqueue and dequeue are lock free.
     -# In case the queue is empty, dequeue() sleeps for a specified amount
       of time, or until a new element is inserted, whichever is earlier.
 
@@ -32,6 +32,10 @@
 
 #include "P_EventSystem.h"
 
+#if HAVE_EVENTFD
+#include <poll.h>
+#endif
+
 // The protected queue is designed to delay signaling of threads
 // until some amount of work has been completed on the current thread
 // in order to prevent excess context switches.
@@ -51,7 +55,8 @@ ProtectedQueue::enqueue(Event *e)
   e->in_the_prot_queue = 1;
   bool was_empty       = (ink_atomiclist_push(&al, e) == nullptr);
 
-  if (was_empty) {
+  // A thread that is awake will see the event before it sleeps, see prepare_to_sleep.
+  if (was_empty && !awake.load()) {
     EThread *inserting_thread = this_ethread();
     // queue e->ethread in the list of threads to be signalled
     // inserting_thread == 0 means it is not a regular EThread
@@ -85,14 +90,35 @@ ProtectedQueue::dequeue_external()
 void
 ProtectedQueue::wait(ink_hrtime timeout)
 {
+#if HAVE_EVENTFD
+  /* If there are no external events available, sleep in poll on the eventfd.
+   *
+   * Producers write to the eventfd once they see that this thread is no longer awake. There is no
+   * lock to hand over, the `EThread::lock` stays held.
+   */
+  if (prepare_to_sleep()) {
+    ink_hrtime delta = timeout - Thread::get_hrtime_updated();
+    if (delta > 0) {
+      struct pollfd pfd = {evfd, POLLIN, 0};
+      timespec ts       = ink_hrtime_to_timespec(delta);
+      if (ppoll(&pfd, 1, &ts, nullptr) > 0) {
+        uint64_t counter;
+        ATS_UNUSED_RETURN(read(evfd, &counter, sizeof(counter)));
+      }
+    }
+  }
+  wake_up();
+#else
   /* If there are no external events available, will do a cond_timedwait.
    *
    *   - The `EThread::lock` will be released,
    *   - And then the Event Thread goes to sleep and waits for the wakeup signal of `EThread::might_have_data`,
    *   - The `EThread::lock` will be locked again when the Event Thread wakes up.
    */
-  if (INK_ATOMICLIST_EMPTY(al) && localQueue.empty()) {
+  if (prepare_to_sleep()) {
     timespec ts = ink_hrtime_to_timespec(timeout);
     ink_cond_timedwait(&might_have_data, &lock, &ts);
   }
+  wake_up();
+#endif
 }
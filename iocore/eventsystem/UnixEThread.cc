@@ -45,12 +45,28 @@ struct AIOCallback;
 char const *const EThread::STAT_NAME[] = {"proxy.process.eventloop.count",      "proxy.process.eventloop.events",
                                           "proxy.process.eventloop.events.min", "proxy.process.eventloop.events.max",
                                           "proxy.process.eventloop.wait",       "proxy.process.eventloop.time.min",
-                                          "proxy.process.eventloop.time.max"};
+                                          "proxy.process.eventloop.time.max",   "proxy.process.eventloop.busy",
+                                          "proxy.process.eventloop.stalls"};
 
 int const EThread::SAMPLE_COUNT[N_EVENT_TIMESCALES] = {10, 100, 1000};
 
 int thread_max_heartbeat_mseconds = THREAD_MAX_HEARTBEAT_MSECONDS;
 
+// The weight of the older seconds in EThread::load.
+#define THREAD_LOAD_SMOOTHING 4
+
+static ink_hrtime
+thread_cpu_time()
+{
+#if defined(CLOCK_THREAD_CPUTIME_ID)
+  timespec ts;
+  if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) == 0) {
+    return ink_hrtime_from_timespec(&ts);
+  }
+#endif
+  return 0;
+}
+
 EThread::EThread()
 {
   memset(thread_private, 0, PER_THREAD_DATA);
@@ -71,6 +87,7 @@ EThread::EThread(ThreadType att, int anid) : id(anid), tt(att)
       Fatal("EThread::EThread: %d=eventfd(0,EFD_NONBLOCK | EFD_CLOEXEC),errno(%d)", evfd, errno);
     }
   }
+  EventQueueExternal.evfd = evfd;
 #elif TS_USE_PORT
 /* Solaris ports requires no crutches to do cross thread signaling.
  * We'll just port_send the event straight over the port.
@@ -92,7 +109,11 @@ EThread::EThread(ThreadType att, Event *e) : tt(att), start_event(e)
 
 // Provide a destructor so that SDK functions which create and destroy
 // threads won't have to deal with EThread memory deallocation.
-EThread::~EThread() {}
+EThread::~EThread()
+{
+  delete WorkQueue;
+  delete profile.load();
+}
 
 bool
 EThread::is_event_type(EventType et)
@@ -124,7 +145,21 @@ EThread::process_event(Event *e, int calling_code)
     // Restore the client IP debugging flags
     set_cont_flags(e->continuation->control_flags);
 
-    e->continuation->handleEvent(calling_code, e);
+    if (HandlerProfile *p = thread_profile_enabled ? this->handler_profile() : nullptr) {
+      // The handler may free the continuation, take what the sample needs first.
+      const std::type_info *type = &typeid(*c_temp);
+      const void *handler        = HandlerProfile::handler_address(c_temp);
+#ifdef DEBUG
+      const char *handler_name = c_temp->handler_name;
+#else
+      const char *handler_name = nullptr;
+#endif
+      ink_hrtime start = ink_get_hrtime_internal();
+      e->continuation->handleEvent(calling_code, e);
+      p->record(type, handler, handler_name, calling_code, start, ink_get_hrtime_internal());
+    } else {
+      e->continuation->handleEvent(calling_code, e);
+    }
     ink_assert(!e->in_the_priority_queue);
     ink_assert(c_temp == e->continuation);
     MUTEX_RELEASE(lock);
@@ -159,7 +194,9 @@ EThread::process_queue(Que(Event, link) * NegativeQueue, int *ev_count, int *nq_
       free_event(e);
     } else if (!e->timeout_at) { // IMMEDIATE
       ink_assert(e->period == 0);
-      process_event(e, e->callback_event);
+      if (WorkQueue == nullptr || !WorkQueue->push(e)) {
+        process_event(e, e->callback_event);
+      }
     } else if (e->timeout_at > 0) { // INTERVAL
       EventQueue.enqueue(e, cur_time);
     } else { // NEGATIVE
@@ -177,6 +214,52 @@ EThread::process_queue(Que(Event, link) * NegativeQueue, int *ev_count, int *nq_
     }
     ++(*nq_count);
   }
+
+  if (WorkQueue) {
+    run_work_queue();
+  }
+}
+
+// Run the queued immediate events, oldest first. They are taken from the top, like a thief would,
+// to keep them in scheduling order. If there is a backlog wake a sibling to help with it.
+void
+EThread::run_work_queue()
+{
+  Event *e;
+
+  if (WorkQueue->size() > 1) {
+    auto group = eventProcessor.active_group_threads(work_group);
+    int n      = group.end() - group.begin();
+    if (n > 1) {
+      EThread *t = group.begin()[(id + 1 + generator.random() % (n - 1)) % n];
+      t->tail_cb->signalActivity();
+    }
+  }
+
+  while (!WorkQueue->empty()) {
+    if (WorkQueue->steal(e)) {
+      process_event(e, e->callback_event);
+    }
+  }
+}
+
+// Take one immediate event from another thread in the group and run it here.
+bool
+EThread::steal_work()
+{
+  auto group = eventProcessor.active_group_threads(work_group);
+  int n      = group.end() - group.begin();
+  Event *e;
+
+  for (int i = 1; i < n; ++i) {
+    EThread *victim = group.begin()[(id + i) % n];
+    if (victim->WorkQueue && victim->WorkQueue->steal(e)) {
+      e->ethread = this;
+      process_event(e, e->callback_event);
+      return true;
+    }
+  }
+  return false;
 }
 
 void
@@ -210,6 +293,17 @@ EThread::execute_regular()
 
     current_metric = metrics + (loop_start_time / HRTIME_SECOND) % N_EVENT_METRICS;
     if (current_metric != prev_metric) {
+      // The CPU time since the last block is that of the block just done, the thread slept through any skipped.
+      ink_hrtime cpu_time = thread_cpu_time();
+      if (load_time != 0) {
+        prev_metric->_busy = cpu_time - load_cpu_time;
+        ink_hrtime elapsed = std::max(loop_start_time - load_time, static_cast<ink_hrtime>(HRTIME_SECOND));
+        int busy           = static_cast<int>(std::min<ink_hrtime>(prev_metric->_busy * 100 / elapsed, 100));
+        load.store((load.load(std::memory_order_relaxed) * (THREAD_LOAD_SMOOTHING - 1) + busy) / THREAD_LOAD_SMOOTHING,
+                   std::memory_order_relaxed);
+      }
+      load_cpu_time = cpu_time;
+      load_time     = loop_start_time;
       // Mixed feelings - really this shouldn't be needed, but just in case more than one entry is
       // skipped, clear them all.
       do {
@@ -248,8 +342,14 @@ EThread::execute_regular()
       }
     }
 
-    next_time             = EventQueue.earliest_timeout();
-    ink_hrtime sleep_time = next_time - Thread::get_hrtime_updated();
+    next_time               = EventQueue.earliest_timeout();
+    ink_hrtime dispatch_end = Thread::get_hrtime_updated();
+    ink_hrtime sleep_time   = next_time - dispatch_end;
+    // Before going idle, help a busy sibling and then look again at our own queues.
+    if (WorkQueue && sleep_time > 0 && EventQueueExternal.localQueue.empty() && steal_work()) {
+      ++ev_count;
+      sleep_time = 0;
+    }
     if (sleep_time > 0) {
       if (EventQueueExternal.localQueue.empty()) {
         sleep_time = std::min(sleep_time, HRTIME_MSECONDS(thread_max_heartbeat_mseconds));
@@ -269,6 +369,17 @@ EThread::execute_regular()
     loop_finish_time = Thread::get_hrtime_updated();
     delta            = loop_finish_time - loop_start_time;
 
+    // The loop was busy dispatching events and for as long as the tail handler took beyond its wait.
+    ink_hrtime tail_busy = std::max<ink_hrtime>(loop_finish_time - dispatch_end - sleep_time, 0);
+    ink_hrtime busy      = dispatch_end - loop_start_time + tail_busy;
+    if (thread_profile_stall_threshold > 0 && busy > HRTIME_MSECONDS(thread_profile_stall_threshold)) {
+      ++(current_metric->_stalls);
+    }
+    if (HandlerProfile *p = profile.load(std::memory_order_relaxed); p && thread_profile_enabled) {
+      p->record(&typeid(*tail_cb), nullptr, nullptr, HANDLER_PROFILE_TAIL_EVENT, loop_finish_time - tail_busy, loop_finish_time);
+      p->loop_done(loop_start_time, busy);
+    }
+
     // This can happen due to time of day adjustments (which apparently happen quite frequently). I
     // tried using the monotonic clock to get around this but it was *very* stuttery (up to hundreds
     // of milliseconds), far too much to be actually used.
@@ -348,6 +459,8 @@ EThread::EventMetrics::operator+=(EventMetrics const &that)
   this->_loop_time._max = std::max(this->_loop_time._max, that._loop_time._max);
   this->_count += that._count;
   this->_wait += that._wait;
+  this->_stalls += that._stalls;
+  this->_busy += that._busy;
   return *this;
 }
 
@@ -83,8 +83,7 @@ EventMetricStatSync(const char *, RecDataT, RecData *, RecRawStatBlock *rsb, int
     t->summarize_stats(summary);
   }
 
-  ink_mutex_acquire(&(rsb->mutex));
-
+  // Only the thread running the raw stat sync passes writes these globals.
   for (int ts_idx = 0; ts_idx < EThread::N_EVENT_TIMESCALES; ++ts_idx, id += EThread::N_EVENT_STATS) {
     EThread::EventMetrics *m = summary + ts_idx;
     // Discarding the atomic swaps for global writes, doesn't seem to actually do anything useful.
@@ -102,6 +101,12 @@ EventMetricStatSync(const char *, RecDataT, RecData *, RecRawStatBlock *rsb, int
     rsb->global[id + EThread::STAT_LOOP_TIME_MAX]->sum   = m->_loop_time._max;
     rsb->global[id + EThread::STAT_LOOP_TIME_MAX]->count = 1;
     RecRawStatUpdateSum(rsb, id + EThread::STAT_LOOP_TIME_MAX);
+    rsb->global[id + EThread::STAT_LOOP_BUSY]->sum   = m->_busy;
+    rsb->global[id + EThread::STAT_LOOP_BUSY]->count = 1;
+    RecRawStatUpdateSum(rsb, id + EThread::STAT_LOOP_BUSY);
+    rsb->global[id + EThread::STAT_LOOP_STALLS]->sum   = m->_stalls;
+    rsb->global[id + EThread::STAT_LOOP_STALLS]->count = 1;
+    RecRawStatUpdateSum(rsb, id + EThread::STAT_LOOP_STALLS);
 
     rsb->global[id + EThread::STAT_LOOP_EVENTS]->sum   = m->_events._total;
     rsb->global[id + EThread::STAT_LOOP_EVENTS]->count = 1;
@@ -114,7 +119,6 @@ EventMetricStatSync(const char *, RecDataT, RecData *, RecRawStatBlock *rsb, int
     RecRawStatUpdateSum(rsb, id + EThread::STAT_LOOP_EVENTS_MAX);
   }
 
-  ink_mutex_release(&(rsb->mutex));
   return REC_ERR_OKAY;
 }
 
@@ -200,6 +204,8 @@ ThreadAffinityInitializer::set_affinity(int, Event *)
     Debug("iocore_thread", "EThread: %d %s: %d", _name, obj->logical_index);
 #endif // HWLOC_API_VERSION
     hwloc_set_thread_cpubind(ink_get_topology(), t->tid, obj->cpuset, HWLOC_CPUBIND_STRICT);
+    // Buffers this thread allocates come from its node, if the binding is within one.
+    ats_numa_set_thread_node(ats_numa_node_of_thread_binding());
   } else {
     Warning("hwloc returned an unexpected number of objects -- CPU affinity disabled");
   }
@@ -377,6 +383,10 @@ EventProcessor::spawn_event_threads(EventType ev_type, int n_threads, size_t sta
     t->id                        = i; // unfortunately needed to support affinity and NUMA logic.
     t->set_event_type(ev_type);
     t->schedule_spawn(&thread_initializer);
+    if (tg->_work_stealing) {
+      t->WorkQueue  = new ts::ChaseLevDeque<Event *>(EThread::WORK_QUEUE_SIZE);
+      t->work_group = ev_type;
+    }
   }
   tg->_count = n_threads;
   n_ethreads += n_threads;
@@ -392,7 +402,8 @@ EventProcessor::spawn_event_threads(EventType ev_type, int n_threads, size_t sta
     tg->_thread[i]->start(thr_name, stack, stacksize);
   }
 
-  Debug("iocore_thread", "Created thread group '%s' id %d with %d threads", tg->_name.c_str(), ev_type, n_threads);
+  Debug("iocore_thread", "Created thread group '%s' id %d with %d threads%s", tg->_name.c_str(), ev_type, n_threads,
+        tg->_work_stealing ? " (work stealing)" : "");
 
   return ev_type; // useless but not sure what would be better.
 }
@@ -0,0 +1,168 @@
+/** @file
+
+  Costs of the event system primitives on the hot paths.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  @section details Details
+
+  Usage: benchmark_EventSystem [-n iterations] [-j]
+
+  Times writing blocks to a @c MIOBuffer and reading them back, allocating and freeing from a
+  @c ClassAllocator, and the latency of an event scheduled with @c schedule_imm from this thread
+  until an event thread calls it back. With -j the results are JSON lines, for `make bench`.
+ */
+
+#include "I_EventSystem.h"
+#include "tscore/I_Layout.h"
+#include "bench_report.h"
+
+#include "diags.i"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <unistd.h>
+
+namespace
+{
+constexpr int EVENT_THREADS = 2;
+constexpr int64_t BLOCK     = 4096;
+
+double
+seconds_since(ink_hrtime start)
+{
+  return static_cast<double>(ink_get_hrtime_internal() - start) / HRTIME_SECOND;
+}
+
+double
+time_iobuffer(int iterations)
+{
+  char block[BLOCK] = {0};
+  char out[BLOCK];
+  MIOBuffer *buffer      = new_MIOBuffer(BUFFER_SIZE_INDEX_32K);
+  IOBufferReader *reader = buffer->alloc_reader();
+
+  ink_hrtime start = ink_get_hrtime_internal();
+  for (int i = 0; i < iterations; ++i) {
+    buffer->write(block, BLOCK);
+    if (reader->read(out, BLOCK) != BLOCK) {
+      fprintf(stderr, "short read from the IOBuffer\n");
+      exit(1);
+    }
+  }
+  double seconds = seconds_since(start);
+
+  free_MIOBuffer(buffer);
+  return seconds;
+}
+
+struct Object {
+  char data[192];
+};
+
+ClassAllocator<Object> objectAllocator("benchmarkObjectAllocator");
+
+double
+time_class_allocator(int iterations)
+{
+  Object *batch[16];
+
+  ink_hrtime start = ink_get_hrtime_internal();
+  for (int i = 0; i < iterations; ++i) {
+    for (auto &object : batch) {
+      object = objectAllocator.alloc();
+    }
+    for (auto object : batch) {
+      objectAllocator.free(object);
+    }
+  }
+  return seconds_since(start);
+}
+
+// Records how long after it was scheduled the event thread called it back.
+struct Receiver : public Continuation {
+  Receiver() : Continuation(new_ProxyMutex()) { SET_HANDLER(&Receiver::handle); }
+
+  int
+  handle(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
+  {
+    latency += ink_get_hrtime_internal() - scheduled;
+    done.store(true, std::memory_order_release);
+    return EVENT_DONE;
+  }
+
+  ink_hrtime scheduled = 0;
+  ink_hrtime latency   = 0;
+  std::atomic<bool> done{false};
+};
+
+double
+time_schedule_imm(int iterations)
+{
+  Receiver receiver;
+  for (int i = 0; i < iterations; ++i) {
+    receiver.done.store(false, std::memory_order_relaxed);
+    receiver.scheduled = ink_get_hrtime_internal();
+    eventProcessor.schedule_imm(&receiver);
+    while (!receiver.done.load(std::memory_order_acquire)) {
+      ;
+    }
+  }
+  return static_cast<double>(receiver.latency) / HRTIME_SECOND;
+}
+} // namespace
+
+int
+main(int argc, char *argv[])
+{
+  int iterations = 1000000;
+  bool json      = false;
+  int opt;
+  while ((opt = getopt(argc, argv, "n:j")) != -1) {
+    if (opt == 'n') {
+      iterations = atoi(optarg);
+    } else if (opt == 'j') {
+      json = true;
+    } else {
+      fprintf(stderr, "usage: %s [-n iterations] [-j]\n", argv[0]);
+      return 1;
+    }
+  }
+
+  Layout::create();
+  init_diags("", nullptr);
+  RecProcessInit(RECM_STAND_ALONE);
+
+  ink_event_system_init(EVENT_SYSTEM_MODULE_PUBLIC_VERSION);
+  eventProcessor.start(EVENT_THREADS, 1048576);
+
+  EThread *main_thread = new EThread;
+  main_thread->set_specific();
+
+  bench_report(json, "iobuffer_write_read_4k", iterations, time_iobuffer(iterations));
+  bench_report(json, "class_allocator_alloc_free", static_cast<int64_t>(iterations) * 16, time_class_allocator(iterations));
+  // The event threads sleep when idle, so this is not the cost of a busy thread's dispatch.
+  int events = iterations / 10;
+  bench_report(json, "event_schedule_imm_latency", events, time_schedule_imm(events));
+
+  // The event threads do not stop, leave without tearing anything down.
+  fflush(stdout);
+  _exit(0);
+}
@@ -330,6 +330,145 @@ TEST_CASE("MIOBuffer", "[iocore]")
   }
 }
 
+TEST_CASE("IOBufferSizer", "[iocore]")
+{
+  MIOBuffer *miob = new_MIOBuffer(BUFFER_SIZE_INDEX_4K);
+  IOBufferSizer sizer;
+
+  SECTION("full reads grow the blocks up to the max")
+  {
+    for (int i = 0; i < IOBufferSizer::GROW_AFTER - 1; ++i) {
+      CHECK(sizer.update(miob, 4096, 4096, BUFFER_SIZE_INDEX_1K, BUFFER_SIZE_INDEX_16K) == 0);
+    }
+    CHECK(sizer.update(miob, 4096, 4096, BUFFER_SIZE_INDEX_1K, BUFFER_SIZE_INDEX_16K) == 1);
+    CHECK(miob->size_index == BUFFER_SIZE_INDEX_8K);
+
+    for (int i = 0; i < 4 * IOBufferSizer::GROW_AFTER; ++i) {
+      sizer.update(miob, 8192, 8192, BUFFER_SIZE_INDEX_1K, BUFFER_SIZE_INDEX_16K);
+    }
+    CHECK(miob->size_index == BUFFER_SIZE_INDEX_16K);
+  }
+
+  SECTION("short reads shrink the blocks down to the min")
+  {
+    for (int i = 0; i < IOBufferSizer::SHRINK_AFTER - 1; ++i) {
+      CHECK(sizer.update(miob, 4096, 100, BUFFER_SIZE_INDEX_1K, BUFFER_SIZE_INDEX_16K) == 0);
+    }
+    CHECK(sizer.update(miob, 4096, 100, BUFFER_SIZE_INDEX_1K, BUFFER_SIZE_INDEX_16K) == -1);
+    CHECK(miob->size_index == BUFFER_SIZE_INDEX_2K);
+
+    for (int i = 0; i < 4 * IOBufferSizer::SHRINK_AFTER; ++i) {
+      sizer.update(miob, 4096, 100, BUFFER_SIZE_INDEX_1K, BUFFER_SIZE_INDEX_16K);
+    }
+    CHECK(miob->size_index == BUFFER_SIZE_INDEX_1K);
+  }
+
+  SECTION("other reads reset the runs")
+  {
+    for (int i = 0; i < 4 * IOBufferSizer::SHRINK_AFTER; ++i) {
+      sizer.update(miob, 4096, i % 2 ? 4096 : 100, BUFFER_SIZE_INDEX_1K, BUFFER_SIZE_INDEX_16K);
+      sizer.update(miob, 4096, 2048, BUFFER_SIZE_INDEX_1K, BUFFER_SIZE_INDEX_16K);
+    }
+    CHECK(miob->size_index == BUFFER_SIZE_INDEX_4K);
+  }
+
+  SECTION("the next buffer starts with the block size settled on")
+  {
+    for (int i = 0; i < IOBufferSizer::GROW_AFTER; ++i) {
+      sizer.update(miob, 4096, 4096, BUFFER_SIZE_INDEX_1K, BUFFER_SIZE_INDEX_16K);
+    }
+    MIOBuffer *next = new_MIOBuffer(BUFFER_SIZE_INDEX_4K);
+    sizer.update(next, 4096, 2048, BUFFER_SIZE_INDEX_1K, BUFFER_SIZE_INDEX_16K);
+    CHECK(next->size_index == BUFFER_SIZE_INDEX_8K);
+    free_MIOBuffer(next);
+  }
+
+  free_MIOBuffer(miob);
+}
+
+TEST_CASE("IOBufferReader spans", "[iocore]")
+{
+  MIOBuffer *miob        = new_MIOBuffer(BUFFER_SIZE_INDEX_128);
+  IOBufferReader *miob_r     = miob->alloc_reader();
+  std::string data;
+  for (int i = 0; data.size() < 1000; ++i) {
+    data += std::to_string(i) + ",";
+  }
+  data += "end";
+  miob->write(data.data(), data.size());
+  REQUIRE(miob_r->block_count() > 1);
+
+  SECTION("the spans cover the readable bytes")
+  {
+    std::string joined;
+    for (std::string_view span : miob_r->spans()) {
+      CHECK(span.size() > 0);
+      joined.append(span.data(), span.size());
+    }
+    CHECK(joined == data);
+
+    joined.clear();
+    for (std::string_view span : miob_r->spans(300)) {
+      joined.append(span.data(), span.size());
+    }
+    CHECK(joined == data.substr(300));
+
+    miob_r->consume(5);
+    miob_r->size_limit = 200;
+    joined.clear();
+    for (std::string_view span : miob_r->spans()) {
+      joined.append(span.data(), span.size());
+    }
+    CHECK(joined == data.substr(5, 200));
+  }
+
+  SECTION("find matches across the blocks")
+  {
+    for (std::string_view pattern : {"0,", "127,128,", "200,201,202,", "end"}) {
+      CHECK(miob_r->find(pattern) == static_cast<int64_t>(data.find(pattern)));
+    }
+    CHECK(miob_r->find("1,", 10) == static_cast<int64_t>(data.find("1,", 10)));
+    CHECK(miob_r->find("not there") == -1);
+    CHECK(miob_r->find("end,") == -1);
+  }
+
+  free_MIOBuffer(miob);
+}
+
+TEST_CASE("MIOBuffer release_blocks", "[iocore]")
+{
+  MIOBuffer *miob        = new_MIOBuffer(BUFFER_SIZE_INDEX_4K);
+  IOBufferReader *miob_r = miob->alloc_reader();
+
+  miob->write("abcd", 4);
+  CHECK(miob->held_bytes() == 4096);
+
+  SECTION("not while there is data to read")
+  {
+    CHECK(miob->release_blocks() == 0);
+    CHECK(miob_r->read_avail() == 4);
+  }
+
+  SECTION("empty buffer")
+  {
+    miob_r->consume(4);
+    CHECK(miob->release_blocks() == 4096);
+    CHECK(miob->held_bytes() == 0);
+    CHECK(miob_r->read_avail() == 0);
+
+    // The reader sees what is written next, in a block of the same size.
+    CHECK(miob->write_avail() == 4096);
+    miob->write("efgh", 4);
+    CHECK(miob->held_bytes() == 4096);
+    REQUIRE(miob_r->read_avail() == 4);
+    char buf[4];
+    miob_r->read(buf, sizeof(buf));
+    CHECK(memcmp(buf, "efgh", 4) == 0);
+  }
+
+  free_MIOBuffer(miob);
+}
+
 struct EventProcessorListener : Catch::TestEventListenerBase {
   using TestEventListenerBase::TestEventListenerBase;
 
@@ -0,0 +1,165 @@
+/** @file
+
+  Cross thread scheduling latency of the ProtectedQueue.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cinttypes>
+#include <thread>
+#include <vector>
+
+#include "I_EventSystem.h"
+#include "tscore/I_Layout.h"
+
+#include "diags.i"
+
+#define TEST_THREADS 2
+#define TEST_ROUNDS 2000
+
+namespace
+{
+std::atomic<ink_hrtime> received{0};
+
+struct Receiver : public Continuation {
+  Receiver() : Continuation(new_ProxyMutex()) { SET_HANDLER(&Receiver::handle); }
+
+  int
+  handle(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
+  {
+    received = ink_get_hrtime_internal();
+    return 0;
+  }
+};
+
+// Schedule an event on @a target from this (non event) thread @a n times and return the sorted
+// latencies until it ran. With @a idle the target is given time to go to sleep first so the
+// wake up is included, otherwise each event is sent right after the previous one ran, usually
+// before the target has gone back to sleep.
+std::vector<ink_hrtime>
+measure(EThread *target, int n, bool idle)
+{
+  Receiver cont;
+  std::vector<ink_hrtime> lat;
+
+  lat.reserve(n);
+  for (int i = 0; i < n; ++i) {
+    if (idle) {
+      std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+    received        = 0;
+    ink_hrtime sent = ink_get_hrtime_internal();
+    target->schedule_imm(&cont);
+    while (received.load() == 0) {
+      std::this_thread::yield();
+    }
+    lat.push_back(received.load() - sent);
+  }
+  std::sort(lat.begin(), lat.end());
+  return lat;
+}
+
+void
+report(const char *name, std::vector<ink_hrtime> const &lat)
+{
+  std::printf("%-8s p50 %6" PRId64 " us  p90 %6" PRId64 " us  p99 %6" PRId64 " us  max %6" PRId64 " us\n", name,
+              ink_hrtime_to_usec(lat[lat.size() / 2]), ink_hrtime_to_usec(lat[lat.size() * 9 / 10]),
+              ink_hrtime_to_usec(lat[lat.size() * 99 / 100]), ink_hrtime_to_usec(lat.back()));
+}
+} // namespace
+
+TEST_CASE("ProtectedQueue cross thread schedule latency", "[iocore][ProtectedQueue]")
+{
+  EThread *target = eventProcessor.thread_group[ET_CALL]._thread[0];
+
+  // Sleeping target: every event has to wake the thread, which must not wait for its heartbeat.
+  auto idle = measure(target, TEST_ROUNDS, true);
+  report("idle", idle);
+  REQUIRE(idle[idle.size() / 2] < HRTIME_MSECONDS(thread_max_heartbeat_mseconds));
+
+  auto hot = measure(target, TEST_ROUNDS * 10, false);
+  report("hot", hot);
+  REQUIRE(hot.size() == TEST_ROUNDS * 10);
+}
+
+TEST_CASE("ProtectedQueue many producers", "[iocore][ProtectedQueue]")
+{
+  static constexpr int N_PRODUCERS = 4;
+  static constexpr int N_EVENTS    = 20000;
+  static std::atomic<int> count;
+
+  struct Counter : public Continuation {
+    Counter() : Continuation(new_ProxyMutex()) { SET_HANDLER(&Counter::handle); }
+
+    int
+    handle(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
+    {
+      ++count;
+      return 0;
+    }
+  };
+
+  Counter cont;
+  EThread *target = eventProcessor.thread_group[ET_CALL]._thread[0];
+  count           = 0;
+
+  ink_hrtime start = ink_get_hrtime_internal();
+  std::vector<std::thread> producers;
+  for (int i = 0; i < N_PRODUCERS; ++i) {
+    producers.emplace_back([&]() {
+      for (int j = 0; j < N_EVENTS; ++j) {
+        target->schedule_imm(&cont);
+      }
+    });
+  }
+  for (auto &t : producers) {
+    t.join();
+  }
+  while (count.load() < N_PRODUCERS * N_EVENTS) {
+    std::this_thread::yield();
+  }
+  ink_hrtime elapsed = ink_get_hrtime_internal() - start;
+  std::printf("%d events from %d threads in %" PRId64 " ms\n", N_PRODUCERS * N_EVENTS, N_PRODUCERS, ink_hrtime_to_msec(elapsed));
+  REQUIRE(count.load() == N_PRODUCERS * N_EVENTS);
+}
+
+struct EventProcessorListener : Catch::TestEventListenerBase {
+  using TestEventListenerBase::TestEventListenerBase;
+
+  void
+  testRunStarting(Catch::TestRunInfo const &testRunInfo) override
+  {
+    Layout::create();
+    init_diags("", nullptr);
+    RecProcessInit(RECM_STAND_ALONE);
+
+    ink_event_system_init(EVENT_SYSTEM_MODULE_PUBLIC_VERSION);
+    eventProcessor.start(TEST_THREADS, 1048576); // Hardcoded stacksize at 1MB
+
+    EThread *main_thread = new EThread;
+    main_thread->set_specific();
+  }
+};
+
+CATCH_REGISTER_LISTENER(EventProcessorListener);
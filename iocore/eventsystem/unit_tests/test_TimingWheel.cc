@@ -0,0 +1,151 @@
+/** @file
+
+  Unit tests for TimingWheel.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+#include <random>
+#include <vector>
+
+#include "I_TimingWheel.h"
+
+namespace
+{
+struct Item {
+  ink_hrtime at  = 0;
+  uint16_t slot  = 0;
+  bool cancelled = false;
+  int fired      = 0;
+  ink_hrtime fired_at;
+  LINK(Item, link);
+};
+
+using Wheel = TimingWheel<Item, Item::Link_link, &Item::at, &Item::slot>;
+
+constexpr ink_hrtime TICK = HRTIME_MSECONDS(1);
+
+// Advance @a w from @a from to @a to in @a step increments and mark what comes out.
+void
+run(Wheel &w, ink_hrtime from, ink_hrtime to, ink_hrtime step)
+{
+  for (ink_hrtime now = from; now <= to; now += step) {
+    w.advance(now);
+    while (Item *i = w.pop_ready()) {
+      ++i->fired;
+      i->fired_at = now;
+    }
+  }
+}
+} // namespace
+
+TEST_CASE("TimingWheel ordering", "[iocore][TimingWheel]")
+{
+  ink_hrtime start = HRTIME_SECONDS(1000);
+  Wheel w(TICK, start);
+  std::vector<Item> items(2000);
+  std::mt19937 rng(7);
+  // Cover every level, including items beyond the span of the wheel.
+  std::uniform_int_distribution<int> exp(0, 36);
+
+  for (auto &i : items) {
+    i.at = start + (ink_hrtime(1) << exp(rng)) * 1000 + rng() % 1000;
+    w.insert(&i);
+  }
+  REQUIRE(w.size() == items.size());
+  REQUIRE(w.next_expiry() > start);
+
+  // Ten second steps for a while, then jump to well past every item.
+  for (ink_hrtime now = start; now < start + HRTIME_HOURS(2); now += HRTIME_SECONDS(10)) {
+    w.advance(now);
+    while (Item *i = w.pop_ready()) {
+      ++i->fired;
+      i->fired_at = now;
+    }
+  }
+  run(w, start + HRTIME_DAYS(100), start + HRTIME_DAYS(100), TICK);
+
+  for (auto &i : items) {
+    REQUIRE(i.fired == 1);
+    REQUIRE(i.fired_at >= i.at);
+    REQUIRE(i.slot == Wheel::NOT_QUEUED);
+  }
+  REQUIRE(w.empty());
+}
+
+TEST_CASE("TimingWheel precision", "[iocore][TimingWheel]")
+{
+  ink_hrtime start = HRTIME_MSECONDS(12345);
+  Wheel w(TICK, start);
+  std::vector<Item> items(500);
+
+  for (size_t n = 0; n < items.size(); ++n) {
+    items[n].at = start + HRTIME_USECONDS(n * 9973);
+    w.insert(&items[n]);
+  }
+  run(w, start, start + HRTIME_SECONDS(6), HRTIME_USECONDS(250));
+
+  for (auto &i : items) {
+    REQUIRE(i.fired == 1);
+    REQUIRE(i.fired_at >= i.at);
+    REQUIRE(i.fired_at - i.at <= TICK + HRTIME_USECONDS(250));
+  }
+}
+
+TEST_CASE("TimingWheel remove and discard", "[iocore][TimingWheel]")
+{
+  ink_hrtime start = 0;
+  Wheel w(TICK, start);
+  Item due, soon, later, far;
+
+  due.at   = start;
+  soon.at  = start + HRTIME_MSECONDS(10);
+  later.at = start + HRTIME_SECONDS(10);
+  far.at   = start + HRTIME_HOURS(10);
+  w.insert(&due);
+  w.insert(&soon);
+  w.insert(&later);
+  w.insert(&far);
+  REQUIRE(due.slot == Wheel::READY);
+  REQUIRE(w.next_expiry() == start);
+
+  w.remove(&due);
+  w.remove(&soon);
+  w.remove(&soon); // not queued any more, must be harmless
+  REQUIRE(w.size() == 2);
+  REQUIRE(w.next_expiry() <= later.at);
+
+  far.cancelled = true;
+  int dropped   = 0;
+  w.advance(start + HRTIME_DAYS(1), [&](Item *i) {
+    if (i->cancelled) {
+      ++dropped;
+      return true;
+    }
+    return false;
+  });
+  REQUIRE(dropped == 1);
+  REQUIRE(w.pop_ready() == &later);
+  REQUIRE(w.pop_ready() == nullptr);
+  REQUIRE(w.empty());
+  REQUIRE(w.next_expiry() == HRTIME_FOREVER);
+}
@@ -50,6 +50,8 @@ unsigned int hostdb_ip_stale_interval          = HOST_DB_IP_STALE;
 unsigned int hostdb_ip_timeout_interval        = HOST_DB_IP_TIMEOUT;
 unsigned int hostdb_ip_fail_timeout_interval   = HOST_DB_IP_FAIL_TIMEOUT;
 unsigned int hostdb_serve_stale_but_revalidate = 0;
+unsigned int hostdb_prefetch_ttl_percent       = 0;
+unsigned int hostdb_prefetch_hit_window        = 60;
 unsigned int hostdb_hostfile_check_interval    = 86400; // 1 day
 // Epoch timestamp of the current hosts file check.
 ink_time_t hostdb_current_interval = 0;
@@ -63,6 +65,7 @@ char hostdb_hostfile_path[PATH_NAME_MAX]           = "";
 int hostdb_sync_frequency                          = 0;
 int hostdb_disable_reverse_lookup                  = 0;
 int hostdb_max_iobuf_index                         = BUFFER_SIZE_INDEX_32K;
+int hostdb_lockfree_index                          = 0;
 
 ClassAllocator<HostDBContinuation> hostDBContAllocator("hostDBContAllocator");
 
@@ -323,6 +326,8 @@ HostDBCache::start(int flags)
   REC_ReadConfigInteger(hostdb_max_size, "proxy.config.hostdb.max_size");
   // number of partitions
   REC_ReadConfigInt32(hostdb_partitions, "proxy.config.hostdb.partitions");
+  // lock free lookups of fresh records
+  REC_ReadConfigInt32(hostdb_lockfree_index, "proxy.config.hostdb.lockfree_index");
   // how often to sync hostdb to disk
   REC_EstablishStaticConfigInt32(hostdb_sync_frequency, "proxy.config.cache.hostdb.sync_frequency");
 
@@ -335,6 +340,9 @@ HostDBCache::start(int flags)
   // Setup the ref-counted cache (this must be done regardless of syncing or not).
   this->refcountcache = new RefCountCache<HostDBInfo>(hostdb_partitions, hostdb_max_size, hostdb_max_count, HostDBInfo::version(),
                                                       "proxy.process.hostdb.cache.");
+  if (hostdb_lockfree_index) {
+    this->refcountcache->enable_index();
+  }
 
   //
   // Load and sync HostDB, if we've asked for it.
@@ -362,9 +370,14 @@ HostDBCache::start(int flags)
 
     Debug("hostdb", "Opening %s, partitions=%d storage_size=%" PRIu64 " items=%d", full_path, hostdb_partitions, hostdb_max_size,
           hostdb_max_count);
-    int load_ret = LoadRefCountCacheFromPath<HostDBInfo>(*this->refcountcache, storage_path, full_path, HostDBInfo::unmarshall);
-    if (load_ret != 0) {
-      Warning("Error loading cache from %s: %d", full_path, load_ret);
+    // Records are served from the mapped file, each one is copied in the first time it is looked up.
+    int load_ret = this->refcountcache->attach_store(full_path, HostDBInfo::unmarshall);
+    if (load_ret == -ENOENT) {
+      Debug("hostdb", "No records at %s", full_path);
+    } else if (load_ret != 0) {
+      Warning("Error loading cache from %s: %s", full_path, strerror(-load_ret));
+    } else {
+      Debug("hostdb", "Serving %zu records from %s", this->refcountcache->get_store()->count(), full_path);
     }
 
     eventProcessor.schedule_imm(new HostDBSync(hostdb_sync_frequency, storage_path, full_path), ET_TASK);
@@ -407,6 +420,8 @@ HostDBProcessor::start(int, size_t)
   REC_EstablishStaticConfigInt32U(hostdb_ip_stale_interval, "proxy.config.hostdb.verify_after");
   REC_EstablishStaticConfigInt32U(hostdb_ip_fail_timeout_interval, "proxy.config.hostdb.fail.timeout");
   REC_EstablishStaticConfigInt32U(hostdb_serve_stale_but_revalidate, "proxy.config.hostdb.serve_stale_for");
+  REC_EstablishStaticConfigInt32U(hostdb_prefetch_ttl_percent, "proxy.config.hostdb.prefetch.ttl_percent");
+  REC_EstablishStaticConfigInt32U(hostdb_prefetch_hit_window, "proxy.config.hostdb.prefetch.hit_window");
   REC_EstablishStaticConfigInt32U(hostdb_hostfile_check_interval, "proxy.config.hostdb.host_file.interval");
   REC_EstablishStaticConfigInt32U(hostdb_round_robin_max_count, "proxy.config.hostdb.round_robin_max_count");
 
@@ -537,6 +552,25 @@ db_mark_for(IpAddr const &ip)
   return ip.isIp6() ? HOSTDB_MARK_IPV6 : HOSTDB_MARK_IPV4;
 }
 
+// Whether @a r is far enough into its TTL to be re-resolved ahead of its timeout.
+static bool
+in_prefetch_window(const HostDBInfo *r)
+{
+  return hostdb_prefetch_ttl_percent && !r->reverse_dns && !r->is_failed() &&
+         r->ip_interval() >= r->ip_timeout_interval * std::min(hostdb_prefetch_ttl_percent, 99u) / 100;
+}
+
+// Record a hit on @a r, which must be locked. A hit in the prefetch window refreshes the record if
+// the previous one was less than the hit window ago, so only busy names get the extra lookups.
+static bool
+prefetch_on_hit(HostDBInfo *r)
+{
+  unsigned int now     = std::min(r->ip_interval(), HOST_DB_MAX_TTL);
+  unsigned int last    = r->last_hit_interval;
+  r->last_hit_interval = now;
+  return in_prefetch_window(r) && now >= last && now - last <= hostdb_prefetch_hit_window;
+}
+
 Ptr<HostDBInfo>
 probe(const Ptr<ProxyMutex> &mutex, HostDBHash const &hash, bool ignore_timeout)
 {
@@ -565,14 +599,22 @@ probe(const Ptr<ProxyMutex> &mutex, HostDBHash const &hash, bool ignore_timeout)
     return make_ptr((HostDBInfo *)nullptr);
   }
 
+  // A busy record close to its timeout is refreshed the same way, so its expiry never stalls a lookup.
+  bool prefetch = !ignore_timeout && prefetch_on_hit(r.get());
+
   // If the record is stale, but we want to revalidate-- lets start that up
-  if ((!ignore_timeout && r->is_ip_stale() && !r->reverse_dns) || (r->is_ip_timeout() && r->serve_stale_but_revalidate())) {
+  if ((!ignore_timeout && r->is_ip_stale() && !r->reverse_dns) || (r->is_ip_timeout() && r->serve_stale_but_revalidate()) ||
+      prefetch) {
     if (hostDB.is_pending_dns_for_hash(hash.hash)) {
       Debug("hostdb", "stale %u %u %u, using it and pending to refresh it", r->ip_interval(), r->ip_timestamp,
             r->ip_timeout_interval);
       return r;
     }
-    Debug("hostdb", "stale %u %u %u, using it and refreshing it", r->ip_interval(), r->ip_timestamp, r->ip_timeout_interval);
+    Debug("hostdb", "%s %u %u %u, using it and refreshing it", prefetch ? "prefetch" : "stale", r->ip_interval(), r->ip_timestamp,
+          r->ip_timeout_interval);
+    if (prefetch) {
+      HOSTDB_INCREMENT_DYN_STAT(hostdb_prefetch_stat);
+    }
     HostDBContinuation *c = hostDBContAllocator.alloc();
     HostDBContinuation::Options copt;
     copt.host_res_style = host_res_style_for(r->ip());
@@ -582,6 +624,23 @@ probe(const Ptr<ProxyMutex> &mutex, HostDBHash const &hash, bool ignore_timeout)
   return r;
 }
 
+// The part of probe that needs no lock: a record that probe would return as is, without
+// removing it or starting a refresh. Anything else, including hits in the prefetch window that
+// have to be recorded, is left to probe under the partition lock.
+static Ptr<HostDBInfo>
+probe_lockfree(HostDBHash const &hash)
+{
+  if (!hostdb_enable || !hostdb_lockfree_index) {
+    return Ptr<HostDBInfo>();
+  }
+  Ptr<HostDBInfo> r = hostDB.refcountcache->get_lockfree(hash.hash.fold());
+  if (r && ((r->is_failed() && r->is_ip_fail_timeout()) || r->is_ip_timeout() || (r->is_ip_stale() && !r->reverse_dns) ||
+            in_prefetch_window(r.get()))) {
+    r.clear();
+  }
+  return r;
+}
+
 //
 // Insert a HostDBInfo into the database
 // A null value indicates that the block is empty.
@@ -649,37 +708,42 @@ HostDBProcessor::getby(Continuation *cont, cb_process_result_pfn cb_process_resu
     bool loop = lock.is_locked();
     while (loop) {
       loop = false; // Only loop on explicit set for retry.
-      // find the partition lock
-      Ptr<ProxyMutex> bucket_mutex = hostDB.refcountcache->lock_for_key(hash.hash.fold());
-      MUTEX_TRY_LOCK(lock2, bucket_mutex, thread);
-      if (lock2.is_locked()) {
+      // A fresh record from the lock free index needs no partition lock
+      Ptr<HostDBInfo> r = probe_lockfree(hash);
+      if (!r) {
+        // find the partition lock
+        Ptr<ProxyMutex> bucket_mutex = hostDB.refcountcache->lock_for_key(hash.hash.fold());
+        MUTEX_TRY_LOCK(lock2, bucket_mutex, thread);
+        if (!lock2.is_locked()) {
+          break;
+        }
         // If we can get the lock and a level 1 probe succeeds, return
-        Ptr<HostDBInfo> r = probe(bucket_mutex, hash, false);
-        if (r) {
-          // fail, see if we should retry with alternate
-          if (hash.db_mark != HOSTDB_MARK_SRV && r->is_failed() && hash.host_name) {
-            loop = check_for_retry(hash.db_mark, opt.host_res_style);
+        r = probe(bucket_mutex, hash, false);
+      }
+      if (r) {
+        // fail, see if we should retry with alternate
+        if (hash.db_mark != HOSTDB_MARK_SRV && r->is_failed() && hash.host_name) {
+          loop = check_for_retry(hash.db_mark, opt.host_res_style);
+        }
+        if (!loop) {
+          // No retry -> final result. Return it.
+          if (hash.db_mark == HOSTDB_MARK_SRV) {
+            Debug("hostdb", "immediate SRV answer for %.*s from hostdb", hash.host_len, hash.host_name);
+            Debug("dns_srv", "immediate SRV answer for %.*s from hostdb", hash.host_len, hash.host_name);
+          } else if (hash.host_name) {
+            Debug("hostdb", "immediate answer for %.*s", hash.host_len, hash.host_name);
+          } else {
+            Debug("hostdb", "immediate answer for %s", hash.ip.isValid() ? hash.ip.toString(ipb, sizeof ipb) : "<null>");
           }
-          if (!loop) {
-            // No retry -> final result. Return it.
-            if (hash.db_mark == HOSTDB_MARK_SRV) {
-              Debug("hostdb", "immediate SRV answer for %.*s from hostdb", hash.host_len, hash.host_name);
-              Debug("dns_srv", "immediate SRV answer for %.*s from hostdb", hash.host_len, hash.host_name);
-            } else if (hash.host_name) {
-              Debug("hostdb", "immediate answer for %.*s", hash.host_len, hash.host_name);
-            } else {
-              Debug("hostdb", "immediate answer for %s", hash.ip.isValid() ? hash.ip.toString(ipb, sizeof ipb) : "<null>");
-            }
-            HOSTDB_INCREMENT_DYN_STAT(hostdb_total_hits_stat);
-            if (cb_process_result) {
-              (cont->*cb_process_result)(r.get());
-            } else {
-              reply_to_cont(cont, r.get());
-            }
-            return ACTION_RESULT_DONE;
+          HOSTDB_INCREMENT_DYN_STAT(hostdb_total_hits_stat);
+          if (cb_process_result) {
+            (cont->*cb_process_result)(r.get());
+          } else {
+            reply_to_cont(cont, r.get());
           }
-          hash.refresh(); // only on reloop, because we've changed the family.
+          return ACTION_RESULT_DONE;
         }
+        hash.refresh(); // only on reloop, because we've changed the family.
       }
     }
   }
@@ -1290,8 +1354,9 @@ HostDBContinuation::dnsEvent(int event, HostEnt *e)
     // If the DNS lookup failed (errors such as SERVFAIL, etc.) but we have an old record
     // which is okay with being served stale-- lets continue to serve the stale record as long as
     // the record is willing to be served.
+    // The same goes for a refresh of a record that has not timed out yet.
     bool serve_stale = false;
-    if (failed && old_r && old_r->serve_stale_but_revalidate()) {
+    if (failed && old_r && (old_r->serve_stale_but_revalidate() || (!old_r->is_failed() && !old_r->is_ip_timeout()))) {
       r->free();
       r           = old_r.get();
       serve_stale = true;
@@ -1406,6 +1471,7 @@ HostDBContinuation::dnsEvent(int event, HostEnt *e)
 
     if (!serve_stale) {
       hostDB.refcountcache->put(hash.hash.fold(), r, allocSize, r->expiry_time());
+      hostDB.refcountcache->publish(hash.hash.fold());
     } else {
       Warning("Fallback to serving stale record, skip re-update of hostdb for %s", aname);
     }
@@ -1643,6 +1709,7 @@ HostDBContinuation::do_dns()
       // check 127.0.0.1 format // What the heck does that mean? - AMC
       if (action.continuation) {
         HostDBInfo *r = lookup_done(tip, hash.host_name, false, HOST_DB_MAX_TTL, nullptr);
+        hostDB.refcountcache->publish(hash.hash.fold());
 
         reply_to_cont(action.continuation, r);
       }
@@ -1656,6 +1723,7 @@ HostDBContinuation::do_dns()
       if (action.continuation) {
         // Set the TTL based on how often we stat() the host file
         HostDBInfo *r = lookup_done(IpAddr(find_result->second), hash.host_name, false, hostdb_hostfile_check_interval, nullptr);
+        hostDB.refcountcache->publish(hash.hash.fold());
         reply_to_cont(action.continuation, r);
       }
       hostdb_cont_free(this);
@@ -2155,6 +2223,9 @@ ink_hostdb_init(ts::ModuleVersion v)
   RecRegisterRawStat(hostdb_rsb, RECT_PROCESS, "proxy.process.hostdb.re_dns_on_reload", RECD_INT, RECP_PERSISTENT,
                      (int)hostdb_re_dns_on_reload_stat, RecRawStatSyncSum);
 
+  RecRegisterRawStat(hostdb_rsb, RECT_PROCESS, "proxy.process.hostdb.prefetch", RECD_INT, RECP_PERSISTENT,
+                     (int)hostdb_prefetch_stat, RecRawStatSyncSum);
+
   ts_host_res_global_init();
 }
 
@@ -28,6 +28,7 @@
 #include "tscore/CryptoHash.h"
 #include "tscore/ink_align.h"
 #include "tscore/ink_resolver.h"
+#include "tscore/memory_domain.h"
 #include "I_EventSystem.h"
 #include "SRV.h"
 #include "P_RefCountCache.h"
@@ -150,6 +151,7 @@ struct HostDBInfo : public RefCountObj {
     memset(ptr, 0, size);
     HostDBInfo *ret      = new (ptr) HostDBInfo();
     ret->_iobuffer_index = iobuffer_index;
+    ats_memory_domain_charge(MEMORY_DOMAIN_HOSTDB, BUFFER_SIZE_FOR_INDEX(iobuffer_index));
     return ret;
   }
 
@@ -158,6 +160,7 @@ struct HostDBInfo : public RefCountObj {
   {
     ink_release_assert(from_alloc());
     Debug("hostdb", "freeing %d bytes at [%p]", (1 << (7 + _iobuffer_index)), this);
+    ats_memory_domain_charge(MEMORY_DOMAIN_HOSTDB, -BUFFER_SIZE_FOR_INDEX(_iobuffer_index));
     ioBufAllocator[_iobuffer_index].free_void((void *)(this));
   }
 
@@ -343,6 +346,8 @@ struct HostDBInfo : public RefCountObj {
   unsigned int round_robin : 1;     // This is the root of a round robin block
   unsigned int round_robin_elt : 1; // This is an address in a round robin block
 
+  unsigned int last_hit_interval : 21; // seconds after ip_timestamp of the last hit, bounded like ip_timeout_interval
+
   HostDBInfo() : _iobuffer_index{-1} {}
 
   HostDBInfo(HostDBInfo const &src) : RefCountObj()
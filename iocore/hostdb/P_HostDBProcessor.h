@@ -53,6 +53,9 @@ extern int hostdb_srv_enabled;
 // extern int hostdb_timestamp;
 extern int hostdb_sync_frequency;
 extern int hostdb_disable_reverse_lookup;
+extern int hostdb_lockfree_index;
+extern unsigned int hostdb_prefetch_ttl_percent;
+extern unsigned int hostdb_prefetch_hit_window;
 
 // Static configuration information
 extern HostDBCache hostDB;
@@ -140,6 +143,7 @@ enum HostDB_Stats {
   hostdb_ttl_stat,         // D average TTL
   hostdb_ttl_expires_stat, // D == TTL Expires
   hostdb_re_dns_on_reload_stat,
+  hostdb_prefetch_stat,
   HostDB_Stat_Count
 };
 
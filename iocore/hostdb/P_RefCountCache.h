@@ -32,15 +32,18 @@
 #include "tscore/ink_hrtime.h"
 
 #include "tscore/I_Version.h"
+#include <atomic>
+#include <string>
+#include <vector>
 #include <unistd.h>
 
 #define REFCOUNT_CACHE_EVENT_SYNC REFCOUNT_CACHE_EVENT_EVENTS_START
 
 #define REFCOUNTCACHE_MAGIC_NUMBER 0x0BAD2D9
 
-static constexpr unsigned char REFCOUNTCACHE_MAJOR_VERSION = 1;
+static constexpr unsigned char REFCOUNTCACHE_MAJOR_VERSION = 2;
 static constexpr unsigned char REFCOUNTCACHE_MINOR_VERSION = 0;
-static constexpr ts::VersionNumber REFCOUNTCACHE_VERSION(1, 0);
+static constexpr ts::VersionNumber REFCOUNTCACHE_VERSION(2, 0);
 
 // Stats
 enum RefCountCache_Stats {
@@ -147,6 +150,351 @@ struct RefCountCacheLinkage {
   }
 };
 
+// Lock free read index of a RefCountCachePartition
+//
+// An open addressing table of pointers to immutable nodes, each node holding a key and a reference
+// to the item. Only the writers of the partition change it, under the partition lock, while get
+// reads it without any lock. A node or a whole table is replaced with one atomic store and the old
+// one is retired, and only freed once the grace period has passed, so a reader that loaded the
+// pointer just before the swap can still take its reference.
+//
+// A put is not visible here until the writer publishes the key, once it is done filling the item
+// in. Erasing a key takes it out right away.
+
+static constexpr ink_hrtime REFCOUNTCACHE_INDEX_GRACE = HRTIME_SECONDS(10);
+
+template <class C> class RefCountCacheIndex
+{
+public:
+  RefCountCacheIndex(unsigned int max_items, ink_hrtime grace);
+  ~RefCountCacheIndex();
+
+  Ptr<C> get(uint64_t key) const;
+
+  // Writers, under the partition lock
+  void publish(uint64_t key, C *item);
+  void unpublish(uint64_t key);
+  void clear();
+
+private:
+  struct Node {
+    uint64_t key;
+    Ptr<C> item;
+  };
+
+  struct Table {
+    uint64_t mask; // number of slots less one
+    std::atomic<Node *> *slots;
+
+    explicit Table(uint64_t n) : mask(n - 1), slots(new std::atomic<Node *>[n]()) {}
+    ~Table() { delete[] slots; }
+  };
+
+  struct Retired {
+    ink_hrtime when;
+    Node *node;
+    Table *table;
+  };
+
+  // Marks a slot whose node was removed, a probe has to go on past it.
+  static Node *
+  tombstone()
+  {
+    return reinterpret_cast<Node *>(static_cast<uintptr_t>(1));
+  }
+
+  static uint64_t
+  slot_of(uint64_t key, uint64_t mask)
+  {
+    // The partition is picked by the key modulo the partition count, the low bits alone would cluster.
+    return ((key * 0x9E3779B97F4A7C15ULL) >> 32) & mask;
+  }
+
+  int64_t find(Table *t, uint64_t key) const;
+  void retire(Node *node, Table *table);
+  void reclaim();
+  void resize();
+
+  std::atomic<Table *> table;
+  uint64_t live = 0; // nodes in the table
+  uint64_t used = 0; // nodes and tombstones in the table
+  ink_hrtime grace;
+  std::vector<Retired> retired;
+};
+
+template <class C>
+RefCountCacheIndex<C>::RefCountCacheIndex(unsigned int max_items, ink_hrtime grace) : grace(grace)
+{
+  uint64_t n = 64;
+  while (max_items > 0 && max_items < (1U << 24) && n < static_cast<uint64_t>(max_items) * 2) {
+    n <<= 1;
+  }
+  table.store(new Table(n), std::memory_order_release);
+}
+
+template <class C> RefCountCacheIndex<C>::~RefCountCacheIndex()
+{
+  // No reader can be left by the time the cache is destroyed.
+  Table *t = table.load(std::memory_order_relaxed);
+  for (uint64_t i = 0; i <= t->mask; i++) {
+    Node *n = t->slots[i].load(std::memory_order_relaxed);
+    if (n && n != tombstone()) {
+      delete n;
+    }
+  }
+  delete t;
+  for (auto &r : retired) {
+    delete r.node;
+    delete r.table;
+  }
+}
+
+template <class C>
+Ptr<C>
+RefCountCacheIndex<C>::get(uint64_t key) const
+{
+  Table *t = table.load(std::memory_order_acquire);
+  for (uint64_t i = slot_of(key, t->mask), probes = 0; probes <= t->mask; i = (i + 1) & t->mask, probes++) {
+    Node *n = t->slots[i].load(std::memory_order_acquire);
+    if (n == nullptr) {
+      break;
+    }
+    if (n != tombstone() && n->key == key) {
+      return n->item;
+    }
+  }
+  return Ptr<C>();
+}
+
+// Slot of the node for @a key in @a t, or -1.
+template <class C>
+int64_t
+RefCountCacheIndex<C>::find(Table *t, uint64_t key) const
+{
+  for (uint64_t i = slot_of(key, t->mask), probes = 0; probes <= t->mask; i = (i + 1) & t->mask, probes++) {
+    Node *n = t->slots[i].load(std::memory_order_relaxed);
+    if (n == nullptr) {
+      break;
+    }
+    if (n != tombstone() && n->key == key) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+template <class C>
+void
+RefCountCacheIndex<C>::publish(uint64_t key, C *item)
+{
+  reclaim();
+  Node *node = new Node{key, make_ptr(item)};
+  Table *t   = table.load(std::memory_order_relaxed);
+  int64_t i  = find(t, key);
+  if (i >= 0) {
+    retire(t->slots[i].exchange(node, std::memory_order_acq_rel), nullptr);
+    return;
+  }
+  if ((used + 1) * 4 > (t->mask + 1) * 3) {
+    resize();
+    t = table.load(std::memory_order_relaxed);
+  }
+  // The first free slot, anything after it is not looked at by a reader until the store.
+  uint64_t j = slot_of(key, t->mask);
+  Node *n    = nullptr;
+  while ((n = t->slots[j].load(std::memory_order_relaxed)) != nullptr && n != tombstone()) {
+    j = (j + 1) & t->mask;
+  }
+  if (n == nullptr) {
+    used++;
+  }
+  live++;
+  t->slots[j].store(node, std::memory_order_release);
+}
+
+template <class C>
+void
+RefCountCacheIndex<C>::unpublish(uint64_t key)
+{
+  reclaim();
+  Table *t  = table.load(std::memory_order_relaxed);
+  int64_t i = find(t, key);
+  if (i >= 0) {
+    retire(t->slots[i].exchange(tombstone(), std::memory_order_acq_rel), nullptr);
+    live--;
+  }
+}
+
+template <class C>
+void
+RefCountCacheIndex<C>::clear()
+{
+  Table *t = table.load(std::memory_order_relaxed);
+  for (uint64_t i = 0; i <= t->mask; i++) {
+    Node *n = t->slots[i].load(std::memory_order_relaxed);
+    if (n && n != tombstone()) {
+      retire(t->slots[i].exchange(tombstone(), std::memory_order_acq_rel), nullptr);
+    }
+  }
+  live = 0;
+}
+
+// Copy the nodes to a new table, twice the size if more than half of the slots hold one.
+template <class C>
+void
+RefCountCacheIndex<C>::resize()
+{
+  Table *t   = table.load(std::memory_order_relaxed);
+  uint64_t n = t->mask + 1;
+  if (live * 2 > n) {
+    n <<= 1;
+  }
+  Table *nt = new Table(n);
+  for (uint64_t i = 0; i <= t->mask; i++) {
+    Node *e = t->slots[i].load(std::memory_order_relaxed);
+    if (e && e != tombstone()) {
+      uint64_t j = slot_of(e->key, nt->mask);
+      while (nt->slots[j].load(std::memory_order_relaxed)) {
+        j = (j + 1) & nt->mask;
+      }
+      nt->slots[j].store(e, std::memory_order_relaxed);
+    }
+  }
+  used = live;
+  table.store(nt, std::memory_order_release);
+  retire(nullptr, t);
+}
+
+template <class C>
+void
+RefCountCacheIndex<C>::retire(Node *node, Table *t)
+{
+  retired.push_back({ink_get_hrtime_internal(), node, t});
+}
+
+template <class C>
+void
+RefCountCacheIndex<C>::reclaim()
+{
+  if (retired.empty()) {
+    return;
+  }
+  ink_hrtime now = ink_get_hrtime_internal();
+  size_t done    = 0;
+  // Retired in time order, so the ones past the grace period are at the front.
+  while (done < retired.size() && now - retired[done].when >= grace) {
+    delete retired[done].node;
+    delete retired[done].table;
+    done++;
+  }
+  retired.erase(retired.begin(), retired.begin() + done);
+}
+
+// The header for the cache, this is used to check if the serialized cache is compatible
+class RefCountCacheHeader
+{
+public:
+  unsigned int magic = REFCOUNTCACHE_MAGIC_NUMBER;
+  ts::VersionNumber version{REFCOUNTCACHE_VERSION};
+  ts::VersionNumber object_version; // version passed in of whatever it is we are caching
+
+  RefCountCacheHeader(ts::VersionNumber object_version = ts::VersionNumber());
+  bool operator==(const RefCountCacheHeader other) const;
+  bool compatible(RefCountCacheHeader *other) const;
+};
+
+// The on disk layout of a persisted cache is
+//    - RefCountCacheHeader, padded to 8 bytes
+//    - RefCountCacheStoreHeader
+//    - the items, each one 8 byte aligned
+//    - RefCountCacheStoreEntry for every item, sorted by key
+//
+// Nothing in it has to be parsed to be used: RefCountCacheStore maps the file and finds an item
+// with a binary search of the entries, so a cache can be served from its file right at startup.
+struct RefCountCacheStoreHeader {
+  uint64_t count;        // number of entries
+  uint64_t entry_offset; // file offset of the entries
+};
+
+struct RefCountCacheStoreEntry {
+  uint64_t key;
+  uint64_t offset; // file offset of the item
+  uint32_t size;   // size of the item, as in RefCountCacheItemMeta
+  uint32_t reserved;
+  int64_t expiry_time;
+};
+
+// A persisted cache, mapped read only. Every entry is claimed at most once, when its item is
+// loaded into the cache or a newer item for the key replaces it. Entries are only touched under
+// the lock of the partition of their key.
+class RefCountCacheStore : public RefCountObj
+{
+public:
+  ~RefCountCacheStore() override;
+
+  // Returns 0 or -errno, -EINVAL if @a path is not a store compatible with @a header.
+  int open(const std::string &path, RefCountCacheHeader &header);
+
+  // Index of the entry for @a key, or -1.
+  int64_t find(uint64_t key) const;
+
+  size_t
+  count() const
+  {
+    return this->nentries;
+  }
+
+  const RefCountCacheStoreEntry &
+  entry(size_t i) const
+  {
+    return this->entries[i];
+  }
+
+  char *
+  data(const RefCountCacheStoreEntry &e) const
+  {
+    return this->base + e.offset;
+  }
+
+  bool
+  claimed(size_t i) const
+  {
+    return this->claims[i];
+  }
+
+  void
+  claim(size_t i)
+  {
+    this->claims[i] = 1;
+  }
+
+private:
+  char *base    = nullptr;
+  size_t length = 0;
+
+  const RefCountCacheStoreEntry *entries = nullptr;
+  size_t nentries                        = 0;
+  std::vector<uint8_t> claims;
+};
+
+// Writes a store to an open file. The entries are kept in memory until finish.
+// All methods return 0 or -errno.
+class RefCountCacheStoreWriter
+{
+public:
+  int start(int fd, const RefCountCacheHeader &header);
+  int append(uint64_t key, const void *data, uint32_t size, ink_time_t expiry_time);
+  // Write the entries, then the store header.
+  int finish();
+
+private:
+  int write(const void *data, size_t n_bytes);
+
+  int fd          = -1;
+  uint64_t offset = 0;
+  std::vector<RefCountCacheStoreEntry> entries;
+};
+
 // The RefCountCachePartition is simply a map of key -> Ptr<YourClass>
 // We partition the cache to reduce lock contention
 template <class C> class RefCountCachePartition
@@ -155,13 +503,19 @@ public:
   using hash_type = IntrusiveHashMap<RefCountCacheLinkage>;
 
   RefCountCachePartition(unsigned int part_num, uint64_t max_size, unsigned int max_items, RecRawStatBlock *rsb = nullptr);
+  ~RefCountCachePartition();
   Ptr<C> get(uint64_t key);
+  Ptr<C> get_lockfree(uint64_t key);
+  void publish(uint64_t key);
+  void enable_index(ink_hrtime grace);
+  void attach_store(RefCountCacheStore *store, C *(*load_func)(char *, unsigned int));
   void put(uint64_t key, C *item, int size = 0, int expire_time = 0);
   void erase(uint64_t key, ink_time_t expiry_time = -1);
 
   void clear();
   bool is_full() const;
   bool make_space_for(unsigned int);
+  unsigned int trim(unsigned int keep);
   void dealloc_entry(hash_type::iterator ptr);
 
   size_t count() const;
@@ -173,6 +527,7 @@ public:
 
 private:
   void metric_inc(RefCountCache_Stats metric_enum, int64_t data);
+  Ptr<C> load_stored(uint64_t key);
 
   unsigned int part_num;
   uint64_t max_size;
@@ -181,6 +536,11 @@ private:
   unsigned int items;
 
   hash_type item_map;
+  RefCountCacheIndex<C> *index = nullptr; // optional lock free copy of item_map
+
+  // Items persisted before the start, loaded on first lookup. Owned by the RefCountCache.
+  RefCountCacheStore *store                      = nullptr;
+  C *(*load_func)(char *buf, unsigned int size) = nullptr;
 
   PriorityQueue<RefCountCacheHashEntry *> expiry_queue;
   RecRawStatBlock *rsb;
@@ -193,6 +553,84 @@ RefCountCachePartition<C>::RefCountCachePartition(unsigned int part_num, uint64_
 {
 }
 
+template <class C> RefCountCachePartition<C>::~RefCountCachePartition()
+{
+  delete this->index;
+}
+
+// Must be called before the first put.
+template <class C>
+void
+RefCountCachePartition<C>::enable_index(ink_hrtime grace)
+{
+  ink_assert(this->items == 0);
+  if (this->index == nullptr) {
+    this->index = new RefCountCacheIndex<C>(this->max_items, grace);
+  }
+}
+
+// Same as get, without the partition lock. Misses if the index is not enabled.
+template <class C>
+Ptr<C>
+RefCountCachePartition<C>::get_lockfree(uint64_t key)
+{
+  if (this->index == nullptr) {
+    return Ptr<C>();
+  }
+  this->metric_inc(refcountcache_total_lookups_stat, 1);
+  Ptr<C> item = this->index->get(key);
+  if (item) {
+    this->metric_inc(refcountcache_total_hits_stat, 1);
+  }
+  return item;
+}
+
+// Serve the items of @a store that belong to this partition, @a load_func makes an item from its persisted copy.
+// A null @a store detaches the current one.
+template <class C>
+void
+RefCountCachePartition<C>::attach_store(RefCountCacheStore *store, C *(*load_func)(char *, unsigned int))
+{
+  this->store     = store;
+  this->load_func = load_func;
+}
+
+// Move the persisted item for @a key, if it was not claimed yet, into the partition.
+template <class C>
+Ptr<C>
+RefCountCachePartition<C>::load_stored(uint64_t key)
+{
+  int64_t i = this->store->find(key);
+  if (i < 0 || this->store->claimed(i)) {
+    return Ptr<C>();
+  }
+  this->store->claim(i);
+
+  const RefCountCacheStoreEntry &e = this->store->entry(i);
+  C *item                          = this->load_func(this->store->data(e), e.size);
+  if (item == nullptr) {
+    return Ptr<C>();
+  }
+  Ptr<C> ret = make_ptr(item);
+  this->put(key, item, e.size - sizeof(C), e.expiry_time);
+  this->publish(key);
+  this->metric_inc(refcountcache_total_hits_stat, 1);
+  return ret;
+}
+
+// Make the item put for @a key visible to get_lockfree.
+template <class C>
+void
+RefCountCachePartition<C>::publish(uint64_t key)
+{
+  if (this->index == nullptr) {
+    return;
+  }
+  if (auto it = this->item_map.find(key); it != this->item_map.end()) {
+    this->index->publish(key, static_cast<C *>(it->item.get()));
+  }
+}
+
 template <class C>
 Ptr<C>
 RefCountCachePartition<C>::get(uint64_t key)
@@ -202,6 +640,8 @@ RefCountCachePartition<C>::get(uint64_t key)
     // found
     this->metric_inc(refcountcache_total_hits_stat, 1);
     return make_ptr(static_cast<C *>(it->item.get()));
+  } else if (this->store) {
+    return this->load_stored(key);
   } else {
     return Ptr<C>();
   }
@@ -248,12 +688,21 @@ template <class C>
 void
 RefCountCachePartition<C>::erase(uint64_t key, ink_time_t expiry_time)
 {
+  // Whatever happens to the key now, the persisted item is out of date.
+  if (this->store) {
+    if (int64_t i = this->store->find(key); i >= 0) {
+      this->store->claim(i);
+    }
+  }
   if (auto it = this->item_map.find(key); it != this->item_map.end()) {
     if (expiry_time >= 0 && it->meta.expiry_time != expiry_time) {
       return;
     }
     this->item_map.erase(it);
     this->dealloc_entry(it);
+    if (this->index) {
+      this->index->unpublish(key);
+    }
   }
 }
 
@@ -295,6 +744,9 @@ RefCountCachePartition<C>::clear()
     this->item_map.erase(cur);
     this->dealloc_entry(cur);
   }
+  if (this->index) {
+    this->index->clear();
+  }
 }
 
 // Are we full?
@@ -330,6 +782,24 @@ RefCountCachePartition<C>::make_space_for(unsigned int size)
   return true;
 }
 
+// Evict the items that expire first, expired or not, until at most `keep` are left. Items that never
+// expire are not evicted. Returns the number of items evicted.
+template <class C>
+unsigned int
+RefCountCachePartition<C>::trim(unsigned int keep)
+{
+  unsigned int evicted = 0;
+  while (this->items > keep) {
+    PriorityQueueEntry<RefCountCacheHashEntry *> *top_item = expiry_queue.top();
+    if (top_item == nullptr) {
+      break;
+    }
+    this->erase(top_item->node->meta.key);
+    ++evicted;
+  }
+  return evicted;
+}
+
 template <class C>
 size_t
 RefCountCachePartition<C>::count() const
@@ -364,19 +834,6 @@ RefCountCachePartition<C>::get_map()
   return this->item_map;
 }
 
-// The header for the cache, this is used to check if the serialized cache is compatible
-class RefCountCacheHeader
-{
-public:
-  unsigned int magic = REFCOUNTCACHE_MAGIC_NUMBER;
-  ts::VersionNumber version{REFCOUNTCACHE_VERSION};
-  ts::VersionNumber object_version; // version passed in of whatever it is we are caching
-
-  RefCountCacheHeader(ts::VersionNumber object_version = ts::VersionNumber());
-  bool operator==(const RefCountCacheHeader other) const;
-  bool compatible(RefCountCacheHeader *other) const;
-};
-
 // RefCountCache is a ref-counted key->value map to store classes that inherit from RefCountObj.
 // Once an item is `put` into the cache, the cache will maintain a Ptr<> to that object until erase
 // or clear is called-- which will remove the cache's Ptr<> to the object.
@@ -405,6 +862,19 @@ public:
   void put(uint64_t key, C *item, int size = 0, ink_time_t expiry_time = -1);
   void erase(uint64_t key);
   void clear();
+  // Cut each partition whose lock is free down to `percent` of its items, returns the number evicted.
+  size_t trim(int percent);
+
+  // Lock free reads, see RefCountCacheIndex. The index must be enabled before the first put.
+  void enable_index(ink_hrtime grace = REFCOUNTCACHE_INDEX_GRACE);
+  void publish(uint64_t key);
+  Ptr<C> get_lockfree(uint64_t key);
+
+  // Serve the items persisted at @a filepath, each one is loaded with @a load_func the first time it is looked up.
+  int attach_store(const std::string &filepath, C *(*load_func)(char *, unsigned int));
+  Ptr<RefCountCacheStore> get_store();
+  // The unclaimed entries of the store for partition @a pnum, called with the partition lock held.
+  void copy_stored(int pnum, std::vector<const RefCountCacheStoreEntry *> &entries);
 
   // Some methods to get some internal state
   int partition_for_key(uint64_t key);
@@ -423,6 +893,7 @@ private:
   // Header
   RefCountCacheHeader header; // Our header
   RecRawStatBlock *rsb;
+  Ptr<RefCountCacheStore> store;
 };
 
 template <class C>
@@ -494,6 +965,64 @@ RefCountCache<C>::put(uint64_t key, C *item, int size, ink_time_t expiry_time)
   return this->partitions[this->partition_for_key(key)]->put(key, item, size, expiry_time);
 }
 
+template <class C>
+void
+RefCountCache<C>::enable_index(ink_hrtime grace)
+{
+  for (unsigned int i = 0; i < this->num_partitions; i++) {
+    this->partitions[i]->enable_index(grace);
+  }
+}
+
+template <class C>
+void
+RefCountCache<C>::publish(uint64_t key)
+{
+  this->partitions[this->partition_for_key(key)]->publish(key);
+}
+
+template <class C>
+Ptr<C>
+RefCountCache<C>::get_lockfree(uint64_t key)
+{
+  return this->partitions[this->partition_for_key(key)]->get_lockfree(key);
+}
+
+template <class C>
+int
+RefCountCache<C>::attach_store(const std::string &filepath, C *(*load_func)(char *, unsigned int))
+{
+  Ptr<RefCountCacheStore> s = make_ptr(new RefCountCacheStore());
+  if (int ret = s->open(filepath, this->header); ret != 0) {
+    return ret;
+  }
+  this->store = s;
+  for (unsigned int i = 0; i < this->num_partitions; i++) {
+    this->partitions[i]->attach_store(this->store.get(), load_func);
+  }
+  return 0;
+}
+
+template <class C>
+Ptr<RefCountCacheStore>
+RefCountCache<C>::get_store()
+{
+  return this->store;
+}
+
+template <class C>
+void
+RefCountCache<C>::copy_stored(int pnum, std::vector<const RefCountCacheStoreEntry *> &entries)
+{
+  RefCountCacheStore *s = this->store.get();
+  for (size_t i = 0; s && i < s->count(); i++) {
+    const RefCountCacheStoreEntry &e = s->entry(i);
+    if (!s->claimed(i) && this->partition_for_key(e.key) == pnum) {
+      entries.push_back(&e);
+    }
+  }
+}
+
 // Pick a partition for a given item
 template <class C>
 int
@@ -561,14 +1090,33 @@ RefCountCache<C>::clear()
 {
   for (unsigned int i = 0; i < this->num_partitions; i++) {
     this->partitions[i]->clear();
+    this->partitions[i]->attach_store(nullptr, nullptr);
   }
+  this->store = nullptr;
+}
+
+template <class C>
+size_t
+RefCountCache<C>::trim(int percent)
+{
+  size_t evicted = 0;
+  EThread *t     = this_ethread();
+  for (unsigned int i = 0; i < this->num_partitions; i++) {
+    RefCountCachePartition<C> *partition = this->partitions[i];
+    MUTEX_TRY_LOCK(lock, partition->lock, t);
+    if (lock.is_locked()) {
+      evicted += partition->trim(partition->count() * percent / 100);
+    }
+  }
+  return evicted;
 }
 
 // Fill `cache` with items in file `filepath` using `load_func` to unmarshall the record.
+// Unlike RefCountCache::attach_store this copies every item in up front.
 // Errors are -1
 template <typename CacheEntryType>
 int
-LoadRefCountCacheFromPath(RefCountCache<CacheEntryType> &cache, const std::string &dirname, const std::string &filepath,
+LoadRefCountCacheFromPath(RefCountCache<CacheEntryType> &cache, const std::string & /* dirname */, const std::string &filepath,
                           CacheEntryType *(*load_func)(char *, unsigned int))
 {
   // If we have no load method, then we can't load anything so lets just stop right here
@@ -576,45 +1124,19 @@ LoadRefCountCacheFromPath(RefCountCache<CacheEntryType> &cache, const std::strin
     return -1; // TODO: some specific error code
   }
 
-  int fd = open(filepath.c_str(), O_RDONLY);
-  if (fd < 0) {
-    Warning("Unable to open file %s; [Error]: %s", filepath.c_str(), strerror(errno));
+  RefCountCacheStore store;
+  if (int ret = store.open(filepath, cache.get_header()); ret != 0) {
+    Warning("Unable to load cache from %s: %s", filepath.c_str(), strerror(-ret));
     return -1;
   }
 
-  // read in the header
-  RefCountCacheHeader tmpHeader = RefCountCacheHeader();
-  int read_ret                  = read(fd, (char *)&tmpHeader, sizeof(RefCountCacheHeader));
-  if (read_ret != sizeof(RefCountCacheHeader)) {
-    socketManager.close(fd);
-    Warning("Error reading cache header from disk (expected %ld): %d", sizeof(RefCountCacheHeader), read_ret);
-    return -1;
-  }
-  if (!cache.get_header().compatible(&tmpHeader)) {
-    socketManager.close(fd);
-    Warning("Incompatible cache at %s, not loading.", filepath.c_str());
-    return -1; // TODO: specific code for incompatible
-  }
-
-  RefCountCacheItemMeta tmpValue = RefCountCacheItemMeta(0, 0);
-  while (true) { // TODO: better loop
-    read_ret = read(fd, (char *)&tmpValue, sizeof(tmpValue));
-    if (read_ret != sizeof(tmpValue)) {
-      break;
-    }
-    char buf[tmpValue.size];
-    read_ret = read(fd, (char *)&buf, tmpValue.size);
-    if (read_ret != (int)tmpValue.size) {
-      Warning("Encountered error reading item from cache: %d", read_ret);
-      break;
-    }
-
-    CacheEntryType *newItem = load_func((char *)&buf, tmpValue.size);
+  for (size_t i = 0; i < store.count(); i++) {
+    const RefCountCacheStoreEntry &e = store.entry(i);
+    CacheEntryType *newItem          = load_func(store.data(e), e.size);
     if (newItem != nullptr) {
-      cache.put(tmpValue.key, newItem, tmpValue.size - sizeof(CacheEntryType));
+      cache.put(e.key, newItem, e.size - sizeof(CacheEntryType));
+      cache.publish(e.key);
     }
-  };
-
-  socketManager.close(fd);
+  }
   return 0;
 }
@@ -38,6 +38,9 @@
 //
 // This way we only have to hold the lock on the partition for the
 // time it takes to get Ptr<>s to all items in the partition
+//
+// The file is written in the RefCountCacheStore layout. Items of the store the cache was started
+// from that were never looked up are copied straight from it.
 template <class C> class RefCountCacheSerializer : public Continuation
 {
 public:
@@ -54,14 +57,15 @@ public:
   // do the final mv and close of file handle
   int finalize_sync();
 
-  // helper method to spin on writes to disk
-  int write_to_disk(const void *, size_t);
-
   RefCountCacheSerializer(Continuation *acont, RefCountCache<C> *cc, int frequency, std::string dirname, std::string filename);
   ~RefCountCacheSerializer() override;
 
 private:
   std::vector<RefCountCacheHashEntry *> partition_items;
+  std::vector<const RefCountCacheStoreEntry *> stored_items;
+  Ptr<RefCountCacheStore> store; // keeps stored_items mapped
+
+  RefCountCacheStoreWriter writer;
 
   int fd; // fd for the file we are writing to
 
@@ -142,6 +146,8 @@ RefCountCacheSerializer<C>::copy_partition(int /* event */, Event *e)
   // copy the partition into our buffer, then we'll let `pauseEvent` write it out
   this->partition_items.reserve(cache->get_partition(partition).count());
   cache->get_partition(partition).copy(this->partition_items);
+  this->store = cache->get_store();
+  cache->copy_stored(partition, this->stored_items);
   partition++;
 
   SET_HANDLER(&RefCountCacheSerializer::write_partition);
@@ -169,16 +175,23 @@ RefCountCacheSerializer<C>::write_partition(int /* event */, Event *e)
       continue;
     }
 
-    // Write the RefCountCacheItemMeta (as our header)
-    int ret = this->write_to_disk((char *)&entry->meta, sizeof(entry->meta));
+    int ret = this->writer.append(entry->meta.key, entry->item.get(), entry->meta.size, entry->meta.expiry_time);
     if (ret < 0) {
-      Warning("Error writing cache item header to %s: %s", this->tmp_filename.c_str(), strerror(-ret));
+      Warning("Error writing cache item to %s: %s", this->tmp_filename.c_str(), strerror(-ret));
       delete this;
       return EVENT_DONE;
     }
 
-    // write the actual object now
-    ret = this->write_to_disk((char *)entry->item.get(), entry->meta.size);
+    this->total_items++;
+    this->total_size += entry->meta.size;
+  }
+
+  for (auto e : this->stored_items) {
+    if (e->expiry_time < curr_time) {
+      continue;
+    }
+
+    int ret = this->writer.append(e->key, this->store->data(*e), e->size, e->expiry_time);
     if (ret < 0) {
       Warning("Error writing cache item to %s: %s", this->tmp_filename.c_str(), strerror(-ret));
       delete this;
@@ -186,8 +199,9 @@ RefCountCacheSerializer<C>::write_partition(int /* event */, Event *e)
     }
 
     this->total_items++;
-    this->total_size += entry->meta.size;
+    this->total_size += e->size;
   }
+  this->stored_items.clear();
 
   // Clear the copied partition for the next round.
   for (auto &entry : this->partition_items) {
@@ -239,7 +253,7 @@ RefCountCacheSerializer<C>::initialize_storage(int /* event */, Event *e)
   }
 
   // Write out the header
-  int ret = this->write_to_disk((char *)&this->cache->get_header(), sizeof(RefCountCacheHeader));
+  int ret = this->writer.start(this->fd, this->cache->get_header());
   if (ret < 0) {
     Warning("Error writing cache header to %s: %s", this->tmp_filename.c_str(), strerror(-ret));
     delete this;
@@ -260,8 +274,8 @@ RefCountCacheSerializer<C>::finalize_sync()
   int error; // Socket manager return 0 or -errno.
   int dirfd = -1;
 
-  // fsync the fd we have
-  if ((error = socketManager.fsync(this->fd))) {
+  // Write out the entries, then fsync the fd we have
+  if ((error = this->writer.finish()) || (error = socketManager.fsync(this->fd))) {
     return error;
   }
 
@@ -306,21 +320,3 @@ RefCountCacheSerializer<C>::finalize_sync()
 
   return 0;
 }
-
-// Write *i to this->fd, if there is an error we'll just stop this continuation
-// TODO: reschedule the continuation if the disk was busy?
-template <class C>
-int
-RefCountCacheSerializer<C>::write_to_disk(const void *ptr, size_t n_bytes)
-{
-  size_t written = 0;
-  while (written < n_bytes) {
-    int ret = socketManager.write(this->fd, (char *)ptr + written, n_bytes - written);
-    if (ret <= 0) {
-      return ret;
-    } else {
-      written += ret;
-    }
-  }
-  return 0;
-}
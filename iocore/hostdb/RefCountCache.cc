@@ -21,6 +21,9 @@
 
 #include <P_RefCountCache.h>
 
+#include <algorithm>
+#include <sys/mman.h>
+
 // Since the hashing values are all fixed size, we can simply use a classAllocator to avoid mallocs
 static ClassAllocator<RefCountCacheHashEntry> refCountCacheHashingValueAllocator("refCountCacheHashingValueAllocator");
 
@@ -50,5 +53,142 @@ bool
 RefCountCacheHeader::compatible(RefCountCacheHeader *other) const
 {
   return (this->magic == other->magic && this->version._major == other->version._major &&
-          this->object_version._major == other->version._major);
+          this->object_version._major == other->object_version._major);
 };
+
+// Where the store header goes, after the cache header.
+static constexpr size_t REFCOUNTCACHE_STORE_HEADER_OFFSET = INK_ALIGN(sizeof(RefCountCacheHeader), 8);
+
+RefCountCacheStore::~RefCountCacheStore()
+{
+  if (this->base) {
+    munmap(this->base, this->length);
+  }
+}
+
+int
+RefCountCacheStore::open(const std::string &path, RefCountCacheHeader &header)
+{
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return -errno;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    int error = -errno;
+    ::close(fd);
+    return error;
+  }
+  if (static_cast<size_t>(st.st_size) < REFCOUNTCACHE_STORE_HEADER_OFFSET + sizeof(RefCountCacheStoreHeader)) {
+    ::close(fd);
+    return -EINVAL;
+  }
+  void *addr = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  // The mapping keeps the file, even once a sync renames a new one over it.
+  ::close(fd);
+  if (addr == MAP_FAILED) {
+    return -errno;
+  }
+  this->base   = static_cast<char *>(addr);
+  this->length = st.st_size;
+
+  RefCountCacheHeader *h = reinterpret_cast<RefCountCacheHeader *>(this->base);
+  if (!header.compatible(h)) {
+    return -EINVAL;
+  }
+  const RefCountCacheStoreHeader *sh = reinterpret_cast<RefCountCacheStoreHeader *>(this->base + REFCOUNTCACHE_STORE_HEADER_OFFSET);
+  uint64_t data_start                = REFCOUNTCACHE_STORE_HEADER_OFFSET + sizeof(RefCountCacheStoreHeader);
+  if (sh->entry_offset < data_start || sh->entry_offset > this->length ||
+      sh->count > (this->length - sh->entry_offset) / sizeof(RefCountCacheStoreEntry)) {
+    return -EINVAL;
+  }
+  this->entries = reinterpret_cast<const RefCountCacheStoreEntry *>(this->base + sh->entry_offset);
+  // Only the entries are checked, the items are not touched until they are looked up.
+  for (size_t i = 0; i < sh->count; i++) {
+    const RefCountCacheStoreEntry &e = this->entries[i];
+    if (e.offset < data_start || e.offset > sh->entry_offset || e.size > sh->entry_offset - e.offset ||
+        (i > 0 && e.key <= this->entries[i - 1].key)) {
+      this->entries = nullptr;
+      return -EINVAL;
+    }
+  }
+  this->nentries = sh->count;
+  this->claims.assign(this->nentries, 0);
+  ats_madvise(this->base, this->length, MADV_RANDOM);
+  return 0;
+}
+
+int64_t
+RefCountCacheStore::find(uint64_t key) const
+{
+  const RefCountCacheStoreEntry *end = this->entries + this->nentries;
+  const RefCountCacheStoreEntry *e =
+    std::lower_bound(this->entries, end, key, [](const RefCountCacheStoreEntry &a, uint64_t k) { return a.key < k; });
+  return (e != end && e->key == key) ? e - this->entries : -1;
+}
+
+int
+RefCountCacheStoreWriter::start(int fd, const RefCountCacheHeader &header)
+{
+  static const char zero[REFCOUNTCACHE_STORE_HEADER_OFFSET + sizeof(RefCountCacheStoreHeader)] = {0};
+
+  this->fd     = fd;
+  this->offset = 0;
+  this->entries.clear();
+  // The store header is written for real by finish, until then the file has no entries.
+  int ret = this->write(&header, sizeof(header));
+  if (ret == 0) {
+    ret = this->write(zero, sizeof(zero) - sizeof(header));
+  }
+  return ret;
+}
+
+int
+RefCountCacheStoreWriter::append(uint64_t key, const void *data, uint32_t size, ink_time_t expiry_time)
+{
+  static const char zero[8] = {0};
+
+  RefCountCacheStoreEntry e = {key, this->offset, size, 0, static_cast<int64_t>(expiry_time)};
+  int ret                   = this->write(data, size);
+  if (ret == 0 && size % 8) {
+    ret = this->write(zero, 8 - size % 8);
+  }
+  if (ret == 0) {
+    this->entries.push_back(e);
+  }
+  return ret;
+}
+
+int
+RefCountCacheStoreWriter::finish()
+{
+  std::sort(this->entries.begin(), this->entries.end(),
+            [](const RefCountCacheStoreEntry &a, const RefCountCacheStoreEntry &b) { return a.key < b.key; });
+  // Keys are unique already, RefCountCacheStore::open insists on it so make sure.
+  this->entries.erase(std::unique(this->entries.begin(), this->entries.end(),
+                                  [](const RefCountCacheStoreEntry &a, const RefCountCacheStoreEntry &b) { return a.key == b.key; }),
+                      this->entries.end());
+
+  RefCountCacheStoreHeader sh = {this->entries.size(), this->offset};
+  int ret                     = this->write(this->entries.data(), this->entries.size() * sizeof(RefCountCacheStoreEntry));
+  if (ret == 0) {
+    int64_t n = socketManager.pwrite(this->fd, &sh, sizeof(sh), REFCOUNTCACHE_STORE_HEADER_OFFSET);
+    ret       = n < 0 ? n : (n == sizeof(sh) ? 0 : -EIO);
+  }
+  return ret;
+}
+
+int
+RefCountCacheStoreWriter::write(const void *data, size_t n_bytes)
+{
+  size_t written = 0;
+  while (written < n_bytes) {
+    int ret = socketManager.write(this->fd, (char *)data + written, std::min<size_t>(n_bytes - written, INT_MAX));
+    if (ret <= 0) {
+      return ret < 0 ? ret : -EIO;
+    }
+    written += ret;
+  }
+  this->offset += written;
+  return 0;
+}
@@ -75,8 +75,9 @@ public:
     ExampleStruct *ret = ExampleStruct::alloc(size - sizeof(ExampleStruct));
     memcpy((void *)ret, buf, size);
     // Reset the refcount back to 0, this is a bit ugly-- but I'm not sure we want to expose a method
-    // to mess with the refcount, since this is a fairly unique use case
-    ret = new (ret) ExampleStruct();
+    // to mess with the refcount, since this is a fairly unique use case. Default initialized, like
+    // HostDBInfo, so the copied members are kept.
+    ret = new (ret) ExampleStruct;
     return ret;
   }
 };
@@ -197,6 +198,157 @@ testclear()
   return ret;
 }
 
+int
+testTrim()
+{
+  int ret = 0;
+
+  RefCountCache<ExampleStruct> *cache              = new RefCountCache<ExampleStruct>(1);
+  RefCountCachePartition<ExampleStruct> &partition = cache->get_partition(0);
+  ink_time_t now                                   = ink_time();
+
+  // Items that expire later are kept longer, those that never expire are never trimmed.
+  for (int i = 0; i < 10; i++) {
+    ExampleStruct *item = ExampleStruct::alloc();
+    item->idx           = i;
+    cache->put(i, item, 0, now + 100 + i);
+  }
+  ExampleStruct *forever = ExampleStruct::alloc();
+  forever->idx           = 10;
+  cache->put(10, forever);
+
+  ret |= partition.trim(5) != 6;
+  ret |= cache->count() != 5;
+  ret |= cache->get(5).get() != nullptr;
+  ret |= cache->get(6).get() == nullptr;
+  ret |= partition.trim(0) != 4;
+  ret |= cache->get(10).get() == nullptr;
+
+  delete cache;
+
+  return ret;
+}
+
+int
+testIndex()
+{
+  int ret = 0;
+
+  RefCountCache<ExampleStruct> *cache = new RefCountCache<ExampleStruct>(4);
+  // No grace period, every retired node is freed by the next change to its partition.
+  cache->enable_index(0);
+
+  ExampleStruct *item = ExampleStruct::alloc();
+  item->idx           = 1;
+  cache->put(1, item);
+  // Not visible until it is published
+  ret |= cache->get_lockfree(1).get() != nullptr;
+  cache->publish(1);
+  ret |= cache->get_lockfree(1).get() != item;
+  ret |= item->refcount() != 2;
+
+  // A replacement is visible once published, the old item is released on the next change
+  ExampleStruct *replacement = ExampleStruct::alloc();
+  replacement->idx           = 2;
+  cache->put(1, replacement);
+  cache->publish(1);
+  ret |= cache->get_lockfree(1).get() != replacement;
+  cache->put(5, ExampleStruct::alloc()); // same partition
+  ret |= item->refcount() != 0;
+  printf("index replace ret=%d\n", ret);
+
+  // Enough keys to resize every partition table a few times
+  int numTestEntries = 2000;
+  fillCache(cache, 100, 100 + numTestEntries);
+  for (int i = 100; i < 100 + numTestEntries; i++) {
+    cache->publish(i);
+  }
+  for (int i = 100; i < 100 + numTestEntries; i++) {
+    Ptr<ExampleStruct> p = cache->get_lockfree(i);
+    if (!p || p->idx != i) {
+      ret |= 1;
+    }
+  }
+  for (int i = 100; i < 100 + numTestEntries; i += 2) {
+    cache->erase(i);
+  }
+  for (int i = 100; i < 100 + numTestEntries; i++) {
+    ret |= (cache->get_lockfree(i).get() == nullptr) != (i % 2 == 0);
+  }
+  printf("index fill ret=%d\n", ret);
+
+  cache->clear();
+  ret |= cache->get_lockfree(101).get() != nullptr;
+  ret |= cache->get_lockfree(1).get() != nullptr;
+
+  delete cache;
+  return ret;
+}
+
+int
+testStore()
+{
+  int ret          = 0;
+  std::string path = "/tmp/test_RefCountCache.store";
+
+  RefCountCache<ExampleStruct> *cache = new RefCountCache<ExampleStruct>(4);
+  int numTestEntries                  = 1000;
+  fillCache(cache, 0, numTestEntries);
+
+  // Written the way RefCountCacheSerializer does, in partition order.
+  int fd = open(path.c_str(), O_TRUNC | O_RDWR | O_CREAT, 0644);
+  RefCountCacheStoreWriter writer;
+  ret |= writer.start(fd, cache->get_header()) != 0;
+  for (unsigned int p = 0; p < cache->partition_count(); p++) {
+    std::vector<RefCountCacheHashEntry *> items;
+    cache->get_partition(p).copy(items);
+    for (auto entry : items) {
+      ret |= writer.append(entry->meta.key, entry->item.get(), entry->meta.size, entry->meta.expiry_time) != 0;
+      RefCountCacheHashEntry::free<ExampleStruct>(entry);
+    }
+  }
+  ret |= writer.finish() != 0;
+  close(fd);
+  delete cache;
+  printf("store write ret=%d\n", ret);
+
+  // Nothing is loaded until it is looked up
+  cache = new RefCountCache<ExampleStruct>(4);
+  ret |= cache->attach_store(path, ExampleStruct::unmarshall) != 0;
+  ret |= cache->get_store()->count() != static_cast<size_t>(numTestEntries);
+  ret |= cache->count() != 0;
+  ret |= verifyCache(cache, 0, numTestEntries);
+  ret |= cache->get(7).get() == nullptr;
+  ret |= cache->get(numTestEntries).get() != nullptr;
+  ret |= cache->count() != static_cast<size_t>(numTestEntries);
+  printf("store load ret=%d\n", ret);
+
+  // An erased or replaced key is not loaded again, and only unclaimed entries are left for the next sync
+  cache->clear();
+  ret |= cache->attach_store(path, ExampleStruct::unmarshall) != 0;
+  cache->erase(1);
+  cache->put(2, ExampleStruct::alloc());
+  ret |= cache->get(1).get() != nullptr;
+  ret |= cache->get(2)->idx == 2;
+  std::vector<const RefCountCacheStoreEntry *> left;
+  for (unsigned int p = 0; p < cache->partition_count(); p++) {
+    cache->copy_stored(p, left);
+  }
+  ret |= left.size() != static_cast<size_t>(numTestEntries - 2);
+  printf("store claim ret=%d\n", ret);
+  delete cache;
+
+  // Loading everything up front reads the same file
+  cache = new RefCountCache<ExampleStruct>(4);
+  ret |= LoadRefCountCacheFromPath<ExampleStruct>(*cache, "/tmp", path, ExampleStruct::unmarshall) != 0;
+  ret |= cache->count() != static_cast<size_t>(numTestEntries);
+  ret |= verifyCache(cache, 0, numTestEntries);
+  delete cache;
+
+  unlink(path.c_str());
+  return ret;
+}
+
 int
 test()
 {
@@ -215,6 +367,18 @@ test()
   ret |= testRefcounting();
   printf("refcount ret %d\n", ret);
 
+  printf("Testing trim\n");
+  ret |= testTrim();
+  printf("trim ret %d\n", ret);
+
+  printf("Testing the lock free index\n");
+  ret |= testIndex();
+  printf("index ret %d\n", ret);
+
+  printf("Testing the store\n");
+  ret |= testStore();
+  printf("store ret %d\n", ret);
+
   // Initialize our cache
   int cachePartitions                 = 4;
   RefCountCache<ExampleStruct> *cache = new RefCountCache<ExampleStruct>(cachePartitions);
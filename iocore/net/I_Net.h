@@ -79,6 +79,7 @@ extern std::string_view net_ccp_out;
 #define NET_EVENT_DATAGRAM_ERROR (NET_EVENT_EVENTS_START + 12)
 #define NET_EVENT_ACCEPT_INTERNAL (NET_EVENT_EVENTS_START + 22)
 #define NET_EVENT_CONNECT_INTERNAL (NET_EVENT_EVENTS_START + 23)
+#define NET_EVENT_MIGRATE (NET_EVENT_EVENTS_START + 24)
 
 #define MAIN_ACCEPT_PORT -1
 
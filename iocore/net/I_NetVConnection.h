@@ -326,6 +326,24 @@ struct NetVCOptions {
   NetVCOptions(const NetVCOptions &) = delete;
 };
 
+/// What the kernel knows of the TCP state of a connection, see NetVConnection::sample_tcp_info().
+struct NetVCTcpInfo {
+  uint32_t rtt_us        = 0; ///< Smoothed round trip time, in microseconds.
+  uint32_t rttvar_us     = 0; ///< Round trip time variance, in microseconds.
+  uint32_t cwnd          = 0; ///< Send congestion window, in segments.
+  uint32_t mss           = 0; ///< Send maximum segment size, in bytes.
+  uint32_t retransmits   = 0; ///< Segments retransmitted over the life of the connection.
+  uint64_t delivery_rate = 0; ///< Bytes per second, estimated from the window where the kernel does not tell.
+  bool valid             = false;
+
+  /// The bytes the connection can have in flight, the bandwidth delay product.
+  uint64_t
+  bdp() const
+  {
+    return static_cast<uint64_t>(cwnd) * mss;
+  }
+};
+
 /**
   A VConnection for a network socket. Abstraction for a net connection.
   Similar to a socket descriptor VConnections are IO handles to
@@ -345,6 +363,29 @@ public:
     return -1;
   };
 
+  // Fill in @a info from the kernel and return true, false where the platform or the
+  // connection (not TCP, or closed) does not have it. This is a system call.
+  virtual bool
+  sample_tcp_info(NetVCTcpInfo &info)
+  {
+    return false;
+  }
+
+  // Limit the writes to @a rate bytes per second, 0 for no limit, and to the share of the pacing
+  // group named @a group, none if empty. See proxy.config.net.pacing.groups.
+  virtual void
+  set_pacing(int64_t rate, std::string_view group)
+  {
+  }
+
+  // While idle in the keep-alive queue, the NetHandler may offer to move the connection to a less
+  // loaded thread by sending @a cont NET_EVENT_MIGRATE with that thread. @a cont returns EVENT_DONE
+  // if it takes it up, see proxy.config.net.keep_alive_migration. nullptr to opt out.
+  virtual void
+  set_migration_cont(Continuation *cont)
+  {
+  }
+
   /**
      Initiates read. Thread safe, may be called when not handling
      an event from the NetVConnection, or the NetVConnection creation
@@ -596,6 +637,28 @@ public:
    */
   virtual void trapWriteBufferEmpty(int event = VC_EVENT_WRITE_READY);
 
+  /** Move the data of the current read straight to the current write of @a target.
+
+      From now on the data read goes through a kernel pipe with @c splice instead of the read
+      buffer. Data already in the write buffer of @a target is written first. Both VIOs keep
+      counting the bytes moved and send their usual events. The next @c do_io_read of this
+      connection or @c do_io_write of @a target ends it.
+
+      @return @c true if the data is spliced, @c false if it is not possible for this pair.
+   */
+  virtual bool
+  splice_to(NetVConnection * /* target ATS_UNUSED */)
+  {
+    return false;
+  }
+
+  /// Bytes moved to this connection by @c splice_to that it has not written yet.
+  virtual int64_t
+  splice_pending() const
+  {
+    return 0;
+  }
+
   /** Returns local sockaddr storage. */
   sockaddr const *get_local_addr();
 
@@ -881,11 +944,40 @@ public:
     return ats_ip_port_host_order(this->get_proxy_protocol_addr(ProxyProtocolData::DST));
   };
 
+  /// The ALPN protocol the client negotiated with the proxy in front, from a version 2 header.
+  std::string_view
+  get_proxy_protocol_alpn() const
+  {
+    return {pp_info.alpn, pp_info.alpn_len};
+  }
+
+  /// The host name the client asked the proxy in front for (its SNI), from a version 2 header.
+  std::string_view
+  get_proxy_protocol_authority() const
+  {
+    return {pp_info.authority, pp_info.authority_len};
+  }
+
+  /// The TLS version the client connected to the proxy in front with, from a version 2 header.
+  std::string_view
+  get_proxy_protocol_ssl_version() const
+  {
+    return {pp_info.ssl_version, pp_info.ssl_version_len};
+  }
+
   struct ProxyProtocol {
     ProxyProtocolVersion proxy_protocol_version = ProxyProtocolVersion::UNDEFINED;
     uint16_t ip_family;
     IpEndpoint src_addr;
     IpEndpoint dst_addr;
+    // The TLVs of a version 2 header that are kept, empty if it did not have them or they do not fit.
+    bool ssl                = false; ///< The client connected to the proxy in front over TLS.
+    uint8_t alpn_len        = 0;
+    uint8_t authority_len   = 0;
+    uint8_t ssl_version_len = 0;
+    char alpn[32];
+    char authority[255];
+    char ssl_version[32];
   };
 
   ProxyProtocol pp_info;
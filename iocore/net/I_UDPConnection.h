@@ -96,8 +96,10 @@ public:
      Required for  and UDPNetProcessor::CreateUDPSocket.  They  don't do
      bindToThread() automatically so that the sockets can be passed to
      other Continuations.
+
+     @a t is the ET_UDP thread to use, one is assigned if it is null.
   */
-  void bindToThread(Continuation *c);
+  void bindToThread(Continuation *c, EThread *t = nullptr);
 
   virtual void UDPConnection_is_abstract() = 0;
 };
@@ -30,6 +30,7 @@
 
 #include "P_Net.h"
 #include <utility>
+#include <algorithm>
 
 RecRawStatBlock *net_rsb = nullptr;
 
@@ -40,10 +41,31 @@ int net_accept_period       = 10;
 int net_retry_delay         = 10;
 int net_throttle_delay      = 50; /* milliseconds */
 
+int net_config_poll_max_events       = POLL_DESCRIPTOR_SIZE;
+int net_config_poll_busy_spin        = 0; // microseconds, 0 disables busy polling
+int net_config_poll_busy_threshold   = 1;
+int net_config_zerocopy_threshold    = 0; // bytes, 0 disables MSG_ZEROCOPY
+int net_config_splice                = 0;
+int net_config_read_buffer_adaptive  = 0;
+int net_config_read_buffer_max_index = BUFFER_SIZE_INDEX_32K;
+int net_config_memory_accept_rate    = 0; // connections per second under hard memory pressure, 0 for no cap
+int net_config_load_aware_accept     = 0;
+int net_config_keep_alive_migration  = 0;
+int net_config_thread_load_gap       = 20; // percent of a CPU
+int net_config_idle_buffer_release   = 0;  // msec in the keep-alive queue, 0 to keep the buffers
+
 // For the in/out congestion control: ToDo: this probably would be better as ports: specifications
 std::string_view net_ccp_in;
 std::string_view net_ccp_out;
 
+static int
+change_net_pacing_groups(const char * /* name ATS_UNUSED */, RecDataT /* data_type ATS_UNUSED */, RecData data,
+                         void * /* cookie ATS_UNUSED */)
+{
+  NetPacingGroup::configure(data.rec_string);
+  return REC_ERR_OKAY;
+}
+
 static inline void
 configure_net()
 {
@@ -52,11 +74,32 @@ configure_net()
 
   REC_EstablishStaticConfigInt32(net_retry_delay, "proxy.config.net.retry_delay");
   REC_EstablishStaticConfigInt32(net_throttle_delay, "proxy.config.net.throttle_delay");
+  REC_EstablishStaticConfigInt32(net_config_zerocopy_threshold, "proxy.config.net.sock_zerocopy_threshold");
+  REC_EstablishStaticConfigInt32(net_config_splice, "proxy.config.net.splice");
+  REC_EstablishStaticConfigInt32(net_config_read_buffer_adaptive, "proxy.config.net.read_buffer_adaptive");
+  REC_EstablishStaticConfigInt32(net_config_read_buffer_max_index, "proxy.config.net.read_buffer_max_size_index");
+  REC_EstablishStaticConfigInteger(net_config_pacing_total_rate, "proxy.config.net.pacing.total_rate");
+  REC_EstablishStaticConfigInt32(net_config_memory_accept_rate, "proxy.config.memory.governor.accept_rate");
+  REC_EstablishStaticConfigInt32(net_config_load_aware_accept, "proxy.config.net.load_aware_accept");
+  REC_EstablishStaticConfigInt32(net_config_keep_alive_migration, "proxy.config.net.keep_alive_migration");
+  REC_EstablishStaticConfigInt32(net_config_thread_load_gap, "proxy.config.net.thread_load_gap");
+  REC_EstablishStaticConfigInt32(net_config_idle_buffer_release, "proxy.config.net.idle_buffer_release");
+
+  REC_RegisterConfigUpdateFunc("proxy.config.net.pacing.groups", change_net_pacing_groups, nullptr);
+  RecString groups = nullptr;
+  REC_ReadConfigStringAlloc(groups, "proxy.config.net.pacing.groups");
+  NetPacingGroup::configure(groups);
+  ats_free(groups);
 
   // These are not reloadable
   REC_ReadConfigInteger(net_event_period, "proxy.config.net.event_period");
   REC_ReadConfigInteger(net_accept_period, "proxy.config.net.accept_period");
 
+  REC_ReadConfigInteger(net_config_poll_max_events, "proxy.config.net.poll_max_events");
+  net_config_poll_max_events = std::clamp(net_config_poll_max_events, 1, POLL_DESCRIPTOR_SIZE);
+  REC_ReadConfigInteger(net_config_poll_busy_spin, "proxy.config.net.poll_busy_spin");
+  REC_ReadConfigInteger(net_config_poll_busy_threshold, "proxy.config.net.poll_busy_threshold");
+
   // This is kinda fugly, but better than it was before (on every connection in and out)
   // Note that these would need to be ats_free()'d if we ever want to clean that up, but
   // we have no good way of dealing with that on such globals I think?
@@ -91,8 +134,26 @@ register_net_stats()
     {"proxy.process.net.calls_to_writetonet_afterpoll", net_calls_to_writetonet_afterpoll_stat},
     {"proxy.process.net.inactivity_cop_lock_acquire_failure", inactivity_cop_lock_acquire_failure_stat},
     {"proxy.process.net.net_handler_run", net_handler_run_stat},
+    {"proxy.process.net.poll_events", net_poll_events_stat},
+    {"proxy.process.net.busy_poll_hits", net_busy_poll_hits_stat},
+    {"proxy.process.net.zerocopy.writes", net_zerocopy_writes_stat},
+    {"proxy.process.net.zerocopy.bytes", net_zerocopy_bytes_stat},
+    {"proxy.process.net.zerocopy.copied", net_zerocopy_copied_stat},
+    {"proxy.process.net.splice.tunnels", net_splice_tunnels_stat},
+    {"proxy.process.net.splice.bytes", net_splice_bytes_stat},
+    {"proxy.process.udp.recv_calls", net_udp_recv_calls_stat},
+    {"proxy.process.udp.recv_datagrams", net_udp_recv_datagrams_stat},
+    {"proxy.process.udp.send_calls", net_udp_send_calls_stat},
+    {"proxy.process.udp.send_datagrams", net_udp_send_datagrams_stat},
     {"proxy.process.net.read_bytes", net_read_bytes_stat},
     {"proxy.process.net.write_bytes", net_write_bytes_stat},
+    {"proxy.process.net.read_buffer.grows", net_read_buffer_grows_stat},
+    {"proxy.process.net.read_buffer.shrinks", net_read_buffer_shrinks_stat},
+    {"proxy.process.net.pacing.waits", net_pacing_waits_stat},
+    {"proxy.process.net.connections_memory_capped_in", net_connections_memory_capped_in_stat},
+    {"proxy.process.net.keep_alive_migrations", net_keep_alive_migrations_stat},
+    {"proxy.process.net.idle_buffers_released", net_idle_buffers_released_stat},
+    {"proxy.process.net.idle_buffer_bytes_released", net_idle_buffer_bytes_released_stat},
     {"proxy.process.net.fastopen_out.attempts", net_fastopen_attempts_stat},
     {"proxy.process.net.fastopen_out.successes", net_fastopen_successes_stat},
     {"proxy.process.socks.connections_successful", socks_connections_successful_stat},
@@ -102,6 +163,8 @@ register_net_stats()
   const std::pair<const char *, Net_Stats> non_persistent[] = {
     {"proxy.process.net.accepts_currently_open", net_accepts_currently_open_stat},
     {"proxy.process.net.connections_currently_open", net_connections_currently_open_stat},
+    {"proxy.process.net.keep_alive_buffer_bytes", net_keep_alive_buffer_bytes_stat},
+    {"proxy.process.net.keep_alive_connections", net_keep_alive_connections_stat},
     {"proxy.process.net.default_inactivity_timeout_applied", default_inactivity_timeout_applied_stat},
     {"proxy.process.net.default_inactivity_timeout_count", default_inactivity_timeout_count_stat},
     {"proxy.process.net.dynamic_keep_alive_timeout_in_count", keep_alive_queue_timeout_count_stat},
@@ -117,8 +180,23 @@ register_net_stats()
     RecRegisterRawStat(net_rsb, RECT_PROCESS, p.first, RECD_INT, RECP_NON_PERSISTENT, p.second, RecRawStatSyncSum);
   }
 
+  // The bytes read into blocks of each size, to tell which default buffer sizes fit the traffic.
+  static_assert(net_read_buffer_bytes_last_stat - net_read_buffer_bytes_stat + 1 == DEFAULT_BUFFER_SIZES,
+                "one read buffer stat per block size index");
+  const char *const read_buffer_sizes[DEFAULT_BUFFER_SIZES] = {"128", "256", "512", "1k",   "2k",   "4k",   "8k", "16k",
+                                                               "32k", "64k", "128k", "256k", "512k", "1m", "2m"};
+  for (int i = 0; i < DEFAULT_BUFFER_SIZES; ++i) {
+    char name[64];
+    snprintf(name, sizeof(name), "proxy.process.net.read_buffer.%s.bytes", read_buffer_sizes[i]);
+    RecRegisterRawStat(net_rsb, RECT_PROCESS, name, RECD_INT, RECP_PERSISTENT, net_read_buffer_bytes_stat + i, RecRawStatSyncSum);
+  }
+
   NET_CLEAR_DYN_STAT(net_handler_run_stat);
+  NET_CLEAR_DYN_STAT(net_poll_events_stat);
+  NET_CLEAR_DYN_STAT(net_busy_poll_hits_stat);
   NET_CLEAR_DYN_STAT(net_connections_currently_open_stat);
+  NET_CLEAR_DYN_STAT(net_keep_alive_buffer_bytes_stat);
+  NET_CLEAR_DYN_STAT(net_keep_alive_connections_stat);
   NET_CLEAR_DYN_STAT(net_accepts_currently_open_stat);
   NET_CLEAR_DYN_STAT(net_calls_to_readfromnet_stat);
   NET_CLEAR_DYN_STAT(net_calls_to_readfromnet_afterpoll_stat);
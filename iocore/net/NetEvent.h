@@ -24,6 +24,7 @@
 #pragma once
 
 #include "I_EventSystem.h"
+#include "P_NetPacing.h"
 
 class NetHandler;
 
@@ -60,6 +61,19 @@ public:
   virtual Ptr<ProxyMutex> &get_mutex()   = 0;
   virtual ContFlags &get_control_flags() = 0;
 
+  /// The size of the buffers of the connection while it is idle, see NetHandler::release_idle_buffers.
+  virtual int64_t
+  idle_buffer_bytes()
+  {
+    return 0;
+  }
+  /// Free the buffers that have nothing in them, returning their size. They are allocated again on demand.
+  virtual int64_t
+  release_idle_buffers()
+  {
+    return 0;
+  }
+
   EventIO ep{};
   NetState read{};
   NetState write{};
@@ -75,14 +89,34 @@ public:
 
   bool default_inactivity_timeout = false;
 
+  /// When and where this is due in @c NetHandler::cop_wheel.
+  ink_hrtime cop_wheel_at = 0;
+  uint16_t cop_wheel_slot = 0;
+
+  /// Write pacing, see @c NetPacer.
+  NetTokenBucket pacing_bucket;
+  NetPacingGroup *pacing_group = nullptr;
+  int64_t pacing_grant         = 0; ///< Bytes the @c NetPacer let this write.
+  bool pacing_waiting          = false;
+
+  /// Offered the moves to less loaded threads while in the keep-alive queue, if any.
+  Continuation *migrate_cont = nullptr;
+
+  /// While in the keep-alive queue, since when and the size of its buffers.
+  ink_hrtime keep_alive_at        = 0;
+  int64_t keep_alive_buffer_bytes = 0;
+  bool idle_buffers_released      = false;
+
   LINK(NetEvent, open_link);
   LINK(NetEvent, cop_link);
+  LINK(NetEvent, cop_wheel_link);
   LINKM(NetEvent, read, ready_link)
   SLINKM(NetEvent, read, enable_link)
   LINKM(NetEvent, write, ready_link)
   SLINKM(NetEvent, write, enable_link)
   LINK(NetEvent, keep_alive_queue_link);
   LINK(NetEvent, active_queue_link);
+  LINK(NetEvent, pacing_link);
 
   union {
     unsigned int flags = 0;
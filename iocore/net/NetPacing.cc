@@ -0,0 +1,249 @@
+/** @file
+
+  Rate limits for the writes of connections, see P_NetPacing.h
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "P_Net.h"
+#include "tscpp/util/TextView.h"
+
+#include <map>
+
+int64_t net_config_pacing_total_rate = 0; // bytes per second, 0 for no limit
+
+namespace
+{
+std::mutex pacing_groups_mutex;
+std::map<std::string, NetPacingGroup *, std::less<>> pacing_groups;
+} // namespace
+
+NetPacingGroup *
+NetPacingGroup::find(std::string_view name)
+{
+  std::lock_guard<std::mutex> lock(pacing_groups_mutex);
+  auto spot = pacing_groups.find(name);
+  return spot == pacing_groups.end() ? nullptr : spot->second;
+}
+
+void
+NetPacingGroup::configure(const char *spec)
+{
+  ts::TextView text{spec, spec ? strlen(spec) : 0};
+  auto is_sep{[](char c) { return isspace(c) || ',' == c || ';' == c; }};
+  std::lock_guard<std::mutex> lock(pacing_groups_mutex);
+
+  // A group left out of the new list no longer has a limit.
+  for (auto &spot : pacing_groups) {
+    spot.second->set_rate(0);
+    spot.second->weight = 1;
+  }
+
+  while (!text.ltrim_if(is_sep).empty()) {
+    ts::TextView token{text.take_prefix_if(is_sep)};
+    ts::TextView spec_token{token};
+    ts::TextView name{token.take_prefix_at(':')};
+    ts::TextView rate_text{token.take_prefix_at(':')};
+    ts::TextView parsed;
+    int64_t rate   = ts::svtoi(rate_text, &parsed);
+    int64_t weight = 1;
+
+    if (name.empty() || rate_text.empty() || parsed.size() != rate_text.size() || rate < 0) {
+      Warning("invalid pacing group '%.*s' in proxy.config.net.pacing.groups", static_cast<int>(spec_token.size()),
+              spec_token.data());
+      continue;
+    }
+    if (!token.empty()) {
+      weight = ts::svtoi(token, &parsed);
+      if (parsed.size() != token.size() || weight < 1) {
+        Warning("invalid weight of pacing group '%.*s' in proxy.config.net.pacing.groups", static_cast<int>(spec_token.size()),
+                spec_token.data());
+        continue;
+      }
+    }
+
+    auto spot = pacing_groups.find(name);
+    if (spot == pacing_groups.end()) {
+      NetPacingGroup *group = new NetPacingGroup;
+      group->name.assign(name.data(), name.size());
+      spot = pacing_groups.emplace(group->name, group).first;
+    }
+    spot->second->set_rate(rate);
+    spot->second->weight = static_cast<int>(weight);
+    Debug("net_pacing", "group %s: %" PRId64 " bytes per second, weight %" PRId64, spot->first.c_str(), rate, weight);
+  }
+}
+
+bool
+NetPacer::paced(NetEvent *ne) const
+{
+  return ne->pacing_bucket.limited() || ne->pacing_group != nullptr || net_config_pacing_total_rate > 0;
+}
+
+NetPacer::Flow &
+NetPacer::flow(NetPacingGroup *group)
+{
+  for (auto &f : _flows) {
+    if (f.group == group) {
+      return f;
+    }
+  }
+  _flows.emplace_back();
+  _flows.back().group = group;
+  return _flows.back();
+}
+
+int64_t
+NetPacer::take(NetEvent *ne, int64_t want, ink_hrtime now)
+{
+  int64_t share = net_config_pacing_total_rate / std::max(1, eventProcessor.thread_group[ET_NET]._count);
+  if (_thread_bucket.rate != share) {
+    _thread_bucket.set_rate(share);
+  }
+
+  // What the buckets of this thread allow is taken from the group, which the other threads share,
+  // and then from them.
+  int64_t n = want;
+  if (ne->pacing_bucket.limited()) {
+    ne->pacing_bucket.refill(now);
+    n = std::min(n, ne->pacing_bucket.tokens);
+  }
+  if (_thread_bucket.limited()) {
+    _thread_bucket.refill(now);
+    n = std::min(n, _thread_bucket.tokens);
+  }
+  if (n > 0 && ne->pacing_group) {
+    n = ne->pacing_group->take(n, now);
+  }
+  if (n <= 0) {
+    return 0;
+  }
+  ne->pacing_bucket.take(n, now);
+  _thread_bucket.take(n, now);
+  return n;
+}
+
+ink_hrtime
+NetPacer::ready_at(NetEvent *ne, ink_hrtime now)
+{
+  ink_hrtime at = std::max(ne->pacing_bucket.ready_at(NET_PACING_QUANTUM, now), _thread_bucket.ready_at(NET_PACING_QUANTUM, now));
+  if (ne->pacing_group) {
+    at = std::max(at, ne->pacing_group->ready_at(NET_PACING_QUANTUM, now));
+  }
+  return std::max(at, now + NET_PACING_MIN_WAIT);
+}
+
+int64_t
+NetPacer::admit(NetEvent *ne, int64_t towrite, ink_hrtime now)
+{
+  if (ne->pacing_grant > 0) {
+    return std::min(towrite, ne->pacing_grant);
+  }
+  if (!paced(ne)) {
+    return towrite;
+  }
+  if (ne->pacing_waiting) {
+    return 0;
+  }
+
+  // The connections already waiting go first, those of other groups too when they share the
+  // rate of the thread.
+  Flow &f = flow(ne->pacing_group);
+  if (f.waiting.empty() && (next_release == 0 || !_thread_bucket.limited())) {
+    if (int64_t n = take(ne, towrite, now); n > 0) {
+      ne->pacing_grant = n;
+      return n;
+    }
+  }
+  f.waiting.enqueue(ne);
+  ne->pacing_waiting = true;
+
+  ink_hrtime at = ready_at(ne, now);
+  if (next_release == 0 || at < next_release) {
+    next_release = at;
+  }
+  return 0;
+}
+
+void
+NetPacer::release(NetHandler *nh, ink_hrtime now)
+{
+  if (next_release == 0 || now < next_release) {
+    return;
+  }
+  next_release = 0;
+
+  for (size_t i = 0; i < _flows.size(); ++i) {
+    Flow &f = _flows[(_next_flow + i) % _flows.size()];
+    if (f.waiting.empty()) {
+      continue;
+    }
+    int64_t quantum = NET_PACING_QUANTUM * (f.group ? f.group->weight.load(std::memory_order_relaxed) : 1);
+    // A flow held back by the rate of its group does not save up more than a round.
+    f.deficit = std::min(f.deficit + quantum, 2 * quantum);
+
+    // A connection out of tokens of its own keeps its place, the next ones may have some.
+    Que(NetEvent, pacing_link) blocked;
+    NetEvent *ne;
+    while (f.deficit > 0 && (ne = f.waiting.dequeue()) != nullptr) {
+      int64_t n = take(ne, f.deficit, now);
+      if (n <= 0) {
+        blocked.enqueue(ne);
+        // Nothing more for anyone when the group or the thread is out of tokens.
+        if (!ne->pacing_bucket.limited() || ne->pacing_bucket.tokens > 0) {
+          break;
+        }
+        continue;
+      }
+      f.deficit -= n;
+
+      ne->pacing_grant   = n;
+      ne->pacing_waiting = false;
+      if (ne->write.enabled && ne->write.triggered) {
+        nh->write_ready_list.in_or_enqueue(ne);
+      }
+    }
+    while ((ne = blocked.tail) != nullptr) {
+      blocked.remove(ne);
+      f.waiting.push(ne);
+    }
+
+    if (f.waiting.empty()) {
+      f.deficit = 0;
+    } else {
+      ink_hrtime at = ready_at(f.waiting.head, now);
+      if (next_release == 0 || at < next_release) {
+        next_release = at;
+      }
+    }
+  }
+  if (!_flows.empty()) {
+    _next_flow = (_next_flow + 1) % _flows.size();
+  }
+}
+
+void
+NetPacer::remove(NetEvent *ne)
+{
+  if (ne->pacing_waiting) {
+    flow(ne->pacing_group).waiting.remove(ne);
+    ne->pacing_waiting = false;
+  }
+  ne->pacing_grant = 0;
+}
@@ -489,7 +489,7 @@ ocsp_update()
   for (unsigned i = 0; i < ctxCount; i++) {
     SSLCertContext *cc = certLookup->get(i);
     if (cc) {
-      ctx = cc->getCtx();
+      ctx = cc->peekCtx();
       if (ctx) {
         certinfo *cinf    = nullptr;
         certinfo_map *map = stapling_get_cert_info(ctx.get());
@@ -33,8 +33,30 @@
 
 enum Net_Stats {
   net_handler_run_stat,
+  net_poll_events_stat,
+  net_busy_poll_hits_stat,
+  net_zerocopy_writes_stat,
+  net_zerocopy_bytes_stat,
+  net_zerocopy_copied_stat,
+  net_splice_tunnels_stat,
+  net_splice_bytes_stat,
+  net_udp_recv_calls_stat,
+  net_udp_recv_datagrams_stat,
+  net_udp_send_calls_stat,
+  net_udp_send_datagrams_stat,
   net_read_bytes_stat,
   net_write_bytes_stat,
+  net_read_buffer_grows_stat,
+  net_read_buffer_shrinks_stat,
+  net_pacing_waits_stat,
+  net_connections_memory_capped_in_stat,
+  net_keep_alive_migrations_stat,
+  net_idle_buffers_released_stat,
+  net_idle_buffer_bytes_released_stat,
+  net_keep_alive_buffer_bytes_stat,
+  net_keep_alive_connections_stat,
+  net_read_buffer_bytes_stat, // One per block size index, see register_net_stats()
+  net_read_buffer_bytes_last_stat = net_read_buffer_bytes_stat + 14,
   net_connections_currently_open_stat,
   net_accepts_currently_open_stat,
   net_calls_to_readfromnet_stat,
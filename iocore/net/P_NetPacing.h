@@ -0,0 +1,151 @@
+/** @file
+
+  Rate limits for the writes of connections
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  @section details Details
+
+  A connection may write at the rate of its own token bucket, that of the pacing group it is in,
+  see proxy.config.net.pacing.groups, and the share of its thread of
+  proxy.config.net.pacing.total_rate, whichever is the lowest. A connection out of tokens waits
+  in the NetPacer of its NetHandler, off the write ready list so that it does not spin the event
+  loop, until the NetPacer hands it more. The NetPacer serves the groups waiting on it by deficit
+  round robin, in proportion to their weights.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+#include "tscore/ink_hrtime.h"
+
+/// The bytes a group may write in each round of the NetPacer, times its weight.
+#define NET_PACING_QUANTUM (16 * 1024)
+/// The shortest wait of a connection out of tokens.
+#define NET_PACING_MIN_WAIT HRTIME_MSECONDS(1)
+
+extern int64_t net_config_pacing_total_rate;
+
+/// Bytes that may be written, refilled at @c rate bytes per second up to @c burst.
+struct NetTokenBucket {
+  int64_t rate    = 0; ///< Bytes per second, 0 for no limit.
+  int64_t burst   = 0;
+  int64_t tokens  = 0;
+  ink_hrtime last = 0;
+
+  bool
+  limited() const
+  {
+    return rate > 0;
+  }
+
+  /// Set the @a rate, the bucket holds a tenth of a second of it, and at least a quantum.
+  void
+  set_rate(int64_t r)
+  {
+    rate   = r;
+    burst  = std::max<int64_t>(r / 10, NET_PACING_QUANTUM);
+    tokens = std::min(tokens, burst);
+  }
+
+  void
+  refill(ink_hrtime now)
+  {
+    if (last == 0) {
+      tokens = burst; // starts full
+    }
+    if (tokens >= burst) {
+      last = now;
+      return;
+    }
+    // In microseconds so that 10 seconds of a rate of up to terabytes per second does not overflow.
+    int64_t add = ink_hrtime_to_usec(std::min<ink_hrtime>(now - last, HRTIME_SECONDS(10))) * rate / 1000000;
+    if (add > 0) {
+      tokens = std::min(burst, tokens + add);
+      last   = now;
+    }
+  }
+
+  /// Take up to @a want tokens, all of them if there is no limit.
+  int64_t
+  take(int64_t want, ink_hrtime now)
+  {
+    if (!limited()) {
+      return want;
+    }
+    refill(now);
+    int64_t n = std::min(want, std::max<int64_t>(tokens, 0));
+    tokens -= n;
+    return n;
+  }
+
+  /// When the bucket will have @a want tokens, or as many as it can hold.
+  ink_hrtime
+  ready_at(int64_t want, ink_hrtime now) const
+  {
+    want = std::min(want, burst);
+    if (!limited() || tokens >= want) {
+      return now;
+    }
+    return last + HRTIME_USECONDS((want - tokens) * 1000000 / rate + 1);
+  }
+};
+
+/// Connections sharing a rate. Groups are never freed, a configuration reload updates them.
+class NetPacingGroup
+{
+public:
+  /// The group named @a name, nullptr if there is none.
+  static NetPacingGroup *find(std::string_view name);
+  /// Create or update the groups from @a spec, a list of name:rate[:weight].
+  static void configure(const char *spec);
+
+  std::string name;
+  std::atomic<int> weight{1};
+
+  int64_t
+  take(int64_t want, ink_hrtime now)
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _bucket.take(want, now);
+  }
+
+  ink_hrtime
+  ready_at(int64_t want, ink_hrtime now)
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _bucket.ready_at(want, now);
+  }
+
+  void
+  set_rate(int64_t rate)
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _bucket.set_rate(rate);
+  }
+
+private:
+  std::mutex _mutex;
+  NetTokenBucket _bucket;
+};
@@ -69,6 +69,7 @@
 #include "quic/QUICPacketProtectionKeyInfo.h"
 #include "quic/QUICContext.h"
 #include "quic/QUICTokenCreator.h"
+#include "quic/QUICPacer.h"
 #include "quic/qlog/QLogListener.h"
 
 // Size of connection ids for debug log : e.g. aaaaaaaa-bbbbbbbb\0
@@ -269,6 +270,7 @@ private:
   QUICTokenCreator *_token_creator                  = nullptr;
 
   QUICFrameGeneratorManager _frame_generators;
+  QUICPacer _pacer{0};
 
   QUICPacketReceiveQueue _packet_recv_queue = {this->_packet_factory, this->_ph_protector};
 
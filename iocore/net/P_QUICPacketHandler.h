@@ -42,14 +42,21 @@ public:
   ~QUICPacketHandler();
 
   void send_packet(const QUICPacket &packet, QUICNetVConnection *vc, const QUICPacketHeaderProtector &pn_protector);
-  void send_packet(QUICNetVConnection *vc, Ptr<IOBufferBlock> udp_payload);
+  void send_packet(QUICNetVConnection *vc, Ptr<IOBufferBlock> udp_payload, ink_hrtime send_at = 0);
 
   void close_connection(QUICNetVConnection *conn);
 
+  /// The hint written into connection IDs this handler chooses, -1 for none.
+  virtual int
+  cid_thread_hint() const
+  {
+    return -1;
+  }
+
 protected:
   void _send_packet(const QUICPacket &packet, UDPConnection *udp_con, IpEndpoint &addr, uint32_t pmtu,
                     const QUICPacketHeaderProtector *ph_protector, int dcil);
-  void _send_packet(UDPConnection *udp_con, IpEndpoint &addr, Ptr<IOBufferBlock> udp_payload);
+  void _send_packet(UDPConnection *udp_con, IpEndpoint &addr, Ptr<IOBufferBlock> udp_payload, ink_hrtime send_at = 0);
   QUICConnection *_check_stateless_reset(const uint8_t *buf, size_t buf_len);
 
   // FIXME Remove this
@@ -80,12 +87,22 @@ public:
   virtual int acceptEvent(int event, void *e) override;
   void init_accept(EThread *t) override;
 
+  /*
+   * Packets come from socket @a index of the @a count sharing the port, each steered by the hint in the connection ID.
+   * New connections go to the ET_NET threads that match the index, so each socket feeds its own set of threads.
+   */
+  void set_steering(uint8_t index, uint8_t count);
+
+  // QUICPacketHandler
+  int cid_thread_hint() const override;
+
 protected:
   // QUICPacketHandler
   Continuation *_get_continuation() override;
 
 private:
   void _recv_packet(int event, UDPPacket *udp_packet) override;
+  EThread *_assign_thread();
   int _stateless_retry(const uint8_t *buf, uint64_t buf_len, UDPConnection *connection, IpEndpoint from, QUICConnectionId dcid,
                        QUICConnectionId scid, QUICConnectionId *original_cid);
   bool _send_stateless_reset(QUICConnectionId dcid, uint32_t instance_id, UDPConnection *udp_con, IpEndpoint &addr,
@@ -94,6 +111,14 @@ private:
                                  IpEndpoint from);
 
   QUICConnectionTable &_ctable;
+
+  uint8_t _steering_index = 0;
+  uint8_t _steering_count = 0; ///< Zero if this socket has the port to itself.
+  int _next_thread        = 0;
+
+  // CONNECTION_CLOSE frames for invalid tokens sent in the current second, each takes a handshake key setup
+  ink_hrtime _invalid_token_second = 0;
+  uint32_t _invalid_token_closes   = 0;
 };
 
 /*
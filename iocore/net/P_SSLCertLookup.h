@@ -23,6 +23,11 @@
 
 #pragma once
 
+#include <functional>
+#include <map>
+#include <string>
+#include <unordered_map>
+
 #include <openssl/ssl.h>
 
 #include "ProxyConfig.h"
@@ -89,9 +94,13 @@ using shared_ssl_ticket_key_block     = std::shared_ptr<ssl_ticket_key_block>;
 
 */
 struct SSLCertContext {
+  /// Builds the @c SSL_CTX of a context loaded on first use.
+  using CtxLoader = std::function<shared_SSL_CTX()>;
+
 private:
   mutable std::mutex ctx_mutex;
   shared_SSL_CTX ctx;
+  CtxLoader ctx_loader;
 
 public:
   SSLCertContext() : ctx_mutex(), ctx(nullptr), opt(SSLCertContextOption::OPT_NONE), userconfig(nullptr), keyblock(nullptr) {}
@@ -112,8 +121,13 @@ public:
   ~SSLCertContext() {}
 
   /// Threadsafe Functions to get and set shared SSL_CTX pointer
+  /// The first @c getCtx builds the @c SSL_CTX if there is a loader for it.
   shared_SSL_CTX getCtx();
+  /// The @c SSL_CTX if it is built, without building it.
+  shared_SSL_CTX peekCtx() const;
   void setCtx(shared_SSL_CTX sc);
+  /// Build the @c SSL_CTX with @a loader on the first @c getCtx instead of now.
+  void setCtxLoader(CtxLoader loader);
   void release();
 
   SSLCertContextOption opt                   = SSLCertContextOption::OPT_NONE; ///< Special handling option.
@@ -122,11 +136,23 @@ public:
 };
 
 struct SSLCertLookup : public ConfigInfo {
+  /** The contexts built for a line of ssl_multicert.config. The next load of the file takes them
+      over if the line and the files it names did not change, rather than building them again.
+  */
+  struct LineContexts {
+    std::string files;                      ///< Status of the files the contexts were built from.
+    std::map<int, shared_SSL_CTX> contexts; ///< By the index of their certificate, -1 for the one of all of them.
+  };
+
   SSLContextStorage *ssl_storage;
   shared_SSL_CTX ssl_default;
   bool is_valid = true;
+  /// Contexts by the settings of their ssl_multicert.config line.
+  std::unordered_map<std::string, LineContexts> line_contexts;
 
   int insert(const char *name, SSLCertContext const &cc);
+  /// Look up @a name to the context at @a idx, returned by a previous insert.
+  int insert(const char *name, int idx);
   int insert(const IpEndpoint &address, SSLCertContext const &cc);
 
   /** Find certificate context by IP address.
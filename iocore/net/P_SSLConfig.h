@@ -76,6 +76,7 @@ struct SSLConfigParams : public ConfigInfo {
   char *cipherSuite;
   char *client_cipherSuite;
   int configExitOnLoadError;
+  int configLazyLoad;
   int clientCertLevel;
   int verify_depth;
   int ssl_session_cache; // SSL_SESSION_CACHE_MODE
@@ -84,6 +85,7 @@ struct SSLConfigParams : public ConfigInfo {
   int ssl_session_cache_skip_on_contention;
   int ssl_session_cache_timeout;
   int ssl_session_cache_auto_clear;
+  char *ssl_session_cache_shared_file;
 
   char *clientCertPath;
   char *clientCertPathOnly;
@@ -106,6 +108,9 @@ struct SSLConfigParams : public ConfigInfo {
   static uint32_t server_max_early_data;
   static uint32_t server_recv_max_early_data;
   static bool server_allow_early_data_params;
+  static bool server_ja3_fingerprint;
+  static uint32_t server_early_data_replay_window;
+  static uint32_t server_early_data_replay_filter_size;
 
   static int ssl_maxrecord;
   static int ssl_misc_max_iobuffer_size_index;
@@ -128,6 +133,7 @@ struct SSLConfigParams : public ConfigInfo {
   static load_ssl_file_func load_ssl_file_cb;
 
   static int async_handshake_enabled;
+  static int async_offload_threads;
   static char *engine_conf_file;
 
   shared_SSL_CTX client_ctx;
@@ -385,6 +385,8 @@ public:
   ink_hrtime sslHandshakeEndTime   = 0;
   ink_hrtime sslLastWriteTime      = 0;
   int64_t sslTotalBytesSent        = 0;
+  /// Set if records are encrypted by the kernel, application data is then written to the socket directly.
+  bool ktls_send = false;
 
   // The serverName is either a pointer to the (null-terminated) name fetched from the
   // SSL object or the empty string.
@@ -396,6 +398,23 @@ public:
 
   void set_server_name(std::string_view name);
 
+  /// The JA3 string of the ClientHello, empty unless proxy.config.ssl.server.ja3_fingerprint is set.
+  std::string_view
+  get_ja3_string() const
+  {
+    return _ja3_string;
+  }
+
+  /// The MD5 of the JA3 string in hexadecimal, nullptr if it was not computed.
+  const char *
+  get_ja3_fingerprint() const
+  {
+    return _ja3_string.empty() ? nullptr : _ja3_fingerprint;
+  }
+
+  /// Keep the JA3 string @a ja3 of the ClientHello and compute its fingerprint.
+  void set_ja3(std::string &&ja3);
+
   bool
   support_sni() const override
   {
@@ -519,6 +538,9 @@ private:
 
   // Null-terminated string, or nullptr if there is no SNI server name.
   std::unique_ptr<char[]> _serverName;
+
+  std::string _ja3_string;
+  char _ja3_fingerprint[33] = {0};
 };
 
 typedef int (SSLNetVConnection::*SSLNetVConnHandler)(int, void *);
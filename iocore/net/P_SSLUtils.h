@@ -65,6 +65,13 @@ public:
 
   bool load(SSLCertLookup *lookup);
 
+  /// Take over the contexts of @a previous for the lines that did not change, instead of building them.
+  void
+  reuse_contexts(const SSLCertLookup *previous)
+  {
+    _previous = previous;
+  }
+
   virtual SSL_CTX *default_server_ssl_ctx();
   virtual SSL_CTX *init_server_ssl_ctx(CertLoadData const &data, const SSLMultiCertConfigParams *sslMultCertSettings,
                                        std::set<std::string> &names);
@@ -84,13 +91,18 @@ public:
 
 protected:
   const SSLConfigParams *_params;
+  const SSLCertLookup *_previous = nullptr;
 
   bool _store_single_ssl_ctx(SSLCertLookup *lookup, shared_SSLMultiCertConfigParams sslMultCertSettings, shared_SSL_CTX ctx,
-                             std::set<std::string> &names);
+                             std::set<std::string> &names, bool fresh = true);
 
 private:
   virtual const char *_debug_tag() const;
   bool _store_ssl_ctx(SSLCertLookup *lookup, shared_SSLMultiCertConfigParams ssl_multi_cert_params);
+  bool _store_lazy_ssl_ctx(SSLCertLookup *lookup, shared_SSLMultiCertConfigParams sslMultCertSettings, CertLoadData const &data,
+                           std::set<std::string> &names);
+  /// Whether contexts may be built on first use, see @c proxy.config.ssl.server.cert.lazy_load.
+  virtual bool _lazy_load_enabled() const;
   virtual void _set_handshake_callbacks(SSL_CTX *ctx);
 };
 
@@ -114,6 +126,11 @@ void SSLPostConfigInitialize();
 ssl_error_t SSLWriteBuffer(SSL *ssl, const void *buf, int64_t nbytes, int64_t &nwritten);
 ssl_error_t SSLReadBuffer(SSL *ssl, void *buf, int64_t nbytes, int64_t &nread);
 ssl_error_t SSLAccept(SSL *ssl);
+
+#if TS_HAS_TLS_EARLY_DATA
+// Whether the early data of a resumed session is accepted, refused when it may be a replay.
+int ssl_allow_early_data_callback(SSL *ssl, void *arg);
+#endif
 ssl_error_t SSLConnect(SSL *ssl);
 
 // Attach a SSL NetVC back pointer to a SSL session.
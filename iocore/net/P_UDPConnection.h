@@ -55,6 +55,9 @@ public:
   // the same as the lastSentPktStartTime.
   uint64_t lastSentPktStartTime = 0;
   uint64_t lastPktStartTime     = 0;
+
+  // SO_TXTIME on the socket: -1 not tried yet, 0 not available, 1 on.
+  int txtime = -1;
 };
 
 TS_INLINE
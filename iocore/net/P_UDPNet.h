@@ -30,6 +30,8 @@
 
 #pragma once
 
+#include <vector>
+
 #include "tscore/ink_platform.h"
 #include "I_UDPNet.h"
 #include "P_UDPPacket.h"
@@ -61,6 +63,12 @@ extern UDPNetProcessorInternal udpNetInternal;
 constexpr int UDP_PERIOD    = 9;
 constexpr int UDP_NH_PERIOD = UDP_PERIOD + 1;
 
+// Upper bound of proxy.config.udp.batch_size.
+constexpr int UDP_MAX_BATCH_SIZE = 64;
+
+// Paced packets due within this much of now are sent, the poll timeout cannot wait any shorter.
+constexpr ink_hrtime UDP_PACING_GRANULARITY = HRTIME_MSECONDS(1);
+
 class PacketQueue
 {
 public:
@@ -279,6 +287,12 @@ class UDPQueue
   int packets             = 0;
   int added               = 0;
 
+  // Packets with a delivery time in the future, as a heap with the earliest first. The calendar
+  // queue works in SLOT_TIME steps, far too coarse to pace packets of one connection.
+  std::vector<UDPPacketInternal *> paced;
+  void addPacedPacket(UDPPacketInternal *p);
+  void releasePacedPackets(ink_hrtime now);
+
 public:
   // Outgoing UDP Packet Queue
   ASLL(UDPPacketInternal, alink) outQueue;
@@ -287,10 +301,18 @@ public:
 
   void SendPackets();
   void SendUDPPacket(UDPPacketInternal *p, int32_t pktLen);
+  void SendMultipleUDPPackets(UDPPacketInternal **p, int n);
 
   // Interface exported to the outside world
   void send(UDPPacket *p);
 
+  /// When the next paced packet is due, 0 if there is none.
+  ink_hrtime
+  nextPacedTime() const
+  {
+    return paced.empty() ? 0 : paced.front()->delivery_time;
+  }
+
   UDPQueue();
   ~UDPQueue();
 };
@@ -312,6 +334,9 @@ public:
   // to be called back with data
   Que(UnixUDPConnection, callback_link) udp_callbacks;
 
+  // receive buffers for recvmmsg, reused until their data is handed off
+  Ptr<IOBufferBlock> recv_slots[UDP_MAX_BATCH_SIZE];
+
   Event *trigger_event = nullptr;
   EThread *thread      = nullptr;
   ink_hrtime nextCheck;
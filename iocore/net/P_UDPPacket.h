@@ -46,6 +46,7 @@ public:
 
   int reqGenerationNum     = 0;
   ink_hrtime delivery_time = 0; // when to deliver packet
+  ink_hrtime txtime        = 0; // when the kernel should send it, for sockets with SO_TXTIME
 
   Ptr<IOBufferBlock> chain;
   Continuation *cont          = nullptr; // callback on error
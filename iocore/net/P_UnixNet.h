@@ -24,6 +24,7 @@
 #pragma once
 
 #include <bitset>
+#include <vector>
 
 #include "tscore/ink_platform.h"
 
@@ -146,17 +147,33 @@ struct EventIO {
 class NetEvent;
 class NetHandler;
 typedef int (NetHandler::*NetContHandler)(int, void *);
+// Longest a NetEvent stays in the cop_wheel without a visit.
+#define NET_COP_WHEEL_HORIZON HRTIME_SECONDS(30)
+
+using NetTimingWheel = TimingWheel<NetEvent, NetEvent::Link_cop_wheel_link, &NetEvent::cop_wheel_at, &NetEvent::cop_wheel_slot>;
 typedef unsigned int uint32;
 
 extern ink_hrtime last_throttle_warning;
 extern ink_hrtime last_shedding_warning;
 extern ink_hrtime emergency_throttle_time;
 extern int net_connections_throttle;
+extern int net_config_memory_accept_rate;
+extern int net_config_load_aware_accept;
+extern int net_config_keep_alive_migration;
+extern int net_config_thread_load_gap;
+extern int net_config_idle_buffer_release;
 extern bool net_memory_throttle;
 extern int fds_throttle;
 extern int fds_limit;
 extern ink_hrtime last_transient_accept_error;
 extern int http_accept_port_number;
+extern int net_config_poll_max_events;
+extern int net_config_poll_busy_spin;
+extern int net_config_poll_busy_threshold;
+extern int net_config_zerocopy_threshold;
+extern int net_config_splice;
+extern int net_config_read_buffer_adaptive;
+extern int net_config_read_buffer_max_index;
 
 //
 // Configuration Parameter had to move here to share
@@ -187,6 +204,10 @@ struct PollCont : public Continuation {
   PollDescriptor *pollDescriptor;
   PollDescriptor *nextPollDescriptor;
   int poll_timeout;
+  /// Events harvested by the last poll, drives the adaptive busy poll.
+  int last_result = 0;
+  /// Set if the last poll found its events while busy polling rather than blocking.
+  bool busy_poll_hit = false;
 
   PollCont(Ptr<ProxyMutex> &m, int pt = net_config_poll_timeout);
   PollCont(Ptr<ProxyMutex> &m, NetHandler *nh, int pt = net_config_poll_timeout);
@@ -195,6 +216,49 @@ struct PollCont : public Continuation {
   void do_poll(ink_hrtime timeout);
 };
 
+/**
+  The write pacing of the connections of a NetHandler, see P_NetPacing.h.
+
+  A connection under no limit is not paced. A paced one writes what @c admit() allows, and when
+  that is nothing it waits in the flow of its group until @c release() puts it back on the write
+  ready list with tokens for its next writes. Each round the flows waiting get
+  NET_PACING_QUANTUM times their weight more bytes they may take, which is deficit round robin.
+ */
+class NetPacer
+{
+public:
+  /// The bytes @a ne may write now out of @a towrite, 0 if it has to wait for @c release().
+  int64_t admit(NetEvent *ne, int64_t towrite, ink_hrtime now);
+  /// @a ne wrote @a written bytes of what @c admit() allowed.
+  void
+  spent(NetEvent *ne, int64_t written)
+  {
+    ne->pacing_grant = std::max<int64_t>(ne->pacing_grant - written, 0);
+  }
+  /// Hand tokens to the waiting connections and put those that got some on @a nh's write ready list.
+  void release(NetHandler *nh, ink_hrtime now);
+  /// Forget @a ne which is closed or moves to another thread.
+  void remove(NetEvent *ne);
+  /// When @c release() has something to do, 0 if no connection is waiting.
+  ink_hrtime next_release = 0;
+
+private:
+  struct Flow {
+    NetPacingGroup *group = nullptr; ///< nullptr for the connections in no group.
+    Que(NetEvent, pacing_link) waiting;
+    int64_t deficit = 0;
+  };
+
+  bool paced(NetEvent *ne) const;
+  Flow &flow(NetPacingGroup *group);
+  int64_t take(NetEvent *ne, int64_t want, ink_hrtime now);
+  ink_hrtime ready_at(NetEvent *ne, ink_hrtime now);
+
+  std::vector<Flow> _flows; ///< The groups with connections on this thread, in round robin order.
+  size_t _next_flow = 0;
+  NetTokenBucket _thread_bucket; ///< The share of this thread of proxy.config.net.pacing.total_rate.
+};
+
 /**
   NetHandler is the processor of NetEvent for the Net sub-system. The NetHandler
   is the core component of the Net sub-system. Once started, it is responsible
@@ -266,12 +330,18 @@ public:
   QueM(NetEvent, NetState, write, ready_link) write_ready_list;
   Que(NetEvent, open_link) open_list;
   DList(NetEvent, cop_link) cop_list;
+  /// Open NetEvents keyed by their next timeout, used instead of @c cop_list if set.
+  NetTimingWheel *cop_wheel = nullptr;
+  ink_hrtime cop_wheel_tick = 0;
   ASLLM(NetEvent, NetState, read, enable_link) read_enable_list;
   ASLLM(NetEvent, NetState, write, enable_link) write_enable_list;
   Que(NetEvent, keep_alive_queue_link) keep_alive_queue;
   uint32_t keep_alive_queue_size = 0;
   Que(NetEvent, active_queue_link) active_queue;
   uint32_t active_queue_size = 0;
+  /// Zero copy sends from closed connections, oldest first.
+  Que(NetZeroCopySend, link) zerocopy_linger;
+  NetPacer pacer;
 
   /// configuration settings for managing the active and keep-alive queues
   struct Config {
@@ -322,11 +392,23 @@ public:
   void process_enabled_list();
   void process_ready_list();
   void manage_keep_alive_queue();
+  /// Offer idle keep-alive connections to the least loaded thread if this one is much busier.
+  void migrate_keep_alive_queue();
   bool manage_active_queue(NetEvent *ne, bool ignore_queue_size);
   void add_to_keep_alive_queue(NetEvent *ne);
   void remove_from_keep_alive_queue(NetEvent *ne);
+  /// Whether @a ne has been in the keep-alive queue for proxy.config.net.idle_buffer_release with its buffers.
+  bool
+  idle_buffers_due(NetEvent *ne, ink_hrtime now) const
+  {
+    return net_config_idle_buffer_release > 0 && ne->keep_alive_at && !ne->idle_buffers_released &&
+           ne->keep_alive_at + HRTIME_MSECONDS(net_config_idle_buffer_release) <= now;
+  }
+  void release_idle_buffers(NetEvent *ne);
   bool add_to_active_queue(NetEvent *ne);
   void remove_from_active_queue(NetEvent *ne);
+  /// Free the lingering zero copy sends whose release time is before @a now.
+  void release_zerocopy_linger(ink_hrtime now);
 
   /// Per process initialization logic.
   static void init_for_process();
@@ -370,6 +452,16 @@ public:
     @param ne NetEvent to be released.
    */
   void stopCop(NetEvent *ne);
+  /**
+    Move @a ne earlier in the @c cop_wheel if one of its timeouts was shortened.
+    Does nothing if there is no wheel or when not called on the thread of this NetHandler, a
+    later deadline is picked up when the old one comes up.
+   */
+  void updateCop(NetEvent *ne);
+  /// Put @a ne, just taken out of the @c cop_wheel, back to be checked again at @a at.
+  void requeueCop(NetEvent *ne, ink_hrtime at);
+  /// When the InactivityCop needs to look at @a ne next.
+  ink_hrtime cop_check_at(NetEvent *ne, ink_hrtime now) const;
 
   // Signal the epoll_wait to terminate.
   void signalActivity() override;
@@ -863,6 +955,7 @@ NetHandler::stopIO(NetEvent *ne)
 
   read_ready_list.remove(ne);
   write_ready_list.remove(ne);
+  pacer.remove(ne);
   if (ne->read.in_enabled_list) {
     read_enable_list.remove(ne);
     ne->read.in_enabled_list = 0;
@@ -875,6 +968,48 @@ NetHandler::stopIO(NetEvent *ne)
   ne->nh = nullptr;
 }
 
+TS_INLINE ink_hrtime
+NetHandler::cop_check_at(NetEvent *ne, ink_hrtime now) const
+{
+  ink_hrtime at = ne->next_inactivity_timeout_at;
+  if (ne->next_activity_timeout_at && (!at || ne->next_activity_timeout_at < at)) {
+    at = ne->next_activity_timeout_at;
+  }
+  if (net_config_idle_buffer_release > 0 && ne->keep_alive_at && !ne->idle_buffers_released) {
+    ink_hrtime release_at = ne->keep_alive_at + HRTIME_MSECONDS(net_config_idle_buffer_release);
+    if (!at || release_at < at) {
+      at = release_at;
+    }
+  }
+  // Without an inactivity timeout the cop has to come back to apply the default one. Changes
+  // made from other threads are only seen on a visit so do not go beyond the horizon either.
+  ink_hrtime limit = now + (ne->next_inactivity_timeout_at ? NET_COP_WHEEL_HORIZON : cop_wheel_tick);
+  return (at && at < limit) ? at : limit;
+}
+
+TS_INLINE void
+NetHandler::requeueCop(NetEvent *ne, ink_hrtime at)
+{
+  if (cop_wheel) {
+    ne->cop_wheel_at = at;
+    cop_wheel->insert(ne);
+  }
+}
+
+TS_INLINE void
+NetHandler::updateCop(NetEvent *ne)
+{
+  if (!cop_wheel || ne->cop_wheel_slot == NetTimingWheel::NOT_QUEUED || this->mutex->thread_holding != this_ethread()) {
+    return;
+  }
+  ink_hrtime at = cop_check_at(ne, Thread::get_hrtime());
+  if (at < ne->cop_wheel_at) {
+    cop_wheel->remove(ne);
+    ne->cop_wheel_at = at;
+    cop_wheel->insert(ne);
+  }
+}
+
 TS_INLINE void
 NetHandler::startCop(NetEvent *ne)
 {
@@ -883,6 +1018,10 @@ NetHandler::startCop(NetEvent *ne)
   ink_assert(!open_list.in(ne));
 
   open_list.enqueue(ne);
+  if (cop_wheel) {
+    ne->cop_wheel_at = cop_check_at(ne, Thread::get_hrtime());
+    cop_wheel->insert(ne);
+  }
 }
 
 TS_INLINE void
@@ -892,6 +1031,9 @@ NetHandler::stopCop(NetEvent *ne)
 
   open_list.remove(ne);
   cop_list.remove(ne);
+  if (cop_wheel) {
+    cop_wheel->remove(ne);
+  }
   remove_from_keep_alive_queue(ne);
   remove_from_active_queue(ne);
 }
@@ -31,6 +31,8 @@
 
 #pragma once
 
+#include <fcntl.h>
+
 #include "tscore/ink_sock.h"
 #include "I_NetVConnection.h"
 #include "P_UnixNetState.h"
@@ -42,6 +44,47 @@ class UnixNetVConnection;
 class NetHandler;
 struct PollDescriptor;
 
+#if defined(SO_ZEROCOPY) && defined(MSG_ZEROCOPY)
+#define TS_USE_NET_ZEROCOPY 1
+#else
+#define TS_USE_NET_ZEROCOPY 0
+#endif
+
+/// How long to keep zero copy send buffers after their connection is closed.
+#define NET_ZEROCOPY_LINGER HRTIME_SECONDS(60)
+
+/** A @c MSG_ZEROCOPY send whose data the kernel may still be reading.
+
+    @a blocks are clones of the blocks which were written, holding references to their
+    @c IOBufferData until the completion for @a id is read from the socket error queue.
+ */
+struct NetZeroCopySend {
+  uint32_t id           = 0;
+  ink_hrtime release_at = 0; ///< When to drop the data regardless, once the connection is closed.
+  Ptr<IOBufferBlock> blocks;
+  LINK(NetZeroCopySend, link);
+};
+
+extern ClassAllocator<NetZeroCopySend> netZeroCopySendAllocator;
+
+#if defined(SPLICE_F_MOVE) && defined(F_GETPIPE_SZ)
+#define TS_USE_NET_SPLICE 1
+#else
+#define TS_USE_NET_SPLICE 0
+#endif
+
+/** The kernel pipe between the read of one connection and the write of another.
+
+    Shared by both, so the data still in it can be written after the reader is done.
+ */
+struct NetSplicePipe : public RefCountObj {
+  int fd[2]       = {NO_FD, NO_FD};
+  int64_t size    = 0; ///< Capacity of the pipe.
+  int64_t pending = 0; ///< Bytes in the pipe.
+
+  ~NetSplicePipe() override;
+};
+
 inline void
 NetVCOptions::reset()
 {
@@ -109,6 +152,15 @@ class UnixNetVConnection : public NetVConnection, public NetEvent
 {
 public:
   int64_t outstanding() override;
+  bool sample_tcp_info(NetVCTcpInfo &info) override;
+  void set_pacing(int64_t rate, std::string_view group) override;
+  void
+  set_migration_cont(Continuation *cont) override
+  {
+    migrate_cont = cont;
+  }
+  int64_t idle_buffer_bytes() override;
+  int64_t release_idle_buffers() override;
   VIO *do_io_read(Continuation *c, int64_t nbytes, MIOBuffer *buf) override;
   VIO *do_io_write(Continuation *c, int64_t nbytes, IOBufferReader *buf, bool owner = false) override;
 
@@ -289,6 +341,30 @@ public:
   bool from_accept_thread  = false;
   NetAccept *accept_object = nullptr;
 
+  /// @c SO_ZEROCOPY state of the socket, 0 if not tried yet, 1 if enabled, -1 if unavailable.
+  int zerocopy              = 0;
+  uint32_t zerocopy_next_id = 0;
+  /// Zero copy sends not yet completed by the kernel, oldest first.
+  Que(NetZeroCopySend, link) zerocopy_pending;
+
+  /// Write @a iov with @c MSG_ZEROCOPY, holding @a blocks until the kernel is done with them.
+  int64_t zerocopy_send(IOVec *iov, unsigned niov, IOBufferBlock **blocks);
+  /// Read completions from the socket error queue and release the finished sends.
+  void zerocopy_reap();
+  /// Hand any uncompleted sends to the NetHandler of @a t before the socket is closed.
+  void zerocopy_release(EThread *t);
+
+  bool splice_to(NetVConnection *target) override;
+  int64_t splice_pending() const override;
+
+  /// Pipe the reads go to, and the writes come from, while spliced.
+  Ptr<NetSplicePipe> read_splice;
+  Ptr<NetSplicePipe> write_splice;
+
+  /// Adapts the block size of the read buffer, see proxy.config.net.read_buffer_adaptive.
+  IOBufferSizer read_sizer;
+  void adapt_read_buffer(MIOBuffer *buf, int64_t offered, int64_t nread, int64_t ntodo, EThread *t);
+
   // es - origin_trace associated connections
   bool origin_trace;
   const sockaddr *origin_trace_addr;
@@ -392,14 +468,6 @@ UnixNetVConnection::get_inactivity_timeout()
   return inactivity_timeout_in;
 }
 
-inline void
-UnixNetVConnection::set_active_timeout(ink_hrtime timeout_in)
-{
-  Debug("socket", "Set active timeout=%" PRId64 ", NetVC=%p", timeout_in, this);
-  active_timeout_in        = timeout_in;
-  next_activity_timeout_at = (active_timeout_in > 0) ? Thread::get_hrtime() + timeout_in : 0;
-}
-
 inline void
 UnixNetVConnection::cancel_inactivity_timeout()
 {
@@ -26,76 +26,152 @@
 #include "ProxyProtocol.h"
 #include "I_NetVConnection.h"
 
+namespace
+{
+// Copies the TLV value @a v to @a dst if it fits, else leaves the value empty.
+template <size_t N>
+void
+copy_tlv(char (&dst)[N], uint8_t &dst_len, ts::TextView v)
+{
+  if (v.size() <= N) {
+    memcpy(dst, v.data(), v.size());
+    dst_len = v.size();
+  }
+}
+
+// Keeps the TLVs in @a tlvs that are of use. False if they do not add up to the length of @a tlvs.
 bool
-ssl_has_proxy_v1(NetVConnection *sslvc, char *buffer, int64_t *bytes_r)
+proxy_protov2_parse_tlvs(NetVConnection *netvc, ts::TextView tlvs)
 {
-  ts::TextView tv;
+  while (tlvs.size() >= 3) {
+    uint8_t type = tlvs[0];
+    size_t len   = (static_cast<uint8_t>(tlvs[1]) << 8) | static_cast<uint8_t>(tlvs[2]);
+    if (tlvs.size() < 3 + len) {
+      Debug("proxyprotocol_v2", "proxy_protov2_parse: TLV type 0x%02x of length %zu overruns the header", type, len);
+      return false;
+    }
+    ts::TextView value{tlvs.data() + 3, len};
+    tlvs.remove_prefix(3 + len);
 
-  tv.assign(buffer, *bytes_r);
+    switch (type) {
+    case PP2_TYPE_ALPN:
+      copy_tlv(netvc->pp_info.alpn, netvc->pp_info.alpn_len, value);
+      break;
+    case PP2_TYPE_AUTHORITY:
+      copy_tlv(netvc->pp_info.authority, netvc->pp_info.authority_len, value);
+      break;
+    case PP2_TYPE_SSL:
+      // client flags, verify result, then the sub TLVs
+      if (value.size() < 5) {
+        return false;
+      }
+      netvc->pp_info.ssl = value[0] & PP2_CLIENT_SSL;
+      for (value.remove_prefix(5); value.size() >= 3;) {
+        uint8_t subtype = value[0];
+        size_t sublen   = (static_cast<uint8_t>(value[1]) << 8) | static_cast<uint8_t>(value[2]);
+        if (value.size() < 3 + sublen) {
+          return false;
+        }
+        if (subtype == PP2_SUBTYPE_SSL_VERSION) {
+          copy_tlv(netvc->pp_info.ssl_version, netvc->pp_info.ssl_version_len, ts::TextView{value.data() + 3, sublen});
+        }
+        value.remove_prefix(3 + sublen);
+      }
+      break;
+    default:
+      break;
+    }
+  }
+  return true;
+}
+} // namespace
 
+size_t
+proxy_protocol_header_len(ts::TextView data)
+{
+  if (data.size() >= PROXY_V2_CONNECTION_HEADER_LEN_MIN &&
+      0 == memcmp(PROXY_V2_CONNECTION_PREFACE, data.data(), PROXY_V2_SIGNATURE_LEN)) {
+    return PROXY_V2_CONNECTION_HEADER_LEN_MIN + ((static_cast<uint8_t>(data[14]) << 8) | static_cast<uint8_t>(data[15]));
+  }
   // Client must send at least 15 bytes to get a reasonable match.
-  if (tv.size() < PROXY_V1_CONNECTION_HEADER_LEN_MIN) {
-    Debug("proxyprotocol_v1", "ssl_has_proxy_v1: not enough recv'd");
-    return false;
+  if (data.size() >= PROXY_V1_CONNECTION_HEADER_LEN_MIN &&
+      0 == memcmp(PROXY_V1_CONNECTION_PREFACE, data.data(), PROXY_V1_CONNECTION_PREFACE_LEN)) {
+    //  Find the terminating newline
+    ts::TextView::size_type pos = data.prefix(PROXY_V1_CONNECTION_HEADER_LEN_MAX).find('\n');
+    if (pos != data.npos) {
+      return pos + 1;
+    }
   }
+  return 0;
+}
 
-  // if we don't have the PROXY preface, we don't have a ProxyV1 header
-  if (0 != memcmp(PROXY_V1_CONNECTION_PREFACE, buffer, PROXY_V1_CONNECTION_PREFACE_LEN)) {
-    Debug("proxyprotocol_v1", "ssl_has_proxy_v1: failed the memcmp(%s, %s, %lu)", PROXY_V1_CONNECTION_PREFACE, buffer,
-          PROXY_V1_CONNECTION_PREFACE_LEN);
-    return false;
+bool
+proxy_protocol_parse(NetVConnection *netvc, ts::TextView hdr)
+{
+  if (hdr.size() >= PROXY_V2_SIGNATURE_LEN && 0 == memcmp(PROXY_V2_CONNECTION_PREFACE, hdr.data(), PROXY_V2_SIGNATURE_LEN)) {
+    return proxy_protov2_parse(netvc, hdr);
   }
+  return proxy_protov1_parse(netvc, hdr);
+}
 
-  //  Find the terminating newline
-  ts::TextView::size_type pos = tv.find('\n');
-  if (pos == tv.npos) {
-    Debug("proxyprotocol_v1", "ssl_has_proxy_v1: newline not found");
+bool
+ssl_has_proxy_protocol(NetVConnection *sslvc, char *buffer, int64_t *bytes_r)
+{
+  ts::TextView tv;
+
+  tv.assign(buffer, *bytes_r);
+
+  size_t len = proxy_protocol_header_len(tv);
+  if (len == 0 || len > tv.size()) {
+    Debug("proxyprotocol", "ssl_has_proxy_protocol: no complete header in the %zu bytes recv'd", tv.size());
     return false;
   }
 
   // Parse the TextView before moving the bytes in the buffer
-  if (!proxy_protov1_parse(sslvc, tv)) {
+  if (!proxy_protocol_parse(sslvc, tv.prefix(len))) {
     *bytes_r = -EAGAIN;
     return false;
   }
-  *bytes_r -= pos + 1;
+  *bytes_r -= len;
   if (*bytes_r <= 0) {
     *bytes_r = -EAGAIN;
   } else {
-    Debug("ssl", "Moving %" PRId64 " characters remaining in the buffer from %p to %p", *bytes_r, buffer + pos + 1, buffer);
-    memmove(buffer, buffer + pos + 1, *bytes_r);
+    Debug("ssl", "Moving %" PRId64 " characters remaining in the buffer from %p to %p", *bytes_r, buffer + len, buffer);
+    memmove(buffer, buffer + len, *bytes_r);
   }
   return true;
 }
 
 bool
-http_has_proxy_v1(IOBufferReader *reader, NetVConnection *netvc)
+http_has_proxy_protocol(IOBufferReader *reader, NetVConnection *netvc)
 {
   char buf[PROXY_V1_CONNECTION_HEADER_LEN_MAX + 1];
-  ts::TextView tv;
-
-  tv.assign(buf, reader->memcpy(buf, sizeof(buf), 0));
+  ts::TextView tv{reader->start(), static_cast<size_t>(reader->block_read_avail())};
 
-  // Client must send at least 15 bytes to get a reasonable match.
-  if (tv.size() < PROXY_V1_CONNECTION_HEADER_LEN_MIN) {
-    return false;
+  // The header is nearly always all in the first block, it is parsed there and only copied out when
+  // the first block is too short to tell.
+  if (tv.size() < sizeof(buf) && reader->read_avail() > static_cast<int64_t>(tv.size())) {
+    tv.assign(buf, reader->memcpy(buf, sizeof(buf), 0));
   }
 
-  if (0 != memcmp(PROXY_V1_CONNECTION_PREFACE, buf, PROXY_V1_CONNECTION_PREFACE_LEN)) {
+  size_t len = proxy_protocol_header_len(tv);
+  if (len == 0) { // it's not a proxy protocol header.
     return false;
   }
 
-  // Find the terminating LF, which should already be in the buffer.
-  ts::TextView::size_type pos = tv.find('\n');
-  if (pos == tv.npos) { // not found, it's not a proxy protocol header.
+  bool ok;
+  if (len <= tv.size()) {
+    ok = proxy_protocol_parse(netvc, tv.prefix(len));
+  } else if (static_cast<int64_t>(len) <= reader->read_avail()) {
+    // a version 2 header with more TLVs than fit in the first block
+    ats_scoped_str hdr(static_cast<char *>(ats_malloc(len)));
+    reader->memcpy(hdr, len, 0);
+    ok = proxy_protocol_parse(netvc, ts::TextView{hdr.get(), len});
+  } else {
     return false;
   }
-  reader->consume(pos + 1); // clear out the header.
-
-  // Now that we know we have a valid PROXY V1 preface, let's parse the
-  // remainder of the header
-
-  return proxy_protov1_parse(netvc, tv);
+  reader->consume(len); // clear out the header.
+  return ok;
 }
 
 bool
@@ -177,3 +253,79 @@ proxy_protov1_parse(NetVConnection *netvc, ts::TextView hdr)
 
   return true;
 }
+
+bool
+proxy_protov2_parse(NetVConnection *netvc, ts::TextView hdr)
+{
+  if (hdr.size() < PROXY_V2_CONNECTION_HEADER_LEN_MIN ||
+      0 != memcmp(PROXY_V2_CONNECTION_PREFACE, hdr.data(), PROXY_V2_SIGNATURE_LEN)) {
+    return false;
+  }
+  uint8_t version = static_cast<uint8_t>(hdr[12]) >> 4;
+  uint8_t command = static_cast<uint8_t>(hdr[12]) & 0x0F;
+  uint8_t family  = static_cast<uint8_t>(hdr[13]) >> 4;
+  size_t len      = (static_cast<uint8_t>(hdr[14]) << 8) | static_cast<uint8_t>(hdr[15]);
+  if (version != 2 || hdr.size() < PROXY_V2_CONNECTION_HEADER_LEN_MIN + len) {
+    Debug("proxyprotocol_v2", "proxy_protov2_parse: version %d, length %zu of %zu", version, len, hdr.size());
+    return false;
+  }
+  ts::TextView body{hdr.data() + PROXY_V2_CONNECTION_HEADER_LEN_MIN, len};
+
+  if (command == PP2_CMD_LOCAL || (command == PP2_CMD_PROXY && (family == PP2_AF_UNSPEC || family == PP2_AF_UNIX))) {
+    // Sent by the proxy itself (health checks) or for addresses that are not IP, keep those of the connection.
+    Debug("proxyprotocol_v2", "proxy_protov2_parse: command %d family %d, using the connection addresses", command, family);
+    ats_ip_copy(&netvc->pp_info.src_addr, netvc->get_remote_addr());
+    ats_ip_copy(&netvc->pp_info.dst_addr, netvc->get_local_addr());
+    netvc->set_proxy_protocol_version(NetVConnection::ProxyProtocolVersion::V2);
+    return true;
+  }
+  if (command != PP2_CMD_PROXY) {
+    Debug("proxyprotocol_v2", "proxy_protov2_parse: unknown command %d", command);
+    return false;
+  }
+
+  if (family == PP2_AF_INET) {
+    in_addr_t src, dst;
+    in_port_t src_port, dst_port;
+    if (body.size() < 12) {
+      return false;
+    }
+    memcpy(&src, body.data(), 4);
+    memcpy(&dst, body.data() + 4, 4);
+    memcpy(&src_port, body.data() + 8, 2);
+    memcpy(&dst_port, body.data() + 10, 2);
+    ats_ip4_set(&netvc->pp_info.src_addr, src, src_port);
+    ats_ip4_set(&netvc->pp_info.dst_addr, dst, dst_port);
+    body.remove_prefix(12);
+  } else if (family == PP2_AF_INET6) {
+    in6_addr src, dst;
+    in_port_t src_port, dst_port;
+    if (body.size() < 36) {
+      return false;
+    }
+    memcpy(&src, body.data(), 16);
+    memcpy(&dst, body.data() + 16, 16);
+    memcpy(&src_port, body.data() + 32, 2);
+    memcpy(&dst_port, body.data() + 34, 2);
+    ats_ip6_set(&netvc->pp_info.src_addr, src, src_port);
+    ats_ip6_set(&netvc->pp_info.dst_addr, dst, dst_port);
+    body.remove_prefix(36);
+  } else {
+    Debug("proxyprotocol_v2", "proxy_protov2_parse: unknown address family %d", family);
+    return false;
+  }
+
+  if (!proxy_protov2_parse_tlvs(netvc, body)) {
+    return false;
+  }
+  if (is_debug_tag_set("proxyprotocol_v2")) {
+    char src[INET6_ADDRPORTSTRLEN], dst[INET6_ADDRPORTSTRLEN];
+    Debug("proxyprotocol_v2", "proxy_protov2_parse: %s -> %s authority [%.*s] alpn [%.*s] ssl %d",
+          ats_ip_nptop(&netvc->pp_info.src_addr, src, sizeof(src)), ats_ip_nptop(&netvc->pp_info.dst_addr, dst, sizeof(dst)),
+          static_cast<int>(netvc->pp_info.authority_len), netvc->pp_info.authority, static_cast<int>(netvc->pp_info.alpn_len),
+          netvc->pp_info.alpn, netvc->pp_info.ssl);
+  }
+  netvc->set_proxy_protocol_version(NetVConnection::ProxyProtocolVersion::V2);
+
+  return true;
+}
@@ -37,19 +37,39 @@
 // http://www.haproxy.org/download/1.8/doc/proxy-protocol.txt
 
 extern bool proxy_protov1_parse(NetVConnection *, ts::TextView hdr);
-extern bool ssl_has_proxy_v1(NetVConnection *, char *, int64_t *);
-extern bool http_has_proxy_v1(IOBufferReader *, NetVConnection *);
+extern bool proxy_protov2_parse(NetVConnection *, ts::TextView hdr);
+extern size_t proxy_protocol_header_len(ts::TextView data);
+extern bool proxy_protocol_parse(NetVConnection *, ts::TextView hdr);
+extern bool ssl_has_proxy_protocol(NetVConnection *, char *, int64_t *);
+extern bool http_has_proxy_protocol(IOBufferReader *, NetVConnection *);
 
 const char *const PROXY_V1_CONNECTION_PREFACE = R"(PROXY)";
 const char *const PROXY_V2_CONNECTION_PREFACE = "\x0D\x0A\x0D\x0A\x00\x0D\x0A\x51\x55\x49\x54\x0A\x02";
 
 const size_t PROXY_V1_CONNECTION_PREFACE_LEN = strlen(PROXY_V1_CONNECTION_PREFACE); // 5
 const size_t PROXY_V2_CONNECTION_PREFACE_LEN = 13;
+const size_t PROXY_V2_SIGNATURE_LEN          = 12; // the preface without the version
 
 const size_t PROXY_V1_CONNECTION_HEADER_LEN_MIN = 15;
 const size_t PROXY_V2_CONNECTION_HEADER_LEN_MIN = 16;
 
 const size_t PROXY_V1_CONNECTION_HEADER_LEN_MAX = 108;
-const size_t PROXY_V2_CONNECTION_HEADER_LEN_MAX = 16;
+const size_t PROXY_V2_CONNECTION_HEADER_LEN_MAX = 16 + 65535;
+
+// Version 2 commands, address families and TLV types.
+const uint8_t PP2_CMD_LOCAL = 0x0;
+const uint8_t PP2_CMD_PROXY = 0x1;
+
+const uint8_t PP2_AF_UNSPEC = 0x0;
+const uint8_t PP2_AF_INET   = 0x1;
+const uint8_t PP2_AF_INET6  = 0x2;
+const uint8_t PP2_AF_UNIX   = 0x3;
+
+const uint8_t PP2_TYPE_ALPN           = 0x01;
+const uint8_t PP2_TYPE_AUTHORITY      = 0x02;
+const uint8_t PP2_TYPE_SSL            = 0x20;
+const uint8_t PP2_SUBTYPE_SSL_VERSION = 0x21;
+
+const uint8_t PP2_CLIENT_SSL = 0x01;
 
 #endif /* ProxyProtocol_H_ */
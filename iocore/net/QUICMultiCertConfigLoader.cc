@@ -252,3 +252,10 @@ QUICMultiCertConfigLoader::_debug_tag() const
 {
   return "quic";
 }
+
+bool
+QUICMultiCertConfigLoader::_lazy_load_enabled() const
+{
+  // The QUIC contexts are built by this loader, which the lazy builder does not know about.
+  return false;
+}
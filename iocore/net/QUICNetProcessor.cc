@@ -33,12 +33,100 @@
 #include "QUICMultiCertConfigLoader.h"
 #include "QUICResetTokenTable.h"
 
+#if defined(SO_ATTACH_REUSEPORT_CBPF)
+#include <linux/filter.h>
+#endif
+
 //
 // Global Data
 //
 
 QUICNetProcessor quic_NetProcessor;
 
+#if defined(SO_ATTACH_REUSEPORT_CBPF)
+/** Steer datagrams in a @c SO_REUSEPORT group by the thread hint in their destination connection ID.
+
+    The offsets are from the start of the UDP payload. A long header has the ID after the flags, the
+    version and the ID length, a short header right after the flags. Client chosen IDs carry no hint,
+    they still go to one socket every time, which then picks the hint for the IDs the server chooses.
+ */
+static void
+attach_cid_steering(int fd, int n)
+{
+  sock_filter prog[] = {
+    BPF_STMT(BPF_LD | BPF_B | BPF_ABS, 0),
+    BPF_JUMP(BPF_JMP | BPF_JSET | BPF_K, 0x80, 0, 2),
+    BPF_STMT(BPF_LD | BPF_B | BPF_ABS, 6 + QUICConnectionId::THREAD_HINT_OFFSET),
+    BPF_JUMP(BPF_JMP | BPF_JA, 1, 0, 0),
+    BPF_STMT(BPF_LD | BPF_B | BPF_ABS, 1 + QUICConnectionId::THREAD_HINT_OFFSET),
+    BPF_STMT(BPF_ALU | BPF_MOD | BPF_K, static_cast<uint32_t>(n)),
+    BPF_STMT(BPF_RET | BPF_A, 0),
+  };
+
+  sock_fprog fprog;
+  fprog.len    = sizeof(prog) / sizeof(prog[0]);
+  fprog.filter = prog;
+  if (setsockopt(fd, SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF, &fprog, sizeof(fprog)) < 0) {
+    Warning("unable to attach QUIC connection ID steering program: %s", strerror(errno));
+  } else {
+    Debug("iocore_net_processor", "attached QUIC connection ID steering program for %d sockets", n);
+  }
+}
+#else
+static void
+attach_cid_steering(int, int)
+{
+  Warning("QUIC connection ID steering needs SO_ATTACH_REUSEPORT_CBPF, packets are spread by address");
+}
+#endif
+
+/** Bind one socket per ET_UDP thread to the same port, socket @c i polled by thread @c i.
+
+    Any socket can take any packet, the connection table is shared. Steering only saves the hop
+    through a thread that does not own the connection. Returns false if the sockets could not be
+    set up, nothing is left bound then.
+ */
+static bool
+bind_steered(QUICPacketHandlerIn *na, int n)
+{
+  const sockaddr *addr = &na->server.accept_addr.sa;
+  std::vector<int> fds;
+  bool ok = true;
+
+  for (int i = 0; ok && i < n; ++i) {
+    int fd = socketManager.socket(addr->sa_family, SOCK_DGRAM, 0);
+    if (fd < 0) {
+      ok = false;
+      break;
+    }
+    fds.push_back(fd);
+    ok = safe_setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, SOCKOPT_ON, sizeof(int)) == 0 &&
+         (!ats_is_ip6(addr) || safe_setsockopt(fd, IPPROTO_IPV6, IPV6_V6ONLY, SOCKOPT_ON, sizeof(int)) == 0) &&
+         socketManager.ink_bind(fd, addr, ats_ip_size(addr)) == 0;
+  }
+  if (!ok) {
+    Warning("unable to bind %d QUIC sockets for connection ID steering: %s", n, strerror(errno));
+    for (int fd : fds) {
+      socketManager.close(fd);
+    }
+    return false;
+  }
+  attach_cid_steering(fds[0], n);
+
+  for (int i = 0; i < n; ++i) {
+    QUICPacketHandlerIn *handler = na;
+    if (i > 0) {
+      handler        = static_cast<QUICPacketHandlerIn *>(na->clone());
+      handler->mutex = new_ProxyMutex();
+    }
+    handler->set_steering(i, n);
+
+    SCOPED_MUTEX_LOCK(lock, handler->mutex, this_ethread());
+    udpNet.UDPBind(handler, addr, fds[i], 1048576, 1048576, eventProcessor.thread_group[ET_UDP]._thread[i]);
+  }
+  return true;
+}
+
 QUICNetProcessor::QUICNetProcessor() {}
 
 QUICNetProcessor::~QUICNetProcessor()
@@ -220,6 +308,13 @@ QUICNetProcessor::main_accept(Continuation *cont, SOCKET fd, AcceptOptions const
   na->action_->server = &na->server;
   na->init_accept();
 
+  // The hint is a byte of the connection ID
+  QUICConfig::scoped_config params;
+  int n_sockets = std::min(eventProcessor.thread_group[ET_UDP]._count, 256);
+  if (params->cid_steering() && fd == NO_FD && n_sockets > 1 && bind_steered(static_cast<QUICPacketHandlerIn *>(na), n_sockets)) {
+    return na->action_.get();
+  }
+
   SCOPED_MUTEX_LOCK(lock, na->mutex, this_ethread());
   udpNet.UDPBind((Continuation *)na, &na->server.accept_addr.sa, fd, 1048576, 1048576);
 
@@ -44,6 +44,8 @@
 #include "QUICHandshake.h"
 #include "QUICConfig.h"
 #include "QUICIntUtil.h"
+#include "QUICCubicCongestionController.h"
+#include "QUICBBRCongestionController.h"
 
 using namespace std::literals;
 static constexpr std::string_view QUIC_DEBUG_TAG = "quic_net"sv;
@@ -267,6 +269,9 @@ QUICNetVConnection::init(QUICConnectionId peer_cid, QUICConnectionId original_ci
   this->_original_quic_connection_id = original_cid;
   this->_first_quic_connection_id    = first_cid;
   this->_quic_connection_id.randomize();
+  if (packet_handler->cid_thread_hint() >= 0) {
+    this->_quic_connection_id.set_thread_hint(packet_handler->cid_thread_hint());
+  }
 
   if (ctable) {
     this->_ctable = ctable;
@@ -429,7 +434,18 @@ QUICNetVConnection::start()
   this->_pinger = new QUICPinger();
   this->_padder = new QUICPadder(this->netvc_context);
   this->_rtt_measure.init(this->_context->ld_config());
-  this->_congestion_controller = new QUICNewRenoCongestionController(*_context);
+  this->_pacer = QUICPacer(this->_context->cc_config().initial_window());
+  switch (this->_context->cc_config().algorithm()) {
+  case QUICCongestionControlAlgorithm::CUBIC:
+    this->_congestion_controller = new QUICCubicCongestionController(*_context);
+    break;
+  case QUICCongestionControlAlgorithm::BBR2:
+    this->_congestion_controller = new QUICBBRCongestionController(*_context);
+    break;
+  default:
+    this->_congestion_controller = new QUICNewRenoCongestionController(*_context);
+    break;
+  }
   this->_loss_detector =
     new QUICLossDetector(*_context, this->_congestion_controller, &this->_rtt_measure, this->_pinger, this->_padder);
   this->_frame_dispatcher->add_handler(this->_loss_detector);
@@ -1135,6 +1151,7 @@ QUICNetVConnection::_state_handshake_process_version_negotiation_packet(const QU
     this->_loss_detector->reset();
 
     this->_congestion_controller->reset();
+    this->_pacer.reset();
 
     // start handshake over
     this->_handshake_handler->reset();
@@ -1167,7 +1184,8 @@ QUICNetVConnection::_state_handshake_process_initial_packet(const QUICInitialPac
       this->_alt_con_manager =
         new QUICAltConnectionManager(this, *this->_ctable, *this->_rtable, this->_peer_quic_connection_id,
                                      this->_quic_config->instance_id(), this->_quic_config->active_cid_limit_in(),
-                                     this->_quic_config->preferred_address_ipv4(), this->_quic_config->preferred_address_ipv6());
+                                     this->_quic_config->preferred_address_ipv4(), this->_quic_config->preferred_address_ipv6(),
+                                     this->_packet_handler->cid_thread_hint());
       this->_frame_generators.add_generator(*this->_alt_con_manager, QUICFrameGeneratorWeight::EARLY);
       this->_frame_dispatcher->add_handler(this->_alt_con_manager);
     }
@@ -1236,6 +1254,7 @@ QUICNetVConnection::_state_handshake_process_retry_packet(const QUICRetryPacketR
   this->_loss_detector->reset();
 
   this->_congestion_controller->reset();
+  this->_pacer.reset();
   this->_packet_recv_queue.reset();
 
   // Initialize Key Materials with peer CID. Because peer CID is DCID of (second) INITIAL packet from client which reply to RETRY
@@ -1401,13 +1420,43 @@ QUICNetVConnection::_state_draining_receive_packet()
  * 2. Allocate buffer for UDP Payload
  * 3. Generate QUIC Packet
  * 4. Store data to the paylaod
- * 5. Send UDP Packet
+ * 5. Send UDP Packet, at the time the pacer gives
  */
 QUICConnectionErrorUPtr
 QUICNetVConnection::_state_common_send_packet()
 {
   uint32_t packet_count = 0;
   uint32_t error        = 0;
+  int dcil              = 0;
+  if (this->_peer_quic_connection_id != QUICConnectionId::ZERO()) {
+    dcil = this->_peer_quic_connection_id.length();
+  }
+
+  // Headers are protected a train at a time, which is what the UDP send queue makes a GSO send of, and the train is handed
+  // over once they are.
+  constexpr size_t TRAIN_LEN = QUICPacketHeaderProtector::MAX_BATCH;
+  uint8_t *train_packets[TRAIN_LEN];
+  size_t train_packet_lens[TRAIN_LEN];
+  size_t train_packet_count = 0;
+  Ptr<IOBufferBlock> train_payloads[TRAIN_LEN];
+  ink_hrtime train_send_at[TRAIN_LEN];
+  size_t train_payload_count = 0;
+
+  auto protect_train = [&]() {
+    if (train_packet_count && !this->_ph_protector.protect(train_packets, train_packet_lens, train_packet_count, dcil)) {
+      ink_assert(!"failed to protect buffer");
+    }
+    train_packet_count = 0;
+  };
+  auto send_train = [&]() {
+    protect_train();
+    for (size_t i = 0; i < train_payload_count; ++i) {
+      this->_packet_handler->send_packet(this, train_payloads[i], train_send_at[i]);
+      train_payloads[i] = nullptr;
+    }
+    train_payload_count = 0;
+  };
+
   while (error == 0 && packet_count < PACKET_PER_EVENT) {
     uint32_t window = this->_congestion_controller->credit();
 
@@ -1415,6 +1464,14 @@ QUICNetVConnection::_state_common_send_packet()
       break;
     }
 
+    // Packets due later than the next write event are better built then, with fresh ACKs.
+    ink_hrtime now     = Thread::get_hrtime();
+    ink_hrtime send_at = this->_pacer.send_time(now);
+    if (send_at - now > WRITE_READY_INTERVAL) {
+      this->_schedule_packet_write_ready(true);
+      break;
+    }
+
     Ptr<IOBufferBlock> udp_payload(new_IOBufferBlock());
     uint32_t udp_payload_len = std::min(window, this->_pmtu);
     udp_payload->alloc(iobuffer_size_to_index(udp_payload_len, BUFFER_SIZE_INDEX_32K));
@@ -1441,7 +1498,7 @@ QUICNetVConnection::_state_common_send_packet()
         this->_context->trigger(QUICContext::CallbackEvent::PACKET_SEND, packet.get());
 
         packet_info->packet_number = packet->packet_number();
-        packet_info->time_sent     = Thread::get_hrtime();
+        packet_info->time_sent     = send_at;
         packet_info->ack_eliciting = packet->is_ack_eliciting();
         if (packet->type() == QUICPacketType::PROTECTED) {
           packet_info->is_crypto_packet = false;
@@ -1469,16 +1526,20 @@ QUICNetVConnection::_state_common_send_packet()
         udp_payload->fill(len);
         written += len;
 
-        int dcil = (this->_peer_quic_connection_id == QUICConnectionId::ZERO()) ? 0 : this->_peer_quic_connection_id.length();
-        if (!this->_ph_protector.protect(buf, len, dcil)) {
-          ink_assert(!"failed to protect buffer");
+        if (train_packet_count == TRAIN_LEN) {
+          protect_train();
         }
+        train_packets[train_packet_count]     = buf;
+        train_packet_lens[train_packet_count] = len;
+        ++train_packet_count;
 
         QUICConDebug("[TX] %s packet #%" PRIu64 " size=%zu", QUICDebugNames::packet_type(packet->type()), packet->packet_number(),
                      len);
 
         if (this->_pp_key_info.is_encryption_key_available(QUICKeyPhase::INITIAL) && packet->type() == QUICPacketType::HANDSHAKE &&
             this->netvc_context == NET_VCONNECTION_OUT) {
+          // Initial packets still waiting for header protection need the keys
+          protect_train();
           this->_pp_key_info.drop_keys(QUICKeyPhase::INITIAL);
           this->_minimum_encryption_level = QUICEncryptionLevel::HANDSHAKE;
         }
@@ -1489,16 +1550,23 @@ QUICNetVConnection::_state_common_send_packet()
     }
 
     if (written) {
-      this->_packet_handler->send_packet(this, udp_payload);
+      this->_pacer.on_sent(now, written, this->_congestion_controller->pacing_rate());
+      train_payloads[train_payload_count] = udp_payload;
+      train_send_at[train_payload_count]  = send_at;
+      if (++train_payload_count == TRAIN_LEN) {
+        send_train();
+      }
     } else {
       udp_payload->dealloc();
       break;
     }
   }
+  send_train();
 
   if (packet_count) {
     this->_context->trigger(QUICContext::CallbackEvent::METRICS_UPDATE, this->_congestion_controller->congestion_window(),
-                            this->_congestion_controller->bytes_in_flight(), this->_congestion_controller->current_ssthresh());
+                            this->_congestion_controller->bytes_in_flight(), this->_congestion_controller->current_ssthresh(),
+                            this->_congestion_controller->pacing_rate());
 
     QUIC_INCREMENT_DYN_STAT_EX(QUICStats::total_packets_sent_stat, packet_count);
     net_activity(this, this_ethread());
@@ -1693,13 +1761,21 @@ QUICNetVConnection::_recv_and_ack(const QUICPacketR &packet, bool *has_non_probi
 {
   ink_assert(packet.type() != QUICPacketType::RETRY);
 
-  uint16_t size               = packet.payload_length();
-  ats_unique_buf payload_ubuf = ats_unique_malloc(size);
-  uint8_t *payload            = payload_ubuf.get();
-  size_t copied_len           = 0;
-  for (auto b = packet.payload_block(); b; b = b->next) {
-    memcpy(payload + copied_len, b->start(), b->size());
-    copied_len += b->size();
+  uint16_t size                    = packet.payload_length();
+  Ptr<IOBufferBlock> payload_block = packet.payload_block();
+  ats_unique_buf payload_ubuf      = {nullptr};
+  const uint8_t *payload           = nullptr;
+  if (payload_block && !payload_block->next) {
+    // A decrypted payload is one block, STREAM and CRYPTO frames keep slices of it
+    payload = reinterpret_cast<const uint8_t *>(payload_block->start());
+  } else {
+    payload_ubuf      = ats_unique_malloc(size);
+    size_t copied_len = 0;
+    for (auto b = payload_block; b; b = b->next) {
+      memcpy(payload_ubuf.get() + copied_len, b->start(), b->size());
+      copied_len += b->size();
+    }
+    payload = payload_ubuf.get();
   }
   QUICPacketNumber packet_num = packet.packet_number();
   QUICEncryptionLevel level   = QUICTypeUtil::encryption_level(packet.type());
@@ -33,6 +33,7 @@
 #include "QUICDebugNames.h"
 #include "QUICEvents.h"
 #include "QUICResetTokenTable.h"
+#include "QUICStats.h"
 
 #include "QUICMultiCertConfigLoader.h"
 #include "QUICTLS.h"
@@ -95,9 +96,9 @@ QUICPacketHandler::_send_packet(const QUICPacket &packet, UDPConnection *udp_con
 }
 
 void
-QUICPacketHandler::_send_packet(UDPConnection *udp_con, IpEndpoint &addr, Ptr<IOBufferBlock> udp_payload)
+QUICPacketHandler::_send_packet(UDPConnection *udp_con, IpEndpoint &addr, Ptr<IOBufferBlock> udp_payload, ink_hrtime send_at)
 {
-  UDPPacket *udp_packet = new_UDPPacket(addr, 0, udp_payload);
+  UDPPacket *udp_packet = new_UDPPacket(addr, send_at, udp_payload);
 
   if (is_debug_tag_set(debug_tag)) {
     ip_port_text_buffer ipb;
@@ -202,6 +203,40 @@ QUICPacketHandlerIn::init_accept(EThread *t = nullptr)
   SET_HANDLER(&QUICPacketHandlerIn::acceptEvent);
 }
 
+void
+QUICPacketHandlerIn::set_steering(uint8_t index, uint8_t count)
+{
+  this->_steering_index = index;
+  this->_steering_count = count;
+  this->_next_thread    = index;
+}
+
+int
+QUICPacketHandlerIn::cid_thread_hint() const
+{
+  return this->_steering_count ? this->_steering_index : -1;
+}
+
+EThread *
+QUICPacketHandlerIn::_assign_thread()
+{
+  int n_threads = eventProcessor.thread_group[ET_NET]._count;
+  if (this->_steering_count == 0 || n_threads == 0) {
+    return eventProcessor.assign_thread(ET_NET);
+  }
+
+  // Round robin over the threads whose index matches ours, or the one we fall on if there are fewer threads than sockets
+  if (n_threads <= this->_steering_count) {
+    return eventProcessor.thread_group[ET_NET]._thread[this->_steering_index % n_threads];
+  }
+  if (this->_next_thread >= n_threads) {
+    this->_next_thread = this->_steering_index;
+  }
+  EThread *t = eventProcessor.thread_group[ET_NET]._thread[this->_next_thread];
+  this->_next_thread += this->_steering_count;
+  return t;
+}
+
 Continuation *
 QUICPacketHandlerIn::_get_continuation()
 {
@@ -343,7 +378,7 @@ QUICPacketHandlerIn::_recv_packet(int event, UDPPacket *udp_packet)
     Connection con;
     con.setRemote(&udp_packet->from.sa);
 
-    eth                           = eventProcessor.assign_thread(ET_NET);
+    eth                           = this->_assign_thread();
     QUICConnectionId original_cid = dcid;
     QUICConnectionId peer_cid     = scid;
 
@@ -386,9 +421,9 @@ QUICPacketHandler::send_packet(const QUICPacket &packet, QUICNetVConnection *vc,
 }
 
 void
-QUICPacketHandler::send_packet(QUICNetVConnection *vc, Ptr<IOBufferBlock> udp_payload)
+QUICPacketHandler::send_packet(QUICNetVConnection *vc, Ptr<IOBufferBlock> udp_payload, ink_hrtime send_at)
 {
-  this->_send_packet(vc->get_udp_con(), vc->con.addr, udp_payload);
+  this->_send_packet(vc->get_udp_con(), vc->con.addr, udp_payload, send_at);
 }
 
 int
@@ -412,6 +447,7 @@ QUICPacketHandlerIn::_stateless_retry(const uint8_t *buf, uint64_t buf_len, UDPC
 
   if (token_length == 0) {
     QUICRetryToken token(from, dcid);
+    QUIC_INCREMENT_DYN_STAT(QUICStats::retry_packets_sent_stat);
     QUICConnectionId local_cid;
     local_cid.randomize();
     QUICPacketUPtr retry_packet = QUICPacketFactory::create_retry_packet(scid, local_cid, token);
@@ -424,18 +460,37 @@ QUICPacketHandlerIn::_stateless_retry(const uint8_t *buf, uint64_t buf_len, UDPC
     return -2;
   } else {
     size_t token_offset = token_length_field_offset + token_length_field_len;
+    if (token_offset + token_length > buf_len) {
+      return -1;
+    }
 
-    if (QUICAddressValidationToken::type(buf + token_offset) == QUICAddressValidationToken::Type::RETRY) {
+    // Everything is checked by the MAC of the token before any connection or handshake state is made
+    if (buf[token_offset] == static_cast<uint8_t>(QUICAddressValidationToken::Type::RETRY)) {
+      QUICConfig::scoped_config params;
       QUICRetryToken token(buf + token_offset, token_length);
-      if (token.is_valid(from)) {
+      if (token.is_valid(from, params->retry_token_lifetime())) {
+        QUIC_INCREMENT_DYN_STAT(QUICStats::retry_tokens_accepted_stat);
         *original_cid = token.original_dcid();
         QUICDebug("Retry Token is valid. ODCID=%" PRIx64, static_cast<uint64_t>(*original_cid));
         return 0;
       } else {
-        QUICDebug("Retry token is invalid: ODCID=%" PRIx64 "token_length=%u token=%02x%02x%02x%02x...",
-                  static_cast<uint64_t>(token.original_dcid()), token.length(), token.buf()[0], token.buf()[1], token.buf()[2],
-                  token.buf()[3]);
-        this->_send_invalid_token_error(buf, buf_len, connection, from);
+        QUIC_INCREMENT_DYN_STAT(QUICStats::retry_tokens_rejected_stat);
+        QUICDebug("Retry token is invalid: token_length=%u token=%02x%02x%02x%02x...", token.length(), token.buf()[0],
+                  token.buf()[1], token.buf()[2], token.buf()[3]);
+
+        // Closing a connection with INVALID_TOKEN sets up the keys of an Initial packet, beyond a few of them a second the
+        // rest are dropped. A legitimate client whose close is dropped times out instead.
+        ink_hrtime now = Thread::get_hrtime();
+        if (now - this->_invalid_token_second >= HRTIME_SECOND) {
+          this->_invalid_token_second = now;
+          this->_invalid_token_closes = 0;
+        }
+        if (this->_invalid_token_closes < params->invalid_token_close_rate()) {
+          ++this->_invalid_token_closes;
+          this->_send_invalid_token_error(buf, buf_len, connection, from);
+        } else {
+          QUIC_INCREMENT_DYN_STAT(QUICStats::invalid_token_closes_suppressed_stat);
+        }
         return -3;
       }
     } else {
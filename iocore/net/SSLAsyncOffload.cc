@@ -0,0 +1,289 @@
+/** @file
+
+  Private key operations of TLS handshakes run on their own threads.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "SSLAsyncOffload.h"
+
+#include "tscore/ink_config.h"
+#include "tscore/Diags.h"
+#include "P_EventSystem.h"
+#include "SSLStats.h"
+
+#if TS_USE_TLS_ASYNC
+#include <openssl/async.h>
+#include <openssl/ec.h>
+#include <openssl/rsa.h>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include <sched.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+EventType ET_SSL = ET_CALL;
+bool offloading  = false;
+
+#if TS_USE_TLS_ASYNC
+using PrivateKeyOp = std::function<int(unsigned char *out, unsigned int *outlen)>;
+using RSAOp        = int (*)(int flen, const unsigned char *from, unsigned char *to, RSA *rsa, int padding);
+using ECSignOp     = int (*)(int type, const unsigned char *dgst, int dlen, unsigned char *sig, unsigned int *siglen,
+                         const BIGNUM *kinv, const BIGNUM *r, EC_KEY *eckey);
+
+RSA_METHOD *rsa_method    = nullptr;
+EC_KEY_METHOD *ec_method  = nullptr;
+RSAOp rsa_priv_enc        = nullptr;
+RSAOp rsa_priv_dec        = nullptr;
+ECSignOp ec_sign          = nullptr;
+const char wait_fd_key[1] = {0}; ///< Where the event fd is kept in the wait context.
+
+/// An operation handed to an @c ET_SSL thread. The paused job and the worker share it, either may let go first.
+struct OffloadedOp {
+  PrivateKeyOp run;
+  std::vector<unsigned char> out;
+  unsigned int outlen = 0;
+  int result          = -1;
+  std::atomic<bool> done{false};
+};
+
+struct OffloadedOpCont : public Continuation {
+  OffloadedOpCont(std::shared_ptr<OffloadedOp> op, int fd) : Continuation(new_ProxyMutex()), op(std::move(op)), signal_fd(fd)
+  {
+    SET_HANDLER(&OffloadedOpCont::mainEvent);
+  }
+
+  int
+  mainEvent(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
+  {
+    op->outlen = op->out.size();
+    op->result = op->run(op->out.data(), &op->outlen);
+    op->done.store(true, std::memory_order_release);
+    eventfd_write(signal_fd, 1);
+    close(signal_fd);
+    delete this;
+    return EVENT_DONE;
+  }
+
+  std::shared_ptr<OffloadedOp> op;
+  int signal_fd;
+};
+
+void
+close_wait_fd(ASYNC_WAIT_CTX * /* ctx ATS_UNUSED */, const void * /* key ATS_UNUSED */, OSSL_ASYNC_FD fd, void * /* ATS_UNUSED */)
+{
+  close(fd);
+}
+
+// Run @a run on an ET_SSL thread and pause the handshake until it is done. Outside of an async job, as
+// when the key is used for something else than a handshake, it just runs here.
+int
+offload(size_t outsize, unsigned char *to, unsigned int *tolen, PrivateKeyOp run)
+{
+  unsigned int len        = 0;
+  ASYNC_JOB *job          = ASYNC_get_current_job();
+  ASYNC_WAIT_CTX *waitctx = job ? ASYNC_get_wait_ctx(job) : nullptr;
+
+  if (tolen == nullptr) {
+    tolen = &len;
+  }
+  if (waitctx == nullptr) {
+    return run(to, tolen);
+  }
+
+  // One event fd per connection, closed with its wait context.
+  OSSL_ASYNC_FD fd;
+  void *data;
+  if (!ASYNC_WAIT_CTX_get_fd(waitctx, wait_fd_key, &fd, &data)) {
+    fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (fd < 0) {
+      return run(to, tolen);
+    }
+    if (!ASYNC_WAIT_CTX_set_wait_fd(waitctx, wait_fd_key, fd, nullptr, close_wait_fd)) {
+      close(fd);
+      return run(to, tolen);
+    }
+  }
+  // The worker signals its own copy, so a connection closed in the meantime can't have it write to a reused fd.
+  int signal_fd = dup(fd);
+  if (signal_fd < 0) {
+    return run(to, tolen);
+  }
+
+  auto op = std::make_shared<OffloadedOp>();
+  op->run = std::move(run);
+  op->out.resize(outsize);
+  SSL_INCREMENT_DYN_STAT(ssl_async_offloaded_stat);
+  eventProcessor.schedule_imm(new OffloadedOpCont(op, signal_fd), ET_SSL);
+
+  while (!op->done.load(std::memory_order_acquire)) {
+    if (!ASYNC_pause_job()) {
+      sched_yield();
+    }
+  }
+
+  eventfd_t count;
+  eventfd_read(fd, &count);
+  if (op->result > 0) {
+    memcpy(to, op->out.data(), op->outlen);
+    *tolen = op->outlen;
+  }
+  return op->result;
+}
+
+int
+offload_rsa(RSAOp fn, int flen, const unsigned char *from, unsigned char *to, RSA *rsa, int padding)
+{
+  // The connection may go away while the worker still has the key.
+  RSA_up_ref(rsa);
+  std::shared_ptr<RSA> key(rsa, RSA_free);
+  std::vector<unsigned char> in(from, from + flen);
+
+  return offload(RSA_size(rsa), to, nullptr, [fn, key, in, padding](unsigned char *out, unsigned int *outlen) {
+    int n   = fn(in.size(), in.data(), out, key.get(), padding);
+    *outlen = n > 0 ? n : 0;
+    return n;
+  });
+}
+
+int
+offloaded_rsa_priv_enc(int flen, const unsigned char *from, unsigned char *to, RSA *rsa, int padding)
+{
+  return offload_rsa(rsa_priv_enc, flen, from, to, rsa, padding);
+}
+
+int
+offloaded_rsa_priv_dec(int flen, const unsigned char *from, unsigned char *to, RSA *rsa, int padding)
+{
+  return offload_rsa(rsa_priv_dec, flen, from, to, rsa, padding);
+}
+
+int
+offloaded_ec_sign(int type, const unsigned char *dgst, int dlen, unsigned char *sig, unsigned int *siglen, const BIGNUM *kinv,
+                  const BIGNUM *r, EC_KEY *eckey)
+{
+  // Precomputed values are the caller's, never the case for a handshake.
+  if (kinv != nullptr || r != nullptr) {
+    return ec_sign(type, dgst, dlen, sig, siglen, kinv, r, eckey);
+  }
+
+  EC_KEY_up_ref(eckey);
+  std::shared_ptr<EC_KEY> key(eckey, EC_KEY_free);
+  std::vector<unsigned char> digest(dgst, dgst + dlen);
+
+  return offload(ECDSA_size(eckey), sig, siglen, [type, key, digest](unsigned char *out, unsigned int *outlen) {
+    return ec_sign(type, digest.data(), digest.size(), out, outlen, nullptr, nullptr, key.get());
+  });
+}
+#endif /* TS_USE_TLS_ASYNC */
+} // namespace
+
+void
+SSLAsyncOffload::initialize(int threads, size_t stacksize)
+{
+  if (threads <= 0) {
+    return;
+  }
+
+#if TS_USE_TLS_ASYNC
+  rsa_priv_enc = RSA_meth_get_priv_enc(RSA_PKCS1_OpenSSL());
+  rsa_priv_dec = RSA_meth_get_priv_dec(RSA_PKCS1_OpenSSL());
+  rsa_method   = RSA_meth_dup(RSA_PKCS1_OpenSSL());
+  ec_method    = EC_KEY_METHOD_new(EC_KEY_OpenSSL());
+  if (rsa_method == nullptr || ec_method == nullptr) {
+    Error("failed to set up the methods for TLS private key offload");
+    return;
+  }
+
+  int (*sign_setup)(EC_KEY *, BN_CTX *, BIGNUM **, BIGNUM **);
+  ECDSA_SIG *(*sign_sig)(const unsigned char *, int, const BIGNUM *, const BIGNUM *, EC_KEY *);
+  EC_KEY_METHOD_get_sign(ec_method, &ec_sign, &sign_setup, &sign_sig);
+  EC_KEY_METHOD_set_sign(ec_method, offloaded_ec_sign, sign_setup, sign_sig);
+  RSA_meth_set1_name(rsa_method, "ATS offloaded RSA");
+  RSA_meth_set_priv_enc(rsa_method, offloaded_rsa_priv_enc);
+  RSA_meth_set_priv_dec(rsa_method, offloaded_rsa_priv_dec);
+
+  ET_SSL     = eventProcessor.spawn_event_threads("ET_SSL", threads, stacksize);
+  offloading = true;
+  Note("offloading TLS private key operations to %d ET_SSL threads", threads);
+#else
+  (void)stacksize;
+  Warning("proxy.config.ssl.async.offload_threads needs OpenSSL async job support, private key operations are not offloaded");
+#endif
+}
+
+bool
+SSLAsyncOffload::enabled()
+{
+  return offloading;
+}
+
+bool
+SSLAsyncOffload::offload_private_key(SSL_CTX *ctx)
+{
+#if TS_USE_TLS_ASYNC
+  EVP_PKEY *pkey    = SSL_CTX_get0_privatekey(ctx);
+  EVP_PKEY *wrapped = nullptr;
+
+  if (!offloading || pkey == nullptr) {
+    return true;
+  }
+
+  // The key is copied, with OpenSSL 3 the one loaded is a provider key which does not use methods.
+  switch (EVP_PKEY_base_id(pkey)) {
+  case EVP_PKEY_RSA: {
+    RSA *rsa = RSAPrivateKey_dup(EVP_PKEY_get0_RSA(pkey));
+    if (rsa == nullptr || !RSA_set_method(rsa, rsa_method) || (wrapped = EVP_PKEY_new()) == nullptr ||
+        !EVP_PKEY_assign_RSA(wrapped, rsa)) {
+      RSA_free(rsa);
+      EVP_PKEY_free(wrapped);
+      return false;
+    }
+    break;
+  }
+  case EVP_PKEY_EC: {
+    EC_KEY *eckey = EC_KEY_dup(EVP_PKEY_get0_EC_KEY(pkey));
+    if (eckey == nullptr || !EC_KEY_set_method(eckey, ec_method) || (wrapped = EVP_PKEY_new()) == nullptr ||
+        !EVP_PKEY_assign_EC_KEY(wrapped, eckey)) {
+      EC_KEY_free(eckey);
+      EVP_PKEY_free(wrapped);
+      return false;
+    }
+    break;
+  }
+  default:
+    Debug("ssl", "private key type %d is not offloaded", EVP_PKEY_base_id(pkey));
+    return true;
+  }
+
+  bool ok = SSL_CTX_use_PrivateKey(ctx, wrapped);
+  EVP_PKEY_free(wrapped);
+  return ok;
+#else
+  (void)ctx;
+  return true;
+#endif
+}
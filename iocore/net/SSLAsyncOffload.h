@@ -0,0 +1,53 @@
+/** @file
+
+  Private key operations of TLS handshakes run on their own threads.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  @section details Details
+
+  The RSA and ECDSA server keys are given methods which, when called from inside an OpenSSL async
+  job, hand the operation to an @c ET_SSL thread and pause the job. The worker signals an event fd
+  kept in the wait context of the connection, which the handshake already polls for
+  @c SSL_ERROR_WANT_ASYNC, and the resumed job picks up the result. So a storm of full handshakes
+  loads the @c ET_SSL threads instead of stalling the net threads.
+ */
+
+#pragma once
+
+#include <openssl/ssl.h>
+#include <cstddef>
+
+class SSLAsyncOffload
+{
+public:
+  /// Spawn @a threads @c ET_SSL threads and set up the key methods, before the certificates are loaded.
+  static void initialize(int threads, size_t stacksize);
+
+  /// Whether private key operations are being offloaded.
+  static bool enabled();
+
+  /** Replace the private key of @a ctx with one whose operations are offloaded.
+
+      Keys of other types than RSA and EC are left as they are.
+
+      @return @c false if the key could not be replaced.
+   */
+  static bool offload_private_key(SSL_CTX *ctx);
+};
@@ -27,7 +27,6 @@
 #include "tscore/I_Layout.h"
 #include "tscore/MatcherUtils.h"
 #include "tscore/Regex.h"
-#include "tscore/Trie.h"
 #include "tscore/BufferWriter.h"
 #include "tscore/bwf_std_format.h"
 #include "tscore/TestBox.h"
@@ -38,6 +37,8 @@
 #include "P_SSLConfig.h"
 #include "SSLSessionTicket.h"
 
+#include <deque>
+#include <string_view>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -109,27 +110,28 @@ public:
   }
 
 private:
-  /** A struct that can be stored a @c Trie.
-      It contains the index of the real certificate and the
-      linkage required by @c Trie.
+  /** Names kept by their labels in reverse, "www.example.com" is the path "com", "example", "www"
+      from the root. The names under a domain share its nodes and each label is kept once, which
+      matters with a few hundred thousand certificates.
   */
-  struct ContextRef {
-    ContextRef() {}
-    explicit ContextRef(int n) : idx(n) {}
-    void
-    Print() const
-    {
-      Debug("ssl", "Item=%p SSL_CTX=#%d", this, idx);
-    }
-    int idx = -1;           ///< Index in the context store.
-    LINK(ContextRef, link); ///< Require by @c Trie
+  struct NameNode {
+    uint32_t parent = 0;  ///< Index of the parent node.
+    uint32_t label  = 0;  ///< Index of the label in @a label_text.
+    int exact       = -1; ///< Context of the name ending here.
+    int wildcard    = -1; ///< Context of "*." and the name ending here, matching one more label.
   };
 
-  /// We can only match one layer with the wildcards
-  /// This table stores the wildcarded subdomain
-  std::unordered_map<std::string, int> wilddomains;
-  /// Contexts stored by IP address or FQDN
-  std::unordered_map<std::string, int> hostnames;
+  /// The node for @a name, added with its parents if @a create, else 0 (the root) if it is not there.
+  uint32_t find_node(std::string_view name, bool create);
+  std::string node_name(uint32_t node) const;
+
+  /// Nodes, the root first.
+  std::vector<NameNode> nodes{1};
+  /// Children by parent node and label, the parent index in the high half.
+  std::unordered_map<uint64_t, uint32_t> children;
+  /// Label indices by label, the keys point into @a label_text.
+  std::unordered_map<std::string_view, uint32_t> label_index;
+  std::deque<std::string> label_text;
   /// List for cleanup.
   /// Exactly one pointer to each SSL context is stored here.
   std::vector<SSLCertContext> ctx_store;
@@ -253,7 +255,8 @@ SSLCertContext::SSLCertContext(SSLCertContext const &other)
   userconfig = other.userconfig;
   keyblock   = other.keyblock;
   std::lock_guard<std::mutex> lock(other.ctx_mutex);
-  ctx = other.ctx;
+  ctx        = other.ctx;
+  ctx_loader = other.ctx_loader;
 }
 
 SSLCertContext &
@@ -264,13 +267,25 @@ SSLCertContext::operator=(SSLCertContext const &other)
     this->userconfig = other.userconfig;
     this->keyblock   = other.keyblock;
     std::lock_guard<std::mutex> lock(other.ctx_mutex);
-    this->ctx = other.ctx;
+    this->ctx        = other.ctx;
+    this->ctx_loader = other.ctx_loader;
   }
   return *this;
 }
 
 shared_SSL_CTX
 SSLCertContext::getCtx()
+{
+  std::lock_guard<std::mutex> lock(ctx_mutex);
+  if (!ctx && ctx_loader) {
+    ctx        = ctx_loader();
+    ctx_loader = nullptr;
+  }
+  return ctx;
+}
+
+shared_SSL_CTX
+SSLCertContext::peekCtx() const
 {
   std::lock_guard<std::mutex> lock(ctx_mutex);
   return ctx;
@@ -280,7 +295,15 @@ void
 SSLCertContext::setCtx(shared_SSL_CTX sc)
 {
   std::lock_guard<std::mutex> lock(ctx_mutex);
-  ctx = std::move(sc);
+  ctx        = std::move(sc);
+  ctx_loader = nullptr;
+}
+
+void
+SSLCertContext::setCtxLoader(CtxLoader loader)
+{
+  std::lock_guard<std::mutex> lock(ctx_mutex);
+  ctx_loader = std::move(loader);
 }
 
 SSLCertLookup::SSLCertLookup() : ssl_storage(new SSLContextStorage()), ssl_default(nullptr), is_valid(true) {}
@@ -322,6 +345,12 @@ SSLCertLookup::insert(const char *name, SSLCertContext const &cc)
   return this->ssl_storage->insert(name, cc);
 }
 
+int
+SSLCertLookup::insert(const char *name, int idx)
+{
+  return this->ssl_storage->insert(name, idx);
+}
+
 int
 SSLCertLookup::insert(const IpEndpoint &address, SSLCertContext const &cc)
 {
@@ -363,6 +392,56 @@ SSLContextStorage::insert(const char *name, SSLCertContext const &cc)
   return idx;
 }
 
+uint32_t
+SSLContextStorage::find_node(std::string_view name, bool create)
+{
+  uint32_t node = 0;
+
+  while (true) {
+    size_t dot             = name.rfind('.');
+    std::string_view label = dot == std::string_view::npos ? name : name.substr(dot + 1);
+
+    auto spot = this->label_index.find(label);
+    if (spot == this->label_index.end()) {
+      if (!create) {
+        return 0;
+      }
+      const std::string &text = this->label_text.emplace_back(label);
+      spot                    = this->label_index.emplace(text, this->label_text.size() - 1).first;
+    }
+
+    uint64_t key = (static_cast<uint64_t>(node) << 32) | spot->second;
+    auto child   = this->children.find(key);
+    if (child != this->children.end()) {
+      node = child->second;
+    } else if (create) {
+      this->nodes.push_back(NameNode{node, spot->second});
+      node = this->nodes.size() - 1;
+      this->children.emplace(key, node);
+    } else {
+      return 0;
+    }
+
+    if (dot == std::string_view::npos) {
+      return node;
+    }
+    name = name.substr(0, dot);
+  }
+}
+
+std::string
+SSLContextStorage::node_name(uint32_t node) const
+{
+  std::string name;
+  for (; node != 0; node = this->nodes[node].parent) {
+    if (!name.empty()) {
+      name.push_back('.');
+    }
+    name.append(this->label_text[this->nodes[node].label]);
+  }
+  return name;
+}
+
 int
 SSLContextStorage::insert(const char *name, int idx)
 {
@@ -370,7 +449,6 @@ SSLContextStorage::insert(const char *name, int idx)
   char lower_case_name[TS_MAX_HOST_NAME_LEN + 1];
   transform_lower(name, lower_case_name);
 
-  shared_SSL_CTX ctx = this->ctx_store[idx].getCtx();
   if (wildcard.match(lower_case_name)) {
     // Strip the wildcard and store the subdomain
     const char *subdomain = index(lower_case_name, '*');
@@ -380,23 +458,25 @@ SSLContextStorage::insert(const char *name, int idx)
       subdomain = nullptr;
     }
     if (subdomain) {
-      if (auto it = this->wilddomains.find(subdomain); it != this->wilddomains.end()) {
-        Debug("ssl", "previously indexed '%s' with SSL_CTX #%d, cannot index it with SSL_CTX #%d now", lower_case_name, it->second,
-              idx);
+      NameNode &node = this->nodes[this->find_node(subdomain, true)];
+      if (node.wildcard >= 0) {
+        Debug("ssl", "previously indexed '%s' with SSL_CTX #%d, cannot index it with SSL_CTX #%d now", lower_case_name,
+              node.wildcard, idx);
         idx = -1;
       } else {
-        this->wilddomains.emplace(subdomain, idx);
-        Debug("ssl", "indexed '%s' with SSL_CTX %p [%d]", lower_case_name, ctx.get(), idx);
+        node.wildcard = idx;
+        Debug("ssl", "indexed '%s' with SSL_CTX #%d", lower_case_name, idx);
       }
     }
   } else {
-    if (auto it = this->hostnames.find(lower_case_name); it != this->hostnames.end() && idx != it->second) {
-      Debug("ssl", "previously indexed '%s' with SSL_CTX %d, cannot index it with SSL_CTX #%d now", lower_case_name, it->second,
+    NameNode &node = this->nodes[this->find_node(lower_case_name, true)];
+    if (node.exact >= 0 && idx != node.exact) {
+      Debug("ssl", "previously indexed '%s' with SSL_CTX %d, cannot index it with SSL_CTX #%d now", lower_case_name, node.exact,
             idx);
       idx = -1;
     } else {
-      this->hostnames.emplace(lower_case_name, idx);
-      Debug("ssl", "indexed '%s' with SSL_CTX %p [%d]", lower_case_name, ctx.get(), idx);
+      node.exact = idx;
+      Debug("ssl", "indexed '%s' with SSL_CTX #%d", lower_case_name, idx);
     }
   }
   return idx;
@@ -405,31 +485,29 @@ SSLContextStorage::insert(const char *name, int idx)
 void
 SSLContextStorage::printWildDomains() const
 {
-  for (auto &&it : this->wilddomains) {
-    Debug("ssl", "Stored wilddomain %s", it.first.c_str());
+  for (uint32_t node = 1; node < this->nodes.size(); ++node) {
+    if (this->nodes[node].wildcard >= 0) {
+      Debug("ssl", "Stored wilddomain %s", this->node_name(node).c_str());
+    }
   }
 }
 
 SSLCertContext *
 SSLContextStorage::lookup(const char *name)
 {
-  // First look for an exact name match
-  if (auto it = this->hostnames.find(name); it != this->hostnames.end()) {
-    return &(this->ctx_store[it->second]);
-  }
-  // Try lower casing it
   char lower_case_name[TS_MAX_HOST_NAME_LEN + 1];
   transform_lower(name, lower_case_name);
-  if (auto it_lower = this->hostnames.find(lower_case_name); it_lower != this->hostnames.end()) {
-    return &(this->ctx_store[it_lower->second]);
+
+  // First look for an exact name match
+  std::string_view lower{lower_case_name};
+  if (uint32_t node = this->find_node(lower, false); node != 0 && this->nodes[node].exact >= 0) {
+    return &(this->ctx_store[this->nodes[node].exact]);
   }
 
   // Then strip off the top domain name and look for a wildcard domain match
-  const char *subdomain = index(lower_case_name, '.');
-  if (subdomain) {
-    ++subdomain; // Move beyond the '.'
-    if (auto it = this->wilddomains.find(subdomain); it != this->wilddomains.end()) {
-      return &(this->ctx_store[it->second]);
+  if (size_t dot = lower.find('.'); dot != std::string_view::npos) {
+    if (uint32_t node = this->find_node(lower.substr(dot + 1), false); node != 0 && this->nodes[node].wildcard >= 0) {
+      return &(this->ctx_store[this->nodes[node].wildcard]);
     }
   }
   return nullptr;
@@ -171,6 +171,10 @@ SSLInitClientContext(const SSLConfigParams *params)
   }
 
   SSL_CTX_set_options(client_ctx, params->ssl_client_ctx_options);
+#ifdef SSL_MODE_RELEASE_BUFFERS
+  // As for the server contexts, an idle origin connection in the pool has no record buffers.
+  SSL_CTX_set_mode(client_ctx, SSL_MODE_RELEASE_BUFFERS);
+#endif
   if (params->client_cipherSuite != nullptr) {
     if (!SSL_CTX_set_cipher_list(client_ctx, params->client_cipherSuite)) {
       SSLError("invalid client cipher suite in %s", ts::filename::RECORDS);
@@ -66,12 +66,16 @@ init_ssl_ctx_func SSLConfigParams::init_ssl_ctx_cb          = nullptr;
 load_ssl_file_func SSLConfigParams::load_ssl_file_cb        = nullptr;
 IpMap *SSLConfigParams::proxy_protocol_ipmap                = nullptr;
 
-const uint32_t EARLY_DATA_DEFAULT_SIZE               = 16384;
-uint32_t SSLConfigParams::server_max_early_data      = 0;
-uint32_t SSLConfigParams::server_recv_max_early_data = EARLY_DATA_DEFAULT_SIZE;
-bool SSLConfigParams::server_allow_early_data_params = false;
+const uint32_t EARLY_DATA_DEFAULT_SIZE                         = 16384;
+uint32_t SSLConfigParams::server_max_early_data                = 0;
+uint32_t SSLConfigParams::server_recv_max_early_data           = EARLY_DATA_DEFAULT_SIZE;
+bool SSLConfigParams::server_allow_early_data_params           = false;
+bool SSLConfigParams::server_ja3_fingerprint                   = false;
+uint32_t SSLConfigParams::server_early_data_replay_window      = 3600;
+uint32_t SSLConfigParams::server_early_data_replay_filter_size = 1048576;
 
 int SSLConfigParams::async_handshake_enabled = 0;
+int SSLConfigParams::async_offload_threads   = 0;
 char *SSLConfigParams::engine_conf_file      = nullptr;
 
 static std::unique_ptr<ConfigUpdateHandler<SSLCertificateConfig>> sslCertUpdate;
@@ -118,7 +122,9 @@ SSLConfigParams::reset()
   ssl_session_cache_skip_on_contention = 0;
   ssl_session_cache_timeout            = 0;
   ssl_session_cache_auto_clear         = 1;
+  ssl_session_cache_shared_file        = nullptr;
   configExitOnLoadError                = 1;
+  configLazyLoad                       = 0;
 }
 
 void
@@ -140,6 +146,8 @@ SSLConfigParams::cleanup()
   client_cipherSuite      = static_cast<char *>(ats_free_null(client_cipherSuite));
   dhparamsFile            = static_cast<char *>(ats_free_null(dhparamsFile));
 
+  ssl_session_cache_shared_file = static_cast<char *>(ats_free_null(ssl_session_cache_shared_file));
+
   server_tls13_cipher_suites = static_cast<char *>(ats_free_null(server_tls13_cipher_suites));
   client_tls13_cipher_suites = static_cast<char *>(ats_free_null(client_tls13_cipher_suites));
   server_groups_list         = static_cast<char *>(ats_free_null(server_groups_list));
@@ -261,6 +269,13 @@ SSLConfigParams::initialize()
   }
 #endif
 
+#ifdef SSL_OP_ENABLE_KTLS
+  REC_ReadConfigInteger(option, "proxy.config.ssl.ktls.enabled");
+  if (option) {
+    ssl_ctx_options |= SSL_OP_ENABLE_KTLS;
+  }
+#endif
+
 #ifdef SSL_OP_NO_COMPRESSION
   ssl_ctx_options |= SSL_OP_NO_COMPRESSION;
   ssl_client_ctx_options |= SSL_OP_NO_COMPRESSION;
@@ -292,6 +307,9 @@ SSLConfigParams::initialize()
 
   REC_ReadConfigInteger(server_max_early_data, "proxy.config.ssl.server.max_early_data");
   REC_ReadConfigInt32(server_allow_early_data_params, "proxy.config.ssl.server.allow_early_data_params");
+  REC_ReadConfigInt32(server_ja3_fingerprint, "proxy.config.ssl.server.ja3_fingerprint");
+  REC_ReadConfigInteger(server_early_data_replay_window, "proxy.config.ssl.server.early_data_replay_window");
+  REC_ReadConfigInteger(server_early_data_replay_filter_size, "proxy.config.ssl.server.early_data_replay_filter_size");
 
   // According to OpenSSL the default value is 16384,
   // we keep it unless "server_max_early_data" is higher.
@@ -304,6 +322,7 @@ SSLConfigParams::initialize()
 
   configFilePath = ats_stringdup(RecConfigReadConfigPath("proxy.config.ssl.server.multicert.filename"));
   REC_ReadConfigInteger(configExitOnLoadError, "proxy.config.ssl.server.multicert.exit_on_load_fail");
+  REC_ReadConfigInteger(configLazyLoad, "proxy.config.ssl.server.cert.lazy_load");
 
   REC_ReadConfigStringAlloc(ssl_server_private_key_path, "proxy.config.ssl.server.private_key.path");
   set_paths_helper(ssl_server_private_key_path, nullptr, &serverKeyPathOnly, nullptr);
@@ -322,6 +341,7 @@ SSLConfigParams::initialize()
   REC_ReadConfigInteger(ssl_session_cache_skip_on_contention, "proxy.config.ssl.session_cache.skip_cache_on_bucket_contention");
   REC_ReadConfigInteger(ssl_session_cache_timeout, "proxy.config.ssl.session_cache.timeout");
   REC_ReadConfigInteger(ssl_session_cache_auto_clear, "proxy.config.ssl.session_cache.auto_clear");
+  REC_ReadConfigStringAlloc(ssl_session_cache_shared_file, "proxy.config.ssl.session_cache.shared_file");
 
   SSLConfigParams::session_cache_max_bucket_size =
     static_cast<size_t>(ceil(static_cast<double>(ssl_session_cache_size) / ssl_session_cache_num_buckets));
@@ -329,7 +349,7 @@ SSLConfigParams::initialize()
   SSLConfigParams::session_cache_number_buckets          = ssl_session_cache_num_buckets;
 
   if (ssl_session_cache == SSL_SESSION_CACHE_MODE_SERVER_ATS_IMPL) {
-    session_cache = new SSLSessionCache();
+    session_cache = new SSLSessionCache(ssl_session_cache_shared_file);
   }
 
   // SSL record size
@@ -347,6 +367,11 @@ SSLConfigParams::initialize()
   REC_ReadConfigInt32(ssl_handshake_timeout_in, "proxy.config.ssl.handshake_timeout_in");
 
   REC_ReadConfigInt32(async_handshake_enabled, "proxy.config.ssl.async.handshake.enabled");
+  REC_ReadConfigInt32(async_offload_threads, "proxy.config.ssl.async.offload_threads");
+  // Offloaded private key operations pause the handshake in an async job.
+  if (async_offload_threads > 0) {
+    async_handshake_enabled = 1;
+  }
   REC_ReadConfigStringAlloc(engine_conf_file, "proxy.config.ssl.engine.conf_file");
 
   REC_ReadConfigStringAlloc(server_groups_list, "proxy.config.ssl.server.groups_list");
@@ -463,6 +488,7 @@ SSLCertificateConfig::startup()
   sslCertUpdate.reset(new ConfigUpdateHandler<SSLCertificateConfig>());
   sslCertUpdate->attach("proxy.config.ssl.server.multicert.filename");
   sslCertUpdate->attach("proxy.config.ssl.server.cert.path");
+  sslCertUpdate->attach("proxy.config.ssl.server.cert.lazy_load");
   sslCertUpdate->attach("proxy.config.ssl.server.private_key.path");
   sslCertUpdate->attach("proxy.config.ssl.server.cert_chain.filename");
   sslCertUpdate->attach("proxy.config.ssl.server.session_ticket.enable");
@@ -491,7 +517,10 @@ SSLCertificateConfig::reconfigure()
     ink_hrtime_sleep(HRTIME_SECONDS(secs));
   }
 
+  // The contexts of the lines that did not change are shared with the previous lookup.
+  SSLCertificateConfig::scoped_config previous;
   SSLMultiCertConfigLoader loader(params);
+  loader.reuse_contexts(previous);
   loader.load(lookup);
 
   if (!lookup->is_valid) {
@@ -28,6 +28,7 @@
 #include "P_OCSPStapling.h"
 #include "P_SSLSNI.h"
 #include "SSLStats.h"
+#include "SSLAsyncOffload.h"
 
 //
 // Global Data
@@ -63,6 +64,8 @@ SSLNetProcessor::start(int, size_t stacksize)
   SSLConfig::startup();
   SSLPostConfigInitialize();
   SNIConfig::startup();
+  // The server keys are wrapped as they are loaded, so the workers must be there first.
+  SSLAsyncOffload::initialize(SSLConfigParams::async_offload_threads, stacksize);
 
   if (!SSLCertificateConfig::startup()) {
     return -1;
@@ -84,7 +87,7 @@ SSLNetProcessor::start(int, size_t stacksize)
   }
 #endif /* TS_USE_TLS_OCSP */
 
-  // We have removed the difference between ET_SSL threads and ET_NET threads,
+  // Other than for private key offload, there is no difference between ET_SSL threads and ET_NET threads,
   // So just keep on chugging
   return 0;
 }
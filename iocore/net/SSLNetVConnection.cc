@@ -174,7 +174,13 @@ make_ssl_connection(SSL_CTX *ctx, SSLNetVConnection *netvc)
     } else {
       netvc->initialize_handshake_buffers();
       BIO *rbio = BIO_new(BIO_s_mem());
+#ifdef SSL_OP_ENABLE_KTLS
+      // OpenSSL only installs the traffic keys in the kernel through a socket BIO.
+      BIO *wbio = (SSL_get_options(ssl) & SSL_OP_ENABLE_KTLS) ? BIO_new_socket(netvc->get_socket(), BIO_NOCLOSE) :
+                                                                BIO_new_fd(netvc->get_socket(), BIO_NOCLOSE);
+#else
       BIO *wbio = BIO_new_fd(netvc->get_socket(), BIO_NOCLOSE);
+#endif
       BIO_set_mem_eof_return(wbio, -1);
       SSL_set_bio(ssl, rbio, wbio);
 
@@ -186,7 +192,8 @@ make_ssl_connection(SSL_CTX *ctx, SSLNetVConnection *netvc)
       //
       // We are now also disabling this when using OpenSSL's internal cache, since we
       // are calling "ssl_accept" non-blocking, it seems to be confusing the anti-replay
-      // mechanism and causing session resumption to fail.
+      // mechanism and causing session resumption to fail. Replays are refused by
+      // ssl_allow_early_data_callback instead.
       SSLConfig::scoped_config params;
       if (SSL_version(ssl) >= TLS1_3_VERSION && params->server_max_early_data > 0) {
         bool ret1 = false;
@@ -206,6 +213,7 @@ make_ssl_connection(SSL_CTX *ctx, SSLNetVConnection *netvc)
         if (ret1 && ret2) {
           Debug("ssl_early_data", "Must disable anti-replay if 0-rtt is enabled.");
           SSL_set_options(ssl, SSL_OP_NO_ANTI_REPLAY);
+          SSL_set_allow_early_data_cb(ssl, ssl_allow_early_data_callback, nullptr);
         }
       }
 #endif
@@ -251,10 +259,11 @@ ssl_read_from_net(SSLNetVConnection *sslvc, EThread *lthread, int64_t &ret)
   int64_t bytes_read     = 0;
   ssl_error_t sslErr     = SSL_ERROR_NONE;
 
+  int64_t ntodo  = s->vio.ntodo();
   int64_t toread = buf.writer()->write_avail();
   ink_release_assert(toread > 0);
-  if (toread > s->vio.ntodo()) {
-    toread = s->vio.ntodo();
+  if (toread > ntodo) {
+    toread = ntodo;
   }
 
   bytes_read = 0;
@@ -336,6 +345,7 @@ ssl_read_from_net(SSLNetVConnection *sslvc, EThread *lthread, int64_t &ret)
 
   if (bytes_read > 0) {
     Debug("ssl", "bytes_read=%" PRId64, bytes_read);
+    sslvc->adapt_read_buffer(buf.writer(), toread, bytes_read, ntodo, lthread);
 
     s->vio.ndone += bytes_read;
     sslvc->netActivity(lthread);
@@ -432,8 +442,8 @@ SSLNetVConnection::read_raw_data()
                              "proxy protocol is enabled on this port - processing all connections");
     }
 
-    if (ssl_has_proxy_v1(this, buffer, &r)) {
-      Debug("proxyprotocol", "ssl has proxy_v1 header");
+    if (ssl_has_proxy_protocol(this, buffer, &r)) {
+      Debug("proxyprotocol", "ssl has proxy protocol header");
       set_remote_addr(get_proxy_protocol_src_addr());
     } else {
       Debug("proxyprotocol", "proxy protocol was enabled, but required header was not present in the "
@@ -757,6 +767,12 @@ SSLNetVConnection::load_buffer_and_write(int64_t towrite, MIOBufferAccessor &buf
     return this->super::load_buffer_and_write(towrite, buf, total_written, needs);
   }
 
+  // With kernel TLS the kernel frames and encrypts records, so write plain data unless SSL_write
+  // still has to finish a retried record.
+  if (ktls_send && !redoWriteSize) {
+    return this->super::load_buffer_and_write(towrite, buf, total_written, needs);
+  }
+
   Debug("ssl", "towrite=%" PRId64, towrite);
 
   do {
@@ -924,6 +940,7 @@ void
 SSLNetVConnection::clear()
 {
   _serverName.reset();
+  _ja3_string.clear();
 
   if (ssl != nullptr) {
     SSL_free(ssl);
@@ -936,6 +953,7 @@ SSLNetVConnection::clear()
   sslHandshakeBeginTime       = 0;
   sslLastWriteTime            = 0;
   sslTotalBytesSent           = 0;
+  ktls_send                   = false;
   sslClientRenegotiationAbort = false;
 
   curHook         = nullptr;
@@ -955,6 +973,7 @@ SSLNetVConnection::free(EThread *t)
   if (con.fd != NO_FD) {
     NET_SUM_GLOBAL_DYN_STAT(net_connections_currently_open_stat, -1);
   }
+  zerocopy_release(t);
   con.close();
 
   ats_free(tunnel_host);
@@ -1125,6 +1144,11 @@ SSLNetVConnection::sslStartHandShake(int event, int &err)
 
       SSL_set_verify(this->ssl, SSL_VERIFY_PEER, verify_callback);
 
+      if (!this->options.alpn_protos.empty()) {
+        SSL_set_alpn_protos(this->ssl, reinterpret_cast<const unsigned char *>(this->options.alpn_protos.data()),
+                            this->options.alpn_protos.size());
+      }
+
       ats_scoped_str &tlsext_host_name = this->options.sni_hostname ? this->options.sni_hostname : this->options.sni_servername;
       if (tlsext_host_name) {
         if (SSL_set_tlsext_host_name(this->ssl, tlsext_host_name)) {
@@ -1302,7 +1326,29 @@ SSLNetVConnection::sslServerHandShakeEvent(int &err)
       Debug("ssl", "ssl handshake time:%" PRId64, ssl_handshake_time);
       SSL_INCREMENT_DYN_STAT_EX(ssl_total_handshake_time_stat, ssl_handshake_time);
       SSL_INCREMENT_DYN_STAT(ssl_total_success_handshake_count_in_stat);
+      SSLIncrementHandshakeTimeStat(ssl_handshake_time);
+
+      bool resumed = SSL_session_reused(ssl);
+      SSL_INCREMENT_DYN_STAT(resumed ? ssl_total_resumed_handshake_count_in_stat : ssl_total_full_handshake_count_in_stat);
+      RecIncrRawStatSum(ssl_rsb, nullptr, ssl_resumed_handshake_ratio_stat, resumed ? 1 : 0);
+      RecIncrRawStatCount(ssl_rsb, nullptr, ssl_resumed_handshake_ratio_stat, 1);
+    }
+
+#if defined(SSL_OP_ENABLE_KTLS) && defined(BIO_get_ktls_send)
+    if (SSL_get_options(ssl) & SSL_OP_ENABLE_KTLS) {
+      if (BIO_get_ktls_send(SSL_get_wbio(ssl))) {
+        Debug("ssl", "kernel TLS transmit offload enabled");
+        ktls_send = true;
+        // Kernel TLS sockets refuse MSG_ZEROCOPY.
+        zerocopy = -1;
+        SSL_INCREMENT_DYN_STAT(ssl_ktls_tx_offloaded_stat);
+      } else {
+        Debug("ssl", "kernel TLS transmit offload not available for %s", SSL_get_cipher_name(ssl));
+        SSL_INCREMENT_DYN_STAT(ssl_ktls_tx_unavailable_stat);
+      }
     }
+#endif
+
     {
       const unsigned char *proto = nullptr;
       unsigned len               = 0;
@@ -1919,3 +1965,19 @@ SSLNetVConnection::set_server_name(std::string_view name)
     _serverName.reset(n);
   }
 }
+
+void
+SSLNetVConnection::set_ja3(std::string &&ja3)
+{
+  static const char hex[] = "0123456789abcdef";
+  unsigned char digest[EVP_MAX_MD_SIZE];
+  unsigned int len = 0;
+
+  _ja3_string = std::move(ja3);
+  EVP_Digest(_ja3_string.data(), _ja3_string.size(), digest, &len, EVP_md5(), nullptr);
+  for (unsigned int i = 0; i < len; ++i) {
+    _ja3_fingerprint[2 * i]     = hex[digest[i] >> 4];
+    _ja3_fingerprint[2 * i + 1] = hex[digest[i] & 0xf];
+  }
+  _ja3_fingerprint[2 * len] = '\0';
+}
@@ -24,6 +24,14 @@
 #include "SSLStats.h"
 
 #include <cstring>
+#include <algorithm>
+#include <ctime>
+#include <fcntl.h>
+#include <sched.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #define SSLSESSIONCACHE_STRINGIFY0(x) #x
 #define SSLSESSIONCACHE_STRINGIFY(x) SSLSESSIONCACHE_STRINGIFY0(x)
@@ -36,8 +44,17 @@
 #endif
 
 /* Session Cache */
-SSLSessionCache::SSLSessionCache() : nbuckets(SSLConfigParams::session_cache_number_buckets)
+SSLSessionCache::SSLSessionCache(const char *shared_file) : nbuckets(SSLConfigParams::session_cache_number_buckets)
 {
+  if (shared_file && *shared_file) {
+    shared = SSLSharedSessionTable::open(shared_file, nbuckets, SSLConfigParams::session_cache_max_bucket_size);
+  }
+  if (shared) {
+    Debug("ssl.session_cache", "Created new ssl session cache %p in %s with %zu buckets each with size max size %zu", this,
+          shared_file, nbuckets, SSLConfigParams::session_cache_max_bucket_size);
+    return;
+  }
+
   Debug("ssl.session_cache", "Created new ssl session cache %p with %zu buckets each with size max size %zu", this, nbuckets,
         SSLConfigParams::session_cache_max_bucket_size);
 
@@ -47,24 +64,29 @@ SSLSessionCache::SSLSessionCache() : nbuckets(SSLConfigParams::session_cache_num
 SSLSessionCache::~SSLSessionCache()
 {
   delete[] session_bucket;
+  delete shared;
 }
 
 int
 SSLSessionCache::getSessionBuffer(const SSLSessionID &sid, char *buffer, int &len) const
 {
+  if (shared) {
+    return shared->getSessionBuffer(sid, buffer, len);
+  }
+
   uint64_t hash            = sid.hash();
   uint64_t target_bucket   = hash % nbuckets;
-  SSLSessionBucket *bucket = &session_bucket[target_bucket];
+  SSLSessionBucket *bucket = shared ? nullptr : &session_bucket[target_bucket];
 
   return bucket->getSessionBuffer(sid, buffer, len);
 }
 
 bool
-SSLSessionCache::getSession(const SSLSessionID &sid, SSL_SESSION **sess, ssl_session_cache_exdata **data) const
+SSLSessionCache::getSession(const SSLSessionID &sid, SSL_SESSION **sess, ssl_session_cache_exdata *data) const
 {
   uint64_t hash            = sid.hash();
   uint64_t target_bucket   = hash % nbuckets;
-  SSLSessionBucket *bucket = &session_bucket[target_bucket];
+  SSLSessionBucket *bucket = shared ? nullptr : &session_bucket[target_bucket];
 
   if (is_debug_tag_set("ssl.session_cache")) {
     char buf[sid.len * 2 + 1];
@@ -73,6 +95,9 @@ SSLSessionCache::getSession(const SSLSessionID &sid, SSL_SESSION **sess, ssl_ses
           target_bucket, bucket, buf, hash);
   }
 
+  if (shared) {
+    return shared->getSession(sid, sess, data);
+  }
   return bucket->getSession(sid, sess, data);
 }
 
@@ -81,7 +106,7 @@ SSLSessionCache::removeSession(const SSLSessionID &sid)
 {
   uint64_t hash            = sid.hash();
   uint64_t target_bucket   = hash % nbuckets;
-  SSLSessionBucket *bucket = &session_bucket[target_bucket];
+  SSLSessionBucket *bucket = shared ? nullptr : &session_bucket[target_bucket];
 
   if (is_debug_tag_set("ssl.session_cache")) {
     char buf[sid.len * 2 + 1];
@@ -93,15 +118,36 @@ SSLSessionCache::removeSession(const SSLSessionID &sid)
   if (ssl_rsb) {
     SSL_INCREMENT_DYN_STAT(ssl_session_cache_eviction);
   }
+  if (shared) {
+    shared->removeSession(sid);
+    return;
+  }
   bucket->removeSession(sid);
 }
 
+size_t
+SSLSessionCache::trim(int percent)
+{
+  // The shared table is a file of a fixed size, trimming it frees no memory.
+  if (shared) {
+    return 0;
+  }
+  size_t removed = 0;
+  for (size_t i = 0; i < nbuckets; ++i) {
+    removed += session_bucket[i].trim(percent);
+  }
+  if (ssl_rsb && removed > 0) {
+    SSL_INCREMENT_DYN_STAT_EX(ssl_session_cache_eviction, removed);
+  }
+  return removed;
+}
+
 void
 SSLSessionCache::insertSession(const SSLSessionID &sid, SSL_SESSION *sess, SSL *ssl)
 {
   uint64_t hash            = sid.hash();
   uint64_t target_bucket   = hash % nbuckets;
-  SSLSessionBucket *bucket = &session_bucket[target_bucket];
+  SSLSessionBucket *bucket = shared ? nullptr : &session_bucket[target_bucket];
 
   if (is_debug_tag_set("ssl.session_cache")) {
     char buf[sid.len * 2 + 1];
@@ -110,6 +156,10 @@ SSLSessionCache::insertSession(const SSLSessionID &sid, SSL_SESSION *sess, SSL *
           target_bucket, bucket, buf, hash);
   }
 
+  if (shared) {
+    shared->insertSession(sid, sess, ssl);
+    return;
+  }
   bucket->insertSession(sid, sess, ssl);
 }
 
@@ -214,7 +264,7 @@ SSLSessionBucket::getSessionBuffer(const SSLSessionID &id, char *buffer, int &le
 }
 
 bool
-SSLSessionBucket::getSession(const SSLSessionID &id, SSL_SESSION **sess, ssl_session_cache_exdata **data)
+SSLSessionBucket::getSession(const SSLSessionID &id, SSL_SESSION **sess, ssl_session_cache_exdata *data)
 {
   char buf[id.len * 2 + 1];
   buf[0] = '\0'; // just to be safe.
@@ -246,7 +296,7 @@ SSLSessionBucket::getSession(const SSLSessionID &id, SSL_SESSION **sess, ssl_ses
       *sess                    = d2i_SSL_SESSION(nullptr, &loc, node->len_asn1_data);
       if (data != nullptr) {
         ssl_session_cache_exdata *exdata = reinterpret_cast<ssl_session_cache_exdata *>(node->extra_data->data());
-        *data                            = exdata;
+        *data                            = *exdata;
       }
 
       return true;
@@ -312,7 +362,232 @@ SSLSessionBucket::removeSession(const SSLSessionID &id)
   }
 }
 
+int
+SSLSessionBucket::trim(int percent)
+{
+  MUTEX_TRY_LOCK(lock, mutex, this_ethread());
+  if (!lock.is_locked()) {
+    return 0;
+  }
+  int keep    = queue.size * percent / 100;
+  int removed = 0;
+  while (queue.head && queue.size > keep) {
+    delete queue.pop();
+    ++removed;
+  }
+  return removed;
+}
+
 /* Session Bucket */
 SSLSessionBucket::SSLSessionBucket() : mutex(new_ProxyMutex()) {}
 
 SSLSessionBucket::~SSLSessionBucket() {}
+
+/* Shared Session Table */
+SSLSharedSessionTable *
+SSLSharedSessionTable::open(const char *path, size_t nbuckets, size_t slots_per_bucket)
+{
+  size_t size = sizeof(SSLSharedSessionHeader) + nbuckets * slots_per_bucket * sizeof(SSLSharedSessionSlot);
+
+  int fd = ::open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+  if (fd < 0) {
+    Warning("unable to open the shared SSL session cache %s: %s", path, strerror(errno));
+    return nullptr;
+  }
+
+  // Only one process at a time checks the layout and resets the file.
+  struct stat st;
+  void *base = MAP_FAILED;
+  if (flock(fd, LOCK_EX) == 0 && fstat(fd, &st) == 0 &&
+      (static_cast<size_t>(st.st_size) == size || (ftruncate(fd, 0) == 0 && ftruncate(fd, size) == 0))) {
+    base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  }
+  if (base == MAP_FAILED) {
+    Warning("unable to map the shared SSL session cache %s: %s", path, strerror(errno));
+    close(fd);
+    return nullptr;
+  }
+
+  SSLSharedSessionHeader *header = static_cast<SSLSharedSessionHeader *>(base);
+  SSLSharedSessionSlot *slots    = reinterpret_cast<SSLSharedSessionSlot *>(header + 1);
+  size_t nslots                  = nbuckets * slots_per_bucket;
+  if (header->magic != SSLSharedSessionHeader::LAYOUT_MAGIC || header->version != SSLSharedSessionHeader::LAYOUT_VERSION ||
+      header->nbuckets != nbuckets || header->slots_per_bucket != slots_per_bucket ||
+      header->slot_size != sizeof(SSLSharedSessionSlot)) {
+    Note("resetting the shared SSL session cache %s for %zu buckets of %zu sessions", path, nbuckets, slots_per_bucket);
+    memset(base, 0, size);
+    header->version          = SSLSharedSessionHeader::LAYOUT_VERSION;
+    header->nbuckets         = nbuckets;
+    header->slots_per_bucket = slots_per_bucket;
+    header->slot_size        = sizeof(SSLSharedSessionSlot);
+    header->magic            = SSLSharedSessionHeader::LAYOUT_MAGIC;
+  } else {
+    // A process that died while writing a slot left it odd, which no one would ever claim again.
+    for (size_t i = 0; i < nslots; ++i) {
+      uint32_t seq = slots[i].seq.load(std::memory_order_relaxed);
+      if (seq & 1) {
+        slots[i].id_len = 0;
+        slots[i].seq.store(seq + 1, std::memory_order_release);
+      }
+    }
+  }
+
+  flock(fd, LOCK_UN);
+  close(fd);
+  return new SSLSharedSessionTable(base, size);
+}
+
+SSLSharedSessionTable::SSLSharedSessionTable(void *base, size_t size)
+  : _base(base),
+    _size(size),
+    _header(static_cast<SSLSharedSessionHeader *>(base)),
+    _slots(reinterpret_cast<SSLSharedSessionSlot *>(_header + 1))
+{
+}
+
+SSLSharedSessionTable::~SSLSharedSessionTable()
+{
+  munmap(_base, _size);
+}
+
+SSLSharedSessionSlot *
+SSLSharedSessionTable::bucket(const SSLSessionID &id) const
+{
+  return _slots + (id.hash() % _header->nbuckets) * _header->slots_per_bucket;
+}
+
+bool
+SSLSharedSessionTable::read(const SSLSessionID &id, unsigned char *asn1, uint16_t &asn1_len, ssl_curve_id &curve) const
+{
+  SSLSharedSessionSlot *slots = bucket(id);
+  for (uint32_t i = 0; i < _header->slots_per_bucket; ++i) {
+    SSLSharedSessionSlot &slot = slots[i];
+    uint32_t seq               = slot.seq.load(std::memory_order_acquire);
+    if ((seq & 1) || slot.id_len != id.len || memcmp(slot.id, id.bytes, id.len) != 0) {
+      continue;
+    }
+    asn1_len = std::min<uint16_t>(slot.asn1_len, SSL_MAX_SESSION_SIZE);
+    memcpy(asn1, slot.asn1, asn1_len);
+    curve = slot.curve;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.seq.load(std::memory_order_relaxed) == seq) {
+      return true;
+    }
+    // Rewritten while it was copied, the session is gone or went to another slot.
+  }
+  return false;
+}
+
+bool
+SSLSharedSessionTable::getSession(const SSLSessionID &id, SSL_SESSION **sess, ssl_session_cache_exdata *data) const
+{
+  unsigned char asn1[SSL_MAX_SESSION_SIZE];
+  uint16_t asn1_len;
+  ssl_curve_id curve;
+  if (!read(id, asn1, asn1_len, curve)) {
+    Debug("ssl.session_cache", "Session not found in the shared cache.");
+    return false;
+  }
+
+  const unsigned char *loc = asn1;
+  *sess                    = d2i_SSL_SESSION(nullptr, &loc, asn1_len);
+  if (*sess == nullptr) {
+    return false;
+  }
+  if (data != nullptr) {
+    data->curve = curve;
+  }
+  return true;
+}
+
+int
+SSLSharedSessionTable::getSessionBuffer(const SSLSessionID &id, char *buffer, int &len) const
+{
+  unsigned char asn1[SSL_MAX_SESSION_SIZE];
+  uint16_t asn1_len;
+  ssl_curve_id curve;
+  if (!read(id, asn1, asn1_len, curve)) {
+    return 0;
+  }
+  if (buffer) {
+    if (asn1_len < len) {
+      len = asn1_len;
+    }
+    memcpy(buffer, asn1, len);
+  }
+  return asn1_len;
+}
+
+void
+SSLSharedSessionTable::insertSession(const SSLSessionID &id, SSL_SESSION *sess, SSL *ssl)
+{
+  int len = i2d_SSL_SESSION(sess, nullptr);
+  /* do not cache a session that's too big. */
+  if (len <= 0 || len > SSL_MAX_SESSION_SIZE) {
+    Debug("ssl.session_cache", "Unable to save SSL session because size of %d exceeds the max of %d", len, SSL_MAX_SESSION_SIZE);
+    return;
+  }
+
+  // Don't insert if it is already there, else take an empty slot, else the oldest.
+  SSLSharedSessionSlot *slots  = bucket(id);
+  SSLSharedSessionSlot *victim = &slots[0];
+  for (uint32_t i = 0; i < _header->slots_per_bucket; ++i) {
+    SSLSharedSessionSlot &slot = slots[i];
+    if (slot.id_len == id.len && memcmp(slot.id, id.bytes, id.len) == 0) {
+      return;
+    }
+    if (victim->id_len != 0 && (slot.id_len == 0 || slot.inserted < victim->inserted)) {
+      victim = &slot;
+    }
+  }
+
+  uint32_t seq = victim->seq.load(std::memory_order_relaxed);
+  if ((seq & 1) || !victim->seq.compare_exchange_strong(seq, seq + 1, std::memory_order_acquire)) {
+    // Another process or thread is writing the slot, the session just is not cached.
+    if (ssl_rsb) {
+      SSL_INCREMENT_DYN_STAT(ssl_session_cache_lock_contention);
+    }
+    return;
+  }
+  std::atomic_thread_fence(std::memory_order_release);
+
+  if (victim->id_len != 0 && ssl_rsb) {
+    SSL_INCREMENT_DYN_STAT(ssl_session_cache_eviction);
+  }
+  unsigned char *loc = victim->asn1;
+  i2d_SSL_SESSION(sess, &loc);
+  victim->asn1_len = len;
+  victim->curve    = (ssl == nullptr) ? 0 : SSLGetCurveNID(ssl);
+  victim->inserted = time(nullptr);
+  memcpy(victim->id, id.bytes, id.len);
+  victim->id_len = id.len;
+
+  victim->seq.store(seq + 2, std::memory_order_release);
+}
+
+void
+SSLSharedSessionTable::removeSession(const SSLSessionID &id)
+{
+  SSLSharedSessionSlot *slots = bucket(id);
+  for (uint32_t i = 0; i < _header->slots_per_bucket; ++i) {
+    SSLSharedSessionSlot &slot = slots[i];
+    if (slot.id_len != id.len || memcmp(slot.id, id.bytes, id.len) != 0) {
+      continue;
+    }
+    // This session MUST be removed, so wait out a writer, unless it went away in the middle.
+    uint32_t seq = slot.seq.load(std::memory_order_relaxed);
+    for (int tries = 0; (seq & 1) || !slot.seq.compare_exchange_weak(seq, seq + 1, std::memory_order_acquire); ++tries) {
+      if (tries == 1000) {
+        Warning("unable to remove a session from a shared SSL session cache slot that stays busy");
+        return;
+      }
+      sched_yield();
+      seq = slot.seq.load(std::memory_order_relaxed);
+    }
+    if (slot.id_len == id.len && memcmp(slot.id, id.bytes, id.len) == 0) {
+      slot.id_len = 0;
+    }
+    slot.seq.store(seq + 2, std::memory_order_release);
+    return;
+  }
+}
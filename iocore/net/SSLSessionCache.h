@@ -29,6 +29,7 @@
 #include "P_SSLUtils.h"
 #include "ts/apidefs.h"
 #include <openssl/ssl.h>
+#include <atomic>
 
 #define SSL_MAX_SESSION_SIZE 256
 
@@ -135,9 +136,11 @@ public:
   SSLSessionBucket();
   ~SSLSessionBucket();
   void insertSession(const SSLSessionID &, SSL_SESSION *ctx, SSL *ssl);
-  bool getSession(const SSLSessionID &, SSL_SESSION **ctx, ssl_session_cache_exdata **data);
+  bool getSession(const SSLSessionID &, SSL_SESSION **ctx, ssl_session_cache_exdata *data);
   int getSessionBuffer(const SSLSessionID &, char *buffer, int &len);
   void removeSession(const SSLSessionID &);
+  /// Drop the oldest sessions down to @a percent of them, unless the bucket is busy. Returns the number dropped.
+  int trim(int percent);
 
 private:
   /* these method must be used while hold the lock */
@@ -148,14 +151,77 @@ private:
   CountQueue<SSLSession> queue;
 };
 
+/** Sessions kept in a file mapped by every process that uses it.
+
+    The same buckets as @c SSLSessionBucket, but of fixed size slots, so that the table outlives a
+    restart of @c traffic_server and can be read and filled by another process as well. The file
+    starts with a @c SSLSharedSessionHeader, followed by @a nbuckets times @a slots_per_bucket
+    @c SSLSharedSessionSlot.
+
+    A slot is guarded by a sequence number, odd while the slot is written. Readers take no lock, they
+    copy the slot and check that the sequence number did not move meanwhile. A writer claims the slot
+    by moving the number to odd, and gives up if another writer has it.
+ */
+struct SSLSharedSessionHeader {
+  static constexpr uint32_t LAYOUT_MAGIC   = 0x54535343; // "TSSC"
+  static constexpr uint32_t LAYOUT_VERSION = 1;
+
+  uint32_t magic;
+  uint32_t version;
+  uint32_t nbuckets;
+  uint32_t slots_per_bucket;
+  uint32_t slot_size;
+  uint32_t reserved;
+};
+
+struct SSLSharedSessionSlot {
+  std::atomic<uint32_t> seq;
+  uint16_t id_len; ///< Zero for an empty slot.
+  uint16_t asn1_len;
+  ssl_curve_id curve;
+  int64_t inserted; ///< Seconds since the epoch, the oldest slot of a bucket is replaced first.
+  char id[TS_SSL_MAX_SSL_SESSION_ID_LENGTH];
+  unsigned char asn1[SSL_MAX_SESSION_SIZE];
+};
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free, "shared session slots need a lock free sequence number");
+
+class SSLSharedSessionTable
+{
+public:
+  /// Map @a path, creating or resetting it for this geometry. @c nullptr if it can not be mapped.
+  static SSLSharedSessionTable *open(const char *path, size_t nbuckets, size_t slots_per_bucket);
+  ~SSLSharedSessionTable();
+
+  bool getSession(const SSLSessionID &id, SSL_SESSION **sess, ssl_session_cache_exdata *data) const;
+  int getSessionBuffer(const SSLSessionID &id, char *buffer, int &len) const;
+  void insertSession(const SSLSessionID &id, SSL_SESSION *sess, SSL *ssl);
+  void removeSession(const SSLSessionID &id);
+
+private:
+  SSLSharedSessionTable(void *base, size_t size);
+
+  SSLSharedSessionSlot *bucket(const SSLSessionID &id) const;
+  /// Copy the session @a id to @a asn1, @c false if it is not there or is being written.
+  bool read(const SSLSessionID &id, unsigned char *asn1, uint16_t &asn1_len, ssl_curve_id &curve) const;
+
+  void *_base;
+  size_t _size;
+  SSLSharedSessionHeader *_header;
+  SSLSharedSessionSlot *_slots;
+};
+
 class SSLSessionCache
 {
 public:
-  bool getSession(const SSLSessionID &sid, SSL_SESSION **sess, ssl_session_cache_exdata **data) const;
+  bool getSession(const SSLSessionID &sid, SSL_SESSION **sess, ssl_session_cache_exdata *data) const;
   int getSessionBuffer(const SSLSessionID &sid, char *buffer, int &len) const;
   void insertSession(const SSLSessionID &sid, SSL_SESSION *sess, SSL *ssl);
   void removeSession(const SSLSessionID &sid);
-  SSLSessionCache();
+  /// Drop the oldest sessions of each bucket down to @a percent of them, returns the number dropped.
+  size_t trim(int percent);
+  /// With @a shared_file the sessions are kept in that file, see @c SSLSharedSessionTable.
+  explicit SSLSessionCache(const char *shared_file = nullptr);
   ~SSLSessionCache();
 
   SSLSessionCache(const SSLSessionCache &) = delete;
@@ -163,5 +229,6 @@ public:
 
 private:
   SSLSessionBucket *session_bucket = nullptr;
+  SSLSharedSessionTable *shared    = nullptr;
   size_t nbuckets;
 };
@@ -25,12 +25,17 @@
 
 #include <openssl/err.h>
 
+#include <algorithm>
+#include <string>
+
 #include "P_SSLConfig.h"
 #include "P_SSLUtils.h"
 
 RecRawStatBlock *ssl_rsb = nullptr;
 std::unordered_map<std::string, intptr_t> cipher_map;
 
+const int ssl_handshake_time_bucket_ms[SSL_HANDSHAKE_TIME_BUCKETS - 1] = {1, 5, 10, 25, 50, 100, 250, 500, 1000};
+
 static int
 SSLRecRawStatSyncCount(const char *name, RecDataT data_type, RecData *data, RecRawStatBlock *rsb, int id)
 {
@@ -48,7 +53,7 @@ SSLRecRawStatSyncCount(const char *name, RecDataT data_type, RecData *data, RecR
     for (size_t i = 0; i < ctxCount; i++) {
       SSLCertContext *cc = certLookup->get(i);
       if (cc) {
-        shared_SSL_CTX ctx = cc->getCtx();
+        shared_SSL_CTX ctx = cc->peekCtx();
         if (ctx) {
           sessions += SSL_CTX_sess_accept_good(ctx.get());
           hits += SSL_CTX_sess_hits(ctx.get());
@@ -67,6 +72,47 @@ SSLRecRawStatSyncCount(const char *name, RecDataT data_type, RecData *data, RecR
   return RecRawStatSyncCount(name, data_type, data, rsb, id);
 }
 
+// The handshake time percentile, in milliseconds, as the upper bound of the bucket it falls in. Past the
+// last bound it is that bound.
+static int
+SSLRecRawStatSyncHandshakeTimePercentile(const char *name, RecDataT data_type, RecData *data, RecRawStatBlock *rsb, int id)
+{
+  int percent = id == ssl_handshake_time_p50_stat ? 50 : id == ssl_handshake_time_p90_stat ? 90 : 99;
+
+  int64_t counts[SSL_HANDSHAKE_TIME_BUCKETS];
+  int64_t total = 0;
+  for (int i = 0; i < SSL_HANDSHAKE_TIME_BUCKETS; ++i) {
+    RecGetRawStatCount(rsb, ssl_handshake_time_bucket_stat + i, &counts[i]);
+    total += counts[i];
+  }
+
+  int64_t ms = 0;
+  if (total > 0) {
+    int64_t rank = (total * percent + 99) / 100;
+    int64_t seen = counts[0];
+    int bucket   = 0;
+    while (seen < rank && bucket < SSL_HANDSHAKE_TIME_BUCKETS - 1) {
+      seen += counts[++bucket];
+    }
+    ms = ssl_handshake_time_bucket_ms[std::min(bucket, SSL_HANDSHAKE_TIME_BUCKETS - 2)];
+  }
+
+  Debug("stats", "raw sync:handshake time percentile for %s", name);
+  ink_assert(data_type == RECD_INT);
+  data->rec_int = ms;
+  return REC_ERR_OKAY;
+}
+
+void
+SSLIncrementHandshakeTimeStat(ink_hrtime handshake_time)
+{
+  int bucket = 0;
+  while (bucket < SSL_HANDSHAKE_TIME_BUCKETS - 1 && handshake_time >= HRTIME_MSECONDS(ssl_handshake_time_bucket_ms[bucket])) {
+    ++bucket;
+  }
+  SSL_INCREMENT_DYN_STAT(ssl_handshake_time_bucket_stat + bucket);
+}
+
 void
 SSLInitializeStatistics()
 {
@@ -136,6 +182,12 @@ SSLInitializeStatistics()
                      (int)ssl_total_attempts_handshake_count_in_stat, RecRawStatSyncCount);
   RecRegisterRawStat(ssl_rsb, RECT_PROCESS, "proxy.process.ssl.total_success_handshake_count_in", RECD_COUNTER, RECP_PERSISTENT,
                      (int)ssl_total_success_handshake_count_in_stat, RecRawStatSyncCount);
+  RecRegisterRawStat(ssl_rsb, RECT_PROCESS, "proxy.process.ssl.total_resumed_handshake_count_in", RECD_COUNTER, RECP_PERSISTENT,
+                     (int)ssl_total_resumed_handshake_count_in_stat, RecRawStatSyncCount);
+  RecRegisterRawStat(ssl_rsb, RECT_PROCESS, "proxy.process.ssl.total_full_handshake_count_in", RECD_COUNTER, RECP_PERSISTENT,
+                     (int)ssl_total_full_handshake_count_in_stat, RecRawStatSyncCount);
+  RecRegisterRawStat(ssl_rsb, RECT_PROCESS, "proxy.process.ssl.resumed_handshake_ratio", RECD_FLOAT, RECP_NON_PERSISTENT,
+                     (int)ssl_resumed_handshake_ratio_stat, RecRawStatSyncAvg);
   RecRegisterRawStat(ssl_rsb, RECT_PROCESS, "proxy.process.ssl.total_attempts_handshake_count_out", RECD_COUNTER, RECP_PERSISTENT,
                      (int)ssl_total_attempts_handshake_count_out_stat, RecRawStatSyncCount);
   RecRegisterRawStat(ssl_rsb, RECT_PROCESS, "proxy.process.ssl.total_success_handshake_count_out", RECD_COUNTER, RECP_PERSISTENT,
@@ -216,6 +268,36 @@ SSLInitializeStatistics()
   // TLSv1.3 0-RTT stats
   RecRegisterRawStat(ssl_rsb, RECT_PROCESS, "proxy.process.ssl.early_data_received", RECD_INT, RECP_PERSISTENT,
                      (int)ssl_early_data_received_count, RecRawStatSyncCount);
+  RecRegisterRawStat(ssl_rsb, RECT_PROCESS, "proxy.process.ssl.early_data_rejected", RECD_INT, RECP_PERSISTENT,
+                     (int)ssl_early_data_rejected_count, RecRawStatSyncCount);
+
+  // Kernel TLS stats
+  RecRegisterRawStat(ssl_rsb, RECT_PROCESS, "proxy.process.ssl.ktls.tx_offloaded", RECD_COUNTER, RECP_PERSISTENT,
+                     (int)ssl_ktls_tx_offloaded_stat, RecRawStatSyncCount);
+  RecRegisterRawStat(ssl_rsb, RECT_PROCESS, "proxy.process.ssl.ktls.tx_unavailable", RECD_COUNTER, RECP_PERSISTENT,
+                     (int)ssl_ktls_tx_unavailable_stat, RecRawStatSyncCount);
+
+  // Private key offload stats
+  RecRegisterRawStat(ssl_rsb, RECT_PROCESS, "proxy.process.ssl.async.offloaded", RECD_COUNTER, RECP_PERSISTENT,
+                     (int)ssl_async_offloaded_stat, RecRawStatSyncCount);
+
+  // Handshake time stats
+  for (int i = 0; i < SSL_HANDSHAKE_TIME_BUCKETS; ++i) {
+    std::string stat_name = "proxy.process.ssl.handshake_time.";
+    if (i < SSL_HANDSHAKE_TIME_BUCKETS - 1) {
+      stat_name += "lt_" + std::to_string(ssl_handshake_time_bucket_ms[i]) + "ms";
+    } else {
+      stat_name += "ge_" + std::to_string(ssl_handshake_time_bucket_ms[i - 1]) + "ms";
+    }
+    RecRegisterRawStat(ssl_rsb, RECT_PROCESS, stat_name.c_str(), RECD_COUNTER, RECP_PERSISTENT,
+                       (int)ssl_handshake_time_bucket_stat + i, RecRawStatSyncCount);
+  }
+  RecRegisterRawStat(ssl_rsb, RECT_PROCESS, "proxy.process.ssl.handshake_time.p50", RECD_INT, RECP_NON_PERSISTENT,
+                     (int)ssl_handshake_time_p50_stat, SSLRecRawStatSyncHandshakeTimePercentile);
+  RecRegisterRawStat(ssl_rsb, RECT_PROCESS, "proxy.process.ssl.handshake_time.p90", RECD_INT, RECP_NON_PERSISTENT,
+                     (int)ssl_handshake_time_p90_stat, SSLRecRawStatSyncHandshakeTimePercentile);
+  RecRegisterRawStat(ssl_rsb, RECT_PROCESS, "proxy.process.ssl.handshake_time.p99", RECD_INT, RECP_NON_PERSISTENT,
+                     (int)ssl_handshake_time_p99_stat, SSLRecRawStatSyncHandshakeTimePercentile);
 
   // Get and register the SSL cipher stats. Note that we are using the default SSL context to obtain
   // the cipher list. This means that the set of ciphers is fixed by the build configuration and not
@@ -25,6 +25,7 @@
 
 #include <unordered_map>
 
+#include "tscore/ink_hrtime.h"
 #include "records/I_RecProcess.h"
 #include "SSLDiags.h"
 
@@ -38,6 +39,11 @@
     RecSetRawStatSum(ssl_rsb, (x), 0);   \
     RecSetRawStatCount(ssl_rsb, (x), 0); \
   } while (0)
+
+// Handshakes are counted by the time they took, in buckets with these upper bounds in milliseconds
+// save the last one, and the percentiles estimated from them.
+#define SSL_HANDSHAKE_TIME_BUCKETS 10
+extern const int ssl_handshake_time_bucket_ms[SSL_HANDSHAKE_TIME_BUCKETS - 1];
 #define SSL_CLR_ERR_INCR_DYN_STAT(vc, x, fmt, ...) \
   do {                                             \
     SSLVCDebug((vc), fmt, ##__VA_ARGS__);          \
@@ -70,6 +76,9 @@ enum SSL_Stats {
   ssl_total_handshake_time_stat,
   ssl_total_attempts_handshake_count_in_stat,
   ssl_total_success_handshake_count_in_stat,
+  ssl_total_resumed_handshake_count_in_stat, // successful handshakes that resumed a session
+  ssl_total_full_handshake_count_in_stat,    // successful handshakes that did not
+  ssl_resumed_handshake_ratio_stat,
   ssl_total_tickets_created_stat,
   ssl_total_tickets_verified_stat,
   ssl_total_tickets_verified_old_key_stat, // verified with old key.
@@ -85,6 +94,16 @@ enum SSL_Stats {
   ssl_session_cache_lock_contention,
   ssl_session_cache_new_session,
   ssl_early_data_received_count, // how many times we received early data
+  ssl_early_data_rejected_count, // early data refused as a possible replay
+  ssl_ktls_tx_offloaded_stat,    // handshakes after which sending was handed to kernel TLS
+  ssl_ktls_tx_unavailable_stat,  // handshakes with kernel TLS enabled which could not be offloaded
+  ssl_async_offloaded_stat,      // private key operations handed to the ET_SSL threads
+
+  /* handshake time buckets, SSL_HANDSHAKE_TIME_BUCKETS of them */
+  ssl_handshake_time_bucket_stat,
+  ssl_handshake_time_p50_stat = ssl_handshake_time_bucket_stat + SSL_HANDSHAKE_TIME_BUCKETS,
+  ssl_handshake_time_p90_stat,
+  ssl_handshake_time_p99_stat,
 
   /* error stats */
   ssl_error_syscall,
@@ -118,3 +137,6 @@ extern std::unordered_map<std::string, intptr_t> cipher_map;
 
 // Initialize SSL statistics.
 void SSLInitializeStatistics();
+
+// Count a successful server handshake in the bucket for the time it took.
+void SSLIncrementHandshakeTimeStat(ink_hrtime handshake_time);
@@ -30,6 +30,7 @@
 #include "tscore/Filenames.h"
 #include "records/I_RecHttp.h"
 #include "tscore/ts_file.h"
+#include "tscore/memory_domain.h"
 
 #include "P_Net.h"
 #include "InkAPIInternal.h"
@@ -42,7 +43,9 @@
 #include "SSLDynlock.h"
 #include "SSLDiags.h"
 #include "SSLStats.h"
+#include "SSLAsyncOffload.h"
 
+#include <mutex>
 #include <string>
 #include <unistd.h>
 #include <termios.h>
@@ -358,6 +361,69 @@ PerformAction(Continuation *cont, const char *servername)
 }
 
 #if TS_USE_HELLO_CB
+// Append the 16 bit (or 8 bit if @a width is 1) values of @a p to @a out, dash separated, skipping the GREASE ones.
+static void
+ssl_ja3_append_values(std::string &out, const unsigned char *p, size_t len, int width)
+{
+  bool first = true;
+
+  for (size_t i = 0; i + width <= len; i += width) {
+    unsigned int value = width == 1 ? p[i] : (p[i] << 8) | p[i + 1];
+    if (width == 2 && (value & 0x0f0f) == 0x0a0a && (value >> 8) == (value & 0xff)) {
+      continue;
+    }
+    if (!first) {
+      out += '-';
+    }
+    first = false;
+    out += std::to_string(value);
+  }
+}
+
+// The JA3 string of the ClientHello: version, ciphers, extensions, groups and point formats.
+static std::string
+ssl_client_hello_ja3(SSL *s)
+{
+  std::string ja3;
+  const unsigned char *p;
+  size_t len;
+  int *extensions;
+
+  ja3 += std::to_string(SSL_client_hello_get0_legacy_version(s));
+  ja3 += ',';
+  len = SSL_client_hello_get0_ciphers(s, &p);
+  ssl_ja3_append_values(ja3, p, len, 2);
+  ja3 += ',';
+
+  if (SSL_client_hello_get1_extensions_present(s, &extensions, &len) == 1) {
+    bool first = true;
+    for (size_t i = 0; i < len; ++i) {
+      unsigned int type = extensions[i];
+      if ((type & 0x0f0f) == 0x0a0a && (type >> 8) == (type & 0xff)) {
+        continue;
+      }
+      if (!first) {
+        ja3 += '-';
+      }
+      first = false;
+      ja3 += std::to_string(type);
+    }
+    OPENSSL_free(extensions);
+  }
+  ja3 += ',';
+
+  // Both lists start with their length.
+  if (SSL_client_hello_get0_ext(s, TLSEXT_TYPE_supported_groups, &p, &len) == 1 && len >= 2) {
+    ssl_ja3_append_values(ja3, p + 2, len - 2, 2);
+  }
+  ja3 += ',';
+  if (SSL_client_hello_get0_ext(s, TLSEXT_TYPE_ec_point_formats, &p, &len) == 1 && len >= 1) {
+    ssl_ja3_append_values(ja3, p + 1, len - 1, 1);
+  }
+
+  return ja3;
+}
+
 // Pausable callback
 static int
 ssl_client_hello_callback(SSL *s, int *al, void *arg)
@@ -400,6 +466,12 @@ ssl_client_hello_callback(SSL *s, int *al, void *arg)
   if (servername) {
     netvc->set_server_name(std::string_view(servername, len));
   }
+  // Only from the first ClientHello, the callback runs again when a hook paused it.
+  if (SSLConfigParams::server_ja3_fingerprint && netvc->get_ja3_fingerprint() == nullptr) {
+    netvc->set_ja3(ssl_client_hello_ja3(s));
+    Debug("ssl_ja3", "JA3 %.*s fingerprint %s", static_cast<int>(netvc->get_ja3_string().size()),
+          netvc->get_ja3_string().data(), netvc->get_ja3_fingerprint());
+  }
   int ret = PerformAction(netvc, netvc->get_server_name());
   if (ret != SSL_TLSEXT_ERR_OK) {
     return SSL_CLIENT_HELLO_ERROR;
@@ -804,12 +876,14 @@ ssl_private_key_validate_exec(const char *cmdLine)
 void *
 ssl_malloc(size_t size, const char * /*filename */, int /*lineno*/)
 {
+  MemoryDomainScope domain(MEMORY_DOMAIN_SSL);
   return ats_malloc(size);
 }
 
 void *
 ssl_realloc(void *ptr, size_t size, const char * /*filename*/, int /*lineno*/)
 {
+  MemoryDomainScope domain(MEMORY_DOMAIN_SSL);
   return ats_realloc(ptr, size);
 }
 
@@ -822,12 +896,14 @@ ssl_free(void *ptr, const char * /*filename*/, int /*lineno*/)
 void *
 ssl_track_malloc(size_t size, const char * /*filename*/, int /*lineno*/)
 {
+  MemoryDomainScope domain(MEMORY_DOMAIN_SSL);
   return ats_track_malloc(size, &ssl_memory_allocated);
 }
 
 void *
 ssl_track_realloc(void *ptr, size_t size, const char * /*filename*/, int /*lineno*/)
 {
+  MemoryDomainScope domain(MEMORY_DOMAIN_SSL);
   return ats_track_realloc(ptr, size, &ssl_memory_allocated, &ssl_memory_freed);
 }
 
@@ -959,6 +1035,12 @@ SSLPrivateKeyHandler(SSL_CTX *ctx, const SSLConfigParams *params, const std::str
     return false;
   }
 
+  // An engine does its own offload.
+  if (e == nullptr && SSLAsyncOffload::enabled() && !SSLAsyncOffload::offload_private_key(ctx)) {
+    SSLError("failed to offload the server private key operations");
+    return false;
+  }
+
   return true;
 }
 
@@ -1388,6 +1470,121 @@ SSLCreateServerContext(const SSLConfigParams *params, const SSLMultiCertConfigPa
   return ctx.release();
 }
 
+/**
+   Index @a cc by each of @a names. The first name that goes in stores the context and the others
+   are aliases to it, so they share one copy.
+ */
+static bool
+ssl_index_certificate_names(SSLCertLookup *lookup, SSLCertContext const &cc, std::set<std::string> const &names)
+{
+  int idx = -1;
+
+  for (auto const &sni_name : names) {
+    Debug("ssl", "mapping '%s'", sni_name.c_str());
+    if (idx < 0) {
+      idx = lookup->insert(sni_name.c_str(), cc);
+    } else {
+      lookup->insert(sni_name.c_str(), idx);
+    }
+  }
+
+  return idx >= 0;
+}
+
+/**
+   Build the @c SSL_CTX of a context stored by @c _store_lazy_ssl_ctx, on the first handshake that selects it.
+ */
+static shared_SSL_CTX
+ssl_build_lazy_ctx(SSLMultiCertConfigLoader::CertLoadData const &data, shared_SSLMultiCertConfigParams const &sslMultCertSettings,
+                   std::set<std::string> &names)
+{
+  SSLConfig::scoped_config params;
+  SSLMultiCertConfigLoader loader(params);
+
+  uint32_t elevate_setting = 0;
+  REC_ReadConfigInteger(elevate_setting, "proxy.config.ssl.cert.load_elevated");
+  ElevateAccess elevate_access(elevate_setting ? ElevateAccess::FILE_PRIVILEGE : 0);
+
+  shared_SSL_CTX ctx(loader.init_server_ssl_ctx(data, sslMultCertSettings.get(), names), SSL_CTX_free);
+  if (!ctx) {
+    Error("failed to build the SSL_CTX for certificate %s", data.cert_names_list.front().c_str());
+    return ctx;
+  }
+
+  // The ticket keys come from the ticket key configuration, as for the other contexts indexed by name.
+  if (sslMultCertSettings->session_ticket_enabled != 0) {
+    ticket_block_free(ssl_context_enable_tickets(ctx.get(), nullptr));
+  }
+  if (SSLConfigParams::init_ssl_ctx_cb) {
+    SSLConfigParams::init_ssl_ctx_cb(ctx.get(), true);
+  }
+
+  Debug("ssl", "built SSL_CTX for certificate %s on first use", data.cert_names_list.front().c_str());
+  return ctx;
+}
+
+/**
+   The settings of an ssl_multicert.config line that go into its contexts, which identify the line
+   between loads of the file.
+ */
+static std::string
+ssl_multicert_line_key(const SSLMultiCertConfigParams *sslMultCertSettings, const SSLConfigParams *params)
+{
+  std::string key;
+  for (const char *value : {sslMultCertSettings->addr.get(), sslMultCertSettings->cert.get(), sslMultCertSettings->ca.get(),
+                            sslMultCertSettings->key.get(), sslMultCertSettings->ocsp_response.get(),
+                            sslMultCertSettings->dialog.get(), sslMultCertSettings->servername.get()}) {
+    key.append(value ? value : "");
+    key.push_back('\n');
+  }
+  for (int value : {static_cast<int>(sslMultCertSettings->opt), sslMultCertSettings->session_ticket_enabled,
+                    sslMultCertSettings->session_ticket_number, params->ssl_session_cache_timeout,
+                    params->ssl_session_cache_auto_clear}) {
+    key.append(std::to_string(value));
+    key.push_back('\n');
+  }
+  return key;
+}
+
+/**
+   The status of the files the contexts of a line are built from, to tell when one of them changed.
+ */
+static std::string
+ssl_multicert_files_state(SSLMultiCertConfigLoader::CertLoadData const &data, const SSLConfigParams *params)
+{
+  std::vector<std::string> paths;
+  for (auto const &name : data.cert_names_list) {
+    paths.push_back(Layout::relative_to(params->serverCertPathOnly, name));
+  }
+  for (auto const &name : data.key_list) {
+    paths.push_back(Layout::relative_to(params->serverKeyPathOnly, name));
+  }
+  for (auto const &name : data.ca_list) {
+    paths.push_back(Layout::relative_to(params->serverCertPathOnly, name));
+  }
+  for (auto const &name : data.ocsp_list) {
+    paths.push_back(Layout::relative_to(params->ssl_ocsp_response_path_only, name));
+  }
+  if (params->serverCertChainFilename) {
+    paths.push_back(Layout::relative_to(params->serverCertPathOnly, params->serverCertChainFilename));
+  }
+  if (params->dhparamsFile) {
+    paths.push_back(params->dhparamsFile);
+  }
+
+  std::string state;
+  for (auto const &path : paths) {
+    struct stat sdata;
+    state.append(path);
+    if (stat(path.c_str(), &sdata) == 0) {
+      state.append(" " + std::to_string(sdata.st_ino) + " " + std::to_string(sdata.st_size) + " " +
+                   std::to_string(sdata.st_mtime) + " " + std::to_string(sdata.st_ctime));
+    }
+    state.push_back('\n');
+  }
+  return state;
+}
+
 /**
    Insert SSLCertContext (SSL_CTX ans options) into SSLCertLookup with key.
    Do NOT call SSL_CTX_set_* functions from here. SSL_CTX should be set up by SSLMultiCertConfigLoader::init_server_ssl_ctx().
@@ -1417,9 +1614,42 @@ SSLMultiCertConfigLoader::_store_ssl_ctx(SSLCertLookup *lookup, const shared_SSL
     i++;
   }
 
-  shared_SSL_CTX ctx(this->init_server_ssl_ctx(data, sslMultCertSettings.get(), common_names), SSL_CTX_free);
+  // A single certificate only named by SNI can wait for its first handshake.
+  if (this->_lazy_load_enabled() && !sslMultCertSettings->addr && data.cert_names_list.size() == 1 &&
+      sslMultCertSettings->opt == SSLCertContextOption::OPT_NONE) {
+    retval = this->_store_lazy_ssl_ctx(lookup, sslMultCertSettings, data, common_names);
+    for (auto &i : cert_list) {
+      X509_free(i);
+    }
+    return retval;
+  }
+
+  // Take over the contexts the previous load built for this line if nothing they came from changed.
+  std::string line_key = ssl_multicert_line_key(sslMultCertSettings.get(), params);
+  SSLCertLookup::LineContexts built{ssl_multicert_files_state(data, params), {}};
+  const SSLCertLookup::LineContexts *previous = nullptr;
+  if (this->_previous) {
+    auto spot = this->_previous->line_contexts.find(line_key);
+    if (spot != this->_previous->line_contexts.end() && spot->second.files == built.files) {
+      previous = &spot->second;
+    }
+  }
+
+  shared_SSL_CTX ctx;
+  bool fresh = true;
+  if (previous && previous->contexts.count(-1)) {
+    ctx   = previous->contexts.at(-1);
+    fresh = false;
+    Debug(this->_debug_tag(), "keeping the SSL_CTX for certificate %s from the previous load",
+          sslMultCertSettings->cert ? sslMultCertSettings->cert.get() : "(default)");
+  } else {
+    ctx = shared_SSL_CTX(this->init_server_ssl_ctx(data, sslMultCertSettings.get(), common_names), SSL_CTX_free);
+  }
+  if (ctx) {
+    built.contexts[-1] = ctx;
+  }
 
-  if (!ctx || !sslMultCertSettings || !this->_store_single_ssl_ctx(lookup, sslMultCertSettings, ctx, common_names)) {
+  if (!ctx || !sslMultCertSettings || !this->_store_single_ssl_ctx(lookup, sslMultCertSettings, ctx, common_names, fresh)) {
     retval = false;
     std::string names;
     for (auto name : data.cert_names_list) {
@@ -1440,12 +1670,26 @@ SSLMultiCertConfigLoader::_store_ssl_ctx(SSLCertLookup *lookup, const shared_SSL
     single_data.ca_list.push_back(i < data.ca_list.size() ? data.ca_list[i] : "");
     single_data.ocsp_list.push_back(i < data.ocsp_list.size() ? data.ocsp_list[i] : "");
 
-    shared_SSL_CTX unique_ctx(this->init_server_ssl_ctx(single_data, sslMultCertSettings.get(), iter->second), SSL_CTX_free);
-    if (!unique_ctx || !this->_store_single_ssl_ctx(lookup, sslMultCertSettings, unique_ctx, iter->second)) {
+    shared_SSL_CTX unique_ctx;
+    bool unique_fresh = true;
+    if (previous && previous->contexts.count(i)) {
+      unique_ctx   = previous->contexts.at(i);
+      unique_fresh = false;
+    } else {
+      unique_ctx = shared_SSL_CTX(this->init_server_ssl_ctx(single_data, sslMultCertSettings.get(), iter->second), SSL_CTX_free);
+    }
+    if (unique_ctx) {
+      built.contexts[i] = unique_ctx;
+    }
+    if (!unique_ctx || !this->_store_single_ssl_ctx(lookup, sslMultCertSettings, unique_ctx, iter->second, unique_fresh)) {
       retval = false;
     }
   }
 
+  if (retval) {
+    lookup->line_contexts.emplace(std::move(line_key), std::move(built));
+  }
+
   for (auto &i : cert_list) {
     X509_free(i);
   }
@@ -1455,7 +1699,7 @@ SSLMultiCertConfigLoader::_store_ssl_ctx(SSLCertLookup *lookup, const shared_SSL
 
 bool
 SSLMultiCertConfigLoader::_store_single_ssl_ctx(SSLCertLookup *lookup, const shared_SSLMultiCertConfigParams sslMultCertSettings,
-                                                shared_SSL_CTX ctx, std::set<std::string> &names)
+                                                shared_SSL_CTX ctx, std::set<std::string> &names, bool fresh)
 {
   bool inserted                        = false;
   shared_ssl_ticket_key_block keyblock = nullptr;
@@ -1486,16 +1730,13 @@ SSLMultiCertConfigLoader::_store_single_ssl_ctx(SSLCertLookup *lookup, const sha
     }
   }
 
-  // Insert additional mappings. Note that this maps multiple keys to the same value, so when
-  // this code is updated to reconfigure the SSL certificates, it will need some sort of
-  // refcounting or alternate way of avoiding double frees.
-  for (auto sni_name : names) {
-    if (SSLMultiCertConfigLoader::index_certificate(lookup, SSLCertContext(ctx, sslMultCertSettings), sni_name.c_str())) {
-      inserted = true;
-    }
+  // Insert additional mappings, all of them referring to one stored context.
+  if (ssl_index_certificate_names(lookup, SSLCertContext(ctx, sslMultCertSettings), names)) {
+    inserted = true;
   }
 
-  if (inserted) {
+  // A context kept from the previous load was already handed to the plugins.
+  if (inserted && fresh) {
     if (SSLConfigParams::init_ssl_ctx_cb) {
       SSLConfigParams::init_ssl_ctx_cb(ctx.get(), true);
     }
@@ -1508,6 +1749,29 @@ SSLMultiCertConfigLoader::_store_single_ssl_ctx(SSLCertLookup *lookup, const sha
   return ctx.get();
 }
 
+bool
+SSLMultiCertConfigLoader::_store_lazy_ssl_ctx(SSLCertLookup *lookup, const shared_SSLMultiCertConfigParams sslMultCertSettings,
+                                              CertLoadData const &data, std::set<std::string> &names)
+{
+  SSLCertContext cc(shared_SSL_CTX(), sslMultCertSettings);
+  cc.setCtxLoader([data, sslMultCertSettings, names]() mutable { return ssl_build_lazy_ctx(data, sslMultCertSettings, names); });
+
+  if (!ssl_index_certificate_names(lookup, cc, names)) {
+    Warning("(%s) Failed to insert SSL_CTX for certificate %s entries for names already made", this->_debug_tag(),
+            data.cert_names_list.front().c_str());
+    return false;
+  }
+
+  Debug(this->_debug_tag(), "deferred building the SSL_CTX for certificate %s", data.cert_names_list.front().c_str());
+  return true;
+}
+
+bool
+SSLMultiCertConfigLoader::_lazy_load_enabled() const
+{
+  return this->_params->configLazyLoad;
+}
+
 static bool
 ssl_extract_certificate(const matcher_line *line_info, SSLMultiCertConfigParams *sslMultCertSettings)
 {
@@ -1820,6 +2084,90 @@ SSLReadBuffer(SSL *ssl, void *buf, int64_t nbytes, int64_t &nread)
   return ssl_error;
 }
 
+#if TS_HAS_TLS_EARLY_DATA
+namespace
+{
+/*
+ * The tickets that early data was accepted with, in two Bloom filters of a replay window each.
+ * Early data is only taken with a ticket issued within the window, so a ticket used again is
+ * still in the filter of its first use, or in that of the window before. A false positive only
+ * costs the client a round trip, it sends the request again once the handshake is done.
+ */
+class EarlyDataReplayFilter
+{
+public:
+  // Whether @a key was seen in this window or the one before, counting it as seen from now on.
+  bool
+  seen(const void *key, int len, time_t now)
+  {
+    uint64_t epoch = now / SSLConfigParams::server_early_data_replay_window;
+    CryptoHash hash;
+    CryptoContext().hash_immediate(hash, key, len);
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_bits[0].empty()) {
+      // About 16 bits per entry and 4 of them set, a false positive every few hundred tickets when full.
+      size_t words = 1;
+      while (words * 4 < SSLConfigParams::server_early_data_replay_filter_size) {
+        words <<= 1;
+      }
+      _bits[0].assign(words, 0);
+      _bits[1].assign(words, 0);
+    }
+    auto &current = _bits[epoch & 1];
+    auto &last    = _bits[(epoch & 1) ^ 1];
+    if (_epoch[epoch & 1] != epoch) {
+      std::fill(current.begin(), current.end(), 0);
+      _epoch[epoch & 1] = epoch;
+    }
+    bool in_last    = _epoch[(epoch & 1) ^ 1] + 1 == epoch;
+    bool in_current = true;
+    uint64_t mask   = current.size() * 64 - 1;
+    for (uint64_t i = 0; i < HASHES; ++i) {
+      uint64_t bit = (hash.u64[0] + i * hash.u64[1]) & mask;
+      in_current   = in_current && (current[bit / 64] & (UINT64_C(1) << (bit % 64)));
+      in_last      = in_last && (last[bit / 64] & (UINT64_C(1) << (bit % 64)));
+      current[bit / 64] |= UINT64_C(1) << (bit % 64);
+    }
+    return in_current || in_last;
+  }
+
+private:
+  static constexpr uint64_t HASHES = 4;
+
+  std::mutex _mutex;
+  std::vector<uint64_t> _bits[2];
+  uint64_t _epoch[2] = {UINT64_MAX, UINT64_MAX};
+};
+
+EarlyDataReplayFilter early_data_replay_filter;
+} // namespace
+
+int
+ssl_allow_early_data_callback(SSL *ssl, void * /* arg ATS_UNUSED */)
+{
+  if (SSLConfigParams::server_early_data_replay_window == 0) {
+    return 1;
+  }
+
+  // The resumption secret of a TLSv1.3 session is different for each ticket.
+  SSL_SESSION *session = SSL_get_session(ssl);
+  unsigned char secret[SSL_MAX_MASTER_KEY_LENGTH];
+  size_t secret_len = session ? SSL_SESSION_get_master_key(session, secret, sizeof(secret)) : 0;
+  time_t now        = time(nullptr);
+
+  if (secret_len == 0 || now - SSL_SESSION_get_time(session) > SSLConfigParams::server_early_data_replay_window) {
+    Debug("ssl_early_data", "Rejecting early data, the ticket is older than the replay window");
+  } else if (early_data_replay_filter.seen(secret, secret_len, now)) {
+    Debug("ssl_early_data", "Rejecting early data, the ticket was used before");
+  } else {
+    return 1;
+  }
+  SSL_INCREMENT_DYN_STAT(ssl_early_data_rejected_count);
+  return 0;
+}
+#endif
+
 ssl_error_t
 SSLAccept(SSL *ssl)
 {
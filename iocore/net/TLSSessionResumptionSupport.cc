@@ -134,11 +134,10 @@ TLSSessionResumptionSupport::getSession(SSL *ssl, const unsigned char *id, int l
     hook = hook->m_link.next;
   }
 
-  SSL_SESSION *session             = nullptr;
-  ssl_session_cache_exdata *exdata = nullptr;
+  SSL_SESSION *session = nullptr;
+  ssl_session_cache_exdata exdata;
   if (session_cache->getSession(sid, &session, &exdata)) {
     ink_assert(session);
-    ink_assert(exdata);
 
     // Double check the timeout
     if (is_ssl_session_timed_out(session)) {
@@ -152,7 +151,7 @@ TLSSessionResumptionSupport::getSession(SSL *ssl, const unsigned char *id, int l
     } else {
       SSL_INCREMENT_DYN_STAT(ssl_session_cache_hit);
       this->_setSSLSessionCacheHit(true);
-      this->_setSSLCurveNID(exdata->curve);
+      this->_setSSLCurveNID(exdata.curve);
     }
   } else {
     SSL_INCREMENT_DYN_STAT(ssl_session_cache_miss);
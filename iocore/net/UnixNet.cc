@@ -25,6 +25,9 @@
 
 using namespace std::literals;
 
+/// Keep-alive connections moved off a busy thread in each run of the InactivityCop.
+#define NET_MAX_MIGRATIONS_PER_RUN 16
+
 ink_hrtime last_throttle_warning;
 ink_hrtime last_shedding_warning;
 int net_connections_throttle;
@@ -54,68 +57,96 @@ public:
     NetHandler &nh = *get_NetHandler(this_ethread());
 
     Debug("inactivity_cop_check", "Checking inactivity on Thread-ID #%d", this_ethread()->id);
-    // The rest NetEvents in cop_list which are not triggered between InactivityCop runs.
-    // Use pop() to catch any closes caused by callbacks.
-    while (NetEvent *ne = nh.cop_list.pop()) {
-      // If we cannot get the lock don't stop just keep cleaning
-      MUTEX_TRY_LOCK(lock, ne->get_mutex(), this_ethread());
-      if (!lock.is_locked()) {
-        NET_INCREMENT_DYN_STAT(inactivity_cop_lock_acquire_failure_stat);
-        continue;
-      }
-
-      if (ne->closed) {
-        nh.free_netevent(ne);
-        continue;
+    if (nh.cop_wheel) {
+      // Only the NetEvents whose next timeout has come up are looked at.
+      nh.cop_wheel->advance(now);
+      while (NetEvent *ne = nh.cop_wheel->pop_ready()) {
+        check(nh, ne, now, e);
       }
-
-      // set a default inactivity timeout if one is not set
-      if (ne->next_inactivity_timeout_at == 0 && nh.config.default_inactivity_timeout > 0) {
-        Debug("inactivity_cop", "vc: %p inactivity timeout not set, setting a default of %d", ne,
-              nh.config.default_inactivity_timeout);
-        ne->set_default_inactivity_timeout(HRTIME_SECONDS(nh.config.default_inactivity_timeout));
-        NET_INCREMENT_DYN_STAT(default_inactivity_timeout_applied_stat);
+    } else {
+      // The rest NetEvents in cop_list which are not triggered between InactivityCop runs.
+      // Use pop() to catch any closes caused by callbacks.
+      while (NetEvent *ne = nh.cop_list.pop()) {
+        check(nh, ne, now, e);
       }
-
-      if (ne->next_inactivity_timeout_at && ne->next_inactivity_timeout_at < now) {
-        if (ne->is_default_inactivity_timeout()) {
-          // track the connections that timed out due to default inactivity
-          NET_INCREMENT_DYN_STAT(default_inactivity_timeout_count_stat);
-        }
-        if (nh.keep_alive_queue.in(ne)) {
-          // only stat if the connection is in keep-alive, there can be other inactivity timeouts
-          ink_hrtime diff = (now - (ne->next_inactivity_timeout_at - ne->inactivity_timeout_in)) / HRTIME_SECOND;
-          NET_SUM_DYN_STAT(keep_alive_queue_timeout_total_stat, diff);
-          NET_INCREMENT_DYN_STAT(keep_alive_queue_timeout_count_stat);
+      // The cop_list is empty now.
+      // Let's reload the cop_list from open_list again.
+      forl_LL(NetEvent, ne, nh.open_list)
+      {
+        if (ne->get_thread() == this_ethread()) {
+          nh.cop_list.push(ne);
         }
-        Debug("inactivity_cop_verbose", "ne: %p now: %" PRId64 " timeout at: %" PRId64 " timeout in: %" PRId64, ne,
-              ink_hrtime_to_sec(now), ne->next_inactivity_timeout_at, ne->inactivity_timeout_in);
-        ne->callback(VC_EVENT_INACTIVITY_TIMEOUT, e);
-      } else if (ne->next_activity_timeout_at && ne->next_activity_timeout_at < now) {
-        Debug("inactivity_cop_verbose", "active ne: %p now: %" PRId64 " timeout at: %" PRId64 " timeout in: %" PRId64, ne,
-              ink_hrtime_to_sec(now), ne->next_activity_timeout_at, ne->active_timeout_in);
-        ne->callback(VC_EVENT_ACTIVE_TIMEOUT, e);
       }
+      // NetHandler will remove NetEvent from cop_list if it is triggered.
+      // As the NetHandler runs, the number of NetEvents in the cop_list is decreasing.
+      // NetHandler runs 100 times maximum between InactivityCop runs.
+      // Therefore we don't have to check all the NetEvents as much as open_list.
     }
-    // The cop_list is empty now.
-    // Let's reload the cop_list from open_list again.
-    forl_LL(NetEvent, ne, nh.open_list)
-    {
-      if (ne->get_thread() == this_ethread()) {
-        nh.cop_list.push(ne);
-      }
-    }
-    // NetHandler will remove NetEvent from cop_list if it is triggered.
-    // As the NetHandler runs, the number of NetEvents in the cop_list is decreasing.
-    // NetHandler runs 100 times maximum between InactivityCop runs.
-    // Therefore we don't have to check all the NetEvents as much as open_list.
 
     // Cleanup the active and keep-alive queues periodically
     nh.manage_active_queue(nullptr, true); // close any connections over the active timeout
     nh.manage_keep_alive_queue();
+    nh.migrate_keep_alive_queue();
+    nh.release_zerocopy_linger(now);
 
     return 0;
   }
+
+private:
+  void
+  check(NetHandler &nh, NetEvent *ne, ink_hrtime now, Event *e)
+  {
+    // If we cannot get the lock don't stop just keep cleaning
+    MUTEX_TRY_LOCK(lock, ne->get_mutex(), this_ethread());
+    if (!lock.is_locked()) {
+      NET_INCREMENT_DYN_STAT(inactivity_cop_lock_acquire_failure_stat);
+      nh.requeueCop(ne, now + nh.cop_wheel_tick);
+      return;
+    }
+
+    if (ne->closed) {
+      nh.free_netevent(ne);
+      return;
+    }
+
+    // set a default inactivity timeout if one is not set
+    if (ne->next_inactivity_timeout_at == 0 && nh.config.default_inactivity_timeout > 0) {
+      Debug("inactivity_cop", "vc: %p inactivity timeout not set, setting a default of %d", ne, nh.config.default_inactivity_timeout);
+      ne->set_default_inactivity_timeout(HRTIME_SECONDS(nh.config.default_inactivity_timeout));
+      NET_INCREMENT_DYN_STAT(default_inactivity_timeout_applied_stat);
+    }
+
+    if (nh.idle_buffers_due(ne, now)) {
+      nh.release_idle_buffers(ne);
+    }
+
+    bool inactive = ne->next_inactivity_timeout_at && ne->next_inactivity_timeout_at < now;
+    bool active   = !inactive && ne->next_activity_timeout_at && ne->next_activity_timeout_at < now;
+
+    // Back into the wheel before the callback, which may close it. If it survives a timeout it is
+    // looked at again next time, as it would be with the cop_list.
+    nh.requeueCop(ne, (inactive || active) ? now + nh.cop_wheel_tick : std::max(nh.cop_check_at(ne, now), now + 1));
+
+    if (inactive) {
+      if (ne->is_default_inactivity_timeout()) {
+        // track the connections that timed out due to default inactivity
+        NET_INCREMENT_DYN_STAT(default_inactivity_timeout_count_stat);
+      }
+      if (nh.keep_alive_queue.in(ne)) {
+        // only stat if the connection is in keep-alive, there can be other inactivity timeouts
+        ink_hrtime diff = (now - (ne->next_inactivity_timeout_at - ne->inactivity_timeout_in)) / HRTIME_SECOND;
+        NET_SUM_DYN_STAT(keep_alive_queue_timeout_total_stat, diff);
+        NET_INCREMENT_DYN_STAT(keep_alive_queue_timeout_count_stat);
+      }
+      Debug("inactivity_cop_verbose", "ne: %p now: %" PRId64 " timeout at: %" PRId64 " timeout in: %" PRId64, ne,
+            ink_hrtime_to_sec(now), ne->next_inactivity_timeout_at, ne->inactivity_timeout_in);
+      ne->callback(VC_EVENT_INACTIVITY_TIMEOUT, e);
+    } else if (active) {
+      Debug("inactivity_cop_verbose", "active ne: %p now: %" PRId64 " timeout at: %" PRId64 " timeout in: %" PRId64, ne,
+            ink_hrtime_to_sec(now), ne->next_activity_timeout_at, ne->active_timeout_in);
+      ne->callback(VC_EVENT_ACTIVE_TIMEOUT, e);
+    }
+  }
 };
 
 PollCont::PollCont(Ptr<ProxyMutex> &m, int pt)
@@ -170,8 +201,24 @@ PollCont::do_poll(ink_hrtime timeout)
   }
 // wait for fd's to trigger, or don't wait if timeout is 0
 #if TS_USE_EPOLL
-  pollDescriptor->result =
-    epoll_wait(pollDescriptor->epoll_fd, pollDescriptor->ePoll_Triggered_Events, POLL_DESCRIPTOR_SIZE, poll_timeout);
+  pollDescriptor->result = 0;
+  busy_poll_hit          = false;
+  // If the last wakeup harvested enough events the thread is busy, so spin on a non-blocking poll for
+  // a short while before going to sleep. This trades CPU on a dedicated core for wakeup latency.
+  if (net_handler && net_config_poll_busy_spin > 0 && poll_timeout != 0 && last_result >= net_config_poll_busy_threshold) {
+    ink_hrtime spin_until = Thread::get_hrtime_updated() +
+                            std::min(HRTIME_USECONDS(net_config_poll_busy_spin), HRTIME_MSECONDS(poll_timeout));
+    do {
+      pollDescriptor->result =
+        epoll_wait(pollDescriptor->epoll_fd, pollDescriptor->ePoll_Triggered_Events, net_config_poll_max_events, 0);
+    } while (pollDescriptor->result == 0 && Thread::get_hrtime_updated() < spin_until);
+    busy_poll_hit = pollDescriptor->result > 0;
+  }
+  if (pollDescriptor->result <= 0) {
+    pollDescriptor->result =
+      epoll_wait(pollDescriptor->epoll_fd, pollDescriptor->ePoll_Triggered_Events, net_config_poll_max_events, poll_timeout);
+  }
+  last_result = pollDescriptor->result;
   NetDebug("v_iocore_net_poll", "[PollCont::pollEvent] epoll_fd: %d, timeout: %d, results: %d", pollDescriptor->epoll_fd,
            poll_timeout, pollDescriptor->result);
 #elif TS_USE_KQUEUE
@@ -179,7 +226,7 @@ PollCont::do_poll(ink_hrtime timeout)
   tv.tv_sec  = poll_timeout / 1000;
   tv.tv_nsec = 1000000 * (poll_timeout % 1000);
   pollDescriptor->result =
-    kevent(pollDescriptor->kqueue_fd, nullptr, 0, pollDescriptor->kq_Triggered_Events, POLL_DESCRIPTOR_SIZE, &tv);
+    kevent(pollDescriptor->kqueue_fd, nullptr, 0, pollDescriptor->kq_Triggered_Events, net_config_poll_max_events, &tv);
   NetDebug("v_iocore_net_poll", "[PollCont::pollEvent] kqueue_fd: %d, timeout: %d, results: %d", pollDescriptor->kqueue_fd,
            poll_timeout, pollDescriptor->result);
 #elif TS_USE_PORT
@@ -188,8 +235,8 @@ PollCont::do_poll(ink_hrtime timeout)
   ptimeout.tv_sec  = poll_timeout / 1000;
   ptimeout.tv_nsec = 1000000 * (poll_timeout % 1000);
   unsigned nget    = 1;
-  if ((retval = port_getn(pollDescriptor->port_fd, pollDescriptor->Port_Triggered_Events, POLL_DESCRIPTOR_SIZE, &nget, &ptimeout)) <
-      0) {
+  if ((retval = port_getn(pollDescriptor->port_fd, pollDescriptor->Port_Triggered_Events, net_config_poll_max_events, &nget,
+                          &ptimeout)) < 0) {
     pollDescriptor->result = 0;
     switch (errno) {
     case EINTR:
@@ -208,7 +255,7 @@ PollCont::do_poll(ink_hrtime timeout)
   }
   NetDebug("v_iocore_net_poll", "[PollCont::pollEvent] %d[%s]=port_getn(%d,%p,%d,%d,%d),results(%d)", retval,
            retval < 0 ? strerror(errno) : "ok", pollDescriptor->port_fd, pollDescriptor->Port_Triggered_Events,
-           POLL_DESCRIPTOR_SIZE, nget, poll_timeout, pollDescriptor->result);
+           net_config_poll_max_events, nget, poll_timeout, pollDescriptor->result);
 #else
 #error port me
 #endif
@@ -247,6 +294,10 @@ initialize_thread_for_net(EThread *thread)
   REC_ReadConfigInteger(cop_freq, "proxy.config.net.inactivity_check_frequency");
   memcpy(&nh->config, &NetHandler::global_config, sizeof(NetHandler::global_config));
   nh->configure_per_thread_values();
+  if (thread_timer_wheel) {
+    nh->cop_wheel_tick = HRTIME_SECONDS(cop_freq);
+    nh->cop_wheel      = new NetTimingWheel(nh->cop_wheel_tick, Thread::get_hrtime());
+  }
   thread->schedule_every(inactivityCop, HRTIME_SECONDS(cop_freq));
 
   thread->set_tail_handler(nh);
@@ -489,12 +540,33 @@ NetHandler::waitForActivity(ink_hrtime timeout)
 
   process_enabled_list();
 
-  // Polling event by PollCont
+  // Polling event by PollCont. Events enqueued from other threads while we are in epoll write to
+  // the thread's eventfd, which is in the poll set.
   PollCont *p = get_PollCont(this->thread);
+  if (!this->thread->EventQueueExternal.prepare_to_sleep()) {
+    timeout = 0;
+  }
+  // Wake up for the connections waiting on the pacer, rounded up to what the poll resolves.
+  if (pacer.next_release != 0 && timeout != 0) {
+    ink_hrtime wait = std::max<ink_hrtime>(pacer.next_release - Thread::get_hrtime(), 0);
+    if (wait > 0) {
+      wait = HRTIME_MSECONDS(1 + ink_hrtime_to_msec(wait - 1));
+    }
+    if (timeout < 0 || wait < timeout) {
+      timeout = wait;
+    }
+  }
   p->do_poll(timeout);
+  this->thread->EventQueueExternal.wake_up();
 
   // Get & Process polling result
   PollDescriptor *pd = get_PollDescriptor(this->thread);
+  if (pd->result > 0) {
+    NET_SUM_DYN_STAT(net_poll_events_stat, pd->result);
+    if (p->busy_poll_hit) {
+      NET_INCREMENT_DYN_STAT(net_busy_poll_hits_stat);
+    }
+  }
   NetEvent *ne       = nullptr;
   for (int x = 0; x < pd->result; x++) {
     epd = static_cast<EventIO *> get_ev_data(pd, x);
@@ -544,6 +616,7 @@ NetHandler::waitForActivity(ink_hrtime timeout)
 
   pd->result = 0;
 
+  pacer.release(this, Thread::get_hrtime());
   process_ready_list();
 
   return EVENT_CONT;
@@ -614,6 +687,16 @@ NetHandler::manage_active_queue(NetEvent *enabling_ne, bool ignore_queue_size =
   return false; // failed to make room in the queue, all connections are active
 }
 
+void
+NetHandler::release_zerocopy_linger(ink_hrtime now)
+{
+  while (zerocopy_linger.head && zerocopy_linger.head->release_at <= now) {
+    NetZeroCopySend *zs = zerocopy_linger.dequeue();
+    zs->blocks          = nullptr;
+    netZeroCopySendAllocator.free(zs);
+  }
+}
+
 void
 NetHandler::configure_per_thread_values()
 {
@@ -661,6 +744,43 @@ NetHandler::manage_keep_alive_queue()
   }
 }
 
+void
+NetHandler::migrate_keep_alive_queue()
+{
+  if (!net_config_keep_alive_migration || keep_alive_queue.empty()) {
+    return;
+  }
+  EThread *self   = this_ethread();
+  EThread *target = eventProcessor.least_loaded_thread(ET_NET);
+  int gap         = self->load.load(std::memory_order_relaxed) - target->load.load(std::memory_order_relaxed);
+  if (target == self || gap < net_config_thread_load_gap) {
+    return;
+  }
+
+  // A few at a time, the load of the target goes up with each of them and is looked at again
+  // on the next run.
+  NetEvent *ne_next = nullptr;
+  int moved         = 0;
+  for (NetEvent *ne = keep_alive_queue.head; ne != nullptr && moved < NET_MAX_MIGRATIONS_PER_RUN; ne = ne_next) {
+    ne_next = ne->keep_alive_queue_link.next;
+    if (ne->migrate_cont == nullptr || ne->get_thread() != self) {
+      continue;
+    }
+    MUTEX_TRY_LOCK(lock, ne->get_mutex(), self);
+    if (!lock.is_locked()) {
+      continue;
+    }
+    if (ne->migrate_cont->handleEvent(NET_EVENT_MIGRATE, target) == EVENT_DONE) {
+      ++moved;
+    }
+  }
+
+  if (moved > 0) {
+    NET_SUM_DYN_STAT(net_keep_alive_migrations_stat, moved);
+    Debug("net_queue", "offered %d keep-alive connections to a thread %d points less loaded", moved, gap);
+  }
+}
+
 void
 NetHandler::_close_ne(NetEvent *ne, ink_hrtime now, int &handle_event, int &closed, int &total_idle_time, int &total_idle_count)
 {
@@ -714,9 +834,16 @@ NetHandler::add_to_keep_alive_queue(NetEvent *ne)
     // in the active queue or no queue, new to this queue
     remove_from_active_queue(ne);
     ++keep_alive_queue_size;
+    NET_INCREMENT_DYN_STAT(net_keep_alive_connections_stat);
+    ne->keep_alive_at         = Thread::get_hrtime();
+    ne->idle_buffers_released = false;
   }
   keep_alive_queue.enqueue(ne);
 
+  int64_t bytes = ne->idle_buffers_released ? 0 : ne->idle_buffer_bytes();
+  NET_SUM_DYN_STAT(net_keep_alive_buffer_bytes_stat, bytes - ne->keep_alive_buffer_bytes);
+  ne->keep_alive_buffer_bytes = bytes;
+
   // if keep-alive queue is over size then close connections
   manage_keep_alive_queue();
 }
@@ -730,7 +857,24 @@ NetHandler::remove_from_keep_alive_queue(NetEvent *ne)
   if (keep_alive_queue.in(ne)) {
     keep_alive_queue.remove(ne);
     --keep_alive_queue_size;
+    NET_DECREMENT_DYN_STAT(net_keep_alive_connections_stat);
+    NET_SUM_DYN_STAT(net_keep_alive_buffer_bytes_stat, -ne->keep_alive_buffer_bytes);
+    ne->keep_alive_buffer_bytes = 0;
+    ne->keep_alive_at           = 0;
+  }
+}
+
+void
+NetHandler::release_idle_buffers(NetEvent *ne)
+{
+  int64_t bytes             = ne->release_idle_buffers();
+  ne->idle_buffers_released = true;
+  if (bytes > 0) {
+    NET_INCREMENT_DYN_STAT(net_idle_buffers_released_stat);
+    NET_SUM_DYN_STAT(net_idle_buffer_bytes_released_stat, bytes);
   }
+  NET_SUM_DYN_STAT(net_keep_alive_buffer_bytes_stat, -ne->keep_alive_buffer_bytes);
+  ne->keep_alive_buffer_bytes = 0;
 }
 
 bool
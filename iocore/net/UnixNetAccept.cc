@@ -22,9 +22,14 @@
  */
 
 #include <tscore/TSSystemState.h>
+#include "tscore/memory_pressure.h"
 
 #include "P_Net.h"
 
+#if defined(SO_ATTACH_REUSEPORT_CBPF)
+#include <linux/filter.h>
+#endif
+
 #ifdef ROUNDUP
 #undef ROUNDUP
 #endif
@@ -43,6 +48,40 @@ safe_delay(int msec)
   socketManager.poll(nullptr, 0, msec);
 }
 
+// Under hard memory pressure all the accept threads together take in at most
+// proxy.config.memory.governor.accept_rate connections a second.
+static bool
+check_memory_throttle()
+{
+  if (net_config_memory_accept_rate <= 0 || ats_memory_pressure_level() < MEMORY_PRESSURE_HARD) {
+    return false;
+  }
+  static std::atomic<ink_hrtime> window{0};
+  static std::atomic<int> accepted{0};
+  ink_hrtime now   = Thread::get_hrtime();
+  ink_hrtime start = window.load(std::memory_order_relaxed);
+  if (now - start >= HRTIME_SECOND && window.compare_exchange_strong(start, now)) {
+    accepted = 0;
+  }
+  return accepted.fetch_add(1, std::memory_order_relaxed) >= net_config_memory_accept_rate;
+}
+
+// The thread a new connection goes to, @a self if the accepting thread may keep it. With
+// proxy.config.net.load_aware_accept the threads are picked by load rather than in turn, and
+// @a self keeps the connection unless it is busier by proxy.config.net.thread_load_gap.
+static EThread *
+accept_thread_for(EventType etype, EThread *self)
+{
+  if (!net_config_load_aware_accept) {
+    return self ? self : eventProcessor.assign_thread(etype);
+  }
+  EThread *t = eventProcessor.assign_thread_by_load(etype);
+  if (self && self->load.load(std::memory_order_relaxed) < t->load.load(std::memory_order_relaxed) + net_config_thread_load_gap) {
+    return self;
+  }
+  return t;
+}
+
 //
 // General case network connection accept code
 //
@@ -107,11 +146,9 @@ net_accept(NetAccept *na, void *ep, bool blockable)
 #endif
     SET_CONTINUATION_HANDLER(vc, (NetVConnHandler)&UnixNetVConnection::acceptEvent);
 
-    EThread *t;
-    NetHandler *h;
-    if (e->ethread->is_event_type(na->opt.etype)) {
-      t = e->ethread;
-      h = get_NetHandler(t);
+    EThread *t    = accept_thread_for(na->opt.etype, e->ethread->is_event_type(na->opt.etype) ? e->ethread : nullptr);
+    NetHandler *h = get_NetHandler(t);
+    if (t == e->ethread) {
       // Assign NetHandler->mutex to NetVC
       vc->mutex = h->mutex;
       MUTEX_TRY_LOCK(lock, h->mutex, t);
@@ -121,8 +158,6 @@ net_accept(NetAccept *na, void *ep, bool blockable)
         vc->handleEvent(EVENT_NONE, e);
       }
     } else {
-      t = eventProcessor.assign_thread(na->opt.etype);
-      h = get_NetHandler(t);
       // Assign NetHandler->mutex to NetVC
       vc->mutex = h->mutex;
       t->schedule_imm(vc);
@@ -201,19 +236,82 @@ NetAccept::init_accept(EThread *t)
   t->schedule_every(this, period);
 }
 
-int
-NetAccept::accept_per_thread(int event, void *ep)
+#if defined(SO_ATTACH_REUSEPORT_CBPF) && defined(SKF_AD_CPU)
+/** Steer connections in a @c SO_REUSEPORT group to the thread running on the CPU that received them.
+
+    The group sockets must have been bound in thread order, so that socket @c i belongs to thread
+    @c i of @a etype. Each CPU is mapped to the thread with the narrowest affinity mask containing
+    it, CPUs which are not mapped (or when affinity is not in use) are spread by CPU number modulo
+    the number of threads.
+ */
+static void
+attach_reuseport_cpu_steering(int fd, EventType etype)
 {
-  int listen_per_thread = 0;
-  REC_ReadConfigInteger(listen_per_thread, "proxy.config.exec_thread.listen");
+  auto &group = eventProcessor.thread_group[etype];
+  int n       = group._count;
+  int ncpu    = std::min(ink_number_of_processors(), CPU_SETSIZE);
+  std::vector<cpu_set_t> masks(n);
+  std::vector<sock_filter> prog;
+
+  for (int i = 0; i < n; ++i) {
+    if (pthread_getaffinity_np(group._thread[i]->tid, sizeof(cpu_set_t), &masks[i]) != 0) {
+      CPU_ZERO(&masks[i]);
+    }
+  }
 
-  if (listen_per_thread == 1) {
-    if (do_listen(NON_BLOCKING)) {
-      Fatal("[NetAccept::accept_per_thread]:error listenting on ports");
-      return -1;
+  prog.push_back(BPF_STMT(BPF_LD | BPF_W | BPF_ABS, static_cast<uint32_t>(SKF_AD_OFF + SKF_AD_CPU)));
+  for (int cpu = 0; cpu < ncpu; ++cpu) {
+    std::vector<int> candidates;
+    int narrowest = CPU_SETSIZE + 1;
+    for (int i = 0; i < n; ++i) {
+      if (CPU_ISSET(cpu, &masks[i])) {
+        int width = CPU_COUNT(&masks[i]);
+        if (width < narrowest) {
+          narrowest = width;
+          candidates.clear();
+        }
+        if (width == narrowest) {
+          candidates.push_back(i);
+        }
+      }
     }
+    if (candidates.empty()) {
+      continue;
+    }
+    int idx = candidates[cpu % candidates.size()];
+    if (idx != cpu % n) {
+      prog.push_back(BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, static_cast<uint32_t>(cpu), 0, 1));
+      prog.push_back(BPF_STMT(BPF_RET | BPF_K, static_cast<uint32_t>(idx)));
+      Debug("iocore_net_accept", "steering CPU %d to listen socket %d", cpu, idx);
+    }
+  }
+  if (prog.size() + 2 > BPF_MAXINSNS) {
+    Warning("too many CPUs to map to listen sockets, falling back to CPU modulo %d steering", n);
+    prog.resize(1);
   }
+  prog.push_back(BPF_STMT(BPF_ALU | BPF_MOD | BPF_K, static_cast<uint32_t>(n)));
+  prog.push_back(BPF_STMT(BPF_RET | BPF_A, 0));
+
+  sock_fprog fprog;
+  fprog.len    = prog.size();
+  fprog.filter = prog.data();
+  if (setsockopt(fd, SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF, &fprog, sizeof(fprog)) < 0) {
+    Warning("unable to attach SO_REUSEPORT CPU steering program: %s", strerror(errno));
+  } else {
+    Debug("iocore_net_accept", "attached SO_REUSEPORT CPU steering program (%zu instructions) for %d threads", prog.size(), n);
+  }
+}
+#else
+static void
+attach_reuseport_cpu_steering(int, EventType)
+{
+  Warning("proxy.config.exec_thread.listen_cpu_steering is not supported on this platform");
+}
+#endif
 
+int
+NetAccept::accept_per_thread(int event, void *ep)
+{
   if (accept_fn == net_accept) {
     SET_HANDLER((NetAcceptHandler)&NetAccept::acceptFastEvent);
   } else {
@@ -246,12 +344,37 @@ NetAccept::init_accept_per_thread()
   SET_HANDLER((NetAcceptHandler)&NetAccept::accept_per_thread);
   n = eventProcessor.thread_group[opt.etype]._count;
 
+  int first_fd = NO_FD;
   for (i = 0; i < n; i++) {
     NetAccept *a = (i < n - 1) ? clone() : this;
     EThread *t   = eventProcessor.thread_group[opt.etype]._thread[i];
     a->mutex     = get_NetHandler(t)->mutex;
+    if (listen_per_thread == 1) {
+      // Listen here rather than on the target thread so the SO_REUSEPORT group is built in thread order.
+      if (a->do_listen(NON_BLOCKING)) {
+        Fatal("[NetAccept::accept_per_thread]:error listenting on ports");
+        return;
+      }
+      if (i == 0) {
+        first_fd = a->server.fd;
+      }
+    }
     t->schedule_imm(a);
   }
+
+  if (listen_per_thread == 1 && n > 1) {
+    int steering = 0;
+    REC_ReadConfigInteger(steering, "proxy.config.exec_thread.listen_cpu_steering");
+    if (steering) {
+      if (server.fd == first_fd) {
+        // Inherited listen socket, the threads share it and there is no group to steer.
+        Warning("exec_thread.listen_cpu_steering requires per thread listen sockets, port %d is shared",
+                ats_ip_port_host_order(&server.accept_addr));
+      } else {
+        attach_reuseport_cpu_steering(server.fd, opt.etype);
+      }
+    }
+  }
 }
 
 void
@@ -319,6 +442,11 @@ NetAccept::do_blocking_accept(EThread *t)
       NET_SUM_DYN_STAT(net_connections_throttled_in_stat, 1);
       continue;
     }
+    if (!opt.backdoor && check_memory_throttle()) {
+      con.close();
+      NET_SUM_DYN_STAT(net_connections_memory_capped_in_stat, 1);
+      continue;
+    }
 
     if (TSSystemState::is_event_system_shut_down()) {
       return -1;
@@ -356,7 +484,7 @@ NetAccept::do_blocking_accept(EThread *t)
 #endif
     SET_CONTINUATION_HANDLER(vc, (NetVConnHandler)&UnixNetVConnection::acceptEvent);
 
-    EThread *localt = eventProcessor.assign_thread(opt.etype);
+    EThread *localt = accept_thread_for(opt.etype, nullptr);
     NetHandler *h   = get_NetHandler(localt);
     // Assign NetHandler->mutex to NetVC
     vc->mutex = h->mutex;
@@ -432,6 +560,11 @@ NetAccept::acceptFastEvent(int event, void *ep)
         NET_SUM_DYN_STAT(net_connections_throttled_in_stat, 1);
         continue;
       }
+      if (!opt.backdoor && check_memory_throttle()) {
+        con.close();
+        NET_SUM_DYN_STAT(net_connections_memory_capped_in_stat, 1);
+        continue;
+      }
       Debug("iocore_net", "accepted a new socket: %d", fd);
       NET_SUM_GLOBAL_DYN_STAT(net_tcp_accept_stat, 1);
       if (opt.send_bufsize > 0) {
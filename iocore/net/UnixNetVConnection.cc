@@ -27,12 +27,18 @@
 #include "Log.h"
 
 #include <termios.h>
+#include <typeinfo>
+
+#if TS_USE_NET_ZEROCOPY
+#include <linux/errqueue.h>
+#endif
 
 #define STATE_VIO_OFFSET ((uintptr_t) & ((NetState *)0)->vio)
 #define STATE_FROM_VIO(_x) ((NetState *)(((char *)(_x)) - STATE_VIO_OFFSET))
 
 // Global
 ClassAllocator<UnixNetVConnection> netVCAllocator("netVCAllocator");
+ClassAllocator<NetZeroCopySend> netZeroCopySendAllocator("netZeroCopySendAllocator");
 
 //
 // Reschedule a UnixNetVConnection by moving it
@@ -177,6 +183,78 @@ write_signal_error(NetHandler *nh, UnixNetVConnection *vc, int lerrno)
   return write_signal_done(VC_EVENT_ERROR, nh, vc);
 }
 
+#if TS_USE_NET_SPLICE
+// Read into the splice pipe of a UnixNetVConnection instead of its
+// read buffer. Signals the same events as read_from_net.
+static void
+read_from_net_splice(NetHandler *nh, UnixNetVConnection *vc, EThread *thread, const ProxyMutex *locked)
+{
+  NetState *s       = &vc->read;
+  ProxyMutex *mutex = thread->mutex.get();
+  NetSplicePipe *p  = vc->read_splice.get();
+  int64_t toread    = std::min(s->vio.ntodo(), p->size - p->pending);
+
+  // The pipe is full, the write draining it reenables the read.
+  if (toread <= 0) {
+    read_disable(nh, vc);
+    return;
+  }
+
+  int64_t r = splice(vc->con.fd, nullptr, p->fd[1], nullptr, toread, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+  NET_INCREMENT_DYN_STAT(net_calls_to_read_stat);
+  if (r < 0) {
+    r = -errno;
+  }
+
+  if (r <= 0) {
+    // The pipe can run out of pages before it is full, the socket still has data then.
+    if (r == -EAGAIN && p->pending > 0) {
+      read_disable(nh, vc);
+      return;
+    }
+    if (r == -EAGAIN || r == -ENOTCONN) {
+      NET_INCREMENT_DYN_STAT(net_calls_to_read_nodata_stat);
+      vc->read.triggered = 0;
+      nh->read_ready_list.remove(vc);
+      return;
+    }
+    if (!r || r == -ECONNRESET) {
+      vc->read.triggered = 0;
+      nh->read_ready_list.remove(vc);
+      read_signal_done(VC_EVENT_EOS, nh, vc);
+      return;
+    }
+    vc->read.triggered = 0;
+    read_signal_error(nh, vc, static_cast<int>(-r));
+    return;
+  }
+  NET_SUM_DYN_STAT(net_read_bytes_stat, r);
+  NET_SUM_DYN_STAT(net_splice_bytes_stat, r);
+
+  p->pending += r;
+  s->vio.ndone += r;
+  net_activity(vc, thread);
+
+  if (s->vio.ntodo() <= 0) {
+    read_signal_done(VC_EVENT_READ_COMPLETE, nh, vc);
+    return;
+  }
+  if (read_signal_and_update(VC_EVENT_READ_READY, vc) != EVENT_CONT) {
+    return;
+  }
+  // change of lock... don't look at shared variables!
+  if (locked != s->vio.mutex.get()) {
+    read_reschedule(nh, vc);
+    return;
+  }
+  if (s->vio.ntodo() <= 0 || !s->enabled || !vc->read_splice || vc->read_splice->pending >= vc->read_splice->size) {
+    read_disable(nh, vc);
+    return;
+  }
+  read_reschedule(nh, vc);
+}
+#endif
+
 // Read the data for a UnixNetVConnection.
 // Rescheduling the UnixNetVConnection by moving the VC
 // onto or off of the ready_list.
@@ -217,6 +295,12 @@ read_from_net(NetHandler *nh, UnixNetVConnection *vc, EThread *thread)
     read_disable(nh, vc);
     return;
   }
+#if TS_USE_NET_SPLICE
+  if (vc->read_splice) {
+    read_from_net_splice(nh, vc, thread, lock.get_mutex());
+    return;
+  }
+#endif
   int64_t toread = buf.writer()->write_avail();
   if (toread > ntodo) {
     toread = ntodo;
@@ -286,6 +370,7 @@ read_from_net(NetHandler *nh, UnixNetVConnection *vc, EThread *thread)
       return;
     }
     NET_SUM_DYN_STAT(net_read_bytes_stat, r);
+    vc->adapt_read_buffer(buf.writer(), toread, r, ntodo, thread);
 
     // Add data to buffer and signal continuation.
     buf.writer()->fill(r);
@@ -328,6 +413,27 @@ read_from_net(NetHandler *nh, UnixNetVConnection *vc, EThread *thread)
   read_reschedule(nh, vc);
 }
 
+// Account for a read of @a nread bytes into @a buf, which had @a offered bytes of space, for a VIO
+// that wanted @a ntodo bytes.
+void
+UnixNetVConnection::adapt_read_buffer(MIOBuffer *buf, int64_t offered, int64_t nread, int64_t ntodo, EThread *t)
+{
+  ProxyMutex *mutex = t->mutex.get();
+
+  if (BUFFER_SIZE_INDEX_IS_FAST_ALLOCATED(buf->size_index)) {
+    NET_SUM_DYN_STAT(net_read_buffer_bytes_stat + buf->size_index, nread);
+  }
+  // A read that took all the VIO wanted says nothing about what else is waiting.
+  if (net_config_read_buffer_adaptive && (nread < offered || offered < ntodo)) {
+    int change = read_sizer.update(buf, offered, nread, BUFFER_SIZE_INDEX_1K, net_config_read_buffer_max_index);
+    if (change > 0) {
+      NET_INCREMENT_DYN_STAT(net_read_buffer_grows_stat);
+    } else if (change < 0) {
+      NET_INCREMENT_DYN_STAT(net_read_buffer_shrinks_stat);
+    }
+  }
+}
+
 //
 // Write the data for a UnixNetVConnection.
 // Rescheduling the UnixNetVConnection when necessary.
@@ -343,6 +449,68 @@ write_to_net(NetHandler *nh, UnixNetVConnection *vc, EThread *thread)
   write_to_net_io(nh, vc, thread);
 }
 
+#if TS_USE_NET_SPLICE
+// Write from the splice pipe of a UnixNetVConnection, once its
+// write buffer is empty.
+static void
+write_to_net_splice(NetHandler *nh, UnixNetVConnection *vc, EThread *thread, const ProxyMutex *locked)
+{
+  NetState *s       = &vc->write;
+  ProxyMutex *mutex = thread->mutex.get();
+  NetSplicePipe *p  = vc->write_splice.get();
+  int64_t towrite   = std::min(s->vio.ntodo(), p->pending);
+
+  // Nothing in the pipe yet, the read filling it reenables the write.
+  if (towrite <= 0) {
+    write_disable(nh, vc);
+    return;
+  }
+
+  int64_t r = splice(p->fd[0], nullptr, vc->con.fd, nullptr, towrite, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+  NET_INCREMENT_DYN_STAT(net_calls_to_write_stat);
+  if (r < 0) {
+    r = -errno;
+  }
+
+  if (r <= 0) {
+    if (r == -EAGAIN || r == -ENOTCONN) {
+      NET_INCREMENT_DYN_STAT(net_calls_to_write_nodata_stat);
+      vc->write.triggered = 0;
+      nh->write_ready_list.remove(vc);
+      write_reschedule(nh, vc);
+      return;
+    }
+    vc->write.triggered = 0;
+    write_signal_error(nh, vc, static_cast<int>(-r));
+    return;
+  }
+  NET_SUM_DYN_STAT(net_write_bytes_stat, r);
+
+  p->pending -= r;
+  s->vio.ndone += r;
+  net_activity(vc, thread);
+
+  if (s->vio.ntodo() <= 0) {
+    write_signal_done(VC_EVENT_WRITE_COMPLETE, nh, vc);
+    return;
+  }
+  // The pipe has room again, which lets the producer read more.
+  if (write_signal_and_update(VC_EVENT_WRITE_READY, vc) != EVENT_CONT) {
+    return;
+  }
+  // change of lock... don't look at shared variables!
+  if (locked != s->vio.mutex.get()) {
+    write_reschedule(nh, vc);
+    return;
+  }
+  if (!vc->write_splice || vc->write_splice->pending <= 0) {
+    write_disable(nh, vc);
+    return;
+  }
+  write_reschedule(nh, vc);
+}
+#endif
+
 void
 write_to_net_io(NetHandler *nh, UnixNetVConnection *vc, EThread *thread)
 {
@@ -414,6 +582,14 @@ write_to_net_io(NetHandler *nh, UnixNetVConnection *vc, EThread *thread)
   MIOBufferAccessor &buf = s->vio.buffer;
   ink_assert(buf.writer());
 
+#if TS_USE_NET_SPLICE
+  // What was put in the buffer before the splice started goes first.
+  if (vc->write_splice && !buf.reader()->is_read_avail_more_than(0)) {
+    write_to_net_splice(nh, vc, thread, lock.get_mutex());
+    return;
+  }
+#endif
+
   // Calculate the amount to write.
   int64_t towrite = buf.reader()->read_avail();
   if (towrite > ntodo) {
@@ -450,6 +626,18 @@ write_to_net_io(NetHandler *nh, UnixNetVConnection *vc, EThread *thread)
     return;
   }
 
+  // Over its rate the connection waits off the ready list until the pacer lets it go.
+  bool was_waiting = vc->pacing_waiting;
+  int64_t allowed  = nh->pacer.admit(vc, towrite, Thread::get_hrtime());
+  if (allowed <= 0) {
+    if (!was_waiting) {
+      NET_INCREMENT_DYN_STAT(net_pacing_waits_stat);
+    }
+    nh->write_ready_list.remove(vc);
+    return;
+  }
+  towrite = std::min(towrite, allowed);
+
   int needs             = 0;
   int64_t total_written = 0;
   int64_t r             = vc->load_buffer_and_write(towrite, buf, total_written, needs);
@@ -457,6 +645,7 @@ write_to_net_io(NetHandler *nh, UnixNetVConnection *vc, EThread *thread)
   if (total_written > 0) {
     NET_SUM_DYN_STAT(net_write_bytes_stat, total_written);
     s->vio.ndone += total_written;
+    nh->pacer.spent(vc, total_written);
     net_activity(vc, thread);
   }
 
@@ -526,6 +715,12 @@ write_to_net_io(NetHandler *nh, UnixNetVConnection *vc, EThread *thread)
     }
 
     if (!(buf.reader()->is_read_avail_more_than(0))) {
+#if TS_USE_NET_SPLICE
+      if (vc->write_splice && vc->write_splice->pending > 0) {
+        write_reschedule(nh, vc);
+        return;
+      }
+#endif
       write_disable(nh, vc);
       return;
     }
@@ -577,6 +772,87 @@ UnixNetVConnection::outstanding()
   return n;
 }
 
+bool
+UnixNetVConnection::sample_tcp_info(NetVCTcpInfo &info)
+{
+#if defined(TCP_INFO) && defined(HAVE_STRUCT_TCP_INFO)
+  struct tcp_info ti;
+  socklen_t len = sizeof(ti);
+
+  if (closed || this->get_socket() == NO_FD || getsockopt(this->get_socket(), IPPROTO_TCP, TCP_INFO, &ti, &len) != 0) {
+    return false;
+  }
+  info.rtt_us        = ti.tcpi_rtt;
+  info.rttvar_us     = ti.tcpi_rttvar;
+  info.cwnd          = ti.tcpi_snd_cwnd;
+  info.mss           = ti.tcpi_snd_mss;
+  info.retransmits   = ti.tcpi_total_retrans;
+  info.delivery_rate = 0;
+#if HAVE_STRUCT_TCP_INFO_TCPI_DELIVERY_RATE
+  // Older kernels return a shorter structure without it.
+  if (len >= offsetof(struct tcp_info, tcpi_delivery_rate) + sizeof(ti.tcpi_delivery_rate)) {
+    info.delivery_rate = ti.tcpi_delivery_rate;
+  }
+#endif
+  if (info.delivery_rate == 0 && info.rtt_us > 0) {
+    info.delivery_rate = info.bdp() * 1000000 / info.rtt_us;
+  }
+  info.valid = true;
+  return true;
+#else
+  return false;
+#endif
+}
+
+void
+UnixNetVConnection::set_pacing(int64_t rate, std::string_view group)
+{
+  NetPacingGroup *pacing = group.empty() ? nullptr : NetPacingGroup::find(group);
+
+  if (!group.empty() && !pacing) {
+    Debug("net_pacing", "no pacing group %.*s", static_cast<int>(group.size()), group.data());
+  }
+  if (rate == pacing_bucket.rate && pacing == pacing_group) {
+    return;
+  }
+  if (nh && pacing_waiting) {
+    // It waits for tokens it may no longer need, it writes again and finds out.
+    SCOPED_MUTEX_LOCK(lock, nh->mutex, this_ethread());
+    nh->pacer.remove(this);
+    if (write.enabled && write.triggered) {
+      nh->write_ready_list.in_or_enqueue(this);
+    }
+  }
+  pacing_bucket.set_rate(rate);
+  pacing_group = pacing;
+}
+
+int64_t
+UnixNetVConnection::idle_buffer_bytes()
+{
+  int64_t bytes = 0;
+  if (MIOBuffer *b = read.vio.buffer.writer()) {
+    bytes += b->held_bytes();
+  }
+  if (MIOBuffer *b = write.vio.buffer.writer()) {
+    bytes += b->held_bytes();
+  }
+  return bytes;
+}
+
+int64_t
+UnixNetVConnection::release_idle_buffers()
+{
+  int64_t bytes = 0;
+  if (MIOBuffer *b = read.vio.buffer.writer()) {
+    bytes += b->release_blocks();
+  }
+  if (MIOBuffer *b = write.vio.buffer.writer()) {
+    bytes += b->release_blocks();
+  }
+  return bytes;
+}
+
 VIO *
 UnixNetVConnection::do_io_read(Continuation *c, int64_t nbytes, MIOBuffer *buf)
 {
@@ -590,6 +866,7 @@ UnixNetVConnection::do_io_read(Continuation *c, int64_t nbytes, MIOBuffer *buf)
   read.vio.nbytes    = nbytes;
   read.vio.ndone     = 0;
   read.vio.vc_server = (VConnection *)this;
+  read_splice        = nullptr;
   if (buf) {
     read.vio.buffer.writer_for(buf);
     if (!read.enabled) {
@@ -615,6 +892,7 @@ UnixNetVConnection::do_io_write(Continuation *c, int64_t nbytes, IOBufferReader
   write.vio.nbytes    = nbytes;
   write.vio.ndone     = 0;
   write.vio.vc_server = (VConnection *)this;
+  write_splice        = nullptr;
   if (reader) {
     ink_assert(!owner);
     write.vio.buffer.reader_for(reader);
@@ -643,6 +921,8 @@ UnixNetVConnection::do_io_close(int alerrno /* = -1 */)
   write.vio.nbytes = 0;
   write.vio.op     = VIO::NONE;
   write.vio.cont   = nullptr;
+  read_splice      = nullptr;
+  write_splice     = nullptr;
 
   EThread *t        = this_ethread();
   bool close_inline = !recursion && (!nh || nh->mutex->thread_holding == t);
@@ -909,8 +1189,13 @@ UnixNetVConnection::load_buffer_and_write(int64_t towrite, MIOBufferAccessor &bu
   int64_t try_to_write       = 0;
   IOBufferReader *tmp_reader = buf.reader()->clone();
 
+  if (zerocopy_pending.head) {
+    zerocopy_reap();
+  }
+
   do {
     IOVec tiovec[NET_MAX_IOV];
+    IOBufferBlock *tblocks[NET_MAX_IOV];
     unsigned niov = 0;
     try_to_write  = 0;
 
@@ -935,6 +1220,7 @@ UnixNetVConnection::load_buffer_and_write(int64_t towrite, MIOBufferAccessor &bu
       // build an iov entry
       tiovec[niov].iov_len  = len;
       tiovec[niov].iov_base = tmp_reader->start();
+      tblocks[niov]         = tmp_reader->block.get();
       niov++;
 
       try_to_write += len;
@@ -969,6 +1255,8 @@ UnixNetVConnection::load_buffer_and_write(int64_t towrite, MIOBufferAccessor &bu
         this->con.is_connected = true;
       }
 
+    } else if (net_config_zerocopy_threshold > 0 && try_to_write >= net_config_zerocopy_threshold && zerocopy >= 0) {
+      r = zerocopy_send(&tiovec[0], niov, tblocks);
     } else {
       r = socketManager.writev(con.fd, &tiovec[0], niov);
     }
@@ -989,6 +1277,176 @@ UnixNetVConnection::load_buffer_and_write(int64_t towrite, MIOBufferAccessor &bu
   return r;
 }
 
+#if TS_USE_NET_ZEROCOPY
+int64_t
+UnixNetVConnection::zerocopy_send(IOVec *iov, unsigned niov, IOBufferBlock **blocks)
+{
+  ProxyMutex *mutex = thread->mutex.get();
+
+  if (zerocopy == 0) {
+    if (safe_setsockopt(con.fd, SOL_SOCKET, SO_ZEROCOPY, SOCKOPT_ON, sizeof(int)) < 0) {
+      Debug("iocore_net", "SO_ZEROCOPY unavailable on fd %d: %s", con.fd, strerror(errno));
+      zerocopy = -1;
+      return socketManager.writev(con.fd, iov, niov);
+    }
+    zerocopy = 1;
+  }
+
+  struct msghdr msg;
+  ink_zero(msg);
+  msg.msg_iov    = iov;
+  msg.msg_iovlen = niov;
+
+  int64_t r = socketManager.sendmsg(con.fd, &msg, MSG_ZEROCOPY);
+  if (r > 0) {
+    // The kernel numbers each successful zero copy send on the socket, starting from 0.
+    NetZeroCopySend *zs = netZeroCopySendAllocator.alloc();
+    IOBufferBlock *tail = nullptr;
+    zs->id              = zerocopy_next_id++;
+    for (unsigned i = 0; i < niov; ++i) {
+      IOBufferBlock *b = blocks[i]->clone();
+      if (tail) {
+        tail->next = b;
+      } else {
+        zs->blocks = b;
+      }
+      tail = b;
+    }
+    zerocopy_pending.enqueue(zs);
+    NET_INCREMENT_DYN_STAT(net_zerocopy_writes_stat);
+    NET_SUM_DYN_STAT(net_zerocopy_bytes_stat, r);
+  } else if (r == -ENOBUFS) {
+    // Out of option memory to track more pinned pages on this socket, copy this one.
+    r = socketManager.writev(con.fd, iov, niov);
+  }
+  return r;
+}
+
+void
+UnixNetVConnection::zerocopy_reap()
+{
+  ProxyMutex *mutex = thread->mutex.get();
+
+  while (zerocopy_pending.head) {
+    char control[CMSG_SPACE(sizeof(sock_extended_err) + sizeof(sockaddr_in6))];
+    struct msghdr msg;
+    ink_zero(msg);
+    msg.msg_control    = control;
+    msg.msg_controllen = sizeof(control);
+
+    if (socketManager.recvmsg(con.fd, &msg, MSG_ERRQUEUE | MSG_DONTWAIT) < 0) {
+      break; // nothing more in the error queue
+    }
+
+    for (cmsghdr *cm = CMSG_FIRSTHDR(&msg); cm; cm = CMSG_NXTHDR(&msg, cm)) {
+      if (!((cm->cmsg_level == SOL_IP && cm->cmsg_type == IP_RECVERR) ||
+            (cm->cmsg_level == SOL_IPV6 && cm->cmsg_type == IPV6_RECVERR))) {
+        continue;
+      }
+      const sock_extended_err *ee = reinterpret_cast<const sock_extended_err *>(CMSG_DATA(cm));
+      if (ee->ee_errno != 0 || ee->ee_origin != SO_EE_ORIGIN_ZEROCOPY) {
+        continue;
+      }
+      if (ee->ee_code & SO_EE_CODE_ZEROCOPY_COPIED) {
+        // The device could not send from our pages, so zero copy only costs us here.
+        NET_INCREMENT_DYN_STAT(net_zerocopy_copied_stat);
+        zerocopy = -1;
+      }
+      // Completions cover the sends [ee_info, ee_data], TCP completes them in order.
+      while (zerocopy_pending.head && static_cast<int32_t>(zerocopy_pending.head->id - ee->ee_data) <= 0) {
+        NetZeroCopySend *zs = zerocopy_pending.dequeue();
+        zs->blocks          = nullptr;
+        netZeroCopySendAllocator.free(zs);
+      }
+    }
+  }
+}
+#else
+int64_t
+UnixNetVConnection::zerocopy_send(IOVec *iov, unsigned niov, IOBufferBlock ** /* blocks ATS_UNUSED */)
+{
+  zerocopy = -1;
+  return socketManager.writev(con.fd, iov, niov);
+}
+
+void
+UnixNetVConnection::zerocopy_reap()
+{
+}
+#endif
+
+void
+UnixNetVConnection::zerocopy_release(EThread *t)
+{
+  if (zerocopy_pending.head) {
+    if (con.fd != NO_FD) {
+      zerocopy_reap();
+    }
+    // After the close the kernel can still retransmit from these pages, keep them for a while.
+    NetHandler *h         = get_NetHandler(t);
+    ink_hrtime release_at = Thread::get_hrtime() + NET_ZEROCOPY_LINGER;
+    while (NetZeroCopySend *zs = zerocopy_pending.dequeue()) {
+      zs->release_at = release_at;
+      h->zerocopy_linger.enqueue(zs);
+    }
+  }
+  zerocopy         = 0;
+  zerocopy_next_id = 0;
+}
+
+NetSplicePipe::~NetSplicePipe()
+{
+  if (fd[0] != NO_FD) {
+    ::close(fd[0]);
+    ::close(fd[1]);
+  }
+}
+
+bool
+UnixNetVConnection::splice_to(NetVConnection *target)
+{
+#if TS_USE_NET_SPLICE
+  UnixNetVConnection *dst = dynamic_cast<UnixNetVConnection *>(target);
+
+  // Only plain sockets, TLS and the other subclasses keep their data in user space.
+  if (!net_config_splice || dst == nullptr || dst == this || typeid(*this) != typeid(UnixNetVConnection) ||
+      typeid(*dst) != typeid(UnixNetVConnection)) {
+    return false;
+  }
+  if (closed || dst->closed || dst->thread != thread || read.vio.op != VIO::READ || dst->write.vio.op != VIO::WRITE) {
+    return false;
+  }
+  if (read_splice || dst->write_splice) {
+    return false;
+  }
+
+  Ptr<NetSplicePipe> p = make_ptr(new NetSplicePipe);
+  if (pipe2(p->fd, O_NONBLOCK | O_CLOEXEC) != 0) {
+    Debug("iocore_net", "splice pipe for NetVC %p failed: %s", this, strerror(errno));
+    return false;
+  }
+  p->size = fcntl(p->fd[0], F_GETPIPE_SZ);
+  if (p->size <= 0) {
+    p->size = 65536;
+  }
+
+  read_splice       = p;
+  dst->write_splice = p;
+  NET_INCREMENT_DYN_STAT(net_splice_tunnels_stat);
+  Debug("iocore_net", "splicing NetVC %p to NetVC %p through a %" PRId64 " byte pipe", this, dst, p->size);
+  return true;
+#else
+  (void)target;
+  return false;
+#endif
+}
+
+int64_t
+UnixNetVConnection::splice_pending() const
+{
+  return write_splice ? write_splice->pending : 0;
+}
+
 void
 UnixNetVConnection::readDisable(NetHandler *nh)
 {
@@ -1314,6 +1772,14 @@ UnixNetVConnection::clear()
   write.vio.cont      = nullptr;
   read.vio.vc_server  = nullptr;
   write.vio.vc_server = nullptr;
+  read_splice         = nullptr;
+  write_splice        = nullptr;
+  read_sizer.clear();
+  pacing_bucket = NetTokenBucket();
+  pacing_group  = nullptr;
+  pacing_grant  = 0;
+  migrate_cont  = nullptr;
+  keep_alive_at = 0;
   options.reset();
   closed        = 0;
   netvc_context = NET_VCONNECTION_UNSET;
@@ -1322,6 +1788,7 @@ UnixNetVConnection::clear()
   ink_assert(!write.ready_link.prev && !write.ready_link.next);
   ink_assert(!write.enable_link.next);
   ink_assert(!link.next && !link.prev);
+  ink_assert(!pacing_waiting);
 }
 
 void
@@ -1335,6 +1802,7 @@ UnixNetVConnection::free(EThread *t)
   if (con.fd != NO_FD) {
     NET_SUM_GLOBAL_DYN_STAT(net_connections_currently_open_stat, -1);
   }
+  zerocopy_release(t);
   con.close();
 
   clear();
@@ -1361,6 +1829,9 @@ UnixNetVConnection::set_inactivity_timeout(ink_hrtime timeout_in)
   Debug("socket", "Set inactive timeout=%" PRId64 ", for NetVC=%p", timeout_in, this);
   inactivity_timeout_in      = timeout_in;
   next_inactivity_timeout_at = (timeout_in > 0) ? Thread::get_hrtime() + inactivity_timeout_in : 0;
+  if (nh) {
+    nh->updateCop(this);
+  }
 }
 
 TS_INLINE void
@@ -1370,6 +1841,20 @@ UnixNetVConnection::set_default_inactivity_timeout(ink_hrtime timeout_in)
   inactivity_timeout_in      = 0;
   default_inactivity_timeout = true;
   next_inactivity_timeout_at = Thread::get_hrtime() + timeout_in;
+  if (nh) {
+    nh->updateCop(this);
+  }
+}
+
+void
+UnixNetVConnection::set_active_timeout(ink_hrtime timeout_in)
+{
+  Debug("socket", "Set active timeout=%" PRId64 ", NetVC=%p", timeout_in, this);
+  active_timeout_in        = timeout_in;
+  next_activity_timeout_at = (active_timeout_in > 0) ? Thread::get_hrtime() + timeout_in : 0;
+  if (nh) {
+    nh->updateCop(this);
+  }
 }
 
 TS_INLINE bool
@@ -1432,6 +1917,12 @@ UnixNetVConnection::migrateToCurrentThread(Continuation *cont, EThread *t)
   }
   if (netvc) {
     netvc->options = this->options;
+    // The kernel keeps numbering the zero copy sends on the socket, so the state moves with it.
+    netvc->zerocopy         = this->zerocopy;
+    netvc->zerocopy_next_id = this->zerocopy_next_id;
+    while (NetZeroCopySend *zs = this->zerocopy_pending.dequeue()) {
+      netvc->zerocopy_pending.enqueue(zs);
+    }
   }
   // Do not mark this closed until the end so it does not get freed by the other thread too soon
   this->do_io_close();
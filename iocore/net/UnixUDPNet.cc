@@ -36,6 +36,7 @@
 
 #include "P_Net.h"
 #include "P_UDPNet.h"
+#include <algorithm>
 
 using UDPNetContHandler = int (UDPNetHandler::*)(int, void *);
 
@@ -52,6 +53,37 @@ UDPNetProcessor &udpNet = udpNetInternal;
 int32_t g_udp_periodicCleanupSlots;
 int32_t g_udp_periodicFreeCancelledPkts;
 int32_t g_udp_numSendRetries;
+int32_t g_udp_batch_size = 1;
+int32_t g_udp_enable_gso = 0;
+int32_t g_udp_enable_gro = 0;
+int32_t g_udp_enable_txtime = 0;
+
+#if defined(SOL_UDP) && defined(UDP_SEGMENT)
+#define UDP_HAS_GSO 1
+#endif
+
+#if defined(SO_TXTIME) && defined(SCM_TXTIME)
+#include <linux/net_tstamp.h>
+#define UDP_HAS_TXTIME 1
+#endif
+
+#if HAVE_RECVMMSG || HAVE_SENDMMSG
+using ink_mmsghdr = struct mmsghdr;
+#else
+// Platforms without the batched calls get them emulated one message at a time.
+struct ink_mmsghdr {
+  struct msghdr msg_hdr;
+  unsigned int msg_len;
+};
+#endif
+
+// Buffers making up a single outgoing packet that can be batched. QUIC packets are one or two.
+static constexpr int UDP_IOV_PER_PACKET = 4;
+// Kernel limits for a single GSO send.
+static constexpr int UDP_MAX_GSO_SEGMENTS  = 64;
+static constexpr int64_t UDP_MAX_GSO_BYTES = 65507;
+// Ancillary space for the GSO segment size and the SO_TXTIME send time of one message.
+static constexpr size_t UDP_SEND_CONTROL_SIZE = CMSG_SPACE(sizeof(uint16_t)) + CMSG_SPACE(sizeof(uint64_t));
 
 //
 // Public functions
@@ -109,6 +141,25 @@ UDPNetProcessorInternal::start(int n_upd_threads, size_t stacksize)
     return -1;
   }
 
+  // The number of datagrams moved per recvmmsg / sendmmsg call.
+  REC_ReadConfigInt32(g_udp_batch_size, "proxy.config.udp.batch_size");
+  g_udp_batch_size = std::clamp(g_udp_batch_size, 1, UDP_MAX_BATCH_SIZE);
+  REC_ReadConfigInt32(g_udp_enable_gso, "proxy.config.udp.enable_gso");
+  REC_ReadConfigInt32(g_udp_enable_gro, "proxy.config.udp.enable_gro");
+  REC_ReadConfigInt32(g_udp_enable_txtime, "proxy.config.udp.enable_txtime");
+#ifndef UDP_HAS_GSO
+  if (g_udp_enable_gso) {
+    Warning("proxy.config.udp.enable_gso is set but UDP GSO is not supported on this platform");
+    g_udp_enable_gso = 0;
+  }
+#endif
+#ifndef UDP_HAS_TXTIME
+  if (g_udp_enable_txtime) {
+    Warning("proxy.config.udp.enable_txtime is set but SO_TXTIME is not supported on this platform");
+    g_udp_enable_txtime = 0;
+  }
+#endif
+
   pollCont_offset      = eventProcessor.allocate(sizeof(PollCont));
   udpNetHandler_offset = eventProcessor.allocate(sizeof(UDPNetHandler));
 
@@ -119,133 +170,171 @@ UDPNetProcessorInternal::start(int n_upd_threads, size_t stacksize)
   return 0;
 }
 
+// Enough ancillary space for the destination address and the GRO segment size.
+static constexpr int UDP_RECV_CONTROL_SIZE = 128;
+
+// Datagrams up to this size are copied out of the receive slot so the slot can be reused.
+static constexpr int64_t UDP_RECV_COPY_LIMIT = BUFFER_SIZE_FOR_INDEX(BUFFER_SIZE_INDEX_2K);
+
+static int
+udp_recv_batch(int fd, ink_mmsghdr *msgs, int n)
+{
+#if HAVE_RECVMMSG
+  return ::recvmmsg(fd, msgs, n, 0, nullptr);
+#else
+  int i = 0;
+  for (; i < n; ++i) {
+    int64_t r = socketManager.recvmsg(fd, &msgs[i].msg_hdr, 0);
+    if (r < 0) {
+      break;
+    }
+    msgs[i].msg_len = r;
+  }
+  return i > 0 ? i : -1;
+#endif
+}
+
 void
 UDPNetProcessorInternal::udp_read_from_net(UDPNetHandler *nh, UDPConnection *xuc)
 {
   UnixUDPConnection *uc = (UnixUDPConnection *)xuc;
+  ProxyMutex *mutex     = nh->mutex.get();
 
-  // receive packet and queue onto UDPConnection.
+  // receive packets and queue onto UDPConnection.
   // don't call back connection at this time.
-  int64_t r;
-  int iters         = 0;
-  unsigned max_niov = 32;
+  int r;
+  int iters = 0;
+  int n     = g_udp_batch_size;
 
-  struct msghdr msg;
-  Ptr<IOBufferBlock> chain, next_chain;
-  struct iovec tiovec[max_niov];
-  int64_t size_index  = BUFFER_SIZE_INDEX_2K;
-  int64_t buffer_size = BUFFER_SIZE_FOR_INDEX(size_index);
-  // The max length of receive buffer is 32 * buffer_size (2048) = 65536 bytes.
-  // Because the 'UDP Length' is type of uint16_t defined in RFC 768.
-  // And there is 8 octets in 'User Datagram Header' which means the max length of payload is no more than 65527 bytes.
-  do {
-    // create IOBufferBlock chain to receive data
-    unsigned int niov;
-    IOBufferBlock *b, *last;
-
-    // build struct iov
-    // reuse the block in chain if available
-    b    = chain.get();
-    last = nullptr;
-    for (niov = 0; niov < max_niov; niov++) {
-      if (b == nullptr) {
-        b = new_IOBufferBlock();
-        b->alloc(size_index);
-        if (last == nullptr) {
-          chain = b;
-        } else {
-          last->next = b;
-        }
-      }
+  ink_mmsghdr msgs[UDP_MAX_BATCH_SIZE];
+  struct iovec tiovec[UDP_MAX_BATCH_SIZE];
+  sockaddr_in6 fromaddr[UDP_MAX_BATCH_SIZE];
+  alignas(struct cmsghdr) char cbuf[UDP_MAX_BATCH_SIZE][UDP_RECV_CONTROL_SIZE];
 
-      tiovec[niov].iov_base = b->buf();
-      tiovec[niov].iov_len  = b->block_size();
+  sockaddr_in6 localaddr;
+  int localaddr_len = sizeof(localaddr);
+  safe_getsockname(xuc->getFd(), reinterpret_cast<struct sockaddr *>(&localaddr), &localaddr_len);
 
-      last = b;
-      b    = b->next.get();
+  // Each slot is a single 64K block: big enough for the largest UDP payload (65527 bytes, RFC 768)
+  // and for a GRO coalesced read. Slots whose data was handed off are replaced on the next pass.
+  do {
+    for (int i = 0; i < n; ++i) {
+      Ptr<IOBufferBlock> &slot = nh->recv_slots[i];
+      if (!slot) {
+        slot = new_IOBufferBlock();
+        slot->alloc(BUFFER_SIZE_INDEX_64K);
+      }
+      tiovec[i].iov_base = slot->buf();
+      tiovec[i].iov_len  = slot->block_size();
+
+      struct msghdr &msg = msgs[i].msg_hdr;
+      msg.msg_name       = &fromaddr[i];
+      msg.msg_namelen    = sizeof(fromaddr[i]);
+      msg.msg_iov        = &tiovec[i];
+      msg.msg_iovlen     = 1;
+      msg.msg_control    = cbuf[i];
+      msg.msg_controllen = sizeof(cbuf[i]);
+      msg.msg_flags      = 0;
+      msgs[i].msg_len    = 0;
     }
 
-    // build struct msghdr
-    sockaddr_in6 fromaddr;
-    sockaddr_in6 toaddr;
-    int toaddr_len = sizeof(toaddr);
-    char *cbuf[1024];
-    msg.msg_name       = &fromaddr;
-    msg.msg_namelen    = sizeof(fromaddr);
-    msg.msg_iov        = tiovec;
-    msg.msg_iovlen     = niov;
-    msg.msg_control    = cbuf;
-    msg.msg_controllen = sizeof(cbuf);
-
-    // receive data by recvmsg
-    r = socketManager.recvmsg(uc->getFd(), &msg, 0);
+    r = udp_recv_batch(uc->getFd(), msgs, n);
     if (r <= 0) {
       // error
       break;
     }
+    NET_INCREMENT_DYN_STAT(net_udp_recv_calls_stat);
 
-    // truncated check
-    if (msg.msg_flags & MSG_TRUNC) {
-      Debug("udp-read", "The UDP packet is truncated");
-    }
+    for (int i = 0; i < r; ++i) {
+      struct msghdr &msg = msgs[i].msg_hdr;
+      int64_t len        = msgs[i].msg_len;
+      int64_t seg_size   = len;
+      sockaddr_in6 toaddr;
 
-    // fill the IOBufferBlock chain
-    int64_t saved = r;
-    b             = chain.get();
-    while (b && saved > 0) {
-      if (saved > buffer_size) {
-        b->fill(buffer_size);
-        saved -= buffer_size;
-        b = b->next.get();
-      } else {
-        b->fill(saved);
-        saved      = 0;
-        next_chain = b->next.get();
-        b->next    = nullptr;
+      // truncated check
+      if (msg.msg_flags & MSG_TRUNC) {
+        Debug("udp-read", "The UDP packet is truncated");
       }
-    }
 
-    safe_getsockname(xuc->getFd(), reinterpret_cast<struct sockaddr *>(&toaddr), &toaddr_len);
-    for (auto cmsg = CMSG_FIRSTHDR(&msg); cmsg != nullptr; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
-      switch (cmsg->cmsg_type) {
+      memcpy(&toaddr, &localaddr, sizeof(toaddr));
+      for (auto cmsg = CMSG_FIRSTHDR(&msg); cmsg != nullptr; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+        switch (cmsg->cmsg_type) {
 #ifdef IP_PKTINFO
-      case IP_PKTINFO:
-        if (cmsg->cmsg_level == IPPROTO_IP) {
-          struct in_pktinfo *pktinfo                                = reinterpret_cast<struct in_pktinfo *>(CMSG_DATA(cmsg));
-          reinterpret_cast<sockaddr_in *>(&toaddr)->sin_addr.s_addr = pktinfo->ipi_addr.s_addr;
-        }
-        break;
+        case IP_PKTINFO:
+          if (cmsg->cmsg_level == IPPROTO_IP) {
+            struct in_pktinfo *pktinfo                                = reinterpret_cast<struct in_pktinfo *>(CMSG_DATA(cmsg));
+            reinterpret_cast<sockaddr_in *>(&toaddr)->sin_addr.s_addr = pktinfo->ipi_addr.s_addr;
+          }
+          break;
 #endif
 #ifdef IP_RECVDSTADDR
-      case IP_RECVDSTADDR:
-        if (cmsg->cmsg_level == IPPROTO_IP) {
-          struct in_addr *addr                                      = reinterpret_cast<struct in_addr *>(CMSG_DATA(cmsg));
-          reinterpret_cast<sockaddr_in *>(&toaddr)->sin_addr.s_addr = addr->s_addr;
-        }
-        break;
+        case IP_RECVDSTADDR:
+          if (cmsg->cmsg_level == IPPROTO_IP) {
+            struct in_addr *addr                                      = reinterpret_cast<struct in_addr *>(CMSG_DATA(cmsg));
+            reinterpret_cast<sockaddr_in *>(&toaddr)->sin_addr.s_addr = addr->s_addr;
+          }
+          break;
 #endif
 #if defined(IPV6_PKTINFO) || defined(IPV6_RECVPKTINFO)
-      case IPV6_PKTINFO: // IPV6_RECVPKTINFO uses IPV6_PKTINFO too
-        if (cmsg->cmsg_level == IPPROTO_IPV6) {
-          struct in6_pktinfo *pktinfo = reinterpret_cast<struct in6_pktinfo *>(CMSG_DATA(cmsg));
-          memcpy(toaddr.sin6_addr.s6_addr, &pktinfo->ipi6_addr, 16);
-        }
-        break;
+        case IPV6_PKTINFO: // IPV6_RECVPKTINFO uses IPV6_PKTINFO too
+          if (cmsg->cmsg_level == IPPROTO_IPV6) {
+            struct in6_pktinfo *pktinfo = reinterpret_cast<struct in6_pktinfo *>(CMSG_DATA(cmsg));
+            memcpy(toaddr.sin6_addr.s6_addr, &pktinfo->ipi6_addr, 16);
+          }
+          break;
+#endif
+#if defined(SOL_UDP) && defined(UDP_GRO)
+        case UDP_GRO:
+          if (cmsg->cmsg_level == SOL_UDP) {
+            int gso_size;
+            memcpy(&gso_size, CMSG_DATA(cmsg), sizeof(gso_size));
+            if (gso_size > 0) {
+              seg_size = gso_size;
+            }
+          }
+          break;
 #endif
+        }
       }
-    }
 
-    // create packet
-    UDPPacket *p = new_incoming_UDPPacket(ats_ip_sa_cast(&fromaddr), ats_ip_sa_cast(&toaddr), chain);
-    p->setConnection(uc);
-    // queue onto the UDPConnection
-    uc->inQueue.push((UDPPacketInternal *)p);
-
-    // reload the unused block
-    chain      = next_chain;
-    next_chain = nullptr;
-    iters++;
-  } while (r > 0);
+      // Split the read into datagrams, more than one only if the kernel coalesced them with GRO.
+      // Small datagrams get their own block; large ones share the slot's data.
+      Ptr<IOBufferBlock> &slot = nh->recv_slots[i];
+      bool shared              = false;
+      int64_t offset           = 0;
+      do {
+        int64_t dlen = std::min(seg_size, len - offset);
+        Ptr<IOBufferBlock> chain;
+        if (dlen <= UDP_RECV_COPY_LIMIT) {
+          chain = new_IOBufferBlock();
+          chain->alloc(buffer_size_to_index(dlen, BUFFER_SIZE_INDEX_2K));
+          memcpy(chain->end(), slot->buf() + offset, dlen);
+          chain->fill(dlen);
+        } else {
+          chain           = slot->clone();
+          chain->_start   = slot->buf() + offset;
+          chain->_end     = chain->_start + dlen;
+          chain->_buf_end = chain->_end;
+          shared          = true;
+        }
+
+        // create packet
+        UDPPacket *p = new_incoming_UDPPacket(ats_ip_sa_cast(&fromaddr[i]), ats_ip_sa_cast(&toaddr), chain);
+        p->setConnection(uc);
+        // queue onto the UDPConnection
+        uc->inQueue.push((UDPPacketInternal *)p);
+        NET_INCREMENT_DYN_STAT(net_udp_recv_datagrams_stat);
+
+        offset += dlen;
+        iters++;
+      } while (offset < len);
+
+      if (shared) {
+        slot = nullptr;
+      }
+    }
+    // A short batch means the socket has been drained.
+  } while (r == n);
   if (iters >= 1) {
     Debug("udp-read", "read %d at a time", iters);
   }
@@ -735,7 +824,7 @@ HardError:
 }
 
 Action *
-UDPNetProcessor::UDPBind(Continuation *cont, sockaddr const *addr, int fd, int send_bufsize, int recv_bufsize)
+UDPNetProcessor::UDPBind(Continuation *cont, sockaddr const *addr, int fd, int send_bufsize, int recv_bufsize, EThread *thread)
 {
   int res              = 0;
   UnixUDPConnection *n = nullptr;
@@ -793,6 +882,15 @@ UDPNetProcessor::UDPBind(Continuation *cont, sockaddr const *addr, int fd, int s
     }
   }
 
+#if defined(SOL_UDP) && defined(UDP_GRO)
+  if (g_udp_enable_gro) {
+    int enable = 1;
+    if (safe_setsockopt(fd, SOL_UDP, UDP_GRO, reinterpret_cast<char *>(&enable), sizeof(enable)) < 0) {
+      Debug("udpnet", "setsockopt for UDP_GRO failed: %s", strerror(errno));
+    }
+  }
+#endif
+
   // If this is a class D address (i.e. multicast address), use REUSEADDR.
   if (ats_is_ip_multicast(addr)) {
     int enable_reuseaddr = 1;
@@ -828,7 +926,7 @@ UDPNetProcessor::UDPBind(Continuation *cont, sockaddr const *addr, int fd, int s
 
   Debug("udpnet", "UDPNetProcessor::UDPBind: %p fd=%d", n, fd);
   n->setBinding(&myaddr.sa);
-  n->bindToThread(cont);
+  n->bindToThread(cont, thread);
 
   pc = get_UDPPollCont(n->ethread);
   pd = pc->pollDescriptor;
@@ -852,6 +950,78 @@ UDPQueue::UDPQueue() {}
 
 UDPQueue::~UDPQueue() {}
 
+// Whether the kernel can hold packets of @a conn until their send time, trying to turn it on the first time.
+static bool
+udp_txtime_enabled(UDPConnectionInternal *conn)
+{
+#ifdef UDP_HAS_TXTIME
+  if (conn->txtime < 0) {
+    conn->txtime = 0;
+    if (g_udp_enable_txtime) {
+      struct sock_txtime cfg = {CLOCK_MONOTONIC, 0};
+      if (safe_setsockopt(conn->getFd(), SOL_SOCKET, SO_TXTIME, reinterpret_cast<char *>(&cfg), sizeof(cfg)) == 0) {
+        conn->txtime = 1;
+      } else {
+        Debug("udpnet", "setsockopt for SO_TXTIME failed: %s", strerror(errno));
+      }
+    }
+  }
+  return conn->txtime > 0;
+#else
+  (void)conn;
+  return false;
+#endif
+}
+
+#ifdef UDP_HAS_TXTIME
+// SO_TXTIME takes CLOCK_MONOTONIC, delivery times are on the clock of Thread::get_hrtime().
+static uint64_t
+udp_txtime_value(ink_hrtime t)
+{
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ink_hrtime_from_timespec(&ts) + (t - ink_get_hrtime_internal());
+}
+
+static size_t
+udp_add_txtime(struct cmsghdr *cm, ink_hrtime t)
+{
+  uint64_t when  = udp_txtime_value(t);
+  cm->cmsg_level = SOL_SOCKET;
+  cm->cmsg_type  = SCM_TXTIME;
+  cm->cmsg_len   = CMSG_LEN(sizeof(when));
+  memcpy(CMSG_DATA(cm), &when, sizeof(when));
+  return CMSG_SPACE(sizeof(when));
+}
+#endif
+
+static bool
+udp_paced_before(const UDPPacketInternal *a, const UDPPacketInternal *b)
+{
+  // std::push_heap keeps the largest first, so this orders on the later time.
+  return a->delivery_time > b->delivery_time;
+}
+
+void
+UDPQueue::addPacedPacket(UDPPacketInternal *p)
+{
+  paced.push_back(p);
+  std::push_heap(paced.begin(), paced.end(), udp_paced_before);
+}
+
+// Move the paced packets due by @a now into the calendar queue, from where they go out right away.
+void
+UDPQueue::releasePacedPackets(ink_hrtime now)
+{
+  while (!paced.empty() && paced.front()->delivery_time <= now + UDP_PACING_GRANULARITY) {
+    std::pop_heap(paced.begin(), paced.end(), udp_paced_before);
+    UDPPacketInternal *p = paced.back();
+    paced.pop_back();
+    p->delivery_time = now;
+    pipeInfo.addPacket(p, now);
+  }
+}
+
 /*
  * Driver function that aggregates packets across cont's and sends them
  */
@@ -886,9 +1056,22 @@ UDPQueue::service(UDPNetHandler *nh)
     p->conn->lastPktStartTime = pktSendStartTime;
     p->delivery_time          = pktSendStartTime;
 
+    // A packet to be paced goes to the kernel now with its send time if the socket allows,
+    // otherwise it waits here.
+    if (p->delivery_time > now + UDP_PACING_GRANULARITY) {
+      if (udp_txtime_enabled(p->conn)) {
+        p->txtime        = p->delivery_time;
+        p->delivery_time = now;
+      } else {
+        addPacedPacket(p);
+        continue;
+      }
+    }
+
     pipeInfo.addPacket(p, now);
   }
 
+  releasePacedPackets(now);
   pipeInfo.advanceNow(now);
   SendPackets();
 
@@ -911,6 +1094,8 @@ UDPQueue::SendPackets()
   int32_t bytesThisSlot = INT_MAX, bytesUsed = 0;
   int32_t bytesThisPipe, sentOne;
   int64_t pktLen;
+  UDPPacketInternal *batch[UDP_MAX_BATCH_SIZE];
+  int nbatch = 0;
 
   bytesThisSlot = INT_MAX;
 
@@ -929,16 +1114,28 @@ sendPackets:
       goto next_pkt;
     }
 
-    SendUDPPacket(p, pktLen);
+    // The packet is freed once its batch has been sent.
+    batch[nbatch++] = p;
+    if (nbatch == g_udp_batch_size) {
+      SendMultipleUDPPackets(batch, nbatch);
+      nbatch = 0;
+    }
     bytesUsed += pktLen;
     bytesThisPipe -= pktLen;
-  next_pkt:
     sentOne = true;
-    p->free();
-
     if (bytesThisPipe < 0) {
       break;
     }
+    continue;
+
+  next_pkt:
+    sentOne = true;
+    p->free();
+  }
+
+  if (nbatch > 0) {
+    SendMultipleUDPPackets(batch, nbatch);
+    nbatch = 0;
   }
 
   bytesThisSlot -= bytesUsed;
@@ -958,9 +1155,201 @@ sendPackets:
   }
 }
 
+static int
+udp_send_batch(int fd, ink_mmsghdr *msgs, int n)
+{
+#if HAVE_SENDMMSG
+  return ::sendmmsg(fd, msgs, n, 0);
+#else
+  int i = 0;
+  for (; i < n; ++i) {
+    int r = ::sendmsg(fd, &msgs[i].msg_hdr, 0);
+    if (r < 0) {
+      break;
+    }
+    msgs[i].msg_len = r;
+  }
+  return i > 0 ? i : -1;
+#endif
+}
+
+/** Send @a n packets, and free them.
+
+    The packets are sent with as few system calls as possible: a run of packets on the same socket
+    goes out with one @c sendmmsg, and with GSO enabled a run of equally sized packets to the same
+    peer is passed to the kernel as one message that it segments on the way out.
+ */
+void
+UDPQueue::SendMultipleUDPPackets(UDPPacketInternal **p, int n)
+{
+  ProxyMutex *mutex = this_ethread()->mutex.get();
+  ink_mmsghdr msgs[UDP_MAX_BATCH_SIZE];
+  struct iovec iov[UDP_MAX_BATCH_SIZE * UDP_IOV_PER_PACKET];
+#if defined(UDP_HAS_GSO) || defined(UDP_HAS_TXTIME)
+  alignas(struct cmsghdr) char cbuf[UDP_MAX_BATCH_SIZE][UDP_SEND_CONTROL_SIZE];
+#endif
+  int first[UDP_MAX_BATCH_SIZE]; // index of the first packet of each message
+  int segs[UDP_MAX_BATCH_SIZE];  // number of packets in each message
+  int nmsg = 0;
+  int niov = 0;
+  int fd   = -1;
+
+  auto flush = [&]() {
+    int sent  = 0;
+    int count = 0;
+    while (sent < nmsg) {
+      int res = udp_send_batch(fd, msgs + sent, nmsg - sent);
+      if (res > 0) {
+        NET_INCREMENT_DYN_STAT(net_udp_send_calls_stat);
+        for (int j = sent; j < sent + res; ++j) {
+          NET_SUM_DYN_STAT(net_udp_send_datagrams_stat, segs[j]);
+        }
+        sent += res;
+        count = 0;
+        continue;
+      }
+      // stupid Linux problem: sendmsg can return EAGAIN
+      if (errno == EAGAIN) {
+        ++count;
+        if ((g_udp_numSendRetries > 0) && (count >= g_udp_numSendRetries)) {
+          // tried too many times; give up on this message
+          Debug("udpnet", "Send failed: too many retries");
+          ++sent;
+          count = 0;
+        }
+        continue;
+      }
+#ifdef UDP_HAS_GSO
+      if (segs[sent] > 1 && (errno == EIO || errno == EINVAL)) {
+        // The device cannot segment for us, send these one by one from now on.
+        Debug("udp-send", "GSO send failed: %s (%d), disabling GSO", strerror(errno), errno);
+        g_udp_enable_gso = 0;
+        for (int k = first[sent]; k < first[sent] + segs[sent]; ++k) {
+          SendUDPPacket(p[k], 0);
+        }
+        ++sent;
+        continue;
+      }
+#endif
+      // some random error happened.
+      Debug("udp-send", "Error: %s (%d)", strerror(errno), errno);
+      ++sent;
+      count = 0;
+    }
+    nmsg = 0;
+    niov = 0;
+  };
+
+  int i = 0;
+  while (i < n) {
+    UDPConnectionInternal *conn = p[i]->conn;
+    int nblocks                 = 0;
+    for (IOBufferBlock *b = p[i]->chain.get(); b != nullptr; b = b->next.get()) {
+      nblocks++;
+    }
+    if (nblocks > UDP_IOV_PER_PACKET) {
+      // Too fragmented to batch, send it by itself.
+      SendUDPPacket(p[i], 0);
+      ++i;
+      continue;
+    }
+    if (nmsg > 0 && (conn->getFd() != fd || niov + nblocks > UDP_MAX_BATCH_SIZE * UDP_IOV_PER_PACKET)) {
+      flush();
+    }
+    fd = conn->getFd();
+
+    struct msghdr &msg = msgs[nmsg].msg_hdr;
+    msg.msg_name       = reinterpret_cast<caddr_t>(&p[i]->to.sa);
+    msg.msg_namelen    = ats_ip_size(p[i]->to);
+    msg.msg_iov        = iov + niov;
+    msg.msg_iovlen     = 0;
+    msg.msg_control    = nullptr;
+    msg.msg_controllen = 0;
+    msg.msg_flags      = 0;
+    msgs[nmsg].msg_len = 0;
+    first[nmsg]        = i;
+    segs[nmsg]         = 0;
+
+#ifdef UDP_HAS_GSO
+    int64_t seg_size = p[i]->getPktLength();
+    int64_t total    = 0;
+#endif
+    do {
+      UDPPacketInternal *pkt = p[i];
+      Debug("udp-send", "Sending %p", pkt);
+      pkt->conn->lastSentPktStartTime = pkt->delivery_time;
+      for (IOBufferBlock *b = pkt->chain.get(); b != nullptr; b = b->next.get()) {
+        iov[niov].iov_base = static_cast<caddr_t>(b->start());
+        iov[niov].iov_len  = b->size();
+        niov++;
+      }
+      msg.msg_iovlen += nblocks;
+      segs[nmsg]++;
+      ++i;
+
+#ifdef UDP_HAS_GSO
+      int64_t len = pkt->getPktLength();
+      total += len;
+      // A segment shorter than the others can only be the last one.
+      if (!g_udp_enable_gso || seg_size == 0 || len < seg_size || i >= n || segs[nmsg] >= UDP_MAX_GSO_SEGMENTS) {
+        break;
+      }
+      nblocks = 0;
+      for (IOBufferBlock *b = p[i]->chain.get(); b != nullptr; b = b->next.get()) {
+        nblocks++;
+      }
+      // The segments of one send all leave together, so only packets due at the same time can share it.
+      if (p[i]->conn != conn || !ats_ip_addr_port_eq(&p[i]->to.sa, &pkt->to.sa) || p[i]->getPktLength() > seg_size ||
+          total + p[i]->getPktLength() > UDP_MAX_GSO_BYTES || nblocks > UDP_IOV_PER_PACKET ||
+          niov + nblocks > UDP_MAX_BATCH_SIZE * UDP_IOV_PER_PACKET || p[i]->txtime != pkt->txtime) {
+        break;
+      }
+#else
+      break;
+#endif
+    } while (true);
+
+#if defined(UDP_HAS_GSO) || defined(UDP_HAS_TXTIME)
+    msg.msg_control    = cbuf[nmsg];
+    msg.msg_controllen = sizeof(cbuf[nmsg]);
+    struct cmsghdr *cm = CMSG_FIRSTHDR(&msg);
+    size_t controllen  = 0;
+#ifdef UDP_HAS_GSO
+    if (segs[nmsg] > 1) {
+      cm->cmsg_level    = SOL_UDP;
+      cm->cmsg_type     = UDP_SEGMENT;
+      cm->cmsg_len      = CMSG_LEN(sizeof(uint16_t));
+      uint16_t gso_size = seg_size;
+      memcpy(CMSG_DATA(cm), &gso_size, sizeof(gso_size));
+      controllen += CMSG_SPACE(sizeof(uint16_t));
+      cm = CMSG_NXTHDR(&msg, cm);
+    }
+#endif
+#ifdef UDP_HAS_TXTIME
+    if (p[first[nmsg]]->txtime) {
+      controllen += udp_add_txtime(cm, p[first[nmsg]]->txtime);
+    }
+#endif
+    msg.msg_controllen = controllen;
+    if (controllen == 0) {
+      msg.msg_control = nullptr;
+    }
+#endif
+    ++nmsg;
+  }
+  if (nmsg > 0) {
+    flush();
+  }
+
+  for (i = 0; i < n; ++i) {
+    p[i]->free();
+  }
+}
+
 void
 UDPQueue::SendUDPPacket(UDPPacketInternal *p, int32_t /* pktLen ATS_UNUSED */)
 {
+  ProxyMutex *mutex = this_ethread()->mutex.get();
   struct msghdr msg;
   struct iovec iov[32];
   int real_len = 0;
@@ -987,6 +1376,15 @@ UDPQueue::SendUDPPacket(UDPPacketInternal *p, int32_t /* pktLen ATS_UNUSED */)
   msg.msg_iov    = iov;
   msg.msg_iovlen = iov_len;
 
+#ifdef UDP_HAS_TXTIME
+  alignas(struct cmsghdr) char cbuf[CMSG_SPACE(sizeof(uint64_t))];
+  if (p->txtime) {
+    msg.msg_control    = cbuf;
+    msg.msg_controllen = sizeof(cbuf);
+    msg.msg_controllen = udp_add_txtime(CMSG_FIRSTHDR(&msg), p->txtime);
+  }
+#endif
+
   count = 0;
   while (true) {
     // stupid Linux problem: sendmsg can return EAGAIN
@@ -995,6 +1393,9 @@ UDPQueue::SendUDPPacket(UDPPacketInternal *p, int32_t /* pktLen ATS_UNUSED */)
       // send succeeded or some random error happened.
       if (n < 0) {
         Debug("udp-send", "Error: %s (%d)", strerror(errno), errno);
+      } else {
+        NET_INCREMENT_DYN_STAT(net_udp_send_calls_stat);
+        NET_INCREMENT_DYN_STAT(net_udp_send_datagrams_stat);
       }
 
       break;
@@ -1062,6 +1463,12 @@ UDPNetHandler::waitForActivity(ink_hrtime timeout)
 {
   UnixUDPConnection *uc;
   PollCont *pc = get_UDPPollCont(this->thread);
+
+  // Wake up for the next paced packet.
+  if (ink_hrtime paced = udpOutQueue.nextPacedTime(); paced) {
+    ink_hrtime wait = std::max<ink_hrtime>(0, paced - Thread::get_hrtime_updated());
+    timeout         = timeout < 0 ? wait : std::min(timeout, wait);
+  }
   pc->do_poll(timeout);
 
   /* Notice: the race between traversal of newconn_list and UDPBind()
@@ -68,6 +68,12 @@ class MockQUICLDConfig : public QUICLDConfig
 
 class MockQUICCCConfig : public QUICCCConfig
 {
+  QUICCongestionControlAlgorithm
+  algorithm() const
+  {
+    return QUICCongestionControlAlgorithm::NEW_RENO;
+  }
+
   uint32_t
   max_datagram_size() const
   {
@@ -495,6 +501,11 @@ public:
   {
     return 0;
   }
+  virtual uint64_t
+  pacing_rate() const override
+  {
+    return 0;
+  }
 
   // for Test
   int
@@ -143,7 +143,7 @@ QUICAckFrameManager::set_max_ack_delay(uint16_t delay)
 void
 QUICAckFrameManager::QUICAckFrameCreator::refresh_state()
 {
-  if (this->_packet_numbers.empty() || !this->_available) {
+  if (this->_ranges.empty() || !this->_available) {
     return;
   }
 
@@ -154,18 +154,28 @@ QUICAckFrameManager::QUICAckFrameCreator::refresh_state()
 void
 QUICAckFrameManager::QUICAckFrameCreator::forget(QUICPacketNumber largest_acknowledged)
 {
-  this->_available = false;
-  this->sort();
-  std::list<RecvdPacket> remove_list;
-  for (auto it = this->_packet_numbers.begin(); it != this->_packet_numbers.end(); it++) {
-    if ((*it).packet_number == largest_acknowledged) {
-      remove_list.splice(remove_list.begin(), this->_packet_numbers, it, this->_packet_numbers.end());
-      break;
+  // The packets up to the largest one the peer has seen acked need not be acked again
+  auto it = std::lower_bound(this->_ranges.begin(), this->_ranges.end(), largest_acknowledged,
+                             [](const RecvdRange &r, QUICPacketNumber pn) { return r.largest < pn; });
+  if (it != this->_ranges.end() && it->smallest <= largest_acknowledged) {
+    for (auto r = this->_ranges.begin(); r != it; ++r) {
+      this->_packet_count -= r->largest - r->smallest + 1;
+    }
+    this->_packet_count -= largest_acknowledged - it->smallest + 1;
+    if (it->largest == largest_acknowledged) {
+      ++it;
+    } else {
+      it->smallest = largest_acknowledged + 1;
+    }
+    this->_ranges.erase(this->_ranges.begin(), it);
+
+    if (this->_has_ack_eliciting && this->_largest_ack_eliciting <= largest_acknowledged) {
+      this->_has_ack_eliciting = false;
     }
-    this->_available |= !(*it).ack_only;
   }
+  this->_available = this->_has_ack_eliciting;
 
-  if (this->_packet_numbers.empty() || !this->_available) {
+  if (this->_ranges.empty() || !this->_available) {
     this->_should_send = false;
   }
 }
@@ -205,19 +215,64 @@ QUICAckFrameManager::QUICAckFrameCreator::push_back(QUICPacketNumber packet_numb
   }
 
   this->_expect_next = packet_number + 1;
-  this->_packet_numbers.push_back({ack_only, packet_number});
+  this->_insert(packet_number);
+  if (!ack_only && (!this->_has_ack_eliciting || packet_number > this->_largest_ack_eliciting)) {
+    this->_has_ack_eliciting     = true;
+    this->_largest_ack_eliciting = packet_number;
+  }
+}
+
+void
+QUICAckFrameManager::QUICAckFrameCreator::_insert(QUICPacketNumber packet_number)
+{
+  // Packets mostly arrive in order, to widen the last range or to start a new one after it.
+  if (this->_ranges.empty() || packet_number > this->_ranges.back().largest + 1) {
+    this->_ranges.push_back({packet_number, packet_number});
+    ++this->_packet_count;
+    return;
+  }
+  if (packet_number == this->_ranges.back().largest + 1) {
+    this->_ranges.back().largest = packet_number;
+    ++this->_packet_count;
+    return;
+  }
+
+  // The first range that ends at or after the packet, or that it would extend at its bottom
+  auto it = std::lower_bound(this->_ranges.begin(), this->_ranges.end(), packet_number,
+                             [](const RecvdRange &r, QUICPacketNumber pn) { return r.largest + 1 < pn; });
+  if (it->smallest <= packet_number && packet_number <= it->largest) {
+    // A duplicate
+    return;
+  }
+  ++this->_packet_count;
+
+  if (packet_number == it->largest + 1) {
+    it->largest = packet_number;
+    auto next   = it + 1;
+    if (next != this->_ranges.end() && next->smallest == packet_number + 1) {
+      it->largest = next->largest;
+      this->_ranges.erase(next);
+    }
+  } else if (packet_number + 1 == it->smallest) {
+    it->smallest = packet_number;
+  } else {
+    this->_ranges.insert(it, {packet_number, packet_number});
+  }
 }
 
 size_t
 QUICAckFrameManager::QUICAckFrameCreator::size()
 {
-  return this->_packet_numbers.size();
+  return this->_packet_count;
 }
 
 void
 QUICAckFrameManager::QUICAckFrameCreator::clear()
 {
-  this->_packet_numbers.clear();
+  this->_ranges.clear();
+  this->_packet_count                = 0;
+  this->_has_ack_eliciting           = false;
+  this->_largest_ack_eliciting       = 0;
   this->_largest_ack_number          = 0;
   this->_largest_ack_received_time   = 0;
   this->_latest_packet_received_time = 0;
@@ -238,13 +293,6 @@ QUICAckFrameManager::QUICAckFrameCreator::largest_ack_received_time()
   return this->_largest_ack_received_time;
 }
 
-void
-QUICAckFrameManager::QUICAckFrameCreator::sort()
-{
-  //  TODO Find more smart way
-  this->_packet_numbers.sort([](const RecvdPacket &a, const RecvdPacket &b) -> bool { return a.packet_number > b.packet_number; });
-}
-
 QUICAckFrame *
 QUICAckFrameManager::QUICAckFrameCreator::generate_ack_frame(uint8_t *buf, uint16_t maximum_frame_size)
 {
@@ -268,61 +316,30 @@ QUICAckFrameManager::QUICAckFrameCreator::generate_ack_frame(uint8_t *buf, uint1
 QUICAckFrame *
 QUICAckFrameManager::QUICAckFrameCreator::_create_ack_frame(uint8_t *buf)
 {
-  ink_assert(!this->_packet_numbers.empty());
+  ink_assert(!this->_ranges.empty());
   QUICAckFrame *ack_frame = nullptr;
-  this->sort();
-  std::list<RecvdPacket> &list = this->_packet_numbers;
 
   this->_has_new_data = false;
 
-  uint8_t gap     = 0;
-  uint64_t length = 0;
-  auto it         = list.begin();
-
-  // skip ack_only packets
-  for (; it != list.end(); it++) {
-    if (!(*it).ack_only) {
-      break;
-    }
-  }
-
-  if (it == list.end()) {
+  // The ack only packets above the largest ack-eliciting one are not acked
+  if (!this->_has_ack_eliciting) {
     return ack_frame;
   }
 
-  QUICPacketNumber largest_ack_number = (*it).packet_number;
-  QUICPacketNumber last_ack_number    = largest_ack_number;
-
-  while (it != list.end()) {
-    QUICPacketNumber pn = (*it).packet_number;
-    if (pn == last_ack_number) {
-      last_ack_number--;
-      length++;
-      it++;
-      continue;
-    }
-
-    ink_assert(length > 0);
-
-    if (ack_frame) {
-      ack_frame->ack_block_section()->add_ack_block({static_cast<uint8_t>(gap - 1), length - 1});
-    } else {
-      uint64_t delay = this->_calculate_delay();
-      ack_frame      = QUICFrameFactory::create_ack_frame(buf, largest_ack_number, delay, length - 1,
-                                                     this->_ack_manager->issue_frame_id(), this->_ack_manager);
-    }
-
-    gap             = last_ack_number - pn;
-    last_ack_number = pn;
-    length          = 0;
+  auto it = this->_ranges.rbegin();
+  while (it->smallest > this->_largest_ack_eliciting) {
+    ++it;
   }
 
-  if (ack_frame) {
-    ack_frame->ack_block_section()->add_ack_block({static_cast<uint8_t>(gap - 1), length - 1});
-  } else {
-    uint64_t delay = this->_calculate_delay();
-    ack_frame = QUICFrameFactory::create_ack_frame(buf, largest_ack_number, delay, length - 1, this->_ack_manager->issue_frame_id(),
-                                                   this->_ack_manager);
+  uint64_t delay = this->_calculate_delay();
+  ack_frame      = QUICFrameFactory::create_ack_frame(buf, this->_largest_ack_eliciting, delay,
+                                                 this->_largest_ack_eliciting - it->smallest, this->_ack_manager->issue_frame_id(),
+                                                 this->_ack_manager);
+
+  QUICPacketNumber smallest = it->smallest;
+  for (++it; it != this->_ranges.rend(); ++it) {
+    ack_frame->ack_block_section()->add_ack_block({smallest - it->largest - 2, it->largest - it->smallest});
+    smallest = it->smallest;
   }
 
   return ack_frame;
@@ -350,13 +367,13 @@ QUICAckFrameManager::QUICAckFrameCreator::available() const
 bool
 QUICAckFrameManager::QUICAckFrameCreator::is_ack_frame_ready()
 {
-  if (this->_available && this->_has_new_data && !this->_packet_numbers.empty() &&
+  if (this->_available && this->_has_new_data && !this->_ranges.empty() &&
       this->_latest_packet_received_time + this->_max_ack_delay * HRTIME_MSECOND <= Thread::get_hrtime()) {
     // when we has new data and the data is available to send (not ack only). and we delay for too much time. Send it out
     this->_should_send = true;
   }
 
-  return this->_should_send && this->_available && !this->_packet_numbers.empty();
+  return this->_should_send && this->_available && !this->_ranges.empty();
 }
 
 void
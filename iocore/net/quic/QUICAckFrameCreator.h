@@ -26,7 +26,7 @@
 #include "QUICFrameGenerator.h"
 #include "QUICTypes.h"
 #include "QUICFrame.h"
-#include <list>
+#include <vector>
 
 class QUICConnection;
 
@@ -36,9 +36,10 @@ public:
   class QUICAckFrameCreator
   {
   public:
-    struct RecvdPacket {
-      bool ack_only                  = false;
-      QUICPacketNumber packet_number = 0;
+    /// Packets smallest to largest were all received.
+    struct RecvdRange {
+      QUICPacketNumber smallest = 0;
+      QUICPacketNumber largest  = 0;
     };
     QUICAckFrameCreator(QUICPacketNumberSpace pn_space, QUICAckFrameManager *ack_manager);
     ~QUICAckFrameCreator();
@@ -46,7 +47,6 @@ public:
     void push_back(QUICPacketNumber packet_number, size_t size, bool ack_only);
     size_t size();
     void clear();
-    void sort();
     void forget(QUICPacketNumber largest_acknowledged);
     bool available() const;
     bool is_ack_frame_ready();
@@ -64,8 +64,15 @@ public:
   private:
     uint64_t _calculate_delay();
     QUICAckFrame *_create_ack_frame(uint8_t *buf);
-
-    std::list<RecvdPacket> _packet_numbers;
+    void _insert(QUICPacketNumber packet_number);
+
+    // The ranges of the packet numbers received, ascending and neither overlapping nor adjacent, so
+    // that a packet received in order only widens the last one. Only whether an ack-eliciting one
+    // was among them and the largest of those are kept of the packets themselves.
+    std::vector<RecvdRange> _ranges;
+    size_t _packet_count                    = 0;
+    bool _has_ack_eliciting                 = false;
+    QUICPacketNumber _largest_ack_eliciting = 0;
     bool _available                         = false; // packet_number has data to sent
     bool _should_send                       = false; // ack frame should be sent immediately
     bool _has_new_data                      = false; // new data after last sent
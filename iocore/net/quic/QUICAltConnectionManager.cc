@@ -35,8 +35,13 @@ static constexpr char V_DEBUG_TAG[] = "v_quic_alt_con";
 QUICAltConnectionManager::QUICAltConnectionManager(QUICConnection *qc, QUICConnectionTable &ctable, QUICResetTokenTable &rtable,
                                                    const QUICConnectionId &peer_initial_cid, uint32_t instance_id,
                                                    uint8_t local_active_cid_limit, const IpEndpoint *preferred_endpoint_ipv4,
-                                                   const IpEndpoint *preferred_endpoint_ipv6)
-  : _qc(qc), _ctable(ctable), _rtable(rtable), _instance_id(instance_id), _local_active_cid_limit(local_active_cid_limit)
+                                                   const IpEndpoint *preferred_endpoint_ipv6, int cid_thread_hint)
+  : _qc(qc),
+    _ctable(ctable),
+    _rtable(rtable),
+    _instance_id(instance_id),
+    _local_active_cid_limit(local_active_cid_limit),
+    _cid_thread_hint(cid_thread_hint)
 {
   // Sequence number of the initial CID is 0
   this->_alt_quic_connection_ids_remote.push_back({0, peer_initial_cid, {}, {true}});
@@ -111,6 +116,9 @@ QUICAltConnectionManager::_generate_next_alt_con_info()
 {
   QUICConnectionId conn_id;
   conn_id.randomize();
+  if (this->_cid_thread_hint >= 0) {
+    conn_id.set_thread_hint(this->_cid_thread_hint);
+  }
   QUICStatelessResetToken token(conn_id, this->_instance_id);
   AltConnectionInfo aci = {++this->_alt_quic_connection_id_seq_num, conn_id, token, {false}};
 
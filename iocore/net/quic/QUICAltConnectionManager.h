@@ -39,7 +39,7 @@ public:
   QUICAltConnectionManager(QUICConnection *qc, QUICConnectionTable &ctable, QUICResetTokenTable &rtable,
                            const QUICConnectionId &peer_initial_cid, uint32_t instance_id, uint8_t active_cid_limit,
                            const IpEndpoint *preferred_endpoint_ipv4 = nullptr,
-                           const IpEndpoint *preferred_endpoint_ipv6 = nullptr);
+                           const IpEndpoint *preferred_endpoint_ipv6 = nullptr, int cid_thread_hint = -1);
   ~QUICAltConnectionManager();
 
   /**
@@ -107,6 +107,7 @@ private:
   uint64_t _alt_quic_connection_id_seq_num       = 0;
   bool _need_advertise                           = false;
   QUICPreferredAddress *_local_preferred_address = nullptr;
+  int _cid_thread_hint                           = -1;
 
   AltConnectionInfo _generate_next_alt_con_info();
   void _init_alt_connection_ids();
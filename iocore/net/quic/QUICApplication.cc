@@ -107,6 +107,39 @@ QUICStreamIO::peek(uint8_t *buf, int64_t len)
   return this->_read_buffer_reader->memcpy(buf, len) - reinterpret_cast<char *>(buf);
 }
 
+Ptr<IOBufferBlock>
+QUICStreamIO::peek_blocks(int64_t offset, int64_t len)
+{
+  Ptr<IOBufferBlock> head;
+  if (this->_read_buffer_reader->read_avail() < offset + len) {
+    return head;
+  }
+
+  IOBufferBlock *tail = nullptr;
+  int64_t skip        = this->_read_buffer_reader->start_offset + offset;
+  for (IOBufferBlock *b = this->_read_buffer_reader->get_current_block(); b && len > 0; b = b->next.get()) {
+    if (skip >= b->read_avail()) {
+      skip -= b->read_avail();
+      continue;
+    }
+    IOBufferBlock *c = b->clone();
+    c->_start += skip;
+    skip = 0;
+    if (c->read_avail() > len) {
+      c->_buf_end = c->_end = c->_start + len;
+    }
+    len -= c->read_avail();
+    if (tail) {
+      tail->next = make_ptr<IOBufferBlock>(c);
+    } else {
+      head = make_ptr<IOBufferBlock>(c);
+    }
+    tail = c;
+  }
+
+  return head;
+}
+
 void
 QUICStreamIO::consume(int64_t len)
 {
@@ -168,8 +201,20 @@ QUICStreamIO::write(IOBufferReader *r, int64_t len)
 int64_t
 QUICStreamIO::write(IOBufferBlock *b)
 {
-  ink_assert(!"not implemented yet");
-  return 0;
+  SCOPED_MUTEX_LOCK(lock, this->_write_vio->mutex, this_ethread());
+
+  int64_t len = 0;
+  for (IOBufferBlock *p = b; p; p = p->next.get()) {
+    len += p->read_avail();
+  }
+
+  // The blocks are cloned onto the write buffer, their data is not copied.
+  int64_t nwritten = this->_write_buffer->write(b, len, 0);
+  if (nwritten > 0) {
+    this->_nwritten += nwritten;
+  }
+
+  return nwritten;
 }
 
 void
@@ -45,6 +45,11 @@ public:
 
   int64_t read(uint8_t *buf, int64_t len);
   int64_t peek(uint8_t *buf, int64_t len);
+  /**
+   * Like peek() but the returned blocks share the data with the read buffer. nullptr unless @a len bytes after @a offset are
+   * available. Nothing is consumed.
+   */
+  Ptr<IOBufferBlock> peek_blocks(int64_t offset, int64_t len);
   void consume(int64_t len);
   bool is_read_done();
   virtual void read_reenable();
@@ -0,0 +1,267 @@
+/** @file
+ *
+ *  A brief file description
+ *
+ *  @section license License
+ *
+ *  Licensed to the Apache Software Foundation (ASF) under one
+ *  or more contributor license agreements.  See the NOTICE file
+ *  distributed with this work for additional information
+ *  regarding copyright ownership.  The ASF licenses this file
+ *  to you under the Apache License, Version 2.0 (the
+ *  "License"); you may not use this file except in compliance
+ *  with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <algorithm>
+#include <iterator>
+
+#include <tscore/Diags.h>
+#include "QUICBBRCongestionController.h"
+
+#define QUICCCDebug(fmt, ...)                                                                                               \
+  Debug("quic_cc",                                                                                                          \
+        "[%s] "                                                                                                             \
+        "window: %" PRIu32 " bytes: %" PRIu32 " bw: %" PRIu64 " min_rtt: %" PRId64 " mode: %d " fmt,                        \
+        this->_context.connection_info()->cids().data(), this->_congestion_window, this->_bytes_in_flight, this->_max_bw,   \
+        this->_min_rtt, static_cast<int>(this->_mode), ##__VA_ARGS__)
+
+namespace
+{
+constexpr double BBR_STARTUP_GAIN           = 2.77;
+constexpr double BBR_CWND_GAIN              = 2.0;
+constexpr double BBR_BETA                   = 0.7;
+constexpr double BBR_PROBE_BW_GAINS[]       = {1.25, 0.75, 1.0, 1.0, 1.0, 1.0, 1.0, 1.0};
+constexpr int BBR_FULL_BW_ROUNDS            = 3;
+constexpr ink_hrtime BBR_PROBE_RTT_INTERVAL = HRTIME_SECONDS(5);
+constexpr ink_hrtime BBR_PROBE_RTT_DURATION = HRTIME_MSECONDS(200);
+constexpr uint32_t BBR_MIN_PIPE_PACKETS     = 4;
+} // namespace
+
+QUICBBRCongestionController::QUICBBRCongestionController(QUICContext &context) : QUICNewRenoCongestionController(context)
+{
+  this->reset();
+}
+
+void
+QUICBBRCongestionController::reset()
+{
+  QUICNewRenoCongestionController::reset();
+
+  SCOPED_MUTEX_LOCK(lock, this->_cc_mutex, this_ethread());
+  this->_mode            = Mode::STARTUP;
+  this->_delivered       = 0;
+  this->_round_delivered = 0;
+  this->_round_start     = 0;
+  this->_round_count     = 0;
+  std::fill(std::begin(this->_bw_samples), std::end(this->_bw_samples), 0);
+  this->_max_bw         = 0;
+  this->_full_bw        = 0;
+  this->_full_bw_count  = 0;
+  this->_filled_pipe    = false;
+  this->_min_rtt        = 0;
+  this->_min_rtt_stamp  = 0;
+  this->_probe_rtt_done = 0;
+  this->_inflight_hi    = UINT64_MAX;
+  this->_cycle_index    = 0;
+  this->_pacing_gain    = BBR_STARTUP_GAIN;
+  this->_cwnd_gain      = BBR_CWND_GAIN;
+}
+
+void
+QUICBBRCongestionController::on_packet_acked(const QUICPacketInfo &acked_packet)
+{
+  SCOPED_MUTEX_LOCK(lock, this->_cc_mutex, this_ethread());
+  this->_bytes_in_flight -= acked_packet.sent_bytes;
+  this->_delivered += acked_packet.sent_bytes;
+
+  ink_hrtime now   = Thread::get_hrtime();
+  bool round_start = this->_update_round(now);
+  this->_update_min_rtt(now);
+  this->_update_mode(now, round_start);
+  this->_set_congestion_window(acked_packet.sent_bytes);
+
+  if (round_start) {
+    QUICCCDebug("Round %" PRIu64 " ended", this->_round_count);
+    this->_metrics_updated();
+  }
+}
+
+uint64_t
+QUICBBRCongestionController::pacing_rate() const
+{
+  if (this->_max_bw == 0) {
+    // No bandwidth sample yet, pace the initial window over the RTT we have.
+    ink_hrtime srtt = this->_context.rtt_provider()->smoothed_rtt();
+    return srtt > 0 ? static_cast<uint64_t>(this->_pacing_gain * this->_congestion_window * HRTIME_SECOND / srtt) : 0;
+  }
+  return static_cast<uint64_t>(this->_pacing_gain * this->_max_bw);
+}
+
+// Called once per congestion event. BBR does not follow the loss down, it only stops putting more
+// in flight than the path held when the loss happened.
+void
+QUICBBRCongestionController::_reduce_congestion_window()
+{
+  uint64_t floor           = this->_k_minimum_window;
+  this->_inflight_hi       = std::max(static_cast<uint64_t>(this->_congestion_window * BBR_BETA), floor);
+  this->_congestion_window = std::min<uint64_t>(this->_congestion_window, this->_inflight_hi);
+  if (this->_mode == Mode::STARTUP) {
+    this->_filled_pipe = true;
+    this->_set_mode(Mode::DRAIN);
+  }
+  QUICCCDebug("Loss, inflight_hi: %" PRIu64, this->_inflight_hi);
+}
+
+// A round is one minimum RTT of ACKs. At the end of each the delivery rate over it goes into the
+// bandwidth filter.
+bool
+QUICBBRCongestionController::_update_round(ink_hrtime now)
+{
+  if (this->_round_start == 0) {
+    this->_round_start     = now;
+    this->_round_delivered = this->_delivered;
+    return false;
+  }
+
+  ink_hrtime interval = now - this->_round_start;
+  if (interval < std::max(this->_min_rtt, HRTIME_MSECONDS(1))) {
+    return false;
+  }
+
+  uint64_t sample = (this->_delivered - this->_round_delivered) * HRTIME_SECOND / interval;
+  this->_bw_samples[this->_round_count % BW_WINDOW_ROUNDS] = sample;
+  ++this->_round_count;
+  this->_max_bw          = *std::max_element(std::begin(this->_bw_samples), std::end(this->_bw_samples));
+  this->_round_start     = now;
+  this->_round_delivered = this->_delivered;
+
+  return true;
+}
+
+void
+QUICBBRCongestionController::_update_min_rtt(ink_hrtime now)
+{
+  ink_hrtime rtt = this->_context.rtt_provider()->latest_rtt();
+  if (rtt <= 0) {
+    return;
+  }
+
+  bool expired = this->_min_rtt_stamp && now - this->_min_rtt_stamp > BBR_PROBE_RTT_INTERVAL;
+  if (this->_min_rtt == 0 || rtt < this->_min_rtt || expired) {
+    this->_min_rtt       = rtt;
+    this->_min_rtt_stamp = now;
+  }
+
+  if (expired && this->_mode != Mode::PROBE_RTT) {
+    this->_set_mode(Mode::PROBE_RTT);
+    this->_probe_rtt_done = 0;
+  }
+}
+
+void
+QUICBBRCongestionController::_update_mode(ink_hrtime now, bool round_start)
+{
+  switch (this->_mode) {
+  case Mode::STARTUP:
+    // The pipe is full once three rounds in a row did not grow the bandwidth by a quarter.
+    if (round_start && this->_max_bw) {
+      if (this->_max_bw >= this->_full_bw * 5 / 4) {
+        this->_full_bw       = this->_max_bw;
+        this->_full_bw_count = 0;
+      } else if (++this->_full_bw_count >= BBR_FULL_BW_ROUNDS) {
+        this->_filled_pipe = true;
+        this->_set_mode(Mode::DRAIN);
+      }
+    }
+    break;
+  case Mode::DRAIN:
+    if (this->_bytes_in_flight <= this->_bdp(1.0)) {
+      this->_set_mode(Mode::PROBE_BW);
+    }
+    break;
+  case Mode::PROBE_BW:
+    if (round_start) {
+      this->_cycle_index = (this->_cycle_index + 1) % static_cast<int>(std::size(BBR_PROBE_BW_GAINS));
+      this->_pacing_gain = BBR_PROBE_BW_GAINS[this->_cycle_index];
+      // Probing up, let a quarter more than the last loss point in flight.
+      if (this->_cycle_index == 0 && this->_inflight_hi != UINT64_MAX) {
+        this->_inflight_hi += this->_inflight_hi / 4;
+      }
+    }
+    break;
+  case Mode::PROBE_RTT:
+    if (this->_probe_rtt_done == 0) {
+      if (this->_bytes_in_flight <= this->_bdp(0.5)) {
+        this->_probe_rtt_done = now + BBR_PROBE_RTT_DURATION;
+      }
+    } else if (now >= this->_probe_rtt_done) {
+      this->_min_rtt_stamp = now;
+      this->_set_mode(this->_filled_pipe ? Mode::PROBE_BW : Mode::STARTUP);
+    }
+    break;
+  }
+}
+
+void
+QUICBBRCongestionController::_set_mode(Mode mode)
+{
+  this->_mode = mode;
+  switch (mode) {
+  case Mode::STARTUP:
+    this->_pacing_gain = BBR_STARTUP_GAIN;
+    break;
+  case Mode::DRAIN:
+    this->_pacing_gain = 1 / BBR_STARTUP_GAIN;
+    break;
+  case Mode::PROBE_BW:
+    this->_cycle_index = 0;
+    this->_pacing_gain = BBR_PROBE_BW_GAINS[0];
+    break;
+  case Mode::PROBE_RTT:
+    this->_pacing_gain = 1.0;
+    break;
+  }
+  this->_context.trigger(QUICContext::CallbackEvent::CONGESTION_STATE_CHANGED,
+                         mode == Mode::STARTUP ? QUICCongestionController::State::SLOW_START :
+                                                 QUICCongestionController::State::CONGESTION_AVOIDANCE);
+  QUICCCDebug("Mode changed");
+}
+
+void
+QUICBBRCongestionController::_set_congestion_window(uint32_t acked_bytes)
+{
+  uint64_t min_window = std::max(this->_k_minimum_window, BBR_MIN_PIPE_PACKETS * this->_k_max_datagram_size);
+  uint64_t cwnd       = this->_congestion_window;
+
+  if (this->_mode == Mode::PROBE_RTT) {
+    cwnd = std::max(this->_bdp(0.5), min_window);
+  } else if (this->_max_bw == 0) {
+    // No model yet, grow as slow start does.
+    cwnd += acked_bytes;
+  } else {
+    uint64_t target = this->_bdp(this->_cwnd_gain) + 3 * this->_k_max_datagram_size;
+    if (this->_filled_pipe) {
+      cwnd = std::min(cwnd + acked_bytes, target);
+    } else if (cwnd < target || this->_delivered < this->_k_initial_window) {
+      cwnd += acked_bytes;
+    }
+  }
+
+  cwnd                     = std::min(cwnd, this->_inflight_hi);
+  this->_congestion_window = static_cast<uint32_t>(std::min<uint64_t>(std::max(cwnd, min_window), UINT32_MAX));
+}
+
+uint64_t
+QUICBBRCongestionController::_bdp(double gain) const
+{
+  return static_cast<uint64_t>(gain * this->_max_bw * this->_min_rtt / HRTIME_SECOND);
+}
@@ -0,0 +1,99 @@
+/** @file
+ *
+ *  BBRv2 congestion control
+ *
+ *  @section license License
+ *
+ *  Licensed to the Apache Software Foundation (ASF) under one
+ *  or more contributor license agreements.  See the NOTICE file
+ *  distributed with this work for additional information
+ *  regarding copyright ownership.  The ASF licenses this file
+ *  to you under the Apache License, Version 2.0 (the
+ *  "License"); you may not use this file except in compliance
+ *  with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include "QUICLossDetector.h"
+
+/**
+   A model based controller after BBRv2 (draft-cardwell-iccrg-bbr-congestion-control). Instead of
+   reacting to each loss it estimates the bottleneck bandwidth (the largest delivery rate over the
+   last rounds) and the minimum RTT, and keeps about two BDPs in flight, pacing at a gain over the
+   bandwidth that cycles to probe for more. Loss only caps the window through @c _inflight_hi, so
+   random loss on mobile paths does not collapse the sending rate.
+
+   This is simpler than the draft: delivery rate is sampled once per round from the bytes acked
+   over it rather than per packet, and PROBE_BW uses the eight phase gain cycle of BBRv1.
+ */
+class QUICBBRCongestionController : public QUICNewRenoCongestionController
+{
+public:
+  enum class Mode : uint8_t {
+    STARTUP,
+    DRAIN,
+    PROBE_BW,
+    PROBE_RTT,
+  };
+
+  QUICBBRCongestionController(QUICContext &context);
+  void on_packet_acked(const QUICPacketInfo &acked_packet) override;
+  void reset() override;
+  uint64_t pacing_rate() const override;
+
+  Mode
+  mode() const
+  {
+    return this->_mode;
+  }
+
+  /// Bytes per second, zero until the first round is over.
+  uint64_t
+  max_bandwidth() const
+  {
+    return this->_max_bw;
+  }
+
+protected:
+  void _reduce_congestion_window() override;
+
+private:
+  static constexpr int BW_WINDOW_ROUNDS = 10;
+
+  bool _update_round(ink_hrtime now);
+  void _update_min_rtt(ink_hrtime now);
+  void _update_mode(ink_hrtime now, bool round_start);
+  void _set_mode(Mode mode);
+  void _set_congestion_window(uint32_t acked_bytes);
+  uint64_t _bdp(double gain) const;
+
+  Mode _mode = Mode::STARTUP;
+
+  uint64_t _delivered       = 0; ///< Bytes acked so far.
+  uint64_t _round_delivered = 0; ///< @c _delivered at the start of the round.
+  ink_hrtime _round_start   = 0;
+  uint64_t _round_count     = 0;
+
+  uint64_t _bw_samples[BW_WINDOW_ROUNDS] = {0};
+  uint64_t _max_bw                       = 0;
+  uint64_t _full_bw                      = 0;
+  int _full_bw_count                     = 0;
+  bool _filled_pipe                      = false;
+
+  ink_hrtime _min_rtt        = 0;
+  ink_hrtime _min_rtt_stamp  = 0;
+  ink_hrtime _probe_rtt_done = 0;
+  uint64_t _inflight_hi      = UINT64_MAX; ///< Cap on the window from the last loss.
+  int _cycle_index           = 0;
+  double _pacing_gain        = 0.0;
+  double _cwnd_gain          = 0.0;
+};
@@ -184,7 +184,7 @@ QUICBidirectionalStream::recv(const QUICStreamFrame &frame)
     return std::make_unique<QUICConnectionError>(QUICTransErrorCode::FLOW_CONTROL_ERROR);
   }
 
-  // Make a copy and insert it into the receive buffer because the frame passed is temporal
+  // Make a copy, which shares the data, and insert it into the receive buffer because the frame passed is temporal
   QUICFrame *cloned             = new QUICStreamFrame(frame);
   QUICConnectionErrorUPtr error = this->_received_stream_frame_buffer.insert(cloned);
   if (error != nullptr) {
@@ -202,8 +202,8 @@ QUICBidirectionalStream::recv(const QUICStreamFrame &frame)
     last_offset  = stream_frame->offset();
     last_length  = stream_frame->data_length();
 
-    this->_write_to_read_vio(stream_frame->offset(), reinterpret_cast<uint8_t *>(stream_frame->data()->start()),
-                             stream_frame->data_length(), stream_frame->has_fin_flag());
+    this->_write_to_read_vio(stream_frame->offset(), stream_frame->data(), stream_frame->data_length(),
+                             stream_frame->has_fin_flag());
     this->_state.update_with_receiving_frame(*new_frame);
 
     delete new_frame;
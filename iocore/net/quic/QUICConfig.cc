@@ -119,6 +119,9 @@ QUICConfigParams::initialize()
   REC_EstablishStaticConfigInt32U(this->_instance_id, "proxy.config.quic.instance_id");
   REC_EstablishStaticConfigInt32(this->_connection_table_size, "proxy.config.quic.connection_table.size");
   REC_EstablishStaticConfigInt32U(this->_stateless_retry, "proxy.config.quic.server.stateless_retry_enabled");
+  REC_EstablishStaticConfigInt32U(this->_retry_token_lifetime, "proxy.config.quic.server.retry_token_lifetime");
+  REC_EstablishStaticConfigInt32U(this->_invalid_token_close_rate, "proxy.config.quic.server.invalid_token_close_rate");
+  REC_EstablishStaticConfigInt32U(this->_cid_steering, "proxy.config.quic.server.cid_steering");
   REC_EstablishStaticConfigInt32U(this->_vn_exercise_enabled, "proxy.config.quic.client.vn_exercise_enabled");
   REC_EstablishStaticConfigInt32U(this->_cm_exercise_enabled, "proxy.config.quic.client.cm_exercise_enabled");
   REC_EstablishStaticConfigInt32U(this->_quantum_readiness_test_enabled_out,
@@ -179,6 +182,7 @@ QUICConfigParams::initialize()
   this->_ld_initial_rtt = HRTIME_MSECONDS(timeout);
 
   // Congestion Control
+  REC_EstablishStaticConfigInt32U(this->_cc_algorithm, "proxy.config.quic.congestion_control.algorithm");
   REC_EstablishStaticConfigInt32U(this->_cc_max_datagram_size, "proxy.config.quic.congestion_control.max_datagram_size");
   REC_EstablishStaticConfigInt32U(this->_cc_initial_window_scale, "proxy.config.quic.congestion_control.initial_window_scale");
   REC_EstablishStaticConfigInt32U(this->_cc_minimum_window_scale, "proxy.config.quic.congestion_control.minimum_window_scale");
@@ -239,6 +243,24 @@ QUICConfigParams::stateless_retry() const
   return this->_stateless_retry;
 }
 
+uint32_t
+QUICConfigParams::retry_token_lifetime() const
+{
+  return this->_retry_token_lifetime;
+}
+
+uint32_t
+QUICConfigParams::invalid_token_close_rate() const
+{
+  return this->_invalid_token_close_rate;
+}
+
+uint32_t
+QUICConfigParams::cid_steering() const
+{
+  return this->_cid_steering;
+}
+
 uint32_t
 QUICConfigParams::vn_exercise_enabled() const
 {
@@ -419,6 +441,12 @@ QUICConfigParams::ld_initial_rtt() const
   return _ld_initial_rtt;
 }
 
+uint32_t
+QUICConfigParams::cc_algorithm() const
+{
+  return _cc_algorithm;
+}
+
 uint32_t
 QUICConfigParams::cc_max_datagram_size() const
 {
@@ -38,6 +38,9 @@ public:
 
   uint32_t instance_id() const;
   uint32_t stateless_retry() const;
+  uint32_t retry_token_lifetime() const;
+  uint32_t invalid_token_close_rate() const;
+  uint32_t cid_steering() const;
   uint32_t vn_exercise_enabled() const;
   uint32_t cm_exercise_enabled() const;
   uint32_t quantum_readiness_test_enabled_in() const;
@@ -83,6 +86,7 @@ public:
   ink_hrtime ld_initial_rtt() const;
 
   // Congestion Control
+  uint32_t cc_algorithm() const;
   uint32_t cc_max_datagram_size() const;
   uint32_t cc_initial_window() const;
   uint32_t cc_minimum_window() const;
@@ -99,6 +103,9 @@ private:
 
   uint32_t _instance_id                        = 0;
   uint32_t _stateless_retry                    = 0;
+  uint32_t _retry_token_lifetime               = 10;
+  uint32_t _invalid_token_close_rate           = 100;
+  uint32_t _cid_steering                       = 0;
   uint32_t _vn_exercise_enabled                = 0;
   uint32_t _cm_exercise_enabled                = 0;
   uint32_t _quantum_readiness_test_enabled_in  = 0;
@@ -146,6 +153,7 @@ private:
   ink_hrtime _ld_initial_rtt    = HRTIME_MSECONDS(500);
 
   // [draft-11 recovery] 4.7.1.  Constants of interest
+  uint32_t _cc_algorithm                       = 0;
   uint32_t _cc_max_datagram_size               = 1200;
   uint32_t _cc_initial_window_scale            = 10; // Actual initial window size is this value multiplied by the _cc_default_mss
   uint32_t _cc_minimum_window_scale            = 2;  // Actual minimum window size is this value multiplied by the _cc_default_mss
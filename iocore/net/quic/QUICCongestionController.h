@@ -63,4 +63,6 @@ public:
   virtual uint32_t bytes_in_flight() const   = 0;
   virtual uint32_t congestion_window() const = 0;
   virtual uint32_t current_ssthresh() const  = 0;
+  // Bytes per second, 0 if unknown
+  virtual uint64_t pacing_rate() const       = 0;
 };
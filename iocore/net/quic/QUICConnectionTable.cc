@@ -23,6 +23,28 @@
 
 #include "QUICConnectionTable.h"
 
+#include <algorithm>
+#include <cstring>
+#include <random>
+
+#include "tscore/ink_hrtime.h"
+
+// How long a table that was rehashed away stays readable. A lookup is a short probe, nothing is still reading it by then.
+static constexpr ink_hrtime RETIRED_TABLE_GRACE = HRTIME_SECONDS(1);
+
+QUICConnectionTable::QUICConnectionTable(int hash_table_size)
+{
+  std::random_device rnd;
+  this->_seed = (static_cast<uint64_t>(rnd()) << 32) | rnd();
+
+  this->_min_size = 16;
+  while (this->_min_size < static_cast<size_t>(hash_table_size)) {
+    this->_min_size <<= 1;
+  }
+  this->_tables.emplace_back(new Table(this->_min_size));
+  this->_table.store(this->_tables.back().get(), std::memory_order_release);
+}
+
 QUICConnectionTable::~QUICConnectionTable()
 {
   // TODO: clear all values.
@@ -31,36 +53,195 @@ QUICConnectionTable::~QUICConnectionTable()
 QUICConnection *
 QUICConnectionTable::insert(QUICConnectionId cid, QUICConnection *connection)
 {
-  Ptr<ProxyMutex> m = _connections.lock_for_key(cid);
-  SCOPED_MUTEX_LOCK(lock, m, this_ethread());
-  // To check whether the return value is nullptr by caller in case memory leak.
-  // The return value isn't nullptr, the new value will take up the slot and return old value.
-  return _connections.insert_entry(cid, connection);
+  Key key = _key(cid);
+  std::lock_guard<std::mutex> lock(this->_mutex);
+
+  if ((this->_used + 1) * 4 > (this->_table.load(std::memory_order_relaxed)->mask + 1) * 3) {
+    this->_rehash();
+  }
+
+  Table *t       = this->_table.load(std::memory_order_relaxed);
+  Slot *free_one = nullptr;
+  for (size_t i = this->_hash(key) & t->mask;; i = (i + 1) & t->mask) {
+    Slot &slot  = t->slots[i];
+    Entry entry = _read(slot);
+    if (entry.state == USED && entry.key == key) {
+      // To check whether the return value is nullptr by caller in case memory leak.
+      // The return value isn't nullptr, the new value will take up the slot and return old value.
+      _write(slot, USED, key, connection);
+      return entry.connection;
+    }
+    if (entry.state == DELETED && free_one == nullptr) {
+      free_one = &slot;
+    }
+    if (entry.state == EMPTY) {
+      if (free_one == nullptr) {
+        free_one = &slot;
+        ++this->_used;
+      }
+      break;
+    }
+  }
+
+  _write(*free_one, USED, key, connection);
+  ++this->_live;
+  return nullptr;
 }
 
 void
 QUICConnectionTable::erase(QUICConnectionId cid, QUICConnection *connection)
 {
-  Ptr<ProxyMutex> m = _connections.lock_for_key(cid);
-  SCOPED_MUTEX_LOCK(lock, m, this_ethread());
-  QUICConnection *ret_connection = _connections.remove_entry(cid);
-  if (ret_connection) {
-    ink_assert(ret_connection == connection);
-  }
+  Key key = _key(cid);
+  std::lock_guard<std::mutex> lock(this->_mutex);
+  this->_erase(key, connection);
 }
 
 QUICConnection *
 QUICConnectionTable::erase(QUICConnectionId cid)
 {
-  Ptr<ProxyMutex> m = _connections.lock_for_key(cid);
-  SCOPED_MUTEX_LOCK(lock, m, this_ethread());
-  return _connections.remove_entry(cid);
+  Key key = _key(cid);
+  std::lock_guard<std::mutex> lock(this->_mutex);
+  return this->_erase(key, nullptr);
 }
 
 QUICConnection *
 QUICConnectionTable::lookup(QUICConnectionId cid)
 {
-  Ptr<ProxyMutex> m = _connections.lock_for_key(cid);
-  SCOPED_MUTEX_LOCK(lock, m, this_ethread());
-  return _connections.lookup_entry(cid);
+  Key key        = _key(cid);
+  const Table *t = this->_table.load(std::memory_order_acquire);
+  for (size_t i = this->_hash(key) & t->mask;; i = (i + 1) & t->mask) {
+    Entry entry = _read(t->slots[i]);
+    if (entry.state == EMPTY) {
+      return nullptr;
+    }
+    if (entry.state == USED && entry.key == key) {
+      return entry.connection;
+    }
+  }
+}
+
+QUICConnectionTable::Key
+QUICConnectionTable::_key(const QUICConnectionId &cid)
+{
+  uint8_t buf[sizeof(Key::w)] = {0};
+  memcpy(buf, static_cast<const uint8_t *>(cid), cid.length());
+  buf[QUICConnectionId::MAX_LENGTH] = cid.length();
+
+  Key key;
+  memcpy(key.w, buf, sizeof(buf));
+  return key;
+}
+
+uint64_t
+QUICConnectionTable::_hash(const Key &key) const
+{
+  // Seeded so that peers choosing their own IDs cannot line them up on one probe sequence
+  uint64_t h = this->_seed;
+  for (uint64_t w : key.w) {
+    h ^= w;
+    h *= 0x9E3779B97F4A7C15ULL;
+    h ^= h >> 32;
+  }
+  return h;
+}
+
+QUICConnectionTable::Entry
+QUICConnectionTable::_read(const Slot &slot)
+{
+  Entry entry;
+  for (;;) {
+    uint32_t seq = slot.seq.load(std::memory_order_acquire);
+    if (seq & 1) {
+      continue;
+    }
+    entry.state = static_cast<SlotState>(slot.state.load(std::memory_order_relaxed));
+    for (int i = 0; i < 3; ++i) {
+      entry.key.w[i] = slot.key[i].load(std::memory_order_relaxed);
+    }
+    entry.connection = slot.connection.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.seq.load(std::memory_order_relaxed) == seq) {
+      return entry;
+    }
+  }
+}
+
+void
+QUICConnectionTable::_write(Slot &slot, SlotState state, const Key &key, QUICConnection *connection)
+{
+  uint32_t seq = slot.seq.load(std::memory_order_relaxed);
+  slot.seq.store(seq + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  slot.state.store(state, std::memory_order_relaxed);
+  for (int i = 0; i < 3; ++i) {
+    slot.key[i].store(key.w[i], std::memory_order_relaxed);
+  }
+  slot.connection.store(connection, std::memory_order_relaxed);
+  slot.seq.store(seq + 2, std::memory_order_release);
+}
+
+QUICConnection *
+QUICConnectionTable::_erase(const Key &key, const QUICConnection *connection)
+{
+  Table *t = this->_table.load(std::memory_order_relaxed);
+  for (size_t i = this->_hash(key) & t->mask;; i = (i + 1) & t->mask) {
+    Entry entry = _read(t->slots[i]);
+    if (entry.state == EMPTY) {
+      return nullptr;
+    }
+    if (entry.state != USED || !(entry.key == key)) {
+      continue;
+    }
+
+    if (connection) {
+      ink_assert(entry.connection == connection);
+    }
+    _write(t->slots[i], DELETED, key, nullptr);
+    --this->_live;
+
+    // A deleted slot right before an empty one ends no probe that would not end there anyway
+    if (_read(t->slots[(i + 1) & t->mask]).state == EMPTY) {
+      for (size_t j = i; _read(t->slots[j]).state == DELETED; j = (j - 1) & t->mask) {
+        _write(t->slots[j], EMPTY, Key(), nullptr);
+        --this->_used;
+      }
+    }
+    return entry.connection;
+  }
+}
+
+void
+QUICConnectionTable::_rehash()
+{
+  ink_hrtime now = Thread::get_hrtime();
+  Table *old     = this->_table.load(std::memory_order_relaxed);
+
+  // At most half full afterwards, so a quarter of the slots can be used before the next rehash
+  size_t size = this->_min_size;
+  while (size < (this->_live + 1) * 2) {
+    size <<= 1;
+  }
+
+  Table *t = new Table(size);
+  for (size_t i = 0; i <= old->mask; ++i) {
+    Entry entry = _read(old->slots[i]);
+    if (entry.state != USED) {
+      continue;
+    }
+    size_t j = this->_hash(entry.key) & t->mask;
+    while (t->slots[j].state.load(std::memory_order_relaxed) != EMPTY) {
+      j = (j + 1) & t->mask;
+    }
+    _write(t->slots[j], USED, entry.key, entry.connection);
+  }
+  this->_used = this->_live;
+
+  // Free what nobody can be reading any more, the current table is always last
+  old->retired = now;
+  auto last    = std::remove_if(this->_tables.begin(), this->_tables.end() - 1, [now](const std::unique_ptr<Table> &r) {
+    return r->retired + RETIRED_TABLE_GRACE < now;
+  });
+  this->_tables.erase(last, this->_tables.end() - 1);
+  this->_tables.emplace_back(t);
+  this->_table.store(t, std::memory_order_release);
 }
@@ -23,14 +23,25 @@
 
 #pragma once
 
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
 #include "QUICTypes.h"
 #include "QUICConnection.h"
-#include "tscore/MT_hashtable.h"
 
+/*
+ * Connection IDs to connections, looked up for every packet received.
+ *
+ * Lookups take no lock. The table is open addressed and each slot is guarded by a sequence number, a reader copies the slot and
+ * tries again if a writer changed it meanwhile. Writers are serialized by a mutex. When the table fills up it is rehashed into a
+ * new array, readers that started on the old one still find everything it held, so it is freed only a while after the switch.
+ */
 class QUICConnectionTable
 {
 public:
-  QUICConnectionTable(int hash_table_size = 65521) : _connections(hash_table_size) {}
+  QUICConnectionTable(int hash_table_size = 65521);
   ~QUICConnectionTable();
   /*
    * Insert an entry
@@ -54,5 +65,50 @@ public:
   QUICConnection *lookup(QUICConnectionId cid);
 
 private:
-  MTHashTable<QUICConnectionId, QUICConnection *> _connections;
+  enum SlotState : uint8_t { EMPTY = 0, USED, DELETED };
+
+  // The ID bytes followed by the length, in words a reader can load atomically.
+  struct Key {
+    uint64_t w[3] = {};
+    bool
+    operator==(const Key &x) const
+    {
+      return w[0] == x.w[0] && w[1] == x.w[1] && w[2] == x.w[2];
+    }
+  };
+
+  struct Slot {
+    std::atomic<uint32_t> seq{0}; ///< Odd while a writer is changing the slot.
+    std::atomic<uint8_t> state{EMPTY};
+    std::atomic<uint64_t> key[3] = {};
+    std::atomic<QUICConnection *> connection{nullptr};
+  };
+
+  struct Entry {
+    SlotState state;
+    Key key;
+    QUICConnection *connection;
+  };
+
+  struct Table {
+    explicit Table(size_t size) : mask(size - 1), slots(new Slot[size]) {}
+    size_t mask;
+    std::unique_ptr<Slot[]> slots;
+    ink_hrtime retired = 0;
+  };
+
+  static Key _key(const QUICConnectionId &cid);
+  uint64_t _hash(const Key &key) const;
+  static Entry _read(const Slot &slot);
+  static void _write(Slot &slot, SlotState state, const Key &key, QUICConnection *connection);
+  QUICConnection *_erase(const Key &key, const QUICConnection *connection);
+  void _rehash();
+
+  std::atomic<Table *> _table{nullptr};
+  std::vector<std::unique_ptr<Table>> _tables; ///< The current table last, older ones until they are freed.
+  std::mutex _mutex;
+  uint64_t _seed;
+  size_t _min_size = 0;
+  size_t _live     = 0;
+  size_t _used     = 0; ///< Live and deleted slots, only an empty slot ends a probe.
 };
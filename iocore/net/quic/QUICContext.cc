@@ -32,6 +32,19 @@ public:
   virtual ~QUICCCConfigQCP() {}
   QUICCCConfigQCP(const QUICConfigParams *params) : _params(params) {}
 
+  QUICCongestionControlAlgorithm
+  algorithm() const override
+  {
+    switch (this->_params->cc_algorithm()) {
+    case 1:
+      return QUICCongestionControlAlgorithm::CUBIC;
+    case 2:
+      return QUICCongestionControlAlgorithm::BBR2;
+    default:
+      return QUICCongestionControlAlgorithm::NEW_RENO;
+    }
+  }
+
   uint32_t
   max_datagram_size() const override
   {
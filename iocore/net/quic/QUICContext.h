@@ -59,7 +59,7 @@ public:
   virtual void packet_recv_callback(QUICCallbackContext &, const QUICPacket &p){};
   // callback on packet acked event
   virtual void cc_metrics_update_callback(QUICCallbackContext &, uint64_t congestion_window, uint64_t bytes_in_flight,
-                                          uint64_t sshresh){};
+                                          uint64_t sshresh, uint64_t pacing_rate){};
   // callback on packet receive event
   virtual void frame_packetize_callback(QUICCallbackContext &, const QUICFrame &p){};
   // callback on packet receive event
@@ -137,11 +137,11 @@ public:
   }
 
   void
-  trigger(CallbackEvent e, uint64_t congestion_window, uint64_t bytes_in_flight, uint64_t sshresh)
+  trigger(CallbackEvent e, uint64_t congestion_window, uint64_t bytes_in_flight, uint64_t sshresh, uint64_t pacing_rate = 0)
   {
     QUICCallbackContext ctx;
     for (auto &&it : this->_callbacks) {
-      it->cc_metrics_update_callback(ctx, congestion_window, bytes_in_flight, sshresh);
+      it->cc_metrics_update_callback(ctx, congestion_window, bytes_in_flight, sshresh, pacing_rate);
     }
   }
 
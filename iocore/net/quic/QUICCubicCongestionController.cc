@@ -0,0 +1,101 @@
+/** @file
+ *
+ *  A brief file description
+ *
+ *  @section license License
+ *
+ *  Licensed to the Apache Software Foundation (ASF) under one
+ *  or more contributor license agreements.  See the NOTICE file
+ *  distributed with this work for additional information
+ *  regarding copyright ownership.  The ASF licenses this file
+ *  to you under the Apache License, Version 2.0 (the
+ *  "License"); you may not use this file except in compliance
+ *  with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <cmath>
+
+#include <tscore/Diags.h>
+#include "QUICCubicCongestionController.h"
+
+#define QUICCCDebug(fmt, ...)                                                                                               \
+  Debug("quic_cc",                                                                                                          \
+        "[%s] "                                                                                                             \
+        "window: %" PRIu32 " bytes: %" PRIu32 " ssthresh: %" PRIu32 " w_max: %.0f " fmt,                                    \
+        this->_context.connection_info()->cids().data(), this->_congestion_window, this->_bytes_in_flight, this->_ssthresh, \
+        this->_w_max, ##__VA_ARGS__)
+
+namespace
+{
+// RFC 8312 4.5 and 5
+constexpr double CUBIC_C    = 0.4;
+constexpr double CUBIC_BETA = 0.7;
+} // namespace
+
+QUICCubicCongestionController::QUICCubicCongestionController(QUICContext &context) : QUICNewRenoCongestionController(context) {}
+
+void
+QUICCubicCongestionController::reset()
+{
+  QUICNewRenoCongestionController::reset();
+  this->_epoch_start = 0;
+  this->_w_max       = 0.0;
+  this->_k           = 0.0;
+  this->_origin      = 0.0;
+  this->_w_est       = 0.0;
+}
+
+void
+QUICCubicCongestionController::_congestion_avoidance(const QUICPacketInfo &acked_packet)
+{
+  double mss     = this->_k_max_datagram_size;
+  double cwnd    = this->_congestion_window;
+  ink_hrtime now = Thread::get_hrtime();
+
+  if (this->_epoch_start == 0) {
+    this->_epoch_start = now;
+    if (cwnd < this->_w_max) {
+      this->_k      = std::cbrt((this->_w_max - cwnd) / mss / CUBIC_C);
+      this->_origin = this->_w_max;
+    } else {
+      this->_k      = 0.0;
+      this->_origin = cwnd;
+    }
+    this->_w_est = cwnd;
+  }
+
+  // RFC 8312 4.1, the target is where the curve will be one RTT from now.
+  double t      = static_cast<double>(now - this->_epoch_start + this->_context.rtt_provider()->smoothed_rtt()) / HRTIME_SECOND;
+  double target = this->_origin + CUBIC_C * std::pow(t - this->_k, 3) * mss;
+  target        = std::min(std::max(target, cwnd), 1.5 * cwnd);
+
+  // RFC 8312 4.2, NewReno's window with the same average over a loss cycle.
+  this->_w_est += mss * (3 * (1 - CUBIC_BETA) / (1 + CUBIC_BETA)) * acked_packet.sent_bytes / cwnd;
+
+  double next              = cwnd + (target - cwnd) * acked_packet.sent_bytes / cwnd;
+  this->_congestion_window = static_cast<uint32_t>(std::max(next, this->_w_est));
+}
+
+void
+QUICCubicCongestionController::_reduce_congestion_window()
+{
+  double cwnd = this->_congestion_window;
+
+  // RFC 8312 4.6, fast convergence: give up some of the window if the last one was not reached.
+  if (cwnd < this->_w_max) {
+    this->_w_max = cwnd * (1 + CUBIC_BETA) / 2;
+  } else {
+    this->_w_max = cwnd;
+  }
+  this->_epoch_start       = 0;
+  this->_congestion_window = std::max(static_cast<uint32_t>(cwnd * CUBIC_BETA), this->_k_minimum_window);
+  QUICCCDebug("Window reduced");
+}
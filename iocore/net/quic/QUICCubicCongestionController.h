@@ -0,0 +1,50 @@
+/** @file
+ *
+ *  CUBIC congestion control (RFC 8312)
+ *
+ *  @section license License
+ *
+ *  Licensed to the Apache Software Foundation (ASF) under one
+ *  or more contributor license agreements.  See the NOTICE file
+ *  distributed with this work for additional information
+ *  regarding copyright ownership.  The ASF licenses this file
+ *  to you under the Apache License, Version 2.0 (the
+ *  "License"); you may not use this file except in compliance
+ *  with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include "QUICLossDetector.h"
+
+/**
+   NewReno with the window growth and reduction of CUBIC. After a congestion event the window
+   grows along a cubic curve back to where the loss happened and then probes beyond it, which
+   recovers much faster than NewReno on paths with a large BDP or random loss. The window never
+   grows slower than NewReno would (the TCP friendly region).
+ */
+class QUICCubicCongestionController : public QUICNewRenoCongestionController
+{
+public:
+  QUICCubicCongestionController(QUICContext &context);
+  void reset() override;
+
+protected:
+  void _congestion_avoidance(const QUICPacketInfo &acked_packet) override;
+  void _reduce_congestion_window() override;
+
+private:
+  ink_hrtime _epoch_start = 0;   ///< Start of the current growth epoch, zero until the first ACK after a reduction.
+  double _w_max           = 0.0; ///< Window before the last reduction, in bytes.
+  double _k               = 0.0; ///< Seconds from the epoch start until the curve reaches @c _w_max.
+  double _origin          = 0.0; ///< Window the curve is centered on, in bytes.
+  double _w_est           = 0.0; ///< Window NewReno would have, in bytes.
+};
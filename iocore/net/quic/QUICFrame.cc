@@ -51,6 +51,32 @@ read_varint(uint8_t *&pos, size_t len, uint64_t &field, size_t &field_len)
   return true;
 }
 
+// The data of a STREAM or CRYPTO frame. A received packet has its decrypted payload in one block, which the
+// frame shares instead of copying out of it.
+static Ptr<IOBufferBlock>
+frame_data_block(const uint8_t *data, uint64_t data_len, const QUICPacketR *packet)
+{
+  Ptr<IOBufferBlock> block;
+  if (packet) {
+    Ptr<IOBufferBlock> payload = packet->payload_block();
+    const char *start          = reinterpret_cast<const char *>(data);
+    if (payload && !payload->next && payload->start() <= start && start + data_len <= payload->end()) {
+      block           = make_ptr<IOBufferBlock>(payload->clone());
+      block->_start   = const_cast<char *>(start);
+      block->_end     = block->_start + data_len;
+      block->_buf_end = block->_end;
+      return block;
+    }
+  }
+
+  block = make_ptr<IOBufferBlock>(new_IOBufferBlock());
+  block->alloc(iobuffer_size_to_index(data_len, BUFFER_SIZE_INDEX_32K));
+  ink_assert(static_cast<uint64_t>(block->write_avail()) >= data_len);
+  memcpy(block->start(), data, data_len);
+  block->fill(data_len);
+  return block;
+}
+
 QUICFrameType
 QUICFrame::type() const
 {
@@ -198,11 +224,7 @@ QUICStreamFrame::parse(const uint8_t *buf, size_t len, const QUICPacketR *packet
   }
 
   this->_valid = true;
-  this->_block = make_ptr<IOBufferBlock>(new_IOBufferBlock());
-  this->_block->alloc(BUFFER_SIZE_INDEX_32K);
-  ink_assert(static_cast<uint64_t>(this->_block->write_avail()) > data_len);
-  memcpy(this->_block->start(), pos, data_len);
-  this->_block->fill(data_len);
+  this->_block = frame_data_block(pos, data_len, packet);
   pos += data_len;
   this->_size = FRAME_SIZE(pos);
 }
@@ -425,11 +447,7 @@ QUICCryptoFrame::parse(const uint8_t *buf, size_t len, const QUICPacketR *packet
   }
 
   this->_valid = true;
-  this->_block = make_ptr<IOBufferBlock>(new_IOBufferBlock());
-  this->_block->alloc(BUFFER_SIZE_INDEX_32K);
-  ink_assert(static_cast<uint64_t>(this->_block->write_avail()) > data_len);
-  memcpy(this->_block->start(), pos, data_len);
-  this->_block->fill(data_len);
+  this->_block = frame_data_block(pos, data_len, packet);
   pos += data_len;
   this->_size = FRAME_SIZE(pos);
 }
@@ -92,6 +92,15 @@ QUIC::_register_stats()
   // Transfered packet counts
   RecRegisterRawStat(quic_rsb, RECT_PROCESS, "proxy.process.quic.total_packets_sent", RECD_INT, RECP_PERSISTENT,
                      static_cast<int>(QUICStats::total_packets_sent_stat), RecRawStatSyncSum);
+  // Stateless Retry, a flood of spoofed Initial packets shows in the Retry packets and the rejected tokens
+  RecRegisterRawStat(quic_rsb, RECT_PROCESS, "proxy.process.quic.retry_packets_sent", RECD_INT, RECP_PERSISTENT,
+                     static_cast<int>(QUICStats::retry_packets_sent_stat), RecRawStatSyncSum);
+  RecRegisterRawStat(quic_rsb, RECT_PROCESS, "proxy.process.quic.retry_tokens_accepted", RECD_INT, RECP_PERSISTENT,
+                     static_cast<int>(QUICStats::retry_tokens_accepted_stat), RecRawStatSyncSum);
+  RecRegisterRawStat(quic_rsb, RECT_PROCESS, "proxy.process.quic.retry_tokens_rejected", RECD_INT, RECP_PERSISTENT,
+                     static_cast<int>(QUICStats::retry_tokens_rejected_stat), RecRawStatSyncSum);
+  RecRegisterRawStat(quic_rsb, RECT_PROCESS, "proxy.process.quic.invalid_token_closes_suppressed", RECD_INT, RECP_PERSISTENT,
+                     static_cast<int>(QUICStats::invalid_token_closes_suppressed_stat), RecRawStatSyncSum);
   // RecRegisterRawStat(quic_rsb, RECT_PROCESS, "proxy.process.quic.total_packets_retransmitted", RECD_INT, RECP_PERSISTENT,
   //                              static_cast<int>(quic_total_packets_retransmitted_stat), RecRawStatSyncSum);
   // RecRegisterRawStat(quic_rsb, RECT_PROCESS, "proxy.process.quic.total_packets_received", RECD_INT, RECP_PERSISTENT,
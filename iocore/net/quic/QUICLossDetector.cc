@@ -217,10 +217,9 @@ QUICLossDetector::_on_ack_received(const QUICAckFrame &ack_frame, QUICPacketNumb
 
   // If the largest acknowledged is newly acked and
   //  ack-eliciting, update the RTT.
-  auto pi = this->_sent_packets[index].find(ack_frame.largest_acknowledged());
-  if (pi != this->_sent_packets[index].end() &&
-      (pi->second->ack_eliciting || this->_include_ack_eliciting(newly_acked_packets, index))) {
-    ink_hrtime latest_rtt = Thread::get_hrtime() - pi->second->time_sent;
+  QUICPacketInfo *pi = this->_sent_packets[index].find(ack_frame.largest_acknowledged());
+  if (pi != nullptr && (pi->ack_eliciting || this->_include_ack_eliciting(newly_acked_packets, index))) {
+    ink_hrtime latest_rtt = Thread::get_hrtime() - pi->time_sent;
     // _latest_rtt is nanosecond but ack_frame.ack_delay is microsecond and scaled
     ink_hrtime delay = HRTIME_USECONDS(ack_frame.ack_delay() << this->_ack_delay_exponent);
     this->_rtt_measure->update_rtt(latest_rtt, delay);
@@ -231,8 +230,8 @@ QUICLossDetector::_on_ack_received(const QUICAckFrame &ack_frame, QUICPacketNumb
 
   // if (ACK frame contains ECN information):
   //   ProcessECN(ack)
-  if (ack_frame.ecn_section() != nullptr && pi != this->_sent_packets[index].end()) {
-    this->_cc->process_ecn(*pi->second, ack_frame.ecn_section());
+  if (ack_frame.ecn_section() != nullptr && pi != nullptr) {
+    this->_cc->process_ecn(*pi, ack_frame.ecn_section());
   }
 
   // Find all newly acked packets.
@@ -380,9 +379,9 @@ QUICLossDetector::_on_loss_detection_timeout()
     for (auto i = 0; i < 3; i++) {
       for (auto &unacked : this->_sent_packets[i]) {
         QUICLDVDebug("[%s] #%" PRIu64 " is_crypto=%i ack_eliciting=%i size=%zu %u %u",
-                     QUICDebugNames::pn_space(static_cast<QUICPacketNumberSpace>(i)), unacked.first,
-                     unacked.second->is_crypto_packet, unacked.second->ack_eliciting, unacked.second->sent_bytes,
-                     this->_ack_eliciting_outstanding.load(), this->_crypto_outstanding.load());
+                     QUICDebugNames::pn_space(static_cast<QUICPacketNumberSpace>(i)), unacked.packet_number,
+                     unacked.is_crypto_packet, unacked.ack_eliciting, unacked.sent_bytes, this->_ack_eliciting_outstanding.load(),
+                     this->_crypto_outstanding.load());
       }
     }
   }
@@ -406,30 +405,30 @@ QUICLossDetector::_detect_lost_packets(QUICPacketNumberSpace pn_space)
   // Packets with packet numbers before this are deemed lost.
   QUICPacketNumber lost_pn = this->_largest_acked_packet[static_cast<int>(pn_space)] - this->_k_packet_threshold;
 
-  for (auto it = this->_sent_packets[static_cast<int>(pn_space)].begin();
-       it != this->_sent_packets[static_cast<int>(pn_space)].end(); ++it) {
-    if (it->first > this->_largest_acked_packet[static_cast<int>(pn_space)]) {
+  for (auto &info : this->_sent_packets[static_cast<int>(pn_space)]) {
+    if (info.packet_number > this->_largest_acked_packet[static_cast<int>(pn_space)]) {
       // the spec uses continue but we can break here because the _sent_packets is sorted by packet_number.
       break;
     }
 
-    auto &unacked = it->second;
+    QUICPacketInfo *unacked = &info;
 
     // Mark packet as lost, or set time when it should be marked.
     if (unacked->time_sent < lost_send_time || unacked->packet_number < lost_pn) {
       if (unacked->time_sent < lost_send_time) {
         QUICLDDebug("[%s] Lost: time since sent is too long (#%" PRId64 " sent=%" PRId64 ", delay=%" PRId64
                     ", fraction=%lf, lrtt=%" PRId64 ", srtt=%" PRId64 ")",
-                    QUICDebugNames::pn_space(pn_space), it->first, unacked->time_sent, lost_send_time, this->_k_time_threshold,
+                    QUICDebugNames::pn_space(pn_space), unacked->packet_number, unacked->time_sent, lost_send_time,
+                    this->_k_time_threshold,
                     this->_rtt_measure->latest_rtt(), this->_rtt_measure->smoothed_rtt());
       } else {
         QUICLDDebug("[%s] Lost: packet delta is too large (#%" PRId64 " largest=%" PRId64 " threshold=%" PRId32 ")",
-                    QUICDebugNames::pn_space(pn_space), it->first, this->_largest_acked_packet[static_cast<int>(pn_space)],
-                    this->_k_packet_threshold);
+                    QUICDebugNames::pn_space(pn_space), unacked->packet_number,
+                    this->_largest_acked_packet[static_cast<int>(pn_space)], this->_k_packet_threshold);
       }
 
       if (unacked->in_flight) {
-        lost_packets.insert({it->first, it->second.get()});
+        lost_packets.insert({unacked->packet_number, unacked});
       }
     } else if (this->_loss_time[static_cast<int>(pn_space)] == 0) {
       this->_loss_time[static_cast<int>(pn_space)] = unacked->time_sent + loss_delay;
@@ -468,10 +467,10 @@ QUICLossDetector::_retransmit_all_unacked_crypto_data()
     std::set<QUICPacketNumber> retransmitted_crypto_packets;
     std::map<QUICPacketNumber, QUICPacketInfo *> lost_packets;
     for (auto &info : this->_sent_packets[i]) {
-      if (info.second->is_crypto_packet) {
-        retransmitted_crypto_packets.insert(info.first);
-        this->_retransmit_lost_packet(*info.second);
-        lost_packets.insert({info.first, info.second.get()});
+      if (info.is_crypto_packet) {
+        retransmitted_crypto_packets.insert(info.packet_number);
+        this->_retransmit_lost_packet(info);
+        lost_packets.insert({info.packet_number, &info});
       }
     }
 
@@ -551,10 +550,18 @@ QUICLossDetector::_determine_newly_acked_packets(const QUICAckFrame &ack_frame,
     x -= block.length() + 1;
   }
 
+  // Look up each acked packet number rather than walk all the sent packets for each range. Only the
+  // ones still outstanding can be found, a range of a bogus frame that wrapped around has none.
+  const QUICSentPacketRing &sent = this->_sent_packets[pn_space];
   for (auto &&range : numbers) {
-    for (auto ite = this->_sent_packets[pn_space].rbegin(); ite != this->_sent_packets[pn_space].rend(); ite++) {
-      if (range.contains(ite->first)) {
-        packets.push_back(ite->second.get());
+    if (sent.size() == 0 || range.last() > range.first()) {
+      continue;
+    }
+    QUICPacketNumber lowest  = std::max(range.last(), sent.lowest());
+    QUICPacketNumber highest = std::min(range.first(), sent.highest());
+    for (QUICPacketNumber pn = highest + 1; pn > lowest; --pn) {
+      if (QUICPacketInfo *info = sent.find(pn - 1)) {
+        packets.push_back(info);
       }
     }
   }
@@ -567,21 +574,24 @@ QUICLossDetector::_add_to_sent_packet_list(QUICPacketNumber packet_number, QUICP
 {
   SCOPED_MUTEX_LOCK(lock, this->_loss_detection_mutex, this_ethread());
 
+  ink_assert(packet_number == packet_info->packet_number);
+  bool is_crypto_packet = packet_info->is_crypto_packet;
+  bool ack_eliciting    = packet_info->ack_eliciting;
+
   // Add to the list
   int index = static_cast<int>(packet_info->pn_space);
-  this->_sent_packets[index].insert(std::pair<QUICPacketNumber, QUICPacketInfoUPtr>(packet_number, std::move(packet_info)));
+  if (!this->_sent_packets[index].insert(std::move(packet_info))) {
+    return;
+  }
 
   // Increment counters
-  auto ite = this->_sent_packets[index].find(packet_number);
-  if (ite != this->_sent_packets[index].end()) {
-    if (ite->second->is_crypto_packet) {
-      ++this->_crypto_outstanding;
-      ink_assert(this->_crypto_outstanding.load() > 0);
-    }
-    if (ite->second->ack_eliciting) {
-      ++this->_ack_eliciting_outstanding;
-      ink_assert(this->_ack_eliciting_outstanding.load() > 0);
-    }
+  if (is_crypto_packet) {
+    ++this->_crypto_outstanding;
+    ink_assert(this->_crypto_outstanding.load() > 0);
+  }
+  if (ack_eliciting) {
+    ++this->_ack_eliciting_outstanding;
+    ink_assert(this->_ack_eliciting_outstanding.load() > 0);
   }
 }
 
@@ -590,35 +600,22 @@ QUICLossDetector::_remove_from_sent_packet_list(QUICPacketNumber packet_number,
 {
   SCOPED_MUTEX_LOCK(lock, this->_loss_detection_mutex, this_ethread());
 
-  auto ite = this->_sent_packets[static_cast<int>(pn_space)].find(packet_number);
-  this->_decrement_outstanding_counters(ite, pn_space);
-  this->_sent_packets[static_cast<int>(pn_space)].erase(packet_number);
-}
-
-std::map<QUICPacketNumber, QUICPacketInfoUPtr>::iterator
-QUICLossDetector::_remove_from_sent_packet_list(std::map<QUICPacketNumber, QUICPacketInfoUPtr>::iterator it,
-                                                QUICPacketNumberSpace pn_space)
-{
-  SCOPED_MUTEX_LOCK(lock, this->_loss_detection_mutex, this_ethread());
-
-  this->_decrement_outstanding_counters(it, pn_space);
-  return this->_sent_packets[static_cast<int>(pn_space)].erase(it);
+  QUICPacketInfoUPtr packet_info = this->_sent_packets[static_cast<int>(pn_space)].erase(packet_number);
+  if (packet_info) {
+    this->_decrement_outstanding_counters(*packet_info);
+  }
 }
 
 void
-QUICLossDetector::_decrement_outstanding_counters(std::map<QUICPacketNumber, QUICPacketInfoUPtr>::iterator it,
-                                                  QUICPacketNumberSpace pn_space)
-{
-  if (it != this->_sent_packets[static_cast<int>(pn_space)].end()) {
-    // Decrement counters
-    if (it->second->is_crypto_packet) {
-      ink_assert(this->_crypto_outstanding.load() > 0);
-      --this->_crypto_outstanding;
-    }
-    if (it->second->ack_eliciting) {
-      ink_assert(this->_ack_eliciting_outstanding.load() > 0);
-      --this->_ack_eliciting_outstanding;
-    }
+QUICLossDetector::_decrement_outstanding_counters(const QUICPacketInfo &packet_info)
+{
+  if (packet_info.is_crypto_packet) {
+    ink_assert(this->_crypto_outstanding.load() > 0);
+    --this->_crypto_outstanding;
+  }
+  if (packet_info.ack_eliciting) {
+    ink_assert(this->_ack_eliciting_outstanding.load() > 0);
+    --this->_ack_eliciting_outstanding;
   }
 }
 
@@ -766,3 +763,101 @@ QUICRTTMeasure::reset()
   this->_min_rtt      = 0;
   this->_latest_rtt   = 0;
 }
+
+//
+// QUICSentPacketRing
+//
+QUICSentPacketRing::const_iterator &
+QUICSentPacketRing::const_iterator::operator++()
+{
+  do {
+    ++this->_pn;
+  } while (this->_pn < this->_ring._end && !this->_ring._slot(this->_pn));
+  return *this;
+}
+
+QUICPacketInfo *
+QUICSentPacketRing::find(QUICPacketNumber packet_number) const
+{
+  if (this->_size == 0 || packet_number < this->_lowest || packet_number >= this->_end) {
+    return nullptr;
+  }
+  return this->_slot(packet_number).get();
+}
+
+bool
+QUICSentPacketRing::insert(QUICPacketInfoUPtr packet_info)
+{
+  QUICPacketNumber pn = packet_info->packet_number;
+
+  if (this->_size == 0) {
+    if (this->_slots.empty()) {
+      this->_slots.resize(INITIAL_SLOTS);
+    }
+    this->_lowest = pn;
+    this->_end    = pn + 1;
+  } else if (this->find(pn)) {
+    return false;
+  } else {
+    QUICPacketNumber lowest = std::min(this->_lowest, pn);
+    QUICPacketNumber end    = std::max(this->_end, pn + 1);
+    this->_reserve(lowest, end);
+    this->_lowest = lowest;
+    this->_end    = end;
+  }
+
+  this->_slot(pn) = std::move(packet_info);
+  ++this->_size;
+  return true;
+}
+
+QUICPacketInfoUPtr
+QUICSentPacketRing::erase(QUICPacketNumber packet_number)
+{
+  if (this->find(packet_number) == nullptr) {
+    return nullptr;
+  }
+
+  QUICPacketInfoUPtr packet_info = std::move(this->_slot(packet_number));
+  if (--this->_size > 0) {
+    // Keep both ends of the window on outstanding packets
+    while (!this->_slot(this->_lowest)) {
+      ++this->_lowest;
+    }
+    while (!this->_slot(this->_end - 1)) {
+      --this->_end;
+    }
+  }
+  return packet_info;
+}
+
+void
+QUICSentPacketRing::clear()
+{
+  for (auto &slot : this->_slots) {
+    slot.reset();
+  }
+  this->_lowest = 0;
+  this->_end    = 0;
+  this->_size   = 0;
+}
+
+void
+QUICSentPacketRing::_reserve(QUICPacketNumber lowest, QUICPacketNumber end)
+{
+  if (end - lowest <= this->_slots.size()) {
+    return;
+  }
+
+  size_t n = this->_slots.size();
+  while (n < end - lowest) {
+    n *= 2;
+  }
+  std::vector<QUICPacketInfoUPtr> slots(n);
+  for (QUICPacketNumber pn = this->_lowest; pn < this->_end; ++pn) {
+    if (QUICPacketInfoUPtr &slot = this->_slot(pn)) {
+      slots[pn & (n - 1)] = std::move(slot);
+    }
+  }
+  this->_slots.swap(slots);
+}
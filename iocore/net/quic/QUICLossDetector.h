@@ -23,9 +23,9 @@
 
 #pragma once
 
-// TODO Using STL Map because ts/Map lacks remove method
 #include <map>
 #include <set>
+#include <vector>
 
 #include "I_EventSystem.h"
 #include "I_Action.h"
@@ -46,6 +46,100 @@ class QUICRTTMeasure;
 
 using QUICPacketInfoUPtr = std::unique_ptr<QUICPacketInfo>;
 
+/**
+  The packets of a packet number space sent and neither acked nor lost yet, in slots indexed by
+  their packet number. Packet numbers only grow, so the outstanding ones stay within a window from
+  the lowest to the latest sent and no two of them share a slot while the ring is at least as large
+  as the window. It doubles when the window outgrows it and never shrinks, so being sent, acked or
+  lost costs a packet no allocation.
+ */
+class QUICSentPacketRing
+{
+public:
+  /// Ascending packet numbers, skipping the empty slots.
+  class const_iterator
+  {
+  public:
+    const_iterator(const QUICSentPacketRing &ring, QUICPacketNumber pn) : _ring(ring), _pn(pn) {}
+
+    QUICPacketInfo &
+    operator*() const
+    {
+      return *this->_ring._slot(this->_pn);
+    }
+
+    QUICPacketInfo *
+    operator->() const
+    {
+      return this->_ring._slot(this->_pn).get();
+    }
+
+    const_iterator &operator++();
+
+    bool
+    operator!=(const const_iterator &b) const
+    {
+      return this->_pn != b._pn;
+    }
+
+  private:
+    const QUICSentPacketRing &_ring;
+    QUICPacketNumber _pn;
+  };
+
+  QUICPacketInfo *find(QUICPacketNumber packet_number) const;
+  /// Returns false, dropping @a packet_info, if its packet number is there already.
+  bool insert(QUICPacketInfoUPtr packet_info);
+  QUICPacketInfoUPtr erase(QUICPacketNumber packet_number);
+  void clear();
+
+  size_t
+  size() const
+  {
+    return this->_size;
+  }
+
+  /// The lowest and the highest outstanding packet numbers, when there are any.
+  QUICPacketNumber
+  lowest() const
+  {
+    return this->_lowest;
+  }
+
+  QUICPacketNumber
+  highest() const
+  {
+    return this->_end - 1;
+  }
+
+  const_iterator
+  begin() const
+  {
+    return {*this, this->_size ? this->_lowest : this->_end};
+  }
+
+  const_iterator
+  end() const
+  {
+    return {*this, this->_end};
+  }
+
+private:
+  static constexpr size_t INITIAL_SLOTS = 64;
+
+  QUICPacketInfoUPtr &
+  _slot(QUICPacketNumber pn) const
+  {
+    return const_cast<QUICPacketInfoUPtr &>(this->_slots[pn & (this->_slots.size() - 1)]);
+  }
+  void _reserve(QUICPacketNumber lowest, QUICPacketNumber end);
+
+  std::vector<QUICPacketInfoUPtr> _slots; ///< A power of two of them
+  QUICPacketNumber _lowest = 0;           ///< The lowest outstanding packet number, its slot is never empty
+  QUICPacketNumber _end    = 0;           ///< One past the highest, whose slot is never empty either
+  size_t _size             = 0;
+};
+
 class QUICRTTProvider
 {
 public:
@@ -74,12 +168,20 @@ public:
   uint32_t bytes_in_flight() const override;
   uint32_t congestion_window() const override;
   uint32_t current_ssthresh() const override;
+  uint64_t pacing_rate() const override;
 
   void add_extra_credit() override;
 
-private:
+protected:
   Ptr<ProxyMutex> _cc_mutex;
 
+  /// Grow the window for @a acked_packet after slow start. Called with the lock held.
+  virtual void _congestion_avoidance(const QUICPacketInfo &acked_packet);
+  /// Shrink the window at the start of a congestion event, ssthresh follows the result.
+  virtual void _reduce_congestion_window();
+  /// Report cwnd and the pacing rate to qlog.
+  void _metrics_updated();
+
   void _congestion_event(ink_hrtime sent_time);
   bool _in_persistent_congestion(const std::map<QUICPacketNumber, QUICPacketInfo *> &lost_packets,
                                  QUICPacketInfo *largest_lost_packet);
@@ -141,7 +243,7 @@ private:
   ink_hrtime _time_of_last_sent_crypto_packet                = 0;
   ink_hrtime _loss_time[kPacketNumberSpace]                  = {0};
   QUICPacketNumber _largest_acked_packet[kPacketNumberSpace] = {0};
-  std::map<QUICPacketNumber, QUICPacketInfoUPtr> _sent_packets[kPacketNumberSpace];
+  QUICSentPacketRing _sent_packets[kPacketNumberSpace];
 
   // These are not defined on the spec but expected to be count
   // These counter have to be updated when inserting / erasing packets from _sent_packets with following functions.
@@ -149,9 +251,7 @@ private:
   std::atomic<uint32_t> _ack_eliciting_outstanding;
   void _add_to_sent_packet_list(QUICPacketNumber packet_number, std::unique_ptr<QUICPacketInfo> packet_info);
   void _remove_from_sent_packet_list(QUICPacketNumber packet_number, QUICPacketNumberSpace pn_space);
-  std::map<QUICPacketNumber, QUICPacketInfoUPtr>::iterator _remove_from_sent_packet_list(
-    std::map<QUICPacketNumber, QUICPacketInfoUPtr>::iterator it, QUICPacketNumberSpace pn_space);
-  void _decrement_outstanding_counters(std::map<QUICPacketNumber, QUICPacketInfoUPtr>::iterator it, QUICPacketNumberSpace pn_space);
+  void _decrement_outstanding_counters(const QUICPacketInfo &packet_info);
 
   /*
    * Because this alarm will be reset on every packet transmission, to reduce number of events,
@@ -101,11 +101,31 @@ QUICNewRenoCongestionController::on_packet_acked(const QUICPacketInfo &acked_pac
     // Congestion avoidance.
     this->_context.trigger(QUICContext::CallbackEvent::CONGESTION_STATE_CHANGED,
                            QUICCongestionController::State::CONGESTION_AVOIDANCE);
-    this->_congestion_window += this->_k_max_datagram_size * acked_packet.sent_bytes / this->_congestion_window;
+    this->_congestion_avoidance(acked_packet);
     QUICCCDebug("Congestion avoidance window changed");
   }
 }
 
+void
+QUICNewRenoCongestionController::_congestion_avoidance(const QUICPacketInfo &acked_packet)
+{
+  this->_congestion_window += this->_k_max_datagram_size * acked_packet.sent_bytes / this->_congestion_window;
+}
+
+void
+QUICNewRenoCongestionController::_reduce_congestion_window()
+{
+  this->_congestion_window *= this->_k_loss_reduction_factor;
+  this->_congestion_window = std::max(this->_congestion_window, this->_k_minimum_window);
+}
+
+void
+QUICNewRenoCongestionController::_metrics_updated()
+{
+  this->_context.trigger(QUICContext::CallbackEvent::METRICS_UPDATE, this->_congestion_window, this->_bytes_in_flight,
+                         this->_ssthresh, this->pacing_rate());
+}
+
 // addtional code
 // the original one is:
 //   CongestionEvent(sent_time):
@@ -116,12 +136,10 @@ QUICNewRenoCongestionController::_congestion_event(ink_hrtime sent_time)
   // start of the previous congestion recovery period.
   if (!this->_in_congestion_recovery(sent_time)) {
     this->_congestion_recovery_start_time = Thread::get_hrtime();
-    this->_congestion_window *= this->_k_loss_reduction_factor;
-    this->_congestion_window = std::max(this->_congestion_window, this->_k_minimum_window);
-    this->_ssthresh          = this->_congestion_window;
+    this->_reduce_congestion_window();
+    this->_ssthresh = this->_congestion_window;
     this->_context.trigger(QUICContext::CallbackEvent::CONGESTION_STATE_CHANGED, QUICCongestionController::State::RECOVERY);
-    this->_context.trigger(QUICContext::CallbackEvent::METRICS_UPDATE, this->_congestion_window, this->_bytes_in_flight,
-                           this->_ssthresh);
+    this->_metrics_updated();
   }
 }
 
@@ -220,6 +238,18 @@ QUICNewRenoCongestionController::current_ssthresh() const
   return this->_ssthresh;
 }
 
+// Pace at 1.25 times cwnd per smoothed RTT, as the recovery draft suggests, so ACK clocking and not the pacer limits the
+// window.
+uint64_t
+QUICNewRenoCongestionController::pacing_rate() const
+{
+  ink_hrtime srtt = this->_context.rtt_provider()->smoothed_rtt();
+  if (srtt <= 0) {
+    return 0;
+  }
+  return static_cast<uint64_t>(this->_congestion_window) * 5 / 4 * HRTIME_SECOND / srtt;
+}
+
 // [draft-17 recovery] 7.9.3.  Initialization
 void
 QUICNewRenoCongestionController::reset()
@@ -0,0 +1,62 @@
+/** @file
+ *
+ *  Spreading datagrams over time at the congestion controller's pacing rate
+ *
+ *  @section license License
+ *
+ *  Licensed to the Apache Software Foundation (ASF) under one
+ *  or more contributor license agreements.  See the NOTICE file
+ *  distributed with this work for additional information
+ *  regarding copyright ownership.  The ASF licenses this file
+ *  to you under the Apache License, Version 2.0 (the
+ *  "License"); you may not use this file except in compliance
+ *  with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include <algorithm>
+
+#include "tscore/ink_hrtime.h"
+
+/**
+   Works out when each datagram of a connection should leave so that a window is sent over an RTT
+   instead of as one burst. The times go into @c UDPPacket delivery times, @c UDPQueue holds the
+   packets until then or hands the time to the kernel (SO_TXTIME).
+
+   Time not used while idle or application limited turns into credit of at most @a burst bytes,
+   which can go out back to back.
+ */
+class QUICPacer
+{
+public:
+  QUICPacer(uint32_t burst) : _burst(burst) {}
+
+  /// When a datagram handed over at @a now should leave.
+  ink_hrtime
+  send_time(ink_hrtime now) const
+  {
+    return std::max(now, this->_next);
+  }
+
+  /// Account for @a bytes handed over at @a now, at @a rate bytes per second. A zero rate turns pacing off.
+  void on_sent(ink_hrtime now, size_t bytes, uint64_t rate);
+
+  void
+  reset()
+  {
+    this->_next = 0;
+  }
+
+private:
+  uint32_t _burst;
+  ink_hrtime _next = 0;
+};
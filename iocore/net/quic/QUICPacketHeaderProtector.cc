@@ -28,54 +28,80 @@
 
 #include "tscore/Diags.h"
 
-bool
-QUICPacketHeaderProtector::protect(uint8_t *unprotected_packet, size_t unprotected_packet_len, int dcil) const
+QUICPacketHeaderProtector::~QUICPacketHeaderProtector()
 {
-  // Do nothing if the packet is VN
-  QUICPacketType type;
-  QUICPacketR::type(type, unprotected_packet, unprotected_packet_len);
-  if (type == QUICPacketType::VERSION_NEGOTIATION) {
-    return true;
+  for (auto &c : this->_encryption_ctx) {
+    EVP_CIPHER_CTX_free(c.ctx);
   }
-
-  QUICKeyPhase phase;
-  if (QUICInvariants::is_long_header(unprotected_packet)) {
-    QUICLongHeaderPacketR::key_phase(phase, unprotected_packet, unprotected_packet_len);
-  } else {
-    // This is a kind of hack. For short header we need to use the same key for header protection regardless of the key phase.
-    phase = QUICKeyPhase::PHASE_0;
-    type  = QUICPacketType::PROTECTED;
+  for (auto &c : this->_decryption_ctx) {
+    EVP_CIPHER_CTX_free(c.ctx);
   }
+}
 
-  Debug("v_quic_pne", "Protecting a packet number of %s packet using %s", QUICDebugNames::packet_type(type),
-        QUICDebugNames::key_phase(phase));
+bool
+QUICPacketHeaderProtector::protect(uint8_t *unprotected_packet, size_t unprotected_packet_len, int dcil) const
+{
+  return this->protect(&unprotected_packet, &unprotected_packet_len, 1, dcil);
+}
 
-  const EVP_CIPHER *aead = this->_pp_key_info.get_cipher_for_hp(phase);
-  if (!aead) {
-    Debug("quic_pne", "Failed to encrypt a packet number: keys for %s is not ready", QUICDebugNames::key_phase(phase));
-    return false;
-  }
+bool
+QUICPacketHeaderProtector::protect(uint8_t *const *unprotected_packets, const size_t *unprotected_packet_lens, size_t n,
+                                   int dcil) const
+{
+  uint8_t samples[MAX_BATCH * SAMPLE_LEN];
+  uint8_t masks[MAX_BATCH * SAMPLE_LEN];
+  size_t batch[MAX_BATCH];
+
+  size_t i = 0;
+  while (i < n) {
+    QUICKeyPhase phase;
+    if (!this->_key_phase(phase, unprotected_packets[i], unprotected_packet_lens[i], false)) {
+      ++i;
+      continue;
+    }
 
-  const uint8_t *key = this->_pp_key_info.encryption_key_for_hp(phase);
-  if (!key) {
-    Debug("quic_pne", "Failed to encrypt a packet number: keys for %s is not ready", QUICDebugNames::key_phase(phase));
-    return false;
-  }
+    const EVP_CIPHER *aead = this->_pp_key_info.get_cipher_for_hp(phase);
+    if (!aead) {
+      Debug("quic_pne", "Failed to encrypt a packet number: keys for %s is not ready", QUICDebugNames::key_phase(phase));
+      return false;
+    }
 
-  uint8_t sample_offset;
-  if (!this->_calc_sample_offset(&sample_offset, unprotected_packet, unprotected_packet_len, dcil)) {
-    Debug("v_quic_pne", "Failed to calculate a sample offset");
-    return false;
-  }
+    const uint8_t *key = this->_pp_key_info.encryption_key_for_hp(phase);
+    if (!key) {
+      Debug("quic_pne", "Failed to encrypt a packet number: keys for %s is not ready", QUICDebugNames::key_phase(phase));
+      return false;
+    }
 
-  uint8_t mask[EVP_MAX_BLOCK_LENGTH];
-  if (!this->_generate_mask(mask, unprotected_packet + sample_offset, key, aead)) {
-    Debug("v_quic_pne", "Failed to generate a mask");
-    return false;
-  }
+    // Gather the samples of the packets that follow and use the same key
+    size_t batch_len = 0;
+    for (; i < n && batch_len < MAX_BATCH; ++i) {
+      QUICKeyPhase packet_phase;
+      if (!this->_key_phase(packet_phase, unprotected_packets[i], unprotected_packet_lens[i], false)) {
+        continue;
+      }
+      if (packet_phase != phase) {
+        break;
+      }
+
+      uint8_t sample_offset;
+      if (!this->_calc_sample_offset(&sample_offset, unprotected_packets[i], unprotected_packet_lens[i], dcil)) {
+        Debug("v_quic_pne", "Failed to calculate a sample offset");
+        return false;
+      }
+      memcpy(samples + batch_len * SAMPLE_LEN, unprotected_packets[i] + sample_offset, SAMPLE_LEN);
+      batch[batch_len++] = i;
+    }
 
-  if (!this->_protect(unprotected_packet, unprotected_packet_len, mask, dcil)) {
-    Debug("quic_pne", "Failed to encrypt a packet number");
+    if (!this->_generate_masks(masks, samples, batch_len, key, aead, this->_encryption_ctx[static_cast<int>(phase)])) {
+      Debug("v_quic_pne", "Failed to generate a mask");
+      return false;
+    }
+
+    for (size_t j = 0; j < batch_len; ++j) {
+      if (!this->_protect(unprotected_packets[batch[j]], unprotected_packet_lens[batch[j]], masks + j * SAMPLE_LEN, dcil)) {
+        Debug("quic_pne", "Failed to encrypt a packet number");
+      }
+    }
   }
 
   return true;
@@ -84,25 +110,11 @@ QUICPacketHeaderProtector::protect(uint8_t *unprotected_packet, size_t unprotect
 bool
 QUICPacketHeaderProtector::unprotect(uint8_t *protected_packet, size_t protected_packet_len) const
 {
-  // Do nothing if the packet is VN or RETRY
-  QUICPacketType type;
-  QUICPacketR::type(type, protected_packet, protected_packet_len);
-  if (type == QUICPacketType::VERSION_NEGOTIATION || type == QUICPacketType::RETRY) {
-    return true;
-  }
-
   QUICKeyPhase phase;
-  if (QUICInvariants::is_long_header(protected_packet)) {
-    QUICLongHeaderPacketR::key_phase(phase, protected_packet, protected_packet_len);
-  } else {
-    // This is a kind of hack. For short header we need to use the same key for header protection regardless of the key phase.
-    phase = QUICKeyPhase::PHASE_0;
-    type  = QUICPacketType::PROTECTED;
+  if (!this->_key_phase(phase, protected_packet, protected_packet_len, true)) {
+    return true;
   }
 
-  Debug("v_quic_pne", "Unprotecting a packet number of %s packet using %s", QUICDebugNames::packet_type(type),
-        QUICDebugNames::key_phase(phase));
-
   const EVP_CIPHER *aead = this->_pp_key_info.get_cipher_for_hp(phase);
   if (!aead) {
     Debug("quic_pne", "Failed to decrypt a packet number: keys for %s is not ready", QUICDebugNames::key_phase(phase));
@@ -121,8 +133,9 @@ QUICPacketHeaderProtector::unprotect(uint8_t *protected_packet, size_t protected
     return false;
   }
 
-  uint8_t mask[EVP_MAX_BLOCK_LENGTH];
-  if (!this->_generate_mask(mask, protected_packet + sample_offset, key, aead)) {
+  uint8_t mask[SAMPLE_LEN];
+  if (!this->_generate_masks(mask, protected_packet + sample_offset, 1, key, aead,
+                             this->_decryption_ctx[static_cast<int>(phase)])) {
     Debug("v_quic_pne", "Failed to generate a mask");
     return false;
   }
@@ -134,6 +147,31 @@ QUICPacketHeaderProtector::unprotect(uint8_t *protected_packet, size_t protected
   return true;
 }
 
+// False if the header of the packet is not protected at all.
+bool
+QUICPacketHeaderProtector::_key_phase(QUICKeyPhase &phase, const uint8_t *packet, size_t packet_len, bool unprotect) const
+{
+  // Do nothing if the packet is VN, or RETRY that is only ever received
+  QUICPacketType type;
+  QUICPacketR::type(type, packet, packet_len);
+  if (type == QUICPacketType::VERSION_NEGOTIATION || (unprotect && type == QUICPacketType::RETRY)) {
+    return false;
+  }
+
+  if (QUICInvariants::is_long_header(packet)) {
+    QUICLongHeaderPacketR::key_phase(phase, packet, packet_len);
+  } else {
+    // This is a kind of hack. For short header we need to use the same key for header protection regardless of the key phase.
+    phase = QUICKeyPhase::PHASE_0;
+    type  = QUICPacketType::PROTECTED;
+  }
+
+  Debug("v_quic_pne", "%s a packet number of %s packet using %s", unprotect ? "Unprotecting" : "Protecting",
+        QUICDebugNames::packet_type(type), QUICDebugNames::key_phase(phase));
+
+  return true;
+}
+
 bool
 QUICPacketHeaderProtector::_calc_sample_offset(uint8_t *sample_offset, const uint8_t *protected_packet, size_t protected_packet_len,
                                                int dcil) const
@@ -31,17 +31,45 @@ class QUICPacketProtectionKeyInfo;
 class QUICPacketHeaderProtector
 {
 public:
+  /// Packets whose masks are generated together, as many as one GSO send takes.
+  static constexpr size_t MAX_BATCH = 64;
+
   QUICPacketHeaderProtector(const QUICPacketProtectionKeyInfo &pp_key_info) : _pp_key_info(pp_key_info) {}
+  ~QUICPacketHeaderProtector();
+  QUICPacketHeaderProtector(const QUICPacketHeaderProtector &) = delete;
+  QUICPacketHeaderProtector &operator=(const QUICPacketHeaderProtector &) = delete;
 
   bool unprotect(uint8_t *protected_packet, size_t protected_packet_len) const;
   bool protect(uint8_t *unprotected_packet, size_t unprotected_packet_len, int dcil) const;
 
+  /**
+     Protects @a n packets with payloads already protected, such as a train about to be sent. The masks of the packets
+     that use the same key are generated in one pass, with AES all the samples go through the cipher in a single call.
+   */
+  bool protect(uint8_t *const *unprotected_packets, const size_t *unprotected_packet_lens, size_t n, int dcil) const;
+
 private:
+  static constexpr size_t SAMPLE_LEN = 16;
+
+  /// A cipher context with the header protection key already set up.
+  struct CipherContext {
+    EVP_CIPHER_CTX *ctx      = nullptr;
+    const EVP_CIPHER *cipher = nullptr; ///< nullptr until the key is set up
+    uint8_t key[EVP_MAX_KEY_LENGTH];
+  };
+
   const QUICPacketProtectionKeyInfo &_pp_key_info;
 
+  // For each key phase, kept while the key of the phase stays the same
+  mutable CipherContext _encryption_ctx[5];
+  mutable CipherContext _decryption_ctx[5];
+
+  bool _key_phase(QUICKeyPhase &phase, const uint8_t *packet, size_t packet_len, bool unprotect) const;
   bool _calc_sample_offset(uint8_t *sample_offset, const uint8_t *protected_packet, size_t protected_packet_len, int dcil) const;
 
-  bool _generate_mask(uint8_t *mask, const uint8_t *sample, const uint8_t *key, const EVP_CIPHER *cipher) const;
+  /// Generates a mask for each of the @a n samples, @c SAMPLE_LEN bytes apart in both @a samples and @a masks.
+  bool _generate_masks(uint8_t *masks, const uint8_t *samples, size_t n, const uint8_t *key, const EVP_CIPHER *cipher,
+                       CipherContext &ctx) const;
 
   bool _unprotect(uint8_t *packet, size_t packet_len, const uint8_t *mask) const;
   bool _protect(uint8_t *packet, size_t packet_len, const uint8_t *mask, int dcil) const;
@@ -25,8 +25,8 @@
 
 #include "openssl/chacha.h"
 
-bool
-QUICPacketHeaderProtector::_generate_mask(uint8_t *mask, const uint8_t *sample, const uint8_t *key, const EVP_CIPHER *cipher) const
+static bool
+generate_mask(uint8_t *mask, const uint8_t *sample, const uint8_t *key, const EVP_CIPHER *cipher)
 {
   static constexpr unsigned char FIVE_ZEROS[] = {0x00, 0x00, 0x00, 0x00, 0x00};
 
@@ -56,3 +56,18 @@ QUICPacketHeaderProtector::_generate_mask(uint8_t *mask, const uint8_t *sample,
 
   return true;
 }
+
+bool
+QUICPacketHeaderProtector::_generate_masks(uint8_t *masks, const uint8_t *samples, size_t n, const uint8_t *key,
+                                           const EVP_CIPHER *cipher, CipherContext & /* c ATS_UNUSED */) const
+{
+  for (size_t i = 0; i < n; ++i) {
+    uint8_t mask[EVP_MAX_BLOCK_LENGTH];
+    if (!generate_mask(mask, samples + i * SAMPLE_LEN, key, cipher)) {
+      return false;
+    }
+    memcpy(masks + i * SAMPLE_LEN, mask, SAMPLE_LEN);
+  }
+
+  return true;
+}
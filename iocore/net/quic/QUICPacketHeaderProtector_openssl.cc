@@ -24,37 +24,43 @@
 #include "QUICPacketHeaderProtector.h"
 
 bool
-QUICPacketHeaderProtector::_generate_mask(uint8_t *mask, const uint8_t *sample, const uint8_t *key, const EVP_CIPHER *cipher) const
+QUICPacketHeaderProtector::_generate_masks(uint8_t *masks, const uint8_t *samples, size_t n, const uint8_t *key,
+                                           const EVP_CIPHER *cipher, CipherContext &c) const
 {
   static constexpr unsigned char FIVE_ZEROS[] = {0x00, 0x00, 0x00, 0x00, 0x00};
-  EVP_CIPHER_CTX *ctx                         = EVP_CIPHER_CTX_new();
 
-  if (!ctx) {
-    return false;
-  }
-  if (!EVP_EncryptInit_ex(ctx, cipher, nullptr, key, sample)) {
-    EVP_CIPHER_CTX_free(ctx);
-    return false;
+  size_t key_len = EVP_CIPHER_key_length(cipher);
+  if (c.cipher != cipher || memcmp(c.key, key, key_len) != 0) {
+    c.cipher = nullptr;
+    if (!c.ctx && !(c.ctx = EVP_CIPHER_CTX_new())) {
+      return false;
+    }
+    if (!EVP_EncryptInit_ex(c.ctx, cipher, nullptr, key, nullptr)) {
+      return false;
+    }
+    // Masks are taken a block at a time without ever finishing the context
+    EVP_CIPHER_CTX_set_padding(c.ctx, 0);
+    c.cipher = cipher;
+    memcpy(c.key, key, key_len);
   }
 
   int len = 0;
   if (cipher == EVP_chacha20()) {
-    if (!EVP_EncryptUpdate(ctx, mask, &len, FIVE_ZEROS, sizeof(FIVE_ZEROS))) {
-      EVP_CIPHER_CTX_free(ctx);
-      return false;
+    // The sample is the counter and nonce, a mask per sample
+    for (size_t i = 0; i < n; ++i) {
+      if (!EVP_EncryptInit_ex(c.ctx, nullptr, nullptr, nullptr, samples + i * SAMPLE_LEN) ||
+          !EVP_EncryptUpdate(c.ctx, masks + i * SAMPLE_LEN, &len, FIVE_ZEROS, sizeof(FIVE_ZEROS))) {
+        c.cipher = nullptr;
+        return false;
+      }
     }
   } else {
-    if (!EVP_EncryptUpdate(ctx, mask, &len, sample, 16)) {
-      EVP_CIPHER_CTX_free(ctx);
+    // ECB encrypts each sample on its own, in one call AES-NI works on several of them at once
+    if (!EVP_EncryptUpdate(c.ctx, masks, &len, samples, n * SAMPLE_LEN)) {
+      c.cipher = nullptr;
       return false;
     }
   }
-  if (!EVP_EncryptFinal_ex(ctx, mask + len, &len)) {
-    EVP_CIPHER_CTX_free(ctx);
-    return false;
-  }
-
-  EVP_CIPHER_CTX_free(ctx);
 
   return true;
 }
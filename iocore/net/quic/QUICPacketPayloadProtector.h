@@ -33,6 +33,9 @@ class QUICPacketPayloadProtector
 {
 public:
   QUICPacketPayloadProtector(const QUICPacketProtectionKeyInfo &pp_key_info) : _pp_key_info(pp_key_info) {}
+  ~QUICPacketPayloadProtector();
+  QUICPacketPayloadProtector(const QUICPacketPayloadProtector &) = delete;
+  QUICPacketPayloadProtector &operator=(const QUICPacketPayloadProtector &) = delete;
 
   Ptr<IOBufferBlock> protect(const Ptr<IOBufferBlock> protected_payload, const Ptr<IOBufferBlock> unprotected_payload,
                              uint64_t pkt_num, QUICKeyPhase phase) const;
@@ -40,14 +43,26 @@ public:
                                uint64_t pkt_num, QUICKeyPhase phase) const;
 
 private:
+  /// A cipher context with the key already set up, only the nonce changes from one packet to the next.
+  struct CipherContext {
+    EVP_CIPHER_CTX *ctx      = nullptr;
+    const EVP_CIPHER *cipher = nullptr; ///< nullptr until the key is set up
+    size_t iv_len            = 0;
+    uint8_t key[EVP_MAX_KEY_LENGTH];
+  };
+
   const QUICPacketProtectionKeyInfo &_pp_key_info;
 
+  // For each key phase, kept while the keys of the phase stay the same
+  mutable CipherContext _encryption_ctx[5];
+  mutable CipherContext _decryption_ctx[5];
+
   bool _unprotect(uint8_t *plain, size_t &plain_len, size_t max_plain_len, const uint8_t *protected_payload,
                   size_t protected_payload_len, uint64_t pkt_num, const uint8_t *ad, size_t ad_len, const uint8_t *key,
-                  const uint8_t *iv, size_t iv_len, const EVP_CIPHER *cipher, size_t tag_len) const;
+                  const uint8_t *iv, size_t iv_len, const EVP_CIPHER *cipher, size_t tag_len, CipherContext &ctx) const;
   bool _protect(uint8_t *protected_payload, size_t &protected_payload_len, size_t max_protected_payload_len,
                 const Ptr<IOBufferBlock> plain, uint64_t pkt_num, const uint8_t *ad, size_t ad_len, const uint8_t *key,
-                const uint8_t *iv, size_t iv_len, const EVP_CIPHER *cipher, size_t tag_len) const;
+                const uint8_t *iv, size_t iv_len, const EVP_CIPHER *cipher, size_t tag_len, CipherContext &ctx) const;
 
   void _gen_nonce(uint8_t *nonce, size_t &nonce_len, uint64_t pkt_num, const uint8_t *iv, size_t iv_len) const;
 };
@@ -30,7 +30,8 @@ static constexpr char tag[] = "quic_ppp";
 bool
 QUICPacketPayloadProtector::_protect(uint8_t *cipher, size_t &cipher_len, size_t max_cipher_len, const Ptr<IOBufferBlock> plain,
                                      uint64_t pkt_num, const uint8_t *ad, size_t ad_len, const uint8_t *key, const uint8_t *iv,
-                                     size_t iv_len, const EVP_CIPHER *aead, size_t tag_len) const
+                                     size_t iv_len, const EVP_CIPHER *aead, size_t tag_len,
+                                     CipherContext & /* c ATS_UNUSED */) const
 {
   EVP_CIPHER_CTX *aead_ctx;
   int len;
@@ -84,7 +85,8 @@ QUICPacketPayloadProtector::_protect(uint8_t *cipher, size_t &cipher_len, size_t
 bool
 QUICPacketPayloadProtector::_unprotect(uint8_t *plain, size_t &plain_len, size_t max_plain_len, const uint8_t *cipher,
                                        size_t cipher_len, uint64_t pkt_num, const uint8_t *ad, size_t ad_len, const uint8_t *key,
-                                       const uint8_t *iv, size_t iv_len, const EVP_CIPHER *aead, size_t tag_len) const
+                                       const uint8_t *iv, size_t iv_len, const EVP_CIPHER *aead, size_t tag_len,
+                                       CipherContext & /* c ATS_UNUSED */) const
 {
   EVP_CIPHER_CTX *aead_ctx;
   int len;
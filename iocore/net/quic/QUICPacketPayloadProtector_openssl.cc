@@ -27,35 +27,58 @@
 
 static constexpr char tag[] = "quic_ppp";
 
+// Sets up @a ctx for @a aead and @a key unless it already is, the nonce is left for each packet to set.
+static bool
+warm_up(EVP_CIPHER_CTX *&ctx, const EVP_CIPHER *&cached_cipher, size_t &cached_iv_len, uint8_t *cached_key, const EVP_CIPHER *aead,
+        const uint8_t *key, size_t iv_len, bool encrypt)
+{
+  size_t key_len = EVP_CIPHER_key_length(aead);
+  if (cached_cipher == aead && cached_iv_len == iv_len && memcmp(cached_key, key, key_len) == 0) {
+    return true;
+  }
+
+  cached_cipher = nullptr;
+  if (!ctx && !(ctx = EVP_CIPHER_CTX_new())) {
+    return false;
+  }
+  if (!EVP_CipherInit_ex(ctx, aead, nullptr, nullptr, nullptr, encrypt)) {
+    return false;
+  }
+  if (!EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_AEAD_SET_IVLEN, iv_len, nullptr)) {
+    return false;
+  }
+  if (!EVP_CipherInit_ex(ctx, nullptr, nullptr, key, nullptr, encrypt)) {
+    return false;
+  }
+
+  cached_cipher = aead;
+  cached_iv_len = iv_len;
+  memcpy(cached_key, key, key_len);
+  return true;
+}
+
 bool
 QUICPacketPayloadProtector::_protect(uint8_t *cipher, size_t &cipher_len, size_t max_cipher_len, const Ptr<IOBufferBlock> plain,
                                      uint64_t pkt_num, const uint8_t *ad, size_t ad_len, const uint8_t *key, const uint8_t *iv,
-                                     size_t iv_len, const EVP_CIPHER *aead, size_t tag_len) const
+                                     size_t iv_len, const EVP_CIPHER *aead, size_t tag_len, CipherContext &c) const
 {
-  EVP_CIPHER_CTX *aead_ctx;
   int len;
   uint8_t nonce[EVP_MAX_IV_LENGTH] = {0};
   size_t nonce_len                 = 0;
 
   this->_gen_nonce(nonce, nonce_len, pkt_num, iv, iv_len);
 
-  if (!(aead_ctx = EVP_CIPHER_CTX_new())) {
-    return false;
-  }
-  if (!EVP_EncryptInit_ex(aead_ctx, aead, nullptr, nullptr, nullptr)) {
-    EVP_CIPHER_CTX_free(aead_ctx);
-    return false;
-  }
-  if (!EVP_CIPHER_CTX_ctrl(aead_ctx, EVP_CTRL_AEAD_SET_IVLEN, nonce_len, nullptr)) {
-    EVP_CIPHER_CTX_free(aead_ctx);
+  if (!warm_up(c.ctx, c.cipher, c.iv_len, c.key, aead, key, nonce_len, true)) {
     return false;
   }
-  if (!EVP_EncryptInit_ex(aead_ctx, nullptr, nullptr, key, nonce)) {
-    EVP_CIPHER_CTX_free(aead_ctx);
+  EVP_CIPHER_CTX *aead_ctx = c.ctx;
+
+  // A failure leaves the context in an unknown state, set it up again for the next packet
+  c.cipher = nullptr;
+  if (!EVP_EncryptInit_ex(aead_ctx, nullptr, nullptr, nullptr, nonce)) {
     return false;
   }
   if (!EVP_EncryptUpdate(aead_ctx, nullptr, &len, ad, ad_len)) {
-    EVP_CIPHER_CTX_free(aead_ctx);
     return false;
   }
 
@@ -63,7 +86,6 @@ QUICPacketPayloadProtector::_protect(uint8_t *cipher, size_t &cipher_len, size_t
   Ptr<IOBufferBlock> b = plain;
   while (b) {
     if (!EVP_EncryptUpdate(aead_ctx, cipher + cipher_len, &len, reinterpret_cast<unsigned char *>(b->buf()), b->size())) {
-      EVP_CIPHER_CTX_free(aead_ctx);
       return false;
     }
     cipher_len += len;
@@ -71,22 +93,18 @@ QUICPacketPayloadProtector::_protect(uint8_t *cipher, size_t &cipher_len, size_t
   }
 
   if (!EVP_EncryptFinal_ex(aead_ctx, cipher + cipher_len, &len)) {
-    EVP_CIPHER_CTX_free(aead_ctx);
     return false;
   }
   cipher_len += len;
 
   if (max_cipher_len < cipher_len + tag_len) {
-    EVP_CIPHER_CTX_free(aead_ctx);
     return false;
   }
   if (!EVP_CIPHER_CTX_ctrl(aead_ctx, EVP_CTRL_AEAD_GET_TAG, tag_len, cipher + cipher_len)) {
-    EVP_CIPHER_CTX_free(aead_ctx);
     return false;
   }
   cipher_len += tag_len;
-
-  EVP_CIPHER_CTX_free(aead_ctx);
+  c.cipher = aead;
 
   return true;
 }
@@ -94,54 +112,44 @@ QUICPacketPayloadProtector::_protect(uint8_t *cipher, size_t &cipher_len, size_t
 bool
 QUICPacketPayloadProtector::_unprotect(uint8_t *plain, size_t &plain_len, size_t max_plain_len, const uint8_t *cipher,
                                        size_t cipher_len, uint64_t pkt_num, const uint8_t *ad, size_t ad_len, const uint8_t *key,
-                                       const uint8_t *iv, size_t iv_len, const EVP_CIPHER *aead, size_t tag_len) const
+                                       const uint8_t *iv, size_t iv_len, const EVP_CIPHER *aead, size_t tag_len,
+                                       CipherContext &c) const
 {
-  EVP_CIPHER_CTX *aead_ctx;
   int len;
   uint8_t nonce[EVP_MAX_IV_LENGTH] = {0};
   size_t nonce_len                 = 0;
 
   this->_gen_nonce(nonce, nonce_len, pkt_num, iv, iv_len);
 
-  if (!(aead_ctx = EVP_CIPHER_CTX_new())) {
-    return false;
-  }
-  if (!EVP_DecryptInit_ex(aead_ctx, aead, nullptr, nullptr, nullptr)) {
-    EVP_CIPHER_CTX_free(aead_ctx);
+  if (cipher_len < tag_len) {
     return false;
   }
-  if (!EVP_CIPHER_CTX_ctrl(aead_ctx, EVP_CTRL_AEAD_SET_IVLEN, nonce_len, nullptr)) {
-    EVP_CIPHER_CTX_free(aead_ctx);
+  if (!warm_up(c.ctx, c.cipher, c.iv_len, c.key, aead, key, nonce_len, false)) {
     return false;
   }
-  if (!EVP_DecryptInit_ex(aead_ctx, nullptr, nullptr, key, nonce)) {
-    EVP_CIPHER_CTX_free(aead_ctx);
+  EVP_CIPHER_CTX *aead_ctx = c.ctx;
+
+  c.cipher = nullptr;
+  if (!EVP_DecryptInit_ex(aead_ctx, nullptr, nullptr, nullptr, nonce)) {
     return false;
   }
   if (!EVP_DecryptUpdate(aead_ctx, nullptr, &len, ad, ad_len)) {
-    EVP_CIPHER_CTX_free(aead_ctx);
     return false;
   }
 
-  if (cipher_len < tag_len) {
-    EVP_CIPHER_CTX_free(aead_ctx);
-    return false;
-  }
   cipher_len -= tag_len;
   if (!EVP_DecryptUpdate(aead_ctx, plain, &len, cipher, cipher_len)) {
-    EVP_CIPHER_CTX_free(aead_ctx);
     return false;
   }
   plain_len = len;
 
   if (!EVP_CIPHER_CTX_ctrl(aead_ctx, EVP_CTRL_AEAD_SET_TAG, tag_len, const_cast<uint8_t *>(cipher + cipher_len))) {
-    EVP_CIPHER_CTX_free(aead_ctx);
     return false;
   }
 
-  int ret = EVP_DecryptFinal_ex(aead_ctx, plain + len, &len);
-
-  EVP_CIPHER_CTX_free(aead_ctx);
+  // A tag that doesn't match is a bad packet, not a broken context
+  int ret  = EVP_DecryptFinal_ex(aead_ctx, plain + len, &len);
+  c.cipher = aead;
 
   if (ret > 0) {
     plain_len += len;
@@ -29,6 +29,10 @@ extern RecRawStatBlock *quic_rsb;
 
 enum class QUICStats {
   total_packets_sent_stat,
+  retry_packets_sent_stat,
+  retry_tokens_accepted_stat,
+  retry_tokens_rejected_stat,
+  invalid_token_closes_suppressed_stat,
   count,
 };
 
@@ -202,11 +202,11 @@ QUICStreamVConnection::~QUICStreamVConnection()
 }
 
 void
-QUICStreamVConnection::_write_to_read_vio(QUICOffset offset, const uint8_t *data, uint64_t data_length, bool fin)
+QUICStreamVConnection::_write_to_read_vio(QUICOffset offset, const IOBufferBlock *data, uint64_t data_length, bool fin)
 {
   SCOPED_MUTEX_LOCK(lock, this->_read_vio.mutex, this_ethread());
 
-  uint64_t bytes_added = this->_read_vio.buffer.writer()->write(data, data_length);
+  uint64_t bytes_added = this->_read_vio.buffer.writer()->write(data, data_length, 0);
 
   // Until receive FIN flag, keep nbytes INT64_MAX
   if (fin && bytes_added == data_length) {
@@ -110,7 +110,8 @@ protected:
   void _signal_read_eos_event();
   Event *_send_tracked_event(Event *, int, VIO *);
 
-  void _write_to_read_vio(QUICOffset offset, const uint8_t *data, uint64_t data_length, bool fin);
+  // Shares the data blocks with the read VIO buffer, nothing is copied
+  void _write_to_read_vio(QUICOffset offset, const IOBufferBlock *data, uint64_t data_length, bool fin);
 
   VIO _read_vio;
   VIO _write_vio;
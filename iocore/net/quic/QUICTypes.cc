@@ -30,7 +30,10 @@
 #include "QUICIntUtil.h"
 #include "tscore/CryptoHash.h"
 #include "I_EventSystem.h"
+#include "tscore/HashSip.h"
+#include <openssl/crypto.h>
 #include <openssl/hmac.h>
+#include <openssl/rand.h>
 
 uint8_t QUICConnectionId::SCID_LEN = 0;
 
@@ -360,41 +363,83 @@ QUICResumptionToken::expire_time() const
   return QUICIntUtil::read_nbytes_as_uint(this->_token + (1 + 20), 4);
 }
 
-QUICRetryToken::QUICRetryToken(const IpEndpoint &src, QUICConnectionId original_dcid)
+QUICRetryToken::QUICRetryToken(const IpEndpoint &src, QUICConnectionId original_dcid, ink_hrtime now)
 {
-  // TODO: read cookie secret from file like SSLTicketKeyConfig
-  static constexpr char stateless_retry_token_secret[] = "stateless_cookie_secret";
-
-  uint8_t data[1 + INET6_ADDRPORTSTRLEN + QUICConnectionId::MAX_LENGTH] = {0};
-  size_t data_len                                                       = 0;
-  ats_ip_nptop(src, reinterpret_cast<char *>(data), sizeof(data));
-  data_len = strlen(reinterpret_cast<char *>(data));
-
+  uint32_t issued = ink_hrtime_to_sec(now ? now : Thread::get_hrtime());
+  size_t dummy;
   size_t cid_len;
-  QUICTypeUtil::write_QUICConnectionId(original_dcid, data + data_len, &cid_len);
-  data_len += cid_len;
 
   this->_token[0] = static_cast<uint8_t>(Type::RETRY);
-  HMAC(EVP_sha1(), stateless_retry_token_secret, sizeof(stateless_retry_token_secret), data, data_len, this->_token + 1,
-       &this->_token_len);
-  ink_assert(this->_token_len == 20);
-  this->_token_len += 1;
-
-  QUICTypeUtil::write_QUICConnectionId(original_dcid, this->_token + this->_token_len, &cid_len);
-  this->_token_len += cid_len;
+  QUICIntUtil::write_uint_as_nbytes(issued, 4, this->_token + 1, &dummy);
+  QUICTypeUtil::write_QUICConnectionId(original_dcid, this->_token + HEADER_LEN, &cid_len);
+  QUICIntUtil::write_uint_as_nbytes(_mac(src, issued, this->_token + HEADER_LEN, cid_len), MAC_LEN, this->_token + 1 + 4, &dummy);
+  this->_token_len = HEADER_LEN + cid_len;
 }
 
 bool
-QUICRetryToken::is_valid(const IpEndpoint &src) const
+QUICRetryToken::is_valid(const IpEndpoint &src, uint32_t lifetime, ink_hrtime now) const
 {
-  return *this == QUICRetryToken(src, this->original_dcid());
+  if (this->_token_len < HEADER_LEN || this->_token_len > HEADER_LEN + QUICConnectionId::MAX_LENGTH ||
+      this->_token[0] != static_cast<uint8_t>(Type::RETRY)) {
+    return false;
+  }
+
+  // Expired, or from the future by more than some clock skew between the threads
+  uint32_t current = ink_hrtime_to_sec(now ? now : Thread::get_hrtime());
+  uint32_t issued  = QUICIntUtil::read_nbytes_as_uint(this->_token + 1, 4);
+  if (current - issued > lifetime && issued - current > 1) {
+    return false;
+  }
+
+  uint8_t mac[MAC_LEN];
+  size_t dummy;
+  QUICIntUtil::write_uint_as_nbytes(_mac(src, issued, this->_token + HEADER_LEN, this->_token_len - HEADER_LEN), MAC_LEN, mac,
+                                    &dummy);
+  return CRYPTO_memcmp(mac, this->_token + 1 + 4, MAC_LEN) == 0;
 }
 
 const QUICConnectionId
 QUICRetryToken::original_dcid() const
 {
-  // Type uses 1 byte and output of EVP_sha1() should be 160 bits
-  return QUICTypeUtil::read_QUICConnectionId(this->_token + (1 + 20), this->_token_len - (1 + 20));
+  if (this->_token_len < HEADER_LEN) {
+    return QUICConnectionId::ZERO();
+  }
+  return QUICTypeUtil::read_QUICConnectionId(this->_token + HEADER_LEN, this->_token_len - HEADER_LEN);
+}
+
+uint64_t
+QUICRetryToken::_mac(const IpEndpoint &src, uint32_t issued, const uint8_t *dcid, size_t dcid_len)
+{
+  // A new secret with each start, tokens need not outlive the process
+  static const struct Secret {
+    uint64_t k[2];
+    Secret()
+    {
+      if (RAND_bytes(reinterpret_cast<unsigned char *>(k), sizeof(k)) != 1) {
+        std::random_device rd;
+        k[0] = (static_cast<uint64_t>(rd()) << 32) | rd();
+        k[1] = (static_cast<uint64_t>(rd()) << 32) | rd();
+      }
+    }
+  } secret;
+
+  // The key of the period the token was issued in
+  uint64_t key[2];
+  for (uint64_t i = 0; i < 2; ++i) {
+    uint64_t seed[2] = {issued / KEY_PERIOD, i};
+    ATSHash64Sip24 kdf(secret.k[0], secret.k[1]);
+    kdf.update(seed, sizeof(seed));
+    kdf.final();
+    key[i] = kdf.get();
+  }
+
+  ATSHash64Sip24 h(key[0], key[1]);
+  h.update(ats_ip_addr8_cast(&src.sa), ats_ip_addr_size(&src.sa));
+  h.update(&ats_ip_port_cast(&src.sa), sizeof(in_port_t));
+  h.update(&issued, sizeof(issued));
+  h.update(dcid, dcid_len);
+  h.final();
+  return h.get();
 }
 
 QUICFrameType
@@ -647,6 +692,19 @@ QUICConnectionId::randomize()
   this->_len = QUICConnectionId::SCID_LEN;
 }
 
+void
+QUICConnectionId::set_thread_hint(uint8_t hint)
+{
+  ink_assert(this->_len > THREAD_HINT_OFFSET);
+  this->_id[THREAD_HINT_OFFSET] = hint;
+}
+
+uint8_t
+QUICConnectionId::thread_hint() const
+{
+  return this->_len > THREAD_HINT_OFFSET ? this->_id[THREAD_HINT_OFFSET] : 0;
+}
+
 uint64_t
 QUICConnectionId::_hashcode() const
 {
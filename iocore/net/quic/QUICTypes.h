@@ -23,6 +23,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <cstring>
 #include <unordered_map>
 #include "tscore/ink_endian.h"
@@ -270,6 +271,14 @@ public:
   bool is_zero() const;
   void randomize();
 
+  /*
+   * Which receiving socket a server chosen ID belongs to, see proxy.config.quic.cid_steering.
+   * It sits at THREAD_HINT_OFFSET, the byte the steering program reads.
+   */
+  static constexpr int THREAD_HINT_OFFSET = 1;
+  void set_thread_hint(uint8_t hint);
+  uint8_t thread_hint() const;
+
 private:
   uint64_t _hashcode() const;
   uint8_t _id[MAX_LENGTH];
@@ -325,8 +334,11 @@ public:
     RETRY,
   };
 
-  // FIXME Check token length
-  QUICAddressValidationToken(const uint8_t *buf, size_t len) : _token_len(len) { memcpy(this->_token, buf, len); }
+  // A token too long for any Retry packet is cut short, it can not be valid anyway
+  QUICAddressValidationToken(const uint8_t *buf, size_t len) : _token_len(std::min(len, sizeof(_token)))
+  {
+    memcpy(this->_token, buf, this->_token_len);
+  }
   virtual ~QUICAddressValidationToken(){};
 
   static Type
@@ -377,11 +389,23 @@ public:
   const ink_hrtime expire_time() const;
 };
 
+/**
+  A Retry token is its type, the second it was issued, a SipHash MAC and the original DCID. The MAC
+  covers the client address and port, the second and the DCID, with a key derived for each
+  KEY_PERIOD from a secret drawn at startup. Telling a forged token from a real one costs one
+  SipHash, and no handshake state is kept for either.
+ */
 class QUICRetryToken : public QUICAddressValidationToken
 {
 public:
+  static constexpr size_t MAC_LEN            = 8;
+  static constexpr size_t HEADER_LEN         = 1 + 4 + MAC_LEN;
+  static constexpr uint32_t DEFAULT_LIFETIME = 10; ///< Seconds
+  static constexpr uint32_t KEY_PERIOD       = 64; ///< Seconds
+
   QUICRetryToken(const uint8_t *buf, size_t len) : QUICAddressValidationToken(buf, len) {}
-  QUICRetryToken(const IpEndpoint &src, QUICConnectionId original_dcid);
+  /// Issue a token for @a src, at @a now or the current time.
+  QUICRetryToken(const IpEndpoint &src, QUICConnectionId original_dcid, ink_hrtime now = 0);
 
   bool
   operator==(const QUICRetryToken &x) const
@@ -392,12 +416,13 @@ public:
     return memcmp(this->_token, x._token, this->_token_len) == 0;
   }
 
-  bool is_valid(const IpEndpoint &src) const;
+  /// Whether this was issued for @a src at most @a lifetime seconds before @a now or the current time.
+  bool is_valid(const IpEndpoint &src, uint32_t lifetime = DEFAULT_LIFETIME, ink_hrtime now = 0) const;
 
   const QUICConnectionId original_dcid() const;
 
 private:
-  QUICConnectionId _original_dcid;
+  static uint64_t _mac(const IpEndpoint &src, uint32_t issued, const uint8_t *dcid, size_t dcid_len);
 };
 
 class QUICPreferredAddress
@@ -547,10 +572,17 @@ public:
   virtual ink_hrtime initial_rtt() const    = 0;
 };
 
+enum class QUICCongestionControlAlgorithm : uint8_t {
+  NEW_RENO = 0,
+  CUBIC    = 1,
+  BBR2     = 2,
+};
+
 class QUICCCConfig
 {
 public:
   virtual ~QUICCCConfig() {}
+  virtual QUICCongestionControlAlgorithm algorithm() const = 0;
   virtual uint32_t max_datagram_size() const               = 0;
   virtual uint32_t initial_window() const                  = 0;
   virtual uint32_t minimum_window() const                  = 0;
@@ -80,10 +80,14 @@ public:
   };
 
   void
-  cc_metrics_update_callback(QUICCallbackContext &, uint64_t congestion_window, uint64_t bytes_in_flight, uint64_t sshresh) override
+  cc_metrics_update_callback(QUICCallbackContext &, uint64_t congestion_window, uint64_t bytes_in_flight, uint64_t sshresh,
+                             uint64_t pacing_rate) override
   {
     auto qe = std::make_unique<Recovery::MetricsUpdated>();
     qe->set_congestion_window(static_cast<int>(congestion_window)).set_bytes_in_flight(bytes_in_flight).set_ssthresh(sshresh);
+    if (pacing_rate) {
+      qe->set_pacing_rate(static_cast<int>(std::min<uint64_t>(pacing_rate, INT_MAX)));
+    }
     this->_log.last_trace().push_event(std::move(qe));
   }
 
@@ -320,6 +320,44 @@ TEST_CASE("QUICAckFrameManager_QUICAckFrameCreator", "[quic]")
   CHECK(packet_numbers.largest_ack_received_time() == 0);
 }
 
+TEST_CASE("QUICAckFrameManager_QUICAckFrameCreator ranges", "[quic]")
+{
+  QUICAckFrameManager ack_manager;
+  QUICAckFrameManager::QUICAckFrameCreator packet_numbers(QUICPacketNumberSpace::ApplicationData, &ack_manager);
+  uint8_t frame_buf[QUICFrame::MAX_INSTANCE_SIZE];
+
+  // Out of order packets fill the gaps between the ranges, duplicates are not counted
+  for (QUICPacketNumber pn : {1, 3, 5, 9, 2, 4, 3, 8}) {
+    packet_numbers.push_back(pn, 1, false);
+  }
+  CHECK(packet_numbers.size() == 7);
+
+  QUICAckFrame *frame = packet_numbers.generate_ack_frame(frame_buf, UINT16_MAX);
+  REQUIRE(frame != nullptr);
+  CHECK(frame->largest_acknowledged() == 9);
+  CHECK(frame->ack_block_section()->first_ack_block() == 1);
+  CHECK(frame->ack_block_count() == 1);
+  CHECK(frame->ack_block_section()->begin()->gap() == 1);
+  CHECK(frame->ack_block_section()->begin()->length() == 4);
+  frame->~QUICAckFrame();
+
+  // Forgetting up to a packet in the middle of a range keeps the rest of it
+  packet_numbers.forget(4);
+  CHECK(packet_numbers.size() == 3);
+  CHECK(packet_numbers.available());
+  frame = packet_numbers.generate_ack_frame(frame_buf, UINT16_MAX);
+  REQUIRE(frame != nullptr);
+  CHECK(frame->largest_acknowledged() == 9);
+  CHECK(frame->ack_block_count() == 1);
+  CHECK(frame->ack_block_section()->begin()->gap() == 1);
+  CHECK(frame->ack_block_section()->begin()->length() == 0);
+  frame->~QUICAckFrame();
+
+  packet_numbers.forget(9);
+  CHECK(packet_numbers.size() == 0);
+  CHECK(!packet_numbers.available());
+}
+
 TEST_CASE("QUICAckFrameManager lost_frame", "[quic]")
 {
   QUICAckFrameManager ack_manager;
@@ -0,0 +1,96 @@
+/** @file
+ *
+ *  A brief file description
+ *
+ *  @section license License
+ *
+ *  Licensed to the Apache Software Foundation (ASF) under one
+ *  or more contributor license agreements.  See the NOTICE file
+ *  distributed with this work for additional information
+ *  regarding copyright ownership.  The ASF licenses this file
+ *  to you under the Apache License, Version 2.0 (the
+ *  "License"); you may not use this file except in compliance
+ *  with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "catch.hpp"
+
+#include "quic/QUICConnectionTable.h"
+
+#include <vector>
+
+static QUICConnection *
+conn(uintptr_t n)
+{
+  return reinterpret_cast<QUICConnection *>(n * 8);
+}
+
+static QUICConnectionId
+cid(uint32_t n, uint8_t len = 8)
+{
+  uint8_t buf[QUICConnectionId::MAX_LENGTH] = {0};
+  buf[0]                                    = n >> 24;
+  buf[1]                                    = n >> 16;
+  buf[2]                                    = n >> 8;
+  buf[3]                                    = n;
+  return QUICConnectionId(buf, len);
+}
+
+TEST_CASE("QUICConnectionTable", "[quic]")
+{
+  SECTION("insert, lookup and erase")
+  {
+    QUICConnectionTable table(16);
+    CHECK(table.lookup(cid(1)) == nullptr);
+    CHECK(table.insert(cid(1), conn(1)) == nullptr);
+    CHECK(table.insert(cid(2), conn(2)) == nullptr);
+    CHECK(table.lookup(cid(1)) == conn(1));
+    CHECK(table.lookup(cid(2)) == conn(2));
+
+    // The length is part of the ID
+    CHECK(table.lookup(cid(1, 9)) == nullptr);
+
+    // Replacing returns the old connection
+    CHECK(table.insert(cid(1), conn(3)) == conn(1));
+    CHECK(table.lookup(cid(1)) == conn(3));
+
+    table.erase(cid(1), conn(3));
+    CHECK(table.lookup(cid(1)) == nullptr);
+    CHECK(table.lookup(cid(2)) == conn(2));
+    CHECK(table.erase(cid(2)) == conn(2));
+    CHECK(table.erase(cid(2)) == nullptr);
+  }
+
+  SECTION("growth and churn")
+  {
+    QUICConnectionTable table(16);
+    for (uint32_t i = 1; i <= 10000; ++i) {
+      table.insert(cid(i), conn(i));
+    }
+    for (uint32_t i = 1; i <= 10000; ++i) {
+      REQUIRE(table.lookup(cid(i)) == conn(i));
+    }
+
+    // Erasing and inserting again keeps every remaining entry reachable
+    for (uint32_t i = 1; i <= 10000; i += 2) {
+      table.erase(cid(i), conn(i));
+      table.insert(cid(i + 20000), conn(i + 20000));
+    }
+    for (uint32_t i = 1; i <= 10000; ++i) {
+      if (i % 2) {
+        REQUIRE(table.lookup(cid(i)) == nullptr);
+        REQUIRE(table.lookup(cid(i + 20000)) == conn(i + 20000));
+      } else {
+        REQUIRE(table.lookup(cid(i)) == conn(i));
+      }
+    }
+  }
+}
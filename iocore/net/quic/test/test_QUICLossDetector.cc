@@ -323,3 +323,65 @@ TEST_CASE("QUICLossDetector_HugeGap", "[quic]")
   CHECK(t2 - t1 < HRTIME_MSECONDS(100));
   ack->~QUICAckFrame();
 }
+
+TEST_CASE("QUICSentPacketRing", "[quic]")
+{
+  QUICSentPacketRing ring;
+  auto packet = [](QUICPacketNumber pn) {
+    QUICPacketInfoUPtr info = std::make_unique<QUICPacketInfo>();
+    info->packet_number     = pn;
+    return info;
+  };
+
+  CHECK(ring.size() == 0);
+  CHECK(ring.find(0) == nullptr);
+  CHECK(!(ring.begin() != ring.end()));
+
+  // More packets than the initial slots
+  for (QUICPacketNumber pn = 1; pn <= 200; ++pn) {
+    CHECK(ring.insert(packet(pn)));
+  }
+  CHECK(ring.size() == 200);
+  CHECK(!ring.insert(packet(100)));
+  CHECK(ring.size() == 200);
+  CHECK(ring.lowest() == 1);
+  CHECK(ring.highest() == 200);
+  REQUIRE(ring.find(150) != nullptr);
+  CHECK(ring.find(150)->packet_number == 150);
+  CHECK(ring.find(201) == nullptr);
+
+  // Erasing the ends moves them to the next outstanding packet
+  for (QUICPacketNumber pn = 1; pn < 100; ++pn) {
+    CHECK(ring.erase(pn) != nullptr);
+  }
+  CHECK(ring.erase(150)->packet_number == 150);
+  CHECK(ring.erase(150) == nullptr);
+  CHECK(ring.erase(200) != nullptr);
+  CHECK(ring.lowest() == 100);
+  CHECK(ring.highest() == 199);
+
+  // Iteration skips what was erased
+  QUICPacketNumber expected = 100;
+  size_t n                  = 0;
+  for (auto &info : ring) {
+    if (expected == 150) {
+      ++expected;
+    }
+    CHECK(info.packet_number == expected);
+    ++expected;
+    ++n;
+  }
+  CHECK(n == ring.size());
+
+  // Packets far ahead of the lowest outstanding one grow the ring
+  CHECK(ring.insert(packet(10000)));
+  CHECK(ring.find(100) != nullptr);
+  CHECK(ring.find(10000) != nullptr);
+  CHECK(ring.highest() == 10000);
+
+  ring.clear();
+  CHECK(ring.size() == 0);
+  CHECK(ring.find(10000) == nullptr);
+  CHECK(ring.insert(packet(5)));
+  CHECK(ring.lowest() == 5);
+}
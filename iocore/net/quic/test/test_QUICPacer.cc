@@ -0,0 +1,74 @@
+/** @file
+ *
+ *  A brief file description
+ *
+ *  @section license License
+ *
+ *  Licensed to the Apache Software Foundation (ASF) under one
+ *  or more contributor license agreements.  See the NOTICE file
+ *  distributed with this work for additional information
+ *  regarding copyright ownership.  The ASF licenses this file
+ *  to you under the Apache License, Version 2.0 (the
+ *  "License"); you may not use this file except in compliance
+ *  with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "catch.hpp"
+
+#include "QUICPacer.h"
+
+// 1200 bytes every millisecond
+static constexpr uint64_t rate = 1200 * 1000;
+
+TEST_CASE("QUICPacer", "[quic]")
+{
+  ink_hrtime now = HRTIME_SECONDS(100);
+
+  SECTION("spreads datagrams at the rate")
+  {
+    QUICPacer pacer(0);
+    CHECK(pacer.send_time(now) == now);
+    pacer.on_sent(now, 1200, rate);
+    CHECK(pacer.send_time(now) == now + HRTIME_MSECONDS(1));
+    pacer.on_sent(now, 1200, rate);
+    CHECK(pacer.send_time(now) == now + HRTIME_MSECONDS(2));
+    CHECK(pacer.send_time(now + HRTIME_MSECONDS(5)) == now + HRTIME_MSECONDS(5));
+  }
+
+  SECTION("idle time turns into a burst")
+  {
+    QUICPacer pacer(3600);
+    pacer.on_sent(now, 1200, rate);
+    pacer.on_sent(now, 1200, rate);
+    pacer.on_sent(now, 1200, rate);
+    CHECK(pacer.send_time(now) == now);
+    pacer.on_sent(now, 1200, rate);
+    CHECK(pacer.send_time(now) == now + HRTIME_MSECONDS(1));
+
+    // Credit never grows past the burst however long the connection was idle.
+    now += HRTIME_SECONDS(10);
+    for (int i = 0; i < 3; ++i) {
+      CHECK(pacer.send_time(now) == now);
+      pacer.on_sent(now, 1200, rate);
+    }
+    CHECK(pacer.send_time(now) == now);
+    pacer.on_sent(now, 1200, rate);
+    CHECK(pacer.send_time(now) == now + HRTIME_MSECONDS(1));
+  }
+
+  SECTION("no rate, no pacing")
+  {
+    QUICPacer pacer(0);
+    pacer.on_sent(now, 1200, rate);
+    pacer.on_sent(now, 1200, 0);
+    CHECK(pacer.send_time(now) == now);
+  }
+}
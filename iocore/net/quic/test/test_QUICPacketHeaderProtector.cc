@@ -108,6 +108,60 @@ TEST_CASE("QUICPacketHeaderProtector")
     delete server;
   }
 
+  SECTION("Batch of long headers", "[quic]")
+  {
+    uint8_t original[] = {
+      0xc3,                                           // Long header, Type: INITIAL
+      0x11, 0x22, 0x33, 0x44,                         // Version
+      0x08,                                           // DCID Len
+      0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, // Destination Connection ID
+      0x08,                                           // SCID Len
+      0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, // Source Connection ID
+      0x00,                                           // Token Length (i), Token (*)
+      0x19,                                           // Length (Not 0x09 because it will have 16 bytes of AEAD tag)
+      0x01, 0x23, 0x45, 0x67,                         // Packet number
+      0x11, 0x22, 0x33, 0x44, 0x55,                   // Payload (dummy)
+    };
+    // Packets that differ in the sample, so that each gets a mask of its own
+    uint8_t batch[3][64] = {};
+    uint8_t single[3][64] = {};
+    for (int i = 0; i < 3; ++i) {
+      memcpy(batch[i], original, sizeof(original));
+      batch[i][sizeof(original) + i] = 0xff;
+      memcpy(single[i], batch[i], sizeof(batch[i]));
+    }
+
+    QUICPacketProtectionKeyInfo pp_key_info_client;
+    QUICPacketProtectionKeyInfo pp_key_info_server;
+    NetVCOptions netvc_options;
+    QUICHandshakeProtocol *client = new QUICTLS(pp_key_info_client, client_ssl_ctx, NET_VCONNECTION_OUT, netvc_options);
+    QUICHandshakeProtocol *server = new QUICTLS(pp_key_info_server, server_ssl_ctx, NET_VCONNECTION_IN, netvc_options);
+
+    CHECK(client->initialize_key_materials({reinterpret_cast<const uint8_t *>("\x83\x94\xc8\xf0\x3e\x51\x57\x00"), 8}));
+    CHECK(server->initialize_key_materials({reinterpret_cast<const uint8_t *>("\x83\x94\xc8\xf0\x3e\x51\x57\x00"), 8}));
+
+    QUICPacketHeaderProtector client_ph_protector(pp_key_info_client);
+    QUICPacketHeaderProtector server_ph_protector(pp_key_info_server);
+
+    uint8_t *packets[] = {batch[0], batch[1], batch[2]};
+    size_t packet_lens[] = {sizeof(batch[0]), sizeof(batch[1]), sizeof(batch[2])};
+    REQUIRE(client_ph_protector.protect(packets, packet_lens, 3, 18));
+    for (int i = 0; i < 3; ++i) {
+      REQUIRE(client_ph_protector.protect(single[i], sizeof(single[i]), 18));
+      CHECK(memcmp(batch[i], single[i], sizeof(batch[i])) == 0);
+      CHECK(memcmp(batch[i], original, sizeof(original)) != 0);
+    }
+    CHECK(memcmp(batch[0], batch[1], sizeof(original)) != 0);
+
+    for (int i = 0; i < 3; ++i) {
+      REQUIRE(server_ph_protector.unprotect(batch[i], sizeof(batch[i])));
+      CHECK(memcmp(batch[i], original, sizeof(original)) == 0);
+    }
+
+    delete client;
+    delete server;
+  }
+
   SECTION("Short header", "[quic]")
   {
     uint8_t original[] = {
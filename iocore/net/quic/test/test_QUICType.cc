@@ -118,6 +118,27 @@ TEST_CASE("QUICType", "[quic]")
     CHECK(token1.length() == token2.length());
     CHECK(memcmp(token1.buf(), token2.buf(), token1.length()) == 0);
     CHECK(token1.original_dcid() == token2.original_dcid());
+
+    // Another client address or port
+    IpEndpoint other;
+    ats_ip4_set(&other, 0x04030202, 0x2211);
+    CHECK(!token1.is_valid(other));
+    ats_ip4_set(&other, 0x04030201, 0x2212);
+    CHECK(!token1.is_valid(other));
+
+    // Tampered with, or cut short
+    uint8_t buf[QUICRetryToken::HEADER_LEN + QUICConnectionId::MAX_LENGTH];
+    memcpy(buf, token1.buf(), token1.length());
+    buf[token1.length() - 1] ^= 0x01;
+    CHECK(!QUICRetryToken(buf, token1.length()).is_valid(ep));
+    CHECK(!QUICRetryToken(token1.buf(), QUICRetryToken::HEADER_LEN - 1).is_valid(ep));
+
+    // Expired
+    ink_hrtime issued = Thread::get_hrtime();
+    QUICRetryToken token3(ep, cid, issued);
+    CHECK(token3.is_valid(ep, 10, issued + HRTIME_SECONDS(10)));
+    CHECK(!token3.is_valid(ep, 10, issued + HRTIME_SECONDS(11)));
+    CHECK(!token3.is_valid(ep, 10, issued - HRTIME_SECONDS(5)));
   }
 
   SECTION("QUICResumptionToken")
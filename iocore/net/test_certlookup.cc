@@ -99,6 +99,56 @@ REGRESSION_TEST(SSLCertificateLookup)(RegressionTest *t, int /* atype ATS_UNUSED
   box.check(lookup.find("mixed.case.com")->getCtx().get() == foo, "lower case lookup for Mixed.Case.Com");
 }
 
+REGRESSION_TEST(SSLCertificateAlias)(RegressionTest *t, int /* atype ATS_UNUSED */, int *pstatus)
+{
+  TestBox box(t, pstatus);
+  SSLCertLookup lookup;
+
+  SSL_CTX *shared = SSL_CTX_new(SSLv23_server_method());
+  SSL_CTX *other  = SSL_CTX_new(SSLv23_server_method());
+  SSLCertContext shared_cc(shared);
+  SSLCertContext other_cc(other);
+
+  box = REGRESSION_TEST_PASSED;
+
+  int idx = lookup.insert("a.example.com", shared_cc);
+  box.check(idx >= 0, "insert host context");
+  box.check(lookup.insert("b.example.com", idx) == idx, "insert host alias");
+  box.check(lookup.insert("*.example.net", idx) == idx, "insert wildcard alias");
+  box.check(lookup.insert("b.example.com", other_cc) < 0, "insert alias duplicate");
+  box.check(lookup.count() == 1, "aliases share the stored context");
+
+  box.check(lookup.find("a.example.com") == lookup.find("b.example.com"), "alias lookup for b.example.com");
+  box.check(lookup.find("www.example.net")->getCtx().get() == shared, "wildcard alias lookup for www.example.net");
+  box.check(lookup.find("example.com") == nullptr, "no lookup for the parent of names");
+  box.check(lookup.find("c.example.com") == nullptr, "no lookup for a sibling of names");
+  box.check(lookup.find("a.example.com.au") == nullptr, "no lookup for a longer name");
+}
+
+REGRESSION_TEST(SSLCertificateLazyLoad)(RegressionTest *t, int /* atype ATS_UNUSED */, int *pstatus)
+{
+  TestBox box(t, pstatus);
+  SSLCertLookup lookup;
+
+  SSL_CTX *lazy = SSL_CTX_new(SSLv23_server_method());
+  int loads     = 0;
+  SSLCertContext lazy_cc;
+  lazy_cc.setCtxLoader([lazy, &loads]() {
+    ++loads;
+    return shared_SSL_CTX(lazy, SSL_CTX_free);
+  });
+
+  box = REGRESSION_TEST_PASSED;
+
+  box.check(lookup.insert("lazy.example.com", lazy_cc) >= 0, "insert lazy context");
+
+  SSLCertContext *cc = lookup.find("lazy.example.com");
+  box.check(cc != nullptr && !cc->peekCtx(), "lazy context is not built by the lookup");
+  box.check(cc != nullptr && cc->getCtx().get() == lazy, "lazy context is built on first use");
+  box.check(cc != nullptr && cc->getCtx().get() == lazy, "lazy context is kept");
+  box.check(loads == 1, "lazy context is built once");
+}
+
 REGRESSION_TEST(SSLAddressLookup)(RegressionTest *t, int /* atype ATS_UNUSED */, int *pstatus)
 {
   TestBox box(t, pstatus);
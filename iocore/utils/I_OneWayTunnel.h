@@ -178,6 +178,9 @@ struct OneWayTunnel : public Continuation {
 
   virtual void transform(MIOBufferAccessor &in_buf, MIOBufferAccessor &out_buf);
 
+  /** Let the kernel move the data if nothing transforms it and both VCs are plain sockets. */
+  void splice();
+
   /** Result is -1 for any error. */
   void close_source_vio(int result);
 
@@ -34,6 +34,7 @@
 
 #include "P_EventSystem.h"
 #include "I_OneWayTunnel.h"
+#include "I_NetVConnection.h"
 
 // #define TEST
 
@@ -148,6 +149,7 @@ OneWayTunnel::init(VConnection *vcSource, VConnection *vcTarget, Continuation *a
   vioSource = vcSource->do_io_read(this, nbytes, buf1);
   vioTarget = vcTarget->do_io_write(this, nbytes, buf2->alloc_reader(), false);
   ink_assert(vioSource && vioTarget);
+  splice();
 
   return;
 }
@@ -178,6 +180,7 @@ OneWayTunnel::init(VConnection *vcSource, VConnection *vcTarget, Continuation *a
 
   vioTarget = vcTarget->do_io_write(this, TUNNEL_TILL_DONE, reader, false);
   ink_assert(vioSource && vioTarget);
+  splice();
 }
 
 void
@@ -202,6 +205,7 @@ OneWayTunnel::init(Continuation *aCont, VIO *SourceVio, VIO *TargetVio, bool acl
   TargetVio->set_continuation(this);
   vioSource = SourceVio;
   vioTarget = TargetVio;
+  splice();
 }
 
 void
@@ -214,6 +218,19 @@ OneWayTunnel::transform(MIOBufferAccessor &in_buf, MIOBufferAccessor &out_buf)
   }
 }
 
+void
+OneWayTunnel::splice()
+{
+  if (manipulate_fn || !single_buffer) {
+    return;
+  }
+  NetVConnection *src = dynamic_cast<NetVConnection *>(vioSource->vc_server);
+  NetVConnection *dst = dynamic_cast<NetVConnection *>(vioTarget->vc_server);
+  if (src && dst && src->splice_to(dst)) {
+    Debug("one_way_tunnel", "splicing %p to %p", src, dst);
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////
 //
 //      int OneWayTunnel::startEvent()
@@ -280,6 +297,9 @@ OneWayTunnel::startEvent(int event, void *data)
     // set write nbytes to the current buffer size
     //
     vioTarget->nbytes = vioTarget->ndone + vioTarget->buffer.reader()->read_avail();
+    if (NetVConnection *target = dynamic_cast<NetVConnection *>(vioTarget->vc_server)) {
+      vioTarget->nbytes += target->splice_pending();
+    }
     if (vioTarget->nbytes == vioTarget->ndone) {
       goto Ldone;
     }
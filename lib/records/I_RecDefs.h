@@ -158,14 +158,22 @@ struct RecRawStat {
   uint32_t version;
 };
 
+// The part of a raw stat that each thread keeps, only written by that thread.
+struct RecRawStatSlice {
+  int64_t sum;
+  int64_t count;
+};
+
 // WARNING!  It's advised that developers do not modify the contents of
 // the RecRawStatBlock.  ^_^
 struct RecRawStatBlock {
-  off_t ethr_stat_offset; // thread local raw-stat storage
-  RecRawStat **global;    // global raw-stat storage (ptr to RecRecord)
-  int num_stats;          // number of stats in this block
-  int max_stats;          // maximum number of stats for this block
-  ink_mutex mutex;
+  off_t ethr_stat_offset;  // thread local raw-stat storage (RecRawStatSlice)
+  RecRawStat **global;     // global raw-stat storage (ptr to RecRecord)
+  int num_stats;           // one past the highest id registered in this block
+  int max_stats;           // maximum number of stats for this block
+  RecRawStatSlice *totals; // sums of the thread local values of the first totals_num stats,
+  int totals_num;          // as of the sync pass totals_pass
+  unsigned totals_pass;
 };
 
 //-------------------------------------------------------------------------
@@ -0,0 +1,99 @@
+/** @file
+
+  Histogram statistics.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  @section details Details
+
+  A RecHistogram counts values, such as latencies in milliseconds, in log-linear buckets: one per
+  value up to 8, then 4 buckets for each power of two up to 2^17 (131072), and one for the larger
+  values. The relative error of a bucket is at most 25%.
+
+  The buckets are raw stats of a block of their own, so each thread counts its values in its own
+  slice and they are merged when the stats are synced. For a histogram named @c name these stats
+  are registered, in the way Prometheus expects them:
+
+  - @c name.bucket.N for each bound @c N, and then @c name.bucket.inf, the number of values less
+    than or equal to @c N.
+  - @c name.sum, the sum of the values.
+  - @c name.count, the number of values.
+ */
+
+#pragma once
+
+#include "I_RecProcess.h"
+
+class RecHistogram
+{
+public:
+  static constexpr int SUB_BITS = 2;
+  /// Buckets for each power of two.
+  static constexpr int SUB_BUCKETS = 1 << SUB_BITS;
+  /// Values up to this have a bucket each.
+  static constexpr int LINEAR_BUCKETS = 2 << SUB_BITS;
+  /// The largest bound is 2^MAX_EXPONENT.
+  static constexpr int MAX_EXPONENT = 17;
+  static constexpr int N_BUCKETS    = LINEAR_BUCKETS + (MAX_EXPONENT - SUB_BITS - 1) * SUB_BUCKETS + 1;
+  /// Bound of the last bucket.
+  static constexpr int64_t INF_BOUND = INT64_MAX;
+
+  /// The bucket @a value is counted in.
+  static int
+  bucket_of(int64_t value)
+  {
+    if (value <= LINEAR_BUCKETS) {
+      return value <= 1 ? 0 : value - 1;
+    }
+    if (value > (int64_t{1} << MAX_EXPONENT)) {
+      return N_BUCKETS - 1;
+    }
+    // 2^exp < value <= 2^(exp + 1), split in SUB_BUCKETS
+    int exp = 63 - __builtin_clzll(value - 1);
+    return LINEAR_BUCKETS + (exp - SUB_BITS - 1) * SUB_BUCKETS + ((value - (int64_t{1} << exp) - 1) >> (exp - SUB_BITS));
+  }
+
+  /// The largest value counted in @a bucket, @c INF_BOUND for the last one.
+  static int64_t bucket_bound(int bucket);
+
+  /** Register the stats of the histogram @a name.
+
+      @return @c false if they could not be registered.
+   */
+  bool init(RecT rec_type, const char *name);
+
+  /// Count @a value, on @a ethread or else the current thread.
+  void
+  record(int64_t value, EThread *ethread = nullptr)
+  {
+    if (_rsb != nullptr && value >= 0) {
+      RecIncrRawStatCount(_rsb, ethread, bucket_of(value), 1);
+      RecIncrRawStatSum(_rsb, ethread, SUM_ID, value);
+    }
+  }
+
+private:
+  static constexpr int SUM_ID   = N_BUCKETS;
+  static constexpr int COUNT_ID = N_BUCKETS + 1;
+
+  static int sync_bucket(const char *name, RecDataT data_type, RecData *data, RecRawStatBlock *rsb, int id);
+  static int sync_count(const char *name, RecDataT data_type, RecData *data, RecRawStatBlock *rsb, int id);
+
+  RecRawStatBlock *_rsb = nullptr;
+};
@@ -0,0 +1,55 @@
+/** @file
+
+  Snapshot of the stats in the Prometheus text format.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  @section details Details
+
+  While the stats are being scraped, the stats are formatted once after each sync of the raw stats,
+  into a buffer that each scrape shares rather than walking and formatting the records itself.
+
+  The metrics are named after the stats, each character that is not allowed replaced by '_'. Parts
+  of a name become labels:
+
+  - "name.volume_N.stat" is the sample of "name_stat" with label volume="N".
+  - The buckets, sum and count of a RecHistogram are the samples of a Prometheus histogram.
+ */
+
+#pragma once
+
+#include <string>
+#include <string_view>
+
+#include "I_EventSystem.h"
+
+/// The content type of the snapshot.
+#define REC_METRICS_CONTENT_TYPE "text/plain; version=0.0.4"
+
+/// The latest snapshot of the stats, formatted now if there is none. It is never written to.
+Ptr<IOBufferData> RecMetricsSnapshot();
+
+/// Format a new snapshot if the stats have been scraped lately, each time the raw stats are synced.
+void RecMetricsUpdate();
+
+/** The metric name of the stat @a name, with the labels taken from it appended to @a labels.
+
+    For example "proxy.process.cache.volume_1.bytes_used" is "proxy_process_cache_bytes_used", with volume="1".
+ */
+std::string RecMetricsName(std::string_view name, std::string &labels);
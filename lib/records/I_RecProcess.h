@@ -111,20 +111,20 @@ int64_t *RecGetGlobalRawStatCountPtr(RecRawStatBlock *rsb, int id);
 //-------------------------------------------------------------------------
 // inlined functions that are used very frequently.
 // FIXME: move it to Inline.cc
-inline RecRawStat *
+inline RecRawStatSlice *
 raw_stat_get_tlp(RecRawStatBlock *rsb, int id, EThread *ethread)
 {
   ink_assert((id >= 0) && (id < rsb->max_stats));
   if (ethread == nullptr) {
     ethread = this_ethread();
   }
-  return (((RecRawStat *)((char *)(ethread) + rsb->ethr_stat_offset)) + id);
+  return (((RecRawStatSlice *)((char *)(ethread) + rsb->ethr_stat_offset)) + id);
 }
 
 inline int
 RecIncrRawStat(RecRawStatBlock *rsb, EThread *ethread, int id, int64_t incr)
 {
-  RecRawStat *tlp = raw_stat_get_tlp(rsb, id, ethread);
+  RecRawStatSlice *tlp = raw_stat_get_tlp(rsb, id, ethread);
   tlp->sum += incr;
   tlp->count += 1;
   return REC_ERR_OKAY;
@@ -133,7 +133,7 @@ RecIncrRawStat(RecRawStatBlock *rsb, EThread *ethread, int id, int64_t incr)
 inline int
 RecDecrRawStat(RecRawStatBlock *rsb, EThread *ethread, int id, int64_t decr)
 {
-  RecRawStat *tlp = raw_stat_get_tlp(rsb, id, ethread);
+  RecRawStatSlice *tlp = raw_stat_get_tlp(rsb, id, ethread);
   tlp->sum -= decr;
   tlp->count += 1;
   return REC_ERR_OKAY;
@@ -142,7 +142,7 @@ RecDecrRawStat(RecRawStatBlock *rsb, EThread *ethread, int id, int64_t decr)
 inline int
 RecIncrRawStatSum(RecRawStatBlock *rsb, EThread *ethread, int id, int64_t incr)
 {
-  RecRawStat *tlp = raw_stat_get_tlp(rsb, id, ethread);
+  RecRawStatSlice *tlp = raw_stat_get_tlp(rsb, id, ethread);
   tlp->sum += incr;
   return REC_ERR_OKAY;
 }
@@ -150,7 +150,7 @@ RecIncrRawStatSum(RecRawStatBlock *rsb, EThread *ethread, int id, int64_t incr)
 inline int
 RecIncrRawStatCount(RecRawStatBlock *rsb, EThread *ethread, int id, int64_t incr)
 {
-  RecRawStat *tlp = raw_stat_get_tlp(rsb, id, ethread);
+  RecRawStatSlice *tlp = raw_stat_get_tlp(rsb, id, ethread);
   tlp->count += incr;
   return REC_ERR_OKAY;
 }
@@ -0,0 +1,146 @@
+/** @file
+
+  Export of the stats in shared memory.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  @section details Details
+
+  traffic_server maps a file in the runtime directory and, each time the raw stats are synced, copies
+  the value of every stat into it. Local tools map the file read only and read the stats with no
+  message to traffic_manager and no lock.
+
+  The file is a RecStatsShmHeader followed by RecStatsShmHeader::capacity slots. Each stat has a slot
+  for as long as traffic_server runs, and a slot is published by raising RecStatsShmHeader::count
+  once its name and types are written, which then never change. The value of a slot is guarded by a
+  sequence lock: the writer makes RecStatsShmSlot::seq odd while it writes the value and even again
+  once it is done, so a reader that sees the same even sequence before and after copying the value
+  has a consistent copy. A new traffic_server replaces the file rather than writing into it.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include <sys/types.h>
+
+#include "I_RecDefs.h"
+
+/// The name of the file in the runtime directory.
+#define REC_STATS_SHM_FILE "stats.shm"
+
+constexpr uint32_t REC_STATS_SHM_MAGIC   = 0x54535354; // "TSST"
+constexpr uint32_t REC_STATS_SHM_VERSION = 1;
+
+/// The longest stat name that is exported, the others are left out.
+constexpr size_t REC_STATS_SHM_NAME_MAX = 183;
+/// String values are cut to this many bytes.
+constexpr size_t REC_STATS_SHM_STRING_MAX = 63;
+
+struct RecStatsShmHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t slot_size;           ///< sizeof(RecStatsShmSlot)
+  uint32_t capacity;            ///< The number of slots.
+  std::atomic<uint32_t> count;  ///< The number of slots in use.
+  uint32_t reserved;
+  int64_t pid;                  ///< The traffic_server that writes the file.
+  std::atomic<int64_t> updated; ///< When the values were last written, in seconds since the epoch.
+  char pad[24];
+};
+
+union RecStatsShmValue {
+  RecInt rec_int;
+  RecCounter rec_counter;
+  RecFloat rec_float;
+  char rec_string[REC_STATS_SHM_STRING_MAX + 1]; ///< nul terminated
+};
+
+struct RecStatsShmSlot {
+  std::atomic<uint32_t> seq;
+  uint8_t rec_type;  ///< RecT
+  uint8_t data_type; ///< RecDataT
+  uint16_t name_len;
+  char name[REC_STATS_SHM_NAME_MAX + 1]; ///< nul terminated
+  RecStatsShmValue value;
+};
+
+static_assert(sizeof(RecStatsShmHeader) == 64, "the layout of the file is fixed");
+static_assert(sizeof(RecStatsShmSlot) == 256, "the layout of the file is fixed");
+
+/** Export the stats to the file at @a path, replacing it.
+
+    @return @c true if the file is mapped, else the stats are not exported.
+ */
+bool RecStatsShmInit(const char *path);
+
+/// Copy the values of the stats to the file, after each sync of the raw stats.
+void RecStatsShmUpdate();
+
+/// Reads the stats exported by traffic_server.
+class RecStatsShmReader
+{
+public:
+  struct Stat {
+    std::string name;
+    RecT rec_type;
+    RecDataT data_type;
+    RecData data;             ///< The value, unless it is a string.
+    std::string string_value; ///< The value of a RECD_STRING stat.
+  };
+
+  ~RecStatsShmReader();
+
+  /// Map the file at @a path. @return @c false if there is no valid file.
+  bool open(const char *path);
+  void close();
+
+  bool
+  is_open() const
+  {
+    return _header != nullptr;
+  }
+
+  /// Map the file again if a new traffic_server has replaced it. @return is_open()
+  bool refresh();
+
+  /// When traffic_server last wrote the values, in seconds since the epoch.
+  time_t updated() const;
+
+  /// The number of stats.
+  uint32_t count() const;
+
+  /// Read the stat in slot @a idx. @return @c false if there is no such stat or its value cannot be read.
+  bool read(uint32_t idx, Stat &stat) const;
+
+  /// Read the stat @a name. @return @c false if it is not exported.
+  bool find(std::string_view name, Stat &stat);
+
+private:
+  std::string _path;
+  ino_t _inode                     = 0;
+  size_t _size                     = 0;
+  const RecStatsShmHeader *_header = nullptr;
+  const RecStatsShmSlot *_slots    = nullptr;
+  std::unordered_map<std::string, uint32_t> _index; ///< The slot of each stat, up to _indexed.
+  uint32_t _indexed = 0;
+};
@@ -0,0 +1,104 @@
+/** @file
+
+  Histogram statistics.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "I_RecHistogram.h"
+
+#include <string>
+
+#include "P_RecCore.h"
+
+int64_t
+RecHistogram::bucket_bound(int bucket)
+{
+  if (bucket < LINEAR_BUCKETS) {
+    return bucket + 1;
+  }
+  if (bucket >= N_BUCKETS - 1) {
+    return INF_BOUND;
+  }
+  int exp = SUB_BITS + 1 + (bucket - LINEAR_BUCKETS) / SUB_BUCKETS;
+  int sub = (bucket - LINEAR_BUCKETS) % SUB_BUCKETS;
+  return (int64_t{1} << exp) + ((sub + 1) * (int64_t{1} << (exp - SUB_BITS)));
+}
+
+bool
+RecHistogram::init(RecT rec_type, const char *name)
+{
+  RecRawStatBlock *rsb = RecAllocateRawStatBlock(COUNT_ID + 1);
+
+  if (rsb == nullptr) {
+    Warning("cannot allocate the stats of histogram %s", name);
+    return false;
+  }
+
+  // The buckets are registered first and in order, so that they are synced before the stats that add them up.
+  for (int bucket = 0; bucket < N_BUCKETS; ++bucket) {
+    int64_t bound    = bucket_bound(bucket);
+    std::string stat = std::string{name} + ".bucket." + (bound == INF_BOUND ? std::string{"inf"} : std::to_string(bound));
+    if (RecRegisterRawStat(rsb, rec_type, stat.c_str(), RECD_INT, RECP_NON_PERSISTENT, bucket, sync_bucket) != REC_ERR_OKAY) {
+      return false;
+    }
+  }
+  if (RecRegisterRawStat(rsb, rec_type, (std::string{name} + ".sum").c_str(), RECD_INT, RECP_NON_PERSISTENT, SUM_ID,
+                         RecRawStatSyncSum) != REC_ERR_OKAY ||
+      RecRegisterRawStat(rsb, rec_type, (std::string{name} + ".count").c_str(), RECD_INT, RECP_NON_PERSISTENT, COUNT_ID,
+                         sync_count) != REC_ERR_OKAY) {
+    return false;
+  }
+
+  _rsb = rsb;
+  return true;
+}
+
+//-------------------------------------------------------------------------
+// RecHistogram::sync_bucket
+//
+// The value of a bucket is the number of values up to its bound, the sum of
+// its count and those of the buckets before it, which are synced first.
+//-------------------------------------------------------------------------
+int
+RecHistogram::sync_bucket(const char *name, RecDataT data_type, RecData *data, RecRawStatBlock *rsb, int id)
+{
+  int64_t total = 0;
+
+  RecRawStatSyncCount(name, data_type, data, rsb, id);
+  for (int bucket = 0; bucket <= id; ++bucket) {
+    total += rsb->global[bucket]->count;
+  }
+  RecDataSetFromInt64(data_type, data, total);
+
+  return REC_ERR_OKAY;
+}
+
+int
+RecHistogram::sync_count(const char * /* name */, RecDataT data_type, RecData *data, RecRawStatBlock *rsb, int /* id */)
+{
+  int64_t total = 0;
+
+  for (int bucket = 0; bucket < N_BUCKETS; ++bucket) {
+    total += rsb->global[bucket]->count;
+  }
+  RecDataSetFromInt64(data_type, data, total);
+
+  return REC_ERR_OKAY;
+}
@@ -0,0 +1,284 @@
+/** @file
+
+  Snapshot of the stats in the Prometheus text format.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "I_RecMetrics.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <mutex>
+#include <unordered_set>
+#include <vector>
+
+#include "tscore/ink_hrtime.h"
+#include "tscpp/util/TextView.h"
+#include "P_RecCore.h"
+
+namespace
+{
+// The snapshot is no longer formatted once it has not been scraped for this long.
+constexpr ink_hrtime SCRAPE_IDLE = HRTIME_MINUTES(5);
+
+constexpr std::string_view BUCKET_PART = ".bucket.";
+constexpr std::string_view VOLUME_PART = "volume_";
+
+std::atomic<ink_hrtime> last_scrape{0};
+
+// Formats a snapshot at a time.
+std::mutex format_mutex;
+
+// Never destroyed: the data would be freed to the allocator of a thread that is gone at exit.
+std::mutex snapshot_mutex;
+Ptr<IOBufferData> *snapshot = new Ptr<IOBufferData>;
+size_t snapshot_size_hint   = 0;
+
+struct Stat {
+  const char *name; ///< Records are never freed.
+  RecDataT data_type;
+  std::string value;
+};
+
+struct Sample {
+  std::string family;      ///< The metric name, shared by the samples of a histogram.
+  std::string_view suffix; ///< "_bucket", "_sum" or "_count" for a histogram.
+  std::string labels;
+  std::string value;
+  const char *type; ///< The Prometheus type, if it is known.
+};
+
+bool
+is_number(std::string_view text)
+{
+  return !text.empty() && std::all_of(text.begin(), text.end(), [](char c) { return isdigit(static_cast<unsigned char>(c)); });
+}
+
+// The histogram of a bucket named "<histogram>.bucket.N" and its bound N, or an empty name.
+std::string_view
+histogram_of(std::string_view name, std::string_view &bound)
+{
+  if (auto pos = name.rfind(BUCKET_PART); pos != name.npos) {
+    bound = name.substr(pos + BUCKET_PART.size());
+    if (bound == "inf" || is_number(bound)) {
+      return name.substr(0, pos);
+    }
+  }
+  return {};
+}
+
+void
+add_label(std::string &labels, std::string_view label, std::string_view value)
+{
+  if (!labels.empty()) {
+    labels += ',';
+  }
+  labels.append(label);
+  labels += "=\"";
+  labels.append(value);
+  labels += '"';
+}
+
+// Copy the stats, with their values formatted, holding the lock of each record only for that.
+std::vector<Stat>
+copy_stats()
+{
+  std::vector<Stat> stats;
+  int num_records = g_num_records;
+  char value[64];
+
+  stats.reserve(num_records);
+  for (int i = 0; i < num_records; i++) {
+    RecRecord *r = &(g_records[i]);
+    if (!REC_TYPE_IS_STAT(r->rec_type)) {
+      continue;
+    }
+
+    rec_mutex_acquire(&(r->lock));
+    switch (r->data_type) {
+    case RECD_INT:
+      snprintf(value, sizeof(value), "%" PRId64, r->data.rec_int);
+      break;
+    case RECD_COUNTER:
+      snprintf(value, sizeof(value), "%" PRId64, r->data.rec_counter);
+      break;
+    case RECD_FLOAT:
+      snprintf(value, sizeof(value), "%.9g", r->data.rec_float);
+      break;
+    default:
+      // strings are not metrics
+      value[0] = '\0';
+      break;
+    }
+    rec_mutex_release(&(r->lock));
+
+    if (value[0] != '\0') {
+      stats.push_back({r->name, r->data_type, value});
+    }
+  }
+
+  return stats;
+}
+
+Ptr<IOBufferData>
+format_snapshot()
+{
+  std::vector<Stat> stats = copy_stats();
+  std::unordered_set<std::string_view> histograms;
+  std::vector<Sample> samples;
+
+  // The histograms are those that have buckets, "<histogram>.bucket.N".
+  for (const Stat &stat : stats) {
+    std::string_view bound;
+    if (std::string_view histogram = histogram_of(stat.name, bound); !histogram.empty()) {
+      histograms.insert(histogram);
+    }
+  }
+
+  samples.reserve(stats.size());
+  for (Stat &stat : stats) {
+    std::string_view name{stat.name};
+    std::string_view bound;
+    std::string_view histogram = histogram_of(name, bound);
+    Sample sample{{}, {}, {}, std::move(stat.value), nullptr};
+    auto dot = name.rfind('.');
+
+    if (!histogram.empty()) {
+      sample.family = RecMetricsName(histogram, sample.labels);
+      sample.suffix = "_bucket";
+      sample.type   = "histogram";
+      add_label(sample.labels, "le", bound == "inf" ? "+Inf" : bound);
+    } else if (dot != name.npos && histograms.count(name.substr(0, dot)) &&
+               (name.substr(dot) == ".sum" || name.substr(dot) == ".count")) {
+      sample.family = RecMetricsName(name.substr(0, dot), sample.labels);
+      sample.suffix = name.substr(dot) == ".sum" ? "_sum" : "_count";
+      sample.type   = "histogram";
+    } else {
+      sample.family = RecMetricsName(name, sample.labels);
+      sample.type   = stat.data_type == RECD_COUNTER ? "counter" : nullptr;
+    }
+    samples.push_back(std::move(sample));
+  }
+
+  // The samples of a metric must be together, such as those of the volumes, and those of a histogram stay in their order.
+  std::stable_sort(samples.begin(), samples.end(), [](const Sample &lhs, const Sample &rhs) { return lhs.family < rhs.family; });
+
+  std::string text;
+  std::string_view family;
+
+  text.reserve(snapshot_size_hint);
+  for (const Sample &sample : samples) {
+    if (sample.family != family) {
+      family = sample.family;
+      if (sample.type) {
+        text += "# TYPE ";
+        text += sample.family;
+        text += ' ';
+        text += sample.type;
+        text += '\n';
+      }
+    }
+    text += sample.family;
+    text.append(sample.suffix);
+    if (!sample.labels.empty()) {
+      text += '{';
+      text += sample.labels;
+      text += '}';
+    }
+    text += ' ';
+    text += sample.value;
+    text += '\n';
+  }
+
+  Debug("stats", "formatted the metrics of %zu stats in %zu bytes", stats.size(), text.size());
+  if (text.empty()) {
+    return Ptr<IOBufferData>{};
+  }
+  snapshot_size_hint = text.size();
+
+  char *buf = static_cast<char *>(ats_malloc(text.size()));
+  memcpy(buf, text.data(), text.size());
+  return Ptr<IOBufferData>{new_xmalloc_IOBufferData(buf, text.size())};
+}
+
+Ptr<IOBufferData>
+update_snapshot()
+{
+  std::lock_guard<std::mutex> format_lock(format_mutex);
+  Ptr<IOBufferData> data = format_snapshot();
+
+  std::lock_guard<std::mutex> lock(snapshot_mutex);
+  *snapshot = data;
+  return data;
+}
+} // namespace
+
+std::string
+RecMetricsName(std::string_view name, std::string &labels)
+{
+  ts::TextView text{name};
+  std::string metric;
+
+  metric.reserve(name.size());
+  while (text) {
+    ts::TextView part = text.take_prefix_at('.');
+    if (part.substr(0, VOLUME_PART.size()) == VOLUME_PART && is_number(part.substr(VOLUME_PART.size()))) {
+      add_label(labels, "volume", part.substr(VOLUME_PART.size()));
+      continue;
+    }
+    if (!metric.empty()) {
+      metric += '_';
+    }
+    for (char c : part) {
+      metric += (isalnum(static_cast<unsigned char>(c)) || c == ':') ? c : '_';
+    }
+  }
+  if (!metric.empty() && isdigit(static_cast<unsigned char>(metric[0]))) {
+    metric.insert(0, 1, '_');
+  }
+
+  return metric;
+}
+
+Ptr<IOBufferData>
+RecMetricsSnapshot()
+{
+  last_scrape = ink_get_hrtime_internal();
+  {
+    std::lock_guard<std::mutex> lock(snapshot_mutex);
+    if (*snapshot) {
+      return *snapshot;
+    }
+  }
+  return update_snapshot();
+}
+
+void
+RecMetricsUpdate()
+{
+  if (ink_get_hrtime_internal() - last_scrape > SCRAPE_IDLE) {
+    // nobody scrapes, the snapshot would only get staler
+    std::lock_guard<std::mutex> lock(snapshot_mutex);
+    snapshot->clear();
+    return;
+  }
+  update_snapshot();
+}
@@ -32,6 +32,8 @@
 #include "P_RecMessage.h"
 #include "P_RecUtils.h"
 #include "P_RecFile.h"
+#include "I_RecMetrics.h"
+#include "I_RecStatsShm.h"
 
 #include "mgmtapi.h"
 #include "ProcessManager.h"
@@ -144,6 +146,8 @@ struct raw_stat_sync_cont : public Continuation {
   exec_callbacks(int /* event */, Event * /* e */)
   {
     RecExecRawStatSyncCbs();
+    RecMetricsUpdate();
+    RecStatsShmUpdate();
     Debug("statsproc", "raw_stat_sync_cont() processed");
 
     return EVENT_CONT;
@@ -24,6 +24,7 @@
 #include "P_RecCore.h"
 #include "P_RecProcess.h"
 #include <string_view>
+#include <atomic>
 
 //-------------------------------------------------------------------------
 // raw_stat_get_total
@@ -32,35 +33,69 @@
 namespace
 {
 // Commonly used access to a raw stat, avoid typos.
-inline RecRawStat *
+inline RecRawStatSlice *
 thread_stat(EThread *et, RecRawStatBlock *rsb, int id)
 {
-  return (reinterpret_cast<RecRawStat *>(reinterpret_cast<char *>(et) + rsb->ethr_stat_offset)) + id;
+  return (reinterpret_cast<RecRawStatSlice *>(reinterpret_cast<char *>(et) + rsb->ethr_stat_offset)) + id;
 }
-} // namespace
-
-static int
-raw_stat_get_total(RecRawStatBlock *rsb, int id, RecRawStat *total)
-{
-  total->sum   = 0;
-  total->count = 0;
 
-  // get global values
-  total->sum   = rsb->global[id]->sum;
-  total->count = rsb->global[id]->count;
+// Number of the sync pass run by RecExecRawStatSyncCbs, 0 on the threads not running one.
+std::atomic<unsigned> sync_passes{0};
+thread_local unsigned current_sync_pass = 0;
 
-  // get thread local values
+void
+raw_stat_add_threads(RecRawStatBlock *rsb, int id, RecRawStatSlice *total)
+{
   for (EThread *et : eventProcessor.active_ethreads()) {
-    RecRawStat *tlp = thread_stat(et, rsb, id);
+    RecRawStatSlice *tlp = thread_stat(et, rsb, id);
     total->sum += tlp->sum;
     total->count += tlp->count;
   }
 
   for (EThread *et : eventProcessor.active_dthreads()) {
-    RecRawStat *tlp = thread_stat(et, rsb, id);
+    RecRawStatSlice *tlp = thread_stat(et, rsb, id);
     total->sum += tlp->sum;
     total->count += tlp->count;
   }
+}
+
+// Sum the thread local values of all the stats of the block into its totals for this sync pass.
+// A thread at a time, its slice of the block is read in order, rather than going through
+// every thread for each stat.
+void
+raw_stat_sum_block(RecRawStatBlock *rsb, int num_stats)
+{
+  RecRawStatSlice *totals = rsb->totals;
+  memset(totals, 0, num_stats * sizeof(RecRawStatSlice));
+
+  auto add = [&](EThread *et) {
+    const RecRawStatSlice *slice = thread_stat(et, rsb, 0);
+    for (int id = 0; id < num_stats; ++id) {
+      totals[id].sum += slice[id].sum;
+      totals[id].count += slice[id].count;
+    }
+  };
+
+  for (EThread *et : eventProcessor.active_ethreads()) {
+    add(et);
+  }
+  for (EThread *et : eventProcessor.active_dthreads()) {
+    add(et);
+  }
+}
+} // namespace
+
+static int
+raw_stat_get_total(RecRawStatBlock *rsb, int id, RecRawStat *total)
+{
+  RecRawStatSlice local = {0, 0};
+
+  // get thread local values
+  raw_stat_add_threads(rsb, id, &local);
+
+  // and add the global values
+  total->sum   = rsb->global[id]->sum + local.sum;
+  total->count = rsb->global[id]->count + local.count;
 
   if (total->sum < 0) { // Assure that we stay positive
     total->sum = 0;
@@ -75,45 +110,34 @@ raw_stat_get_total(RecRawStatBlock *rsb, int id, RecRawStat *total)
 static int
 raw_stat_sync_to_global(RecRawStatBlock *rsb, int id)
 {
-  RecRawStat total;
+  RecRawStatSlice total = {0, 0};
 
-  total.sum   = 0;
-  total.count = 0;
-
-  // sum the thread local values
-  for (EThread *et : eventProcessor.active_ethreads()) {
-    RecRawStat *tlp = thread_stat(et, rsb, id);
-    total.sum += tlp->sum;
-    total.count += tlp->count;
+  // sum the thread local values, all those of the block at once during a sync pass
+  if (current_sync_pass != 0 && rsb->totals_pass != current_sync_pass) {
+    rsb->totals_num = rsb->num_stats;
+    raw_stat_sum_block(rsb, rsb->totals_num);
+    rsb->totals_pass = current_sync_pass;
   }
-
-  for (EThread *et : eventProcessor.active_dthreads()) {
-    RecRawStat *tlp = thread_stat(et, rsb, id);
-    total.sum += tlp->sum;
-    total.count += tlp->count;
+  if (current_sync_pass != 0 && id < rsb->totals_num) {
+    total = rsb->totals[id];
+  } else {
+    raw_stat_add_threads(rsb, id, &total);
   }
 
   if (total.sum < 0) { // Assure that we stay positive
     total.sum = 0;
   }
 
-  // lock so the setting of the globals and last values are atomic
-  {
-    ink_scoped_mutex_lock lock(rsb->mutex);
+  // Swapping in the new totals as the last values seen gives the delta from the last sync, so
+  // concurrent syncs each add their own part of it and the globals need no lock.
+  RecRawStat *global = rsb->global[id];
 
-    // get the delta from the last sync
-    RecRawStat delta;
-    delta.sum   = total.sum - rsb->global[id]->last_sum;
-    delta.count = total.count - rsb->global[id]->last_count;
+  int64_t last_sum   = ink_atomic_swap(&(global->last_sum), total.sum);
+  int64_t last_count = ink_atomic_swap(&(global->last_count), total.count);
 
-    // increment the global values by the delta
-    ink_atomic_increment(&(rsb->global[id]->sum), delta.sum);
-    ink_atomic_increment(&(rsb->global[id]->count), delta.count);
-
-    // set the new totals as the last values seen
-    ink_atomic_swap(&(rsb->global[id]->last_sum), total.sum);
-    ink_atomic_swap(&(rsb->global[id]->last_count), total.count);
-  }
+  // increment the global values by the delta
+  ink_atomic_increment(&(global->sum), total.sum - last_sum);
+  ink_atomic_increment(&(global->count), total.count - last_count);
 
   return REC_ERR_OKAY;
 }
@@ -127,23 +151,20 @@ raw_stat_clear(RecRawStatBlock *rsb, int id)
   Debug("stats", "raw_stat_clear(): rsb pointer:%p id:%d", rsb, id);
 
   // the globals need to be reset too
-  // lock so the setting of the globals and last values are atomic
-  {
-    ink_scoped_mutex_lock lock(rsb->mutex);
-    ink_atomic_swap(&(rsb->global[id]->sum), static_cast<int64_t>(0));
-    ink_atomic_swap(&(rsb->global[id]->last_sum), static_cast<int64_t>(0));
-    ink_atomic_swap(&(rsb->global[id]->count), static_cast<int64_t>(0));
-    ink_atomic_swap(&(rsb->global[id]->last_count), static_cast<int64_t>(0));
-  }
+  ink_atomic_swap(&(rsb->global[id]->sum), static_cast<int64_t>(0));
+  ink_atomic_swap(&(rsb->global[id]->last_sum), static_cast<int64_t>(0));
+  ink_atomic_swap(&(rsb->global[id]->count), static_cast<int64_t>(0));
+  ink_atomic_swap(&(rsb->global[id]->last_count), static_cast<int64_t>(0));
+
   // reset the local stats
   for (EThread *et : eventProcessor.active_ethreads()) {
-    RecRawStat *tlp = thread_stat(et, rsb, id);
+    RecRawStatSlice *tlp = thread_stat(et, rsb, id);
     ink_atomic_swap(&(tlp->sum), static_cast<int64_t>(0));
     ink_atomic_swap(&(tlp->count), static_cast<int64_t>(0));
   }
 
   for (EThread *et : eventProcessor.active_dthreads()) {
-    RecRawStat *tlp = thread_stat(et, rsb, id);
+    RecRawStatSlice *tlp = thread_stat(et, rsb, id);
     ink_atomic_swap(&(tlp->sum), static_cast<int64_t>(0));
     ink_atomic_swap(&(tlp->count), static_cast<int64_t>(0));
   }
@@ -160,21 +181,17 @@ raw_stat_clear_sum(RecRawStatBlock *rsb, int id)
   Debug("stats", "raw_stat_clear_sum(): rsb pointer:%p id:%d", rsb, id);
 
   // the globals need to be reset too
-  // lock so the setting of the globals and last values are atomic
-  {
-    ink_scoped_mutex_lock lock(rsb->mutex);
-    ink_atomic_swap(&(rsb->global[id]->sum), static_cast<int64_t>(0));
-    ink_atomic_swap(&(rsb->global[id]->last_sum), static_cast<int64_t>(0));
-  }
+  ink_atomic_swap(&(rsb->global[id]->sum), static_cast<int64_t>(0));
+  ink_atomic_swap(&(rsb->global[id]->last_sum), static_cast<int64_t>(0));
 
   // reset the local stats
   for (EThread *et : eventProcessor.active_ethreads()) {
-    RecRawStat *tlp = thread_stat(et, rsb, id);
+    RecRawStatSlice *tlp = thread_stat(et, rsb, id);
     ink_atomic_swap(&(tlp->sum), static_cast<int64_t>(0));
   }
 
   for (EThread *et : eventProcessor.active_dthreads()) {
-    RecRawStat *tlp = thread_stat(et, rsb, id);
+    RecRawStatSlice *tlp = thread_stat(et, rsb, id);
     ink_atomic_swap(&(tlp->sum), static_cast<int64_t>(0));
   }
 
@@ -190,21 +207,17 @@ raw_stat_clear_count(RecRawStatBlock *rsb, int id)
   Debug("stats", "raw_stat_clear_count(): rsb pointer:%p id:%d", rsb, id);
 
   // the globals need to be reset too
-  // lock so the setting of the globals and last values are atomic
-  {
-    ink_scoped_mutex_lock lock(rsb->mutex);
-    ink_atomic_swap(&(rsb->global[id]->count), static_cast<int64_t>(0));
-    ink_atomic_swap(&(rsb->global[id]->last_count), static_cast<int64_t>(0));
-  }
+  ink_atomic_swap(&(rsb->global[id]->count), static_cast<int64_t>(0));
+  ink_atomic_swap(&(rsb->global[id]->last_count), static_cast<int64_t>(0));
 
   // reset the local stats
   for (EThread *et : eventProcessor.active_ethreads()) {
-    RecRawStat *tlp = thread_stat(et, rsb, id);
+    RecRawStatSlice *tlp = thread_stat(et, rsb, id);
     ink_atomic_swap(&(tlp->count), static_cast<int64_t>(0));
   }
 
   for (EThread *et : eventProcessor.active_dthreads()) {
-    RecRawStat *tlp = thread_stat(et, rsb, id);
+    RecRawStatSlice *tlp = thread_stat(et, rsb, id);
     ink_atomic_swap(&(tlp->count), static_cast<int64_t>(0));
   }
 
@@ -220,8 +233,8 @@ RecAllocateRawStatBlock(int num_stats)
   off_t ethr_stat_offset;
   RecRawStatBlock *rsb;
 
-  // allocate thread-local raw-stat memory
-  if ((ethr_stat_offset = eventProcessor.allocate(num_stats * sizeof(RecRawStat))) == -1) {
+  // allocate thread-local raw-stat memory, only the parts the threads update
+  if ((ethr_stat_offset = eventProcessor.allocate(num_stats * sizeof(RecRawStatSlice))) == -1) {
     return nullptr;
   }
 
@@ -232,11 +245,15 @@ RecAllocateRawStatBlock(int num_stats)
   rsb->global = static_cast<RecRawStat **>(ats_malloc(num_stats * sizeof(RecRawStat *)));
   memset(rsb->global, 0, num_stats * sizeof(RecRawStat *));
 
+  rsb->totals = static_cast<RecRawStatSlice *>(ats_malloc(num_stats * sizeof(RecRawStatSlice)));
+  memset(rsb->totals, 0, num_stats * sizeof(RecRawStatSlice));
+
   rsb->num_stats        = 0;
   rsb->max_stats        = num_stats;
   rsb->ethr_stat_offset = ethr_stat_offset;
+  rsb->totals_num       = 0;
+  rsb->totals_pass      = 0;
 
-  ink_mutex_init(&(rsb->mutex));
   return rsb;
 }
 
@@ -276,6 +293,10 @@ _RecRegisterRawStat(RecRawStatBlock *rsb, RecT rec_type, const char *name, RecDa
   rsb->global[id]->last_sum   = 0;
   rsb->global[id]->last_count = 0;
 
+  // the sync passes sum the block up to the highest id registered
+  for (int num = rsb->num_stats; num <= id && !ink_atomic_cas(&rsb->num_stats, num, id + 1); num = rsb->num_stats) {
+  }
+
   // setup the periodic sync callback
   if (sync_cb) {
     RecRegisterRawStatSyncCb(name, sync_cb, rsb, id);
@@ -550,6 +571,12 @@ RecExecRawStatSyncCbs()
   RecRecord *r;
   int i, num_records;
 
+  // The stats of a block are summed from the threads once for the pass, when the first of them is
+  // synced. There is only one thread running the passes, which owns the totals of the blocks.
+  do {
+    current_sync_pass = ++sync_passes;
+  } while (current_sync_pass == 0);
+
   num_records = g_num_records;
   for (i = 0; i < num_records; i++) {
     r = &(g_records[i]);
@@ -567,6 +594,7 @@ RecExecRawStatSyncCbs()
     }
     rec_mutex_release(&(r->lock));
   }
+  current_sync_pass = 0;
 
   return REC_ERR_OKAY;
 }
@@ -0,0 +1,344 @@
+/** @file
+
+  Export of the stats in shared memory.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "I_RecStatsShm.h"
+
+#include <algorithm>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "P_RecCore.h"
+#include "P_RecUtils.h"
+
+extern int max_records_entries;
+
+namespace
+{
+// A reader gives up on a value that stays odd this many times, the writer died while writing it.
+constexpr int READ_RETRIES = 1000;
+
+struct Export {
+  int record; ///< The index of the stat in g_records.
+  uint32_t slot;
+};
+
+// Only the raw stat sync writes the file.
+RecStatsShmHeader *shm_header = nullptr;
+RecStatsShmSlot *shm_slots    = nullptr;
+std::vector<Export> exports;
+int scanned_records = 0; // the records up to here have been given a slot, or left out
+
+// Give a slot to each stat that was registered since the last update.
+void
+add_stats(int num_records)
+{
+  uint32_t count = shm_header->count.load(std::memory_order_relaxed);
+
+  for (; scanned_records < num_records; ++scanned_records) {
+    RecRecord *r = &(g_records[scanned_records]);
+    if (!REC_TYPE_IS_STAT(r->rec_type)) {
+      continue;
+    }
+
+    size_t len = strlen(r->name);
+    if (len > REC_STATS_SHM_NAME_MAX) {
+      Warning("stat %s is not exported to shared memory, its name is longer than %zu", r->name, REC_STATS_SHM_NAME_MAX);
+      continue;
+    }
+    if (count >= shm_header->capacity) {
+      Warning("stat %s is not exported to shared memory, there are no slots left", r->name);
+      continue;
+    }
+
+    RecStatsShmSlot &slot = shm_slots[count];
+    slot.rec_type         = r->rec_type;
+    slot.data_type        = r->data_type;
+    slot.name_len         = len;
+    memcpy(slot.name, r->name, len + 1);
+    exports.push_back({scanned_records, count++});
+  }
+
+  // publish the names and types before the slots are counted
+  shm_header->count.store(count, std::memory_order_release);
+}
+
+void
+copy_value(RecRecord *r, RecStatsShmValue &value)
+{
+  memset(&value, 0, sizeof(value));
+
+  rec_mutex_acquire(&(r->lock));
+  switch (r->data_type) {
+  case RECD_INT:
+    value.rec_int = r->data.rec_int;
+    break;
+  case RECD_COUNTER:
+    value.rec_counter = r->data.rec_counter;
+    break;
+  case RECD_FLOAT:
+    value.rec_float = r->data.rec_float;
+    break;
+  case RECD_STRING:
+    if (r->data.rec_string) {
+      ink_strlcpy(value.rec_string, r->data.rec_string, sizeof(value.rec_string));
+    }
+    break;
+  default:
+    break;
+  }
+  rec_mutex_release(&(r->lock));
+}
+} // namespace
+
+bool
+RecStatsShmInit(const char *path)
+{
+  uint32_t capacity = max_records_entries;
+  size_t size       = sizeof(RecStatsShmHeader) + capacity * sizeof(RecStatsShmSlot);
+  std::string tmp   = std::string{path} + ".tmp";
+
+  // The file is written aside and renamed, the mapping of a reader of the previous traffic_server stays valid.
+  int fd = ::open(tmp.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0640);
+  if (fd < 0) {
+    Warning("cannot create %s to export the stats: %s", tmp.c_str(), strerror(errno));
+    return false;
+  }
+  if (ftruncate(fd, size) < 0) {
+    Warning("cannot size %s to export the stats: %s", tmp.c_str(), strerror(errno));
+    ::close(fd);
+    unlink(tmp.c_str());
+    return false;
+  }
+
+  void *mem = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (mem == MAP_FAILED) {
+    Warning("cannot map %s to export the stats: %s", tmp.c_str(), strerror(errno));
+    unlink(tmp.c_str());
+    return false;
+  }
+
+  // The file is new, its pages are zero.
+  shm_header            = static_cast<RecStatsShmHeader *>(mem);
+  shm_slots             = reinterpret_cast<RecStatsShmSlot *>(shm_header + 1);
+  shm_header->version   = REC_STATS_SHM_VERSION;
+  shm_header->slot_size = sizeof(RecStatsShmSlot);
+  shm_header->capacity  = capacity;
+  shm_header->pid       = getpid();
+  std::atomic_thread_fence(std::memory_order_release);
+  shm_header->magic = REC_STATS_SHM_MAGIC;
+
+  if (rename(tmp.c_str(), path) < 0) {
+    Warning("cannot rename %s to %s to export the stats: %s", tmp.c_str(), path, strerror(errno));
+    munmap(mem, size);
+    unlink(tmp.c_str());
+    shm_header = nullptr;
+    shm_slots  = nullptr;
+    return false;
+  }
+
+  Note("exporting the stats to %s", path);
+  return true;
+}
+
+void
+RecStatsShmUpdate()
+{
+  if (shm_header == nullptr) {
+    return;
+  }
+
+  add_stats(g_num_records);
+
+  for (const Export &e : exports) {
+    RecStatsShmSlot &slot = shm_slots[e.slot];
+    RecStatsShmValue value;
+
+    copy_value(&(g_records[e.record]), value);
+    // most stats do not change between syncs, the readers of those never retry
+    if (memcmp(&value, &slot.value, sizeof(value)) == 0) {
+      continue;
+    }
+
+    uint32_t seq = slot.seq.load(std::memory_order_relaxed);
+    slot.seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    memcpy(&slot.value, &value, sizeof(value));
+    slot.seq.store(seq + 2, std::memory_order_release);
+  }
+
+  shm_header->updated.store(time(nullptr), std::memory_order_relaxed);
+}
+
+RecStatsShmReader::~RecStatsShmReader()
+{
+  close();
+}
+
+bool
+RecStatsShmReader::open(const char *path)
+{
+  struct stat st;
+
+  close();
+  _path = path;
+
+  int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return false;
+  }
+  if (fstat(fd, &st) < 0 || static_cast<size_t>(st.st_size) < sizeof(RecStatsShmHeader)) {
+    ::close(fd);
+    return false;
+  }
+
+  void *mem = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (mem == MAP_FAILED) {
+    return false;
+  }
+
+  auto header = static_cast<const RecStatsShmHeader *>(mem);
+  if (header->magic != REC_STATS_SHM_MAGIC || header->version != REC_STATS_SHM_VERSION ||
+      header->slot_size != sizeof(RecStatsShmSlot) ||
+      sizeof(RecStatsShmHeader) + header->capacity * sizeof(RecStatsShmSlot) > static_cast<size_t>(st.st_size)) {
+    munmap(mem, st.st_size);
+    return false;
+  }
+
+  _inode  = st.st_ino;
+  _size   = st.st_size;
+  _header = header;
+  _slots  = reinterpret_cast<const RecStatsShmSlot *>(header + 1);
+  return true;
+}
+
+void
+RecStatsShmReader::close()
+{
+  if (_header) {
+    munmap(const_cast<RecStatsShmHeader *>(_header), _size);
+  }
+  _header  = nullptr;
+  _slots   = nullptr;
+  _inode   = 0;
+  _size    = 0;
+  _indexed = 0;
+  _index.clear();
+}
+
+bool
+RecStatsShmReader::refresh()
+{
+  struct stat st;
+
+  if (_path.empty()) {
+    return false;
+  }
+  if (!is_open() || stat(_path.c_str(), &st) < 0 || st.st_ino != _inode) {
+    std::string path{_path};
+    open(path.c_str());
+  }
+  return is_open();
+}
+
+time_t
+RecStatsShmReader::updated() const
+{
+  return _header ? _header->updated.load(std::memory_order_relaxed) : 0;
+}
+
+uint32_t
+RecStatsShmReader::count() const
+{
+  return _header ? std::min(_header->count.load(std::memory_order_acquire), _header->capacity) : 0;
+}
+
+bool
+RecStatsShmReader::read(uint32_t idx, Stat &stat) const
+{
+  if (idx >= count()) {
+    return false;
+  }
+
+  const RecStatsShmSlot &slot = _slots[idx];
+  RecStatsShmValue value;
+  int retries = 0;
+
+  for (;; ++retries) {
+    if (retries == READ_RETRIES) {
+      return false;
+    }
+    uint32_t seq = slot.seq.load(std::memory_order_acquire);
+    if (seq & 1) {
+      continue;
+    }
+    memcpy(&value, const_cast<RecStatsShmValue *>(&slot.value), sizeof(value));
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.seq.load(std::memory_order_relaxed) == seq) {
+      break;
+    }
+  }
+
+  stat.name.assign(slot.name, std::min<size_t>(slot.name_len, REC_STATS_SHM_NAME_MAX));
+  stat.rec_type     = static_cast<RecT>(slot.rec_type);
+  stat.data_type    = static_cast<RecDataT>(slot.data_type);
+  stat.data.rec_int = 0;
+  stat.string_value.clear();
+  switch (stat.data_type) {
+  case RECD_INT:
+    stat.data.rec_int = value.rec_int;
+    break;
+  case RECD_COUNTER:
+    stat.data.rec_counter = value.rec_counter;
+    break;
+  case RECD_FLOAT:
+    stat.data.rec_float = value.rec_float;
+    break;
+  case RECD_STRING:
+    value.rec_string[REC_STATS_SHM_STRING_MAX] = '\0';
+    stat.string_value                          = value.rec_string;
+    break;
+  default:
+    break;
+  }
+
+  return true;
+}
+
+bool
+RecStatsShmReader::find(std::string_view name, Stat &stat)
+{
+  // The slots never move, only the new ones need to be indexed.
+  for (uint32_t n = count(); _indexed < n; ++_indexed) {
+    const RecStatsShmSlot &slot = _slots[_indexed];
+    _index.emplace(std::string{slot.name, std::min<size_t>(slot.name_len, REC_STATS_SHM_NAME_MAX)}, _indexed);
+  }
+
+  auto spot = _index.find(std::string{name});
+  return spot != _index.end() && read(spot->second, stat);
+}
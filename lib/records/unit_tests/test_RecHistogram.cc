@@ -0,0 +1,73 @@
+/** @file
+
+  Unit tests for the buckets of RecHistogram.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "catch.hpp"
+
+#include "records/I_RecHistogram.h"
+
+TEST_CASE("RecHistogram buckets", "[librecords][RecHistogram]")
+{
+  CHECK(RecHistogram::N_BUCKETS == 65);
+
+  SECTION("small values have a bucket each")
+  {
+    CHECK(RecHistogram::bucket_of(0) == 0);
+    CHECK(RecHistogram::bucket_of(1) == 0);
+    CHECK(RecHistogram::bucket_of(2) == 1);
+    CHECK(RecHistogram::bucket_of(8) == 7);
+    CHECK(RecHistogram::bucket_bound(7) == 8);
+  }
+
+  SECTION("larger values are split in four for each power of two")
+  {
+    CHECK(RecHistogram::bucket_of(9) == 8);
+    CHECK(RecHistogram::bucket_of(10) == 8);
+    CHECK(RecHistogram::bucket_of(11) == 9);
+    CHECK(RecHistogram::bucket_of(16) == 11);
+    CHECK(RecHistogram::bucket_of(17) == 12);
+    CHECK(RecHistogram::bucket_bound(8) == 10);
+    CHECK(RecHistogram::bucket_bound(11) == 16);
+    CHECK(RecHistogram::bucket_bound(12) == 20);
+    CHECK(RecHistogram::bucket_bound(RecHistogram::N_BUCKETS - 2) == 131072);
+  }
+
+  SECTION("values past the largest bound")
+  {
+    CHECK(RecHistogram::bucket_of(131072) == RecHistogram::N_BUCKETS - 2);
+    CHECK(RecHistogram::bucket_of(131073) == RecHistogram::N_BUCKETS - 1);
+    CHECK(RecHistogram::bucket_of(INT64_MAX) == RecHistogram::N_BUCKETS - 1);
+    CHECK(RecHistogram::bucket_bound(RecHistogram::N_BUCKETS - 1) == RecHistogram::INF_BOUND);
+  }
+
+  SECTION("every value is counted in the first bucket whose bound is not below it")
+  {
+    int64_t lower = 0;
+    for (int bucket = 0; bucket < RecHistogram::N_BUCKETS - 1; ++bucket) {
+      int64_t bound = RecHistogram::bucket_bound(bucket);
+      REQUIRE(bound > lower);
+      CHECK(RecHistogram::bucket_of(lower + 1) == bucket);
+      CHECK(RecHistogram::bucket_of(bound) == bucket);
+      lower = bound;
+    }
+  }
+}
@@ -0,0 +1,55 @@
+/** @file
+
+  Unit tests for the metric names of the stats.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "catch.hpp"
+
+#include "records/I_RecMetrics.h"
+
+TEST_CASE("RecMetricsName", "[librecords][RecMetrics]")
+{
+  std::string labels;
+
+  CHECK(RecMetricsName("proxy.process.http.incoming_requests", labels) == "proxy_process_http_incoming_requests");
+  CHECK(labels.empty());
+
+  CHECK(RecMetricsName("plugin.my-plugin.hits/s", labels) == "plugin_my_plugin_hits_s");
+  CHECK(RecMetricsName("3rd.party", labels) == "_3rd_party");
+  CHECK(labels.empty());
+
+  SECTION("volumes are labels")
+  {
+    CHECK(RecMetricsName("proxy.process.cache.volume_1.bytes_used", labels) == "proxy_process_cache_bytes_used");
+    CHECK(labels == "volume=\"1\"");
+
+    labels = "le=\"10\"";
+    CHECK(RecMetricsName("proxy.process.cache.volume_12.span.read_ms", labels) == "proxy_process_cache_span_read_ms");
+    CHECK(labels == "le=\"10\",volume=\"12\"");
+  }
+
+  SECTION("only numbered volumes")
+  {
+    CHECK(RecMetricsName("proxy.process.cache.volume_.bytes", labels) == "proxy_process_cache_volume__bytes");
+    CHECK(RecMetricsName("proxy.process.cache.volume_all.bytes", labels) == "proxy_process_cache_volume_all_bytes");
+    CHECK(labels.empty());
+  }
+}
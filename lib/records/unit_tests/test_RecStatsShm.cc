@@ -0,0 +1,78 @@
+/** @file
+
+  Unit tests for the export of the stats in shared memory.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "catch.hpp"
+
+#include <string>
+#include <unistd.h>
+
+#include "records/I_RecProcess.h"
+#include "records/I_RecStatsShm.h"
+
+TEST_CASE("RecStatsShm", "[librecords][RecStatsShm]")
+{
+  std::string path = "/tmp/test_RecStatsShm." + std::to_string(getpid());
+  RecStatsShmReader reader;
+  RecStatsShmReader::Stat stat;
+
+  REQUIRE(RecProcessInit(RECM_CLIENT, nullptr) == REC_ERR_OKAY);
+  RecRegisterStatInt(RECT_PROCESS, "test.shm.int", 7, RECP_NON_PERSISTENT);
+  RecRegisterStatFloat(RECT_PROCESS, "test.shm.float", 0.5, RECP_NON_PERSISTENT);
+  RecRegisterStatString(RECT_PROCESS, "test.shm.string", const_cast<char *>("ats"), RECP_NON_PERSISTENT);
+
+  CHECK_FALSE(reader.open(path.c_str()));
+  REQUIRE(RecStatsShmInit(path.c_str()));
+  RecStatsShmUpdate();
+
+  REQUIRE(reader.open(path.c_str()));
+  CHECK(reader.count() == 3);
+  CHECK(reader.updated() > 0);
+
+  REQUIRE(reader.find("test.shm.int", stat));
+  CHECK(stat.rec_type == RECT_PROCESS);
+  CHECK(stat.data_type == RECD_INT);
+  CHECK(stat.data.rec_int == 7);
+  REQUIRE(reader.find("test.shm.float", stat));
+  CHECK(stat.data.rec_float == 0.5);
+  REQUIRE(reader.find("test.shm.string", stat));
+  CHECK(stat.string_value == "ats");
+  CHECK_FALSE(reader.find("test.shm.none", stat));
+
+  SECTION("values and new stats show up at the next update")
+  {
+    RecSetRecordInt("test.shm.int", 42, REC_SOURCE_EXPLICIT);
+    RecRegisterStatInt(RECT_PROCESS, "test.shm.new", 1, RECP_NON_PERSISTENT);
+    CHECK(reader.find("test.shm.int", stat));
+    CHECK(stat.data.rec_int == 7);
+    CHECK_FALSE(reader.find("test.shm.new", stat));
+
+    RecStatsShmUpdate();
+    CHECK(reader.refresh());
+    CHECK(reader.count() == 4);
+    REQUIRE(reader.find("test.shm.int", stat));
+    CHECK(stat.data.rec_int == 42);
+    CHECK(reader.find("test.shm.new", stat));
+  }
+
+  unlink(path.c_str());
+}
@@ -29,6 +29,39 @@
 
 ConfigProcessor configProcessor;
 
+namespace
+{
+// How often a replaced configuration that is still referenced is looked at again.
+constexpr ink_hrtime CONFIG_RECLAIM_RETRY = HRTIME_SECONDS(1);
+
+std::atomic<int> config_readers{0};
+
+// The counter of this thread in each ConfigInfo, or -1 if it uses the shared reference count.
+thread_local int config_reader = -2;
+
+int
+config_reader_index()
+{
+  if (config_reader == -2) {
+    // Only the event threads get a counter, they are few and live as long as the process.
+    int idx       = this_ethread() ? config_readers++ : MAX_CONFIG_READERS;
+    config_reader = idx < MAX_CONFIG_READERS ? idx : -1;
+  }
+  return config_reader;
+}
+} // namespace
+
+int64_t
+ConfigInfo::references() const
+{
+  int64_t sum = this->refcount();
+
+  for (const Reader &reader : m_readers) {
+    sum += reader.count.load(std::memory_order_acquire);
+  }
+  return sum;
+}
+
 void *
 config_int_cb(void *data, void *value)
 {
@@ -99,9 +132,12 @@ public:
   }
 
   int
-  handle_event(int /* event ATS_UNUSED */, void * /* edata ATS_UNUSED */)
+  handle_event(int /* event ATS_UNUSED */, void *edata)
   {
-    configProcessor.release(m_id, m_info);
+    if (!configProcessor.reclaim(m_id, m_info)) {
+      static_cast<Event *>(edata)->schedule_in(CONFIG_RECLAIM_RETRY);
+      return EVENT_CONT;
+    }
     delete this;
     return EVENT_DONE;
   }
@@ -126,10 +162,9 @@ ConfigProcessor::set(unsigned int id, ConfigInfo *info, unsigned timeout_secs)
   // Don't be an idiot and use a zero timeout ...
   ink_assert(timeout_secs > 0);
 
-  // New objects *must* start with a zero refcount. The config
-  // processor holds it's own refcount. We should be the only
-  // refcount holder at this point.
-  ink_release_assert(info->refcount_inc() == 1);
+  // New objects *must* start without references. The config
+  // processor's own reference is being installed in the index.
+  ink_release_assert(info->references() == 0);
 
   if (id > MAX_CONFIGS) {
     // invalid index
@@ -140,13 +175,11 @@ ConfigProcessor::set(unsigned int id, ConfigInfo *info, unsigned timeout_secs)
   idx      = id - 1;
   old_info = infos[idx].exchange(info);
 
-  Debug("config", "Set for slot %d 0x%" PRId64 " was 0x%" PRId64 " with ref count %d", id, (int64_t)info, (int64_t)old_info,
-        (old_info) ? old_info->refcount() : 0);
+  Debug("config", "Set for slot %d 0x%" PRId64 " was 0x%" PRId64, id, (int64_t)info, (int64_t)old_info);
 
   if (old_info) {
-    // The ConfigInfoReleaser now takes our refcount, but
-    // some other thread might also have one ...
-    ink_assert(old_info->refcount() > 0);
+    // The ConfigInfoReleaser deletes it once the threads that
+    // loaded it before the exchange have released it.
     eventProcessor.schedule_in(new ConfigInfoReleaser(id, old_info), HRTIME_SECONDS(timeout_secs));
   }
 
@@ -167,32 +200,57 @@ ConfigProcessor::get(unsigned int id)
   }
 
   idx  = id - 1;
-  info = infos[idx];
-
-  // Hand out a refcount to the caller. We should still have out
-  // own refcount, so it should be at least 2.
-  ink_release_assert(info->refcount_inc() > 1);
+  info = infos[idx].load(std::memory_order_acquire);
+
+  // Hand out a reference to the caller. Only this thread writes
+  // its counter, there is no need for an atomic increment.
+  if (int reader = config_reader_index(); reader >= 0) {
+    std::atomic<int64_t> &count = info->m_readers[reader].count;
+    count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+  } else {
+    info->refcount_inc();
+  }
   return info;
 }
 
 void
 ConfigProcessor::release(unsigned int id, ConfigInfo *info)
 {
-  int idx;
-
   if (id == 0 || id > MAX_CONFIGS) {
     // nothing to delete since we have an invalid index
     ink_abort("released an invalid id '%u'", id);
   }
 
-  idx = id - 1;
+  if (info == nullptr) {
+    return;
+  }
+
+  // The ConfigInfoReleaser deletes a replaced object once its
+  // references are all released.
+  if (int reader = config_reader_index(); reader >= 0) {
+    std::atomic<int64_t> &count = info->m_readers[reader].count;
+    count.store(count.load(std::memory_order_relaxed) - 1, std::memory_order_release);
+  } else {
+    info->refcount_dec();
+  }
+}
+
+bool
+ConfigProcessor::reclaim(unsigned int id, ConfigInfo *info)
+{
+  int64_t references = info->references();
 
-  if (info && info->refcount_dec() == 0) {
-    // When we release, we should already have replaced this object in the index.
-    Debug("config", "Release config %d 0x%" PRId64, id, (int64_t)info);
-    ink_release_assert(info != this->infos[idx]);
-    delete info;
+  // A reference released on another thread than it was taken on may be seen first, wait for both.
+  if (references != 0) {
+    Debug("config", "Config %d 0x%" PRId64 " still has %" PRId64 " references", id, (int64_t)info, references);
+    return false;
   }
+
+  // When we reclaim, we should already have replaced this object in the index.
+  Debug("config", "Release config %d 0x%" PRId64, id, (int64_t)info);
+  ink_release_assert(info != this->infos[id - 1]);
+  delete info;
+  return true;
 }
 
 #if TS_HAS_TESTS
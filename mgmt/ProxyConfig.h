@@ -50,7 +50,39 @@ void *config_string_alloc_cb(void *data, void *value);
 
 #define MAX_CONFIGS 100
 
-typedef RefCountObj ConfigInfo;
+/// The most threads that count their references to the configurations without an atomic operation.
+#define MAX_CONFIG_READERS 256
+
+/** A generation of a configuration.
+
+    Each event thread counts the references it takes and releases in a counter of its own, on a cache
+    line of its own, with plain loads and stores. A reference may be released on another thread than
+    it was taken on, only the sum of the counters is meaningful. The other threads use the shared
+    reference count.
+ */
+class ConfigInfo : public RefCountObj
+{
+public:
+  ConfigInfo() {}
+  ConfigInfo(const ConfigInfo &) : RefCountObj() {}
+  ConfigInfo &
+  operator=(const ConfigInfo &)
+  {
+    return *this;
+  }
+
+private:
+  friend class ConfigProcessor;
+
+  struct alignas(64) Reader {
+    std::atomic<int64_t> count{0};
+  };
+
+  /// The references held, which are only exact once no thread can take a new one.
+  int64_t references() const;
+
+  Reader m_readers[MAX_CONFIG_READERS];
+};
 
 class ConfigProcessor
 {
@@ -82,6 +114,15 @@ public:
   ConfigInfo *get(unsigned int id);
   void release(unsigned int id, ConfigInfo *data);
 
+  /** Delete @a info, which was replaced in @a id at least the release timeout ago, if it is not referenced.
+
+      No thread can take a new reference to @a info by then, a thread takes its reference right
+      after it loads the current generation.
+
+      @return @c true if @a info was deleted.
+   */
+  bool reclaim(unsigned int id, ConfigInfo *info);
+
 public:
   std::atomic<ConfigInfo *> infos[MAX_CONFIGS] = {nullptr};
   std::atomic<int> ninfos{0};
@@ -582,6 +582,14 @@ MgmtRecordGetMatching(const char * /* regex */, TSList /* rec_vals */)
   return TS_ERR_FAIL;
 }
 
+// The batch only saves the round trips of the remote side, the Core side
+// reads the records one at a time instead.
+TSMgmtError
+MgmtRecordGetBatch(TSRecordMatchT /* match */, TSStringList /* patterns */, TSList /* rec_vals */)
+{
+  return TS_ERR_NOT_SUPPORTED;
+}
+
 TSMgmtError
 MgmtConfigRecordDescribe(const char * /* rec_name */, unsigned /* flags */, TSConfigRecordDescription * /* val */)
 {
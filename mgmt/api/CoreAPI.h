@@ -67,6 +67,7 @@ TSMgmtError MgmtRecordSetCounter(const char *rec_name, MgmtIntCounter counter_va
 TSMgmtError MgmtRecordSetFloat(const char *rec_name, MgmtFloat float_val, TSActionNeedT *action_need);
 TSMgmtError MgmtRecordSetString(const char *rec_name, const char *string_val, TSActionNeedT *action_need);
 TSMgmtError MgmtRecordGetMatching(const char *regex, TSList rec_vals);
+TSMgmtError MgmtRecordGetBatch(TSRecordMatchT match, TSStringList patterns, TSList rec_vals);
 
 TSMgmtError MgmtConfigRecordDescribe(const char *rec_name, unsigned flags, TSConfigRecordDescription *val);
 TSMgmtError MgmtConfigRecordDescribeMatching(const char *regex, unsigned flags, TSList rec_vals);
@@ -50,6 +50,8 @@
 #include "EventCallback.h"
 #include "MgmtMarshall.h"
 
+#include <string>
+
 // forward declarations
 static TSMgmtError send_and_parse_list(OpType op, LLQ *list);
 static TSMgmtError mgmt_record_set(const char *rec_name, const char *rec_val, TSActionNeedT *action_need);
@@ -779,6 +781,66 @@ fail:
   return ret;
 }
 
+TSMgmtError
+MgmtRecordGetBatch(TSRecordMatchT match, TSStringList patterns, TSList rec_vals)
+{
+  TSMgmtError ret;
+  TSRecordEle *rec_ele;
+  std::string buf;
+
+  OpType optype          = OpType::RECORD_GET_BATCH;
+  MgmtMarshallInt kind   = match;
+  MgmtMarshallData names = {nullptr, 0};
+
+  if (!patterns || !rec_vals) {
+    return TS_ERR_PARAMS;
+  }
+
+  // Send all the patterns at once, each NUL terminated.
+  for (int i = 0, count = queue_len(static_cast<LLQ *>(patterns)); i < count; ++i) {
+    char *pattern = static_cast<char *>(dequeue(static_cast<LLQ *>(patterns)));
+    if (pattern) {
+      buf.append(pattern, strlen(pattern) + 1);
+    }
+    enqueue(static_cast<LLQ *>(patterns), pattern); // return the pattern to the list
+  }
+  names.ptr = buf.data();
+  names.len = buf.size();
+
+  ret = MGMTAPI_SEND_MESSAGE(main_socket_fd, OpType::RECORD_GET_BATCH, &optype, &kind, &names);
+  if (ret != TS_ERR_OKAY) {
+    return ret;
+  }
+
+  for (;;) {
+    rec_ele = TSRecordEleCreate();
+
+    ret = mgmt_record_get_reply(OpType::RECORD_GET_BATCH, rec_ele);
+    if (ret != TS_ERR_OKAY) {
+      TSRecordEleDestroy(rec_ele);
+      goto fail;
+    }
+
+    // A record without a name ends the list, one without a type is a name that is not a record.
+    if (rec_ele->rec_type == TS_REC_UNDEFINED && (rec_ele->rec_name == nullptr || *rec_ele->rec_name == '\0')) {
+      TSRecordEleDestroy(rec_ele);
+      break;
+    }
+
+    enqueue(static_cast<LLQ *>(rec_vals), rec_ele);
+  }
+
+  return TS_ERR_OKAY;
+
+fail:
+  while (!queue_is_empty(static_cast<LLQ *>(rec_vals))) {
+    rec_ele = static_cast<TSRecordEle *>(dequeue(static_cast<LLQ *>(rec_vals)));
+    TSRecordEleDestroy(rec_ele);
+  }
+
+  return ret;
+}
+
 TSMgmtError
 MgmtRecordSet(const char *rec_name, const char *val, TSActionNeedT *action_need)
 {
@@ -515,6 +515,7 @@ static const event_message_handler handlers[] = {
   nullptr,                     // LIFECYCLE_MESSAGE
   nullptr,                     // HOST_STATUS_UP
   nullptr,                     // HOST_STATUS_DOWN
+  nullptr,                     // RECORD_GET_BATCH
 };
 
 static TSMgmtError
@@ -535,6 +535,26 @@ TSRecordGetMlt(TSStringList rec_names, TSList rec_vals)
     return TS_ERR_PARAMS;
   }
 
+  // All the records in one request when the other side can answer it.
+  ret = MgmtRecordGetBatch(TS_RECORD_MATCH_NAME, rec_names, rec_vals);
+  if (ret != TS_ERR_NOT_SUPPORTED) {
+    if (ret == TS_ERR_OKAY) {
+      bool missing = false;
+      for (i = 0, num_recs = queue_len(static_cast<LLQ *>(rec_vals)); i < num_recs; i++) {
+        TSRecordEle *ele = static_cast<TSRecordEle *>(dequeue(static_cast<LLQ *>(rec_vals)));
+        missing          = missing || ele->rec_type == TS_REC_UNDEFINED;
+        enqueue(static_cast<LLQ *>(rec_vals), ele);
+      }
+      if (missing) { // some name is not a record
+        while (!queue_is_empty(static_cast<LLQ *>(rec_vals))) {
+          TSRecordEleDestroy(static_cast<TSRecordEle *>(dequeue(static_cast<LLQ *>(rec_vals))));
+        }
+        ret = TS_ERR_PARAMS;
+      }
+    }
+    return ret;
+  }
+
   num_recs = queue_len(static_cast<LLQ *>(rec_names));
   for (i = 0; i < num_recs; i++) {
     char *rec_name = static_cast<char *>(dequeue(static_cast<LLQ *>(rec_names))); // remove name from list
@@ -574,6 +594,16 @@ TSRecordGetMatchMlt(const char *regex, TSList rec_vals)
   return MgmtRecordGetMatching(regex, rec_vals);
 }
 
+tsapi TSMgmtError
+TSRecordGetBatch(TSRecordMatchT match, TSStringList patterns, TSList rec_vals)
+{
+  if (!patterns || !rec_vals) {
+    return TS_ERR_PARAMS;
+  }
+
+  return MgmtRecordGetBatch(match, patterns, rec_vals);
+}
+
 tsapi TSMgmtError
 TSRecordSet(const char *rec_name, const char *val, TSActionNeedT *action_need)
 {
@@ -63,6 +63,7 @@ static const struct NetCmdOperation requests[] = {
   /* LIFECYCLE_MESSAGE          */ {3, {MGMT_MARSHALL_INT, MGMT_MARSHALL_STRING, MGMT_MARSHALL_DATA}},
   /* HOST_STATUS_HOST_UP        */ {4, {MGMT_MARSHALL_INT, MGMT_MARSHALL_STRING, MGMT_MARSHALL_STRING, MGMT_MARSHALL_INT}},
   /* HOST_STATUS_HOST_DOWN      */ {4, {MGMT_MARSHALL_INT, MGMT_MARSHALL_STRING, MGMT_MARSHALL_STRING, MGMT_MARSHALL_INT}},
+  /* RECORD_GET_BATCH           */ {3, {MGMT_MARSHALL_INT, MGMT_MARSHALL_INT, MGMT_MARSHALL_DATA}},
 };
 
 // Responses always begin with a TSMgmtError code, followed by additional fields.
@@ -99,6 +100,8 @@ static const struct NetCmdOperation responses[] = {
   /* LIFECYCLE_MESSAGE          */ {1, {MGMT_MARSHALL_INT}},
   /* HOST_STATUS_UP             */ {1, {MGMT_MARSHALL_INT}},
   /* HOST_STATUS_DOWN           */ {1, {MGMT_MARSHALL_INT}},
+  /* RECORD_GET_BATCH           */
+  {5, {MGMT_MARSHALL_INT, MGMT_MARSHALL_INT, MGMT_MARSHALL_INT, MGMT_MARSHALL_STRING, MGMT_MARSHALL_DATA}},
 };
 
 #define GETCMD(ops, optype, cmd)                           \
@@ -235,6 +238,7 @@ send_mgmt_error(int fd, OpType optype, TSMgmtError error)
 
   case OpType::RECORD_GET:
   case OpType::RECORD_MATCH_GET:
+  case OpType::RECORD_GET_BATCH:
     ink_release_assert(responses[static_cast<unsigned>(optype)].nfields == 5);
     return send_mgmt_response(fd, optype, &ecode, &intval, &intval, &strval, &dataval);
 
@@ -42,7 +42,9 @@
 #include "CoreAPIShared.h"
 #include "NetworkUtilsLocal.h"
 
+#include <string>
 #include <unordered_map>
+#include <vector>
 
 #define TIMEOUT_SECS 1 // the num secs for select timeout
 
@@ -436,6 +438,149 @@ handle_record_match(int fd, void *req, size_t reqlen)
   return match.err;
 }
 
+/**************************************************************************
+ * handle_record_get_batch
+ *
+ * purpose: handles requests to retrieve all the records selected by a set
+ *          of names, name prefixes or regular expressions at once
+ * input: socket information
+ *        req - the msg sent (match kind, NUL separated patterns)
+ * output: SUCC or ERR
+ * note: the records are copied while they are locked and only sent once
+ *       all of them are, so that no record lock is held across a write to
+ *       the socket. A name that is not a record comes back without a type,
+ *       a record without a name ends the list.
+ *************************************************************************/
+struct record_snapshot {
+  std::string name;
+  RecT rclass   = RECT_NULL;
+  RecDataT type = RECD_NULL;
+  RecData data;
+  std::string str; // The value of a string record.
+};
+
+static void
+snapshot_record(const RecRecord *rec, void *edata)
+{
+  std::vector<record_snapshot> *records = static_cast<std::vector<record_snapshot> *>(edata);
+  record_snapshot &snap                 = records->emplace_back();
+
+  snap.name   = rec->name;
+  snap.rclass = rec->rec_type;
+  snap.type   = rec->data_type;
+  snap.data   = rec->data;
+  if (rec->data_type == RECD_STRING) {
+    // For NULL string parameters, send the literal "NULL" like send_record_get_response() does.
+    snap.str = rec->data.rec_string ? rec->data.rec_string : "NULL";
+  }
+}
+
+static TSMgmtError
+send_record_snapshot(int fd, const record_snapshot *snap)
+{
+  MgmtMarshallInt err     = TS_ERR_OKAY;
+  MgmtMarshallInt type    = TS_REC_UNDEFINED;
+  MgmtMarshallInt rclass  = snap ? snap->rclass : RECT_NULL;
+  MgmtMarshallString name = snap ? const_cast<MgmtMarshallString>(snap->name.c_str()) : nullptr;
+  MgmtMarshallData value  = {nullptr, 0};
+
+  if (snap && snap->type == RECD_STRING) {
+    type      = TS_REC_STRING;
+    value.ptr = const_cast<char *>(snap->str.c_str());
+    value.len = snap->str.size() + 1;
+  } else if (snap && marshall_rec_data(snap->type, snap->data, value) == TS_ERR_OKAY) {
+    type = snap->type == RECD_INT ? TS_REC_INT : snap->type == RECD_COUNTER ? TS_REC_COUNTER : TS_REC_FLOAT;
+  }
+
+  return send_mgmt_response(fd, OpType::RECORD_GET_BATCH, &err, &rclass, &type, &name, &value);
+}
+
+// Append @a text to @a regex with the regular expression metacharacters escaped.
+static void
+append_regex_literal(std::string &regex, const char *text)
+{
+  for (const char *p = text; *p; ++p) {
+    if (strchr("\\^$.|?*+()[]{}", *p)) {
+      regex += '\\';
+    }
+    regex += *p;
+  }
+}
+
+static TSMgmtError
+handle_record_get_batch(int fd, void *req, size_t reqlen)
+{
+  TSMgmtError ret;
+  MgmtMarshallInt optype;
+  MgmtMarshallInt match;
+  MgmtMarshallData patterns = {nullptr, 0};
+  std::vector<const char *> names;
+  std::vector<record_snapshot> records;
+
+  ret = recv_mgmt_request(req, reqlen, OpType::RECORD_GET_BATCH, &optype, &match, &patterns);
+  if (ret != TS_ERR_OKAY) {
+    return ret;
+  }
+
+  // The patterns are NUL terminated strings one after the other.
+  for (const char *p = static_cast<const char *>(patterns.ptr), *end = p + patterns.len; p < end; p += strlen(p) + 1) {
+    if (memchr(p, '\0', end - p) == nullptr) {
+      ret = TS_ERR_PARAMS;
+      goto done;
+    }
+    if (*p) {
+      names.push_back(p);
+    }
+  }
+
+  switch (match) {
+  case TS_RECORD_MATCH_NAME:
+    records.reserve(names.size());
+    for (const char *name : names) {
+      if (RecLookupRecord(name, snapshot_record, &records) != REC_ERR_OKAY) {
+        records.emplace_back().name = name;
+      }
+    }
+    break;
+  case TS_RECORD_MATCH_PREFIX:
+  case TS_RECORD_MATCH_REGEX:
+    if (!names.empty()) {
+      // A single pass over the records table for all the patterns, which also keeps a record from coming back twice.
+      std::string regex;
+      for (const char *name : names) {
+        regex += regex.empty() ? "(?:" : "|(?:";
+        if (match == TS_RECORD_MATCH_PREFIX) {
+          regex += '^';
+          append_regex_literal(regex, name);
+        } else {
+          regex += name;
+        }
+        regex += ')';
+      }
+      if (RecLookupMatchingRecords(RECT_ALL, regex.c_str(), snapshot_record, &records) != REC_ERR_OKAY) {
+        ret = TS_ERR_PARAMS;
+        goto done;
+      }
+    }
+    break;
+  default:
+    ret = TS_ERR_PARAMS;
+    goto done;
+  }
+
+  Debug("ts_main", "sending %zu records for a batch of %zu patterns", records.size(), names.size());
+  for (const record_snapshot &snap : records) {
+    if ((ret = send_record_snapshot(fd, &snap)) != TS_ERR_OKAY) {
+      goto done;
+    }
+  }
+  ret = send_record_snapshot(fd, nullptr);
+
+done:
+  ats_free(patterns.ptr);
+  return ret;
+}
+
 /**************************************************************************
  * handle_record_set
  *
@@ -1040,6 +1185,7 @@ static const control_message_handler handlers[] = {
   /* LIFECYCLE_MESSAGE          */ {MGMT_API_PRIVILEGED, handle_lifecycle_message},
   /* HOST_STATUS_UP             */ {MGMT_API_PRIVILEGED, handle_host_status_up},
   /* HOST_STATUS_DOWN           */ {MGMT_API_PRIVILEGED, handle_host_status_down},
+  /* RECORD_GET_BATCH           */ {0, handle_record_get_batch},
 };
 
 // This should use countof(), but we need a constexpr :-/
@@ -134,6 +134,13 @@ typedef enum {
   TS_REC_UNDEFINED,
 } TSRecordT;
 
+/* How the patterns of TSRecordGetBatch select the records. */
+typedef enum {
+  TS_RECORD_MATCH_NAME,   /* exact record names */
+  TS_RECORD_MATCH_PREFIX, /* records whose name starts with one of the patterns */
+  TS_RECORD_MATCH_REGEX,  /* records whose name matches one of the regular expressions */
+} TSRecordMatchT;
+
 /* These are initialization options for the Init() function. */
 typedef enum {
   TS_MGMT_OPT_DEFAULTS = 0,
@@ -470,6 +477,16 @@ tsapi TSMgmtError TSRecordGetMlt(TSStringList rec_names, TSList rec_vals);
  */
 tsapi TSMgmtError TSRecordGetMatchMlt(const char *rec_regex, TSList list);
 
+/* TSRecordGetBatch: gets all the records selected by a set of patterns in a single request
+ * Input:  match    - how the patterns select the records
+ *         patterns - list of record names, name prefixes or regular expressions
+ * Output: TSMgmtError, TSList of TSRecordEle
+ * Note: With TS_RECORD_MATCH_NAME the records come back in the order of the names and
+ *       a name that is not a record comes back with a rec_type of TS_REC_UNDEFINED.
+ *       Empty patterns are ignored.
+ */
+tsapi TSMgmtError TSRecordGetBatch(TSRecordMatchT match, TSStringList patterns, TSList rec_vals);
+
 /* TSRecordSet*: sets a record w/ a known type
  * Input:  rec_name     - the name of the record (proxy.config.record_name)
  *         *_val        - the value to set the record to
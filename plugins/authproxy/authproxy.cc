@@ -24,11 +24,18 @@
 // This plugin follows the pattern of the basic-auth sample code. We use the
 // TS_HTTP_POST_REMAP_HOOK to perform the initial authorization, and
 // the TS_HTTP_SEND_RESPONSE_HDR_HOOK to send an error response if necessary.
+//
+// With --cache-key the decisions are kept in an AuthCache by the request
+// attributes they depend on, and identical requests that arrive while one of
+// them is being authorized wait for its answer instead of asking again.
 
 #include "utils.h"
+#include "cache.h"
 #include <string>
 #include <memory> // placement new
 #include <limits>
+#include <algorithm>
+#include <vector>
 #include <cstring>
 #include <cstdlib>
 #include <cstdio>
@@ -53,11 +60,22 @@ static int AuthTaggedRequestArg = -1;
 
 static TSCont AuthOsDnsContinuation;
 
+// A request attribute that an authorization decision depends on.
+struct AuthCacheKeyPart {
+  enum { HEADER, COOKIE, PATH } type;
+  std::string name;      // Header or cookie name.
+  unsigned segments = 0; // Leading path segments.
+};
+
 struct AuthOptions {
   std::string hostname;
   int hostport                   = -1;
   AuthRequestTransform transform = nullptr;
   bool force                     = false;
+  std::vector<AuthCacheKeyPart> cache_key;
+  size_t cache_size = 10000;
+  time_t cache_ttl  = 0;
+  std::unique_ptr<AuthCache> cache;
 
   AuthOptions()  = default;
   ~AuthOptions() = default;
@@ -91,6 +109,9 @@ static TSEvent StateAuthProxyCompleteContent(AuthRequestContext *, void *);
 
 static TSEvent StateAuthProxySendResponse(AuthRequestContext *, void *);
 
+static TSEvent StateAuthCacheLookup(AuthRequestContext *, void *);
+static TSEvent StateAuthCacheResolved(AuthRequestContext *, void *);
+
 // Trampoline state that just returns TS_EVENT_CONTINUE. We need this to be
 // able to transition between state tables when we are in a loop.
 static TSEvent
@@ -131,8 +152,20 @@ static const StateTransition StateTableProxyRequest[] = {
   {TS_EVENT_ERROR, StateUnauthorized, nullptr},
   {TS_EVENT_NONE, nullptr, nullptr}};
 
+// State table for acting on a cached or coalesced authorization decision.
+static const StateTransition StateTableCacheResult[] = {
+  {TS_EVENT_IMMEDIATE, StateAuthorized, nullptr},
+  {TS_EVENT_HTTP_SEND_RESPONSE_HDR, StateContinue, StateTableSendResponse},
+  {TS_EVENT_HTTP_POST_REMAP, StateAuthProxyConnect, StateTableProxyRequest},
+  {TS_EVENT_ERROR, StateUnauthorized, nullptr},
+  {TS_EVENT_NONE, nullptr, nullptr}};
+
+// State table for waiting on the decision for an identical request.
+static const StateTransition StateTableCacheWait[] = {{TS_EVENT_IMMEDIATE, StateAuthCacheResolved, StateTableCacheResult},
+                                                      {TS_EVENT_NONE, nullptr, nullptr}};
+
 // Initial state table.
-static const StateTransition StateTableInit[] = {{TS_EVENT_HTTP_POST_REMAP, StateAuthProxyConnect, StateTableProxyRequest},
+static const StateTransition StateTableInit[] = {{TS_EVENT_HTTP_POST_REMAP, StateAuthCacheLookup, StateTableProxyRequest},
                                                  {TS_EVENT_ERROR, StateUnauthorized, nullptr},
                                                  {TS_EVENT_NONE, nullptr, nullptr}};
 
@@ -146,6 +179,10 @@ struct AuthRequestContext {
   const char *method = nullptr; // Client request method (e.g. GET)
   bool read_body     = true;
 
+  AuthCache *cache = nullptr; // Set while this request asks the auth proxy for cache_key.
+  std::string cache_key;
+  AuthCacheWaiter waiter;
+
   const StateTransition *state = nullptr;
 
   AuthRequestContext()
@@ -163,6 +200,17 @@ struct AuthRequestContext {
     if (this->vconn) {
       TSVConnClose(this->vconn);
     }
+    cache_abandon();
+  }
+
+  // Let the requests waiting on this one ask for themselves.
+  void
+  cache_abandon()
+  {
+    if (this->cache) {
+      this->cache->abandon(this->cache_key);
+      this->cache = nullptr;
+    }
   }
 
   const AuthOptions *
@@ -386,6 +434,132 @@ AuthWriteRedirectedRequest(AuthRequestContext *auth)
   return true;
 }
 
+// Append the value of the cookie @a name in @a cookies to @a key.
+static void
+AuthCacheKeyAppendCookie(std::string &key, const char *cookies, int len, const std::string &name)
+{
+  const char *end = cookies + len;
+
+  while (cookies < end) {
+    const char *sep = static_cast<const char *>(memchr(cookies, ';', end - cookies));
+    const char *pos = sep ? sep : end;
+
+    while (cookies < pos && (*cookies == ' ' || *cookies == '\t')) {
+      ++cookies;
+    }
+    if (static_cast<size_t>(pos - cookies) > name.size() && cookies[name.size()] == '=' &&
+        strncmp(cookies, name.data(), name.size()) == 0) {
+      key.append(cookies + name.size() + 1, pos - cookies - name.size() - 1);
+      return;
+    }
+    cookies = pos + 1;
+  }
+}
+
+// Build the cache key of the client request from the method, the host and the configured attributes.
+static void
+AuthCacheKeyBuild(AuthRequestContext *auth, const AuthOptions *options)
+{
+  TSMBuffer mbuf;
+  TSMLoc mhdr;
+  TSMLoc murl;
+  const char *value;
+  int len;
+
+  TSReleaseAssert(TSHttpTxnClientReqGet(auth->txn, &mbuf, &mhdr) == TS_SUCCESS);
+
+  std::string &key = auth->cache_key;
+  key.assign(auth->method ? auth->method : "");
+  key.push_back('\n');
+  if ((value = TSHttpHdrHostGet(mbuf, mhdr, &len)) != nullptr) {
+    key.append(value, len);
+  }
+
+  for (const auto &part : options->cache_key) {
+    key.push_back('\n');
+    if (part.type == AuthCacheKeyPart::PATH) {
+      if (TSHttpHdrUrlGet(mbuf, mhdr, &murl) == TS_SUCCESS) {
+        if ((value = TSUrlPathGet(mbuf, murl, &len)) != nullptr) {
+          const char *end = value;
+          for (unsigned n = 0; n < part.segments && end < value + len; ++n) {
+            const char *slash = static_cast<const char *>(memchr(end, '/', value + len - end));
+            end               = slash ? slash + 1 : value + len;
+          }
+          key.append(value, end - value);
+        }
+        TSHandleMLocRelease(mbuf, mhdr, murl);
+      }
+      continue;
+    }
+
+    const char *field_name = part.type == AuthCacheKeyPart::COOKIE ? TS_MIME_FIELD_COOKIE : part.name.c_str();
+    TSMLoc field           = TSMimeHdrFieldFind(mbuf, mhdr, field_name, -1);
+    while (field != TS_NULL_MLOC) {
+      if ((value = TSMimeHdrFieldValueStringGet(mbuf, mhdr, field, -1, &len)) != nullptr) {
+        if (part.type == AuthCacheKeyPart::COOKIE) {
+          AuthCacheKeyAppendCookie(key, value, len, part.name);
+        } else {
+          key.append(value, len);
+        }
+      }
+      TSMLoc next = TSMimeHdrFieldNextDup(mbuf, mhdr, field);
+      TSHandleMLocRelease(mbuf, mhdr, field);
+      field = next;
+    }
+  }
+
+  TSHandleMLocRelease(mbuf, TS_NULL_MLOC, mhdr);
+}
+
+// Look for a decision for this request in the authorization cache, or for an identical request
+// that is being authorized, before asking the auth proxy.
+static TSEvent
+StateAuthCacheLookup(AuthRequestContext *auth, void *edata)
+{
+  const AuthOptions *options = auth->options();
+
+  if (!options->cache) {
+    return StateAuthProxyConnect(auth, edata);
+  }
+
+  auth->method = AuthRequestGetMethod(auth->txn);
+  AuthCacheKeyBuild(auth, options);
+
+  auth->waiter.cont     = auth->cont;
+  auth->waiter.thread   = TSEventThreadSelf();
+  auth->waiter.response = &auth->rheader;
+
+  // The state to carry on in depends on what the cache knows, rather than on the event.
+  switch (options->cache->lookup(auth->cache_key, &auth->waiter, time(nullptr))) {
+  case AuthCacheResult::Miss:
+    auth->cache = options->cache.get();
+    return StateAuthProxyConnect(auth, edata);
+  case AuthCacheResult::Pending:
+    AuthLogDebug("waiting for the authorization of an identical request");
+    auth->state = StateTableCacheWait;
+    return TS_EVENT_CONTINUE;
+  default:
+    AuthLogDebug("using a cached authorization");
+    auth->state = StateTableCacheResult;
+    return StateAuthCacheResolved(auth, edata);
+  }
+}
+
+// Act on the decision the cache gave, or ask the auth proxy if the request we waited on got none.
+static TSEvent
+StateAuthCacheResolved(AuthRequestContext *auth, void * /* edata ATS_UNUSED */)
+{
+  switch (auth->waiter.result) {
+  case AuthCacheResult::Granted:
+    return TS_EVENT_IMMEDIATE;
+  case AuthCacheResult::Denied:
+    AuthChainAuthorizationResponse(auth);
+    return TS_EVENT_HTTP_SEND_RESPONSE_HDR;
+  default:
+    return TS_EVENT_HTTP_POST_REMAP;
+  }
+}
+
 static TSEvent
 StateAuthProxyConnect(AuthRequestContext *auth, void * /* edata ATS_UNUSED */)
 {
@@ -421,6 +595,11 @@ StateAuthProxyCompleteHeaders(AuthRequestContext *auth, void * /* edata ATS_UNUS
   status = TSHttpHdrStatusGet(auth->rheader.buffer, auth->rheader.header);
   AuthLogDebug("authorization proxy returned status %d", (int)status);
 
+  if (auth->cache) {
+    auth->cache->complete(auth->cache_key, auth->rheader.buffer, auth->rheader.header, time(nullptr));
+    auth->cache = nullptr;
+  }
+
   // Authorize the original request on a 2xx response.
   if (status >= 200 && status < 300) {
     return TS_EVENT_IMMEDIATE;
@@ -591,6 +770,7 @@ StateUnauthorized(AuthRequestContext *auth, void *)
 {
   static const char msg[] = "authorization denied\n";
 
+  auth->cache_abandon();
   TSHttpTxnStatusSet(auth->txn, TS_HTTP_STATUS_FORBIDDEN);
   TSHttpTxnErrorBodySet(auth->txn, TSstrdup(msg), sizeof(msg) - 1, TSstrdup("text/plain"));
 
@@ -674,6 +854,9 @@ AuthParseOptions(int argc, const char **argv)
     {const_cast<char *>("auth-port"), required_argument, nullptr, 'p'},
     {const_cast<char *>("auth-transform"), required_argument, nullptr, 't'},
     {const_cast<char *>("force-cacheability"), no_argument, nullptr, 'c'},
+    {const_cast<char *>("cache-key"), required_argument, nullptr, 'k'},
+    {const_cast<char *>("cache-size"), required_argument, nullptr, 's'},
+    {const_cast<char *>("cache-ttl"), required_argument, nullptr, 'l'},
     {nullptr, 0, nullptr, 0},
   };
 
@@ -707,6 +890,30 @@ AuthParseOptions(int argc, const char **argv)
         // XXX make this a fatal error?
       }
       break;
+    case 'k': {
+      AuthCacheKeyPart part;
+      if (strncasecmp(optarg, "header:", 7) == 0 && optarg[7]) {
+        part.type = AuthCacheKeyPart::HEADER;
+        part.name = optarg + 7;
+      } else if (strncasecmp(optarg, "cookie:", 7) == 0 && optarg[7]) {
+        part.type = AuthCacheKeyPart::COOKIE;
+        part.name = optarg + 7;
+      } else if (strncasecmp(optarg, "path:", 5) == 0) {
+        part.type     = AuthCacheKeyPart::PATH;
+        part.segments = std::atoi(optarg + 5);
+      } else {
+        AuthLogError("invalid authorization cache key '%s'", optarg);
+        break;
+      }
+      options->cache_key.push_back(part);
+      break;
+    }
+    case 's':
+      options->cache_size = std::max(1, std::atoi(optarg));
+      break;
+    case 'l':
+      options->cache_ttl = std::max(0, std::atoi(optarg));
+      break;
     }
 
     if (opt == -1) {
@@ -718,6 +925,10 @@ AuthParseOptions(int argc, const char **argv)
     options->hostname = "127.0.0.1";
   }
 
+  if (!options->cache_key.empty()) {
+    options->cache.reset(new AuthCache(options->cache_size, options->cache_ttl));
+  }
+
   return options;
 }
 
@@ -0,0 +1,208 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "cache.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <strings.h>
+
+AuthCache::AuthCache(size_t entries, time_t default_ttl)
+  : _shard_entries(std::max<size_t>(1, (entries + SHARDS - 1) / SHARDS)), _default_ttl(default_ttl)
+{
+}
+
+AuthCache::~AuthCache()
+{
+  for (auto &shard : _shards) {
+    for (auto &entry : shard.entries) {
+      if (entry.second.response) {
+        AuthDelete(entry.second.response);
+      }
+    }
+  }
+}
+
+AuthCache::Shard &
+AuthCache::shard(const std::string &key)
+{
+  return _shards[std::hash<std::string>{}(key) % SHARDS];
+}
+
+void
+AuthCache::erase(Shard &shard, std::unordered_map<std::string, Entry>::iterator entry)
+{
+  if (entry->second.response) {
+    AuthDelete(entry->second.response);
+  }
+  shard.lru.erase(entry->second.lru);
+  shard.entries.erase(entry);
+}
+
+// The seconds the auth proxy @a response may be reused for, from its Cache-Control.
+time_t
+AuthCache::ttl(TSMBuffer mbuf, TSMLoc mhdr) const
+{
+  TSMLoc field    = TSMimeHdrFieldFind(mbuf, mhdr, TS_MIME_FIELD_CACHE_CONTROL, TS_MIME_LEN_CACHE_CONTROL);
+  time_t max_age  = -1;
+  time_t s_maxage = -1;
+  bool no_store   = false;
+
+  while (field != TS_NULL_MLOC) {
+    int count = TSMimeHdrFieldValuesCount(mbuf, mhdr, field);
+    for (int i = 0; i < count; ++i) {
+      int len;
+      const char *value = TSMimeHdrFieldValueStringGet(mbuf, mhdr, field, i, &len);
+      std::string directive(value, len);
+
+      if (strcasecmp(directive.c_str(), "no-store") == 0 || strcasecmp(directive.c_str(), "no-cache") == 0) {
+        no_store = true;
+      } else if (strncasecmp(directive.c_str(), "max-age=", 8) == 0) {
+        max_age = std::strtol(directive.c_str() + 8, nullptr, 10);
+      } else if (strncasecmp(directive.c_str(), "s-maxage=", 9) == 0) {
+        s_maxage = std::strtol(directive.c_str() + 9, nullptr, 10);
+      }
+    }
+    TSMLoc next = TSMimeHdrFieldNextDup(mbuf, mhdr, field);
+    TSHandleMLocRelease(mbuf, mhdr, field);
+    field = next;
+  }
+
+  if (no_store) {
+    return 0;
+  }
+  if (s_maxage >= 0) {
+    return s_maxage;
+  }
+  return max_age >= 0 ? max_age : _default_ttl;
+}
+
+AuthCacheResult
+AuthCache::lookup(const std::string &key, AuthCacheWaiter *waiter, time_t now)
+{
+  Shard &s = shard(key);
+  std::lock_guard<std::mutex> lock(s.mutex);
+
+  auto entry = s.entries.find(key);
+  if (entry != s.entries.end()) {
+    if (entry->second.expires > now) {
+      s.lru.splice(s.lru.begin(), s.lru, entry->second.lru);
+      if (entry->second.granted) {
+        waiter->result = AuthCacheResult::Granted;
+      } else {
+        waiter->result = AuthCacheResult::Denied;
+        TSHttpHdrCopy(waiter->response->buffer, waiter->response->header, entry->second.response->buffer,
+                      entry->second.response->header);
+      }
+      return waiter->result;
+    }
+    erase(s, entry);
+  }
+
+  auto pending = s.pending.find(key);
+  if (pending != s.pending.end()) {
+    waiter->next_waiter = pending->second;
+    pending->second     = waiter;
+    return AuthCacheResult::Pending;
+  }
+  s.pending.emplace(key, nullptr);
+  return AuthCacheResult::Miss;
+}
+
+void
+AuthCache::complete(const std::string &key, TSMBuffer mbuf, TSMLoc mhdr, time_t now)
+{
+  Shard &s                = shard(key);
+  TSHttpStatus status     = TSHttpHdrStatusGet(mbuf, mhdr);
+  bool granted            = status >= 200 && status < 300;
+  bool cacheable          = granted || status == TS_HTTP_STATUS_UNAUTHORIZED || status == TS_HTTP_STATUS_FORBIDDEN;
+  time_t lifetime         = cacheable ? ttl(mbuf, mhdr) : 0;
+  AuthCacheWaiter *waiter = nullptr;
+
+  {
+    std::lock_guard<std::mutex> lock(s.mutex);
+
+    auto pending = s.pending.find(key);
+    if (pending != s.pending.end()) {
+      waiter = pending->second;
+      s.pending.erase(pending);
+    }
+
+    if (lifetime > 0) {
+      auto entry = s.entries.find(key);
+      if (entry != s.entries.end()) {
+        erase(s, entry);
+      }
+      while (s.entries.size() >= _shard_entries) {
+        erase(s, s.entries.find(s.lru.back()));
+      }
+      s.lru.push_front(key);
+
+      Entry &added  = s.entries[key];
+      added.expires = now + lifetime;
+      added.granted = granted;
+      added.lru     = s.lru.begin();
+      if (!granted) {
+        added.response = AuthNew<HttpHeader>();
+        TSHttpHdrCopy(added.response->buffer, added.response->header, mbuf, mhdr);
+      }
+    }
+  }
+
+  AuthLogDebug("auth proxy status %d for %zu byte key, cached for %ld seconds", static_cast<int>(status), key.size(),
+               static_cast<long>(lifetime));
+
+  // The waiters are off the pending list, they are ours alone until they are called back.
+  while (waiter) {
+    AuthCacheWaiter *next = waiter->next_waiter;
+    waiter->result        = granted ? AuthCacheResult::Granted : AuthCacheResult::Denied;
+    if (!granted) {
+      TSHttpHdrCopy(waiter->response->buffer, waiter->response->header, mbuf, mhdr);
+    }
+    TSContScheduleOnThread(waiter->cont, 0, waiter->thread);
+    waiter = next;
+  }
+}
+
+void
+AuthCache::abandon(const std::string &key)
+{
+  Shard &s                = shard(key);
+  AuthCacheWaiter *waiter = nullptr;
+
+  {
+    std::lock_guard<std::mutex> lock(s.mutex);
+
+    auto pending = s.pending.find(key);
+    if (pending != s.pending.end()) {
+      waiter = pending->second;
+      s.pending.erase(pending);
+    }
+  }
+
+  while (waiter) {
+    AuthCacheWaiter *next = waiter->next_waiter;
+    waiter->result        = AuthCacheResult::Miss;
+    TSContScheduleOnThread(waiter->cont, 0, waiter->thread);
+    waiter = next;
+  }
+}
+
+// vim: set ts=4 sw=4 et :
@@ -0,0 +1,97 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "utils.h"
+
+#include <ctime>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// The result of an authorization cache lookup.
+enum class AuthCacheResult {
+  Miss,    // Nothing known, the caller asks the auth proxy and completes or abandons the key.
+  Pending, // Another request is asking, the caller is woken up when it has the answer.
+  Granted, // The request is authorized.
+  Denied,  // The request is denied with the auth proxy response.
+};
+
+// A request waiting for the answer of the request asking the auth proxy. Once the answer is in,
+// its continuation is called back with TS_EVENT_IMMEDIATE on the thread it was waiting on.
+struct AuthCacheWaiter {
+  TSCont cont                  = nullptr;
+  TSEventThread thread         = nullptr;
+  HttpHeader *response         = nullptr; // Gets a copy of the auth proxy response when denied.
+  AuthCacheResult result       = AuthCacheResult::Miss;
+  AuthCacheWaiter *next_waiter = nullptr;
+};
+
+// Authorization decisions by request key, bounded in entries and sharded by the key so that
+// requests on different threads seldom wait on each other. Only 2xx grants and 401 or 403
+// denials are kept, for as long as the Cache-Control of the auth proxy response allows.
+class AuthCache
+{
+public:
+  AuthCache(size_t entries, time_t default_ttl);
+  ~AuthCache();
+
+  // Look up @a key. On a Pending result @a waiter is queued and must wait, it is filled in
+  // for Granted and Denied results.
+  AuthCacheResult lookup(const std::string &key, AuthCacheWaiter *waiter, time_t now);
+
+  // Record the auth proxy @a response for @a key and wake up the requests waiting on it.
+  void complete(const std::string &key, TSMBuffer mbuf, TSMLoc mhdr, time_t now);
+
+  // The request asking for @a key got no answer, the requests waiting on it ask themselves.
+  void abandon(const std::string &key);
+
+  // noncopyable
+  AuthCache(const AuthCache &) = delete;
+  AuthCache &operator=(const AuthCache &) = delete;
+
+private:
+  static constexpr unsigned SHARDS = 16;
+
+  struct Entry {
+    time_t expires       = 0;
+    bool granted         = false;
+    HttpHeader *response = nullptr; // The auth proxy response of a denial.
+    std::list<std::string>::iterator lru;
+  };
+
+  struct Shard {
+    std::mutex mutex;
+    std::unordered_map<std::string, Entry> entries;
+    std::list<std::string> lru; // Most recently used first.
+    std::unordered_map<std::string, AuthCacheWaiter *> pending;
+  };
+
+  Shard &shard(const std::string &key);
+  void erase(Shard &shard, std::unordered_map<std::string, Entry>::iterator entry);
+  time_t ttl(TSMBuffer mbuf, TSMLoc mhdr) const;
+
+  size_t _shard_entries;
+  time_t _default_ttl;
+  Shard _shards[SHARDS];
+};
+
+// vim: set ts=4 sw=4 et :
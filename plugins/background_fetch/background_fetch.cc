@@ -55,12 +55,34 @@ static const std::array<const std::string_view, 6> FILTER_HEADERS{
 // Hold the global background fetch state. This is currently shared across all
 // configurations, as a singleton. ToDo: Would it ever make sense to do this
 // per remap rule? Maybe for per-remap logging ??
-typedef std::unordered_map<std::string, bool> OutstandingRequests;
+//
+// The state is also the scheduler of the fetches. A URL is fetched at most once
+// at a time, and with limits on the running fetches, the others wait in a queue.
+// The queued URL that was asked for the most times is started first.
+struct BgFetchData;
+
+struct BgFetchEntry {
+  BgFetchData *data = nullptr; // Only while queued, a running fetch owns its data
+  std::string origin;
+  int hits     = 0; // Times the URL was asked for while queued or running
+  bool running = false;
+};
+
+typedef std::unordered_map<std::string, BgFetchEntry> OutstandingRequests;
 
 class BgFetchState
 {
 public:
-  BgFetchState()                     = default;
+  BgFetchState()
+  {
+    _stat_queued  = createStat("queued");
+    _stat_running = createStat("running");
+    _stat_started = createStat("started");
+    _stat_deduped = createStat("deduplicated");
+    _stat_dropped = createStat("dropped");
+    _stat_cached  = createStat("cancelled_cached");
+  }
+
   BgFetchState(BgFetchState const &) = delete;
   void operator=(BgFetchState const &) = delete;
 
@@ -90,46 +112,91 @@ public:
     return _log;
   }
 
-  bool
-  acquire(const std::string &url)
+  // The limits are shared by all the configurations, the last one that sets a limit wins.
+  void
+  setLimits(const BgFetchConfig *config)
   {
-    bool ret;
-
     TSMutexLock(_lock);
-    if (_urls.end() == _urls.find(url)) {
-      _urls[url] = true;
-      ret        = true;
-    } else {
-      ret = false;
+    if (config->maxFetches() > 0) {
+      _max_fetches = config->maxFetches();
+    }
+    if (config->maxOriginFetches() > 0) {
+      _max_origin_fetches = config->maxOriginFetches();
+    }
+    if (config->maxQueued() > 0) {
+      _max_queued = config->maxQueued();
     }
     TSMutexUnlock(_lock);
+  }
+
+  void
+  cancelledCached()
+  {
+    TSStatIntIncrement(_stat_cached, 1);
+  }
+
+  void submit(BgFetchData *data);
+  void release(const std::string &url);
 
-    TSDebug(PLUGIN_NAME, "BgFetchState.acquire(): ret = %d, url = %s", ret, url.c_str());
+private:
+  static int
+  createStat(const char *name)
+  {
+    std::string stat_name = std::string{"plugin."} + PLUGIN_NAME + "." + name;
+    int id;
 
-    return ret;
+    if (TS_ERROR == TSStatFindName(stat_name.c_str(), &id)) {
+      id = TSStatCreate(stat_name.c_str(), TS_RECORDDATATYPE_INT, TS_STAT_NON_PERSISTENT, TS_STAT_SYNC_SUM);
+    }
+    return id;
   }
 
   bool
-  release(const std::string &url)
+  canRun(const std::string &origin)
   {
-    bool ret;
-
-    TSMutexLock(_lock);
-    if (_urls.end() == _urls.find(url)) {
-      ret = false;
-    } else {
-      _urls.erase(url);
-      ret = true;
+    if (_max_fetches > 0 && _running >= _max_fetches) {
+      return false;
     }
-    TSMutexUnlock(_lock);
+    if (_max_origin_fetches > 0) {
+      auto spot = _origins.find(origin);
+      return spot == _origins.end() || spot->second < _max_origin_fetches;
+    }
+    return true;
+  }
 
-    return ret;
+  // Called with the lock held, the caller schedules the data after unlocking.
+  void
+  start(BgFetchEntry &entry)
+  {
+    entry.running = true;
+    entry.data    = nullptr;
+    ++_running;
+    ++_origins[entry.origin];
+    TSStatIntIncrement(_stat_started, 1);
+  }
+
+  void
+  updateGauges()
+  {
+    TSStatIntSet(_stat_queued, _queued);
+    TSStatIntSet(_stat_running, _running);
   }
 
-private:
   OutstandingRequests _urls;
-  TSTextLogObject _log = nullptr;
-  TSMutex _lock        = TSMutexCreate();
+  std::unordered_map<std::string, int> _origins; // Running fetches per origin
+  int _running            = 0;
+  int _queued             = 0;
+  int _max_fetches        = 0;
+  int _max_origin_fetches = 0;
+  int _max_queued         = 1024;
+  int _stat_queued        = -1;
+  int _stat_running       = -1;
+  int _stat_started       = -1;
+  int _stat_deduped       = -1;
+  int _stat_dropped       = -1;
+  int _stat_cached        = -1;
+  TSTextLogObject _log    = nullptr;
+  TSMutex _lock           = TSMutexCreate();
 };
 
 //////////////////////////////////////////////////////////////////////////////
@@ -154,7 +221,7 @@ struct BgFetchData {
 
     // If we got schedule, also clean that up
     if (_cont) {
-      releaseUrl();
+      BgFetchState::getInstance().release(_url);
 
       TSContDestroy(_cont);
       _cont = nullptr;
@@ -165,21 +232,16 @@ struct BgFetchData {
     }
   }
 
-  bool
-  acquireUrl() const
-  {
-    return BgFetchState::getInstance().acquire(_url);
-  }
-  bool
-  releaseUrl() const
+  const std::string &
+  getUrl() const
   {
-    return BgFetchState::getInstance().release(_url);
+    return _url;
   }
 
-  const char *
-  getUrl() const
+  const std::string &
+  getOrigin() const
   {
-    return _url.c_str();
+    return _origin;
   }
 
   void
@@ -209,10 +271,87 @@ struct BgFetchData {
 
 private:
   std::string _url;
+  std::string _origin;
   int64_t _bytes = 0;
   TSCont _cont   = nullptr;
 };
 
+// Start the fetch of the data, queue it, or drop it when the URL is already being fetched.
+void
+BgFetchState::submit(BgFetchData *data)
+{
+  bool run = false;
+
+  TSMutexLock(_lock);
+  auto spot = _urls.find(data->getUrl());
+  if (spot != _urls.end()) {
+    ++spot->second.hits;
+    TSStatIntIncrement(_stat_deduped, 1);
+  } else if (canRun(data->getOrigin())) {
+    BgFetchEntry &entry = _urls[data->getUrl()];
+    entry.origin        = data->getOrigin();
+    start(entry);
+    run = true;
+  } else if (_queued < _max_queued) {
+    BgFetchEntry &entry = _urls[data->getUrl()];
+    entry.origin        = data->getOrigin();
+    entry.data          = data;
+    ++_queued;
+    data = nullptr;
+  } else {
+    TSStatIntIncrement(_stat_dropped, 1);
+  }
+  updateGauges();
+  TSMutexUnlock(_lock);
+
+  TSDebug(PLUGIN_NAME, "BgFetchState.submit(): run = %d, url = %s", run, data ? data->getUrl().c_str() : "(queued)");
+  if (run) {
+    data->schedule();
+  } else {
+    delete data;
+  }
+}
+
+// The fetch of the url is done, start the most asked for queued fetch that its origin allows.
+void
+BgFetchState::release(const std::string &url)
+{
+  BgFetchData *next = nullptr;
+
+  TSMutexLock(_lock);
+  auto spot = _urls.find(url);
+  if (spot != _urls.end()) {
+    auto origin = _origins.find(spot->second.origin);
+    if (origin != _origins.end() && --origin->second <= 0) {
+      _origins.erase(origin);
+    }
+    --_running;
+    _urls.erase(spot);
+  }
+
+  if (_queued > 0 && (_max_fetches <= 0 || _running < _max_fetches)) {
+    BgFetchEntry *best = nullptr;
+
+    for (auto &[queued_url, entry] : _urls) {
+      if (!entry.running && (!best || entry.hits > best->hits) && canRun(entry.origin)) {
+        best = &entry;
+      }
+    }
+    if (best) {
+      next = best->data;
+      --_queued;
+      start(*best);
+    }
+  }
+  updateGauges();
+  TSMutexUnlock(_lock);
+
+  if (next) {
+    TSDebug(PLUGIN_NAME, "BgFetchState.release(): starting queued url = %s", next->getUrl().c_str());
+    next->schedule();
+  }
+}
+
 // This sets up the data and continuation properly, this is done outside
 // of the CTor, since this can actually fail. If we fail, the data is
 // useless, and should be delete'd.
@@ -273,6 +412,8 @@ BgFetchData::initialize(TSMBuffer request, TSMLoc req_hdr, TSHttpTxn txnp)
             // Make sure we have the correct Host: header for this request.
             const char *hostp = TSUrlHostGet(mbuf, url_loc, &len);
 
+            _origin.assign(hostp ? hostp : "", hostp ? len : 0);
+
             if (set_header(mbuf, hdr_loc, TS_MIME_FIELD_HOST, TS_MIME_LEN_HOST, hostp, len)) {
               TSDebug(PLUGIN_NAME, "Set header Host: %.*s", len, hostp);
             }
@@ -449,6 +590,41 @@ cont_bg_fetch(TSCont contp, TSEvent event, void * /* edata ATS_UNUSED */)
   return 0;
 }
 
+///////////////////////////////////////////////////////////////////////////
+// A global CACHE_LOOKUP_COMPLETE hook, which ends a background fetch of an
+// object that is already fresh in cache (e.g. filled by the time a queued
+// fetch started), without reading it from disk.
+//
+static int
+cont_check_cached(TSCont /* contp ATS_UNUSED */, TSEvent /* event ATS_UNUSED */, void *edata)
+{
+  TSHttpTxn txnp  = static_cast<TSHttpTxn>(edata);
+  const char *tag = TSHttpTxnPluginTagGet(txnp);
+  TSEvent next    = TS_EVENT_HTTP_CONTINUE;
+  int status;
+
+  if (tag && 0 == strcmp(tag, PLUGIN_NAME) && TS_SUCCESS == TSHttpTxnCacheLookupStatusGet(txnp, &status) &&
+      TS_CACHE_LOOKUP_HIT_FRESH == status) {
+    TSDebug(PLUGIN_NAME, "Cancelling background fetch, the object is in cache");
+    BgFetchState::getInstance().cancelledCached();
+    next = TS_EVENT_HTTP_ERROR;
+  }
+
+  TSHttpTxnReenable(txnp, next);
+  return 0;
+}
+
+static void
+add_check_cached_hook()
+{
+  static bool added = false; // Global and remap initialization are serialized
+
+  if (!added) {
+    TSHttpHookAdd(TS_HTTP_CACHE_LOOKUP_COMPLETE_HOOK, TSContCreate(cont_check_cached, nullptr));
+    added = true;
+  }
+}
+
 ///////////////////////////////////////////////////////////////////////////
 // This is a TXN hook, used to verify that the response (before sending to
 // originating client) is indeed cacheable. This has to be deferred, because
@@ -473,9 +649,9 @@ cont_check_cacheable(TSCont contp, TSEvent /* event ATS_UNUSED */, void *edata)
       if (cacheable) {
         BgFetchData *data = new BgFetchData();
 
-        // Initialize the data structure (can fail) and acquire a privileged lock on the URL
-        if (data->initialize(request, req_hdr, txnp) && data->acquireUrl()) {
-          data->schedule();
+        // Initialize the data structure (can fail), the scheduler starts it, queues it or deletes it.
+        if (data->initialize(request, req_hdr, txnp)) {
+          BgFetchState::getInstance().submit(data);
         } else {
           delete data; // Not sure why this would happen, but ok.
         }
@@ -577,8 +753,10 @@ TSPluginInit(int argc, const char *argv[])
     if (!gConfig->logFile().empty()) {
       BgFetchState::getInstance().createLog(gConfig->logFile());
     }
+    BgFetchState::getInstance().setLimits(gConfig);
     TSDebug(PLUGIN_NAME, "Initialized");
     TSHttpHookAdd(TS_HTTP_READ_RESPONSE_HDR_HOOK, cont);
+    add_check_cached_hook();
   } else {
     // ToDo: Hmmm, no way to fail a global plugin here?
     TSDebug(PLUGIN_NAME, "Failed to initialize as global plugin");
@@ -605,6 +783,7 @@ TSRemapInit(TSRemapInterface *api_info, char *errbuf, int errbuf_size)
     return TS_ERROR;
   }
 
+  add_check_cached_hook();
   TSDebug(PLUGIN_NAME, "background fetch remap is successfully initialized");
   return TS_SUCCESS;
 }
@@ -643,6 +822,7 @@ TSRemapNewInstance(int argc, char *argv[], void **ih, char * /* errbuf */, int /
   }
 
   if (success) {
+    BgFetchState::getInstance().setLimits(config);
     *ih = config;
 
     return TS_SUCCESS;
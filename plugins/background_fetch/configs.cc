@@ -23,6 +23,7 @@
 */
 
 #include <getopt.h>
+#include <algorithm>
 #include <cstdio>
 #include <memory.h>
 
@@ -37,6 +38,9 @@ BgFetchConfig::parseOptions(int argc, const char *argv[])
   static const struct option longopt[] = {{const_cast<char *>("log"), required_argument, nullptr, 'l'},
                                           {const_cast<char *>("config"), required_argument, nullptr, 'c'},
                                           {const_cast<char *>("allow-304"), no_argument, nullptr, 'a'},
+                                          {const_cast<char *>("max-fetches"), required_argument, nullptr, 'm'},
+                                          {const_cast<char *>("max-origin-fetches"), required_argument, nullptr, 'o'},
+                                          {const_cast<char *>("max-queued"), required_argument, nullptr, 'q'},
                                           {nullptr, no_argument, nullptr, '\0'}};
 
   while (true) {
@@ -62,6 +66,18 @@ BgFetchConfig::parseOptions(int argc, const char *argv[])
       TSDebug(PLUGIN_NAME, "option: --allow-304 set");
       _allow_304 = true;
       break;
+    case 'm':
+      _max_fetches = std::max(0, atoi(optarg));
+      TSDebug(PLUGIN_NAME, "option: --max-fetches=%d", _max_fetches);
+      break;
+    case 'o':
+      _max_origin_fetches = std::max(0, atoi(optarg));
+      TSDebug(PLUGIN_NAME, "option: --max-origin-fetches=%d", _max_origin_fetches);
+      break;
+    case 'q':
+      _max_queued = std::max(0, atoi(optarg));
+      TSDebug(PLUGIN_NAME, "option: --max-queued=%d", _max_queued);
+      break;
     default:
       TSError("[%s] invalid plugin option: %c", PLUGIN_NAME, opt);
       return false;
@@ -75,6 +75,24 @@ public:
     return _allow_304;
   }
 
+  int
+  maxFetches() const
+  {
+    return _max_fetches;
+  }
+
+  int
+  maxOriginFetches() const
+  {
+    return _max_origin_fetches;
+  }
+
+  int
+  maxQueued() const
+  {
+    return _max_queued;
+  }
+
   // This parses and populates the BgFetchRule linked list (_rules).
   bool readConfig(const char *file_name);
 
@@ -84,5 +102,8 @@ private:
   TSCont _cont        = nullptr;
   BgFetchRule *_rules = nullptr;
   bool _allow_304     = false;
+  int _max_fetches        = 0; // 0 is no limit
+  int _max_origin_fetches = 0;
+  int _max_queued         = 0;
   std::string _log_file;
 };
@@ -56,3 +56,28 @@ PromotionPolicy::create_stat(std::string_view name, std::string_view remap_ident
 
   return stat_id;
 }
+
+// The cache key URL (for now), since this has better lookup behavior when using e.g. the cachekey
+// plugin. The caller frees the URL with TSfree().
+char *
+PromotionPolicy::cacheKeyUrl(TSHttpTxn txnp, int *url_len) const
+{
+  char *url = nullptr;
+  TSMBuffer request;
+  TSMLoc req_hdr;
+
+  *url_len = 0;
+  if (TS_SUCCESS == TSHttpTxnClientReqGet(txnp, &request, &req_hdr)) {
+    TSMLoc c_url = TS_NULL_MLOC;
+
+    if (TS_SUCCESS == TSUrlCreate(request, &c_url)) {
+      if (TS_SUCCESS == TSHttpTxnCacheLookupUrlGet(txnp, request, c_url)) {
+        url = TSUrlStringGet(request, c_url, url_len);
+        TSHandleMLocRelease(request, TS_NULL_MLOC, c_url);
+      }
+    }
+    TSHandleMLocRelease(request, TS_NULL_MLOC, req_hdr);
+  }
+
+  return url;
+}
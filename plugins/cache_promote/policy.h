@@ -84,6 +84,7 @@ public:
 
   bool doSample() const;
   int create_stat(std::string_view name, std::string_view remap_identifier);
+  char *cacheKeyUrl(TSHttpTxn txnp, int *url_len) const;
 
   // These are pure virtual
   virtual bool doPromote(TSHttpTxn txnp)       = 0;
@@ -0,0 +1,184 @@
+/*
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+#include <algorithm>
+#include <functional>
+#include <string_view>
+
+#include "sketch_policy.h"
+
+#define MINIMUM_SKETCH_BUCKETS 64
+
+void
+SketchPolicy::resize()
+{
+  _counters.reset(new std::atomic<uint8_t>[SKETCH_ROWS * _buckets]);
+  _doorkeeper.reset(new std::atomic<uint64_t>[_buckets / 8 + 1]);
+  for (unsigned i = 0; i < SKETCH_ROWS * _buckets; ++i) {
+    _counters[i].store(0, std::memory_order_relaxed);
+  }
+  for (unsigned i = 0; i < _buckets / 8 + 1; ++i) {
+    _doorkeeper[i].store(0, std::memory_order_relaxed);
+  }
+  _additions.store(0, std::memory_order_relaxed);
+}
+
+// Halve all the counters and empty the doorkeeper. Requests counted meanwhile may be lost, which
+// does not matter for an estimate.
+void
+SketchPolicy::age()
+{
+  TSDebug(PLUGIN_NAME, "aging the sketch of %u buckets", _buckets);
+  for (unsigned i = 0; i < SKETCH_ROWS * _buckets; ++i) {
+    _counters[i].store(_counters[i].load(std::memory_order_relaxed) >> 1, std::memory_order_relaxed);
+  }
+  for (unsigned i = 0; i < _buckets / 8 + 1; ++i) {
+    _doorkeeper[i].store(0, std::memory_order_relaxed);
+  }
+  incrementStat(aged_id, 1);
+}
+
+bool
+SketchPolicy::parseOption(int opt, char *optarg)
+{
+  switch (opt) {
+  case 'b':
+    _buckets = static_cast<unsigned>(strtol(optarg, nullptr, 10));
+    if (_buckets < MINIMUM_SKETCH_BUCKETS) {
+      TSError("%s: Enforcing minimum sketch bucket size of %d", PLUGIN_NAME, MINIMUM_SKETCH_BUCKETS);
+      _buckets = MINIMUM_SKETCH_BUCKETS;
+    }
+    resize();
+    break;
+  case 'h':
+    _hits = static_cast<unsigned>(strtol(optarg, nullptr, 10));
+    if (_hits > MAXIMUM_SKETCH_HITS) {
+      TSError("%s: Enforcing maximum sketch hits of %d", PLUGIN_NAME, MAXIMUM_SKETCH_HITS);
+      _hits = MAXIMUM_SKETCH_HITS;
+    }
+    break;
+  case 'l':
+    _label = optarg;
+    break;
+  default:
+    // All other options are unsupported for this policy
+    return false;
+  }
+
+  return true;
+}
+
+bool
+SketchPolicy::doPromote(TSHttpTxn txnp)
+{
+  int url_len = 0;
+  char *url   = cacheKeyUrl(txnp, &url_len);
+
+  // Generally shouldn't happen ...
+  if (!url) {
+    return false;
+  }
+
+  TSDebug(PLUGIN_NAME, "SketchPolicy::doPromote(%.*s%s)", url_len > 100 ? 100 : url_len, url, url_len > 100 ? "..." : "");
+
+  // The rows and the doorkeeper bits are picked by double hashing one hash of the URL.
+  uint64_t hash = std::hash<std::string_view>{}(std::string_view(url, url_len));
+  uint64_t h1   = hash & 0xffffffff;
+  uint64_t h2   = (hash >> 32) | 1;
+
+  TSfree(url);
+
+  if ((_additions.fetch_add(1, std::memory_order_relaxed) + 1) % (10 * static_cast<uint64_t>(_buckets)) == 0) {
+    age();
+  }
+
+  // A URL seen for the first time only goes into the doorkeeper, the long tail never reaches the counters.
+  bool seen = true;
+  for (int i = 0; i < 2; ++i) {
+    uint64_t bit  = (h1 + (SKETCH_ROWS + i) * h2) % (8 * static_cast<uint64_t>(_buckets));
+    uint64_t mask = static_cast<uint64_t>(1) << (bit % 64);
+    if (!(_doorkeeper[bit / 64].fetch_or(mask, std::memory_order_relaxed) & mask)) {
+      seen = false;
+    }
+  }
+  if (!seen) {
+    incrementStat(first_seen_id, 1);
+    if (_hits <= 1) {
+      incrementStat(promoted_id, 1);
+      return true;
+    }
+    TSDebug(PLUGIN_NAME, "first seen, not promoted");
+    return false;
+  }
+
+  // Conservative update, only the smallest of the counters are incremented.
+  std::atomic<uint8_t> *counters[SKETCH_ROWS];
+  uint8_t values[SKETCH_ROWS];
+  uint8_t count = UINT8_MAX;
+
+  for (int i = 0; i < SKETCH_ROWS; ++i) {
+    counters[i] = &_counters[i * _buckets + (h1 + i * h2) % _buckets];
+    values[i]   = counters[i]->load(std::memory_order_relaxed);
+    count       = std::min(count, values[i]);
+  }
+  if (count < UINT8_MAX) {
+    for (int i = 0; i < SKETCH_ROWS; ++i) {
+      if (values[i] == count) {
+        counters[i]->compare_exchange_weak(values[i], count + 1, std::memory_order_relaxed);
+      }
+    }
+    ++count;
+  }
+
+  // The doorkeeper holds the first hit.
+  if (count + 1u >= _hits) {
+    TSDebug(PLUGIN_NAME, "promoted with %d hits", count + 1);
+    incrementStat(promoted_id, 1);
+    return true;
+  }
+
+  TSDebug(PLUGIN_NAME, "still not promoted, got %d hits so far", count + 1);
+  incrementStat(not_promoted_id, 1);
+  return false;
+}
+
+bool
+SketchPolicy::stats_add(const char *remap_id)
+
+{
+  std::string_view remap_identifier                 = remap_id;
+  const std::tuple<std::string_view, int *> stats[] = {
+    {"cache_hits", &cache_hits_id},            {"promoted", &promoted_id},
+    {"total_requests", &total_requests_id},    {"sketch_first_seen", &first_seen_id},
+    {"sketch_not_promoted", &not_promoted_id}, {"sketch_aged", &aged_id},
+  };
+
+  if (nullptr == remap_id) {
+    TSError("[%s] no remap identifier specified for for stats, no stats will be used", PLUGIN_NAME);
+    return false;
+  }
+
+  for (int ii = 0; ii < 6; ii++) {
+    std::string_view name = std::get<0>(stats[ii]);
+    int *id               = std::get<1>(stats[ii]);
+    if ((*(id) = create_stat(name, remap_identifier)) == TS_ERROR) {
+      return false;
+    }
+  }
+
+  return true;
+}
@@ -0,0 +1,78 @@
+/*
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+#pragma once
+
+#include <atomic>
+#include <memory>
+
+#include "policy.h"
+
+#define SKETCH_ROWS 4
+#define MAXIMUM_SKETCH_HITS 255
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+// The sketch based policy counts the URLs in a count-min sketch of <bucket> counters per row,
+// in front of which a doorkeeper (a bloom filter) absorbs the URLs seen only once. Objects are
+// promoted once their count reaches <hits>. The counters are halved after every 10 * <buckets>
+// requests counted, so that old hits age out. The memory is fixed, about 5 bytes per bucket, and
+// the updates are lock free.
+//
+class SketchPolicy : public PromotionPolicy
+{
+public:
+  SketchPolicy() : PromotionPolicy() { resize(); }
+
+  bool parseOption(int opt, char *optarg) override;
+  bool doPromote(TSHttpTxn txnp) override;
+  bool stats_add(const char *remap_id) override;
+
+  void
+  usage() const override
+  {
+    TSError("[%s] Usage: @plugin=%s.so @pparam=--policy=sketch @pparam=--buckets=<n> --hits=<m> --sample=<x>", PLUGIN_NAME,
+            PLUGIN_NAME);
+  }
+
+  const char *
+  policyName() const override
+  {
+    return "sketch";
+  }
+
+  const std::string
+  id() const override
+  {
+    return _label + ";sketch=b:" + std::to_string(_buckets) + ",h:" + std::to_string(_hits);
+  }
+
+private:
+  void resize();
+  void age();
+
+  unsigned _buckets = 1 << 16;
+  unsigned _hits    = 10;
+
+  std::unique_ptr<std::atomic<uint8_t>[]> _counters;    // SKETCH_ROWS rows of _buckets counters
+  std::unique_ptr<std::atomic<uint64_t>[]> _doorkeeper; // 8 bits per bucket
+  std::atomic<uint64_t> _additions{0};
+
+  // internal stats ids
+  int first_seen_id   = -1;
+  int not_promoted_id = -1;
+  int aged_id         = -1;
+};
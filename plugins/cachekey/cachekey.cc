@@ -21,8 +21,9 @@
  * @brief Cache key manipulation.
  */
 
-#include <cstring> /* strlen() */
-#include <sstream> /* istringstream */
+#include <algorithm> /* std::sort(), std::unique() */
+#include <cstring>   /* strlen() */
+#include <sstream>   /* istringstream */
 #include <utility>
 #include "cachekey.h"
 
@@ -88,36 +89,50 @@ containerToString(ContainerType &c, const String &sdelim, const String &delim)
   return result;
 }
 
-static void
-appendToContainer(StringSet &c, const String &s)
-{
-  c.insert(s);
-}
+/* Most queries have fewer parameters, they are filtered and sorted on the stack */
+static const size_t QUERY_PARAMS_MAX = 64;
 
+/**
+ * @brief Appends the query parameters to be added to the key, sorted and uniquified if required.
+ *
+ * The parameters are views into the query, the only copy is the append to the key.
+ */
 static void
-appendToContainer(StringList &c, const String &s)
+appendKeyQuery(String &key, const char *query, int length, const ConfigQuery &config)
 {
-  c.push_back(s);
-}
-
-template <typename T>
-static String
-getKeyQuery(const char *query, int length, const ConfigQuery &config)
-{
-  std::istringstream istr(String(query, length));
-  String token;
-  T container;
-
-  while (std::getline(istr, token, '&')) {
-    String::size_type pos(token.find_first_of('='));
-    String param(token.substr(0, pos == String::npos ? token.size() : pos));
-
-    if (config.toBeAdded(param)) {
-      ::appendToContainer(container, token);
+  StringView params[QUERY_PARAMS_MAX];
+  std::vector<StringView> moreParams;
+  size_t count = 0;
+
+  StringView rest(query, length);
+  while (!rest.empty()) {
+    StringView::size_type end = rest.find('&');
+    StringView token          = rest.substr(0, end);
+    rest.remove_prefix(StringView::npos == end ? rest.size() : end + 1);
+
+    if (config.toBeAdded(token.substr(0, token.find('=')))) {
+      if (count < QUERY_PARAMS_MAX) {
+        params[count++] = token;
+      } else {
+        if (moreParams.empty()) {
+          moreParams.assign(params, params + count);
+        }
+        moreParams.push_back(token);
+      }
     }
   }
 
-  return containerToString<T, typename T::const_iterator>(container, "?", "&");
+  StringView *begin = moreParams.empty() ? params : moreParams.data();
+  StringView *end   = moreParams.empty() ? params + count : moreParams.data() + moreParams.size();
+  if (config.toBeSorted()) {
+    std::sort(begin, end);
+    end = std::unique(begin, end);
+  }
+
+  for (StringView *param = begin; param != end; ++param) {
+    key.append(param == begin ? "?" : "&");
+    key.append(param->data(), param->size());
+  }
 }
 
 static void
@@ -178,13 +193,18 @@ getUri(TSMBuffer buf, TSMLoc url)
 {
   String uri;
   int uriLen;
-  const char *uriPtr = TSUrlStringGet(buf, url, &uriLen);
+  char *uriCopy      = nullptr;
+  const char *uriPtr = TSUrlStringViewGet(buf, url, &uriLen);
+  if (nullptr == uriPtr) {
+    /* Read only buffers cannot keep the string, fall back to a copy. */
+    uriPtr = uriCopy = TSUrlStringGet(buf, url, &uriLen);
+  }
   if (nullptr != uriPtr && 0 != uriLen) {
     uri.assign(uriPtr, uriLen);
-    TSfree((void *)uriPtr);
   } else {
     CacheKeyError("failed to get URI");
   }
+  TSfree(uriCopy);
   return uri;
 }
 
@@ -659,18 +679,8 @@ CacheKey::appendQuery(const ConfigQuery &config)
     return;
   }
 
-  /* Use the corresponding container based on whether we need
-   * to sort the parameters (set) or keep the order (list) */
-  String keyQuery;
-  if (config.toBeSorted()) {
-    keyQuery = getKeyQuery<StringSet>(query, length, config);
-  } else {
-    keyQuery = getKeyQuery<StringList>(query, length, config);
-  }
-
-  if (!keyQuery.empty()) {
-    _key.append(keyQuery);
-  }
+  /* Sort and uniquify the parameters or keep their order, straight into the key */
+  ::appendKeyQuery(_key, query, length, config);
 }
 
 /**
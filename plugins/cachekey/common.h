@@ -25,6 +25,7 @@
 
 #define PLUGIN_NAME "cachekey"
 
+#include <functional>
 #include <string>
 #include <string_view>
 #include <set>
@@ -33,7 +34,7 @@
 
 typedef std::string String;
 typedef std::string_view StringView;
-typedef std::set<std::string> StringSet;
+typedef std::set<std::string, std::less<>> StringSet; /* transparent, looked up by StringView without a copy */
 typedef std::list<std::string> StringList;
 typedef std::vector<std::string> StringVector;
 
@@ -48,9 +49,12 @@ void PrintToStdErr(const char *fmt, ...);
 #else /* CACHEKEY_UNIT_TEST */
 #include "ts/ts.h"
 
-#define CacheKeyDebug(fmt, ...)                                                           \
-  do {                                                                                    \
-    TSDebug(PLUGIN_NAME, "%s:%d:%s() " fmt, __FILE__, __LINE__, __func__, ##__VA_ARGS__); \
+/* The arguments are only evaluated with the debug tag set, some build strings, i.e. the URI */
+#define CacheKeyDebug(fmt, ...)                                                             \
+  do {                                                                                      \
+    if (TSIsDebugTagSet(PLUGIN_NAME)) {                                                     \
+      TSDebug(PLUGIN_NAME, "%s:%d:%s() " fmt, __FILE__, __LINE__, __func__, ##__VA_ARGS__); \
+    }                                                                                       \
   } while (0)
 
 #define CacheKeyError(fmt, ...)                                                           \
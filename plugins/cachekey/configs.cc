@@ -154,24 +154,27 @@ ConfigElements::toBeSorted() const
 }
 
 bool
-ConfigElements::toBeAdded(const String &element) const
+ConfigElements::toBeAdded(StringView element) const
 {
-  /* Exclude the element if it is in the exclusion list. If the list is empty don't exclude anything. */
+  int len = static_cast<int>(element.size());
+
+  /* Exclude the element if it is in the exclusion list. If the list is empty don't exclude anything.
+   * The lists are looked up without a copy of the element, only the patterns need one. */
   bool exclude = (!_exclude.empty() && _exclude.find(element) != _exclude.end()) ||
-                 (!_excludePatterns.empty() && _excludePatterns.match(element));
-  CacheKeyDebug("%s '%s' %s the 'exclude' rule", name().c_str(), element.c_str(), exclude ? "matches" : "does not match");
+                 (!_excludePatterns.empty() && _excludePatterns.match(String(element)));
+  CacheKeyDebug("%s '%.*s' %s the 'exclude' rule", name().c_str(), len, element.data(), exclude ? "matches" : "does not match");
 
   /* Include the element only if it is in the inclusion list. If the list is empty include everything. */
-  bool include =
-    ((_include.empty() && _includePatterns.empty()) || _include.find(element) != _include.end()) || _includePatterns.match(element);
-  CacheKeyDebug("%s '%s' %s the 'include' rule", name().c_str(), element.c_str(), include ? "matches" : "do not match");
+  bool include = ((_include.empty() && _includePatterns.empty()) || _include.find(element) != _include.end()) ||
+                 (!_includePatterns.empty() && _includePatterns.match(String(element)));
+  CacheKeyDebug("%s '%.*s' %s the 'include' rule", name().c_str(), len, element.data(), include ? "matches" : "do not match");
 
   if (include && !exclude) {
-    CacheKeyDebug("%s '%s' should be added to cache key", name().c_str(), element.c_str());
+    CacheKeyDebug("%s '%.*s' should be added to cache key", name().c_str(), len, element.data());
     return true;
   }
 
-  CacheKeyDebug("%s '%s' should not be added to cache key", name().c_str(), element.c_str());
+  CacheKeyDebug("%s '%.*s' should not be added to cache key", name().c_str(), len, element.data());
   return false;
 }
 
@@ -72,7 +72,7 @@ public:
   /** @brief shows if the processing of elements is to be skipped */
   bool toBeSkipped() const;
   /** @brief shows if the element is to be included in the result */
-  bool toBeAdded(const String &element) const;
+  bool toBeAdded(StringView element) const;
   /** @brief returns the configuration element name for debug logging */
   virtual const String &name() const = 0;
 
@@ -21,7 +21,9 @@
   limitations under the License.
  */
 
+#include <chrono>
 #include <cstring>
+#include <string>
 #include <zlib.h>
 
 #include "ink_autoconf.h"
@@ -30,6 +32,10 @@
 #include <brotli/encode.h>
 #endif
 
+#if HAVE_ZSTD_H
+#include <zstd.h>
+#endif
+
 #include "ts/ts.h"
 #include "tscore/ink_defs.h"
 
@@ -57,6 +63,8 @@ const int ZLIB_COMPRESSION_LEVEL = 6;
 const char *dictionary           = nullptr;
 const char *TS_HTTP_VALUE_BROTLI = "br";
 const int TS_HTTP_LEN_BROTLI     = 2;
+const char *TS_HTTP_VALUE_ZSTD   = "zstd";
+const int TS_HTTP_LEN_ZSTD       = 4;
 
 // brotli compression quality 1-11. Testing proved level '6'
 #if HAVE_BROTLI_ENCODE_H
@@ -66,12 +74,43 @@ const int BROTLI_LGW               = 16;
 
 static const char *global_hidden_header_name = nullptr;
 
+// The bytes in, the bytes out and the microseconds spent compressing, per content encoding.
+enum CompressEncoding { ENCODING_DEFLATE, ENCODING_GZIP, ENCODING_BROTLI, ENCODING_ZSTD, ENCODING_COUNT };
+enum CompressStat { STAT_BYTES_IN, STAT_BYTES_OUT, STAT_USEC, STAT_COUNT };
+
+static const char *encoding_names[ENCODING_COUNT] = {"deflate", "gzip", "br", "zstd"};
+static const char *stat_names[STAT_COUNT]         = {"bytes_in", "bytes_out", "usec"};
+static int compress_stats[ENCODING_COUNT][STAT_COUNT];
+
 // Current global configuration, and the previous one (for cleanup)
 Configuration *cur_config  = nullptr;
 Configuration *prev_config = nullptr;
 
+static void
+register_stats()
+{
+  for (int encoding = 0; encoding < ENCODING_COUNT; ++encoding) {
+    for (int stat = 0; stat < STAT_COUNT; ++stat) {
+      std::string name = std::string("plugin.compress.") + encoding_names[encoding] + "." + stat_names[stat];
+      int *id          = &compress_stats[encoding][stat];
+
+      if (TSStatFindName(name.c_str(), id) == TS_ERROR) {
+        *id = TSStatCreate(name.c_str(), TS_RECORDDATATYPE_COUNTER, TS_STAT_NON_PERSISTENT, TS_STAT_SYNC_SUM);
+      }
+    }
+  }
+}
+
+static void
+record_compression(Data *data, int encoding)
+{
+  TSStatIntIncrement(compress_stats[encoding][STAT_BYTES_IN], data->upstream_length);
+  TSStatIntIncrement(compress_stats[encoding][STAT_BYTES_OUT], data->downstream_length);
+  TSStatIntIncrement(compress_stats[encoding][STAT_USEC], data->compress_nsec / 1000);
+}
+
 static Data *
-data_alloc(int compression_type, int compression_algorithms)
+data_alloc(int compression_type, int compression_algorithms, HostConfiguration *hc)
 {
   Data *data;
   int err;
@@ -81,6 +120,8 @@ data_alloc(int compression_type, int compression_algorithms)
   data->downstream_buffer      = nullptr;
   data->downstream_reader      = nullptr;
   data->downstream_length      = 0;
+  data->upstream_length        = 0;
+  data->compress_nsec          = 0;
   data->state                  = transform_state_initialized;
   data->compression_type       = compression_type;
   data->compression_algorithms = compression_algorithms;
@@ -129,6 +170,23 @@ data_alloc(int compression_type, int compression_algorithms)
     data->bstrm.avail_out = 0;
     data->bstrm.total_out = 0;
   }
+#endif
+#if HAVE_ZSTD_H
+  data->zstd_cctx = nullptr;
+  if ((compression_type & COMPRESSION_TYPE_ZSTD) && (compression_algorithms & ALGORITHM_ZSTD)) {
+    debug("zstd compression. Create zstd compression context.");
+    data->zstd_cctx = ZSTD_createCCtx();
+    if (!data->zstd_cctx) {
+      fatal("zstd compression context creation failed");
+    }
+    if (hc->zstd_cdict()) {
+      ZSTD_CCtx_refCDict(data->zstd_cctx, hc->zstd_cdict());
+    } else {
+      ZSTD_CCtx_setParameter(data->zstd_cctx, ZSTD_c_compressionLevel, ZSTD_COMPRESSION_LEVEL);
+    }
+  }
+#else
+  (void)hc;
 #endif
   return data;
 }
@@ -150,6 +208,9 @@ data_destroy(Data *data)
 #if HAVE_BROTLI_ENCODE_H
   BrotliEncoderDestroyInstance(data->bstrm.br);
 #endif
+#if HAVE_ZSTD_H
+  ZSTD_freeCCtx(data->zstd_cctx);
+#endif
 
   TSfree(data);
 }
@@ -162,7 +223,10 @@ content_encoding_header(TSMBuffer bufp, TSMLoc hdr_loc, const int compression_ty
   const char *value = nullptr;
   int value_len     = 0;
   // Delete Content-Encoding if present???
-  if (compression_type & COMPRESSION_TYPE_BROTLI && (algorithm & ALGORITHM_BROTLI)) {
+  if (compression_type & COMPRESSION_TYPE_ZSTD && (algorithm & ALGORITHM_ZSTD)) {
+    value     = TS_HTTP_VALUE_ZSTD;
+    value_len = TS_HTTP_LEN_ZSTD;
+  } else if (compression_type & COMPRESSION_TYPE_BROTLI && (algorithm & ALGORITHM_BROTLI)) {
     value     = TS_HTTP_VALUE_BROTLI;
     value_len = TS_HTTP_LEN_BROTLI;
   } else if (compression_type & COMPRESSION_TYPE_GZIP && (algorithm & ALGORITHM_GZIP)) {
@@ -400,11 +464,51 @@ brotli_transform_one(Data *data, const char *upstream_buffer, int64_t upstream_l
 }
 #endif
 
+#if HAVE_ZSTD_H
+static bool
+zstd_compress_operation(Data *data, const char *upstream_buffer, int64_t upstream_length, ZSTD_EndDirective mode)
+{
+  TSIOBufferBlock downstream_blkp;
+  int64_t downstream_length;
+  ZSTD_inBuffer in = {upstream_buffer, static_cast<size_t>(upstream_length), 0};
+
+  for (;;) {
+    downstream_blkp         = TSIOBufferStart(data->downstream_buffer);
+    char *downstream_buffer = TSIOBufferBlockWriteStart(downstream_blkp, &downstream_length);
+    ZSTD_outBuffer out      = {downstream_buffer, static_cast<size_t>(downstream_length), 0};
+
+    size_t remaining = ZSTD_compressStream2(data->zstd_cctx, &out, &in, mode);
+    if (ZSTD_isError(remaining)) {
+      error("ZSTD_compressStream2(%d) call failed: %s", mode, ZSTD_getErrorName(remaining));
+      return false;
+    }
+
+    TSIOBufferProduce(data->downstream_buffer, out.pos);
+    data->downstream_length += out.pos;
+
+    // a flush or an end is done when nothing remains buffered in zstd
+    if (mode == ZSTD_e_continue ? in.pos == in.size : remaining == 0) {
+      return true;
+    }
+  }
+}
+
+static void
+zstd_transform_one(Data *data, const char *upstream_buffer, int64_t upstream_length)
+{
+  if (!zstd_compress_operation(data, upstream_buffer, upstream_length, data->hc->flush() ? ZSTD_e_flush : ZSTD_e_continue)) {
+    error("zstd compression of %" PRId64 " bytes failed", upstream_length);
+  }
+}
+#endif
+
 static void
 compress_transform_one(Data *data, TSIOBufferReader upstream_reader, int amount)
 {
   TSIOBufferBlock downstream_blkp;
   int64_t upstream_length;
+  auto start = std::chrono::steady_clock::now();
+
   while (amount > 0) {
     downstream_blkp = TSIOBufferReaderStart(upstream_reader);
     if (!downstream_blkp) {
@@ -422,8 +526,13 @@ compress_transform_one(Data *data, TSIOBufferReader upstream_reader, int amount)
       upstream_length = amount;
     }
 
+#if HAVE_ZSTD_H
+    if (data->compression_type & COMPRESSION_TYPE_ZSTD && (data->compression_algorithms & ALGORITHM_ZSTD)) {
+      zstd_transform_one(data, upstream_buffer, upstream_length);
+    } else
+#endif
 #if HAVE_BROTLI_ENCODE_H
-    if (data->compression_type & COMPRESSION_TYPE_BROTLI && (data->compression_algorithms & ALGORITHM_BROTLI)) {
+      if (data->compression_type & COMPRESSION_TYPE_BROTLI && (data->compression_algorithms & ALGORITHM_BROTLI)) {
       brotli_transform_one(data, upstream_buffer, upstream_length);
     } else
 #endif
@@ -435,8 +544,11 @@ compress_transform_one(Data *data, TSIOBufferReader upstream_reader, int amount)
     }
 
     TSIOBufferReaderConsume(upstream_reader, upstream_length);
+    data->upstream_length += upstream_length;
     amount -= upstream_length;
   }
+
+  data->compress_nsec += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
 }
 
 static void
@@ -506,22 +618,63 @@ brotli_transform_finish(Data *data)
 }
 #endif
 
+#if HAVE_ZSTD_H
+static void
+zstd_transform_finish(Data *data)
+{
+  if (data->state != transform_state_output) {
+    return;
+  }
+
+  data->state = transform_state_finished;
+
+  if (!zstd_compress_operation(data, nullptr, 0, ZSTD_e_end)) {
+    error("zstd compression end failed");
+    return;
+  }
+
+  debug("zstd-transform: Finished zstd");
+  log_compression_ratio(data->upstream_length, data->downstream_length);
+}
+#endif
+
 static void
 compress_transform_finish(Data *data)
 {
+  int encoding;
+
+  if (data->state != transform_state_output) {
+    return;
+  }
+
+  auto start = std::chrono::steady_clock::now();
+
+#if HAVE_ZSTD_H
+  if (data->compression_type & COMPRESSION_TYPE_ZSTD && data->compression_algorithms & ALGORITHM_ZSTD) {
+    zstd_transform_finish(data);
+    encoding = ENCODING_ZSTD;
+    debug("compress_transform_finish: zstd compression finish");
+  } else
+#endif
 #if HAVE_BROTLI_ENCODE_H
-  if (data->compression_type & COMPRESSION_TYPE_BROTLI && data->compression_algorithms & ALGORITHM_BROTLI) {
+    if (data->compression_type & COMPRESSION_TYPE_BROTLI && data->compression_algorithms & ALGORITHM_BROTLI) {
     brotli_transform_finish(data);
+    encoding = ENCODING_BROTLI;
     debug("compress_transform_finish: brotli compression finish");
   } else
 #endif
     if ((data->compression_type & (COMPRESSION_TYPE_GZIP | COMPRESSION_TYPE_DEFLATE)) &&
         (data->compression_algorithms & (ALGORITHM_GZIP | ALGORITHM_DEFLATE))) {
     gzip_transform_finish(data);
+    encoding = (data->compression_type & COMPRESSION_TYPE_DEFLATE) ? ENCODING_DEFLATE : ENCODING_GZIP;
     debug("compress_transform_finish: gzip compression finish");
   } else {
     error("No Compression matched, shouldn't come here");
+    return;
   }
+
+  data->compress_nsec += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+  record_compression(data, encoding);
 }
 
 static void
@@ -682,7 +835,12 @@ transformable(TSHttpTxn txnp, bool server, HostConfiguration *host_configuration
         continue;
       }
 
-      if (strncasecmp(value, "br", sizeof("br") - 1) == 0) {
+      if (strncasecmp(value, "zstd", sizeof("zstd") - 1) == 0) {
+        if (*algorithms & ALGORITHM_ZSTD) {
+          compression_acceptable = 1;
+        }
+        *compress_type |= COMPRESSION_TYPE_ZSTD;
+      } else if (strncasecmp(value, "br", sizeof("br") - 1) == 0) {
         if (*algorithms & ALGORITHM_BROTLI) {
           compression_acceptable = 1;
         }
@@ -772,7 +930,11 @@ compress_transform_add(TSHttpTxn txnp, HostConfiguration *hc, int compress_type,
 
   TSHttpTxnUntransformedRespCache(txnp, 1);
 
-  if (!hc->cache()) {
+  if (hc->cache_compressed_alternate()) {
+    // the compressed variant is an alternate of its own, later requests accepting it are served without compressing
+    debug("TransformedRespCache  enabled as an alternate");
+    TSHttpTxnTransformedRespCache(txnp, 1);
+  } else if (!hc->cache()) {
     debug("TransformedRespCache  not enabled");
     TSHttpTxnTransformedRespCache(txnp, 0);
   } else {
@@ -782,7 +944,7 @@ compress_transform_add(TSHttpTxn txnp, HostConfiguration *hc, int compress_type,
   }
 
   connp     = TSTransformCreate(compress_transform, txnp);
-  data      = data_alloc(compress_type, algorithms);
+  data      = data_alloc(compress_type, algorithms, hc);
   data->txn = txnp;
   data->hc  = hc;
 
@@ -995,6 +1157,7 @@ TSPluginInit(int argc, const char *argv[])
   if (!register_plugin()) {
     fatal("the compress plugin failed to register");
   }
+  register_stats();
 
   info("TSPluginInit %s", argv[0]);
 
@@ -1033,6 +1196,7 @@ TSRemapInit(TSRemapInterface *api_info, char *errbuf, int errbuf_size)
     return TS_ERROR;
   }
 
+  register_stats();
   info("The compress plugin is successfully initialized");
   return TS_SUCCESS;
 }
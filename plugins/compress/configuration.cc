@@ -24,6 +24,7 @@
 #include "ink_autoconf.h"
 #include "configuration.h"
 #include <fstream>
+#include <iterator>
 #include <algorithm>
 #include <vector>
 #include <fnmatch.h>
@@ -105,9 +106,11 @@ enum ParserState {
   kParseRemoveAcceptEncoding,
   kParseEnable,
   kParseCache,
+  kParseCacheCompressedAlternate,
   kParseFlush,
   kParseAllow,
-  kParseMinimumContentLength
+  kParseMinimumContentLength,
+  kParseZstdDictionary
 };
 
 void
@@ -116,6 +119,13 @@ Configuration::add_host_configuration(HostConfiguration *hc)
   host_configurations_.push_back(hc);
 }
 
+HostConfiguration::~HostConfiguration()
+{
+#if HAVE_ZSTD_H
+  ZSTD_freeCDict(zstd_cdict_);
+#endif
+}
+
 void
 HostConfiguration::update_defaults()
 {
@@ -238,8 +248,14 @@ HostConfiguration::add_compression_algorithms(string &line)
       compression_algorithms_ |= ALGORITHM_GZIP;
     } else if (token == "deflate") {
       compression_algorithms_ |= ALGORITHM_DEFLATE;
+    } else if (token == "zstd") {
+#ifdef HAVE_ZSTD_H
+      compression_algorithms_ |= ALGORITHM_ZSTD;
+#else
+      error("supported-algorithms: zstd support not compiled in.");
+#endif
     } else {
-      error("Unknown compression type. Supported compression-algorithms <br,gzip,deflate>.");
+      error("Unknown compression type. Supported compression-algorithms <zstd,br,gzip,deflate>.");
     }
   }
 }
@@ -269,6 +285,39 @@ HostConfiguration::compression_algorithms()
   return compression_algorithms_;
 }
 
+void
+HostConfiguration::set_zstd_dictionary(const std::string &path)
+{
+#if HAVE_ZSTD_H
+  string pathstring(path);
+
+  if (!pathstring.empty() && pathstring[0] != '/') {
+    pathstring.assign(TSConfigDirGet());
+    pathstring.append("/");
+    pathstring.append(path);
+  }
+
+  std::ifstream f(pathstring, std::ios::in | std::ios::binary);
+  string dictionary((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+
+  if (!f.is_open() || dictionary.empty()) {
+    error("zstd-dictionary: could not read the dictionary [%s]", pathstring.c_str());
+    return;
+  }
+
+  ZSTD_freeCDict(zstd_cdict_);
+  zstd_cdict_ = ZSTD_createCDict(dictionary.data(), dictionary.size(), ZSTD_COMPRESSION_LEVEL);
+  if (zstd_cdict_ == nullptr) {
+    error("zstd-dictionary: could not load the dictionary [%s]", pathstring.c_str());
+    return;
+  }
+  info("zstd-dictionary: loaded [%s], %zu bytes, id %u", pathstring.c_str(), dictionary.size(),
+       ZSTD_getDictID_fromDict(dictionary.data(), dictionary.size()));
+#else
+  error("zstd-dictionary: zstd support not compiled in, ignoring [%s].", path.c_str());
+#endif
+}
+
 Configuration *
 Configuration::Parse(const char *path)
 {
@@ -347,6 +396,8 @@ Configuration::Parse(const char *path)
           state = kParseEnable;
         } else if (token == "cache") {
           state = kParseCache;
+        } else if (token == "cache-compressed-alternate") {
+          state = kParseCacheCompressedAlternate;
         } else if (token == "flush") {
           state = kParseFlush;
         } else if (token == "supported-algorithms") {
@@ -359,6 +410,8 @@ Configuration::Parse(const char *path)
           state = kParseStart;
         } else if (token == "minimum-content-length") {
           state = kParseMinimumContentLength;
+        } else if (token == "zstd-dictionary") {
+          state = kParseZstdDictionary;
         } else {
           warning("failed to interpret \"%s\" at line %zu", token.c_str(), lineno);
         }
@@ -379,6 +432,10 @@ Configuration::Parse(const char *path)
         current_host_configuration->set_cache(token == "true");
         state = kParseStart;
         break;
+      case kParseCacheCompressedAlternate:
+        current_host_configuration->set_cache_compressed_alternate(token == "true");
+        state = kParseStart;
+        break;
       case kParseFlush:
         current_host_configuration->set_flush(token == "true");
         state = kParseStart;
@@ -391,6 +448,10 @@ Configuration::Parse(const char *path)
         current_host_configuration->set_minimum_content_length(strtoul(token.c_str(), nullptr, 10));
         state = kParseStart;
         break;
+      case kParseZstdDictionary:
+        current_host_configuration->set_zstd_dictionary(token);
+        state = kParseStart;
+        break;
       }
     }
   }
@@ -30,6 +30,10 @@
 #include "ts/ts.h"
 #include "tscpp/api/noncopyable.h"
 
+#if HAVE_ZSTD_H
+#include <zstd.h>
+#endif
+
 namespace Gzip
 {
 typedef std::vector<std::string> StringContainer;
@@ -38,9 +42,15 @@ enum CompressionAlgorithm {
   ALGORITHM_DEFAULT = 0,
   ALGORITHM_DEFLATE = 1,
   ALGORITHM_GZIP    = 2,
-  ALGORITHM_BROTLI  = 4 // For bit manipulations
+  ALGORITHM_BROTLI  = 4, // For bit manipulations
+  ALGORITHM_ZSTD    = 8
 };
 
+#if HAVE_ZSTD_H
+// zstd compression level 1-19, '3' is the default of the zstd library
+const int ZSTD_COMPRESSION_LEVEL = 3;
+#endif
+
 class HostConfiguration : private atscppapi::noncopyable
 {
 public:
@@ -48,12 +58,14 @@ public:
     : host_(host),
       enabled_(true),
       cache_(true),
+      cache_compressed_alternate_(false),
       remove_accept_encoding_(false),
       flush_(false),
       compression_algorithms_(ALGORITHM_GZIP),
       minimum_content_length_(1024)
   {
   }
+  ~HostConfiguration();
 
   bool
   enabled()
@@ -76,6 +88,16 @@ public:
     cache_ = x;
   }
   bool
+  cache_compressed_alternate()
+  {
+    return cache_compressed_alternate_;
+  }
+  void
+  set_cache_compressed_alternate(bool x)
+  {
+    cache_compressed_alternate_ = x;
+  }
+  bool
   flush()
   {
     return flush_;
@@ -126,15 +148,27 @@ public:
   bool is_status_code_compressible(const TSHttpStatus status_code) const;
   void add_compression_algorithms(std::string &algorithms);
   int compression_algorithms();
+  void set_zstd_dictionary(const std::string &path);
+#if HAVE_ZSTD_H
+  const ZSTD_CDict *
+  zstd_cdict() const
+  {
+    return zstd_cdict_;
+  }
+#endif
 
 private:
   std::string host_;
   bool enabled_;
   bool cache_;
+  bool cache_compressed_alternate_;
   bool remove_accept_encoding_;
   bool flush_;
   int compression_algorithms_;
   unsigned int minimum_content_length_;
+#if HAVE_ZSTD_H
+  ZSTD_CDict *zstd_cdict_ = nullptr;
+#endif
 
   StringContainer compressible_content_types_;
   StringContainer allows_;
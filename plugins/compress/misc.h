@@ -32,6 +32,10 @@
 #include <brotli/encode.h>
 #endif
 
+#if HAVE_ZSTD_H
+#include <zstd.h>
+#endif
+
 #include "configuration.h"
 
 using namespace Gzip;
@@ -46,7 +50,8 @@ enum CompressionType {
   COMPRESSION_TYPE_DEFAULT = 0,
   COMPRESSION_TYPE_DEFLATE = 1,
   COMPRESSION_TYPE_GZIP    = 2,
-  COMPRESSION_TYPE_BROTLI  = 4
+  COMPRESSION_TYPE_BROTLI  = 4,
+  COMPRESSION_TYPE_ZSTD    = 8
 };
 
 // this one is used to rename the accept encoding header
@@ -79,6 +84,8 @@ typedef struct {
   TSIOBuffer downstream_buffer;
   TSIOBufferReader downstream_reader;
   int downstream_length;
+  int64_t upstream_length;
+  int64_t compress_nsec; // the effort spent on compressing
   z_stream zstrm;
   enum transform_state state;
   int compression_type;
@@ -86,6 +93,9 @@ typedef struct {
 #if HAVE_BROTLI_ENCODE_H
   b_stream bstrm;
 #endif
+#if HAVE_ZSTD_H
+  ZSTD_CCtx *zstd_cctx;
+#endif
 } Data;
 
 voidpf gzip_alloc(voidpf opaque, uInt items, uInt size);
@@ -29,6 +29,7 @@
 #include <cstring>
 #include <string>
 #include <list>
+#include <memory>
 #include <arpa/inet.h>
 #include <getopt.h>
 
@@ -46,6 +47,7 @@
 #include "serverIntercept.h"
 #include "Stats.h"
 #include "HttpDataFetcherImpl.h"
+#include "NodeListCache.h"
 using std::string;
 using std::list;
 using namespace EsiLib;
@@ -56,9 +58,11 @@ struct OptionInfo {
   bool private_response;
   bool disable_gzip_output;
   bool first_byte_flush;
+  int include_timeout;
 };
 
 static HandlerManager *gHandlerManager = nullptr;
+static NodeListCache *gNodeListCache   = nullptr;
 static Utils::HeaderValueList gAllowlistCookies;
 
 #define DEBUG_TAG "plugin_esi"
@@ -111,6 +115,8 @@ struct ContData {
   sockaddr const *client_addr;
   DataType input_type;
   string packed_node_list;
+  string node_list_key;
+  std::shared_ptr<const string> parsed_node_list;
   string gzipped_data;
   char debug_tag[32];
   bool gzip_output;
@@ -158,6 +164,8 @@ struct ContData {
 
   void getServerState();
 
+  void getNodeListKey(TSMBuffer bufp, TSMLoc hdr_loc);
+
   void checkXformStatus();
 
   bool init();
@@ -253,6 +261,7 @@ ContData::init()
     if (!data_fetcher) {
       data_fetcher = new HttpDataFetcherImpl(contp, client_addr, createDebugTag(FETCHER_DEBUG_TAG, contp, fetcher_tag));
     }
+    data_fetcher->setFetchTimeout(option_info->include_timeout);
     if (!esi_vars) {
       esi_vars = new Variables(createDebugTag(VARS_DEBUG_TAG, contp, vars_tag), &TSDebug, &TSError, gAllowlistCookies);
     }
@@ -264,6 +273,20 @@ ContData::init()
     esi_gzip   = new EsiGzip(createDebugTag(GZIP_DEBUG_TAG, contp, gzip_tag), &TSDebug, &TSError);
     esi_gunzip = new EsiGunzip(createDebugTag(GUNZIP_DEBUG_TAG, contp, gunzip_tag), &TSDebug, &TSError);
 
+    if (parsed_node_list) {
+      // the includes are fetched right away, the document itself is only drained
+      TSDebug(debug_tag, "[%s] Using parsed node list of size %d", __FUNCTION__, static_cast<int>(parsed_node_list->size()));
+      Stats::increment(Stats::N_NODE_LIST_HITS);
+      if (esi_proc->useParsedNodeList(*parsed_node_list) == EsiProcessor::UNPACK_FAILURE) {
+        gNodeListCache->remove(node_list_key);
+        parsed_node_list.reset();
+        esi_proc->start();
+      }
+    }
+    if (!node_list_key.empty() && !parsed_node_list) {
+      esi_proc->retainParsedNodeList();
+    }
+
     TSDebug(debug_tag, "[%s] Set input data type to [%s]", __FUNCTION__, DATA_TYPE_NAMES_[input_type]);
 
     retval = true;
@@ -475,9 +498,53 @@ ContData::getServerState()
     fillPostHeader(bufp, hdr_loc);
   }
 
+  if (gNodeListCache && cache_txn && !head_only && request_url) {
+    getNodeListKey(bufp, hdr_loc);
+    if (!node_list_key.empty()) {
+      parsed_node_list = gNodeListCache->get(node_list_key);
+    }
+  }
+
   TSHandleMLocRelease(bufp, TS_NULL_MLOC, hdr_loc);
 }
 
+// The identity of the cached document: its URL and the headers that tell its versions apart.
+void
+ContData::getNodeListKey(TSMBuffer bufp, TSMLoc hdr_loc)
+{
+  const struct {
+    const char *name;
+    int name_len;
+    bool version; // whether the field tells versions apart on its own
+  } fields[] = {
+    {TS_MIME_FIELD_DATE, TS_MIME_LEN_DATE, true},
+    {TS_MIME_FIELD_LAST_MODIFIED, TS_MIME_LEN_LAST_MODIFIED, true},
+    {TS_MIME_FIELD_ETAG, TS_MIME_LEN_ETAG, true},
+    {TS_MIME_FIELD_CONTENT_LENGTH, TS_MIME_LEN_CONTENT_LENGTH, false},
+    {TS_MIME_FIELD_CONTENT_ENCODING, TS_MIME_LEN_CONTENT_ENCODING, false},
+  };
+  bool versioned = false;
+
+  node_list_key.assign(request_url);
+  for (const auto &field : fields) {
+    node_list_key.append(1, '\n');
+    TSMLoc field_loc = TSMimeHdrFieldFind(bufp, hdr_loc, field.name, field.name_len);
+    if (field_loc) {
+      int value_len;
+      const char *value = TSMimeHdrFieldValueStringGet(bufp, hdr_loc, field_loc, -1, &value_len);
+      if (value && value_len) {
+        node_list_key.append(value, value_len);
+        versioned = versioned || field.version;
+      }
+      TSHandleMLocRelease(bufp, hdr_loc, field_loc);
+    }
+  }
+  if (!versioned) {
+    TSDebug(debug_tag, "[%s] No date or validator in cached response; not caching its node list", __FUNCTION__);
+    node_list_key.clear();
+  }
+}
+
 ContData::~ContData()
 {
   TSDebug(debug_tag, "[%s] Destroying continuation data", __FUNCTION__);
@@ -674,7 +741,9 @@ transformData(TSCont contp)
         // Now start extraction
         while (block != nullptr) {
           data = TSIOBufferBlockReadStart(block, cont_data->input_reader, &data_len);
-          if (cont_data->input_type == DATA_TYPE_RAW_ESI) {
+          if (cont_data->parsed_node_list) {
+            // already have the parsed document
+          } else if (cont_data->input_type == DATA_TYPE_RAW_ESI) {
             cont_data->esi_proc->addParseData(data, data_len);
           } else if (cont_data->input_type == DATA_TYPE_GZIPPED_ESI) {
             string udata = "";
@@ -722,7 +791,7 @@ transformData(TSCont contp)
       }
     }
 
-    if (cont_data->input_type != DATA_TYPE_PACKED_ESI) {
+    if ((cont_data->input_type != DATA_TYPE_PACKED_ESI) && !cont_data->parsed_node_list) {
       bool gunzip_complete = true;
       if (cont_data->input_type == DATA_TYPE_GZIPPED_ESI) {
         gunzip_complete = cont_data->esi_gunzip->stream_finish();
@@ -732,6 +801,11 @@ transformData(TSCont contp)
             !cont_data->head_only) {
           cacheNodeList(cont_data);
         }
+        if (!cont_data->node_list_key.empty()) {
+          string parsed_node_list;
+          cont_data->esi_proc->packParsedNodeList(parsed_node_list);
+          gNodeListCache->put(cont_data->node_list_key, std::move(parsed_node_list));
+        }
       }
     }
 
@@ -945,6 +1019,10 @@ transformHandler(TSCont contp, TSEvent event, void *edata)
         }
       }
     }
+    if (!process_event && is_fetch_event) {
+      // responses of timed out includes still come in, the fetcher has to see them all
+      cont_data->data_fetcher->handleFetchEvent(event, edata);
+    }
   }
 
   if (process_event) {
@@ -1004,9 +1082,10 @@ transformHandler(TSCont contp, TSEvent event, void *edata)
   TSDebug(cont_data->debug_tag, "[%s] transformHandler, event: %d, curr_state: %d", __FUNCTION__, static_cast<int>(event),
           static_cast<int>(cont_data->curr_state));
 
-  shutdown = (cont_data->xform_closed && (cont_data->curr_state == ContData::PROCESSING_COMPLETE));
+  shutdown = (cont_data->xform_closed && (cont_data->curr_state == ContData::PROCESSING_COMPLETE) &&
+              !cont_data->data_fetcher->getNumTimedOutRequests());
   if (shutdown) {
-    if (process_event && is_fetch_event) {
+    if (is_fetch_event) {
       // we need to return control to the fetch API to give up it's
       // lock on our continuation which will fail if we destroy
       // ourselves right now
@@ -1596,11 +1675,13 @@ esiPluginInit(int argc, const char *argv[], struct OptionInfo *pOptionInfo)
       {const_cast<char *>("disable-gzip-output"), no_argument, nullptr, 'z'},
       {const_cast<char *>("first-byte-flush"), no_argument, nullptr, 'b'},
       {const_cast<char *>("handler-filename"), required_argument, nullptr, 'f'},
+      {const_cast<char *>("include-timeout"), required_argument, nullptr, 't'},
+      {const_cast<char *>("node-list-cache"), required_argument, nullptr, 'c'},
       {nullptr, 0, nullptr, 0},
     };
 
     int longindex = 0;
-    while ((c = getopt_long(argc, const_cast<char *const *>(argv), "npzbf:", longopts, &longindex)) != -1) {
+    while ((c = getopt_long(argc, const_cast<char *const *>(argv), "npzbf:t:c:", longopts, &longindex)) != -1) {
       switch (c) {
       case 'n':
         pOptionInfo->packed_node_support = true;
@@ -1620,6 +1701,17 @@ esiPluginInit(int argc, const char *argv[], struct OptionInfo *pOptionInfo)
         gHandlerManager->loadObjects(handler_conf);
         break;
       }
+      case 't':
+        pOptionInfo->include_timeout = atoi(optarg);
+        break;
+      case 'c': {
+        int entries = atoi(optarg);
+        // one cache for all the instances, the documents are told apart by their URL
+        if (entries > 0 && gNodeListCache == nullptr) {
+          gNodeListCache = new NodeListCache(entries);
+        }
+        break;
+      }
       default:
         break;
       }
@@ -1629,9 +1721,9 @@ esiPluginInit(int argc, const char *argv[], struct OptionInfo *pOptionInfo)
   TSDebug(DEBUG_TAG,
           "[%s] Plugin started, "
           "packed-node-support: %d, private-response: %d, "
-          "disable-gzip-output: %d, first-byte-flush: %d ",
+          "disable-gzip-output: %d, first-byte-flush: %d, include-timeout: %d ms, node-list-cache: %d ",
           __FUNCTION__, pOptionInfo->packed_node_support, pOptionInfo->private_response, pOptionInfo->disable_gzip_output,
-          pOptionInfo->first_byte_flush);
+          pOptionInfo->first_byte_flush, pOptionInfo->include_timeout, gNodeListCache != nullptr);
 
   return 0;
 }
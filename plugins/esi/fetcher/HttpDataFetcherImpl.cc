@@ -22,8 +22,10 @@
  */
 
 #include "HttpDataFetcherImpl.h"
+#include "ts/experimental.h"
 #include "lib/Utils.h"
 #include "lib/gzip.h"
+#include "lib/Stats.h"
 
 #include <arpa/inet.h>
 #include <cstdlib>
@@ -47,7 +49,13 @@ HttpDataFetcherImpl::_release(RequestData &req_data)
 }
 
 HttpDataFetcherImpl::HttpDataFetcherImpl(TSCont contp, sockaddr const *client_addr, const char *debug_tag)
-  : _contp(contp), _n_pending_requests(0), _curr_event_id_base(FETCH_EVENT_ID_BASE), _headers_str("")
+  : _contp(contp),
+    _n_pending_requests(0),
+    _n_timed_out_requests(0),
+    _curr_event_id_base(FETCH_EVENT_ID_BASE),
+    _headers_str(""),
+    _timeout_ms(0),
+    _timeout_action(nullptr)
 {
   _http_parser = TSHttpParserCreate();
   snprintf(_debug_tag, sizeof(_debug_tag), "%s", debug_tag);
@@ -122,6 +130,65 @@ HttpDataFetcherImpl::addFetchRequest(const string &url, FetchedDataProcessor *ca
   TSDebug(_debug_tag, "[%s] Successfully added fetch request for URL [%s]", __FUNCTION__, url.data());
   _page_entry_lookup.push_back(insert_result.first);
   ++_n_pending_requests;
+
+  if (_timeout_ms > 0) {
+    RequestData &req_data = insert_result.first->second;
+    TSHRTime now          = TShrtime();
+    req_data.deadline     = now + static_cast<TSHRTime>(_timeout_ms) * 1000000;
+    if (!_timeout_action) {
+      _scheduleTimeout(now);
+    }
+  }
+  return true;
+}
+
+// Schedules the timeout event for the earliest deadline of the pending requests, if any.
+void
+HttpDataFetcherImpl::_scheduleTimeout(TSHRTime now)
+{
+  TSHRTime next_deadline = 0;
+  for (auto &entry : _page_entry_lookup) {
+    const RequestData &req_data = entry->second;
+    if (!req_data.complete && req_data.deadline && (!next_deadline || (req_data.deadline < next_deadline))) {
+      next_deadline = req_data.deadline;
+    }
+  }
+  if (next_deadline) {
+    // at least a millisecond, as a zero delay would make for an immediate event
+    TSHRTime delay  = next_deadline > now ? (next_deadline - now + 999999) / 1000000 : 1;
+    _timeout_action = TSContScheduleOnPool(_contp, delay, TS_THREAD_POOL_NET);
+  }
+}
+
+void
+HttpDataFetcherImpl::_cancelTimeout()
+{
+  if (_timeout_action) {
+    TSActionCancel(_timeout_action);
+    _timeout_action = nullptr;
+  }
+}
+
+// Fails the requests past their deadline. The fetches of these will still call back, then
+// their responses are dropped.
+bool
+HttpDataFetcherImpl::_handleTimeout()
+{
+  TSHRTime now    = TShrtime();
+  _timeout_action = nullptr;
+
+  for (auto &entry : _page_entry_lookup) {
+    RequestData &req_data = entry->second;
+    if (!req_data.complete && req_data.deadline && (req_data.deadline <= now)) {
+      TSError("[HttpDataFetcherImpl][%s] Request [%s] timed out after %d ms", __FUNCTION__, entry->first.c_str(), _timeout_ms);
+      Stats::increment(Stats::N_INCLUDE_TIMEOUTS);
+      req_data.complete  = true;
+      req_data.timed_out = true;
+      --_n_pending_requests;
+      ++_n_timed_out_requests;
+    }
+  }
+  _scheduleTimeout(now);
   return true;
 }
 
@@ -141,6 +208,9 @@ bool
 HttpDataFetcherImpl::handleFetchEvent(TSEvent event, void *edata)
 {
   int base_event_id;
+  if ((event == TS_EVENT_TIMEOUT) && _timeout_action) {
+    return _handleTimeout();
+  }
   if (!_isFetchEvent(event, base_event_id)) {
     TSError("[HttpDataFetcherImpl][%s] Event %d is not a fetch event", __FUNCTION__, event);
     return false;
@@ -150,6 +220,13 @@ HttpDataFetcherImpl::handleFetchEvent(TSEvent event, void *edata)
   const string &req_str                = req_entry->first;
   RequestData &req_data                = req_entry->second;
 
+  if (req_data.timed_out) {
+    TSDebug(_debug_tag, "[%s] Dropping response of timed out request [%s]", __FUNCTION__, req_str.c_str());
+    req_data.timed_out = false;
+    --_n_timed_out_requests;
+    return true;
+  }
+
   if (req_data.complete) {
     // can only happen if there's a bug in this or fetch API code
     TSError("[HttpDataFetcherImpl][%s] URL [%s] already completed; Retaining original data", __FUNCTION__, req_str.c_str());
@@ -158,6 +235,9 @@ HttpDataFetcherImpl::handleFetchEvent(TSEvent event, void *edata)
 
   --_n_pending_requests;
   req_data.complete = true;
+  if (!_n_pending_requests) {
+    _cancelTimeout();
+  }
 
   int event_id = (static_cast<int>(event) - FETCH_EVENT_ID_BASE) % 3;
   if (event_id != 0) { // failure or timeout
@@ -298,10 +378,12 @@ HttpDataFetcherImpl::getData(const string &url, ResponseData &resp_data) const
 void
 HttpDataFetcherImpl::clear()
 {
+  _cancelTimeout();
   for (UrlToContentMap::iterator iter = _pages.begin(); iter != _pages.end(); ++iter) {
     _release(iter->second);
   }
-  _n_pending_requests = 0;
+  _n_pending_requests   = 0;
+  _n_timed_out_requests = 0;
   _pages.clear();
   _page_entry_lookup.clear();
   _headers_str.clear();
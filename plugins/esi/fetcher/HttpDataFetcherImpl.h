@@ -42,6 +42,14 @@ public:
 
   void useHeaders(const EsiLib::HttpHeaderList &headers);
 
+  /** Requests not complete this many milliseconds after they were added
+   * fail as if the fetch had timed out; 0 (the default) waits for the fetch */
+  void
+  setFetchTimeout(int timeout_ms)
+  {
+    _timeout_ms = timeout_ms;
+  }
+
   bool addFetchRequest(const std::string &url, FetchedDataProcessor *callback_obj = nullptr) override;
 
   bool handleFetchEvent(TSEvent event, void *edata);
@@ -50,6 +58,9 @@ public:
   isFetchEvent(TSEvent event) const
   {
     int base_event_id;
+    if (event == TS_EVENT_TIMEOUT) {
+      return _timeout_action != nullptr;
+    }
     return _isFetchEvent(event, base_event_id);
   }
 
@@ -67,6 +78,14 @@ public:
     return _n_pending_requests;
   };
 
+  /** Requests that timed out but whose fetch has not called back yet. The
+   * continuation must live on until the fetch API is done with it */
+  int
+  getNumTimedOutRequests() const
+  {
+    return _n_timed_out_requests;
+  };
+
   // used to return data to callers
   struct ResponseData {
     const char *content;
@@ -115,9 +134,11 @@ private:
     int body_len             = 0;
     TSHttpStatus resp_status = TS_HTTP_STATUS_NONE;
     CallbackObjectList callback_objects;
-    bool complete  = false;
-    TSMBuffer bufp = nullptr;
-    TSMLoc hdr_loc = nullptr;
+    bool complete     = false;
+    bool timed_out    = false;
+    TSHRTime deadline = 0;
+    TSMBuffer bufp    = nullptr;
+    TSMLoc hdr_loc    = nullptr;
 
     RequestData() {}
   };
@@ -129,6 +150,7 @@ private:
   IteratorArray _page_entry_lookup; // used to map event ids to requests
 
   int _n_pending_requests;
+  int _n_timed_out_requests;
   int _curr_event_id_base;
   TSHttpParser _http_parser;
 
@@ -148,6 +170,13 @@ private:
 
   inline void _release(RequestData &req_data);
 
+  int _timeout_ms;
+  TSAction _timeout_action;
+
+  void _scheduleTimeout(TSHRTime now);
+  void _cancelTimeout();
+  bool _handleTimeout();
+
   struct sockaddr_storage _client_addr;
 };
 
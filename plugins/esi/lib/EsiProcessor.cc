@@ -44,6 +44,7 @@ EsiProcessor::EsiProcessor(const char *debug_tag, const char *parser_debug_tag,
     _overall_len(0),
     _fetcher(fetcher),
     _usePackedNodeList(false),
+    _retain_parsed_nodes(false),
     _esi_vars(variables),
     _expression(expression_debug_tag, debug_func, error_func, _esi_vars),
     _n_try_blocks_processed(0),
@@ -83,6 +84,7 @@ EsiProcessor::addParseData(const char *data, int data_len)
     Stats::increment(Stats::N_PARSE_ERRS);
     return false;
   }
+  _retainParsedNodes();
   if (!_preprocess(_node_list, _n_prescanned_nodes)) {
     _errorLog("[%s] Failed to preprocess parsed nodes; Stopping processor...", __FUNCTION__);
     error();
@@ -111,11 +113,25 @@ EsiProcessor::completeParse(const char *data /* = 0 */, int data_len /* = -1 */)
     Stats::increment(Stats::N_PARSE_ERRS);
     return false;
   }
+  _retainParsedNodes();
   return _handleParseComplete();
 }
 
+void
+EsiProcessor::_retainParsedNodes()
+{
+  if (_retain_parsed_nodes) {
+    // nodes past the pre-scanned ones are the ones the parser just added
+    DocNodeList::const_iterator iter = _node_list.begin();
+    for (int i = 0; i < _n_prescanned_nodes; ++i, ++iter) {
+      ;
+    }
+    _parsed_node_list.insert(_parsed_node_list.end(), iter, _node_list.cend());
+  }
+}
+
 EsiProcessor::UsePackedNodeResult
-EsiProcessor::usePackedNodeList(const char *data, int data_len)
+EsiProcessor::_useNodeList(const char *data, int data_len)
 {
   if (_curr_state != STOPPED) {
     _errorLog("[%s] Cannot use packed node list whilst processing other data", __FUNCTION__);
@@ -127,10 +143,30 @@ EsiProcessor::usePackedNodeList(const char *data, int data_len)
     error();
     return UNPACK_FAILURE;
   }
+  return PROCESS_SUCCESS;
+}
+
+EsiProcessor::UsePackedNodeResult
+EsiProcessor::usePackedNodeList(const char *data, int data_len)
+{
+  UsePackedNodeResult result = _useNodeList(data, data_len);
+  if (result != PROCESS_SUCCESS) {
+    return result;
+  }
   _usePackedNodeList = true;
   return _handleParseComplete() ? PROCESS_SUCCESS : PROCESS_FAILURE;
 }
 
+EsiProcessor::UsePackedNodeResult
+EsiProcessor::useParsedNodeList(const char *data, int data_len)
+{
+  UsePackedNodeResult result = _useNodeList(data, data_len);
+  if (result != PROCESS_SUCCESS) {
+    return result;
+  }
+  return _handleParseComplete() ? PROCESS_SUCCESS : PROCESS_FAILURE;
+}
+
 bool
 EsiProcessor::_handleParseComplete()
 {
@@ -469,6 +505,8 @@ EsiProcessor::stop()
 {
   _output_data.clear();
   _node_list.clear();
+  _parsed_node_list.clear();
+  _retain_parsed_nodes = false;
   _include_urls.clear();
   _try_blocks.clear();
   _n_prescanned_nodes     = 0;
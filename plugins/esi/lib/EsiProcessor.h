@@ -112,6 +112,36 @@ public:
     return usePackedNodeList(data.data(), data.size());
   }
 
+  /** Keeps a copy of the nodes as the parser returns them, before any
+   * of them are evaluated, for packParsedNodeList(); has to be called
+   * before any data is parsed */
+  void
+  retainParsedNodeList()
+  {
+    _retain_parsed_nodes = true;
+  }
+
+  /** returns packed version of the document as parsed; unlike the node
+   * list of packNodeList(), it does not depend on the variables of the
+   * request and can be used for any request for the same document */
+  void
+  packParsedNodeList(std::string &buffer) const
+  {
+    _parsed_node_list.pack(buffer);
+  }
+
+  /** Unpacks a node list packed by packParsedNodeList() and preps for
+   * process() as if the document had just been parsed; Unpacked
+   * document will point to data in argument (i.e., caller space) */
+  UsePackedNodeResult useParsedNodeList(const char *data, int data_len);
+
+  /** convenient alternative to method above */
+  inline UsePackedNodeResult
+  useParsedNodeList(const std::string &data)
+  {
+    return useParsedNodeList(data.data(), data.size());
+  }
+
   /** Clears state from current request */
   void stop();
 
@@ -141,6 +171,11 @@ private:
 
   bool _usePackedNodeList;
 
+  bool _retain_parsed_nodes;
+  EsiLib::DocNodeList _parsed_node_list;
+
+  UsePackedNodeResult _useNodeList(const char *data, int data_len);
+  void _retainParsedNodes();
   bool _processEsiNode(const EsiLib::DocNodeList::iterator &iter);
   bool _handleParseComplete();
   bool _getIncludeData(const EsiLib::DocNode &node, const char **content_ptr = nullptr, int *content_len_ptr = nullptr);
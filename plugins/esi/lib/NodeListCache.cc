@@ -0,0 +1,70 @@
+/** @file
+
+  Bounded cache of parsed ESI documents
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "NodeListCache.h"
+
+using std::string;
+using namespace EsiLib;
+
+std::shared_ptr<const string>
+NodeListCache::get(const string &key)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  auto iter = _entries.find(key);
+  if (iter == _entries.end()) {
+    return nullptr;
+  }
+  _lru.splice(_lru.begin(), _lru, iter->second.lru);
+  return iter->second.packed_node_list;
+}
+
+void
+NodeListCache::put(const string &key, string &&packed_node_list)
+{
+  auto value = std::make_shared<const string>(std::move(packed_node_list));
+
+  std::lock_guard<std::mutex> lock(_mutex);
+  auto iter = _entries.find(key);
+  if (iter != _entries.end()) {
+    iter->second.packed_node_list = std::move(value);
+    _lru.splice(_lru.begin(), _lru, iter->second.lru);
+    return;
+  }
+  while (!_lru.empty() && _entries.size() >= _max_entries) {
+    _entries.erase(_lru.back());
+    _lru.pop_back();
+  }
+  _lru.push_front(key);
+  _entries.emplace(key, Entry{std::move(value), _lru.begin()});
+}
+
+void
+NodeListCache::remove(const string &key)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  auto iter = _entries.find(key);
+  if (iter != _entries.end()) {
+    _lru.erase(iter->second.lru);
+    _entries.erase(iter);
+  }
+}
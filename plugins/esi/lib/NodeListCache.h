@@ -0,0 +1,65 @@
+/** @file
+
+  Bounded cache of parsed ESI documents
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#pragma once
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace EsiLib
+{
+/** Packed node lists of parsed documents (see EsiProcessor::packParsedNodeList()),
+ * by the identity of the document they were parsed from. Documents served again,
+ * typically from the cache, are not parsed again. The least recently used lists
+ * are dropped past the given number of documents. */
+class NodeListCache
+{
+public:
+  explicit NodeListCache(size_t max_entries) : _max_entries(max_entries) {}
+
+  /** returns the packed node list for the document, or null. The returned
+   * list stays valid as long as it is referenced, even if it is dropped */
+  std::shared_ptr<const std::string> get(const std::string &key);
+
+  void put(const std::string &key, std::string &&packed_node_list);
+
+  void remove(const std::string &key);
+
+  NodeListCache(const NodeListCache &) = delete;
+  NodeListCache &operator=(const NodeListCache &) = delete;
+
+private:
+  struct Entry {
+    std::shared_ptr<const std::string> packed_node_list;
+    std::list<std::string>::iterator lru;
+  };
+
+  size_t _max_entries;
+  std::mutex _mutex;
+  std::unordered_map<std::string, Entry> _entries;
+  std::list<std::string> _lru; // most recently used first
+};
+}; // namespace EsiLib
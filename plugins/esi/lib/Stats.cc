@@ -29,9 +29,9 @@ namespace EsiLib
 {
 namespace Stats
 {
-  const char *STAT_NAMES[Stats::MAX_STAT_ENUM] = {"esi.n_os_docs",          "esi.n_cache_docs",   "esi.n_parse_errs",
-                                                  "esi.n_includes",         "esi.n_include_errs", "esi.n_spcl_includes",
-                                                  "esi.n_spcl_include_errs"};
+  const char *STAT_NAMES[Stats::MAX_STAT_ENUM] = {"esi.n_os_docs",           "esi.n_cache_docs",       "esi.n_parse_errs",
+                                                  "esi.n_includes",          "esi.n_include_errs",     "esi.n_spcl_includes",
+                                                  "esi.n_spcl_include_errs", "esi.n_include_timeouts", "esi.n_node_list_hits"};
 
   int g_stat_indices[Stats::MAX_STAT_ENUM] = {0};
   StatSystem *g_system                     = nullptr;
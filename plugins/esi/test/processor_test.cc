@@ -1069,6 +1069,47 @@ main()
     assert(esi_proc.usePackedNodeList(packedNodeList.data(), 0) == EsiProcessor::UNPACK_FAILURE);
   }
 
+  {
+    cout << endl << "===================== Test 49) using parsed node list" << endl;
+    string input_data1("<esi:choose>"
+                       "<esi:when test=\"$(QUERY_STRING{a}) == x\">"
+                       "<esi:include src=x />"
+                       "</esi:when>");
+    string input_data2("<esi:otherwise>"
+                       "<esi:include src=y />"
+                       "</esi:otherwise>"
+                       "</esi:choose>"
+                       "<!--esi <esi:vars>$(QUERY_STRING{a})</esi:vars>-->");
+    const char *output_data;
+    int output_data_len = 0;
+    string parsedNodeList;
+
+    {
+      TestHttpDataFetcher data_fetcher;
+      Variables vars("vars", &Debug, &Error, allowlistCookies);
+      vars.populate("a=x");
+      EsiProcessor esi_proc("processor", "parser", "expression", &Debug, &Error, data_fetcher, vars, handler_mgr);
+      esi_proc.retainParsedNodeList();
+      assert(esi_proc.addParseData(input_data1) == true);
+      assert(esi_proc.completeParse(input_data2) == true);
+      assert(esi_proc.process(output_data, output_data_len) == EsiProcessor::SUCCESS);
+      assert(string(output_data, output_data_len) == ">>>>> Content for URL [x] <<<<<x");
+      esi_proc.packParsedNodeList(parsedNodeList);
+    }
+
+    // the parsed document does not depend on the variables of the request it was parsed for
+    TestHttpDataFetcher data_fetcher;
+    Variables vars("vars", &Debug, &Error, allowlistCookies);
+    vars.populate("a=z");
+    EsiProcessor esi_proc("processor", "parser", "expression", &Debug, &Error, data_fetcher, vars, handler_mgr);
+    assert(esi_proc.useParsedNodeList(parsedNodeList) == EsiProcessor::PROCESS_SUCCESS);
+    assert(esi_proc.process(output_data, output_data_len) == EsiProcessor::SUCCESS);
+    assert(string(output_data, output_data_len) == ">>>>> Content for URL [y] <<<<<z");
+
+    esi_proc.stop();
+    assert(esi_proc.useParsedNodeList(parsedNodeList.data(), 0) == EsiProcessor::UNPACK_FAILURE);
+  }
+
   cout << endl << "All tests passed!" << endl;
   return 0;
 }
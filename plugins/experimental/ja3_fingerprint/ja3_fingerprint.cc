@@ -308,10 +308,22 @@ client_hello_ja3_handler(TSCont contp, TSEvent event, void *edata)
     SSL *ssl = reinterpret_cast<SSL *>(sslobj);
 
     ja3_data *data = new ja3_data;
-    data->ja3_string.append(custom_get_ja3(ssl));
     getIP(TSNetVConnRemoteAddrGet(ssl_vc), data->ip_addr);
-
     TSUserArgSet(ssl_vc, ja3_idx, static_cast<void *>(data));
+
+    // With proxy.config.ssl.server.ja3_fingerprint the core has it already
+    const char *raw  = nullptr;
+    int raw_len      = 0;
+    const char *core = TSVConnSslJa3Get(ssl_vc, &raw, &raw_len);
+    if (core != nullptr) {
+      data->ja3_string.assign(raw, raw_len);
+      strncpy(data->md5_string, core, sizeof(data->md5_string) - 1);
+      data->md5_string[sizeof(data->md5_string) - 1] = '\0';
+      TSDebug(PLUGIN_NAME, "Fingerprint from the core: %s", data->md5_string);
+      break;
+    }
+
+    data->ja3_string.append(custom_get_ja3(ssl));
     TSDebug(PLUGIN_NAME, "client_hello_ja3_handler(): JA3: %s", data->ja3_string.c_str());
 
     // MD5 hash
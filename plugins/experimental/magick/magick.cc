@@ -22,6 +22,7 @@
 #include <functional>
 #include <list>
 #include <map>
+#include <memory>
 #include <mutex>
 #include <string>
 #include <vector>
@@ -140,6 +141,14 @@ struct ThreadPool {
 
   ThreadPool(ThreadPool &) = delete;
 
+  /// The callbacks waiting for a thread.
+  size_t
+  pending()
+  {
+    Lock lock(mutex_);
+    return queue_.size();
+  }
+
   void
   emplace_back(Callback &&c)
   {
@@ -455,23 +464,52 @@ QueryParameterToArguments(CharVector &v)
   return result;
 }
 
+struct ImageTransform;
+
+/**
+ * The work handed to the thread pool, shared by the transform and the pool as either can end first.
+ * The output is produced back on the thread of the transform, with the transaction mutex held.
+ */
+struct Conversion {
+  CharVector arguments;
+  CharPointerVector argumentMap;
+  CharVector blob;
+  std::string output;
+  TSEventThread thread;
+  TSCont done;
+  ImageTransform *transform = nullptr; // nullptr once the transaction is gone.
+};
+
+using ConversionPointer = std::shared_ptr<Conversion>;
+
 struct ImageTransform : TransformationPlugin {
-  ~ImageTransform() override = default;
+  ~ImageTransform() override
+  {
+    if (conversion_) {
+      conversion_->transform = nullptr;
+    }
+  }
 
   ImageTransform(Transaction &t, CharVector &&a, CharPointerVector &&m, ThreadPool &p)
     : TransformationPlugin(t, TransformationPlugin::RESPONSE_TRANSFORMATION),
-      arguments_(std::move(a)),
-      argumentMap_(std::move(m)),
+      conversion_(std::make_shared<Conversion>()),
       threadPool_(p)
   {
     TSDebug(PLUGIN_TAG, "ImageTransform");
+    conversion_->arguments   = std::move(a);
+    conversion_->argumentMap = std::move(m);
+
+    // the transformed image is what gets cached, under the url with the magick parameter.
+    txn_ = static_cast<TSHttpTxn>(t.getAtsHandle());
+    TSHttpTxnTransformedRespCache(txn_, 1);
+    TSHttpTxnUntransformedRespCache(txn_, 0);
   }
 
   void
   consume(const std::string_view s) override
   {
     TSDebug(PLUGIN_TAG, "consume");
-    blob_.insert(blob_.end(), s.begin(), s.end());
+    conversion_->blob.insert(conversion_->blob.end(), s.begin(), s.end());
   }
 
   void
@@ -479,40 +517,66 @@ struct ImageTransform : TransformationPlugin {
   {
     TSDebug(PLUGIN_TAG, "handleInputComplete");
 
-    threadPool_.emplace_back([this](void) {
+    conversion_->thread    = TSEventThreadSelf();
+    conversion_->transform = this;
+    conversion_->done      = TSContCreate(produceOutput, TSContMutexGet(reinterpret_cast<TSCont>(txn_)));
+    TSContDataSet(conversion_->done, new ConversionPointer(conversion_));
+
+    ConversionPointer conversion = conversion_;
+    threadPool_.emplace_back([conversion](void) {
       magick::Image image;
       magick::Exception exception;
       magick::Wand wand;
 
-      assert(!this->blob_.empty());
+      assert(!conversion->blob.empty());
 
-      wand.readBlob(this->blob_);
+      wand.readBlob(conversion->blob);
       wand.write("mpr:b");
 
-      const bool result = MagickCommandGenesis(image.info, ConvertImageCommand, this->argumentMap_.size(),
-                                               this->argumentMap_.data(), nullptr, exception.info) == MagickTrue;
+      const bool result = MagickCommandGenesis(image.info, ConvertImageCommand, conversion->argumentMap.size(),
+                                               conversion->argumentMap.data(), nullptr, exception.info) == MagickTrue;
 
       wand.clear();
       wand.read("mpr:a");
 
-      const std::string_view output = wand.get();
-      this->produce(output);
+      conversion->output = wand.get();
 
-      TSDebug(PLUGIN_TAG, "Background transformation is done, resuming continuation (%p)", this);
+      TSDebug(PLUGIN_TAG, "Background transformation is done (%d), resuming continuation (%p)", result, conversion->done);
 
-      this->setOutputComplete();
+      // produce() and setOutputComplete() are not safe from this thread.
+      TSContScheduleOnThread(conversion->done, 0, conversion->thread);
     });
 
     TSDebug(PLUGIN_TAG, "Scheduling background transformation (%p)", this);
   }
 
-  CharVector arguments_;
-  CharPointerVector argumentMap_;
-  CharVector blob_;
+  static int
+  produceOutput(TSCont cont, TSEvent, void *)
+  {
+    ConversionPointer *const conversion = static_cast<ConversionPointer *>(TSContDataGet(cont));
+    ImageTransform *const transform     = (*conversion)->transform;
+
+    if (nullptr != transform) {
+      transform->produce((*conversion)->output);
+      transform->setOutputComplete();
+    } else {
+      TSDebug(PLUGIN_TAG, "transaction closed before the background transformation was done");
+    }
+
+    delete conversion;
+    TSContDestroy(cont);
+    return 0;
+  }
+
+  ConversionPointer conversion_;
   ThreadPool &threadPool_;
+  TSHttpTxn txn_;
 };
 
 struct GlobalHookPlugin : GlobalPlugin {
+  /// Transformations waiting for a thread, beyond it the images are sent as they are.
+  static constexpr size_t MAX_PENDING = 32;
+
   magick::Core core_;
   magick::EVPKey *key_ = nullptr;
   ThreadPool threadPool_;
@@ -600,7 +664,13 @@ struct GlobalHookPlugin : GlobalPlugin {
           QueryParameterToCharVector(magick);
           TSDebug(PLUGIN_TAG, "ImageMagick's syntax: %s", magick.data());
           CharPointerVector argumentMap = QueryParameterToArguments(magick);
-          t.addPlugin(new ImageTransform(t, std::move(magick), std::move(argumentMap), threadPool_));
+          if (threadPool_.pending() < MAX_PENDING) {
+            t.addPlugin(new ImageTransform(t, std::move(magick), std::move(argumentMap), threadPool_));
+          } else {
+            // the original must not be cached where the transformed image goes.
+            TSDebug(PLUGIN_TAG, "too many pending transformations, sending the image as is.");
+            TSHttpTxnServerRespNoStoreSet(static_cast<TSHttpTxn>(t.getAtsHandle()), 1);
+          }
         } else {
           TSDebug(PLUGIN_TAG, "signature verification failed.");
           TSError("[" PLUGIN_TAG "] signature verification failed.");
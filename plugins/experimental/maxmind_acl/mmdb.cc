@@ -18,6 +18,114 @@
 
 #include "mmdb.h"
 
+namespace
+{
+std::mutex shared_mmdbs_mutex;
+std::unordered_map<std::string, std::weak_ptr<SharedMmdb>> shared_mmdbs;
+std::atomic<uint64_t> mmdb_generation{0};
+std::atomic<uint64_t> acl_id{0};
+thread_local DecisionCache decisions;
+} // namespace
+
+///////////////////////////////////////////////////////////////////////////////
+// The database of path, opened if no other instance has it
+std::shared_ptr<SharedMmdb>
+SharedMmdb::get(const std::string &path)
+{
+  std::lock_guard<std::mutex> lock(shared_mmdbs_mutex);
+  std::shared_ptr<SharedMmdb> db = shared_mmdbs[path].lock();
+
+  if (!db) {
+    db.reset(new SharedMmdb(path));
+    if (!db->reopen()) {
+      return nullptr;
+    }
+    shared_mmdbs[path] = db;
+  } else {
+    TSDebug(PLUGIN_NAME, "Sharing MMDB %s", path.c_str());
+  }
+
+  return db;
+}
+
+std::shared_ptr<const MmdbHandle>
+SharedMmdb::acquire()
+{
+  time_t now = time(nullptr);
+
+  if (now >= _next_check.load(std::memory_order_relaxed)) {
+    std::unique_lock<std::mutex> lock(_mutex, std::try_to_lock);
+    if (lock.owns_lock() && now >= _next_check.load(std::memory_order_relaxed)) {
+      reopen();
+    }
+  }
+
+  return std::atomic_load(&_handle);
+}
+
+// Open the file if it changed since it was last opened, the current database
+// stays in use for the transactions that have it until they are done
+bool
+SharedMmdb::reopen()
+{
+  struct stat s;
+
+  _next_check = time(nullptr) + CONFIG_TMOUT / 1000;
+  if (stat(_path.c_str(), &s) < 0) {
+    TSDebug(PLUGIN_NAME, "Could not stat %s", _path.c_str());
+    return _handle != nullptr;
+  }
+  if (_handle && s.st_mtime == _mtime) {
+    return true;
+  }
+
+  auto handle = std::make_shared<MmdbHandle>();
+  int status  = MMDB_open(_path.c_str(), MMDB_MODE_MMAP, &handle->mmdb);
+  if (MMDB_SUCCESS != status) {
+    TSDebug(PLUGIN_NAME, "Cant open DB %s - %s", _path.c_str(), MMDB_strerror(status));
+    return _handle != nullptr;
+  }
+  handle->opened     = true;
+  handle->generation = ++mmdb_generation;
+  _mtime             = s.st_mtime;
+
+  if (_handle) {
+    TSDebug(PLUGIN_NAME, "Reloaded MMDB %s", _path.c_str());
+  }
+  std::atomic_store(&_handle, std::shared_ptr<const MmdbHandle>(handle));
+  return true;
+}
+
+int
+DecisionCache::find(uint64_t acl, uint64_t generation, const IpAddr &addr)
+{
+  auto spot = _index.find(Key{acl, generation, addr});
+
+  if (spot == _index.end()) {
+    return -1;
+  }
+  _lru.splice(_lru.begin(), _lru, spot->second);
+  return spot->second->second;
+}
+
+void
+DecisionCache::insert(uint64_t acl, uint64_t generation, const IpAddr &addr, bool allow)
+{
+  Key key{acl, generation, addr};
+
+  if (_index.count(key)) {
+    return;
+  }
+  if (_lru.size() >= SIZE) {
+    _index.erase(_lru.back().first);
+    _lru.pop_back();
+  }
+  _lru.emplace_front(key, allow);
+  _index.emplace(key, _lru.begin());
+}
+
+Acl::Acl() : _id(++acl_id) {}
+
 ///////////////////////////////////////////////////////////////////////////////
 // Load the config file from param
 // check for basics
@@ -378,28 +486,44 @@ Acl::loaddb(YAML::Node dbNode)
     dbloc.assign(dbname);
   }
 
-  // Make sure we close any previously opened DBs in case this is a reload
-  if (db_loaded) {
-    MMDB_close(&_mmdb);
-  }
-
-  int status = MMDB_open(dbloc.c_str(), MMDB_MODE_MMAP, &_mmdb);
-  if (MMDB_SUCCESS != status) {
-    TSDebug(PLUGIN_NAME, "Cant open DB %s - %s", dbloc.c_str(), MMDB_strerror(status));
+  _db = SharedMmdb::get(dbloc);
+  if (!_db) {
     return false;
   }
 
-  db_loaded = true;
   TSDebug(PLUGIN_NAME, "Initialized MMDB with %s", dbloc.c_str());
   return true;
 }
 
 bool
 Acl::eval(TSRemapRequestInfo *rri, TSHttpTxn txnp)
+{
+  std::shared_ptr<const MmdbHandle> db = _db->acquire();
+  const sockaddr *addr                 = TSHttpTxnClientAddrGet(txnp);
+
+  // The regexes look at the path, without them the decision only depends on the address
+  if (addr == nullptr || !allow_regex.empty() || !deny_regex.empty()) {
+    return eval_db(rri, addr, &db->mmdb);
+  }
+
+  IpAddr ip(addr);
+  int cached = decisions.find(_id, db->generation, ip);
+  if (cached >= 0) {
+    TSDebug(PLUGIN_NAME, "Cached decision for this IP: %d", cached);
+    return cached;
+  }
+
+  bool ret = eval_db(rri, addr, &db->mmdb);
+  decisions.insert(_id, db->generation, ip, ret);
+  return ret;
+}
+
+bool
+Acl::eval_db(TSRemapRequestInfo *rri, const sockaddr *addr, const MMDB_s *mmdb)
 {
   bool ret = default_allow;
   int mmdb_error;
-  MMDB_lookup_result_s result = MMDB_lookup_sockaddr(&_mmdb, TSHttpTxnClientAddrGet(txnp), &mmdb_error);
+  MMDB_lookup_result_s result = MMDB_lookup_sockaddr(mmdb, addr, &mmdb_error);
 
   if (MMDB_SUCCESS != mmdb_error) {
     TSDebug(PLUGIN_NAME, "Error during sockaddr lookup: %s", MMDB_strerror(mmdb_error));
@@ -456,7 +580,7 @@ Acl::eval(TSRemapRequestInfo *rri, TSHttpTxn txnp)
   }
 
   // Test for allowable IPs based on our lists
-  switch (eval_ip(TSHttpTxnClientAddrGet(txnp))) {
+  switch (eval_ip(addr)) {
   case ALLOW_IP:
     TSDebug(PLUGIN_NAME, "Saw explicit allow of this IP");
     ret = true;
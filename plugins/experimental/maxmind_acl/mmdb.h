@@ -35,6 +35,11 @@
 #include <sys/stat.h>
 #include <unistd.h>
 #include <iterator>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <ctime>
 #include <maxminddb.h>
 #include "tscore/IpMap.h"
 
@@ -55,17 +60,82 @@ typedef struct {
 
 typedef enum { ALLOW_IP, DENY_IP, UNKNOWN_IP } ipstate;
 
+// An opened database
+struct MmdbHandle {
+  MMDB_s mmdb;
+  bool opened         = false;
+  uint64_t generation = 0; // unique to each database opened, for the decisions made with it
+
+  ~MmdbHandle()
+  {
+    if (opened) {
+      MMDB_close(&mmdb);
+    }
+  }
+};
+
+// The database of a file, opened once for all the instances that use it and
+// opened again when the file changes
+class SharedMmdb
+{
+public:
+  static std::shared_ptr<SharedMmdb> get(const std::string &path);
+
+  // The current database, the file is checked for changes at most every CONFIG_TMOUT
+  std::shared_ptr<const MmdbHandle> acquire();
+
+private:
+  explicit SharedMmdb(const std::string &path) : _path(path) {}
+  bool reopen();
+
+  std::string _path;
+  std::shared_ptr<const MmdbHandle> _handle; // swapped with std::atomic_store
+  std::mutex _mutex;                         // held by the reopen
+  std::atomic<time_t> _next_check{0};
+  time_t _mtime = 0;
+};
+
+// The latest decisions of the Acls without regexes for the client addresses,
+// in each thread, so that the requests of a connection skip the database
+class DecisionCache
+{
+public:
+  static constexpr size_t SIZE = 1024;
+
+  // -1 if there is none, else whether the address is allowed
+  int find(uint64_t acl, uint64_t generation, const IpAddr &addr);
+  void insert(uint64_t acl, uint64_t generation, const IpAddr &addr, bool allow);
+
+private:
+  struct Key {
+    uint64_t acl;
+    uint64_t generation;
+    IpAddr addr;
+
+    bool
+    operator==(const Key &that) const
+    {
+      return acl == that.acl && generation == that.generation && addr == that.addr;
+    }
+  };
+  struct KeyHasher {
+    size_t
+    operator()(const Key &key) const
+    {
+      return std::hash<uint64_t>()(key.acl ^ (key.generation << 32)) ^ key.addr.hash();
+    }
+  };
+  using Lru = std::list<std::pair<Key, bool>>; // most recent first
+
+  Lru _lru;
+  std::unordered_map<Key, Lru::iterator, KeyHasher> _index;
+};
+
 // Base class for all ACLs
 class Acl
 {
 public:
-  Acl() {}
-  ~Acl()
-  {
-    if (db_loaded) {
-      MMDB_close(&_mmdb);
-    }
-  }
+  Acl();
 
   bool eval(TSRemapRequestInfo *rri, TSHttpTxn txnp);
   bool init(char const *filename);
@@ -83,7 +153,8 @@ public:
 protected:
   // Class members
   YAML::Node _config;
-  MMDB_s _mmdb;
+  std::shared_ptr<SharedMmdb> _db;
+  uint64_t _id; // for the decision cache
   std::string _html;
   std::unordered_map<std::string, bool> allow_country;
 
@@ -96,12 +167,12 @@ protected:
   // Do we want to allow by default or not? Useful
   // for deny only rules
   bool default_allow = false;
-  bool db_loaded     = false;
 
   bool loaddb(YAML::Node dbNode);
   bool loadallow(YAML::Node allowNode);
   bool loaddeny(YAML::Node denyNode);
   void loadhtml(YAML::Node htmlNode);
+  bool eval_db(TSRemapRequestInfo *rri, const sockaddr *addr, const MMDB_s *mmdb);
   bool eval_country(MMDB_entry_data_s *entry_data, const char *path, int path_len);
   void parseregex(YAML::Node regex, bool allow);
   ipstate eval_ip(const sockaddr *sock);
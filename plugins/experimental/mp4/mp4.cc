@@ -22,10 +22,50 @@ static char *ts_arg(const char *param, size_t param_len, const char *key, size_t
 static int mp4_handler(TSCont contp, TSEvent event, void *edata);
 static void mp4_cache_lookup_complete(Mp4Context *mc, TSHttpTxn txnp);
 static void mp4_read_response(Mp4Context *mc, TSHttpTxn txnp);
-static void mp4_add_transform(Mp4Context *mc, TSHttpTxn txnp);
+static void mp4_add_transform(Mp4Context *mc, TSHttpTxn txnp, TSMBuffer bufp, TSMLoc hdrp);
 static int mp4_transform_entry(TSCont contp, TSEvent event, void *edata);
 static int mp4_transform_handler(TSCont contp, Mp4Context *mc);
 static int mp4_parse_meta(Mp4TransformContext *mtc, bool body_complete);
+static void mp4_use_cached_meta(Mp4TransformContext *mtc);
+static void mp4_cache_meta(Mp4TransformContext *mtc);
+static std::string mp4_meta_cache_key(Mp4Context *mc, TSHttpTxn txnp, TSMBuffer bufp, TSMLoc hdrp);
+
+static Mp4MetaCache meta_cache;
+
+Mp4CachedMetaPtr
+Mp4MetaCache::get(const std::string &key)
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  auto it = index.find(key);
+
+  if (it == index.end()) {
+    return nullptr;
+  }
+
+  lru.splice(lru.begin(), lru, it->second);
+  return it->second->second;
+}
+
+void
+Mp4MetaCache::put(const std::string &key, const Mp4CachedMetaPtr &meta)
+{
+  std::lock_guard<std::mutex> lock(mutex);
+
+  if (index.find(key) != index.end() || meta->meta.size() > MAX_BYTES) {
+    return;
+  }
+
+  lru.emplace_front(key, meta);
+  index[key] = lru.begin();
+  bytes += key.size() + meta->meta.size();
+
+  while (bytes > MAX_BYTES) {
+    Entry &last = lru.back();
+    bytes -= last.first.size() + last.second->meta.size();
+    index.erase(last.first);
+    lru.pop_back();
+  }
+}
 
 TSReturnCode
 TSRemapInit(TSRemapInterface *api_info, char *errbuf, int errbuf_size)
@@ -222,7 +262,7 @@ mp4_cache_lookup_complete(Mp4Context *mc, TSHttpTxn txnp)
   }
 
   mc->cl = n;
-  mp4_add_transform(mc, txnp);
+  mp4_add_transform(mc, txnp, bufp, hdrp);
 
 release:
 
@@ -260,7 +300,7 @@ mp4_read_response(Mp4Context *mc, TSHttpTxn txnp)
   }
 
   mc->cl = n;
-  mp4_add_transform(mc, txnp);
+  mp4_add_transform(mc, txnp, bufp, hdrp);
 
 release:
 
@@ -268,7 +308,7 @@ release:
 }
 
 static void
-mp4_add_transform(Mp4Context *mc, TSHttpTxn txnp)
+mp4_add_transform(Mp4Context *mc, TSHttpTxn txnp, TSMBuffer bufp, TSMLoc hdrp)
 {
   TSVConn connp;
 
@@ -278,6 +318,12 @@ mp4_add_transform(Mp4Context *mc, TSHttpTxn txnp)
 
   mc->mtc = new Mp4TransformContext(mc->start, mc->cl);
 
+  mc->mtc->cache_key = mp4_meta_cache_key(mc, txnp, bufp, hdrp);
+  if (!mc->mtc->cache_key.empty()) {
+    mc->mtc->cached = meta_cache.get(mc->mtc->cache_key);
+    TSDebug(DEBUG_TAG, "meta data of %s %s", mc->mtc->cache_key.c_str(), mc->mtc->cached ? "cached" : "not cached");
+  }
+
   TSHttpTxnUntransformedRespCache(txnp, 1);
   TSHttpTxnTransformedRespCache(txnp, 0);
 
@@ -354,9 +400,19 @@ mp4_transform_handler(TSCont contp, Mp4Context *mc)
   write_down = false;
 
   if (!mtc->parse_over) {
-    ret = mp4_parse_meta(mtc, toread <= 0);
-    if (ret == 0) {
-      goto trans;
+    if (mtc->cached) {
+      mp4_use_cached_meta(mtc);
+      ret = 1;
+
+    } else {
+      ret = mp4_parse_meta(mtc, toread <= 0);
+      if (ret == 0) {
+        goto trans;
+      }
+
+      if (ret > 0) {
+        mp4_cache_meta(mtc);
+      }
     }
 
     mtc->parse_over    = true;
@@ -477,6 +533,91 @@ mp4_parse_meta(Mp4TransformContext *mtc, bool body_complete)
   return ret;
 }
 
+/*
+ * Skip the parsing, the meta data of the same seek into the same object
+ * is known already. The moov box is not even buffered, the bytes up to
+ * the start position are dropped as they come.
+ */
+static void
+mp4_use_cached_meta(Mp4TransformContext *mtc)
+{
+  const Mp4CachedMeta &cached = *mtc->cached;
+  Mp4Meta *mm                 = &mtc->mm;
+
+  mm->out_handle.buffer = TSIOBufferCreate();
+  mm->out_handle.reader = TSIOBufferReaderAlloc(mm->out_handle.buffer);
+  TSIOBufferWrite(mm->out_handle.buffer, cached.meta.data(), cached.meta.size());
+
+  mtc->tail           = cached.start_pos;
+  mtc->content_length = cached.content_length;
+  mtc->meta_length    = cached.meta.size();
+
+  TSIOBufferReaderFree(mtc->dup_reader);
+  mtc->dup_reader = nullptr;
+}
+
+static void
+mp4_cache_meta(Mp4TransformContext *mtc)
+{
+  TSIOBufferBlock blk;
+  const char *data;
+  int64_t bytes;
+
+  if (mtc->cache_key.empty()) {
+    return;
+  }
+
+  auto cached = std::make_shared<Mp4CachedMeta>();
+
+  cached->meta.reserve(mtc->meta_length);
+  for (blk = TSIOBufferReaderStart(mtc->mm.out_handle.reader); blk != nullptr; blk = TSIOBufferBlockNext(blk)) {
+    data = TSIOBufferBlockReadStart(blk, mtc->mm.out_handle.reader, &bytes);
+    cached->meta.append(data, bytes);
+  }
+
+  cached->start_pos      = mtc->tail;
+  cached->content_length = mtc->content_length;
+
+  meta_cache.put(mtc->cache_key, cached);
+}
+
+/*
+ * The url of the object, without the start argument, its validator and
+ * length, and the start time. Empty if the object has neither ETag nor
+ * Last-Modified, a changed object could not be told from the one cached.
+ */
+static std::string
+mp4_meta_cache_key(Mp4Context *mc, TSHttpTxn txnp, TSMBuffer bufp, TSMLoc hdrp)
+{
+  TSMLoc field;
+  const char *val;
+  int val_len, url_len;
+  char *url;
+  char buf[64];
+  std::string key;
+
+  field = TSMimeHdrFieldFind(bufp, hdrp, TS_MIME_FIELD_ETAG, TS_MIME_LEN_ETAG);
+  if (field == TS_NULL_MLOC) {
+    field = TSMimeHdrFieldFind(bufp, hdrp, TS_MIME_FIELD_LAST_MODIFIED, TS_MIME_LEN_LAST_MODIFIED);
+  }
+
+  if (field == TS_NULL_MLOC) {
+    return key;
+  }
+
+  url = TSHttpTxnEffectiveUrlStringGet(txnp, &url_len);
+  if (url != nullptr) {
+    val = TSMimeHdrFieldValueStringGet(bufp, hdrp, field, -1, &val_len);
+    snprintf(buf, sizeof(buf), " %" PRId64 " %.3f", mc->cl, mc->start);
+
+    key.append(url, url_len).append(" ").append(val, val_len).append(buf);
+    TSfree(url);
+  }
+
+  TSHandleMLocRelease(bufp, hdrp, field);
+  return key;
+}
+
 static char *
 ts_arg(const char *param, size_t param_len, const char *key, size_t key_len, size_t *val_len)
 {
@@ -23,6 +23,11 @@
 #include <cstdio>
 #include <unistd.h>
 #include <cinttypes>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
 
 #include <ts/ts.h>
 #include <ts/experimental.h>
@@ -53,6 +58,42 @@ public:
   TSIOBufferReader reader = nullptr;
 };
 
+/*
+ * The new meta data of a seek, which the transactions that make the same
+ * seek into the same object take instead of parsing the moov box again.
+ */
+class Mp4CachedMeta
+{
+public:
+  std::string meta;           // ftyp, moov and mdat header of the new file
+  int64_t start_pos      = 0; // where the media data resumes in the original file
+  int64_t content_length = 0; // the size of the new mp4 file
+};
+
+using Mp4CachedMetaPtr = std::shared_ptr<const Mp4CachedMeta>;
+
+/*
+ * The least recently used entries go first when their meta data takes more
+ * than MAX_BYTES. The key has the url, the validator and the length of the
+ * object, so a changed object is not matched, and the start of the seek.
+ */
+class Mp4MetaCache
+{
+public:
+  static constexpr size_t MAX_BYTES = 64 * 1024 * 1024;
+
+  Mp4CachedMetaPtr get(const std::string &key);
+  void put(const std::string &key, const Mp4CachedMetaPtr &meta);
+
+private:
+  using Entry = std::pair<std::string, Mp4CachedMetaPtr>;
+
+  std::mutex mutex;
+  std::list<Entry> lru; // the most recently used first
+  std::unordered_map<std::string, std::list<Entry>::iterator> index;
+  size_t bytes = 0;
+};
+
 class Mp4TransformContext
 {
 public:
@@ -97,6 +138,9 @@ public:
 
   bool parse_over;
   bool raw_transform;
+
+  Mp4CachedMetaPtr cached; // to use instead of parsing
+  std::string cache_key;   // to store the parsed meta data under, empty if it can not be
 };
 
 class Mp4Context
@@ -53,6 +53,7 @@ static void mp4_reader_set_64value(TSIOBufferReader readerp, int64_t offset, uin
 static uint32_t mp4_reader_get_32value(TSIOBufferReader readerp, int64_t offset);
 static uint64_t mp4_reader_get_64value(TSIOBufferReader readerp, int64_t offset);
 static int64_t IOBufferReaderCopy(TSIOBufferReader readerp, void *buf, int64_t length);
+static uint32_t mp4_sync_sample_upper_bound(TSIOBufferReader readerp, uint32_t entries, uint32_t sample);
 
 int
 Mp4Meta::parse_meta(bool body_complete)
@@ -1113,24 +1114,16 @@ Mp4Meta::mp4_update_stss_atom(Mp4Trak *trak)
 
   readerp = TSIOBufferReaderClone(trak->atoms[MP4_STSS_DATA].reader);
 
-  start_sample = trak->start_sample + 1;
-  entries      = trak->sync_samples_entries;
-
-  for (i = 0; i < entries; i++) {
-    sample = mp4_reader_get_32value(readerp, 0);
-
-    if (sample >= start_sample) {
-      goto found;
-    }
+  entries = trak->sync_samples_entries;
 
-    TSIOBufferReaderConsume(readerp, sizeof(uint32_t));
+  // the first sync sample from trak->start_sample + 1 on
+  i = mp4_sync_sample_upper_bound(readerp, entries, trak->start_sample);
+  if (i >= entries) {
+    TSIOBufferReaderFree(readerp);
+    return -1;
   }
 
-  TSIOBufferReaderFree(readerp);
-  return -1;
-
-found:
-
+  TSIOBufferReaderConsume(readerp, i * sizeof(uint32_t));
   left = entries - i;
 
   start_sample = trak->start_sample;
@@ -1554,7 +1547,7 @@ uint32_t
 Mp4Meta::mp4_find_key_sample(uint32_t start_sample, Mp4Trak *trak)
 {
   uint32_t i;
-  uint32_t sample, prev_sample, entries;
+  uint32_t prev_sample, entries;
   TSIOBufferReader readerp;
 
   if (trak->atoms[MP4_STSS_DATA].buffer == nullptr) {
@@ -1566,23 +1559,42 @@ Mp4Meta::mp4_find_key_sample(uint32_t start_sample, Mp4Trak *trak)
 
   readerp = TSIOBufferReaderClone(trak->atoms[MP4_STSS_DATA].reader);
 
-  for (i = 0; i < entries; i++) {
-    sample = mp4_reader_get_32value(readerp, 0);
-
-    if (sample > start_sample) {
-      goto found;
-    }
-
-    prev_sample = sample;
-    TSIOBufferReaderConsume(readerp, sizeof(uint32_t));
+  i = mp4_sync_sample_upper_bound(readerp, entries, start_sample);
+  if (i > 0) {
+    prev_sample = mp4_reader_get_32value(readerp, (i - 1) * sizeof(uint32_t));
   }
 
-found:
-
   TSIOBufferReaderFree(readerp);
   return prev_sample;
 }
 
+/*
+ * The index of the first of the @a entries sync samples at @a readerp
+ * above @a sample, @a entries if there is none. The samples are in
+ * ascending order, so they are binary searched.
+ */
+static uint32_t
+mp4_sync_sample_upper_bound(TSIOBufferReader readerp, uint32_t entries, uint32_t sample)
+{
+  uint32_t low, high, mid;
+
+  low  = 0;
+  high = entries;
+
+  while (low < high) {
+    mid = low + (high - low) / 2;
+
+    if (mp4_reader_get_32value(readerp, mid * sizeof(uint32_t)) > sample) {
+      high = mid;
+
+    } else {
+      low = mid + 1;
+    }
+  }
+
+  return low;
+}
+
 void
 Mp4Meta::mp4_update_mvhd_duration()
 {
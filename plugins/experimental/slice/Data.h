@@ -79,6 +79,8 @@ struct Data {
 
   BlockState m_blockstate{Pending}; // is there an active slice block
 
+  int64_t m_prefetchnext{-1}; // next block to prefetch, earlier ones were
+
   int64_t m_bytestosend{0}; // header + content bytes to send
   int64_t m_bytessent{0};   // number of bytes written to the client
 
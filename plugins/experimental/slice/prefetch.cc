@@ -0,0 +1,114 @@
+/** @file
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "prefetch.h"
+
+#include "Config.h"
+#include "Data.h"
+
+#include <algorithm>
+
+void
+BgBlockFetch::schedule(Data *const data)
+{
+  int64_t const blockbytes = data->m_config->m_blockbytes;
+  int64_t const lastblock  = data->m_blocknum + data->m_config->m_prefetchcount;
+
+  // blocks already prefetched for this transaction are not fetched again
+  int64_t blocknum = std::max(data->m_prefetchnext, data->m_blocknum + 1);
+  for (; blocknum <= lastblock; ++blocknum) {
+    if (!data->m_req_range.blockIsInside(blockbytes, blocknum) || data->m_contentlen <= blocknum * blockbytes) {
+      break;
+    }
+
+    BgBlockFetch *const bg = new BgBlockFetch(blocknum);
+    if (!bg->fetch(data)) {
+      delete bg;
+      break;
+    }
+  }
+
+  data->m_prefetchnext = blocknum;
+}
+
+BgBlockFetch::~BgBlockFetch()
+{
+  m_stream.close();
+  if (nullptr != m_cont) {
+    TSContDestroy(m_cont);
+  }
+}
+
+bool
+BgBlockFetch::fetch(Data *const data)
+{
+  int64_t const blockbeg = data->m_config->m_blockbytes * m_blocknum;
+  Range blockbe(blockbeg, blockbeg + data->m_config->m_blockbytes);
+
+  char rangestr[1024];
+  int rangelen      = sizeof(rangestr);
+  bool const rpstat = blockbe.toStringClosed(rangestr, &rangelen);
+  TSAssert(rpstat);
+
+  // the block request of the transaction sets its own range again
+  HttpHeader header(data->m_req_hdrmgr.m_buffer, data->m_req_hdrmgr.m_lochdr);
+  if (!header.setKeyVal(TS_MIME_FIELD_RANGE, TS_MIME_LEN_RANGE, rangestr, rangelen)) {
+    ERROR_LOG("Error trying to set prefetch range request header %s", rangestr);
+    return false;
+  }
+
+  DEBUG_LOG("%p prefetching block %" PRId64 ": %s", data, m_blocknum, rangestr);
+
+  m_cont = TSContCreate(handler, TSMutexCreate());
+  TSContDataSet(m_cont, this);
+
+  TSVConn const upvc = TSHttpConnectWithPluginId((sockaddr *)&data->m_client_ip, PLUGIN_NAME, 0);
+  int const hlen     = TSHttpHdrLengthGet(header.m_buffer, header.m_lochdr);
+
+  m_stream.setupConnection(upvc);
+  m_stream.setupVioWrite(m_cont, hlen);
+  TSHttpHdrPrint(header.m_buffer, header.m_lochdr, m_stream.m_write.m_iobuf);
+  TSVIOReenable(m_stream.m_write.m_vio);
+
+  m_stream.setupVioRead(m_cont, INT64_MAX);
+
+  return true;
+}
+
+int
+BgBlockFetch::handler(TSCont contp, TSEvent event, void * /* edata */)
+{
+  BgBlockFetch *const bg = static_cast<BgBlockFetch *>(TSContDataGet(contp));
+
+  switch (event) {
+  case TS_EVENT_VCONN_WRITE_READY:
+  case TS_EVENT_VCONN_WRITE_COMPLETE:
+    break;
+  case TS_EVENT_VCONN_READ_READY:
+    // nothing is kept, the cache has the block
+    bg->m_stream.m_read.drainReader();
+    TSVIOReenable(bg->m_stream.m_read.m_vio);
+    break;
+  default:
+    DEBUG_LOG("prefetch of block %" PRId64 " done: %s", bg->m_blocknum, TSHttpEventNameLookup(event));
+    delete bg;
+    break;
+  }
+
+  return 0;
+}
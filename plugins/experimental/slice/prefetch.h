@@ -0,0 +1,49 @@
+/** @file
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#pragma once
+
+#include "ts/ts.h"
+
+#include "Stage.h"
+
+struct Data;
+
+/**
+ * Background fetch of a block ahead of the one sent to the client.
+ * The response goes through the cache and is thrown away, so that
+ * the block is a cache hit by the time the transaction asks for it.
+ * It only holds what the upstream hands it before it is drained.
+ */
+struct BgBlockFetch {
+  /** Fetch the blocks after the current one, up to the configured count
+   * that are still inside the requested range.
+   */
+  static void schedule(Data *const data);
+
+private:
+  explicit BgBlockFetch(int64_t const blocknum) : m_blocknum(blocknum) {}
+  ~BgBlockFetch();
+
+  bool fetch(Data *const data);
+  static int handler(TSCont contp, TSEvent event, void *edata);
+
+  Stage m_stream;
+  int64_t m_blocknum;
+  TSCont m_cont{nullptr};
+};
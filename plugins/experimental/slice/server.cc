@@ -20,6 +20,7 @@
 
 #include "Config.h"
 #include "ContentRange.h"
+#include "prefetch.h"
 #include "response.h"
 #include "transfer.h"
 #include "util.h"
@@ -579,6 +580,11 @@ handle_server_resp(TSCont contp, TSEvent event, Data *const data)
       default: {
         // how much to normally fast forward into this data block
         data->m_blockskip = data->m_req_range.skipBytesForBlock(data->m_config->m_blockbytes, data->m_blocknum);
+
+        // the block is good, the ones after it are fetched from here on
+        if (0 < data->m_config->m_prefetchcount) {
+          BgBlockFetch::schedule(data);
+        }
       } break;
       }
     }
@@ -84,3 +84,14 @@ TEST_CASE("config bytesfrom invalid parsing", "[AWS][slice][utility]")
     }
   }
 }
+
+TEST_CASE("config prefetch-count parsing", "[AWS][slice][utility]")
+{
+  Config config;
+  CHECK(0 == config.m_prefetchcount);
+
+  char const *const argv[] = {"slice.so", "--prefetch-count=4", "--prefetch-count=100", nullptr};
+  optind                   = 1;
+  CHECK(config.fromArgs(2, argv + 1));
+  CHECK(4 == config.m_prefetchcount);
+}
@@ -68,6 +68,8 @@
  *   The default is 20.
  *
  *   Performance tips:
+ *    - The string from: values of all rules are matched together, in a
+ *      single pass over the data; each regexp from: is a pass of its own.
  *    - A high len: value on any rule can severely impact on performance,
  *      especially if mixed with short matches that match frequently.
  *    - Specify high-precedence rules (low prio: values) first in your
@@ -90,6 +92,8 @@
 
 #include <cstdint>
 
+#include <algorithm>
+#include <array>
 #include <vector>
 #include <set>
 #include <regex.h>
@@ -260,6 +264,13 @@ public:
   virtual bool find(const char *, size_t, size_t &, size_t &, const char *, std::string &) const = 0;
   virtual size_t cont_size() const                                                               = 0;
   virtual ~match_t()                                                                             = default;
+
+  /* A string match gives its string, to be matched together with the others */
+  virtual bool
+  literal(const char *& /* str ATS_UNUSED */, size_t & /* len ATS_UNUSED */, bool & /* icase ATS_UNUSED */) const
+  {
+    return false;
+  }
 };
 
 class strmatch : public match_t
@@ -296,6 +307,15 @@ public:
   {
     return slen;
   }
+
+  bool
+  literal(const char *&s, size_t &len, bool &i) const override
+  {
+    s   = str;
+    len = slen;
+    i   = icase;
+    return slen > 0;
+  }
 };
 
 class rxmatch : public match_t
@@ -528,6 +548,19 @@ public:
     return from->cont_size();
   }
 
+  bool
+  literal(const char *&str, size_t &len, bool &icase) const
+  {
+    return from->literal(str, len, icase);
+  }
+
+  /* add an edit of a match of the literal from: string */
+  void
+  save_literal(size_t found, size_t found_len, editset_t &edits) const
+  {
+    edit_t(found, found_len, to, priority).saveto(edits);
+  }
+
   void
   apply(const char *buf, size_t len, editset_t &edits) const
   {
@@ -551,12 +584,135 @@ public:
 using ruleset_t = std::vector<rule_t>;
 using rule_p    = ruleset_t::const_iterator;
 
+struct literal_hit_t {
+  size_t rule;
+  size_t start;
+  size_t len;
+};
+
+/* Aho-Corasick automaton of the literal from: strings of a ruleset, so that
+ * one pass over the data finds the matches of all of them.  The automaton
+ * runs over lower-cased data, and the matches of case-sensitive strings are
+ * then checked against the data itself.
+ */
+class literal_matcher_t
+{
+  struct literal_t {
+    size_t rule;
+    const char *str;
+    size_t len;
+    bool icase;
+  };
+  struct state_t {
+    std::array<int, 256> next;
+    int fail = 0;
+    int dict = -1;           /* nearest state on the fail chain with output */
+    std::vector<size_t> out; /* indexes of the literals ending here */
+  };
+  std::vector<literal_t> literals;
+  std::vector<state_t> states;
+
+public:
+  void
+  build(const ruleset_t &rules)
+  {
+    states.assign(1, state_t());
+    states[0].next.fill(-1);
+    literals.clear();
+
+    for (size_t r = 0; r < rules.size(); ++r) {
+      literal_t lit;
+      if (!rules[r].literal(lit.str, lit.len, lit.icase)) {
+        continue;
+      }
+      lit.rule = r;
+      int s    = 0;
+      for (size_t i = 0; i < lit.len; ++i) {
+        unsigned char c = tolower(static_cast<unsigned char>(lit.str[i]));
+        if (states[s].next[c] < 0) {
+          states[s].next[c] = states.size();
+          states.emplace_back();
+          states.back().next.fill(-1);
+        }
+        s = states[s].next[c];
+      }
+      states[s].out.push_back(literals.size());
+      literals.push_back(lit);
+    }
+
+    /* breadth first, completing the transitions through the fail links */
+    std::vector<int> queue;
+    for (int &n : states[0].next) {
+      if (n < 0) {
+        n = 0;
+      } else {
+        queue.push_back(n);
+      }
+    }
+    for (size_t q = 0; q < queue.size(); ++q) {
+      int s = queue[q];
+      for (int c = 0; c < 256; ++c) {
+        int n = states[s].next[c];
+        if (n < 0) {
+          states[s].next[c] = states[states[s].fail].next[c];
+        } else {
+          int f          = states[states[s].fail].next[c];
+          states[n].fail = f;
+          states[n].dict = states[f].out.empty() ? states[f].dict : f;
+          queue.push_back(n);
+        }
+      }
+    }
+  }
+
+  bool
+  empty() const
+  {
+    return literals.empty();
+  }
+
+  /* Matches of the active rules in buf, non-overlapping and leftmost first for each rule
+   * like a scan for each of them would find, ordered by rule and then by position.
+   */
+  void
+  find(const char *buf, size_t len, const std::vector<bool> &active, std::vector<literal_hit_t> &hits) const
+  {
+    std::vector<size_t> next_start(literals.size(), 0);
+    int s = 0;
+
+    for (size_t i = 0; i < len; ++i) {
+      s = states[s].next[tolower(static_cast<unsigned char>(buf[i]))];
+      for (int d = states[s].out.empty() ? states[s].dict : s; d >= 0; d = states[d].dict) {
+        for (size_t l : states[d].out) {
+          const literal_t &lit = literals[l];
+          size_t start         = i + 1 - lit.len;
+          if (!active[lit.rule] || start < next_start[l] || (!lit.icase && memcmp(buf + start, lit.str, lit.len) != 0)) {
+            continue;
+          }
+          hits.push_back({lit.rule, start, lit.len});
+          next_start[l] = i + 1;
+        }
+      }
+    }
+    std::sort(hits.begin(), hits.end(), [](const literal_hit_t &a, const literal_hit_t &b) {
+      return a.rule < b.rule || (a.rule == b.rule && a.start < b.start);
+    });
+  }
+};
+
+/* The rules of one direction, as read from the config files */
+struct ruleconf_t {
+  ruleset_t rules;
+  literal_matcher_t literals;
+};
+
 typedef struct contdata_t {
   TSCont cont             = nullptr;
   TSIOBuffer out_buf      = nullptr;
   TSIOBufferReader out_rd = nullptr;
   TSVIO out_vio           = nullptr;
-  ruleset_t rules;
+  const ruleconf_t *conf  = nullptr;
+  std::vector<bool> active; /* the rules in scope */
   std::string contbuf;
   size_t contbuf_sz = 0;
   int64_t bytes_in  = 0;
@@ -584,6 +740,16 @@ typedef struct contdata_t {
   }
 } contdata_t;
 
+/* Unedited bytes still in the input block are shared with the output, not copied */
+static int64_t
+pass_through(contdata_t *contdata, TSIOBufferBlock block, const char *data, int64_t len)
+{
+  if (block != nullptr) {
+    return TSIOBufferBlockAppend(contdata->out_buf, block, data, len);
+  }
+  return TSIOBufferWrite(contdata->out_buf, data, len);
+}
+
 static int64_t
 process_block(contdata_t *contdata, TSIOBufferReader reader)
 {
@@ -592,7 +758,7 @@ process_block(contdata_t *contdata, TSIOBufferReader reader)
   size_t buflen;
   size_t keep;
   const char *buf;
-  TSIOBufferBlock block;
+  TSIOBufferBlock block = nullptr;
 
   if (reader == nullptr) { // We're just flushing anything we have buffered
     keep   = 0;
@@ -604,9 +770,10 @@ process_block(contdata_t *contdata, TSIOBufferReader reader)
     buf   = TSIOBufferBlockReadStart(block, reader, &nbytes);
 
     if (contdata->contbuf.empty()) {
-      /* Use the data as-is */
+      /* Use the data as-is, and forward unedited bytes by reference */
       buflen = nbytes;
     } else {
+      block = nullptr;
       contdata->contbuf.append(buf, nbytes);
       buf    = contdata->contbuf.c_str();
       buflen = contdata->contbuf.length();
@@ -616,9 +783,28 @@ process_block(contdata_t *contdata, TSIOBufferReader reader)
   size_t bytes_read = 0;
 
   editset_t edits;
+  std::vector<literal_hit_t> hits;
+  const ruleset_t &rules = contdata->conf->rules;
 
-  for (rule_p r = contdata->rules.begin(); r != contdata->rules.end(); ++r) {
-    r->apply(buf, buflen, edits);
+  /* the edits are made in rule order, which settles conflicts of equal priority */
+  if (!contdata->conf->literals.empty()) {
+    contdata->conf->literals.find(buf, buflen, contdata->active, hits);
+  }
+  auto hit = hits.begin();
+  for (size_t r = 0; r < rules.size(); ++r) {
+    const char *str;
+    size_t len;
+    bool icase;
+    if (!contdata->active[r]) {
+      continue;
+    }
+    if (rules[r].literal(str, len, icase)) {
+      for (; hit != hits.end() && hit->rule == r; ++hit) {
+        rules[r].save_literal(hit->start, hit->len, edits);
+      }
+    } else {
+      rules[r].apply(buf, buflen, edits);
+    }
   }
 
   for (edit_p p = edits.begin(); p != edits.end(); ++p) {
@@ -631,9 +817,7 @@ process_block(contdata_t *contdata, TSIOBufferReader reader)
     start = p->start - bytes_read;
 
     while (start > 0) {
-      // FIXME: would this be quicker if we managed a TSIOBuffer
-      //        so we could use TSIOBufferCopy ?
-      n = TSIOBufferWrite(contdata->out_buf, buf + bytes_read, start);
+      n = pass_through(contdata, block, buf + bytes_read, start);
       assert(n > 0); // FIXME - handle error
       bytes_read += n;
       contdata->bytes_out += n;
@@ -654,13 +838,13 @@ process_block(contdata_t *contdata, TSIOBufferReader reader)
 
   /* data after the last edit */
   if (bytes_read < buflen - keep) {
-    n = TSIOBufferWrite(contdata->out_buf, buf + bytes_read, buflen - bytes_read - keep);
+    n = pass_through(contdata, block, buf + bytes_read, buflen - bytes_read - keep);
     contdata->bytes_in += n;
     contdata->bytes_out += n;
     bytes_read += n;
   }
-  /* reset buf to what we've not processed */
-  contdata->contbuf = buf + bytes_read;
+  /* reset buf to what we've not processed, the block data is not nul terminated */
+  contdata->contbuf.assign(buf + bytes_read, buflen - bytes_read);
 
   return nbytes;
 }
@@ -761,19 +945,21 @@ static int
 streamedit_setup(TSCont contp, TSEvent event, void *edata)
 {
   TSHttpTxn txn        = static_cast<TSHttpTxn>(edata);
-  ruleset_t *rules_in  = static_cast<ruleset_t *>(TSContDataGet(contp));
+  ruleconf_t *conf     = static_cast<ruleconf_t *>(TSContDataGet(contp));
   contdata_t *contdata = nullptr;
 
   assert((event == TS_EVENT_HTTP_READ_RESPONSE_HDR) || (event == TS_EVENT_HTTP_READ_REQUEST_HDR));
 
-  /* make a new list comprising those rules that are in scope */
-  for (rule_p r = rules_in->begin(); r != rules_in->end(); ++r) {
-    if (r->in_scope(txn)) {
+  /* mark those rules that are in scope */
+  for (size_t r = 0; r < conf->rules.size(); ++r) {
+    if (conf->rules[r].in_scope(txn)) {
       if (contdata == nullptr) {
-        contdata = new contdata_t();
+        contdata         = new contdata_t();
+        contdata->conf   = conf;
+        contdata->active = std::vector<bool>(conf->rules.size(), false);
       }
-      contdata->rules.push_back(*r);
-      contdata->set_cont_size(r->cont_size());
+      contdata->active[r] = true;
+      contdata->set_cont_size(conf->rules[r].cont_size());
     }
   }
 
@@ -798,7 +984,7 @@ streamedit_setup(TSCont contp, TSEvent event, void *edata)
 }
 
 static void
-read_conf(const char *filename, ruleset_t *&in, ruleset_t *&out)
+read_conf(const char *filename, ruleconf_t *&in, ruleconf_t *&out)
 {
   char buf[MAX_CONFIG_LINE];
   FILE *file = fopen(filename, "r");
@@ -811,14 +997,14 @@ read_conf(const char *filename, ruleset_t *&in, ruleset_t *&out)
     try {
       if (!strncasecmp(buf, "[in]", 4)) {
         if (in == nullptr) {
-          in = new ruleset_t();
+          in = new ruleconf_t();
         }
-        in->push_back(rule_t(buf));
+        in->rules.push_back(rule_t(buf));
       } else if (!strncasecmp(buf, "[out]", 5)) {
         if (out == nullptr) {
-          out = new ruleset_t();
+          out = new ruleconf_t();
         }
-        out->push_back(rule_t(buf));
+        out->rules.push_back(rule_t(buf));
       }
     } catch (...) {
       TSError("stream-editor: failed to parse rule %s", buf);
@@ -832,8 +1018,8 @@ TSPluginInit(int argc, const char *argv[])
 {
   TSPluginRegistrationInfo info;
   TSCont inputcont, outputcont;
-  ruleset_t *rewrites_in  = nullptr;
-  ruleset_t *rewrites_out = nullptr;
+  ruleconf_t *rewrites_in  = nullptr;
+  ruleconf_t *rewrites_out = nullptr;
 
   info.plugin_name   = (char *)"stream-editor";
   info.vendor_name   = (char *)"Apache Software Foundation";
@@ -851,6 +1037,7 @@ TSPluginInit(int argc, const char *argv[])
 
   if (rewrites_in != nullptr) {
     TSDebug("[stream-editor]", "initializing input filtering");
+    rewrites_in->literals.build(rewrites_in->rules);
     inputcont = TSContCreate(streamedit_setup, nullptr);
     if (inputcont == nullptr) {
       TSError("[stream-editor] failed to initialize input filtering!");
@@ -864,6 +1051,7 @@ TSPluginInit(int argc, const char *argv[])
 
   if (rewrites_out != nullptr) {
     TSDebug("[stream-editor]", "initializing output filtering");
+    rewrites_out->literals.build(rewrites_out->rules);
     outputcont = TSContCreate(streamedit_setup, nullptr);
     if (outputcont == nullptr) {
       TSError("[stream-editor] failed to initialize output filtering!");
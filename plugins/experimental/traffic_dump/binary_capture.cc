@@ -0,0 +1,154 @@
+/** @file
+
+  Binary capture of the dumped traffic.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include <cerrno>
+#include <chrono>
+#include <fcntl.h>
+#include <mutex>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "ts/ts.h"
+#include "tscore/ts_file.h"
+
+#include "binary_capture.h"
+#include "global_variables.h"
+#include "session_data.h"
+
+namespace traffic_dump
+{
+namespace
+{
+/// How long the writer sleeps when all the rings are empty.
+constexpr auto writer_idle_interval = std::chrono::milliseconds(10);
+
+int capture_fd = -1;
+std::atomic<uint64_t> dropped_records{0};
+
+/// The rings of all the threads. The rings live as long as the process.
+std::mutex rings_mutex;
+std::vector<CaptureRing *> rings;
+
+thread_local CaptureRing *thread_ring = nullptr;
+
+bool
+write_fully(std::string_view bytes)
+{
+  while (!bytes.empty()) {
+    ssize_t written = ::write(capture_fd, bytes.data(), bytes.size());
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return false;
+    }
+    bytes.remove_prefix(written);
+  }
+  return true;
+}
+
+void *
+writer_thread(void *)
+{
+  std::vector<CaptureRing *> snapshot;
+  uint64_t reported_drops = 0;
+
+  while (true) {
+    {
+      const std::lock_guard<std::mutex> _(rings_mutex);
+      snapshot = rings;
+    }
+
+    size_t drained = 0;
+    for (CaptureRing *ring : snapshot) {
+      drained += ring->drain([](std::string_view bytes) {
+        if (!write_fully(bytes)) {
+          TSError("[%s] Failed to write to the binary capture file: %s", debug_tag, strerror(errno));
+        }
+      });
+    }
+    SessionData::add_disk_usage(drained);
+
+    const uint64_t drops = dropped_records.load(std::memory_order_relaxed);
+    if (drops != reported_drops) {
+      TSDebug(debug_tag, "Dropped %" PRIu64 " binary capture records, the thread rings are full", drops - reported_drops);
+      reported_drops = drops;
+    }
+    if (drained == 0) {
+      std::this_thread::sleep_for(writer_idle_interval);
+    }
+  }
+  return nullptr;
+}
+} // namespace
+
+bool
+BinaryCapture::init(std::string_view log_directory)
+{
+  auto start = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch());
+  ts::file::path capture_path =
+    ts::file::path{log_directory} / ts::file::path("capture." + std::to_string(start.count()) + "." + std::to_string(getpid()));
+
+  capture_fd = open(capture_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, S_IRUSR | S_IWUSR);
+  if (capture_fd < 0) {
+    TSError("[%s] Failed to open the binary capture file %s: %s", debug_tag, capture_path.c_str(), strerror(errno));
+    return false;
+  }
+  if (!write_fully(std::string_view{binary_capture_magic, sizeof(binary_capture_magic) - 1})) {
+    TSError("[%s] Failed to write to the binary capture file %s: %s", debug_tag, capture_path.c_str(), strerror(errno));
+    close(capture_fd);
+    capture_fd = -1;
+    return false;
+  }
+
+  if (TSThreadCreate(writer_thread, nullptr) == nullptr) {
+    TSError("[%s] Failed to start the binary capture writer thread.", debug_tag);
+    close(capture_fd);
+    capture_fd = -1;
+    return false;
+  }
+  TSDebug(debug_tag, "Capturing in the binary format to %s", capture_path.c_str());
+  return true;
+}
+
+bool
+BinaryCapture::is_enabled()
+{
+  return capture_fd >= 0;
+}
+
+void
+BinaryCapture::write(BinaryRecord &record)
+{
+  if (thread_ring == nullptr) {
+    thread_ring = new CaptureRing(ring_size);
+    const std::lock_guard<std::mutex> _(rings_mutex);
+    rings.push_back(thread_ring);
+  }
+  if (!thread_ring->push(record.finish())) {
+    dropped_records.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+} // namespace traffic_dump
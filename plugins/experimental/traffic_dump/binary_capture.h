@@ -0,0 +1,237 @@
+/** @file
+
+  Binary capture of the dumped traffic.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace traffic_dump
+{
+/** The binary capture format.
+ *
+ * A capture file starts with the magic below and is followed by records. Each
+ * record starts with its size (u32, the header included), its type (u8) and
+ * the id of its session (u64). All integers are in host byte order and strings
+ * are a u32 length followed by the bytes. binary_to_json.py converts capture
+ * files to the JSON replay files traffic_dump writes otherwise.
+ *
+ * SESSION_START: connection-time (u64), client IP (string), client protocol
+ *   node (string, JSON).
+ * TRANSACTION: connection-time (u64), uuid (string), then messages until the
+ *   end of the record. A message is its type (u8), for a proxy request the
+ *   server protocol node (string, JSON), the major and minor version (u8 each),
+ *   the scheme, method and url (strings) of a request or the status (u16) and
+ *   reason (string) of a response, the field count (u32) and fields, and the
+ *   body size (i64). A field is its name (string) and value (string), a value
+ *   length with sensitive_value_flag set has no bytes, the value is replaced
+ *   by generic content of that length at conversion.
+ * SESSION_END: nothing.
+ */
+constexpr char binary_capture_magic[] = "TSDUMPB1";
+
+enum class BinaryRecordType : uint8_t {
+  SESSION_START = 1,
+  TRANSACTION   = 2,
+  SESSION_END   = 3,
+};
+
+enum class BinaryMessageType : uint8_t {
+  CLIENT_REQUEST  = 1,
+  PROXY_REQUEST   = 2,
+  SERVER_RESPONSE = 3,
+  PROXY_RESPONSE  = 4,
+};
+
+/// Set in the length of a field value that was not captured because it is sensitive.
+constexpr uint32_t sensitive_value_flag = 0x80000000;
+
+/** A binary capture record being built.
+ *
+ * Building a record is appending to a string, there is no escaping and no
+ * formatting on the transaction thread.
+ */
+class BinaryRecord
+{
+public:
+  /// The size of the record header: size, type and session id.
+  static constexpr size_t header_size = sizeof(uint32_t) + sizeof(uint8_t) + sizeof(uint64_t);
+
+  BinaryRecord(BinaryRecordType type, uint64_t session_id)
+  {
+    data.reserve(1024);
+    append_u32(0);
+    append_u8(static_cast<uint8_t>(type));
+    append_u64(session_id);
+  }
+
+  void
+  append_u8(uint8_t value)
+  {
+    data.push_back(static_cast<char>(value));
+  }
+
+  void
+  append_u16(uint16_t value)
+  {
+    data.append(reinterpret_cast<char const *>(&value), sizeof(value));
+  }
+
+  void
+  append_u32(uint32_t value)
+  {
+    data.append(reinterpret_cast<char const *>(&value), sizeof(value));
+  }
+
+  void
+  append_u64(uint64_t value)
+  {
+    data.append(reinterpret_cast<char const *>(&value), sizeof(value));
+  }
+
+  void
+  append_string(std::string_view value)
+  {
+    append_u32(value.size());
+    data.append(value.data(), value.size());
+  }
+
+  /// Append a u64 to be set later by patch_u64, returning its offset.
+  size_t
+  reserve_u64()
+  {
+    size_t offset = data.size();
+    append_u64(0);
+    return offset;
+  }
+
+  void
+  patch_u64(size_t offset, uint64_t value)
+  {
+    memcpy(data.data() + offset, &value, sizeof(value));
+  }
+
+  /// Set the size of the record and return its bytes.
+  std::string_view
+  finish()
+  {
+    uint32_t size = data.size();
+    memcpy(data.data(), &size, sizeof(size));
+    return data;
+  }
+
+private:
+  std::string data;
+};
+
+/** A byte ring with a single producer and a single consumer.
+ *
+ * The producer is a transaction thread and the consumer is the writer thread.
+ * A record is pushed whole or not at all, so the consumer can copy the bytes
+ * out without looking at them.
+ */
+class CaptureRing
+{
+public:
+  /// @a capacity must be a power of two.
+  explicit CaptureRing(size_t capacity) : _capacity(capacity), _buffer(new char[capacity]) {}
+
+  /// Push @a record, return @c false if there is not room for it.
+  bool
+  push(std::string_view record)
+  {
+    uint64_t head = _head.load(std::memory_order_relaxed);
+    if (record.size() > _capacity - (head - _tail.load(std::memory_order_acquire))) {
+      return false;
+    }
+    size_t start = head & (_capacity - 1);
+    size_t first = std::min(record.size(), _capacity - start);
+    memcpy(_buffer.get() + start, record.data(), first);
+    memcpy(_buffer.get(), record.data() + first, record.size() - first);
+    _head.store(head + record.size(), std::memory_order_release);
+    return true;
+  }
+
+  /** Pass the pushed bytes to @a consume, in at most two pieces, and release them.
+   *
+   * @return The number of bytes drained.
+   */
+  template <typename F>
+  size_t
+  drain(F &&consume)
+  {
+    uint64_t tail = _tail.load(std::memory_order_relaxed);
+    uint64_t head = _head.load(std::memory_order_acquire);
+    size_t size   = head - tail;
+    if (size == 0) {
+      return 0;
+    }
+    size_t start = tail & (_capacity - 1);
+    size_t first = std::min(size, _capacity - start);
+    consume(std::string_view{_buffer.get() + start, first});
+    if (first < size) {
+      consume(std::string_view{_buffer.get(), size - first});
+    }
+    _tail.store(head, std::memory_order_release);
+    return size;
+  }
+
+private:
+  size_t const _capacity;
+  std::unique_ptr<char[]> _buffer;
+  std::atomic<uint64_t> _head{0}; ///< Written by the producer only.
+  std::atomic<uint64_t> _tail{0}; ///< Written by the consumer only.
+};
+
+/** The capture of the dumped traffic in the binary format.
+ *
+ * Each thread pushes the records into a ring of its own and a writer thread
+ * drains the rings to the capture file, so that no transaction thread formats
+ * JSON or waits for the disk. A record that does not fit in the ring of its
+ * thread is dropped.
+ */
+class BinaryCapture
+{
+public:
+  /// The size of the ring of each thread.
+  static constexpr size_t ring_size = 1 << 20;
+
+  /** Open the capture file in @a log_directory and start the writer thread.
+   *
+   * @return True if initialization is successful, false otherwise.
+   */
+  static bool init(std::string_view log_directory);
+
+  /// Whether the traffic is captured in the binary format.
+  static bool is_enabled();
+
+  /// Push the @a record into the ring of this thread.
+  static void write(BinaryRecord &record);
+};
+
+} // namespace traffic_dump
@@ -0,0 +1,321 @@
+#!/usr/bin/env python3
+'''
+Licensed to the Apache Software Foundation (ASF) under one
+or more contributor license agreements.  See the NOTICE file
+distributed with this work for additional information
+regarding copyright ownership.  The ASF licenses this file
+to you under the Apache License, Version 2.0 (the
+"License"); you may not use this file except in compliance
+with the License.  You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the License is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied.  See the License for the
+specific language governing permissions and limitations
+under the License.
+'''
+
+from collections import OrderedDict
+import argparse
+import logging
+import os
+import struct
+import sys
+
+description = '''
+Convert a capture file written by traffic_dump with --binary to the JSON replay
+files traffic_dump writes otherwise: one file per session in a subdirectory
+named after the first three characters of the client IP. The replay files can
+then be post processed by post_process.py.
+'''
+
+MAGIC = b'TSDUMPB1'
+
+SESSION_START = 1
+TRANSACTION = 2
+SESSION_END = 3
+
+CLIENT_REQUEST = 1
+PROXY_REQUEST = 2
+SERVER_RESPONSE = 3
+PROXY_RESPONSE = 4
+
+MESSAGE_NODES = {
+    CLIENT_REQUEST: b'client-request',
+    PROXY_REQUEST: b'proxy-request',
+    SERVER_RESPONSE: b'server-response',
+    PROXY_RESPONSE: b'proxy-response',
+}
+
+SENSITIVE_VALUE_FLAG = 0x80000000
+
+# The generic content dumped for sensitive field values, as traffic_dump
+# generates it.
+SENSITIVE_VALUE_SIZE = 128 * 1024
+SENSITIVE_VALUE = b''.join(b'%07x ' % i for i in range(SENSITIVE_VALUE_SIZE // 8))
+
+ESCAPES = {
+    ord('"'): b'\\"',
+    ord('\\'): b'\\\\',
+    ord('\b'): b'\\b',
+    ord('\f'): b'\\f',
+    ord('\n'): b'\\n',
+    ord('\r'): b'\\r',
+    ord('\t'): b'\\t',
+}
+
+
+class CaptureError(Exception):
+    ''' The capture file is not a traffic_dump binary capture.
+    '''
+    pass
+
+
+def escape_json(value):
+    """ Escape the bytes of value as traffic_dump does for esc_json content.
+
+    Args:
+        value (bytes) The bytes to escape.
+
+    Return:
+        The escaped bytes.
+    """
+    escaped = bytearray()
+    for c in value:
+        if c in ESCAPES:
+            escaped += ESCAPES[c]
+        elif c <= 0x1f:
+            escaped += b'\\u%04x' % c
+        else:
+            escaped.append(c)
+    return bytes(escaped)
+
+
+def json_entry(name, value):
+    return b'"' + escape_json(name) + b'":"' + escape_json(value) + b'"'
+
+
+def json_entry_array(name, value):
+    return b'["' + escape_json(name) + b'","' + escape_json(value) + b'"]'
+
+
+class Reader:
+    ''' Read the fields of a record.
+    '''
+
+    def __init__(self, data, offset, end):
+        self.data = data
+        self.offset = offset
+        self.end = end
+
+    def at_end(self):
+        return self.offset >= self.end
+
+    def unpack(self, fmt):
+        size = struct.calcsize(fmt)
+        if self.offset + size > self.end:
+            raise CaptureError('truncated record')
+        value = struct.unpack_from(fmt, self.data, self.offset)[0]
+        self.offset += size
+        return value
+
+    def u8(self):
+        return self.unpack('=B')
+
+    def u16(self):
+        return self.unpack('=H')
+
+    def u32(self):
+        return self.unpack('=I')
+
+    def u64(self):
+        return self.unpack('=Q')
+
+    def i64(self):
+        return self.unpack('=q')
+
+    def bytes(self, length):
+        if self.offset + length > self.end:
+            raise CaptureError('truncated record')
+        value = self.data[self.offset:self.offset + length]
+        self.offset += length
+        return value
+
+    def string(self):
+        return self.bytes(self.u32())
+
+
+def read_message(reader, message_type):
+    """ Read a message of a transaction record and return its JSON node.
+    """
+    node = b',"' + MESSAGE_NODES[message_type] + b'":{'
+    if message_type == PROXY_REQUEST:
+        node += reader.string() + b','
+    major = reader.u8()
+    minor = reader.u8()
+    node += b'"version":"%d.%d"' % (major, minor)
+    if message_type in (CLIENT_REQUEST, PROXY_REQUEST):
+        node += b',' + json_entry(b'scheme', reader.string())
+        node += b',' + json_entry(b'method', reader.string())
+        node += b',' + json_entry(b'url', reader.string())
+    else:
+        node += b',"status":%d' % reader.u16()
+        node += b',' + json_entry(b'reason', reader.string())
+
+    fields = []
+    for _ in range(reader.u32()):
+        name = reader.string()
+        value_length = reader.u32()
+        if value_length & SENSITIVE_VALUE_FLAG:
+            value_length &= ~SENSITIVE_VALUE_FLAG
+            if value_length > SENSITIVE_VALUE_SIZE:
+                logging.warning("Sensitive field value larger than %d bytes, truncated", SENSITIVE_VALUE_SIZE)
+            value = SENSITIVE_VALUE[:value_length]
+        else:
+            value = reader.bytes(value_length)
+        if name:
+            fields.append(json_entry_array(name, value))
+    node += b',"headers":{"encoding":"esc_json", "fields": [' + b','.join(fields) + b']}'
+    node += b',"content":{"encoding":"plain","size":%d}}' % reader.i64()
+    return node
+
+
+def read_transaction(reader):
+    """ Read a transaction record and return its JSON node.
+    """
+    connection_time = reader.u64()
+    uuid = reader.string()
+    node = b'{"connection-time":%d' % connection_time
+    node += b',"all":{"headers":{"fields":[' + json_entry_array(b'uuid', uuid) + b']}}'
+    while not reader.at_end():
+        message_type = reader.u8()
+        if message_type not in MESSAGE_NODES:
+            raise CaptureError('unknown message type {}'.format(message_type))
+        node += read_message(reader, message_type)
+    return node + b'}'
+
+
+class Session:
+    def __init__(self, connection_time, client_ip, protocol):
+        self.connection_time = connection_time
+        self.client_ip = client_ip
+        self.protocol = protocol
+        self.transactions = []
+        self.closed = False
+
+
+def read_capture(capture_file):
+    """ Read the sessions of a capture file.
+
+    Args:
+        capture_file (string) The path to the capture file.
+
+    Return:
+        The sessions by id, in the order they started, and the number of
+        records that were skipped.
+    """
+    with open(capture_file, 'rb') as f:
+        data = f.read()
+    if not data.startswith(MAGIC):
+        raise CaptureError('{} is not a traffic_dump binary capture'.format(capture_file))
+
+    sessions = OrderedDict()
+    skipped = 0
+    offset = len(MAGIC)
+    header_size = struct.calcsize('=IBQ')
+    while offset + header_size <= len(data):
+        size, record_type, session_id = struct.unpack_from('=IBQ', data, offset)
+        if size < header_size or offset + size > len(data):
+            # Traffic Server stopped while this record was written.
+            logging.warning("Truncated record at offset %d, ignoring the end of %s", offset, capture_file)
+            break
+        reader = Reader(data, offset + header_size, offset + size)
+        offset += size
+
+        try:
+            if record_type == SESSION_START:
+                connection_time = reader.u64()
+                client_ip = reader.string().decode('ascii', 'replace')
+                protocol = reader.string()
+                sessions[session_id] = Session(connection_time, client_ip, protocol)
+            elif session_id not in sessions:
+                # The start of the session was dropped.
+                skipped += 1
+            elif record_type == TRANSACTION:
+                sessions[session_id].transactions.append(read_transaction(reader))
+            elif record_type == SESSION_END:
+                sessions[session_id].closed = True
+            else:
+                raise CaptureError('unknown record type {}'.format(record_type))
+        except CaptureError as e:
+            logging.debug("Skipping a record of session %d: %s", session_id, e)
+            skipped += 1
+    return sessions, skipped
+
+
+def write_session(out_dir, session_id, session):
+    """ Write the session to its replay file, named as traffic_dump names it.
+    """
+    subdir = os.path.join(out_dir, session.client_ip[:3])
+    os.makedirs(subdir, exist_ok=True)
+    with open(os.path.join(subdir, '{:016x}'.format(session_id)), 'wb') as f:
+        f.write(b'{"meta":{"version":"1.0"},"sessions":[{' + session.protocol)
+        f.write(b',"connection-time":%d,"transactions":[' % session.connection_time)
+        f.write(b','.join(session.transactions))
+        f.write(b']}]}')
+
+
+def configure_logging(use_debug=False):
+    ''' Configure the logging mechanism.
+
+    Args:
+        use_debug (bool) Whether to configure debug-level logging.
+    '''
+    log_format = '%(levelname)s: %(message)s'
+    if use_debug:
+        logging.basicConfig(format=log_format, level=logging.DEBUG)
+    else:
+        logging.basicConfig(format=log_format, level=logging.INFO)
+
+
+def parse_args():
+    ''' Parse the command line arguments.
+    '''
+    parser = argparse.ArgumentParser(description=description)
+
+    parser.add_argument("capture_file", type=str,
+                        help='''The capture file written by traffic_dump in the
+                        directory given by --logdir.''')
+    parser.add_argument("out_dir", type=str,
+                        help="The output directory of the replay files.")
+    parser.add_argument("-d", "--debug", action="store_true",
+                        help="Enable debug level logging.")
+    return parser.parse_args()
+
+
+def main():
+    args = parse_args()
+    configure_logging(use_debug=args.debug)
+
+    try:
+        sessions, skipped = read_capture(args.capture_file)
+    except (OSError, CaptureError) as e:
+        logging.error("%s", e)
+        return 1
+
+    transaction_count = 0
+    for session_id, session in sessions.items():
+        if not session.closed:
+            logging.debug("Session %d was not closed in the capture", session_id)
+        write_session(args.out_dir, session_id, session)
+        transaction_count += len(session.transactions)
+    logging.info("Total %d sessions and %d transactions, %d records skipped.",
+                 len(sessions), transaction_count, skipped)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -29,6 +29,7 @@
 
 #include <tscore/ink_inet.h>
 
+#include "binary_capture.h"
 #include "session_data.h"
 #include "global_variables.h"
 #include "transaction_data.h"
@@ -210,6 +211,18 @@ SessionData::reset_disk_usage()
   disk_usage = 0;
 }
 
+void
+SessionData::add_disk_usage(int64_t bytes)
+{
+  disk_usage += bytes;
+}
+
+uint64_t
+SessionData::get_session_id() const
+{
+  return session_id;
+}
+
 void
 SessionData::set_max_disk_usage(int64_t new_max_disk_usage)
 {
@@ -426,6 +439,7 @@ SessionData::global_session_handler(TSCont contp, TSEvent event, void *edata)
 
     // Create new per session data
     SessionData *ssnData = new SessionData;
+    ssnData->session_id  = this_session_count;
     TSUserArgSet(ssnp, session_arg_index, ssnData);
 
     TSContDataSet(ssnData->aio_cont, ssnData);
@@ -434,14 +448,6 @@ SessionData::global_session_handler(TSCont contp, TSEvent event, void *edata)
     // This is the protocol stack for the client side of the session.
     std::string protocol_description = get_client_protocol_description(ssnp);
 
-    std::string beginning = R"({"meta":{"version":"1.0"},"sessions":[{)" + protocol_description + R"(,"connection-time":)" +
-                            std::to_string(start.count()) + R"(,"transactions":[)";
-
-    // Use the session count's hex string as the filename.
-    std::stringstream stream;
-    stream << std::setw(16) << std::setfill('0') << std::hex << this_session_count;
-    std::string session_hex_name = stream.str();
-
     // Use client ip as sub directory name
     char client_str[INET6_ADDRSTRLEN];
     sockaddr const *client_ip = TSHttpSsnClientAddrGet(ssnp);
@@ -454,6 +460,28 @@ SessionData::global_session_handler(TSCont contp, TSEvent event, void *edata)
       snprintf(client_str, INET6_ADDRSTRLEN, "unknown");
     }
 
+    if (BinaryCapture::is_enabled()) {
+      // The converter lays out the replay files from this record as the JSON
+      // dump would have.
+      BinaryRecord record{BinaryRecordType::SESSION_START, this_session_count};
+      record.append_u64(start.count());
+      record.append_string(client_str);
+      record.append_string(protocol_description);
+      BinaryCapture::write(record);
+
+      TSHttpSsnHookAdd(ssnp, TS_HTTP_TXN_START_HOOK, ssnData->txn_cont);
+      TSHttpSsnHookAdd(ssnp, TS_HTTP_TXN_CLOSE_HOOK, ssnData->txn_cont);
+      break;
+    }
+
+    std::string beginning = R"({"meta":{"version":"1.0"},"sessions":[{)" + protocol_description + R"(,"connection-time":)" +
+                            std::to_string(start.count()) + R"(,"transactions":[)";
+
+    // Use the session count's hex string as the filename.
+    std::stringstream stream;
+    stream << std::setw(16) << std::setfill('0') << std::hex << this_session_count;
+    std::string session_hex_name = stream.str();
+
     // Initialize AIO file
     const std::lock_guard<std::recursive_mutex> _(ssnData->disk_io_mutex);
     if (ssnData->log_fd < 0) {
@@ -496,6 +524,13 @@ SessionData::global_session_handler(TSCont contp, TSEvent event, void *edata)
       TSHttpSsnReenable(ssnp, TS_EVENT_HTTP_CONTINUE);
       return TS_SUCCESS;
     }
+    if (BinaryCapture::is_enabled()) {
+      BinaryRecord record{BinaryRecordType::SESSION_END, ssnData->session_id};
+      BinaryCapture::write(record);
+      TSUserArgSet(ssnp, session_arg_index, nullptr);
+      delete ssnData;
+      break;
+    }
     ssnData->write_to_disk(json_closing);
     {
       const std::lock_guard<std::recursive_mutex> _(ssnData->disk_io_mutex);
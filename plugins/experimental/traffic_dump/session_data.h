@@ -61,6 +61,8 @@ private:
   ts::file::path log_name;
   /// Whether the first transaction in this session has been written.
   bool has_written_first_transaction = false;
+  /// The count of this session among the dumped ones, which names its dump file.
+  uint64_t session_id = 0;
 
   TSCont aio_cont = nullptr; /// AIO continuation callback
   TSCont txn_cont = nullptr; /// Transaction continuation callback
@@ -118,6 +120,15 @@ public:
   /** Reset the disk usage counter to 0. */
   static void reset_disk_usage();
 
+  /** Add the bytes written to dump files outside of the session dump files.
+   *
+   * @param[in] bytes The number of bytes written.
+   */
+  static void add_disk_usage(int64_t bytes);
+
+  /** The getter for the session_id value. */
+  uint64_t get_session_id() const;
+
   /** Set the max_disk_usage to a new value.
    *
    * @param[in] new_max_disk_usage The new value to set for max_disk_usage.
@@ -20,6 +20,7 @@
 
 #include <getopt.h>
 
+#include "binary_capture.h"
 #include "global_variables.h"
 #include "session_data.h"
 #include "transaction_data.h"
@@ -82,12 +83,14 @@ TSPluginInit(int argc, char const *argv[])
   int64_t sample_pool_size = traffic_dump::SessionData::default_sample_pool_size;
   int64_t max_disk_usage   = traffic_dump::SessionData::default_max_disk_usage;
   std::string sni_filter;
+  bool binary = false;
 
   /// Commandline options
   static const struct option longopts[] = {
     {"logdir", required_argument, nullptr, 'l'},     {"sample", required_argument, nullptr, 's'},
     {"limit", required_argument, nullptr, 'm'},      {"sensitive-fields", required_argument, nullptr, 'f'},
-    {"sni-filter", required_argument, nullptr, 'n'}, {nullptr, no_argument, nullptr, 0}};
+    {"sni-filter", required_argument, nullptr, 'n'}, {"binary", no_argument, nullptr, 'b'},
+    {nullptr, no_argument, nullptr, 0}};
   int opt = 0;
   while (opt >= 0) {
     opt = getopt_long(argc, const_cast<char *const *>(argv), "l:", longopts, nullptr);
@@ -118,6 +121,12 @@ TSPluginInit(int argc, char const *argv[])
       sni_filter = std::string(optarg);
       break;
     }
+    case 'b': {
+      // --binary captures the traffic in the binary format, converted to
+      // replay files offline by binary_to_json.py.
+      binary = true;
+      break;
+    }
     case 'l': {
       log_dir = ts::file::path{optarg};
       break;
@@ -154,6 +163,11 @@ TSPluginInit(int argc, char const *argv[])
     }
   }
 
+  if (binary && !traffic_dump::BinaryCapture::init(log_dir.view())) {
+    TSError("[%s] Failed to initialize the binary capture.", traffic_dump::debug_tag);
+    return;
+  }
+
   if (sensitive_fields_were_specified) {
     if (!traffic_dump::TransactionData::init(std::move(user_specified_fields))) {
       TSError("[%s] Failed to initialize transaction state with user-specified fields.", traffic_dump::debug_tag);
@@ -199,6 +199,68 @@ TransactionData::write_message_node(TSMBuffer &buffer, TSMLoc &hdr_loc, int64_t
   return result + "}";
 }
 
+void
+TransactionData::write_binary_message(BinaryMessageType type, TSMBuffer &buffer, TSMLoc &hdr_loc)
+{
+  int len        = 0;
+  char const *cp = nullptr;
+  TSMLoc url_loc = nullptr;
+
+  txn_record->append_u8(static_cast<uint8_t>(type));
+  if (type == BinaryMessageType::PROXY_REQUEST) {
+    txn_record->append_string(server_protocol_description);
+  }
+
+  int version = TSHttpHdrVersionGet(buffer, hdr_loc);
+  txn_record->append_u8(TS_HTTP_MAJOR(version));
+  txn_record->append_u8(TS_HTTP_MINOR(version));
+
+  if (TSHttpHdrTypeGet(buffer, hdr_loc) == TS_HTTP_TYPE_REQUEST) {
+    TSAssert(TS_SUCCESS == TSHttpHdrUrlGet(buffer, hdr_loc, &url_loc));
+    cp = TSUrlSchemeGet(buffer, url_loc, &len);
+    txn_record->append_string(std::string_view{cp, static_cast<size_t>(len)});
+    cp = TSHttpHdrMethodGet(buffer, hdr_loc, &len);
+    txn_record->append_string(std::string_view{cp, static_cast<size_t>(len)});
+
+    cp = TSUrlHostGet(buffer, url_loc, &len);
+    std::string_view host{cp, static_cast<size_t>(len)};
+    char *url = TSUrlStringGet(buffer, url_loc, &len);
+    std::string_view url_string{url, static_cast<size_t>(len)};
+    if (host.empty()) {
+      // See write_message_node_no_content().
+      url_string = remove_scheme_prefix(url_string);
+    }
+    txn_record->append_string(url_string);
+    TSfree(url);
+    TSHandleMLocRelease(buffer, hdr_loc, url_loc);
+  } else {
+    txn_record->append_u16(TSHttpHdrStatusGet(buffer, hdr_loc));
+    cp = TSHttpHdrReasonGet(buffer, hdr_loc, &len);
+    txn_record->append_string(std::string_view{cp, static_cast<size_t>(len)});
+  }
+
+  // The fields without a name are not dumped, the converter skips them.
+  txn_record->append_u32(TSMimeHdrFieldsCount(buffer, hdr_loc));
+  TSMLoc field_loc = TSMimeHdrFieldGet(buffer, hdr_loc, 0);
+  while (field_loc) {
+    int name_len = 0, value_len = 0;
+    char const *name  = TSMimeHdrFieldNameGet(buffer, hdr_loc, field_loc, &name_len);
+    char const *value = TSMimeHdrFieldValueStringGet(buffer, hdr_loc, field_loc, -1, &value_len);
+    std::string_view name_view{name, static_cast<size_t>(name_len)};
+
+    txn_record->append_string(name_view);
+    if (sensitive_fields.find(std::string(name_view)) != sensitive_fields.end()) {
+      txn_record->append_u32(value_len | sensitive_value_flag);
+    } else {
+      txn_record->append_string(std::string_view{value, static_cast<size_t>(value_len)});
+    }
+
+    TSMLoc next_field_loc = TSMimeHdrFieldNext(buffer, hdr_loc, field_loc);
+    TSHandleMLocRelease(buffer, hdr_loc, field_loc);
+    field_loc = next_field_loc;
+  }
+}
+
 std::string_view
 TransactionData::remove_scheme_prefix(std::string_view url)
 {
@@ -210,6 +272,33 @@ TransactionData::remove_scheme_prefix(std::string_view url)
   return url;
 }
 
+void
+TransactionData::write_binary_transaction(TSHttpTxn txnp)
+{
+  TSMBuffer buffer;
+  TSMLoc hdr_loc;
+
+  if (client_request_size_offset != 0) {
+    txn_record->patch_u64(client_request_size_offset, TSHttpTxnClientReqBodyBytesGet(txnp));
+  }
+  if (TS_SUCCESS == TSHttpTxnServerReqGet(txnp, &buffer, &hdr_loc)) {
+    write_binary_message(BinaryMessageType::PROXY_REQUEST, buffer, hdr_loc);
+    txn_record->append_u64(TSHttpTxnServerReqBodyBytesGet(txnp));
+    TSHandleMLocRelease(buffer, TS_NULL_MLOC, hdr_loc);
+  }
+  if (TS_SUCCESS == TSHttpTxnServerRespGet(txnp, &buffer, &hdr_loc)) {
+    write_binary_message(BinaryMessageType::SERVER_RESPONSE, buffer, hdr_loc);
+    txn_record->append_u64(TSHttpTxnServerRespBodyBytesGet(txnp));
+    TSHandleMLocRelease(buffer, TS_NULL_MLOC, hdr_loc);
+  }
+  if (TS_SUCCESS == TSHttpTxnClientRespGet(txnp, &buffer, &hdr_loc)) {
+    write_binary_message(BinaryMessageType::PROXY_RESPONSE, buffer, hdr_loc);
+    txn_record->append_u64(TSHttpTxnClientRespBodyBytesGet(txnp));
+    TSHandleMLocRelease(buffer, TS_NULL_MLOC, hdr_loc);
+  }
+  BinaryCapture::write(*txn_record);
+}
+
 bool
 TransactionData::init_helper()
 {
@@ -264,11 +353,18 @@ TransactionData::global_transaction_handler(TSCont contp, TSEvent event, void *e
     TSAssert(TS_SUCCESS == TSClientRequestUuidGet(txnp, uuid));
     std::string_view uuid_view{uuid, strnlen(uuid, TS_CRUUID_STRING_LEN)};
 
+    TSHRTime start_time;
+    TSHttpTxnMilestoneGet(txnp, TS_MILESTONE_UA_BEGIN, &start_time);
+    if (BinaryCapture::is_enabled()) {
+      txnData->txn_record.emplace(BinaryRecordType::TRANSACTION, ssnData->get_session_id());
+      txnData->txn_record->append_u64(start_time);
+      txnData->txn_record->append_string(uuid_view);
+      break;
+    }
+
     // Generate per transaction json records
     txnData->txn_json += "{";
     // "connection-time":(number)
-    TSHRTime start_time;
-    TSHttpTxnMilestoneGet(txnp, TS_MILESTONE_UA_BEGIN, &start_time);
     txnData->txn_json += "\"connection-time\":" + std::to_string(start_time);
 
     // "uuid":(string)
@@ -297,6 +393,12 @@ TransactionData::global_transaction_handler(TSCont contp, TSEvent event, void *e
     TSMLoc hdr_loc;
     if (TS_SUCCESS == TSHttpTxnClientReqGet(txnp, &buffer, &hdr_loc)) {
       TSDebug(debug_tag, "Found client request");
+      if (txnData->txn_record) {
+        txnData->write_binary_message(BinaryMessageType::CLIENT_REQUEST, buffer, hdr_loc);
+        txnData->client_request_size_offset = txnData->txn_record->reserve_u64();
+        TSHandleMLocRelease(buffer, TS_NULL_MLOC, hdr_loc);
+        break;
+      }
       // We don't have an accurate view of the body size until TXN_CLOSE so we hold
       // off on writing the content:size node until then.
       txnData->txn_json += R"(,"client-request":{)" + txnData->write_message_node_no_content(buffer, hdr_loc);
@@ -325,6 +427,11 @@ TransactionData::global_transaction_handler(TSCont contp, TSEvent event, void *e
     // proxy-request/response headers
     TSMBuffer buffer;
     TSMLoc hdr_loc;
+    if (txnData->txn_record) {
+      txnData->write_binary_transaction(txnp);
+      delete txnData;
+      break;
+    }
     if (TS_SUCCESS == TSHttpTxnClientReqGet(txnp, &buffer, &hdr_loc)) {
       txnData->txn_json += txnData->write_content_node(TSHttpTxnClientReqBodyBytesGet(txnp)) + "}";
       TSHandleMLocRelease(buffer, TS_NULL_MLOC, hdr_loc);
@@ -18,10 +18,12 @@
 
 #pragma once
 
+#include <optional>
 #include <string>
 
 #include "ts/ts.h"
 
+#include "binary_capture.h"
 #include "sensitive_fields.h"
 
 namespace traffic_dump
@@ -40,6 +42,16 @@ private:
   /** The '"protocol" node for this transaction's server-side conection. */
   std::string server_protocol_description;
 
+  /** The binary capture record of this transaction, used instead of txn_json
+   * when capturing in the binary format.
+   */
+  std::optional<BinaryRecord> txn_record;
+
+  /** The offset in txn_record of the client request body size, which is only
+   * known at TXN_CLOSE.
+   */
+  size_t client_request_size_offset = 0;
+
   // The index to be used for the TS API for storing this TransactionData on a
   // per-transaction basis.
   static int transaction_arg_index;
@@ -68,6 +80,14 @@ public:
   /// the content node describing the body characteristics.
   std::string write_message_node(TSMBuffer &buffer, TSMLoc &hdr_loc, int64_t num_body_bytes);
 
+  /// Read the txn information from TSMBuffer and append the header information
+  /// to txn_record. This function does not append the body size.
+  void write_binary_message(BinaryMessageType type, TSMBuffer &buffer, TSMLoc &hdr_loc);
+
+  /// Append the proxy request, server response and proxy response to
+  /// txn_record and push it to the binary capture.
+  void write_binary_transaction(TSHttpTxn txnp);
+
   /// The handler callback for transaction events.
   static int global_transaction_handler(TSCont contp, TSEvent event, void *edata);
 
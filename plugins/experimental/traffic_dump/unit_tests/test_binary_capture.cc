@@ -0,0 +1,91 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "binary_capture.h"
+
+#include <catch.hpp>
+
+using namespace traffic_dump;
+
+TEST_CASE("BinaryRecord", "[binary_capture]")
+{
+  BinaryRecord record{BinaryRecordType::TRANSACTION, 0x1122334455667788};
+  record.append_u8(7);
+  size_t offset = record.reserve_u64();
+  record.append_string("abc");
+  record.patch_u64(offset, 42);
+
+  std::string_view bytes = record.finish();
+  REQUIRE(bytes.size() == BinaryRecord::header_size + 1 + 8 + 4 + 3);
+
+  uint32_t size;
+  memcpy(&size, bytes.data(), sizeof(size));
+  CHECK(size == bytes.size());
+  CHECK(static_cast<uint8_t>(bytes[4]) == static_cast<uint8_t>(BinaryRecordType::TRANSACTION));
+
+  uint64_t session_id;
+  memcpy(&session_id, bytes.data() + 5, sizeof(session_id));
+  CHECK(session_id == 0x1122334455667788);
+  CHECK(bytes[BinaryRecord::header_size] == 7);
+
+  uint64_t patched;
+  memcpy(&patched, bytes.data() + BinaryRecord::header_size + 1, sizeof(patched));
+  CHECK(patched == 42);
+
+  uint32_t length;
+  memcpy(&length, bytes.data() + BinaryRecord::header_size + 9, sizeof(length));
+  CHECK(length == 3);
+  CHECK(bytes.substr(BinaryRecord::header_size + 13) == "abc");
+}
+
+TEST_CASE("CaptureRing", "[binary_capture]")
+{
+  CaptureRing ring{16};
+  std::string drained;
+  auto consume = [&drained](std::string_view bytes) { drained.append(bytes.data(), bytes.size()); };
+
+  CHECK(ring.drain(consume) == 0);
+
+  SECTION("Records are drained in order")
+  {
+    CHECK(ring.push("0123456789"));
+    CHECK(ring.push("abc"));
+    CHECK(ring.drain(consume) == 13);
+    CHECK(drained == "0123456789abc");
+  }
+
+  SECTION("A record that does not fit is dropped whole")
+  {
+    CHECK(ring.push("0123456789"));
+    CHECK_FALSE(ring.push("abcdefg"));
+    CHECK(ring.push("abcdef"));
+    CHECK_FALSE(ring.push("x"));
+    CHECK(ring.drain(consume) == 16);
+    CHECK(drained == "0123456789abcdef");
+  }
+
+  SECTION("Records wrap around the end of the ring")
+  {
+    CHECK(ring.push("0123456789"));
+    CHECK(ring.drain(consume) == 10);
+    drained.clear();
+    CHECK(ring.push("abcdefghijkl"));
+    CHECK(ring.drain(consume) == 12);
+    CHECK(drained == "abcdefghijkl");
+  }
+}
@@ -45,8 +45,12 @@ struct config {
   struct auth_directive *auth_directives;
   char *id;
   bool strip_token;
+  bool token_cache;
+  unsigned generation; /* tells the configs apart when one is freed and another allocated at the same address */
 };
 
+static unsigned config_generations = 0;
+
 cjose_jwk_t **
 find_keys(struct config *cfg, const char *issuer)
 {
@@ -92,6 +96,18 @@ config_strip_token(struct config *cfg)
   return cfg->strip_token;
 }
 
+bool
+config_token_cache(struct config *cfg)
+{
+  return cfg->token_cache;
+}
+
+unsigned
+config_generation(struct config *cfg)
+{
+  return cfg->generation;
+}
+
 struct config *
 config_new(size_t n)
 {
@@ -120,6 +136,8 @@ config_new(size_t n)
   cfg->id              = NULL;
 
   cfg->strip_token = false;
+  cfg->token_cache = false;
+  cfg->generation  = __sync_add_and_fetch(&config_generations, 1);
 
   PluginDebug("New config object created at %p", cfg);
   return cfg;
@@ -295,6 +313,11 @@ read_config(const char *path)
       cfg->strip_token = json_boolean_value(strip_json);
     }
 
+    json_t *token_cache_json = json_object_get(jwks, "token_cache");
+    if (token_cache_json) {
+      cfg->token_cache = json_boolean_value(token_cache_json);
+    }
+
     size_t jwks_ct     = json_array_size(key_ary);
     cjose_jwk_t **jwks = (*jwkis++ = malloc((jwks_ct + 1) * sizeof *jwks));
     PluginDebug("Created table with size %d", cfg->issuers->size);
@@ -37,3 +37,5 @@ struct _cjose_jwk_int *find_key_by_kid(struct config *cfg, const char *issuer, c
 bool uri_matches_auth_directive(struct config *cfg, const char *uri, size_t uri_ct);
 const char *config_get_id(struct config *cfg);
 bool config_strip_token(struct config *cfg);
+bool config_token_cache(struct config *cfg);
+unsigned config_generation(struct config *cfg);
@@ -77,7 +77,7 @@ jwt_delete(struct jwt *jwt)
     return;
   }
 
-  json_decref(jwt->aud);
+  /* aud is borrowed from raw */
   json_decref(jwt->raw);
   free(jwt);
 }
@@ -263,7 +263,8 @@ void
 renew_copy_raw(json_t *new_json, const char *name, json_t *old_json)
 {
   if (old_json) {
-    json_object_set_new(new_json, name, old_json);
+    /* Takes a reference of its own, old_json still belongs to the renewed jwt */
+    json_object_set(new_json, name, old_json);
   }
 }
 
@@ -22,13 +22,39 @@
 #include "jwt.h"
 #include "cookie.h"
 #include "timing.h"
+#include "token_cache.h"
 #include <cjose/cjose.h>
 #include <jansson.h>
 #include <string.h>
 #include <inttypes.h>
 
+static cjose_jws_t *
+import_jws(const char *token, size_t token_ct)
+{
+  cjose_err err    = {0};
+  cjose_jws_t *jws = cjose_jws_import(token, token_ct, &err);
+  if (!jws) {
+    PluginDebug("Unable to read JWS: %.*s, %s", (int)token_ct, token, err.message ? err.message : "");
+  } else {
+    PluginDebug("Parsed JWS: %.*s (%16p)", (int)token_ct, token, jws);
+  }
+  return jws;
+}
+
 cjose_jws_t *
 get_jws_from_uri(const char *uri, size_t uri_ct, const char *paramName, char *strip_uri, size_t buff_ct, size_t *strip_ct)
+{
+  size_t token_ct;
+  const char *token = get_token_from_uri(uri, uri_ct, paramName, strip_uri, buff_ct, strip_ct, &token_ct);
+  if (!token) {
+    return NULL;
+  }
+  return import_jws(token, token_ct);
+}
+
+const char *
+get_token_from_uri(const char *uri, size_t uri_ct, const char *paramName, char *strip_uri, size_t buff_ct, size_t *strip_ct,
+                   size_t *token_ct)
 {
   /* Reserved characters as defined by the URI Generic Syntax RFC: https://tools.ietf.org/html/rfc3986#section-2.2 */
   static char const *const reserved_string  = ":/?#[]@!$&\'()*+,;=";
@@ -81,72 +107,120 @@ get_jws_from_uri(const char *uri, size_t uri_ct, const char *paramName, char *st
     }
     key_end = value;
 
-    /* If the Parameter key is our target parameter name, attempt to import a JWS from the value. */
+    /* If the Parameter key is our target parameter name, the value is the token. */
     if ((size_t)(key_end - key) == termination_ct && !strncmp(paramName, key, (size_t)(key_end - key))) {
       value_end = ++value;
       while (value_end != end && strchr(reserved_string, *value_end) == NULL) {
         ++value_end;
       }
-      PluginDebug("Decoding JWS: %.*s", (int)(key_end - key), key);
-      cjose_err err    = {0};
-      cjose_jws_t *jws = cjose_jws_import(value, (size_t)(value_end - value), &err);
-      if (!jws) {
-        PluginDebug("Unable to read JWS: %.*s, %s", (int)(key_end - key), key, err.message ? err.message : "");
+      PluginDebug("Found token: %.*s", (int)(key_end - key), key);
+
+      /* Strip token */
+      /* Check that passed buffer is large enough */
+      *strip_ct = ((key - uri) + (end - value_end));
+      if (buff_ct <= *strip_ct) {
+        PluginDebug("Strip URI buffer is not large enough");
+        return NULL;
+      }
+
+      if (value_end != end && strchr(sub_delim_string, *value_end)) {
+        /*Strip from first char of package name to sub-delimeter that terminates the signed JWT */
+        memcpy(strip_uri, uri, (key - uri));
+        memcpy(strip_uri + (key - uri), value_end + 1, (end - value_end + 1));
       } else {
-        PluginDebug("Parsed JWS: %.*s (%16p)", (int)(key_end - key), key, jws);
-
-        /* Strip token */
-        /* Check that passed buffer is large enough */
-        *strip_ct = ((key - uri) + (end - value_end));
-        if (buff_ct <= *strip_ct) {
-          PluginDebug("Strip URI buffer is not large enough");
-          return NULL;
-        }
-
-        if (value_end != end && strchr(sub_delim_string, *value_end)) {
-          /*Strip from first char of package name to sub-delimeter that terminates the signed JWT */
-          memcpy(strip_uri, uri, (key - uri));
-          memcpy(strip_uri + (key - uri), value_end + 1, (end - value_end + 1));
-        } else {
-          /*Strip from reserved char to the last char of the JWT */
-          memcpy(strip_uri, uri, (key - uri - 1));
-          memcpy(strip_uri + (key - uri - 1), value_end, (end - value_end));
-        }
-
-        if (strip_uri[*strip_ct - 1] != '\0') {
-          strip_uri[*strip_ct - 1] = '\0';
-        }
-        PluginDebug("Stripped URI: %s", strip_uri);
+        /*Strip from reserved char to the last char of the JWT */
+        memcpy(strip_uri, uri, (key - uri - 1));
+        memcpy(strip_uri + (key - uri - 1), value_end, (end - value_end));
       }
-      return jws;
+
+      if (strip_uri[*strip_ct - 1] != '\0') {
+        strip_uri[*strip_ct - 1] = '\0';
+      }
+      PluginDebug("Stripped URI: %s", strip_uri);
+
+      *token_ct = (size_t)(value_end - value);
+      return value;
     }
   }
   PluginDebug("Unable to locate signing key in uri: %.*s", (int)uri_ct, uri);
   return NULL;
 }
 
+const char *
+get_token_from_cookie(const char **cookie, size_t *cookie_ct, const char *paramName, size_t *token_ct)
+{
+  PluginDebug("Parsing JWS from cookie: %.*s", (int)*cookie_ct, *cookie);
+  const char *value = get_cookie_value(cookie, cookie_ct, paramName, token_ct);
+  PluginDebug("Got jws string: (%p) %.*s", value, value ? (int)*token_ct : 0, value);
+  if (!value || !*token_ct) {
+    return NULL;
+  }
+  return value;
+}
+
 cjose_jws_t *
 get_jws_from_cookie(const char **cookie, size_t *cookie_ct, const char *paramName)
 {
-  PluginDebug("Parsing JWS from cookie: %.*s", (int)*cookie_ct, *cookie);
-  size_t value_ct;
-  const char *value = get_cookie_value(cookie, cookie_ct, paramName, &value_ct);
-  PluginDebug("Got jws string: (%p) %.*s", value, (int)value_ct, value);
-  if (!value || !value_ct) {
+  size_t token_ct;
+  const char *token = get_token_from_cookie(cookie, cookie_ct, paramName, &token_ct);
+  if (!token) {
     return NULL;
   }
-  cjose_err err    = {0};
-  cjose_jws_t *jws = cjose_jws_import(value, value_ct, &err);
-  if (!jws) {
-    PluginDebug("Unable to read JWS: %.*s, %s", (int)value_ct, value, err.message ? err.message : "");
+  return import_jws(token, token_ct);
+}
+
+struct jwt *
+validate_jws(cjose_jws_t *jws, struct config *cfg, const char *uri, size_t uri_ct)
+{
+  struct jwt *jwt = verify_jws(jws, cfg);
+  if (!jwt) {
+    return NULL;
+  }
+
+  if (!jwt_check_uri(jwt->cdniuc, uri)) {
+    PluginDebug("Valid key for %16p that does not match uri.", jws);
+    jwt_delete(jwt);
+    return NULL;
+  }
+  return jwt;
+}
+
+struct jwt *
+validate_token(const char *token, size_t token_ct, struct config *cfg, const char *uri, size_t uri_ct, bool *cached)
+{
+  /* A token verified before is only checked again for the claims that change with the time and the uri. */
+  struct jwt *jwt = token_cache_get(cfg, token, token_ct);
+  *cached         = (jwt != NULL);
+  if (jwt) {
+    if (!jwt_validate(jwt)) {
+      PluginDebug("Validation of cached JWT failed");
+      return NULL;
+    }
   } else {
-    PluginDebug("Parsed JWS: %.*s (%16p)", (int)value_ct, value, jws);
+    cjose_jws_t *jws = import_jws(token, token_ct);
+    if (!jws) {
+      return NULL;
+    }
+    jwt = verify_jws(jws, cfg);
+    cjose_jws_release(jws);
+    if (!jwt) {
+      return NULL;
+    }
+    *cached = token_cache_put(cfg, token, token_ct, jwt);
   }
-  return jws;
+
+  if (!jwt_check_uri(jwt->cdniuc, uri)) {
+    PluginDebug("Valid token that does not match uri.");
+    if (!*cached) {
+      jwt_delete(jwt);
+    }
+    return NULL;
+  }
+  return jwt;
 }
 
 struct jwt *
-validate_jws(cjose_jws_t *jws, struct config *cfg, const char *uri, size_t uri_ct)
+verify_jws(cjose_jws_t *jws, struct config *cfg)
 {
   struct timer t;
   int64_t last_mark = 0;
@@ -232,12 +306,7 @@ validate_jws(cjose_jws_t *jws, struct config *cfg, const char *uri, size_t uri_c
     PluginDebug("Valid key for %16p that does not match aud.", jws);
     goto jwt_fail;
   }
-
-  if (!jwt_check_uri(jwt->cdniuc, uri)) {
-    PluginDebug("Valid key for %16p that does not match uri.", jws);
-    goto jwt_fail;
-  }
-  TimerDebug("verifying sub claim");
+  TimerDebug("verifying aud claim");
 
   return jwt;
 jwt_fail:
@@ -18,6 +18,7 @@
 
 #pragma once
 
+#include <stdbool.h>
 #include <stdlib.h>
 
 struct _cjose_jws_int;
@@ -27,6 +28,18 @@ struct _cjose_jws_int *get_jws_from_uri(const char *uri, size_t uri_ct, const ch
                                         size_t *strip_ct);
 struct _cjose_jws_int *get_jws_from_cookie(const char **cookie, size_t *cookie_ct, const char *paramName);
 
+/* Same as the above, but only find the token, it is not decoded */
+const char *get_token_from_uri(const char *uri, size_t uri_ct, const char *paramName, char *strip_uri, size_t buff_ct,
+                               size_t *strip_ct, size_t *token_ct);
+const char *get_token_from_cookie(const char **cookie, size_t *cookie_ct, const char *paramName, size_t *token_ct);
+
 struct config;
 struct jwt;
 struct jwt *validate_jws(struct _cjose_jws_int *jws, struct config *cfg, const char *uri, size_t uri_ct);
+
+/* Verifies the signature and the claims that do not depend on the uri */
+struct jwt *verify_jws(struct _cjose_jws_int *jws, struct config *cfg);
+
+/* Validates the token for the uri, skipping the decoding and the signature verification of the tokens verified before.
+ * If cached is set the JWT belongs to the token cache and must not be deleted. */
+struct jwt *validate_token(const char *token, size_t token_ct, struct config *cfg, const char *uri, size_t uri_ct, bool *cached);
@@ -0,0 +1,116 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "common.h"
+#include "config.h"
+#include "jwt.h"
+#include "token_cache.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define TOKEN_CACHE_SIZE 256      /* entries per thread */
+#define TOKEN_CACHE_TOKEN_MAX 4096 /* longer tokens are not cached */
+
+struct token_cache_entry {
+  const struct config *cfg;
+  unsigned generation;
+  uint64_t hash;
+  char *token;
+  size_t token_ct;
+  struct jwt *jwt;
+};
+
+/* Every thread has its own cache, the entries and their JWTs are never shared with another thread. */
+static __thread struct token_cache_entry token_cache[TOKEN_CACHE_SIZE];
+
+static uint64_t
+token_hash(const char *token, size_t token_ct)
+{
+  /* FNV-1a, only picks the entry, the token itself is compared */
+  uint64_t hash = 14695981039346656037ULL;
+  for (size_t i = 0; i < token_ct; ++i) {
+    hash ^= (unsigned char)token[i];
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+static void
+token_cache_evict(struct token_cache_entry *entry)
+{
+  free(entry->token);
+  jwt_delete(entry->jwt);
+  memset(entry, 0, sizeof *entry);
+}
+
+struct jwt *
+token_cache_get(struct config *cfg, const char *token, size_t token_ct)
+{
+  if (!config_token_cache(cfg) || !token_ct || token_ct > TOKEN_CACHE_TOKEN_MAX) {
+    return NULL;
+  }
+
+  uint64_t hash                   = token_hash(token, token_ct);
+  struct token_cache_entry *entry = &token_cache[hash % TOKEN_CACHE_SIZE];
+  if (!entry->jwt || entry->hash != hash || entry->cfg != cfg || entry->generation != config_generation(cfg) ||
+      entry->token_ct != token_ct || memcmp(entry->token, token, token_ct)) {
+    return NULL;
+  }
+
+  /* The expired tokens are dropped, the other claims are checked again by the caller. */
+  if ((double)time(NULL) > entry->jwt->exp) {
+    PluginDebug("Evicting expired token from the cache");
+    token_cache_evict(entry);
+    return NULL;
+  }
+
+  PluginDebug("Found verified token in the cache");
+  return entry->jwt;
+}
+
+bool
+token_cache_put(struct config *cfg, const char *token, size_t token_ct, struct jwt *jwt)
+{
+  if (!config_token_cache(cfg) || !token_ct || token_ct > TOKEN_CACHE_TOKEN_MAX) {
+    return false;
+  }
+
+  char *copy = malloc(token_ct);
+  if (!copy) {
+    return false;
+  }
+  memcpy(copy, token, token_ct);
+
+  uint64_t hash                   = token_hash(token, token_ct);
+  struct token_cache_entry *entry = &token_cache[hash % TOKEN_CACHE_SIZE];
+  if (entry->jwt) {
+    token_cache_evict(entry);
+  }
+
+  entry->cfg        = cfg;
+  entry->generation = config_generation(cfg);
+  entry->hash       = hash;
+  entry->token      = copy;
+  entry->token_ct   = token_ct;
+  entry->jwt        = jwt;
+  PluginDebug("Cached verified token");
+  return true;
+}
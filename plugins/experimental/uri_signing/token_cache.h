@@ -0,0 +1,34 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/* A bounded per thread cache of the tokens whose signature was verified. The tokens are compared byte for byte, a hit
+ * returns the JWT parsed when the token was verified. The cache owns the JWTs, the callers must not delete them. */
+
+struct config;
+struct jwt;
+
+/* Returns the JWT of the token verified with cfg, NULL if the token is not cached or has expired. */
+struct jwt *token_cache_get(struct config *cfg, const char *token, size_t token_ct);
+
+/* Caches the JWT of the token verified with cfg. Returns false if the cache did not take the JWT, the caller still owns it. */
+bool token_cache_put(struct config *cfg, const char *token, size_t token_ct, struct jwt *jwt);
@@ -31,6 +31,7 @@ extern "C" {
 #include "../parse.h"
 #include "../match.h"
 #include "../config.h"
+#include "../token_cache.h"
 }
 
 bool
@@ -661,3 +662,58 @@ TEST_CASE("8", "[TestsWithConfig]")
   config_delete(cfg);
   fprintf(stderr, "\n");
 }
+
+TEST_CASE("9", "[TokenCacheTests]")
+{
+  INFO("TEST 9, Tests Involving the Cache of Verified Tokens");
+  struct config *cfg = read_config("experimental/uri_signing/unit_tests/testConfig.config");
+  REQUIRE(cfg != NULL);
+  REQUIRE(config_token_cache(cfg));
+
+  const char *token = "eyJLZXlJREtleSI6IjUiLCJhbGciOiJIUzI1NiJ9."
+                      "eyJjZG5pZXRzIjozMCwiY2RuaXN0dCI6MSwiaXNzIjoiTWFzdGVyIElzc3VlciIsImF1ZCI6InRlc3RlciIsImNkbml1YyI6"
+                      "InJlZ2V4Omh0dHA6Ly93d3cuZm9vYmFyLmNvbS8qIn0.InBxVm6OOAglNqc-U5wAZaRQVebJ9PK7Y9i7VFHWYHU";
+  const char *uri   = "http://www.foobar.com/segment1.ts";
+  bool cached       = false;
+
+  SECTION("Verified token is cached and checked against each uri")
+  {
+    struct jwt *jwt = validate_token(token, strlen(token), cfg, uri, strlen(uri), &cached);
+    REQUIRE(jwt != NULL);
+    REQUIRE(cached);
+    REQUIRE(token_cache_get(cfg, token, strlen(token)) == jwt);
+
+    const char *next = "http://www.foobar.com/segment2.ts";
+    REQUIRE(validate_token(token, strlen(token), cfg, next, strlen(next), &cached) == jwt);
+    REQUIRE(cached);
+
+    const char *other = "http://www.other.com/segment2.ts";
+    REQUIRE(validate_token(token, strlen(token), cfg, other, strlen(other), &cached) == NULL);
+    REQUIRE(token_cache_get(cfg, token, strlen(token)) == jwt);
+  }
+
+  SECTION("Tampered token is not taken from the cache")
+  {
+    REQUIRE(validate_token(token, strlen(token), cfg, uri, strlen(uri), &cached) != NULL);
+
+    char tampered[strlen(token) + 1];
+    strcpy(tampered, token);
+    size_t pos    = strlen(token) - 10; /* in the signature */
+    tampered[pos] = tampered[pos] == 'A' ? 'B' : 'A';
+    REQUIRE(token_cache_get(cfg, tampered, strlen(tampered)) == NULL);
+    REQUIRE(validate_token(tampered, strlen(tampered), cfg, uri, strlen(uri), &cached) == NULL);
+  }
+
+  SECTION("Token verified with another config is not taken from the cache")
+  {
+    REQUIRE(validate_token(token, strlen(token), cfg, uri, strlen(uri), &cached) != NULL);
+
+    struct config *other = read_config("experimental/uri_signing/unit_tests/testConfig.config");
+    REQUIRE(other != NULL);
+    REQUIRE(token_cache_get(other, token, strlen(token)) == NULL);
+    config_delete(other);
+  }
+
+  config_delete(cfg);
+  fprintf(stderr, "\n");
+}
@@ -195,12 +195,13 @@ TSRemapDoRemap(void *ih, TSHttpTxn txnp, TSRemapRequestInfo *rri)
   memset(strip_uri, 0, strip_size);
 
   size_t strip_ct;
-  cjose_jws_t *jws = get_jws_from_uri(url, url_ct, package, strip_uri, strip_size, &strip_ct);
+  size_t token_ct   = 0;
+  const char *token = get_token_from_uri(url, url_ct, package, strip_uri, strip_size, &strip_ct, &token_ct);
 
   checkpoints[cpi++] = mark_timer(&t);
 
   int checked_cookies = 0;
-  if (!jws) {
+  if (!token) {
   check_cookies:
     /* There is no valid token in the url */
     strncpy(strip_uri, url, url_ct);
@@ -244,7 +245,7 @@ TSRemapDoRemap(void *ih, TSHttpTxn txnp, TSRemapRequestInfo *rri)
     if (cpi < max_cpi) {
       checkpoints[cpi++] = mark_timer(&t);
     }
-    jws = get_jws_from_cookie(&client_cookie, &client_cookie_sz_ct, package);
+    token = get_token_from_cookie(&client_cookie, &client_cookie_sz_ct, package, &token_ct);
   } else {
     /* There has been a JWS found in the url */
     /* Strip the token from the URL for upstream if configured to do so */
@@ -262,8 +263,8 @@ TSRemapDoRemap(void *ih, TSHttpTxn txnp, TSRemapRequestInfo *rri)
         memset(map_strip_uri, 0, map_strip_size);
         size_t map_strip_ct = 0;
 
-        cjose_jws_t *map_jws = get_jws_from_uri(map_url, map_url_ct, package, map_strip_uri, map_strip_size, &map_strip_ct);
-        cjose_jws_release(map_jws);
+        size_t map_token_ct = 0;
+        get_token_from_uri(map_url, map_url_ct, package, map_strip_uri, map_strip_size, &map_strip_ct, &map_token_ct);
 
         char const *strip_uri_start = map_strip_uri;
 
@@ -303,7 +304,7 @@ check_auth:
   }
   checked_auth = true;
 
-  if (!jws) {
+  if (!token) {
     goto fail;
   }
 
@@ -311,8 +312,8 @@ check_auth:
     checkpoints[cpi++] = mark_timer(&t);
   }
 
-  struct jwt *jwt = validate_jws(jws, (struct config *)ih, strip_uri, strip_ct);
-  cjose_jws_release(jws);
+  bool cached_jwt = false;
+  struct jwt *jwt = validate_token(token, token_ct, (struct config *)ih, strip_uri, strip_ct, &cached_jwt);
 
   if (cpi < max_cpi) {
     checkpoints[cpi++] = mark_timer(&t);
@@ -329,7 +330,9 @@ check_auth:
 
   struct signer *signer = config_signer((struct config *)ih);
   char *cookie          = renew(jwt, signer->issuer, signer->jwk, signer->alg, package);
-  jwt_delete(jwt);
+  if (!cached_jwt) {
+    jwt_delete(jwt);
+  }
 
   if (cpi < max_cpi) {
     checkpoints[cpi++] = mark_timer(&t);
@@ -60,8 +60,75 @@ struct config {
   pcre_extra *regex_extra;
   int pristine_url_flag;
   char *sig_anchor;
+  int sig_cache;
+  unsigned generation; /* tells the configs apart when one is freed and another allocated at the same address */
 };
 
+static unsigned config_generations = 0;
+
+/* Per thread cache of the verified signatures, a hit skips the HMAC. The signed string and the signature are compared
+ * byte for byte, the hash only picks the entry. */
+#define SIG_CACHE_SIZE 256
+#define SIG_CACHE_SIGNED_MAX 2048 /* longer signed strings are not cached */
+
+struct sig_cache_entry {
+  const struct config *cfg;
+  unsigned generation;
+  uint64_t hash;
+  time_t expiration;
+  size_t signed_len;
+  char *signed_part; /* the signed string followed by its signature */
+};
+
+static __thread struct sig_cache_entry sig_cache[SIG_CACHE_SIZE];
+
+static uint64_t
+sig_cache_hash(const char *signed_part, size_t signed_len)
+{
+  /* FNV-1a */
+  uint64_t hash = 14695981039346656037ULL;
+  for (size_t i = 0; i < signed_len; ++i) {
+    hash ^= (unsigned char)signed_part[i];
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+static bool
+sig_cache_lookup(const struct config *cfg, const char *signed_part, size_t signed_len)
+{
+  if (!cfg->sig_cache || signed_len > SIG_CACHE_SIGNED_MAX) {
+    return false;
+  }
+
+  uint64_t hash                 = sig_cache_hash(signed_part, signed_len);
+  struct sig_cache_entry *entry = &sig_cache[hash % SIG_CACHE_SIZE];
+  return entry->signed_part != NULL && entry->hash == hash && entry->cfg == cfg && entry->generation == cfg->generation &&
+         entry->expiration >= time(NULL) && entry->signed_len == signed_len &&
+         memcmp(entry->signed_part, signed_part, signed_len) == 0;
+}
+
+static void
+sig_cache_insert(const struct config *cfg, const char *signed_part, size_t signed_len, time_t expiration)
+{
+  if (!cfg->sig_cache || signed_len > SIG_CACHE_SIGNED_MAX) {
+    return;
+  }
+
+  uint64_t hash                 = sig_cache_hash(signed_part, signed_len);
+  struct sig_cache_entry *entry = &sig_cache[hash % SIG_CACHE_SIZE];
+  if (entry->signed_len < signed_len) {
+    TSfree(entry->signed_part);
+    entry->signed_part = TSmalloc(signed_len);
+  }
+  memcpy(entry->signed_part, signed_part, signed_len);
+  entry->signed_len = signed_len;
+  entry->cfg        = cfg;
+  entry->generation = cfg->generation;
+  entry->hash       = hash;
+  entry->expiration = expiration;
+}
+
 static void
 free_cfg(struct config *cfg)
 {
@@ -137,6 +204,7 @@ TSRemapNewInstance(int argc, char *argv[], void **ih, char *errbuf, int errbuf_s
 
   cfg = TSmalloc(sizeof(struct config));
   memset(cfg, 0, sizeof(struct config));
+  cfg->generation = __sync_add_and_fetch(&config_generations, 1);
 
   while (fgets(line, sizeof(line), file) != NULL) {
     TSDebug(PLUGIN_NAME, "LINE: %s (%d)", line, (int)strlen(line));
@@ -197,6 +265,8 @@ TSRemapNewInstance(int argc, char *argv[], void **ih, char *errbuf, int errbuf_s
       }
     } else if (strncmp(line, "sig_anchor", 10) == 0) {
       cfg->sig_anchor = TSstrndup(value, strlen(value));
+    } else if (strncmp(line, "sig_cache", 9) == 0) {
+      cfg->sig_cache = (strcasecmp(value, "true") == 0 || atoi(value) > 0);
     } else if (strncmp(line, "excl_regex", 10) == 0) {
       // compile and study regex
       const char *errptr;
@@ -771,6 +841,19 @@ TSRemapDoRemap(void *ih, TSHttpTxn txnp, TSRemapRequestInfo *rri)
 
   TSDebug(PLUGIN_NAME, "Signed string=\"%s\"", signed_part);
 
+  /* a signature verified before is taken from the cache, along with the signed string */
+  size_t signed_len = strlen(signed_part);
+  size_t sig_hex_len =
+    (algorithm == USIG_HMAC_SHA1 ? 2 * SHA1_SIG_SIZE : (algorithm == USIG_HMAC_MD5 ? 2 * MD5_SIG_SIZE : 0));
+  if (sig_hex_len && strlen(signature) >= sig_hex_len && signed_len + sig_hex_len < sizeof(signed_part)) {
+    memcpy(signed_part + signed_len, signature, sig_hex_len);
+    if (sig_cache_lookup(cfg, signed_part, signed_len + sig_hex_len)) {
+      TSDebug(PLUGIN_NAME, "Signature check passed (cached)");
+      goto allow;
+    }
+    signed_part[signed_len] = '\0';
+  }
+
   /* calculate the expected the signature with the right algorithm */
   switch (algorithm) {
   case USIG_HMAC_SHA1:
@@ -810,6 +893,10 @@ TSRemapDoRemap(void *ih, TSHttpTxn txnp, TSRemapRequestInfo *rri)
     goto deny;
   } else {
     TSDebug(PLUGIN_NAME, "Signature check passed");
+    if (signed_len + sig_len * 2 < sizeof(signed_part)) {
+      memcpy(signed_part + signed_len, signature, sig_len * 2);
+      sig_cache_insert(cfg, signed_part, signed_len + sig_len * 2, (time_t)expiration);
+    }
     goto allow;
   }
 
@@ -16,6 +16,11 @@
   limitations under the License.
  */
 
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
 #include <sstream>
 #include <iostream>
 #include <string_view>
@@ -24,6 +29,8 @@
 #include "tscpp/api/TransformationPlugin.h"
 #include "tscpp/api/Logger.h"
 
+#include <ts/ts.h>
+
 #include <Magick++.h>
 
 using std::string;
@@ -32,10 +39,51 @@ using namespace atscppapi;
 
 #define TAG "webp_transform"
 
+class ImageTransform;
+
 namespace
 {
 GlobalPlugin *plugin;
+
+/// Set on the client requests that take webp, the cached variants vary on it.
+const string FORMAT_HEADER = "@Image-Format";
+
+/// The request headers the format is negotiated from, in the Vary sent to the clients.
+const string FORMAT_VARY = "Accept, User-Agent";
+
+/// Images that are being converted or waiting to be, beyond it the images go through unconverted.
+int max_conversions = 16;
+std::atomic<int> conversions{0};
+
+/// The work handed to a task thread, shared by the transform and the task as either can end first.
+struct Conversion {
+  string input;
+  string output;
+  TSEventThread thread;                ///< Of the transform, the output is produced there.
+  TSCont done;                         ///< Produces the output, with the transaction mutex.
+  ImageTransform *transform = nullptr; ///< nullptr once the transaction is gone, under the transaction mutex.
+};
+
+using ConversionPtr = std::shared_ptr<Conversion>;
+
+void
+convert(Conversion &conversion)
+{
+  try {
+    Blob input_blob(conversion.input.data(), conversion.input.length());
+    Image image;
+    image.read(input_blob);
+
+    Blob output_blob;
+    image.magick("WEBP");
+    image.write(&output_blob);
+    conversion.output.assign(static_cast<const char *>(output_blob.data()), output_blob.length());
+  } catch (const Magick::Exception &e) {
+    TSError("[%s] Unable to convert the image, sending it as is: %s", TAG, e.what());
+    conversion.output = std::move(conversion.input);
+  }
 }
+} // namespace
 
 class ImageTransform : public TransformationPlugin
 {
@@ -43,13 +91,17 @@ public:
   ImageTransform(Transaction &transaction) : TransformationPlugin(transaction, TransformationPlugin::RESPONSE_TRANSFORMATION)
   {
     TransformationPlugin::registerHook(HOOK_READ_RESPONSE_HEADERS);
+    // Only the webp variant goes to the cache, the original is cached by the requests that do not take webp.
+    _txn = static_cast<TSHttpTxn>(transaction.getAtsHandle());
+    TSHttpTxnTransformedRespCache(_txn, 1);
+    TSHttpTxnUntransformedRespCache(_txn, 0);
+    ++conversions;
   }
 
   void
   handleReadResponseHeaders(Transaction &transaction) override
   {
     transaction.getServerResponse().getHeaders()["Content-Type"] = "image/webp";
-    transaction.getServerResponse().getHeaders()["Vary"]         = "Content-Type"; // to have a separate cache entry.
 
     TS_DEBUG(TAG, "url %s", transaction.getServerRequest().getUrl().getUrlString().c_str());
     transaction.resume();
@@ -64,54 +116,151 @@ public:
   void
   handleInputComplete() override
   {
-    string input_data = _img.str();
-    Blob input_blob(input_data.data(), input_data.length());
-    Image image;
-    image.read(input_blob);
+    // The conversion takes too long for an event thread, it runs on a task thread and the output is
+    // produced back on this one.
+    _conversion            = std::make_shared<Conversion>();
+    _conversion->input     = _img.str();
+    _conversion->thread    = TSEventThreadSelf();
+    _conversion->transform = this;
+    _img.str(string());
 
-    Blob output_blob;
-    image.magick("WEBP");
-    image.write(&output_blob);
-    produce(std::string_view(reinterpret_cast<const char *>(output_blob.data()), output_blob.length()));
+    // The transaction mutex keeps the transform from going away while it produces.
+    _conversion->done = TSContCreate(handleConverted, TSContMutexGet(reinterpret_cast<TSCont>(_txn)));
+    TSContDataSet(_conversion->done, new ConversionPtr(_conversion));
 
-    setOutputComplete();
+    TSCont task = TSContCreate(handleConvert, nullptr);
+    TSContDataSet(task, new ConversionPtr(_conversion));
+    TSContScheduleOnPool(task, 0, TS_THREAD_POOL_TASK);
   }
 
-  ~ImageTransform() override = default;
+  ~ImageTransform() override
+  {
+    if (_conversion) {
+      _conversion->transform = nullptr;
+    } else {
+      --conversions;
+    }
+  }
 
 private:
+  static int
+  handleConvert(TSCont cont, TSEvent, void *)
+  {
+    auto conversion = static_cast<ConversionPtr *>(TSContDataGet(cont));
+    Conversion &c   = **conversion;
+    TSContDestroy(cont);
+
+    convert(c);
+    --conversions;
+
+    TSContScheduleOnThread(c.done, 0, c.thread);
+    delete conversion;
+    return 0;
+  }
+
+  static int
+  handleConverted(TSCont cont, TSEvent, void *)
+  {
+    auto conversion = static_cast<ConversionPtr *>(TSContDataGet(cont));
+    Conversion &c   = **conversion;
+
+    if (c.transform != nullptr) {
+      c.transform->produce(c.output);
+      c.transform->setOutputComplete();
+    } else {
+      TS_DEBUG(TAG, "Transaction closed before the conversion was done");
+    }
+    delete conversion;
+    TSContDestroy(cont);
+    return 0;
+  }
+
   std::stringstream _img;
+  TSHttpTxn _txn;
+  ConversionPtr _conversion;
 };
 
 class GlobalHookPlugin : public GlobalPlugin
 {
 public:
-  GlobalHookPlugin() { registerHook(HOOK_READ_RESPONSE_HEADERS); }
+  GlobalHookPlugin()
+  {
+    registerHook(HOOK_READ_REQUEST_HEADERS);
+    registerHook(HOOK_READ_RESPONSE_HEADERS);
+    registerHook(HOOK_SEND_RESPONSE_HEADERS);
+  }
+
+  void
+  handleReadRequestHeaders(Transaction &transaction) override
+  {
+    // Before the cache lookup, so that the webp and the original variants of an image are told apart.
+    Headers &headers  = transaction.getClientRequest().getHeaders();
+    string user_agent = headers.values("User-Agent");
+    string accept     = headers.values("Accept");
+
+    headers.erase(FORMAT_HEADER);
+    if (accept.find("image/webp") != string::npos || user_agent.find("Chrome") != string::npos) {
+      headers.set(FORMAT_HEADER, "webp");
+    }
+    transaction.resume();
+  }
+
   void
   handleReadResponseHeaders(Transaction &transaction) override
   {
-    string ctype      = transaction.getServerResponse().getHeaders().values("Content-Type");
-    string user_agent = transaction.getServerRequest().getHeaders().values("User-Agent");
-    string accept     = transaction.getServerRequest().getHeaders().values("Accept");
+    Headers &headers = transaction.getServerResponse().getHeaders();
+    string ctype     = headers.values("Content-Type");
 
-    bool webp_supported = accept.find("image/webp") != string::npos || user_agent.find("Chrome") != string::npos;
+    bool webp_supported = transaction.getClientRequest().getHeaders().count(FORMAT_HEADER) > 0;
     bool image_format   = ctype.find("jpeg") != string::npos || ctype.find("png") != string::npos;
 
-    if (webp_supported && image_format) {
-      TS_DEBUG(TAG, "Content type is either jpeg or png. Converting to webp");
-      transaction.addPlugin(new ImageTransform(transaction));
+    if (image_format) {
+      // Both variants vary on the format, or the first one cached would be served to everyone.
+      headers.append("Vary", FORMAT_HEADER);
+      if (webp_supported && conversions < max_conversions) {
+        TS_DEBUG(TAG, "Content type is either jpeg or png. Converting to webp");
+        transaction.addPlugin(new ImageTransform(transaction));
+      } else if (webp_supported) {
+        // Too many conversions already, do not cache the original where the webp variant goes.
+        TS_DEBUG(TAG, "%d conversions in progress, sending the image as is", conversions.load());
+        TSHttpTxnServerRespNoStoreSet(static_cast<TSHttpTxn>(transaction.getAtsHandle()), 1);
+      }
     }
 
     transaction.resume();
   }
+
+  void
+  handleSendResponseHeaders(Transaction &transaction) override
+  {
+    // The clients and the caches downstream know nothing of the internal header.
+    Headers &headers = transaction.getClientResponse().getHeaders();
+    string vary      = headers.values("Vary", ", ");
+    auto pos         = vary.find(FORMAT_HEADER);
+
+    if (pos != string::npos) {
+      vary.replace(pos, FORMAT_HEADER.length(), FORMAT_VARY);
+      headers.set("Vary", vary);
+    }
+    transaction.resume();
+  }
 };
 
 void
-TSPluginInit(int argc ATSCPPAPI_UNUSED, const char *argv[] ATSCPPAPI_UNUSED)
+TSPluginInit(int argc, const char *argv[])
 {
   if (!RegisterGlobalPlugin("CPP_Webp_Transform", "apache", "dev@trafficserver.apache.org")) {
     return;
   }
+  for (int i = 1; i < argc; ++i) {
+    static const char OPTION[] = "--max-conversions=";
+    if (strncmp(argv[i], OPTION, sizeof(OPTION) - 1) == 0) {
+      max_conversions = std::max(1, atoi(argv[i] + sizeof(OPTION) - 1));
+    } else {
+      TSError("[%s] Unknown argument %s", TAG, argv[i]);
+    }
+  }
+  TS_DEBUG(TAG, "Converting up to %d images at a time", max_conversions);
   InitializeMagick("");
   plugin = new GlobalHookPlugin();
 }
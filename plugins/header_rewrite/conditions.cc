@@ -200,6 +200,17 @@ ConditionHeader::initialize(Parser &p)
   require_resources(RSRC_SERVER_RESPONSE_HEADERS);
 }
 
+void
+ConditionHeader::set_qualifier(const std::string &q)
+{
+  Condition::set_qualifier(q);
+
+  _qualifier_wks = TSMimeHdrStringToWKS(_qualifier.c_str(), _qualifier.size());
+  if (_qualifier_wks == nullptr) {
+    _qualifier_wks = _qualifier.c_str();
+  }
+}
+
 void
 ConditionHeader::append_value(std::string &s, const Resources &res)
 {
@@ -218,7 +229,7 @@ ConditionHeader::append_value(std::string &s, const Resources &res)
   if (bufp && hdr_loc) {
     TSMLoc field_loc;
 
-    field_loc = TSMimeHdrFieldFind(bufp, hdr_loc, _qualifier.c_str(), _qualifier.size());
+    field_loc = TSMimeHdrFieldFind(bufp, hdr_loc, _qualifier_wks, _qualifier.size());
     TSDebug(PLUGIN_NAME, "Getting Header: %s, field_loc: %p", _qualifier.c_str(), field_loc);
 
     while (field_loc) {
@@ -345,11 +356,17 @@ ConditionUrl::append_value(std::string &s, const Resources &res)
     break;
   case URL_QUAL_URL:
   case URL_QUAL_NONE: {
-    // TSUrlStringGet returns an allocated char * we must free
-    char *non_const_q_str = TSUrlStringGet(bufp, url, &i);
-    s.append(non_const_q_str, i);
-    TSDebug(PLUGIN_NAME, "   URL to match is: %.*s", i, non_const_q_str);
-    TSfree(non_const_q_str);
+    q_str = TSUrlStringViewGet(bufp, url, &i);
+    if (q_str) {
+      s.append(q_str, i);
+      TSDebug(PLUGIN_NAME, "   URL to match is: %.*s", i, q_str);
+    } else {
+      // TSUrlStringGet returns an allocated char * we must free
+      char *non_const_q_str = TSUrlStringGet(bufp, url, &i);
+      s.append(non_const_q_str, i);
+      TSDebug(PLUGIN_NAME, "   URL to match is: %.*s", i, non_const_q_str);
+      TSfree(non_const_q_str);
+    }
     break;
   }
   }
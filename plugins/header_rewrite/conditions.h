@@ -257,6 +257,7 @@ public:
   void operator=(const ConditionHeader &) = delete;
 
   void initialize(Parser &p) override;
+  void set_qualifier(const std::string &q) override;
   void append_value(std::string &s, const Resources &res) override;
 
 protected:
@@ -264,6 +265,7 @@ protected:
 
 private:
   bool _client;
+  const char *_qualifier_wks = ""; // the well-known string of _qualifier, or _qualifier itself
 };
 
 // url
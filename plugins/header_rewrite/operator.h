@@ -85,6 +85,7 @@ public:
 
 protected:
   std::string _header;
+  const char *_header_wks = nullptr; // the well-known string of _header, or _header itself
 };
 
 ///////////////////////////////////////////////////////////////////////////////
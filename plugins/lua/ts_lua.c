@@ -34,12 +34,23 @@
 #define TS_LUA_IND_THREADS 2
 #define TS_LUA_IND_SIZE 3
 
-static uint64_t ts_lua_http_next_id   = 0;
-static uint64_t ts_lua_g_http_next_id = 0;
+// each thread picks its lua states once and keeps running in them, so that their caches stay warm
+static __thread int ts_lua_thread_slot = -1;
+static int ts_lua_next_thread_slot     = 0;
 
 static ts_lua_main_ctx *ts_lua_main_ctx_array   = NULL;
 static ts_lua_main_ctx *ts_lua_g_main_ctx_array = NULL;
 
+static ts_lua_main_ctx *
+ts_lua_thread_main_ctx(ts_lua_main_ctx *arr, int states)
+{
+  if (ts_lua_thread_slot < 0) {
+    ts_lua_thread_slot = __sync_fetch_and_add(&ts_lua_next_thread_slot, 1);
+  }
+
+  return &arr[ts_lua_thread_slot % states];
+}
+
 // records.config entry injected by plugin
 static char const *const ts_lua_mgmt_state_str   = "proxy.config.plugin.lua.max_states";
 static char const *const ts_lua_mgmt_state_regex = "^[1-9][0-9]*$";
@@ -462,7 +473,6 @@ static TSRemapStatus
 ts_lua_remap_plugin_init(void *ih, TSHttpTxn rh, TSRemapRequestInfo *rri)
 {
   int ret;
-  uint64_t req_id;
 
   TSCont contp;
   lua_State *L;
@@ -475,9 +485,8 @@ ts_lua_remap_plugin_init(void *ih, TSHttpTxn rh, TSRemapRequestInfo *rri)
 
   int remap     = (rri == NULL ? 0 : 1);
   instance_conf = (ts_lua_instance_conf *)ih;
-  req_id        = __sync_fetch_and_add(&ts_lua_http_next_id, 1);
 
-  main_ctx = &ts_lua_main_ctx_array[req_id % instance_conf->states];
+  main_ctx = ts_lua_thread_main_ctx(ts_lua_main_ctx_array, instance_conf->states);
 
   TSMutexLock(main_ctx->mutexp);
 
@@ -566,7 +575,6 @@ globalHookHandler(TSCont contp, TSEvent event ATS_UNUSED, void *edata)
   TSMLoc url_loc;
 
   int ret;
-  uint64_t req_id;
   TSCont txn_contp;
 
   lua_State *l;
@@ -577,11 +585,9 @@ globalHookHandler(TSCont contp, TSEvent event ATS_UNUSED, void *edata)
 
   ts_lua_instance_conf *conf = (ts_lua_instance_conf *)TSContDataGet(contp);
 
-  req_id = __sync_fetch_and_add(&ts_lua_g_http_next_id, 1);
-
-  main_ctx = &ts_lua_g_main_ctx_array[req_id % conf->states];
+  main_ctx = ts_lua_thread_main_ctx(ts_lua_g_main_ctx_array, conf->states);
 
-  TSDebug(TS_LUA_DEBUG_TAG, "[%s] req_id: %" PRId64, __FUNCTION__, req_id);
+  TSDebug(TS_LUA_DEBUG_TAG, "[%s] state: %d", __FUNCTION__, (int)(main_ctx - ts_lua_g_main_ctx_array));
   TSMutexLock(main_ctx->mutexp);
 
   http_ctx           = ts_lua_create_http_ctx(main_ctx, conf);
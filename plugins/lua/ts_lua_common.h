@@ -22,6 +22,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <inttypes.h>
+#include <sys/types.h>
 
 #include "lua.h"
 #include "lualib.h"
@@ -98,6 +99,9 @@ typedef struct {
   int states;
 
   int init_func;
+
+  time_t script_mtime; // of the script when it was loaded, a reload skips an unchanged script
+  off_t script_size;
 } ts_lua_instance_conf;
 
 /* lua state for http request */
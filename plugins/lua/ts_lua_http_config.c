@@ -137,6 +137,9 @@ typedef enum {
   TS_LUA_CONFIG_SSL_CLIENT_PRIVATE_KEY_FILENAME               = TS_CONFIG_SSL_CLIENT_PRIVATE_KEY_FILENAME,
   TS_LUA_CONFIG_SSL_CLIENT_CA_CERT_FILENAME                   = TS_CONFIG_SSL_CLIENT_CA_CERT_FILENAME,
   TS_LUA_CONFIG_HTTP_HOST_RESOLUTION_PREFERENCE               = TS_CONFIG_HTTP_HOST_RESOLUTION_PREFERENCE,
+  TS_LUA_CONFIG_NET_PACING_RATE                               = TS_CONFIG_NET_PACING_RATE,
+  TS_LUA_CONFIG_NET_PACING_GROUP                              = TS_CONFIG_NET_PACING_GROUP,
+  TS_LUA_CONFIG_HTTP_CACHE_VARY_USER_AGENT_CLASS              = TS_CONFIG_HTTP_CACHE_VARY_USER_AGENT_CLASS,
   TS_LUA_CONFIG_LAST_ENTRY                                    = TS_CONFIG_LAST_ENTRY,
 } TSLuaOverridableConfigKey;
 
@@ -263,6 +266,9 @@ ts_lua_var_item ts_lua_http_config_vars[] = {
   TS_LUA_MAKE_VAR_ITEM(TS_CONFIG_SSL_CLIENT_PRIVATE_KEY_FILENAME),
   TS_LUA_MAKE_VAR_ITEM(TS_CONFIG_SSL_CLIENT_CA_CERT_FILENAME),
   TS_LUA_MAKE_VAR_ITEM(TS_CONFIG_HTTP_HOST_RESOLUTION_PREFERENCE),
+  TS_LUA_MAKE_VAR_ITEM(TS_CONFIG_NET_PACING_RATE),
+  TS_LUA_MAKE_VAR_ITEM(TS_CONFIG_NET_PACING_GROUP),
+  TS_LUA_MAKE_VAR_ITEM(TS_CONFIG_HTTP_CACHE_VARY_USER_AGENT_CLASS),
   TS_LUA_MAKE_VAR_ITEM(TS_CONFIG_HTTP_SERVER_MIN_KEEP_ALIVE_CONNS),
   TS_LUA_MAKE_VAR_ITEM(TS_LUA_CONFIG_HTTP_PER_SERVER_CONNECTION_MAX),
   TS_LUA_MAKE_VAR_ITEM(TS_LUA_CONFIG_HTTP_PER_SERVER_CONNECTION_MATCH),
@@ -36,12 +36,29 @@
 #include "ts_lua_fetch.h"
 #include "ts_lua_http_intercept.h"
 
+#include <pthread.h>
+#include <sys/stat.h>
+
+/* a script compiled to bytecode, so that it is parsed once for all the lua states */
+typedef struct ts_lua_chunk {
+  char script[TS_LUA_MAX_SCRIPT_FNAME_LENGTH];
+  time_t mtime;
+  off_t size;
+  char *code;
+  size_t len;
+  struct ts_lua_chunk *next;
+} ts_lua_chunk;
+
+static ts_lua_chunk *ts_lua_chunks         = NULL;
+static pthread_mutex_t ts_lua_chunks_mutex = PTHREAD_MUTEX_INITIALIZER;
+
 static lua_State *ts_lua_new_state();
 static void ts_lua_init_registry(lua_State *L);
 static void ts_lua_init_globals(lua_State *L);
 static void ts_lua_inject_ts_api(lua_State *L);
 static ts_lua_ctx_stats *ts_lua_create_ctx_stats();
 static void ts_lua_destroy_ctx_stats(ts_lua_ctx_stats *stats);
+static int ts_lua_load_script(lua_State *L, const char *script, const struct stat *st);
 
 int
 ts_lua_create_vm(ts_lua_main_ctx *arr, int n)
@@ -220,6 +237,14 @@ ts_lua_add_module(ts_lua_instance_conf *conf, ts_lua_main_ctx *arr, int n, int a
   int i, ret;
   int t;
   lua_State *L;
+  struct stat st;
+  const struct stat *stp = NULL;
+
+  if (!conf->content && strlen(conf->script) && stat(conf->script, &st) == 0) {
+    conf->script_mtime = st.st_mtime;
+    conf->script_size  = st.st_size;
+    stp                = &st;
+  }
 
   for (i = 0; i < n; i++) {
     conf->_first = (i == 0) ? 1 : 0;
@@ -249,7 +274,7 @@ ts_lua_add_module(ts_lua_instance_conf *conf, ts_lua_main_ctx *arr, int n, int a
       }
 
     } else if (strlen(conf->script)) {
-      if (luaL_loadfile(L, conf->script)) {
+      if (ts_lua_load_script(L, conf->script, stp)) {
         snprintf(errbuf, errbuf_size, "[%s] luaL_loadfile %s failed: %s", __FUNCTION__, conf->script, lua_tostring(L, -1));
         lua_pop(L, 1);
         TSMutexUnlock(arr[i].mutexp);
@@ -356,6 +381,18 @@ ts_lua_reload_module(ts_lua_instance_conf *conf, ts_lua_main_ctx *arr, int n)
 {
   int i;
   lua_State *L;
+  struct stat st;
+  const struct stat *stp = NULL;
+
+  if (strlen(conf->script) && stat(conf->script, &st) == 0) {
+    if (st.st_mtime == conf->script_mtime && st.st_size == conf->script_size) {
+      TSDebug(TS_LUA_DEBUG_TAG, "[%s] %s is unchanged, not reloading it", __FUNCTION__, conf->script);
+      return 0;
+    }
+    conf->script_mtime = st.st_mtime;
+    conf->script_size  = st.st_size;
+    stp                = &st;
+  }
 
   for (i = 0; i < n; i++) {
     TSMutexLock(arr[i].mutexp);
@@ -390,7 +427,7 @@ ts_lua_reload_module(ts_lua_instance_conf *conf, ts_lua_main_ctx *arr, int n)
     ts_lua_set_instance_conf(L, conf);
 
     if (strlen(conf->script)) {
-      if (luaL_loadfile(L, conf->script)) {
+      if (ts_lua_load_script(L, conf->script, stp)) {
         TSError("[ts_lua][%s] luaL_loadfile %s failed: %s", __FUNCTION__, conf->script, lua_tostring(L, -1));
       } else {
         if (lua_pcall(L, 0, 0, 0)) {
@@ -412,6 +449,68 @@ ts_lua_reload_module(ts_lua_instance_conf *conf, ts_lua_main_ctx *arr, int n)
   return 0;
 }
 
+static int
+ts_lua_chunk_writer(lua_State *L ATS_UNUSED, const void *p, size_t sz, void *ud)
+{
+  ts_lua_chunk *chunk = (ts_lua_chunk *)ud;
+
+  chunk->code = TSrealloc(chunk->code, chunk->len + sz);
+  memcpy(chunk->code + chunk->len, p, sz);
+  chunk->len += sz;
+
+  return 0;
+}
+
+/* push the function of @a script, which is parsed only if it changed since it was last compiled */
+static int
+ts_lua_load_script(lua_State *L, const char *script, const struct stat *st)
+{
+  int ret;
+  ts_lua_chunk *chunk;
+
+  if (st == NULL) {
+    return luaL_loadfile(L, script);
+  }
+
+  pthread_mutex_lock(&ts_lua_chunks_mutex);
+
+  for (chunk = ts_lua_chunks; chunk != NULL; chunk = chunk->next) {
+    if (strcmp(chunk->script, script) == 0) {
+      break;
+    }
+  }
+
+  if (chunk && chunk->len && chunk->mtime == st->st_mtime && chunk->size == st->st_size) {
+    ret = luaL_loadbuffer(L, chunk->code, chunk->len, script);
+    pthread_mutex_unlock(&ts_lua_chunks_mutex);
+    return ret;
+  }
+
+  ret = luaL_loadfile(L, script);
+
+  if (ret == 0) {
+    if (chunk == NULL) {
+      chunk = TSmalloc(sizeof(ts_lua_chunk));
+      memset(chunk, 0, sizeof(ts_lua_chunk));
+      TSstrlcpy(chunk->script, script, sizeof(chunk->script));
+      chunk->next   = ts_lua_chunks;
+      ts_lua_chunks = chunk;
+    }
+
+    chunk->len = 0;
+    if (lua_dump(L, ts_lua_chunk_writer, chunk)) {
+      chunk->len = 0; /* parse it again next time */
+    }
+    chunk->mtime = st->st_mtime;
+    chunk->size  = st->st_size;
+    TSDebug(TS_LUA_DEBUG_TAG, "[%s] compiled %s to %zu bytes", __FUNCTION__, script, chunk->len);
+  }
+
+  pthread_mutex_unlock(&ts_lua_chunks_mutex);
+
+  return ret;
+}
+
 int
 ts_lua_init_instance(ts_lua_instance_conf *conf ATS_UNUSED)
 {
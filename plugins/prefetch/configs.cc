@@ -66,6 +66,8 @@ PrefetchConfig::init(int argc, char *argv[])
                                           {const_cast<char *>("metrics-prefix"), optional_argument, nullptr, 'm'},
                                           {const_cast<char *>("exact-match"), optional_argument, nullptr, 'y'},
                                           {const_cast<char *>("log-name"), optional_argument, nullptr, 'l'},
+                                          {const_cast<char *>("fetch-manifest"), optional_argument, nullptr, 'a'},
+                                          {const_cast<char *>("fetch-origin-rate"), optional_argument, nullptr, 'o'},
                                           {nullptr, 0, nullptr, 0}};
 
   bool status = true;
@@ -141,6 +143,14 @@ PrefetchConfig::init(int argc, char *argv[])
     case 'l': /* --log-name */
       setLogName(optarg);
       break;
+
+    case 'a': /* --fetch-manifest */
+      _fetchManifest = ::isTrue(optarg);
+      break;
+
+    case 'o': /* --fetch-origin-rate */
+      setFetchOriginRate(optarg);
+      break;
     }
   }
 
@@ -164,6 +174,8 @@ PrefetchConfig::finalize()
   PrefetchDebug("fetch policy parameters: %s", _fetchPolicy.c_str());
   PrefetchDebug("fetch count: %d", _fetchCount);
   PrefetchDebug("fetch concurrently max: %d", _fetchMax);
+  PrefetchDebug("fetch manifest segments: %s", (_fetchManifest ? "true" : "false"));
+  PrefetchDebug("fetch origin rate: %d/s", _fetchOriginRate);
   PrefetchDebug("replace host name: %s", _replaceHost.c_str());
   PrefetchDebug("name space: %s", _namespace.c_str());
   PrefetchDebug("log name: %s", _logName.c_str());
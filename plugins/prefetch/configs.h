@@ -111,6 +111,24 @@ public:
     return _exactMatch;
   }
 
+  bool
+  isFetchManifest() const
+  {
+    return _fetchManifest;
+  }
+
+  void
+  setFetchOriginRate(const char *optarg)
+  {
+    _fetchOriginRate = getValue(optarg);
+  }
+
+  unsigned
+  getFetchOriginRate() const
+  {
+    return _fetchOriginRate;
+  }
+
   void
   setFetchCount(const char *optarg)
   {
@@ -192,8 +210,10 @@ private:
   std::string _metricsPrefix;
   std::string _logName;
   unsigned _fetchCount = 1;
-  unsigned _fetchMax   = 0;
-  bool _front          = false;
-  bool _exactMatch     = false;
+  unsigned _fetchMax        = 0;
+  unsigned _fetchOriginRate = 0;
+  bool _front               = false;
+  bool _exactMatch          = false;
+  bool _fetchManifest       = false;
   MultiPattern _nextPaths;
 };
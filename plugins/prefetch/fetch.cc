@@ -82,6 +82,12 @@ getPrefetchMetricsNames(int metric)
   case FETCH_POLICY_MAXSIZE:
     return "fetch.policy.maxsize";
     break;
+  case FETCH_MANIFESTS:
+    return "fetch.manifests";
+    break;
+  case FETCH_RATE_LIMITED:
+    return "fetch.rate_limited";
+    break;
   default:
     return "unknown";
     break;
@@ -334,6 +340,37 @@ BgFetchState::uniqueRelease(const String &url)
   return permitted;
 }
 
+bool
+BgFetchState::rateAcquire(const String &origin, unsigned rate)
+{
+  if (0 == rate) {
+    return true;
+  }
+
+  bool permitted = false;
+  TSHRTime now   = TShrtime();
+
+  TSMutexLock(_lock);
+  auto it = _originBudgets.find(origin);
+  if (_originBudgets.end() == it) {
+    it = _originBudgets.emplace(origin, std::make_pair(static_cast<double>(rate), now)).first;
+  } else {
+    /* Refill at 'rate' tokens per second, at most one second worth of fetches can burst */
+    double tokens = it->second.first + static_cast<double>(now - it->second.second) * rate / TS_HRTIME_SECOND;
+    it->second    = std::make_pair(std::min(tokens, static_cast<double>(rate)), now);
+  }
+  if (it->second.first >= 1.0) {
+    it->second.first -= 1.0;
+    permitted = true;
+  }
+  TSMutexUnlock(_lock);
+
+  if (!permitted) {
+    incrementMetric(FETCH_RATE_LIMITED);
+  }
+  return permitted;
+}
+
 void
 BgFetchState::incrementMetric(PrefetchMetric m)
 {
@@ -50,6 +50,8 @@ enum PrefetchMetric {
   FETCH_POLICY_NO,  /* metric id for counting fetch policy failures */
   FETCH_POLICY_SIZE,
   FETCH_POLICY_MAXSIZE,
+  FETCH_MANIFESTS,     /* metric id for counting manifests parsed for segments */
+  FETCH_RATE_LIMITED,  /* metric id for counting fetches over the origin rate budget */
   FETCHES_MAX_METRICS,
 };
 
@@ -79,6 +81,9 @@ public:
   bool uniqueAcquire(const String &url);
   bool uniqueRelease(const String &url);
 
+  /* Per origin budget of fetches per second */
+  bool rateAcquire(const String &origin, unsigned rate);
+
   /* Metrics and logs */
   void incrementMetric(PrefetchMetric m);
   void setMetric(PrefetchMetric m, size_t value);
@@ -97,6 +102,9 @@ private:
   TSMutex _lock;                  /* protects the de-duplication object only */
   size_t _concurrentFetches                        = 0;
   size_t _concurrentFetchesMax                     = 0;
+
+  /* Token bucket per origin: the tokens left and when they were last refilled, protected by _lock */
+  std::unordered_map<String, std::pair<double, TSHRTime>> _originBudgets;
   PrefetchMetricInfo _metrics[FETCHES_MAX_METRICS] = {
     {FETCH_ACTIVE, TS_RECORDDATATYPE_INT, -1},        {FETCH_COMPLETED, TS_RECORDDATATYPE_COUNTER, -1},
     {FETCH_ERRORS, TS_RECORDDATATYPE_COUNTER, -1},    {FETCH_TIMEOOUTS, TS_RECORDDATATYPE_COUNTER, -1},
@@ -105,7 +113,8 @@ private:
     {FETCH_UNIQUE_NO, TS_RECORDDATATYPE_COUNTER, -1}, {FETCH_MATCH_YES, TS_RECORDDATATYPE_COUNTER, -1},
     {FETCH_MATCH_NO, TS_RECORDDATATYPE_COUNTER, -1},  {FETCH_POLICY_YES, TS_RECORDDATATYPE_COUNTER, -1},
     {FETCH_POLICY_NO, TS_RECORDDATATYPE_COUNTER, -1}, {FETCH_POLICY_SIZE, TS_RECORDDATATYPE_INT, -1},
-    {FETCH_POLICY_MAXSIZE, TS_RECORDDATATYPE_INT, -1}};
+    {FETCH_POLICY_MAXSIZE, TS_RECORDDATATYPE_INT, -1}, {FETCH_MANIFESTS, TS_RECORDDATATYPE_COUNTER, -1},
+    {FETCH_RATE_LIMITED, TS_RECORDDATATYPE_COUNTER, -1}};
 
   /* plugin specific fetch logging */
   TSTextLogObject _log = nullptr;
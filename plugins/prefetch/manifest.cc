@@ -0,0 +1,172 @@
+/*
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+/**
+ * @file manifest.cc
+ * @brief HLS / DASH manifest parsing.
+ */
+
+#include "manifest.h"
+
+static bool
+endsWith(const String &str, const char *suffix, size_t len)
+{
+  return str.length() >= len && 0 == str.compare(str.length() - len, len, suffix);
+}
+
+bool
+isManifestPath(const String &path, bool &dash)
+{
+  dash = endsWith(path, ".mpd", 4);
+  return dash || endsWith(path, ".m3u8", 5);
+}
+
+/**
+ * @brief resolves a segment URI against the manifest path, absolute URLs (other hosts) are not resolved.
+ * @return the URL path without leading '/', empty if the URI cannot be fetched through this host.
+ */
+static String
+resolveSegmentPath(const String &manifestPath, String uri)
+{
+  String::size_type pos = uri.find_first_of("?#");
+  if (String::npos != pos) {
+    uri.erase(pos);
+  }
+
+  if (uri.empty() || String::npos != uri.find("://")) {
+    return String();
+  }
+  if ('/' == uri[0]) {
+    return uri.substr(1);
+  }
+
+  pos = manifestPath.rfind('/');
+  return String::npos == pos ? uri : manifestPath.substr(0, pos + 1) + uri;
+}
+
+/**
+ * @brief gets the value of attribute 'name' from the markup in 'str' starting at 'pos'.
+ */
+static bool
+getAttribute(const String &str, String::size_type pos, String::size_type end, const char *name, String &value)
+{
+  String key(name);
+  key.append("=\"");
+
+  pos = str.find(key, pos);
+  if (String::npos == pos || pos >= end) {
+    return false;
+  }
+  pos += key.length();
+
+  String::size_type close = str.find('"', pos);
+  if (String::npos == close || close > end) {
+    return false;
+  }
+  value.assign(str, pos, close - pos);
+  return true;
+}
+
+static void
+getHlsSegments(const String &manifest, StringList &uris, String &init, bool &live)
+{
+  String::size_type pos = 0;
+
+  live = true;
+  while (pos < manifest.length()) {
+    String::size_type eol = manifest.find('\n', pos);
+    if (String::npos == eol) {
+      eol = manifest.length();
+    }
+
+    String line(manifest, pos, eol - pos);
+    pos = eol + 1;
+    if (!line.empty() && '\r' == line.back()) {
+      line.pop_back();
+    }
+
+    if (line.empty()) {
+      continue;
+    } else if ('#' != line[0]) {
+      uris.push_back(line);
+    } else if (0 == line.compare(0, 14, "#EXT-X-ENDLIST")) {
+      live = false;
+    } else if (0 == line.compare(0, 18, "#EXT-X-STREAM-INF:")) {
+      /* A master playlist lists renditions, the segments are in their playlists. */
+      uris.clear();
+      return;
+    } else if (0 == line.compare(0, 11, "#EXT-X-MAP:")) {
+      getAttribute(line, 0, line.length(), "URI", init);
+    }
+  }
+}
+
+static void
+getDashSegments(const String &manifest, StringList &uris, String &init, bool &live)
+{
+  String::size_type pos = manifest.find("<MPD");
+  String value;
+
+  live = String::npos != pos && getAttribute(manifest, pos, manifest.find('>', pos), "type", value) && value == "dynamic";
+
+  /* Only explicit segment lists, a SegmentTemplate needs the timeline to be computed. */
+  for (pos = manifest.find("<Initialization"); String::npos != pos && init.empty(); pos = manifest.find("<Initialization", pos + 1)) {
+    getAttribute(manifest, pos, manifest.find('>', pos), "sourceURL", init);
+  }
+  for (pos = manifest.find("<SegmentURL"); String::npos != pos; pos = manifest.find("<SegmentURL", pos + 1)) {
+    if (getAttribute(manifest, pos, manifest.find('>', pos), "media", value)) {
+      uris.push_back(value);
+    }
+  }
+}
+
+void
+getManifestSegments(const String &manifest, bool dash, const String &manifestPath, unsigned count, StringVector &segments)
+{
+  StringList uris;
+  String init;
+  bool live;
+
+  if (dash) {
+    getDashSegments(manifest, uris, init, live);
+  } else {
+    getHlsSegments(manifest, uris, init, live);
+  }
+  PrefetchDebug("manifest %s: %zu segments, %s", manifestPath.c_str(), uris.size(), live ? "live" : "vod");
+
+  if (!init.empty()) {
+    String path = resolveSegmentPath(manifestPath, init);
+    if (!path.empty()) {
+      segments.push_back(path);
+    }
+  }
+
+  /* Live clients join near the end of the playlist, VOD clients at the start. */
+  while (live && uris.size() > count) {
+    uris.pop_front();
+  }
+  for (const String &uri : uris) {
+    if (0 == count--) {
+      break;
+    }
+    String path = resolveSegmentPath(manifestPath, uri);
+    if (!path.empty()) {
+      segments.push_back(path);
+    }
+  }
+}
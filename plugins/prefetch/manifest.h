@@ -0,0 +1,48 @@
+/*
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+/**
+ * @file manifest.h
+ * @brief HLS / DASH manifest parsing (header file).
+ */
+
+#pragma once
+
+#include "common.h"
+
+/**
+ * @brief tells if a URL path is a HLS playlist (.m3u8) or a DASH manifest (.mpd).
+ * @param path URL path
+ * @param dash set to true if a DASH manifest
+ * @return true if a manifest
+ */
+bool isManifestPath(const String &path, bool &dash);
+
+/**
+ * @brief finds the segments that clients are about to request from a manifest.
+ *
+ * For a VOD manifest these are the first segments, for a live one the last, which is where new clients join. The
+ * initialization segment, if any, comes first and does not count.
+ *
+ * @param manifest manifest body
+ * @param dash true if a DASH MPD, false if a HLS playlist
+ * @param manifestPath URL path of the manifest, relative segment URIs are resolved against it
+ * @param count number of segments
+ * @param segments URL paths of the segments (without the leading '/')
+ */
+void getManifestSegments(const String &manifest, bool dash, const String &manifestPath, unsigned count, StringVector &segments);
@@ -33,6 +33,7 @@
 #include "fetch.h"
 #include "fetch_policy.h"
 #include "headers.h"
+#include "manifest.h"
 
 static const char *
 getEventName(TSEvent event)
@@ -140,7 +141,7 @@ class PrefetchTxnData
 {
 public:
   PrefetchTxnData(PrefetchInstance *inst)
-    : _inst(inst), _front(true), _firstPass(true), _fetchable(false), _status(TS_HTTP_STATUS_OK)
+    : _inst(inst), _front(true), _firstPass(true), _manifest(false), _dash(false), _fetchable(false), _status(TS_HTTP_STATUS_OK)
   {
   }
 
@@ -172,6 +173,8 @@ public:
 
   bool _front;     /* front-end vs back-end */
   bool _firstPass; /* first vs second pass */
+  bool _manifest;  /* HLS / DASH manifest to fetch the segments of */
+  bool _dash;      /* DASH vs HLS manifest */
 
   /* saves state between hooks */
   String _cachekey;     /* cache key */
@@ -429,6 +432,209 @@ respToTriggerPrefetch(TSHttpTxn txnp)
   return trigger;
 }
 
+/**
+ * @brief Manifest transform data, the manifest body is saved while passed through to find the segments to fetch.
+ */
+struct ManifestTransformData {
+  ManifestTransformData(PrefetchInstance *inst, TSHttpTxn txnp, bool dash) : _inst(inst), _txnp(txnp), _dash(dash) {}
+
+  ~ManifestTransformData()
+  {
+    if (nullptr != _outputReader) {
+      TSIOBufferReaderFree(_outputReader);
+    }
+    if (nullptr != _outputBuffer) {
+      TSIOBufferDestroy(_outputBuffer);
+    }
+  }
+
+  PrefetchInstance *_inst;
+  TSHttpTxn _txnp;
+  bool _dash;
+
+  TSIOBuffer _outputBuffer       = nullptr;
+  TSIOBufferReader _outputReader = nullptr;
+  TSVIO _outputVio               = nullptr;
+  String _body;
+  bool _truncated = false;
+};
+
+/* Bigger manifests are passed through but not parsed */
+static const size_t MANIFEST_MAX_SIZE = 1024 * 1024;
+
+/**
+ * @brief Saves up to 'len' bytes available in the reader into the manifest body.
+ */
+static void
+saveManifestBody(ManifestTransformData *data, TSIOBufferReader reader, int64_t len)
+{
+  TSIOBufferBlock block = TSIOBufferReaderStart(reader);
+  while (nullptr != block && len > 0) {
+    int64_t avail   = 0;
+    const char *ptr = TSIOBufferBlockReadStart(block, reader, &avail);
+    avail           = std::min(avail, len);
+    if (data->_body.length() + avail > MANIFEST_MAX_SIZE) {
+      data->_truncated = true;
+      return;
+    }
+    data->_body.append(ptr, avail);
+    len   -= avail;
+    block  = TSIOBufferBlockNext(block);
+  }
+}
+
+/**
+ * @brief Schedules the background fetches of the segments found in the manifest.
+ */
+static void
+fetchManifestSegments(ManifestTransformData *data)
+{
+  PrefetchConfig &config = data->_inst->_config;
+  BgFetchState *state    = data->_inst->_state;
+  TSHttpTxn txnp         = data->_txnp;
+
+  if (data->_truncated) {
+    PrefetchDebug("manifest bigger than %zu bytes, skip", MANIFEST_MAX_SIZE);
+    return;
+  }
+  if (!respToTriggerPrefetch(txnp)) {
+    return;
+  }
+
+  String manifestPath = getPristineUrlPath(txnp);
+  if (manifestPath.empty()) {
+    PrefetchDebug("failed to get manifest path");
+    return;
+  }
+
+  StringVector segments;
+  getManifestSegments(data->_body, data->_dash, manifestPath, config.getFetchCount(), segments);
+  state->incrementMetric(FETCH_MANIFESTS);
+  PrefetchDebug("found %zu segments to fetch in %s manifest", segments.size(), data->_dash ? "DASH" : "HLS");
+  if (segments.empty()) {
+    return;
+  }
+
+  /* The fetches of an origin are budgeted, the replaced host is the origin if set */
+  String origin(config.getReplaceHost());
+  if (origin.empty()) {
+    TSMBuffer urlBuffer;
+    TSMLoc pristineUrlLoc;
+    if (TS_SUCCESS == TSHttpTxnPristineUrlGet(txnp, &urlBuffer, &pristineUrlLoc)) {
+      int hostLen      = 0;
+      const char *host = TSUrlHostGet(urlBuffer, pristineUrlLoc, &hostLen);
+      if (nullptr != host) {
+        origin.assign(host, hostLen);
+      }
+      TSHandleMLocRelease(urlBuffer, TS_NULL_MLOC, pristineUrlLoc);
+    }
+  }
+
+  TSMBuffer reqBuffer;
+  TSMLoc reqHdrLoc;
+  if (TS_SUCCESS != TSHttpTxnClientReqGet(txnp, &reqBuffer, &reqHdrLoc)) {
+    PrefetchError("failed to get client request");
+    return;
+  }
+
+  for (const String &segment : segments) {
+    if (!state->rateAcquire(origin, config.getFetchOriginRate())) {
+      PrefetchDebug("origin '%s' fetch rate exceeded, skip the remaining segments", origin.c_str());
+      break;
+    }
+    /* The second-pass skips the segments already cached or being fetched */
+    PrefetchDebug("fetching segment %s", segment.c_str());
+    BgFetch::schedule(state, config, /* askPermission */ false, reqBuffer, reqHdrLoc, txnp, segment.c_str(), segment.length(),
+                      manifestPath);
+  }
+
+  TSHandleMLocRelease(reqBuffer, TS_NULL_MLOC, reqHdrLoc);
+}
+
+/**
+ * @brief Passes the manifest body through unchanged while saving it.
+ */
+static void
+handleManifestTransform(TSCont contp, ManifestTransformData *data)
+{
+  TSVConn output = TSTransformOutputVConnGet(contp);
+  TSVIO inputVio = TSVConnWriteVIOGet(contp);
+
+  if (nullptr == data->_outputBuffer) {
+    data->_outputBuffer = TSIOBufferCreate();
+    data->_outputReader = TSIOBufferReaderAlloc(data->_outputBuffer);
+    data->_outputVio    = TSVConnWrite(output, contp, data->_outputReader, TSVIONBytesGet(inputVio));
+  }
+
+  /* The write operation was shutdown, there is no more data to pass through */
+  if (nullptr == TSVIOBufferGet(inputVio)) {
+    TSVIONBytesSet(data->_outputVio, TSVIONDoneGet(inputVio));
+    TSVIOReenable(data->_outputVio);
+    return;
+  }
+
+  int64_t towrite = TSVIONTodoGet(inputVio);
+  if (towrite > 0) {
+    TSIOBufferReader inputReader = TSVIOReaderGet(inputVio);
+    towrite                      = std::min(towrite, TSIOBufferReaderAvail(inputReader));
+    if (towrite > 0) {
+      if (!data->_truncated) {
+        saveManifestBody(data, inputReader, towrite);
+      }
+      TSIOBufferCopy(TSVIOBufferGet(data->_outputVio), inputReader, towrite, 0);
+      TSIOBufferReaderConsume(inputReader, towrite);
+      TSVIONDoneSet(inputVio, TSVIONDoneGet(inputVio) + towrite);
+    }
+  }
+
+  if (TSVIONTodoGet(inputVio) > 0) {
+    if (towrite > 0) {
+      TSVIOReenable(data->_outputVio);
+      TSContCall(TSVIOContGet(inputVio), TS_EVENT_VCONN_WRITE_READY, inputVio);
+    }
+  } else {
+    fetchManifestSegments(data);
+
+    TSVIONBytesSet(data->_outputVio, TSVIONDoneGet(inputVio));
+    TSVIOReenable(data->_outputVio);
+    TSContCall(TSVIOContGet(inputVio), TS_EVENT_VCONN_WRITE_COMPLETE, inputVio);
+  }
+}
+
+/**
+ * @brief Manifest transform continuation handler.
+ *
+ * @param contp transform continuation
+ * @param event transform event
+ * @param edata event data
+ * @return always 0
+ */
+static int
+contManifestTransform(TSCont contp, TSEvent event, void *edata)
+{
+  ManifestTransformData *data = static_cast<ManifestTransformData *>(TSContDataGet(contp));
+
+  if (TSVConnClosedGet(contp)) {
+    delete data;
+    TSContDestroy(contp);
+    return 0;
+  }
+
+  switch (event) {
+  case TS_EVENT_ERROR: {
+    TSVIO inputVio = TSVConnWriteVIOGet(contp);
+    TSContCall(TSVIOContGet(inputVio), TS_EVENT_ERROR, inputVio);
+  } break;
+  case TS_EVENT_VCONN_WRITE_COMPLETE:
+    TSVConnShutdown(TSTransformOutputVConnGet(contp), 0, 1);
+    break;
+  default:
+    handleManifestTransform(contp, data);
+    break;
+  }
+  return 0;
+}
+
 /**
  * @brief Callback function that handles necessary foreground / background fetch operations.
  *
@@ -476,8 +682,8 @@ contHandleFetch(const TSCont contp, TSEvent event, void *edata)
     if (data->frontend()) {
       /* front-end instance */
       if (data->firstPass()) {
-        /* first-pass */
-        if (!config.isExactMatch()) {
+        /* first-pass, the manifests are never prefetched themselves */
+        if (!config.isExactMatch() && !data->_manifest) {
           data->_fetchable = state->acquire(data->_cachekey);
           PrefetchDebug("request is %s fetchable", data->_fetchable ? " " : " not ");
         }
@@ -504,6 +710,14 @@ contHandleFetch(const TSCont contp, TSEvent event, void *edata)
         } else {
           retEvent = shortcutResponse(data, TS_HTTP_STATUS_ALREADY_REPORTED, "fetch not scheduled\n", TS_EVENT_HTTP_ERROR);
         }
+      } else if (data->_manifest) {
+        /* first-pass, find the segments to fetch in the manifest body, only the untransformed response is cached */
+        ManifestTransformData *transformData = new ManifestTransformData(data->_inst, txnp, data->_dash);
+        TSVConn transform                    = TSTransformCreate(contManifestTransform, txnp);
+        TSContDataSet(transform, static_cast<void *>(transformData));
+        TSHttpTxnHookAdd(txnp, TS_HTTP_RESPONSE_TRANSFORM_HOOK, transform);
+        TSHttpTxnUntransformedRespCache(txnp, 1);
+        TSHttpTxnTransformedRespCache(txnp, 0);
       }
     } else {
       /* back-end instance */
@@ -703,7 +917,13 @@ TSRemapDoRemap(void *instance, TSHttpTxn txnp, TSRemapRequestInfo *rri)
 
       /* Make sure we handle only URLs that match the path pattern on the front-end + first-pass, cancel otherwise */
       bool handleFetch = true;
-      if (front && firstPass) {
+      bool manifest    = false;
+      bool dash        = false;
+      if (front && firstPass && config.isFetchManifest() && isManifestPath(getPristineUrlPath(txnp), dash)) {
+        /* Front-end plug-in instance + first pass of a manifest, the segments to fetch come from its body. */
+        PrefetchDebug("%s manifest, fetch the segments", dash ? "DASH" : "HLS");
+        manifest = true;
+      } else if (front && firstPass) {
         /* Front-end plug-in instance + first pass. */
         if (config.getNextPath().empty()) {
           /* No next path pattern specified then pass this request untouched. */
@@ -734,6 +954,8 @@ TSRemapDoRemap(void *instance, TSHttpTxn txnp, TSRemapRequestInfo *rri)
         if (nullptr != data) {
           data->_front     = front;
           data->_firstPass = firstPass;
+          data->_manifest  = manifest;
+          data->_dash      = dash;
 
           TSCont cont = TSContCreate(contHandleFetch, TSMutexCreate());
           TSContDataSet(cont, static_cast<void *>(data));
@@ -37,6 +37,7 @@
 #include <cctype>
 #include <memory>
 #include <sstream>
+#include <vector>
 
 // Get some specific stuff from libts, yes, we can do that now that we build inside the core.
 #include "tscore/ink_platform.h"
@@ -56,6 +57,12 @@ static const char *PLUGIN_NAME = "regex_remap";
 static const int OVECCOUNT = 30; // We support $0 - $9 x2 ints, and this needs to be 1.5x that
 static const int MAX_SUBS  = 32; // No more than 32 substitution variables in the subst string
 
+#ifdef PCRE_STUDY_JIT_COMPILE
+static const int STUDY_OPTIONS = PCRE_STUDY_EXTRA_NEEDED | PCRE_STUDY_JIT_COMPILE;
+#else
+static const int STUDY_OPTIONS = PCRE_STUDY_EXTRA_NEEDED;
+#endif
+
 // Substitutions other than regex matches
 enum ExtraSubstitutions {
   SUB_HOST       = 11,
@@ -122,7 +129,11 @@ public:
       pcre_free(_rex);
     }
     if (_extra) {
+#ifdef PCRE_STUDY_JIT_COMPILE
+      pcre_free_study(_extra);
+#else
       pcre_free(_extra);
+#endif
     }
   }
 
@@ -196,6 +207,16 @@ public:
   {
     return !_rex_string || !*_rex_string;
   }
+  inline bool
+  caseless() const
+  {
+    return _options & PCRE_CASELESS;
+  }
+  inline const pcre *
+  compiled() const
+  {
+    return _rex;
+  }
   inline TSHttpStatus
   status_option() const
   {
@@ -389,7 +410,7 @@ RemapRegex::compile(const char *&error, int &erroffset)
     return -1;
   }
 
-  _extra = pcre_study(_rex, PCRE_STUDY_EXTRA_NEEDED, &error);
+  _extra = pcre_study(_rex, STUDY_OPTIONS, &error);
   if (error != nullptr) {
     return -1;
   }
@@ -623,6 +644,22 @@ RemapRegex::substitute(char dest[], const char *src, const int ovector[], const
 // Hold one remap instance
 struct RemapInstance {
   RemapInstance() : filename("unknown") {}
+  ~RemapInstance()
+  {
+    if (set_extra) {
+#ifdef PCRE_STUDY_JIT_COMPILE
+      pcre_free_study(set_extra);
+#else
+      pcre_free(set_extra);
+#endif
+    }
+    if (set_rex) {
+      pcre_free(set_rex);
+    }
+  }
+
+  void build_match_set();
+  RemapRegex *match_set_first(const char *str, int len, bool &none);
 
   RemapRegex *first  = nullptr;
   RemapRegex *last   = nullptr;
@@ -631,12 +668,93 @@ struct RemapInstance {
   bool query_string  = true;
   bool matrix_params = false;
   bool host          = false;
+  bool match_set     = false;
   int hits           = 0;
   int misses         = 0;
   int failures       = 0;
   std::string filename;
+
+  // All the rules in one alternation, each rule in a group of its own.
+  pcre *set_rex         = nullptr;
+  pcre_extra *set_extra = nullptr;
+  bool set_anchored     = false;
+  int set_ovec_size     = 0;
+  std::vector<std::pair<int, RemapRegex *>> set_groups; // The group and the rule, in the order of the rules.
 };
 
+// Compile all the rules into one alternation. A string that matches none of the rules is then known after a
+// single pass, and when all the rules are anchored, the first group that matched is the first rule that matches.
+void
+RemapInstance::build_match_set()
+{
+  std::string pattern;
+  const char *error;
+  int erroffset;
+  int group = 1;
+
+  for (RemapRegex *re = first; re; re = re->next()) {
+    int ccount, backrefs;
+
+    // The groups of the rules are numbered anew in the alternation, a back reference would refer to another group.
+    if (pcre_fullinfo(re->compiled(), nullptr, PCRE_INFO_CAPTURECOUNT, &ccount) != 0 ||
+        pcre_fullinfo(re->compiled(), nullptr, PCRE_INFO_BACKREFMAX, &backrefs) != 0 || backrefs > 0) {
+      TSDebug(PLUGIN_NAME, "Not matching the rules of %s as a set, rule %d has back references", filename.c_str(), re->order());
+      set_groups.clear();
+      return;
+    }
+    if (re != first) {
+      pattern += '|';
+    }
+    pattern += re->caseless() ? "((?i)" : "(";
+    pattern += re->regex();
+    pattern += ')';
+    set_groups.emplace_back(group, re);
+    group += ccount + 1;
+  }
+
+  set_rex = pcre_compile(pattern.c_str(), 0, &error, &erroffset, nullptr);
+  if (set_rex == nullptr) {
+    TSDebug(PLUGIN_NAME, "Not matching the rules of %s as a set, the alternation did not compile: %s", filename.c_str(), error);
+    set_groups.clear();
+    return;
+  }
+  set_extra = pcre_study(set_rex, STUDY_OPTIONS, &error);
+  if (set_extra) {
+    set_extra->match_limit_recursion = 1750;
+    set_extra->flags |= PCRE_EXTRA_MATCH_LIMIT_RECURSION;
+  }
+
+  unsigned long options = 0;
+  pcre_fullinfo(set_rex, set_extra, PCRE_INFO_OPTIONS, &options);
+  set_anchored  = options & PCRE_ANCHORED;
+  set_ovec_size = group * 3;
+  TSDebug(PLUGIN_NAME, "Matching the %zu rules of %s as a set%s", set_groups.size(), filename.c_str(),
+          set_anchored ? ", all anchored" : "");
+}
+
+// The rule to start matching at, or nullptr with @a none set when no rule matches.
+RemapRegex *
+RemapInstance::match_set_first(const char *str, int len, bool &none)
+{
+  int *ovector = static_cast<int *>(alloca(set_ovec_size * sizeof(int)));
+  int rc       = pcre_exec(set_rex, set_extra, str, len, 0, 0, ovector, set_ovec_size);
+
+  none = (rc == PCRE_ERROR_NOMATCH);
+  if (none) {
+    return nullptr;
+  }
+  if (rc > 0 && set_anchored) {
+    // The alternatives are tried in order at the only position, the first one that matched is the first rule.
+    for (auto &[group, re] : set_groups) {
+      if (group < rc && ovector[2 * group] >= 0) {
+        return re;
+      }
+    }
+  }
+
+  return first; // Failed, or not anchored, the rules have to be matched one by one
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // Helpers for memory management (to make sure pcre uses the TS APIs).
 //
@@ -726,6 +844,10 @@ TSRemapNewInstance(int argc, char *argv[], void **ih, char * /* errbuf ATS_UNUSE
       ri->host = true;
     } else if (strncmp(argv[i], "no-host", 7) == 0) {
       ri->host = false;
+    } else if (strncmp(argv[i], "match-set", 9) == 0) {
+      ri->match_set = true;
+    } else if (strncmp(argv[i], "no-match-set", 12) == 0) {
+      ri->match_set = false;
     } else {
       TSError("[%s] invalid option '%s'", PLUGIN_NAME, argv[i]);
     }
@@ -844,6 +966,10 @@ TSRemapNewInstance(int argc, char *argv[], void **ih, char * /* errbuf ATS_UNUSE
     return TS_ERROR;
   }
 
+  if (ri->match_set) {
+    ri->build_match_set();
+  }
+
   return TS_SUCCESS;
 }
 
@@ -973,6 +1099,18 @@ TSRemapDoRemap(void *ih, TSHttpTxn txnp, TSRemapRequestInfo *rri)
   match_buf[match_len] = '\0'; // NULL terminate the match string
   TSDebug(PLUGIN_NAME, "Target match string is `%s'", match_buf);
 
+  if (ri->set_rex) {
+    bool none;
+
+    re = ri->match_set_first(match_buf, match_len, none);
+    if (none) {
+      if (ri->profile) {
+        ink_atomic_increment(&(ri->misses), 1);
+      }
+      return TSREMAP_NO_REMAP;
+    }
+  }
+
   // Apply the regular expressions, in order. First one wins.
   while (re) {
     // Since we check substitutions on parse time, we don't need to reset ovector
@@ -45,6 +45,12 @@
 #define LOG_ROLL_INTERVAL 86400
 #define LOG_ROLL_OFFSET 0
 
+#ifdef PCRE_STUDY_JIT_COMPILE
+#define STUDY_OPTIONS PCRE_STUDY_JIT_COMPILE
+#else
+#define STUDY_OPTIONS 0
+#endif
+
 static inline void *
 ts_malloc(size_t s)
 {
@@ -64,6 +70,9 @@ typedef struct invalidate_t {
   time_t epoch;
   time_t expiry;
   struct invalidate_t *next;
+  // Only in the first rule of a list, all the rules of the list in one alternation.
+  pcre *set_regex;
+  pcre_extra *set_extra;
 } invalidate_t;
 
 typedef struct {
@@ -71,6 +80,7 @@ typedef struct {
   char *config_file;
   time_t last_load;
   TSTextLogObject log;
+  bool match_set;
 } plugin_state_t;
 
 static invalidate_t *
@@ -82,22 +92,31 @@ init_invalidate_t(invalidate_t *i)
   i->epoch       = 0;
   i->expiry      = 0;
   i->next        = NULL;
+  i->set_regex   = NULL;
+  i->set_extra   = NULL;
   return i;
 }
 
 static void
-free_invalidate_t(invalidate_t *i)
+free_regex(pcre *regex, pcre_extra *extra)
 {
-  if (i->regex_extra) {
+  if (extra) {
 #ifndef PCRE_STUDY_JIT_COMPILE
-    pcre_free(i->regex_extra);
+    pcre_free(extra);
 #else
-    pcre_free_study(i->regex_extra);
+    pcre_free_study(extra);
 #endif
   }
-  if (i->regex) {
-    pcre_free(i->regex);
+  if (regex) {
+    pcre_free(regex);
   }
+}
+
+static void
+free_invalidate_t(invalidate_t *i)
+{
+  free_regex(i->regex, i->regex_extra);
+  free_regex(i->set_regex, i->set_extra);
   if (i->regex_text) {
     pcre_free_substring(i->regex_text);
   }
@@ -120,6 +139,7 @@ init_plugin_state_t(plugin_state_t *pstate)
   pstate->config_file     = NULL;
   pstate->last_load       = 0;
   pstate->log             = NULL;
+  pstate->match_set       = false;
   return pstate;
 }
 
@@ -148,10 +168,12 @@ copy_invalidate_t(invalidate_t *i)
   iptr              = (invalidate_t *)TSmalloc(sizeof(invalidate_t));
   iptr->regex_text  = TSstrdup(i->regex_text);
   iptr->regex       = pcre_compile(iptr->regex_text, 0, &errptr, &erroffset, NULL); // There is no pcre_copy :-(
-  iptr->regex_extra = pcre_study(iptr->regex, 0, &errptr); // Assuming no errors since this worked before :-/
+  iptr->regex_extra = pcre_study(iptr->regex, STUDY_OPTIONS, &errptr); // Assuming no errors since this worked before :-/
   iptr->epoch       = i->epoch;
   iptr->expiry      = i->expiry;
   iptr->next        = NULL;
+  iptr->set_regex   = NULL;
+  iptr->set_extra   = NULL;
   return iptr;
 }
 
@@ -260,7 +282,7 @@ load_config(plugin_state_t *pstate, invalidate_t **ilist)
           TSDebug(LOG_PREFIX, "%s did not compile", i->regex_text);
           free_invalidate_t(i);
         } else {
-          i->regex_extra = pcre_study(i->regex, 0, &errptr);
+          i->regex_extra = pcre_study(i->regex, STUDY_OPTIONS, &errptr);
           if (!*ilist) {
             *ilist = i;
             TSDebug(LOG_PREFIX, "Created new list and Loaded %s %d %d", i->regex_text, (int)i->epoch, (int)i->expiry);
@@ -302,6 +324,42 @@ load_config(plugin_state_t *pstate, invalidate_t **ilist)
   return false;
 }
 
+// Compile all the rules of the list into one alternation, which tells in a single pass that a URL matches none of them.
+static void
+build_match_set(plugin_state_t *pstate, invalidate_t *list)
+{
+  invalidate_t *iptr;
+  const char *errptr;
+  int erroffset, backrefs;
+  size_t len = 1;
+  char *pattern, *p;
+
+  if (!pstate->match_set || !list) {
+    return;
+  }
+  for (iptr = list; iptr; iptr = iptr->next) {
+    // The groups of the rules are numbered anew in the alternation, a back reference would refer to another rule.
+    if (pcre_fullinfo(iptr->regex, iptr->regex_extra, PCRE_INFO_BACKREFMAX, &backrefs) != 0 || backrefs > 0) {
+      TSDebug(LOG_PREFIX, "Not matching the rules as a set, %s has back references", iptr->regex_text);
+      return;
+    }
+    len += strlen(iptr->regex_text) + 5;
+  }
+
+  p = pattern = TSmalloc(len);
+  for (iptr = list; iptr; iptr = iptr->next) {
+    p += sprintf(p, "%s(?:%s)", iptr == list ? "" : "|", iptr->regex_text);
+  }
+
+  list->set_regex = pcre_compile(pattern, 0, &errptr, &erroffset, NULL);
+  if (list->set_regex == NULL) {
+    TSDebug(LOG_PREFIX, "Not matching the rules as a set, the alternation did not compile: %s", errptr);
+  } else {
+    list->set_extra = pcre_study(list->set_regex, STUDY_OPTIONS, &errptr);
+  }
+  TSfree(pattern);
+}
+
 static void
 list_config(plugin_state_t *pstate, invalidate_t *i)
 {
@@ -361,6 +419,7 @@ config_handler(TSCont cont, TSEvent event, void *edata)
 
   if (updated) {
     list_config(pstate, i);
+    build_match_set(pstate, i);
     iptr = __sync_val_compare_and_swap(&(pstate->invalidate_list), pstate->invalidate_list, i);
 
     if (iptr) {
@@ -421,6 +480,13 @@ main_handler(TSCont cont, TSEvent event, void *edata)
       if (status == TS_CACHE_LOOKUP_HIT_FRESH) {
         pstate = (plugin_state_t *)TSContDataGet(cont);
         iptr   = pstate->invalidate_list;
+        if (iptr && iptr->set_regex) {
+          url = TSHttpTxnEffectiveUrlStringGet(txn, &url_len);
+          // Only a URL that matches some rule needs the rules one by one, for their epoch and expiry.
+          if (pcre_exec(iptr->set_regex, iptr->set_extra, url, url_len, 0, 0, NULL, 0) == PCRE_ERROR_NOMATCH) {
+            iptr = NULL;
+          }
+        }
         while (iptr) {
           if (!date) {
             date = get_date_from_cached_hdr(txn);
@@ -495,9 +561,10 @@ TSPluginInit(int argc, const char *argv[])
   static const struct option longopts[] = {{"config", required_argument, NULL, 'c'},
                                            {"log", required_argument, NULL, 'l'},
                                            {"disable-timed-reload", no_argument, NULL, 'd'},
+                                           {"match-set", no_argument, NULL, 'm'},
                                            {NULL, 0, NULL, 0}};
 
-  while ((c = getopt_long(argc, (char *const *)argv, "c:l:", longopts, NULL)) != -1) {
+  while ((c = getopt_long(argc, (char *const *)argv, "c:l:dm", longopts, NULL)) != -1) {
     switch (c) {
     case 'c':
       pstate->config_file = TSstrdup(optarg);
@@ -512,6 +579,9 @@ TSPluginInit(int argc, const char *argv[])
     case 'd':
       disable_timed_reload = true;
       break;
+    case 'm':
+      pstate->match_set = true;
+      break;
     default:
       break;
     }
@@ -528,6 +598,7 @@ TSPluginInit(int argc, const char *argv[])
   } else {
     pstate->invalidate_list = iptr;
     list_config(pstate, iptr);
+    build_match_set(pstate, iptr);
   }
 
   info.plugin_name   = LOG_PREFIX;
@@ -27,6 +27,8 @@
 #include <ctime>          /* strftime(), time(), gmtime_r() */
 #include <iomanip>        /* std::setw */
 #include <sstream>        /* std::stringstream */
+#include <string_view>    /* std::string_view */
+#include <vector>         /* std::vector */
 #include <openssl/sha.h>  /* SHA(), sha256_Update(), SHA256_Final, etc. */
 #include <openssl/hmac.h> /* HMAC() */
 
@@ -265,6 +267,14 @@ getPayloadSha256(bool signPayload)
   return base16Encode(reinterpret_cast<char *>(payloadHash), SHA256_DIGEST_LENGTH);
 }
 
+/* A signed header of the canonical request, its lower-case name is at name in the names buffer. */
+struct CanonicalHeader {
+  size_t name;
+  size_t nameLen;
+  const char *value;
+  size_t valueLen;
+};
+
 /**
  * @brief Get Canonical Uri SHA256 Hash
  *
@@ -339,9 +349,16 @@ getCanonicalRequestSha256Hash(TsInterface &api, bool signPayload, const StringSe
   sha256Update(&canonicalRequestSha256Ctx, "\n");
 
   /* Sorted Canonical Headers
-   *  <CanonicalHeaders>\n */
-  StringSet signedHeadersSet;
-  StringMap headersMap;
+   *  <CanonicalHeaders>\n
+   * The signed headers are views of the request header values, with their lower-case names in a buffer, sorted by name and
+   * then by their order in the request, so that the values of same name fields are joined in order. The buffers are kept
+   * by each thread, so once they are large enough nothing is allocated for the headers. */
+  thread_local String lowercaseName;
+  thread_local String headerNames;
+  thread_local std::vector<CanonicalHeader> headers;
+
+  headerNames.clear();
+  headers.clear();
 
   for (HeaderIterator it = api.headerBegin(); it != api.headerEnd(); it++) {
     int nameLen;
@@ -353,7 +370,7 @@ getCanonicalRequestSha256Hash(TsInterface &api, bool signPayload, const StringSe
       continue;
     }
 
-    String lowercaseName(name, nameLen);
+    lowercaseName.assign(name, nameLen);
     std::transform(lowercaseName.begin(), lowercaseName.end(), lowercaseName.begin(), ::tolower);
 
     /* Host, content-type and x-amx-* headers are mandatory */
@@ -384,29 +401,39 @@ getCanonicalRequestSha256Hash(TsInterface &api, bool signPayload, const StringSe
     size_t trimValueLen   = 0;
     const char *trimValue = trimWhiteSpaces(value, valueLen, trimValueLen);
 
-    signedHeadersSet.insert(lowercaseName);
-    if (headersMap.find(lowercaseName) == headersMap.end()) {
-      headersMap[lowercaseName] = String(trimValue, trimValueLen);
+    headers.push_back({headerNames.size(), lowercaseName.length(), trimValue, trimValueLen});
+    headerNames.append(lowercaseName);
+  }
+
+  auto headerName = [](const CanonicalHeader &h) { return std::string_view(headerNames.data() + h.name, h.nameLen); };
+  std::sort(headers.begin(), headers.end(), [&headerName](const CanonicalHeader &a, const CanonicalHeader &b) {
+    int cmp = headerName(a).compare(headerName(b));
+    return cmp < 0 || (cmp == 0 && a.name < b.name);
+  });
+
+  for (auto it = headers.begin(); it != headers.end(); ++it) {
+    std::string_view name = headerName(*it);
+    if (it != headers.begin() && headerName(*(it - 1)) == name) {
+      sha256Update(&canonicalRequestSha256Ctx, ",");
     } else {
-      headersMap[lowercaseName].append(",").append(String(trimValue, trimValueLen));
+      if (it != headers.begin()) {
+        sha256Update(&canonicalRequestSha256Ctx, "\n");
+      }
+      sha256Update(&canonicalRequestSha256Ctx, name.data(), name.length());
+      sha256Update(&canonicalRequestSha256Ctx, ":");
+
+      if (!signedHeaders.empty()) {
+        signedHeaders.append(";");
+      }
+      signedHeaders.append(name);
     }
+    sha256Update(&canonicalRequestSha256Ctx, it->value, it->valueLen);
   }
-
-  for (const auto &it : signedHeadersSet) {
-    sha256Update(&canonicalRequestSha256Ctx, it);
-    sha256Update(&canonicalRequestSha256Ctx, ":");
-    sha256Update(&canonicalRequestSha256Ctx, headersMap[it]);
+  if (!headers.empty()) {
     sha256Update(&canonicalRequestSha256Ctx, "\n");
   }
   sha256Update(&canonicalRequestSha256Ctx, "\n");
 
-  for (const auto &it : signedHeadersSet) {
-    if (!signedHeaders.empty()) {
-      signedHeaders.append(";");
-    }
-    signedHeaders.append(it);
-  }
-
   sha256Update(&canonicalRequestSha256Ctx, signedHeaders);
   sha256Update(&canonicalRequestSha256Ctx, "\n");
 
@@ -620,6 +647,77 @@ getStringToSign(const char *entryPoint, size_t EntryPointLen, const char *dateTi
   return stringToSign;
 }
 
+/* A derived signing key, which only changes with the date, region and service of the requests it signs. */
+struct SigningKey {
+  String secret;
+  String date;
+  String region;
+  String service;
+  unsigned char key[EVP_MAX_MD_SIZE];
+  unsigned int keyLen = 0;
+};
+
+static constexpr size_t SIGNING_KEY_CACHE_SIZE = 4;
+
+/**
+ * @brief Get the signing key, derived once per day for each region and service and kept by each thread.
+ *
+ * signing key = HMAC-SHA256(HMAC-SHA256(HMAC-SHA256(HMAC-SHA256("AWS4" + "<awsSecret>", <dateTime>),
+ *                   <awsRegion>), <awsService>),"aws4_request")
+ *
+ * @param keyLen output signing key length
+ * @return the signing key or nullptr on failure
+ */
+static const unsigned char *
+getSigningKey(const char *awsSecret, size_t awsSecretLen, const char *awsRegion, size_t awsRegionLen, const char *awsService,
+              size_t awsServiceLen, const char *dateTime, size_t dateTimeLen, unsigned int *keyLen)
+{
+  thread_local SigningKey signingKeys[SIGNING_KEY_CACHE_SIZE];
+  thread_local size_t nextSigningKey = 0;
+
+  for (auto &k : signingKeys) {
+    if (k.keyLen > 0 && 0 == k.date.compare(0, String::npos, dateTime, dateTimeLen) &&
+        0 == k.region.compare(0, String::npos, awsRegion, awsRegionLen) &&
+        0 == k.service.compare(0, String::npos, awsService, awsServiceLen) &&
+        0 == k.secret.compare(0, String::npos, awsSecret, awsSecretLen)) {
+      *keyLen = k.keyLen;
+      return k.key;
+    }
+  }
+
+  unsigned int dateKeyLen = EVP_MAX_MD_SIZE;
+  unsigned char dateKey[EVP_MAX_MD_SIZE];
+  unsigned int dateRegionKeyLen = EVP_MAX_MD_SIZE;
+  unsigned char dateRegionKey[EVP_MAX_MD_SIZE];
+  unsigned int dateRegionServiceKeyLen = EVP_MAX_MD_SIZE;
+  unsigned char dateRegionServiceKey[EVP_MAX_MD_SIZE];
+
+  size_t secretLen = 4 + awsSecretLen;
+  char secret[secretLen];
+  memcpy(secret, "AWS4", 4);
+  memcpy(secret + 4, awsSecret, awsSecretLen);
+
+  SigningKey &k = signingKeys[nextSigningKey];
+  k.keyLen      = EVP_MAX_MD_SIZE;
+  if (!(HMAC(EVP_sha256(), secret, secretLen, (unsigned char *)dateTime, dateTimeLen, dateKey, &dateKeyLen) &&
+        HMAC(EVP_sha256(), dateKey, dateKeyLen, (unsigned char *)awsRegion, awsRegionLen, dateRegionKey, &dateRegionKeyLen) &&
+        HMAC(EVP_sha256(), dateRegionKey, dateRegionKeyLen, (unsigned char *)awsService, awsServiceLen, dateRegionServiceKey,
+             &dateRegionServiceKeyLen) &&
+        HMAC(EVP_sha256(), dateRegionServiceKey, dateRegionServiceKeyLen, reinterpret_cast<const unsigned char *>("aws4_request"),
+             12, k.key, &k.keyLen))) {
+    k.keyLen = 0;
+    return nullptr;
+  }
+  k.secret.assign(awsSecret, awsSecretLen);
+  k.date.assign(dateTime, dateTimeLen);
+  k.region.assign(awsRegion, awsRegionLen);
+  k.service.assign(awsService, awsServiceLen);
+  nextSigningKey = (nextSigningKey + 1) % SIGNING_KEY_CACHE_SIZE;
+
+  *keyLen = k.keyLen;
+  return k.key;
+}
+
 /**
  * @brief Calculates the final signature based on the following parameters and base16 encodes it.
  *
@@ -648,29 +746,13 @@ getSignature(const char *awsSecret, size_t awsSecretLen, const char *awsRegion,
              size_t awsServiceLen, const char *dateTime, size_t dateTimeLen, const char *stringToSign, size_t stringToSignLen,
              char *signature, size_t signatureLen)
 {
-  unsigned int dateKeyLen = EVP_MAX_MD_SIZE;
-  unsigned char dateKey[EVP_MAX_MD_SIZE];
-  unsigned int dateRegionKeyLen = EVP_MAX_MD_SIZE;
-  unsigned char dateRegionKey[EVP_MAX_MD_SIZE];
-  unsigned int dateRegionServiceKeyLen = EVP_MAX_MD_SIZE;
-  unsigned char dateRegionServiceKey[EVP_MAX_MD_SIZE];
-  unsigned int signingKeyLen = EVP_MAX_MD_SIZE;
-  unsigned char signingKey[EVP_MAX_MD_SIZE];
-
-  size_t keyLen = 4 + awsSecretLen;
-  char key[keyLen];
-  memcpy(key, "AWS4", 4);
-  memcpy(key + 4, awsSecret, awsSecretLen);
+  unsigned int signingKeyLen;
+  const unsigned char *signingKey = getSigningKey(awsSecret, awsSecretLen, awsRegion, awsRegionLen, awsService, awsServiceLen,
+                                                  dateTime, dateTimeLen, &signingKeyLen);
 
   unsigned int len = signatureLen;
-  if (HMAC(EVP_sha256(), key, keyLen, (unsigned char *)dateTime, dateTimeLen, dateKey, &dateKeyLen) &&
-      HMAC(EVP_sha256(), dateKey, dateKeyLen, (unsigned char *)awsRegion, awsRegionLen, dateRegionKey, &dateRegionKeyLen) &&
-      HMAC(EVP_sha256(), dateRegionKey, dateRegionKeyLen, (unsigned char *)awsService, awsServiceLen, dateRegionServiceKey,
-           &dateRegionServiceKeyLen) &&
-      HMAC(EVP_sha256(), dateRegionServiceKey, dateRegionServiceKeyLen, reinterpret_cast<const unsigned char *>("aws4_request"), 12,
-           signingKey, &signingKeyLen) &&
-      HMAC(EVP_sha256(), signingKey, signingKeyLen, (unsigned char *)stringToSign, stringToSignLen,
-           reinterpret_cast<unsigned char *>(signature), &len)) {
+  if (signingKey && HMAC(EVP_sha256(), signingKey, signingKeyLen, (unsigned char *)stringToSign, stringToSignLen,
+                         reinterpret_cast<unsigned char *>(signature), &len)) {
     return len;
   }
 
@@ -1040,3 +1040,35 @@ TEST_CASE("S3AuthV4UtilParams: include missing content type", "[AWS][auth][utili
 
   ValidateBenchCanonicalRequest(api, /*signePayload */ false, &now, bench, include, exclude);
 }
+
+/* getSignature() ************************************************************************************************************** */
+
+static String
+signatureOf(const char *region, const char *date, const char *stringToSign)
+{
+  char signature[EVP_MAX_MD_SIZE];
+  size_t signatureLen = getSignature(awsSecretAccessKey, strlen(awsSecretAccessKey), region, strlen(region), awsService,
+                                     strlen(awsService), date, strlen(date), stringToSign, strlen(stringToSign), signature,
+                                     EVP_MAX_MD_SIZE);
+  return base16Encode(signature, signatureLen);
+}
+
+TEST_CASE("getSignature(): signing keys are reused only for the same date, region and service", "[AWS][auth][utility]")
+{
+  const char *regions[] = {"us-east-1", "us-west-1", "us-west-2", "eu-west-1", "ap-south-1", "sa-east-1"};
+  String first[6];
+
+  /* More keys than are kept, so the first ones are derived again. */
+  for (int i = 0; i < 6; i++) {
+    first[i] = signatureOf(regions[i], "20130524", "string to sign");
+    CHECK(first[i].length() == 64);
+    for (int j = 0; j < i; j++) {
+      CHECK(first[i] != first[j]);
+    }
+  }
+  for (int i = 5; i >= 0; i--) {
+    CHECK(signatureOf(regions[i], "20130524", "string to sign") == first[i]);
+  }
+  CHECK(signatureOf(regions[0], "20130525", "string to sign") != first[0]);
+  CHECK(signatureOf(regions[0], "20130524", "string to sign") == first[0]);
+}
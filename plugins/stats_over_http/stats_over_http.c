@@ -72,7 +72,7 @@ typedef struct {
   config_t *config;
 } config_holder_t;
 
-typedef enum { JSON_OUTPUT, CSV_OUTPUT } output_format;
+typedef enum { JSON_OUTPUT, CSV_OUTPUT, PROMETHEUS_OUTPUT } output_format;
 
 int configReloadRequests = 0;
 int configReloads        = 0;
@@ -146,6 +146,8 @@ stats_add_data_to_resp_buffer(const char *s, stats_state *my_state)
 
 static const char RESP_HEADER_JSON[] = "HTTP/1.0 200 Ok\r\nContent-Type: text/json\r\nCache-Control: no-cache\r\n\r\n";
 static const char RESP_HEADER_CSV[]  = "HTTP/1.0 200 Ok\r\nContent-Type: text/csv\r\nCache-Control: no-cache\r\n\r\n";
+static const char RESP_HEADER_PROMETHEUS[] =
+  "HTTP/1.0 200 Ok\r\nContent-Type: text/plain; version=0.0.4\r\nCache-Control: no-cache\r\n\r\n";
 
 static int
 stats_add_resp_header(stats_state *my_state)
@@ -157,6 +159,9 @@ stats_add_resp_header(stats_state *my_state)
   case CSV_OUTPUT:
     return stats_add_data_to_resp_buffer(RESP_HEADER_CSV, my_state);
     break;
+  case PROMETHEUS_OUTPUT:
+    return stats_add_data_to_resp_buffer(RESP_HEADER_PROMETHEUS, my_state);
+    break;
   default:
     TSError("stats_add_resp_header: Unknown output format");
     break;
@@ -304,6 +309,13 @@ csv_out_stats(stats_state *my_state)
   APPEND_STAT_CSV("version", "%s", version);
 }
 
+// The snapshot of the stats that the core formats once per sync, shared rather than copied.
+static void
+prometheus_out_stats(stats_state *my_state)
+{
+  my_state->output_bytes += TSStatPrometheusWrite(my_state->resp_buffer);
+}
+
 static void
 stats_process_write(TSCont contp, TSEvent event, stats_state *my_state)
 {
@@ -318,6 +330,9 @@ stats_process_write(TSCont contp, TSEvent event, stats_state *my_state)
       case CSV_OUTPUT:
         csv_out_stats(my_state);
         break;
+      case PROMETHEUS_OUTPUT:
+        prometheus_out_stats(my_state);
+        break;
       default:
         TSError("stats_process_write: Unknown output type\n");
         break;
@@ -351,6 +366,21 @@ stats_dostuff(TSCont contp, TSEvent event, void *edata)
   return 0;
 }
 
+// Whether the Accept header value @a str, of @a len bytes, lists the media type @a type.
+static bool
+accepts_type(const char *str, int len, const char *type)
+{
+  int type_len = strlen(type);
+  int i;
+
+  for (i = 0; i + type_len <= len; ++i) {
+    if (!strncasecmp(str + i, type, type_len)) {
+      return true;
+    }
+  }
+  return false;
+}
+
 static int
 stats_origin(TSCont contp ATS_UNUSED, TSEvent event ATS_UNUSED, void *edata)
 {
@@ -406,6 +436,9 @@ stats_origin(TSCont contp ATS_UNUSED, TSEvent event ATS_UNUSED, void *edata)
     // Parse the Accept header, default to JSON output unless its another supported format
     if (!strncasecmp(str, "text/csv", len)) {
       my_state->output = CSV_OUTPUT;
+    } else if (accepts_type(str, len, "text/plain") || accepts_type(str, len, "application/openmetrics-text")) {
+      // what Prometheus asks for
+      my_state->output = PROMETHEUS_OUTPUT;
     } else {
       my_state->output = JSON_OUTPUT;
     }
@@ -157,10 +157,11 @@ reloadCacheControl()
 }
 
 void
-getCacheControl(CacheControlResult *result, HttpRequestData *rdata, const OverridableHttpConfigParams *h_txn_conf, char *tag)
+getCacheControl(CacheControlResult *result, HttpRequestData *rdata, const OverridableHttpConfigParams *h_txn_conf, char *tag,
+                ControlMatcherMemo<CacheControlResult> *memo)
 {
   rdata->tag = tag;
-  CacheControlTable->Match(rdata, result);
+  CacheControlTable->Match(rdata, result, memo);
 
   if (h_txn_conf->cache_ignore_client_no_cache) {
     result->ignore_client_no_cache = true;
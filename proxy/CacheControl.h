@@ -120,9 +120,10 @@ inline CacheControlRecord::CacheControlRecord() : ControlBase() {}
 class URL;
 struct HttpConfigParams;
 struct OverridableHttpConfigParams;
+template <class Result> class ControlMatcherMemo;
 
 inkcoreapi void getCacheControl(CacheControlResult *result, HttpRequestData *rdata, const OverridableHttpConfigParams *h_txn_conf,
-                                char *tag = nullptr);
+                                char *tag = nullptr, ControlMatcherMemo<CacheControlResult> *memo = nullptr);
 inkcoreapi bool host_rule_in_CacheControlTable();
 inkcoreapi bool ip_rule_in_CacheControlTable();
 
@@ -79,6 +79,11 @@ public:
   void Print();
   int line_num = 0;
   Modifier *findModOfType(Modifier::Type t) const;
+  bool
+  has_modifiers() const
+  {
+    return !_mods.empty();
+  }
 
 protected:
   /// Get the text for the Scheme modifier, if any.
@@ -29,6 +29,7 @@
  ****************************************************************************/
 
 #include <sys/types.h>
+#include <mutex>
 
 #include "tscore/ink_config.h"
 #include "tscore/MatcherUtils.h"
@@ -82,6 +83,259 @@ HttpRequestData::get_client_ip()
   return &src_ip.sa;
 }
 
+/*************************************************************
+ *   Lookup stats of the config files
+ *************************************************************/
+
+namespace
+{
+// Two stats for each file, the number of lookups and their time, kept across reloads.
+constexpr int CONTROL_MATCHER_MAX_FILES = 16;
+RecRawStatBlock *control_matcher_rsb    = nullptr;
+std::mutex control_matcher_stats_mutex;
+std::unordered_map<std::string, int> control_matcher_stat_ids;
+
+// Tables built so far, for a generation unique to each.
+std::atomic<uint64_t> control_matcher_generation{0};
+
+// The first id of the stats of config_file_path, -1 if there are no more.
+int
+control_matcher_stat_id(const char *config_file_path)
+{
+  const char *slash = strrchr(config_file_path, '/');
+  std::string file{slash ? slash + 1 : config_file_path};
+  std::replace(file.begin(), file.end(), '.', '_');
+
+  std::lock_guard<std::mutex> lock(control_matcher_stats_mutex);
+  if (auto spot = control_matcher_stat_ids.find(file); spot != control_matcher_stat_ids.end()) {
+    return spot->second;
+  }
+  if (control_matcher_stat_ids.size() == CONTROL_MATCHER_MAX_FILES) {
+    Warning("no lookup stats for %s, there are already %d files with stats", config_file_path, CONTROL_MATCHER_MAX_FILES);
+    return -1;
+  }
+  if (control_matcher_rsb == nullptr) {
+    control_matcher_rsb = RecAllocateRawStatBlock(CONTROL_MATCHER_MAX_FILES * 2);
+  }
+
+  int id = control_matcher_stat_ids.size() * 2;
+  std::string name{"proxy.process.control_matcher."};
+  name.append(file);
+  RecRegisterRawStat(control_matcher_rsb, RECT_PROCESS, (name + ".lookups").c_str(), RECD_INT, RECP_NON_PERSISTENT, id,
+                     RecRawStatSyncSum);
+  RecRegisterRawStat(control_matcher_rsb, RECT_PROCESS, (name + ".lookup_time").c_str(), RECD_INT, RECP_NON_PERSISTENT, id + 1,
+                     RecRawStatSyncSum);
+  control_matcher_stat_ids.emplace(file, id);
+  return id;
+}
+} // namespace
+
+/*************************************************************
+ *   Begin class RegexLiteralIndex
+ *************************************************************/
+
+namespace
+{
+// Index just past the ']' closing the class that starts at pattern[i], npos if it is not closed.
+size_t
+skip_class(std::string_view pattern, size_t i)
+{
+  ++i;
+  if (i < pattern.size() && pattern[i] == '^') {
+    ++i;
+  }
+  if (i < pattern.size() && pattern[i] == ']') {
+    ++i; // a leading ']' is a member
+  }
+  while (i < pattern.size()) {
+    char c = pattern[i];
+    if (c == '\\') {
+      i += 2;
+    } else if (c == '[' && i + 1 < pattern.size() && (pattern[i + 1] == ':' || pattern[i + 1] == '=' || pattern[i + 1] == '.')) {
+      char closing[] = {pattern[i + 1], ']'}; // like ":]" for "[:alpha:]"
+      size_t end      = pattern.find(std::string_view{closing, sizeof(closing)}, i + 2);
+      if (end == std::string_view::npos) {
+        return end;
+      }
+      i = end + sizeof(closing);
+    } else if (c == ']') {
+      return i + 1;
+    } else {
+      ++i;
+    }
+  }
+  return std::string_view::npos;
+}
+
+// Index just past the ')' closing the group that starts at pattern[i], npos if it is not closed.
+size_t
+skip_group(std::string_view pattern, size_t i)
+{
+  int depth = 0;
+  while (i < pattern.size()) {
+    char c = pattern[i];
+    if (c == '\\') {
+      i += 2;
+    } else if (c == '[') {
+      i = skip_class(pattern, i);
+    } else {
+      if (c == '(') {
+        ++depth;
+      } else if (c == ')' && --depth == 0) {
+        return i + 1;
+      }
+      ++i;
+    }
+  }
+  return std::string_view::npos;
+}
+} // namespace
+
+std::string
+RegexLiteralIndex::required_literal(std::string_view pattern)
+{
+  // Inline options can make the match caseless or the pattern extended, and quoting needs more
+  // parsing than is worth it here, so either leaves the pattern without a literal.
+  if (pattern.find("(?") != std::string_view::npos || pattern.find("\\Q") != std::string_view::npos) {
+    return {};
+  }
+
+  std::string best;
+  std::string run;
+  auto end_run = [&]() -> void {
+    if (run.size() > best.size()) {
+      best = run;
+    }
+    run.clear();
+  };
+
+  size_t i = 0;
+  while (i < pattern.size()) {
+    char c = pattern[i];
+    switch (c) {
+    case '|':
+      // Only the branches of a top level alternation would be required, and none of them is.
+      return {};
+    case '\\':
+      if (i + 1 >= pattern.size()) {
+        return {};
+      }
+      c = pattern[i + 1];
+      if (!isalnum(static_cast<unsigned char>(c))) {
+        run.push_back(c);
+      } else if (strchr("dDwWsSbBAzZG", c)) {
+        end_run();
+      } else {
+        // Escapes like \x41 or \1 take arguments, rather than parse those give up.
+        return {};
+      }
+      i += 2;
+      continue;
+    case '[':
+      end_run();
+      i = skip_class(pattern, i);
+      if (i == std::string_view::npos) {
+        return {};
+      }
+      continue;
+    case '(':
+      end_run();
+      i = skip_group(pattern, i);
+      if (i == std::string_view::npos) {
+        return {};
+      }
+      continue;
+    case '*':
+    case '?':
+    case '{':
+      // The character before is optional or repeated.
+      if (!run.empty()) {
+        run.pop_back();
+      }
+      end_run();
+      if (c == '{') {
+        size_t close = pattern.find('}', i);
+        if (close != std::string_view::npos &&
+            pattern.substr(i + 1, close - i - 1).find_first_not_of("0123456789,") == std::string_view::npos) {
+          i = close;
+        }
+      }
+      break;
+    case '+':
+    case '.':
+    case '^':
+    case '$':
+    case ')':
+      end_run();
+      break;
+    default:
+      run.push_back(c);
+      break;
+    }
+    ++i;
+  }
+  end_run();
+
+  return best;
+}
+
+void
+RegexLiteralIndex::add(const char *pattern)
+{
+  int entry           = num_entries++;
+  std::string literal = required_literal(pattern);
+
+  if (unfiltered.size() * 64 < static_cast<size_t>(num_entries)) {
+    unfiltered.push_back(0);
+  }
+  if (literal.empty()) {
+    unfiltered[entry >> 6] |= uint64_t(1) << (entry & 63);
+    return;
+  }
+
+  int node = 0;
+  for (unsigned char c : literal) {
+    int child = next(node, c);
+    if (child < 0) {
+      child = nodes.size();
+      nodes.emplace_back();
+      edges.emplace(static_cast<uint64_t>(node) << 8 | c, child);
+    }
+    node = child;
+  }
+  nodes[node].entries.push_back(entry);
+  built = false;
+}
+
+void
+RegexLiteralIndex::build()
+{
+  std::vector<std::vector<std::pair<unsigned char, int>>> children(nodes.size());
+  for (auto const &[key, child] : edges) {
+    children[key >> 8].emplace_back(static_cast<unsigned char>(key & 0xFF), child);
+  }
+
+  // Breadth first, so the node a fail link goes to, which is shallower, is done before.
+  std::vector<int> queue{0};
+  for (size_t head = 0; head < queue.size(); head++) {
+    int parent = queue[head];
+    for (auto const &[c, child] : children[parent]) {
+      int fail = 0;
+      if (parent != 0) {
+        int f;
+        for (fail = nodes[parent].fail; (f = next(fail, c)) < 0 && fail != 0;) {
+          fail = nodes[fail].fail;
+        }
+        fail = f < 0 ? 0 : f;
+      }
+      nodes[child].fail  = fail;
+      nodes[child].match = nodes[child].entries.empty() ? nodes[fail].match : child;
+      queue.push_back(child);
+    }
+  }
+  built = true;
+}
+
 /*************************************************************
  *   Begin class HostMatcher
  *************************************************************/
@@ -143,6 +397,18 @@ HostMatcher<Data, MatchResult>::AllocateSpace(int num_entries)
   num_el     = 0;
 }
 
+//
+// void HostMatcher<Data,MatchResult>::BuildIndex()
+//
+//   Called once all the entries are in
+//
+template <class Data, class MatchResult>
+void
+HostMatcher<Data, MatchResult>::BuildIndex()
+{
+  host_lookup->BuildIndex();
+}
+
 // void HostMatcher<Data,MatchResult>::Match(RequestData* rdata, MatchResult* result)
 //
 //  Searches our tree and updates argresult for each element matching
@@ -175,6 +441,18 @@ HostMatcher<Data, MatchResult>::Match(RequestData *rdata, MatchResult *result)
   }
 }
 
+template <class Data, class MatchResult>
+bool
+HostMatcher<Data, MatchResult>::has_modifiers() const
+{
+  for (int i = 0; i < num_el; i++) {
+    if (data_array[i].has_modifiers()) {
+      return true;
+    }
+  }
+  return false;
+}
+
 //
 // Result HostMatcher<Data,MatchResult>::NewEntry(bool domain_record,
 //          char* match_data, char* match_info, int line_num)
@@ -468,16 +746,29 @@ RegexMatcher<Data, MatchResult>::NewEntry(matcher_line *line_info)
     pcre_free(re_array[num_el]);
     re_array[num_el] = nullptr;
   } else {
+    re_index.add(pattern);
     num_el++;
   }
 
   return error;
 }
 
+//
+// void RegexMatcher<Data,MatchResult>::BuildIndex()
+//
+//   Called once all the entries are in
+//
+template <class Data, class MatchResult>
+void
+RegexMatcher<Data, MatchResult>::BuildIndex()
+{
+  re_index.build();
+}
+
 //
 // void RegexMatcher<Data,MatchResult>::Match(RequestData* rdata, MatchResult* result)
 //
-//   Coduncts a linear search through the regex array and
+//   Runs the regexs the URL has the literals of and
 //     updates arg result for each regex that matches arg URL
 //
 template <class Data, class MatchResult>
@@ -505,8 +796,9 @@ RegexMatcher<Data, MatchResult>::Match(RequestData *rdata, MatchResult *result)
   // HttpRequestData::get_string(); therefore, no need to call again here.
   // unescapifyStr(url_str);
 
-  for (int i = 0; i < num_el; i++) {
-    r = pcre_exec(re_array[i], nullptr, url_str, strlen(url_str), 0, 0, nullptr, 0);
+  int url_len = strlen(url_str);
+  re_index.candidates({url_str, static_cast<size_t>(url_len)}, [&](int i) -> void {
+    r = pcre_exec(re_array[i], nullptr, url_str, url_len, 0, 0, nullptr, 0);
     if (r > -1) {
       Debug("matcher", "%s Matched %s with regex at line %d", matcher_name, url_str, data_array[i].line_num);
       data_array[i].UpdateMatch(result, rdata);
@@ -514,7 +806,7 @@ RegexMatcher<Data, MatchResult>::Match(RequestData *rdata, MatchResult *result)
       // An error has occured
       Warning("Error [%d] matching regex at line %d.", r, data_array[i].line_num);
     } // else it's -1 which means no match was found.
-  }
+  });
   ats_free(url_str);
 }
 
@@ -530,7 +822,7 @@ HostRegexMatcher<Data, MatchResult>::HostRegexMatcher(const char *name, const ch
 //
 // void HostRegexMatcher<Data,MatchResult>::Match(RequestData* rdata, MatchResult* result)
 //
-//   Conducts a linear search through the regex array and
+//   Runs the regexs the host has the literals of and
 //     updates arg result for each regex that matches arg host_regex
 //
 template <class Data, class MatchResult>
@@ -553,17 +845,18 @@ HostRegexMatcher<Data, MatchResult>::Match(RequestData *rdata, MatchResult *resu
   if (url_str == nullptr) {
     url_str = "";
   }
-  for (int i = 0; i < this->num_el; i++) {
-    r = pcre_exec(this->re_array[i], nullptr, url_str, strlen(url_str), 0, 0, nullptr, 0);
-    if (r != -1) {
+  int url_len = strlen(url_str);
+  this->re_index.candidates({url_str, static_cast<size_t>(url_len)}, [&](int i) -> void {
+    r = pcre_exec(this->re_array[i], nullptr, url_str, url_len, 0, 0, nullptr, 0);
+    if (r > -1) {
       Debug("matcher", "%s Matched %s with regex at line %d", const_cast<char *>(this->matcher_name), url_str,
             this->data_array[i].line_num);
       this->data_array[i].UpdateMatch(result, rdata);
-    } else {
+    } else if (r < -1) {
       // An error has occured
       Warning("error matching regex at line %d", this->data_array[i].line_num);
     }
-  }
+  });
 }
 
 //
@@ -644,6 +937,19 @@ IpMatcher<Data, MatchResult>::NewEntry(matcher_line *line_info)
   return error;
 }
 
+//
+// void IpMatcher<Data,MatchResult>::BuildIndex()
+//
+//   Called once all the entries are in, freezes the map
+//     into sorted arrays for the lookups
+//
+template <class Data, class MatchResult>
+void
+IpMatcher<Data, MatchResult>::BuildIndex()
+{
+  ip_map.freeze();
+}
+
 //
 // void IpMatcherData,MatchResult>::Match(in_addr_t addr, RequestData* rdata, MatchResult* result)
 //
@@ -682,6 +988,7 @@ ControlMatcher<Data, MatchResult>::ControlMatcher(const char *file_var, const ch
 
   matcher_name        = name;
   config_file_path[0] = '\0';
+  generation          = ++control_matcher_generation;
 
   if (!(flags & DONT_BUILD_TABLE)) {
     ats_scoped_str config_path(RecConfigReadConfigPath(file_var));
@@ -697,6 +1004,7 @@ ControlMatcher<Data, MatchResult>::ControlMatcher(const char *file_var, const ch
   hrMatch   = nullptr;
 
   if (!(flags & DONT_BUILD_TABLE)) {
+    stat_id      = control_matcher_stat_id(config_file_path);
     m_numEntries = this->BuildTable();
   } else {
     m_numEntries = 0;
@@ -747,6 +1055,9 @@ template <class Data, class MatchResult>
 void
 ControlMatcher<Data, MatchResult>::Match(RequestData *rdata, MatchResult *result)
 {
+  EThread *thread  = stat_id >= 0 ? this_ethread() : nullptr;
+  ink_hrtime start = thread ? Thread::get_hrtime_updated() : 0;
+
   if (hostMatch != nullptr) {
     hostMatch->Match(rdata, result);
   }
@@ -762,6 +1073,29 @@ ControlMatcher<Data, MatchResult>::Match(RequestData *rdata, MatchResult *result
   if (hrMatch != nullptr) {
     hrMatch->Match(rdata, result);
   }
+
+  if (thread) {
+    RecIncrRawStat(control_matcher_rsb, thread, stat_id, 1);
+    RecIncrRawStat(control_matcher_rsb, thread, stat_id + 1, Thread::get_hrtime_updated() - start);
+  }
+}
+
+template <class Data, class MatchResult>
+void
+ControlMatcher<Data, MatchResult>::Match(RequestData *rdata, MatchResult *result, ControlMatcherMemo<MatchResult> *memo)
+{
+  if (memo == nullptr || !host_only) {
+    Match(rdata, result);
+    return;
+  }
+
+  const char *host = rdata->get_host();
+  std::string_view key{host ? host : ""};
+
+  if (!memo->get(generation, key, *result)) {
+    Match(rdata, result);
+    memo->set(generation, key, *result);
+  }
 }
 
 // int ControlMatcher::BuildTable()
@@ -926,6 +1260,21 @@ ControlMatcher<Data, MatchResult>::BuildTableFromString(char *file_buf)
 
   ink_assert(second_pass == numEntries);
 
+  if (hostMatch != nullptr) {
+    hostMatch->BuildIndex();
+  }
+  if (reMatch != nullptr) {
+    reMatch->BuildIndex();
+  }
+  if (hrMatch != nullptr) {
+    hrMatch->BuildIndex();
+  }
+  if (ipMatch != nullptr) {
+    ipMatch->BuildIndex();
+  }
+  host_only = reMatch == nullptr && urlMatch == nullptr && ipMatch == nullptr && hrMatch == nullptr &&
+              (hostMatch == nullptr || !hostMatch->has_modifiers());
+
   if (is_debug_tag_set("matcher")) {
     Print();
   }
@@ -1000,3 +1349,56 @@ template class HostMatcher<CacheControlRecord, CacheControlResult>;
 template class RegexMatcher<CacheControlRecord, CacheControlResult>;
 template class UrlMatcher<CacheControlRecord, CacheControlResult>;
 template class IpMatcher<CacheControlRecord, CacheControlResult>;
+
+#if TS_HAS_TESTS
+#include "tscore/TestBox.h"
+
+REGRESSION_TEST(ControlMatcher_RegexLiteralIndex)(RegressionTest *t, int /* atype ATS_UNUSED */, int *pstatus)
+{
+  TestBox box(t, pstatus);
+  box = REGRESSION_TEST_PASSED;
+
+  static const struct {
+    const char *pattern;
+    const char *literal;
+  } literals[] = {
+    {"^https?://images\\.example\\.com/", "://images.example.com/"},
+    {"example\\.com/.*\\.jpg$", "example.com/"},
+    {"colou?r", "colo"},
+    {"ab+c", "ab"},
+    {"[[:alpha:]]+xyz", "xyz"},
+    {"(foo|bar)baz", "baz"},
+    {"foo|bar", ""},
+    {"(?i)example", ""},
+    {"\\x41bc", ""},
+    {"\\d{2,3}abc", "abc"},
+    {"a{2}bc", "bc"},
+  };
+  for (auto const &l : literals) {
+    std::string literal = RegexLiteralIndex::required_literal(l.pattern);
+    box.check(literal == l.literal, "literal of '%s' is '%s', not '%s'", l.pattern, literal.c_str(), l.literal);
+  }
+
+  // Entry 66 is there to spill into the second word of the bitmap.
+  RegexLiteralIndex index;
+  const char *patterns[] = {"videos\\.example\\.com", "example\\.com/.*\\.jpg$", ".*", "\\.example\\.net$", "deo"};
+  for (int i = 0; i < 67; i++) {
+    index.add(i < 5 ? patterns[i] : (i == 66 ? "ample" : "never-matched"));
+  }
+  index.build();
+
+  static const struct {
+    const char *subject;
+    std::vector<int> entries;
+  } lookups[] = {
+    {"http://videos.example.com/a.jpg", {0, 1, 2, 4, 66}},
+    {"http://www.example.net", {2, 3, 66}},
+    {"http://other.org/", {2}},
+  };
+  for (auto const &l : lookups) {
+    std::vector<int> entries;
+    index.candidates(l.subject, [&](int entry) -> void { entries.push_back(entry); });
+    box.check(entries == l.entries, "wrong candidates for '%s', %zu of them", l.subject, entries.size());
+  }
+}
+#endif
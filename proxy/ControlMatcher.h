@@ -54,8 +54,10 @@
  *  Lookup Table Descriptions
  *  -------------------------
  *
- *   regex table - implemented as a linear list of regular expressions to
- *       match against
+ *   regex table - implemented as a list of regular expressions to
+ *       match against.  The literals the expressions require are found in
+ *       one pass over the string (class RegexLiteralIndex) and only the
+ *       expressions whose literal is there, or that have none, are run
  *
  *   host/domain table - The host domain table is logically implemented as
  *       tree, broken up at each partition in a hostname.  Three mechanism
@@ -96,7 +98,14 @@
 #include "tscore/Regex.h"
 #include "URL.h"
 
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
 #include <unordered_map>
+#include <vector>
 
 #ifdef HAVE_CTYPE_H
 #include <cctype>
@@ -157,6 +166,82 @@ public:
   URL **cache_info_parent_selection_url = nullptr;
 };
 
+// Index of the literal text each regular expression of a table requires.
+//   All the literals in a string are found in one pass (Aho-Corasick), so a
+//   lookup only runs the expressions whose literal it contains and those
+//   that have none, instead of every expression in the table.
+class RegexLiteralIndex
+{
+public:
+  // Add the pattern of the next entry, numbered from 0 in the order they are added
+  void add(const char *pattern);
+  // Link the literals, until then every entry is a candidate
+  void build();
+  // Call f with the number of each entry that may match subject, lowest first
+  template <typename F> void candidates(std::string_view subject, F &&f) const;
+
+  // The longest text in every string the pattern matches, empty if there is none found
+  static std::string required_literal(std::string_view pattern);
+
+private:
+  struct Node {
+    int fail  = 0;  // node of the longest proper suffix in the trie
+    int match = -1; // nearest node ending a literal, this one or along the fail links
+    std::vector<int> entries;
+  };
+
+  int
+  next(int node, unsigned char c) const
+  {
+    auto spot = edges.find(static_cast<uint64_t>(node) << 8 | c);
+    return spot == edges.end() ? -1 : spot->second;
+  }
+
+  int num_entries = 0;
+  bool built      = false;
+  std::vector<Node> nodes{1};
+  std::unordered_map<uint64_t, int> edges; // (node << 8 | char) to child node
+  std::vector<uint64_t> unfiltered;        // bits of the entries without a literal
+};
+
+template <typename F>
+void
+RegexLiteralIndex::candidates(std::string_view subject, F &&f) const
+{
+  if (!built) {
+    for (int i = 0; i < num_entries; i++) {
+      f(i);
+    }
+    return;
+  }
+
+  size_t n_words = unfiltered.size();
+  uint64_t local[64];
+  std::unique_ptr<uint64_t[]> heap;
+  uint64_t *bits = n_words <= countof(local) ? local : (heap.reset(new uint64_t[n_words]), heap.get());
+  std::copy(unfiltered.begin(), unfiltered.end(), bits);
+
+  int node = 0;
+  for (unsigned char c : subject) {
+    int child;
+    while ((child = next(node, c)) < 0 && node != 0) {
+      node = nodes[node].fail;
+    }
+    node = child < 0 ? 0 : child;
+    for (int m = nodes[node].match; m > 0; m = nodes[nodes[m].fail].match) {
+      for (int entry : nodes[m].entries) {
+        bits[entry >> 6] |= uint64_t(1) << (entry & 63);
+      }
+    }
+  }
+
+  for (size_t w = 0; w < n_words; w++) {
+    for (uint64_t word = bits[w]; word; word &= word - 1) {
+      f(static_cast<int>(w * 64 + __builtin_ctzll(word)));
+    }
+  }
+}
+
 // Mixin class for shared info across all templates. This just wraps the
 // shared members such that we don't have to duplicate all these initialixers
 // etc. If someone wants to rewrite all this code to use setters and getters,
@@ -210,6 +295,7 @@ public:
   void Match(RequestData *rdata, MatchResult *result);
   void AllocateSpace(int num_entries);
   Result NewEntry(matcher_line *line_info);
+  void BuildIndex();
   void Print();
 
   using super::num_el;
@@ -221,6 +307,7 @@ public:
 protected:
   pcre **re_array = nullptr; // array of compiled regexs
   char **re_str   = nullptr; // array of uncompiled regex strings
+  RegexLiteralIndex re_index;
 };
 
 template <class Data, class MatchResult> class HostRegexMatcher : public RegexMatcher<Data, MatchResult>
@@ -248,7 +335,9 @@ public:
   void Match(RequestData *rdata, MatchResult *result);
   void AllocateSpace(int num_entries);
   Result NewEntry(matcher_line *line_info);
+  void BuildIndex();
   void Print();
+  bool has_modifiers() const; // some entry matches on more than the host
 
   using super::num_el;
   using super::matcher_name;
@@ -276,6 +365,7 @@ public:
   void Match(sockaddr const *ip_addr, RequestData *rdata, MatchResult *result);
   void AllocateSpace(int num_entries);
   Result NewEntry(matcher_line *line_info);
+  void BuildIndex();
   void Print();
 
   using super::num_el;
@@ -296,6 +386,60 @@ private:
 #define ALLOW_URL_TABLE 1 << 4
 #define DONT_BUILD_TABLE 1 << 5 // for testing
 
+/** The last result of a table that matches on the host alone, for the next requests of a remap rule.
+
+    A rule mostly maps its requests to a single host, so each keeps what the tables it is looked up
+    in gave for it, see @c ControlMatcher::host_only. A table rebuilt on reload has a new generation,
+    which the results of the others do not match.
+ */
+template <class Result> class ControlMatcherMemo
+{
+public:
+  /// Results kept for each table, the requests of a rule for more hosts than this are matched as usual.
+  static constexpr int MAX_ENTRIES = 8;
+
+  bool
+  get(uint64_t generation, std::string_view host, Result &result) const
+  {
+    const Entry *entry = _last.load(std::memory_order_acquire);
+
+    if (entry != nullptr && entry->generation == generation && entry->host == host) {
+      result = entry->result;
+      return true;
+    }
+    return false;
+  }
+
+  void
+  set(uint64_t generation, std::string_view host, const Result &result)
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    if (generation != _generation) {
+      _generation = generation;
+      _count      = 0;
+    }
+    if (_count < MAX_ENTRIES) {
+      ++_count;
+      _entries.emplace_back(new Entry{generation, std::string(host), result});
+      _last.store(_entries.back().get(), std::memory_order_release);
+    }
+  }
+
+private:
+  struct Entry {
+    uint64_t generation;
+    std::string host;
+    Result result;
+  };
+
+  std::atomic<const Entry *> _last{nullptr};
+  std::mutex _mutex;
+  uint64_t _generation = 0;
+  int _count           = 0;
+  std::vector<std::unique_ptr<Entry>> _entries; // kept as long as the memo, a reader may still be on any of them
+};
+
 template <class Data, class MatchResult> class ControlMatcher
 {
 public:
@@ -307,6 +451,8 @@ public:
   int BuildTable();
   int BuildTableFromString(char *str);
   void Match(RequestData *rdata, MatchResult *result);
+  // Match through @a memo when the table is host only, @a result must be as it is before any match
+  void Match(RequestData *rdata, MatchResult *result, ControlMatcherMemo<MatchResult> *memo);
   void Print();
 
   int
@@ -357,4 +503,7 @@ public:
   int flags                = 0;
   int m_numEntries         = 0;
   const char *matcher_name = "unknown"; // Used for Debug/Warning/Error messages
+  int stat_id              = -1;        // lookups of the file, followed by their time
+  uint64_t generation      = 0;         // unique to each table, for the memos of its results
+  bool host_only           = false;     // all the entries match on the host alone
 };
@@ -112,8 +112,9 @@ enum AclOp {
 const IpAllow::Record IpAllow::ALLOW_ALL_RECORD(ALL_METHOD_MASK);
 const IpAllow::ACL IpAllow::DENY_ALL_ACL;
 
-size_t IpAllow::configid     = 0;
-bool IpAllow::accept_check_p = true; // initializing global flag for fast deny
+size_t IpAllow::configid                        = 0;
+std::atomic<uint32_t> IpAllow::current_generation = 0;
+bool IpAllow::accept_check_p                    = true; // initializing global flag for fast deny
 
 static ConfigUpdateHandler<IpAllow> *ipAllowUpdate;
 
@@ -143,6 +144,8 @@ IpAllow::reconfigure()
   new_table->BuildTable();
 
   configid = configProcessor.set(configid, new_table);
+  // Sessions holding an ACL from an earlier generation match again on their next transaction.
+  current_generation.fetch_add(1, std::memory_order_release);
 
   Note("%s finished loading", ts::filename::IP_ALLOW);
 }
@@ -168,6 +171,7 @@ IpAllow::release()
 IpAllow::ACL
 IpAllow::match(sockaddr const *ip, match_key_t key)
 {
+  uint32_t gen    = generation();
   self_type *self = acquire();
   void *raw       = nullptr;
   if (SRC_ADDR == key) {
@@ -186,7 +190,7 @@ IpAllow::match(sockaddr const *ip, match_key_t key)
     self->release();
     self = nullptr;
   }
-  return ACL{static_cast<Record *>(raw), self};
+  return ACL{static_cast<Record *>(raw), self, gen};
 }
 
 //
@@ -278,6 +282,8 @@ IpAllow::BuildTable()
     for (auto &item : _dst_map) {
       item.setData(&_dst_acls[reinterpret_cast<size_t>(item.data())]);
     }
+    _src_map.freeze();
+    _dst_map.freeze();
     if (is_debug_tag_set("ip-allow")) {
       Print();
     }
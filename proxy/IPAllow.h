@@ -30,6 +30,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <string>
 #include <string_view>
 #include <vector>
@@ -137,12 +138,17 @@ public:
     /// Return the configuration source line for this ACL.
     int source_line() const;
 
+    /// Check if the ACL was matched against the current configuration.
+    /// A stale ACL still works but should be matched again to pick up a reload.
+    bool isCurrent() const;
+
   private:
     // @a config must already be ref counted.
-    ACL(const Record *r, IpAllow *config) noexcept;
+    ACL(const Record *r, IpAllow *config, uint32_t generation) noexcept;
 
     const Record *_r{nullptr}; ///< The actual ACL record.
     IpAllow *_config{nullptr}; ///< The backing configuration.
+    uint32_t _generation{0};   ///< Configuration generation this was matched against.
   };
 
   explicit IpAllow(const char *config_var);
@@ -182,10 +188,14 @@ public:
 
   const ts::file::path &get_config_file() const;
 
+  /// @return The generation of the current configuration, incremented on every reload.
+  static uint32_t generation();
+
 private:
-  static size_t configid;               ///< Configuration ID for update management.
-  static const Record ALLOW_ALL_RECORD; ///< Static record that allows all access.
-  static bool accept_check_p;           ///< @c true if deny all can be enforced during accept.
+  static size_t configid;                          ///< Configuration ID for update management.
+  static std::atomic<uint32_t> current_generation; ///< Generation of the current configuration.
+  static const Record ALLOW_ALL_RECORD;            ///< Static record that allows all access.
+  static bool accept_check_p;                      ///< @c true if deny all can be enforced during accept.
 
   void PrintMap(IpMap *map);
   int BuildTable();
@@ -216,9 +226,12 @@ inline IpAllow::Record::Record(uint32_t method_mask, int ln, MethodNames &&nonst
 
 // ------ ACL methods --------
 
-inline IpAllow::ACL::ACL(const IpAllow::Record *r, IpAllow *config) noexcept : _r(r), _config(config) {}
+inline IpAllow::ACL::ACL(const IpAllow::Record *r, IpAllow *config, uint32_t generation) noexcept
+  : _r(r), _config(config), _generation(generation)
+{
+}
 
-inline IpAllow::ACL::ACL(self_type &&that) noexcept : _r(that._r), _config(that._config)
+inline IpAllow::ACL::ACL(self_type &&that) noexcept : _r(that._r), _config(that._config), _generation(that._generation)
 {
   that._r      = nullptr;
   that._config = nullptr;
@@ -234,11 +247,15 @@ inline IpAllow::ACL::~ACL()
 inline auto
 IpAllow::ACL::operator=(self_type &&that) noexcept -> self_type &
 {
-  // move and clear so @a that doesn't drop the config reference.
-  this->_r      = that._r;
-  that._r       = nullptr;
-  this->_config = that._config;
-  that._config  = nullptr;
+  if (this != &that) {
+    this->clear();
+    // move and clear so @a that doesn't drop the config reference.
+    this->_r          = that._r;
+    that._r           = nullptr;
+    this->_config     = that._config;
+    that._config      = nullptr;
+    this->_generation = that._generation;
+  }
 
   return *this;
 }
@@ -294,7 +311,8 @@ IpAllow::ACL::clear()
     _config->release();
     _config = nullptr;
   }
-  _r = nullptr;
+  _r          = nullptr;
+  _generation = 0;
 }
 
 inline int
@@ -303,6 +321,12 @@ IpAllow::ACL::source_line() const
   return _r ? _r->_src_line : 0;
 }
 
+inline bool
+IpAllow::ACL::isCurrent() const
+{
+  return _generation == IpAllow::generation();
+}
+
 // ------ IpAllow methods --------
 
 inline bool
@@ -319,6 +343,12 @@ IpAllow::isAcceptCheckEnabled()
   return accept_check_p;
 }
 
+inline uint32_t
+IpAllow::generation()
+{
+  return current_generation.load(std::memory_order_acquire);
+}
+
 inline auto
 IpAllow::match(IpEndpoint const *ip, match_key_t key) -> ACL
 {
@@ -328,7 +358,7 @@ IpAllow::match(IpEndpoint const *ip, match_key_t key) -> ACL
 inline auto
 IpAllow::makeAllowAllACL() -> ACL
 {
-  return {&ALLOW_ALL_RECORD, nullptr};
+  return {&ALLOW_ALL_RECORD, nullptr, generation()};
 }
 
 inline const ts::file::path &
@@ -108,12 +108,12 @@ ParentConsistentHash::getPathHash(HttpRequestData *hrdata, ATSHash64 *h)
 // Helper function to abstract calling ATSConsistentHash lookup_by_hashval() vs lookup().
 static pRecord *
 chash_lookup(ATSConsistentHash *fhash, uint64_t path_hash, ATSConsistentHashIter *chashIter, bool *wrap_around,
-             ATSHash64Sip24 *hash, bool *chash_init, bool *mapWrapped)
+             ATSHash64Sip24 *hash, bool *chash_init, bool *mapWrapped, float bounded_load)
 {
   pRecord *prtmp;
 
   if (*chash_init == false) {
-    prtmp       = (pRecord *)fhash->lookup_by_hashval(path_hash, chashIter, wrap_around);
+    prtmp       = (pRecord *)fhash->lookup_bounded(path_hash, bounded_load, chashIter, wrap_around);
     *chash_init = true;
   } else {
     prtmp = (pRecord *)fhash->lookup(nullptr, chashIter, wrap_around, hash);
@@ -193,7 +193,8 @@ ParentConsistentHash::selectParent(bool first_call, ParentResult *result, Reques
   fhash     = chash[last_lookup];
   do { // search until we've selected a different parent if !firstCall
     prtmp = chash_lookup(fhash, path_hash, &result->chashIter[last_lookup], &wrap_around[last_lookup], &hash,
-                         &result->chash_init[last_lookup], &result->mapWrapped[last_lookup]);
+                         &result->chash_init[last_lookup], &result->mapWrapped[last_lookup],
+                         result->rec->bounded_load);
     lookups++;
     if (prtmp) {
       pRec = (parents[last_lookup] + prtmp->idx);
@@ -277,7 +278,8 @@ ParentConsistentHash::selectParent(bool first_call, ParentResult *result, Reques
         }
         fhash = chash[last_lookup];
         prtmp = chash_lookup(fhash, path_hash, &result->chashIter[last_lookup], &wrap_around[last_lookup], &hash,
-                             &result->chash_init[last_lookup], &result->mapWrapped[last_lookup]);
+                             &result->chash_init[last_lookup], &result->mapWrapped[last_lookup],
+                             result->rec->bounded_load);
         lookups++;
         if (prtmp) {
           pRec = (parents[last_lookup] + prtmp->idx);
@@ -331,6 +333,9 @@ ParentConsistentHash::selectParent(bool first_call, ParentResult *result, Reques
     result->retry       = parentRetry;
     ink_assert(result->hostname != nullptr);
     ink_assert(result->port != 0);
+    if (result->rec->bounded_load > 0) {
+      result->hold_load(chash[last_lookup], pRec);
+    }
     Debug("parent_select", "Chosen parent: %s.%d", result->hostname, result->port);
   } else {
     if (result->rec->go_direct == true && result->rec->parent_is_proxy == true) {
@@ -341,6 +346,7 @@ ParentConsistentHash::selectParent(bool first_call, ParentResult *result, Reques
     result->hostname = nullptr;
     result->port     = 0;
     result->retry    = false;
+    result->release_load();
   }
 
   return;
@@ -100,7 +100,8 @@ ParentConfigParams::apiParentExists(HttpRequestData *rdata)
 }
 
 void
-ParentConfigParams::findParent(HttpRequestData *rdata, ParentResult *result, unsigned int fail_threshold, unsigned int retry_time)
+ParentConfigParams::findParent(HttpRequestData *rdata, ParentResult *result, unsigned int fail_threshold, unsigned int retry_time,
+                               ControlMatcherMemo<ParentResult> *memo)
 {
   P_table *tablePtr        = parent_table;
   ParentRecord *defaultPtr = DefaultParent;
@@ -123,7 +124,7 @@ ParentConfigParams::findParent(HttpRequestData *rdata, ParentResult *result, uns
   // Initialize the result structure
   result->reset();
 
-  tablePtr->Match(rdata, result);
+  tablePtr->Match(rdata, result, memo);
   rec = result->rec;
 
   if (rec == nullptr) {
@@ -755,6 +756,14 @@ ParentRecord::Init(matcher_line *line_info)
         ignore_self_detect = false;
       }
       used = true;
+    } else if (strcasecmp(label, "bounded_load") == 0) {
+      float v = atof(val);
+      if (v >= 0) {
+        bounded_load = v;
+        used         = true;
+      } else {
+        errPtr = "invalid argument to bounded_load.  Argument must not be negative.";
+      }
     }
     // Report errors generated by ProcessParents();
     if (errPtr != nullptr) {
@@ -164,6 +164,7 @@ public:
   int max_unavailable_server_retries                                 = 1;
   int secondary_mode                                                 = 1;
   bool ignore_self_detect                                            = false;
+  float bounded_load                                                 = 0;
 };
 
 // If the parent was set by the external customer api,
@@ -186,10 +187,12 @@ struct ParentResult {
   bool retry;
   bool chash_init[MAX_GROUP_RINGS] = {false};
   HostStatus_t first_choice_status = HostStatus_t::HOST_STATUS_INIT;
+  bool peer                        = false; // a sibling peer of a peering ring, only asked for its cached copy.
 
   void
   reset()
   {
+    release_load();
     ink_zero(*this);
     line_number   = -1;
     result        = PARENT_UNDEFINED;
@@ -203,6 +206,27 @@ struct ParentResult {
     return rec == extApiRecord;
   }
 
+  /// Take the parent selected out of the in flight count of its bounded load ring, if it is on one.
+  void
+  release_load()
+  {
+    if (load_node != nullptr) {
+      load_ring->release(load_node);
+      load_ring = nullptr;
+      load_node = nullptr;
+    }
+  }
+
+  /// Count a request in flight to @a node of @a ring until release_load(), in place of the one counted before.
+  void
+  hold_load(ATSConsistentHash *ring, ATSConsistentHashNode *node)
+  {
+    release_load();
+    ring->acquire(node);
+    load_ring = ring;
+    load_node = node;
+  }
+
   // Do we have some result?
   bool
   is_some() const
@@ -307,9 +331,13 @@ private:
   // state for consistent hash.
   int last_lookup;
   ATSConsistentHashIter chashIter[MAX_GROUP_RINGS];
+  // the parent counted by a ring with bounded loads.
+  ATSConsistentHash *load_ring     = nullptr;
+  ATSConsistentHashNode *load_node = nullptr;
 
   friend class NextHopSelectionStrategy;
   friend class NextHopRoundRobin;
+  friend class NextHopLeastLoaded;
   friend class NextHopConsistentHash;
   friend class ParentConsistentHash;
   friend class ParentRoundRobin;
@@ -360,7 +388,8 @@ public:
   ~ParentConfigParams() override;
 
   bool apiParentExists(HttpRequestData *rdata);
-  void findParent(HttpRequestData *rdata, ParentResult *result, unsigned int fail_threshold, unsigned int retry_time);
+  void findParent(HttpRequestData *rdata, ParentResult *result, unsigned int fail_threshold, unsigned int retry_time,
+                  ControlMatcherMemo<ParentResult> *memo = nullptr);
   void nextParent(HttpRequestData *rdata, ParentResult *result, unsigned int fail_threshold, unsigned int retry_time);
   bool parentExists(HttpRequestData *rdata);
 
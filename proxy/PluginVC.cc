@@ -79,6 +79,7 @@
 #define PVC_LOCK_RETRY_TIME HRTIME_MSECONDS(10)
 #define PVC_DEFAULT_MAX_BYTES 32768
 #define MIN_BLOCK_TRANSFER_BYTES 128
+#define PVC_MAX_INLINE_ROUNDS 8
 
 #define PVC_TYPE ((vc_type == PLUGIN_VC_ACTIVE) ? "Active" : "Passive")
 
@@ -97,6 +98,7 @@ PluginVC::PluginVC(PluginVCCore *core_obj)
     core_lock_retry_event(nullptr),
     deletable(false),
     reentrancy_count(0),
+    processing(false),
     active_timeout(0),
     active_event(nullptr),
     inactive_timeout(0),
@@ -202,6 +204,7 @@ PluginVC::main_handler(int event, void *data)
   //  we could be calling the continuation and that we
   //  need to defer close processing
   reentrancy_count++;
+  processing = true;
 
   if (call_event == active_event) {
     process_timeout(&active_event, VC_EVENT_ACTIVE_TIMEOUT);
@@ -226,9 +229,28 @@ PluginVC::main_handler(int event, void *data)
     }
   }
 
+  // The continuations we called back may have reenabled either side, or the
+  //   other side may have reenabled us.  Process them now rather than with
+  //   another event, as long as we hold the locks of their continuations
+  for (int round = 0; round < PVC_MAX_INLINE_ROUNDS && !closed && (need_read_process || need_write_process); ++round) {
+    if ((need_read_process && read_state.vio.mutex != read_side_mutex) ||
+        (need_write_process && write_state.vio.mutex != write_side_mutex)) {
+      break;
+    }
+    if (need_read_process) {
+      process_read_side(false);
+    }
+    if (need_write_process && !closed) {
+      process_write_side(false);
+    }
+  }
+
+  processing = false;
   reentrancy_count--;
   if (closed) {
     process_close();
+  } else if (need_read_process || need_write_process) {
+    setup_event_cb(0, &sm_lock_retry_event);
   }
 
   if (read_mutex_held) {
@@ -268,7 +290,7 @@ PluginVC::do_io_read(Continuation *c, int64_t nbytes, MIOBuffer *buf)
   // Since reentrant callbacks are not allowed on from do_io
   //   functions schedule ourselves get on a different stack
   need_read_process = true;
-  setup_event_cb(0, &sm_lock_retry_event);
+  setup_process_cb();
 
   return &read_state.vio;
 }
@@ -300,7 +322,7 @@ PluginVC::do_io_write(Continuation *c, int64_t nbytes, IOBufferReader *abuffer,
   // Since reentrant callbacks are not allowed on from do_io
   //   functions schedule ourselves get on a different stack
   need_write_process = true;
-  setup_event_cb(0, &sm_lock_retry_event);
+  setup_process_cb();
 
   return &write_state.vio;
 }
@@ -325,7 +347,7 @@ PluginVC::reenable(VIO *vio)
   } else {
     ink_release_assert(0);
   }
-  setup_event_cb(0, &sm_lock_retry_event);
+  setup_process_cb();
 }
 
 void
@@ -850,6 +872,22 @@ PluginVC::setup_event_cb(ink_hrtime in, Event **e_ptr)
   }
 }
 
+// void PluginVC::setup_process_cb()
+//
+//    Arranges for the sides flagged by need_read_process and
+//      need_write_process to be processed.  When main_handler is running
+//      on this thread it does it before it returns, so there is no need
+//      for an event to call us back
+//
+void
+PluginVC::setup_process_cb()
+{
+  if (processing && mutex->thread_holding == this_ethread()) {
+    return;
+  }
+  setup_event_cb(0, &sm_lock_retry_event);
+}
+
 void
 PluginVC::set_active_timeout(ink_hrtime timeout_in)
 {
@@ -159,6 +159,7 @@ private:
   void clear_event(Event **e);
 
   void setup_event_cb(ink_hrtime in, Event **e_ptr);
+  void setup_process_cb();
 
   void update_inactive_time();
   int64_t transfer_bytes(MIOBuffer *transfer_to, IOBufferReader *transfer_from, int64_t act_on);
@@ -181,6 +182,9 @@ private:
 
   bool deletable;
   int reentrancy_count;
+  // Set while main_handler holds the locks of both sides, it processes the sides
+  //   flagged by the continuations it calls back before it returns
+  bool processing;
 
   ink_hrtime active_timeout;
   Event *active_event;
@@ -120,8 +120,8 @@ struct ProtocolProbeTrampoline : public Continuation, public ProtocolProbeSessio
               "ernabled on this port - processing all connections");
       }
 
-      if (http_has_proxy_v1(reader, netvc)) {
-        Debug("proxyprotocol", "ioCompletionEvent: http has proxy_v1 header");
+      if (http_has_proxy_protocol(reader, netvc)) {
+        Debug("proxyprotocol", "ioCompletionEvent: http has proxy protocol header");
         netvc->set_remote_addr(netvc->get_proxy_protocol_src_addr());
       } else {
         Debug("proxyprotocol",
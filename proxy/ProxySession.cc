@@ -79,6 +79,8 @@ ProxySession::free()
   this->api_hooks.clear();
   this->mutex.clear();
   this->acl.clear();
+  this->_dst_acl.clear();
+  ats_ip_invalidate(&this->_dst_acl_ip);
   this->_ssl.reset();
 }
 
@@ -259,6 +261,29 @@ ProxySession::get_local_addr()
   return _vc ? _vc->get_local_addr() : nullptr;
 }
 
+const IpAllow::ACL &
+ProxySession::get_acl()
+{
+  // Stay with the ACL matched at accept until ip_allow is reloaded.
+  if (!acl.isCurrent()) {
+    sockaddr const *client_ip = get_client_addr();
+    if (client_ip) {
+      acl = IpAllow::match(client_ip, IpAllow::SRC_ADDR);
+    }
+  }
+  return acl;
+}
+
+const IpAllow::ACL &
+ProxySession::get_dst_acl(sockaddr const *server_ip)
+{
+  if (!_dst_acl.isCurrent() || !ats_ip_addr_eq(&_dst_acl_ip.sa, server_ip)) {
+    _dst_acl = IpAllow::match(server_ip, IpAllow::DST_ADDR);
+    _dst_acl_ip.assign(server_ip);
+  }
+  return _dst_acl;
+}
+
 void
 ProxySession::_handle_if_ssl(NetVConnection *new_vc)
 {
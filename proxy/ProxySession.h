@@ -148,6 +148,17 @@ public:
   // Returns null pointer if session does not use a TLS connection.
   SSLProxySession const *ssl() const;
 
+  /** The client ACL of the session.
+   * It is matched once at accept and then reused by every transaction, until the ip_allow
+   * configuration is reloaded.
+   */
+  const IpAllow::ACL &get_acl();
+
+  /** The ACL for the destination @a server_ip.
+   * The last match is kept, so transactions going to the same server do not look it up again.
+   */
+  const IpAllow::ACL &get_dst_acl(sockaddr const *server_ip);
+
   // Implement VConnection interface
   VIO *do_io_read(Continuation *c, int64_t nbytes = INT64_MAX, MIOBuffer *buf = nullptr) override;
   VIO *do_io_write(Continuation *c = nullptr, int64_t nbytes = INT64_MAX, IOBufferReader *buf = 0, bool owner = false) override;
@@ -164,6 +175,9 @@ public:
   ink_hrtime ssn_start_time    = 0;
   ink_hrtime ssn_last_txn_time = 0;
 
+  /// Requests in the client buffer that were looked ahead, see HttpPipelineLookahead.
+  int pipeline_lookahead_pending = 0;
+
 protected:
   // Hook dispatching state
   HttpHookState hook_state;
@@ -185,6 +199,9 @@ protected:
   NetVConnection *_vc = nullptr; // The netvc associated with the concrete session class
 
 private:
+  IpAllow::ACL _dst_acl;    ///< ACL of the last destination.
+  IpEndpoint _dst_acl_ip{}; ///< Address @a _dst_acl was matched for.
+
   void handle_api_return(int event);
   int state_api_callout(int event, void *edata);
 
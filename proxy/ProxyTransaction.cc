@@ -130,7 +130,7 @@ ProxyTransaction::clear_session_active()
 const IpAllow::ACL &
 ProxyTransaction::get_acl() const
 {
-  return _proxy_ssn ? _proxy_ssn->acl : IpAllow::DENY_ALL_ACL;
+  return _proxy_ssn ? _proxy_ssn->get_acl() : IpAllow::DENY_ALL_ACL;
 }
 
 // outbound values Set via the server port definition.  Really only used for Http1 at the moment
@@ -140,7 +140,22 @@ reloadUrlRewrite()
   Note("%s loading ...", ts::filename::REMAP);
   Debug("url_rewrite", "%s updated, reloading...", ts::filename::REMAP);
   newTable = new UrlRewrite();
-  if (newTable->load()) {
+
+  // Let the new table keep the plugin instances of the current one that are configured the same way.
+  int reuse_instances = 0;
+  REC_ReadConfigInteger(reuse_instances, "proxy.config.url_remap.reuse_plugin_instances");
+  UrlRewrite *previous = reuse_instances && rewrite_table ? rewrite_table : nullptr;
+  if (previous) {
+    previous->acquire();
+    newTable->pluginFactory.reuseInstancesFrom(&previous->pluginFactory);
+  }
+  bool loaded = newTable->load();
+  if (previous) {
+    newTable->pluginFactory.reuseInstancesFrom(nullptr);
+    previous->release();
+  }
+
+  if (loaded) {
     static const char *msg_format = "%s finished loading";
 
     // Hold at least one lease, until we reload the configuration
@@ -33,6 +33,7 @@
 #include "StatPages.h"
 #include "HdrUtils.h"
 #include "tscore/MatcherUtils.h"
+#include "records/I_RecMetrics.h"
 
 #define MAX_STAT_PAGES 32
 
@@ -46,11 +47,34 @@ static struct {
 
 static int n_stat_pages;
 
+// The stats in the Prometheus text format, from the snapshot taken at the last sync of the stats.
+static Action *
+metrics_page(Continuation *cont, HTTPHdr * /* header ATS_UNUSED */)
+{
+  Ptr<IOBufferData> snapshot = RecMetricsSnapshot();
+
+  if (!snapshot) {
+    cont->handleEvent(STAT_PAGE_FAILURE, nullptr);
+    return ACTION_RESULT_DONE;
+  }
+
+  StatPageData data;
+
+  data.length = snapshot->block_size();
+  data.data   = static_cast<char *>(ats_malloc(data.length));
+  data.type   = ats_strdup(REC_METRICS_CONTENT_TYPE);
+  memcpy(data.data, snapshot->data(), data.length);
+
+  cont->handleEvent(STAT_PAGE_SUCCESS, &data);
+  return ACTION_RESULT_DONE;
+}
+
 void
 StatPagesManager::init()
 {
   ink_mutex_init(&stat_pages_mutex);
   REC_EstablishStaticConfigInt32(m_enabled, "proxy.config.http_ui_enabled");
+  register_http("metrics", metrics_page);
 }
 
 void
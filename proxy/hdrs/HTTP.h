@@ -516,7 +516,7 @@ public:
   void create(HTTPType polarity, HdrHeap *heap = nullptr);
   void clear();
   void reset();
-  void copy(const HTTPHdr *hdr);
+  void copy(const HTTPHdr *hdr, HdrHeapRole role = HDR_HEAP_ROLE_NONE);
   void copy_shallow(const HTTPHdr *hdr);
 
   int unmarshal(char *buf, int len, RefCountObj *block_ref);
@@ -804,14 +804,14 @@ HTTPHdr::reset()
   -------------------------------------------------------------------------*/
 
 inline void
-HTTPHdr::copy(const HTTPHdr *hdr)
+HTTPHdr::copy(const HTTPHdr *hdr, HdrHeapRole role)
 {
   ink_assert(hdr->valid());
 
   if (valid()) {
     http_hdr_copy_onto(hdr->m_http, hdr->m_heap, m_http, m_heap, (m_heap != hdr->m_heap) ? true : false);
   } else {
-    m_heap = new_HdrHeap();
+    m_heap = new_HdrHeap(role);
     m_http = http_hdr_clone(hdr->m_http, hdr->m_heap, m_heap);
     m_mime = m_http->m_fields_impl;
   }
@@ -1494,12 +1494,12 @@ public:
   void
   request_set(const HTTPHdr *req)
   {
-    m_alt->m_request_hdr.copy(req);
+    m_alt->m_request_hdr.copy(req, HDR_HEAP_ROLE_CACHE);
   }
   void
   response_set(const HTTPHdr *resp)
   {
-    m_alt->m_response_hdr.copy(resp);
+    m_alt->m_response_hdr.copy(resp, HDR_HEAP_ROLE_CACHE);
   }
 
   void
@@ -36,12 +36,51 @@
 #include "MIME.h"
 #include "HTTP.h"
 #include "I_EventSystem.h"
+#include "tscore/memory_domain.h"
+
+#include <algorithm>
+#include <atomic>
 
 static constexpr size_t MAX_LOST_STR_SPACE        = 1024;
 static constexpr uint32_t MAX_HDR_HEAP_OBJ_LENGTH = (1 << 20) - 1; ///< m_length is 20 bit
 
+// Heaps come in size classes each with a freelist, anything larger is malloc'd.
 Allocator hdrHeapAllocator("hdrHeap", HdrHeap::DEFAULT_SIZE);
+Allocator hdrHeap4kAllocator("hdrHeap4k", HdrHeap::DEFAULT_SIZE * 2);
+Allocator hdrHeap8kAllocator("hdrHeap8k", HdrHeap::DEFAULT_SIZE * 4);
 Allocator strHeapAllocator("hdrStrHeap", HdrStrHeap::DEFAULT_SIZE);
+Allocator strHeap4kAllocator("hdrStrHeap4k", HdrStrHeap::DEFAULT_SIZE * 2);
+Allocator strHeap8kAllocator("hdrStrHeap8k", HdrStrHeap::DEFAULT_SIZE * 4);
+
+namespace
+{
+/** Recent sizes of the heaps for each role, stretched towards the larger ones.
+
+    A size that comes out larger moves the estimate a quarter of the way up to it, a smaller one only a
+    sixty-fourth of the way down, so the estimate sits near the top of what the role needs and a new
+    heap seldom has to grow. The updates race between threads, which only costs a little accuracy.
+ */
+struct HdrHeapSizeEstimate {
+  std::atomic<int> obj_size{HdrHeap::DEFAULT_SIZE};
+  std::atomic<int> str_size{0};
+
+  static void
+  update(std::atomic<int> &estimate, int observed)
+  {
+    int current = estimate.load(std::memory_order_relaxed);
+    if (observed > current) {
+      estimate.store(current + (observed - current + 3) / 4, std::memory_order_relaxed);
+    } else {
+      estimate.store(current - (current - observed) / 64, std::memory_order_relaxed);
+    }
+  }
+};
+
+HdrHeapSizeEstimate hdr_heap_size_estimate[HDR_HEAP_ROLE_COUNT];
+
+// The largest size class, predictions are capped at it.
+constexpr int HDR_HEAP_MAX_CLASS_SIZE = HdrHeap::DEFAULT_SIZE * 4;
+} // namespace
 
 /*-------------------------------------------------------------------------
   -------------------------------------------------------------------------*/
@@ -93,6 +132,7 @@ HdrHeap::init()
 
   m_next      = nullptr;
   m_free_size = m_size - HDR_HEAP_HDR_SIZE;
+  m_role      = HDR_HEAP_ROLE_NONE;
 
   // We need to clear m_ptr directly since it's garbage and
   //  using the operator functions will to free() what ever
@@ -117,7 +157,12 @@ new_HdrHeap(int size)
   if (size <= HdrHeap::DEFAULT_SIZE) {
     size = HdrHeap::DEFAULT_SIZE;
     h    = static_cast<HdrHeap *>(THREAD_ALLOC(hdrHeapAllocator, this_ethread()));
+  } else if (size == HdrHeap::DEFAULT_SIZE * 2) {
+    h = static_cast<HdrHeap *>(THREAD_ALLOC(hdrHeap4kAllocator, this_ethread()));
+  } else if (size == HdrHeap::DEFAULT_SIZE * 4) {
+    h = static_cast<HdrHeap *>(THREAD_ALLOC(hdrHeap8kAllocator, this_ethread()));
   } else {
+    MemoryDomainScope domain(MEMORY_DOMAIN_HDR_HEAP);
     h = static_cast<HdrHeap *>(ats_malloc(size));
   }
 
@@ -127,6 +172,23 @@ new_HdrHeap(int size)
   return h;
 }
 
+HdrHeap *
+new_HdrHeap(HdrHeapRole role)
+{
+  int size = HdrHeap::DEFAULT_SIZE;
+
+  if (role != HDR_HEAP_ROLE_NONE) {
+    int wanted = hdr_heap_size_estimate[role].obj_size.load(std::memory_order_relaxed);
+    while (size < wanted && size < HDR_HEAP_MAX_CLASS_SIZE) {
+      size *= 2;
+    }
+  }
+
+  HdrHeap *h = new_HdrHeap(size);
+  h->m_role  = role;
+  return h;
+}
+
 HdrStrHeap *
 new_HdrStrHeap(int requested_size)
 {
@@ -143,7 +205,14 @@ new_HdrStrHeap(int requested_size)
     sh         = static_cast<HdrStrHeap *>(THREAD_ALLOC(strHeapAllocator, this_ethread()));
   } else {
     alloc_size = ts::round_up<HdrStrHeap::DEFAULT_SIZE * 2>(alloc_size);
-    sh         = static_cast<HdrStrHeap *>(ats_malloc(alloc_size));
+    if (alloc_size == HdrStrHeap::DEFAULT_SIZE * 2) {
+      sh = static_cast<HdrStrHeap *>(THREAD_ALLOC(strHeap4kAllocator, this_ethread()));
+    } else if (alloc_size == HdrStrHeap::DEFAULT_SIZE * 4) {
+      sh = static_cast<HdrStrHeap *>(THREAD_ALLOC(strHeap8kAllocator, this_ethread()));
+    } else {
+      MemoryDomainScope domain(MEMORY_DOMAIN_HDR_HEAP);
+      sh = static_cast<HdrStrHeap *>(ats_malloc(alloc_size));
+    }
   }
 
   //    Debug("hdrs", "Allocated string heap in size %d", alloc_size);
@@ -165,6 +234,20 @@ new_HdrStrHeap(int requested_size)
 void
 HdrHeap::destroy()
 {
+  if (m_role != HDR_HEAP_ROLE_NONE) {
+    // What the heap ended up needing, overflow heaps and string heaps included.
+    int obj_size = 0;
+    for (HdrHeap *h = this; h; h = h->m_next) {
+      obj_size += h->m_size - h->m_free_size;
+    }
+    int str_size = m_read_write_heap ? m_read_write_heap->m_heap_size - m_read_write_heap->m_free_size : 0;
+    for (auto &i : m_ronly_heap) {
+      str_size += i.m_heap_len;
+    }
+    HdrHeapSizeEstimate::update(hdr_heap_size_estimate[m_role].obj_size, obj_size);
+    HdrHeapSizeEstimate::update(hdr_heap_size_estimate[m_role].str_size, str_size);
+  }
+
   if (m_next) {
     m_next->destroy();
   }
@@ -176,11 +259,32 @@ HdrHeap::destroy()
 
   if (m_size == HdrHeap::DEFAULT_SIZE) {
     THREAD_FREE(this, hdrHeapAllocator, this_thread());
+  } else if (m_size == HdrHeap::DEFAULT_SIZE * 2) {
+    THREAD_FREE(this, hdrHeap4kAllocator, this_thread());
+  } else if (m_size == HdrHeap::DEFAULT_SIZE * 4) {
+    THREAD_FREE(this, hdrHeap8kAllocator, this_thread());
   } else {
     ats_free(this);
   }
 }
 
+void
+HdrHeap::reset()
+{
+  if (m_next) {
+    m_next->destroy();
+  }
+
+  m_read_write_heap = nullptr;
+  for (auto &i : m_ronly_heap) {
+    i.m_ref_count_ptr = nullptr;
+  }
+
+  HdrHeapRole role = m_role;
+  init();
+  m_role = role;
+}
+
 HdrHeapObjImpl *
 HdrHeap::allocate_obj(int nbytes, int type)
 {
@@ -253,7 +357,12 @@ RETRY:
   // First check to see if we have a read/write
   //   string heap
   if (!m_read_write_heap) {
-    int next_size     = (last_size * 2) - sizeof(HdrStrHeap);
+    int next_size = (last_size * 2) - sizeof(HdrStrHeap);
+    if (last_size == 0 && m_role != HDR_HEAP_ROLE_NONE) {
+      // The first one, as large as the role has been needing
+      next_size = std::min(hdr_heap_size_estimate[m_role].str_size.load(std::memory_order_relaxed), HDR_HEAP_MAX_CLASS_SIZE) -
+                  static_cast<int>(sizeof(HdrStrHeap));
+    }
     next_size         = next_size > nbytes ? next_size : nbytes;
     m_read_write_heap = new_HdrStrHeap(next_size);
   }
@@ -298,6 +407,23 @@ HdrHeap::expand_str(const char *old_str, int old_len, int new_len)
   return nullptr;
 }
 
+// void HdrHeap::shrink_str(const char* str, int old_len, int new_len)
+//
+//   Gives back the end of a string, for one allocated before
+//     its length was known.  Space that can't be reused is
+//     counted as lost.
+//
+void
+HdrHeap::shrink_str(const char *str, int old_len, int new_len)
+{
+  ink_assert(new_len <= old_len);
+
+  if (!(m_read_write_heap && m_read_write_heap->contains(str) &&
+        m_read_write_heap->shrink(const_cast<char *>(str), old_len, new_len))) {
+    free_string(str + new_len, old_len - new_len);
+  }
+}
+
 // char* HdrHeap::duplicate_str(char* str, int nbytes)
 //
 //  Allocates a new string and copies the old data.
@@ -611,6 +737,89 @@ compute_checksum(void *buf, int len)
 }
 #endif
 
+bool
+HdrHeap::is_unmarshaled_in_place() const
+{
+  const char *base = reinterpret_cast<const char *>(this);
+
+  if (m_magic != HDR_BUF_MAGIC_ALIVE || m_writeable || m_next != nullptr || m_read_write_heap ||
+      m_data_start != base + HDR_HEAP_HDR_SIZE || m_free_start != base + m_size || m_ronly_heap[0].m_heap_start != base + m_size) {
+    return false;
+  }
+  for (unsigned i = 1; i < HDR_BUF_RONLY_HEAPS; ++i) {
+    if (m_ronly_heap[i].m_heap_start != nullptr) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Marshals a heap that is still where unmarshal put it, as in an
+//   alternate vector being written back. Its objects and strings are
+//   already in the marshaled layout, so the heap is copied whole and
+//   unmarshal is run again with the offset negated to turn the pointers
+//   back into offsets, no translation tables needed.
+static int
+marshal_unmarshaled_heap(const HdrHeap *heap, char *buf, int len)
+{
+  int size = heap->unmarshal_size();
+  int used = HdrHeapMarshalBlocks(ts::round_up(size));
+
+  if (used > len) {
+    return -1;
+  }
+  memcpy(buf, heap, size);
+
+  HdrHeap *marshal_hdr      = reinterpret_cast<HdrHeap *>(buf);
+  marshal_hdr->m_magic      = HDR_BUF_MAGIC_MARSHALED;
+  marshal_hdr->m_free_start = nullptr;
+  marshal_hdr->m_data_start = reinterpret_cast<char *>(HDR_HEAP_HDR_SIZE.value()); // offset
+  marshal_hdr->m_role       = HDR_HEAP_ROLE_NONE;
+  // The copy holds the ref count pointer bit for bit, it must not let go of it.
+  marshal_hdr->m_ronly_heap[0].m_ref_count_ptr.detach();
+  marshal_hdr->m_ronly_heap[0].m_heap_start = reinterpret_cast<char *>(static_cast<intptr_t>(heap->m_size)); // offset
+
+  char *obj_data  = buf + HDR_HEAP_HDR_SIZE;
+  char *obj_end   = buf + heap->m_size;
+  intptr_t offset = -reinterpret_cast<intptr_t>(heap);
+
+  while (obj_data < obj_end) {
+    HdrHeapObjImpl *obj = reinterpret_cast<HdrHeapObjImpl *>(obj_data);
+    ink_release_assert(0 != obj->m_length);
+
+    switch (obj->m_type) {
+    case HDR_HEAP_OBJ_HTTP_HEADER:
+      ((HTTPHdrImpl *)obj)->unmarshal(offset);
+      break;
+    case HDR_HEAP_OBJ_URL:
+      ((URLImpl *)obj)->unmarshal(offset);
+      break;
+    case HDR_HEAP_OBJ_FIELD_BLOCK:
+      ((MIMEFieldBlockImpl *)obj)->unmarshal(offset);
+      break;
+    case HDR_HEAP_OBJ_MIME_HEADER:
+      ((MIMEHdrImpl *)obj)->unmarshal(offset);
+      break;
+    case HDR_HEAP_OBJ_EMPTY:
+      break;
+    default:
+      marshal_hdr->m_magic = HDR_BUF_MAGIC_CORRUPT;
+      return -1;
+    }
+
+    obj_data = obj_data + obj->m_length;
+  }
+
+#ifdef HDR_HEAP_CHECKSUMS
+  {
+    uint32_t chksum           = compute_checksum(buf, used);
+    marshal_hdr->m_free_start = (char *)chksum;
+  }
+#endif
+
+  return used;
+}
+
 // int HdrHeap::marshal(char* buf, int len)
 //
 //   Creates a marshalled representation of the contents
@@ -626,6 +835,10 @@ HdrHeap::marshal(char *buf, int len)
 {
   ink_assert((((uintptr_t)buf) & HDR_PTR_ALIGNMENT_MASK) == 0);
 
+  if (is_unmarshaled_in_place()) {
+    return marshal_unmarshaled_heap(this, buf, len);
+  }
+
   HdrHeap *marshal_hdr = reinterpret_cast<HdrHeap *>(buf);
   char *b              = buf + HDR_HEAP_HDR_SIZE;
 
@@ -685,6 +898,7 @@ HdrHeap::marshal(char *buf, int len)
   marshal_hdr->m_data_start = reinterpret_cast<char *>(HDR_HEAP_HDR_SIZE.value()); // offset
   marshal_hdr->m_magic      = HDR_BUF_MAGIC_MARSHALED;
   marshal_hdr->m_writeable  = false;
+  marshal_hdr->m_role       = HDR_HEAP_ROLE_NONE;
   marshal_hdr->m_size       = ptr_heap_size + HDR_HEAP_HDR_SIZE;
   marshal_hdr->m_next       = nullptr;
   marshal_hdr->m_free_size  = 0;
@@ -918,6 +1132,9 @@ HdrHeap::unmarshal(int buf_length, int obj_type, HdrHeapObjImpl **found_obj, Ref
 
   ink_assert(m_free_start == nullptr);
 
+  // Older caches left whatever was in the padding here.
+  m_role = HDR_HEAP_ROLE_NONE;
+
   // Convert Heap offsets to pointers
   m_data_start                 = (reinterpret_cast<char *>(this)) + (intptr_t)m_data_start;
   m_free_start                 = (reinterpret_cast<char *>(this)) + m_size;
@@ -1095,6 +1312,42 @@ HdrHeap::inherit_string_heaps(const HdrHeap *inherit_from)
   return;
 }
 
+// bool HdrHeap::share_str_heap(HdrStrHeap* str_heap)
+//
+//    Takes the used part of str_heap as a read-only string
+//     heap, so strings in it can be set on our objects
+//     without being copied.  Returns false if all the
+//     read-only slots are taken.
+//
+bool
+HdrHeap::share_str_heap(HdrStrHeap *str_heap)
+{
+  const char *start = reinterpret_cast<const char *>(str_heap + 1);
+  int len           = str_heap->m_heap_size - sizeof(HdrStrHeap) - str_heap->m_free_size;
+  int first_free    = HDR_BUF_RONLY_HEAPS;
+
+  ink_assert(m_writeable);
+
+  for (unsigned index = 0; index < HDR_BUF_RONLY_HEAPS; ++index) {
+    if (m_ronly_heap[index].m_heap_start == start) {
+      ink_assert(m_ronly_heap[index].m_ref_count_ptr.object() == str_heap);
+      if (len > m_ronly_heap[index].m_heap_len) {
+        m_ronly_heap[index].m_heap_len = len;
+      }
+      return true;
+    }
+    if (m_ronly_heap[index].m_heap_start == nullptr && first_free == HDR_BUF_RONLY_HEAPS) {
+      first_free = index;
+    }
+  }
+
+  if (first_free == HDR_BUF_RONLY_HEAPS) {
+    return false;
+  }
+
+  return attach_str_heap(start, len, str_heap, &first_free);
+}
+
 // void HdrHeap::dump_heap(int len)
 //
 //   Debugging function to dump the heap in hex
@@ -1159,6 +1412,10 @@ HdrStrHeap::free()
 {
   if (m_heap_size == HdrStrHeap::DEFAULT_SIZE) {
     THREAD_FREE(this, strHeapAllocator, this_thread());
+  } else if (m_heap_size == HdrStrHeap::DEFAULT_SIZE * 2) {
+    THREAD_FREE(this, strHeap4kAllocator, this_thread());
+  } else if (m_heap_size == HdrStrHeap::DEFAULT_SIZE * 4) {
+    THREAD_FREE(this, strHeap8kAllocator, this_thread());
   } else {
     ats_free(this);
   }
@@ -1184,6 +1441,27 @@ HdrStrHeap::allocate(int nbytes)
   }
 }
 
+// bool HdrStrHeap::shrink(char* ptr, int old_size, int new_size)
+//
+//   Try to give back the end of str in the heap, which
+//     works if it is the last string.  Returns whether
+//     it did.
+//
+bool
+HdrStrHeap::shrink(char *ptr, int old_size, int new_size)
+{
+  ink_assert(ptr >= reinterpret_cast<char const *>(this + 1));
+  ink_assert(ptr < reinterpret_cast<char const *>(this) + m_heap_size);
+
+  if (ptr + old_size == m_free_start) {
+    m_free_start -= old_size - new_size;
+    m_free_size += old_size - new_size;
+    return true;
+  } else {
+    return false;
+  }
+}
+
 // char* HdrStrHeap::expand(char* ptr, int old_size, int new_size)
 //
 //   Try to expand str in the heap.  If we succeed to
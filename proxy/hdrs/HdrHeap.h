@@ -53,6 +53,15 @@ static constexpr unsigned HDR_BUF_RONLY_HEAPS = 3;
 class CoreUtils;
 class IOBufferBlock;
 
+/// What a heap is for. Heaps with a role start out at the size that heaps for it have been needing.
+enum HdrHeapRole : uint8_t {
+  HDR_HEAP_ROLE_NONE = 0,
+  HDR_HEAP_ROLE_CLIENT_REQUEST,
+  HDR_HEAP_ROLE_SERVER_RESPONSE,
+  HDR_HEAP_ROLE_CACHE,
+  HDR_HEAP_ROLE_COUNT
+};
+
 enum {
   HDR_HEAP_OBJ_EMPTY            = 0,
   HDR_HEAP_OBJ_RAW              = 1,
@@ -137,6 +146,7 @@ public:
 
   char *allocate(int nbytes);
   char *expand(char *ptr, int old_size, int new_size);
+  bool shrink(char *ptr, int old_size, int new_size);
   int space_avail();
 
   uint32_t m_heap_size;
@@ -176,6 +186,8 @@ public:
 
   void init();
   inkcoreapi void destroy();
+  /// Empty the heap for the next header, freeing what is chained to it but not the heap itself.
+  void reset();
 
   // PtrHeap allocation
   HdrHeapObjImpl *allocate_obj(int nbytes, int type);
@@ -184,12 +196,16 @@ public:
   // StrHeap allocation
   char *allocate_str(int nbytes);
   char *expand_str(const char *old_str, int old_len, int new_len);
+  void shrink_str(const char *str, int old_len, int new_len);
   char *duplicate_str(const char *str, int nbytes);
   void free_string(const char *s, int len);
+  bool is_shared_str(const char *s) const;
 
   // Marshalling
   inkcoreapi int marshal_length();
   inkcoreapi int marshal(char *buf, int length);
+  /// Whether the heap is still laid out the way @c unmarshal left it, objects and strings in one block.
+  bool is_unmarshaled_in_place() const;
   int unmarshal(int buf_length, int obj_type, HdrHeapObjImpl **found_obj, RefCountObj *block_ref);
   /// Computes the valid data size of an unmarshalled instance.
   /// Callers should round up to HDR_PTR_SIZE to get the actual footprint.
@@ -197,6 +213,7 @@ public:
   // One option - overload marshal_length to return this value if @a magic is HDR_BUF_MAGIC_MARSHALED.
 
   void inherit_string_heaps(const HdrHeap *inherit_from);
+  bool share_str_heap(HdrStrHeap *str_heap);
   int attach_block(IOBufferBlock *b, const char *use_start);
   void set_ronly_str_heap_end(int slot, const char *end);
 
@@ -266,6 +283,7 @@ public:
   uint32_t m_size;
 
   bool m_writeable;
+  HdrHeapRole m_role; // In the padding after m_writeable, the marshaled layout is unchanged.
 
   // Overflow block ptr
   //   Overflow blocks are necessary because we can
@@ -328,11 +346,30 @@ static constexpr size_t HDR_MAX_ALLOC_SIZE = HdrHeap::DEFAULT_SIZE - HDR_HEAP_HD
 inline void
 HdrHeap::free_string(const char *s, int len)
 {
-  if (s && len > 0) {
+  if (s && len > 0 && !is_shared_str(s)) {
     m_lost_string_space += len;
   }
 }
 
+/* A string heap inherited by a header copy is shared by both headers until one of them lets go,
+   and a coalesce of either one frees none of its space. Strings dropped from such a heap are not
+   lost space, counting them would only force the copies on the forward path to duplicate every
+   string they still share with the header they came from.
+*/
+inline bool
+HdrHeap::is_shared_str(const char *s) const
+{
+  if (m_read_write_heap && m_read_write_heap->contains(s)) {
+    return m_read_write_heap->refcount() > 1;
+  }
+  for (auto const &ronly : m_ronly_heap) {
+    if (ronly.contains(s)) {
+      return ronly.m_ref_count_ptr && ronly.m_ref_count_ptr->refcount() > 1;
+    }
+  }
+  return false;
+}
+
 inline int
 HdrHeap::unmarshal_size() const
 {
@@ -503,5 +540,7 @@ HdrHeapSDKHandle::set(const HdrHeapSDKHandle *from)
 
 HdrStrHeap *new_HdrStrHeap(int requested_size);
 inkcoreapi HdrHeap *new_HdrHeap(int size = HdrHeap::DEFAULT_SIZE);
+/// A heap for @a role, sized so that most headers for it fit without overflow heaps or a second string heap.
+inkcoreapi HdrHeap *new_HdrHeap(HdrHeapRole role);
 
 void hdr_heap_test();
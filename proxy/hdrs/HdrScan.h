@@ -0,0 +1,195 @@
+/** @file
+
+  Scanning header text many bytes at a time.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  @section details Details
+
+  Scans of request text that used to go one character at a time through the @c ParseRules tables.
+  Each checks a whole vector of input per step, with AVX2, SSE2 or NEON depending on the build, and
+  uses the table only for a tail shorter than a vector, so the result is always what the table
+  gives. Lines and the ':' of a field are found with @c memchr, which the C library already does a
+  vector at a time.
+ */
+
+#pragma once
+
+#include "tscore/ParseRules.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace hdr_scan_detail
+{
+#if defined(__AVX2__)
+using Vec                   = __m256i;
+static constexpr int VEC_SZ = 32;
+
+inline Vec
+load(const char *s)
+{
+  return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(s));
+}
+
+inline Vec
+eq(Vec v, char c)
+{
+  return _mm256_cmpeq_epi8(v, _mm256_set1_epi8(c));
+}
+
+// Bytes outside [lo, hi], both in 0x00 - 0x7F. Bytes with the top bit set are negative and out of range.
+inline Vec
+outside(Vec v, char lo, char hi)
+{
+  return _mm256_or_si256(_mm256_cmpgt_epi8(_mm256_set1_epi8(lo), v), _mm256_cmpgt_epi8(v, _mm256_set1_epi8(hi)));
+}
+
+inline Vec
+vor(Vec a, Vec b)
+{
+  return _mm256_or_si256(a, b);
+}
+
+// Offset of the first marked byte, or -1.
+inline int
+first(Vec m)
+{
+  unsigned bits = _mm256_movemask_epi8(m);
+  return bits ? __builtin_ctz(bits) : -1;
+}
+#elif defined(__SSE2__)
+using Vec                   = __m128i;
+static constexpr int VEC_SZ = 16;
+
+inline Vec
+load(const char *s)
+{
+  return _mm_loadu_si128(reinterpret_cast<const __m128i *>(s));
+}
+
+inline Vec
+eq(Vec v, char c)
+{
+  return _mm_cmpeq_epi8(v, _mm_set1_epi8(c));
+}
+
+inline Vec
+outside(Vec v, char lo, char hi)
+{
+  return _mm_or_si128(_mm_cmplt_epi8(v, _mm_set1_epi8(lo)), _mm_cmpgt_epi8(v, _mm_set1_epi8(hi)));
+}
+
+inline Vec
+vor(Vec a, Vec b)
+{
+  return _mm_or_si128(a, b);
+}
+
+inline int
+first(Vec m)
+{
+  unsigned bits = _mm_movemask_epi8(m);
+  return bits ? __builtin_ctz(bits) : -1;
+}
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+using Vec                   = uint8x16_t;
+static constexpr int VEC_SZ = 16;
+
+inline Vec
+load(const char *s)
+{
+  return vld1q_u8(reinterpret_cast<const uint8_t *>(s));
+}
+
+inline Vec
+eq(Vec v, char c)
+{
+  return vceqq_u8(v, vdupq_n_u8(static_cast<uint8_t>(c)));
+}
+
+inline Vec
+outside(Vec v, char lo, char hi)
+{
+  return vorrq_u8(vcltq_u8(v, vdupq_n_u8(static_cast<uint8_t>(lo))), vcgtq_u8(v, vdupq_n_u8(static_cast<uint8_t>(hi))));
+}
+
+inline Vec
+vor(Vec a, Vec b)
+{
+  return vorrq_u8(a, b);
+}
+
+// No movemask on NEON, narrow each byte of the mask to a nibble instead.
+inline int
+first(Vec m)
+{
+  uint64_t bits = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(m), 4)), 0);
+  return bits ? __builtin_ctzll(bits) >> 2 : -1;
+}
+#endif
+} // namespace hdr_scan_detail
+
+/// The first character in [@a s, @a e) that @c ParseRules::is_uri rejects, or @a e.
+inline const char *
+hdr_scan_non_uri(const char *s, const char *e)
+{
+#if defined(__SSE2__) || (defined(__aarch64__) && defined(__ARM_NEON))
+  using namespace hdr_scan_detail;
+  // URI characters are the printable ones except these.
+  for (; e - s >= VEC_SZ; s += VEC_SZ) {
+    Vec v   = load(s);
+    Vec bad = vor(vor(vor(outside(v, 0x21, 0x7E), eq(v, '"')), vor(eq(v, '<'), eq(v, '>'))),
+                  vor(vor(vor(eq(v, '\\'), eq(v, '^')), vor(eq(v, '`'), eq(v, '{'))), vor(eq(v, '|'), eq(v, '}'))));
+    int n   = first(bad);
+    if (n >= 0) {
+      return s + n;
+    }
+  }
+#endif
+  while (s < e && ParseRules::is_uri(*s)) {
+    ++s;
+  }
+  return s;
+}
+
+/// The first ';', '?' or '#' in [@a s, @a e), or @a e.
+inline const char *
+hdr_scan_path_end(const char *s, const char *e)
+{
+#if defined(__SSE2__) || (defined(__aarch64__) && defined(__ARM_NEON))
+  using namespace hdr_scan_detail;
+  for (; e - s >= VEC_SZ; s += VEC_SZ) {
+    Vec v = load(s);
+    int n = first(vor(vor(eq(v, ';'), eq(v, '?')), eq(v, '#')));
+    if (n >= 0) {
+      return s + n;
+    }
+  }
+#endif
+  while (s < e && *s != ';' && *s != '?' && *s != '#') {
+    ++s;
+  }
+  return s;
+}
@@ -22,7 +22,6 @@
  */
 
 #include "tscore/ink_platform.h"
-#include "tscore/HashFNV.h"
 #include "tscore/Diags.h"
 #include "tscore/ink_memory.h"
 #include <cstdio>
@@ -30,24 +29,12 @@
 #include "HTTP.h"
 #include "HdrToken.h"
 #include "MIME.h"
-#include "tscore/Regex.h"
 #include "URL.h"
 
-/*
- You SHOULD add to _hdrtoken_commonly_tokenized_strs, with the same ordering
- ** important, ordering matters **
-
- You want a regexp like 'Accept' after "greedier" choices so it doesn't match 'Accept-Ranges' earlier than
- it should. The regexp are anchored (^Accept), but I dont see a way with the current system to
- match the word ONLY without making _hdrtoken_strs a real PCRE, but then that breaks the hashing
- hdrtoken_hash("^Accept$") != hdrtoken_hash("Accept")
-
- So, the current hack is to have "Accept" follow "Accept-.*", lame, I know
-
-  /ericb
-*/
-
-static const char *_hdrtoken_strs[] = {
+// WARNING:  Indexes into this array are stored on disk for cached objects.  New strings must be added at the end of the array to
+// avoid changing the indexes of pre-existing entries, unless the cache format version number is increased.
+//
+static constexpr const char *_hdrtoken_strs[] = {
   // MIME Field names
   "Accept-Charset", "Accept-Encoding", "Accept-Language", "Accept-Ranges", "Accept", "Age", "Allow",
   "Approved", // NNTP
@@ -256,153 +243,143 @@ int32_t hdrtoken_str_slotids[SIZEOF(_hdrtoken_strs)];          // wks_idx -> slo
 uint64_t hdrtoken_str_masks[SIZEOF(_hdrtoken_strs)];           // wks_idx -> presence mask
 uint32_t hdrtoken_str_flags[SIZEOF(_hdrtoken_strs)];           // wks_idx -> flags
 
-DFA *hdrtoken_strs_dfa = nullptr;
-
 /***********************************************************************
  *                                                                     *
- *                        H A S H    T A B L E                         *
+ *                    P E R F E C T    H A S H                         *
  *                                                                     *
  ***********************************************************************/
 
-#define HDRTOKEN_HASH_TABLE_SIZE 65536
-
-struct HdrTokenHashBucket {
-  const char *wks;
-  uint32_t hash;
-};
-
-HdrTokenHashBucket hdrtoken_hash_table[HDRTOKEN_HASH_TABLE_SIZE];
+// A minimal perfect hash over _hdrtoken_strs, worked out by the compiler.
+//
+// One pass of a case folding 64 bit FNV-1a gives a bucket from the high
+// half and, mixed with the displacement found for that bucket, a slot from
+// the low half. The displacements are searched bucket by bucket, largest
+// bucket first, until every string has a slot of its own, so a lookup is
+// one hash, one table load and one compare. A list of strings no
+// displacement can separate fails the build.
+
+namespace
+{
+constexpr unsigned HDRTOKEN_HASH_BUCKETS = 64;
+constexpr unsigned HDRTOKEN_HASH_SLOTS   = 256;
+constexpr unsigned HDRTOKEN_NUM_WKS      = SIZEOF(_hdrtoken_strs);
 
-/**
-  basic FNV hash
-**/
-#define TINY_MASK(x) (((uint32_t)1 << (x)) - 1)
+static_assert(HDRTOKEN_NUM_WKS < HDRTOKEN_HASH_SLOTS, "too many well known strings for the hash table");
 
-inline uint32_t
-hash_to_slot(uint32_t hash)
+constexpr uint64_t
+hdrtoken_hash(const char *string, unsigned int length)
 {
-  return ((hash >> 15) ^ hash) & TINY_MASK(15);
+  uint64_t hash = 14695981039346656037ULL;
+  for (unsigned int i = 0; i < length; ++i) {
+    char c = string[i];
+    hash   = (hash ^ static_cast<unsigned char>((c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c)) * 1099511628211ULL;
+  }
+  return hash;
 }
 
-inline uint32_t
-hdrtoken_hash(const unsigned char *string, unsigned int length)
+constexpr unsigned
+hdrtoken_hash_bucket(uint64_t hash)
 {
-  ATSHash32FNV1a fnv;
-  fnv.update(string, length, ATSHash::nocase());
-  fnv.final();
-  return fnv.get();
+  return (hash >> 32) & (HDRTOKEN_HASH_BUCKETS - 1);
 }
 
-/*-------------------------------------------------------------------------
-  -------------------------------------------------------------------------*/
-
-// WARNING:  Indexes into this array are stored on disk for cached objects.  New strings must be added at the end of the array to
-// avoid changing the indexes of pre-existing entries, unless the cache format version number is increased.
-//
-static const char *_hdrtoken_commonly_tokenized_strs[] = {
-  // MIME Field names
-  "Accept-Charset", "Accept-Encoding", "Accept-Language", "Accept-Ranges", "Accept", "Age", "Allow",
-  "Approved", // NNTP
-  "Authorization",
-  "Bytes", // NNTP
-  "Cache-Control", "Client-ip", "Connection", "Content-Base", "Content-Encoding", "Content-Language", "Content-Length",
-  "Content-Location", "Content-MD5", "Content-Range", "Content-Type",
-  "Control", // NNTP
-  "Cookie", "Date",
-  "Distribution", // NNTP
-  "Etag", "Expect", "Expires",
-  "Followup-To", // NNTP
-  "From", "Host", "If-Match", "If-Modified-Since", "If-None-Match", "If-Range", "If-Unmodified-Since", "Keep-Alive",
-  "Keywords", // NNTP
-  "Last-Modified",
-  "Lines", // NNTP
-  "Location", "Max-Forwards",
-  "Message-ID", // NNTP
-  "MIME-Version",
-  "Newsgroups",   // NNTP
-  "Organization", // NNTP
-  "Path",         // NNTP
-  "Pragma", "Proxy-Authenticate", "Proxy-Authorization", "Proxy-Connection", "Public", "Range",
-  "References", // NNTP
-  "Referer",
-  "Reply-To", // NNTP
-  "Retry-After",
-  "Sender", // NNTP
-  "Server", "Set-Cookie",
-  "Subject", // NNTP
-  "Summary", // NNTP
-  "Transfer-Encoding", "Upgrade", "User-Agent", "Vary", "Via", "Warning", "Www-Authenticate",
-  "Xref",          // NNTP
-  "@Ats-Internal", // Internal Hack
-
-  // Accept-Encoding
-  "compress", "deflate", "gzip", "identity",
-
-  // Cache-Control flags
-  "max-age", "max-stale", "min-fresh", "must-revalidate", "no-cache", "no-store", "no-transform", "only-if-cached", "private",
-  "proxy-revalidate", "s-maxage", "need-revalidate-once",
+constexpr unsigned
+hdrtoken_hash_slot(uint64_t hash, uint32_t displacement)
+{
+  uint32_t x = static_cast<uint32_t>(hash) ^ displacement;
+  x ^= x >> 16;
+  x *= 0x85ebca6b;
+  x ^= x >> 13;
+  x *= 0xc2b2ae35;
+  x ^= x >> 16;
+  return x & (HDRTOKEN_HASH_SLOTS - 1);
+}
 
-  // HTTP miscellaneous
-  "none", "chunked", "close",
+constexpr unsigned
+const_strlen(const char *s)
+{
+  unsigned n = 0;
+  while (s[n]) {
+    ++n;
+  }
+  return n;
+}
 
-  // WS
-  "websocket", "Sec-WebSocket-Key", "Sec-WebSocket-Version",
+struct HdrTokenPerfectHash {
+  uint32_t displacement[HDRTOKEN_HASH_BUCKETS] = {};
+  int16_t wks_idx[HDRTOKEN_HASH_SLOTS]         = {}; ///< -1 for an empty slot.
+  bool complete                                = false;
+};
 
-  // HTTP/2 cleartext
-  MIME_UPGRADE_H2C_TOKEN, "HTTP2-Settings",
+constexpr HdrTokenPerfectHash
+hdrtoken_perfect_hash_build()
+{
+  constexpr unsigned BUCKET_MAX = 16;
 
-  // URL schemes
-  "file", "ftp", "gopher", "https", "http", "mailto", "news", "nntp", "prospero", "telnet", "tunnel", "wais", "pnm", "rtspu",
-  "rtsp", "mmsu", "mmst", "mms", "wss", "ws",
+  HdrTokenPerfectHash table{};
+  uint64_t hashes[HDRTOKEN_NUM_WKS]                      = {};
+  unsigned members[HDRTOKEN_HASH_BUCKETS][BUCKET_MAX]    = {};
+  unsigned bucket_size[HDRTOKEN_HASH_BUCKETS]            = {};
+  unsigned max_bucket_size                               = 0;
 
-  // HTTP methods
-  "CONNECT", "DELETE", "GET", "POST", "HEAD", "OPTIONS", "PURGE", "PUT", "TRACE", "PUSH",
+  for (unsigned i = 0; i < HDRTOKEN_HASH_SLOTS; ++i) {
+    table.wks_idx[i] = -1;
+  }
+  for (unsigned i = 0; i < HDRTOKEN_NUM_WKS; ++i) {
+    hashes[i]       = hdrtoken_hash(_hdrtoken_strs[i], const_strlen(_hdrtoken_strs[i]));
+    unsigned bucket = hdrtoken_hash_bucket(hashes[i]);
+    if (bucket_size[bucket] == BUCKET_MAX) {
+      return table;
+    }
+    members[bucket][bucket_size[bucket]++] = i;
+    max_bucket_size                        = bucket_size[bucket] > max_bucket_size ? bucket_size[bucket] : max_bucket_size;
+  }
 
-  // Header extensions
-  "X-ID", "X-Forwarded-For", "TE", "Strict-Transport-Security", "100-continue",
+  for (unsigned size = max_bucket_size; size > 0; --size) {
+    for (unsigned bucket = 0; bucket < HDRTOKEN_HASH_BUCKETS; ++bucket) {
+      if (bucket_size[bucket] != size) {
+        continue;
+      }
+      unsigned slots[BUCKET_MAX] = {};
+      bool placed                = false;
+      for (uint32_t displacement = 0; !placed && displacement < 0x10000; ++displacement) {
+        placed = true;
+        for (unsigned i = 0; placed && i < size; ++i) {
+          slots[i] = hdrtoken_hash_slot(hashes[members[bucket][i]], displacement);
+          placed   = table.wks_idx[slots[i]] < 0;
+          for (unsigned j = 0; placed && j < i; ++j) {
+            placed = slots[j] != slots[i];
+          }
+        }
+        if (placed) {
+          table.displacement[bucket] = displacement;
+        }
+      }
+      if (!placed) {
+        return table;
+      }
+      for (unsigned i = 0; i < size; ++i) {
+        table.wks_idx[slots[i]] = static_cast<int16_t>(members[bucket][i]);
+      }
+    }
+  }
 
-  // RFC-2739
-  "Forwarded",
+  table.complete = true;
+  return table;
+}
 
-  // RFC-8470
-  "Early-Data"};
+constexpr HdrTokenPerfectHash hdrtoken_perfect_hash = hdrtoken_perfect_hash_build();
 
-/*-------------------------------------------------------------------------
-  -------------------------------------------------------------------------*/
+static_assert(hdrtoken_perfect_hash.complete, "no perfect hash found for _hdrtoken_strs, change the slot mixing");
 
-void
-hdrtoken_hash_init()
+// The index of the well known string @a string might be, or -1 if it can't be one.
+inline int
+hdrtoken_perfect_hash_find(const char *string, int string_len)
 {
-  uint32_t i;
-  int num_collisions;
-
-  memset(hdrtoken_hash_table, 0, sizeof(hdrtoken_hash_table));
-  num_collisions = 0;
-
-  for (i = 0; i < static_cast<int> SIZEOF(_hdrtoken_commonly_tokenized_strs); i++) {
-    // convert the common string to the well-known token
-    unsigned const char *wks;
-    int wks_idx =
-      hdrtoken_tokenize_dfa(_hdrtoken_commonly_tokenized_strs[i], static_cast<int>(strlen(_hdrtoken_commonly_tokenized_strs[i])),
-                            reinterpret_cast<const char **>(&wks));
-    ink_release_assert(wks_idx >= 0);
-
-    uint32_t hash = hdrtoken_hash(wks, hdrtoken_str_lengths[wks_idx]);
-    uint32_t slot = hash_to_slot(hash);
-
-    if (hdrtoken_hash_table[slot].wks) {
-      printf("ERROR: hdrtoken_hash_table[%u] collision: '%s' replacing '%s'\n", slot, reinterpret_cast<const char *>(wks),
-             hdrtoken_hash_table[slot].wks);
-      ++num_collisions;
-    }
-    hdrtoken_hash_table[slot].wks  = reinterpret_cast<const char *>(wks);
-    hdrtoken_hash_table[slot].hash = hash;
-  }
-
-  if (num_collisions > 0) {
-    abort();
-  }
+  uint64_t hash = hdrtoken_hash(string, string_len);
+  return hdrtoken_perfect_hash.wks_idx[hdrtoken_hash_slot(hash, hdrtoken_perfect_hash.displacement[hdrtoken_hash_bucket(hash)])];
 }
+} // namespace
 
 /***********************************************************************
  *                                                                     *
@@ -432,9 +409,6 @@ hdrtoken_init()
   if (!inited) {
     inited = 1;
 
-    hdrtoken_strs_dfa = new DFA;
-    hdrtoken_strs_dfa->compile(_hdrtoken_strs, SIZEOF(_hdrtoken_strs), (RE_CASE_INSENSITIVE));
-
     // all the tokenized hdrtoken strings are placed in a special heap,
     // and each string is prepended with a HdrTokenHeapPrefix ---
     // this makes it easy to tell that a string is a tokenized
@@ -485,8 +459,8 @@ hdrtoken_init()
       int wks_idx;
       HdrTokenHeapPrefix *prefix;
 
-      wks_idx = hdrtoken_tokenize_dfa(_hdrtoken_strs_type_initializers[i].name,
-                                      static_cast<int>(strlen(_hdrtoken_strs_type_initializers[i].name)));
+      wks_idx = hdrtoken_tokenize(_hdrtoken_strs_type_initializers[i].name,
+                                  static_cast<int>(strlen(_hdrtoken_strs_type_initializers[i].name)));
 
       ink_assert((wks_idx >= 0) && (wks_idx < (int)SIZEOF(hdrtoken_strs)));
       // coverity[negative_returns]
@@ -499,8 +473,8 @@ hdrtoken_init()
       int wks_idx;
       HdrTokenHeapPrefix *prefix;
 
-      wks_idx = hdrtoken_tokenize_dfa(_hdrtoken_strs_field_initializers[i].name,
-                                      static_cast<int>(strlen(_hdrtoken_strs_field_initializers[i].name)));
+      wks_idx = hdrtoken_tokenize(_hdrtoken_strs_field_initializers[i].name,
+                                  static_cast<int>(strlen(_hdrtoken_strs_field_initializers[i].name)));
 
       ink_assert((wks_idx >= 0) && (wks_idx < (int)SIZEOF(hdrtoken_strs)));
       prefix                  = hdrtoken_index_to_prefix(wks_idx);
@@ -517,36 +491,9 @@ hdrtoken_init()
       hdrtoken_str_masks[i]       = prefix->wks_info.mask;   // parallel array for speed
       hdrtoken_str_flags[i]       = prefix->wks_info.flags;  // parallel array for speed
     }
-
-    hdrtoken_hash_init();
   }
 }
 
-/*-------------------------------------------------------------------------
-  -------------------------------------------------------------------------*/
-
-int
-hdrtoken_tokenize_dfa(const char *string, int string_len, const char **wks_string_out)
-{
-  int wks_idx;
-
-  wks_idx = hdrtoken_strs_dfa->match({string, size_t(string_len)});
-
-  if (wks_idx < 0) {
-    wks_idx = -1;
-  }
-  if (wks_string_out) {
-    if (wks_idx >= 0) {
-      *wks_string_out = hdrtoken_index_to_wks(wks_idx);
-    } else {
-      *wks_string_out = nullptr;
-    }
-  }
-  // printf("hdrtoken_tokenize_dfa(%d,*s) - return %d\n",string_len,string,wks_idx);
-
-  return wks_idx;
-}
-
 /*-------------------------------------------------------------------------
   -------------------------------------------------------------------------*/
 
@@ -554,7 +501,6 @@ int
 hdrtoken_tokenize(const char *string, int string_len, const char **wks_string_out)
 {
   int wks_idx;
-  HdrTokenHashBucket *bucket;
 
   ink_assert(string != nullptr);
 
@@ -566,14 +512,10 @@ hdrtoken_tokenize(const char *string, int string_len, const char **wks_string_ou
     return wks_idx;
   }
 
-  uint32_t hash = hdrtoken_hash(reinterpret_cast<const unsigned char *>(string), static_cast<unsigned int>(string_len));
-  uint32_t slot = hash_to_slot(hash);
-
-  bucket = &(hdrtoken_hash_table[slot]);
-  if ((bucket->wks != nullptr) && (bucket->hash == hash) && (hdrtoken_wks_to_length(bucket->wks) == string_len)) {
-    wks_idx = hdrtoken_wks_to_index(bucket->wks);
+  wks_idx = hdrtoken_perfect_hash_find(string, string_len);
+  if (wks_idx >= 0 && hdrtoken_str_lengths[wks_idx] == string_len && strncasecmp(string, hdrtoken_strs[wks_idx], string_len) == 0) {
     if (wks_string_out) {
-      *wks_string_out = bucket->wks;
+      *wks_string_out = hdrtoken_strs[wks_idx];
     }
     return wks_idx;
   }
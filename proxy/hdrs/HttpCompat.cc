@@ -466,6 +466,81 @@ HttpCompat::do_vary_header_values_match(MIMEField *hdr1, MIMEField *hdr2)
   return true;
 }
 
+//////////////////////////////////////////////////////////////////////////////
+//
+//      uint32_t HttpCompat::vary_header_values_hash(MIMEField *field)
+//
+//      Hash of the values of a header field such that two fields that
+//      do_vary_header_values_match() says match hash the same. Elements
+//      are hashed case insensitively up to their first end of word, the
+//      way they are compared. A missing field hashes to 0, a present one
+//      never does.
+//
+//////////////////////////////////////////////////////////////////////////////
+uint32_t
+HttpCompat::vary_header_values_hash(MIMEField *field)
+{
+  if (!field) {
+    return 0;
+  }
+
+  // FNV-1a
+  uint32_t hash = 2166136261u;
+  HdrCsvIter iter;
+  int val_len;
+
+  for (const char *val = iter.get_first(field, &val_len); val; val = iter.get_next(&val_len)) {
+    for (int i = 0; i < val_len && !ParseRules::is_eow(val[i]); i++) {
+      hash = (hash ^ static_cast<unsigned char>(ParseRules::ink_tolower(val[i]))) * 16777619u;
+    }
+    // The element length, the comparison needs both to be the same.
+    for (int i = 0; i < 4; i++) {
+      hash = (hash ^ ((val_len >> (8 * i)) & 0xff)) * 16777619u;
+    }
+  }
+
+  return hash ? hash : 1;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//      HttpCompat::UserAgentClass HttpCompat::user_agent_class(MIMEField *field)
+//
+//      The device class of a User-Agent field, by the tokens tablets and
+//      phones put in theirs. A missing field, or one with none of them, is
+//      a desktop.
+//
+//////////////////////////////////////////////////////////////////////////////
+HttpCompat::UserAgentClass
+HttpCompat::user_agent_class(MIMEField *field)
+{
+  if (!field) {
+    return UA_CLASS_DESKTOP;
+  }
+
+  int len;
+  const char *value = field->value_get(&len);
+  std::string_view ua{value, static_cast<size_t>(len)};
+  auto has          = [ua](std::string_view token) {
+    for (size_t i = 0; i + token.size() <= ua.size(); ++i) {
+      if (strncasecmp(ua.data() + i, token.data(), token.size()) == 0) {
+        return true;
+      }
+    }
+    return false;
+  };
+
+  // Android phones say Mobile, Android tablets do not.
+  bool mobi = has("Mobi");
+  if (has("iPad") || has("Kindle") || has("Silk/") || (has("Android") && !mobi)) {
+    return UA_CLASS_TABLET;
+  }
+  if (mobi || has("iPhone") || has("iPod") || has("Opera Mini") || has("BlackBerry")) {
+    return UA_CLASS_MOBILE;
+  }
+  return UA_CLASS_DESKTOP;
+}
+
 //////////////////////////////////////////////////////////////////////////////
 //
 //      float HttpCompat::find_Q_param_in_strlist(StrList *strlist);
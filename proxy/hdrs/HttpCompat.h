@@ -46,6 +46,13 @@ public:
 
   static bool do_vary_header_values_match(MIMEField *hv1, MIMEField *hv2);
 
+  static uint32_t vary_header_values_hash(MIMEField *field);
+
+  /// Device classes that @c Vary: @c User-Agent can compare instead of the values themselves.
+  enum UserAgentClass { UA_CLASS_DESKTOP, UA_CLASS_MOBILE, UA_CLASS_TABLET };
+
+  static UserAgentClass user_agent_class(MIMEField *field);
+
   static float find_Q_param_in_strlist(StrList *strlist);
 
   static float match_accept_language(const char *lang_str, int lang_len, StrList *acpt_lang_list, int *matching_length,
@@ -25,6 +25,9 @@
 #include "tscore/ink_platform.h"
 #include "tscore/ink_memory.h"
 #include "tscore/ink_defs.h"
+#include "tscore/ink_assert.h"
+
+#include <cstring>
 
 struct huffman_entry {
   uint32_t code_as_hex;
@@ -70,131 +73,151 @@ static const huffman_entry huffman_table[] = {
   {0x7ffffe8, 27}, {0x7ffffe9, 27},  {0x7ffffea, 27}, {0x7ffffeb, 27},  {0xffffffe, 28}, {0x7ffffec, 27}, {0x7ffffed, 27},
   {0x7ffffee, 27}, {0x7ffffef, 27},  {0x7fffff0, 27}, {0x3ffffee, 26},  {0x3fffffff, 30}};
 
-typedef struct node {
-  node *left, *right;
-  char ascii_code;
-  bool leaf_node;
-} Node;
+// The decoder is a state machine that takes four bits at a time, as in nghttp2. A state is an
+// internal node of the code tree, there are 256 of them with the root as 0. For each state and
+// nibble the table gives where the walk ends up and the symbol passed on the way, if any, which is
+// at most one as no code is shorter than five bits.
 
-Node *HUFFMAN_TREE_ROOT;
+#define HUFFMAN_EOS 256
 
-static Node *
-make_huffman_tree_node()
-{
-  Node *n       = static_cast<Node *>(ats_malloc(sizeof(Node)));
-  n->left       = nullptr;
-  n->right      = nullptr;
-  n->ascii_code = '\0';
-  n->leaf_node  = false;
-  return n;
-}
+enum {
+  HUFFMAN_DECODE_SYM    = 0x01, ///< A symbol was completed, in @c sym.
+  HUFFMAN_DECODE_ACCEPT = 0x02, ///< The string may end here, the bits since the last symbol are valid padding.
+  HUFFMAN_DECODE_FAIL   = 0x04, ///< EOS was decoded.
+};
+
+struct huffman_decode_entry {
+  uint8_t state;
+  uint8_t flags;
+  uint8_t sym;
+};
+
+static huffman_decode_entry huffman_decode_table[256][16];
+static bool huffman_decode_table_ready = false;
 
-static Node *
-make_huffman_tree()
+static void
+make_huffman_decode_table()
 {
-  Node *root = make_huffman_tree_node();
+  // The tree, as children by internal node. Leaves are -1 - symbol.
+  int child[256][2];
+  int depth[256];
+  bool ones[256]; // The path from the root is all 1 bits, as the start of EOS is.
+  int nodes = 1;
+
+  memset(child, 0, sizeof(child));
+  depth[0] = 0;
+  ones[0]  = true;
 
-  // insert leafs for each ascii code
   for (unsigned i = 0; i < countof(huffman_table); i++) {
     uint32_t bit_len = huffman_table[i].bit_len;
-    Node *current    = root;
+    int current      = 0;
 
-    while (bit_len > 0) {
-      if (huffman_table[i].code_as_hex & (1 << (bit_len - 1))) {
-        if (!current->right) {
-          current->right = make_huffman_tree_node();
-        }
-        current = current->right;
-      } else {
-        if (!current->left) {
-          current->left = make_huffman_tree_node();
-        }
-        current = current->left;
+    while (--bit_len > 0) {
+      int bit = (huffman_table[i].code_as_hex >> bit_len) & 1;
+      if (!child[current][bit]) {
+        ink_release_assert(nodes < 256);
+        child[current][bit] = nodes;
+        depth[nodes]        = depth[current] + 1;
+        ones[nodes]         = ones[current] && bit;
+        ++nodes;
       }
-      bit_len--;
+      current = child[current][bit];
     }
-    current->ascii_code = i;
-    current->leaf_node  = true;
+    child[current][huffman_table[i].code_as_hex & 1] = -1 - static_cast<int>(i);
   }
 
-  return root;
-}
+  for (int state = 0; state < 256; state++) {
+    for (int nibble = 0; nibble < 16; nibble++) {
+      huffman_decode_entry &entry = huffman_decode_table[state][nibble];
+      int current                 = state;
 
-static void
-free_huffman_tree(Node *node)
-{
-  if (node->left) {
-    free_huffman_tree(node->left);
-  }
-  if (node->right) {
-    free_huffman_tree(node->right);
+      entry = {0, 0, 0};
+      for (int bit = 3; bit >= 0; bit--) {
+        int next = child[current][(nibble >> bit) & 1];
+        if (next < 0) {
+          if (-1 - next == HUFFMAN_EOS) {
+            entry.flags = HUFFMAN_DECODE_FAIL;
+            break;
+          }
+          entry.flags |= HUFFMAN_DECODE_SYM;
+          entry.sym = -1 - next;
+          next      = 0;
+        }
+        current = next;
+      }
+      if (!(entry.flags & HUFFMAN_DECODE_FAIL)) {
+        entry.state = current;
+        // Padding is the start of EOS and shorter than a byte.
+        if (ones[current] && depth[current] < 8) {
+          entry.flags |= HUFFMAN_DECODE_ACCEPT;
+        }
+      }
+    }
   }
-
-  ats_free(node);
 }
 
 void
 hpack_huffman_init()
 {
-  if (!HUFFMAN_TREE_ROOT) {
-    HUFFMAN_TREE_ROOT = make_huffman_tree();
+  if (!huffman_decode_table_ready) {
+    make_huffman_decode_table();
+    huffman_decode_table_ready = true;
   }
 }
 
 void
 hpack_huffman_fin()
 {
-  if (HUFFMAN_TREE_ROOT) {
-    free_huffman_tree(HUFFMAN_TREE_ROOT);
-  }
+  // The table is static, there is nothing to free.
 }
 
 int64_t
 huffman_decode(char *dst_start, const uint8_t *src, uint32_t src_len)
 {
-  char *dst_end             = dst_start;
-  uint8_t shift             = 7;
-  Node *current             = HUFFMAN_TREE_ROOT;
-  int byte_boundary_crossed = 0;
-  bool includes_zero        = false;
-
-  while (src_len) {
-    if (*src & (1 << shift)) {
-      current = current->right;
-    } else {
-      current       = current->left;
-      includes_zero = true;
-    }
+  char *dst_end      = dst_start;
+  const uint8_t *end = src + src_len;
+  uint8_t state      = 0;
+  uint8_t flags      = HUFFMAN_DECODE_ACCEPT;
 
-    if (current->leaf_node == true) {
-      *dst_end = current->ascii_code;
-      ++dst_end;
-      current               = HUFFMAN_TREE_ROOT;
-      byte_boundary_crossed = 0;
-      includes_zero         = false;
+  for (; src < end; ++src) {
+    const huffman_decode_entry &high = huffman_decode_table[state][*src >> 4];
+    if (high.flags & HUFFMAN_DECODE_FAIL) {
+      return -1;
     }
-    if (shift) {
-      --shift;
-    } else {
-      shift = 7;
-      ++src;
-      --src_len;
-      ++byte_boundary_crossed;
+    if (high.flags & HUFFMAN_DECODE_SYM) {
+      *dst_end++ = high.sym;
     }
-    if (byte_boundary_crossed > 3) {
+
+    const huffman_decode_entry &low = huffman_decode_table[high.state][*src & 0xf];
+    if (low.flags & HUFFMAN_DECODE_FAIL) {
       return -1;
     }
+    if (low.flags & HUFFMAN_DECODE_SYM) {
+      *dst_end++ = low.sym;
+    }
+    state = low.state;
+    flags = low.flags;
   }
-  if (byte_boundary_crossed > 1) {
-    return -1;
-  }
-  if (includes_zero) {
+
+  if (!(flags & HUFFMAN_DECODE_ACCEPT)) {
     return -1;
   }
 
   return dst_end - dst_start;
 }
 
+int64_t
+huffman_encode_length(const uint8_t *src, uint32_t src_len)
+{
+  uint64_t bits = 0;
+
+  for (uint32_t i = 0; i < src_len; ++i) {
+    bits += huffman_table[src[i]].bit_len;
+  }
+
+  return (bits + 7) / 8;
+}
+
 uint8_t *
 huffman_encode_append(uint8_t *dst, uint32_t src, int n = 0)
 {
@@ -208,36 +231,28 @@ int64_t
 huffman_encode(uint8_t *dst_start, const uint8_t *src, uint32_t src_len)
 {
   uint8_t *dst = dst_start;
-  // NOTE: The maximum length of Huffman Code is 30, thus using uint32_t as buffer.
-  uint32_t buf         = 0;
-  uint32_t remain_bits = 32;
+  // NOTE: The maximum length of Huffman Code is 30, so with fewer than 32 bits pending a code always fits.
+  uint64_t buf  = 0;
+  uint32_t bits = 0;
 
   for (uint32_t i = 0; i < src_len; ++i) {
-    const uint32_t hex     = huffman_table[src[i]].code_as_hex;
-    const uint32_t bit_len = huffman_table[src[i]].bit_len;
-
-    if (remain_bits > bit_len) {
-      remain_bits = remain_bits - bit_len;
-      buf |= hex << remain_bits;
-    } else if (remain_bits == bit_len) {
-      buf |= hex;
-      dst         = huffman_encode_append(dst, buf);
-      remain_bits = 32;
-      buf         = 0;
-    } else {
-      buf |= hex >> (bit_len - remain_bits);
-      dst         = huffman_encode_append(dst, buf);
-      remain_bits = (32 - (bit_len - remain_bits));
-      buf         = hex << remain_bits;
+    const huffman_entry &code = huffman_table[src[i]];
+
+    buf  = (buf << code.bit_len) | code.code_as_hex;
+    bits += code.bit_len;
+    if (bits >= 32) {
+      bits -= 32;
+      dst = huffman_encode_append(dst, static_cast<uint32_t>(buf >> bits));
     }
   }
 
-  dst = huffman_encode_append(dst, buf, remain_bits / 8);
-
   // NOTE: Add padding w/ EOS
-  uint32_t pad_len = remain_bits % 8;
-  if (pad_len) {
-    *(dst - 1) |= 0xff >> (8 - pad_len);
+  uint32_t pad_len = (8 - bits % 8) % 8;
+  buf              = (buf << pad_len) | ((1u << pad_len) - 1);
+  bits += pad_len;
+
+  for (; bits > 0; bits -= 8) {
+    *dst++ = (buf >> (bits - 8)) & 255;
   }
 
   return dst - dst_start;
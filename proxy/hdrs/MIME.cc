@@ -435,6 +435,152 @@ mime_hdr_presence_unset(MIMEHdrImpl *h, int well_known_str_index)
   mime_hdr_presence_unset(h, wks);
 }
 
+/***********************************************************************
+ *                                                                     *
+ *                         N A M E    I N D E X                        *
+ *                                                                     *
+ ***********************************************************************/
+
+/// The name index of @a mh, or @c nullptr if @a mh was marshaled before there was one.
+inline MIMENameIndex *
+mime_hdr_name_index(MIMEHdrImpl *mh)
+{
+  return (mh->m_length >= sizeof(MIMEHdrImpl)) ? &(mh->m_name_index) : nullptr;
+}
+
+/// Where a name starts probing, the same for names that differ only in case.
+static inline unsigned
+mime_name_index_home(const char *name, int length)
+{
+  uint32_t h = length;
+  for (int i = 0; i < length; ++i) {
+    h = h * 31 + (name[i] | 0x20);
+  }
+  return (h ^ (h >> 11)) & (MIME_NAME_INDEX_SLOTS - 1);
+}
+
+static inline MIMEField *
+mime_name_index_field(MIMEHdrImpl *mh, uint8_t entry)
+{
+  return _mime_hdr_field_list_search_by_slotnum(mh, entry - 1);
+}
+
+static inline bool
+mime_name_index_match(const MIMEField *field, const char *name, int length)
+{
+  return field->is_live() && (field->m_len_name == length) && (strncasecmp(field->m_ptr_name, name, length) == 0);
+}
+
+/// Make @a field, a dup head, the entry for its name.
+static void
+mime_hdr_name_index_add(MIMEHdrImpl *mh, MIMEField *field)
+{
+  MIMENameIndex *index = mime_hdr_name_index(mh);
+  if ((index == nullptr) || index->m_overflow) {
+    return;
+  }
+
+  int slotnum = mime_hdr_field_slotnum(mh, field);
+  if ((slotnum < 0) || (slotnum >= UINT8_MAX)) {
+    index->m_overflow = true;
+    return;
+  }
+
+  for (unsigned i = mime_name_index_home(field->m_ptr_name, field->m_len_name);; i = (i + 1) & (MIME_NAME_INDEX_SLOTS - 1)) {
+    uint8_t entry = index->m_slots[i];
+    if (entry == 0) {
+      if (index->m_count >= MIME_NAME_INDEX_MAX_NAMES) {
+        index->m_overflow = true;
+      } else {
+        index->m_slots[i] = slotnum + 1;
+        ++index->m_count;
+      }
+      return;
+    }
+    MIMEField *other = mime_name_index_field(mh, entry);
+    if (other && mime_name_index_match(other, field->m_ptr_name, field->m_len_name)) {
+      // The field walk finds the first of two heads with the same name, keep that one.
+      if (!other->is_dup_head() || (slotnum < entry - 1)) {
+        index->m_slots[i] = slotnum + 1;
+      }
+      return;
+    }
+  }
+}
+
+/// Drop the entry for @a field, which is still live.
+static void
+mime_hdr_name_index_remove(MIMEHdrImpl *mh, MIMEField *field)
+{
+  const unsigned mask  = MIME_NAME_INDEX_SLOTS - 1;
+  MIMENameIndex *index = mime_hdr_name_index(mh);
+  if ((index == nullptr) || index->m_overflow) {
+    return;
+  }
+
+  int slotnum = mime_hdr_field_slotnum(mh, field);
+  if ((slotnum < 0) || (slotnum >= UINT8_MAX)) {
+    return;
+  }
+
+  uint8_t entry = slotnum + 1;
+  unsigned i    = mime_name_index_home(field->m_ptr_name, field->m_len_name);
+  while (index->m_slots[i] != entry) {
+    if (index->m_slots[i] == 0) {
+      return; // not a head that finds return
+    }
+    i = (i + 1) & mask;
+  }
+  index->m_slots[i] = 0;
+  --index->m_count;
+
+  // Move back the entries after it in the run that can go in the hole, so finds don't stop there.
+  for (unsigned j = (i + 1) & mask; index->m_slots[j] != 0; j = (j + 1) & mask) {
+    MIMEField *other = mime_name_index_field(mh, index->m_slots[j]);
+    unsigned home    = other ? mime_name_index_home(other->m_ptr_name, other->m_len_name) : j;
+    if (((j - home) & mask) >= ((j - i) & mask)) {
+      index->m_slots[i] = index->m_slots[j];
+      index->m_slots[j] = 0;
+      i                 = j;
+    }
+  }
+}
+
+/// Refill the index from the fields, for when slot numbers have changed.
+static void
+mime_hdr_name_index_rebuild(MIMEHdrImpl *mh)
+{
+  MIMENameIndex *index = mime_hdr_name_index(mh);
+  if (index == nullptr) {
+    return;
+  }
+
+  memset(index, 0, sizeof(MIMENameIndex));
+  for (MIMEFieldBlockImpl *fblock = &(mh->m_first_fblock); fblock != nullptr; fblock = fblock->m_next) {
+    for (MIMEField *field = fblock->m_field_slots, *limit = field + fblock->m_freetop; field < limit; ++field) {
+      if (field->is_live() && field->is_dup_head()) {
+        mime_hdr_name_index_add(mh, field);
+      }
+    }
+  }
+}
+
+MIMEField *
+_mime_hdr_field_list_search_by_name_index(MIMEHdrImpl *mh, const char *field_name_str, int field_name_len)
+{
+  MIMENameIndex *index = mime_hdr_name_index(mh);
+  ink_assert(index && !index->m_overflow);
+
+  for (unsigned i = mime_name_index_home(field_name_str, field_name_len); index->m_slots[i] != 0;
+       i          = (i + 1) & (MIME_NAME_INDEX_SLOTS - 1)) {
+    MIMEField *field = mime_name_index_field(mh, index->m_slots[i]);
+    if (field && mime_name_index_match(field, field_name_str, field_name_len)) {
+      return field;
+    }
+  }
+  return nullptr;
+}
+
 /***********************************************************************
  *                                                                     *
  *                  S L O T    A C C E L E R A T O R S                 *
@@ -448,6 +594,11 @@ mime_hdr_init_accelerators_and_presence_bits(MIMEHdrImpl *mh)
   mh->m_slot_accelerators[1] = 0xFFFFFFFF;
   mh->m_slot_accelerators[2] = 0xFFFFFFFF;
   mh->m_slot_accelerators[3] = 0xFFFFFFFF;
+
+  MIMENameIndex *index = mime_hdr_name_index(mh);
+  if (index) {
+    memset(index, 0, sizeof(MIMENameIndex));
+  }
 }
 
 inline uint32_t
@@ -484,6 +635,9 @@ mime_hdr_set_accelerators_and_presence_bits(MIMEHdrImpl *mh, MIMEField *field)
 {
   int slot_id;
   ptrdiff_t slot_num;
+
+  mime_hdr_name_index_add(mh, field);
+
   if (field->m_wks_idx < 0) {
     return;
   }
@@ -1119,14 +1273,17 @@ mime_hdr_copy_onto(MIMEHdrImpl *s_mh, HdrHeap *s_heap, MIMEHdrImpl *d_mh, HdrHea
     mime_hdr_destroy_field_block_list(d_heap, d_mh->m_first_fblock.m_next);
   }
 
-  ink_assert(((char *)&(s_mh->m_first_fblock.m_field_slots[MIME_FIELD_BLOCK_SLOTS]) - (char *)s_mh) == sizeof(struct MIMEHdrImpl));
+  ink_assert(((char *)&(s_mh->m_first_fblock.m_field_slots[MIME_FIELD_BLOCK_SLOTS]) - (char *)s_mh) ==
+             ((char *)&(s_mh->m_name_index) - (char *)s_mh));
 
   int top             = s_mh->m_first_fblock.m_freetop;
   char *end           = reinterpret_cast<char *>(&(s_mh->m_first_fblock.m_field_slots[top]));
   int bytes_below_top = end - reinterpret_cast<char *>(s_mh);
+  uint32_t d_length   = d_mh->m_length; // the source may be a shorter header from an older cache
 
   // copies useful part of enclosed first block too
   memcpy(d_mh, s_mh, bytes_below_top);
+  d_mh->m_length = d_length;
 
   if (d_mh->m_first_fblock.m_next == nullptr) // common case: no other block
   {
@@ -1151,6 +1308,15 @@ mime_hdr_copy_onto(MIMEHdrImpl *s_mh, HdrHeap *s_heap, MIMEHdrImpl *d_mh, HdrHea
 
   mime_hdr_field_block_list_adjust(block_count, &(s_mh->m_first_fblock), &(d_mh->m_first_fblock));
 
+  // The slots are where they were, so the index carries over.
+  MIMENameIndex *s_index = mime_hdr_name_index(s_mh);
+  MIMENameIndex *d_index = mime_hdr_name_index(d_mh);
+  if (s_index && d_index) {
+    memcpy(d_index, s_index, sizeof(MIMENameIndex));
+  } else {
+    mime_hdr_name_index_rebuild(d_mh);
+  }
+
   MIME_HDR_SANITY_CHECK(s_mh);
   MIME_HDR_SANITY_CHECK(d_mh);
 }
@@ -1365,6 +1531,19 @@ mime_hdr_field_find(MIMEHdrImpl *mh, const char *field_name_str, int field_name_
 #endif
     return f;
   } else {
+    MIMENameIndex *index = mime_hdr_name_index(mh);
+
+    if (index && !index->m_overflow) {
+      MIMEField *f = _mime_hdr_field_list_search_by_name_index(mh, field_name_str, field_name_len);
+
+      ink_assert((f == nullptr) || f->is_live());
+#if TRACK_FIELD_FIND_CALLS
+      Debug("http", "mime_hdr_field_find(hdr 0x%X, field %.*s): %s (due to name index)", mh, field_name_len, field_name_str,
+            (f ? "HIT" : "MISS"));
+#endif
+      return f;
+    }
+
     MIMEField *f = _mime_hdr_field_list_search_by_string(mh, field_name_str, field_name_len);
 
     ink_assert((f == nullptr) || f->is_live());
@@ -1595,6 +1774,7 @@ mime_hdr_field_detach(MIMEHdrImpl *mh, MIMEField *field, bool detach_all_dups)
 
   if (field->m_flags & MIME_FIELD_SLOT_FLAGS_DUP_HEAD) // head of list?
   {
+    mime_hdr_name_index_remove(mh, field);
     if (!next_dup) // only child
     {
       mime_hdr_unset_accelerators_and_presence_bits(mh, field);
@@ -1677,6 +1857,8 @@ mime_hdr_field_delete(HdrHeap *heap, MIMEHdrImpl *mh, MIMEField *field, bool del
             if (prev_block->m_next == nullptr) {
               mh->m_fblock_list_tail = prev_block;
             }
+            // Fields in later blocks moved down a block's worth of slots.
+            mime_hdr_name_index_rebuild(mh);
           }
           break;
         }
@@ -2254,6 +2436,30 @@ mime_field_value_append(HdrHeap *heap, MIMEHdrImpl *mh, MIMEField *field, const
   }
 }
 
+int32_t
+MIMEHdr::get_cc_directive_secs(const char *name, int name_len)
+{
+  MIMEField *field = field_find(MIME_FIELD_CACHE_CONTROL, MIME_LEN_CACHE_CONTROL);
+  HdrCsvIter csv_iter;
+  const char *s;
+  int len;
+
+  if (field == nullptr) {
+    return -1;
+  }
+  for (s = csv_iter.get_first(field, &len); s != nullptr; s = csv_iter.get_next(&len)) {
+    const char *e = s + len;
+    const char *c = s + name_len;
+    int value;
+
+    if (len > name_len && *c == '=' && strncasecmp(s, name, name_len) == 0 && mime_parse_integer(c, e, &value) &&
+        value >= 0) {
+      return value;
+    }
+  }
+  return -1;
+}
+
 MIMEField *
 MIMEHdr::get_host_port_values(const char **host_ptr, ///< Pointer to host.
                               int *host_len,         ///< Length of host.
@@ -88,6 +88,9 @@ enum MimeParseState {
 #define MIME_FIELD_SLOTNUM_MAX (MIME_FIELD_SLOTNUM_MASK - 1)
 #define MIME_FIELD_SLOTNUM_UNKNOWN MIME_FIELD_SLOTNUM_MAX
 
+#define MIME_NAME_INDEX_SLOTS 64
+#define MIME_NAME_INDEX_MAX_NAMES 48
+
 /***********************************************************************
  *                                                                     *
  *                    MIMEField & MIMEFieldBlockImpl                   *
@@ -251,6 +254,20 @@ struct MIMECooked {
  *                                                                     *
  ***********************************************************************/
 
+/** Open addressed hash table from field name to the slot of the dup head with that name.
+
+    Every live dup head is in it, not just the ones without a well known string, since a name
+    can be looked up with a pointer that is not the well known string. It is kept up to date as
+    fields are attached and detached, finds only read it, because a header read from the cache
+    can be shared between threads. When there are more names than fit, or a slot number too big
+    for a byte, finds go back to walking the fields.
+ */
+struct MIMENameIndex {
+  uint8_t m_overflow;
+  uint8_t m_count;
+  uint8_t m_slots[MIME_NAME_INDEX_SLOTS]; ///< Slot number + 1 of a dup head, 0 if empty.
+};
+
 struct MIMEHdrImpl : public HdrHeapObjImpl {
   // HdrHeapObjImpl is 4 bytes, so this will result in 4 bytes padding
   uint64_t m_presence_bits;
@@ -260,8 +277,10 @@ struct MIMEHdrImpl : public HdrHeapObjImpl {
 
   MIMEFieldBlockImpl *m_fblock_list_tail;
   MIMEFieldBlockImpl m_first_fblock; // 1 block inline
-  // mime_hdr_copy_onto assumes that m_first_fblock is last --
-  // don't add any new fields after it.
+  // mime_hdr_copy_onto assumes that m_first_fblock is last, apart from
+  // m_name_index. Headers marshaled before there was a name index end at
+  // m_first_fblock, use mime_hdr_name_index(), which checks the length.
+  MIMENameIndex m_name_index;
 
   // Marshaling Functions
   int marshal(MarshalXlate *ptr_xlate, int num_ptr, MarshalXlate *str_xlate, int num_str);
@@ -704,6 +723,7 @@ void mime_hdr_fields_clear(HdrHeap *heap, MIMEHdrImpl *mh);
 MIMEField *_mime_hdr_field_list_search_by_wks(MIMEHdrImpl *mh, int wks_idx);
 MIMEField *_mime_hdr_field_list_search_by_string(MIMEHdrImpl *mh, const char *field_name_str, int field_name_len);
 MIMEField *_mime_hdr_field_list_search_by_slotnum(MIMEHdrImpl *mh, int slotnum);
+MIMEField *_mime_hdr_field_list_search_by_name_index(MIMEHdrImpl *mh, const char *field_name_str, int field_name_len);
 inkcoreapi MIMEField *mime_hdr_field_find(MIMEHdrImpl *mh, const char *field_name_str, int field_name_len);
 
 MIMEField *mime_hdr_field_get(MIMEHdrImpl *mh, int idx);
@@ -1068,6 +1088,12 @@ public:
   int32_t get_cooked_cc_min_fresh();
   bool get_cooked_pragma_no_cache();
 
+  /** The seconds of the Cache-Control directive @a name, one that is not cooked such as
+      stale-while-revalidate.
+      @return The value, or -1 if there is no such directive or it has no value.
+  */
+  int32_t get_cc_directive_secs(const char *name, int name_len);
+
   /** Get the value of the host field.
       This parses the host field for brackets and port value.
       @return The mime HOST field if it has a value, @c NULL otherwise.
@@ -30,6 +30,7 @@
 #include "MIME.h"
 #include "HTTP.h"
 #include "tscore/Diags.h"
+#include "HdrScan.h"
 
 const char *URL_SCHEME_FILE;
 const char *URL_SCHEME_FTP;
@@ -94,9 +95,7 @@ int URL_LEN_MMS;
 int URL_LEN_MMSU;
 int URL_LEN_MMST;
 
-// Whether we should implement url_CryptoHash_get() using url_CryptoHash_get_fast(). Note that
-// url_CryptoHash_get_fast() does NOT produce the same result as url_CryptoHash_get_general().
-static int url_hash_method = 0;
+URLHashContext::HashType URLHashContext::Setting = CryptoContext::UNSPECIFIED;
 
 // test to see if a character is a valid character for a host in a URI according to
 // RFC 3986 and RFC 1034
@@ -1172,11 +1171,10 @@ namespace UrlImpl
 bool
 url_is_strictly_compliant(const char *start, const char *end)
 {
-  for (const char *i = start; i < end; ++i) {
-    if (!ParseRules::is_uri(*i)) {
-      Debug("http", "Non-RFC compliant character [0x%.2X] found in URL", (unsigned char)*i);
-      return false;
-    }
+  const char *i = hdr_scan_non_uri(start, end);
+  if (i != end) {
+    Debug("http", "Non-RFC compliant character [0x%.2X] found in URL", (unsigned char)*i);
+    return false;
   }
   return true;
 }
@@ -1364,7 +1362,6 @@ url_parse_http(HdrHeap *heap, URLImpl *url, const char **start, const char *end,
   const char *query_end      = nullptr;
   const char *fragment_start = nullptr;
   const char *fragment_end   = nullptr;
-  char mask;
 
   err = url_parse_internet(heap, url, start, end, copy_strings);
   if (err < 0) {
@@ -1377,26 +1374,18 @@ url_parse_http(HdrHeap *heap, URLImpl *url, const char **start, const char *end,
   }
 
   path_start = cur;
-  mask       = ';' & '?' & '#';
-parse_path2:
-  if ((*cur & mask) == mask) {
-    if (*cur == ';') {
-      path_end = cur;
-      goto parse_params1;
-    }
-    if (*cur == '?') {
-      path_end = cur;
-      goto parse_query1;
-    }
-    if (*cur == '#') {
-      path_end = cur;
-      goto parse_fragment1;
-    }
-  } else {
-    ink_assert((*cur != ';') && (*cur != '?') && (*cur != '#'));
+  cur        = hdr_scan_path_end(cur, end);
+  if (cur == end) {
+    goto done;
   }
-  GETNEXT(done);
-  goto parse_path2;
+  path_end = cur;
+  if (*cur == ';') {
+    goto parse_params1;
+  }
+  if (*cur == '?') {
+    goto parse_query1;
+  }
+  goto parse_fragment1;
 
 parse_params1:
   params_start = cur + 1;
@@ -1642,41 +1631,44 @@ memcpy_tolower(char *d, const char *s, int n)
 
 #define BUFSIZE 512
 
+// Lower case @a s into the hash, in place unless it has upper case in it.
+static inline void
+url_CryptoHash_update_tolower(CryptoContext &ctx, const char *s, int length)
+{
+  const char *e = s + length;
+  const char *t = s;
+
+  while (t < e && !ParseRules::is_upalpha(*t)) {
+    ++t;
+  }
+  if (t == e) {
+    ctx.update(s, length);
+  } else {
+    char buffer[BUFSIZE];
+    memcpy_tolower(buffer, s, length);
+    ctx.update(buffer, length);
+  }
+}
+
 // fast path for CryptoHash, HTTP, no user/password/params/query,
-// no buffer overflow, no unescaping needed
+// no buffer overflow, no unescaping needed. The same bytes as the
+// general path, hashed where they are instead of copied out first.
 
 static inline void
 url_CryptoHash_get_fast(const URLImpl *url, CryptoContext &ctx, CryptoHash *hash, cache_generation_t generation)
 {
-  char buffer[BUFSIZE];
-  char *p;
-
-  p = buffer;
-  memcpy_tolower(p, url->m_ptr_scheme, url->m_len_scheme);
-  p += url->m_len_scheme;
-  *p++ = ':';
-  *p++ = '/';
-  *p++ = '/';
-  // no user
-  *p++ = ':';
-  // no password
-  *p++ = '@';
-  memcpy_tolower(p, url->m_ptr_host, url->m_len_host);
-  p += url->m_len_host;
-  *p++ = '/';
-  memcpy(p, url->m_ptr_path, url->m_len_path);
-  p += url->m_len_path;
-  *p++ = ';';
-  // no params
-  *p++ = '?';
-  // no query
+  url_CryptoHash_update_tolower(ctx, url->m_ptr_scheme, url->m_len_scheme);
+  // no user, no password
+  ctx.update("://:@", 5);
+  url_CryptoHash_update_tolower(ctx, url->m_ptr_host, url->m_len_host);
+  ctx.update("/", 1);
+  ctx.update(url->m_ptr_path, url->m_len_path);
+  // no params, no query
+  ctx.update(";?", 2);
 
   ink_assert(sizeof(url->m_port) == 2);
   uint16_t port = static_cast<uint16_t>(url_canonicalize_port(url->m_url_type, url->m_port));
-  *p++          = (reinterpret_cast<char *>(&port))[0];
-  *p++          = (reinterpret_cast<char *>(&port))[1];
-
-  ctx.update(buffer, p - buffer);
+  ctx.update(&port, sizeof(port));
   if (generation != -1) {
     ctx.update(&generation, sizeof(generation));
   }
@@ -1766,14 +1758,15 @@ void
 url_CryptoHash_get(const URLImpl *url, CryptoHash *hash, cache_generation_t generation)
 {
   URLHashContext ctx;
-  if ((url_hash_method != 0) && (url->m_url_type == URL_TYPE_HTTP) &&
+  if ((url->m_url_type == URL_TYPE_HTTP) &&
       ((url->m_len_user + url->m_len_password + url->m_len_params + url->m_len_query) == 0) &&
       (3 + 1 + 1 + 1 + 1 + 1 + 2 + url->m_len_scheme + url->m_len_host + url->m_len_path < BUFSIZE) &&
       (memchr(url->m_ptr_host, '%', url->m_len_host) == nullptr) && (memchr(url->m_ptr_path, '%', url->m_len_path) == nullptr)) {
     url_CryptoHash_get_fast(url, ctx, hash, generation);
 #ifdef DEBUG
     CryptoHash hash_general;
-    url_CryptoHash_get_general(url, ctx, hash_general, generation);
+    URLHashContext ctx_general;
+    url_CryptoHash_get_general(url, ctx_general, hash_general, generation);
     ink_assert(*hash == hash_general);
 #endif
   } else {
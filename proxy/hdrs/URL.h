@@ -87,7 +87,15 @@ struct URLImpl : public HdrHeapObjImpl {
   void check_strings(HeapCheck *heaps, int num_heaps);
 };
 
-using URLHashContext = CryptoContext;
+/// Context for the cache key hash of a URL, which can be a different type than other hashes.
+class URLHashContext : public CryptoContext
+{
+public:
+  URLHashContext() : CryptoContext(Setting) {}
+
+  /// Set once the cache knows what its stripes were written with, @c UNSPECIFIED follows @c CryptoContext::Setting.
+  static HashType Setting;
+};
 
 extern const char *URL_SCHEME_FILE;
 extern const char *URL_SCHEME_FTP;
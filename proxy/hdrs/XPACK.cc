@@ -26,7 +26,6 @@
 
 #include "tscore/Arena.h"
 #include "tscore/ink_memory.h"
-#include "tscpp/util/LocalBuffer.h"
 
 //
 // [RFC 7541] 5.1. Integer representation
@@ -153,15 +152,9 @@ xpack_encode_string(uint8_t *buf_start, const uint8_t *buf_end, const char *valu
   uint8_t *p       = buf_start;
   bool use_huffman = true;
 
-  ts::LocalBuffer<uint8_t, 4096> local_buffer(value_len * 4);
-  uint8_t *data    = local_buffer.data();
-  int64_t data_len = 0;
-
   // TODO Choose whether to use Huffman encoding wisely
   // cppcheck-suppress knownConditionTrueFalse; leaving "use_huffman" for wise huffman usage in the future
-  if (use_huffman && value_len) {
-    data_len = huffman_encode(data, reinterpret_cast<const uint8_t *>(value), value_len);
-  }
+  const int64_t data_len = use_huffman ? huffman_encode_length(reinterpret_cast<const uint8_t *>(value), value_len) : 0;
 
   // Length
   const int64_t len = xpack_encode_integer(p, buf_end, data_len, n);
@@ -180,10 +173,9 @@ xpack_encode_string(uint8_t *buf_start, const uint8_t *buf_end, const char *valu
     return -1;
   }
 
-  // Value
+  // Value, encoded in place now its length is known
   if (data_len) {
-    memcpy(p, data, data_len);
-    p += data_len;
+    p += huffman_encode(p, reinterpret_cast<const uint8_t *>(value), value_len);
   }
 
   return p - buf_start;
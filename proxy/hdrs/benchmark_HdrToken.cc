@@ -0,0 +1,112 @@
+/** @file
+
+  Throughput of well known string tokenizing.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  @section details Details
+
+  Usage: benchmark_HdrToken [-n iterations] [-j]
+
+  Tokenizes the field names of typical requests and responses, some of them not well known strings,
+  with @c hdrtoken_tokenize and with a DFA over the well known strings, as they were found at startup
+  before. The DFA is slow enough that it only gets a hundredth of the iterations. It also matches
+  names that only start with a well known string, so it finds more. With -j only the perfect hash
+  is timed and reported as a JSON line, for `make bench`.
+ */
+
+#include "HdrToken.h"
+#include "tscore/ink_hrtime.h"
+#include "tscore/Regex.h"
+#include "bench_report.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+namespace
+{
+const char *const NAMES[] = {
+  "Host", "User-Agent", "Accept", "Accept-Encoding", "Accept-Language", "Cookie", "Referer", "Connection", "Cache-Control",
+  "If-None-Match", "If-Modified-Since", "X-Forwarded-For", "Content-Type", "Content-Length", "Date", "Server", "Last-Modified",
+  "Etag", "Vary", "Set-Cookie", "content-encoding", "transfer-encoding", "x-request-id", "sec-fetch-mode", "X-Amz-Cf-Id",
+  "Upgrade-Insecure-Requests", "Sec-Ch-Ua", "Strict-Transport-Security",
+};
+
+template <typename F>
+double
+time_names(std::vector<std::string> const &names, int iterations, int &found, F &&tokenize)
+{
+  found          = 0;
+  ink_hrtime now = ink_get_hrtime_internal();
+  for (int i = 0; i < iterations; ++i) {
+    for (auto const &name : names) {
+      found += tokenize(name) >= 0;
+    }
+  }
+  return static_cast<double>(ink_get_hrtime_internal() - now) / HRTIME_SECOND;
+}
+} // namespace
+
+int
+main(int argc, char *argv[])
+{
+  int iterations = 1000000;
+  bool json      = false;
+  int opt;
+  while ((opt = getopt(argc, argv, "n:j")) != -1) {
+    if (opt == 'n') {
+      iterations = atoi(optarg);
+    } else if (opt == 'j') {
+      json = true;
+    } else {
+      fprintf(stderr, "usage: %s [-n iterations] [-j]\n", argv[0]);
+      return 1;
+    }
+  }
+
+  hdrtoken_init();
+
+  DFA dfa;
+  dfa.compile(hdrtoken_strs, hdrtoken_num_wks, RE_CASE_INSENSITIVE);
+
+  // Copies, so neither can tell a well known string by its address.
+  std::vector<std::string> names(std::begin(NAMES), std::end(NAMES));
+
+  int hash_found = 0, dfa_found = 0;
+  double hash_seconds = time_names(names, iterations, hash_found,
+                                   [](std::string const &name) { return hdrtoken_tokenize(name.data(), name.size()); });
+  if (json) {
+    bench_report(true, "hdrtoken_tokenize", static_cast<int64_t>(names.size()) * iterations, hash_seconds);
+    return 0;
+  }
+  int dfa_iterations  = iterations / 100 > 0 ? iterations / 100 : 1;
+  double dfa_seconds  = time_names(names, dfa_iterations, dfa_found, [&dfa](std::string const &name) { return dfa.match(name); });
+
+  double lookups = static_cast<double>(names.size()) * iterations;
+  printf("%zu names, %d iterations: perfect hash %.3f s, %.1f M/s (%d found)\n", names.size(), iterations, hash_seconds,
+         lookups / hash_seconds / 1e6, hash_found);
+  lookups = static_cast<double>(names.size()) * dfa_iterations;
+  printf("%zu names, %d iterations: DFA %.3f s, %.3f M/s (%d found)\n", names.size(), dfa_iterations, dfa_seconds,
+         lookups / dfa_seconds / 1e6, dfa_found);
+  return 0;
+}
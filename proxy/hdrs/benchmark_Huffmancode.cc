@@ -0,0 +1,127 @@
+/** @file
+
+  Throughput of the HPACK / QPACK Huffman codec.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  @section details Details
+
+  Usage: benchmark_Huffmancode [-n iterations] [-j]
+
+  Encodes and decodes a set of header values typical of HTTP/2 requests, large cookies among them.
+  With -j the results are JSON lines, for `make bench`.
+ */
+
+#include "HuffmanCodec.h"
+#include "tscore/ink_hrtime.h"
+#include "bench_report.h"
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+namespace
+{
+const char *const VALUES[] = {
+  "Mozilla/5.0 (Windows NT 10.0; Win64; x64) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/90.0.4430.93 Safari/537.36",
+  "text/html,application/xhtml+xml,application/xml;q=0.9,image/avif,image/webp,image/apng,*/*;q=0.8",
+  "gzip, deflate, br",
+  "en-US,en;q=0.9",
+  "https://en.wikipedia.org/wiki/Main_Page",
+  "WMF-Last-Access=05-May-2021; WMF-Last-Access-Global=05-May-2021; GeoIP=US:CA:San_Jose:37.33:-121.89:v4; "
+  "enwikimwuser-sessionId=8f0c1d5e2b7a4c3d9e6f; _ga=GA1.2.1234567890.1620211122; _gid=GA1.2.987654321.1620211122; "
+  "session=eyJhbGciOiJSUzI1NiIsInR5cCI6IkpXVCJ9.eyJzdWIiOiIxMjM0NTY3ODkwIiwibmFtZSI6IkpvaG4gRG9lIiwiaWF0IjoxNTE2MjM5MDIyfQ; "
+  "prefs=lang%3Den%26theme%3Ddark%26tz%3DAmerica%2FLos_Angeles",
+  "Bearer eyJhbGciOiJSUzI1NiIsInR5cCI6IkpXVCJ9.eyJzdWIiOiIxMjM0NTY3ODkwIiwibmFtZSI6IkpvaG4gRG9lIiwiaWF0IjoxNTE2",
+  "/assets/img/products/2021/05/sku-889172_1200x1200.jpg?v=1620211122&width=640",
+  "Wed, 05 May 2021 10:38:42 GMT",
+};
+} // namespace
+
+int
+main(int argc, char *argv[])
+{
+  int iterations = 200000;
+  bool json      = false;
+  int opt;
+  while ((opt = getopt(argc, argv, "n:j")) != -1) {
+    if (opt == 'n') {
+      iterations = atoi(optarg);
+    } else if (opt == 'j') {
+      json = true;
+    } else {
+      fprintf(stderr, "usage: %s [-n iterations] [-j]\n", argv[0]);
+      return 1;
+    }
+  }
+
+  hpack_huffman_init();
+
+  std::vector<std::string> encoded;
+  size_t plain_bytes = 0;
+  for (auto value : VALUES) {
+    std::string plain(value);
+    std::string code(huffman_encode_length(reinterpret_cast<const uint8_t *>(plain.data()), plain.size()), '\0');
+    huffman_encode(reinterpret_cast<uint8_t *>(&code[0]), reinterpret_cast<const uint8_t *>(plain.data()), plain.size());
+    encoded.push_back(code);
+    plain_bytes += plain.size();
+  }
+
+  std::vector<uint8_t> out(8192);
+  int64_t check  = 0;
+  ink_hrtime now = ink_get_hrtime_internal();
+  for (int i = 0; i < iterations; ++i) {
+    for (auto value : VALUES) {
+      check += huffman_encode(out.data(), reinterpret_cast<const uint8_t *>(value), strlen(value));
+    }
+  }
+  double encode_seconds = static_cast<double>(ink_get_hrtime_internal() - now) / HRTIME_SECOND;
+
+  now = ink_get_hrtime_internal();
+  for (int i = 0; i < iterations; ++i) {
+    for (auto &code : encoded) {
+      int64_t len =
+        huffman_decode(reinterpret_cast<char *>(out.data()), reinterpret_cast<const uint8_t *>(code.data()), code.size());
+      if (len < 0) {
+        fprintf(stderr, "decode error\n");
+        return 1;
+      }
+      check += len;
+    }
+  }
+  double decode_seconds = static_cast<double>(ink_get_hrtime_internal() - now) / HRTIME_SECOND;
+
+  hpack_huffman_fin();
+
+  if (json) {
+    int64_t ops = static_cast<int64_t>(std::size(VALUES)) * iterations;
+    bench_report(true, "huffman_encode", ops, encode_seconds);
+    bench_report(true, "huffman_decode", ops, decode_seconds);
+    return 0;
+  }
+
+  double total = static_cast<double>(plain_bytes) * iterations;
+  printf("%zu bytes, %d iterations: encode %.3f s, %.1f MB/s; decode %.3f s, %.1f MB/s (%" PRId64 ")\n", plain_bytes, iterations,
+         encode_seconds, total / encode_seconds / 1e6, decode_seconds, total / decode_seconds / 1e6, check);
+  return 0;
+}
@@ -0,0 +1,121 @@
+/** @file
+
+  Throughput of the cache key hash of URLs.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  @section details Details
+
+  Usage: benchmark_UrlHash [-n iterations] [-j]
+
+  Hashes URLs with @c url_CryptoHash_get, plain ones that take its fast path and ones with a query
+  that take the general path. With -j the results are JSON lines, for `make bench`.
+ */
+
+#include "URL.h"
+#include "tscore/ink_hrtime.h"
+#include "bench_report.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <unistd.h>
+#include <vector>
+
+extern int cmd_disable_pfreelist;
+
+namespace
+{
+const char *const FAST_URLS[] = {
+  "http://en.wikipedia.org/wiki/Apache_Traffic_Server",
+  "https://cdn.shop.example.net/assets/img/products/2021/05/sku-889172_1200x1200.jpg",
+  "http://static.example.com:8080/js/vendor.3f9c2a1b.min.js",
+};
+
+const char *const GENERAL_URLS[] = {
+  "http://en.wikipedia.org/wiki/Special:Search?search=apache+traffic+server&go=Go&ns0=1",
+  "https://cdn.shop.example.net/assets/img/products/2021/05/sku-889172_1200x1200.jpg?v=1620211122&width=640",
+  "http://api.example.com/api/v2/orders/3432/items%20list?page=2",
+};
+
+std::vector<URL>
+parse_urls(HdrHeap *heap, const char *const *urls, size_t count)
+{
+  std::vector<URL> parsed(count);
+  for (size_t i = 0; i < count; ++i) {
+    parsed[i].create(heap);
+    if (parsed[i].parse(urls[i], strlen(urls[i])) != PARSE_RESULT_DONE) {
+      fprintf(stderr, "cannot parse %s\n", urls[i]);
+      exit(1);
+    }
+  }
+  return parsed;
+}
+
+double
+time_hash(std::vector<URL> const &urls, int iterations, uint64_t &check)
+{
+  CryptoHash hash;
+  ink_hrtime now = ink_get_hrtime_internal();
+  for (int i = 0; i < iterations; ++i) {
+    for (auto const &url : urls) {
+      url.hash_get(&hash);
+      check += hash.u64[0];
+    }
+  }
+  return static_cast<double>(ink_get_hrtime_internal() - now) / HRTIME_SECOND;
+}
+} // namespace
+
+int
+main(int argc, char *argv[])
+{
+  int iterations = 500000;
+  bool json      = false;
+  int opt;
+  while ((opt = getopt(argc, argv, "n:j")) != -1) {
+    if (opt == 'n') {
+      iterations = atoi(optarg);
+    } else if (opt == 'j') {
+      json = true;
+    } else {
+      fprintf(stderr, "usage: %s [-n iterations] [-j]\n", argv[0]);
+      return 1;
+    }
+  }
+
+  cmd_disable_pfreelist = true;
+  url_init();
+
+  HdrHeap *heap            = new_HdrHeap();
+  std::vector<URL> fast    = parse_urls(heap, FAST_URLS, std::size(FAST_URLS));
+  std::vector<URL> general = parse_urls(heap, GENERAL_URLS, std::size(GENERAL_URLS));
+  uint64_t check           = 0;
+  double fast_seconds      = time_hash(fast, iterations, check);
+  double general_seconds   = time_hash(general, iterations, check);
+
+  bench_report(json, "url_CryptoHash_get_fast", static_cast<int64_t>(fast.size()) * iterations, fast_seconds);
+  bench_report(json, "url_CryptoHash_get_general", static_cast<int64_t>(general.size()) * iterations, general_seconds);
+  if (!json) {
+    printf("(%" PRIu64 ")\n", check);
+  }
+  heap->destroy();
+  return 0;
+}
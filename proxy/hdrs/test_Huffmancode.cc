@@ -134,7 +134,12 @@ values_test()
     encoded_mapped.y[2] = encoded.y[1];
     encoded_mapped.y[3] = encoded.y[0];
 
-    int bytes        = huffman_decode(dst_start, encoded_mapped.y, encoded_size);
+    int bytes = huffman_decode(dst_start, encoded_mapped.y, encoded_size);
+    if (i / 2 == 256) {
+      // EOS in a string is an error, RFC 7541 5.2
+      assert(bytes == -1);
+      continue;
+    }
     char ascii_value = i / 2;
     assert(dst_start[0] == ascii_value);
     assert(bytes == 1);
@@ -171,6 +176,44 @@ encode_test()
   }
 }
 
+void
+decode_test()
+{
+  char dst[64];
+
+  for (const auto &i : huffman_encode_test_data) {
+    int64_t decoded_len = huffman_decode(dst, i.expect, i.expect_len);
+
+    assert(decoded_len == i.src_len);
+    assert(memcmp(i.src, dst, decoded_len) == 0);
+  }
+
+  // Padding of 8 bits or more, padding with a 0 bit in it and EOS itself are errors.
+  assert(huffman_decode(dst, (const uint8_t *)"\x07\xff", 2) == -1);
+  assert(huffman_decode(dst, (const uint8_t *)"\x06", 1) == -1);
+  assert(huffman_decode(dst, (const uint8_t *)"\xff\xff\xff\xff", 4) == -1);
+}
+
+void
+round_trip_test()
+{
+  uint8_t src[256];
+  uint8_t encoded[256 * 4];
+  char decoded[256];
+
+  for (int i = 0; i < 256; i++) {
+    src[i] = i;
+  }
+  for (uint32_t len = 0; len <= sizeof(src); len++) {
+    int64_t encoded_len = huffman_encode(encoded, src, len);
+    assert(encoded_len == huffman_encode_length(src, len));
+
+    int64_t decoded_len = huffman_decode(decoded, encoded, encoded_len);
+    assert(decoded_len == len);
+    assert(memcmp(src, decoded, len) == 0);
+  }
+}
+
 int
 main()
 {
@@ -180,6 +223,8 @@ main()
     random_test();
   }
   values_test();
+  decode_test();
+  round_trip_test();
 
   hpack_huffman_fin();
 
@@ -130,3 +130,94 @@ TEST_CASE("HdrHeap", "[proxy][hdrheap]")
   // Clean up
   heap->destroy();
 }
+
+TEST_CASE("HdrHeap shared strings", "[proxy][hdrheap]")
+{
+  HdrHeap *heap = new_HdrHeap();
+  URLImpl *url  = url_create(heap);
+
+  url_path_set(heap, url, "first/path", 10, true);
+  url_path_set(heap, url, "second/path", 11, true);
+  // Replacing a string only this heap uses loses its space
+  CHECK(heap->m_lost_string_space == 10);
+
+  HdrHeap *copy     = new_HdrHeap();
+  URLImpl *url_copy = url_create(copy);
+  url_copy_onto(url, heap, url_copy, copy, true);
+  CHECK(copy->m_lost_string_space == 10);
+
+  // Both heaps use the string replaced here, neither loses anything
+  url_path_set(copy, url_copy, "third/path", 10, true);
+  CHECK(copy->m_lost_string_space == 10);
+  url_path_set(heap, url, "fourth/path", 11, true);
+  CHECK(heap->m_lost_string_space == 10);
+
+  // Once the copy is gone the strings belong to the original alone again
+  copy->destroy();
+  url_path_set(heap, url, "fifth/path", 10, true);
+  CHECK(heap->m_lost_string_space == 21);
+
+  heap->destroy();
+}
+
+TEST_CASE("HdrHeap role sizing", "[proxy][hdrheap]")
+{
+  // Heaps without a role keep the default size
+  HdrHeap *heap = new_HdrHeap(HDR_HEAP_ROLE_NONE);
+  CHECK(heap->m_size == HdrHeap::DEFAULT_SIZE);
+  CHECK(heap->m_role == HDR_HEAP_ROLE_NONE);
+  heap->destroy();
+
+  // Fill server response heaps well past the default, later ones start out larger
+  for (int i = 0; i < 8; ++i) {
+    heap = new_HdrHeap(HDR_HEAP_ROLE_SERVER_RESPONSE);
+    CHECK(heap->m_role == HDR_HEAP_ROLE_SERVER_RESPONSE);
+    for (int j = 0; j < 100; ++j) {
+      url_create(heap);
+    }
+    heap->destroy();
+  }
+  heap = new_HdrHeap(HDR_HEAP_ROLE_SERVER_RESPONSE);
+  CHECK(heap->m_size > HdrHeap::DEFAULT_SIZE);
+  CHECK(heap->m_size <= HdrHeap::DEFAULT_SIZE * 4);
+  heap->destroy();
+
+  // Other roles are not affected
+  heap = new_HdrHeap(HDR_HEAP_ROLE_CLIENT_REQUEST);
+  CHECK(heap->m_size == HdrHeap::DEFAULT_SIZE);
+  heap->destroy();
+
+  // Heaps of each size class go back to their own freelist and come back at that size
+  for (int size : {HdrHeap::DEFAULT_SIZE * 2, HdrHeap::DEFAULT_SIZE * 4}) {
+    heap = new_HdrHeap(size);
+    CHECK(heap->m_size == size);
+    heap->destroy();
+  }
+}
+
+TEST_CASE("HdrHeap reset", "[proxy][hdrheap]")
+{
+  HdrHeap *heap = new_HdrHeap(HDR_HEAP_ROLE_CLIENT_REQUEST);
+  int free_size = heap->m_free_size;
+
+  // Overflow into a chained heap and a string heap
+  for (int i = 0; i < 100; ++i) {
+    URLImpl *url = url_create(heap);
+    url_path_set(heap, url, "some/path", 9, true);
+  }
+  CHECK(heap->m_next != nullptr);
+  CHECK(heap->m_read_write_heap);
+
+  heap->reset();
+  CHECK(heap->m_next == nullptr);
+  CHECK(!heap->m_read_write_heap);
+  CHECK(heap->m_free_size == free_size);
+  CHECK(heap->m_role == HDR_HEAP_ROLE_CLIENT_REQUEST);
+
+  // And it takes new objects as a new heap would
+  URLImpl *url = url_create(heap);
+  url_path_set(heap, url, "other/path", 10, true);
+  CHECK(heap->m_free_size < free_size);
+
+  heap->destroy();
+}
@@ -91,6 +91,99 @@ TEST_CASE("HdrTestHttpParse", "[proxy][hdrtest]")
   }
 }
 
+TEST_CASE("HdrTokenTokenize", "[proxy][hdrtoken]")
+{
+  for (int i = 0; i < hdrtoken_num_wks; ++i) {
+    std::string name(hdrtoken_index_to_wks(i));
+    const char *wks = nullptr;
+
+    // The WKS itself, a copy of it and a copy in another case all give the same index.
+    CHECK(hdrtoken_tokenize(hdrtoken_index_to_wks(i), name.size()) == i);
+    CHECK(hdrtoken_tokenize(name.data(), name.size(), &wks) == i);
+    CHECK(wks == hdrtoken_index_to_wks(i));
+    for (char &c : name) {
+      c = isupper(static_cast<unsigned char>(c)) ? tolower(c) : toupper(c);
+    }
+    CHECK(hdrtoken_tokenize(name.data(), name.size()) == i);
+  }
+
+  for (const char *name : {"", "A", "Accep", "Accept-", "Accept-Foo", "X-Unknown", "gzipx", "Content-Lengt", "Hosts"}) {
+    const char *wks = "";
+    CHECK(hdrtoken_tokenize(name, strlen(name), &wks) == -1);
+    CHECK(hdrtoken_string_to_wks(name) == nullptr);
+  }
+}
+
+TEST_CASE("HdrTestMarshalUnmarshaled", "[proxy][hdrtest]")
+{
+  static const char request[] = "GET http://www.example.com/a/b.jpg?c=d HTTP/1.1\r\n"
+                                "Host: www.example.com\r\n"
+                                "User-Agent: foobar\r\n"
+                                "Accept: */*\r\n"
+                                "Cookie: a=1\r\n"
+                                "Cookie: b=2\r\n"
+                                "X-Long: 0123456789012345678901234567890123456789\r\n"
+                                "\r\n";
+
+  HTTPParser parser;
+  HTTPHdr hdr;
+  const char *start = request;
+
+  http_parser_init(&parser);
+  hdr.create(HTTP_TYPE_REQUEST);
+  REQUIRE(hdr.parse_req(&parser, &start, request + sizeof(request) - 1, true) == PARSE_RESULT_DONE);
+  // Leave a dead field behind, a marshaled heap keeps its slot.
+  hdr.field_delete("Accept", 6);
+  CHECK_FALSE(hdr.m_heap->is_unmarshaled_in_place());
+
+  RefCountObj ref;
+  ref.refcount_inc();
+
+  std::unique_ptr<char[]> first_buf(new char[4096]);
+  std::unique_ptr<char[]> second_buf(new char[4096]);
+  int first_len = hdr.m_heap->marshal(first_buf.get(), 4096);
+  REQUIRE(first_len > 0);
+  CHECK(first_len == hdr.m_heap->marshal_length());
+
+  HTTPHdr first;
+  REQUIRE(first.unmarshal(first_buf.get(), first_len, &ref) == first_len);
+  REQUIRE(first.m_heap->is_unmarshaled_in_place());
+  CHECK(first.m_heap->marshal_length() == first_len);
+
+  // Marshaling the unmarshaled heap again gives the same thing at the same size.
+  CHECK(first.m_heap->marshal(second_buf.get(), first_len - 8) < 0);
+  int second_len = first.m_heap->marshal(second_buf.get(), 4096);
+  REQUIRE(second_len == first_len);
+  // The first copy is left as it was.
+  CHECK(first.m_heap->is_unmarshaled_in_place());
+
+  HTTPHdr second;
+  REQUIRE(second.unmarshal(second_buf.get(), second_len, &ref) == second_len);
+
+  char expected[1024], actual[1024];
+  int expected_len = 0, actual_len = 0, offset = 0;
+  REQUIRE(hdr.print(expected, sizeof(expected), &expected_len, &offset) == 1);
+  offset = 0;
+  REQUIRE(second.print(actual, sizeof(actual), &actual_len, &offset) == 1);
+  CHECK(std::string(actual, actual_len) == std::string(expected, expected_len));
+  MIMEField *cookie = second.field_find("Cookie", 6);
+  REQUIRE(cookie != nullptr);
+  CHECK(cookie->has_dups());
+  CHECK(second.field_find("Accept", 6) == nullptr);
+
+  // Copies out of the second one refer to its strings.
+  HTTPHdr copy;
+  copy.create(HTTP_TYPE_REQUEST);
+  copy.copy(&second);
+  int copy_len = 0;
+  offset       = 0;
+  REQUIRE(copy.print(actual, sizeof(actual), &copy_len, &offset) == 1);
+  CHECK(std::string(actual, copy_len) == std::string(expected, expected_len));
+
+  copy.destroy();
+  hdr.destroy();
+}
+
 TEST_CASE("MIMEScanner_fragments", "[proxy][mimescanner_fragments]")
 {
   constexpr ts::TextView const message = "GET /index.html HTTP/1.0\r\n";
@@ -2033,3 +2126,31 @@ TEST_CASE("HdrTest", "[proxy][hdrtest]")
     }
   }
 }
+
+TEST_CASE("HttpCompatUserAgentClass", "[proxy][httpcompat]")
+{
+  struct {
+    const char *ua;
+    HttpCompat::UserAgentClass expected;
+  } tests[] = {
+    {"Mozilla/5.0 (Windows NT 10.0; Win64; x64) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/120.0 Safari/537.36",
+     HttpCompat::UA_CLASS_DESKTOP},
+    {"Mozilla/5.0 (iPhone; CPU iPhone OS 17_0 like Mac OS X) AppleWebKit/605.1.15 Mobile/15E148", HttpCompat::UA_CLASS_MOBILE},
+    {"Mozilla/5.0 (Linux; Android 14; Pixel 8) AppleWebKit/537.36 Chrome/120.0 Mobile Safari/537.36", HttpCompat::UA_CLASS_MOBILE},
+    {"Mozilla/5.0 (Linux; Android 13; SM-X700) AppleWebKit/537.36 Chrome/120.0 Safari/537.36", HttpCompat::UA_CLASS_TABLET},
+    {"Mozilla/5.0 (iPad; CPU OS 17_0 like Mac OS X) AppleWebKit/605.1.15 Mobile/15E148", HttpCompat::UA_CLASS_TABLET},
+    {"curl/8.4.0", HttpCompat::UA_CLASS_DESKTOP},
+  };
+
+  MIMEHdr hdr;
+  hdr.create(nullptr);
+  CHECK(HttpCompat::user_agent_class(hdr.field_find(MIME_FIELD_USER_AGENT, MIME_LEN_USER_AGENT)) == HttpCompat::UA_CLASS_DESKTOP);
+
+  for (auto const &test : tests) {
+    hdr.value_set(MIME_FIELD_USER_AGENT, MIME_LEN_USER_AGENT, test.ua, strlen(test.ua));
+    INFO(test.ua);
+    CHECK(HttpCompat::user_agent_class(hdr.field_find(MIME_FIELD_USER_AGENT, MIME_LEN_USER_AGENT)) == test.expected);
+  }
+
+  hdr.destroy();
+}
@@ -21,7 +21,10 @@
   limitations under the License.
  */
 
+#include <cctype>
 #include <cstdio>
+#include <string>
+#include <vector>
 
 #include "catch.hpp"
 
@@ -64,6 +67,102 @@ TEST_CASE("Mime", "[proxy][mime]")
   hdr.destroy();
 }
 
+namespace
+{
+// Every find through the name index has to give what the walk over the fields gives.
+void
+check_name_index(MIMEHdr &hdr, std::vector<std::string> const &names)
+{
+  for (auto const &name : names) {
+    int len = static_cast<int>(name.size());
+    std::string upper(name);
+    for (auto &c : upper) {
+      c = toupper(c);
+    }
+    CHECK(hdr.field_find(name.data(), len) == _mime_hdr_field_list_search_by_string(hdr.m_mime, name.data(), len));
+    CHECK(hdr.field_find(upper.data(), len) == hdr.field_find(name.data(), len));
+  }
+}
+} // namespace
+
+TEST_CASE("MimeNameIndex", "[proxy][mime]")
+{
+  MIMEHdr hdr;
+  hdr.create(NULL);
+
+  std::vector<std::string> names;
+  for (int i = 0; i < 40; ++i) {
+    names.push_back("X-Custom-" + std::to_string(i));
+  }
+  names.push_back("Content-Type"); // a well known name, looked up with a plain string
+  names.push_back("X-Absent");
+
+  for (int i = 0; i < 40; ++i) {
+    for (int dups = 0; dups < 1 + (i % 3); ++dups) {
+      MIMEField *field = hdr.field_create(names[i].data(), names[i].size());
+      hdr.field_attach(field);
+    }
+  }
+  MIMEField *ctype = hdr.field_create("Content-Type", 12);
+  hdr.field_attach(ctype);
+
+  REQUIRE(!hdr.m_mime->m_name_index.m_overflow);
+  CHECK(hdr.field_find("X-Absent", 8) == nullptr);
+  CHECK(hdr.field_find("Content-Type", 12) == ctype);
+  check_name_index(hdr, names);
+
+  // Detach heads, the dups after them and names with no dups.
+  for (int i = 0; i < 40; i += 4) {
+    MIMEField *field = hdr.field_find(names[i].data(), names[i].size());
+    REQUIRE(field != nullptr);
+    if (i % 8 == 0 && field->m_next_dup) {
+      hdr.field_detach(field->m_next_dup, false);
+    } else {
+      hdr.field_delete(field, false);
+    }
+  }
+  check_name_index(hdr, names);
+
+  MIMEHdr copy;
+  copy.create(NULL);
+  copy.copy(&hdr);
+  REQUIRE(!copy.m_mime->m_name_index.m_overflow);
+  check_name_index(copy, names);
+
+  // Too many names for the index, finds walk the fields.
+  for (int i = 40; i < 60; ++i) {
+    names.push_back("X-More-" + std::to_string(i));
+    MIMEField *field = hdr.field_create(names.back().data(), names.back().size());
+    hdr.field_attach(field);
+  }
+  CHECK(hdr.m_mime->m_name_index.m_overflow);
+  check_name_index(hdr, names);
+
+  copy.destroy();
+  hdr.destroy();
+}
+
+TEST_CASE("MimeCacheControlDirective", "[proxy][mime]")
+{
+  MIMEHdr hdr;
+  hdr.create(NULL);
+
+  CHECK(hdr.get_cc_directive_secs("stale-while-revalidate", 22) == -1);
+
+  const char *value = "max-age=60, Stale-While-Revalidate=30, stale-if-error=\"600\", stale-while-revalidate-x=5";
+  hdr.value_set("Cache-Control", 13, value, strlen(value));
+  CHECK(hdr.get_cc_directive_secs("stale-while-revalidate", 22) == 30);
+  CHECK(hdr.get_cc_directive_secs("stale-if-error", 14) == 600);
+  CHECK(hdr.get_cc_directive_secs("s-maxage", 8) == -1);
+
+  value = "stale-if-error, stale-while-revalidate=-1";
+  hdr.value_set("Cache-Control", 13, value, strlen(value));
+  CHECK(hdr.get_cc_directive_secs("stale-if-error", 14) == -1);
+  CHECK(hdr.get_cc_directive_secs("stale-while-revalidate", 22) == -1);
+
+  hdr.destroy();
+}
+
 TEST_CASE("MimeGetHostPortValues", "[proxy][mimeport]")
 {
   MIMEHdr hdr;
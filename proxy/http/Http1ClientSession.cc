@@ -224,6 +224,10 @@ Http1ClientSession::do_io_close(int alerrno)
   // Prevent double closing
   ink_release_assert(read_state != HCS_CLOSED);
 
+  if (_vc) {
+    _vc->set_migration_cont(nullptr);
+  }
+
   // If we have an attached server session, release
   //   it back to our shared pool
   if (bound_ss) {
@@ -355,6 +359,21 @@ Http1ClientSession::state_slave_keep_alive(int event, void *data)
 int
 Http1ClientSession::state_keep_alive(int event, void *data)
 {
+  if (event == NET_EVENT_MIGRATE) {
+    // Only a connection with nothing else going on moves, it is then taken up on the target thread.
+    EThread *target = static_cast<EThread *>(data);
+    if (bound_ss || _reader->is_read_avail_more_than(0) || !dynamic_cast<UnixNetVConnection *>(_vc)) {
+      return EVENT_CONT;
+    }
+    HttpSsnDebug("[%" PRId64 "] moving keep-alive session to a less loaded thread", con_id);
+    _vc->set_migration_cont(nullptr);
+    _vc->remove_from_keep_alive_queue();
+    ka_vio = this->do_io_read(this, 0, nullptr);
+    SET_HANDLER(&Http1ClientSession::state_migrate);
+    migrate_event = target->schedule_imm(this);
+    return EVENT_DONE;
+  }
+
   // Route the event.  It is either for vc or
   //  the origin server slave vc
   if (data && data == slave_ka_vio) {
@@ -393,6 +412,49 @@ Http1ClientSession::state_keep_alive(int event, void *data)
   return 0;
 }
 
+// Waiting for the target thread of a NET_EVENT_MIGRATE, anything from the old VC ends the session.
+int
+Http1ClientSession::state_migrate(int event, void *data)
+{
+  STATE_ENTER(&Http1ClientSession::state_migrate, event, data);
+
+  if (event != EVENT_IMMEDIATE || data != migrate_event) {
+    if (migrate_event) {
+      migrate_event->cancel();
+      migrate_event = nullptr;
+    }
+    this->do_io_close(EHTTP_ERROR);
+    return 0;
+  }
+  migrate_event = nullptr;
+
+  EThread *ethread           = this_ethread();
+  UnixNetVConnection *old_vc = static_cast<UnixNetVConnection *>(_vc);
+  ink_hrtime timeout         = old_vc->get_inactivity_timeout();
+  UnixNetVConnection *new_vc = old_vc->migrateToCurrentThread(this, ethread);
+  if (!new_vc) {
+    // The old VC is already closed.
+    _vc = nullptr;
+    this->do_io_close(EHTTP_ERROR);
+    return 0;
+  }
+
+  // The session takes the mutex of its new thread.
+  new_vc->mutex = get_NetHandler(ethread)->mutex;
+  mutex         = new_vc->mutex;
+  trans.mutex   = mutex;
+  _vc           = new_vc;
+
+  SCOPED_MUTEX_LOCK(lock, mutex, ethread);
+  SET_HANDLER(&Http1ClientSession::state_keep_alive);
+  this->do_io_write(this, 0, nullptr);
+  ka_vio = this->do_io_read(this, INT64_MAX, read_buffer);
+  _vc->set_inactivity_timeout(timeout);
+  _vc->add_to_keep_alive_queue();
+  _vc->set_migration_cont(this);
+  return 0;
+}
+
 // Called from the Http1Transaction::release
 void
 Http1ClientSession::release(ProxyTransaction *trans)
@@ -421,6 +483,9 @@ Http1ClientSession::release(ProxyTransaction *trans)
     if (_vc) {
       _vc->cancel_active_timeout();
       _vc->add_to_keep_alive_queue();
+      if (!bound_ss) {
+        _vc->set_migration_cont(this);
+      }
     }
     trans->destroy();
   }
@@ -435,6 +500,7 @@ Http1ClientSession::new_transaction()
     return;
   }
 
+  _vc->set_migration_cont(nullptr);
   if (!_vc->add_to_active_queue()) {
     // no room in the active queue close the connection
     this->do_io_close();
@@ -467,6 +533,10 @@ Http1ClientSession::attach_server_session(Http1ServerSession *ssession, bool tra
     // handling potential keep-alive here
     clear_session_active();
 
+    if (_vc) {
+      _vc->set_migration_cont(nullptr);
+    }
+
     // Since this our slave, issue an IO to detect a close and
     //  have it call the client session back.  This IO also prevent
     //  the server net conneciton from calling back a dead sm
@@ -87,6 +87,7 @@ private:
   int state_keep_alive(int event, void *data);
   int state_slave_keep_alive(int event, void *data);
   int state_wait_for_close(int event, void *data);
+  int state_migrate(int event, void *data);
 
   enum C_Read_State {
     HCS_INIT,
@@ -109,6 +110,9 @@ private:
   VIO *ka_vio       = nullptr;
   VIO *slave_ka_vio = nullptr;
 
+  /// The move to another thread, see NET_EVENT_MIGRATE.
+  Event *migrate_event = nullptr;
+
   Http1ServerSession *bound_ss = nullptr;
 
   int released_transactions = 0;
@@ -35,6 +35,7 @@
 #include "Http1ServerSession.h"
 #include "HttpSessionManager.h"
 #include "HttpSM.h"
+#include "PreWarmManager.h"
 
 static int64_t next_ss_id = static_cast<int64_t>(0);
 ClassAllocator<Http1ServerSession> httpServerSessionAllocator("httpServerSessionAllocator");
@@ -52,7 +53,7 @@ Http1ServerSession::destroy()
   }
 
   mutex.clear();
-  if (TS_SERVER_SESSION_SHARING_POOL_THREAD == sharing_pool) {
+  if (TS_SERVER_SESSION_SHARING_POOL_GLOBAL != sharing_pool) {
     THREAD_FREE(this, httpServerSessionAllocator, this_thread());
   } else {
     httpServerSessionAllocator.free(this);
@@ -72,8 +73,10 @@ Http1ServerSession::new_connection(NetVConnection *new_vc)
   con_id = ink_atomic_increment((&next_ss_id), 1);
 
   magic = HTTP_SS_MAGIC_ALIVE;
-  HTTP_SUM_GLOBAL_DYN_STAT(http_current_server_connections_stat, 1); // Update the true global stat
-  HTTP_INCREMENT_DYN_STAT(http_total_server_connections_stat);
+  if (!multiplexed) {
+    HTTP_SUM_GLOBAL_DYN_STAT(http_current_server_connections_stat, 1); // Update the true global stat
+    HTTP_INCREMENT_DYN_STAT(http_total_server_connections_stat);
+  }
 
   read_buffer = new_MIOBuffer(HTTP_SERVER_RESP_HDR_BUFFER_INDEX);
 
@@ -129,8 +132,10 @@ Http1ServerSession::do_io_close(int alerrno)
     w.print("[{}] session close: nevtc {:x}", con_id, server_vc);
   }
 
-  HTTP_SUM_GLOBAL_DYN_STAT(http_current_server_connections_stat, -1); // Make sure to work on the global stat
-  HTTP_SUM_DYN_STAT(http_transactions_per_server_con, transact_count);
+  if (!multiplexed) {
+    HTTP_SUM_GLOBAL_DYN_STAT(http_current_server_connections_stat, -1); // Make sure to work on the global stat
+    HTTP_SUM_DYN_STAT(http_transactions_per_server_con, transact_count);
+  }
 
   // Update upstream connection tracking data if present.
   if (conn_track_group) {
@@ -139,6 +144,7 @@ Http1ServerSession::do_io_close(int alerrno)
       if (debug_p) {
         w.print(" conn track group ({}) count {}", conn_track_group->_key, n);
       }
+      conn_track_group->slot_released();
     } else {
       // A bit dubious, as there's no guarantee it's still negative, but even that would be interesting to know.
       Error("[http_ss] [%" PRId64 "] number of connections should be greater than or equal to zero: %u", con_id,
@@ -157,6 +163,9 @@ Http1ServerSession::do_io_close(int alerrno)
   if (to_parent_proxy) {
     HTTP_DECREMENT_DYN_STAT(http_current_parent_proxy_connections_stat);
   }
+  if (prewarm_target) {
+    PreWarmManager::session_wasted(this);
+  }
   destroy();
 }
 
@@ -179,8 +188,9 @@ Http1ServerSession::release()
 
   server_vc->control_flags.set_flags(0);
 
-  // Private sessions are never released back to the shared pool
-  if (private_session || sharing_match == 0) {
+  // Private sessions are never released back to the shared pool, nor are streams, their
+  //   connection stays open on its own
+  if (private_session || sharing_match == 0 || multiplexed) {
     this->do_io_close();
     return;
   }
@@ -38,6 +38,7 @@
 #include "HttpProxyAPIEnums.h"
 
 class HttpSM;
+struct PreWarmTarget;
 class MIOBuffer;
 class IOBufferReader;
 
@@ -145,6 +146,13 @@ public:
   // singleton that keeps track of the connection counts.
   OutboundConnTrack::Group *conn_track_group = nullptr;
 
+  // Set while a prewarmed connection waits in the pool for its first transaction.
+  PreWarmTarget *prewarm_target = nullptr;
+
+  // Set when server_vc is a stream on a shared HTTP/2 connection. The connection is counted
+  //   and tracked by its Http2ServerSession, and the stream is never pooled.
+  bool multiplexed = false;
+
   // The ServerSession owns the following buffer which use
   //   for parsing the headers.  The server session needs to
   //   own the buffer so we can go from a keep-alive state
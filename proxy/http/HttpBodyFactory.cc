@@ -40,6 +40,7 @@
 #include "URL.h"
 #include "logging/Log.h"
 #include "logging/LogAccess.h"
+#include "logging/LogFormat.h"
 #include "HttpCompat.h"
 #include "tscore/I_Layout.h"
 
@@ -1060,6 +1061,10 @@ HttpBodyTemplate::HttpBodyTemplate()
   byte_count        = 0;
   template_buffer   = nullptr;
   template_pathname = nullptr;
+  n_fields          = -1;
+  printf_str        = nullptr;
+  fields            = nullptr;
+  body_length       = 0;
 }
 
 HttpBodyTemplate::~HttpBodyTemplate()
@@ -1074,6 +1079,40 @@ HttpBodyTemplate::reset()
   template_buffer = nullptr;
   byte_count      = 0;
   ats_free(template_pathname);
+  template_pathname = nullptr;
+  ats_free(printf_str);
+  printf_str = nullptr;
+  delete fields;
+  fields      = nullptr;
+  n_fields    = -1;
+  body_length = 0;
+}
+
+void
+HttpBodyTemplate::compile()
+{
+  char *fields_str = nullptr;
+  bool contains_aggregates;
+
+  n_fields = LogFormat::parse_format_string(template_buffer, &printf_str, &fields_str);
+  if (n_fields == 0) {
+    body_length = strlen(template_buffer);
+  } else if (n_fields > 0) {
+    fields = new LogFieldList;
+    if (LogFormat::parse_symbol_string(fields_str, fields, &contains_aggregates) != n_fields || contains_aggregates) {
+      // Leave the errors to the parse of each use, as before.
+      delete fields;
+      fields   = nullptr;
+      n_fields = -1;
+    }
+  }
+  if (n_fields <= 0) {
+    ats_free(printf_str);
+    printf_str = nullptr;
+  }
+  ats_free(fields_str);
+
+  Debug("body_factory", "    %d log fields in '%s'", n_fields, template_pathname);
 }
 
 int
@@ -1141,6 +1180,7 @@ HttpBodyTemplate::load_from_file(char *dir, char *file)
   template_buffer   = new_template_buffer;
   byte_count        = new_byte_count;
   template_pathname = ats_strdup(path);
+  compile();
 
   return 1;
 }
@@ -1152,11 +1192,16 @@ HttpBodyTemplate::build_instantiated_buffer(HttpTransact::State *context, int64_
 
   Debug("body_factory_instantiation", "    before instantiation: [%s]", template_buffer);
 
-  LogAccess la(context->state_machine);
+  if (n_fields == 0) {
+    buffer         = ats_strndup(template_buffer, body_length);
+    *buflen_return = body_length;
+  } else {
+    LogAccess la(context->state_machine);
 
-  buffer = resolve_logfield_string(&la, template_buffer);
+    buffer = n_fields > 0 ? resolve_logfield_string(&la, fields, printf_str) : resolve_logfield_string(&la, template_buffer);
 
-  *buflen_return = ((buffer == nullptr) ? 0 : strlen(buffer));
+    *buflen_return = ((buffer == nullptr) ? 0 : strlen(buffer));
+  }
   Debug("body_factory_instantiation", "    after instantiation: [%s]", buffer);
   Debug("body_factory", "  returning %" PRId64 " byte instantiated buffer", *buflen_return);
 
@@ -66,6 +66,8 @@
 #include <memory>
 #include <unordered_map>
 
+class LogFieldList;
+
 #define HTTP_BODY_TEMPLATE_MAGIC 0xB0DFAC00
 #define HTTP_BODY_SET_MAGIC 0xB0DFAC55
 #define HTTP_BODY_FACTORY_MAGIC 0xB0DFACFF
@@ -79,6 +81,9 @@
 //      to dump out the contents of the template, and to instantiate
 //      the template into a buffer given a context.
 //
+//      The log fields of the template are parsed once when it is
+//      loaded, and a template without any is its own body.
+//
 ////////////////////////////////////////////////////////////////////////
 
 class HttpBodyTemplate
@@ -100,6 +105,16 @@ public:
   int64_t byte_count;
   char *template_buffer;
   char *template_pathname;
+
+  // The template divided by LogFormat::parse_format_string, n_fields is -1
+  // if it could not be and the template is parsed on each use instead.
+  int n_fields;
+  char *printf_str;
+  LogFieldList *fields;
+  int64_t body_length; // of the template without fields
+
+private:
+  void compile();
 };
 
 ////////////////////////////////////////////////////////////////////////
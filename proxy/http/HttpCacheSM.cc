@@ -34,9 +34,16 @@
 #include "HttpSM.h"
 #include "HttpDebugNames.h"
 
-#define SM_REMEMBER(sm, e, r)                          \
-  {                                                    \
-    sm->history.push_back(MakeSourceLocation(), e, r); \
+#include <algorithm>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#define SM_REMEMBER(sm, e, r)                             \
+  {                                                       \
+    if (sm->history) {                                    \
+      sm->history->push_back(MakeSourceLocation(), e, r); \
+    }                                                     \
   }
 
 #define STATE_ENTER(state_name, event)                                                                                   \
@@ -59,6 +66,129 @@ HttpCacheAction::cancel(Continuation *c)
   }
 }
 
+//////////////////////////////////////////////////////////////////////////
+//
+//  Request collapsing
+//
+//  A transaction that finds the object it wants being written by another
+//  one waits on a list kept for that cache key, rather than retrying the
+//  cache every cache_open_read_retry_time. The writer empties the list once
+//  the response header is in the cache, which is when read-while-write can
+//  start, or when it gives up the write. The waiters then retry at once.
+//
+//////////////////////////////////////////////////////////////////////////
+namespace
+{
+struct CollapsedWrite {
+  int writers = 0;
+  std::vector<HttpCacheCollapseWaiter *> waiters;
+};
+
+struct CacheKeyHasher {
+  size_t
+  operator()(CacheKey const &key) const
+  {
+    return key.fold();
+  }
+};
+
+std::mutex collapse_mutex;
+std::unordered_map<CacheKey, CollapsedWrite, CacheKeyHasher> collapse_table;
+} // namespace
+
+// Runs with the mutex of the HttpSM, on its thread. Once in the list it is
+// deleted by whichever of the wake up, the timeout or the cancel comes last.
+struct HttpCacheCollapseWaiter : public Continuation {
+  struct WaitAction : public Action {
+    HttpCacheCollapseWaiter *waiter = nullptr;
+
+    void
+    cancel(Continuation *c = nullptr) override
+    {
+      Action::cancel(c);
+      waiter->abandon();
+    }
+  };
+
+  HttpCacheCollapseWaiter(HttpCacheSM *sm, CacheKey const &k)
+    : Continuation(sm->mutex), cache_sm(sm), key(k), thread(this_ethread())
+  {
+    SET_HANDLER(&HttpCacheCollapseWaiter::handle_event);
+    action.waiter = this;
+  }
+
+  int handle_event(int event, Event *e);
+  void abandon();
+  bool unregister();
+
+  HttpCacheSM *cache_sm;
+  CacheKey key;
+  EThread *thread;
+  Event *timeout  = nullptr;
+  bool registered = true; ///< Under collapse_mutex, false once a wake up is on its way.
+  WaitAction action;
+};
+
+bool
+HttpCacheCollapseWaiter::unregister()
+{
+  std::lock_guard<std::mutex> lock(collapse_mutex);
+  if (!registered) {
+    return false;
+  }
+  registered = false;
+  auto spot  = collapse_table.find(key);
+  if (spot != collapse_table.end()) {
+    auto &waiters = spot->second.waiters;
+    waiters.erase(std::remove(waiters.begin(), waiters.end(), this), waiters.end());
+  }
+  return true;
+}
+
+void
+HttpCacheCollapseWaiter::abandon()
+{
+  cache_sm->pending_action = nullptr;
+  cache_sm                 = nullptr;
+  if (timeout) {
+    timeout->cancel();
+    timeout = nullptr;
+  }
+  if (unregister()) {
+    delete this;
+  }
+}
+
+int
+HttpCacheCollapseWaiter::handle_event(int event, Event * /* e ATS_UNUSED */)
+{
+  bool timed_out = event == EVENT_INTERVAL;
+  if (timed_out) {
+    timeout = nullptr;
+    if (!unregister()) {
+      // The writer woke us up at the same time, that event does the rest.
+      return EVENT_DONE;
+    }
+  } else if (timeout) {
+    timeout->cancel();
+    timeout = nullptr;
+  }
+
+  if (cache_sm) {
+    HttpCacheSM *sm    = cache_sm;
+    sm->pending_action = nullptr;
+    if (timed_out) {
+      // Waited as long as all the retries would have, the next attempt is the last one.
+      HTTP_INCREMENT_DYN_STAT(http_cache_collapsed_timeout_stat);
+      sm->open_read_tries = std::max<int>(sm->open_read_tries, sm->master_sm->t_state.txn_conf->max_cache_open_read_retries);
+    }
+    Debug("http_cache", "[%" PRId64 "] collapsed wait %s", sm->master_sm->sm_id, timed_out ? "timed out" : "done");
+    sm->handleEvent(EVENT_INTERVAL, nullptr);
+  }
+  delete this;
+  return EVENT_DONE;
+}
+
 HttpCacheSM::HttpCacheSM()
   : Continuation(nullptr),
 
@@ -120,7 +250,7 @@ HttpCacheSM::state_cache_open_read(int event, void *data)
       if (open_read_tries <= master_sm->t_state.txn_conf->max_cache_open_read_retries) {
         // Retry to read; maybe the update finishes in time
         open_read_cb = false;
-        do_schedule_in();
+        do_schedule_in(master_sm->t_state.txn_conf->max_cache_open_read_retries - open_read_tries + 1);
       } else {
         // Give up; the update didn't finish in time
         // HttpSM will inform HttpTransact to 'proxy-only'
@@ -168,6 +298,11 @@ HttpCacheSM::state_cache_open_write(int event, void *data)
     ink_assert(cache_write_vc == nullptr);
     cache_write_vc = static_cast<CacheVConnection *>(data);
     open_write_cb  = true;
+    if (master_sm->t_state.http_config_param->cache_collapse_requests && !collapse_writer) {
+      std::lock_guard<std::mutex> lock(collapse_mutex);
+      ++collapse_table[cache_key.hash].writers;
+      collapse_writer = true;
+    }
     master_sm->handleEvent(event, data);
     break;
 
@@ -198,7 +333,8 @@ HttpCacheSM::state_cache_open_write(int event, void *data)
       open_write_cb = false;
       // reset captive_action since HttpSM cancelled it
       captive_action.cancelled = 0;
-      do_schedule_in();
+      do_schedule_in(read_retry_on_write_fail ? master_sm->t_state.txn_conf->max_cache_open_read_retries :
+                                                master_sm->t_state.txn_conf->max_cache_open_write_retries - open_write_tries + 1);
     } else {
       // The cache is hosed or full or something.
       // Forward the failure to the main sm
@@ -243,9 +379,15 @@ HttpCacheSM::state_cache_open_write(int event, void *data)
 }
 
 void
-HttpCacheSM::do_schedule_in()
+HttpCacheSM::do_schedule_in(int retries_left)
 {
   ink_assert(pending_action == nullptr);
+  if (master_sm->profile) {
+    master_sm->profile->lock_retry();
+  }
+  if (wait_for_writer(retries_left)) {
+    return;
+  }
   Action *action_handle =
     mutex->thread_holding->schedule_in(this, HRTIME_MSECONDS(master_sm->t_state.txn_conf->cache_open_read_retry_time));
 
@@ -256,6 +398,66 @@ HttpCacheSM::do_schedule_in()
   return;
 }
 
+bool
+HttpCacheSM::wait_for_writer(int retries_left)
+{
+  // Without a writer of ours to wait for, e.g. one that started before the
+  // setting was enabled, the retries are the only option.
+  if (!master_sm->t_state.http_config_param->cache_collapse_requests || collapse_writer) {
+    return false;
+  }
+
+  const OverridableHttpConfigParams *conf = master_sm->t_state.txn_conf;
+  HttpCacheCollapseWaiter *waiter         = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(collapse_mutex);
+    auto spot = collapse_table.find(cache_key.hash);
+    if (spot == collapse_table.end()) {
+      return false;
+    }
+    waiter = new HttpCacheCollapseWaiter(this, cache_key.hash);
+    spot->second.waiters.push_back(waiter);
+  }
+
+  // A wake up from another thread can not run before this returns, it needs our mutex.
+  ink_hrtime wait = HRTIME_MSECONDS(conf->cache_open_read_retry_time * std::max(retries_left, 1));
+  waiter->timeout = this_ethread()->schedule_in(waiter, wait);
+  pending_action  = &waiter->action;
+  HTTP_INCREMENT_DYN_STAT(http_cache_collapsed_wait_stat);
+  Debug("http_cache", "[%" PRId64 "] waiting for the writer of the object", master_sm->sm_id);
+  return true;
+}
+
+void
+HttpCacheSM::release_collapsed_waiters()
+{
+  if (!collapse_writer) {
+    return;
+  }
+  collapse_writer = false;
+
+  std::vector<HttpCacheCollapseWaiter *> waiters;
+  {
+    std::lock_guard<std::mutex> lock(collapse_mutex);
+    auto spot = collapse_table.find(cache_key.hash);
+    ink_assert(spot != collapse_table.end());
+    if (spot == collapse_table.end()) {
+      return;
+    }
+    waiters.swap(spot->second.waiters);
+    if (--spot->second.writers == 0) {
+      collapse_table.erase(spot);
+    }
+    for (auto waiter : waiters) {
+      waiter->registered = false;
+    }
+  }
+
+  for (auto waiter : waiters) {
+    waiter->thread->schedule_imm(waiter);
+  }
+}
+
 Action *
 HttpCacheSM::do_cache_open_read(const HttpCacheKey &key)
 {
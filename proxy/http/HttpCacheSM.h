@@ -40,6 +40,7 @@
 
 class HttpSM;
 class HttpCacheSM;
+struct HttpCacheCollapseWaiter;
 
 struct HttpCacheAction : public Action {
   HttpCacheAction();
@@ -54,6 +55,8 @@ struct HttpCacheAction : public Action {
 
 class HttpCacheSM : public Continuation
 {
+  friend struct HttpCacheCollapseWaiter;
+
 public:
   HttpCacheSM();
 
@@ -150,6 +153,7 @@ public:
   inline void
   abort_write()
   {
+    release_collapsed_waiters();
     if (cache_write_vc) {
       HTTP_DECREMENT_DYN_STAT(http_current_cache_connections_stat);
       cache_write_vc->do_io_close(0); // passing zero as aborting write is not an error
@@ -159,6 +163,7 @@ public:
   inline void
   close_write()
   {
+    release_collapsed_waiters();
     if (cache_write_vc) {
       HTTP_DECREMENT_DYN_STAT(http_current_cache_connections_stat);
       cache_write_vc->do_io_close();
@@ -183,8 +188,13 @@ public:
     abort_write();
   }
 
+  // Wake up the transactions waiting for this one to write the object, there is
+  // now something for them to read or nothing more to wait for.
+  void release_collapsed_waiters();
+
 private:
-  void do_schedule_in();
+  void do_schedule_in(int retries_left);
+  bool wait_for_writer(int retries_left);
   Action *do_cache_open_read(const HttpCacheKey &);
 
   int state_cache_open_read(int event, void *data);
@@ -211,4 +221,7 @@ private:
   // to keep track of multiple cache lookups
   int lookup_max_recursive = 0;
   int current_lookup_level = 0;
+
+  // Others may be waiting for the write lock we hold
+  bool collapse_writer = false;
 };
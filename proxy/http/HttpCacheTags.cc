@@ -0,0 +1,90 @@
+/** @file
+
+  Invalidation of cached objects by surrogate key, see HttpCacheTags.h
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "HttpCacheTags.h"
+
+#include <algorithm>
+#include <functional>
+#include <mutex>
+
+HttpCacheTags httpCacheTags;
+
+namespace
+{
+constexpr std::string_view SEPARATORS{" \t,"};
+} // namespace
+
+std::string_view
+HttpCacheTags::next_tag(std::string_view &tags)
+{
+  size_t start = tags.find_first_not_of(SEPARATORS);
+  if (start == std::string_view::npos) {
+    tags = {};
+    return {};
+  }
+  tags                 = tags.substr(start);
+  std::string_view tag = tags.substr(0, tags.find_first_of(SEPARATORS));
+  tags.remove_prefix(tag.size());
+  return tag;
+}
+
+void
+HttpCacheTags::invalidate(std::string_view tag, time_t now, size_t capacity)
+{
+  size_t hash = std::hash<std::string_view>{}(tag);
+
+  std::unique_lock<std::shared_mutex> lock(_mutex);
+  _tags[hash] = now;
+  _order.emplace_back(hash, now);
+  while (_order.size() > capacity) {
+    auto [oldest, when] = _order.front();
+    _order.pop_front();
+    // Later invalidations of the tag are further down the queue, this one is outdated.
+    auto spot = _tags.find(oldest);
+    if (spot != _tags.end() && spot->second == when) {
+      _tags.erase(spot);
+      _dropped = std::max(_dropped, when);
+    }
+  }
+  _any.store(true, std::memory_order_release);
+}
+
+bool
+HttpCacheTags::is_invalidated(std::string_view tags, time_t received)
+{
+  if (!_any.load(std::memory_order_acquire)) {
+    return false;
+  }
+
+  std::shared_lock<std::shared_mutex> lock(_mutex);
+  for (std::string_view tag = next_tag(tags); !tag.empty(); tag = next_tag(tags)) {
+    if (received <= _dropped) {
+      return true;
+    }
+    auto spot = _tags.find(std::hash<std::string_view>{}(tag));
+    if (spot != _tags.end() && received <= spot->second) {
+      return true;
+    }
+  }
+  return false;
+}
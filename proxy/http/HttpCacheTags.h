@@ -0,0 +1,74 @@
+/** @file
+
+  Invalidation of cached objects by surrogate key.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  @section details Details
+
+  Responses list the keys, or tags, of their object in the field named by
+  proxy.config.http.cache.surrogate_key_header, e.g. "Surrogate-Key: product-42 catalog". Invalidating
+  a tag only records when that happened. A cache hit on an object received no later than that for
+  one of its tags is stale, so nothing on disk is touched: the tags travel in the cached header.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <ctime>
+#include <deque>
+#include <shared_mutex>
+#include <string_view>
+#include <unordered_map>
+
+class HttpCacheTags
+{
+public:
+  /** Invalidate the objects tagged with @a tag that were received up to @a now.
+
+      At most @a capacity tags are kept. When the oldest is dropped for a new one, every tagged
+      object received up to its time is taken for invalidated.
+   */
+  void invalidate(std::string_view tag, time_t now, size_t capacity);
+
+  /// Whether an object received at @a received with @a tags was invalidated since.
+  bool is_invalidated(std::string_view tags, time_t received);
+
+  /// Take the first tag off @a tags, which are separated by spaces or commas. Empty once there are no more.
+  static std::string_view next_tag(std::string_view &tags);
+
+  size_t
+  size() const
+  {
+    std::shared_lock<std::shared_mutex> lock(_mutex);
+    return _tags.size();
+  }
+
+private:
+  using Invalidation = std::pair<size_t, time_t>; ///< Hash of the tag, when
+
+  mutable std::shared_mutex _mutex;
+  std::unordered_map<size_t, time_t> _tags; ///< The latest invalidation of each tag, by its hash.
+  std::deque<Invalidation> _order;          ///< Oldest first, with the outdated ones of a tag.
+  time_t _dropped = 0;                      ///< The latest invalidation no longer in @c _tags.
+  std::atomic<bool> _any{false};            ///< Whether a tag was ever invalidated, to skip the lock.
+};
+
+extern HttpCacheTags httpCacheTags;
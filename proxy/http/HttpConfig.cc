@@ -51,6 +51,7 @@
   REC_RegisterConfigUpdateFunc(_n, http_config_cb, NULL)
 
 RecRawStatBlock *http_rsb;
+RecHistogram http_histograms[http_histogram_count];
 #define HTTP_CLEAR_DYN_STAT(x)          \
   do {                                  \
     RecSetRawStatSum(http_rsb, x, 0);   \
@@ -164,7 +165,8 @@ http_config_enum_mask_read(const char *name, MgmtByte &value)
 
 static const ConfigEnumPair<TSServerSessionSharingPoolType> SessionSharingPoolStrings[] = {
   {TS_SERVER_SESSION_SHARING_POOL_GLOBAL, "global"},
-  {TS_SERVER_SESSION_SHARING_POOL_THREAD, "thread"}};
+  {TS_SERVER_SESSION_SHARING_POOL_THREAD, "thread"},
+  {TS_SERVER_SESSION_SHARING_POOL_HYBRID, "hybrid"}};
 
 int HttpConfig::m_id = 0;
 HttpConfigParams HttpConfig::m_master;
@@ -355,6 +357,22 @@ register_stat_callbacks()
                      RECP_NON_PERSISTENT, (int)http_origin_shutdown_pool_lock_contention, RecRawStatSyncCount);
   RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.origin_shutdown.migration_failure", RECD_INT, RECP_NON_PERSISTENT,
                      (int)http_origin_shutdown_migration_failure, RecRawStatSyncCount);
+
+  // Stats for the hybrid server session pool
+  RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.origin_pool.local_hits", RECD_COUNTER, RECP_PERSISTENT,
+                     (int)http_origin_pool_local_hit_stat, RecRawStatSyncCount);
+  RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.origin_pool.steals", RECD_COUNTER, RECP_PERSISTENT,
+                     (int)http_origin_pool_steal_stat, RecRawStatSyncCount);
+  RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.origin_pool.misses", RECD_COUNTER, RECP_PERSISTENT,
+                     (int)http_origin_pool_miss_stat, RecRawStatSyncCount);
+  RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.prewarm.opens", RECD_COUNTER, RECP_PERSISTENT,
+                     (int)http_prewarm_open_stat, RecRawStatSyncCount);
+  RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.prewarm.hits", RECD_COUNTER, RECP_PERSISTENT,
+                     (int)http_prewarm_hit_stat, RecRawStatSyncCount);
+  RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.prewarm.misses", RECD_COUNTER, RECP_PERSISTENT,
+                     (int)http_prewarm_miss_stat, RecRawStatSyncCount);
+  RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.prewarm.waste", RECD_COUNTER, RECP_PERSISTENT,
+                     (int)http_prewarm_waste_stat, RecRawStatSyncCount);
   RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.origin_shutdown.tunnel_server", RECD_INT, RECP_NON_PERSISTENT,
                      (int)http_origin_shutdown_tunnel_server, RecRawStatSyncCount);
   RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.origin_shutdown.tunnel_server_no_keep_alive", RECD_INT,
@@ -388,6 +406,9 @@ register_stat_callbacks()
   RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.origin_shutdown.tunnel_abort", RECD_INT, RECP_NON_PERSISTENT,
                      (int)http_origin_shutdown_tunnel_abort, RecRawStatSyncCount);
 
+  RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.early_hints_responses", RECD_COUNTER, RECP_PERSISTENT,
+                     (int)http_early_hints_responses_stat, RecRawStatSyncCount);
+
   // Upstream current connections stats
   RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.current_parent_proxy_connections", RECD_INT, RECP_NON_PERSISTENT,
                      (int)http_current_parent_proxy_connections_stat, RecRawStatSyncSum);
@@ -404,6 +425,9 @@ register_stat_callbacks()
   RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.avg_transactions_per_server_connection", RECD_FLOAT,
                      RECP_PERSISTENT, (int)http_transactions_per_server_con, RecRawStatSyncAvg);
 
+  RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.avg_transaction_memory", RECD_FLOAT, RECP_PERSISTENT,
+                     (int)http_sm_memory_stat, RecRawStatSyncAvg);
+
   RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.transaction_counts.errors.pre_accept_hangups", RECD_COUNTER,
                      RECP_PERSISTENT, (int)http_ua_msecs_counts_errors_pre_accept_hangups_stat, RecRawStatSyncCount);
 
@@ -608,6 +632,42 @@ register_stat_callbacks()
   RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.cache_hit_fresh", RECD_COUNTER, RECP_PERSISTENT,
                      (int)http_cache_hit_fresh_stat, RecRawStatSyncCount);
 
+  RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.cache_hit_fast_path", RECD_COUNTER, RECP_PERSISTENT,
+                     (int)http_cache_hit_fast_path_stat, RecRawStatSyncCount);
+
+  RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.cache_collapsed_waits", RECD_COUNTER, RECP_PERSISTENT,
+                     (int)http_cache_collapsed_wait_stat, RecRawStatSyncCount);
+
+  RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.cache_collapsed_timeouts", RECD_COUNTER, RECP_PERSISTENT,
+                     (int)http_cache_collapsed_timeout_stat, RecRawStatSyncCount);
+
+  RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.cache_stale_while_revalidate", RECD_COUNTER, RECP_PERSISTENT,
+                     (int)http_cache_stale_while_revalidate_stat, RecRawStatSyncCount);
+
+  RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.cache_stale_if_error", RECD_COUNTER, RECP_PERSISTENT,
+                     (int)http_cache_stale_if_error_stat, RecRawStatSyncCount);
+
+  RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.background_revalidations", RECD_COUNTER, RECP_PERSISTENT,
+                     (int)http_background_revalidate_stat, RecRawStatSyncCount);
+
+  RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.cache_tag_invalidations", RECD_COUNTER, RECP_PERSISTENT,
+                     (int)http_cache_tag_invalidation_stat, RecRawStatSyncCount);
+
+  RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.cache_hit_tag_invalidated", RECD_COUNTER, RECP_PERSISTENT,
+                     (int)http_cache_hit_tag_invalidated_stat, RecRawStatSyncCount);
+
+  RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.pipeline_lookahead_reads", RECD_COUNTER, RECP_PERSISTENT,
+                     (int)http_pipeline_lookahead_read_stat, RecRawStatSyncCount);
+
+  RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.peer_cache_hits", RECD_COUNTER, RECP_PERSISTENT,
+                     (int)http_peer_cache_hit_stat, RecRawStatSyncCount);
+
+  RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.peer_cache_misses", RECD_COUNTER, RECP_PERSISTENT,
+                     (int)http_peer_cache_miss_stat, RecRawStatSyncCount);
+
+  RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.peer_cache_errors", RECD_COUNTER, RECP_PERSISTENT,
+                     (int)http_peer_cache_error_stat, RecRawStatSyncCount);
+
   RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.cache_hit_mem_fresh", RECD_COUNTER, RECP_PERSISTENT,
                      (int)http_cache_hit_mem_fresh_stat, RecRawStatSyncCount);
 
@@ -1027,6 +1087,22 @@ register_stat_callbacks()
                      (int)http_sm_start_time_stat, RecRawStatSyncSum);
   RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.milestone.sm_finish", RECD_COUNTER, RECP_PERSISTENT,
                      (int)http_sm_finish_time_stat, RecRawStatSyncSum);
+
+  http_histograms[http_ttfb_histogram].init(RECT_PROCESS, "proxy.process.http.latency.ttfb_ms");
+  http_histograms[http_total_time_histogram].init(RECT_PROCESS, "proxy.process.http.latency.total_ms");
+  http_histograms[http_dns_lookup_histogram].init(RECT_PROCESS, "proxy.process.http.latency.dns_lookup_ms");
+  http_histograms[http_origin_connect_histogram].init(RECT_PROCESS, "proxy.process.http.latency.origin_connect_ms");
+  http_histograms[http_origin_first_byte_histogram].init(RECT_PROCESS, "proxy.process.http.latency.origin_first_byte_ms");
+  http_histograms[http_cache_open_read_histogram].init(RECT_PROCESS, "proxy.process.http.latency.cache_open_read_ms");
+  http_histograms[http_client_rtt_histogram].init(RECT_PROCESS, "proxy.process.http.tcp.client_rtt_ms");
+  http_histograms[http_server_rtt_histogram].init(RECT_PROCESS, "proxy.process.http.tcp.server_rtt_ms");
+  http_histograms[http_client_retransmits_histogram].init(RECT_PROCESS, "proxy.process.http.tcp.client_retransmits");
+  http_histograms[http_server_retransmits_histogram].init(RECT_PROCESS, "proxy.process.http.tcp.server_retransmits");
+  http_histograms[http_profile_plugin_cpu_histogram].init(RECT_PROCESS, "proxy.process.http.profile.plugin_cpu_us");
+  http_histograms[http_profile_lock_retries_histogram].init(RECT_PROCESS, "proxy.process.http.profile.lock_retries");
+  http_histograms[http_profile_cache_wait_histogram].init(RECT_PROCESS, "proxy.process.http.profile.cache_wait_ms");
+  http_histograms[http_profile_dns_wait_histogram].init(RECT_PROCESS, "proxy.process.http.profile.dns_wait_ms");
+  http_histograms[http_profile_origin_wait_histogram].init(RECT_PROCESS, "proxy.process.http.profile.origin_wait_ms");
 }
 
 static bool
@@ -1222,6 +1298,9 @@ HttpConfig::startup()
   HttpEstablishStaticConfigByte(c.oride.anonymize_insert_client_ip, "proxy.config.http.insert_client_ip");
   HttpEstablishStaticConfigStringAlloc(c.anonymize_other_header_list, "proxy.config.http.anonymize_other_header_list");
 
+  HttpEstablishStaticConfigStringAlloc(c.cache_surrogate_key_header, "proxy.config.http.cache.surrogate_key_header");
+  HttpEstablishStaticConfigLongLong(c.cache_surrogate_key_max_tags, "proxy.config.http.cache.surrogate_key_max_tags");
+
   HttpEstablishStaticConfigStringAlloc(c.oride.global_user_agent_header, "proxy.config.http.global_user_agent_header");
   c.oride.global_user_agent_header_size = c.oride.global_user_agent_header ? strlen(c.oride.global_user_agent_header) : 0;
 
@@ -1271,11 +1350,24 @@ HttpConfig::startup()
   HttpEstablishStaticConfigByte(c.oride.ignore_accept_language_mismatch, "proxy.config.http.cache.ignore_accept_language_mismatch");
   HttpEstablishStaticConfigByte(c.oride.ignore_accept_encoding_mismatch, "proxy.config.http.cache.ignore_accept_encoding_mismatch");
   HttpEstablishStaticConfigByte(c.oride.ignore_accept_charset_mismatch, "proxy.config.http.cache.ignore_accept_charset_mismatch");
+  HttpEstablishStaticConfigByte(c.oride.cache_vary_user_agent_class, "proxy.config.http.cache.vary_user_agent_class");
 
   HttpEstablishStaticConfigByte(c.send_100_continue_response, "proxy.config.http.send_100_continue_response");
   HttpEstablishStaticConfigByte(c.disallow_post_100_continue, "proxy.config.http.disallow_post_100_continue");
+  HttpEstablishStaticConfigByte(c.enable_sm_history, "proxy.config.http.enable_sm_history");
+  HttpEstablishStaticConfigByte(c.cache_hit_fast_path, "proxy.config.http.cache.hit_fast_path");
+  HttpEstablishStaticConfigByte(c.cache_collapse_requests, "proxy.config.http.cache.collapse_requests");
+  HttpEstablishStaticConfigByte(c.cache_stale_while_revalidate, "proxy.config.http.cache.stale_while_revalidate");
+  HttpEstablishStaticConfigByte(c.cache_stale_if_error, "proxy.config.http.cache.stale_if_error");
 
   HttpEstablishStaticConfigByte(c.keepalive_internal_vc, "proxy.config.http.keepalive_internal_vc");
+  HttpEstablishStaticConfigLongLong(c.pipeline_lookahead, "proxy.config.http.pipeline_lookahead");
+  HttpEstablishStaticConfigLongLong(c.profile_sample_rate, "proxy.config.http.profile.sample_rate");
+
+  HttpEstablishStaticConfigByte(c.send_early_hints, "proxy.config.http.early_hints.enabled");
+  HttpEstablishStaticConfigLongLong(c.early_hints_cache_size, "proxy.config.http.early_hints.cache_size");
+
+  HttpEstablishStaticConfigByte(c.tcp_info, "proxy.config.http.tcp_info");
 
   HttpEstablishStaticConfigByte(c.oride.cache_open_write_fail_action, "proxy.config.http.cache.open_write_fail_action");
 
@@ -1329,6 +1421,7 @@ HttpConfig::startup()
   HttpEstablishStaticConfigByte(c.enable_http_info, "proxy.config.http.enable_http_info");
 
   HttpEstablishStaticConfigLongLong(c.max_post_size, "proxy.config.http.max_post_size");
+  HttpEstablishStaticConfigLongLong(c.prewarm_rate, "proxy.config.http.prewarm.rate");
   HttpEstablishStaticConfigLongLong(c.max_payload_iobuf_index, "proxy.config.payload.io.max_buffer_index");
   HttpEstablishStaticConfigLongLong(c.max_msg_iobuf_index, "proxy.config.msg.io.max_buffer_index");
 
@@ -1348,6 +1441,9 @@ HttpConfig::startup()
 
   HttpEstablishStaticConfigStringAlloc(c.oride.ssl_client_sni_policy, "proxy.config.ssl.client.sni_policy");
 
+  HttpEstablishStaticConfigLongLong(c.oride.pacing_rate, "proxy.config.net.pacing.rate");
+  HttpEstablishStaticConfigStringAlloc(c.oride.pacing_group, "proxy.config.net.pacing.group");
+
   OutboundConnTrack::config_init(&c.outbound_conntrack, &c.oride.outbound_conntrack);
 
   MUTEX_TRY_LOCK(lock, http_config_cont->mutex, this_ethread());
@@ -1508,6 +1604,10 @@ HttpConfig::reconfigure()
   params->oride.anonymize_insert_client_ip  = m_master.oride.anonymize_insert_client_ip;
   params->anonymize_other_header_list       = ats_strdup(m_master.anonymize_other_header_list);
 
+  params->cache_surrogate_key_header     = ats_strdup(m_master.cache_surrogate_key_header);
+  params->cache_surrogate_key_header_len = params->cache_surrogate_key_header ? strlen(params->cache_surrogate_key_header) : 0;
+  params->cache_surrogate_key_max_tags   = m_master.cache_surrogate_key_max_tags;
+
   params->oride.global_user_agent_header = ats_strdup(m_master.oride.global_user_agent_header);
   params->oride.global_user_agent_header_size =
     params->oride.global_user_agent_header ? strlen(params->oride.global_user_agent_header) : 0;
@@ -1558,10 +1658,23 @@ HttpConfig::reconfigure()
   params->oride.ignore_accept_language_mismatch = m_master.oride.ignore_accept_language_mismatch;
   params->oride.ignore_accept_encoding_mismatch = m_master.oride.ignore_accept_encoding_mismatch;
   params->oride.ignore_accept_charset_mismatch  = m_master.oride.ignore_accept_charset_mismatch;
+  params->oride.cache_vary_user_agent_class     = m_master.oride.cache_vary_user_agent_class;
 
-  params->send_100_continue_response = INT_TO_BOOL(m_master.send_100_continue_response);
-  params->disallow_post_100_continue = INT_TO_BOOL(m_master.disallow_post_100_continue);
-  params->keepalive_internal_vc      = INT_TO_BOOL(m_master.keepalive_internal_vc);
+  params->send_100_continue_response   = INT_TO_BOOL(m_master.send_100_continue_response);
+  params->disallow_post_100_continue   = INT_TO_BOOL(m_master.disallow_post_100_continue);
+  params->enable_sm_history            = INT_TO_BOOL(m_master.enable_sm_history);
+  params->cache_hit_fast_path          = INT_TO_BOOL(m_master.cache_hit_fast_path);
+  params->cache_collapse_requests      = INT_TO_BOOL(m_master.cache_collapse_requests);
+  params->cache_stale_while_revalidate = INT_TO_BOOL(m_master.cache_stale_while_revalidate);
+  params->cache_stale_if_error         = INT_TO_BOOL(m_master.cache_stale_if_error);
+  params->keepalive_internal_vc        = INT_TO_BOOL(m_master.keepalive_internal_vc);
+  params->pipeline_lookahead           = m_master.pipeline_lookahead;
+  params->profile_sample_rate         = m_master.profile_sample_rate;
+
+  params->send_early_hints       = INT_TO_BOOL(m_master.send_early_hints);
+  params->early_hints_cache_size = m_master.early_hints_cache_size;
+
+  params->tcp_info = m_master.tcp_info;
 
   params->oride.cache_open_write_fail_action = m_master.oride.cache_open_write_fail_action;
   if (params->oride.cache_open_write_fail_action == CACHE_WL_FAIL_ACTION_READ_RETRY) {
@@ -1575,6 +1688,7 @@ HttpConfig::reconfigure()
 
   params->oride.cache_when_to_revalidate = m_master.oride.cache_when_to_revalidate;
   params->max_post_size                  = m_master.max_post_size;
+  params->prewarm_rate                   = m_master.prewarm_rate;
   params->max_payload_iobuf_index        = m_master.max_payload_iobuf_index;
   params->max_msg_iobuf_index            = m_master.max_msg_iobuf_index;
 
@@ -1636,6 +1750,9 @@ HttpConfig::reconfigure()
   params->oride.host_res_data            = m_master.oride.host_res_data;
   params->oride.host_res_data.conf_value = ats_strdup(m_master.oride.host_res_data.conf_value);
 
+  params->oride.pacing_rate  = m_master.oride.pacing_rate;
+  params->oride.pacing_group = ats_strdup(m_master.oride.pacing_group);
+
   m_id = configProcessor.set(m_id, params);
 }
 
@@ -52,6 +52,7 @@
 #include "HttpProxyAPIEnums.h"
 #include "ProxyConfig.h"
 #include "records/P_RecProcess.h"
+#include "records/I_RecHistogram.h"
 #include "HttpConnectionCount.h"
 
 static const unsigned HTTP_STATUS_NUMBER = 600;
@@ -94,6 +95,7 @@ enum {
   // Http K-A Stats
   http_transactions_per_client_con,
   http_transactions_per_server_con,
+  http_sm_memory_stat,
 
   // Transactional stats
   http_incoming_requests_stat,
@@ -177,6 +179,7 @@ enum {
 
   // cache result stats
   http_cache_hit_fresh_stat,
+  http_cache_hit_fast_path_stat,
   http_cache_hit_mem_fresh_stat,
   http_cache_hit_reval_stat,
   http_cache_hit_ims_stat,
@@ -187,6 +190,17 @@ enum {
   http_cache_miss_uncacheable_stat,
   http_cache_miss_ims_stat,
   http_cache_read_error_stat,
+  http_cache_collapsed_wait_stat,
+  http_cache_collapsed_timeout_stat,
+  http_cache_stale_while_revalidate_stat,
+  http_cache_stale_if_error_stat,
+  http_background_revalidate_stat,
+  http_cache_tag_invalidation_stat,
+  http_cache_hit_tag_invalidated_stat,
+  http_pipeline_lookahead_read_stat,
+  http_peer_cache_hit_stat,
+  http_peer_cache_miss_stat,
+  http_peer_cache_error_stat,
 
   // bandwidth savings stats
   http_tcp_hit_count_stat,
@@ -333,6 +347,13 @@ enum {
 
   http_origin_shutdown_pool_lock_contention,
   http_origin_shutdown_migration_failure,
+  http_origin_pool_local_hit_stat,
+  http_origin_pool_steal_stat,
+  http_origin_pool_miss_stat,
+  http_prewarm_open_stat,
+  http_prewarm_hit_stat,
+  http_prewarm_miss_stat,
+  http_prewarm_waste_stat,
   http_origin_shutdown_tunnel_server,
   http_origin_shutdown_tunnel_server_no_keep_alive,
   http_origin_shutdown_tunnel_server_eos,
@@ -350,6 +371,8 @@ enum {
   http_origin_shutdown_cleanup_entry,
   http_origin_shutdown_tunnel_abort,
 
+  http_early_hints_responses_stat,
+
   http_stat_count
 };
 
@@ -363,7 +386,29 @@ enum CacheOpenWriteFailAction_t {
   TOTAL_CACHE_WL_FAIL_ACTION_TYPES
 };
 
+// Latency histograms of the transactions, in milliseconds between two of their milestones.
+enum HttpHistogram_t {
+  http_ttfb_histogram,
+  http_total_time_histogram,
+  http_dns_lookup_histogram,
+  http_origin_connect_histogram,
+  http_origin_first_byte_histogram,
+  http_cache_open_read_histogram,
+  http_client_rtt_histogram,
+  http_server_rtt_histogram,
+  http_client_retransmits_histogram,
+  http_server_retransmits_histogram,
+  http_profile_plugin_cpu_histogram,
+  http_profile_lock_retries_histogram,
+  http_profile_cache_wait_histogram,
+  http_profile_dns_wait_histogram,
+  http_profile_origin_wait_histogram,
+
+  http_histogram_count
+};
+
 extern RecRawStatBlock *http_rsb;
+extern RecHistogram http_histograms[http_histogram_count];
 
 /* Stats should only be accessed using these macros */
 #define HTTP_INCREMENT_DYN_STAT(x) RecIncrRawStat(http_rsb, this_ethread(), (int)x, 1)
@@ -547,6 +592,7 @@ struct OverridableHttpConfigParams {
   MgmtByte ignore_accept_language_mismatch = 0;
   MgmtByte ignore_accept_encoding_mismatch = 0;
   MgmtByte ignore_accept_charset_mismatch  = 0;
+  MgmtByte cache_vary_user_agent_class     = 0;
 
   MgmtByte insert_request_via_string  = 1;
   MgmtByte insert_response_via_string = 0;
@@ -708,6 +754,10 @@ struct OverridableHttpConfigParams {
 
   // Host Resolution order
   HostResData host_res_data;
+
+  // Write pacing of the client connection, see P_NetPacing.h
+  MgmtInt pacing_rate = 0;
+  char *pacing_group  = nullptr;
 };
 
 /////////////////////////////////////////////////////////////
@@ -756,6 +806,13 @@ public:
   ///////////////////////////////////////////////////////////////////
   char *anonymize_other_header_list = nullptr;
 
+  ///////////////////////////////////////////////////
+  // Surrogate keys of the objects, HttpCacheTags.h //
+  ///////////////////////////////////////////////////
+  char *cache_surrogate_key_header     = nullptr;
+  int cache_surrogate_key_header_len   = 0;
+  MgmtInt cache_surrogate_key_max_tags = 100000;
+
   ////////////////////////////////////////////
   // CONNECT ports (used to be == ssl_ports //
   ////////////////////////////////////////////
@@ -770,6 +827,8 @@ public:
   MgmtInt post_copy_size = 2048;
   MgmtInt max_post_size  = 0;
 
+  MgmtInt prewarm_rate = 10;
+
   MgmtInt max_payload_iobuf_index = BUFFER_SIZE_INDEX_32K;
   MgmtInt max_msg_iobuf_index     = BUFFER_SIZE_INDEX_32K;
 
@@ -806,9 +865,22 @@ public:
 
   MgmtByte redirection_host_no_port = 1;
 
-  MgmtByte send_100_continue_response = 0;
-  MgmtByte disallow_post_100_continue = 0;
-  MgmtByte keepalive_internal_vc      = 0;
+  MgmtByte send_100_continue_response   = 0;
+  MgmtByte disallow_post_100_continue   = 0;
+  MgmtByte enable_sm_history            = 1;
+  MgmtByte cache_hit_fast_path          = 1;
+  MgmtByte cache_collapse_requests      = 0;
+  MgmtByte cache_stale_while_revalidate = 0;
+  MgmtByte cache_stale_if_error         = 0;
+  MgmtByte keepalive_internal_vc        = 0;
+
+  MgmtInt pipeline_lookahead  = 0;
+  MgmtInt profile_sample_rate = 0; // Profile one transaction out of this many on each thread, 0 for none.
+
+  MgmtByte send_early_hints      = 0;
+  MgmtInt early_hints_cache_size = 1024;
+
+  MgmtByte tcp_info = 1; // 1 samples TCP_INFO at the end of transactions, 2 also sizes the response buffers by it.
 
   MgmtByte server_session_sharing_pool = TS_SERVER_SESSION_SHARING_POOL_THREAD;
 
@@ -879,6 +951,7 @@ inline HttpConfigParams::~HttpConfigParams()
   ats_free(proxy_request_via_string);
   ats_free(proxy_response_via_string);
   ats_free(anonymize_other_header_list);
+  ats_free(cache_surrogate_key_header);
   ats_free(oride.body_factory_template_base);
   ats_free(oride.server_session_sharing_match_str);
   ats_free(oride.proxy_response_server_string);
@@ -891,6 +964,7 @@ inline HttpConfigParams::~HttpConfigParams()
   ats_free(redirect_actions_string);
   ats_free(oride.ssl_client_sni_policy);
   ats_free(oride.host_res_data.conf_value);
+  ats_free(oride.pacing_group);
 
   delete connect_ports;
   delete redirect_actions_map;
@@ -28,6 +28,7 @@
 #include "HttpConnectionCount.h"
 #include "tscore/bwf_std_format.h"
 #include "tscore/BufferWriter.h"
+#include "I_EventSystem.h"
 
 using namespace std::literals;
 
@@ -183,6 +184,16 @@ OutboundConnTrack::obtain(TxnConfig const &txn_cnf, std::string_view fqdn, IpEnd
   CryptoHash hash;
   CryptoContext().hash_immediate(hash, fqdn.data(), fqdn.size());
   Group::Key key{addr, hash, txn_cnf.match};
+
+  // Groups are never removed, so a group found once can be kept. Remember the last group found for
+  // each slot on this thread, which keeps the table lock out of the common case.
+  static thread_local std::array<Group *, 64> recent{};
+  Group *&spot = recent[Group::hash(key) % recent.size()];
+  if (spot != nullptr && Group::equal(key, spot->_key)) {
+    zret._g = spot;
+    return zret;
+  }
+
   std::lock_guard<std::mutex> lock(_imp._mutex); // Table lock
   auto loc = _imp._table.find(key);
   if (loc != _imp._table.end()) {
@@ -191,9 +202,131 @@ OutboundConnTrack::obtain(TxnConfig const &txn_cnf, std::string_view fqdn, IpEnd
     zret._g = new Group(key, fqdn, txn_cnf.min);
     _imp._table.insert(zret._g);
   }
+  spot = zret._g;
   return zret;
 }
 
+/** A transaction waiting for a connection slot in a group.
+ *
+ * It runs with the mutex of the waiting continuation, on its thread. Once queued it is deleted by whichever of the
+ * wake up, the timeout or the cancel comes last.
+ */
+struct OutboundConnTrack::SlotWaiter : public Continuation {
+  struct WaitAction : public Action {
+    SlotWaiter *waiter = nullptr;
+
+    void
+    cancel(Continuation *c = nullptr) override
+    {
+      Action::cancel(c);
+      waiter->abandon();
+    }
+  };
+
+  SlotWaiter(Continuation *cont, Group *g) : Continuation(cont->mutex), target(cont), group(g), thread(this_ethread())
+  {
+    SET_HANDLER(&SlotWaiter::handle_event);
+    action.waiter = this;
+  }
+
+  int handle_event(int event, Event *e);
+  void abandon();
+  bool unqueue();
+
+  Continuation *target;
+  Group *group;
+  EThread *thread;
+  Event *timeout = nullptr;
+  bool queued    = true; ///< Under the group waiter lock, false once a wake up is on its way.
+  WaitAction action;
+};
+
+bool
+OutboundConnTrack::SlotWaiter::unqueue()
+{
+  std::lock_guard<std::mutex> lock(group->_waiter_mutex);
+  if (!queued) {
+    return false;
+  }
+  queued = false;
+  group->_waiters.erase(std::find(group->_waiters.begin(), group->_waiters.end(), this));
+  return true;
+}
+
+void
+OutboundConnTrack::SlotWaiter::abandon()
+{
+  target = nullptr;
+  if (timeout) {
+    timeout->cancel();
+    timeout = nullptr;
+  }
+  if (unqueue()) {
+    delete this;
+  }
+}
+
+int
+OutboundConnTrack::SlotWaiter::handle_event(int event, Event * /* e ATS_UNUSED */)
+{
+  if (event == EVENT_INTERVAL) {
+    timeout = nullptr;
+    if (!unqueue()) {
+      // A connection closed at the same time, that wake up does the rest.
+      return EVENT_DONE;
+    }
+  } else if (timeout) {
+    timeout->cancel();
+    timeout = nullptr;
+  }
+
+  if (target) {
+    Debug(DEBUG_TAG, "%s", event == EVENT_INTERVAL ? "queue wait timed out" : "woken up by a closed connection");
+    target->handleEvent(EVENT_INTERVAL, nullptr);
+  }
+  delete this;
+  return EVENT_DONE;
+}
+
+Action *
+OutboundConnTrack::Group::wait_for_slot(Continuation *cont, int max, ink_hrtime timeout)
+{
+  SlotWaiter *waiter = new SlotWaiter(cont, this);
+  bool open_p        = false;
+  {
+    std::lock_guard<std::mutex> lock(_waiter_mutex);
+    // A connection that closes from here on finds us in the queue, one that closed before shows in the count.
+    open_p = _count < max;
+    if (open_p) {
+      waiter->queued = false;
+    } else {
+      _waiters.push_back(waiter);
+    }
+  }
+  if (open_p) {
+    waiter->thread->schedule_imm(waiter);
+  } else {
+    waiter->timeout = waiter->thread->schedule_in(waiter, timeout);
+  }
+  return &waiter->action;
+}
+
+void
+OutboundConnTrack::Group::slot_released()
+{
+  SlotWaiter *waiter = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(_waiter_mutex);
+    if (_waiters.empty()) {
+      return;
+    }
+    waiter = _waiters.front();
+    _waiters.pop_front();
+    waiter->queued = false;
+  }
+  waiter->thread->schedule_imm(waiter);
+}
+
 bool
 OutboundConnTrack::Group::equal(const Key &lhs, const Key &rhs)
 {
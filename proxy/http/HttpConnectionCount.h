@@ -29,10 +29,12 @@
 #include <sstream>
 #include <tuple>
 #include <mutex>
+#include <deque>
 #include "tscore/ink_platform.h"
 #include "tscore/ink_config.h"
 #include "tscore/ink_mutex.h"
 #include "tscore/ink_inet.h"
+#include "tscore/ink_hrtime.h"
 #include "tscore/IntrusiveHashMap.h"
 #include "tscore/Diags.h"
 #include "tscore/CryptoHash.h"
@@ -42,6 +44,9 @@
 #include "HttpProxyAPIEnums.h"
 #include "Show.h"
 
+class Continuation;
+class Action;
+
 /**
  * Singleton class to keep track of the number of outbound connections.
  *
@@ -92,6 +97,8 @@ public:
   static constexpr std::string_view CONFIG_VAR_QUEUE_DELAY{"proxy.config.http.per_server.connection.queue_delay"_sv};
   static constexpr std::string_view CONFIG_VAR_ALERT_DELAY{"proxy.config.http.per_server.connection.alert_delay"_sv};
 
+  struct SlotWaiter;
+
   /// A record for the outbound connection count.
   /// These are stored per outbound session equivalence class, as determined by the session matching.
   struct Group {
@@ -126,6 +133,9 @@ public:
     std::atomic<int> _in_queue{0};      ///< # of connections queued, waiting for a connection.
     std::atomic<Ticker> _last_alert{0}; ///< Absolute time of the last alert.
 
+    std::mutex _waiter_mutex;          ///< Lock for @a _waiters.
+    std::deque<SlotWaiter *> _waiters; ///< Transactions waiting for a connection, oldest first.
+
     // Links for intrusive container.
     Group *_next{nullptr};
     Group *_prev{nullptr};
@@ -147,6 +157,20 @@ public:
     bool should_alert(std::time_t *lat = nullptr);
     /// Time of the last alert in epoch seconds.
     std::time_t get_last_alert_epoch_time() const;
+
+    /** Wait for a connection in this group to close.
+     *
+     * @a cont is called back with @c EVENT_INTERVAL, under its mutex and on the calling thread, when a connection
+     * closes or after @a timeout, whichever comes first. Waiters are called back in the order they started waiting.
+     *
+     * @param cont The waiting continuation.
+     * @param max The connection maximum for @a cont, to catch a connection that closed just before the wait.
+     * @param timeout Longest time to wait.
+     * @return The action to cancel the wait.
+     */
+    Action *wait_for_slot(Continuation *cont, int max, ink_hrtime timeout);
+    /// A connection in the group closed, wake the transaction that has waited longest.
+    void slot_released();
   };
 
   /// Container for per transaction state and operations.
@@ -166,6 +190,8 @@ public:
     int enqueue();
     /// Release a block
     void dequeue();
+    /// Wait in the queue of the group, see @c Group::wait_for_slot.
+    Action *wait_for_slot(Continuation *cont, int max, ink_hrtime timeout);
     /// Note blocking a transaction.
     void blocked();
     /// Note a rescheduling
@@ -354,6 +380,9 @@ OutboundConnTrack::TxnState::drop()
 inline int
 OutboundConnTrack::TxnState::enqueue()
 {
+  if (_queued_p) {
+    return _g->_in_queue;
+  }
   _queued_p = true;
   return ++_g->_in_queue;
 }
@@ -367,12 +396,22 @@ OutboundConnTrack::TxnState::dequeue()
   }
 }
 
+inline Action *
+OutboundConnTrack::TxnState::wait_for_slot(Continuation *cont, int max, ink_hrtime timeout)
+{
+  return _g->wait_for_slot(cont, max, timeout);
+}
+
 inline void
 OutboundConnTrack::TxnState::clear()
 {
   if (_g) {
+    bool reserved_p = _reserved_p;
     this->dequeue();
     this->release();
+    if (reserved_p) {
+      _g->slot_released();
+    }
     _g = nullptr;
   }
 }
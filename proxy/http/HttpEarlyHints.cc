@@ -0,0 +1,189 @@
+/** @file
+
+  Preload hints remembered per URL, for 103 Early Hints.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "HttpEarlyHints.h"
+#include "HTTP.h"
+
+#include <strings.h>
+
+HttpEarlyHints httpEarlyHints;
+
+namespace
+{
+constexpr std::string_view LINK_FIELD{"Link"};
+constexpr std::string_view LINK_REL{"rel"};
+constexpr std::string_view LINK_PRELOAD{"preload"};
+constexpr std::string_view WHITESPACE{" \t"};
+
+std::string_view
+trim(std::string_view s)
+{
+  size_t start = s.find_first_not_of(WHITESPACE);
+  if (start == std::string_view::npos) {
+    return {};
+  }
+  return s.substr(start, s.find_last_not_of(WHITESPACE) - start + 1);
+}
+
+bool
+same_token(std::string_view a, std::string_view b)
+{
+  return a.size() == b.size() && strncasecmp(a.data(), b.data(), a.size()) == 0;
+}
+
+// Whether the parameters of a link, what follows the '>', have "preload" among the relation types.
+bool
+is_preload(std::string_view params)
+{
+  while (!params.empty()) {
+    size_t semi           = params.find(';');
+    std::string_view name = trim(params.substr(0, semi));
+    params                = semi == std::string_view::npos ? std::string_view{} : params.substr(semi + 1);
+
+    size_t eq = name.find('=');
+    if (eq == std::string_view::npos || !same_token(trim(name.substr(0, eq)), LINK_REL)) {
+      continue;
+    }
+    std::string_view types = trim(name.substr(eq + 1));
+    if (types.size() >= 2 && types.front() == '"' && types.back() == '"') {
+      types = types.substr(1, types.size() - 2);
+    }
+    // rel="preload prefetch" names two relation types.
+    while (!types.empty()) {
+      size_t space = types.find(' ');
+      if (same_token(types.substr(0, space), LINK_PRELOAD)) {
+        return true;
+      }
+      types = space == std::string_view::npos ? std::string_view{} : trim(types.substr(space + 1));
+    }
+  }
+  return false;
+}
+
+// Append the preload links in one Link value, which may hold several separated by ','. A ',' can
+// also be in the URL or a quoted parameter, so those are skipped over.
+void
+append_preload_links(std::string_view value, std::string &links)
+{
+  while (!value.empty()) {
+    size_t end    = 0;
+    bool in_url   = false;
+    bool in_quote = false;
+    for (; end < value.size(); ++end) {
+      char c = value[end];
+      if (in_quote) {
+        in_quote = c != '"';
+      } else if (in_url) {
+        in_url = c != '>';
+      } else if (c == '"') {
+        in_quote = true;
+      } else if (c == '<') {
+        in_url = true;
+      } else if (c == ',') {
+        break;
+      }
+    }
+
+    std::string_view link = trim(value.substr(0, end));
+    value                 = end < value.size() ? value.substr(end + 1) : std::string_view{};
+
+    size_t url_end = link.find('>');
+    if (link.empty() || link.front() != '<' || url_end == std::string_view::npos || !is_preload(link.substr(url_end + 1))) {
+      continue;
+    }
+    if (!links.empty()) {
+      links.append(", ");
+    }
+    links.append(link);
+  }
+}
+} // namespace
+
+bool
+HttpEarlyHints::preload_links(HTTPHdr *hdr, std::string &links)
+{
+  size_t before = links.size();
+
+  for (MIMEField *field = hdr->field_find(LINK_FIELD.data(), LINK_FIELD.size()); field; field = field->m_next_dup) {
+    int len           = 0;
+    const char *value = field->value_get(&len);
+    append_preload_links({value, static_cast<size_t>(len)}, links);
+  }
+
+  return links.size() != before;
+}
+
+std::string
+HttpEarlyHints::response(std::string_view links)
+{
+  std::string text{"HTTP/1.1 103 Early Hints\r\nLink: "};
+  text.append(links);
+  text.append("\r\n\r\n");
+  return text;
+}
+
+void
+HttpEarlyHints::remember(std::string_view url, HTTPHdr *response, size_t capacity)
+{
+  std::string links;
+  preload_links(response, links);
+
+  std::lock_guard<std::mutex> lock(_mutex);
+
+  auto spot = _entries.find(url);
+  if (spot != _entries.end()) {
+    if (links.empty()) {
+      _lru.erase(spot->second);
+      _entries.erase(spot);
+    } else {
+      spot->second->second = std::move(links);
+      _lru.splice(_lru.begin(), _lru, spot->second);
+    }
+    return;
+  }
+
+  if (links.empty() || capacity == 0) {
+    return;
+  }
+
+  while (_entries.size() >= capacity) {
+    _entries.erase(_lru.back().first);
+    _lru.pop_back();
+  }
+  _lru.emplace_front(std::string{url}, std::move(links));
+  _entries.emplace(_lru.front().first, _lru.begin());
+}
+
+bool
+HttpEarlyHints::lookup(std::string_view url, std::string &links)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+
+  auto spot = _entries.find(url);
+  if (spot == _entries.end()) {
+    return false;
+  }
+  _lru.splice(_lru.begin(), _lru, spot->second);
+  links = spot->second->second;
+  return true;
+}
@@ -0,0 +1,76 @@
+/** @file
+
+  Preload hints remembered per URL, for 103 Early Hints.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  @section details Details
+
+  The @c Link fields with @c rel=preload of the last successful response for a URL are kept, so the
+  next request for it can be sent a @c 103 interim response with them while the origin is still
+  working on the final one. The clients fetch the resources in the meantime, which is what HTTP/2
+  server push was for.
+ */
+
+#pragma once
+
+#include <list>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+class HTTPHdr;
+
+class HttpEarlyHints
+{
+public:
+  /** Append the @c rel=preload links of @a hdr to @a links.
+
+      @return @c true if there were any.
+   */
+  static bool preload_links(HTTPHdr *hdr, std::string &links);
+
+  /// The @c 103 response carrying @a links, as HTTP/1.1 text.
+  static std::string response(std::string_view links);
+
+  /** Remember the preload links of @a response for @a url, or forget the URL if it has none.
+
+      At most @a capacity URLs are kept, the least recently used is dropped for a new one.
+   */
+  void remember(std::string_view url, HTTPHdr *response, size_t capacity);
+
+  /// Copy the links remembered for @a url to @a links, @c false if there are none.
+  bool lookup(std::string_view url, std::string &links);
+
+  size_t
+  size() const
+  {
+    return _entries.size();
+  }
+
+private:
+  using Entry = std::pair<std::string, std::string>; ///< URL, links
+
+  std::mutex _mutex;
+  std::list<Entry> _lru; ///< Most recently used first.
+  std::unordered_map<std::string_view, std::list<Entry>::iterator> _entries;
+};
+
+extern HttpEarlyHints httpEarlyHints;
@@ -211,20 +211,21 @@ HttpPagesHandler::dump_history(HttpSM *sm)
 
   // Figure out how big the history is and look
   //  for wrap around
-  for (unsigned int i = 0; i < sm->history.size(); i++) {
+  for (unsigned int i = 0; sm->history && i < sm->history->size(); i++) {
+    const HistoryEntry &entry = (*sm->history)[i];
     char buf[256];
     resp_begin_row();
 
     resp_begin_column();
-    resp_add("%s", sm->history[i].location.str(buf, sizeof(buf)));
+    resp_add("%s", entry.location.str(buf, sizeof(buf)));
     resp_end_column();
 
     resp_begin_column();
-    resp_add("%u", static_cast<unsigned int>(sm->history[i].event));
+    resp_add("%u", static_cast<unsigned int>(entry.event));
     resp_end_column();
 
     resp_begin_column();
-    resp_add("%d", static_cast<int>(sm->history[i].reentrancy));
+    resp_add("%d", static_cast<int>(entry.reentrancy));
     resp_end_column();
 
     resp_end_row();
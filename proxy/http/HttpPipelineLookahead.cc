@@ -0,0 +1,175 @@
+/** @file
+
+  Cache reads ahead of the pipelined requests of a client session, see HttpPipelineLookahead.h
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "HttpPipelineLookahead.h"
+#include "HttpConfig.h"
+#include "HttpTransact.h"
+#include "HttpTransactHeaders.h"
+#include "P_Cache.h"
+#include "ReverseProxy.h"
+
+#include <algorithm>
+
+namespace
+{
+/// Reads the objects of the requests one after the other, then deletes itself.
+struct LookaheadCont : public Continuation {
+  LookaheadCont() : Continuation(new_ProxyMutex()), params(HttpConfig::acquire()) { SET_HANDLER(&LookaheadCont::handle_event); }
+
+  ~LookaheadCont() override
+  {
+    for (int i = 0; i < n_requests; ++i) {
+      requests[i].destroy();
+    }
+    HttpConfig::release(params);
+    mutex.clear();
+  }
+
+  void
+  read_next()
+  {
+    if (next >= n_requests) {
+      delete this;
+      return;
+    }
+
+    HttpCacheKey key;
+    HTTPHdr *request = &requests[next];
+    Cache::generate_key(&key, request->url_get(), params->oride.cache_generation_number);
+    Debug("http_pipeline", "reading ahead %d of %d", next + 1, n_requests);
+    HTTP_INCREMENT_DYN_STAT(http_pipeline_lookahead_read_stat);
+
+    SCOPED_MUTEX_LOCK(lock, mutex, this_ethread());
+    cacheProcessor.open_read(this, &key, request, &params->oride);
+  }
+
+  int
+  handle_event(int event, void *data)
+  {
+    if (event == CACHE_EVENT_OPEN_READ) {
+      // The first fragment of the object is in the RAM cache now, which is all that was wanted.
+      static_cast<VConnection *>(data)->do_io_close();
+    }
+    ++next;
+    read_next();
+    return EVENT_DONE;
+  }
+
+  HttpConfigParams *params;
+  HTTPHdr requests[HttpPipelineLookahead::MAX_REQUESTS];
+  int n_requests = 0;
+  int next       = 0;
+};
+
+// Map @a request the way a remap rule without plugins would, false if the cache key could come out different.
+bool
+remap(HTTPHdr *request)
+{
+  UrlRewrite *table = rewrite_table->acquire();
+  bool mapped       = false;
+
+  if (table->num_rules_forward == 0 && table->num_rules_forward_with_recv_port == 0) {
+    // Without any rules only the requests of a forward proxy client make it to the cache.
+    mapped = request->is_target_in_url();
+  } else if (table->num_rules_forward_with_recv_port == 0) {
+    UrlMappingContainer container(request->m_heap);
+    URL *url = request->url_get();
+    int host_len;
+    const char *host = request->host_get(&host_len);
+    if (host == nullptr) {
+      host     = "";
+      host_len = 0;
+    }
+
+    mapped = table->forwardMappingLookup(url, request->port_get(), host, host_len, container);
+    if (!mapped && table->nohost_rules && host_len) {
+      mapped = table->forwardMappingLookup(url, 0, "", 0, container);
+    }
+    if (mapped && container.getMapping()->plugin_instance_count() > 0) {
+      mapped = false;
+    }
+    if (mapped) {
+      if (!request->is_target_in_url()) {
+        request->set_url_target_from_host_field();
+      }
+      url_rewrite_remap_request(container, url, request->method_get_wksidx());
+    }
+  }
+
+  table->release();
+  return mapped;
+}
+} // namespace
+
+int
+HttpPipelineLookahead::start(IOBufferReader *reader, int max_requests)
+{
+  if (CacheProcessor::IsCacheEnabled() != CACHE_INITIALIZED) {
+    return 0;
+  }
+
+  LookaheadCont *cont      = new LookaheadCont;
+  HttpConfigParams *config = cont->params;
+  IOBufferReader *ahead    = reader->clone();
+  int parsed               = 0;
+  HTTPParser parser;
+
+  http_parser_init(&parser);
+  max_requests = std::min(max_requests, MAX_REQUESTS);
+  while (parsed < max_requests && ahead->is_read_avail_more_than(0)) {
+    HTTPHdr &request = cont->requests[cont->n_requests];
+    int used         = 0;
+
+    request.create(HTTP_TYPE_REQUEST);
+    ParseResult result = request.parse_req(&parser, ahead, &used, false, config->strict_uri_parsing,
+                                           config->http_request_line_max_size, config->http_hdr_field_max_size);
+    http_parser_clear(&parser);
+    http_parser_init(&parser);
+
+    int method = request.method_get_wksidx();
+    if (result != PARSE_RESULT_DONE || (method != HTTP_WKSIDX_GET && method != HTTP_WKSIDX_HEAD) ||
+        request.get_content_length() > 0 || request.presence(MIME_PRESENCE_TRANSFER_ENCODING)) {
+      // Whatever follows could be a body, not a request.
+      request.destroy();
+      break;
+    }
+    ++parsed;
+
+    bool keep_alive = request.is_keep_alive_set();
+    if (remap(&request)) {
+      HttpTransactHeaders::normalize_accept_encoding(&config->oride, &request);
+      ++cont->n_requests;
+    } else {
+      request.destroy();
+    }
+    if (!keep_alive) {
+      break;
+    }
+  }
+  http_parser_clear(&parser);
+  ahead->dealloc();
+
+  Debug("http_pipeline", "%d pipelined requests parsed, %d to read ahead", parsed, cont->n_requests);
+  cont->read_next();
+  return parsed;
+}
@@ -0,0 +1,51 @@
+/** @file
+
+  Cache reads ahead of the pipelined requests of a client session.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  @section details Details
+
+  An HTTP/1.1 session still runs its transactions one after the other and answers them in order.
+  With proxy.config.http.pipeline_lookahead, when a request is followed by other requests already
+  in the client buffer, up to that many of them are parsed and their objects are read from the
+  cache, so that their transactions find them in the RAM cache instead of waiting on the disk. The
+  buffer is left as is for the transactions to parse it again.
+
+  Only GET and HEAD requests without a body are looked at, up to the first one that closes the
+  connection, and only those that a remap rule without plugins maps, as a plugin could change the
+  cache key.
+ */
+
+#pragma once
+
+class IOBufferReader;
+
+namespace HttpPipelineLookahead
+{
+/// The most requests looked ahead.
+constexpr int MAX_REQUESTS = 16;
+
+/** Read from the cache the objects of up to @a max_requests requests at @a reader, without consuming them.
+
+    @return The number of requests that were parsed, looked up or not, the transactions that will
+    parse them again do not start another lookahead.
+ */
+int start(IOBufferReader *reader, int max_requests);
+} // namespace HttpPipelineLookahead
@@ -27,6 +27,7 @@
 #include "HttpSessionAccept.h"
 #include "ReverseProxy.h"
 #include "HttpSessionManager.h"
+#include "PreWarmManager.h"
 #include "HttpUpdateSM.h"
 #ifdef USE_HTTP_DEBUG_LISTS
 #include "Http1ClientSession.h"
@@ -45,8 +46,11 @@
 #include "http3/Http3SessionAccept.h"
 #endif
 
+#include <thread>
 #include <vector>
 
+#include <sys/un.h>
+
 HttpSessionAccept *plugin_http_accept             = nullptr;
 HttpSessionAccept *plugin_http_transparent_accept = nullptr;
 
@@ -113,6 +117,8 @@ struct HttpProxyAcceptor {
   Continuation *_accept = nullptr;
   /// Options for @c NetProcessor.
   NetProcessor::AcceptOptions _net_opt;
+  /// The accept of a TCP port once it is started, it has the listen socket to hand over.
+  Action *_action = nullptr;
 
   /// Default constructor.
   HttpProxyAcceptor() {}
@@ -267,6 +273,7 @@ init_accept_HttpProxyServer(int n_accept_threads)
   HttpProxyPort::Group &proxy_ports = HttpProxyPort::global();
 
   init_reverse_proxy();
+  prewarmManager.start();
   http_pages_init();
 
 #ifdef USE_HTTP_DEBUG_LISTS
@@ -336,7 +343,8 @@ start_HttpProxyServer()
     HttpProxyAcceptor &acceptor = HttpProxyAcceptors[i];
     HttpProxyPort &port         = proxy_ports[i];
     if (port.isSSL()) {
-      if (nullptr == sslNetProcessor.main_accept(acceptor._accept, port.m_fd, acceptor._net_opt)) {
+      acceptor._action = sslNetProcessor.main_accept(acceptor._accept, port.m_fd, acceptor._net_opt);
+      if (nullptr == acceptor._action) {
         return;
       }
 #if TS_USE_QUIC == 1
@@ -346,7 +354,8 @@ start_HttpProxyServer()
       }
 #endif
     } else if (!port.isPlugin()) {
-      if (nullptr == netProcessor.main_accept(acceptor._accept, port.m_fd, acceptor._net_opt)) {
+      acceptor._action = netProcessor.main_accept(acceptor._accept, port.m_fd, acceptor._net_opt);
+      if (nullptr == acceptor._action) {
         return;
       }
     }
@@ -377,3 +386,185 @@ stop_HttpProxyServer()
   sslNetProcessor.stop_accept();
   netProcessor.stop_accept();
 }
+
+namespace
+{
+// The messages on the handoff socket, a byte each.
+constexpr char HANDOFF_SOCKET = 'S'; ///< A listen socket, it comes with the message.
+constexpr char HANDOFF_END    = 'E'; ///< There are no more listen sockets.
+constexpr char HANDOFF_READY  = 'R'; ///< The new traffic_server started its ports.
+
+// The connection to the traffic_server the listen sockets were taken from.
+int handoff_fd = ts::NO_FD;
+
+// Whether the listen socket @a fd is bound to the address of @a port.
+bool
+handoff_port_matches(const HttpProxyPort &port, int fd)
+{
+  IpEndpoint addr;
+  socklen_t len = sizeof(addr);
+
+  if (getsockname(fd, &addr.sa, &len) < 0 || addr.family() != port.m_family || addr.host_order_port() != port.m_port) {
+    return false;
+  }
+  return port.m_inbound_ip.isValid() ? IpAddr(addr) == port.m_inbound_ip : ats_is_ip_any(&addr.sa);
+}
+
+int
+handoff_connect(const char *path)
+{
+  struct sockaddr_un addr;
+
+  if (strlen(path) > sizeof(addr.sun_path) - 1) {
+    errno = ENAMETOOLONG;
+    return -1;
+  }
+
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0) {
+    return -1;
+  }
+
+  ink_zero(addr);
+  addr.sun_family = AF_UNIX;
+  ink_strlcpy(addr.sun_path, path, sizeof(addr.sun_path));
+  if (safe_fcntl(fd, F_SETFD, FD_CLOEXEC) < 0 || connect(fd, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr)) < 0) {
+    int errsav = errno;
+    ::close(fd);
+    errno = errsav;
+    return -1;
+  }
+  return fd;
+}
+
+// Hand the listen sockets @a fds over on the connection @a conn, and wait for the new traffic_server to start its ports.
+bool
+handoff_send(int conn, const std::vector<int> &fds)
+{
+  char msg = HANDOFF_SOCKET;
+
+  for (int fd : fds) {
+    if (send_fds(conn, &fd, 1, &msg, 1) != 1) {
+      return false;
+    }
+  }
+  msg = HANDOFF_END;
+  if (send_fds(conn, nullptr, 0, &msg, 1) != 1) {
+    return false;
+  }
+
+  // This is as long as the new traffic_server takes to start.
+  return read_socket(conn, &msg, 1) == 1 && msg == HANDOFF_READY;
+}
+} // namespace
+
+int
+handoff_receive_HttpProxyServer(const char *path)
+{
+  HttpProxyPort::Group &proxy_ports = HttpProxyPort::global();
+  int taken                         = 0;
+
+  int fd = handoff_connect(path);
+  if (fd < 0) {
+    Warning("cannot connect to %s to take over the listen sockets: %s", path, strerror(errno));
+    return -1;
+  }
+
+  for (;;) {
+    char msg;
+    int sock = ts::NO_FD;
+    int nfds = 1;
+
+    if (recv_fds(fd, &sock, &nfds, &msg, 1) <= 0) {
+      Warning("the handoff on %s ended before all the listen sockets were sent", path);
+      ::close(fd);
+      fd = ts::NO_FD;
+      break;
+    }
+    if (msg == HANDOFF_END) {
+      break;
+    }
+    if (nfds != 1) {
+      continue;
+    }
+
+    bool used = false;
+    for (HttpProxyPort &port : proxy_ports) {
+      if (port.m_fd == ts::NO_FD && !port.isPlugin() && !port.isQUIC() && handoff_port_matches(port, sock)) {
+        Debug("http_handoff", "took over the listen socket %d for port %d", sock, port.m_port);
+        port.m_fd = sock;
+        used      = true;
+        ++taken;
+        break;
+      }
+    }
+    if (!used) {
+      // The port was removed from the configuration, or it already has a socket from traffic_manager.
+      Debug("http_handoff", "listen socket %d does not match any port", sock);
+      ::close(sock);
+    }
+  }
+
+  handoff_fd = fd;
+  Note("took over %d listen sockets from %s", taken, path);
+  return taken;
+}
+
+void
+handoff_ready_HttpProxyServer()
+{
+  if (handoff_fd == ts::NO_FD) {
+    return;
+  }
+
+  char msg = HANDOFF_READY;
+  if (write(handoff_fd, &msg, 1) != 1) {
+    Warning("cannot tell the previous traffic_server to drain: %s", strerror(errno));
+  }
+  ::close(handoff_fd);
+  handoff_fd = ts::NO_FD;
+}
+
+bool
+handoff_listen_HttpProxyServer(const char *path, Continuation *cont)
+{
+  std::vector<int> fds;
+
+  for (HttpProxyAcceptor &acceptor : HttpProxyAcceptors) {
+    if (acceptor._action) {
+      fds.push_back(static_cast<NetAcceptAction *>(acceptor._action)->server->fd);
+    }
+  }
+
+  int sock = bind_unix_domain_socket(path, 00700);
+  if (sock < 0) {
+    Warning("cannot listen on %s to hand the listen sockets over: %s", path, strerror(errno));
+    return false;
+  }
+
+  std::thread([sock, fds, cont]() {
+    for (;;) {
+      int conn = accept(sock, nullptr, nullptr);
+      if (conn < 0) {
+        if (errno == EINTR || errno == ECONNABORTED) {
+          continue;
+        }
+        Warning("cannot accept on the handoff socket: %s", strerror(errno));
+        break;
+      }
+
+      bool ready = handoff_send(conn, fds);
+      ::close(conn);
+      if (ready) {
+        Note("a new traffic_server took over the %zu listen sockets", fds.size());
+        eventProcessor.schedule_imm(cont);
+        break;
+      }
+      Warning("the new traffic_server went away before it started its ports, still serving");
+    }
+    ::close(sock);
+  }).detach();
+
+  Debug("http_handoff", "listening on %s to hand over %zu listen sockets", path, fds.size());
+  return true;
+}
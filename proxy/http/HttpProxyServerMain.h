@@ -29,6 +29,9 @@
 
 struct HttpProxyPort;
 
+/// The socket in the runtime directory on which traffic_server hands its listen sockets over.
+#define HTTP_PROXY_HANDOFF_SOCKET "handoff.sock"
+
 /// Perform any pre-thread start initialization.
 void prep_HttpProxyServer();
 
@@ -47,6 +50,26 @@ void start_HttpProxyServer();
 
 void stop_HttpProxyServer();
 
+/** Take the listen sockets of a running traffic_server from its handoff socket @a path.
+
+    A port for which a socket is received does not open one of its own when it is started.
+    This must be called after the ports are loaded and before they are started.
+
+    @return The number of sockets taken over, or -1 if there was no traffic_server to take them from.
+*/
+int handoff_receive_HttpProxyServer(const char *path);
+
+/// Tell the traffic_server the sockets were taken from that the ports are started, so that it drains.
+void handoff_ready_HttpProxyServer();
+
+/** Listen on the handoff socket @a path for a new traffic_server, this must be called after the ports are started.
+
+    When a new traffic_server has taken the listen sockets and started its ports, @a cont is
+    scheduled with @c EVENT_IMMEDIATE. If the new traffic_server goes away before that, this one
+    keeps serving and listens for the next one.
+*/
+bool handoff_listen_HttpProxyServer(const char *path, Continuation *cont);
+
 NetProcessor::AcceptOptions make_net_accept_options(const HttpProxyPort *port, unsigned nthreads);
 
 extern std::mutex proxyServerMutex;
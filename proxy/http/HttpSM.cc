@@ -24,12 +24,16 @@
 
 #include "../ProxyTransaction.h"
 #include "HttpSM.h"
+#include "HttpEarlyHints.h"
+#include "HttpPipelineLookahead.h"
 #include "HttpTransact.h"
 #include "HttpTransactHeaders.h"
+#include "HttpUpdateSM.h"
 #include "ProxyConfig.h"
 #include "Http1ServerSession.h"
 #include "HttpDebugNames.h"
 #include "HttpSessionManager.h"
+#include "Http2ServerSession.h"
 #include "P_Cache.h"
 #include "P_Net.h"
 #include "StatPages.h"
@@ -130,6 +134,12 @@ std::atomic<int64_t> next_sm_id(0);
 } // namespace
 
 ClassAllocator<HttpSM> httpSMAllocator("httpSMAllocator");
+// The parts of the state machine most transactions do without, kept out of it to keep it small.
+static ClassAllocator<History<HISTORY_DEFAULT_SIZE>> httpSMHistoryAllocator("httpSMHistoryAllocator");
+static ClassAllocator<HttpAPIHooks> httpSMHooksAllocator("httpSMHooksAllocator");
+static ClassAllocator<HttpCacheSM> httpSMTransformCacheAllocator("httpSMTransformCacheAllocator");
+static ClassAllocator<PostDataBuffers> httpSMPostBufAllocator("httpSMPostBufAllocator");
+static ClassAllocator<HttpTxnProfile> httpSMProfileAllocator("httpSMProfileAllocator");
 
 HttpVCTable::HttpVCTable(HttpSM *mysm)
 {
@@ -250,9 +260,11 @@ HttpVCTable::cleanup_all()
 
 #define SMDebug(tag, ...) SpecificDebug(debug_on, tag, __VA_ARGS__)
 
-#define REMEMBER(e, r)                             \
-  {                                                \
-    history.push_back(MakeSourceLocation(), e, r); \
+#define REMEMBER(e, r)                                \
+  {                                                   \
+    if (history) {                                    \
+      history->push_back(MakeSourceLocation(), e, r); \
+    }                                                 \
   }
 
 #ifdef STATE_ENTER
@@ -280,12 +292,27 @@ HttpSM::set_server_netvc_inactivity_timeout(NetVConnection *netvc)
   if (netvc) {
     if (t_state.api_txn_no_activity_timeout_value != -1) {
       netvc->set_inactivity_timeout(HRTIME_MSECONDS(t_state.api_txn_no_activity_timeout_value));
+    } else if (int peer_timeout = get_peer_timeout()) {
+      netvc->set_inactivity_timeout(HRTIME_MSECONDS(peer_timeout));
     } else {
       netvc->set_inactivity_timeout(HRTIME_SECONDS(t_state.txn_conf->transaction_no_activity_timeout_out));
     }
   }
 }
 
+// The milliseconds a sibling peer is given when it is the next hop, 0 otherwise.
+int
+HttpSM::get_peer_timeout() const
+{
+  if (t_state.current.server == &t_state.parent_info && t_state.parent_result.peer) {
+    const url_mapping *mp = t_state.url_map.getMapping();
+    if (mp && mp->strategy) {
+      return mp->strategy->peering_timeout;
+    }
+  }
+  return 0;
+}
+
 void
 HttpSM::set_server_netvc_active_timeout(NetVConnection *netvc)
 {
@@ -304,6 +331,8 @@ HttpSM::set_server_netvc_connect_timeout(NetVConnection *netvc)
   if (netvc) {
     if (t_state.api_txn_connect_timeout_value != -1) {
       netvc->set_inactivity_timeout(HRTIME_MSECONDS(t_state.api_txn_connect_timeout_value));
+    } else if (int peer_timeout = get_peer_timeout()) {
+      netvc->set_inactivity_timeout(HRTIME_MSECONDS(peer_timeout));
     } else {
       int connect_timeout;
       if (t_state.method == HTTP_WKSIDX_POST || t_state.method == HTTP_WKSIDX_PUT) {
@@ -324,7 +353,11 @@ void
 HttpSM::cleanup()
 {
   t_state.destroy();
-  api_hooks.clear();
+  if (api_hooks) {
+    api_hooks->clear();
+    httpSMHooksAllocator.free(api_hooks);
+    api_hooks = nullptr;
+  }
   http_parser_clear(&http_parser);
 
   HttpConfig::release(t_state.http_config_param);
@@ -333,11 +366,76 @@ HttpSM::cleanup()
   mutex.clear();
   tunnel.mutex.clear();
   cache_sm.mutex.clear();
-  transform_cache_sm.mutex.clear();
+  if (transform_cache_sm) {
+    transform_cache_sm->mutex.clear();
+    httpSMTransformCacheAllocator.free(transform_cache_sm);
+    transform_cache_sm = nullptr;
+  }
+  if (_postbuf) {
+    _postbuf->clear();
+    httpSMPostBufAllocator.free(_postbuf);
+    _postbuf = nullptr;
+  }
+  if (history) {
+    httpSMHistoryAllocator.free(history);
+    history = nullptr;
+  }
+  if (profile) {
+    httpSMProfileAllocator.free(profile);
+    profile = nullptr;
+  }
   magic    = HTTP_SM_MAGIC_DEAD;
   debug_on = false;
 }
 
+HttpAPIHooks &
+HttpSM::get_api_hooks()
+{
+  if (api_hooks == nullptr) {
+    api_hooks = httpSMHooksAllocator.alloc();
+  }
+  return *api_hooks;
+}
+
+HttpCacheSM &
+HttpSM::get_transform_cache_sm()
+{
+  if (transform_cache_sm == nullptr) {
+    transform_cache_sm = httpSMTransformCacheAllocator.alloc();
+    transform_cache_sm->init(this, mutex);
+  }
+  return *transform_cache_sm;
+}
+
+void
+HttpSM::postbuf_init(IOBufferReader *ua_reader)
+{
+  if (_postbuf == nullptr) {
+    _postbuf = httpSMPostBufAllocator.alloc();
+  }
+  _postbuf->init(ua_reader);
+}
+
+// The bytes this transaction holds in the state machine and its side objects.
+int64_t
+HttpSM::memory_footprint() const
+{
+  int64_t size = sizeof(*this);
+  if (history) {
+    size += sizeof(*history);
+  }
+  if (api_hooks) {
+    size += sizeof(*api_hooks);
+  }
+  if (transform_cache_sm) {
+    size += sizeof(*transform_cache_sm);
+  }
+  if (_postbuf) {
+    size += sizeof(*_postbuf);
+  }
+  return size;
+}
+
 void
 HttpSM::destroy()
 {
@@ -360,6 +458,13 @@ HttpSM::init(bool from_early_data)
   t_state.state_machine    = this;
 
   t_state.http_config_param = HttpConfig::acquire();
+  if (t_state.http_config_param->enable_sm_history) {
+    history = httpSMHistoryAllocator.alloc();
+  }
+  if (HttpTxnProfile::sample(t_state.http_config_param->profile_sample_rate)) {
+    profile = httpSMProfileAllocator.alloc();
+    profile->init();
+  }
   // Acquire a lease on the global remap / rewrite table (stupid global name ...)
   m_remap = rewrite_table->acquire();
 
@@ -485,7 +590,6 @@ HttpSM::start_sub_sm()
 {
   tunnel.init(this, mutex);
   cache_sm.init(this, mutex);
-  transform_cache_sm.init(this, mutex);
 }
 
 void
@@ -531,6 +635,9 @@ HttpSM::attach_client_session(ProxyTransaction *client_vc, IOBufferReader *buffe
     client_cipher_suite      = cipher ? cipher : "-";
     const char *curve        = ssl_vc->getSSLCurve();
     client_curve             = curve ? curve : "-";
+    if (const char *ja3 = ssl_vc->get_ja3_fingerprint(); ja3) {
+      ink_strlcpy(client_ja3_fingerprint, ja3, sizeof(client_ja3_fingerprint));
+    }
     if (!client_tcp_reused) {
       // Copy along the TLS handshake timings
       milestones[TS_MILESTONE_TLS_HANDSHAKE_START] = ssl_vc->sslHandshakeBeginTime;
@@ -575,7 +682,7 @@ HttpSM::attach_client_session(ProxyTransaction *client_vc, IOBufferReader *buffe
   ua_buffer_reader     = buffer_reader;
   ua_entry->vc_handler = &HttpSM::state_read_client_request_header;
   t_state.hdr_info.client_request.destroy();
-  t_state.hdr_info.client_request.create(HTTP_TYPE_REQUEST);
+  t_state.hdr_info.client_request.create(HTTP_TYPE_REQUEST, new_HdrHeap(HDR_HEAP_ROLE_CLIENT_REQUEST));
 
   // Prepare raw reader which will live until we are sure this is HTTP indeed
   if (is_transparent_passthrough_allowed() || (ssl_vc && ssl_vc->decrypt_tunnel())) {
@@ -868,6 +975,17 @@ HttpSM::state_read_client_request_header(int event, void *data)
          t_state.client_info.transfer_encoding != HttpTransact::CHUNKED_ENCODING)) {
       // Enable further IO to watch for client aborts
       ua_entry->read_vio->reenable();
+
+      // Start on the cache reads of the requests pipelined behind this one, unless this is one of them.
+      // Only HTTP/1 sessions, the ones with chunked encoding, have requests in the client buffer.
+      ProxySession *ssn = ua_txn->is_chunked_encoding_supported() ? ua_txn->get_proxy_ssn() : nullptr;
+      if (ssn && ssn->pipeline_lookahead_pending > 0) {
+        --ssn->pipeline_lookahead_pending;
+      } else if (ssn && t_state.http_config_param->pipeline_lookahead > 0 && ua_buffer_reader->is_read_avail_more_than(0) &&
+                 t_state.hdr_info.client_request.is_keep_alive_set()) {
+        ssn->pipeline_lookahead_pending =
+          HttpPipelineLookahead::start(ua_buffer_reader, t_state.http_config_param->pipeline_lookahead);
+      }
     } else {
       // Disable further I/O on the client since there could
       //  be body that we are tunneling POST/PUT/CONNECT or
@@ -907,7 +1025,7 @@ HttpSM::wait_for_full_body()
   MIOBuffer *post_buffer    = new_MIOBuffer(alloc_index);
   IOBufferReader *buf_start = post_buffer->alloc_reader();
 
-  this->_postbuf.init(post_buffer->clone_reader(buf_start));
+  this->postbuf_init(post_buffer->clone_reader(buf_start));
 
   // Note: Many browsers, Netscape and IE included send two extra
   //  bytes (CRLF) at the end of the post.  We just ignore those
@@ -999,13 +1117,13 @@ HttpSM::state_watch_for_client_abort(int event, void *data)
     //    when we finish the current transaction
     break;
   case VC_EVENT_WRITE_READY:
-    // 100-continue handler
-    ink_assert(t_state.hdr_info.client_request.m_100_continue_required);
+    // 100-continue or 103 Early Hints handler
+    ink_assert(t_state.hdr_info.client_request.m_100_continue_required || early_hints_sent);
     ua_entry->write_vio->reenable();
     break;
   case VC_EVENT_WRITE_COMPLETE:
-    // 100-continue handler
-    ink_assert(t_state.hdr_info.client_request.m_100_continue_required);
+    // 100-continue or 103 Early Hints handler
+    ink_assert(t_state.hdr_info.client_request.m_100_continue_required || early_hints_sent);
     if (ua_entry->write_buffer) {
       ink_assert(ua_entry->write_vio && !ua_entry->write_vio->ntodo());
       free_MIOBuffer(ua_entry->write_buffer);
@@ -1040,7 +1158,7 @@ HttpSM::setup_push_read_response_header()
   // Note: we must use destroy() here since clear()
   //  does not free the memory from the header
   t_state.hdr_info.server_response.destroy();
-  t_state.hdr_info.server_response.create(HTTP_TYPE_RESPONSE);
+  t_state.hdr_info.server_response.create(HTTP_TYPE_RESPONSE, new_HdrHeap(HDR_HEAP_ROLE_SERVER_RESPONSE));
   http_parser_clear(&http_parser);
 
   // We already done the READ when we read the client
@@ -1170,6 +1288,9 @@ HttpSM::state_raw_http_server_open(int event, void *data)
   ink_assert(server_entry == nullptr);
   milestones[TS_MILESTONE_SERVER_CONNECT_END] = Thread::get_hrtime();
   NetVConnection *netvc                       = nullptr;
+  if (profile) {
+    profile->wait_end(HTTP_TXN_WAIT_ORIGIN, milestones[TS_MILESTONE_SERVER_CONNECT_END]);
+  }
 
   pending_action = nullptr;
   switch (event) {
@@ -1387,6 +1508,10 @@ HttpSM::state_api_callback(int event, void *data)
   reentrancy_count++;
 
   milestone_update_api_time(milestones, api_timer);
+  if (profile) {
+    // The plugin reenabled the transaction, what follows is not its time.
+    profile->hook_end();
+  }
 
   STATE_ENTER(&HttpSM::state_api_callback, event);
 
@@ -1496,6 +1621,9 @@ plugins required to work with sni_routing.
       // Have a mutex but didn't get the lock, reschedule
       if (!lock.is_locked()) {
         api_timer = -Thread::get_hrtime_updated();
+        if (profile) {
+          profile->lock_retry();
+        }
         HTTP_SM_SET_DEFAULT_HANDLER(&HttpSM::state_api_callout);
         ink_assert(pending_action == nullptr);
         pending_action = mutex->thread_holding->schedule_in(this, HRTIME_MSECONDS(10));
@@ -1514,7 +1642,13 @@ plugins required to work with sni_routing.
         api_timer = Thread::get_hrtime();
       }
 
+      if (profile) {
+        profile->hook_begin(cur_hook_id, reinterpret_cast<const void *>(hook->m_cont->m_event_func));
+      }
       hook->invoke(TS_EVENT_HTTP_READ_REQUEST_HDR + cur_hook_id, this);
+      if (profile) {
+        profile->hook_end();
+      }
       if (api_timer > 0) { // true if the hook did not call TxnReenable()
         milestone_update_api_time(milestones, api_timer);
         api_timer = -Thread::get_hrtime(); // set in order to track non-active callout duration
@@ -1560,7 +1694,9 @@ plugins required to work with sni_routing.
       t_state.api_http_sm_shutdown   = false;
       t_state.cache_info.object_read = nullptr;
       cache_sm.close_read();
-      transform_cache_sm.close_read();
+      if (transform_cache_sm) {
+        transform_cache_sm->close_read();
+      }
       release_server_session();
       terminate_sm                 = true;
       api_next                     = API_RETURN_SHUTDOWN;
@@ -1644,7 +1780,9 @@ HttpSM::handle_api_return()
       t_state.request_sent_time      = UNDEFINED_TIME;
       t_state.response_received_time = UNDEFINED_TIME;
       cache_sm.close_read();
-      transform_cache_sm.close_read();
+      if (transform_cache_sm) {
+        transform_cache_sm->close_read();
+      }
     }
     // fallthrough
 
@@ -1664,6 +1802,11 @@ HttpSM::handle_api_return()
     if (ua_txn) {
       ua_txn->set_inactivity_timeout(HRTIME_SECONDS(t_state.txn_conf->transaction_no_activity_timeout_in));
     }
+    // Pace the response, the remap rule or a plugin has had its say by now.
+    if (ua_txn && ua_txn->get_netvc()) {
+      const char *group = t_state.txn_conf->pacing_group;
+      ua_txn->get_netvc()->set_pacing(t_state.txn_conf->pacing_rate, group ? group : "");
+    }
 
     // We only follow 3xx when redirect_in_process == false. Otherwise the redirection has already been launched (in
     // SM_ACTION_SERVER_READ).redirect_in_process is set before this logic if we need more direction.
@@ -1783,11 +1926,14 @@ HttpSM::state_http_server_open(int event, void *data)
   }
   milestones[TS_MILESTONE_SERVER_CONNECT_END] = Thread::get_hrtime();
   NetVConnection *netvc                       = nullptr;
+  if (profile) {
+    profile->wait_end(HTTP_TXN_WAIT_ORIGIN, milestones[TS_MILESTONE_SERVER_CONNECT_END]);
+  }
 
   switch (event) {
   case NET_EVENT_OPEN: {
     Http1ServerSession *session =
-      (TS_SERVER_SESSION_SHARING_POOL_THREAD == t_state.http_config_param->server_session_sharing_pool) ?
+      (TS_SERVER_SESSION_SHARING_POOL_GLOBAL != t_state.http_config_param->server_session_sharing_pool) ?
         THREAD_ALLOC_INIT(httpServerSessionAllocator, mutex->thread_holding) :
         httpServerSessionAllocator.alloc();
     session->sharing_pool  = static_cast<TSServerSessionSharingPoolType>(t_state.http_config_param->server_session_sharing_pool);
@@ -1844,6 +1990,20 @@ HttpSM::state_http_server_open(int event, void *data)
     SMDebug("http_ss", "[%" PRId64 "] TCP Handshake complete", sm_id);
     server_entry->vc_handler = &HttpSM::state_send_server_request_header;
 
+    if (server_connection_offered_h2 && Http2ServerSession::is_h2_negotiated(server_session->get_netvc())) {
+      // The origin picked HTTP/2, the connection goes to a session and this transaction gets the first stream on it.
+      Http2ServerSession *h2_session =
+        Http2ServerSession::create(server_session->get_netvc(), server_session->hostname_hash, server_session->conn_track_group,
+                                   HRTIME_SECONDS(t_state.txn_conf->keep_alive_no_activity_timeout_out));
+      SMDebug("http_ss", "[%" PRId64 "] origin negotiated HTTP/2", sm_id);
+      server_session->conn_track_group = nullptr;
+      server_session->multiplexed      = true;
+      server_session->set_netvc(h2_session->new_stream());
+      server_entry->read_vio  = server_session->do_io_read(this, 0, server_session->read_buffer);
+      server_entry->write_vio = server_session->do_io_write(this, 0, nullptr);
+      set_server_netvc_active_timeout(server_session->get_netvc());
+    }
+
     // Reset the timeout to the non-connect timeout
     set_server_netvc_inactivity_timeout(server_session->get_netvc());
     handle_http_server_open();
@@ -1973,6 +2133,9 @@ HttpSM::state_read_server_response_header(int event, void *data)
     server_entry->read_vio->nbytes = server_entry->read_vio->ndone;
     http_parser_clear(&http_parser);
     milestones[TS_MILESTONE_SERVER_READ_HEADER_DONE] = Thread::get_hrtime();
+    if (profile) {
+      profile->wait_end(HTTP_TXN_WAIT_ORIGIN, milestones[TS_MILESTONE_SERVER_READ_HEADER_DONE]);
+    }
   }
 
   switch (state) {
@@ -2040,6 +2203,24 @@ HttpSM::state_read_server_response_header(int event, void *data)
     t_state.transact_return_point = HttpTransact::HandleResponse;
     t_state.api_next_action       = HttpTransact::SM_ACTION_API_READ_RESPONSE_HDR;
 
+    // Tell the next hop strategy how long the parent took to answer
+    if (t_state.current.request_to == HttpTransact::PARENT_PROXY && milestones[TS_MILESTONE_SERVER_BEGIN_WRITE] != 0) {
+      url_mapping *mp = t_state.url_map.getMapping();
+      if (mp && mp->strategy) {
+        mp->strategy->onParentResponse(reinterpret_cast<TSHttpTxn>(this),
+                                       milestones.elapsed(TS_MILESTONE_SERVER_BEGIN_WRITE, TS_MILESTONE_SERVER_READ_HEADER_DONE));
+      }
+    }
+
+    // Keep the preload links of the page for the next request of it
+    if (t_state.http_config_param->send_early_hints && t_state.hdr_info.server_response.status_get() == HTTP_STATUS_OK &&
+        t_state.hdr_info.client_request.method_get_wksidx() == HTTP_WKSIDX_GET) {
+      int url_len     = 0;
+      const char *url = t_state.hdr_info.client_request.url_string_get_ref(&url_len);
+      httpEarlyHints.remember({url, static_cast<size_t>(url_len)}, &t_state.hdr_info.server_response,
+                              t_state.http_config_param->early_hints_cache_size);
+    }
+
     // if exceeded limit deallocate postdata buffers and disable redirection
     if (!(enable_redirection && (redirection_tries <= t_state.txn_conf->number_of_redirections))) {
       this->disable_redirect();
@@ -2277,6 +2458,9 @@ HttpSM::process_hostdb_info(HostDBInfo *r)
   }
 
   milestones[TS_MILESTONE_DNS_LOOKUP_END] = Thread::get_hrtime();
+  if (profile) {
+    profile->wait_end(HTTP_TXN_WAIT_DNS, milestones[TS_MILESTONE_DNS_LOOKUP_END]);
+  }
 
   if (is_debug_tag_set("http_timeout")) {
     if (t_state.api_txn_dns_timeout_value != -1) {
@@ -2469,6 +2653,9 @@ HttpSM::state_cache_open_write(int event, void *data)
 
   milestones[TS_MILESTONE_CACHE_OPEN_WRITE_END] = Thread::get_hrtime();
   pending_action                                = nullptr;
+  if (profile) {
+    profile->wait_end(HTTP_TXN_WAIT_CACHE, milestones[TS_MILESTONE_CACHE_OPEN_WRITE_END]);
+  }
 
   switch (event) {
   case CACHE_EVENT_OPEN_WRITE:
@@ -2575,6 +2762,9 @@ HttpSM::state_cache_open_read(int event, void *data)
 {
   STATE_ENTER(&HttpSM::state_cache_open_read, event);
   milestones[TS_MILESTONE_CACHE_OPEN_READ_END] = Thread::get_hrtime();
+  if (profile) {
+    profile->wait_end(HTTP_TXN_WAIT_CACHE, milestones[TS_MILESTONE_CACHE_OPEN_READ_END]);
+  }
 
   ink_assert(server_entry == nullptr);
   ink_assert(t_state.cache_info.object_read == nullptr);
@@ -2987,6 +3177,14 @@ HttpSM::tunnel_handler_server(int event, HttpTunnelProducer *p)
 
   milestones[TS_MILESTONE_SERVER_CLOSE] = Thread::get_hrtime();
 
+  if (t_state.http_config_param->tcp_info && server_session && server_session->get_netvc() &&
+      server_session->get_netvc()->sample_tcp_info(server_tcp_info) && t_state.current.request_to == HttpTransact::PARENT_PROXY) {
+    url_mapping *mp = t_state.url_map.getMapping();
+    if (mp && mp->strategy) {
+      mp->strategy->onParentTcpInfo(reinterpret_cast<TSHttpTxn>(this), server_tcp_info);
+    }
+  }
+
   bool close_connection = false;
 
   if (t_state.current.server->keep_alive == HTTP_KEEPALIVE && server_entry->eos == false &&
@@ -3152,7 +3350,8 @@ HttpSM::tunnel_handler_server(int event, HttpTunnelProducer *p)
     // server session to so the next ka request can use it.  Server sessions will
     // be placed into the shared pool if the next incoming request is for a different
     // origin server
-    if (t_state.txn_conf->attach_server_session_to_client == 1 && ua_txn && t_state.client_info.keep_alive == HTTP_KEEPALIVE) {
+    if (t_state.txn_conf->attach_server_session_to_client == 1 && ua_txn && t_state.client_info.keep_alive == HTTP_KEEPALIVE &&
+        !server_session->multiplexed) {
       Debug("http", "attaching server session to the client");
       ua_txn->attach_server_session(server_session);
     } else {
@@ -3262,6 +3461,10 @@ HttpSM::tunnel_handler_ua(int event, HttpTunnelConsumer *c)
   ink_assert(c->vc == ua_txn);
   milestones[TS_MILESTONE_UA_CLOSE] = Thread::get_hrtime();
 
+  if (t_state.http_config_param->tcp_info && ua_txn->get_netvc()) {
+    ua_txn->get_netvc()->sample_tcp_info(client_tcp_info);
+  }
+
   switch (event) {
   case VC_EVENT_EOS:
     ua_entry->eos = true;
@@ -4121,6 +4324,9 @@ HttpSM::do_hostdb_lookup()
   ink_assert(pending_action == nullptr);
 
   milestones[TS_MILESTONE_DNS_LOOKUP_BEGIN] = Thread::get_hrtime();
+  if (profile) {
+    profile->wait_begin(HTTP_TXN_WAIT_DNS, milestones[TS_MILESTONE_DNS_LOOKUP_BEGIN]);
+  }
 
   if (t_state.txn_conf->srv_enabled) {
     char d[MAXDNAME];
@@ -4529,6 +4735,20 @@ HttpSM::do_range_parse(MIMEField *range_field)
   calculate_output_cl(num_chars_for_ct, num_chars_for_cl);
 }
 
+void
+HttpSM::do_background_revalidate()
+{
+  HttpCacheKey key;
+  URL *url = t_state.unmapped_url.valid() ? &t_state.unmapped_url : t_state.hdr_info.client_request.url_get();
+
+  Cache::generate_key(&key, t_state.cache_info.lookup_url, t_state.txn_conf->cache_generation_number);
+  if (HttpStaleRevalidate::start(key.hash, &t_state.hdr_info.client_request, url)) {
+    SMDebug("http", "[%" PRId64 "] revalidating the stale object in the background", sm_id);
+  } else {
+    SMDebug("http", "[%" PRId64 "] the stale object is already being revalidated", sm_id);
+  }
+}
+
 // this function looks for any Range: headers, parses them and either
 // sets up a transform processor to handle the request OR defers to the
 // HttpTunnel
@@ -4578,7 +4798,7 @@ HttpSM::do_range_setup_if_necessary()
 
       // We have to do the transform on (allowed) multi-range request, *or* if the VC is not pread capable
       if (do_transform) {
-        if (api_hooks.get(TS_HTTP_RESPONSE_TRANSFORM_HOOK) == nullptr) {
+        if (txn_hook_get(TS_HTTP_RESPONSE_TRANSFORM_HOOK) == nullptr) {
           int field_content_type_len = -1;
           const char *content_type   = t_state.cache_info.object_read->response_get()->value_get(
             MIME_FIELD_CONTENT_TYPE, MIME_LEN_CONTENT_TYPE, &field_content_type_len);
@@ -4589,7 +4809,7 @@ HttpSM::do_range_setup_if_necessary()
           INKVConnInternal *range_trans = transformProcessor.range_transform(
             mutex.get(), t_state.ranges, t_state.num_range_fields, &t_state.hdr_info.transform_response, content_type,
             field_content_type_len, t_state.cache_info.object_read->object_size_get());
-          api_hooks.append(TS_HTTP_RESPONSE_TRANSFORM_HOOK, range_trans);
+          get_api_hooks().append(TS_HTTP_RESPONSE_TRANSFORM_HOOK, range_trans);
         } else {
           // ToDo: Do we do something here? The theory is that multiple transforms do not behave well with
           // the range transform needed here.
@@ -4610,6 +4830,9 @@ HttpSM::do_cache_lookup_and_read()
 
   milestones[TS_MILESTONE_CACHE_OPEN_READ_BEGIN] = Thread::get_hrtime();
   t_state.cache_lookup_result                    = HttpTransact::CACHE_LOOKUP_NONE;
+  if (profile) {
+    profile->wait_begin(HTTP_TXN_WAIT_CACHE, milestones[TS_MILESTONE_CACHE_OPEN_READ_BEGIN]);
+  }
   t_state.cache_info.lookup_count++;
   // YTS Team, yamsat Plugin
   // Changed the lookup_url to c_url which enables even
@@ -4673,6 +4896,9 @@ inline void
 HttpSM::do_cache_prepare_write()
 {
   milestones[TS_MILESTONE_CACHE_OPEN_WRITE_BEGIN] = Thread::get_hrtime();
+  if (profile) {
+    profile->wait_begin(HTTP_TXN_WAIT_CACHE, milestones[TS_MILESTONE_CACHE_OPEN_WRITE_BEGIN]);
+  }
   do_cache_prepare_action(&cache_sm, t_state.cache_info.object_read, true);
 }
 
@@ -4680,9 +4906,9 @@ inline void
 HttpSM::do_cache_prepare_write_transform()
 {
   if (cache_sm.cache_write_vc != nullptr || tunnel.has_cache_writer()) {
-    do_cache_prepare_action(&transform_cache_sm, nullptr, false, true);
+    do_cache_prepare_action(&get_transform_cache_sm(), nullptr, false, true);
   } else {
-    do_cache_prepare_action(&transform_cache_sm, nullptr, false);
+    do_cache_prepare_action(&get_transform_cache_sm(), nullptr, false);
   }
 }
 
@@ -4767,7 +4993,7 @@ HttpSM::send_origin_throttled_response()
   call_transact_and_set_next_state(HttpTransact::HandleResponse);
 }
 
-static void
+void
 set_tls_options(NetVCOptions &opt, const OverridableHttpConfigParams *txn_conf)
 {
   char *verify_server = nullptr;
@@ -4890,6 +5116,9 @@ HttpSM::do_http_server_open(bool raw)
   SMDebug("http_seq", "[HttpSM::do_http_server_open] Sending request to server");
 
   milestones[TS_MILESTONE_SERVER_CONNECT] = Thread::get_hrtime();
+  if (profile) {
+    profile->wait_begin(HTTP_TXN_WAIT_ORIGIN, milestones[TS_MILESTONE_SERVER_CONNECT]);
+  }
   if (milestones[TS_MILESTONE_SERVER_FIRST_CONNECT] == 0) {
     milestones[TS_MILESTONE_SERVER_FIRST_CONNECT] = milestones[TS_MILESTONE_SERVER_CONNECT];
   }
@@ -4898,12 +5127,15 @@ HttpSM::do_http_server_open(bool raw)
   // Otherwise, if no remap rule is defined, apply the ip_allow filter.
   if (!t_state.url_remap_success || t_state.url_map.getMapping()->ip_allow_check_enabled_p) {
     // Method allowed on dest IP address check
-    sockaddr *server_ip    = &t_state.current.server->dst_addr.sa;
-    IpAllow::ACL acl       = IpAllow::match(server_ip, IpAllow::DST_ADDR);
-    bool deny_request      = false; // default is fail open.
-    int method             = t_state.hdr_info.server_request.method_get_wksidx();
-    int method_str_len     = 0;
-    const char *method_str = nullptr;
+    sockaddr *server_ip = &t_state.current.server->dst_addr.sa;
+    // The client session keeps the last destination ACL, transactions to the same server reuse it.
+    IpAllow::ACL txn_acl;
+    ProxySession *ssn       = ua_txn ? ua_txn->get_proxy_ssn() : nullptr;
+    const IpAllow::ACL &acl = ssn ? ssn->get_dst_acl(server_ip) : (txn_acl = IpAllow::match(server_ip, IpAllow::DST_ADDR));
+    bool deny_request       = false; // default is fail open.
+    int method              = t_state.hdr_info.server_request.method_get_wksidx();
+    int method_str_len      = 0;
+    const char *method_str  = nullptr;
 
     if (acl.isValid()) {
       if (acl.isDenyAll()) {
@@ -5040,6 +5272,34 @@ HttpSM::do_http_server_open(bool raw)
       ua_txn->attach_server_session(nullptr);
     }
   }
+  // A stream on an HTTP/2 connection already open to this origin, which is not a new connection to count.
+  if (server_session == nullptr && ua_txn != nullptr && is_http2_origin_eligible(raw)) {
+    CryptoHash hostname_hash;
+    CryptoContext().hash_immediate(hostname_hash, reinterpret_cast<const unsigned char *>(t_state.current.server->name),
+                                   strlen(t_state.current.server->name));
+    Http2ServerStream *stream = Http2ServerSession::acquire_stream(&t_state.current.server->dst_addr.sa, hostname_hash);
+    if (stream != nullptr) {
+      Http1ServerSession *session =
+        (TS_SERVER_SESSION_SHARING_POOL_GLOBAL != t_state.http_config_param->server_session_sharing_pool) ?
+          THREAD_ALLOC_INIT(httpServerSessionAllocator, mutex->thread_holding) :
+          httpServerSessionAllocator.alloc();
+      session->sharing_pool  = static_cast<TSServerSessionSharingPoolType>(t_state.http_config_param->server_session_sharing_pool);
+      session->sharing_match = static_cast<TSServerSessionSharingMatchMask>(t_state.txn_conf->server_session_sharing_match);
+      session->multiplexed   = true;
+      session->attach_hostname(t_state.current.server->name);
+      session->new_connection(stream);
+      session->state = HSS_ACTIVE;
+      ats_ip_copy(&t_state.server_info.src_addr, stream->get_local_addr());
+      SMDebug("http_ss", "[%" PRId64 "] new HTTP/2 stream to origin", sm_id);
+
+      attach_server_session(session);
+      session->to_parent_proxy = false;
+      server_connection_is_ssl = true;
+      handle_http_server_open();
+      return;
+    }
+  }
+
   // Check to see if we have reached the max number of connections.
   // Atomically read the current number of connections and check to see
   // if we have gone above the max allowed.
@@ -5077,19 +5337,19 @@ HttpSM::do_http_server_open(bool raw)
 
       ink_assert(pending_action == nullptr); // in case of reschedule must not have already pending.
 
+      // Wait for a connection to the upstream to close, or at most the queue delay before checking again.
+      ink_hrtime queue_delay = HRTIME_MSECONDS(t_state.http_config_param->outbound_conntrack.queue_delay.count());
       // If the queue is disabled, reschedule.
       if (t_state.http_config_param->outbound_conntrack.queue_size < 0) {
         ct_state.enqueue();
         ct_state.rescheduled();
-        pending_action =
-          eventProcessor.schedule_in(this, HRTIME_MSECONDS(t_state.http_config_param->outbound_conntrack.queue_delay.count()));
+        pending_action = ct_state.wait_for_slot(this, t_state.txn_conf->outbound_conntrack.max, queue_delay);
       } else if (t_state.http_config_param->outbound_conntrack.queue_size > 0) { // queue enabled, check for a slot
         auto wcount = ct_state.enqueue();
         if (wcount < t_state.http_config_param->outbound_conntrack.queue_size) {
           ct_state.rescheduled();
           SMDebug("http", "%s", lbw().print("[{}] queued for {}\0", sm_id, t_state.current.server->dst_addr).data());
-          pending_action =
-            eventProcessor.schedule_in(this, HRTIME_MSECONDS(t_state.http_config_param->outbound_conntrack.queue_delay.count()));
+          pending_action = ct_state.wait_for_slot(this, t_state.txn_conf->outbound_conntrack.max, queue_delay);
         } else {              // the queue is full
           ct_state.dequeue(); // release the queue slot
           ct_state.blocked(); // note the blockage.
@@ -5180,6 +5440,11 @@ HttpSM::do_http_server_open(bool raw)
   opt.ssl_client_private_key_name = t_state.txn_conf->ssl_client_private_key_filename;
   opt.ssl_client_ca_cert_name     = t_state.txn_conf->ssl_client_ca_cert_filename;
 
+  server_connection_offered_h2 = tls_upstream && is_http2_origin_eligible(raw);
+  if (server_connection_offered_h2) {
+    opt.alpn_protos = Http2ServerSession::ALPN_PROTOCOLS;
+  }
+
   if (tls_upstream) {
     SMDebug("http", "calling sslNetProcessor.connect_re");
 
@@ -5218,6 +5483,26 @@ HttpSM::do_http_server_open(bool raw)
   return;
 }
 
+// Whether the request may go over a shared HTTP/2 connection. HTTP/2 is only negotiated with
+// ALPN, and the stream has no way to send a request body of unknown length.
+bool
+HttpSM::is_http2_origin_eligible(bool raw)
+{
+  if (!Http2::origin_enabled || raw || t_state.is_websocket || t_state.current.request_to == HttpTransact::PARENT_PROXY ||
+      plugin_tunnel_type != HTTP_NO_PLUGIN_TUNNEL || is_private()) {
+    return false;
+  }
+  if (t_state.client_info.transfer_encoding == HttpTransact::CHUNKED_ENCODING ||
+      t_state.hdr_info.server_request.presence(MIME_PRESENCE_TRANSFER_ENCODING)) {
+    return false;
+  }
+  int scheme = t_state.hdr_info.server_request.url_get()->scheme_get_wksidx();
+  if (scheme < 0) {
+    scheme = t_state.hdr_info.client_request.url_get()->scheme_get_wksidx();
+  }
+  return scheme == URL_WKSIDX_HTTPS;
+}
+
 int
 HttpSM::do_api_callout_internal()
 {
@@ -5269,7 +5554,7 @@ HttpSM::do_api_callout_internal()
     ink_assert(!"not reached");
   }
 
-  hook_state.init(cur_hook_id, http_global_hooks, ua_txn ? ua_txn->feature_hooks() : nullptr, &api_hooks);
+  hook_state.init(cur_hook_id, http_global_hooks, ua_txn ? ua_txn->feature_hooks() : nullptr, api_hooks);
   cur_hook  = nullptr;
   cur_hooks = 0;
   return state_api_callout(0, nullptr);
@@ -5284,7 +5569,7 @@ HttpSM::do_post_transform_open()
     txn_hook_add(TS_HTTP_REQUEST_TRANSFORM_HOOK, transformProcessor.null_transform(mutex.get()));
   }
 
-  post_transform_info.vc = transformProcessor.open(this, api_hooks.get(TS_HTTP_REQUEST_TRANSFORM_HOOK));
+  post_transform_info.vc = transformProcessor.open(this, txn_hook_get(TS_HTTP_REQUEST_TRANSFORM_HOOK));
   if (post_transform_info.vc) {
     // Record the transform VC in our table
     post_transform_info.entry          = vc_table.new_entry();
@@ -5305,7 +5590,7 @@ HttpSM::do_transform_open()
     txn_hook_add(TS_HTTP_RESPONSE_TRANSFORM_HOOK, transformProcessor.null_transform(mutex.get()));
   }
 
-  hooks = api_hooks.get(TS_HTTP_RESPONSE_TRANSFORM_HOOK);
+  hooks = txn_hook_get(TS_HTTP_RESPONSE_TRANSFORM_HOOK);
   if (hooks) {
     transform_info.vc = transformProcessor.open(this, hooks);
 
@@ -5449,7 +5734,7 @@ HttpSM::release_server_session(bool serve_from_cache)
     HTTP_DECREMENT_DYN_STAT(http_current_server_transactions_stat);
     server_session->server_trans_stat--;
     server_session->attach_hostname(t_state.current.server->name);
-    if (t_state.www_auth_content == HttpTransact::CACHE_AUTH_NONE || serve_from_cache == false) {
+    if (t_state.www_auth_content == HttpTransact::CACHE_AUTH_NONE || serve_from_cache == false || server_session->multiplexed) {
       // Must explicitly set the keep_alive_no_activity time before doing the release
       server_session->get_netvc()->set_inactivity_timeout(HRTIME_SECONDS(t_state.txn_conf->keep_alive_no_activity_timeout_out));
       server_session->release();
@@ -5753,7 +6038,8 @@ HttpSM::do_drain_request_body(HTTPHdr &response)
   int64_t content_length = t_state.hdr_info.client_request.get_content_length();
   int64_t avail          = ua_buffer_reader->read_avail();
 
-  if (t_state.client_info.transfer_encoding == HttpTransact::CHUNKED_ENCODING) {
+  if (t_state.client_info.transfer_encoding == HttpTransact::CHUNKED_ENCODING ||
+      t_state.hdr_info.server_request.presence(MIME_PRESENCE_TRANSFER_ENCODING)) {
     SMDebug("http", "Chunked body, setting the response to non-keepalive");
     goto close_connection;
   }
@@ -5787,13 +6073,13 @@ HttpSM::do_setup_post_tunnel(HttpVC_t to_vc_type)
   // if redirect_in_process and redirection is enabled add static producer
 
   if (is_using_post_buffer ||
-      (t_state.redirect_info.redirect_in_process && enable_redirection && this->_postbuf.postdata_copy_buffer_start != nullptr)) {
+      (t_state.redirect_info.redirect_in_process && enable_redirection && this->is_postbuf_valid())) {
     post_redirect = true;
     // copy the post data into a new producer buffer for static producer
     MIOBuffer *postdata_producer_buffer      = new_empty_MIOBuffer(t_state.http_config_param->max_payload_iobuf_index);
     IOBufferReader *postdata_producer_reader = postdata_producer_buffer->alloc_reader();
 
-    postdata_producer_buffer->write(this->_postbuf.postdata_copy_buffer_start);
+    postdata_producer_buffer->write(this->_postbuf->postdata_copy_buffer_start);
     int64_t post_bytes = postdata_producer_reader->read_avail();
     transfered_bytes   = post_bytes;
     p = tunnel.add_producer(HTTP_TUNNEL_STATIC_PRODUCER, post_bytes, postdata_producer_reader, (HttpProducerHandler) nullptr,
@@ -5815,7 +6101,7 @@ HttpSM::do_setup_post_tunnel(HttpVC_t to_vc_type)
     int64_t post_bytes        = chunked ? INT64_MAX : t_state.hdr_info.request_content_length;
 
     if (enable_redirection) {
-      this->_postbuf.init(post_buffer->clone_reader(buf_start));
+      this->postbuf_init(post_buffer->clone_reader(buf_start));
     }
 
     // Note: Many browsers, Netscape and IE included send two extra
@@ -5901,14 +6187,16 @@ HttpSM::perform_transform_cache_write_action()
   switch (t_state.cache_info.transform_action) {
   case HttpTransact::CACHE_DO_NO_ACTION: {
     // Nothing to do
-    transform_cache_sm.end_both();
+    if (transform_cache_sm) {
+      transform_cache_sm->end_both();
+    }
     break;
   }
 
   case HttpTransact::CACHE_DO_WRITE: {
-    transform_cache_sm.close_read();
+    get_transform_cache_sm().close_read();
     t_state.cache_info.transform_write_status = HttpTransact::CACHE_WRITE_IN_PROGRESS;
-    setup_cache_write_transfer(&transform_cache_sm, transform_info.entry->vc, &t_state.cache_info.transform_store,
+    setup_cache_write_transfer(transform_cache_sm, transform_info.entry->vc, &t_state.cache_info.transform_store,
                                client_response_hdr_bytes, "cache write t");
     break;
   }
@@ -5981,9 +6269,11 @@ HttpSM::perform_cache_write_action()
     } else {
       // We are not caching the untransformed.  We might want to
       //  use the cache writevc to cache the transformed copy
-      ink_assert(transform_cache_sm.cache_write_vc == nullptr);
-      transform_cache_sm.cache_write_vc = cache_sm.cache_write_vc;
-      cache_sm.cache_write_vc           = nullptr;
+      HttpCacheSM &t_cache_sm = get_transform_cache_sm();
+      ink_assert(t_cache_sm.cache_write_vc == nullptr);
+      t_cache_sm.cache_write_vc = cache_sm.cache_write_vc;
+      cache_sm.cache_write_vc   = nullptr;
+      cache_sm.release_collapsed_waiters();
     }
     break;
 
@@ -6166,14 +6456,13 @@ HttpSM::setup_server_send_request()
   }
 
   milestones[TS_MILESTONE_SERVER_BEGIN_WRITE] = Thread::get_hrtime();
-  server_entry->write_vio                     = server_entry->vc->do_io_write(this, hdr_length, buf_start);
+  if (profile) {
+    profile->wait_begin(HTTP_TXN_WAIT_ORIGIN, milestones[TS_MILESTONE_SERVER_BEGIN_WRITE]);
+  }
+  server_entry->write_vio = server_entry->vc->do_io_write(this, hdr_length, buf_start);
 
   // Make sure the VC is using correct timeouts.  We may be reusing a previously used server session
-  if (t_state.api_txn_no_activity_timeout_value != -1) {
-    server_session->get_netvc()->set_inactivity_timeout(HRTIME_MSECONDS(t_state.api_txn_no_activity_timeout_value));
-  } else {
-    server_session->get_netvc()->set_inactivity_timeout(HRTIME_SECONDS(t_state.txn_conf->transaction_no_activity_timeout_out));
-  }
+  set_server_netvc_inactivity_timeout(server_session->get_netvc());
 }
 
 void
@@ -6199,7 +6488,7 @@ HttpSM::setup_server_read_response_header()
   // Note: we must use destroy() here since clear()
   //  does not free the memory from the header
   t_state.hdr_info.server_response.destroy();
-  t_state.hdr_info.server_response.create(HTTP_TYPE_RESPONSE);
+  t_state.hdr_info.server_response.create(HTTP_TYPE_RESPONSE, new_HdrHeap(HDR_HEAP_ROLE_SERVER_RESPONSE));
   http_parser_clear(&http_parser);
   server_response_hdr_bytes                        = 0;
   milestones[TS_MILESTONE_SERVER_READ_HEADER_DONE] = 0;
@@ -6313,12 +6602,58 @@ HttpSM::setup_cache_write_transfer(HttpCacheSM *c_sm, VConnection *source_vc, HT
 
   c_sm->cache_write_vc->set_http_info(store_info);
   store_info->clear();
+  // The header is in the cache now, so collapsed requests can read while we write.
+  c_sm->release_collapsed_waiters();
 
   tunnel.add_consumer(c_sm->cache_write_vc, source_vc, &HttpSM::tunnel_handler_cache_write, HT_CACHE_WRITE, name, skip_bytes);
 
   c_sm->cache_write_vc = nullptr;
 }
 
+// void HttpSM::send_early_hints()
+//
+//   Sends the client a 103 with the preload links known for the URL, from
+//   the last response for it or from the stale object in cache, while the
+//   origin is asked for the final response.
+//
+void
+HttpSM::send_early_hints()
+{
+  HTTPHdr &request = t_state.hdr_info.client_request;
+
+  // Nothing else may be written to the client yet, so no 100 Continue and no request body.
+  if (!t_state.http_config_param->send_early_hints || early_hints_sent || ua_txn == nullptr || ua_entry == nullptr ||
+      ua_entry->write_vio != nullptr || request.version_get() < HTTPVersion(1, 1) ||
+      (request.method_get_wksidx() != HTTP_WKSIDX_GET && request.method_get_wksidx() != HTTP_WKSIDX_HEAD)) {
+    return;
+  }
+
+  std::string links;
+  int url_len     = 0;
+  const char *url = request.url_string_get_ref(&url_len);
+  if (!httpEarlyHints.lookup({url, static_cast<size_t>(url_len)}, links)) {
+    CacheHTTPInfo *cached = t_state.cache_info.object_read;
+    if (cached == nullptr || !cached->valid() || !HttpEarlyHints::preload_links(cached->response_get(), links)) {
+      return;
+    }
+  }
+
+  std::string response = HttpEarlyHints::response(links);
+  int64_t alloc_index  = buffer_size_to_index(response.size(), t_state.http_config_param->max_payload_iobuf_index);
+  if (ua_entry->write_buffer) {
+    free_MIOBuffer(ua_entry->write_buffer);
+    ua_entry->write_buffer = nullptr;
+  }
+  ua_entry->write_buffer    = new_MIOBuffer(alloc_index);
+  IOBufferReader *buf_start = ua_entry->write_buffer->alloc_reader();
+  early_hints_sent          = true;
+
+  SMDebug("http_seq", "send 103 Early Hints to client: %s", links.c_str());
+  HTTP_INCREMENT_DYN_STAT(http_early_hints_responses_stat);
+  int64_t nbytes      = ua_entry->write_buffer->write(response.data(), response.size());
+  ua_entry->write_vio = ua_txn->do_io_write(this, nbytes, buf_start);
+}
+
 void
 HttpSM::setup_100_continue_transfer()
 {
@@ -6494,6 +6829,12 @@ HttpSM::find_http_resp_buffer_size(int64_t content_length)
     if (alloc_index < MIN_CONFIG_BUFFER_SIZE_INDEX || alloc_index > DEFAULT_MAX_BUFFER_SIZE) {
       alloc_index = DEFAULT_RESPONSE_BUFFER_SIZE_INDEX;
     }
+    // Unless the client connection can have more than that in flight.
+    if (t_state.http_config_param->tcp_info == 2 && ua_txn && ua_txn->get_netvc() &&
+        ua_txn->get_netvc()->sample_tcp_info(client_tcp_info)) {
+      alloc_index =
+        std::max(alloc_index, buffer_size_to_index(client_tcp_info.bdp(), t_state.http_config_param->max_payload_iobuf_index));
+    }
   } else {
     int64_t buf_size = index_to_buffer_size(HTTP_HEADER_BUFFER_SIZE_INDEX) + content_length;
     alloc_index      = buffer_size_to_index(buf_size, t_state.http_config_param->max_payload_iobuf_index);
@@ -6887,7 +7228,7 @@ HttpSM::setup_plugin_agents(HttpTunnelProducer *p)
 inline void
 HttpSM::transform_cleanup(TSHttpHookID hook, HttpTransformInfo *info)
 {
-  APIHook *t_hook = api_hooks.get(hook);
+  APIHook *t_hook = txn_hook_get(hook);
   if (t_hook && info->vc == nullptr) {
     do {
       VConnection *t_vcon = t_hook->m_cont;
@@ -6947,7 +7288,9 @@ HttpSM::kill_this()
     }
 
     cache_sm.end_both();
-    transform_cache_sm.end_both();
+    if (transform_cache_sm) {
+      transform_cache_sm->end_both();
+    }
     vc_table.cleanup_all();
 
     // tunnel.deallocate_buffers();
@@ -7069,6 +7412,7 @@ void
 HttpSM::update_stats()
 {
   milestones[TS_MILESTONE_SM_FINISH] = Thread::get_hrtime();
+  HTTP_SUM_DYN_STAT(http_sm_memory_stat, memory_footprint());
 
   if (is_action_tag_set("bad_length_state_dump")) {
     if (t_state.hdr_info.client_response.valid() && t_state.hdr_info.client_response.status_get() == HTTP_STATUS_OK) {
@@ -7123,6 +7467,18 @@ HttpSM::update_stats()
     &t_state, total_time, ua_write_time, os_read_time, client_request_hdr_bytes, client_request_body_bytes,
     client_response_hdr_bytes, client_response_body_bytes, server_request_hdr_bytes, server_request_body_bytes,
     server_response_hdr_bytes, server_response_body_bytes, pushed_response_hdr_bytes, pushed_response_body_bytes, milestones);
+
+  if (client_tcp_info.valid) {
+    http_histograms[http_client_rtt_histogram].record(client_tcp_info.rtt_us / 1000);
+    http_histograms[http_client_retransmits_histogram].record(client_tcp_info.retransmits);
+  }
+  if (server_tcp_info.valid) {
+    http_histograms[http_server_rtt_histogram].record(server_tcp_info.rtt_us / 1000);
+    http_histograms[http_server_retransmits_histogram].record(server_tcp_info.retransmits);
+  }
+  if (profile) {
+    profile->finish(milestones[TS_MILESTONE_SM_FINISH]);
+  }
   /*
       if (is_action_tag_set("http_handler_times")) {
           print_all_http_handler_times();
@@ -7228,15 +7584,17 @@ HttpSM::dump_state_on_assert()
 {
   Error("[%" PRId64 "] ------- begin http state dump -------", sm_id);
 
-  if (history.overflowed()) {
-    Error("   History Wrap around. history size: %d", history.size());
+  if (history == nullptr) {
+    Error("   No history, proxy.config.http.enable_sm_history is not set");
+  } else if (history->overflowed()) {
+    Error("   History Wrap around. history size: %d", history->size());
   }
   // Loop through the history and dump it
-  for (unsigned int i = 0; i < history.size(); i++) {
+  for (unsigned int i = 0; history && i < history->size(); i++) {
     char buf[256];
-    int r = history[i].reentrancy;
-    int e = history[i].event;
-    Error("%d   %d   %s", e, r, history[i].location.str(buf, sizeof(buf)));
+    int r = (*history)[i].reentrancy;
+    int e = (*history)[i].event;
+    Error("%d   %d   %s", e, r, (*history)[i].location.str(buf, sizeof(buf)));
   }
 
   // Dump the via string
@@ -7508,6 +7866,7 @@ HttpSM::set_next_state()
       }
     }
 
+    send_early_hints();
     do_http_server_open();
     break;
   }
@@ -7682,7 +8041,7 @@ HttpSM::set_next_state()
   case HttpTransact::SM_ACTION_CACHE_ISSUE_WRITE_TRANSFORM: {
     ink_assert(t_state.cache_info.transform_action == HttpTransact::CACHE_PREPARE_TO_WRITE);
 
-    if (transform_cache_sm.cache_write_vc) {
+    if (transform_cache_sm && transform_cache_sm->cache_write_vc) {
       // We've already got the write_vc that
       //  didn't use for the untransformed copy
       ink_assert(cache_sm.cache_write_vc == nullptr);
@@ -8048,6 +8407,9 @@ HttpSM::get_http_schedule(int event, void * /* data ATS_UNUSED */)
     plugin_lock  = MUTEX_TAKE_TRY_LOCK(schedule_cont->mutex, mutex->thread_holding);
 
     if (!plugin_lock) {
+      if (profile) {
+        profile->lock_retry();
+      }
       HTTP_SM_SET_DEFAULT_HANDLER(&HttpSM::get_http_schedule);
       ink_assert(pending_action == nullptr);
       pending_action = mutex->thread_holding->schedule_in(this, HRTIME_MSECONDS(10));
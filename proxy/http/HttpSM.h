@@ -40,6 +40,7 @@
 #include "HttpTransact.h"
 #include "UrlRewrite.h"
 #include "HttpTunnel.h"
+#include "HttpTxnProfile.h"
 #include "InkAPIInternal.h"
 #include "../ProxyTransaction.h"
 #include "HdrUtils.h"
@@ -84,6 +85,9 @@ enum BackgroundFill_t {
 
 extern ink_mutex debug_sm_list_mutex;
 
+/// Set the origin certificate verification options of @a opt from @a txn_conf.
+void set_tls_options(NetVCOptions &opt, const OverridableHttpConfigParams *txn_conf);
+
 struct HttpVCTableEntry {
   VConnection *vc;
   MIOBuffer *read_buffer;
@@ -242,6 +246,10 @@ public:
   //  directly from transact
   void do_hostdb_update_if_necessary();
 
+  // Called by transact. Revalidate the stale cached object it serves in the
+  //  background, unless that is already being done
+  void do_background_revalidate();
+
   // Called by transact. Decide if cached response supports Range and
   // setup Range transfomration if so.
   // return true when the Range is unsatisfiable
@@ -365,7 +373,8 @@ public:
   void set_http_schedule(Continuation *);
   int get_http_schedule(int event, void *data);
 
-  History<HISTORY_DEFAULT_SIZE> history;
+  /// Set if proxy.config.http.enable_sm_history is, allocated by init.
+  History<HISTORY_DEFAULT_SIZE> *history = nullptr;
 
 protected:
   IOBufferReader *ua_buffer_reader     = nullptr;
@@ -390,7 +399,9 @@ protected:
   bool has_active_plugin_agents = false;
 
   HttpCacheSM cache_sm;
-  HttpCacheSM transform_cache_sm;
+  /// Only used to cache transformed content, see get_transform_cache_sm.
+  HttpCacheSM *transform_cache_sm = nullptr;
+  HttpCacheSM &get_transform_cache_sm();
 
   HttpSMHandler default_handler = nullptr;
   Action *pending_action        = nullptr;
@@ -461,6 +472,7 @@ protected:
   void do_hostdb_reverse_lookup();
   void do_cache_lookup_and_read();
   void do_http_server_open(bool raw = false);
+  bool is_http2_origin_eligible(bool raw);
   void send_origin_throttled_response();
   void do_setup_post_tunnel(HttpVC_t to_vc_type);
   void do_cache_prepare_write();
@@ -501,6 +513,7 @@ protected:
   void setup_internal_transfer(HttpSMHandler handler);
   void setup_error_transfer();
   void setup_100_continue_transfer();
+  void send_early_hints();
   HttpTunnelProducer *setup_push_transfer_to_cache();
   void setup_transform_to_server_transfer();
   void setup_cache_write_transfer(HttpCacheSM *c_sm, VConnection *source_vc, HTTPInfo *store_info, int64_t skip_bytes,
@@ -548,17 +561,24 @@ public:
   bool client_connection_is_ssl       = false;
   bool is_internal                    = false;
   bool server_connection_is_ssl       = false;
+  bool server_connection_offered_h2   = false;
   bool is_waiting_for_full_body       = false;
   bool is_using_post_buffer           = false;
+  bool early_hints_sent               = false; ///< A 103 went to the client, the final response is still to come.
   std::optional<bool> mptcp_state; // Don't initialize, that marks it as "not defined".
   const char *client_protocol     = "-";
   const char *client_sec_protocol = "-";
   const char *client_cipher_suite = "-";
   const char *client_curve        = "-";
+  char client_ja3_fingerprint[33] = "-"; ///< Copied from the connection, which may go first.
   int server_transact_count       = 0;
+  NetVCTcpInfo client_tcp_info; ///< Sampled at the end of the transaction, see proxy.config.http.tcp_info.
+  NetVCTcpInfo server_tcp_info;
 
   TransactionMilestones milestones;
   ink_hrtime api_timer = 0;
+  /// Only for the transactions sampled by proxy.config.http.profile.sample_rate.
+  HttpTxnProfile *profile = nullptr;
   // The next two enable plugins to tag the state machine for
   // the purposes of logging so the instances can be correlated
   // with the source plugin.
@@ -584,8 +604,9 @@ protected:
 
   // api_hooks must not be changed directly
   //  Use txn_hook_{ap,pre}pend so hooks_set is
-  //  updated
-  HttpAPIHooks api_hooks;
+  //  updated. It is allocated with the first hook.
+  HttpAPIHooks *api_hooks = nullptr;
+  HttpAPIHooks &get_api_hooks();
 
   // The terminate flag is set by handlers and checked by the
   //   main handler who will terminate the state machine
@@ -596,6 +617,7 @@ protected:
   virtual int kill_this_async_hook(int event, void *data);
   void kill_this();
   void update_stats();
+  int64_t memory_footprint() const;
   void transform_cleanup(TSHttpHookID hook, HttpTransformInfo *info);
   bool is_transparent_passthrough_allowed();
   void plugin_agents_cleanup();
@@ -636,12 +658,14 @@ public:
   }
 
   void set_server_netvc_inactivity_timeout(NetVConnection *netvc);
+  int get_peer_timeout() const;
   void set_server_netvc_active_timeout(NetVConnection *netvc);
   void set_server_netvc_connect_timeout(NetVConnection *netvc);
   void rewind_state_machine();
 
 private:
-  PostDataBuffers _postbuf;
+  /// Allocated by postbuf_init, for redirects of requests with a body.
+  PostDataBuffers *_postbuf = nullptr;
   int _client_connection_id = -1, _client_transaction_id = -1;
   int _client_transaction_priority_weight = -1, _client_transaction_priority_dependence = -1;
   bool _from_early_data = false;
@@ -680,14 +704,14 @@ HttpSM::find_server_buffer_size()
 inline void
 HttpSM::txn_hook_add(TSHttpHookID id, INKContInternal *cont)
 {
-  api_hooks.append(id, cont);
+  get_api_hooks().append(id, cont);
   hooks_set = true;
 }
 
 inline APIHook *
 HttpSM::txn_hook_get(TSHttpHookID id)
 {
-  return api_hooks.get(id);
+  return api_hooks ? api_hooks->get(id) : nullptr;
 }
 
 inline bool
@@ -699,60 +723,56 @@ HttpSM::is_transparent_passthrough_allowed()
 inline int64_t
 HttpSM::postbuf_reader_avail()
 {
-  return this->_postbuf.ua_buffer_reader->read_avail();
+  return this->_postbuf->ua_buffer_reader->read_avail();
 }
 
 inline int64_t
 HttpSM::postbuf_buffer_avail()
 {
-  return this->_postbuf.postdata_copy_buffer_start->read_avail();
+  return this->_postbuf->postdata_copy_buffer_start->read_avail();
 }
 
 inline void
 HttpSM::postbuf_clear()
 {
-  this->_postbuf.clear();
+  if (this->_postbuf) {
+    this->_postbuf->clear();
+  }
 }
 
 inline void
 HttpSM::disable_redirect()
 {
   this->enable_redirection = false;
-  this->_postbuf.clear();
+  this->postbuf_clear();
 }
 
 inline void
 HttpSM::postbuf_copy_partial_data()
 {
-  this->_postbuf.copy_partial_post_data();
-}
-
-inline void
-HttpSM::postbuf_init(IOBufferReader *ua_reader)
-{
-  this->_postbuf.init(ua_reader);
+  this->_postbuf->copy_partial_post_data();
 }
 
 inline void
 HttpSM::set_postbuf_done(bool done)
 {
-  this->_postbuf.set_post_data_buffer_done(done);
+  this->_postbuf->set_post_data_buffer_done(done);
 }
 
 inline bool
 HttpSM::get_postbuf_done()
 {
-  return this->_postbuf.get_post_data_buffer_done();
+  return this->_postbuf && this->_postbuf->get_post_data_buffer_done();
 }
 
 inline bool
 HttpSM::is_postbuf_valid()
 {
-  return this->_postbuf.is_valid();
+  return this->_postbuf && this->_postbuf->is_valid();
 }
 
 inline IOBufferReader *
 HttpSM::get_postbuf_clone_reader()
 {
-  return this->_postbuf.get_post_data_buffer_clone_reader();
+  return this->_postbuf ? this->_postbuf->get_post_data_buffer_clone_reader() : nullptr;
 }
@@ -35,6 +35,7 @@
 #include "Http1ServerSession.h"
 #include "HttpSM.h"
 #include "HttpDebugNames.h"
+#include "PreWarmManager.h"
 
 // Initialize a thread to handle HTTP session management
 void
@@ -45,6 +46,34 @@ initialize_thread_for_http_sessions(EThread *thread)
 
 HttpSessionManager httpSessionManager;
 
+// Move a session taken out of the pool of another thread to @a ethread.
+// If that fails the session is closed and false is returned.
+static bool
+move_session_to_thread(Http1ServerSession *ss, HttpSM *sm, EThread *ethread)
+{
+  UnixNetVConnection *server_vc = dynamic_cast<UnixNetVConnection *>(ss->get_netvc());
+  if (server_vc) {
+    UnixNetVConnection *new_vc = server_vc->migrateToCurrentThread(sm, ethread);
+    // The VC moved, free up the original one
+    if (new_vc != server_vc) {
+      ink_assert(new_vc == nullptr || new_vc->nh != nullptr);
+      if (!new_vc) {
+        // Close out the session, we were't able to get a connection
+        HTTP_INCREMENT_DYN_STAT(http_origin_shutdown_migration_failure);
+        ss->do_io_close();
+        return false;
+      }
+      // Keep things from timing out on us
+      new_vc->set_inactivity_timeout(new_vc->get_inactivity_timeout());
+      ss->set_netvc(new_vc);
+    } else {
+      // Keep things from timing out on us
+      server_vc->set_inactivity_timeout(server_vc->get_inactivity_timeout());
+    }
+  }
+  return true;
+}
+
 ServerSessionPool::ServerSessionPool() : Continuation(new_ProxyMutex()), m_ip_pool(1023), m_fqdn_pool(1023)
 {
   SET_HANDLER(&ServerSessionPool::eventHandler);
@@ -379,43 +408,33 @@ HttpSessionManager::acquire_session(Continuation * /* cont ATS_UNUSED */, sockad
   {
     // Now check to see if we have a connection in our shared connection pool
     EThread *ethread = this_ethread();
+    TSServerSessionSharingPoolType pool_type =
+      static_cast<TSServerSessionSharingPoolType>(sm->t_state.http_config_param->server_session_sharing_pool);
     Ptr<ProxyMutex> pool_mutex =
-      (TS_SERVER_SESSION_SHARING_POOL_THREAD == sm->t_state.http_config_param->server_session_sharing_pool) ?
-        ethread->server_session_pool->mutex :
-        m_g_pool->mutex;
+      (TS_SERVER_SESSION_SHARING_POOL_GLOBAL != pool_type) ? ethread->server_session_pool->mutex : m_g_pool->mutex;
     MUTEX_TRY_LOCK(lock, pool_mutex, ethread);
     if (lock.is_locked()) {
-      if (TS_SERVER_SESSION_SHARING_POOL_THREAD == sm->t_state.http_config_param->server_session_sharing_pool) {
+      if (TS_SERVER_SESSION_SHARING_POOL_GLOBAL != pool_type) {
         retval = ethread->server_session_pool->acquireSession(ip, hostname_hash, match_style, sm, to_return);
         Debug("http_ss", "[acquire session] thread pool search %s", to_return ? "successful" : "failed");
+        if (TS_SERVER_SESSION_SHARING_POOL_HYBRID == pool_type) {
+          if (to_return) {
+            HTTP_INCREMENT_DYN_STAT(http_origin_pool_local_hit_stat);
+          } else if (steal_session(ip, hostname_hash, match_style, sm, to_return)) {
+            HTTP_INCREMENT_DYN_STAT(http_origin_pool_steal_stat);
+            retval = HSM_DONE;
+          } else {
+            HTTP_INCREMENT_DYN_STAT(http_origin_pool_miss_stat);
+          }
+        }
       } else {
         retval = m_g_pool->acquireSession(ip, hostname_hash, match_style, sm, to_return);
         Debug("http_ss", "[acquire session] global pool search %s", to_return ? "successful" : "failed");
         // At this point to_return has been removed from the pool. Do we need to move it
         // to the same thread?
-        if (to_return) {
-          UnixNetVConnection *server_vc = dynamic_cast<UnixNetVConnection *>(to_return->get_netvc());
-          if (server_vc) {
-            UnixNetVConnection *new_vc = server_vc->migrateToCurrentThread(sm, ethread);
-            // The VC moved, free up the original one
-            if (new_vc != server_vc) {
-              ink_assert(new_vc == nullptr || new_vc->nh != nullptr);
-              if (!new_vc) {
-                // Close out to_return, we were't able to get a connection
-                HTTP_INCREMENT_DYN_STAT(http_origin_shutdown_migration_failure);
-                to_return->do_io_close();
-                to_return = nullptr;
-                retval    = HSM_NOT_FOUND;
-              } else {
-                // Keep things from timing out on us
-                new_vc->set_inactivity_timeout(new_vc->get_inactivity_timeout());
-                to_return->set_netvc(new_vc);
-              }
-            } else {
-              // Keep things from timing out on us
-              server_vc->set_inactivity_timeout(server_vc->get_inactivity_timeout());
-            }
-          }
+        if (to_return && !move_session_to_thread(to_return, sm, ethread)) {
+          to_return = nullptr;
+          retval    = HSM_NOT_FOUND;
         }
       }
     } else { // Didn't get the lock.  to_return is still NULL
@@ -425,20 +444,60 @@ HttpSessionManager::acquire_session(Continuation * /* cont ATS_UNUSED */, sockad
 
   if (to_return) {
     Debug("http_ss", "[%" PRId64 "] [acquire session] return session from shared pool", to_return->con_id);
+    if (to_return->prewarm_target) {
+      PreWarmManager::session_used(to_return);
+    }
     to_return->state = HSS_ACTIVE;
     // the attach_server_session will issue the do_io_read under the sm lock
     sm->attach_server_session(to_return);
     retval = HSM_DONE;
+  } else if (retval == HSM_NOT_FOUND && sm->t_state.url_map.getMapping() && sm->t_state.url_map.getMapping()->prewarm_conns) {
+    HTTP_INCREMENT_DYN_STAT(http_prewarm_miss_stat);
   }
   return retval;
 }
 
+// The pools of the other threads are only tried, a busy one is skipped rather than waited for.
+// The search starts at a different thread every time so no single pool is drained first.
+bool
+HttpSessionManager::steal_session(sockaddr const *ip, CryptoHash const &hostname_hash, TSServerSessionSharingMatchMask match_style,
+                                  HttpSM *sm, Http1ServerSession *&to_return)
+{
+  static thread_local unsigned next_victim = 0;
+
+  EThread *ethread = this_ethread();
+  int nthreads     = eventProcessor.thread_group[ET_NET]._count;
+  unsigned start   = next_victim++;
+
+  to_return = nullptr;
+  for (int i = 0; i < nthreads; ++i) {
+    EThread *victim         = eventProcessor.thread_group[ET_NET]._thread[(start + i) % nthreads];
+    ServerSessionPool *pool = victim->server_session_pool;
+    if (victim == ethread || pool == nullptr) {
+      continue;
+    }
+    MUTEX_TRY_LOCK(lock, pool->mutex, ethread);
+    if (!lock.is_locked()) {
+      continue;
+    }
+    pool->acquireSession(ip, hostname_hash, match_style, sm, to_return);
+    if (to_return) {
+      Debug("http_ss", "[%" PRId64 "] [acquire session] taking session from the pool of thread %p", to_return->con_id, victim);
+      if (move_session_to_thread(to_return, sm, ethread)) {
+        return true;
+      }
+      to_return = nullptr;
+    }
+  }
+  return false;
+}
+
 HSMresult_t
 HttpSessionManager::release_session(Http1ServerSession *to_release)
 {
   EThread *ethread = this_ethread();
   ServerSessionPool *pool =
-    TS_SERVER_SESSION_SHARING_POOL_THREAD == to_release->sharing_pool ? ethread->server_session_pool : m_g_pool;
+    TS_SERVER_SESSION_SHARING_POOL_GLOBAL != to_release->sharing_pool ? ethread->server_session_pool : m_g_pool;
   bool released_p = true;
 
   // The per thread lock looks like it should not be needed but if it's not locked the close checking I/O op will crash.
@@ -112,6 +112,10 @@ public:
   int main_handler(int event, void *data);
 
 private:
+  /// Take a matching session from the pool of another thread, for the hybrid pool.
+  bool steal_session(sockaddr const *addr, CryptoHash const &host_hash, TSServerSessionSharingMatchMask match_style, HttpSM *sm,
+                     Http1ServerSession *&server_session);
+
   /// Global pool, used if not per thread pools.
   /// @internal We delay creating this because the session manager is created during global statics init.
   ServerSessionPool *m_g_pool = nullptr;
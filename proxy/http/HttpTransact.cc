@@ -31,6 +31,7 @@
 #include "HttpTransactHeaders.h"
 #include "HttpSM.h"
 #include "HttpCacheSM.h" //Added to get the scope of HttpCacheSM object - YTS Team, yamsat
+#include "HttpCacheTags.h"
 #include "HttpDebugNames.h"
 #include <ctime>
 #include "tscore/ParseRules.h"
@@ -60,6 +61,10 @@ const MgmtConverter HttpTransact::HOST_RES_CONV{[](const void *data) -> std::str
 static char range_type[] = "multipart/byteranges; boundary=RANGE_SEPARATOR";
 #define RANGE_NUMBERS_LENGTH 60
 
+// The RFC 5861 Cache-Control directives, which are not cooked.
+static const char CC_STALE_WHILE_REVALIDATE[] = "stale-while-revalidate";
+static const char CC_STALE_IF_ERROR[]         = "stale-if-error";
+
 #define TRANSACT_SETUP_RETURN(n, r) \
   s->next_action           = n;     \
   s->transact_return_point = r;     \
@@ -183,7 +188,7 @@ findParent(HttpTransact::State *s)
     return mp->strategy->findNextHop(reinterpret_cast<TSHttpTxn>(s->state_machine));
   } else if (s->parent_params) {
     return s->parent_params->findParent(&s->request_data, &s->parent_result, s->txn_conf->parent_fail_threshold,
-                                        s->txn_conf->parent_retry_time);
+                                        s->txn_conf->parent_retry_time, mp ? mp->parent_memo : nullptr);
   }
 }
 
@@ -341,6 +346,11 @@ response_is_retryable(HttpTransact::State *s, HTTPStatus response_code)
     return PARENT_RETRY_NONE;
   }
 
+  // A peer that does not have the object either answers only-if-cached with a 504, the upstreams are next for any 5xx.
+  if (s->parent_result.peer) {
+    return is_response_unavailable_code(response_code) ? PARENT_RETRY_SIMPLE : PARENT_RETRY_NONE;
+  }
+
   const url_mapping *mp = s->url_map.getMapping();
   if (mp && mp->strategy) {
     if (mp->strategy->responseIsRetryable(s->current.simple_retry_attempts, response_code)) {
@@ -426,7 +436,11 @@ is_port_in_range(int port, HttpConfigPortRange *pr)
 inline static void
 update_cache_control_information_from_config(HttpTransact::State *s)
 {
-  getCacheControl(&s->cache_control, &s->request_data, s->txn_conf);
+  url_mapping *mp = s->url_map.getMapping();
+
+  // A followed redirect matches again on top of the first result, which is not what the memo has.
+  getCacheControl(&s->cache_control, &s->request_data, s->txn_conf, nullptr,
+                  mp && !s->redirect_info.redirect_in_process ? mp->cache_control_memo : nullptr);
 
   s->cache_info.directives.does_config_permit_lookup &= (s->cache_control.never_cache == false);
   s->cache_info.directives.does_config_permit_storing &= (s->cache_control.never_cache == false);
@@ -728,11 +742,37 @@ does_method_effect_cache(int method)
            method == HTTP_WKSIDX_POST));
 }
 
+// A sibling peer of a peering ring is asked only for its cached copy, the next hops after it get the client's Cache-Control.
+inline static void
+set_peer_probe(HttpTransact::State *s)
+{
+  HTTPHdr *request = &s->hdr_info.server_request;
+  bool probe       = s->current.request_to == HttpTransact::PARENT_PROXY && s->parent_result.peer;
+
+  if (probe == s->peer_probe || !request->valid()) {
+    return;
+  }
+  if (probe) {
+    request->value_append(MIME_FIELD_CACHE_CONTROL, MIME_LEN_CACHE_CONTROL, HTTP_VALUE_ONLY_IF_CACHED, HTTP_LEN_ONLY_IF_CACHED,
+                          true);
+  } else {
+    request->field_delete(MIME_FIELD_CACHE_CONTROL, MIME_LEN_CACHE_CONTROL);
+    if (MIMEField *cc = s->hdr_info.client_request.field_find(MIME_FIELD_CACHE_CONTROL, MIME_LEN_CACHE_CONTROL)) {
+      int len;
+      const char *value = cc->value_get(&len);
+      request->value_set(MIME_FIELD_CACHE_CONTROL, MIME_LEN_CACHE_CONTROL, value, len);
+    }
+  }
+  s->peer_probe = probe;
+}
+
 inline static HttpTransact::StateMachineAction_t
 how_to_open_connection(HttpTransact::State *s)
 {
   ink_assert((s->pending_work == nullptr) || (s->current.request_to == HttpTransact::PARENT_PROXY));
 
+  set_peer_probe(s);
+
   // Originally we returned which type of server to open
   // Now, however, we may want to issue a cache
   // operation first in order to lock the cache
@@ -1003,8 +1043,9 @@ HttpTransact::EndRemapRequest(State *s)
       error_body_type = "redirect#moved_temporarily";
     }
     build_error_response(s, s->http_return_code, "Redirect", error_body_type);
-    ats_free(s->remap_redirect);
-    s->reverse_proxy = false;
+    s->arena.str_free(s->remap_redirect);
+    s->remap_redirect = nullptr;
+    s->reverse_proxy  = false;
     goto done;
   }
   /////////////////////////////////////////////////////
@@ -1528,6 +1569,11 @@ HttpTransact::HandleRequest(State *s)
     TRANSACT_RETURN(SM_ACTION_INTERNAL_CACHE_NOOP, nullptr);
   }
 
+  // A PURGE with surrogate keys invalidates the objects tagged with them, not the URL.
+  if (handle_surrogate_key_purge(s)) {
+    TRANSACT_RETURN(SM_ACTION_INTERNAL_CACHE_NOOP, nullptr);
+  }
+
   if (s->http_config_param->no_dns_forward_to_parent && s->scheme != URL_WKSIDX_HTTPS &&
       strcmp(s->server_info.name, "127.0.0.1") != 0) {
     // for HTTPS requests, we must go directly to the
@@ -2115,6 +2161,10 @@ HttpTransact::DecideCacheLookup(State *s)
     TxnDebug("http_seq", "[DecideCacheLookup] Will do cache lookup");
     ink_assert(s->current.mode != TUNNELLING_PROXY);
 
+    // The alternates were written for the request as it went to the origin, normalize the Accept-Encoding
+    // of this one the same way before it is matched against them.
+    HttpTransactHeaders::normalize_accept_encoding(s->txn_conf, &s->hdr_info.client_request);
+
     if (s->cache_info.lookup_url == nullptr) {
       HTTPHdr *incoming_request = &s->hdr_info.client_request;
 
@@ -2410,6 +2460,11 @@ HttpTransact::HandleCacheOpenRead(State *s)
   } else {
     // cache hit
     TxnDebug("http_trans", "CacheOpenRead -- hit");
+    if (cache_hit_hooks_skippable(s)) {
+      // Nothing would run on the READ_CACHE_HDR hook, go on without the round trip through the SM
+      HandleCacheOpenReadHitFreshness(s);
+      return;
+    }
     TRANSACT_RETURN(SM_ACTION_API_READ_CACHE_HDR, HandleCacheOpenReadHitFreshness);
   }
 
@@ -2587,6 +2642,16 @@ HttpTransact::HandleCacheOpenReadHitFreshness(State *s)
 
   TxnDebug("http_trans", "[HandleCacheOpenReadHitFreshness] request_sent_time      : %" PRId64, (int64_t)s->request_sent_time);
   TxnDebug("http_trans", "[HandleCacheOpenReadHitFreshness] response_received_time : %" PRId64, (int64_t)s->response_received_time);
+  // Surrogate key invalidations make the object stale, whatever its age.
+  if (s->cache_lookup_result == HttpTransact::CACHE_LOOKUP_NONE && is_cache_tag_invalidated(s, obj->response_get())) {
+    TxnDebug("http_seq", "[HttpTransact::HandleCacheOpenReadHitFreshness] "
+                         "Surrogate key invalidated");
+    HTTP_INCREMENT_DYN_STAT(http_cache_hit_tag_invalidated_stat);
+    s->cache_tag_invalidated     = true;
+    s->cache_lookup_result       = HttpTransact::CACHE_LOOKUP_HIT_STALE;
+    s->is_revalidation_necessary = true;
+  }
+
   // if the plugin has already decided the freshness, we don't need to
   // do it again
   if (s->cache_lookup_result == HttpTransact::CACHE_LOOKUP_NONE) {
@@ -2626,7 +2691,15 @@ HttpTransact::HandleCacheOpenReadHitFreshness(State *s)
     if (need_to_revalidate(s)) {
       TRANSACT_RETURN(SM_ACTION_API_CACHE_LOOKUP_COMPLETE,
                       CallOSDNSLookup); // content needs to be revalidated and we did not perform a dns ....calling DNS lookup
-    } else {                            // document can be served can cache
+    } else if (s->cache_lookup_result == CACHE_LOOKUP_HIT_FRESH && cache_hit_hooks_skippable(s) &&
+               (!(s->cache_info.object_read->response_get()->get_cooked_cc_mask() & MIME_COOKED_MASK_CC_NO_CACHE) ||
+                s->cache_control.ignore_server_no_cache)) {
+      // need_to_revalidate() already did the authentication and returnability checks of
+      // HandleCacheOpenReadHit(), and there is no hook to change the lookup result.
+      TxnDebug("http_seq", "[HttpTransact::HandleCacheOpenReadHitFreshness] Fresh hit fast path");
+      HTTP_INCREMENT_DYN_STAT(http_cache_hit_fast_path_stat);
+      serve_cache_hit(s);
+    } else { // document can be served can cache
       TRANSACT_RETURN(SM_ACTION_API_CACHE_LOOKUP_COMPLETE, HttpTransact::HandleCacheOpenReadHit);
     }
   } else { // we have done dns . Its up to HandleCacheOpenReadHit to decide to go OS or serve from cache
@@ -2634,6 +2707,26 @@ HttpTransact::HandleCacheOpenReadHitFreshness(State *s)
   }
 }
 
+///////////////////////////////////////////////////////////////////////////////
+// Name       : cache_hit_hooks_skippable
+// Description: whether the cache hit API states can be skipped
+//
+// Details    :
+//
+// With no hooks for the transaction, no remap plugin that could have looked at
+// the request and no cached object update in progress, the READ_CACHE_HDR and
+// CACHE_LOOKUP_COMPLETE states only bounce through the state machine back to
+// here. Fresh hits are then served directly.
+///////////////////////////////////////////////////////////////////////////////
+bool
+HttpTransact::cache_hit_hooks_skippable(State *s)
+{
+  url_mapping *map = s->url_map.getMapping();
+
+  return s->http_config_param->cache_hit_fast_path && !s->state_machine->hooks_set &&
+         s->api_update_cached_object == UPDATE_CACHED_OBJECT_NONE && (map == nullptr || map->plugin_instance_count() == 0);
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // Name       : CallOSDNSLookup
 // Description: Moves in SM_ACTION_DNS_LOOKUP state and sets the transact return to OSDNSLookup
@@ -2864,6 +2957,18 @@ HttpTransact::HandleCacheOpenReadHit(State *s)
   TxnDebug("http_trans", "CacheOpenRead --- needs_cache_auth    = %d", needs_cache_auth);
   TxnDebug("http_trans", "CacheOpenRead --- send_revalidate     = %d", send_revalidate);
 
+  // stale-while-revalidate: serve the stale document now and revalidate it in the
+  // background, the client does not wait for the origin server.
+  if (send_revalidate && needs_revalidate && !needs_authenticate && !needs_cache_auth && response_returnable &&
+      is_stale_while_revalidate_allowed(s)) {
+    TxnDebug("http_trans", "CacheOpenRead --- HIT-STALE, stale-while-revalidate");
+    HTTP_INCREMENT_DYN_STAT(http_cache_stale_while_revalidate_stat);
+    s->state_machine->do_background_revalidate();
+    SET_VIA_STRING(VIA_CACHE_RESULT, VIA_IN_CACHE_STALE);
+    build_response_from_cache(s, HTTP_WARNING_CODE_RESPONSE_STALE);
+    return;
+  }
+
   if (send_revalidate) {
     TxnDebug("http_trans", "CacheOpenRead --- HIT-STALE");
     s->dns_info.attempts = 0;
@@ -2969,6 +3074,21 @@ HttpTransact::HandleCacheOpenReadHit(State *s)
   //
   ink_assert((send_revalidate == true && server_up == false) || (send_revalidate == false && server_up == true));
 
+  serve_cache_hit(s);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Name       : serve_cache_hit
+// Description: serve a cache hit that needs no revalidation
+//
+// Details    :
+//
+// Called by HandleCacheOpenReadHit() and, for fresh hits that can skip the
+// cache hit API states, directly by HandleCacheOpenReadHitFreshness().
+///////////////////////////////////////////////////////////////////////////////
+void
+HttpTransact::serve_cache_hit(State *s)
+{
   TxnDebug("http_trans", "CacheOpenRead --- HIT-FRESH");
   TxnDebug("http_seq", "[HttpTransact::HandleCacheOpenReadHit] "
                        "Serve from cache");
@@ -2983,7 +3103,6 @@ HttpTransact::HandleCacheOpenReadHit(State *s)
   if (s->cache_lookup_result == CACHE_LOOKUP_HIT_WARNING) {
     build_response_from_cache(s, HTTP_WARNING_CODE_HERUISTIC_EXPIRATION);
   } else if (s->cache_lookup_result == CACHE_LOOKUP_HIT_STALE) {
-    ink_assert(server_up == false);
     build_response_from_cache(s, HTTP_WARNING_CODE_REVALIDATION_FAILED);
   } else {
     build_response_from_cache(s, HTTP_WARNING_CODE_NONE);
@@ -3609,10 +3728,17 @@ HttpTransact::handle_response_from_parent(State *s)
     if (s->parent_result.retry) {
       markParentUp(s);
     }
+    if (s->parent_result.peer) {
+      HTTP_INCREMENT_DYN_STAT(http_peer_cache_hit_stat);
+    }
     handle_forward_server_connection_open(s);
     break;
   case PARENT_RETRY:
-    if (s->current.retry_type == PARENT_RETRY_SIMPLE) {
+    if (s->parent_result.peer) {
+      // Not a failure of the peer, nor one of the retries of the upstreams.
+      TxnDebug("http_trans", "[hrfp] peer %s does not have the object", s->parent_result.hostname);
+      HTTP_INCREMENT_DYN_STAT(http_peer_cache_miss_stat);
+    } else if (s->current.retry_type == PARENT_RETRY_SIMPLE) {
       s->current.simple_retry_attempts++;
     } else {
       markParentDown(s);
@@ -3638,6 +3764,16 @@ HttpTransact::handle_response_from_parent(State *s)
     TxnDebug("http_trans", "[%d] failed to connect to parent %s", s->current.attempts,
              ats_ip_ntop(&s->current.server->dst_addr.sa, addrbuf, sizeof(addrbuf)));
 
+    // A peer gets a single attempt within its timeout, then the upstreams are asked.
+    if (s->parent_result.peer) {
+      HTTP_INCREMENT_DYN_STAT(http_peer_cache_error_stat);
+      if (s->current.state == CONNECTION_ERROR) {
+        markParentDown(s);
+      }
+      next_lookup = find_server_and_update_current_info(s);
+      break;
+    }
+
     // If the request is not retryable, just give up!
     if (!is_request_retryable(s)) {
       if (s->current.state != OUTBOUND_CONGESTION) {
@@ -4452,6 +4588,19 @@ HttpTransact::handle_cache_operation_on_forward_server_response(State *s)
       return;
     }
 
+    // stale-if-error: serve the stale document instead of the error, the cache is left as it is.
+    if ((server_response_code == HTTP_STATUS_INTERNAL_SERVER_ERROR || server_response_code == HTTP_STATUS_GATEWAY_TIMEOUT ||
+         server_response_code == HTTP_STATUS_BAD_GATEWAY || server_response_code == HTTP_STATUS_SERVICE_UNAVAILABLE) &&
+        s->cache_info.action == CACHE_DO_UPDATE && s->http_config_param->cache_stale_if_error &&
+        is_within_stale_directive(s, CC_STALE_IF_ERROR, sizeof(CC_STALE_IF_ERROR) - 1) && is_stale_cache_response_returnable(s)) {
+      TxnDebug("http_trans", "[hcoofsr] stale-if-error: serve stale object from cache");
+      HTTP_INCREMENT_DYN_STAT(http_cache_stale_if_error_stat);
+      s->source = SOURCE_CACHE;
+      SET_VIA_STRING(VIA_SERVER_RESULT, VIA_SERVER_ERROR);
+      build_response_from_cache(s, HTTP_WARNING_CODE_REVALIDATION_FAILED);
+      return;
+    }
+
     s->next_action       = SM_ACTION_SERVER_READ;
     client_response_code = server_response_code;
     base_response        = &s->hdr_info.server_response;
@@ -5976,8 +6125,10 @@ HttpTransact::is_stale_cache_response_returnable(State *s)
   time_t current_age = HttpTransactHeaders::calculate_document_age(s->cache_info.object_read->request_sent_time_get(),
                                                                    s->cache_info.object_read->response_received_time_get(),
                                                                    cached_response, cached_response->get_date(), s->current.now);
-  // Negative age is overflow
-  if ((current_age < 0) || (current_age > s->txn_conf->cache_max_stale_age)) {
+  // Negative age is overflow. stale-if-error may allow a document older than max_stale_age.
+  if ((current_age < 0) || (current_age > s->txn_conf->cache_max_stale_age &&
+                            !(s->http_config_param->cache_stale_if_error &&
+                              is_within_stale_directive(s, CC_STALE_IF_ERROR, sizeof(CC_STALE_IF_ERROR) - 1)))) {
     TxnDebug("http_trans",
              "[is_stale_cache_response_returnable] "
              "document age is too large %" PRId64,
@@ -5997,6 +6148,142 @@ HttpTransact::is_stale_cache_response_returnable(State *s)
   return true;
 }
 
+///////////////////////////////////////////////////////////////////////////////
+// Name       : is_within_stale_directive()
+// Description: check if the cached response is in the stale window of one of
+//              the RFC 5861 Cache-Control directives
+//
+// Input      : State, directive name
+// Output     : true if the response has the directive and its age is at most
+//              its freshness lifetime plus the directive's seconds
+//
+///////////////////////////////////////////////////////////////////////////////
+bool
+HttpTransact::is_within_stale_directive(State *s, const char *name, int name_len)
+{
+  HTTPHdr *cached_response = s->cache_info.object_read->response_get();
+  int secs                 = cached_response->get_cc_directive_secs(name, name_len);
+  bool heuristic;
+
+  if (secs < 0) {
+    return false;
+  }
+
+  time_t response_date = cached_response->get_date();
+  time_t limit         = calculate_document_freshness_limit(s, cached_response, response_date, &heuristic);
+  time_t current_age   = HttpTransactHeaders::calculate_document_age(s->cache_info.object_read->request_sent_time_get(),
+                                                                   s->cache_info.object_read->response_received_time_get(),
+                                                                   cached_response, response_date, s->current.now);
+
+  limit += secs;
+
+  TxnDebug("http_trans", "[is_within_stale_directive] %.*s: age %" PRId64 ", limit %" PRId64, name_len, name,
+           static_cast<int64_t>(current_age), static_cast<int64_t>(limit));
+  return current_age >= 0 && current_age <= limit;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Name       : is_stale_while_revalidate_allowed()
+// Description: check if a stale cache hit can be served while it is
+//              revalidated in the background
+//
+// Input      : State
+// Output     : true or false
+//
+// Details    :
+//
+// The client must not be asking for a fresh document itself, and the
+// revalidation must not be a background one already.
+//
+///////////////////////////////////////////////////////////////////////////////
+bool
+HttpTransact::is_stale_while_revalidate_allowed(State *s)
+{
+  HTTPHdr *client_request = &s->hdr_info.client_request;
+
+  if (!s->http_config_param->cache_stale_while_revalidate || s->cache_tag_invalidated ||
+      s->req_flavor == REQ_FLAVOR_SCHEDULED_UPDATE || s->method != HTTP_WKSIDX_GET ||
+      s->cache_lookup_result != CACHE_LOOKUP_HIT_STALE || s->api_update_cached_object == UPDATE_CACHED_OBJECT_CONTINUE) {
+    return false;
+  }
+  if ((client_request->get_cooked_cc_mask() & (MIME_COOKED_MASK_CC_NO_CACHE | MIME_COOKED_MASK_CC_MAX_AGE |
+                                               MIME_COOKED_MASK_CC_MIN_FRESH)) ||
+      client_request->is_pragma_no_cache_set()) {
+    return false;
+  }
+  return is_within_stale_directive(s, CC_STALE_WHILE_REVALIDATE, sizeof(CC_STALE_WHILE_REVALIDATE) - 1) &&
+         is_stale_cache_response_returnable(s);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Name       : is_cache_tag_invalidated()
+// Description: check if one of the surrogate keys of the cached response was
+//              invalidated since it was received
+//
+///////////////////////////////////////////////////////////////////////////////
+bool
+HttpTransact::is_cache_tag_invalidated(State *s, HTTPHdr *cached_response)
+{
+  HttpConfigParams *params = s->http_config_param;
+
+  if (params->cache_surrogate_key_header_len == 0) {
+    return false;
+  }
+
+  for (MIMEField *field = cached_response->field_find(params->cache_surrogate_key_header, params->cache_surrogate_key_header_len);
+       field != nullptr; field = field->m_next_dup) {
+    int len;
+    const char *tags = field->value_get(&len);
+    if (httpCacheTags.is_invalidated(std::string_view(tags, len), s->response_received_time)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Name       : handle_surrogate_key_purge()
+// Description: invalidate the surrogate keys of a PURGE request
+//
+// Details    :
+//
+// The keys are in the proxy.config.http.cache.surrogate_key_header field of
+// the request. A PURGE without it removes its URL from the cache as usual.
+//
+///////////////////////////////////////////////////////////////////////////////
+bool
+HttpTransact::handle_surrogate_key_purge(State *s)
+{
+  HttpConfigParams *params = s->http_config_param;
+
+  if (s->method != HTTP_WKSIDX_PURGE || params->cache_surrogate_key_header_len == 0) {
+    return false;
+  }
+
+  HTTPHdr *request = &s->hdr_info.client_request;
+  MIMEField *field = request->field_find(params->cache_surrogate_key_header, params->cache_surrogate_key_header_len);
+  if (field == nullptr) {
+    return false;
+  }
+
+  for (; field != nullptr; field = field->m_next_dup) {
+    int len;
+    const char *value = field->value_get(&len);
+    std::string_view tags(value, len);
+    for (std::string_view tag = HttpCacheTags::next_tag(tags); !tag.empty(); tag = HttpCacheTags::next_tag(tags)) {
+      TxnDebug("http_trans", "[handle_surrogate_key_purge] invalidating %.*s", static_cast<int>(tag.size()), tag.data());
+      httpCacheTags.invalidate(tag, s->current.now, params->cache_surrogate_key_max_tags);
+      HTTP_INCREMENT_DYN_STAT(http_cache_tag_invalidation_stat);
+    }
+  }
+
+  s->cache_info.action          = CACHE_DO_NO_ACTION;
+  s->hdr_info.trust_response_cl = true;
+  SET_VIA_STRING(VIA_DETAIL_TUNNEL, VIA_DETAIL_TUNNEL_NO_FORWARD);
+  build_response(s, &s->hdr_info.client_response, s->client_info.http_version, HTTP_STATUS_OK);
+  return true;
+}
+
 bool
 HttpTransact::url_looks_dynamic(URL *url)
 {
@@ -8794,6 +9081,19 @@ HttpTransact::update_size_and_time_stats(State *s, ink_hrtime total_time, ink_hr
   HTTP_SUM_DYN_STAT(http_dns_lookup_end_time_stat, milestones.difference_msec(TS_MILESTONE_SM_START, TS_MILESTONE_DNS_LOOKUP_END));
   HTTP_SUM_DYN_STAT(http_sm_start_time_stat, milestones.difference_msec(TS_MILESTONE_SM_START, TS_MILESTONE_SM_START));
   HTTP_SUM_DYN_STAT(http_sm_finish_time_stat, milestones.difference_msec(TS_MILESTONE_SM_START, TS_MILESTONE_SM_FINISH));
+
+  // and the latency histograms, of the transactions that reached both milestones
+  auto record_latency = [&](HttpHistogram_t histogram, TSMilestonesType start, TSMilestonesType end) {
+    if (milestones[start] != 0 && milestones[end] != 0) {
+      http_histograms[histogram].record(milestones.difference_msec(start, end));
+    }
+  };
+  record_latency(http_ttfb_histogram, TS_MILESTONE_SM_START, TS_MILESTONE_UA_BEGIN_WRITE);
+  record_latency(http_total_time_histogram, TS_MILESTONE_SM_START, TS_MILESTONE_SM_FINISH);
+  record_latency(http_dns_lookup_histogram, TS_MILESTONE_DNS_LOOKUP_BEGIN, TS_MILESTONE_DNS_LOOKUP_END);
+  record_latency(http_origin_connect_histogram, TS_MILESTONE_SERVER_CONNECT, TS_MILESTONE_SERVER_CONNECT_END);
+  record_latency(http_origin_first_byte_histogram, TS_MILESTONE_SERVER_BEGIN_WRITE, TS_MILESTONE_SERVER_FIRST_READ);
+  record_latency(http_cache_open_read_histogram, TS_MILESTONE_CACHE_OPEN_READ_BEGIN, TS_MILESTONE_CACHE_OPEN_READ_END);
 }
 
 void
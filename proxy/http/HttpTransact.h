@@ -687,6 +687,7 @@ public:
     MgmtByte cache_open_write_fail_action = 0;
     bool is_revalidation_necessary        = false; // Added to check if revalidation is necessary - YTS Team, yamsat
     bool request_will_not_selfloop        = false; // To determine if process done - YTS Team, yamsat
+    bool cache_tag_invalidated            = false; // The cached object's surrogate keys were invalidated
     ConnectionAttributes client_info;
     ConnectionAttributes parent_info;
     ConnectionAttributes server_info;
@@ -713,6 +714,7 @@ public:
     ParentConfigParams *parent_params                           = nullptr;
     std::shared_ptr<NextHopSelectionStrategy> next_hop_strategy = nullptr;
     ParentResult parent_result;
+    bool peer_probe = false; ///< The server request asks a sibling peer for its cached copy only.
     CacheControlResult cache_control;
     CacheLookupResult_t cache_lookup_result = CACHE_LOOKUP_NONE;
 
@@ -865,6 +867,7 @@ public:
       free_internal_msg_buffer();
       ats_free(internal_msg_buffer_type);
 
+      parent_result.release_load();
       ParentConfig::release(parent_params);
       parent_params = nullptr;
 
@@ -954,6 +957,7 @@ public:
   static void HandleCacheOpenReadHit(State *s);
   static void HandleCacheOpenReadMiss(State *s);
   static void build_response_from_cache(State *s, HTTPWarningCode warning_code);
+  static void serve_cache_hit(State *s);
   static void handle_cache_write_lock(State *s);
   static void HandleResponse(State *s);
   static void HandleUpdateCachedObject(State *s);
@@ -1012,7 +1016,12 @@ public:
   static bool is_server_negative_cached(State *s);
   static bool is_cache_response_returnable(State *s);
   static bool is_stale_cache_response_returnable(State *s);
+  static bool is_within_stale_directive(State *s, const char *name, int name_len);
+  static bool is_stale_while_revalidate_allowed(State *s);
+  static bool is_cache_tag_invalidated(State *s, HTTPHdr *cached_response);
+  static bool handle_surrogate_key_purge(State *s);
   static bool need_to_revalidate(State *s);
+  static bool cache_hit_hooks_skippable(State *s);
   static bool url_looks_dynamic(URL *url);
   static bool is_request_cache_lookupable(State *s);
   static bool is_request_valid(State *s, HTTPHdr *incoming_request);
@@ -150,6 +150,76 @@ is_empty(char *s)
   return (s[0] == NUL);
 }
 
+/// Hashes of the client request values of the fields named by one Vary, in the order of its summary.
+struct VaryRequestHashes {
+  uint32_t names = 0;
+  uint32_t nvary = CACHE_ALT_SUMMARY_VARY_MANY;
+  uint32_t skip  = 0; ///< Bit per field that the configuration says to ignore.
+  uint32_t vary[CACHE_ALT_SUMMARY_VARY_MAX];
+};
+
+/**
+  Whether the summary @a s of alternate @a obj shows that CalcVariability would find it varies for
+  @a client_request. Only ever rules alternates out, anything not covered by the summary is left to
+  the full match. @a hashes keeps the client side for alternates with the same Vary.
+
+*/
+static bool
+summary_varies(const OverridableHttpConfigParams *http_config_params, HTTPHdr *client_request, CacheHTTPInfo *obj,
+               const CacheAltSummary &s, VaryRequestHashes &hashes)
+{
+  if (s.nvary == CACHE_ALT_SUMMARY_VARY_ALL) {
+    return true;
+  }
+  if (s.nvary == 0 || s.nvary > CACHE_ALT_SUMMARY_VARY_MAX) {
+    return false;
+  }
+
+  if (hashes.names != s.vary_names) {
+    StrList vary_list;
+
+    hashes.names = s.vary_names;
+    hashes.nvary = CACHE_ALT_SUMMARY_VARY_MANY;
+    hashes.skip  = 0;
+    if (obj->response_get()->value_get_comma_list(MIME_FIELD_VARY, MIME_LEN_VARY, &vary_list) <= 0) {
+      return false;
+    }
+    uint32_t n = 0;
+    for (Str *field = vary_list.head; field != nullptr; field = field->next) {
+      if (field->len == 0) {
+        continue;
+      }
+      if (n == CACHE_ALT_SUMMARY_VARY_MAX) {
+        return false;
+      }
+      // A User-Agent compared by its class is left to the full match.
+      if (((http_config_params->global_user_agent_header || http_config_params->cache_vary_user_agent_class) &&
+           !strcasecmp(field->str, "User-Agent")) ||
+          (http_config_params->ignore_accept_encoding_mismatch && !strcasecmp(field->str, "Accept-Encoding"))) {
+        hashes.skip |= 1 << n;
+      } else {
+        const char *name = hdrtoken_string_to_wks(field->str, field->len);
+        if (name == nullptr) {
+          name = field->str;
+        }
+        hashes.vary[n] = HttpCompat::vary_header_values_hash(client_request->field_find(name, field->len));
+      }
+      ++n;
+    }
+    hashes.nvary = n;
+  }
+
+  if (hashes.nvary != s.nvary) {
+    return false;
+  }
+  for (uint32_t i = 0; i < s.nvary; i++) {
+    if (!(hashes.skip & (1 << i)) && hashes.vary[i] != s.vary[i]) {
+      return true;
+    }
+  }
+  return false;
+}
+
 /**
   Given a set of alternates, select the best match.
 
@@ -189,12 +259,25 @@ HttpTransactCache::SelectFromAlternates(CacheHTTPInfoVector *cache_vector, HTTPH
     return 0;
   }
 
+  // An alternate that varies gets a quality of -1 and is never picked. Those that the summaries show
+  // vary are skipped without a look at their headers, except for PURGE, which takes any alternate,
+  // and when a plugin could force an alternate.
+  const CacheAltSummary *summary = cache_vector->summary;
+  VaryRequestHashes hashes;
+  if (summary && (client_request->method_get_wksidx() == HTTP_WKSIDX_PURGE || http_global_hooks->get(TS_HTTP_SELECT_ALT_HOOK))) {
+    summary = nullptr;
+  }
+
   for (int i = 0; i < alt_count; i++) {
     float Q;
     CacheHTTPInfo *obj       = cache_vector->get(i);
     HTTPHdr *cached_request  = obj->request_get();
     HTTPHdr *cached_response = obj->response_get();
 
+    if (summary && summary_varies(http_config_params, client_request, obj, summary[i], hashes)) {
+      Debug("http_match", "[SelectFromAlternates] alternate %d varies on its summary", i);
+      continue;
+    }
     if (!(obj->object_key_get() == zero_key)) {
       ink_assert(cached_request->valid());
       ink_assert(cached_response->valid());
@@ -1199,6 +1282,15 @@ HttpTransactCache::CalcVariability(const OverridableHttpConfigParams *http_confi
         MIMEField *cached_hdr_field  = obj_client_request->field_find(field_name_str, field->len);
         MIMEField *current_hdr_field = client_request->field_find(field_name_str, field->len);
 
+        // With proxy.config.http.cache.vary_user_agent_class the agents only need to be of the same device class.
+        if (http_config_params->cache_vary_user_agent_class && field_name_str == MIME_FIELD_USER_AGENT) {
+          if (HttpCompat::user_agent_class(cached_hdr_field) != HttpCompat::user_agent_class(current_hdr_field)) {
+            variability = VARIABILITY_SOME;
+            break;
+          }
+          continue;
+        }
+
         // Header values match? //
         if (!HttpCompat::do_vary_header_values_match(cached_hdr_field, current_hdr_field)) {
           variability = VARIABILITY_SOME;
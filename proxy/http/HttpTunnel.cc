@@ -119,18 +119,15 @@ ChunkedHandler::set_max_chunk_size(int64_t size)
 void
 ChunkedHandler::read_size()
 {
-  int64_t bytes_used;
-  bool done = false;
+  int64_t bytes_used = 0;
+  bool done          = false;
 
-  while (chunked_reader->read_avail() > 0 && !done) {
-    const char *tmp   = chunked_reader->start();
-    int64_t data_size = chunked_reader->block_read_avail();
+  for (std::string_view span : chunked_reader->spans()) {
+    const char *tmp = span.data();
+    const char *end = tmp + span.size();
 
-    ink_assert(data_size > 0);
-    bytes_used = 0;
-
-    while (data_size > 0) {
-      bytes_used++;
+    ink_assert(tmp < end);
+    while (tmp < end && !done) {
       if (state == CHUNK_READ_SIZE) {
         // The http spec says the chunked size is always in hex
         if (ParseRules::is_hex(*tmp)) {
@@ -148,31 +145,37 @@ ChunkedHandler::read_size()
             // Bogus chunk size
             state = CHUNK_READ_ERROR;
             done  = true;
-            break;
           } else {
             state = CHUNK_READ_SIZE_CRLF; // now look for CRLF
           }
         }
-      } else if (state == CHUNK_READ_SIZE_CRLF) { // Scan for a linefeed
-        if (ParseRules::is_lf(*tmp)) {
+        tmp++;
+      } else {
+        // Skip the chunk extensions, or the CRLF ending the previous chunk, up to the linefeed.
+        const char *lf = static_cast<const char *>(memchr(tmp, '\n', end - tmp));
+        if (!lf) {
+          tmp = end;
+          break;
+        }
+        tmp = lf + 1;
+        if (state == CHUNK_READ_SIZE_CRLF) {
           Debug("http_chunk", "read chunk size of %d bytes", running_sum);
           bytes_left = (cur_chunk_size = running_sum);
           state      = (running_sum == 0) ? CHUNK_READ_TRAILER_BLANK : CHUNK_READ_CHUNK;
           done       = true;
-          break;
-        }
-      } else if (state == CHUNK_READ_SIZE_START) {
-        if (ParseRules::is_lf(*tmp)) {
+        } else if (state == CHUNK_READ_SIZE_START) {
           running_sum = 0;
           num_digits  = 0;
           state       = CHUNK_READ_SIZE;
         }
       }
-      tmp++;
-      data_size--;
     }
-    chunked_reader->consume(bytes_used);
+    bytes_used += tmp - span.data();
+    if (done) {
+      break;
+    }
   }
+  chunked_reader->consume(bytes_used);
 }
 
 // int ChunkedHandler::transfer_bytes()
@@ -242,16 +245,23 @@ ChunkedHandler::read_chunk()
 void
 ChunkedHandler::read_trailer()
 {
-  int64_t bytes_used;
-  bool done = false;
-
-  while (chunked_reader->is_read_avail_more_than(0) && !done) {
-    const char *tmp   = chunked_reader->start();
-    int64_t data_size = chunked_reader->block_read_avail();
-
-    ink_assert(data_size > 0);
-    for (bytes_used = 0; data_size > 0; data_size--) {
-      bytes_used++;
+  int64_t bytes_used = 0;
+  bool done          = false;
+
+  for (std::string_view span : chunked_reader->spans()) {
+    const char *tmp = span.data();
+    const char *end = tmp + span.size();
+
+    while (tmp < end) {
+      if (state == CHUNK_READ_TRAILER_LINE) {
+        // Only a LF ends a line of the trailer, skip to it.
+        const char *lf = static_cast<const char *>(memchr(tmp, '\n', end - tmp));
+        if (!lf) {
+          tmp = end;
+          break;
+        }
+        tmp = lf;
+      }
 
       if (ParseRules::is_cr(*tmp)) {
         // For a CR to signal we are almost done, the preceding
@@ -266,6 +276,7 @@ ChunkedHandler::read_trailer()
           state = CHUNK_READ_DONE;
           Debug("http_chunk", "completed read of trailers");
           done = true;
+          tmp++;
           break;
         } else {
           // A LF that does not terminate the trailer
@@ -279,8 +290,12 @@ ChunkedHandler::read_trailer()
       }
       tmp++;
     }
-    chunked_reader->consume(bytes_used);
+    bytes_used += tmp - span.data();
+    if (done) {
+      break;
+    }
   }
+  chunked_reader->consume(bytes_used);
 }
 
 bool
@@ -988,6 +1003,44 @@ HttpTunnel::producer_run(HttpTunnelProducer *p)
     p->read_buffer->dealloc_reader(p->buffer_start);
   }
   p->buffer_start = nullptr;
+
+  producer_splice(p);
+}
+
+// void HttpTunnel::producer_splice(HttpTunnelProducer* p)
+//
+//   Hands the rest of the data of a running producer to the kernel
+//    when it goes, untouched, from one connection to one other.
+//    The byte counts stay those of the VIOs.
+//
+void
+HttpTunnel::producer_splice(HttpTunnelProducer *p)
+{
+  HttpTunnelConsumer *c = p->consumer_list.head;
+
+  if (!p->alive || p->read_vio == nullptr || p->do_chunking || p->do_dechunking || p->do_chunked_passthru) {
+    return;
+  }
+  if (c == nullptr || c->link.next != nullptr || !c->alive || c->write_vio == nullptr) {
+    return;
+  }
+  if (p->vc_type != HT_HTTP_SERVER && p->vc_type != HT_HTTP_CLIENT) {
+    return;
+  }
+  if (c->vc_type != HT_HTTP_CLIENT && c->vc_type != HT_HTTP_SERVER) {
+    return;
+  }
+  // A POST body is copied as it is read, for redirects.
+  if (p->vc_type == HT_HTTP_CLIENT && sm->t_state.method == HTTP_WKSIDX_POST && sm->enable_redirection) {
+    return;
+  }
+
+  // For HTTP/1 the VIOs are those of the connections themselves.
+  NetVConnection *src = dynamic_cast<NetVConnection *>(p->read_vio->vc_server);
+  NetVConnection *dst = dynamic_cast<NetVConnection *>(c->write_vio->vc_server);
+  if (src && dst && src->splice_to(dst)) {
+    Debug("http_tunnel", "[%" PRId64 "] [producer_splice] %s spliced to %s", sm->sm_id, p->name, c->name);
+  }
 }
 
 int
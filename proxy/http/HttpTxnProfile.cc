@@ -0,0 +1,165 @@
+/** @file
+
+  Accounting of where the time of a sampled transaction went, see HttpTxnProfile.h
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "HttpTxnProfile.h"
+#include "HttpConfig.h"
+#include "HttpDebugNames.h"
+
+#include <dlfcn.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <string_view>
+
+namespace
+{
+thread_local uint64_t transactions_seen = 0;
+
+// Append @a name:@a usec to @a buf, with a comma after the first. @return The new length.
+int
+append_usec(char *buf, int size, int len, const char *name, int name_len, ink_hrtime cpu)
+{
+  if (len < size) {
+    int n = snprintf(buf + len, size - len, "%s%.*s:%" PRId64, len ? "," : "", name_len, name, ink_hrtime_to_usec(cpu));
+    len   = std::min(len + std::max(n, 0), size - 1);
+  }
+  return len;
+}
+} // namespace
+
+bool
+HttpTxnProfile::sample(int64_t rate)
+{
+  return rate > 0 && ++transactions_seen % rate == 0;
+}
+
+ink_hrtime
+HttpTxnProfile::thread_cpu_time()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  return ink_hrtime_from_timespec(&ts);
+}
+
+void
+HttpTxnProfile::init()
+{
+  cpu          = 0;
+  n_plugins    = 0;
+  lock_retries = 0;
+  memset(hook_cpu, 0, sizeof(hook_cpu));
+  memset(waits, 0, sizeof(waits));
+  memset(_wait_start, 0, sizeof(_wait_start));
+  _hook           = TS_HTTP_LAST_HOOK;
+  _hook_func      = nullptr;
+  _hook_cpu_start = 0;
+}
+
+void
+HttpTxnProfile::hook_end()
+{
+  if (_hook_cpu_start == 0) {
+    return;
+  }
+
+  ink_hrtime spent = thread_cpu_time() - _hook_cpu_start;
+  _hook_cpu_start  = 0;
+
+  cpu += spent;
+  if (_hook < TS_HTTP_LAST_HOOK) {
+    hook_cpu[_hook] += spent;
+  }
+
+  int i = 0;
+  while (i < n_plugins && plugins[i].func != _hook_func) {
+    ++i;
+  }
+  if (i == n_plugins) {
+    if (n_plugins < MAX_PLUGINS) {
+      plugins[n_plugins++] = Plugin{_hook_func, 0, 0};
+    } else {
+      i = MAX_PLUGINS - 1;
+    }
+  }
+  plugins[i].cpu += spent;
+  ++plugins[i].calls;
+}
+
+void
+HttpTxnProfile::finish(ink_hrtime now)
+{
+  for (int i = 0; i < HTTP_TXN_WAIT_COUNT; ++i) {
+    wait_end(static_cast<HttpTxnWait_t>(i), now);
+  }
+
+  http_histograms[http_profile_plugin_cpu_histogram].record(ink_hrtime_to_usec(cpu));
+  http_histograms[http_profile_lock_retries_histogram].record(lock_retries);
+  http_histograms[http_profile_cache_wait_histogram].record(ink_hrtime_to_msec(waits[HTTP_TXN_WAIT_CACHE]));
+  http_histograms[http_profile_dns_wait_histogram].record(ink_hrtime_to_msec(waits[HTTP_TXN_WAIT_DNS]));
+  http_histograms[http_profile_origin_wait_histogram].record(ink_hrtime_to_msec(waits[HTTP_TXN_WAIT_ORIGIN]));
+}
+
+int
+HttpTxnProfile::print_plugins(char *buf, int size) const
+{
+  int len = 0;
+
+  buf[0] = '\0';
+  for (int i = 0; i < n_plugins; ++i) {
+    // The plugin is named by its shared object, without the directory.
+    Dl_info info;
+    const char *name = "unknown";
+    if (plugins[i].func && dladdr(plugins[i].func, &info) != 0 && info.dli_fname) {
+      const char *slash = strrchr(info.dli_fname, '/');
+      name              = slash ? slash + 1 : info.dli_fname;
+    }
+    len = append_usec(buf, size, len, name, strlen(name), plugins[i].cpu);
+  }
+  return len;
+}
+
+int
+HttpTxnProfile::print_hooks(char *buf, int size) const
+{
+  static constexpr std::string_view PREFIX{"TS_HTTP_"};
+  static constexpr std::string_view SUFFIX{"_HOOK"};
+  int len = 0;
+
+  buf[0] = '\0';
+  for (int hook = 0; hook < TS_HTTP_LAST_HOOK; ++hook) {
+    if (hook_cpu[hook] == 0) {
+      continue;
+    }
+    // TS_HTTP_READ_REQUEST_HDR_HOOK is written READ_REQUEST_HDR.
+    std::string_view name{HttpDebugNames::get_api_hook_name(static_cast<TSHttpHookID>(hook))};
+    if (name.substr(0, PREFIX.size()) == PREFIX) {
+      name.remove_prefix(PREFIX.size());
+    }
+    if (name.size() > SUFFIX.size() && name.substr(name.size() - SUFFIX.size()) == SUFFIX) {
+      name.remove_suffix(SUFFIX.size());
+    }
+    len = append_usec(buf, size, len, name.data(), name.size(), hook_cpu[hook]);
+  }
+  return len;
+}
@@ -0,0 +1,128 @@
+/** @file
+
+  Accounting of where the time of a sampled transaction went
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  @section details Details
+
+  The milestones of a transaction are wall clock times. With proxy.config.http.profile.sample_rate
+  one transaction out of that many on each thread also gets an @c HttpTxnProfile, which adds up
+  - the time on the CPU of the thread spent in the plugin hooks, per hook and per plugin,
+  - the lock retries, of the plugin continuations and of the cache,
+  - the time waiting on the cache, on DNS and on the origin server, over all the attempts.
+
+  That is what the "tp" log fields and the proxy.process.http.profile histograms show. The other
+  transactions only pay for a null pointer test at each of these points.
+ */
+
+#pragma once
+
+#include "ts/apidefs.h"
+#include "tscore/ink_hrtime.h"
+
+/// What a transaction can be blocked on.
+enum HttpTxnWait_t {
+  HTTP_TXN_WAIT_CACHE,
+  HTTP_TXN_WAIT_DNS,
+  HTTP_TXN_WAIT_ORIGIN,
+
+  HTTP_TXN_WAIT_COUNT
+};
+
+class HttpTxnProfile
+{
+public:
+  /// Plugins accounted one by one, the CPU time of any more goes to the last one.
+  static constexpr int MAX_PLUGINS = 8;
+
+  struct Plugin {
+    const void *func = nullptr; ///< The event function of its continuations.
+    ink_hrtime cpu   = 0;
+    int calls        = 0;
+  };
+
+  /// Whether the transaction starting on this thread is to be profiled, one out of @a rate.
+  static bool sample(int64_t rate);
+
+  /// The time the calling thread has been on the CPU.
+  static ink_hrtime thread_cpu_time();
+
+  /// Reset to start profiling a transaction.
+  void init();
+
+  /// The hook @a hook of the plugin with the event function @a func is being called.
+  void
+  hook_begin(TSHttpHookID hook, const void *func)
+  {
+    _hook           = hook;
+    _hook_func      = func;
+    _hook_cpu_start = thread_cpu_time();
+  }
+
+  /// The hook call returned, or the plugin reenabled the transaction from it.
+  void hook_end();
+
+  void
+  lock_retry()
+  {
+    ++lock_retries;
+  }
+
+  /// The transaction is now blocked on @a what, unless it already was.
+  void
+  wait_begin(HttpTxnWait_t what, ink_hrtime now)
+  {
+    if (_wait_start[what] == 0) {
+      _wait_start[what] = now;
+    }
+  }
+
+  /// The transaction is no longer blocked on @a what.
+  void
+  wait_end(HttpTxnWait_t what, ink_hrtime now)
+  {
+    if (_wait_start[what] != 0) {
+      waits[what] += now - _wait_start[what];
+      _wait_start[what] = 0;
+    }
+  }
+
+  /// End the waits still going on and count the transaction in the histograms.
+  void finish(ink_hrtime now);
+
+  /// Write "name:usec" of each plugin to @a buf, separated by commas. @return The length written.
+  int print_plugins(char *buf, int size) const;
+
+  /// Write "hook:usec" of each hook that any plugin took time in to @a buf. @return The length written.
+  int print_hooks(char *buf, int size) const;
+
+  ink_hrtime cpu = 0; ///< In all the hooks.
+  ink_hrtime hook_cpu[TS_HTTP_LAST_HOOK];
+  Plugin plugins[MAX_PLUGINS];
+  int n_plugins        = 0;
+  int64_t lock_retries = 0;
+  ink_hrtime waits[HTTP_TXN_WAIT_COUNT];
+
+private:
+  ink_hrtime _wait_start[HTTP_TXN_WAIT_COUNT];
+  TSHttpHookID _hook         = TS_HTTP_LAST_HOOK;
+  const void *_hook_func     = nullptr;
+  ink_hrtime _hook_cpu_start = 0; ///< Zero when not in a hook.
+};
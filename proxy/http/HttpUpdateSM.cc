@@ -35,6 +35,9 @@
 #include "HttpUpdateSM.h"
 #include "HttpDebugNames.h"
 
+#include <mutex>
+#include <unordered_set>
+
 ClassAllocator<HttpUpdateSM> httpUpdateSMAllocator("httpUpdateSMAllocator");
 
 #define STATE_ENTER(state_name, event, vio)                                                             \
@@ -149,8 +152,19 @@ HttpUpdateSM::handle_api_return()
     }
     break;
   }
+  case HttpTransact::SM_ACTION_SERVER_READ: {
+    if (t_state.cache_info.action == HttpTransact::CACHE_DO_WRITE || t_state.cache_info.action == HttpTransact::CACHE_DO_REPLACE) {
+      // The object changed, store the new one
+      cb_event = HTTP_SCH_UPDATE_EVENT_WRITTEN;
+      cache_sm.close_read();
+      t_state.cache_info.write_status = HttpTransact::CACHE_WRITE_IN_PROGRESS;
+      setup_server_transfer_to_cache_only();
+      tunnel.tunnel_run();
+      return;
+    }
+  }
+  // fallthrough
   case HttpTransact::SM_ACTION_INTERNAL_CACHE_WRITE:
-  case HttpTransact::SM_ACTION_SERVER_READ:
   case HttpTransact::SM_ACTION_INTERNAL_CACHE_NOOP:
   case HttpTransact::SM_ACTION_SEND_ERROR_CACHE_NOOP:
   case HttpTransact::SM_ACTION_SERVE_FROM_CACHE: {
@@ -220,3 +234,74 @@ HttpUpdateSM::kill_this_async_hook(int event, void * /* data ATS_UNUSED */)
 
   return HttpSM::kill_this_async_hook(EVENT_NONE, nullptr);
 }
+
+namespace
+{
+struct CacheKeyHasher {
+  size_t
+  operator()(CacheKey const &key) const
+  {
+    return key.fold();
+  }
+};
+
+std::mutex revalidate_mutex;
+std::unordered_set<CacheKey, CacheKeyHasher> revalidating;
+} // namespace
+
+bool
+HttpStaleRevalidate::start(const CacheKey &key, HTTPHdr *request, URL *url)
+{
+  {
+    std::lock_guard<std::mutex> lock(revalidate_mutex);
+    if (!revalidating.insert(key).second) {
+      return false;
+    }
+  }
+  HTTP_INCREMENT_DYN_STAT(http_background_revalidate_stat);
+  eventProcessor.schedule_imm(new HttpStaleRevalidate(key, request, url), ET_NET);
+  return true;
+}
+
+HttpStaleRevalidate::HttpStaleRevalidate(const CacheKey &key, HTTPHdr *request, URL *url)
+  : Continuation(new_ProxyMutex()), _key(key)
+{
+  _request.create(HTTP_TYPE_REQUEST);
+  _request.copy(request);
+  _request.url_set(url);
+  // The update SM makes its own conditional request from the cached object.
+  _request.field_delete(MIME_FIELD_RANGE, MIME_LEN_RANGE);
+  _request.field_delete(MIME_FIELD_IF_RANGE, MIME_LEN_IF_RANGE);
+  _request.field_delete(MIME_FIELD_IF_MODIFIED_SINCE, MIME_LEN_IF_MODIFIED_SINCE);
+  _request.field_delete(MIME_FIELD_IF_UNMODIFIED_SINCE, MIME_LEN_IF_UNMODIFIED_SINCE);
+  _request.field_delete(MIME_FIELD_IF_NONE_MATCH, MIME_LEN_IF_NONE_MATCH);
+  _request.field_delete(MIME_FIELD_IF_MATCH, MIME_LEN_IF_MATCH);
+  SET_HANDLER(&HttpStaleRevalidate::state_start);
+}
+
+HttpStaleRevalidate::~HttpStaleRevalidate()
+{
+  _request.destroy();
+  std::lock_guard<std::mutex> lock(revalidate_mutex);
+  revalidating.erase(_key);
+}
+
+int
+HttpStaleRevalidate::state_start(int /* event ATS_UNUSED */, void * /* data ATS_UNUSED */)
+{
+  HttpUpdateSM *sm = HttpUpdateSM::allocate();
+
+  // The update SM may call back before it returns, which deletes this.
+  SET_HANDLER(&HttpStaleRevalidate::state_done);
+  sm->init();
+  sm->start_scheduled_update(this, &_request);
+  return EVENT_DONE;
+}
+
+int
+HttpStaleRevalidate::state_done(int event, void * /* data ATS_UNUSED */)
+{
+  Debug("http", "[HttpStaleRevalidate] background revalidation done with %s", HttpDebugNames::get_event_name(event));
+  delete this;
+  return EVENT_DONE;
+}
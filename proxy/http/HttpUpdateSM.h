@@ -73,5 +73,25 @@ HttpUpdateSM::allocate()
   return httpUpdateSMAllocator.alloc();
 }
 
+/// Revalidates a stale cached object with an HttpUpdateSM after it was served to a client, see
+/// proxy.config.http.cache.stale_while_revalidate. There is one at a time for each cache key.
+class HttpStaleRevalidate : public Continuation
+{
+public:
+  /// Revalidate the object of @a key with a copy of @a request for @a url, unless that is already
+  /// being done. @return @c true if a revalidation was started.
+  static bool start(const CacheKey &key, HTTPHdr *request, URL *url);
+
+private:
+  HttpStaleRevalidate(const CacheKey &key, HTTPHdr *request, URL *url);
+  ~HttpStaleRevalidate() override;
+
+  int state_start(int event, void *data);
+  int state_done(int event, void *data);
+
+  CacheKey _key;
+  HTTPHdr _request;
+};
+
 // Regression/Testing Routing
 void init_http_update_test();
@@ -0,0 +1,245 @@
+/** @file
+
+  Keeps idle connections open to the origins of remap rules with a prewarm option.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "PreWarmManager.h"
+#include "HttpConfig.h"
+#include "HttpSM.h"
+#include "HttpSessionManager.h"
+#include "Http1ServerSession.h"
+#include "ReverseProxy.h"
+#include "UrlRewrite.h"
+#include "P_Net.h"
+
+PreWarmManager prewarmManager;
+
+// Opens one connection to a target and puts it into the pool of the thread it lands on.
+struct PreWarmConnect : public Continuation {
+  PreWarmTarget *target;
+  Action *pending_action = nullptr;
+
+  explicit PreWarmConnect(PreWarmTarget *t) : Continuation(new_ProxyMutex()), target(t)
+  {
+    SET_HANDLER(&PreWarmConnect::startEvent);
+  }
+
+  int startEvent(int event, void *data);
+  int dnsEvent(int event, void *data);
+  int connectEvent(int event, void *data);
+
+private:
+  int done();
+};
+
+int
+PreWarmConnect::startEvent(int /* event ATS_UNUSED */, void * /* data ATS_UNUSED */)
+{
+  HostDBProcessor::Options opt;
+  opt.port = target->port;
+
+  SET_HANDLER(&PreWarmConnect::dnsEvent);
+  Action *action = hostDBProcessor.getbyname_re(this, target->host.c_str(), target->host.size(), opt);
+  if (action != ACTION_RESULT_DONE) {
+    pending_action = action;
+  }
+  return EVENT_DONE;
+}
+
+int
+PreWarmConnect::dnsEvent(int event, void *data)
+{
+  ink_assert(event == EVENT_HOST_DB_LOOKUP);
+  pending_action = nullptr;
+
+  HostDBInfo *r = static_cast<HostDBInfo *>(data);
+  if (r && r->round_robin) {
+    HostDBRoundRobin *rr = r->rr();
+    r                    = (rr && rr->good > 0) ? &rr->info(target->next_addr++ % rr->good) : nullptr;
+  }
+  if (r == nullptr || r->is_failed() || !ats_is_ip(r->ip())) {
+    Debug("http_prewarm", "no address for %s", target->host.c_str());
+    return done();
+  }
+
+  IpEndpoint addr;
+  ats_ip_copy(&addr, r->ip());
+  addr.port() = htons(target->port);
+
+  HttpConfigParams *params = HttpConfig::acquire();
+  NetVCOptions opt;
+  opt.f_blocking_connect = false;
+  opt.ip_family          = addr.family();
+  opt.set_sock_param(params->oride.sock_recv_buffer_size_out, params->oride.sock_send_buffer_size_out,
+                     params->oride.sock_option_flag_out, params->oride.sock_packet_mark_out, params->oride.sock_packet_tos_out);
+  opt.ssl_client_cert_name        = params->oride.ssl_client_cert_filename;
+  opt.ssl_client_private_key_name = params->oride.ssl_client_private_key_filename;
+  opt.ssl_client_ca_cert_name     = params->oride.ssl_client_ca_cert_filename;
+  set_tls_options(opt, &params->oride);
+  HttpConfig::release(params);
+
+  SET_HANDLER(&PreWarmConnect::connectEvent);
+  Action *action;
+  if (target->tls) {
+    opt.set_sni_servername(target->host.data(), target->host.size());
+    opt.set_ssl_servername(target->host.c_str());
+    action = sslNetProcessor.connect_re(this, &addr.sa, &opt);
+  } else {
+    action = netProcessor.connect_re(this, &addr.sa, &opt);
+  }
+  if (action != ACTION_RESULT_DONE) {
+    pending_action = action;
+  }
+  return EVENT_DONE;
+}
+
+int
+PreWarmConnect::connectEvent(int event, void *data)
+{
+  pending_action = nullptr;
+  if (event != NET_EVENT_OPEN) {
+    Debug("http_prewarm", "connect to %s:%d failed", target->host.c_str(), target->port);
+    return done();
+  }
+
+  NetVConnection *netvc    = static_cast<NetVConnection *>(data);
+  HttpConfigParams *params = HttpConfig::acquire();
+  EThread *ethread         = this_ethread();
+  Http1ServerSession *ss   = (TS_SERVER_SESSION_SHARING_POOL_GLOBAL != params->server_session_sharing_pool) ?
+                             THREAD_ALLOC_INIT(httpServerSessionAllocator, ethread) :
+                             httpServerSessionAllocator.alloc();
+  ss->sharing_pool  = static_cast<TSServerSessionSharingPoolType>(params->server_session_sharing_pool);
+  ss->sharing_match = static_cast<TSServerSessionSharingMatchMask>(params->oride.server_session_sharing_match);
+  ss->attach_hostname(target->host.c_str());
+  ss->new_connection(netvc);
+  // The pool keeps the timeouts it finds, an unused connection goes away like any idle keep alive one.
+  netvc->set_inactivity_timeout(HRTIME_SECONDS(params->oride.keep_alive_no_activity_timeout_out));
+  HttpConfig::release(params);
+
+  // Set before the release, another thread may take it out of the pool right away.
+  ss->prewarm_target = target;
+  ++target->idle;
+  if (httpSessionManager.release_session(ss) != HSM_DONE) {
+    --target->idle;
+    ss->prewarm_target = nullptr;
+    ss->do_io_close();
+  } else {
+    HTTP_INCREMENT_DYN_STAT(http_prewarm_open_stat);
+    Debug("http_prewarm", "[%" PRId64 "] prewarmed connection to %s:%d", ss->con_id, target->host.c_str(), target->port);
+  }
+  return done();
+}
+
+int
+PreWarmConnect::done()
+{
+  --target->pending;
+  mutex.clear();
+  delete this;
+  return EVENT_DONE;
+}
+
+PreWarmManager::PreWarmManager() : Continuation(nullptr)
+{
+  SET_HANDLER(&PreWarmManager::mainEvent);
+}
+
+void
+PreWarmManager::start()
+{
+  // Created here rather than in the constructor, the instance is a global static.
+  mutex = new_ProxyMutex();
+  eventProcessor.schedule_every(this, HRTIME_SECOND, ET_TASK);
+}
+
+void
+PreWarmManager::reconfigure(UrlRewrite *table)
+{
+  for (auto &t : m_targets) {
+    t->conns = 0;
+  }
+  for (auto const &origin : table->prewarm_origins) {
+    PreWarmTarget *target = nullptr;
+    for (auto &t : m_targets) {
+      if (t->port == origin.port && t->tls == origin.tls && t->host == origin.host) {
+        target = t.get();
+        break;
+      }
+    }
+    if (target == nullptr) {
+      m_targets.emplace_back(new PreWarmTarget);
+      target       = m_targets.back().get();
+      target->host = origin.host;
+      target->port = origin.port;
+      target->tls  = origin.tls;
+    }
+    target->conns = origin.conns;
+    Debug("http_prewarm", "keeping %d connections open to %s:%d%s", origin.conns, origin.host.c_str(), origin.port,
+          origin.tls ? " (TLS)" : "");
+  }
+}
+
+int
+PreWarmManager::mainEvent(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
+{
+  if (rewrite_table && rewrite_table != m_table) {
+    UrlRewrite *table = rewrite_table->acquire();
+    reconfigure(table);
+    if (m_table) {
+      m_table->release();
+    }
+    m_table = table;
+  }
+
+  HttpConfigParams *params = HttpConfig::acquire();
+  int budget               = params->prewarm_rate;
+  HttpConfig::release(params);
+
+  // One connection per target at a time, so a large target can not use up the budget of the others.
+  for (bool progress = true; budget > 0 && progress;) {
+    progress = false;
+    for (auto &t : m_targets) {
+      if (budget > 0 && t->idle + t->pending < t->conns) {
+        ++t->pending;
+        eventProcessor.schedule_imm(new PreWarmConnect(t.get()), ET_NET);
+        --budget;
+        progress = true;
+      }
+    }
+  }
+  return EVENT_CONT;
+}
+
+void
+PreWarmManager::session_used(Http1ServerSession *ss)
+{
+  --ss->prewarm_target->idle;
+  ss->prewarm_target = nullptr;
+  HTTP_INCREMENT_DYN_STAT(http_prewarm_hit_stat);
+}
+
+void
+PreWarmManager::session_wasted(Http1ServerSession *ss)
+{
+  --ss->prewarm_target->idle;
+  ss->prewarm_target = nullptr;
+  HTTP_INCREMENT_DYN_STAT(http_prewarm_waste_stat);
+}
@@ -0,0 +1,78 @@
+/** @file
+
+  Keeps idle connections open to the origins of remap rules with a prewarm option.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  @section details Details
+
+  The connections are opened ahead of any request and put straight into the server session pool,
+  so the first transactions to an origin after a quiet period find one there instead of waiting
+  for a TCP and TLS connect. A connection still unused when the keep alive timeout closes it is
+  counted as waste and opened again, at no more than @c proxy.config.http.prewarm.rate a second.
+ */
+
+#pragma once
+
+#include "P_EventSystem.h"
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+class Http1ServerSession;
+class UrlRewrite;
+
+/// An origin to keep connections open to.
+/// @internal Sessions point at these, so they are never freed, only set to zero connections.
+struct PreWarmTarget {
+  std::string host;
+  int port = 0;
+  bool tls = false;
+
+  std::atomic<int> conns{0};   ///< Connections wanted, from the remap rules.
+  std::atomic<int> idle{0};    ///< Connections in the pool not used yet.
+  std::atomic<int> pending{0}; ///< Connections being opened.
+  std::atomic<unsigned> next_addr{0};
+};
+
+class PreWarmManager : public Continuation
+{
+public:
+  PreWarmManager();
+
+  /// Start replenishing, once the remap rules are loaded.
+  void start();
+  int mainEvent(int event, Event *e);
+
+  /// A prewarmed session was taken out of the pool by a transaction.
+  static void session_used(Http1ServerSession *ss);
+  /// A prewarmed session was closed before any transaction used it.
+  static void session_wasted(Http1ServerSession *ss);
+
+private:
+  void reconfigure(UrlRewrite *table);
+
+  /// Remap rules the targets were last taken from, held so a new table never gets its address.
+  UrlRewrite *m_table = nullptr;
+  std::vector<std::unique_ptr<PreWarmTarget>> m_targets;
+};
+
+extern PreWarmManager prewarmManager;
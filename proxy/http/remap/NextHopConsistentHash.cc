@@ -35,14 +35,18 @@ constexpr std::string_view hash_key_path_query    = "path+query";
 constexpr std::string_view hash_key_path_fragment = "path+fragment";
 constexpr std::string_view hash_key_cache         = "cache_key";
 
+// hash_algorithm strings.
+constexpr std::string_view hash_algorithm_ring   = "ring";
+constexpr std::string_view hash_algorithm_maglev = "maglev";
+
 static HostRecord *
 chash_lookup(std::shared_ptr<ATSConsistentHash> ring, uint64_t hash_key, ATSConsistentHashIter *iter, bool *wrapped,
-             ATSHash64Sip24 *hash, bool *hash_init, bool *mapWrapped, uint64_t sm_id)
+             ATSHash64Sip24 *hash, bool *hash_init, bool *mapWrapped, uint64_t sm_id, float bounded_load)
 {
   HostRecord *host_rec = nullptr;
 
   if (*hash_init == false) {
-    host_rec   = static_cast<HostRecord *>(ring->lookup_by_hashval(hash_key, iter, wrapped));
+    host_rec   = static_cast<HostRecord *>(ring->lookup_bounded(hash_key, bounded_load, iter, wrapped));
     *hash_init = true;
   } else {
     host_rec = static_cast<HostRecord *>(ring->lookup(nullptr, iter, wrapped, hash));
@@ -87,6 +91,26 @@ NextHopConsistentHash::Init(const YAML::Node &n)
                 strategy_name.c_str(), hash_key_path.data());
       }
     }
+    if (n["hash_algorithm"]) {
+      auto hash_algorithm_val = n["hash_algorithm"].Scalar();
+      if (hash_algorithm_val == hash_algorithm_ring) {
+        hash_algorithm = NH_RING_HASH_ALGORITHM;
+      } else if (hash_algorithm_val == hash_algorithm_maglev) {
+        hash_algorithm = NH_MAGLEV_HASH_ALGORITHM;
+      } else {
+        hash_algorithm = NH_RING_HASH_ALGORITHM;
+        NH_Note("Invalid 'hash_algorithm' value, '%s', for the strategy named '%s', using default '%s'.",
+                hash_algorithm_val.c_str(), strategy_name.c_str(), hash_algorithm_ring.data());
+      }
+    }
+    if (n["bounded_load"]) {
+      bounded_load = n["bounded_load"].as<float>();
+      if (bounded_load < 0) {
+        NH_Note("Invalid 'bounded_load' value, '%f', for the strategy named '%s', bounded loads are disabled.", bounded_load,
+                strategy_name.c_str());
+        bounded_load = 0;
+      }
+    }
   } catch (std::exception &ex) {
     NH_Note("Error parsing the strategy named '%s' due to '%s', this strategy will be ignored.", strategy_name.c_str(), ex.what());
     return false;
@@ -96,6 +120,11 @@ NextHopConsistentHash::Init(const YAML::Node &n)
   if (!result) {
     return false;
   }
+  if (ring_mode == NH_PEERING_RING && groups < 2) {
+    NH_Note("The 'peering_ring' mode of the strategy named '%s' needs a group of peers and a group of upstreams, using '%s'.",
+            strategy_name.c_str(), "exhaust_ring");
+    ring_mode = NH_EXHAUST_RING;
+  }
 
   // load up the hash rings.
   for (uint32_t i = 0; i < groups; i++) {
@@ -116,6 +145,9 @@ NextHopConsistentHash::Init(const YAML::Node &n)
                p->hostname.c_str(), strategy_name.c_str());
     }
     hash.clear();
+    if (hash_algorithm == NH_MAGLEV_HASH_ALGORITHM) {
+      hash_ring->build_table();
+    }
     rings.push_back(std::move(hash_ring));
   }
   return true;
@@ -207,6 +239,49 @@ NextHopConsistentHash::getHashKey(uint64_t sm_id, HttpRequestData *hrdata, ATSHa
   return h->get();
 }
 
+bool
+NextHopConsistentHash::findPeer(HttpSM *sm, uint64_t hash_key, ATSHash64Sip24 *hash)
+{
+  ParentResult *result = &sm->t_state.parent_result;
+  int64_t sm_id        = sm->sm_id;
+  int method           = sm->t_state.method;
+  bool wrapped         = false;
+
+  // a peer only has a copy to give for what this host would have cached.
+  if (sm->t_state.cache_lookup_result != HttpTransact::CACHE_LOOKUP_MISS ||
+      (method != HTTP_WKSIDX_GET && method != HTTP_WKSIDX_HEAD)) {
+    return false;
+  }
+
+  // the owner of the key only, another peer would not have it either. Bounded loads would move it.
+  HostRecord *hostRec = chash_lookup(rings[0], hash_key, &result->chashIter[0], &wrapped, hash, &result->chash_init[0],
+                                     &result->mapWrapped[0], sm_id, 0);
+  if (hostRec == nullptr) {
+    return false;
+  }
+  std::shared_ptr<HostRecord> pRec = host_groups[0][hostRec->host_index];
+  HostStatRec *hst                 = HostStatus::instance().getHostStatus(pRec->hostname.c_str());
+
+  // this host is down by self detection, it is the owner and already missed.
+  if (!pRec->available || (hst && hst->status == HOST_STATUS_DOWN)) {
+    NH_Debug(NH_DEBUG_TAG, "[%" PRIu64 "] peer %s is this host or down, skipping the peers.", sm_id, pRec->hostname.c_str());
+    return false;
+  }
+
+  result->result      = PARENT_SPECIFIED;
+  result->hostname    = pRec->hostname.c_str();
+  result->port        = pRec->getPort(scheme);
+  result->last_parent = pRec->host_index;
+  result->last_lookup = result->last_group = 0;
+  result->retry                            = false;
+  result->peer                             = true;
+  result->first_choice_status              = HostStatus_t::HOST_STATUS_UP;
+  ink_assert(result->port != 0);
+  NH_Debug(NH_DEBUG_TAG, "[%" PRIu64 "] Chosen peer: %s.%d", sm_id, result->hostname, result->port);
+
+  return true;
+}
+
 void
 NextHopConsistentHash::findNextHop(TSHttpTxn txnp, void *ih, time_t now)
 {
@@ -233,6 +308,11 @@ NextHopConsistentHash::findNextHop(TSHttpTxn txnp, void *ih, time_t now)
   if (result->line_number == -1 && result->result == PARENT_UNDEFINED) {
     firstcall = true;
   }
+  result->peer = false;
+  if (ring_mode == NH_PEERING_RING) {
+    // the peers are never searched for another host, only the one owning the key is asked.
+    wrap_around[0] = true;
+  }
 
   if (firstcall) {
     NH_Debug(NH_DEBUG_TAG, "[%" PRIu64 "] firstcall, line_number: %d, result: %s", sm_id, result->line_number,
@@ -254,6 +334,10 @@ NextHopConsistentHash::findNextHop(TSHttpTxn txnp, void *ih, time_t now)
         cur_ring = result->last_group;
       }
       break;
+    case NH_PEERING_RING:
+      // after the peer, the upstream groups are exhausted in turn.
+      cur_ring = std::max<uint32_t>(result->last_group, 1);
+      break;
     case NH_EXHAUST_RING:
     default:
       if (!wrapped) {
@@ -268,10 +352,17 @@ NextHopConsistentHash::findNextHop(TSHttpTxn txnp, void *ih, time_t now)
   // Do the initial parent look-up.
   hash_key = getHashKey(sm_id, &request_info, &hash);
 
+  if (firstcall && ring_mode == NH_PEERING_RING) {
+    if (findPeer(sm, hash_key, &hash)) {
+      return;
+    }
+    cur_ring = 1;
+  }
+
   do { // search until we've selected a different parent if !firstcall
     std::shared_ptr<ATSConsistentHash> r = rings[cur_ring];
     hostRec               = chash_lookup(r, hash_key, &result->chashIter[cur_ring], &wrapped, &hash, &result->chash_init[cur_ring],
-                           &result->mapWrapped[cur_ring], sm_id);
+                           &result->mapWrapped[cur_ring], sm_id, bounded_load);
     wrap_around[cur_ring] = wrapped;
     lookups++;
     // the 'available' flag is maintained in 'host_groups' and not the hash ring.
@@ -324,6 +415,11 @@ NextHopConsistentHash::findNextHop(TSHttpTxn txnp, void *ih, time_t now)
           cur_ring = (pRec->group_index + 1) % groups;
         }
         break;
+      case NH_PEERING_RING:
+        if (wrap_around[cur_ring] && groups > 2) {
+          cur_ring = cur_ring + 1 < groups ? cur_ring + 1 : 1;
+        }
+        break;
       case NH_EXHAUST_RING:
       default:
         if (wrap_around[cur_ring] && groups > 1) {
@@ -333,7 +429,7 @@ NextHopConsistentHash::findNextHop(TSHttpTxn txnp, void *ih, time_t now)
       }
       std::shared_ptr<ATSConsistentHash> r = rings[cur_ring];
       hostRec = chash_lookup(r, hash_key, &result->chashIter[cur_ring], &wrapped, &hash, &result->chash_init[cur_ring],
-                             &result->mapWrapped[cur_ring], sm_id);
+                             &result->mapWrapped[cur_ring], sm_id, bounded_load);
       wrap_around[cur_ring] = wrapped;
       lookups++;
       if (hostRec) {
@@ -393,6 +489,9 @@ NextHopConsistentHash::findNextHop(TSHttpTxn txnp, void *ih, time_t now)
     result->retry = nextHopRetry;
     ink_assert(result->hostname != nullptr);
     ink_assert(result->port != 0);
+    if (bounded_load > 0) {
+      result->hold_load(rings[cur_ring].get(), pRec.get());
+    }
     NH_Debug(NH_DEBUG_TAG, "[%" PRIu64 "] result->result: %s Chosen parent: %s.%d", sm_id, ParentResultStr[result->result],
              result->hostname, result->port);
   } else {
@@ -404,6 +503,7 @@ NextHopConsistentHash::findNextHop(TSHttpTxn txnp, void *ih, time_t now)
     result->hostname = nullptr;
     result->port     = 0;
     result->retry    = false;
+    result->release_load();
     NH_Debug(NH_DEBUG_TAG, "[%" PRIu64 "] result->result: %s set hostname null port 0 retry false", sm_id,
              ParentResultStr[result->result]);
   }
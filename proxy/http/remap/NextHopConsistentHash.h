@@ -27,6 +27,9 @@
 #include <vector>
 #include "NextHopSelectionStrategy.h"
 
+class HttpSM;
+struct ATSHash64Sip24;
+
 enum NHHashKeyType {
   NH_URL_HASH_KEY = 0,
   NH_HOSTNAME_HASH_KEY,
@@ -36,14 +39,22 @@ enum NHHashKeyType {
   NH_CACHE_HASH_KEY
 };
 
+enum NHHashAlgorithm {
+  NH_RING_HASH_ALGORITHM = 0, // default, the first host is searched for on the ring
+  NH_MAGLEV_HASH_ALGORITHM
+};
+
 class NextHopConsistentHash : public NextHopSelectionStrategy
 {
   std::vector<std::shared_ptr<ATSConsistentHash>> rings;
 
   uint64_t getHashKey(uint64_t sm_id, HttpRequestData *hrdata, ATSHash64 *h);
+  bool findPeer(HttpSM *sm, uint64_t hash_key, ATSHash64Sip24 *hash);
 
 public:
-  NHHashKeyType hash_key = NH_PATH_HASH_KEY;
+  NHHashKeyType hash_key         = NH_PATH_HASH_KEY;
+  NHHashAlgorithm hash_algorithm = NH_RING_HASH_ALGORITHM;
+  float bounded_load             = 0; ///< epsilon of consistent hashing with bounded loads, 0 to disable.
 
   NextHopConsistentHash() = delete;
   NextHopConsistentHash(const std::string_view name, const NHPolicyType &policy) : NextHopSelectionStrategy(name, policy) {}
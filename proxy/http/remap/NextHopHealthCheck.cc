@@ -0,0 +1,261 @@
+/** @file
+
+  Active health checks of the hosts of a next hop strategy.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include <cerrno>
+#include <cstring>
+#include <random>
+
+#include <fcntl.h>
+#include <netdb.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "HostStatus.h"
+#include "NextHopHealthCheck.h"
+
+NextHopHealthCheck::NextHopHealthCheck(const std::string &strategy, const NHActiveHealthCheck &cfg,
+                                       const std::vector<std::shared_ptr<HostRecord>> &hosts, NHSchemeType scheme)
+  : Continuation(new_ProxyMutex()), strategy_name(strategy), config(cfg)
+{
+  HostStatus &h_stat = HostStatus::instance();
+
+  for (auto &host : hosts) {
+    Target target;
+    if (makeTarget(*host, scheme, config.type, target)) {
+      // a host left down by the checks of an earlier configuration comes back up when it passes.
+      HostStatRec *hst = h_stat.getHostStatus(target.hostname.c_str());
+      target.down      = hst && (hst->reasons & Reason::ACTIVE);
+      targets.push_back(std::move(target));
+    }
+  }
+  SET_HANDLER(&NextHopHealthCheck::checkEvent);
+}
+
+bool
+NextHopHealthCheck::makeTarget(const HostRecord &host, NHSchemeType scheme, NHActiveCheckType type, Target &target)
+{
+  const NHProtocol *protocol = nullptr;
+  for (auto &pr : host.protocols) {
+    if (protocol == nullptr || pr->scheme == scheme) {
+      protocol = pr.get();
+    }
+    if (pr->scheme == scheme) {
+      break;
+    }
+  }
+  if (protocol == nullptr || protocol->port == 0) {
+    return false;
+  }
+
+  target.hostname = host.hostname;
+  target.address  = host.hostname;
+  target.port     = std::to_string(protocol->port);
+  target.request.clear();
+  if (type != NH_CHECK_HTTP) {
+    return true;
+  }
+
+  // only plain http URLs can be fetched, the host is just connected to for the others.
+  std::string_view url  = protocol->health_check_url;
+  std::string_view path = "/";
+  if (url.substr(0, 7) == "http://") {
+    url.remove_prefix(7);
+    size_t slash = url.find('/');
+    if (slash != std::string_view::npos) {
+      path = url.substr(slash);
+      url  = url.substr(0, slash);
+    }
+    size_t colon = url.rfind(':');
+    if (colon != std::string_view::npos && url.find(']', colon) == std::string_view::npos) {
+      target.port = std::string{url.substr(colon + 1)};
+      url         = url.substr(0, colon);
+    }
+    if (url.size() > 2 && url.front() == '[' && url.back() == ']') {
+      url = url.substr(1, url.size() - 2);
+    }
+    if (!url.empty()) {
+      target.address = std::string{url};
+    }
+  } else if (!url.empty()) {
+    return true;
+  }
+  target.request.append("GET ").append(path).append(" HTTP/1.1\r\nHost: ").append(host.hostname);
+  target.request.append("\r\nUser-Agent: ATS health check\r\nConnection: close\r\n\r\n");
+  return true;
+}
+
+std::vector<bool>
+NextHopHealthCheck::probe(const std::vector<Target> &targets, int timeout_ms)
+{
+  enum State { CONNECTING, WRITING, READING, DONE };
+  struct Probe {
+    int fd      = -1;
+    State state = DONE;
+    size_t sent = 0;
+    size_t got  = 0;
+    char status[12];
+  };
+  std::vector<bool> passed(targets.size(), false);
+  std::vector<Probe> probes(targets.size());
+
+  for (size_t i = 0; i < targets.size(); ++i) {
+    struct addrinfo hints, *ai = nullptr;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family   = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    if (getaddrinfo(targets[i].address.c_str(), targets[i].port.c_str(), &hints, &ai) != 0 || ai == nullptr) {
+      continue;
+    }
+    int fd = socket(ai->ai_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd >= 0 && (connect(fd, ai->ai_addr, ai->ai_addrlen) == 0 || errno == EINPROGRESS)) {
+      probes[i].fd    = fd;
+      probes[i].state = CONNECTING;
+    } else if (fd >= 0) {
+      close(fd);
+    }
+    freeaddrinfo(ai);
+  }
+
+  ink_hrtime deadline = ink_get_hrtime_internal() + HRTIME_MSECONDS(timeout_ms);
+  std::vector<struct pollfd> fds;
+  std::vector<size_t> which;
+  for (ink_hrtime now = ink_get_hrtime_internal(); now < deadline; now = ink_get_hrtime_internal()) {
+    fds.clear();
+    which.clear();
+    for (size_t i = 0; i < probes.size(); ++i) {
+      if (probes[i].state != DONE) {
+        fds.push_back({probes[i].fd, static_cast<short>(probes[i].state == READING ? POLLIN : POLLOUT), 0});
+        which.push_back(i);
+      }
+    }
+    if (fds.empty() || poll(fds.data(), fds.size(), std::max<int>(1, ink_hrtime_to_msec(deadline - now))) <= 0) {
+      break;
+    }
+
+    for (size_t k = 0; k < fds.size(); ++k) {
+      if (fds[k].revents == 0) {
+        continue;
+      }
+      Probe &p             = probes[which[k]];
+      const Target &target = targets[which[k]];
+      bool failed          = false;
+      if (p.state == CONNECTING) {
+        int err       = 0;
+        socklen_t len = sizeof(err);
+        if (getsockopt(p.fd, SOL_SOCKET, SO_ERROR, &err, &len) != 0 || err != 0) {
+          failed = true;
+        } else if (target.request.empty()) {
+          passed[which[k]] = true;
+          p.state          = DONE;
+        } else {
+          p.state = WRITING;
+        }
+      } else if (p.state == WRITING) {
+        ssize_t n = send(p.fd, target.request.data() + p.sent, target.request.size() - p.sent, MSG_NOSIGNAL);
+        if (n < 0 && errno != EAGAIN && errno != EINTR) {
+          failed = true;
+        } else if (n > 0 && (p.sent += n) == target.request.size()) {
+          p.state = READING;
+        }
+      } else if (p.state == READING) {
+        // only the status line matters, "HTTP/1.1 200".
+        ssize_t n = recv(p.fd, p.status + p.got, sizeof(p.status) - p.got, 0);
+        if (n > 0) {
+          p.got += n;
+        }
+        if (p.got == sizeof(p.status)) {
+          int code         = atoi(std::string(p.status + 9, 3).c_str());
+          passed[which[k]] = memcmp(p.status, "HTTP/", 5) == 0 && code >= 200 && code < 400;
+          p.state          = DONE;
+        } else if (n == 0 || (n < 0 && errno != EAGAIN && errno != EINTR)) {
+          failed = true;
+        }
+      }
+      if (failed) {
+        p.state = DONE;
+      }
+    }
+  }
+
+  for (auto &p : probes) {
+    if (p.fd >= 0) {
+      close(p.fd);
+    }
+  }
+  return passed;
+}
+
+void
+NextHopHealthCheck::start()
+{
+  // spread the first checks over an interval.
+  eventProcessor.schedule_in(this, HRTIME_MSECONDS(std::random_device{}() % (config.interval * 1000)), ET_TASK);
+}
+
+ink_hrtime
+NextHopHealthCheck::nextDelay() const
+{
+  static thread_local std::minstd_rand random{std::random_device{}()};
+  return HRTIME_SECONDS(config.interval) + (config.jitter > 0 ? HRTIME_MSECONDS(random() % (config.jitter * 1000)) : 0);
+}
+
+int
+NextHopHealthCheck::checkEvent(int /* event */, Event * /* e */)
+{
+  if (stopped) {
+    delete this;
+    return EVENT_DONE;
+  }
+
+  HostStatus &h_stat        = HostStatus::instance();
+  std::vector<bool> results = probe(targets, config.timeout);
+
+  for (size_t i = 0; i < targets.size(); ++i) {
+    Target &target = targets[i];
+    if (results[i]) {
+      target.fails = 0;
+      if (target.down && ++target.oks >= config.rise) {
+        target.down = false;
+        target.oks  = 0;
+        h_stat.setHostStatus(target.hostname.c_str(), HostStatus_t::HOST_STATUS_UP, 0, Reason::ACTIVE);
+        NH_Note("%s passed %d health checks of the strategy named '%s', marked it up.", target.hostname.c_str(), config.rise,
+                strategy_name.c_str());
+      }
+    } else {
+      target.oks = 0;
+      if (!target.down && ++target.fails >= config.fall) {
+        target.down  = true;
+        target.fails = 0;
+        h_stat.setHostStatus(target.hostname.c_str(), HostStatus_t::HOST_STATUS_DOWN, 0, Reason::ACTIVE);
+        NH_Warn("%s failed %d health checks of the strategy named '%s', marked it down.", target.hostname.c_str(), config.fall,
+                strategy_name.c_str());
+      }
+    }
+    NH_Debug(NH_DEBUG_TAG, "health check of %s:%s for the strategy named '%s': %s", target.address.c_str(), target.port.c_str(),
+             strategy_name.c_str(), results[i] ? "passed" : "failed");
+  }
+
+  eventProcessor.schedule_in(this, nextDelay(), ET_TASK);
+  return EVENT_DONE;
+}
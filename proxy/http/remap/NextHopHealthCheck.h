@@ -0,0 +1,87 @@
+/** @file
+
+  Active health checks of the hosts of a next hop strategy.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  @section details Details
+
+  The hosts of a group are checked together on a task thread every interval, plus some jitter so
+  the checks of many strategies do not line up. A check connects to the host, and for the http type
+  sends a GET for its health_check_url and wants a 2xx or 3xx status back. After enough failures in
+  a row the host is marked down in HostStatus with the ACTIVE reason, so the strategies pass it over
+  before a request has to fail on it, and after enough passed checks it is marked up again.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "I_EventSystem.h"
+#include "NextHopSelectionStrategy.h"
+
+class NextHopHealthCheck : public Continuation
+{
+public:
+  // where and how to check a host.
+  struct Target {
+    std::string address; // host name or IP address to connect to.
+    std::string port;
+    std::string request; // the request to send, empty to only connect.
+    std::string hostname;
+    int fails = 0;
+    int oks   = 0;
+    bool down = false;
+  };
+
+  NextHopHealthCheck(const std::string &strategy, const NHActiveHealthCheck &config,
+                     const std::vector<std::shared_ptr<HostRecord>> &hosts, NHSchemeType scheme);
+
+  // schedule the first check.
+  void start();
+  // stop checking, the checker deletes itself on its next event.
+  void
+  stop()
+  {
+    stopped = true;
+  }
+
+  // the target a host is checked at, @c false if it has nothing to check.
+  static bool makeTarget(const HostRecord &host, NHSchemeType scheme, NHActiveCheckType type, Target &target);
+  // check all of @a targets at once, whether each one passed.
+  static std::vector<bool> probe(const std::vector<Target> &targets, int timeout_ms);
+
+  const std::vector<Target> &
+  getTargets() const
+  {
+    return targets;
+  }
+
+private:
+  int checkEvent(int event, Event *e);
+  ink_hrtime nextDelay() const;
+
+  std::string strategy_name;
+  NHActiveHealthCheck config;
+  std::vector<Target> targets;
+  std::atomic<bool> stopped{false};
+};
@@ -0,0 +1,219 @@
+/** @file
+
+  Implementation of the least loaded nexthop selection strategy.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include <random>
+#include <yaml-cpp/yaml.h>
+
+#include "tscore/HashSip.h"
+#include "HttpSM.h"
+#include "NextHopLeastLoaded.h"
+
+NextHopLeastLoaded::~NextHopLeastLoaded()
+{
+  NH_Debug(NH_DEBUG_TAG, "destructor called for strategy named: %s", strategy_name.c_str());
+}
+
+bool
+NextHopLeastLoaded::Init(const YAML::Node &n)
+{
+  ATSHash64Sip24 hash;
+
+  if (!NextHopSelectionStrategy::Init(n)) {
+    return false;
+  }
+
+  for (uint32_t i = 0; i < groups; i++) {
+    std::shared_ptr<ATSConsistentHash> ring = std::make_shared<ATSConsistentHash>(1);
+    for (auto &host : host_groups[i]) {
+      host->name = const_cast<char *>(host->hostname.c_str());
+      ring->insert(host.get(), host->weight > 0 ? host->weight : 1, &hash);
+    }
+    rings.push_back(std::move(ring));
+  }
+  return true;
+}
+
+// Whether the host may be selected, @a retry is set if that is only because it is due for a retry.
+bool
+NextHopLeastLoaded::isUsable(const HostRecord &host, int64_t fail_threshold, int64_t retry_time, time_t now, bool &retry) const
+{
+  HostStatRec *hst = HostStatus::instance().getHostStatus(host.hostname.c_str());
+
+  retry = false;
+  if (hst && hst->status == HOST_STATUS_DOWN && !(ignore_self_detect && hst->reasons == Reason::SELF_DETECT)) {
+    return false;
+  }
+  if (host.failedAt == 0 || host.failCount < fail_threshold) {
+    return true;
+  }
+  if ((host.failedAt + retry_time) < static_cast<unsigned>(now)) {
+    retry = true;
+    return true;
+  }
+  return false;
+}
+
+// The load of a host, @a latency standing in for its own average when it has none yet. The response
+// times cover the headers, the round trip time of the connections to the host adds what the path
+// costs the body.
+double
+NextHopLeastLoaded::cost(const HostRecord &host, int64_t latency)
+{
+  int64_t own = host.latency.load(std::memory_order_relaxed);
+  int64_t rtt = host.rtt.load(std::memory_order_relaxed);
+  return static_cast<double>((own > 0 ? own : latency) + rtt + 1) * (host.load + 1) / (host.weight > 0 ? host.weight : 1);
+}
+
+void
+NextHopLeastLoaded::findNextHop(TSHttpTxn txnp, void *ih, time_t now)
+{
+  static thread_local std::minstd_rand random{std::random_device{}()};
+
+  HttpSM *sm             = reinterpret_cast<HttpSM *>(txnp);
+  ParentResult *result   = &sm->t_state.parent_result;
+  int64_t sm_id          = sm->sm_id;
+  int64_t fail_threshold = sm->t_state.txn_conf->parent_fail_threshold;
+  int64_t retry_time     = sm->t_state.txn_conf->parent_retry_time;
+  time_t _now            = now == 0 ? time(nullptr) : now;
+  bool firstcall         = result->line_number == -1 || result->result == PARENT_UNDEFINED;
+  HostRecord *chosen     = nullptr;
+  uint32_t chosen_group  = 0;
+  bool chosen_retry      = false;
+  bool retry             = false;
+
+  if (firstcall) {
+    result->line_number = distance;
+    for (uint32_t g = 0; g < groups && chosen == nullptr; g++) {
+      auto &hosts = host_groups[g];
+      uint32_t n  = hosts.size();
+      if (n == 0) {
+        continue;
+      }
+      uint32_t a = random() % n;
+      uint32_t b = n > 1 ? (a + 1 + random() % (n - 1)) % n : a;
+      bool a_retry = false, b_retry = false;
+      bool a_ok = isUsable(*hosts[a], fail_threshold, retry_time, _now, a_retry);
+      bool b_ok = a != b && isUsable(*hosts[b], fail_threshold, retry_time, _now, b_retry);
+
+      if (a_ok && b_ok) {
+        int64_t a_latency = hosts[a]->latency.load(std::memory_order_relaxed);
+        int64_t b_latency = hosts[b]->latency.load(std::memory_order_relaxed);
+        bool pick_a       = cost(*hosts[a], b_latency) <= cost(*hosts[b], a_latency);
+        chosen            = pick_a ? hosts[a].get() : hosts[b].get();
+        chosen_retry      = pick_a ? a_retry : b_retry;
+      } else if (a_ok || b_ok) {
+        chosen       = a_ok ? hosts[a].get() : hosts[b].get();
+        chosen_retry = a_ok ? a_retry : b_retry;
+      } else {
+        // Neither choice can take it, fall back to the least loaded of the group.
+        double least = 0;
+        for (auto &host : hosts) {
+          if (isUsable(*host, fail_threshold, retry_time, _now, retry) && (chosen == nullptr || cost(*host, 0) < least)) {
+            least        = cost(*host, 0);
+            chosen       = host.get();
+            chosen_retry = retry;
+          }
+        }
+      }
+      chosen_group = g;
+    }
+  } else {
+    // The selected host failed, use the least loaded of the others.
+    for (uint32_t g = 0; g < groups && chosen == nullptr; g++) {
+      double least = 0;
+      for (auto &host : host_groups[g]) {
+        if (g == result->last_group && static_cast<uint32_t>(host->host_index) == result->last_parent) {
+          continue;
+        }
+        if (isUsable(*host, fail_threshold, retry_time, _now, retry) && (chosen == nullptr || cost(*host, 0) < least)) {
+          least        = cost(*host, 0);
+          chosen       = host.get();
+          chosen_retry = retry;
+        }
+      }
+      chosen_group = g;
+    }
+  }
+
+  if (chosen != nullptr) {
+    result->result      = PARENT_SPECIFIED;
+    result->hostname    = chosen->hostname.c_str();
+    result->port        = chosen->getPort(scheme);
+    result->last_parent = chosen->host_index;
+    result->last_lookup = result->last_group = chosen_group;
+    result->retry       = chosen_retry;
+    result->hold_load(rings[chosen_group].get(), chosen);
+    ink_assert(result->port != 0);
+    NH_Debug(NH_DEBUG_TAG, "[%" PRIu64 "] Chosen parent: %s.%d, in flight: %d, latency: %" PRId64 "us", sm_id, result->hostname,
+             result->port, chosen->load, chosen->latency.load(std::memory_order_relaxed));
+    return;
+  }
+
+  if (go_direct == true) {
+    result->result = PARENT_DIRECT;
+  } else {
+    result->result = PARENT_FAIL;
+  }
+  result->hostname = nullptr;
+  result->port     = 0;
+  result->retry    = false;
+  result->release_load();
+  NH_Debug(NH_DEBUG_TAG, "[%" PRIu64 "] No available parents, result->result: %s", sm_id, ParentResultStr[result->result]);
+}
+
+void
+NextHopLeastLoaded::onParentResponse(TSHttpTxn txnp, ink_hrtime response_time)
+{
+  HttpSM *sm           = reinterpret_cast<HttpSM *>(txnp);
+  ParentResult *result = &sm->t_state.parent_result;
+
+  if (result->result != PARENT_SPECIFIED || result->last_group >= groups ||
+      result->last_parent >= host_groups[result->last_group].size()) {
+    return;
+  }
+  HostRecord *host = host_groups[result->last_group][result->last_parent].get();
+  int64_t sample   = ink_hrtime_to_usec(response_time);
+  int64_t average  = host->latency.load(std::memory_order_relaxed);
+
+  // A moving average weighting the last sample by 1/8, like the smoothed round trip time of TCP. Updates
+  // racing each other can lose a sample, which does not matter here.
+  host->latency.store(average == 0 ? sample : average + (sample - average) / 8, std::memory_order_relaxed);
+}
+
+void
+NextHopLeastLoaded::onParentTcpInfo(TSHttpTxn txnp, const NetVCTcpInfo &info)
+{
+  HttpSM *sm           = reinterpret_cast<HttpSM *>(txnp);
+  ParentResult *result = &sm->t_state.parent_result;
+
+  if (result->result != PARENT_SPECIFIED || result->last_group >= groups ||
+      result->last_parent >= host_groups[result->last_group].size() || info.rtt_us == 0) {
+    return;
+  }
+  HostRecord *host = host_groups[result->last_group][result->last_parent].get();
+  int64_t sample   = info.rtt_us;
+  int64_t average  = host->rtt.load(std::memory_order_relaxed);
+
+  // The kernel smooths its round trip time per connection already, this averages the connections.
+  host->rtt.store(average == 0 ? sample : average + (sample - average) / 8, std::memory_order_relaxed);
+}
@@ -0,0 +1,54 @@
+/** @file
+
+  Implementation of the least loaded nexthop selection strategy.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "NextHopSelectionStrategy.h"
+
+/*
+  Power of two choices: two hosts of the first group with any available are picked at random and
+  the request goes to the one with the smaller product of the moving average of its response times,
+  plus that of the kernel round trip times when proxy.config.http.tcp_info samples them, and the
+  requests it has in flight, divided by its weight. Retries go to the least loaded of all the other
+  hosts.
+ */
+class NextHopLeastLoaded : public NextHopSelectionStrategy
+{
+  // Only used to count the requests in flight to the hosts of each group, see ParentResult::hold_load().
+  std::vector<std::shared_ptr<ATSConsistentHash>> rings;
+
+  bool isUsable(const HostRecord &host, int64_t fail_threshold, int64_t retry_time, time_t now, bool &retry) const;
+  static double cost(const HostRecord &host, int64_t latency);
+
+public:
+  NextHopLeastLoaded() = delete;
+  NextHopLeastLoaded(const std::string_view &name, const NHPolicyType &policy) : NextHopSelectionStrategy(name, policy) {}
+  ~NextHopLeastLoaded();
+  bool Init(const YAML::Node &n);
+  void findNextHop(TSHttpTxn txnp, void *ih = nullptr, time_t now = 0) override;
+  void onParentResponse(TSHttpTxn txnp, ink_hrtime response_time) override;
+  void onParentTcpInfo(TSHttpTxn txnp, const NetVCTcpInfo &info) override;
+};
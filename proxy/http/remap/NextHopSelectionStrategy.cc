@@ -25,17 +25,19 @@
 #include "I_Machine.h"
 #include "HttpSM.h"
 #include "NextHopSelectionStrategy.h"
+#include "NextHopHealthCheck.h"
 
 // ring mode strings
 constexpr std::string_view alternate_rings = "alternate_ring";
 constexpr std::string_view exhaust_rings   = "exhaust_ring";
+constexpr std::string_view peering_rings   = "peering_ring";
 
 // health check strings
 constexpr std::string_view active_health_check  = "active";
 constexpr std::string_view passive_health_check = "passive";
 
-constexpr const char *policy_strings[] = {"NH_UNDEFINED", "NH_FIRST_LIVE", "NH_RR_STRICT",
-                                          "NH_RR_IP",     "NH_RR_LATCHED", "NH_CONSISTENT_HASH"};
+constexpr const char *policy_strings[] = {"NH_UNDEFINED",  "NH_FIRST_LIVE",      "NH_RR_STRICT",   "NH_RR_IP",
+                                          "NH_RR_LATCHED", "NH_CONSISTENT_HASH", "NH_LEAST_LOADED"};
 
 NextHopSelectionStrategy::NextHopSelectionStrategy(const std::string_view &name, const NHPolicyType &policy)
 {
@@ -44,6 +46,14 @@ NextHopSelectionStrategy::NextHopSelectionStrategy(const std::string_view &name,
   NH_Debug(NH_DEBUG_TAG, "Using a selection strategy of type %s", policy_strings[policy]);
 }
 
+NextHopSelectionStrategy::~NextHopSelectionStrategy()
+{
+  // the checkers delete themselves on their next event.
+  for (auto checker : active_checkers) {
+    checker->stop();
+  }
+}
+
 //
 // parse out the data for this strategy.
 //
@@ -91,12 +101,17 @@ NextHopSelectionStrategy::Init(const YAML::Node &n)
           ring_mode = NH_ALTERNATE_RING;
         } else if (ring_mode_val == exhaust_rings) {
           ring_mode = NH_EXHAUST_RING;
+        } else if (ring_mode_val == peering_rings && policy_type == NH_CONSISTENT_HASH) {
+          ring_mode = NH_PEERING_RING;
         } else {
           ring_mode = NH_ALTERNATE_RING;
           NH_Note("Invalid 'ring_mode' value, '%s', for the strategy named '%s', using default '%s'.", ring_mode_val.c_str(),
                   strategy_name.c_str(), alternate_rings.data());
         }
       }
+      if (failover_node["peering_timeout"]) {
+        peering_timeout = failover_node["peering_timeout"].as<int>();
+      }
       if (failover_node["max_simple_retries"]) {
         max_simple_retries = failover_node["max_simple_retries"].as<int>();
       }
@@ -137,6 +152,17 @@ NextHopSelectionStrategy::Init(const YAML::Node &n)
           }
         }
       }
+      // settings for all the groups, or a list of them for each group in turn.
+      if (health_checks.active && failover_node["active_health_check"]) {
+        YAML::Node active_node = failover_node["active_health_check"];
+        if (active_node.Type() == YAML::NodeType::Sequence) {
+          for (auto it = active_node.begin(); it != active_node.end(); ++it) {
+            active_checks.push_back(it->as<NHActiveHealthCheck>());
+          }
+        } else {
+          active_checks.assign(MAX_GROUP_RINGS, active_node.as<NHActiveHealthCheck>());
+        }
+      }
     }
 
     // parse and load the host data
@@ -191,6 +217,16 @@ NextHopSelectionStrategy::Init(const YAML::Node &n)
     return false;
   }
 
+#ifndef _NH_UNIT_TESTS_
+  for (uint32_t grp = 0; grp < groups && grp < active_checks.size(); ++grp) {
+    if (active_checks[grp].type != NH_CHECK_NONE) {
+      NextHopHealthCheck *checker = new NextHopHealthCheck(strategy_name, active_checks[grp], host_groups[grp], scheme);
+      checker->start();
+      active_checkers.push_back(checker);
+    }
+  }
+#endif
+
   return true;
 }
 
@@ -291,6 +327,41 @@ template <> struct convert<HostRecord> {
   }
 };
 
+template <> struct convert<NHActiveHealthCheck> {
+  static bool
+  decode(const Node &node, NHActiveHealthCheck &hc)
+  {
+    if (node["type"]) {
+      auto type = node["type"].Scalar();
+      if (type == "http") {
+        hc.type = NH_CHECK_HTTP;
+      } else if (type == "tcp") {
+        hc.type = NH_CHECK_TCP;
+      } else if (type == "none") {
+        hc.type = NH_CHECK_NONE;
+      } else {
+        throw std::invalid_argument("Invalid active_health_check type '" + type + "', expected http, tcp or none.");
+      }
+    }
+    if (node["interval"]) {
+      hc.interval = std::max(1, node["interval"].as<int>());
+    }
+    if (node["jitter"]) {
+      hc.jitter = std::max(0, node["jitter"].as<int>());
+    }
+    if (node["timeout"]) {
+      hc.timeout = std::max(1, node["timeout"].as<int>());
+    }
+    if (node["fall"]) {
+      hc.fall = std::max(1, node["fall"].as<int>());
+    }
+    if (node["rise"]) {
+      hc.rise = std::max(1, node["rise"].as<int>());
+    }
+    return true;
+  }
+};
+
 template <> struct convert<NHProtocol> {
   static bool
   decode(const Node &node, NHProtocol &nh)
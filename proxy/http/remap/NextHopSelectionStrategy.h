@@ -23,6 +23,8 @@
 
 #pragma once
 
+#include <atomic>
+
 #include "ts/nexthop.h"
 #include "ParentSelection.h"
 
@@ -37,6 +39,8 @@
 
 constexpr const char *NH_DEBUG_TAG = "next_hop";
 
+struct NetVCTcpInfo;
+
 namespace YAML
 {
 class Node;
@@ -48,12 +52,14 @@ enum NHPolicyType {
   NH_RR_STRICT,      // strict round robin
   NH_RR_IP,          // round robin by client ip.
   NH_RR_LATCHED,     // latched to available next hop.
-  NH_CONSISTENT_HASH // consistent hashing strategy.
+  NH_CONSISTENT_HASH, // consistent hashing strategy.
+  NH_LEAST_LOADED     // power of two choices by latency and requests in flight.
 };
 
 enum NHSchemeType { NH_SCHEME_NONE = 0, NH_SCHEME_HTTP, NH_SCHEME_HTTPS };
 
-enum NHRingMode { NH_ALTERNATE_RING = 0, NH_EXHAUST_RING };
+// with NH_PEERING_RING the first group are sibling peers, this host among them, asked only for their cached copy.
+enum NHRingMode { NH_ALTERNATE_RING = 0, NH_EXHAUST_RING, NH_PEERING_RING };
 
 enum NH_HHealthCheck { NH_ACTIVE, NH_PASSIVE };
 
@@ -83,6 +89,18 @@ struct HealthChecks {
   bool passive = false;
 };
 
+enum NHActiveCheckType { NH_CHECK_NONE = 0, NH_CHECK_HTTP, NH_CHECK_TCP };
+
+// settings of the health checks traffic_server makes to the hosts of a group, see NextHopHealthCheck.
+struct NHActiveHealthCheck {
+  NHActiveCheckType type = NH_CHECK_HTTP; // GET the health_check_url, or only connect to the host.
+  int interval           = 5;             // seconds between the checks.
+  int jitter             = 1;             // up to this many seconds are added to each interval at random.
+  int timeout            = 1000;          // milliseconds a check may take.
+  int fall               = 2;             // failed checks in a row to mark a host down.
+  int rise               = 2;             // passed checks in a row to mark it up again.
+};
+
 struct NHProtocol {
   NHSchemeType scheme;
   uint32_t port;
@@ -100,6 +118,8 @@ struct HostRecord : ATSConsistentHashNode {
   int host_index;
   int group_index;
   std::vector<std::shared_ptr<NHProtocol>> protocols;
+  std::atomic<int64_t> latency{0}; // moving average of the response times in microseconds, see onParentResponse().
+  std::atomic<int64_t> rtt{0};     // moving average of the kernel round trip times in microseconds, see onParentTcpInfo().
 
   // construct without locking the _mutex.
   HostRecord()
@@ -209,12 +229,14 @@ private:
   std::unordered_map<std::string, std::shared_ptr<HostRecord>> host_map;
 };
 
+class NextHopHealthCheck;
+
 class NextHopSelectionStrategy
 {
 public:
   NextHopSelectionStrategy();
   NextHopSelectionStrategy(const std::string_view &name, const NHPolicyType &type);
-  virtual ~NextHopSelectionStrategy(){};
+  virtual ~NextHopSelectionStrategy();
   bool Init(const YAML::Node &n);
   virtual void findNextHop(TSHttpTxn txnp, void *ih = nullptr, time_t now = 0) = 0;
   void markNextHop(TSHttpTxn txnp, const char *hostname, const int port, const NHCmd status, void *ih = nullptr,
@@ -224,6 +246,18 @@ public:
   virtual bool responseIsRetryable(unsigned int current_retry_attempts, HTTPStatus response_code);
   virtual bool onFailureMarkParentDown(HTTPStatus response_code);
 
+  // the time the next hop selected took to send the response headers, for the strategies balancing on it.
+  virtual void
+  onParentResponse(TSHttpTxn txnp, ink_hrtime response_time)
+  {
+  }
+
+  // the TCP state of the connection to the next hop selected at the end of the response, see proxy.config.http.tcp_info.
+  virtual void
+  onParentTcpInfo(TSHttpTxn txnp, const NetVCTcpInfo &info)
+  {
+  }
+
   std::string strategy_name;
   bool go_direct           = true;
   bool parent_is_proxy     = true;
@@ -231,9 +265,12 @@ public:
   NHPolicyType policy_type = NH_UNDEFINED;
   NHSchemeType scheme      = NH_SCHEME_NONE;
   NHRingMode ring_mode     = NH_ALTERNATE_RING;
+  int peering_timeout      = 500; // milliseconds a peer may take to connect and between reads.
   ResponseCodes resp_codes;
   HealthChecks health_checks;
   NextHopHealthStatus passive_health;
+  std::vector<NHActiveHealthCheck> active_checks; // by group, empty if traffic_server does not check the hosts.
+  std::vector<NextHopHealthCheck *> active_checkers;
   std::vector<std::vector<std::shared_ptr<HostRecord>>> host_groups;
   uint32_t max_simple_retries = 1;
   uint32_t groups             = 0;
@@ -29,6 +29,7 @@
 #include "NextHopStrategyFactory.h"
 #include "NextHopConsistentHash.h"
 #include "NextHopRoundRobin.h"
+#include "NextHopLeastLoaded.h"
 
 NextHopStrategyFactory::NextHopStrategyFactory(const char *file)
 {
@@ -44,6 +45,7 @@ NextHopStrategyFactory::NextHopStrategyFactory(const char *file)
   constexpr std::string_view rr_strict       = "rr_strict";
   constexpr std::string_view rr_ip           = "rr_ip";
   constexpr std::string_view latched         = "latched";
+  constexpr std::string_view least_loaded    = "least_loaded";
 
   strategies_loaded    = true;
   const char *basename = fn.substr(fn.find_last_of('/') + 1).data();
@@ -86,6 +88,8 @@ NextHopStrategyFactory::NextHopStrategyFactory(const char *file)
         policy_type = NH_RR_IP;
       } else if (policy_value == latched) {
         policy_type = NH_RR_LATCHED;
+      } else if (policy_value == least_loaded) {
+        policy_type = NH_LEAST_LOADED;
       }
       if (policy_type == NH_UNDEFINED) {
         NH_Error("Invalid policy '%s' for the strategy named '%s', this strategy will be ignored.", policy_value.c_str(),
@@ -114,6 +118,7 @@ NextHopStrategyFactory::createStrategy(const std::string &name, const NHPolicyTy
   std::shared_ptr<NextHopSelectionStrategy> strat;
   std::shared_ptr<NextHopRoundRobin> strat_rr;
   std::shared_ptr<NextHopConsistentHash> strat_chash;
+  std::shared_ptr<NextHopLeastLoaded> strat_ll;
 
   strat = strategyInstance(name.c_str());
   if (strat != nullptr) {
@@ -141,6 +146,14 @@ NextHopStrategyFactory::createStrategy(const std::string &name, const NHPolicyTy
       strat_chash.reset();
     }
     break;
+  case NH_LEAST_LOADED:
+    strat_ll = std::make_shared<NextHopLeastLoaded>(name, policy_type);
+    if (strat_ll->Init(node)) {
+      _strategies.emplace(std::make_pair(std::string(name), strat_ll));
+    } else {
+      strat_ll.reset();
+    }
+    break;
   default: // handles P_UNDEFINED, no strategy is added
     break;
   };
@@ -37,6 +37,28 @@
 
 #include <algorithm> /* std::swap */
 
+namespace
+{
+/* The index of the calling thread among the event threads, -1 if it is not one */
+int
+ethread_index()
+{
+  static thread_local int index = -2;
+
+  if (-2 == index) {
+    EThread *thread = this_ethread();
+    index           = -1;
+    for (int i = 0; thread && i < eventProcessor.n_ethreads; ++i) {
+      if (eventProcessor.all_ethreads[i] == thread) {
+        index = i;
+        break;
+      }
+    }
+  }
+  return index;
+}
+} // namespace
+
 RemapPluginInst::RemapPluginInst(RemapPluginInfo &plugin) : _plugin(plugin)
 {
   _plugin.acquire();
@@ -53,6 +75,9 @@ RemapPluginInst::init(RemapPluginInfo *plugin, int argc, char **argv, std::strin
   RemapPluginInst *inst = new RemapPluginInst(*plugin);
   if (plugin->initInstance(argc, argv, &(inst->_instance), error)) {
     plugin->incInstanceCount();
+    if (plugin->new_thread_instance_cb) {
+      inst->_threadInstances.resize(eventProcessor.n_ethreads, nullptr);
+    }
     return inst;
   }
   delete inst;
@@ -63,6 +88,12 @@ void
 RemapPluginInst::done()
 {
   _plugin.decInstanceCount();
+  for (void *thread_ih : _threadInstances) {
+    if (thread_ih) {
+      _plugin.doneThreadInstance(_instance, thread_ih);
+    }
+  }
+  _threadInstances.clear();
   _plugin.doneInstance(_instance);
 
   if (0 == _plugin.instanceCount()) {
@@ -76,6 +107,23 @@ RemapPluginInst::doRemap(TSHttpTxn rh, TSRemapRequestInfo *rri)
   return _plugin.doRemap(_instance, rh, rri);
 }
 
+void *
+RemapPluginInst::threadInstance()
+{
+  int index = ethread_index();
+
+  if (index < 0 || index >= static_cast<int>(_threadInstances.size())) {
+    return nullptr;
+  }
+
+  /* Only this thread writes its entry */
+  void *&thread_ih = _threadInstances[index];
+  if (nullptr == thread_ih) {
+    thread_ih = _plugin.initThreadInstance(_instance);
+  }
+  return thread_ih;
+}
+
 void
 RemapPluginInst::osResponse(TSHttpTxn rh, int os_response_type)
 {
@@ -99,7 +147,23 @@ PluginFactory::PluginFactory()
 
 PluginFactory::~PluginFactory()
 {
-  _instList.apply([](RemapPluginInst *pluginInst) -> void { delete pluginInst; });
+  if (_deactivated) {
+    for (auto inst : _finished) {
+      delete inst;
+    }
+  } else {
+    /* Never deactivated, delete the instances no other factory uses without calling them */
+    _instList.apply([](RemapPluginInst *pluginInst) -> void {
+      if (0 == --pluginInst->_factories) {
+        delete pluginInst;
+      }
+    });
+    for (auto inst : _adopted) {
+      if (0 == --inst->_factories) {
+        delete inst;
+      }
+    }
+  }
   _instList.clear();
 
   fs::remove(_runtimeDir, _ec);
@@ -159,6 +223,12 @@ PluginFactory::getRemapPlugin(const fs::path &configPath, int argc, char **argv,
     dynamicReloadEnabled = false;
   }
 
+  /* Instances are keyed by effective path and parameters, to be reused by the next factory */
+  std::string key(effectivePath.string());
+  for (int i = 0; i < argc; ++i) {
+    key.append(1, '\0').append(argv[i]);
+  }
+
   /* Only one plugin with this effective path can be loaded by a plugin factory */
   RemapPluginInfo *plugin = dynamic_cast<RemapPluginInfo *>(findByEffectivePath(effectivePath, dynamicReloadEnabled));
   RemapPluginInst *inst   = nullptr;
@@ -196,6 +266,7 @@ PluginFactory::getRemapPlugin(const fs::path &configPath, int argc, char **argv,
           if (nullptr != inst) {
             /* Plugin loading and instance init went fine. */
             _instList.append(inst);
+            _instByKey.emplace(key, inst);
           }
         } else {
           /* Plugin DSO load succeeded but instance init failed. */
@@ -215,9 +286,24 @@ PluginFactory::getRemapPlugin(const fs::path &configPath, int argc, char **argv,
     }
   } else {
     PluginDebug(_tag, "plugin '%s' has already been loaded", configPath.c_str());
+
+    /* The same plugin with the same parameters as in the previous configuration can keep its instance */
+    if (nullptr != _previous && _instByKey.end() == _instByKey.find(key)) {
+      auto spot = _previous->_instByKey.find(key);
+      if (_previous->_instByKey.end() != spot && &spot->second->_plugin == plugin) {
+        PluginDebug(_tag, "plugin '%s' reusing instance of factory '%s'", configPath.c_str(), _previous->getUuid());
+        inst = spot->second;
+        ++inst->_factories;
+        _adopted.push_back(inst);
+        _instByKey.emplace(key, inst);
+        return inst;
+      }
+    }
+
     inst = RemapPluginInst::init(plugin, argc, argv, error);
     if (nullptr != inst) {
       _instList.append(inst);
+      _instByKey.emplace(key, inst);
     }
   }
 
@@ -266,19 +352,43 @@ PluginFactory::findByEffectivePath(const fs::path &path, bool dynamicReloadEnabl
   return PluginDso::loadedPlugins()->findByEffectivePath(path, dynamicReloadEnabled);
 }
 
+/**
+ * @brief Reuse the instances of @a previous for the plugins loaded with the same parameters, until set back to nullptr.
+ *
+ * Only plugins whose DSO @a previous has already loaded can be reused, those are the ones looked up by effective path.
+ * @a previous must not be deactivated while it is set.
+ */
+void
+PluginFactory::reuseInstancesFrom(PluginFactory *previous)
+{
+  _previous = previous;
+}
+
 /**
  * @brief Tell all plugins instantiated by this factory that the configuration
  * they are using is no longer the active one.
  *
  * This method would be useful only in case configs are reloaded independently from
  * factory/plugins instantiation and initialization.
+ *
+ * An instance also used by a newer factory is done only when that one is deactivated.
  */
 void
 PluginFactory::deactivate()
 {
   PluginDebug(_tag, "deactivate configuration used by factory '%s'", getUuid());
 
-  _instList.apply([](RemapPluginInst &pluginInst) -> void { pluginInst.done(); });
+  auto release = [this](RemapPluginInst *inst) -> void {
+    if (0 == --inst->_factories) {
+      inst->done();
+      _finished.push_back(inst);
+    }
+  };
+  _instList.apply([&release](RemapPluginInst &pluginInst) -> void { release(&pluginInst); });
+  for (auto inst : _adopted) {
+    release(inst);
+  }
+  _deactivated = true;
 }
 
 /**
@@ -301,6 +411,9 @@ PluginFactory::indicatePostReload(bool reloadSuccessful)
   for (auto &inst : _instList) {
     pluginUsed[&(inst._plugin)]++;
   }
+  for (auto inst : _adopted) {
+    pluginUsed[&(inst->_plugin)]++;
+  }
 
   PluginDso::loadedPlugins()->indicatePostReload(reloadSuccessful, pluginUsed, getUuid());
 }
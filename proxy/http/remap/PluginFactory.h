@@ -23,6 +23,9 @@
 
 #pragma once
 
+#include <atomic>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "tscore/Ptr.h"
@@ -53,6 +56,7 @@ public:
   /* Used by the traffic server core while processing requests */
   TSRemapStatus doRemap(TSHttpTxn rh, TSRemapRequestInfo *rri);
   void osResponse(TSHttpTxn rh, int os_response_type);
+  void *threadInstance();
 
   /* List used by the plugin factory */
   using self_type  = RemapPluginInst; ///< Self reference type.
@@ -63,6 +67,12 @@ public:
   /* Plugin instance = the plugin info + the data returned by the init callback */
   RemapPluginInfo &_plugin;
   void *_instance = nullptr;
+
+  /* The state of the instance for each event thread, if the plugin has per thread instances */
+  std::vector<void *> _threadInstances;
+
+  /* Number of factories using the instance, it is done when the last one is deactivated */
+  std::atomic<int> _factories{1};
 };
 
 /**
@@ -101,6 +111,8 @@ public:
   virtual const char *getUuid();
   void clean(std::string &error);
 
+  void reuseInstancesFrom(PluginFactory *previous);
+
   void deactivate();
   void indicatePreReload();
   void indicatePostReload(bool reloadSuccessful);
@@ -114,6 +126,13 @@ protected:
 
   PluginInstList _instList;
 
+  /* Instances by plugin effective path and parameters, for the next factory to reuse */
+  std::unordered_map<std::string, RemapPluginInst *> _instByKey;
+  std::vector<RemapPluginInst *> _adopted;  /** @brief instances reused from a previous factory */
+  std::vector<RemapPluginInst *> _finished; /** @brief instances done when this factory was deactivated */
+  PluginFactory *_previous = nullptr;
+  bool _deactivated        = false;
+
   ATSUuid *_uuid = nullptr;
   std::error_code _ec;
   bool _preventiveCleaning = true;
@@ -0,0 +1,188 @@
+/** @file
+
+  Literal prefilter for the host regular expressions of remap rules.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "RegexPrefilter.h"
+
+#include <cctype>
+
+namespace
+{
+constexpr std::string_view META{"\\^$.[]|()?*+{}"};
+
+bool
+is_meta(char c)
+{
+  return META.find(c) != std::string_view::npos;
+}
+
+bool
+is_quantifier(char c)
+{
+  return c == '*' || c == '?' || c == '{' || c == '+';
+}
+
+// Alternation, or option settings like (?x), can make the literals optional, so those patterns are not filtered.
+bool
+can_filter(std::string_view pattern)
+{
+  return pattern.find('|') == std::string_view::npos && pattern.find("(?") == std::string_view::npos;
+}
+} // namespace
+
+std::string
+RegexPrefilter::literal_prefix(std::string_view pattern)
+{
+  std::string literal;
+
+  if (!can_filter(pattern) || pattern.empty() || pattern.front() != '^') {
+    return literal;
+  }
+
+  size_t i = 1;
+  while (i < pattern.size()) {
+    char c      = pattern[i];
+    size_t next = i + 1;
+    if (c == '\\') {
+      // Only an escaped punctuation character is itself, the others are classes like \d.
+      if (next >= pattern.size() || std::isalnum(static_cast<unsigned char>(pattern[next]))) {
+        break;
+      }
+      c = pattern[next++];
+    } else if (is_meta(c)) {
+      break;
+    }
+    if (next < pattern.size() && is_quantifier(pattern[next])) {
+      // The character may be left out, unless it must be there at least once.
+      if (pattern[next] == '+') {
+        literal.push_back(c);
+      }
+      break;
+    }
+    literal.push_back(c);
+    i = next;
+  }
+
+  return literal;
+}
+
+std::string
+RegexPrefilter::literal_suffix(std::string_view pattern)
+{
+  std::string literal;
+
+  if (!can_filter(pattern) || pattern.size() < 2 || pattern.back() != '$') {
+    return literal;
+  }
+  // The '$' must not be escaped itself.
+  size_t escapes = 0;
+  for (size_t i = pattern.size() - 1; i > 0 && pattern[i - 1] == '\\'; --i) {
+    ++escapes;
+  }
+  if (escapes % 2) {
+    return literal;
+  }
+
+  // Walk back from the '$', stopping at anything that is not a literal, like a ')' or a quantifier.
+  size_t end = pattern.size() - 1;
+  while (end > 0) {
+    char c         = pattern[end - 1];
+    size_t escapes = 0;
+    for (size_t i = end - 1; i > 0 && pattern[i - 1] == '\\'; --i) {
+      ++escapes;
+    }
+    if (escapes % 2) {
+      if (std::isalnum(static_cast<unsigned char>(c))) {
+        break;
+      }
+      end -= 2;
+    } else if (is_meta(c)) {
+      break;
+    } else {
+      end -= 1;
+    }
+    literal.push_back(c);
+  }
+
+  std::reverse(literal.begin(), literal.end());
+  return literal;
+}
+
+void
+RegexPrefilter::add(std::string_view pattern)
+{
+  _unfiltered.push_back(_rules.size());
+  _rules.push_back({literal_prefix(pattern), literal_suffix(pattern)});
+
+  // A fully literal pattern has the same text for both, which one of them covers.
+  Rule &r = _rules.back();
+  if (!r.prefix.empty() && r.prefix == r.suffix) {
+    r.suffix.clear();
+  }
+}
+
+void
+RegexPrefilter::build()
+{
+  std::unordered_map<std::string_view, int> prefix_count, suffix_count;
+  for (auto const &r : _rules) {
+    ++prefix_count[r.prefix];
+    ++suffix_count[r.suffix];
+  }
+
+  _unfiltered.clear();
+  _by_prefix.clear();
+  _by_suffix.clear();
+  _literals.clear();
+
+  for (int rule = 0; rule < static_cast<int>(_rules.size()); ++rule) {
+    Rule const &r = _rules[rule];
+    if (r.prefix.empty() && r.suffix.empty()) {
+      _unfiltered.push_back(rule);
+      continue;
+    }
+
+    // Index by the literal fewer rules share, then the longer one. The other is checked for each candidate.
+    bool by_prefix = r.suffix.empty();
+    if (!r.prefix.empty() && !r.suffix.empty()) {
+      int prefixes = prefix_count[r.prefix], suffixes = suffix_count[r.suffix];
+      by_prefix    = prefixes != suffixes ? prefixes < suffixes : r.prefix.size() >= r.suffix.size();
+    }
+    std::string const &literal = by_prefix ? r.prefix : r.suffix;
+    auto &rules                = (by_prefix ? _by_prefix : _by_suffix)[literal.size()];
+    auto spot                  = rules.find(literal);
+    if (spot == rules.end()) {
+      spot = rules.emplace(_literals.emplace_back(literal), std::vector<int>{}).first;
+    }
+    spot->second.push_back(rule);
+  }
+}
+
+void
+RegexPrefilter::clear()
+{
+  _rules.clear();
+  _unfiltered.clear();
+  _by_prefix.clear();
+  _by_suffix.clear();
+  _literals.clear();
+}
@@ -0,0 +1,146 @@
+/** @file
+
+  Literal prefilter for the host regular expressions of remap rules.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  @section details Details
+
+  Most host patterns in remap.config are anchored on a literal, like @c ^(.*)\.example\.com$. A host
+  can only match such a pattern if it ends (or starts) with the literal, so the rules are indexed by
+  their literals and a lookup only runs the regular expressions of the rules whose literals the host
+  has, plus those of the rules that have none. A rule with both is indexed by the one fewer rules
+  share, since a domain suffix like @c .example.net is often common to thousands of them. The rules
+  come out in the order they were added, which is their rank, so the first one that matches is
+  still the one that wins.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <deque>
+#include <map>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "tscore/ink_config.h"
+#include "tscore/ink_defs.h"
+
+class RegexPrefilter
+{
+public:
+  /// Add the pattern of the next rule, numbered from 0 in the order they are added.
+  void add(std::string_view pattern);
+
+  /// Index the rules added. Until then the literals of every rule are compared for each host.
+  void build();
+
+  /** Call @a f with the number of each rule that may match @a host, lowest first, until it returns @c false.
+
+      The rules not called can not match @a host.
+   */
+  template <typename F> void candidates(std::string_view host, F &&f) const;
+
+  size_t
+  size() const
+  {
+    return _rules.size();
+  }
+
+  void clear();
+
+  /// The text a host matching @a pattern must start with, empty if it is not anchored on a literal.
+  static std::string literal_prefix(std::string_view pattern);
+  /// The text a host matching @a pattern must end with, empty if it is not anchored on a literal.
+  static std::string literal_suffix(std::string_view pattern);
+
+private:
+  struct Rule {
+    std::string prefix;
+    std::string suffix;
+  };
+  /// Rules by the literal they are indexed with, for each length of literal.
+  using LiteralIndex = std::map<size_t, std::unordered_map<std::string_view, std::vector<int>>>;
+
+  bool
+  _has_literals(int rule, std::string_view host) const
+  {
+    Rule const &r = _rules[rule];
+    return host.size() >= r.prefix.size() + r.suffix.size() && host.substr(0, r.prefix.size()) == r.prefix &&
+           host.substr(host.size() - r.suffix.size()) == r.suffix;
+  }
+
+  std::vector<Rule> _rules;
+  std::vector<int> _unfiltered; ///< Rules without a literal.
+  LiteralIndex _by_prefix;
+  LiteralIndex _by_suffix;
+  std::deque<std::string> _literals; ///< Keys of the indices.
+};
+
+template <typename F>
+void
+RegexPrefilter::candidates(std::string_view host, F &&f) const
+{
+  struct Span {
+    const int *next;
+    const int *end;
+  };
+  // One list for each length of literal the host is long enough for, of each index, and the unfiltered rules.
+  Span spans[TS_MAX_HOST_NAME_LEN * 2 + 1];
+  int n_spans = 0;
+
+  if (!_unfiltered.empty()) {
+    spans[n_spans++] = {_unfiltered.data(), _unfiltered.data() + _unfiltered.size()};
+  }
+  for (auto const &[length, rules] : _by_prefix) {
+    if (length > host.size() || n_spans == static_cast<int>(countof(spans))) {
+      break;
+    }
+    if (auto spot = rules.find(host.substr(0, length)); spot != rules.end()) {
+      spans[n_spans++] = {spot->second.data(), spot->second.data() + spot->second.size()};
+    }
+  }
+  for (auto const &[length, rules] : _by_suffix) {
+    if (length > host.size() || n_spans == static_cast<int>(countof(spans))) {
+      break;
+    }
+    if (auto spot = rules.find(host.substr(host.size() - length)); spot != rules.end()) {
+      spans[n_spans++] = {spot->second.data(), spot->second.data() + spot->second.size()};
+    }
+  }
+
+  // Merge the lists, each of them is in rule order and a rule is in only one of them.
+  while (n_spans > 0) {
+    int lowest = 0;
+    for (int i = 1; i < n_spans; ++i) {
+      if (*spans[i].next < *spans[lowest].next) {
+        lowest = i;
+      }
+    }
+    int rule = *spans[lowest].next++;
+    if (spans[lowest].next == spans[lowest].end) {
+      spans[lowest] = spans[--n_spans];
+    }
+    if (_has_literals(rule, host) && !f(rule)) {
+      return;
+    }
+  }
+}
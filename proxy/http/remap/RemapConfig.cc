@@ -700,6 +700,14 @@ remap_check_option(const char **argv, int argc, unsigned long findmode, int *_re
           *argptr = &argv[i][9];
         }
         ret_flags |= REMAP_OPTFLG_STRATEGY;
+      } else if (!strncasecmp(argv[i], "prewarm=", 8)) {
+        if ((findmode & REMAP_OPTFLG_PREWARM) != 0) {
+          idx = i;
+        }
+        if (argptr) {
+          *argptr = &argv[i][8];
+        }
+        ret_flags |= REMAP_OPTFLG_PREWARM;
       } else {
         Warning("ignoring invalid remap option '%s'", argv[i]);
       }
@@ -1293,6 +1301,26 @@ remap_parse_config_bti(const char *path, BUILD_TABLE_INFO *bti)
       }
     }
 
+    // check for a 'prewarm' count and record the origin to keep connections open to.
+    if ((bti->remap_optflg & REMAP_OPTFLG_PREWARM) != 0 &&
+        (maptype == FORWARD_MAP || maptype == FORWARD_MAP_REFERER || maptype == FORWARD_MAP_WITH_RECV_PORT)) {
+      int idx = 0;
+      remap_check_option((const char **)bti->argv, bti->argc, REMAP_OPTFLG_PREWARM, &idx);
+      const char *c = strchr(bti->argv[idx], static_cast<int>('='));
+      int conns     = c ? atoi(c + 1) : 0;
+      if (conns <= 0) {
+        errStr = "'prewarm' needs a positive number of connections, unable to add mapping rule";
+        goto MAP_ERROR;
+      }
+      if (is_cur_mapping_regex) {
+        Warning("ignoring the 'prewarm' option of the regex mapping at line %d, the origin is not known until a request", cln + 1);
+      } else {
+        new_mapping->prewarm_conns = conns;
+        bti->rewrite->AddPreWarmOrigin(&new_mapping->toURL, conns);
+        Debug("url_rewrite", "keeping %d connections open to the origin of the mapping at line %d", conns, cln + 1);
+      }
+    }
+
     // Check "remap" plugin options and load .so object
     if ((bti->remap_optflg & REMAP_OPTFLG_PLUGIN) != 0 &&
         (maptype == FORWARD_MAP || maptype == FORWARD_MAP_REFERER || maptype == FORWARD_MAP_WITH_RECV_PORT)) {
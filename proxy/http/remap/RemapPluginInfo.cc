@@ -85,14 +85,16 @@ RemapPluginInfo::load(std::string &error)
     return false;
   }
 
-  init_cb               = getFunctionSymbol<Init_F>(TSREMAP_FUNCNAME_INIT);
-  pre_config_reload_cb  = getFunctionSymbol<PreReload_F>(TSREMAP_FUNCNAME_PRE_CONFIG_RELOAD);
-  post_config_reload_cb = getFunctionSymbol<PostReload_F>(TSREMAP_FUNCNAME_POST_CONFIG_RELOAD);
-  done_cb               = getFunctionSymbol<Done_F>(TSREMAP_FUNCNAME_DONE);
-  new_instance_cb       = getFunctionSymbol<New_Instance_F>(TSREMAP_FUNCNAME_NEW_INSTANCE);
-  delete_instance_cb    = getFunctionSymbol<Delete_Instance_F>(TSREMAP_FUNCNAME_DELETE_INSTANCE);
-  do_remap_cb           = getFunctionSymbol<Do_Remap_F>(TSREMAP_FUNCNAME_DO_REMAP);
-  os_response_cb        = getFunctionSymbol<OS_Response_F>(TSREMAP_FUNCNAME_OS_RESPONSE);
+  init_cb                   = getFunctionSymbol<Init_F>(TSREMAP_FUNCNAME_INIT);
+  pre_config_reload_cb      = getFunctionSymbol<PreReload_F>(TSREMAP_FUNCNAME_PRE_CONFIG_RELOAD);
+  post_config_reload_cb     = getFunctionSymbol<PostReload_F>(TSREMAP_FUNCNAME_POST_CONFIG_RELOAD);
+  done_cb                   = getFunctionSymbol<Done_F>(TSREMAP_FUNCNAME_DONE);
+  new_instance_cb           = getFunctionSymbol<New_Instance_F>(TSREMAP_FUNCNAME_NEW_INSTANCE);
+  delete_instance_cb        = getFunctionSymbol<Delete_Instance_F>(TSREMAP_FUNCNAME_DELETE_INSTANCE);
+  new_thread_instance_cb    = getFunctionSymbol<New_Thread_Instance_F>(TSREMAP_FUNCNAME_NEW_THREAD_INST);
+  delete_thread_instance_cb = getFunctionSymbol<Delete_Thread_Instance_F>(TSREMAP_FUNCNAME_DELETE_THREAD_INST);
+  do_remap_cb               = getFunctionSymbol<Do_Remap_F>(TSREMAP_FUNCNAME_DO_REMAP);
+  os_response_cb            = getFunctionSymbol<OS_Response_F>(TSREMAP_FUNCNAME_OS_RESPONSE);
 
   /* Validate if the callback TSREMAP functions are specified correctly in the plugin. */
   bool valid = true;
@@ -108,6 +110,9 @@ RemapPluginInfo::load(std::string &error)
   } else if (new_instance_cb && !delete_instance_cb) {
     error = missingRequiredSymbolError(_configPath.string(), TSREMAP_FUNCNAME_DELETE_INSTANCE, TSREMAP_FUNCNAME_NEW_INSTANCE);
     valid = false;
+  } else if (new_thread_instance_cb && !delete_thread_instance_cb) {
+    error = missingRequiredSymbolError(_configPath.string(), TSREMAP_FUNCNAME_DELETE_THREAD_INST, TSREMAP_FUNCNAME_NEW_THREAD_INST);
+    valid = false;
   }
 
   if (valid) {
@@ -217,6 +222,32 @@ RemapPluginInfo::doneInstance(void *ih)
   resetPluginContext();
 }
 
+void *
+RemapPluginInfo::initThreadInstance(void *ih)
+{
+  void *thread_ih = nullptr;
+
+  if (new_thread_instance_cb) {
+    setPluginContext();
+    thread_ih = new_thread_instance_cb(ih);
+    resetPluginContext();
+  }
+
+  return thread_ih;
+}
+
+void
+RemapPluginInfo::doneThreadInstance(void *ih, void *thread_ih)
+{
+  setPluginContext();
+
+  if (delete_thread_instance_cb) {
+    delete_thread_instance_cb(ih, thread_ih);
+  }
+
+  resetPluginContext();
+}
+
 TSRemapStatus
 RemapPluginInfo::doRemap(void *ih, TSHttpTxn rh, TSRemapRequestInfo *rri)
 {
@@ -42,6 +42,8 @@ static constexpr const char *const TSREMAP_FUNCNAME_POST_CONFIG_RELOAD = "TSRema
 static constexpr const char *const TSREMAP_FUNCNAME_DONE               = "TSRemapDone";
 static constexpr const char *const TSREMAP_FUNCNAME_NEW_INSTANCE       = "TSRemapNewInstance";
 static constexpr const char *const TSREMAP_FUNCNAME_DELETE_INSTANCE    = "TSRemapDeleteInstance";
+static constexpr const char *const TSREMAP_FUNCNAME_NEW_THREAD_INST    = "TSRemapNewThreadInstance";
+static constexpr const char *const TSREMAP_FUNCNAME_DELETE_THREAD_INST = "TSRemapDeleteThreadInstance";
 static constexpr const char *const TSREMAP_FUNCNAME_DO_REMAP           = "TSRemapDoRemap";
 static constexpr const char *const TSREMAP_FUNCNAME_OS_RESPONSE        = "TSRemapOSResponse";
 
@@ -64,20 +66,26 @@ public:
   using New_Instance_F = TSReturnCode(int argc, char *argv[], void **ih, char *errbuf, int errbuf_size);
   /// Delete a rule instance.
   using Delete_Instance_F = void(void *ih);
+  /// Create the state of a rule instance for the calling thread.
+  using New_Thread_Instance_F = void *(void *ih);
+  /// Delete the state of a rule instance for a thread.
+  using Delete_Thread_Instance_F = void(void *ih, void *thread_ih);
   /// Perform remap.
   using Do_Remap_F = TSRemapStatus(void *ih, TSHttpTxn rh, TSRemapRequestInfo *rri);
   /// I have no idea what this is for.
   using OS_Response_F = void(void *ih, TSHttpTxn rh, int os_response_type);
 
-  void *dl_handle                       = nullptr; /* "handle" for the dynamic library */
-  Init_F *init_cb                       = nullptr;
-  PreReload_F *pre_config_reload_cb     = nullptr;
-  PostReload_F *post_config_reload_cb   = nullptr;
-  Done_F *done_cb                       = nullptr;
-  New_Instance_F *new_instance_cb       = nullptr;
-  Delete_Instance_F *delete_instance_cb = nullptr;
-  Do_Remap_F *do_remap_cb               = nullptr;
-  OS_Response_F *os_response_cb         = nullptr;
+  void *dl_handle                                     = nullptr; /* "handle" for the dynamic library */
+  Init_F *init_cb                                     = nullptr;
+  PreReload_F *pre_config_reload_cb                   = nullptr;
+  PostReload_F *post_config_reload_cb                 = nullptr;
+  Done_F *done_cb                                     = nullptr;
+  New_Instance_F *new_instance_cb                     = nullptr;
+  Delete_Instance_F *delete_instance_cb               = nullptr;
+  New_Thread_Instance_F *new_thread_instance_cb       = nullptr;
+  Delete_Thread_Instance_F *delete_thread_instance_cb = nullptr;
+  Do_Remap_F *do_remap_cb                             = nullptr;
+  OS_Response_F *os_response_cb                       = nullptr;
 
   RemapPluginInfo(const fs::path &configPath, const fs::path &effectivePath, const fs::path &runtimePath);
   ~RemapPluginInfo();
@@ -92,6 +100,8 @@ public:
   /* Used by the facility that handles remap plugin instances to invoke callbacks per plugin instance */
   bool initInstance(int argc, char **argv, void **ih, std::string &error);
   void doneInstance(void *ih);
+  void *initThreadInstance(void *ih);
+  void doneThreadInstance(void *ih, void *thread_ih);
 
   /* Used by the other parts of the traffic server core while handling requests */
   TSRemapStatus doRemap(void *ih, TSHttpTxn rh, TSRemapRequestInfo *rri);
@@ -32,36 +32,38 @@ RemapPlugins::run_plugin(RemapPluginInst *plugin)
   ink_assert(_s);
 
   TSRemapStatus plugin_retcode;
-  TSRemapRequestInfo rri;
-  URL *map_from = _s->url_map.getFromURL();
-  URL *map_to   = _s->url_map.getToURL();
 
-  // This is the equivalent of TSHttpTxnClientReqGet(), which every remap plugin would
-  // have to call.
-  rri.requestBufp = reinterpret_cast<TSMBuffer>(_request_header);
-  rri.requestHdrp = reinterpret_cast<TSMLoc>(_request_header->m_http);
+  // The plugins of a chain share the request info, it is only filled for the first one.
+  if (_cur == 0) {
+    URL *map_from = _s->url_map.getFromURL();
+    URL *map_to   = _s->url_map.getToURL();
 
-  // Read-only URL's (TSMLoc's to the SDK)
-  rri.mapFromUrl = reinterpret_cast<TSMLoc>(map_from->m_url_impl);
-  rri.mapToUrl   = reinterpret_cast<TSMLoc>(map_to->m_url_impl);
-  rri.requestUrl = reinterpret_cast<TSMLoc>(_request_url->m_url_impl);
+    // This is the equivalent of TSHttpTxnClientReqGet(), which every remap plugin would
+    // have to call.
+    _rri.requestBufp = reinterpret_cast<TSMBuffer>(_request_header);
+    _rri.requestHdrp = reinterpret_cast<TSMLoc>(_request_header->m_http);
 
-  rri.redirect = 0;
+    // Read-only URL's (TSMLoc's to the SDK)
+    _rri.mapFromUrl = reinterpret_cast<TSMLoc>(map_from->m_url_impl);
+    _rri.mapToUrl   = reinterpret_cast<TSMLoc>(map_to->m_url_impl);
+    _rri.requestUrl = reinterpret_cast<TSMLoc>(_request_url->m_url_impl);
 
-  // Prepare State for the future
-  if (_cur == 0) {
+    // Prepare State for the future
     _s->os_response_plugin_inst = plugin;
   }
 
-  plugin_retcode = plugin->doRemap(reinterpret_cast<TSHttpTxn>(_s->state_machine), &rri);
+  _rri.redirect  = 0;
+  _rri.thread_ih = plugin->threadInstance();
+
+  plugin_retcode = plugin->doRemap(reinterpret_cast<TSHttpTxn>(_s->state_machine), &_rri);
   // TODO: Deal with negative return codes here
   if (plugin_retcode < 0) {
     plugin_retcode = TSREMAP_NO_REMAP;
   }
 
   // First step after plugin remap must be "redirect url" check
-  if ((TSREMAP_DID_REMAP == plugin_retcode || TSREMAP_DID_REMAP_STOP == plugin_retcode) && rri.redirect) {
-    _s->remap_redirect = _request_url->string_get(nullptr);
+  if ((TSREMAP_DID_REMAP == plugin_retcode || TSREMAP_DID_REMAP_STOP == plugin_retcode) && _rri.redirect) {
+    _s->remap_redirect = _request_url->string_get(&_s->arena);
   }
 
   return plugin_retcode;
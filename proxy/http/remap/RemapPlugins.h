@@ -76,4 +76,5 @@ private:
   URL *_request_url        = nullptr;
   HTTPHdr *_request_header = nullptr;
   host_hdr_info *_hh_ptr   = nullptr;
+  TSRemapRequestInfo _rri;
 };
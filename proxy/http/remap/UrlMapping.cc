@@ -24,9 +24,17 @@
 
 #include "tscore/ink_defs.h"
 #include "UrlMapping.h"
+#include "CacheControl.h"
+#include "ControlMatcher.h"
+#include "ParentSelection.h"
 #include "records/I_RecCore.h"
 #include "tscore/ink_cap.h"
 
+url_mapping::url_mapping()
+  : cache_control_memo(new ControlMatcherMemo<CacheControlResult>), parent_memo(new ControlMatcherMemo<ParentResult>)
+{
+}
+
 /**
  *
  **/
@@ -78,6 +86,9 @@ url_mapping::~url_mapping()
     delete afr;
   }
 
+  delete cache_control_memo;
+  delete parent_memo;
+
   // Destroy the URLs
   fromURL.destroy();
   toURL.destroy();
@@ -35,6 +35,9 @@
 #include "tscore/List.h"
 
 class NextHopSelectionStrategy;
+class CacheControlResult;
+struct ParentResult;
+template <class Result> class ControlMatcherMemo;
 
 /**
  * Used to store http referer strings (and/or regexp)
@@ -81,6 +84,7 @@ public:
 class url_mapping
 {
 public:
+  url_mapping();
   ~url_mapping();
 
   bool add_plugin_instance(RemapPluginInst *i);
@@ -106,12 +110,15 @@ public:
   char *tag                          = nullptr; // tag
   char *filter_redirect_url          = nullptr; // redirect url when referer filtering enabled
   unsigned int map_id                = 0;
+  int prewarm_conns                  = 0; // idle connections kept open to the origin
   referer_info *referer_list         = nullptr;
   redirect_tag_str *redir_chunk_list = nullptr;
   bool ip_allow_check_enabled_p      = false;
   acl_filter_rule *filter            = nullptr; // acl filtering (list of rules)
   LINK(url_mapping, link);                      // For use with the main Queue linked list holding all the mapping
   std::shared_ptr<NextHopSelectionStrategy> strategy = nullptr;
+  ControlMatcherMemo<CacheControlResult> *cache_control_memo; // cache.config result of the requests of this rule
+  ControlMatcherMemo<ParentResult> *parent_memo;              // parent.config result
 
   int
   getRank() const
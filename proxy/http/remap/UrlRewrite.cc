@@ -553,6 +553,8 @@ UrlRewrite::_addToStore(MappingsStore &store, url_mapping *new_mapping, RegexMap
   new_mapping->setRank(count); // Use the mapping rules number count for rank
   if (is_cur_mapping_regex) {
     store.regex_list.enqueue(reg_map);
+    store.regex_rules.push_back(reg_map);
+    store.regex_prefilter.add(src_host);
     retval = true;
   } else {
     retval = TableInsert(store.hash_lookup, new_mapping, src_host);
@@ -602,6 +604,25 @@ UrlRewrite::InsertMapping(mapping_type maptype, url_mapping *new_mapping, RegexM
   return success;
 }
 
+void
+UrlRewrite::AddPreWarmOrigin(URL *to_url, int conns)
+{
+  int host_len     = 0;
+  const char *host = to_url->host_get(&host_len);
+  int port         = to_url->port_get();
+  int scheme       = to_url->scheme_get_wksidx();
+  bool tls         = scheme == URL_WKSIDX_HTTPS || scheme == URL_WKSIDX_WSS;
+
+  for (auto &origin : prewarm_origins) {
+    if (origin.port == port && origin.tls == tls && origin.host.size() == static_cast<size_t>(host_len) &&
+        strncasecmp(origin.host.data(), host, host_len) == 0) {
+      origin.conns = std::max(origin.conns, conns);
+      return;
+    }
+  }
+  prewarm_origins.push_back({std::string(host, host_len), port, tls, conns});
+}
+
 bool
 UrlRewrite::InsertForwardMapping(mapping_type maptype, url_mapping *mapping, const char *src_host)
 {
@@ -661,6 +682,12 @@ UrlRewrite::BuildTable(const char *path)
     return 3;
   }
 
+  // Index the regex mappings, now that all of them are known.
+  for (MappingsStore *store :
+       {&forward_mappings, &reverse_mappings, &permanent_redirects, &temporary_redirects, &forward_mappings_with_recv_port}) {
+    store->regex_prefilter.build();
+  }
+
   // Destroy unused tables
   if (num_rules_forward == 0) {
     forward_mappings.hash_lookup.reset(nullptr);
@@ -759,7 +786,7 @@ UrlRewrite::_mappingLookup(MappingsStore &mappings, URL *request_url, int reques
     mapping_container.set(mapping);
     retval = true;
   }
-  if (_regexMappingLookup(mappings.regex_list, request_url, request_port, request_host_lower, request_host_len, rank_ceiling,
+  if (_regexMappingLookup(mappings, request_url, request_port, request_host_lower, request_host_len, rank_ceiling,
                           mapping_container)) {
     Debug("url_rewrite", "Using regex mapping with rank %d", (mapping_container.getMapping())->getRank());
     retval = true;
@@ -816,7 +843,7 @@ lOverFlow:
 }
 
 bool
-UrlRewrite::_regexMappingLookup(RegexMappingList &regex_mappings, URL *request_url, int request_port, const char *request_host,
+UrlRewrite::_regexMappingLookup(MappingsStore &mappings, URL *request_url, int request_port, const char *request_host,
                                 int request_host_len, int rank_ceiling, UrlMappingContainer &mapping_container)
 {
   bool retval = false;
@@ -841,19 +868,19 @@ UrlRewrite::_regexMappingLookup(RegexMappingList &regex_mappings, URL *request_u
     request_scheme_len = hdrtoken_wks_to_length(request_scheme);
   }
 
-  // Loop over the entire linked list, or until we're satisfied
-  forl_LL(RegexMapping, list_iter, regex_mappings)
-  {
-    int reg_map_rank = list_iter->url_map->getRank();
+  // Loop over the mappings the host may match, in rank order, or until we're satisfied
+  mappings.regex_prefilter.candidates(std::string_view(request_host, request_host_len), [&](int rule) -> bool {
+    RegexMapping *list_iter = mappings.regex_rules[rule];
+    int reg_map_rank        = list_iter->url_map->getRank();
 
     if (reg_map_rank > rank_ceiling) {
-      break;
+      return false;
     }
 
     reg_map_scheme = list_iter->url_map->fromURL.scheme_get(&reg_map_scheme_len);
     if ((request_scheme_len != reg_map_scheme_len) || strncmp(request_scheme, reg_map_scheme, request_scheme_len)) {
       Debug("url_rewrite_regex", "Skipping regex with rank %d as scheme does not match request scheme", reg_map_rank);
-      continue;
+      return true;
     }
 
     if (list_iter->url_map->fromURL.port_get() != request_port) {
@@ -861,14 +888,14 @@ UrlRewrite::_regexMappingLookup(RegexMappingList &regex_mappings, URL *request_u
             "Skipping regex with rank %d as regex map port does not match request port. "
             "regex map port: %d, request port %d",
             reg_map_rank, list_iter->url_map->fromURL.port_get(), request_port);
-      continue;
+      return true;
     }
 
     reg_map_path = list_iter->url_map->fromURL.path_get(&reg_map_path_len);
     if ((request_path_len < reg_map_path_len) ||
         strncmp(reg_map_path, request_path, reg_map_path_len)) { // use the shorter path length here
       Debug("url_rewrite_regex", "Skipping regex with rank %d as path does not cover request path", reg_map_rank);
-      continue;
+      return true;
     }
 
     int matches_info[MAX_REGEX_SUBS * 3];
@@ -894,12 +921,13 @@ UrlRewrite::_regexMappingLookup(RegexMappingList &regex_mappings, URL *request_u
 
       Debug("url_rewrite_regex", "Expanded toURL to [%.*s]", expanded_url->length_get(), expanded_url->string_get_ref());
       retval = true;
-      break;
+      return false;
     } else {
       Debug("url_rewrite_regex", "Request URL host [%.*s] did NOT match regex in mapping of rank %d", request_host_len,
             request_host, reg_map_rank);
     }
-  }
+    return true;
+  });
 
   return retval;
 }
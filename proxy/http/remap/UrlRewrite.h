@@ -27,12 +27,15 @@
 #include "tscore/ink_config.h"
 #include "UrlMapping.h"
 #include "UrlMappingPathIndex.h"
+#include "RegexPrefilter.h"
 #include "HttpTransact.h"
 #include "tscore/Regex.h"
 #include "PluginFactory.h"
 #include "NextHopStrategyFactory.h"
 
 #include <memory>
+#include <string>
+#include <vector>
 
 #define URL_REMAP_FILTER_NONE 0x00000000
 #define URL_REMAP_FILTER_REFERER 0x00000001      /* enable "referer" header validation */
@@ -137,6 +140,9 @@ public:
   struct MappingsStore {
     std::unique_ptr<URLTable> hash_lookup;
     RegexMappingList regex_list;
+    /// The mappings of @a regex_list in rank order, numbered as in @a regex_prefilter.
+    std::vector<RegexMapping *> regex_rules;
+    RegexPrefilter regex_prefilter;
     bool
     empty()
     {
@@ -152,6 +158,8 @@ public:
   {
     _destroyTable(store.hash_lookup);
     _destroyList(store.regex_list);
+    store.regex_rules.clear();
+    store.regex_prefilter.clear();
   }
 
   bool InsertForwardMapping(mapping_type maptype, url_mapping *mapping, const char *src_host);
@@ -213,6 +221,18 @@ public:
   PluginFactory pluginFactory;
   NextHopStrategyFactory *strategyFactory = nullptr;
 
+  /// An origin named by rules with a @c prewarm option.
+  struct PreWarmOrigin {
+    std::string host;
+    int port  = 0;
+    bool tls  = false;
+    int conns = 0;
+  };
+  /// One entry per origin, rules to the same origin share the largest count any of them asked for.
+  std::vector<PreWarmOrigin> prewarm_origins;
+
+  void AddPreWarmOrigin(URL *to_url, int conns);
+
 private:
   bool _valid = false;
 
@@ -220,7 +240,7 @@ private:
                       UrlMappingContainer &mapping_container);
   url_mapping *_tableLookup(std::unique_ptr<URLTable> &h_table, URL *request_url, int request_port, char *request_host,
                             int request_host_len);
-  bool _regexMappingLookup(RegexMappingList &regex_mappings, URL *request_url, int request_port, const char *request_host,
+  bool _regexMappingLookup(MappingsStore &mappings, URL *request_url, int request_port, const char *request_host,
                            int request_host_len, int rank_ceiling, UrlMappingContainer &mapping_container);
   int _expandSubstitutions(int *matches_info, const RegexMapping *reg_map, const char *matched_string, char *dest_buf,
                            int dest_buf_size);
@@ -0,0 +1,160 @@
+/** @file
+
+  Throughput of finding the first remap host regular expression a host matches.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  @section details Details
+
+  Usage: benchmark_RemapRegex [-r rules] [-u unfiltered] [-n iterations] [-j]
+
+  Makes @a rules host patterns like the regex_map rules of a large remap.config, @a unfiltered of them
+  without a literal to filter on, and looks up hosts that match rules throughout the list and hosts
+  that match none. The lookups are done as @c UrlRewrite did before, running every rule in
+  order, and with the @c RegexPrefilter, and must find the same rules. With -j the results are JSON
+  lines, for `make bench`.
+ */
+
+#include "RegexPrefilter.h"
+#include "tscore/ink_hrtime.h"
+#include "tscore/Regex.h"
+#include "bench_report.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+namespace
+{
+template <typename F>
+double
+time_hosts(std::vector<std::string> const &hosts, int iterations, long &found, F &&lookup)
+{
+  found          = 0;
+  ink_hrtime now = ink_get_hrtime_internal();
+  for (int i = 0; i < iterations; ++i) {
+    for (auto const &host : hosts) {
+      found += lookup(host);
+    }
+  }
+  return static_cast<double>(ink_get_hrtime_internal() - now) / HRTIME_SECOND;
+}
+} // namespace
+
+int
+main(int argc, char *argv[])
+{
+  int n_rules      = 10000;
+  int n_unfiltered = 10;
+  int iterations   = 10;
+  bool json        = false;
+  int opt;
+  while ((opt = getopt(argc, argv, "r:u:n:j")) != -1) {
+    if (opt == 'r') {
+      n_rules = atoi(optarg);
+    } else if (opt == 'u') {
+      n_unfiltered = atoi(optarg);
+    } else if (opt == 'n') {
+      iterations = atoi(optarg);
+    } else if (opt == 'j') {
+      json = true;
+    } else {
+      fprintf(stderr, "usage: %s [-r rules] [-u unfiltered] [-n iterations] [-j]\n", argv[0]);
+      return 1;
+    }
+  }
+  if (n_rules <= 0 || n_unfiltered < 0 || iterations <= 0) {
+    fprintf(stderr, "%s: the counts must be positive\n", argv[0]);
+    return 1;
+  }
+
+  RegexPrefilter prefilter;
+  std::vector<std::unique_ptr<Regex>> regexes;
+  std::vector<std::string> hosts;
+  char text[256];
+  for (int i = 0; i < n_rules; ++i) {
+    if (i < n_unfiltered) {
+      snprintf(text, sizeof(text), "(.*)\\.unfiltered%d\\.example\\.org", i);
+    } else if (i % 2) {
+      snprintf(text, sizeof(text), "^(.*)\\.site%d\\.example\\.com$", i);
+    } else {
+      snprintf(text, sizeof(text), "^cdn%d-(.*)\\.example\\.net$", i);
+    }
+    prefilter.add(text);
+    regexes.emplace_back(std::make_unique<Regex>());
+    if (!regexes.back()->compile(text)) {
+      fprintf(stderr, "%s: failed to compile %s\n", argv[0], text);
+      return 1;
+    }
+  }
+  prefilter.build();
+  for (int i = 0; i < 10; ++i) {
+    int rule = n_rules / 10 * i + n_rules / 20;
+    snprintf(text, sizeof(text), rule % 2 ? "www.site%d.example.com" : "cdn%d-img.example.net", rule);
+    hosts.emplace_back(text);
+  }
+  hosts.emplace_back("www.nowhere.example.com");
+  hosts.emplace_back("www.example.net");
+
+  auto linear = [&regexes](std::string const &host) -> int {
+    for (size_t rule = 0; rule < regexes.size(); ++rule) {
+      if (regexes[rule]->exec(host)) {
+        return rule;
+      }
+    }
+    return -1;
+  };
+  auto filtered = [&regexes, &prefilter](std::string const &host) -> int {
+    int found = -1;
+    prefilter.candidates(host, [&](int rule) {
+      if (regexes[rule]->exec(host)) {
+        found = rule;
+        return false;
+      }
+      return true;
+    });
+    return found;
+  };
+
+  for (auto const &host : hosts) {
+    if (linear(host) != filtered(host)) {
+      fprintf(stderr, "%s: the lookups found different rules for %s\n", argv[0], host.c_str());
+      return 1;
+    }
+  }
+
+  long linear_found = 0, filtered_found = 0;
+  double linear_seconds   = time_hosts(hosts, iterations, linear_found, linear);
+  double filtered_seconds = time_hosts(hosts, iterations, filtered_found, filtered);
+
+  double lookups = static_cast<double>(hosts.size()) * iterations;
+  if (json) {
+    bench_report(true, "remap_regex_linear", static_cast<int64_t>(lookups), linear_seconds);
+    bench_report(true, "remap_regex_prefilter", static_cast<int64_t>(lookups), filtered_seconds);
+    return 0;
+  }
+  printf("%d rules, %zu hosts, %d iterations: linear %.3f s, %.1f us/lookup\n", n_rules, hosts.size(), iterations, linear_seconds,
+         linear_seconds / lookups * 1e6);
+  printf("%d rules, %zu hosts, %d iterations: prefilter %.3f s, %.3f us/lookup\n", n_rules, hosts.size(), iterations,
+         filtered_seconds, filtered_seconds / lookups * 1e6);
+  return 0;
+}
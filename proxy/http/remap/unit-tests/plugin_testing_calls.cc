@@ -90,6 +90,22 @@ TSRemapDeleteInstance(void *ih)
   debugObject.ih = ih;
 }
 
+void *
+TSRemapNewThreadInstance(void *ih)
+{
+  debugObject.initThreadInstCalled++;
+  debugObject.ih = ih;
+  return debugObject.input_ih;
+}
+
+void
+TSRemapDeleteThreadInstance(void *ih, void *thread_ih)
+{
+  debugObject.deleteThreadInstCalled++;
+  debugObject.ih        = ih;
+  debugObject.thread_ih = thread_ih;
+}
+
 TSRemapStatus
 TSRemapDoRemap(void *ih, TSHttpTxn rh, TSRemapRequestInfo *rri)
 {
@@ -58,10 +58,13 @@ public:
     doneCalled             = 0;
     initInstanceCalled     = 0;
     deleteInstanceCalled   = 0;
+    initThreadInstCalled   = 0;
+    deleteThreadInstCalled = 0;
     preReloadConfigCalled  = 0;
     postReloadConfigCalled = 0;
     postReloadConfigStatus = TSREMAP_CONFIG_RELOAD_FAILURE;
     ih                     = nullptr;
+    thread_ih              = nullptr;
     argc                   = 0;
     argv                   = nullptr;
   }
@@ -78,10 +81,13 @@ public:
   int doneCalled                                 = 0;                         /* mark if done was called */
   int initInstanceCalled                         = 0;                         /* mark if instance init was called */
   int deleteInstanceCalled                       = 0;                         /* mark if delete instance was called */
+  int initThreadInstCalled                       = 0;                         /* mark if thread instance init was called */
+  int deleteThreadInstCalled                     = 0;                         /* mark if delete thread instance was called */
   int preReloadConfigCalled                      = 0;                         /* mark if pre-reload config was called */
   int postReloadConfigCalled                     = 0;                         /* mark if post-reload config was called */
   TSRemapReloadStatus postReloadConfigStatus = TSREMAP_CONFIG_RELOAD_FAILURE; /* mark if plugin reload status is passed correctly */
   void *ih                                   = nullptr;                       /* instance handler */
+  void *thread_ih                            = nullptr;                       /* thread instance handler */
   int argc                                   = 0;       /* number of plugin instance parameters received by the plugin */
   char **argv                                = nullptr; /* plugin instance parameters received by the plugin */
 };
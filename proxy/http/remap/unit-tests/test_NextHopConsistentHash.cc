@@ -620,3 +620,89 @@ SCENARIO("Testing NextHopConsistentHash class (alternating rings), using policy
     }
   }
 }
+
+SCENARIO("Testing NextHopConsistentHash class (peering ring), using policy 'consistent_hash'", "[NextHopConsistentHash]")
+{
+  // We need this to build a HdrHeap object in build_request();
+  // No thread setup, forbid use of thread local allocators.
+  cmd_disable_pfreelist = true;
+  // Get all of the HTTP WKS items populated.
+  http_init();
+
+  GIVEN("Loading the consistent-hash-tests.yaml config for 'consistent_hash' tests.")
+  {
+    std::shared_ptr<NextHopSelectionStrategy> strategy;
+    NextHopStrategyFactory nhf(TS_SRC_DIR "unit-tests/consistent-hash-tests.yaml");
+    strategy = nhf.strategyInstance("peering");
+
+    WHEN("the config is loaded.")
+    {
+      THEN("then testing consistent hash.")
+      {
+        REQUIRE(nhf.strategies_loaded == true);
+        REQUIRE(strategy != nullptr);
+        REQUIRE(strategy->groups == 2);
+        REQUIRE(strategy->ring_mode == NH_PEERING_RING);
+        REQUIRE(strategy->peering_timeout == 250);
+      }
+    }
+
+    WHEN("requests miss the cache and the peers are asked first.")
+    {
+      HttpSM sm;
+      ParentResult *result = &sm.t_state.parent_result;
+      TSHttpTxn txnp       = reinterpret_cast<TSHttpTxn>(&sm);
+
+      THEN("the peer owning the key is asked, then the upstreams.")
+      {
+        REQUIRE(nhf.strategies_loaded == true);
+        REQUIRE(strategy != nullptr);
+
+        // a cache miss goes to the peer first.
+        build_request(40001, &sm, nullptr, "bunny.net/asset1", nullptr);
+        sm.t_state.method              = HTTP_WKSIDX_GET;
+        sm.t_state.cache_lookup_result = HttpTransact::CACHE_LOOKUP_MISS;
+        result->reset();
+        strategy->findNextHop(txnp);
+        CHECK(result->result == ParentResultType::PARENT_SPECIFIED);
+        CHECK(result->peer == true);
+        REQUIRE(result->hostname != nullptr);
+        std::string peer = result->hostname;
+        CHECK(peer.rfind("peer", 0) == 0);
+
+        // the peer missed too, the retry goes upstream and not to another peer.
+        strategy->findNextHop(txnp);
+        CHECK(result->result == ParentResultType::PARENT_SPECIFIED);
+        CHECK(result->peer == false);
+        REQUIRE(result->hostname != nullptr);
+        std::string upstream = result->hostname;
+        CHECK(upstream.rfind("up", 0) == 0);
+
+        // the same key always goes to the same peer.
+        result->reset();
+        strategy->findNextHop(txnp);
+        CHECK(result->peer == true);
+        CHECK(peer == result->hostname);
+
+        // with the peer down, straight upstream.
+        strategy->markNextHop(txnp, result->hostname, result->port, NH_MARK_DOWN);
+        result->reset();
+        strategy->findNextHop(txnp);
+        CHECK(result->result == ParentResultType::PARENT_SPECIFIED);
+        CHECK(result->peer == false);
+        CHECK(upstream == result->hostname);
+
+        // what would not be a cache miss is not asked of a peer.
+        build_request(40002, &sm, nullptr, "bunny.net/asset2", nullptr);
+        sm.t_state.cache_lookup_result = HttpTransact::CACHE_LOOKUP_NONE;
+        result->reset();
+        strategy->findNextHop(txnp);
+        CHECK(result->result == ParentResultType::PARENT_SPECIFIED);
+        CHECK(result->peer == false);
+        CHECK(std::string(result->hostname).rfind("up", 0) == 0);
+      }
+      // free up request resources.
+      br_destroy(sm);
+    }
+  }
+}
@@ -0,0 +1,126 @@
+/** @file
+
+  Unit tests for the NextHopLeastLoaded.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  @section details Details
+
+  Unit testing the NextHopLeastLoaded class.
+
+ */
+
+#define CATCH_CONFIG_MAIN /* include main function */
+
+#include <catch.hpp> /* catch unit-test framework */
+#include <yaml-cpp/yaml.h>
+
+#include "HttpSM.h"
+#include "nexthop_test_stubs.h"
+#include "NextHopSelectionStrategy.h"
+#include "NextHopStrategyFactory.h"
+#include "NextHopLeastLoaded.h"
+
+SCENARIO("Testing NextHopLeastLoaded class, using policy 'least_loaded'", "[NextHopLeastLoaded]")
+{
+  // We need this to build a HdrHeap object in build_request();
+  // No thread setup, forbid use of thread local allocators.
+  cmd_disable_pfreelist = true;
+  // Get all of the HTTP WKS items populated.
+  http_init();
+
+  GIVEN("Loading the least-loaded-tests.yaml config for 'least_loaded' tests.")
+  {
+    std::shared_ptr<NextHopSelectionStrategy> strategy;
+    NextHopStrategyFactory nhf(TS_SRC_DIR "unit-tests/least-loaded-tests.yaml");
+    strategy = nhf.strategyInstance("least-loaded");
+
+    WHEN("the config is loaded.")
+    {
+      THEN("the least_loaded strategy is ready for use.")
+      {
+        REQUIRE(nhf.strategies_loaded == true);
+        REQUIRE(strategy != nullptr);
+        REQUIRE(strategy->policy_type == NH_LEAST_LOADED);
+      }
+    }
+
+    WHEN("making requests using a 'least_loaded' policy.")
+    {
+      HttpSM sm1, sm2;
+      ParentResult *result1 = &sm1.t_state.parent_result;
+      ParentResult *result2 = &sm2.t_state.parent_result;
+      TSHttpTxn txnp1       = reinterpret_cast<TSHttpTxn>(&sm1);
+      TSHttpTxn txnp2       = reinterpret_cast<TSHttpTxn>(&sm2);
+
+      THEN("then testing least_loaded.")
+      {
+        REQUIRE(nhf.strategies_loaded == true);
+        REQUIRE(strategy != nullptr);
+
+        // the second request in flight goes to the other primary.
+        build_request(10001, &sm1, nullptr, "rabbit.net", nullptr);
+        strategy->findNextHop(txnp1);
+        REQUIRE(result1->result == PARENT_SPECIFIED);
+        build_request(10002, &sm2, nullptr, "rabbit.net", nullptr);
+        strategy->findNextHop(txnp2);
+        REQUIRE(result2->result == PARENT_SPECIFIED);
+        CHECK(strncmp(result1->hostname, "p", 1) == 0);
+        CHECK(strncmp(result2->hostname, "p", 1) == 0);
+        CHECK(strcmp(result1->hostname, result2->hostname) != 0);
+
+        // the first one answers slowly, the second one quickly.
+        std::string slow = result1->hostname;
+        std::string fast = result2->hostname;
+        strategy->onParentResponse(txnp1, HRTIME_MSECONDS(500));
+        strategy->onParentResponse(txnp2, HRTIME_MSECONDS(10));
+        result1->reset();
+        result2->reset();
+
+        // with nothing in flight the faster one wins, and keeps winning with one in flight.
+        build_request(10003, &sm1, nullptr, "rabbit.net", nullptr);
+        strategy->findNextHop(txnp1);
+        CHECK(fast == result1->hostname);
+        build_request(10004, &sm2, nullptr, "rabbit.net", nullptr);
+        strategy->findNextHop(txnp2);
+        CHECK(fast == result2->hostname);
+        result2->reset();
+
+        // mark down the fast one, the slow one is left.
+        strategy->markNextHop(txnp1, result1->hostname, result1->port, NH_MARK_DOWN);
+        strategy->findNextHop(txnp1);
+        CHECK(slow == result1->hostname);
+        result1->reset();
+        build_request(10005, &sm1, nullptr, "rabbit.net", nullptr);
+        strategy->findNextHop(txnp1);
+        CHECK(slow == result1->hostname);
+
+        // mark down the slow one too, the secondary group is used.
+        strategy->markNextHop(txnp1, result1->hostname, result1->port, NH_MARK_DOWN);
+        strategy->findNextHop(txnp1);
+        CHECK(strncmp(result1->hostname, "s", 1) == 0);
+        result1->reset();
+        build_request(10006, &sm1, nullptr, "rabbit.net", nullptr);
+        strategy->findNextHop(txnp1);
+        CHECK(strncmp(result1->hostname, "s", 1) == 0);
+        result1->reset();
+      }
+    }
+  }
+}
@@ -30,6 +30,9 @@
 #include <catch.hpp>      /* catch unit-test framework */
 #include <fstream>        /* ofstream */
 #include <memory>
+#include <thread>
+#include <netinet/in.h>
+#include <unistd.h>
 #include <utime.h>
 #include <yaml-cpp/yaml.h>
 
@@ -38,6 +41,7 @@
 #include "NextHopStrategyFactory.h"
 #include "NextHopConsistentHash.h"
 #include "NextHopRoundRobin.h"
+#include "NextHopHealthCheck.h"
 
 SCENARIO("factory tests loading yaml configs", "[loadConfig]")
 {
@@ -954,3 +958,99 @@ SCENARIO("factory tests loading yaml configs from a directory", "[loadConfig]")
     }
   }
 }
+
+SCENARIO("factory tests loading yaml configs with active health checks", "[loadConfig]")
+{
+  GIVEN("loading the health-check-tests.yaml config")
+  {
+    std::shared_ptr<NextHopSelectionStrategy> strategy;
+    NextHopStrategyFactory nhf(TS_SRC_DIR "unit-tests/health-check-tests.yaml");
+
+    WHEN("the config is loaded.")
+    {
+      THEN("the health checks are set for each group.")
+      {
+        REQUIRE(nhf.strategies_loaded == true);
+        strategy = nhf.strategyInstance("health-checked");
+        REQUIRE(strategy != nullptr);
+        CHECK(strategy->health_checks.active == true);
+        REQUIRE(strategy->active_checks.size() == 2);
+        CHECK(strategy->active_checks[0].type == NH_CHECK_HTTP);
+        CHECK(strategy->active_checks[0].interval == 10);
+        CHECK(strategy->active_checks[0].jitter == 2);
+        CHECK(strategy->active_checks[0].timeout == 500);
+        CHECK(strategy->active_checks[0].fall == 3);
+        CHECK(strategy->active_checks[0].rise == 1);
+        CHECK(strategy->active_checks[1].type == NH_CHECK_NONE);
+
+        NextHopHealthCheck::Target target;
+        REQUIRE(NextHopHealthCheck::makeTarget(*strategy->host_groups[0][0], NH_SCHEME_HTTP, NH_CHECK_HTTP, target));
+        CHECK(target.address == "192.168.1.1");
+        CHECK(target.port == "80");
+        CHECK(target.request.find("GET / HTTP/1.1\r\nHost: p1.foo.com\r\n") == 0);
+        REQUIRE(NextHopHealthCheck::makeTarget(*strategy->host_groups[0][0], NH_SCHEME_HTTPS, NH_CHECK_HTTP, target));
+        CHECK(target.address == "p1.foo.com");
+        CHECK(target.port == "443");
+        CHECK(target.request.empty());
+      }
+    }
+  }
+}
+
+SCENARIO("probing hosts with active health checks", "[healthCheck]")
+{
+  GIVEN("a listening server and a closed port")
+  {
+    struct sockaddr_in addr;
+    socklen_t len = sizeof(addr);
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family      = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    int listener = socket(AF_INET, SOCK_STREAM, 0);
+    REQUIRE(bind(listener, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) == 0);
+    REQUIRE(listen(listener, 8) == 0);
+    REQUIRE(getsockname(listener, reinterpret_cast<sockaddr *>(&addr), &len) == 0);
+    std::string open_port = std::to_string(ntohs(addr.sin_port));
+
+    int closed = socket(AF_INET, SOCK_STREAM, 0);
+    addr.sin_port = 0;
+    REQUIRE(bind(closed, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) == 0);
+    REQUIRE(getsockname(closed, reinterpret_cast<sockaddr *>(&addr), &len) == 0);
+    std::string closed_port = std::to_string(ntohs(addr.sin_port));
+    close(closed);
+
+    // answers the one http check.
+    std::thread server([listener]() {
+      int fd = accept(listener, nullptr, nullptr);
+      char buf[1024];
+      if (fd >= 0 && read(fd, buf, sizeof(buf)) > 0) {
+        const char response[] = "HTTP/1.1 204 No Content\r\n\r\n";
+        CHECK(write(fd, response, sizeof(response) - 1) > 0);
+      }
+      close(fd);
+    });
+
+    WHEN("the hosts are probed")
+    {
+      std::vector<NextHopHealthCheck::Target> targets(3);
+      targets[0].address = targets[1].address = targets[2].address = "127.0.0.1";
+      targets[0].port                                              = open_port;
+      targets[0].request = "GET /health HTTP/1.1\r\nHost: localhost\r\nConnection: close\r\n\r\n";
+      targets[1].port    = closed_port;
+      targets[2].port    = open_port;
+
+      std::vector<bool> passed = NextHopHealthCheck::probe(targets, 2000);
+      server.join();
+
+      THEN("the open ones pass and the closed one fails")
+      {
+        REQUIRE(passed.size() == 3);
+        CHECK(passed[0] == true);
+        CHECK(passed[1] == false);
+        CHECK(passed[2] == true);
+      }
+    }
+    close(listener);
+  }
+}
@@ -1426,4 +1426,58 @@ SCENARIO("notifying plugins of config reload", "[plugin][core]")
       clean();
     }
   }
+
+  GIVEN("configuration with 1 plugin loaded by 2 factories, the 2nd one reusing the instances of the 1st")
+  {
+    WHEN("the 2nd factory instantiates the plugin with the same and with different parameters")
+    {
+      setupConfigPathTest(configName1, buildPath, uuid_t1, effectivePath1, runtimePath1, 1556825556);
+      PluginFactoryUnitTest *factory1 = getFactory(uuid_t1);
+      PluginFactoryUnitTest *factory2 = getFactory(uuid_t2);
+
+      char param1[] = "param1";
+      char param2[] = "param2";
+      char *argv1[] = {param1};
+      char *argv2[] = {param2};
+
+      RemapPluginInst *pluginInst1 = factory1->getRemapPlugin(configName1, 1, argv1, error, isPluginDynamicReloadEnabled());
+      RemapPluginInst *pluginInst2 = factory1->getRemapPlugin(configName1, 1, argv2, error, isPluginDynamicReloadEnabled());
+      PluginDebugObject *debugObject = getDebugObject(pluginInst1->_plugin);
+      debugObject->clear();
+
+      factory2->reuseInstancesFrom(factory1);
+      RemapPluginInst *pluginInst3 = factory2->getRemapPlugin(configName1, 1, argv1, error, isPluginDynamicReloadEnabled());
+      RemapPluginInst *pluginInst4 = factory2->getRemapPlugin(configName1, 1, argv1, error, isPluginDynamicReloadEnabled());
+      RemapPluginInst *pluginInst5 = factory2->getRemapPlugin(configName1, 0, nullptr, error, isPluginDynamicReloadEnabled());
+      factory2->reuseInstancesFrom(nullptr);
+
+      THEN("expect only the instance with the same parameters to be reused, and done when neither factory uses it")
+      {
+        CHECK(pluginInst3 == pluginInst1);
+        CHECK(pluginInst4 != pluginInst1);
+        CHECK(pluginInst5 != pluginInst1);
+        CHECK(pluginInst5 != pluginInst2);
+        CHECK(2 == debugObject->initInstanceCalled);
+
+        debugObject->clear();
+        factory2->indicatePostReload(/* reload succeeded */ true);
+        CHECK(TSREMAP_CONFIG_RELOAD_SUCCESS_PLUGIN_USED == debugObject->postReloadConfigStatus);
+
+        /* The 1st configuration goes away, only the instance the 2nd one does not use is done */
+        debugObject->clear();
+        factory1->deactivate();
+        delete factory1;
+        CHECK(1 == debugObject->deleteInstanceCalled);
+        CHECK(0 == debugObject->doneCalled);
+
+        debugObject->clear();
+        factory2->deactivate();
+        CHECK(3 == debugObject->deleteInstanceCalled);
+        CHECK(1 == debugObject->doneCalled);
+        delete factory2;
+      }
+
+      clean();
+    }
+  }
 }
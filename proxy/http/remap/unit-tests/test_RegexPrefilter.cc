@@ -0,0 +1,120 @@
+/** @file
+
+  Unit tests for the literal prefilter of remap host regular expressions.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#define CATCH_CONFIG_MAIN /* include main function */
+
+#include <catch.hpp> /* catch unit-test framework */
+
+#include "RegexPrefilter.h"
+#include "tscore/Regex.h"
+
+#include <memory>
+
+TEST_CASE("RegexPrefilter literals", "[remap][RegexPrefilter]")
+{
+  CHECK(RegexPrefilter::literal_suffix("^(.*)\\.example\\.com$") == ".example.com");
+  CHECK(RegexPrefilter::literal_prefix("^(.*)\\.example\\.com$") == "");
+  CHECK(RegexPrefilter::literal_prefix("^cdn-(.*)\\.example\\.net$") == "cdn-");
+  CHECK(RegexPrefilter::literal_suffix("^cdn-(.*)\\.example\\.net$") == ".example.net");
+  CHECK(RegexPrefilter::literal_prefix("^www\\.foo\\.com$") == "www.foo.com");
+  CHECK(RegexPrefilter::literal_suffix("^www\\.foo\\.com$") == "www.foo.com");
+
+  // Optional characters, classes, alternation and options end or prevent the literal.
+  CHECK(RegexPrefilter::literal_prefix("^abc?d") == "ab");
+  CHECK(RegexPrefilter::literal_prefix("^ab+c") == "ab");
+  CHECK(RegexPrefilter::literal_prefix("^ab{2}c") == "a");
+  CHECK(RegexPrefilter::literal_prefix("^a\\dc") == "a");
+  CHECK(RegexPrefilter::literal_suffix("a\\d\\.com$") == ".com");
+  CHECK(RegexPrefilter::literal_suffix("(a|b)\\.com$") == "");
+  CHECK(RegexPrefilter::literal_suffix("(?x)a b\\.com$") == "");
+  CHECK(RegexPrefilter::literal_suffix("com\\$") == "");
+  CHECK(RegexPrefilter::literal_suffix("a\\\\$") == "a\\");
+  CHECK(RegexPrefilter::literal_suffix("[a-z]+$") == "");
+  CHECK(RegexPrefilter::literal_prefix("example\\.com") == "");
+  CHECK(RegexPrefilter::literal_suffix("example\\.com") == "");
+}
+
+TEST_CASE("RegexPrefilter candidates", "[remap][RegexPrefilter]")
+{
+  const char *patterns[] = {
+    "^(.*)\\.example\\.com$", "^cdn-(.*)\\.example\\.net$", "(.*)\\.example\\.org", "^www\\.example\\.com$",
+    "^(.*)\\.b\\.example\\.com$", "^img[0-9]+\\.example\\.net$", "^cdn-[a-z]+\\.example\\.net$", "^(.*)$",
+  };
+  const char *hosts[] = {
+    "www.example.com", "a.b.example.com", "cdn-x.example.net", "img7.example.net", "cdn-.example.net", "example.com",
+    "x.example.org.uk", "", "other.net",
+  };
+
+  RegexPrefilter prefilter;
+  std::vector<std::unique_ptr<Regex>> regexes;
+  for (auto pattern : patterns) {
+    prefilter.add(pattern);
+    regexes.emplace_back(std::make_unique<Regex>());
+    REQUIRE(regexes.back()->compile(pattern));
+  }
+  REQUIRE(prefilter.size() == countof(patterns));
+
+  std::vector<int> candidates;
+  prefilter.candidates("a.b.example.com", [&](int rule) {
+    candidates.push_back(rule);
+    return true;
+  });
+  CHECK(candidates == std::vector<int>{0, 2, 4, 7});
+  prefilter.build();
+
+  // Every rule that matches is a candidate, in rule order.
+  for (auto host : hosts) {
+    std::vector<int> matches;
+    candidates.clear();
+    prefilter.candidates(host, [&](int rule) {
+      candidates.push_back(rule);
+      return true;
+    });
+    for (unsigned rule = 0; rule < countof(patterns); ++rule) {
+      if (regexes[rule]->exec(host)) {
+        matches.push_back(rule);
+      }
+    }
+    INFO(host);
+    CHECK(std::is_sorted(candidates.begin(), candidates.end()));
+    CHECK(std::includes(candidates.begin(), candidates.end(), matches.begin(), matches.end()));
+  }
+
+  candidates.clear();
+  prefilter.candidates("a.b.example.com", [&](int rule) {
+    candidates.push_back(rule);
+    return true;
+  });
+  CHECK(candidates == std::vector<int>{0, 2, 4, 7});
+
+  // The lookup stops when told to.
+  candidates.clear();
+  prefilter.candidates("a.b.example.com", [&](int rule) {
+    candidates.push_back(rule);
+    return rule < 2;
+  });
+  CHECK(candidates == std::vector<int>{0, 2});
+
+  prefilter.clear();
+  CHECK(prefilter.size() == 0);
+}
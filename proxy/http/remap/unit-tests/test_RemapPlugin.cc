@@ -357,6 +357,60 @@ SCENARIO("invoking plugin instance init", "[plugin][core]")
   }
 }
 
+SCENARIO("invoking plugin thread instances", "[plugin][core]")
+{
+  REQUIRE_FALSE(sandboxDir.empty());
+
+  std::string error;
+  PluginDebugObject *debugObject = nullptr;
+  void *THREAD_HANDLER           = reinterpret_cast<void *>(987);
+
+  GIVEN("thread instance init and delete functions")
+  {
+    fs::path pluginConfigPath   = fs::path("plugin_testing_calls.so");
+    RemapPluginUnitTest *plugin = setupSandBox(pluginConfigPath);
+
+    bool result = loadPlugin(plugin, error, debugObject);
+    CHECK(true == result);
+
+    WHEN("a thread instance is created and deleted")
+    {
+      debugObject->clear();
+      debugObject->input_ih = THREAD_HANDLER; /* this is what the thread instance init will return */
+
+      void *thread_ih = plugin->initThreadInstance(INSTANCE_HANDLER);
+      plugin->doneThreadInstance(INSTANCE_HANDLER, thread_ih);
+
+      THEN("expect both to run with the instance handler and the thread instance handler")
+      {
+        CHECK(1 == debugObject->initThreadInstCalled);
+        CHECK(1 == debugObject->deleteThreadInstCalled);
+        CHECK(THREAD_HANDLER == thread_ih);
+        CHECK(INSTANCE_HANDLER == debugObject->ih);
+        CHECK(THREAD_HANDLER == debugObject->thread_ih);
+      }
+      cleanupSandBox(plugin);
+    }
+  }
+
+  GIVEN("a plugin without thread instances")
+  {
+    fs::path pluginConfigPath   = fs::path("plugin_required_cb.so");
+    RemapPluginUnitTest *plugin = setupSandBox(pluginConfigPath);
+
+    bool result = loadPlugin(plugin, error, debugObject);
+    CHECK(true == result);
+
+    WHEN("a thread instance is asked for")
+    {
+      void *thread_ih = plugin->initThreadInstance(INSTANCE_HANDLER);
+
+      THEN("expect no thread instance") { CHECK(nullptr == thread_ih); }
+      cleanupSandBox(plugin);
+    }
+  }
+}
+
 SCENARIO("unloading the plugin", "[plugin][core]")
 {
   REQUIRE_FALSE(sandboxDir.empty());
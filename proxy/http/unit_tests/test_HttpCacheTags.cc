@@ -0,0 +1,81 @@
+/** @file
+
+  Unit tests for the invalidation of cached objects by surrogate key.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "catch.hpp"
+
+#include "HttpCacheTags.h"
+
+#include <string>
+#include <vector>
+
+TEST_CASE("CacheTagsSplit", "[http][cache_tags]")
+{
+  std::string_view tags{"  product-42 catalog,\tfront ,, "};
+  std::vector<std::string> found;
+
+  for (std::string_view tag = HttpCacheTags::next_tag(tags); !tag.empty(); tag = HttpCacheTags::next_tag(tags)) {
+    found.emplace_back(tag);
+  }
+  CHECK(found == std::vector<std::string>{"product-42", "catalog", "front"});
+
+  tags = " ,";
+  CHECK(HttpCacheTags::next_tag(tags).empty());
+}
+
+TEST_CASE("CacheTagsInvalidate", "[http][cache_tags]")
+{
+  HttpCacheTags tags;
+
+  CHECK(!tags.is_invalidated("a b", 100));
+
+  tags.invalidate("b", 200, 8);
+  CHECK(tags.is_invalidated("a b", 100));
+  CHECK(tags.is_invalidated("b", 200));
+  CHECK(!tags.is_invalidated("b", 201));
+  CHECK(!tags.is_invalidated("a c", 100));
+  CHECK(!tags.is_invalidated("", 100));
+
+  // A later invalidation of the same tag wins.
+  tags.invalidate("b", 300, 8);
+  CHECK(tags.is_invalidated("b", 250));
+  CHECK(tags.size() == 1);
+}
+
+TEST_CASE("CacheTagsCapacity", "[http][cache_tags]")
+{
+  HttpCacheTags tags;
+
+  tags.invalidate("a", 100, 2);
+  tags.invalidate("b", 200, 2);
+  tags.invalidate("a", 300, 2); // The first invalidation of a is outdated, dropping it keeps a.
+  CHECK(tags.size() == 2);
+  CHECK(!tags.is_invalidated("c", 50));
+
+  tags.invalidate("c", 400, 2); // Drops b, so every tagged object up to 200 is invalidated.
+  CHECK(tags.size() == 2);
+  CHECK(tags.is_invalidated("d", 150));
+  CHECK(!tags.is_invalidated("d", 250));
+  CHECK(tags.is_invalidated("a", 250));
+  CHECK(tags.is_invalidated("c", 350));
+  CHECK(!tags.is_invalidated("", 150));
+}
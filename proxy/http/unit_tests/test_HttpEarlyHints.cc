@@ -0,0 +1,112 @@
+/** @file
+
+  Unit tests for the preload links kept for 103 Early Hints.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "catch.hpp"
+
+#include "HTTP.h"
+#include "HttpEarlyHints.h"
+
+#include <string>
+
+extern int cmd_disable_pfreelist;
+
+namespace
+{
+void
+parse_response(HTTPHdr &hdr, const char *text)
+{
+  cmd_disable_pfreelist = true;
+  http_init();
+
+  HTTPParser parser;
+  http_parser_init(&parser);
+  hdr.create(HTTP_TYPE_RESPONSE);
+  const char *start = text;
+  REQUIRE(hdr.parse_resp(&parser, &start, text + strlen(text), true) == PARSE_RESULT_DONE);
+  http_parser_clear(&parser);
+}
+} // namespace
+
+TEST_CASE("EarlyHintsLinks", "[http][early_hints]")
+{
+  HTTPHdr hdr;
+  parse_response(hdr, "HTTP/1.1 200 OK\r\n"
+                      "Link: </style.css>; rel=preload; as=style, </next.html>; rel=prefetch\r\n"
+                      "Link: </a,b.js>; rel=\"preload modulepreload\"; as=script\r\n"
+                      "Link: </font.woff2>; REL=Preload; as=font; crossorigin\r\n"
+                      "Link: <https://example.com/>; rel=preconnect\r\n"
+                      "\r\n");
+
+  std::string links;
+  CHECK(HttpEarlyHints::preload_links(&hdr, links));
+  CHECK(links == "</style.css>; rel=preload; as=style, </a,b.js>; rel=\"preload modulepreload\"; as=script, "
+                 "</font.woff2>; REL=Preload; as=font; crossorigin");
+  CHECK(HttpEarlyHints::response("</style.css>; rel=preload") ==
+        "HTTP/1.1 103 Early Hints\r\nLink: </style.css>; rel=preload\r\n\r\n");
+  hdr.destroy();
+
+  parse_response(hdr, "HTTP/1.1 200 OK\r\n"
+                      "Link: </next.html>; rel=prefetch\r\n"
+                      "\r\n");
+  links.clear();
+  CHECK_FALSE(HttpEarlyHints::preload_links(&hdr, links));
+  CHECK(links.empty());
+  hdr.destroy();
+}
+
+TEST_CASE("EarlyHintsCache", "[http][early_hints]")
+{
+  HttpEarlyHints hints;
+  HTTPHdr with_links, without_links;
+  parse_response(with_links, "HTTP/1.1 200 OK\r\nLink: </style.css>; rel=preload; as=style\r\n\r\n");
+  parse_response(without_links, "HTTP/1.1 200 OK\r\n\r\n");
+
+  std::string links;
+  hints.remember("http://example.com/a", &with_links, 2);
+  hints.remember("http://example.com/b", &without_links, 2);
+  CHECK(hints.size() == 1);
+  CHECK(hints.lookup("http://example.com/a", links));
+  CHECK(links == "</style.css>; rel=preload; as=style");
+  CHECK_FALSE(hints.lookup("http://example.com/b", links));
+
+  SECTION("least recently used is dropped")
+  {
+    hints.remember("http://example.com/b", &with_links, 2);
+    CHECK(hints.lookup("http://example.com/a", links));
+    hints.remember("http://example.com/c", &with_links, 2);
+    CHECK(hints.size() == 2);
+    CHECK(hints.lookup("http://example.com/a", links));
+    CHECK_FALSE(hints.lookup("http://example.com/b", links));
+    CHECK(hints.lookup("http://example.com/c", links));
+  }
+
+  SECTION("forgotten when the links go away")
+  {
+    hints.remember("http://example.com/a", &without_links, 2);
+    CHECK(hints.size() == 0);
+    CHECK_FALSE(hints.lookup("http://example.com/a", links));
+  }
+
+  with_links.destroy();
+  without_links.destroy();
+}
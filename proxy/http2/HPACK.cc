@@ -22,6 +22,7 @@
  */
 
 #include "HPACK.h"
+#include "HuffmanCodec.h"
 
 #include "tscpp/util/LocalBuffer.h"
 
@@ -184,6 +185,9 @@ static const StaticTable STATIC_TABLE[] = {{"", ""},
 */
 static constexpr uint32_t HPACK_HDR_HEAP_THRESHOLD = sizeof(MIMEHdrImpl) + sizeof(MIMEFieldBlockImpl) * (2 + 7 + 15);
 
+/// Values of dynamic table entries at least this long are shared by the headers that refer to them instead of copied.
+static constexpr int HPACK_SHARED_VALUE_MIN_LEN = 64;
+
 //
 // Local functions
 //
@@ -193,6 +197,58 @@ hpack_field_is_literal(HpackField ftype)
   return ftype == HpackField::INDEXED_LITERAL || ftype == HpackField::NOINDEX_LITERAL || ftype == HpackField::NEVERINDEX_LITERAL;
 }
 
+//
+// [RFC 7541] 5.2. String Literal Representation
+// The string goes into the heap of the header it is for, a Huffman coded one decoded straight into the space it
+// ends up in.
+//
+int64_t
+hpack_decode_string(HdrHeap *heap, const char **str, int &str_len, const uint8_t *buf_start, const uint8_t *buf_end)
+{
+  if (buf_start >= buf_end) {
+    return HPACK_ERROR_COMPRESSION_ERROR;
+  }
+
+  const uint8_t *p            = buf_start;
+  bool is_huffman             = *p & 0x80;
+  uint64_t encoded_string_len = 0;
+  int64_t len                 = xpack_decode_integer(encoded_string_len, p, buf_end, 7);
+
+  if (len == XPACK_ERROR_COMPRESSION_ERROR) {
+    return HPACK_ERROR_COMPRESSION_ERROR;
+  }
+  p += len;
+
+  if (buf_end < p || static_cast<uint64_t>(buf_end - p) < encoded_string_len) {
+    return HPACK_ERROR_COMPRESSION_ERROR;
+  }
+
+  *str    = nullptr;
+  str_len = 0;
+
+  if (encoded_string_len > 0 && is_huffman) {
+    // No code is shorter than five bits
+    int max_len  = encoded_string_len * 8 / 5;
+    char *s      = heap->allocate_str(max_len);
+    int64_t dlen = huffman_decode(s, p, encoded_string_len);
+
+    heap->shrink_str(s, max_len, dlen < 0 ? 0 : dlen);
+    if (dlen < 0) {
+      return HPACK_ERROR_COMPRESSION_ERROR;
+    }
+    *str    = s;
+    str_len = dlen;
+  } else if (encoded_string_len > 0) {
+    char *s = heap->allocate_str(encoded_string_len);
+
+    memcpy(s, p, encoded_string_len);
+    *str    = s;
+    str_len = encoded_string_len;
+  }
+
+  return p + encoded_string_len - buf_start;
+}
+
 //
 // The first byte of an HPACK field unambiguously tells us what
 // kind of field it is. Field types are specified in the high 4 bits
@@ -221,34 +277,71 @@ hpack_parse_field_type(uint8_t ftype)
   return HpackField::NOINDEX_LITERAL;
 }
 
+// FNV-1a, of the name in lower case as names compare without case.
+uint64_t
+hpack_name_hash(const char *name, int name_len)
+{
+  uint64_t hash = 14695981039346656037ULL;
+  for (int i = 0; i < name_len; ++i) {
+    hash = (hash ^ static_cast<uint8_t>(ParseRules::ink_tolower(name[i]))) * 1099511628211ULL;
+  }
+  return hash;
+}
+
+uint64_t
+hpack_entry_hash(const char *name, int name_len, const char *value, int value_len)
+{
+  uint64_t hash = hpack_name_hash(name, name_len) ^ 0xff;
+  for (int i = 0; i < value_len; ++i) {
+    hash = (hash ^ static_cast<uint8_t>(value[i])) * 1099511628211ULL;
+  }
+  return hash;
+}
+
 //
 // HpackStaticTable
 //
 namespace HpackStaticTable
 {
+  // The lowest index for each hash of a name and of a name and value.
+  struct Index {
+    Index()
+    {
+      for (unsigned int index = TS_HPACK_STATIC_TABLE_ENTRY_NUM - 1; index > 0; --index) {
+        const StaticTable &entry = STATIC_TABLE[index];
+
+        names[hpack_name_hash(entry.name, entry.name_size)]                                   = index;
+        entries[hpack_entry_hash(entry.name, entry.name_size, entry.value, entry.value_size)] = index;
+      }
+    }
+
+    std::unordered_map<uint64_t, uint32_t> names;
+    std::unordered_map<uint64_t, uint32_t> entries;
+  };
+
   HpackLookupResult
   lookup(const char *name, int name_len, const char *value, int value_len)
   {
+    static const Index index;
     HpackLookupResult result;
 
-    for (unsigned int index = 1; index < TS_HPACK_STATIC_TABLE_ENTRY_NUM; ++index) {
-      const char *table_name  = STATIC_TABLE[index].name;
-      int table_name_len      = STATIC_TABLE[index].name_size;
-      const char *table_value = STATIC_TABLE[index].value;
-      int table_value_len     = STATIC_TABLE[index].value_size;
-
-      // Check whether name (and value) are matched
-      if (ptr_len_casecmp(name, name_len, table_name, table_name_len) == 0) {
-        if ((value_len == table_value_len) && (memcmp(value, table_value, value_len) == 0)) {
-          result.index      = index;
-          result.index_type = HpackIndex::STATIC;
-          result.match_type = HpackMatch::EXACT;
-          break;
-        } else if (!result.index) {
-          result.index      = index;
-          result.index_type = HpackIndex::STATIC;
-          result.match_type = HpackMatch::NAME;
-        }
+    // Check whether name (and value) are matched
+    if (auto spot = index.entries.find(hpack_entry_hash(name, name_len, value, value_len)); spot != index.entries.end()) {
+      const StaticTable &entry = STATIC_TABLE[spot->second];
+      if (ptr_len_casecmp(name, name_len, entry.name, entry.name_size) == 0 && value_len == entry.value_size &&
+          memcmp(value, entry.value, value_len) == 0) {
+        result.index      = spot->second;
+        result.index_type = HpackIndex::STATIC;
+        result.match_type = HpackMatch::EXACT;
+        return result;
+      }
+    }
+    if (auto spot = index.names.find(hpack_name_hash(name, name_len)); spot != index.names.end()) {
+      const StaticTable &entry = STATIC_TABLE[spot->second];
+      if (ptr_len_casecmp(name, name_len, entry.name, entry.name_size) == 0) {
+        result.index      = spot->second;
+        result.index_type = HpackIndex::STATIC;
+        result.match_type = HpackMatch::NAME;
       }
     }
 
@@ -304,13 +397,18 @@ HpackIndexingTable::get_header_field(uint32_t index, MIMEFieldWrapper &field) co
   } else if (index < TS_HPACK_STATIC_TABLE_ENTRY_NUM + _dynamic_table.length()) {
     // dynamic table
     const MIMEField *m_field = _dynamic_table.get_header_field(index - TS_HPACK_STATIC_TABLE_ENTRY_NUM);
+    const HpackDynamicTable::SharedValue &shared = _dynamic_table.get_shared_value(index - TS_HPACK_STATIC_TABLE_ENTRY_NUM);
 
     int name_len, value_len;
     const char *name  = m_field->name_get(&name_len);
     const char *value = m_field->value_get(&value_len);
 
     field.name_set(name, name_len);
-    field.value_set(value, value_len);
+    if (shared.heap && field.heap_get()->share_str_heap(shared.heap.get())) {
+      field.value_set_in_heap(shared.value, value_len);
+    } else {
+      field.value_set(value, value_len);
+    }
   } else {
     // [RFC 7541] 2.3.3. Index Address Space
     // Indices strictly greater than the sum of the lengths of both tables
@@ -389,6 +487,9 @@ HpackDynamicTable::add_header_field(const MIMEField *field)
     // the maximum size; an attempt to add an entry larger than the entire
     // table causes the table to be emptied of all existing entries.
     this->_headers.clear();
+    this->_shared_values.clear();
+    this->_name_index.clear();
+    this->_entry_index.clear();
     this->_mhdr->fields_clear();
 
     if (this->_mhdr_old) {
@@ -407,36 +508,59 @@ HpackDynamicTable::add_header_field(const MIMEField *field)
     new_field->value_set(this->_mhdr->m_heap, this->_mhdr->m_mime, value, value_len);
     this->_mhdr->field_attach(new_field);
     this->_headers.push_front(new_field);
+    this->_index_add(new_field);
+
+    SharedValue shared;
+    if (value_len >= HPACK_SHARED_VALUE_MIN_LEN) {
+      char *copy = this->_shared_heap ? this->_shared_heap->allocate(value_len) : nullptr;
+      if (copy == nullptr) {
+        this->_shared_heap = new_HdrStrHeap(value_len);
+        copy               = this->_shared_heap->allocate(value_len);
+      }
+      memcpy(copy, value, value_len);
+      shared.heap  = this->_shared_heap;
+      shared.value = copy;
+    }
+    this->_shared_values.push_front(shared);
   }
 }
 
+const HpackDynamicTable::SharedValue &
+HpackDynamicTable::get_shared_value(uint32_t index) const
+{
+  return this->_shared_values.at(index);
+}
+
 HpackLookupResult
 HpackDynamicTable::lookup(const char *name, int name_len, const char *value, int value_len) const
 {
   HpackLookupResult result;
-  const unsigned int entry_num = TS_HPACK_STATIC_TABLE_ENTRY_NUM + this->length();
-
-  for (unsigned int index = TS_HPACK_STATIC_TABLE_ENTRY_NUM; index < entry_num; ++index) {
-    const MIMEField *m_field = this->get_header_field(index - TS_HPACK_STATIC_TABLE_ENTRY_NUM);
-
-    int table_name_len     = 0;
-    const char *table_name = m_field->name_get(&table_name_len);
-
-    int table_value_len     = 0;
-    const char *table_value = m_field->value_get(&table_value_len);
+  int table_name_len, table_value_len;
+
+  // Check whether name (and value) are matched
+  if (auto spot = this->_entry_index.find(hpack_entry_hash(name, name_len, value, value_len)); spot != this->_entry_index.end()) {
+    uint32_t index           = this->_added - 1 - spot->second;
+    const MIMEField *m_field = this->get_header_field(index);
+    const char *table_name   = m_field->name_get(&table_name_len);
+    const char *table_value  = m_field->value_get(&table_value_len);
+
+    if (ptr_len_casecmp(name, name_len, table_name, table_name_len) == 0 && value_len == table_value_len &&
+        memcmp(value, table_value, value_len) == 0) {
+      result.index      = TS_HPACK_STATIC_TABLE_ENTRY_NUM + index;
+      result.index_type = HpackIndex::DYNAMIC;
+      result.match_type = HpackMatch::EXACT;
+      return result;
+    }
+  }
+  if (auto spot = this->_name_index.find(hpack_name_hash(name, name_len)); spot != this->_name_index.end()) {
+    uint32_t index           = this->_added - 1 - spot->second;
+    const MIMEField *m_field = this->get_header_field(index);
+    const char *table_name   = m_field->name_get(&table_name_len);
 
-    // Check whether name (and value) are matched
     if (ptr_len_casecmp(name, name_len, table_name, table_name_len) == 0) {
-      if ((value_len == table_value_len) && (memcmp(value, table_value, value_len) == 0)) {
-        result.index      = index;
-        result.index_type = HpackIndex::DYNAMIC;
-        result.match_type = HpackMatch::EXACT;
-        break;
-      } else if (!result.index) {
-        result.index      = index;
-        result.index_type = HpackIndex::DYNAMIC;
-        result.match_type = HpackMatch::NAME;
-      }
+      result.index      = TS_HPACK_STATIC_TABLE_ENTRY_NUM + index;
+      result.index_type = HpackIndex::DYNAMIC;
+      result.match_type = HpackMatch::NAME;
     }
   }
 
@@ -489,6 +613,7 @@ HpackDynamicTable::_evict_overflowed_entries()
     (*h)->value_get(&value_len);
 
     this->_current_size -= ADDITIONAL_OCTETS + name_len + value_len;
+    this->_index_remove(*h);
 
     if (this->_mhdr_old && this->_mhdr_old->fields_count() != 0) {
       this->_mhdr_old->field_delete(*h, false);
@@ -497,6 +622,7 @@ HpackDynamicTable::_evict_overflowed_entries()
     }
 
     this->_headers.pop_back();
+    this->_shared_values.pop_back();
 
     if (this->_current_size <= this->_maximum_size) {
       break;
@@ -506,6 +632,42 @@ HpackDynamicTable::_evict_overflowed_entries()
   this->_mime_hdr_gc();
 }
 
+/**
+   Index @a field, the entry just added at the front.
+ */
+void
+HpackDynamicTable::_index_add(const MIMEField *field)
+{
+  int name_len, value_len;
+  const char *name  = field->name_get(&name_len);
+  const char *value = field->value_get(&value_len);
+  uint64_t n        = this->_added++;
+
+  this->_name_index[hpack_name_hash(name, name_len)]                     = n;
+  this->_entry_index[hpack_entry_hash(name, name_len, value, value_len)] = n;
+}
+
+/**
+   Drop @a field, the oldest entry, from the indexes. Anything newer with the same hash would have replaced it, so it
+   is only there if it was the last one.
+ */
+void
+HpackDynamicTable::_index_remove(const MIMEField *field)
+{
+  int name_len, value_len;
+  const char *name  = field->name_get(&name_len);
+  const char *value = field->value_get(&value_len);
+  uint64_t n        = this->_added - this->_headers.size();
+
+  if (auto spot = this->_name_index.find(hpack_name_hash(name, name_len)); spot != this->_name_index.end() && spot->second == n) {
+    this->_name_index.erase(spot);
+  }
+  if (auto spot = this->_entry_index.find(hpack_entry_hash(name, name_len, value, value_len));
+      spot != this->_entry_index.end() && spot->second == n) {
+    this->_entry_index.erase(spot);
+  }
+}
+
 /**
    When HdrHeap size of current MIMEHdr exceeds the threshold, allocate new MIMEHdr and HdrHeap.
    The old MIMEHdr and HdrHeap will be freed, when all MIMEFiled are deleted by HPACK Entry Eviction.
@@ -751,25 +913,23 @@ decode_literal_header_field(MIMEFieldWrapper &header, const uint8_t *buf_start,
 
   p += len;
 
-  Arena arena;
-
   // Decode header field name
   if (index) {
     if (indexing_table.get_header_field(index, header) == HPACK_ERROR_COMPRESSION_ERROR) {
       return HPACK_ERROR_COMPRESSION_ERROR;
     }
   } else {
-    char *name_str        = nullptr;
-    uint64_t name_str_len = 0;
+    const char *name_str = nullptr;
+    int name_str_len     = 0;
 
-    len = xpack_decode_string(arena, &name_str, name_str_len, p, buf_end);
-    if (len == XPACK_ERROR_COMPRESSION_ERROR) {
+    len = hpack_decode_string(header.heap_get(), &name_str, name_str_len, p, buf_end);
+    if (len == HPACK_ERROR_COMPRESSION_ERROR) {
       return HPACK_ERROR_COMPRESSION_ERROR;
     }
 
     // Check whether header field name is lower case
     // XXX This check shouldn't be here because this rule is not a part of HPACK but HTTP2.
-    for (uint32_t i = 0; i < name_str_len; i++) {
+    for (int i = 0; i < name_str_len; i++) {
       if (ParseRules::is_upalpha(name_str[i])) {
         has_http2_violation = true;
         break;
@@ -777,20 +937,20 @@ decode_literal_header_field(MIMEFieldWrapper &header, const uint8_t *buf_start,
     }
 
     p += len;
-    header.name_set(name_str, name_str_len);
+    header.name_set_in_heap(name_str, name_str_len);
   }
 
   // Decode header field value
-  char *value_str        = nullptr;
-  uint64_t value_str_len = 0;
+  const char *value_str = nullptr;
+  int value_str_len     = 0;
 
-  len = xpack_decode_string(arena, &value_str, value_str_len, p, buf_end);
-  if (len == XPACK_ERROR_COMPRESSION_ERROR) {
+  len = hpack_decode_string(header.heap_get(), &value_str, value_str_len, p, buf_end);
+  if (len == HPACK_ERROR_COMPRESSION_ERROR) {
     return HPACK_ERROR_COMPRESSION_ERROR;
   }
 
   p += len;
-  header.value_set(value_str, value_str_len);
+  header.value_set_in_heap(value_str, value_str_len);
 
   // Incremental Indexing adds header to header table as new entry
   if (isIncremental) {
@@ -804,8 +964,7 @@ decode_literal_header_field(MIMEFieldWrapper &header, const uint8_t *buf_start,
     int decoded_value_len;
     const char *decoded_value = header.value_get(&decoded_value_len);
 
-    Debug("hpack_decode", "Decoded field: %s: %s", arena.str_store(decoded_name, decoded_name_len),
-          arena.str_store(decoded_value, decoded_value_len));
+    Debug("hpack_decode", "Decoded field: %.*s: %.*s", decoded_name_len, decoded_name, decoded_value_len, decoded_value);
   }
 
   if (has_http2_violation) {
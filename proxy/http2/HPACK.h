@@ -29,6 +29,7 @@
 #include "../hdrs/XPACK.h"
 
 #include <deque>
+#include <unordered_map>
 
 // It means that any header field can be compressed/decompressed by ATS
 const static int HPACK_ERROR_COMPRESSION_ERROR   = -1;
@@ -95,6 +96,34 @@ public:
     return _field;
   }
 
+  HdrHeap *
+  heap_get() const
+  {
+    return _heap;
+  }
+
+  /// Set the name to @a name, a string already allocated in the heap, without copying it.
+  void
+  name_set_in_heap(const char *name, int name_len)
+  {
+    const char *name_wks;
+    int name_wks_idx = name_len > 0 ? hdrtoken_tokenize(name, name_len, &name_wks) : -1;
+
+    if (name_wks_idx >= 0) {
+      _heap->shrink_str(name, name_len, 0);
+      mime_field_name_set(_heap, _mh, _field, name_wks_idx, name_wks, name_len, false);
+    } else {
+      mime_field_name_set(_heap, _mh, _field, -1, name, name_len, false);
+    }
+  }
+
+  /// Set the value to @a value, which is in the heap or in one it shares, without copying it.
+  void
+  value_set_in_heap(const char *value, int value_len)
+  {
+    mime_field_value_set(_heap, _mh, _field, value, value_len, false);
+  }
+
 private:
   MIMEField *_field;
   HdrHeap *_heap;
@@ -115,6 +144,13 @@ public:
   const MIMEField *get_header_field(uint32_t index) const;
   void add_header_field(const MIMEField *field);
 
+  /// A copy of the value of an entry in a string heap headers can share, so it needs no copy for each of them.
+  struct SharedValue {
+    Ptr<HdrStrHeap> heap; ///< Null if the value is too short to be worth sharing.
+    const char *value = nullptr;
+  };
+  const SharedValue &get_shared_value(uint32_t index) const;
+
   HpackLookupResult lookup(const char *name, int name_len, const char *value, int value_len) const;
   uint32_t maximum_size() const;
   uint32_t size() const;
@@ -125,6 +161,8 @@ public:
 private:
   void _evict_overflowed_entries();
   void _mime_hdr_gc();
+  void _index_add(const MIMEField *field);
+  void _index_remove(const MIMEField *field);
 
   uint32_t _current_size = 0;
   uint32_t _maximum_size = 0;
@@ -132,6 +170,18 @@ private:
   MIMEHdr *_mhdr     = nullptr;
   MIMEHdr *_mhdr_old = nullptr;
   std::deque<MIMEField *> _headers;
+
+  // Long values are also added to a string heap of their own, one after another, which is replaced when it fills
+  // up. Each goes when the last entry in it is evicted and no header refers to it any more.
+  std::deque<SharedValue> _shared_values;
+  Ptr<HdrStrHeap> _shared_heap;
+
+  // The newest entry for each hash of a name and of a name and value, by the number of entries added before it. It
+  // is at index _added - 1 - n, counting from the newest, however many were added or evicted since. Only hashes are
+  // kept as the strings of a field move when its heap is coalesced, a lookup compares the field it finds.
+  uint64_t _added = 0;
+  std::unordered_map<uint64_t, uint64_t> _name_index;
+  std::unordered_map<uint64_t, uint64_t> _entry_index;
 };
 
 // [RFC 7541] 2.3. Indexing Table
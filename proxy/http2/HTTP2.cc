@@ -26,6 +26,7 @@
 
 #include "tscore/ink_assert.h"
 #include "tscpp/util/LocalBuffer.h"
+#include "tscpp/util/TextView.h"
 
 #include "records/P_RecCore.h"
 #include "records/P_RecProcess.h"
@@ -83,7 +84,16 @@ static const char *const HTTP2_STAT_MAX_PING_FRAMES_PER_MINUTE_EXCEEDED_NAME =
   "proxy.process.http2.max_ping_frames_per_minute_exceeded";
 static const char *const HTTP2_STAT_MAX_PRIORITY_FRAMES_PER_MINUTE_EXCEEDED_NAME =
   "proxy.process.http2.max_priority_frames_per_minute_exceeded";
-static const char *const HTTP2_STAT_INSUFFICIENT_AVG_WINDOW_UPDATE_NAME = "proxy.process.http2.insufficient_avg_window_update";
+static const char *const HTTP2_STAT_INSUFFICIENT_AVG_WINDOW_UPDATE_NAME  = "proxy.process.http2.insufficient_avg_window_update";
+static const char *const HTTP2_STAT_CURRENT_SERVER_CONNECTION_NAME       = "proxy.process.http2.current_server_connections";
+static const char *const HTTP2_STAT_TOTAL_SERVER_CONNECTION_NAME         = "proxy.process.http2.total_server_connections";
+static const char *const HTTP2_STAT_CURRENT_SERVER_STREAM_NAME           = "proxy.process.http2.current_server_streams";
+static const char *const HTTP2_STAT_TOTAL_SERVER_STREAM_NAME             = "proxy.process.http2.total_server_streams";
+static const char *const HTTP2_STAT_TOTAL_FRAME_WRITES_NAME              = "proxy.process.http2.total_frame_writes";
+static const char *const HTTP2_STAT_TOTAL_FRAMES_WRITTEN_NAME            = "proxy.process.http2.total_frames_written";
+static const char *const HTTP2_STAT_FLOW_CONTROL_BLOCKED_TIME_NAME       = "proxy.process.http2.flow_control_blocked_time";
+static const char *const HTTP2_STAT_MEMORY_PRESSURE_REFUSED_STREAMS_NAME = "proxy.process.http2.memory_pressure_refused_streams";
+static const char *const HTTP2_STAT_HEADER_HEAPS_REUSED_NAME             = "proxy.process.http2.header_heaps_reused";
 
 union byte_pointer {
   byte_pointer(void *p) : ptr(p) {}
@@ -416,6 +426,44 @@ http2_parse_window_update(IOVec iov, uint32_t &size)
   return true;
 }
 
+// [RFC 9218] 4. Priority Parameters
+//
+// The value of a priority header field or PRIORITY_UPDATE frame is a Structured Fields dictionary,
+// like "u=5, i". Only the urgency u, an integer 0 to 7, and incremental i, a boolean, are defined.
+// Unknown members, parameters and values out of range are ignored, leaving @a urgency and
+// @a incremental as they were. Returns false if the dictionary can't be parsed.
+bool
+http2_parse_priority_field(std::string_view field, uint8_t &urgency, bool &incremental)
+{
+  ts::TextView text{field};
+
+  while (!text.ltrim_if(&ParseRules::is_ws).empty()) {
+    ts::TextView member = text.take_prefix_at(',');
+    ts::TextView value  = member.take_prefix_at(';'); // Parameters of the member are ignored
+    ts::TextView key    = value.take_prefix_at('=');
+    key.trim_if(&ParseRules::is_ws);
+    value.trim_if(&ParseRules::is_ws);
+
+    if (key.empty()) {
+      return false;
+    }
+    if (key == "u") {
+      if (value.size() == 1 && value[0] >= '0' && value[0] <= '0' + HTTP2_PRIORITY_MAX_URGENCY) {
+        urgency = value[0] - '0';
+      }
+    } else if (key == "i") {
+      // A bare key is the boolean true
+      if (value.empty() || value == "?1") {
+        incremental = true;
+      } else if (value == "?0") {
+        incremental = false;
+      }
+    }
+  }
+
+  return true;
+}
+
 ParseResult
 http2_convert_header_from_2_to_1_1(HTTPHdr *headers)
 {
@@ -787,6 +835,7 @@ uint32_t Http2::max_active_streams_in          = 0;
 bool Http2::throttling                         = false;
 uint32_t Http2::stream_priority_enabled        = 0;
 uint32_t Http2::initial_window_size            = 65535;
+uint32_t Http2::max_window_size                = 0;
 uint32_t Http2::max_frame_size                 = 16384;
 uint32_t Http2::header_table_size              = 4096;
 uint32_t Http2::max_header_list_size           = 4294967295;
@@ -805,6 +854,11 @@ float Http2::min_avg_window_update             = 2560.0;
 uint32_t Http2::con_slow_log_threshold         = 0;
 uint32_t Http2::stream_slow_log_threshold      = 0;
 uint32_t Http2::header_table_size_limit        = 65536;
+uint32_t Http2::origin_enabled                 = 0;
+uint32_t Http2::origin_max_concurrent_streams  = 100;
+uint32_t Http2::write_batch_size               = 65536;
+uint32_t Http2::write_record_size              = 0;
+uint32_t Http2::header_heap_cache_size         = 8;
 
 void
 Http2::init()
@@ -814,6 +868,7 @@ Http2::init()
   REC_EstablishStaticConfigInt32U(max_active_streams_in, "proxy.config.http2.max_active_streams_in");
   REC_EstablishStaticConfigInt32U(stream_priority_enabled, "proxy.config.http2.stream_priority_enabled");
   REC_EstablishStaticConfigInt32U(initial_window_size, "proxy.config.http2.initial_window_size_in");
+  REC_EstablishStaticConfigInt32U(max_window_size, "proxy.config.http2.max_window_size_in");
   REC_EstablishStaticConfigInt32U(max_frame_size, "proxy.config.http2.max_frame_size");
   REC_EstablishStaticConfigInt32U(header_table_size, "proxy.config.http2.header_table_size");
   REC_EstablishStaticConfigInt32U(max_header_list_size, "proxy.config.http2.max_header_list_size");
@@ -832,6 +887,11 @@ Http2::init()
   REC_EstablishStaticConfigInt32U(con_slow_log_threshold, "proxy.config.http2.connection.slow.log.threshold");
   REC_EstablishStaticConfigInt32U(stream_slow_log_threshold, "proxy.config.http2.stream.slow.log.threshold");
   REC_EstablishStaticConfigInt32U(header_table_size_limit, "proxy.config.http2.header_table_size_limit");
+  REC_EstablishStaticConfigInt32U(origin_enabled, "proxy.config.http2.origin.enabled");
+  REC_EstablishStaticConfigInt32U(origin_max_concurrent_streams, "proxy.config.http2.origin.max_concurrent_streams");
+  REC_EstablishStaticConfigInt32U(write_batch_size, "proxy.config.http2.write_batch_size");
+  REC_EstablishStaticConfigInt32U(write_record_size, "proxy.config.http2.write_record_size");
+  REC_EstablishStaticConfigInt32U(header_heap_cache_size, "proxy.config.http2.header_heap_cache_size");
 
   // If any settings is broken, ATS should not start
   ink_release_assert(http2_settings_parameter_is_valid({HTTP2_SETTINGS_MAX_CONCURRENT_STREAMS, max_concurrent_streams_in}));
@@ -894,6 +954,26 @@ Http2::init()
                      static_cast<int>(HTTP2_STAT_MAX_PRIORITY_FRAMES_PER_MINUTE_EXCEEDED), RecRawStatSyncSum);
   RecRegisterRawStat(http2_rsb, RECT_PROCESS, HTTP2_STAT_INSUFFICIENT_AVG_WINDOW_UPDATE_NAME, RECD_INT, RECP_PERSISTENT,
                      static_cast<int>(HTTP2_STAT_INSUFFICIENT_AVG_WINDOW_UPDATE), RecRawStatSyncSum);
+  RecRegisterRawStat(http2_rsb, RECT_PROCESS, HTTP2_STAT_CURRENT_SERVER_CONNECTION_NAME, RECD_INT, RECP_NON_PERSISTENT,
+                     static_cast<int>(HTTP2_STAT_CURRENT_SERVER_SESSION_COUNT), RecRawStatSyncSum);
+  HTTP2_CLEAR_DYN_STAT(HTTP2_STAT_CURRENT_SERVER_SESSION_COUNT);
+  RecRegisterRawStat(http2_rsb, RECT_PROCESS, HTTP2_STAT_TOTAL_SERVER_CONNECTION_NAME, RECD_INT, RECP_PERSISTENT,
+                     static_cast<int>(HTTP2_STAT_TOTAL_SERVER_CONNECTION_COUNT), RecRawStatSyncCount);
+  RecRegisterRawStat(http2_rsb, RECT_PROCESS, HTTP2_STAT_CURRENT_SERVER_STREAM_NAME, RECD_INT, RECP_NON_PERSISTENT,
+                     static_cast<int>(HTTP2_STAT_CURRENT_SERVER_STREAM_COUNT), RecRawStatSyncSum);
+  HTTP2_CLEAR_DYN_STAT(HTTP2_STAT_CURRENT_SERVER_STREAM_COUNT);
+  RecRegisterRawStat(http2_rsb, RECT_PROCESS, HTTP2_STAT_TOTAL_SERVER_STREAM_NAME, RECD_INT, RECP_PERSISTENT,
+                     static_cast<int>(HTTP2_STAT_TOTAL_SERVER_STREAM_COUNT), RecRawStatSyncCount);
+  RecRegisterRawStat(http2_rsb, RECT_PROCESS, HTTP2_STAT_TOTAL_FRAME_WRITES_NAME, RECD_INT, RECP_PERSISTENT,
+                     static_cast<int>(HTTP2_STAT_TOTAL_FRAME_WRITES), RecRawStatSyncCount);
+  RecRegisterRawStat(http2_rsb, RECT_PROCESS, HTTP2_STAT_TOTAL_FRAMES_WRITTEN_NAME, RECD_INT, RECP_PERSISTENT,
+                     static_cast<int>(HTTP2_STAT_TOTAL_FRAMES_WRITTEN), RecRawStatSyncSum);
+  RecRegisterRawStat(http2_rsb, RECT_PROCESS, HTTP2_STAT_FLOW_CONTROL_BLOCKED_TIME_NAME, RECD_INT, RECP_PERSISTENT,
+                     static_cast<int>(HTTP2_STAT_FLOW_CONTROL_BLOCKED_TIME), RecRawStatSyncSum);
+  RecRegisterRawStat(http2_rsb, RECT_PROCESS, HTTP2_STAT_MEMORY_PRESSURE_REFUSED_STREAMS_NAME, RECD_INT, RECP_PERSISTENT,
+                     static_cast<int>(HTTP2_STAT_MEMORY_PRESSURE_REFUSED_STREAMS), RecRawStatSyncSum);
+  RecRegisterRawStat(http2_rsb, RECT_PROCESS, HTTP2_STAT_HEADER_HEAPS_REUSED_NAME, RECD_INT, RECP_PERSISTENT,
+                     static_cast<int>(HTTP2_STAT_HEADER_HEAPS_REUSED), RecRawStatSyncSum);
 
   http2_init();
 }
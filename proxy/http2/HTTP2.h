@@ -82,6 +82,10 @@ const uint32_t HTTP2_MAX_BUFFER_USAGE       = 524288;
 const uint32_t HTTP2_PRIORITY_DEFAULT_STREAM_DEPENDENCY = 0;
 const uint8_t HTTP2_PRIORITY_DEFAULT_WEIGHT             = 15;
 
+// [RFC 9218] 4. Priority Parameters
+const uint8_t HTTP2_PRIORITY_DEFAULT_URGENCY = 3;
+const uint8_t HTTP2_PRIORITY_MAX_URGENCY     = 7;
+
 // Statistics
 enum {
   HTTP2_STAT_CURRENT_CLIENT_SESSION_COUNT,           // Current # of HTTP2 connections
@@ -105,6 +109,15 @@ enum {
   HTTP2_STAT_MAX_PING_FRAMES_PER_MINUTE_EXCEEDED,
   HTTP2_STAT_MAX_PRIORITY_FRAMES_PER_MINUTE_EXCEEDED,
   HTTP2_STAT_INSUFFICIENT_AVG_WINDOW_UPDATE,
+  HTTP2_STAT_CURRENT_SERVER_SESSION_COUNT, // Current # of HTTP2 connections to origins
+  HTTP2_STAT_TOTAL_SERVER_CONNECTION_COUNT,
+  HTTP2_STAT_CURRENT_SERVER_STREAM_COUNT,
+  HTTP2_STAT_TOTAL_SERVER_STREAM_COUNT,
+  HTTP2_STAT_TOTAL_FRAME_WRITES, // Writes to client connections, each with one or more frames
+  HTTP2_STAT_TOTAL_FRAMES_WRITTEN,
+  HTTP2_STAT_FLOW_CONTROL_BLOCKED_TIME, // Milliseconds DATA waited for the client to open the window
+  HTTP2_STAT_MEMORY_PRESSURE_REFUSED_STREAMS,
+  HTTP2_STAT_HEADER_HEAPS_REUSED, // Stream headers created in a heap left by an earlier stream of the connection
 
   HTTP2_N_STATS // Terminal counter, NOT A STAT INDEX.
 };
@@ -170,6 +183,9 @@ enum Http2FrameType {
   HTTP2_FRAME_TYPE_MAX,
 };
 
+// [RFC 9218] 7.1. The PRIORITY_UPDATE Frame, an extension frame with no handler in the table.
+const uint8_t HTTP2_FRAME_TYPE_PRIORITY_UPDATE = 0x10;
+
 // [RFC 7540] 6.1. Data
 enum Http2FrameFlagsData {
   HTTP2_FLAGS_DATA_END_STREAM = 0x01,
@@ -362,6 +378,8 @@ bool http2_parse_goaway(IOVec, Http2Goaway &);
 
 bool http2_parse_window_update(IOVec, uint32_t &);
 
+bool http2_parse_priority_field(std::string_view, uint8_t &, bool &);
+
 Http2ErrorCode http2_decode_header_blocks(HTTPHdr *, const uint8_t *, const uint32_t, uint32_t *, HpackHandle &, bool &, uint32_t);
 
 Http2ErrorCode http2_encode_header_blocks(HTTPHdr *, uint8_t *, uint32_t, uint32_t *, HpackHandle &, int32_t);
@@ -385,6 +403,7 @@ public:
   static bool throttling;
   static uint32_t stream_priority_enabled;
   static uint32_t initial_window_size;
+  static uint32_t max_window_size;
   static uint32_t max_frame_size;
   static uint32_t header_table_size;
   static uint32_t max_header_list_size;
@@ -403,6 +422,11 @@ public:
   static uint32_t con_slow_log_threshold;
   static uint32_t stream_slow_log_threshold;
   static uint32_t header_table_size_limit;
+  static uint32_t origin_enabled;
+  static uint32_t origin_max_concurrent_streams;
+  static uint32_t write_batch_size;
+  static uint32_t write_record_size;
+  static uint32_t header_heap_cache_size;
 
   static void init();
 };
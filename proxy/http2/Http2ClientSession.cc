@@ -299,18 +299,35 @@ Http2ClientSession::set_half_close_local_flag(bool flag)
 }
 
 int64_t
-Http2ClientSession::xmit(const Http2TxFrame &frame)
+Http2ClientSession::xmit(const Http2TxFrame &frame, bool flush)
 {
   int64_t len = frame.write_to(this->write_buffer);
 
   if (len > 0) {
     total_write_len += len;
-    write_reenable();
+    ++_n_frame_unflushed;
+    if (flush) {
+      this->flush();
+    }
   }
 
   return len;
 }
 
+// Hands the frames written since the last flush to the network as one write.
+void
+Http2ClientSession::flush()
+{
+  if (_n_frame_unflushed == 0) {
+    return;
+  }
+
+  HTTP2_INCREMENT_THREAD_DYN_STAT(HTTP2_STAT_TOTAL_FRAME_WRITES, this_ethread());
+  HTTP2_SUM_THREAD_DYN_STAT(HTTP2_STAT_TOTAL_FRAMES_WRITTEN, this_ethread(), _n_frame_unflushed);
+  _n_frame_unflushed = 0;
+  write_reenable();
+}
+
 int
 Http2ClientSession::main_event_handler(int event, void *edata)
 {
@@ -466,13 +483,20 @@ Http2ClientSession::do_start_frame_read(Http2ErrorCode &ret_error)
   ink_release_assert(this->_reader->read_avail() >= (int64_t)HTTP2_FRAME_HEADER_LEN);
 
   uint8_t buf[HTTP2_FRAME_HEADER_LEN];
-  unsigned nbytes;
+  unsigned nbytes = HTTP2_FRAME_HEADER_LEN;
+  IOVec header;
 
   Http2SsnDebug("receiving frame header");
-  nbytes = copy_from_buffer_reader(buf, this->_reader, sizeof(buf));
+  // Parse the header where it is in the read buffer, unless it spans two blocks.
+  if (this->_reader->block_read_avail() >= static_cast<int64_t>(HTTP2_FRAME_HEADER_LEN)) {
+    header = make_iovec(this->_reader->start(), HTTP2_FRAME_HEADER_LEN);
+  } else {
+    nbytes = copy_from_buffer_reader(buf, this->_reader, sizeof(buf));
+    header = make_iovec(buf);
+  }
 
   this->cur_frame_from_early_data = false;
-  if (!http2_parse_frame_header(make_iovec(buf), this->current_hdr)) {
+  if (!http2_parse_frame_header(header, this->current_hdr)) {
     Http2SsnDebug("frame header parse failure");
     this->do_io_close();
     return -1;
@@ -101,7 +101,9 @@ public:
 
   // more methods
   void write_reenable();
-  int64_t xmit(const Http2TxFrame &frame);
+  /// Write @a frame to the write buffer, without @a flush it waits for the next flush() to go out.
+  int64_t xmit(const Http2TxFrame &frame, bool flush = true);
+  void flush();
 
   ////////////////////
   // Accessors
@@ -182,6 +184,7 @@ private:
 
   Event *_reenable_event = nullptr;
   int _n_frame_read      = 0;
+  int _n_frame_unflushed = 0;
 
   int64_t read_from_early_data   = 0;
   bool cur_frame_from_early_data = false;
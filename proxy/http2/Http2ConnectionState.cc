@@ -29,6 +29,7 @@
 #include "Http2DebugNames.h"
 #include "HttpDebugNames.h"
 
+#include "tscore/memory_pressure.h"
 #include "tscpp/util/PostScript.h"
 #include "tscpp/util/LocalBuffer.h"
 
@@ -78,6 +79,25 @@ read_rcv_buffer(char *buf, size_t bufsize, unsigned &nbytes, const Http2Frame &f
   return end - buf;
 }
 
+// [RFC 9218] 5. The Priority HTTP Header Field. Takes the priority of @a stream from its request,
+// unless a PRIORITY_UPDATE frame set it already.
+static void
+set_priority_from_field(Http2ConnectionState &cstate, Http2Stream *stream)
+{
+  Http2DependencyTree::Node *node = stream->priority_node;
+  if (node == nullptr || node->priority_updated || !cstate.dependency_tree->is_extensible()) {
+    return;
+  }
+
+  std::string_view field = stream->get_priority_field();
+  uint8_t urgency        = HTTP2_PRIORITY_DEFAULT_URGENCY;
+  bool incremental       = false;
+  if (!field.empty() && http2_parse_priority_field(field, urgency, incremental)) {
+    Http2StreamDebug(cstate.ua_session, stream->get_id(), "Priority field - urgency: %u, incremental: %d", urgency, incremental);
+    cstate.dependency_tree->set_urgency(node, urgency, incremental);
+  }
+}
+
 static Http2Error
 rcv_data_frame(Http2ConnectionState &cstate, const Http2Frame &frame)
 {
@@ -169,6 +189,7 @@ rcv_data_frame(Http2ConnectionState &cstate, const Http2Frame &frame)
   // Update Window size
   cstate.decrement_server_rwnd(payload_length);
   stream->decrement_server_rwnd(payload_length);
+  cstate.sample_received_data(payload_length);
 
   if (is_debug_tag_set("http2_con")) {
     uint32_t rwnd = cstate.server_settings.get(HTTP2_SETTINGS_INITIAL_WINDOW_SIZE);
@@ -191,11 +212,10 @@ rcv_data_frame(Http2ConnectionState &cstate, const Http2Frame &frame)
     myreader->consume(HTTP2_DATA_PADLEN_LEN);
   }
 
+  // The payload is passed on as references to the blocks of the session read buffer, not copied,
+  // so there is no need to split it at a buffer size.
   if (nbytes < unpadded_length) {
-    size_t read_len = BUFFER_SIZE_FOR_INDEX(buffer_size_index[HTTP2_FRAME_TYPE_DATA]);
-    if (nbytes + read_len > unpadded_length) {
-      read_len -= nbytes + read_len - unpadded_length;
-    }
+    size_t read_len          = unpadded_length - nbytes;
     unsigned int num_written = writer->write(myreader, read_len);
     if (num_written != read_len) {
       myreader->writer()->dealloc_reader(myreader);
@@ -382,6 +402,10 @@ rcv_headers_frame(Http2ConnectionState &cstate, const Http2Frame &frame)
       }
     }
 
+    if (Http2::stream_priority_enabled && !empty_request) {
+      set_priority_from_field(cstate, stream);
+    }
+
     // Set up the State Machine
     if (!empty_request) {
       SCOPED_MUTEX_LOCK(stream_lock, stream->mutex, this_ethread());
@@ -448,7 +472,8 @@ rcv_priority_frame(Http2ConnectionState &cstate, const Http2Frame &frame)
                       "PRIORITY frame depends on itself");
   }
 
-  if (!Http2::stream_priority_enabled) {
+  // [RFC 9218] 2.1. The dependencies of RFC 7540 are ignored with the Extensible Priorities.
+  if (!Http2::stream_priority_enabled || cstate.dependency_tree->is_extensible()) {
     return Http2Error(Http2ErrorClass::HTTP2_ERROR_CLASS_NONE);
   }
 
@@ -700,6 +725,13 @@ rcv_ping_frame(Http2ConnectionState &cstate, const Http2Frame &frame)
                       "ping bad length");
   }
 
+  frame.reader()->memcpy(opaque_data, HTTP2_PING_LEN, 0);
+
+  // The ACK of our own PING doesn't count against the client
+  if ((frame.header().flags & HTTP2_FLAGS_PING_ACK) && cstate.recv_ping_ack(opaque_data)) {
+    return Http2Error(Http2ErrorClass::HTTP2_ERROR_CLASS_NONE);
+  }
+
   // Update PING frame count per minute
   cstate.increment_received_ping_frame_count();
   // Close this connection if its ping count received exceeds a limit
@@ -716,8 +748,6 @@ rcv_ping_frame(Http2ConnectionState &cstate, const Http2Frame &frame)
     return Http2Error(Http2ErrorClass::HTTP2_ERROR_CLASS_NONE);
   }
 
-  frame.reader()->memcpy(opaque_data, HTTP2_PING_LEN, 0);
-
   // ACK (0x1): An endpoint MUST set this flag in PING responses.
   cstate.send_ping_frame(stream_id, HTTP2_FLAGS_PING_ACK, opaque_data);
 
@@ -811,6 +841,7 @@ rcv_window_update_frame(Http2ConnectionState &cstate, const Http2Frame &frame)
       return Http2Error(Http2ErrorClass::HTTP2_ERROR_CLASS_CONNECTION, error);
     }
 
+    cstate.mark_flow_control_unblocked();
     cstate.restart_streams();
   } else {
     // Stream level window update
@@ -846,6 +877,9 @@ rcv_window_update_frame(Http2ConnectionState &cstate, const Http2Frame &frame)
     }
 
     ssize_t wnd = std::min(cstate.client_rwnd(), stream->client_rwnd());
+    if (wnd > 0) {
+      cstate.mark_flow_control_unblocked();
+    }
     if (!stream->is_closed() && stream->get_state() == Http2StreamState::HTTP2_STREAM_STATE_HALF_CLOSED_REMOTE && wnd > 0) {
       SCOPED_MUTEX_LOCK(lock, stream->mutex, this_ethread());
       stream->restart_sending();
@@ -941,6 +975,10 @@ rcv_continuation_frame(Http2ConnectionState &cstate, const Http2Frame &frame)
       }
     }
 
+    if (Http2::stream_priority_enabled) {
+      set_priority_from_field(cstate, stream);
+    }
+
     // Set up the State Machine
     SCOPED_MUTEX_LOCK(stream_lock, stream->mutex, this_ethread());
     stream->mark_milestone(Http2StreamMilestone::START_TXN);
@@ -957,6 +995,81 @@ rcv_continuation_frame(Http2ConnectionState &cstate, const Http2Frame &frame)
   return Http2Error(Http2ErrorClass::HTTP2_ERROR_CLASS_NONE);
 }
 
+// [RFC 9218] 7.1. The PRIORITY_UPDATE Frame
+static Http2Error
+rcv_priority_update_frame(Http2ConnectionState &cstate, const Http2Frame &frame)
+{
+  const uint32_t payload_length = frame.header().length;
+
+  //  PRIORITY_UPDATE frames are always sent on the control stream, the prioritized stream is in the payload.
+  if (frame.header().streamid != 0) {
+    return Http2Error(Http2ErrorClass::HTTP2_ERROR_CLASS_CONNECTION, Http2ErrorCode::HTTP2_ERROR_PROTOCOL_ERROR,
+                      "priority update on a stream");
+  }
+
+  if (payload_length < sizeof(uint32_t)) {
+    return Http2Error(Http2ErrorClass::HTTP2_ERROR_CLASS_CONNECTION, Http2ErrorCode::HTTP2_ERROR_FRAME_SIZE_ERROR,
+                      "priority update bad length");
+  }
+
+  // Without the Extensible Priorities it is an extension frame like any other
+  if (!Http2::stream_priority_enabled || !cstate.dependency_tree->is_extensible()) {
+    return Http2Error(Http2ErrorClass::HTTP2_ERROR_CLASS_NONE);
+  }
+
+  uint8_t buf[sizeof(uint32_t)] = {0};
+  frame.reader()->memcpy(buf, sizeof(buf), 0);
+  const Http2StreamId stream_id = ((buf[0] & 0x7f) << 24) | (buf[1] << 16) | (buf[2] << 8) | buf[3];
+
+  // Only the client opens the streams that it may prioritize
+  if (stream_id == 0 || !http2_is_client_streamid(stream_id)) {
+    return Http2Error(Http2ErrorClass::HTTP2_ERROR_CLASS_CONNECTION, Http2ErrorCode::HTTP2_ERROR_PROTOCOL_ERROR,
+                      "priority update bad stream");
+  }
+
+  // Same limit as PRIORITY frames, they cost about the same
+  cstate.increment_received_priority_frame_count();
+  if (Http2::max_priority_frames_per_minute != 0 &&
+      cstate.get_received_priority_frame_count() > Http2::max_priority_frames_per_minute) {
+    HTTP2_INCREMENT_THREAD_DYN_STAT(HTTP2_STAT_MAX_PRIORITY_FRAMES_PER_MINUTE_EXCEEDED, this_ethread());
+    Http2StreamDebug(cstate.ua_session, stream_id,
+                     "Observed too frequent priority changes: %u priority changes within a last minute",
+                     cstate.get_received_priority_frame_count());
+    return Http2Error(Http2ErrorClass::HTTP2_ERROR_CLASS_CONNECTION, Http2ErrorCode::HTTP2_ERROR_ENHANCE_YOUR_CALM,
+                      "recv priority update too frequent priority changes");
+  }
+
+  ts::LocalBuffer<char> field_buf(payload_length - sizeof(uint32_t));
+  char *field = field_buf.data();
+  frame.reader()->memcpy(field, payload_length - sizeof(uint32_t), sizeof(uint32_t));
+
+  uint8_t urgency  = HTTP2_PRIORITY_DEFAULT_URGENCY;
+  bool incremental = false;
+  if (!http2_parse_priority_field(std::string_view{field, payload_length - sizeof(uint32_t)}, urgency, incremental)) {
+    return Http2Error(Http2ErrorClass::HTTP2_ERROR_CLASS_CONNECTION, Http2ErrorCode::HTTP2_ERROR_PROTOCOL_ERROR,
+                      "priority update parse error");
+  }
+
+  Http2StreamDebug(cstate.ua_session, stream_id, "PRIORITY_UPDATE - urgency: %u, incremental: %d, tree size: %d", urgency,
+                   incremental, cstate.dependency_tree->size());
+
+  Http2DependencyTree::Node *node = cstate.dependency_tree->find(stream_id);
+  if (node == nullptr) {
+    // Closed streams are gone for good, a stream still to be opened holds the priority until its HEADERS, within the same
+    // limit as PRIORITY frames sent ahead.
+    if (stream_id <= cstate.get_latest_stream_id_in() ||
+        Http2::max_concurrent_streams_in <= cstate.dependency_tree->size() - cstate.get_client_stream_count() + 1) {
+      return Http2Error(Http2ErrorClass::HTTP2_ERROR_CLASS_NONE);
+    }
+    node = cstate.dependency_tree->add(HTTP2_PRIORITY_DEFAULT_STREAM_DEPENDENCY, stream_id, HTTP2_PRIORITY_DEFAULT_WEIGHT, false,
+                                       nullptr);
+  }
+  cstate.dependency_tree->set_urgency(node, urgency, incremental);
+  node->priority_updated = true;
+
+  return Http2Error(Http2ErrorClass::HTTP2_ERROR_CLASS_NONE);
+}
+
 static const http2_frame_dispatch frame_handlers[HTTP2_FRAME_TYPE_MAX] = {
   rcv_data_frame,          // HTTP2_FRAME_TYPE_DATA
   rcv_headers_frame,       // HTTP2_FRAME_TYPE_HEADERS
@@ -1036,7 +1149,7 @@ Http2ConnectionState::main_event_handler(int event, void *edata)
 
     // [RFC 7540] 5.5. Extending HTTP/2
     //   Implementations MUST discard frames that have unknown or unsupported types.
-    if (frame->header().type >= HTTP2_FRAME_TYPE_MAX) {
+    if (frame->header().type >= HTTP2_FRAME_TYPE_MAX && frame->header().type != HTTP2_FRAME_TYPE_PRIORITY_UPDATE) {
       Http2StreamDebug(ua_session, stream_id, "Discard a frame which has unknown type, type=%x", frame->header().type);
       break;
     }
@@ -1052,6 +1165,7 @@ Http2ConnectionState::main_event_handler(int event, void *edata)
     // GOAWAY:        NO
     // WINDOW_UPDATE: YES
     // CONTINUATION:  YES (safe http methods only, same as HEADERS frame).
+    // PRIORITY_UPDATE: YES
     if (frame->is_from_early_data() &&
         (frame->header().type == HTTP2_FRAME_TYPE_DATA || frame->header().type == HTTP2_FRAME_TYPE_RST_STREAM ||
          frame->header().type == HTTP2_FRAME_TYPE_PUSH_PROMISE || frame->header().type == HTTP2_FRAME_TYPE_GOAWAY)) {
@@ -1060,7 +1174,9 @@ Http2ConnectionState::main_event_handler(int event, void *edata)
       break;
     }
 
-    if (frame_handlers[frame->header().type]) {
+    if (frame->header().type == HTTP2_FRAME_TYPE_PRIORITY_UPDATE) {
+      error = rcv_priority_update_frame(*this, *frame);
+    } else if (frame_handlers[frame->header().type]) {
       error = frame_handlers[frame->header().type](*this, *frame);
     } else {
       error = Http2Error(Http2ErrorClass::HTTP2_ERROR_CLASS_CONNECTION, Http2ErrorCode::HTTP2_ERROR_INTERNAL_ERROR, "no handler");
@@ -1209,6 +1325,13 @@ Http2ConnectionState::create_stream(Http2StreamId new_id, Http2Error &error)
                          "recv headers creating inbound stream beyond max_concurrent limit");
       return nullptr;
     }
+    // The client may retry a refused stream, on another connection or once the pressure is off.
+    if (ats_memory_pressure_level() >= MEMORY_PRESSURE_HARD) {
+      HTTP2_INCREMENT_THREAD_DYN_STAT(HTTP2_STAT_MEMORY_PRESSURE_REFUSED_STREAMS, this_ethread());
+      error = Http2Error(Http2ErrorClass::HTTP2_ERROR_CLASS_STREAM, Http2ErrorCode::HTTP2_ERROR_REFUSED_STREAM,
+                         "refused to create new stream under memory pressure");
+      return nullptr;
+    }
   } else {
     if (client_streams_out_count >= client_settings.get(HTTP2_SETTINGS_MAX_CONCURRENT_STREAMS)) {
       error = Http2Error(Http2ErrorClass::HTTP2_ERROR_CLASS_STREAM, Http2ErrorCode::HTTP2_ERROR_REFUSED_STREAM,
@@ -1218,7 +1341,9 @@ Http2ConnectionState::create_stream(Http2StreamId new_id, Http2Error &error)
   }
 
   Http2Stream *new_stream = THREAD_ALLOC_INIT(http2StreamAllocator, this_ethread());
-  new_stream->init(new_id, client_settings.get(HTTP2_SETTINGS_INITIAL_WINDOW_SIZE));
+  HdrHeap *req_heap       = take_header_heap();
+  HdrHeap *resp_heap      = take_header_heap();
+  new_stream->init(new_id, client_settings.get(HTTP2_SETTINGS_INITIAL_WINDOW_SIZE), req_heap, resp_heap);
 
   ink_assert(nullptr != new_stream);
   ink_assert(!stream_list.in(new_stream));
@@ -1302,8 +1427,12 @@ Http2ConnectionState::restart_streams()
 void
 Http2ConnectionState::restart_receiving(Http2Stream *stream)
 {
-  uint32_t initial_rwnd = this->server_settings.get(HTTP2_SETTINGS_INITIAL_WINDOW_SIZE);
+  uint32_t initial_rwnd = this->_receive_window_size();
   uint32_t min_rwnd     = std::min(initial_rwnd, this->server_settings.get(HTTP2_SETTINGS_MAX_FRAME_SIZE));
+  // Don't let a grown window drain all the way before it is topped up
+  if (this->_autotuned_rwnd != 0) {
+    min_rwnd = std::max(min_rwnd, initial_rwnd / 2);
+  }
 
   // Connection level WINDOW UPDATE
   if (this->server_rwnd() < min_rwnd) {
@@ -1328,10 +1457,90 @@ Http2ConnectionState::restart_receiving(Http2Stream *stream)
   this->send_window_update_frame(stream->get_id(), diff_size);
 }
 
+uint32_t
+Http2ConnectionState::_receive_window_size() const
+{
+  return std::max(this->server_settings.get(HTTP2_SETTINGS_INITIAL_WINDOW_SIZE), this->_autotuned_rwnd);
+}
+
+// Opaque data of the PINGs that time the round trip
+static const uint8_t HTTP2_BDP_PING_OPAQUE[HTTP2_PING_LEN] = {'A', 'T', 'S', '-', 'B', 'D', 'P', 0};
+
+// [BDP estimation] While a PING is out, counts the DATA that comes in. By the time the ACK is back that is what the client
+// can have in flight for one round trip, the bandwidth-delay product. If it comes near the receive window, the window is
+// what limits the client, so the window grows to twice the product, up to Http2::max_window_size.
+void
+Http2ConnectionState::sample_received_data(size_t length)
+{
+  if (Http2::max_window_size == 0 || this->_receive_window_size() >= Http2::max_window_size) {
+    return;
+  }
+
+  if (this->_bdp_ping_sent_at == 0) {
+    this->_bdp_ping_sent_at = Thread::get_hrtime();
+    this->_bdp_received     = 0;
+    this->send_ping_frame(0, HTTP2_FRAME_NO_FLAG, HTTP2_BDP_PING_OPAQUE);
+  }
+  this->_bdp_received += length;
+}
+
+// Returns true if @a opaque_data is that of the PING sent by sample_received_data().
+bool
+Http2ConnectionState::recv_ping_ack(const uint8_t *opaque_data)
+{
+  if (this->_bdp_ping_sent_at == 0 || memcmp(opaque_data, HTTP2_BDP_PING_OPAQUE, HTTP2_PING_LEN) != 0) {
+    return false;
+  }
+
+  ink_hrtime rtt          = Thread::get_hrtime() - this->_bdp_ping_sent_at;
+  this->_bdp_ping_sent_at = 0;
+
+  uint32_t rwnd = this->_receive_window_size();
+  if (this->_bdp_received * 3 < static_cast<size_t>(rwnd) * 2) {
+    return true;
+  }
+
+  uint32_t new_rwnd = std::min({static_cast<size_t>(Http2::max_window_size), static_cast<size_t>(HTTP2_MAX_WINDOW_SIZE),
+                                this->_bdp_received * 2});
+  if (new_rwnd <= rwnd) {
+    return true;
+  }
+
+  Http2ConDebug(ua_session, "Receive window %u -> %u, bdp=%zu rtt=%" PRId64 "ms", rwnd, new_rwnd, this->_bdp_received,
+                ink_hrtime_to_msec(rtt));
+  this->_autotuned_rwnd = new_rwnd;
+
+  // The connection gets the growth right away, the streams when they are next topped up
+  this->increment_server_rwnd(new_rwnd - rwnd);
+  this->send_window_update_frame(0, new_rwnd - rwnd);
+
+  return true;
+}
+
+void
+Http2ConnectionState::mark_flow_control_blocked()
+{
+  if (this->_blocked_since == 0) {
+    this->_blocked_since = Thread::get_hrtime();
+  }
+}
+
+void
+Http2ConnectionState::mark_flow_control_unblocked()
+{
+  if (this->_blocked_since != 0) {
+    HTTP2_SUM_THREAD_DYN_STAT(HTTP2_STAT_FLOW_CONTROL_BLOCKED_TIME, this_ethread(),
+                              ink_hrtime_to_msec(Thread::get_hrtime() - this->_blocked_since));
+    this->_blocked_since = 0;
+  }
+}
+
 void
 Http2ConnectionState::cleanup_streams()
 {
-  Http2Stream *s = stream_list.head;
+  // Close all the streams in one pass, the session is only released once at the end.
+  in_cleanup_streams = true;
+  Http2Stream *s     = stream_list.head;
   while (s) {
     Http2Stream *next = static_cast<Http2Stream *>(s->link.next);
     if (this->rx_error_code.cls != ProxyErrorClass::NONE) {
@@ -1344,6 +1553,7 @@ Http2ConnectionState::cleanup_streams()
     ink_assert(s != next);
     s = next;
   }
+  in_cleanup_streams = false;
 
   if (!is_state_closed()) {
     SCOPED_MUTEX_LOCK(lock, this->ua_session->mutex, this_ethread());
@@ -1386,7 +1596,8 @@ Http2ConnectionState::delete_stream(Http2Stream *stream)
     stream->priority_node = nullptr;
   }
 
-  if (stream->get_state() != Http2StreamState::HTTP2_STREAM_STATE_CLOSED) {
+  // The whole connection is going away in cleanup_streams(), resetting each stream is of no use.
+  if (stream->get_state() != Http2StreamState::HTTP2_STREAM_STATE_CLOSED && !in_cleanup_streams) {
     send_rst_stream_frame(stream->get_id(), Http2ErrorCode::HTTP2_ERROR_NO_ERROR);
   }
 
@@ -1411,6 +1622,10 @@ Http2ConnectionState::release_stream()
 {
   REMEMBER(NO_EVENT, this->recursion)
 
+  if (in_cleanup_streams) {
+    return;
+  }
+
   SCOPED_MUTEX_LOCK(lock, this->mutex, this_ethread());
   if (this->ua_session) {
     ink_assert(this->mutex == ua_session->mutex);
@@ -1448,6 +1663,40 @@ Http2ConnectionState::release_stream()
   }
 }
 
+HdrHeap *
+Http2ConnectionState::take_header_heap()
+{
+  if (_n_header_heaps == 0) {
+    return nullptr;
+  }
+  HTTP2_INCREMENT_THREAD_DYN_STAT(HTTP2_STAT_HEADER_HEAPS_REUSED, this_ethread());
+  return _header_heaps[--_n_header_heaps];
+}
+
+void
+Http2ConnectionState::recycle_header(HTTPHdr &hdr)
+{
+  HdrHeap *heap = hdr.m_heap;
+  int limit     = std::min<int>(Http2::header_heap_cache_size, HEADER_HEAP_CACHE_MAX);
+
+  // Only the default size is kept, larger heaps would pin the memory of a few big headers.
+  if (heap == nullptr || in_destroy || _n_header_heaps >= limit || heap->m_size != HdrHeap::DEFAULT_SIZE ||
+      ats_memory_pressure_level() >= MEMORY_PRESSURE_SOFT) {
+    return;
+  }
+  hdr.clear();
+  heap->reset();
+  _header_heaps[_n_header_heaps++] = heap;
+}
+
+void
+Http2ConnectionState::free_header_heaps()
+{
+  while (_n_header_heaps > 0) {
+    _header_heaps[--_n_header_heaps]->destroy();
+  }
+}
+
 void
 Http2ConnectionState::update_initial_rwnd(Http2WindowSize new_size)
 {
@@ -1477,56 +1726,75 @@ Http2ConnectionState::schedule_stream(Http2Stream *stream)
   }
 }
 
+// Sends DATA frames from the streams in priority order, up to Http2::write_batch_size bytes of them, and hands them to the
+// network in one write.
 void
 Http2ConnectionState::send_data_frames_depends_on_priority()
 {
-  Http2DependencyTree::Node *node = dependency_tree->top();
+  size_t batch_len = 0;
 
-  // No node to send or no connection level window left
-  if (node == nullptr || _client_rwnd <= 0) {
-    return;
-  }
+  do {
+    Http2DependencyTree::Node *node = dependency_tree->top();
 
-  Http2Stream *stream = static_cast<Http2Stream *>(node->t);
-  ink_release_assert(stream != nullptr);
-  Http2StreamDebug(ua_session, stream->get_id(), "top node, point=%d", node->point);
+    // No node to send or no connection level window left
+    if (node == nullptr || _client_rwnd <= 0) {
+      break;
+    }
 
-  size_t len                      = 0;
-  Http2SendDataFrameResult result = send_a_data_frame(stream, len);
+    Http2Stream *stream = static_cast<Http2Stream *>(node->t);
+    ink_release_assert(stream != nullptr);
+    Http2StreamDebug(ua_session, stream->get_id(), "top node, point=%" PRIu64, node->point);
 
-  switch (result) {
-  case Http2SendDataFrameResult::NO_ERROR: {
-    // No response body to send
-    if (len == 0 && !stream->is_write_vio_done()) {
-      dependency_tree->deactivate(node, len);
-    } else {
-      dependency_tree->update(node, len);
+    size_t len                      = 0;
+    Http2SendDataFrameResult result = send_a_data_frame(stream, len, false);
+    batch_len += len;
 
-      SCOPED_MUTEX_LOCK(stream_lock, stream->mutex, this_ethread());
-      stream->signal_write_event(true);
+    switch (result) {
+    case Http2SendDataFrameResult::NO_ERROR: {
+      // No response body to send
+      if (len == 0 && !stream->is_write_vio_done()) {
+        dependency_tree->deactivate(node, len);
+      } else {
+        dependency_tree->update(node, len);
+
+        SCOPED_MUTEX_LOCK(stream_lock, stream->mutex, this_ethread());
+        stream->signal_write_event(true);
+      }
+      break;
     }
-    break;
-  }
-  case Http2SendDataFrameResult::DONE: {
-    dependency_tree->deactivate(node, len);
-    stream->initiating_close();
-    break;
-  }
-  default:
-    // When no stream level window left, deactivate node once and wait window_update frame
-    dependency_tree->deactivate(node, len);
-    break;
-  }
+    case Http2SendDataFrameResult::DONE: {
+      dependency_tree->deactivate(node, len);
+      stream->initiating_close();
+      break;
+    }
+    case Http2SendDataFrameResult::NOT_WRITE_AVAIL:
+      // Wait for the network to drain the write buffer
+      dependency_tree->deactivate(node, len);
+      batch_len = Http2::write_batch_size;
+      break;
+    default:
+      // When no stream level window left, deactivate node once and wait window_update frame
+      dependency_tree->deactivate(node, len);
+      break;
+    }
+  } while (batch_len < Http2::write_batch_size);
 
-  this_ethread()->schedule_imm_local((Continuation *)this, HTTP2_SESSION_EVENT_XMIT);
-  return;
+  this->ua_session->flush();
+
+  if (dependency_tree->top() != nullptr && _client_rwnd > 0) {
+    this_ethread()->schedule_imm_local((Continuation *)this, HTTP2_SESSION_EVENT_XMIT);
+  }
 }
 
 Http2SendDataFrameResult
-Http2ConnectionState::send_a_data_frame(Http2Stream *stream, size_t &payload_length)
+Http2ConnectionState::send_a_data_frame(Http2Stream *stream, size_t &payload_length, bool flush)
 {
-  const ssize_t window_size         = std::min(this->client_rwnd(), stream->client_rwnd());
-  const size_t buf_len              = BUFFER_SIZE_FOR_INDEX(buffer_size_index[HTTP2_FRAME_TYPE_DATA]);
+  const ssize_t window_size = std::min(this->client_rwnd(), stream->client_rwnd());
+  size_t buf_len            = BUFFER_SIZE_FOR_INDEX(buffer_size_index[HTTP2_FRAME_TYPE_DATA]);
+  // Leave room for the frame header so that a full frame fills a record exactly
+  if (Http2::write_record_size > HTTP2_FRAME_HEADER_LEN) {
+    buf_len = std::min(buf_len, static_cast<size_t>(Http2::write_record_size - HTTP2_FRAME_HEADER_LEN));
+  }
   const size_t write_available_size = std::min(buf_len, static_cast<size_t>(window_size));
   payload_length                    = 0;
 
@@ -1550,6 +1818,7 @@ Http2ConnectionState::send_a_data_frame(Http2Stream *stream, size_t &payload_len
     // We only need to check for window size when there is a payload
     if (window_size <= 0) {
       Http2StreamDebug(this->ua_session, stream->get_id(), "No window");
+      this->mark_flow_control_blocked();
       return Http2SendDataFrameResult::NO_WINDOW;
     }
 
@@ -1583,7 +1852,7 @@ Http2ConnectionState::send_a_data_frame(Http2Stream *stream, size_t &payload_len
                    _client_rwnd, stream->client_rwnd(), payload_length);
 
   Http2DataFrame data(stream->get_id(), flags, resp_reader, payload_length);
-  this->ua_session->xmit(data);
+  this->ua_session->xmit(data, flush);
 
   stream->update_sent_count(payload_length);
 
@@ -1614,7 +1883,7 @@ Http2ConnectionState::send_data_frames(Http2Stream *stream)
   size_t len                      = 0;
   Http2SendDataFrameResult result = Http2SendDataFrameResult::NO_ERROR;
   while (result == Http2SendDataFrameResult::NO_ERROR) {
-    result = send_a_data_frame(stream, len);
+    result = send_a_data_frame(stream, len, false);
 
     if (result == Http2SendDataFrameResult::DONE) {
       // Delete a stream immediately
@@ -1626,6 +1895,7 @@ Http2ConnectionState::send_data_frames(Http2Stream *stream)
     }
   }
 
+  this->ua_session->flush();
   return;
 }
 
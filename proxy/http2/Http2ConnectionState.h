@@ -140,7 +140,8 @@ public:
     local_hpack_handle  = new HpackHandle(HTTP2_HEADER_TABLE_SIZE);
     remote_hpack_handle = new HpackHandle(HTTP2_HEADER_TABLE_SIZE);
     if (Http2::stream_priority_enabled) {
-      dependency_tree = new DependencyTree(Http2::max_concurrent_streams_in);
+      // 2 is for the Extensible Priorities of RFC 9218 rather than the dependencies of RFC 7540
+      dependency_tree = new DependencyTree(Http2::max_concurrent_streams_in, Http2::stream_priority_enabled == 2);
     }
 
     _cop = ActivityCop<Http2Stream>(this->mutex, &stream_list, 1);
@@ -163,6 +164,7 @@ public:
       shutdown_cont_event = nullptr;
     }
     cleanup_streams();
+    free_header_heaps();
 
     delete local_hpack_handle;
     local_hpack_handle = nullptr;
@@ -196,6 +198,16 @@ public:
   void restart_receiving(Http2Stream *stream);
   void update_initial_rwnd(Http2WindowSize new_size);
 
+  // Header heaps of finished streams, kept for the headers of the next ones
+  HdrHeap *take_header_heap();
+  void recycle_header(HTTPHdr &hdr);
+
+  // Receive window autotuning and flow control accounting
+  void sample_received_data(size_t length);
+  bool recv_ping_ack(const uint8_t *opaque_data);
+  void mark_flow_control_blocked();
+  void mark_flow_control_unblocked();
+
   Http2StreamId
   get_latest_stream_id_in() const
   {
@@ -271,7 +283,7 @@ public:
   void schedule_stream(Http2Stream *stream);
   void send_data_frames_depends_on_priority();
   void send_data_frames(Http2Stream *stream);
-  Http2SendDataFrameResult send_a_data_frame(Http2Stream *stream, size_t &payload_length);
+  Http2SendDataFrameResult send_a_data_frame(Http2Stream *stream, size_t &payload_length, bool flush = true);
   void send_headers_frame(Http2Stream *stream);
   bool send_push_promise_frame(Http2Stream *stream, URL &url, const MIMEField *accept_encoding);
   void send_rst_stream_frame(Http2StreamId id, Http2ErrorCode ec);
@@ -354,6 +366,8 @@ public:
 
 private:
   unsigned _adjust_concurrent_stream();
+  uint32_t _receive_window_size() const;
+  void free_header_heaps();
 
   // NOTE: 'stream_list' has only active streams.
   //   If given Stream Identifier is not found in stream_list and it is less
@@ -385,6 +399,17 @@ private:
   std::vector<size_t> _recent_rwnd_increment = {SIZE_MAX, SIZE_MAX, SIZE_MAX, SIZE_MAX, SIZE_MAX};
   int _recent_rwnd_increment_index           = 0;
 
+  // Receive window grown by BDP estimation, zero until it grows beyond the initial window
+  uint32_t _autotuned_rwnd     = 0;
+  ink_hrtime _bdp_ping_sent_at = 0;
+  size_t _bdp_received         = 0;
+  ink_hrtime _blocked_since    = 0;
+
+  // At most Http2::header_heap_cache_size of them
+  static constexpr int HEADER_HEAP_CACHE_MAX    = 32;
+  HdrHeap *_header_heaps[HEADER_HEAP_CACHE_MAX] = {};
+  int _n_header_heaps                           = 0;
+
   Http2FrequencyCounter _received_settings_counter;
   Http2FrequencyCounter _received_settings_frame_counter;
   Http2FrequencyCounter _received_ping_frame_counter;
@@ -401,6 +426,7 @@ private:
   bool _scheduled                   = false;
   bool fini_received                = false;
   bool in_destroy                   = false;
+  bool in_cleanup_streams           = false; // Streams closed by cleanup_streams() leave release_stream() to it
   int recursion                     = 0;
   Http2ShutdownState shutdown_state = HTTP2_SHUTDOWN_NONE;
   Http2ErrorCode shutdown_reason    = Http2ErrorCode::HTTP2_ERROR_MAX;
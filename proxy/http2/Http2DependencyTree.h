@@ -30,6 +30,9 @@
 #include "tscore/Diags.h"
 #include "tscore/PriorityQueue.h"
 
+#include <algorithm>
+#include <unordered_map>
+
 #include "HTTP2.h"
 
 // TODO: K is a constant, 256 is temporal value.
@@ -76,16 +79,17 @@ public:
 
   LINK(Node, link);
 
+  // A lower urgency always goes first, the urgencies only differ with RFC 9218 priorities.
   bool
   operator<(const Node &n) const
   {
-    return point < n.point;
+    return urgency != n.urgency ? urgency < n.urgency : point < n.point;
   }
 
   bool
   operator>(const Node &n) const
   {
-    return point > n.point;
+    return urgency != n.urgency ? urgency > n.urgency : point > n.point;
   }
 
   /**
@@ -104,20 +108,42 @@ public:
   bool shadow     = false;
   uint32_t id     = HTTP2_PRIORITY_DEFAULT_STREAM_DEPENDENCY;
   uint32_t weight = HTTP2_PRIORITY_DEFAULT_WEIGHT;
-  uint32_t point  = 0;
-  void *t         = nullptr;
-  Node *parent    = nullptr;
+  /// Virtual finish time, the child with the lowest goes next. 64 bits so that it never wraps.
+  uint64_t point = 0;
+  /// Virtual time of this node's queue, the point of the child served last. A child that joins the
+  /// queue starts from here rather than from where it stopped, so it can't make up for time idle.
+  uint64_t vtime = 0;
+  /// [RFC 9218] 4. Priority Parameters
+  uint8_t urgency  = HTTP2_PRIORITY_DEFAULT_URGENCY;
+  bool incremental = false;
+  /// A PRIORITY_UPDATE frame set the priority, the priority field of the request doesn't count.
+  bool priority_updated = false;
+  void *t               = nullptr;
+  Node *parent          = nullptr;
   DLL<Node> children;
   PriorityQueueEntry<Node *> *entry;
   PriorityQueue<Node *> *queue;
 };
 
+/** Streams scheduled by weighted fair queuing, each node keeping a priority queue of its children by virtual finish time.
+
+    Choosing the next stream follows the top of each queue on the way down, so costs O(depth), and
+    charging it for what was sent costs O(log n) at each level on the way up. Nodes are found by
+    stream id through a hash index.
+
+    With @a extensible the tree schedules by RFC 9218 Extensible Priorities instead of the
+    dependencies of RFC 7540. Every stream is a child of the root, a lower urgency always goes
+    first and within an urgency incremental streams share the bandwidth by turns while the others
+    are sent one after another in stream id order.
+ */
 template <typename T> class Tree
 {
 public:
-  explicit Tree(uint32_t max_concurrent_streams) : _max_depth(MIN(max_concurrent_streams, HTTP2_DEPENDENCY_TREE_MAX_DEPTH))
+  explicit Tree(uint32_t max_concurrent_streams, bool extensible = false)
+    : _max_depth(MIN(max_concurrent_streams, HTTP2_DEPENDENCY_TREE_MAX_DEPTH)), _extensible(extensible)
   {
     _ancestors.resize(_max_ancestors);
+    _index[_root->id] = _root;
   }
   ~Tree() { delete _root; }
   Node *find(uint32_t id, bool *is_max_leaf = nullptr);
@@ -130,8 +156,16 @@ public:
   void activate(Node *node);
   void deactivate(Node *node, uint32_t sent);
   void update(Node *node, uint32_t sent);
+  /// Move @a node to the RFC 9218 @a urgency and @a incremental.
+  void set_urgency(Node *node, uint8_t urgency, bool incremental);
   bool in(Node *current, Node *node);
   uint32_t size() const;
+
+  bool
+  is_extensible() const
+  {
+    return _extensible;
+  }
   /*
    * Dump the priority tree relationships in JSON form for debugging
    */
@@ -145,14 +179,17 @@ public:
 
 private:
   void _dump(Node *node, std::ostream &output) const;
-  Node *_find(Node *node, uint32_t id, uint32_t depth = 1, bool *is_max_leaf = nullptr);
+  Node *_find(uint32_t id, bool *is_max_leaf = nullptr);
   Node *_top(Node *node);
+  void _enqueue(Node *node);
   void _change_parent(Node *node, Node *new_parent, bool exclusive);
   bool in_parent_chain(Node *maybe_parent, Node *target);
 
   Node *_root = new Node(this);
   uint32_t _max_depth;
+  bool _extensible;
   uint32_t _node_count = 0;
+  std::unordered_map<uint32_t, Node *> _index;
   /*
    * _ancestors in a circular buffer tracking parent relationships for
    * recently completed nodes.  Without this new streams may not find their
@@ -182,7 +219,11 @@ void
 Tree<T>::_dump(Node *node, std::ostream &output) const
 {
   output << R"({ "id":")" << node->id << "/" << node->weight << "/" << node->point << "/" << ((node->t != nullptr) ? "1" : "0")
-         << "/" << ((node->active) ? "a" : "d") << "\",";
+         << "/" << ((node->active) ? "a" : "d");
+  if (_extensible) {
+    output << "/u=" << static_cast<int>(node->urgency) << (node->incremental ? ",i" : "");
+  }
+  output << "\",";
   // Dump the children
   output << " \"c\":[";
   for (Node *n = node->children.head; n; n = n->link.next) {
@@ -194,42 +235,49 @@ Tree<T>::_dump(Node *node, std::ostream &output) const
 
 template <typename T>
 Node *
-Tree<T>::_find(Node *node, uint32_t id, uint32_t depth, bool *is_max_leaf)
+Tree<T>::_find(uint32_t id, bool *is_max_leaf)
 {
-  if (node->id == id) {
-    if (is_max_leaf) {
-      *is_max_leaf = depth == _max_depth;
-    }
-    return node;
-  }
-
-  if (node->children.empty() || depth > _max_depth) {
+  auto spot = _index.find(id);
+  if (spot == _index.end()) {
     return nullptr;
   }
 
-  Node *result = nullptr;
-  for (Node *n = node->children.head; n; n = n->link.next) {
-    result = _find(n, id, ++depth, is_max_leaf);
-    if (result != nullptr) {
-      break;
+  Node *node = spot->second;
+  if (is_max_leaf) {
+    uint32_t depth = 1;
+    for (Node *n = node; n->parent != nullptr; n = n->parent) {
+      ++depth;
     }
+    *is_max_leaf = depth >= _max_depth;
   }
+  return node;
+}
 
-  return result;
+// Puts @a node in its parent's queue, not before the virtual time of that queue.
+template <typename T>
+void
+Tree<T>::_enqueue(Node *node)
+{
+  // Non incremental streams of RFC 9218 keep their stream id order.
+  if (!_extensible || node->incremental) {
+    node->point = std::max(node->point, node->parent->vtime);
+  }
+  node->parent->queue->push(node->entry);
+  node->queued = true;
 }
 
 template <typename T>
 Node *
 Tree<T>::find_shadow(uint32_t id, bool *is_max_leaf)
 {
-  return _find(_root, id, 1, is_max_leaf);
+  return _find(id, is_max_leaf);
 }
 
 template <typename T>
 Node *
 Tree<T>::find(uint32_t id, bool *is_max_leaf)
 {
-  Node *n = _find(_root, id, 1, is_max_leaf);
+  Node *n = _find(id, is_max_leaf);
   return n == nullptr ? nullptr : (n->is_shadow() ? nullptr : n);
 }
 
@@ -265,6 +313,13 @@ template <typename T>
 Node *
 Tree<T>::add(uint32_t parent_id, uint32_t id, uint32_t weight, bool exclusive, T t, bool shadow)
 {
+  if (_extensible) {
+    // Only RFC 7540 has dependencies
+    parent_id = HTTP2_PRIORITY_DEFAULT_STREAM_DEPENDENCY;
+    weight    = HTTP2_PRIORITY_DEFAULT_WEIGHT;
+    exclusive = false;
+  }
+
   // Can we vivify a shadow node?
   Node *node = find_shadow(id);
   if (node != nullptr && node->is_shadow()) {
@@ -322,10 +377,10 @@ Tree<T>::add(uint32_t parent_id, uint32_t id, uint32_t weight, bool exclusive, T
   parent->children.push(node);
   if (!node->queue->empty()) {
     ink_release_assert(!node->queued);
-    parent->queue->push(node->entry);
-    node->queued = true;
+    _enqueue(node);
   }
   node->shadow = shadow;
+  _index[id]   = node;
   ++_node_count;
   return node;
 }
@@ -388,6 +443,7 @@ Tree<T>::remove(Node *node)
 
   // ink_release_assert(!this->in(nullptr, node));
 
+  _index.erase(node->id);
   --_node_count;
   delete node;
 }
@@ -492,9 +548,8 @@ Tree<T>::_change_parent(Node *node, Node *new_parent, bool exclusive)
   if (node->active || !node->queue->empty()) {
     Node *current = node;
     while (current->parent != nullptr && !current->queued) {
-      current->parent->queue->push(current->entry);
-      current->queued = true;
-      current         = current->parent;
+      _enqueue(current);
+      current = current->parent;
     }
   }
 }
@@ -532,9 +587,8 @@ Tree<T>::activate(Node *node)
   node->active = true;
 
   while (node->parent != nullptr && !node->queued) {
-    node->parent->queue->push(node->entry);
-    node->queued = true;
-    node         = node->parent;
+    _enqueue(node);
+    node = node->parent;
   }
 }
 
@@ -561,7 +615,10 @@ void
 Tree<T>::update(Node *node, uint32_t sent)
 {
   while (node->parent != nullptr) {
-    node->point += sent * K / (node->weight + 1);
+    node->parent->vtime = std::max(node->parent->vtime, node->point);
+    if (!_extensible || node->incremental) {
+      node->point += static_cast<uint64_t>(sent) * K / (node->weight + 1);
+    }
 
     if (node->queued) {
       node->parent->queue->update(node->entry, true);
@@ -574,6 +631,29 @@ Tree<T>::update(Node *node, uint32_t sent)
   }
 }
 
+template <typename T>
+void
+Tree<T>::set_urgency(Node *node, uint8_t urgency, bool incremental)
+{
+  if (node->urgency == urgency && node->incremental == incremental) {
+    return;
+  }
+
+  bool queued = node->queued;
+  if (queued) {
+    node->parent->queue->erase(node->entry);
+    node->queued = false;
+  }
+  node->urgency     = urgency;
+  node->incremental = incremental;
+  if (!incremental) {
+    node->point = node->id;
+  }
+  if (queued) {
+    _enqueue(node);
+  }
+}
+
 template <typename T>
 uint32_t
 Tree<T>::size() const
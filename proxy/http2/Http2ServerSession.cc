@@ -0,0 +1,645 @@
+/** @file
+
+  Http2ServerSession.cc
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "Http2ServerSession.h"
+#include "HttpConfig.h"
+#include "P_Net.h"
+#include "tscpp/util/LocalBuffer.h"
+#include "tscpp/util/PostScript.h"
+
+#include <openssl/ssl.h>
+
+#define Http2ServerSessionDebug(fmt, ...) Debug("http2_origin", "[%p] " fmt, this, ##__VA_ARGS__);
+
+const std::string_view Http2ServerSession::ALPN_PROTOCOLS{"\x02h2\x08http/1.1", 12};
+
+static constexpr Http2StreamId MAX_STREAM_ID = 0x7FFFFFFF;
+
+namespace
+{
+// Connections with room for more streams, per thread like the connections themselves.
+thread_local DLL<Http2ServerSession, Http2ServerSession::Link_pool_link> session_pool;
+} // namespace
+
+bool
+Http2ServerSession::is_h2_negotiated(NetVConnection *netvc)
+{
+  SSLNetVConnection *ssl_vc = dynamic_cast<SSLNetVConnection *>(netvc);
+  if (ssl_vc == nullptr || ssl_vc->ssl == nullptr) {
+    return false;
+  }
+  const unsigned char *proto = nullptr;
+  unsigned int len           = 0;
+  SSL_get0_alpn_selected(ssl_vc->ssl, &proto, &len);
+  return len == 2 && memcmp(proto, "h2", 2) == 0;
+}
+
+Http2ServerSession *
+Http2ServerSession::create(NetVConnection *netvc, CryptoHash const &hostname_hash, OutboundConnTrack::Group *group,
+                           ink_hrtime idle_timeout)
+{
+  Http2ServerSession *session = new Http2ServerSession;
+  session->mutex              = new_ProxyMutex();
+  session->_netvc             = netvc;
+  session->_hostname_hash     = hostname_hash;
+  session->_conn_track_group  = group;
+  session->_idle_timeout      = idle_timeout;
+  ats_ip_copy(&session->_server_ip, netvc->get_remote_addr());
+
+  SCOPED_MUTEX_LOCK(lock, session->mutex, this_ethread());
+  session->start();
+  return session;
+}
+
+void
+Http2ServerSession::start()
+{
+  SET_HANDLER(&Http2ServerSession::main_event_handler);
+  Http2ServerSessionDebug("new connection to origin");
+
+  _decoder      = new HpackHandle(Http2::header_table_size);
+  _encoder      = new HpackHandle(HTTP2_HEADER_TABLE_SIZE);
+  _read_buffer  = new_MIOBuffer(BUFFER_SIZE_INDEX_32K);
+  _reader       = _read_buffer->alloc_reader();
+  _write_buffer = new_MIOBuffer(BUFFER_SIZE_INDEX_32K);
+  _write_reader = _write_buffer->alloc_reader();
+
+  _write_vio = _netvc->do_io_write(this, INT64_MAX, _write_reader);
+  _read_vio  = _netvc->do_io_read(this, INT64_MAX, _read_buffer);
+
+  // The preface is followed by our SETTINGS, and the connection window is opened all the way as
+  // every stream has its own window to keep a slow reader in check.
+  _write_buffer->write(HTTP2_CONNECTION_PREFACE, HTTP2_CONNECTION_PREFACE_LEN);
+  Http2SettingsParameter params[] = {
+    {HTTP2_SETTINGS_ENABLE_PUSH, 0},
+    {HTTP2_SETTINGS_INITIAL_WINDOW_SIZE, Http2::initial_window_size},
+    {HTTP2_SETTINGS_HEADER_TABLE_SIZE, Http2::header_table_size},
+    {HTTP2_SETTINGS_MAX_HEADER_LIST_SIZE, Http2::max_header_list_size},
+  };
+  xmit(Http2SettingsFrame(HTTP2_CONNECTION_CONTROL_STRTEAM, HTTP2_FRAME_NO_FLAG, params, countof(params)));
+  xmit(Http2WindowUpdateFrame(HTTP2_CONNECTION_CONTROL_STRTEAM, HTTP2_MAX_WINDOW_SIZE - HTTP2_INITIAL_WINDOW_SIZE));
+
+  _cop = ActivityCop<Http2ServerStream>(mutex, &_streams, 1);
+  _cop.start();
+  // What HttpSM set up for its connect is replaced by the idle timeout, once the streams are gone.
+  _netvc->cancel_active_timeout();
+  _netvc->set_inactivity_timeout(_idle_timeout);
+
+  session_pool.push(this);
+  _in_pool = true;
+
+  HTTP2_INCREMENT_THREAD_DYN_STAT(HTTP2_STAT_CURRENT_SERVER_SESSION_COUNT, this_ethread());
+  HTTP2_INCREMENT_THREAD_DYN_STAT(HTTP2_STAT_TOTAL_SERVER_CONNECTION_COUNT, this_ethread());
+}
+
+void
+Http2ServerSession::destroy()
+{
+  Http2ServerSessionDebug("destroy");
+  HTTP2_DECREMENT_THREAD_DYN_STAT(HTTP2_STAT_CURRENT_SERVER_SESSION_COUNT, this_ethread());
+
+  delete _decoder;
+  delete _encoder;
+  free_MIOBuffer(_read_buffer);
+  free_MIOBuffer(_write_buffer);
+  mutex.clear();
+  delete this;
+}
+
+void
+Http2ServerSession::leave_pool()
+{
+  if (_in_pool) {
+    session_pool.remove(this);
+    _in_pool = false;
+  }
+}
+
+bool
+Http2ServerSession::has_room() const
+{
+  uint32_t limit = std::min(Http2::origin_max_concurrent_streams, _peer_max_concurrent_streams);
+  return !_goaway && !_closed && static_cast<uint32_t>(_stream_count) < limit && _next_stream_id < MAX_STREAM_ID;
+}
+
+Http2ServerStream *
+Http2ServerSession::acquire_stream(sockaddr const *addr, CryptoHash const &hostname_hash)
+{
+  // First fit, so the load piles onto as few connections as the origin allows.
+  for (Http2ServerSession *session = session_pool.head; session != nullptr; session = session->pool_link.next) {
+    if (session->has_room() && ats_ip_addr_port_eq(&session->_server_ip.sa, addr) && session->_hostname_hash == hostname_hash) {
+      return session->new_stream();
+    }
+  }
+  return nullptr;
+}
+
+Http2ServerStream *
+Http2ServerSession::new_stream()
+{
+  SCOPED_MUTEX_LOCK(lock, this->mutex, this_ethread());
+
+  Http2ServerStream *stream = THREAD_ALLOC_INIT(http2ServerStreamAllocator, this_ethread());
+  stream->init(this);
+  stream->send_window = _peer_initial_window_size;
+  stream->recv_window = Http2::initial_window_size;
+  _streams.push(stream);
+
+  // While there are streams their own timeouts apply, the connection's is only for idling.
+  if (_stream_count++ == 0) {
+    _netvc->cancel_inactivity_timeout();
+  }
+  return stream;
+}
+
+Http2ServerStream *
+Http2ServerSession::find_stream(Http2StreamId id)
+{
+  if (id == 0) {
+    return nullptr;
+  }
+  for (Http2ServerStream *stream = _streams.head; stream != nullptr; stream = stream->link.next) {
+    if (stream->_id == id) {
+      return stream;
+    }
+  }
+  return nullptr;
+}
+
+void
+Http2ServerSession::xmit(const Http2TxFrame &frame)
+{
+  if (_closed) {
+    return;
+  }
+  frame.write_to(_write_buffer);
+  _write_vio->reenable();
+}
+
+bool
+Http2ServerSession::send_headers(Http2ServerStream *stream, HTTPHdr *hdr, bool end_stream)
+{
+  if (_closed || _goaway) {
+    return false;
+  }
+
+  uint32_t buf_len = hdr->length_get() * 2; // Make it double just in case
+  ts::LocalBuffer local_buffer(buf_len);
+  uint8_t *buf = local_buffer.data();
+  uint32_t len = 0;
+  if (http2_encode_header_blocks(hdr, buf, buf_len, &len, *_encoder, _peer_header_table_size) !=
+      Http2ErrorCode::HTTP2_ERROR_NO_ERROR) {
+    // The encoder may have changed its table already, the origin would not be able to follow.
+    connection_error(Http2ErrorCode::HTTP2_ERROR_COMPRESSION_ERROR);
+    return false;
+  }
+
+  stream->_id = _next_stream_id;
+  _next_stream_id += 2;
+
+  uint32_t sent = std::min(len, _peer_max_frame_size);
+  uint8_t flags = end_stream ? HTTP2_FLAGS_HEADERS_END_STREAM : 0;
+  if (sent == len) {
+    flags |= HTTP2_FLAGS_HEADERS_END_HEADERS;
+  }
+  xmit(Http2HeadersFrame(stream->_id, flags, buf, sent));
+  while (sent < len) {
+    uint32_t n = std::min(len - sent, _peer_max_frame_size);
+    flags      = sent + n == len ? HTTP2_FLAGS_CONTINUATION_END_HEADERS : 0;
+    xmit(Http2ContinuationFrame(stream->_id, flags, buf + sent, n));
+    sent += n;
+  }
+  return true;
+}
+
+int64_t
+Http2ServerSession::send_data(Http2ServerStream *stream, IOBufferReader *reader, int64_t len, bool end_stream)
+{
+  if (_closed) {
+    return 0;
+  }
+
+  int64_t sent = 0;
+  while (sent < len) {
+    int64_t n = std::min({len - sent, static_cast<int64_t>(_peer_max_frame_size), static_cast<int64_t>(stream->send_window),
+                          static_cast<int64_t>(_send_window)});
+    if (n <= 0) {
+      // Picked up again by wake() on the next WINDOW_UPDATE or SETTINGS.
+      break;
+    }
+    sent += n;
+    stream->send_window -= n;
+    _send_window -= n;
+    uint8_t flags = end_stream && sent == len ? HTTP2_FLAGS_DATA_END_STREAM : 0;
+    xmit(Http2DataFrame(stream->_id, flags, reader, n));
+  }
+  if (len == 0 && end_stream) {
+    xmit(Http2DataFrame(stream->_id, HTTP2_FLAGS_DATA_END_STREAM, nullptr, 0));
+  }
+  return sent;
+}
+
+void
+Http2ServerSession::send_window_update(Http2StreamId id, uint32_t size)
+{
+  xmit(Http2WindowUpdateFrame(id, size));
+}
+
+void
+Http2ServerSession::stream_done(Http2ServerStream *stream)
+{
+  _streams.remove(stream);
+  --_stream_count;
+  if (stream->_id != 0 && !stream->is_finished() && !stream->_reset) {
+    xmit(Http2RstStreamFrame(stream->_id, static_cast<uint32_t>(Http2ErrorCode::HTTP2_ERROR_CANCEL)));
+  }
+
+  if (_stream_count == 0) {
+    if (_goaway) {
+      close_connection();
+    } else if (!_closed) {
+      _netvc->set_inactivity_timeout(_idle_timeout);
+    }
+  }
+  if (_closed && _stream_count == 0) {
+    destroy();
+  }
+}
+
+int
+Http2ServerSession::main_event_handler(int event, void *edata)
+{
+  switch (event) {
+  case VC_EVENT_READ_READY:
+  case VC_EVENT_READ_COMPLETE:
+    process_frames();
+    break;
+  case VC_EVENT_WRITE_READY:
+  case VC_EVENT_WRITE_COMPLETE:
+    break;
+  case VC_EVENT_EOS:
+  case VC_EVENT_ERROR:
+  case VC_EVENT_ACTIVE_TIMEOUT:
+  case VC_EVENT_INACTIVITY_TIMEOUT:
+  default:
+    Http2ServerSessionDebug("closing on event %s", get_vc_event_name(event));
+    close_connection();
+    break;
+  }
+
+  if (_closed && _stream_count == 0) {
+    destroy();
+  }
+  return EVENT_DONE;
+}
+
+void
+Http2ServerSession::process_frames()
+{
+  while (!_closed) {
+    uint8_t buf[HTTP2_FRAME_HEADER_LEN];
+    if (_reader->read_avail() < static_cast<int64_t>(sizeof(buf))) {
+      break;
+    }
+    _reader->memcpy(buf, sizeof(buf));
+    Http2FrameHeader hdr;
+    http2_parse_frame_header(make_iovec(buf), hdr);
+
+    // We never raise MAX_FRAME_SIZE, so the origin has to stay within the default.
+    if (hdr.length > HTTP2_MAX_FRAME_SIZE) {
+      connection_error(Http2ErrorCode::HTTP2_ERROR_FRAME_SIZE_ERROR);
+      return;
+    }
+    if (!http2_frame_header_is_valid(hdr, HTTP2_MAX_FRAME_SIZE)) {
+      connection_error(Http2ErrorCode::HTTP2_ERROR_PROTOCOL_ERROR);
+      return;
+    }
+    if (_reader->read_avail() < static_cast<int64_t>(sizeof(buf) + hdr.length)) {
+      break;
+    }
+    _reader->consume(sizeof(buf));
+
+    // 6.10 A header block is followed only by its own CONTINUATION frames.
+    if (_continued_stream_id != 0 && (hdr.type != HTTP2_FRAME_TYPE_CONTINUATION || hdr.streamid != _continued_stream_id)) {
+      connection_error(Http2ErrorCode::HTTP2_ERROR_PROTOCOL_ERROR);
+      return;
+    }
+
+    Http2ErrorCode error = process_frame(hdr);
+    if (error != Http2ErrorCode::HTTP2_ERROR_NO_ERROR) {
+      connection_error(error);
+      return;
+    }
+  }
+
+  if (!_closed) {
+    _read_vio->reenable();
+  }
+}
+
+Http2ErrorCode
+Http2ServerSession::process_frame(const Http2FrameHeader &hdr)
+{
+  // DATA stays in the read buffer, the rest is small and copied out.
+  if (hdr.type == HTTP2_FRAME_TYPE_DATA) {
+    return process_data(hdr);
+  }
+
+  ts::LocalBuffer local_buffer(hdr.length);
+  uint8_t *payload = local_buffer.data();
+  _reader->memcpy(payload, hdr.length);
+  _reader->consume(hdr.length);
+
+  switch (hdr.type) {
+  case HTTP2_FRAME_TYPE_HEADERS: {
+    // Responses only come on streams we opened, the odd ids below the next one.
+    if (hdr.streamid == 0 || (hdr.streamid & 1) == 0 || hdr.streamid >= _next_stream_id) {
+      return Http2ErrorCode::HTTP2_ERROR_PROTOCOL_ERROR;
+    }
+    uint32_t offset = 0;
+    uint32_t pad    = 0;
+    if (hdr.flags & HTTP2_FLAGS_HEADERS_PADDED) {
+      if (hdr.length < 1) {
+        return Http2ErrorCode::HTTP2_ERROR_PROTOCOL_ERROR;
+      }
+      pad    = payload[0];
+      offset = 1;
+    }
+    if (hdr.flags & HTTP2_FLAGS_HEADERS_PRIORITY) {
+      offset += HTTP2_PRIORITY_LEN;
+    }
+    if (offset + pad > hdr.length) {
+      return Http2ErrorCode::HTTP2_ERROR_PROTOCOL_ERROR;
+    }
+    _header_block.assign(payload + offset, payload + hdr.length - pad);
+    _continued_end_stream = hdr.flags & HTTP2_FLAGS_HEADERS_END_STREAM;
+    if (hdr.flags & HTTP2_FLAGS_HEADERS_END_HEADERS) {
+      return process_header_block(hdr.streamid);
+    }
+    _continued_stream_id = hdr.streamid;
+    break;
+  }
+  case HTTP2_FRAME_TYPE_CONTINUATION:
+    if (_continued_stream_id == 0) {
+      return Http2ErrorCode::HTTP2_ERROR_PROTOCOL_ERROR;
+    }
+    _header_block.insert(_header_block.end(), payload, payload + hdr.length);
+    if (hdr.flags & HTTP2_FLAGS_CONTINUATION_END_HEADERS) {
+      Http2StreamId id     = _continued_stream_id;
+      _continued_stream_id = 0;
+      return process_header_block(id);
+    }
+    break;
+  case HTTP2_FRAME_TYPE_RST_STREAM: {
+    if (hdr.length != HTTP2_RST_STREAM_LEN) {
+      return Http2ErrorCode::HTTP2_ERROR_FRAME_SIZE_ERROR;
+    }
+    if (hdr.streamid == 0) {
+      return Http2ErrorCode::HTTP2_ERROR_PROTOCOL_ERROR;
+    }
+    if (Http2ServerStream *stream = find_stream(hdr.streamid); stream != nullptr) {
+      stream->recv_reset();
+    }
+    break;
+  }
+  case HTTP2_FRAME_TYPE_SETTINGS:
+    return process_settings(hdr, payload);
+  case HTTP2_FRAME_TYPE_PUSH_PROMISE:
+    // We told the origin in our SETTINGS not to push.
+    return Http2ErrorCode::HTTP2_ERROR_PROTOCOL_ERROR;
+  case HTTP2_FRAME_TYPE_PING:
+    if (hdr.length != HTTP2_PING_LEN) {
+      return Http2ErrorCode::HTTP2_ERROR_FRAME_SIZE_ERROR;
+    }
+    if (hdr.streamid != 0) {
+      return Http2ErrorCode::HTTP2_ERROR_PROTOCOL_ERROR;
+    }
+    if (!(hdr.flags & HTTP2_FLAGS_PING_ACK)) {
+      xmit(Http2PingFrame(HTTP2_CONNECTION_CONTROL_STRTEAM, HTTP2_FLAGS_PING_ACK, payload));
+    }
+    break;
+  case HTTP2_FRAME_TYPE_GOAWAY:
+    return process_goaway(hdr, payload);
+  case HTTP2_FRAME_TYPE_WINDOW_UPDATE:
+    return process_window_update(hdr, payload);
+  default:
+    // PRIORITY and unknown types have nothing for us.
+    break;
+  }
+  return Http2ErrorCode::HTTP2_ERROR_NO_ERROR;
+}
+
+Http2ErrorCode
+Http2ServerSession::process_data(const Http2FrameHeader &hdr)
+{
+  uint32_t len = hdr.length;
+  uint32_t pad = 0;
+  if (hdr.flags & HTTP2_FLAGS_DATA_PADDED) {
+    uint8_t pad_length = 0;
+    if (len < 1) {
+      return Http2ErrorCode::HTTP2_ERROR_PROTOCOL_ERROR;
+    }
+    _reader->memcpy(&pad_length, 1);
+    _reader->consume(1);
+    pad = pad_length;
+    len -= 1;
+    if (pad > len) {
+      return Http2ErrorCode::HTTP2_ERROR_PROTOCOL_ERROR;
+    }
+    len -= pad;
+  }
+
+  // The whole frame counts against the windows, padding included.
+  _recv_window -= hdr.length;
+  if (_recv_window < 0) {
+    return Http2ErrorCode::HTTP2_ERROR_FLOW_CONTROL_ERROR;
+  }
+  if (Http2ServerStream *stream = find_stream(hdr.streamid); stream != nullptr) {
+    stream->recv_data(_reader, len, hdr.length, hdr.flags & HTTP2_FLAGS_DATA_END_STREAM);
+  }
+  _reader->consume(len + pad);
+
+  if (_recv_window < HTTP2_MAX_WINDOW_SIZE / 2) {
+    send_window_update(HTTP2_CONNECTION_CONTROL_STRTEAM, HTTP2_MAX_WINDOW_SIZE - _recv_window);
+    _recv_window = HTTP2_MAX_WINDOW_SIZE;
+  }
+  return Http2ErrorCode::HTTP2_ERROR_NO_ERROR;
+}
+
+Http2ErrorCode
+Http2ServerSession::process_settings(const Http2FrameHeader &hdr, uint8_t *payload)
+{
+  if (hdr.streamid != 0) {
+    return Http2ErrorCode::HTTP2_ERROR_PROTOCOL_ERROR;
+  }
+  if (hdr.flags & HTTP2_FLAGS_SETTINGS_ACK) {
+    return hdr.length == 0 ? Http2ErrorCode::HTTP2_ERROR_NO_ERROR : Http2ErrorCode::HTTP2_ERROR_FRAME_SIZE_ERROR;
+  }
+  if (hdr.length % HTTP2_SETTINGS_PARAMETER_LEN != 0) {
+    return Http2ErrorCode::HTTP2_ERROR_FRAME_SIZE_ERROR;
+  }
+
+  for (uint32_t offset = 0; offset < hdr.length; offset += HTTP2_SETTINGS_PARAMETER_LEN) {
+    Http2SettingsParameter param;
+    if (!http2_parse_settings_parameter(make_iovec(payload + offset, HTTP2_SETTINGS_PARAMETER_LEN), param) ||
+        !http2_settings_parameter_is_valid(param)) {
+      return param.id == HTTP2_SETTINGS_INITIAL_WINDOW_SIZE ? Http2ErrorCode::HTTP2_ERROR_FLOW_CONTROL_ERROR :
+                                                              Http2ErrorCode::HTTP2_ERROR_PROTOCOL_ERROR;
+    }
+    switch (param.id) {
+    case HTTP2_SETTINGS_HEADER_TABLE_SIZE:
+      _peer_header_table_size = param.value;
+      break;
+    case HTTP2_SETTINGS_MAX_CONCURRENT_STREAMS:
+      _peer_max_concurrent_streams = param.value;
+      break;
+    case HTTP2_SETTINGS_INITIAL_WINDOW_SIZE: {
+      // 6.9.2 The change applies to the windows of the open streams too.
+      Http2WindowSize delta = static_cast<Http2WindowSize>(param.value) - static_cast<Http2WindowSize>(_peer_initial_window_size);
+      for (Http2ServerStream *stream = _streams.head; stream != nullptr; stream = stream->link.next) {
+        stream->send_window += delta;
+      }
+      _peer_initial_window_size = param.value;
+      break;
+    }
+    case HTTP2_SETTINGS_MAX_FRAME_SIZE:
+      _peer_max_frame_size = param.value;
+      break;
+    default:
+      break;
+    }
+  }
+
+  xmit(Http2SettingsFrame(HTTP2_CONNECTION_CONTROL_STRTEAM, HTTP2_FLAGS_SETTINGS_ACK));
+  for (Http2ServerStream *stream = _streams.head; stream != nullptr; stream = stream->link.next) {
+    stream->wake();
+  }
+  return Http2ErrorCode::HTTP2_ERROR_NO_ERROR;
+}
+
+Http2ErrorCode
+Http2ServerSession::process_goaway(const Http2FrameHeader &hdr, uint8_t *payload)
+{
+  Http2Goaway goaway;
+  if (hdr.streamid != 0 || hdr.length < HTTP2_GOAWAY_LEN) {
+    return Http2ErrorCode::HTTP2_ERROR_PROTOCOL_ERROR;
+  }
+  http2_parse_goaway(make_iovec(payload, hdr.length), goaway);
+  Http2ServerSessionDebug("GOAWAY, last stream %u, error %u", goaway.last_streamid, static_cast<unsigned>(goaway.error_code));
+
+  // Streams past the last one were not processed and may be retried by HttpSM, the others finish.
+  _goaway = true;
+  leave_pool();
+  for (Http2ServerStream *stream = _streams.head; stream != nullptr; stream = stream->link.next) {
+    if (stream->_id == 0 || stream->_id > goaway.last_streamid) {
+      stream->recv_reset();
+    }
+  }
+  if (_stream_count == 0) {
+    close_connection();
+  }
+  return Http2ErrorCode::HTTP2_ERROR_NO_ERROR;
+}
+
+Http2ErrorCode
+Http2ServerSession::process_window_update(const Http2FrameHeader &hdr, uint8_t *payload)
+{
+  uint32_t size = 0;
+  if (hdr.length != HTTP2_WINDOW_UPDATE_LEN) {
+    return Http2ErrorCode::HTTP2_ERROR_FRAME_SIZE_ERROR;
+  }
+  http2_parse_window_update(make_iovec(payload, hdr.length), size);
+
+  if (hdr.streamid == 0) {
+    if (size == 0 || static_cast<int64_t>(_send_window) + size > HTTP2_MAX_WINDOW_SIZE) {
+      return size == 0 ? Http2ErrorCode::HTTP2_ERROR_PROTOCOL_ERROR : Http2ErrorCode::HTTP2_ERROR_FLOW_CONTROL_ERROR;
+    }
+    _send_window += size;
+    for (Http2ServerStream *stream = _streams.head; stream != nullptr; stream = stream->link.next) {
+      stream->wake();
+    }
+  } else if (Http2ServerStream *stream = find_stream(hdr.streamid); stream != nullptr && size != 0) {
+    stream->send_window += size;
+    stream->wake();
+  }
+  return Http2ErrorCode::HTTP2_ERROR_NO_ERROR;
+}
+
+Http2ErrorCode
+Http2ServerSession::process_header_block(Http2StreamId id)
+{
+  HTTPHdr hdr;
+  hdr.create(HTTP_TYPE_RESPONSE);
+  ts::PostScript hdr_defer([&]() -> void { hdr.destroy(); });
+
+  // Decoded even when the stream is gone, the table has to follow what the origin encoded.
+  int64_t result = hpack_decode_header_block(*_decoder, &hdr, _header_block.data(), _header_block.size(),
+                                             Http2::max_header_list_size, Http2::header_table_size);
+  _header_block.clear();
+  if (result < 0) {
+    return Http2ErrorCode::HTTP2_ERROR_COMPRESSION_ERROR;
+  }
+
+  if (Http2ServerStream *stream = find_stream(id); stream != nullptr) {
+    stream->recv_headers(&hdr, _continued_end_stream);
+  }
+  return Http2ErrorCode::HTTP2_ERROR_NO_ERROR;
+}
+
+void
+Http2ServerSession::connection_error(Http2ErrorCode code)
+{
+  Http2ServerSessionDebug("connection error %u", static_cast<unsigned>(code));
+  Http2Goaway goaway;
+  goaway.last_streamid = 0;
+  goaway.error_code    = code;
+  xmit(Http2GoawayFrame(goaway));
+  close_connection();
+}
+
+void
+Http2ServerSession::close_connection()
+{
+  if (_closed) {
+    return;
+  }
+  Http2ServerSessionDebug("close connection, %d streams left", _stream_count);
+
+  _goaway = true;
+  leave_pool();
+  _cop.stop();
+  _closed = true;
+  _netvc->do_io_close();
+  _netvc = nullptr;
+
+  HTTP_SUM_GLOBAL_DYN_STAT(http_current_server_connections_stat, -1);
+  if (_conn_track_group && _conn_track_group->_count > 0) {
+    --(_conn_track_group->_count);
+    _conn_track_group->slot_released();
+  }
+
+  // The streams go away as HttpSM closes them, the last one takes the session with it.
+  for (Http2ServerStream *stream = _streams.head; stream != nullptr; stream = stream->link.next) {
+    stream->recv_reset();
+  }
+}
@@ -0,0 +1,139 @@
+/** @file
+
+  Http2ServerSession.h
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  @section details Details
+
+  An HTTP/2 connection to an origin, carrying the requests of many HttpSMs at once. It is made
+  from a TLS connection whose handshake picked "h2" and is kept in a list for the thread it was
+  opened on, so a later HttpSM on that thread gets a stream on it instead of a new connection.
+  The connection, not the streams, counts against the outbound connection limits.
+ */
+
+#pragma once
+
+#include "P_Net.h"
+#include "NetTimeout.h"
+
+#include "HTTP2.h"
+#include "HPACK.h"
+#include "Http2Frame.h"
+#include "Http2ServerStream.h"
+#include "HttpConnectionCount.h"
+
+#include <vector>
+
+class Http2ServerSession : public Continuation
+{
+public:
+  Http2ServerSession() : Continuation(nullptr) {}
+
+  /// ALPN list offered on connections that may become HTTP/2.
+  static const std::string_view ALPN_PROTOCOLS;
+
+  /// Whether the TLS handshake on @a netvc picked HTTP/2.
+  static bool is_h2_negotiated(NetVConnection *netvc);
+
+  /** Take over @a netvc, which just finished its TLS handshake with "h2".
+
+      @a group is the connection tracking reservation made for @a netvc, released when the
+      connection closes. @a idle_timeout is how long the connection stays open without streams.
+  */
+  static Http2ServerSession *create(NetVConnection *netvc, CryptoHash const &hostname_hash, OutboundConnTrack::Group *group,
+                                    ink_hrtime idle_timeout);
+
+  /// A new stream on a connection to @a addr for @a hostname_hash opened on this thread, if one has room.
+  static Http2ServerStream *acquire_stream(sockaddr const *addr, CryptoHash const &hostname_hash);
+
+  Http2ServerStream *new_stream();
+
+  int main_event_handler(int event, void *edata);
+
+  /// @name Called by the streams.
+  //@{
+  bool send_headers(Http2ServerStream *stream, HTTPHdr *hdr, bool end_stream);
+  int64_t send_data(Http2ServerStream *stream, IOBufferReader *reader, int64_t len, bool end_stream);
+  void send_window_update(Http2StreamId id, uint32_t size);
+  void stream_done(Http2ServerStream *stream);
+  //@}
+
+  NetVConnection *
+  get_netvc() const
+  {
+    return _netvc;
+  }
+
+  LINK(Http2ServerSession, pool_link);
+
+private:
+  void start();
+  void leave_pool();
+  bool has_room() const;
+  Http2ServerStream *find_stream(Http2StreamId id);
+  void xmit(const Http2TxFrame &frame);
+  void process_frames();
+  Http2ErrorCode process_frame(const Http2FrameHeader &hdr);
+  Http2ErrorCode process_data(const Http2FrameHeader &hdr);
+  Http2ErrorCode process_settings(const Http2FrameHeader &hdr, uint8_t *payload);
+  Http2ErrorCode process_goaway(const Http2FrameHeader &hdr, uint8_t *payload);
+  Http2ErrorCode process_window_update(const Http2FrameHeader &hdr, uint8_t *payload);
+  Http2ErrorCode process_header_block(Http2StreamId id);
+  void connection_error(Http2ErrorCode code);
+  void close_connection();
+  void destroy();
+
+  NetVConnection *_netvc        = nullptr;
+  MIOBuffer *_read_buffer       = nullptr;
+  IOBufferReader *_reader       = nullptr;
+  MIOBuffer *_write_buffer      = nullptr;
+  IOBufferReader *_write_reader = nullptr;
+  VIO *_read_vio                = nullptr;
+  VIO *_write_vio               = nullptr;
+
+  CryptoHash _hostname_hash;
+  IpEndpoint _server_ip;
+  OutboundConnTrack::Group *_conn_track_group = nullptr;
+  ink_hrtime _idle_timeout                    = 0;
+
+  HpackHandle *_decoder = nullptr; ///< For the response headers.
+  HpackHandle *_encoder = nullptr; ///< For the request headers.
+
+  // What the origin told us in its SETTINGS.
+  uint32_t _peer_header_table_size      = HTTP2_HEADER_TABLE_SIZE;
+  uint32_t _peer_max_concurrent_streams = HTTP2_MAX_CONCURRENT_STREAMS;
+  uint32_t _peer_initial_window_size    = HTTP2_INITIAL_WINDOW_SIZE;
+  uint32_t _peer_max_frame_size         = HTTP2_MAX_FRAME_SIZE;
+
+  Http2WindowSize _send_window       = HTTP2_INITIAL_WINDOW_SIZE;
+  Http2WindowSize _recv_window       = HTTP2_MAX_WINDOW_SIZE;
+  Http2StreamId _next_stream_id      = 1;
+  Http2StreamId _continued_stream_id = 0; ///< Stream of a header block waiting for CONTINUATION.
+  bool _continued_end_stream         = false;
+  std::vector<uint8_t> _header_block;
+
+  DLL<Http2ServerStream> _streams;
+  int _stream_count = 0;
+  ActivityCop<Http2ServerStream> _cop;
+
+  bool _in_pool = false;
+  bool _goaway  = false; ///< No new streams, the origin sent GOAWAY or we are closing.
+  bool _closed  = false;
+};
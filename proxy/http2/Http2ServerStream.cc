@@ -0,0 +1,561 @@
+/** @file
+
+  Http2ServerStream.cc
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "Http2ServerStream.h"
+#include "Http2ServerSession.h"
+#include "P_Net.h"
+
+#define Http2ServerStreamDebug(fmt, ...) \
+  Debug("http2_origin", "[%p] [%u] " fmt, this->_session, static_cast<unsigned>(this->_id), ##__VA_ARGS__);
+
+ClassAllocator<Http2ServerStream> http2ServerStreamAllocator("http2ServerStreamAllocator");
+
+static constexpr ink_hrtime STREAM_RETRY_DELAY = HRTIME_MSECONDS(10);
+
+void
+Http2ServerStream::init(Http2ServerSession *session)
+{
+  _session = session;
+  mutex    = session->mutex;
+  SET_HANDLER(&Http2ServerStream::main_event_handler);
+
+  // HttpSM looks at these as it would at those of its own connection.
+  NetVConnection *netvc = session->get_netvc();
+  ats_ip_copy(&remote_addr, netvc->get_remote_addr());
+  ats_ip_copy(&local_addr, netvc->get_local_addr());
+  got_remote_addr = true;
+  got_local_addr  = true;
+  options         = netvc->options;
+
+  _request_header.create(HTTP_TYPE_REQUEST);
+  http2_init_pseudo_headers(_request_header);
+  http_parser_init(&_http_parser);
+
+  _recv_buffer = new_MIOBuffer(BUFFER_SIZE_INDEX_32K);
+  _recv_reader = _recv_buffer->alloc_reader();
+
+  HTTP2_INCREMENT_THREAD_DYN_STAT(HTTP2_STAT_CURRENT_SERVER_STREAM_COUNT, this_ethread());
+  HTTP2_INCREMENT_THREAD_DYN_STAT(HTTP2_STAT_TOTAL_SERVER_STREAM_COUNT, this_ethread());
+}
+
+void
+Http2ServerStream::destroy()
+{
+  Http2ServerStreamDebug("destroy");
+  HTTP2_DECREMENT_THREAD_DYN_STAT(HTTP2_STAT_CURRENT_SERVER_STREAM_COUNT, this_ethread());
+
+  _request_header.destroy();
+  http_parser_clear(&_http_parser);
+  free_MIOBuffer(_recv_buffer);
+  _recv_buffer = nullptr;
+  _recv_reader = nullptr;
+
+  _read_vio.mutex.clear();
+  _write_vio.mutex.clear();
+  mutex.clear();
+  THREAD_FREE(this, http2ServerStreamAllocator, this_ethread());
+}
+
+int
+Http2ServerStream::main_event_handler(int event, void *edata)
+{
+  Event *e = static_cast<Event *>(edata);
+  if (e == _read_event) {
+    _read_event = nullptr;
+  } else if (e == _write_event) {
+    _write_event = nullptr;
+  }
+
+  ++_reentrancy;
+  switch (event) {
+  case VC_EVENT_ACTIVE_TIMEOUT:
+  case VC_EVENT_INACTIVITY_TIMEOUT:
+    // From the session's activity check, once per expiry.
+    _timeout.cancel_active_timeout();
+    _timeout.cancel_inactive_timeout();
+    if (_read_vio.op == VIO::READ && _read_vio.cont) {
+      _read_event = send_tracked_event(_read_event, event, &_read_vio);
+    } else if (_write_vio.op == VIO::WRITE && _write_vio.cont) {
+      _write_event = send_tracked_event(_write_event, event, &_write_vio);
+    }
+    break;
+  default:
+    deliver(event, static_cast<VIO *>(e->cookie));
+    break;
+  }
+  --_reentrancy;
+
+  if (_closed && _reentrancy == 0) {
+    destroy();
+  }
+  return EVENT_DONE;
+}
+
+// Events go to HttpSM from the event loop only, never from inside one of its own calls.
+Event *
+Http2ServerStream::send_tracked_event(Event *event, int send_event, VIO *vio)
+{
+  if (event != nullptr && event->callback_event != send_event) {
+    event->cancel();
+    event = nullptr;
+  }
+  if (event == nullptr) {
+    event = this_ethread()->schedule_imm(this, send_event, vio);
+  }
+  return event;
+}
+
+void
+Http2ServerStream::deliver(int event, VIO *vio)
+{
+  if (_closed || vio->cont == nullptr || vio->op == VIO::NONE) {
+    return;
+  }
+  MUTEX_TRY_LOCK(lock, vio->mutex, this_ethread());
+  if (!lock.is_locked()) {
+    Event *&slot = vio == &_read_vio ? _read_event : _write_event;
+    if (slot) {
+      slot->cancel();
+    }
+    slot = this_ethread()->schedule_in(this, STREAM_RETRY_DELAY, event, vio);
+    return;
+  }
+  vio->cont->handleEvent(event, vio);
+}
+
+VIO *
+Http2ServerStream::do_io_read(Continuation *c, int64_t nbytes, MIOBuffer *buf)
+{
+  if (buf) {
+    _read_vio.buffer.writer_for(buf);
+  } else {
+    _read_vio.buffer.clear();
+  }
+
+  _read_vio.mutex     = c ? c->mutex : this->mutex;
+  _read_vio.cont      = c;
+  _read_vio.nbytes    = nbytes;
+  _read_vio.ndone     = 0;
+  _read_vio.vc_server = this;
+  _read_vio.op        = VIO::READ;
+
+  if (c && nbytes > 0) {
+    SCOPED_MUTEX_LOCK(lock, this->mutex, this_ethread());
+    process_read();
+  }
+  return &_read_vio;
+}
+
+VIO *
+Http2ServerStream::do_io_write(Continuation *c, int64_t nbytes, IOBufferReader *abuffer, bool owner)
+{
+  if (abuffer) {
+    _write_vio.buffer.reader_for(abuffer);
+  } else {
+    _write_vio.buffer.clear();
+  }
+
+  _write_vio.mutex     = c ? c->mutex : this->mutex;
+  _write_vio.cont      = c;
+  _write_vio.nbytes    = nbytes;
+  _write_vio.ndone     = 0;
+  _write_vio.vc_server = this;
+  _write_vio.op        = VIO::WRITE;
+
+  if (c && nbytes > 0) {
+    SCOPED_MUTEX_LOCK(lock, this->mutex, this_ethread());
+    process_write();
+  }
+  return &_write_vio;
+}
+
+void
+Http2ServerStream::reenable(VIO *vio)
+{
+  SCOPED_MUTEX_LOCK(lock, this->mutex, this_ethread());
+  if (vio == &_read_vio) {
+    process_read();
+  } else if (vio == &_write_vio) {
+    process_write();
+  }
+}
+
+void
+Http2ServerStream::reenable_re(VIO *vio)
+{
+  reenable(vio);
+}
+
+void
+Http2ServerStream::wake()
+{
+  process_write();
+  process_read();
+}
+
+void
+Http2ServerStream::do_io_close(int /* lerrno ATS_UNUSED */)
+{
+  if (_closed) {
+    return;
+  }
+  SCOPED_MUTEX_LOCK(lock, this->mutex, this_ethread());
+  Http2ServerStreamDebug("close");
+  _closed = true;
+
+  if (_read_event) {
+    _read_event->cancel();
+    _read_event = nullptr;
+  }
+  if (_write_event) {
+    _write_event->cancel();
+    _write_event = nullptr;
+  }
+  _read_vio.buffer.clear();
+  _read_vio.nbytes = 0;
+  _read_vio.op     = VIO::NONE;
+  _read_vio.cont   = nullptr;
+  _write_vio.buffer.clear();
+  _write_vio.nbytes = 0;
+  _write_vio.op     = VIO::NONE;
+  _write_vio.cont   = nullptr;
+
+  // The session may be gone once it lets go of us, and it resets the stream if it is still open.
+  _session->stream_done(this);
+  if (_reentrancy == 0) {
+    destroy();
+  }
+}
+
+void
+Http2ServerStream::do_io_shutdown(ShutdownHowTo_t howto)
+{
+  SCOPED_MUTEX_LOCK(lock, this->mutex, this_ethread());
+  if (howto != IO_SHUTDOWN_READ && _request_header_sent && !_send_end_stream && !_reset) {
+    // End a request body cut short by HttpSM, the origin then sees a truncated request.
+    _session->send_data(this, nullptr, 0, true);
+    _send_end_stream = true;
+  }
+}
+
+void
+Http2ServerStream::process_write()
+{
+  if (_closed || _write_vio.op != VIO::WRITE || _write_vio.cont == nullptr || _write_vio.is_disabled() ||
+      _write_vio.ntodo() == 0) {
+    return;
+  }
+  if (_reset) {
+    _write_event = send_tracked_event(_write_event, VC_EVENT_ERROR, &_write_vio);
+    return;
+  }
+
+  IOBufferReader *reader = _write_vio.get_reader();
+  int64_t before         = _write_vio.ndone;
+
+  if (!_request_header_sent) {
+    int bytes_used = 0;
+    ParseResult result =
+      _request_header.parse_req(&_http_parser, reader, &bytes_used, false, false, HTTP2_MAX_FRAME_SIZE, HTTP2_MAX_FRAME_SIZE);
+    // HTTPHdr::parse_req() consumed bytes_used from the reader.
+    _write_vio.ndone += bytes_used;
+    if (result == PARSE_RESULT_CONT) {
+      return;
+    }
+    if (result != PARSE_RESULT_DONE || _request_header.presence(MIME_PRESENCE_TRANSFER_ENCODING)) {
+      // A chunked body has no length to send as DATA frames, the caller keeps those requests on HTTP/1.1.
+      Http2ServerStreamDebug("request header not usable for HTTP/2");
+      _write_event = send_tracked_event(_write_event, VC_EVENT_ERROR, &_write_vio);
+      return;
+    }
+
+    _request_body_todo = _request_header.presence(MIME_PRESENCE_CONTENT_LENGTH) ? _request_header.get_content_length() : 0;
+    if (MIMEField *field = _request_header.field_find(MIME_FIELD_TE, MIME_LEN_TE); field != nullptr) {
+      _request_header.field_delete(field);
+    }
+    http2_convert_header_from_1_1_to_2(&_request_header);
+    _send_end_stream = _request_body_todo == 0;
+    if (!_session->send_headers(this, &_request_header, _send_end_stream)) {
+      _write_event = send_tracked_event(_write_event, VC_EVENT_ERROR, &_write_vio);
+      return;
+    }
+    _request_header_sent = true;
+  }
+
+  int64_t avail = std::min(_write_vio.ntodo(), reader->read_avail());
+  if (_request_body_todo > 0 && avail > 0) {
+    int64_t len  = std::min(avail, _request_body_todo);
+    int64_t sent = _session->send_data(this, reader, len, len == _request_body_todo);
+    _write_vio.ndone += sent;
+    _request_body_todo -= sent;
+    _send_end_stream = _request_body_todo == 0;
+  }
+
+  if (_write_vio.ndone != before) {
+    _timeout.update_inactivity();
+    int event    = _write_vio.ntodo() == 0 ? VC_EVENT_WRITE_COMPLETE : VC_EVENT_WRITE_READY;
+    _write_event = send_tracked_event(_write_event, event, &_write_vio);
+  }
+}
+
+void
+Http2ServerStream::process_read()
+{
+  if (_closed || _read_vio.op != VIO::READ || _read_vio.cont == nullptr || _read_vio.is_disabled() || _read_vio.ntodo() == 0) {
+    return;
+  }
+
+  int64_t moved = std::min(_read_vio.ntodo(), _recv_reader->read_avail());
+  if (moved > 0) {
+    _read_vio.get_writer()->write(_recv_reader, moved);
+    _recv_reader->consume(moved);
+    _read_vio.ndone += moved;
+    _timeout.update_inactivity();
+
+    // Open the window again once HttpSM has taken half of it, what is buffered here stays bounded.
+    Http2WindowSize initial = Http2::initial_window_size;
+    if (!_recv_end_stream && !_reset && recv_window < initial / 2 && _recv_reader->read_avail() < initial / 2) {
+      _session->send_window_update(_id, initial - recv_window);
+      recv_window = initial;
+    }
+
+    int event   = _read_vio.ntodo() == 0 ? VC_EVENT_READ_COMPLETE : VC_EVENT_READ_READY;
+    _read_event = send_tracked_event(_read_event, event, &_read_vio);
+  } else if (_reset) {
+    _read_event = send_tracked_event(_read_event, VC_EVENT_ERROR, &_read_vio);
+  } else if (_recv_end_stream) {
+    // Only once what was read is handed over, so HttpSM always sees the data before the EOS.
+    _read_event = send_tracked_event(_read_event, VC_EVENT_EOS, &_read_vio);
+  }
+}
+
+void
+Http2ServerStream::print_response_header(HTTPHdr *hdr)
+{
+  // Borrowing logic from HttpSM::write_header_into_buffer.
+  int bufindex;
+  int dumpoffset = 0;
+  int done, tmp;
+  do {
+    bufindex             = 0;
+    tmp                  = dumpoffset;
+    IOBufferBlock *block = _recv_buffer->get_current_block();
+    if (!block || block->write_avail() == 0) {
+      _recv_buffer->add_block();
+      block = _recv_buffer->get_current_block();
+    }
+    done = hdr->print(block->end(), block->write_avail(), &bufindex, &tmp);
+    dumpoffset += bufindex;
+    _recv_buffer->fill(bufindex);
+    if (!done) {
+      _recv_buffer->add_block();
+    }
+  } while (!done);
+}
+
+void
+Http2ServerStream::recv_headers(HTTPHdr *hdr, bool end_stream)
+{
+  if (_reset) {
+    return;
+  }
+  if (!_response_header_done) {
+    if (http2_convert_header_from_2_to_1_1(hdr) != PARSE_RESULT_DONE) {
+      Http2ServerStreamDebug("bad response header");
+      recv_reset();
+      return;
+    }
+    if (const char *reason = http_hdr_reason_lookup(hdr->status_get()); reason != nullptr) {
+      hdr->reason_set(reason, strlen(reason));
+    }
+    print_response_header(hdr);
+    // An interim response is passed on as is, the next header block is another response.
+    _response_header_done = !hdr->expect_final_response();
+  }
+  // Otherwise trailers, which HttpSM has no use for over HTTP/1.1 without chunking.
+  if (end_stream) {
+    _recv_end_stream = true;
+  }
+  process_read();
+}
+
+void
+Http2ServerStream::recv_data(IOBufferReader *reader, uint32_t len, uint32_t flow_len, bool end_stream)
+{
+  recv_window -= flow_len;
+  if (!_reset && _response_header_done) {
+    _recv_buffer->write(reader, len);
+  }
+  if (end_stream) {
+    _recv_end_stream = true;
+  }
+  process_read();
+}
+
+void
+Http2ServerStream::recv_reset()
+{
+  Http2ServerStreamDebug("reset");
+  _reset = true;
+  wake();
+}
+
+int
+Http2ServerStream::populate_protocol(std::string_view *result, int size) const
+{
+  int retval = 0;
+  if (size > retval) {
+    result[retval++] = IP_PROTO_TAG_HTTP_2_0;
+    if (size > retval) {
+      NetVConnection *netvc = _session->get_netvc();
+      if (netvc) {
+        retval += netvc->populate_protocol(result + retval, size - retval);
+      }
+    }
+  }
+  return retval;
+}
+
+const char *
+Http2ServerStream::protocol_contains(std::string_view tag_prefix) const
+{
+  if (tag_prefix.size() <= IP_PROTO_TAG_HTTP_2_0.size() &&
+      strncmp(IP_PROTO_TAG_HTTP_2_0.data(), tag_prefix.data(), tag_prefix.size()) == 0) {
+    return IP_PROTO_TAG_HTTP_2_0.data();
+  }
+  NetVConnection *netvc = _session->get_netvc();
+  return netvc ? netvc->protocol_contains(tag_prefix) : nullptr;
+}
+
+void
+Http2ServerStream::set_active_timeout(ink_hrtime timeout_in)
+{
+  _timeout.set_active_timeout(timeout_in);
+}
+
+void
+Http2ServerStream::set_inactivity_timeout(ink_hrtime timeout_in)
+{
+  _timeout.set_inactive_timeout(timeout_in);
+}
+
+void
+Http2ServerStream::set_default_inactivity_timeout(ink_hrtime timeout_in)
+{
+  _timeout.set_inactive_timeout(timeout_in);
+}
+
+bool
+Http2ServerStream::is_default_inactivity_timeout()
+{
+  return false;
+}
+
+void
+Http2ServerStream::cancel_active_timeout()
+{
+  _timeout.cancel_active_timeout();
+}
+
+void
+Http2ServerStream::cancel_inactivity_timeout()
+{
+  _timeout.cancel_inactive_timeout();
+}
+
+bool
+Http2ServerStream::is_active_timeout_expired(ink_hrtime now)
+{
+  return _timeout.is_active_timeout_expired(now);
+}
+
+bool
+Http2ServerStream::is_inactive_timeout_expired(ink_hrtime now)
+{
+  return _timeout.is_inactive_timeout_expired(now);
+}
+
+void
+Http2ServerStream::add_to_keep_alive_queue()
+{
+}
+
+void
+Http2ServerStream::remove_from_keep_alive_queue()
+{
+}
+
+bool
+Http2ServerStream::add_to_active_queue()
+{
+  return true;
+}
+
+ink_hrtime
+Http2ServerStream::get_active_timeout()
+{
+  return 0;
+}
+
+ink_hrtime
+Http2ServerStream::get_inactivity_timeout()
+{
+  return 0;
+}
+
+SOCKET
+Http2ServerStream::get_socket()
+{
+  return NO_FD;
+}
+
+void
+Http2ServerStream::set_local_addr()
+{
+}
+
+void
+Http2ServerStream::set_remote_addr()
+{
+}
+
+void
+Http2ServerStream::set_remote_addr(const sockaddr * /* new_sa ATS_UNUSED */)
+{
+}
+
+void
+Http2ServerStream::set_mptcp_state()
+{
+}
+
+int
+Http2ServerStream::set_tcp_congestion_control(int /* side ATS_UNUSED */)
+{
+  return -1;
+}
+
+void
+Http2ServerStream::apply_options()
+{
+}
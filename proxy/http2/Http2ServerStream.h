@@ -0,0 +1,151 @@
+/** @file
+
+  Http2ServerStream.h
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  @section details Details
+
+  A stream is what HttpSM gets instead of a connection when the request goes to an origin over a
+  shared HTTP/2 connection. HttpSM drives it as it drives a connection to an HTTP/1.1 origin: the
+  request header it writes is parsed and sent as HEADERS, the body as DATA, and the response comes
+  back as HTTP/1.1 text, with the end of the stream reported as EOS. The Http1ServerSession wrapping
+  a stream is never pooled, the reuse happens at the level of the HTTP/2 connection.
+ */
+
+#pragma once
+
+#include "P_Net.h"
+#include "NetTimeout.h"
+
+#include "HTTP2.h"
+#include "HTTP.h"
+
+class Http2ServerSession;
+
+class Http2ServerStream : public NetVConnection
+{
+  friend class Http2ServerSession;
+
+public:
+  Http2ServerStream() {}
+
+  void init(Http2ServerSession *session);
+
+  // VConnection
+  VIO *do_io_read(Continuation *c, int64_t nbytes = INT64_MAX, MIOBuffer *buf = nullptr) override;
+  VIO *do_io_write(Continuation *c = nullptr, int64_t nbytes = INT64_MAX, IOBufferReader *buf = nullptr,
+                   bool owner = false) override;
+  void do_io_close(int lerrno = -1) override;
+  void do_io_shutdown(ShutdownHowTo_t howto) override;
+  void reenable(VIO *vio) override;
+  void reenable_re(VIO *vio) override;
+
+  // Timeouts, checked by the session once a second
+  void set_active_timeout(ink_hrtime timeout_in) override;
+  void set_inactivity_timeout(ink_hrtime timeout_in) override;
+  void set_default_inactivity_timeout(ink_hrtime timeout_in) override;
+  bool is_default_inactivity_timeout() override;
+  void cancel_active_timeout() override;
+  void cancel_inactivity_timeout() override;
+  void add_to_keep_alive_queue() override;
+  void remove_from_keep_alive_queue() override;
+  bool add_to_active_queue() override;
+  ink_hrtime get_active_timeout() override;
+  ink_hrtime get_inactivity_timeout() override;
+  bool is_active_timeout_expired(ink_hrtime now);
+  bool is_inactive_timeout_expired(ink_hrtime now);
+
+  // There is no socket of our own, these are about the shared connection or nothing at all.
+  SOCKET get_socket() override;
+  void set_local_addr() override;
+  void set_remote_addr() override;
+  void set_remote_addr(const sockaddr *) override;
+  void set_mptcp_state() override;
+  int set_tcp_congestion_control(int) override;
+  void apply_options() override;
+  int populate_protocol(std::string_view *result, int size) const override;
+  const char *protocol_contains(std::string_view tag_prefix) const override;
+
+  int main_event_handler(int event, void *edata);
+
+  /// @name Called by the session for frames on this stream.
+  //@{
+  void recv_headers(HTTPHdr *hdr, bool end_stream);
+  void recv_data(IOBufferReader *reader, uint32_t len, uint32_t flow_len, bool end_stream);
+  void recv_reset();
+  //@}
+
+  /// The peer allowed more data, or the connection went away.
+  void wake();
+
+  Http2StreamId
+  get_id() const
+  {
+    return _id;
+  }
+
+  /// Both sides sent END_STREAM, nothing to reset on close.
+  bool
+  is_finished() const
+  {
+    return _send_end_stream && _recv_end_stream;
+  }
+
+  Http2WindowSize send_window = HTTP2_INITIAL_WINDOW_SIZE;
+  Http2WindowSize recv_window = HTTP2_INITIAL_WINDOW_SIZE;
+
+  LINK(Http2ServerStream, link);
+
+private:
+  void process_read();
+  void process_write();
+  void print_response_header(HTTPHdr *hdr);
+  Event *send_tracked_event(Event *event, int send_event, VIO *vio);
+  void deliver(int event, VIO *vio);
+  void destroy();
+
+  Http2ServerSession *_session = nullptr;
+  Http2StreamId _id            = 0; ///< Zero until the request header is sent.
+
+  VIO _read_vio;
+  VIO _write_vio;
+  Event *_read_event  = nullptr;
+  Event *_write_event = nullptr;
+  NetTimeout _timeout{};
+
+  // Request side
+  HTTPParser _http_parser;
+  HTTPHdr _request_header;
+  bool _request_header_sent  = false;
+  int64_t _request_body_todo = 0;
+  bool _send_end_stream      = false;
+
+  // Response side, as HTTP/1.1 text until HttpSM reads it
+  MIOBuffer *_recv_buffer      = nullptr;
+  IOBufferReader *_recv_reader = nullptr;
+  bool _response_header_done   = false;
+  bool _recv_end_stream        = false;
+  bool _reset                  = false;
+
+  bool _closed    = false;
+  int _reentrancy = 0;
+};
+
+extern ClassAllocator<Http2ServerStream> http2ServerStreamAllocator;
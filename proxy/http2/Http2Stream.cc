@@ -45,7 +45,7 @@ Http2Stream::Http2Stream(Http2StreamId sid, ssize_t initial_rwnd) : _id(sid), _c
 }
 
 void
-Http2Stream::init(Http2StreamId sid, ssize_t initial_rwnd)
+Http2Stream::init(Http2StreamId sid, ssize_t initial_rwnd, HdrHeap *req_heap, HdrHeap *resp_heap)
 {
   this->mark_milestone(Http2StreamMilestone::OPEN);
 
@@ -56,8 +56,8 @@ Http2Stream::init(Http2StreamId sid, ssize_t initial_rwnd)
 
   this->_reader = this->_request_buffer.alloc_reader();
 
-  _req_header.create(HTTP_TYPE_REQUEST);
-  response_header.create(HTTP_TYPE_RESPONSE);
+  _req_header.create(HTTP_TYPE_REQUEST, req_heap);
+  response_header.create(HTTP_TYPE_RESPONSE, resp_heap);
   // TODO: init _req_header instead of response_header if this Http2Stream is outgoing
   http2_init_pseudo_headers(response_header);
 
@@ -766,6 +766,10 @@ Http2Stream::destroy()
 
     h2_proxy_ssn->connection_state.decrement_stream_count();
 
+    // Leave the header heaps to the next streams of the connection
+    h2_proxy_ssn->connection_state.recycle_header(_req_header);
+    h2_proxy_ssn->connection_state.recycle_header(response_header);
+
     // Update session's stream counts, so it accurately goes into keep-alive state
     h2_proxy_ssn->connection_state.release_stream();
 
@@ -56,7 +56,7 @@ public:
 
   Http2Stream(Http2StreamId sid = 0, ssize_t initial_rwnd = Http2::initial_window_size);
 
-  void init(Http2StreamId sid, ssize_t initial_rwnd);
+  void init(Http2StreamId sid, ssize_t initial_rwnd, HdrHeap *req_heap = nullptr, HdrHeap *resp_heap = nullptr);
 
   int main_event_handler(int event, void *edata);
 
@@ -127,6 +127,7 @@ public:
   void update_initial_rwnd(Http2WindowSize new_size);
   bool has_trailing_header() const;
   void set_request_headers(HTTPHdr &h2_headers);
+  std::string_view get_priority_field() const;
   MIOBuffer *read_vio_writer() const;
   int64_t read_vio_read_avail();
 
@@ -277,6 +278,13 @@ Http2Stream::set_request_headers(HTTPHdr &h2_headers)
   _req_header.copy(&h2_headers);
 }
 
+// [RFC 9218] 5. The Priority HTTP Header Field
+inline std::string_view
+Http2Stream::get_priority_field() const
+{
+  return _req_header.value_get(std::string_view{"priority"});
+}
+
 // Check entire DATA payload length if content-length: header is exist
 inline void
 Http2Stream::increment_data_length(uint64_t length)
@@ -167,3 +167,34 @@ TEST_CASE("Convert HTTPHdr", "[HTTP2]")
     CHECK_THAT(buf, Catch::StartsWith("HTTP/1.1 200 OK\r\n\r\n"));
   }
 }
+
+TEST_CASE("Parse priority field", "[HTTP2]")
+{
+  uint8_t urgency;
+  bool incremental;
+
+  auto parse = [&](std::string_view field) {
+    urgency     = HTTP2_PRIORITY_DEFAULT_URGENCY;
+    incremental = false;
+    return http2_parse_priority_field(field, urgency, incremental);
+  };
+
+  REQUIRE(parse("u=5, i"));
+  CHECK(urgency == 5);
+  CHECK(incremental == true);
+
+  REQUIRE(parse("i=?0,u=0"));
+  CHECK(urgency == 0);
+  CHECK(incremental == false);
+
+  REQUIRE(parse("i=?1;foo=bar, x=3"));
+  CHECK(urgency == HTTP2_PRIORITY_DEFAULT_URGENCY);
+  CHECK(incremental == true);
+
+  // Out of range values are ignored
+  REQUIRE(parse("u=8"));
+  CHECK(urgency == HTTP2_PRIORITY_DEFAULT_URGENCY);
+
+  REQUIRE(parse(""));
+  CHECK_FALSE(parse("u=1, =2"));
+}
@@ -28,6 +28,10 @@
 
 #include "HPACK.h"
 
+#include <deque>
+#include <string>
+#include <strings.h>
+
 static constexpr int DYNAMIC_TABLE_SIZE_FOR_REGRESSION_TEST = 256;
 static constexpr int BUFSIZE_FOR_REGRESSION_TEST            = 128;
 static constexpr int MAX_TEST_FIELD_NUM                     = 8;
@@ -544,3 +548,113 @@ TEST_CASE("HPACK high level APIs", "[hpack]")
     }
   }
 }
+
+TEST_CASE("HPACK dynamic table lookup", "[hpack]")
+{
+  // Indexes of the dynamic table start after the 61 entries of the static table.
+  static constexpr uint32_t FIRST_DYNAMIC_INDEX = 62;
+  static const char *names[]                     = {"x-a", "X-B", "x-c", "set-cookie"};
+  static const char *values[]                    = {"1", "22", "333", "4444", "55555"};
+
+  HpackDynamicTable table(300);
+  std::deque<std::pair<std::string, std::string>> model;
+  uint32_t model_size = 0;
+
+  ats_scoped_obj<HTTPHdr> headers(new HTTPHdr);
+  headers->create(HTTP_TYPE_REQUEST);
+
+  for (int i = 0; i < 200; ++i) {
+    const char *name  = names[(i * 7) % 4];
+    const char *value = values[(i * 3) % 5];
+
+    MIMEField *field = mime_field_create(headers->m_heap, headers->m_http->m_fields_impl);
+    field->name_set(headers->m_heap, headers->m_http->m_fields_impl, name, strlen(name));
+    field->value_set(headers->m_heap, headers->m_http->m_fields_impl, value, strlen(value));
+    table.add_header_field(field);
+    mime_field_destroy(headers->m_http->m_fields_impl, field);
+
+    model.emplace_front(name, value);
+    model_size += 32 + strlen(name) + strlen(value);
+    while (model_size > table.maximum_size()) {
+      model_size -= 32 + model.back().first.size() + model.back().second.size();
+      model.pop_back();
+    }
+    REQUIRE(table.length() == model.size());
+    REQUIRE(table.size() == model_size);
+
+    // Every name and value, in the table or not, finds what a search from the newest entry would.
+    for (const char *n : {"x-a", "x-b", "x-c", "set-cookie", "x-d"}) {
+      for (const char *v : values) {
+        HpackLookupResult expected;
+        for (uint32_t j = 0; j < model.size(); ++j) {
+          if (strcasecmp(model[j].first.c_str(), n) == 0) {
+            if (model[j].second == v) {
+              expected.index      = FIRST_DYNAMIC_INDEX + j;
+              expected.match_type = HpackMatch::EXACT;
+              break;
+            } else if (expected.match_type == HpackMatch::NONE) {
+              expected.index      = FIRST_DYNAMIC_INDEX + j;
+              expected.match_type = HpackMatch::NAME;
+            }
+          }
+        }
+
+        HpackLookupResult result = table.lookup(n, strlen(n), v, strlen(v));
+        CHECK(result.match_type == expected.match_type);
+        CHECK(result.index == expected.index);
+      }
+    }
+  }
+
+  // Over the maximum size empties the table, and the indexes with it.
+  std::string big(400, 'x');
+  MIMEField *field = mime_field_create(headers->m_heap, headers->m_http->m_fields_impl);
+  field->name_set(headers->m_heap, headers->m_http->m_fields_impl, "x-a", 3);
+  field->value_set(headers->m_heap, headers->m_http->m_fields_impl, big.data(), big.size());
+  table.add_header_field(field);
+  CHECK(table.length() == 0);
+  CHECK(table.lookup("x-a", 3, "1", 1).match_type == HpackMatch::NONE);
+}
+
+TEST_CASE("HPACK decoding shares long dynamic table values", "[hpack]")
+{
+  HpackIndexingTable indexing_table(4096);
+  std::string value(100, 'v');
+
+  // Literal with incremental indexing, new name: "x-big: vvv..."
+  std::string block = std::string("\x40\x05x-big", 7) + static_cast<char>(value.size()) + value;
+  // Indexed, the entry just added
+  uint8_t indexed[] = {0x80 | 62};
+
+  ats_scoped_obj<HTTPHdr> first(new HTTPHdr);
+  first->create(HTTP_TYPE_REQUEST);
+  REQUIRE(hpack_decode_header_block(indexing_table, first, reinterpret_cast<const uint8_t *>(block.data()), block.size(),
+                                    MAX_REQUEST_HEADER_SIZE, MAX_TABLE_SIZE) == static_cast<int64_t>(block.size()));
+
+  for (int i = 0; i < 2; ++i) {
+    ats_scoped_obj<HTTPHdr> headers(new HTTPHdr);
+    headers->create(HTTP_TYPE_REQUEST);
+    REQUIRE(hpack_decode_header_block(indexing_table, headers, indexed, sizeof(indexed), MAX_REQUEST_HEADER_SIZE,
+                                      MAX_TABLE_SIZE) == sizeof(indexed));
+
+    MIMEField *field = headers->field_find("x-big", 5);
+    REQUIRE(field != nullptr);
+    int len;
+    const char *str = field->value_get(&len);
+    CHECK(std::string(str, len) == value);
+    // The value is in a string heap the header holds on to, not in one of its own.
+    CHECK(headers->m_heap->m_ronly_heap[0].contains(str));
+  }
+
+  // Evicting the entry leaves the header that shares its value intact.
+  ats_scoped_obj<HTTPHdr> headers(new HTTPHdr);
+  headers->create(HTTP_TYPE_REQUEST);
+  REQUIRE(hpack_decode_header_block(indexing_table, headers, indexed, sizeof(indexed), MAX_REQUEST_HEADER_SIZE, MAX_TABLE_SIZE) ==
+          sizeof(indexed));
+  indexing_table.update_maximum_size(0);
+  CHECK(indexing_table.size() == 0);
+
+  int len;
+  const char *str = headers->field_find("x-big", 5)->value_get(&len);
+  CHECK(std::string(str, len) == value);
+}
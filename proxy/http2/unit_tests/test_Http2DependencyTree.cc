@@ -23,6 +23,7 @@
 #define CATCH_CONFIG_MAIN
 #include "catch.hpp"
 
+#include <algorithm>
 #include <iostream>
 #include <cstring>
 #include <sstream>
@@ -938,3 +939,126 @@ TEST_CASE("Http2DependencyTree_max_depth", "[http2][Http2DependencyTree]")
 
   delete tree;
 }
+
+TEST_CASE("Http2DependencyTree_find_wide", "[http2][Http2DependencyTree]")
+{
+  Tree *tree = new Tree(100);
+  string a("A");
+  for (uint32_t id = 1; id < 20000; id += 2) {
+    tree->add(0, id, 16, false, &a);
+  }
+
+  REQUIRE(tree->find(0) != nullptr);
+  REQUIRE(tree->find(19999)->id == 19999);
+  REQUIRE(tree->find(2) == nullptr);
+
+  tree->remove(tree->find(19999));
+  REQUIRE(tree->find(19999) == nullptr);
+  REQUIRE(tree->size() == 9999);
+
+  delete tree;
+}
+
+/**
+ * A stream that was idle doesn't get back the time it was idle
+ *
+ *   ROOT
+ *   /  \
+ *  A    B
+ */
+TEST_CASE("Http2DependencyTree_fair_after_idle", "[http2][Http2DependencyTree]")
+{
+  Tree *tree = new Tree(100);
+  string a("A"), b("B");
+
+  Node *node_a = tree->add(0, 1, 15, false, &a);
+  Node *node_b = tree->add(0, 3, 15, false, &b);
+
+  tree->activate(node_a);
+  for (int i = 0; i < 100; ++i) {
+    tree->update(tree->top(), 16384);
+  }
+
+  tree->activate(node_b);
+  string order;
+  for (int i = 0; i < 6; ++i) {
+    Node *node = tree->top();
+    order += *static_cast<string *>(node->t);
+    tree->update(node, 16384);
+  }
+
+  // B starts level with A rather than where it was, without that it would have had all of them
+  REQUIRE(order[0] == 'B');
+  REQUIRE(std::count(order.begin(), order.end(), 'A') >= 2);
+
+  delete tree;
+}
+
+TEST_CASE("Http2DependencyTree_extensible_urgency", "[http2][Http2DependencyTree]")
+{
+  Tree *tree = new Tree(100, true);
+  string a("A"), b("B"), c("C");
+
+  // Dependencies are ignored
+  Node *node_a = tree->add(0, 1, 15, false, &a);
+  Node *node_b = tree->add(1, 3, 200, true, &b);
+  Node *node_c = tree->add(0, 5, 15, false, &c);
+  REQUIRE(node_b->parent->id == 0);
+  REQUIRE(node_a->parent->id == 0);
+
+  tree->set_urgency(node_c, 1, false);
+  tree->activate(node_a);
+  tree->activate(node_b);
+  tree->activate(node_c);
+
+  ostringstream oss;
+  for (int i = 0; i < 3; ++i) {
+    Node *node = tree->top();
+    oss << static_cast<string *>(node->t)->c_str();
+    tree->update(node, 16384);
+  }
+  // C goes first while it has data, then A and B in stream id order
+  REQUIRE(oss.str() == "CCC");
+
+  tree->deactivate(node_c, 0);
+  oss.str("");
+  for (int i = 0; i < 3; ++i) {
+    Node *node = tree->top();
+    oss << static_cast<string *>(node->t)->c_str();
+    tree->update(node, 16384);
+  }
+  REQUIRE(oss.str() == "AAA");
+
+  delete tree;
+}
+
+TEST_CASE("Http2DependencyTree_extensible_incremental", "[http2][Http2DependencyTree]")
+{
+  Tree *tree = new Tree(100, true);
+  string a("A"), b("B"), c("C");
+
+  Node *node_a = tree->add(0, 1, 15, false, &a);
+  Node *node_b = tree->add(0, 3, 15, false, &b);
+  Node *node_c = tree->add(0, 5, 15, false, &c);
+  tree->set_urgency(node_a, 3, true);
+  tree->set_urgency(node_b, 3, true);
+  tree->set_urgency(node_c, 4, false);
+
+  tree->activate(node_a);
+  tree->activate(node_b);
+  tree->activate(node_c);
+
+  ostringstream oss;
+  for (int i = 0; i < 4; ++i) {
+    Node *node = tree->top();
+    oss << static_cast<string *>(node->t)->c_str();
+    tree->update(node, 16384);
+  }
+  REQUIRE(oss.str() == "ABAB");
+
+  tree->deactivate(node_a, 0);
+  tree->deactivate(node_b, 0);
+  REQUIRE(tree->top() == node_c);
+
+  delete tree;
+}
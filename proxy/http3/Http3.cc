@@ -35,4 +35,8 @@ void
 Http3::init()
 {
   http3_rsb = RecAllocateRawStatBlock(static_cast<int>(HTTP3_N_STATS));
+
+  // Bytes of encoded header blocks for each byte of header names and values
+  RecRegisterRawStat(http3_rsb, RECT_PROCESS, "proxy.process.http3.header_compression_ratio", RECD_FLOAT, RECP_NON_PERSISTENT,
+                     static_cast<int>(HTTP3_STAT_HEADER_COMPRESSION_RATIO), RecRawStatSyncAvg);
 }
@@ -42,5 +42,13 @@ public:
 
 // Statistics
 enum {
+  HTTP3_STAT_HEADER_COMPRESSION_RATIO,
   HTTP3_N_STATS // Terminal counter, NOT A STAT INDEX.
 };
+
+// Adds to the sum and to the count of an average separately, so that it averages @a _num over @a _den.
+#define HTTP3_SUM_RATIO_THREAD_DYN_STAT(_s, _t, _num, _den) \
+  do {                                                     \
+    RecIncrRawStatSum(http3_rsb, _t, (int)_s, _num);       \
+    RecIncrRawStatCount(http3_rsb, _t, (int)_s, _den);     \
+  } while (0)
@@ -142,8 +142,20 @@ Http3DataFrame::Http3DataFrame(ats_unique_buf payload, size_t payload_len)
   this->_payload = this->_payload_uptr.get();
 }
 
+Http3DataFrame::Http3DataFrame(const uint8_t *header, size_t header_len, Ptr<IOBufferBlock> payload)
+  : Http3Frame(header, header_len), _payload_blocks(payload)
+{
+  this->_payload_len = this->_length;
+}
+
+Http3DataFrame::Http3DataFrame(Ptr<IOBufferBlock> payload, size_t payload_len)
+  : Http3Frame(Http3FrameType::DATA), _payload_len(payload_len), _payload_blocks(payload)
+{
+  this->_length = this->_payload_len;
+}
+
 void
-Http3DataFrame::store(uint8_t *buf, size_t *len) const
+Http3DataFrame::store_header(uint8_t *buf, size_t *len) const
 {
   size_t written = 0;
   size_t n;
@@ -151,8 +163,23 @@ Http3DataFrame::store(uint8_t *buf, size_t *len) const
   written += n;
   QUICVariableInt::encode(buf + written, UINT64_MAX, n, this->_length);
   written += n;
-  memcpy(buf + written, this->_payload, this->_payload_len);
-  written += this->_payload_len;
+  *len = written;
+}
+
+void
+Http3DataFrame::store(uint8_t *buf, size_t *len) const
+{
+  size_t written = 0;
+  this->store_header(buf, &written);
+  if (this->_payload_blocks) {
+    for (const IOBufferBlock *b = this->_payload_blocks.get(); b; b = b->next.get()) {
+      memcpy(buf + written, b->_start, b->read_avail());
+      written += b->read_avail();
+    }
+  } else {
+    memcpy(buf + written, this->_payload, this->_payload_len);
+    written += this->_payload_len;
+  }
   *len = written;
 }
 
@@ -163,12 +190,25 @@ Http3DataFrame::reset(const uint8_t *buf, size_t len)
   new (this) Http3DataFrame(buf, len);
 }
 
+void
+Http3DataFrame::reset(const uint8_t *header, size_t header_len, Ptr<IOBufferBlock> payload)
+{
+  this->~Http3DataFrame();
+  new (this) Http3DataFrame(header, header_len, payload);
+}
+
 const uint8_t *
 Http3DataFrame::payload() const
 {
   return this->_payload;
 }
 
+const IOBufferBlock *
+Http3DataFrame::payload_block() const
+{
+  return this->_payload_blocks.get();
+}
+
 uint64_t
 Http3DataFrame::payload_length() const
 {
@@ -419,7 +459,21 @@ Http3FrameFactory::fast_create(QUICStreamIO &stream_io, size_t frame_len)
 {
   uint8_t buf[65536];
 
-  // FIXME DATA frames can be giga bytes
+  // A DATA payload is not copied out, the frame shares it with the stream buffer
+  int64_t head_len = stream_io.peek(buf, std::min(frame_len, static_cast<size_t>(16)));
+  if (head_len > 0 && Http3Frame::type(buf, head_len) == Http3FrameType::DATA) {
+    size_t payload_offset = QUICVariableInt::size(buf);
+    payload_offset += QUICVariableInt::size(buf + payload_offset);
+    if (frame_len > payload_offset) {
+      Ptr<IOBufferBlock> payload = stream_io.peek_blocks(payload_offset, frame_len - payload_offset);
+      if (!payload) {
+        return nullptr;
+      }
+      return this->_fast_create_data(buf, payload_offset, payload);
+    }
+  }
+
+  // FIXME Other frames are copied out and limited to the size of buf
   ink_assert(sizeof(buf) > frame_len);
 
   if (stream_io.peek(buf, frame_len) < static_cast<int64_t>(frame_len)) {
@@ -429,6 +483,22 @@ Http3FrameFactory::fast_create(QUICStreamIO &stream_io, size_t frame_len)
   return this->fast_create(buf, frame_len);
 }
 
+std::shared_ptr<const Http3Frame>
+Http3FrameFactory::_fast_create_data(const uint8_t *header, size_t header_len, Ptr<IOBufferBlock> payload)
+{
+  std::shared_ptr<Http3Frame> &frame = this->_reusable_frames[static_cast<uint8_t>(Http3FrameType::DATA)];
+
+  if (frame == nullptr) {
+    Http3DataFrame *data_frame = http3DataFrameAllocator.alloc();
+    new (data_frame) Http3DataFrame(header, header_len, payload);
+    frame = Http3FrameUPtr(data_frame, &Http3FrameDeleter::delete_data_frame);
+  } else {
+    static_cast<Http3DataFrame *>(frame.get())->reset(header, header_len, payload);
+  }
+
+  return frame;
+}
+
 Http3HeadersFrameUPtr
 Http3FrameFactory::create_headers_frame(const uint8_t *header_block, size_t header_block_len)
 {
@@ -466,29 +536,18 @@ Http3FrameFactory::create_data_frame(const uint8_t *payload, size_t payload_len)
   return Http3DataFrameUPtr(frame, &Http3FrameDeleter::delete_data_frame);
 }
 
-// TODO: This should clone IOBufferBlock chain to avoid memcpy
+// The payload is not copied, the frame shares the blocks of @a reader.
 Http3DataFrameUPtr
 Http3FrameFactory::create_data_frame(IOBufferReader *reader, size_t payload_len)
 {
-  ats_unique_buf buf = ats_unique_malloc(payload_len);
-  size_t written     = 0;
-
-  while (written < payload_len) {
-    int64_t len = reader->block_read_avail();
-
-    if (written + len > payload_len) {
-      len = payload_len - written;
-    }
-
-    memcpy(buf.get() + written, reinterpret_cast<uint8_t *>(reader->start()), len);
-    reader->consume(len);
-    written += len;
-  }
+  IOBufferChain chain;
+  size_t written = chain.write(reader->get_current_block(), payload_len, reader->start_offset);
+  reader->consume(written);
 
   ink_assert(written == payload_len);
 
   Http3DataFrame *frame = http3DataFrameAllocator.alloc();
-  new (frame) Http3DataFrame(std::move(buf), payload_len);
+  new (frame) Http3DataFrame(make_ptr(chain.head()), payload_len);
 
   return Http3DataFrameUPtr(frame, &Http3FrameDeleter::delete_data_frame);
 }
@@ -76,17 +76,28 @@ public:
   Http3DataFrame() : Http3Frame() {}
   Http3DataFrame(const uint8_t *buf, size_t len);
   Http3DataFrame(ats_unique_buf payload, size_t payload_len);
+  /// A received frame whose payload stays in the stream buffer, @a header is the Type and Length fields only.
+  Http3DataFrame(const uint8_t *header, size_t header_len, Ptr<IOBufferBlock> payload);
+  /// A frame to send whose payload is in blocks shared with the body it comes from.
+  Http3DataFrame(Ptr<IOBufferBlock> payload, size_t payload_len);
 
   void store(uint8_t *buf, size_t *len) const override;
+  /// Store the Type and Length fields only, for the payload blocks to follow as they are.
+  void store_header(uint8_t *buf, size_t *len) const;
   void reset(const uint8_t *buf, size_t len) override;
+  void reset(const uint8_t *header, size_t header_len, Ptr<IOBufferBlock> payload);
 
+  /// nullptr if the payload is in blocks, see payload_block().
   const uint8_t *payload() const;
+  /// The payload blocks shared with the stream buffer, nullptr if the payload is flat.
+  const IOBufferBlock *payload_block() const;
   uint64_t payload_length() const;
 
 private:
   const uint8_t *_payload      = nullptr;
   ats_unique_buf _payload_uptr = {nullptr};
   size_t _payload_len          = 0;
+  Ptr<IOBufferBlock> _payload_blocks;
 };
 
 //
@@ -239,6 +250,8 @@ public:
   static Http3DataFrameUPtr create_data_frame(IOBufferReader *reader, size_t data_len);
 
 private:
+  std::shared_ptr<const Http3Frame> _fast_create_data(const uint8_t *header, size_t header_len, Ptr<IOBufferBlock> payload);
+
   std::shared_ptr<Http3Frame> _unknown_frame        = nullptr;
   std::shared_ptr<Http3Frame> _reusable_frames[256] = {nullptr};
 };
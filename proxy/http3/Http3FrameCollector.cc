@@ -30,7 +30,8 @@ Http3FrameCollector::on_write_ready(QUICStreamIO *stream_io, size_t &nwritten)
 {
   bool all_done = true;
   uint8_t tmp[32768];
-  nwritten = 0;
+  size_t buffered = 0; // in tmp, not written to the stream yet
+  nwritten        = 0;
 
   for (auto g : this->_generators) {
     if (g->is_done()) {
@@ -39,7 +40,20 @@ Http3FrameCollector::on_write_ready(QUICStreamIO *stream_io, size_t &nwritten)
     size_t len           = 0;
     Http3FrameUPtr frame = g->generate_frame(sizeof(tmp) - nwritten);
     if (frame) {
-      frame->store(tmp + nwritten, &len);
+      const Http3DataFrame *data = frame->type() == Http3FrameType::DATA ? static_cast<Http3DataFrame *>(frame.get()) : nullptr;
+
+      if (data && data->payload_block()) {
+        // Only the frame header goes through tmp, the blocks of the body follow it on the stream as they are.
+        data->store_header(tmp + buffered, &len);
+        buffered += len;
+        this->_flush(stream_io, tmp, buffered);
+        int64_t payload_len = stream_io->write(const_cast<IOBufferBlock *>(data->payload_block()));
+        ink_assert(payload_len >= 0 && static_cast<uint64_t>(payload_len) == data->payload_length());
+        len += payload_len;
+      } else {
+        frame->store(tmp + buffered, &len);
+        buffered += len;
+      }
       nwritten += len;
 
       Debug("http3", "[TX] [%d] | %s size=%zu", stream_io->stream_id(), Http3DebugNames::frame_type(frame->type()), len);
@@ -48,10 +62,7 @@ Http3FrameCollector::on_write_ready(QUICStreamIO *stream_io, size_t &nwritten)
     all_done &= g->is_done();
   }
 
-  if (nwritten) {
-    int64_t len = stream_io->write(tmp, nwritten);
-    ink_assert(len > 0 && (uint64_t)len == nwritten);
-  }
+  this->_flush(stream_io, tmp, buffered);
 
   if (all_done) {
     stream_io->write_done();
@@ -65,3 +76,13 @@ Http3FrameCollector::add_generator(Http3FrameGenerator *generator)
 {
   this->_generators.push_back(generator);
 }
+
+void
+Http3FrameCollector::_flush(QUICStreamIO *stream_io, const uint8_t *buf, size_t &len)
+{
+  if (len) {
+    int64_t written = stream_io->write(buf, len);
+    ink_assert(written > 0 && static_cast<uint64_t>(written) == len);
+    len = 0;
+  }
+}
@@ -36,5 +36,7 @@ public:
   void add_generator(Http3FrameGenerator *generator);
 
 private:
+  void _flush(QUICStreamIO *stream_io, const uint8_t *buf, size_t &len);
+
   std::vector<Http3FrameGenerator *> _generators;
 };
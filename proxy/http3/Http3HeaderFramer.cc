@@ -56,7 +56,12 @@ Http3HeaderFramer::generate_frame(uint16_t max_size)
     this->_header_block_wrote += len;
 
     if (this->_header_block_len == this->_header_block_wrote) {
-      this->_sent_all_data = true;
+      if (this->_header.type_get() == HTTP_TYPE_RESPONSE && this->_header.expect_final_response()) {
+        // An interim response, like 103 Early Hints. The final one follows in the same VIO.
+        this->_reset();
+      } else {
+        this->_sent_all_data = true;
+      }
     }
     return frame;
   } else {
@@ -111,3 +116,16 @@ Http3HeaderFramer::_generate_header_block()
     break;
   }
 }
+
+void
+Http3HeaderFramer::_reset()
+{
+  free_MIOBuffer(this->_header_block);
+  this->_header_block        = nullptr;
+  this->_header_block_reader = nullptr;
+  this->_header_block_len    = 0;
+  this->_header_block_wrote  = 0;
+  this->_header.destroy();
+  http_parser_clear(&this->_http_parser);
+  http_parser_init(&this->_http_parser);
+}
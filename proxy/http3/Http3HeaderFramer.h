@@ -57,4 +57,5 @@ private:
 
   void _convert_header_from_1_1_to_3(HTTPHdr *hdrs);
   void _generate_header_block();
+  void _reset();
 };
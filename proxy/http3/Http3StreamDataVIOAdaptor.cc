@@ -41,7 +41,11 @@ Http3StreamDataVIOAdaptor::handle_frame(std::shared_ptr<const Http3Frame> frame)
   SCOPED_MUTEX_LOCK(lock, this->_sink_vio->mutex, this_ethread());
 
   MIOBuffer *writer = this->_sink_vio->get_writer();
-  writer->write(dframe->payload(), dframe->payload_length());
+  if (dframe->payload_block()) {
+    writer->write(dframe->payload_block(), dframe->payload_length(), 0);
+  } else {
+    writer->write(dframe->payload(), dframe->payload_length());
+  }
   this->_total_data_length += dframe->payload_length();
 
   return Http3ErrorUPtr(new Http3NoError());
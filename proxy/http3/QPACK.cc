@@ -24,12 +24,37 @@
 #include "HTTP.h"
 #include "XPACK.h"
 #include "QPACK.h"
+#include "Http3.h"
 #include "tscore/ink_defs.h"
 #include "tscore/ink_memory.h"
 
+#include <algorithm>
+
 #define QPACKDebug(fmt, ...) Debug("qpack", "[%s] " fmt, this->_qc->cids().data(), ##__VA_ARGS__)
 #define QPACKDTDebug(fmt, ...) Debug("qpack", "" fmt, ##__VA_ARGS__)
 
+namespace
+{
+// A name and value goes into the dynamic table once it has been encoded this many times, so that one-off values such as
+// request ids don't evict the headers every response repeats.
+constexpr uint8_t QPACK_INDEX_AFTER_SEEN = 2;
+// Names and values remembered while waiting to see them again, forgotten all at once past this.
+constexpr size_t QPACK_MAX_INDEX_CANDIDATES = 1024;
+
+uint64_t
+qpack_name_hash(const char *name, int name_len)
+{
+  return std::hash<std::string_view>{}(std::string_view(name, name_len));
+}
+
+uint64_t
+qpack_field_hash(uint64_t name_hash, const char *value, int value_len)
+{
+  uint64_t value_hash = std::hash<std::string_view>{}(std::string_view(value, value_len));
+  return name_hash ^ (value_hash + 0x9e3779b97f4a7c15 + (name_hash << 6) + (name_hash >> 2));
+}
+} // namespace
+
 // qpack-05 Appendix A.
 const QPACK::Header QPACK::StaticTable::STATIC_HEADER_FIELDS[] = {
   {":authority", ""},
@@ -184,25 +209,42 @@ QPACK::encode(uint64_t stream_id, HTTPHdr &header_set, MIOBuffer *header_block,
 
   uint16_t base_index = this->_largest_known_received_index;
 
+  // A stream sends trailers in a second header block, its references add to those of the first
+  EntryReference *references = this->_find_references(stream_id);
+  if (references == nullptr) {
+    this->_references.push_back({stream_id, 0, {}});
+    references = &this->_references.back();
+  }
+  size_t first_reference = references->indices.size();
+
   // Compress headers and record the largest reference
-  uint16_t referred_index           = 0;
   uint16_t largest_reference        = 0;
-  uint16_t smallest_reference       = 0;
+  int64_t header_len                = 0;
   IOBufferBlock *compressed_headers = new_IOBufferBlock();
   compressed_headers->alloc(BUFFER_SIZE_INDEX_2K);
 
   MIMEFieldIter field_iter;
   for (MIMEField *field = header_set.iter_get_first(&field_iter); field != nullptr; field = header_set.iter_get_next(&field_iter)) {
-    int ret            = this->_encode_header(*field, base_index, compressed_headers, referred_index);
-    largest_reference  = std::max(largest_reference, referred_index);
-    smallest_reference = std::min(smallest_reference, referred_index);
+    int ret = this->_encode_header(*field, base_index, compressed_headers, *references);
     if (ret < 0) {
+      for (size_t i = first_reference; i < references->indices.size(); ++i) {
+        this->_dynamic_table.unref_entry(references->indices[i]);
+      }
+      references->indices.resize(first_reference);
+      if (references->indices.empty()) {
+        this->_forget_references(stream_id);
+      }
       compressed_headers->free();
       return ret;
     }
+    header_len += field->m_len_name + field->m_len_value;
+  }
+  for (size_t i = first_reference; i < references->indices.size(); ++i) {
+    largest_reference = std::max(largest_reference, references->indices[i]);
+  }
+  if (references->indices.empty()) {
+    this->_forget_references(stream_id);
   }
-  struct EntryReference eref = {smallest_reference, largest_reference};
-  this->_references.emplace(stream_id, eref);
 
   // Make an IOBufferBlock for Header Data Prefix
   IOBufferBlock *header_data_prefix = new_IOBufferBlock();
@@ -215,6 +257,9 @@ QPACK::encode(uint64_t stream_id, HTTPHdr &header_set, MIOBuffer *header_block,
   header_block->append_block(compressed_headers);
   header_block_len += compressed_headers->size();
 
+  HTTP3_SUM_RATIO_THREAD_DYN_STAT(HTTP3_STAT_HEADER_COMPRESSION_RATIO, this_ethread(),
+                                  header_data_prefix->size() + compressed_headers->size(), header_len);
+
   return 0;
 }
 
@@ -317,7 +362,7 @@ QPACK::_encode_prefix(uint16_t largest_reference, uint16_t base_index, IOBufferB
 }
 
 int
-QPACK::_encode_header(const MIMEField &field, uint16_t base_index, IOBufferBlock *compressed_header, uint16_t &referred_index)
+QPACK::_encode_header(const MIMEField &field, uint16_t base_index, IOBufferBlock *compressed_header, EntryReference &references)
 {
   Arena arena;
   int name_len;
@@ -338,6 +383,10 @@ QPACK::_encode_header(const MIMEField &field, uint16_t base_index, IOBufferBlock
   lookup_result_static = StaticTable::lookup(lowered_name, name_len, value, value_len);
   if (lookup_result_static.match_type != LookupResult::MatchType::EXACT) {
     lookup_result_dynamic = this->_dynamic_table.lookup(lowered_name, name_len, value, value_len);
+    bool index            = false;
+    if (lookup_result_dynamic.match_type != LookupResult::MatchType::EXACT && !never_index) {
+      index = this->_should_index(lowered_name, name_len, value, value_len);
+    }
     if (lookup_result_dynamic.match_type == LookupResult::MatchType::EXACT) {
       if (this->_dynamic_table.should_duplicate(lookup_result_dynamic.index)) {
         // Duplicate an entry and use the new entry
@@ -346,13 +395,13 @@ QPACK::_encode_header(const MIMEField &field, uint16_t base_index, IOBufferBlock
         if (lookup_result_dynamic.match_type != LookupResult::MatchType::NONE) {
           this->_write_duplicate(current_index);
           QPACKDebug("Wrote Duplicate: current_index=%d", current_index);
-          this->_dynamic_table.ref_entry(current_index);
+          this->_ref_entry(references, current_index);
         }
       }
     } else if (lookup_result_static.match_type == LookupResult::MatchType::NAME) {
       if (never_index) {
         // Name in static table is always available. Do nothing.
-      } else {
+      } else if (index) {
         // Insert both the name and the value
         lookup_result_dynamic = this->_dynamic_table.insert_entry(lowered_name, name_len, value, value_len);
         if (lookup_result_dynamic.match_type != LookupResult::MatchType::NONE) {
@@ -370,7 +419,7 @@ QPACK::_encode_header(const MIMEField &field, uint16_t base_index, IOBufferBlock
           if (lookup_result_dynamic.match_type != LookupResult::MatchType::NONE) {
             this->_write_duplicate(current_index);
             QPACKDebug("Wrote Duplicate: current_index=%d", current_index);
-            this->_dynamic_table.ref_entry(current_index);
+            this->_ref_entry(references, current_index);
           }
         }
       } else {
@@ -381,9 +430,9 @@ QPACK::_encode_header(const MIMEField &field, uint16_t base_index, IOBufferBlock
           if (lookup_result_dynamic.match_type != LookupResult::MatchType::NONE) {
             this->_write_duplicate(current_index);
             QPACKDebug("Wrote Duplicate: current_index=%d", current_index);
-            this->_dynamic_table.ref_entry(current_index);
+            this->_ref_entry(references, current_index);
           }
-        } else {
+        } else if (index) {
           // Insert both the name and the value
           uint16_t current_index = lookup_result_dynamic.index;
           lookup_result_dynamic  = this->_dynamic_table.insert_entry(lowered_name, name_len, value, value_len);
@@ -401,7 +450,7 @@ QPACK::_encode_header(const MIMEField &field, uint16_t base_index, IOBufferBlock
           this->_write_insert_without_name_ref(lowered_name, name_len, "", 0);
           QPACKDebug("Wrote Insert Without Name Ref: name=%.*s value=%.*s", name_len, lowered_name, 0, "");
         }
-      } else {
+      } else if (index) {
         // Insert both the name and the value
         lookup_result_dynamic = this->_dynamic_table.insert_entry(lowered_name, name_len, value, value_len);
         if (lookup_result_dynamic.match_type != LookupResult::MatchType::NONE) {
@@ -410,6 +459,12 @@ QPACK::_encode_header(const MIMEField &field, uint16_t base_index, IOBufferBlock
         }
       }
     }
+
+    // An entry the decoder may not have received yet blocks the stream until it has, only so many streams may be blocked
+    if (lookup_result_dynamic.match_type != LookupResult::MatchType::NONE &&
+        lookup_result_dynamic.index > this->_largest_known_received_index && !this->_can_block(references)) {
+      lookup_result_dynamic.match_type = LookupResult::MatchType::NONE;
+    }
   }
 
   // Encode
@@ -417,9 +472,8 @@ QPACK::_encode_header(const MIMEField &field, uint16_t base_index, IOBufferBlock
     this->_encode_indexed_header_field(lookup_result_static.index, base_index, false, compressed_header);
     QPACKDebug("Encoded Indexed Header Field: abs_index=%d, base_index=%d, dynamic_table=%d", lookup_result_static.index,
                base_index, false);
-    referred_index = 0;
   } else if (lookup_result_dynamic.match_type == LookupResult::MatchType::EXACT) {
-    if (lookup_result_dynamic.index < this->_largest_known_received_index) {
+    if (lookup_result_dynamic.index <= this->_largest_known_received_index) {
       this->_encode_indexed_header_field(lookup_result_dynamic.index, base_index, true, compressed_header);
       QPACKDebug("Encoded Indexed Header Field: abs_index=%d, base_index=%d, dynamic_table=%d", lookup_result_dynamic.index,
                  base_index, true);
@@ -429,15 +483,13 @@ QPACK::_encode_header(const MIMEField &field, uint16_t base_index, IOBufferBlock
       QPACKDebug("Encoded Indexed Header With Postbase Index: abs_index=%d, base_index=%d, never_index=%d",
                  lookup_result_dynamic.index, base_index, never_index);
     }
-    this->_dynamic_table.ref_entry(lookup_result_dynamic.index);
-    referred_index = lookup_result_dynamic.index;
+    this->_ref_entry(references, lookup_result_dynamic.index);
   } else if (lookup_result_static.match_type == LookupResult::MatchType::NAME) {
     this->_encode_literal_header_field_with_name_ref(lookup_result_static.index, false, base_index, value, value_len, never_index,
                                                      compressed_header);
     QPACKDebug(
       "Encoded Literal Header Field With Name Ref: abs_index=%d, base_index=%d, dynamic_table=%d, value=%.*s, never_index=%d",
       lookup_result_static.index, base_index, false, value_len, value, never_index);
-    referred_index = 0;
   } else if (lookup_result_dynamic.match_type == LookupResult::MatchType::NAME) {
     if (lookup_result_dynamic.index <= this->_largest_known_received_index) {
       this->_encode_literal_header_field_with_name_ref(lookup_result_dynamic.index, true, base_index, value, value_len, never_index,
@@ -451,8 +503,7 @@ QPACK::_encode_header(const MIMEField &field, uint16_t base_index, IOBufferBlock
       QPACKDebug("Encoded Literal Header Field With Postbase Name Ref: abs_index=%d, base_index=%d, value=%.*s, never_index=%d",
                  lookup_result_dynamic.index, base_index, value_len, value, never_index);
     }
-    this->_dynamic_table.ref_entry(lookup_result_dynamic.index);
-    referred_index = lookup_result_dynamic.index;
+    this->_ref_entry(references, lookup_result_dynamic.index);
   } else {
     this->_encode_literal_header_field_without_name_ref(lowered_name, name_len, value, value_len, never_index, compressed_header);
     QPACKDebug("Encoded Literal Header Field Without Name Ref: name=%.*s, value=%.*s, never_index=%d", name_len, lowered_name,
@@ -957,21 +1008,93 @@ QPACK::_update_largest_known_received_index_by_insert_count(uint16_t insert_coun
 void
 QPACK::_update_largest_known_received_index_by_stream_id(uint64_t stream_id)
 {
-  uint16_t largest_ref_index = this->_references[stream_id].largest;
-  if (largest_ref_index > this->_largest_known_received_index) {
-    this->_largest_known_received_index = largest_ref_index;
+  EntryReference *references = this->_find_references(stream_id);
+  if (references && references->largest > this->_largest_known_received_index) {
+    this->_largest_known_received_index = references->largest;
   }
 }
 
 void
 QPACK::_update_reference_counts(uint64_t stream_id)
 {
-  uint16_t smallest_ref_index = this->_references[stream_id].smallest;
-  if (smallest_ref_index) {
-    this->_dynamic_table.unref_entry(smallest_ref_index);
+  EntryReference *references = this->_find_references(stream_id);
+  if (references) {
+    for (uint16_t index : references->indices) {
+      this->_dynamic_table.unref_entry(index);
+    }
+  }
+}
+
+QPACK::EntryReference *
+QPACK::_find_references(uint64_t stream_id)
+{
+  for (auto &references : this->_references) {
+    if (references.stream_id == stream_id) {
+      return &references;
+    }
+  }
+  return nullptr;
+}
+
+void
+QPACK::_forget_references(uint64_t stream_id)
+{
+  for (auto &references : this->_references) {
+    if (references.stream_id == stream_id) {
+      if (&references != &this->_references.back()) {
+        references = std::move(this->_references.back());
+      }
+      this->_references.pop_back();
+      return;
+    }
   }
 }
 
+void
+QPACK::_ref_entry(EntryReference &references, uint16_t index)
+{
+  this->_dynamic_table.ref_entry(index);
+  references.indices.push_back(index);
+  references.largest = std::max(references.largest, index);
+}
+
+bool
+QPACK::_can_block(const EntryReference &references) const
+{
+  if (references.largest > this->_largest_known_received_index) {
+    // The stream may already be blocked
+    return true;
+  }
+
+  uint16_t blocking = 0;
+  for (const auto &r : this->_references) {
+    if (r.largest > this->_largest_known_received_index) {
+      ++blocking;
+    }
+  }
+  return blocking < this->_max_blocking_streams;
+}
+
+bool
+QPACK::_should_index(const char *name, int name_len, const char *value, int value_len)
+{
+  // A large entry would evict many small ones
+  if (name_len + value_len > this->_dynamic_table.max_size() / 4) {
+    return false;
+  }
+
+  if (this->_index_candidates.size() >= QPACK_MAX_INDEX_CANDIDATES) {
+    this->_index_candidates.clear();
+  }
+  uint64_t key  = qpack_field_hash(qpack_name_hash(name, name_len), value, value_len);
+  uint8_t &seen = this->_index_candidates[key];
+  if (++seen < QPACK_INDEX_AFTER_SEEN) {
+    return false;
+  }
+  this->_index_candidates.erase(key);
+  return true;
+}
+
 void
 QPACK::_resume_decode()
 {
@@ -1047,14 +1170,14 @@ QPACK::_on_decoder_stream_read_ready(QUICStreamIO &stream_io)
         QPACKDebug("Received Header Acknowledgement: stream_id=%" PRIu64, stream_id);
         this->_update_largest_known_received_index_by_stream_id(stream_id);
         this->_update_reference_counts(stream_id);
-        this->_references.erase(stream_id);
+        this->_forget_references(stream_id);
       }
     } else if (buf & 0x40) { // Stream Cancellation
       uint64_t stream_id;
       if (this->_read_stream_cancellation(stream_io, stream_id) >= 0) {
         QPACKDebug("Received Stream Cancellation: stream_id=%" PRIu64, stream_id);
         this->_update_reference_counts(stream_id);
-        this->_references.erase(stream_id);
+        this->_forget_references(stream_id);
       }
     } else { // Table State Synchronize
       uint16_t insert_count;
@@ -1219,7 +1342,8 @@ QPACK::_attach_header(HTTPHdr &hdr, const char *name, int name_len, const char *
 //
 // DynamicTable
 //
-QPACK::DynamicTable::DynamicTable(uint16_t size) : _available(size), _max_entries(size), _storage(new DynamicTableStorage(size))
+QPACK::DynamicTable::DynamicTable(uint16_t size)
+  : _available(size), _max_size(size), _max_entries(size), _storage(new DynamicTableStorage(size))
 {
   QPACKDTDebug("Dynamic table size: %u", size);
   this->_entries      = static_cast<struct DynamicTableEntry *>(ats_malloc(sizeof(struct DynamicTableEntry) * size));
@@ -1244,7 +1368,7 @@ QPACK::DynamicTable::lookup(uint16_t index, const char **name, int *name_len, co
 {
   // ink_assert(index >= this->_entries[(this->_entries_tail + 1) % this->_max_entries].index);
   // ink_assert(index <= this->_entries[this->_entries_head].index);
-  uint16_t pos = (this->_entries_head + (index - this->_entries[this->_entries_head].index)) % this->_max_entries;
+  uint16_t pos = this->_position(index);
   *name_len    = this->_entries[pos].name_len;
   *value_len   = this->_entries[pos].value_len;
   this->_storage->read(this->_entries[pos].offset, name, *name_len, value, *value_len);
@@ -1254,38 +1378,22 @@ QPACK::DynamicTable::lookup(uint16_t index, const char **name, int *name_len, co
 const QPACK::LookupResult
 QPACK::DynamicTable::lookup(const char *name, int name_len, const char *value, int value_len)
 {
-  QPACK::LookupResult::MatchType match_type = QPACK::LookupResult::MatchType::NONE;
-  uint16_t i                                = this->_entries_tail + 1;
-  int end                                   = this->_entries_head;
-  uint16_t candidate_index                  = 0;
-  const char *tmp_name                      = nullptr;
-  const char *tmp_value                     = nullptr;
-
   // DynamicTable is empty
-  if (this->_entries_inserted == 0) {
-    return {candidate_index, match_type};
-  }
-
-  // TODO Use a tree for better perfomance
-  for (; i <= end; i = (i + 1) % this->_max_entries) {
-    if (name_len != 0 && this->_entries[i].name_len == name_len) {
-      this->_storage->read(this->_entries[i].offset, &tmp_name, this->_entries[i].name_len, &tmp_value,
-                           this->_entries[i].value_len);
-      if (memcmp(name, tmp_name, name_len) == 0) {
-        candidate_index = this->_entries[i].index;
-        if (value_len == this->_entries[i].value_len && memcmp(value, tmp_value, value_len) == 0) {
-          // Exact match
-          match_type = QPACK::LookupResult::MatchType::EXACT;
-          break;
-        } else {
-          // Name match -- Keep it for no exact matchs
-          match_type = QPACK::LookupResult::MatchType::NAME;
-        }
-      }
-    }
+  if (this->_entries_inserted == 0 || name_len == 0) {
+    return {UINT16_C(0), QPACK::LookupResult::MatchType::NONE};
   }
 
-  return {candidate_index, match_type};
+  uint64_t name_hash = qpack_name_hash(name, name_len);
+  auto field         = this->_field_index.find(qpack_field_hash(name_hash, value, value_len));
+  if (field != this->_field_index.end() && this->_matches(field->second, name, name_len, value, value_len)) {
+    return {field->second, QPACK::LookupResult::MatchType::EXACT};
+  }
+  auto name_only = this->_name_index.find(name_hash);
+  if (name_only != this->_name_index.end() && this->_matches(name_only->second, name, name_len, nullptr, -1)) {
+    return {name_only->second, QPACK::LookupResult::MatchType::NAME};
+  }
+
+  return {UINT16_C(0), QPACK::LookupResult::MatchType::NONE};
 }
 
 const QPACK::LookupResult
@@ -1315,7 +1423,8 @@ QPACK::DynamicTable::insert_entry(const char *name, uint16_t name_len, const cha
   uint16_t required_len = name_len + value_len;
   uint16_t available    = this->_available;
   uint16_t tail         = (this->_entries_tail + 1) % this->_max_entries;
-  while (available < required_len) {
+  uint16_t end          = (this->_entries_head + 1) % this->_max_entries;
+  while (available < required_len && tail != end) {
     if (this->_entries[tail].ref_count) {
       break;
     }
@@ -1329,10 +1438,14 @@ QPACK::DynamicTable::insert_entry(const char *name, uint16_t name_len, const cha
 
   // Evict
   if (this->_available != available) {
+    uint16_t last = (tail + this->_max_entries - 1) % this->_max_entries;
     QPACKDTDebug("Evict entries: from %u to %u", this->_entries[(this->_entries_tail + 1) % this->_max_entries].index,
-                 this->_entries[tail - 1].index);
+                 this->_entries[last].index);
+    for (uint16_t i = (this->_entries_tail + 1) % this->_max_entries; i != tail; i = (i + 1) % this->_max_entries) {
+      this->_unindex_entry(this->_entries[i]);
+    }
     this->_available    = available;
-    this->_entries_tail = tail - 1;
+    this->_entries_tail = last;
     QPACKDTDebug("Available size: %u", this->_available);
   }
 
@@ -1341,6 +1454,7 @@ QPACK::DynamicTable::insert_entry(const char *name, uint16_t name_len, const cha
   this->_entries[this->_entries_head] = {++this->_entries_inserted, this->_storage->write(name, name_len, value, value_len),
                                          name_len, value_len, 0};
   this->_available -= required_len;
+  this->_index_entry(this->_entries[this->_entries_head]);
 
   QPACKDTDebug("Insert Entry: entry=%u, index=%u, size=%u", this->_entries_head, this->_entries_inserted, name_len + value_len);
   QPACKDTDebug("Available size: %u", this->_available);
@@ -1385,15 +1499,13 @@ QPACK::DynamicTable::update_size(uint16_t max_size)
 void
 QPACK::DynamicTable::ref_entry(uint16_t index)
 {
-  uint16_t pos = (this->_entries_head + (index - this->_entries[this->_entries_head].index)) % this->_max_entries;
-  ++this->_entries[pos].ref_count;
+  ++this->_entries[this->_position(index)].ref_count;
 }
 
 void
 QPACK::DynamicTable::unref_entry(uint16_t index)
 {
-  uint16_t pos = (this->_entries_head + (index - this->_entries[this->_entries_head].index)) % this->_max_entries;
-  --this->_entries[pos].ref_count;
+  --this->_entries[this->_position(index)].ref_count;
 }
 
 uint16_t
@@ -1402,6 +1514,64 @@ QPACK::DynamicTable::largest_index()
   return this->_entries_inserted;
 }
 
+uint16_t
+QPACK::DynamicTable::max_size() const
+{
+  return this->_max_size;
+}
+
+uint16_t
+QPACK::DynamicTable::_position(uint16_t index) const
+{
+  uint16_t behind_head = this->_entries[this->_entries_head].index - index;
+  return (this->_entries_head + this->_max_entries - behind_head) % this->_max_entries;
+}
+
+// A negative @a value_len compares the name only.
+bool
+QPACK::DynamicTable::_matches(uint16_t index, const char *name, int name_len, const char *value, int value_len) const
+{
+  const DynamicTableEntry &entry = this->_entries[this->_position(index)];
+  if (entry.index != index || entry.name_len != name_len || (value_len >= 0 && entry.value_len != value_len)) {
+    return false;
+  }
+
+  const char *entry_name;
+  const char *entry_value;
+  this->_storage->read(entry.offset, &entry_name, entry.name_len, &entry_value, entry.value_len);
+  return memcmp(name, entry_name, name_len) == 0 && (value_len < 0 || memcmp(value, entry_value, value_len) == 0);
+}
+
+void
+QPACK::DynamicTable::_index_entry(const DynamicTableEntry &entry)
+{
+  const char *name;
+  const char *value;
+  this->_storage->read(entry.offset, &name, entry.name_len, &value, entry.value_len);
+  uint64_t name_hash                                                     = qpack_name_hash(name, entry.name_len);
+  this->_name_index[name_hash]                                           = entry.index;
+  this->_field_index[qpack_field_hash(name_hash, value, entry.value_len)] = entry.index;
+}
+
+void
+QPACK::DynamicTable::_unindex_entry(const DynamicTableEntry &entry)
+{
+  const char *name;
+  const char *value;
+  this->_storage->read(entry.offset, &name, entry.name_len, &value, entry.value_len);
+  uint64_t name_hash = qpack_name_hash(name, entry.name_len);
+
+  // A newer entry with the same name or value keeps its place
+  auto name_only = this->_name_index.find(name_hash);
+  if (name_only != this->_name_index.end() && name_only->second == entry.index) {
+    this->_name_index.erase(name_only);
+  }
+  auto field = this->_field_index.find(qpack_field_hash(name_hash, value, entry.value_len));
+  if (field != this->_field_index.end() && field->second == entry.index) {
+    this->_field_index.erase(field);
+  }
+}
+
 int
 QPACK::_write_insert_with_name_ref(uint16_t index, bool dynamic, const char *value, uint16_t value_len)
 {
@@ -23,7 +23,9 @@
 
 #pragma once
 
-#include <map>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
 
 #include "I_EventSystem.h"
 #include "I_Event.h"
@@ -140,9 +142,16 @@ private:
     void ref_entry(uint16_t index);
     void unref_entry(uint16_t index);
     uint16_t largest_index();
+    uint16_t max_size() const;
 
   private:
+    uint16_t _position(uint16_t index) const;
+    bool _matches(uint16_t index, const char *name, int name_len, const char *value, int value_len) const;
+    void _index_entry(const DynamicTableEntry &entry);
+    void _unindex_entry(const DynamicTableEntry &entry);
+
     uint16_t _available        = 0;
+    uint16_t _max_size         = 0;
     uint16_t _entries_inserted = 0;
 
     // FIXME It may be better to split this array into small arrays to reduce memory footprint
@@ -151,6 +160,11 @@ private:
     uint16_t _entries_head             = 0;
     uint16_t _entries_tail             = 0;
     DynamicTableStorage *_storage      = nullptr;
+
+    // Hashes of the name, and of the name and value, to the absolute index of the newest entry that has them.
+    // A hit is checked against the entry itself, so a collision only costs a missed match.
+    std::unordered_map<uint64_t, uint16_t> _name_index;
+    std::unordered_map<uint64_t, uint16_t> _field_index;
   };
 
   class DecodeRequest
@@ -239,13 +253,18 @@ private:
     DecodeRequest *_prev = nullptr;
   };
 
+  // Dynamic table entries a stream's header blocks refer to, held until the decoder acknowledges or cancels the stream.
   struct EntryReference {
-    uint16_t smallest;
-    uint16_t largest;
+    uint64_t stream_id = 0;
+    uint16_t largest   = 0;
+    std::vector<uint16_t> indices;
   };
 
   DynamicTable _dynamic_table;
-  std::map<uint64_t, struct EntryReference> _references;
+  // Few streams are in flight at once, a flat vector scans faster than a tree
+  std::vector<EntryReference> _references;
+  // How many times each name and value has been encoded without being in the dynamic table
+  std::unordered_map<uint64_t, uint8_t> _index_candidates;
   uint32_t _max_header_list_size = 0;
   uint16_t _max_table_size       = 0;
   uint16_t _max_blocking_streams = 0;
@@ -264,6 +283,11 @@ private:
   void _update_largest_known_received_index_by_stream_id(uint64_t stream_id);
 
   void _update_reference_counts(uint64_t stream_id);
+  EntryReference *_find_references(uint64_t stream_id);
+  void _forget_references(uint64_t stream_id);
+  void _ref_entry(EntryReference &references, uint16_t index);
+  bool _can_block(const EntryReference &references) const;
+  bool _should_index(const char *name, int name_len, const char *value, int value_len);
 
   // Encoder Stream
   int _read_insert_with_name_ref(QUICStreamIO &stream_io, bool &is_static, uint16_t &index, Arena &arena, char **value,
@@ -287,7 +311,7 @@ private:
 
   // Request and Push Streams
   int _encode_prefix(uint16_t largest_reference, uint16_t base_index, IOBufferBlock *prefix);
-  int _encode_header(const MIMEField &field, uint16_t base_index, IOBufferBlock *compressed_header, uint16_t &referred_index);
+  int _encode_header(const MIMEField &field, uint16_t base_index, IOBufferBlock *compressed_header, EntryReference &references);
   int _encode_indexed_header_field(uint16_t index, uint16_t base_index, bool dynamic_table, IOBufferBlock *compressed_header);
   int _encode_indexed_header_field_with_postbase_index(uint16_t index, uint16_t base_index, bool never_index,
                                                        IOBufferBlock *compressed_header);
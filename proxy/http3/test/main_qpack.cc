@@ -36,6 +36,7 @@
 #include "QUICConfig.h"
 #include "HuffmanCodec.h"
 #include "QPACK.h"
+#include "Http3.h"
 #include "HTTP.h"
 
 #define TEST_THREADS 1
@@ -77,6 +78,7 @@ struct EventProcessorListener : Catch::TestEventListenerBase {
     mime_init();
     http_init();
     hpack_huffman_init();
+    Http3::init();
   }
 };
 CATCH_REGISTER_LISTENER(EventProcessorListener);
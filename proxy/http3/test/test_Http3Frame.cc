@@ -69,6 +69,34 @@ TEST_CASE("Load DATA Frame", "[http3]")
     CHECK(data_frame->payload_length() == 4);
     CHECK(memcmp(data_frame->payload(), "\x11\x22\x33\x44", 4) == 0);
   }
+
+  SECTION("Payload in blocks")
+  {
+    uint8_t header[] = {
+      0x00, // Type
+      0x04, // Length
+    };
+    Ptr<IOBufferBlock> payload = make_ptr<IOBufferBlock>(new_IOBufferBlock());
+    payload->alloc(BUFFER_SIZE_INDEX_128);
+    memcpy(payload->end(), "\x11\x22", 2);
+    payload->fill(2);
+    payload->next = make_ptr<IOBufferBlock>(new_IOBufferBlock());
+    payload->next->alloc(BUFFER_SIZE_INDEX_128);
+    memcpy(payload->next->end(), "\x33\x44", 2);
+    payload->next->fill(2);
+
+    Http3DataFrame data_frame(header, sizeof(header), payload);
+    CHECK(data_frame.type() == Http3FrameType::DATA);
+    CHECK(data_frame.payload_length() == 4);
+    CHECK(data_frame.payload() == nullptr);
+    CHECK(data_frame.payload_block() == payload.get());
+
+    uint8_t buf[32] = {0};
+    size_t len;
+    data_frame.store(buf, &len);
+    CHECK(len == 6);
+    CHECK(memcmp(buf, "\x00\x04\x11\x22\x33\x44", len) == 0);
+  }
 }
 
 TEST_CASE("Store DATA Frame", "[http3]")
@@ -94,6 +122,33 @@ TEST_CASE("Store DATA Frame", "[http3]")
     CHECK(len == 6);
     CHECK(memcmp(buf, expected1, len) == 0);
   }
+
+  SECTION("Payload shared with the body")
+  {
+    MIOBuffer *body        = new_MIOBuffer(BUFFER_SIZE_INDEX_128);
+    IOBufferReader *reader = body->alloc_reader();
+    body->write("\x11\x22\x33\x44\x55", 5);
+
+    Http3DataFrameUPtr data_frame = Http3FrameFactory::create_data_frame(reader, 4);
+    CHECK(data_frame->length() == 4);
+    CHECK(data_frame->payload() == nullptr);
+    REQUIRE(data_frame->payload_block() != nullptr);
+    CHECK(data_frame->payload_block()->_start == body->first_write_block()->start());
+    CHECK(reader->read_avail() == 1);
+
+    uint8_t buf[32] = {0};
+    size_t len;
+    data_frame->store_header(buf, &len);
+    CHECK(len == 2);
+    CHECK(memcmp(buf, "\x00\x04", len) == 0);
+
+    data_frame->store(buf, &len);
+    CHECK(len == 6);
+    CHECK(memcmp(buf, "\x00\x04\x11\x22\x33\x44", len) == 0);
+
+    data_frame.reset();
+    free_MIOBuffer(body);
+  }
 }
 
 TEST_CASE("Store HEADERS Frame", "[http3]")
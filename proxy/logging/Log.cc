@@ -48,11 +48,15 @@
 #include "LogConfig.h"
 #include "LogBuffer.h"
 #include "LogUtils.h"
+#include "LogFlushWriter.h"
 #include "Log.h"
 #include "tscore/SimpleTokenizer.h"
 
 #include "tscore/ink_apidefs.h"
 
+#include <atomic>
+#include <deque>
+
 #define PERIODIC_TASKS_INTERVAL_FALLBACK 5
 
 // Log global objects
@@ -155,6 +159,36 @@ Log::change_configuration()
   thread will keep track of executions per period.
   -------------------------------------------------------------------------*/
 
+/*-------------------------------------------------------------------------
+  LogSpaceCheck
+
+  Counts the space used by the logs, and deletes rolled logs when it runs
+  short, on a task thread. Scanning the log directory and unlinking large
+  files can take a long time, and in the flush thread the buffers would
+  back up meanwhile. The periodic tasks start one check at a time.
+  -------------------------------------------------------------------------*/
+
+struct LogSpaceCheck : public Continuation {
+  static std::atomic<bool> running;
+
+  int
+  mainEvent(int /* event ATS_UNUSED */, void * /* data ATS_UNUSED */)
+  {
+    // the configuration may be replaced meanwhile, hold on to the one being checked
+    if (LogConfig *current = static_cast<LogConfig *>(configProcessor.get(log_configid))) {
+      current->update_space_used();
+      configProcessor.release(log_configid, current);
+    }
+    running = false;
+    delete this;
+    return EVENT_DONE;
+  }
+
+  LogSpaceCheck() : Continuation(new_ProxyMutex()) { SET_HANDLER(&LogSpaceCheck::mainEvent); }
+};
+
+std::atomic<bool> LogSpaceCheck::running{false};
+
 /*-------------------------------------------------------------------------
   PeriodicWakeup
 
@@ -225,8 +259,8 @@ Log::periodic_tasks(long time_now)
 
     // Check if space is ok and update the space used
     //
-    if (config->space_is_short() || time_now % config->space_used_frequency == 0) {
-      Log::config->update_space_used();
+    if ((config->space_is_short() || time_now % config->space_used_frequency == 0) && !LogSpaceCheck::running.exchange(true)) {
+      eventProcessor.schedule_imm(new LogSpaceCheck, ET_TASK);
     }
 
     // See if there are any buffers that have expired
@@ -512,6 +546,26 @@ Log::init_fields()
   global_field_list.add(field, false);
   field_symbol_hash.emplace("cqmpt", field);
 
+  field = new LogField("client_tcp_rtt", "ctrtt", LogField::sINT, &LogAccess::marshal_client_tcp_rtt,
+                       &LogAccess::unmarshal_int_to_str);
+  global_field_list.add(field, false);
+  field_symbol_hash.emplace("ctrtt", field);
+
+  field = new LogField("client_tcp_cwnd", "ctcwnd", LogField::sINT, &LogAccess::marshal_client_tcp_cwnd,
+                       &LogAccess::unmarshal_int_to_str);
+  global_field_list.add(field, false);
+  field_symbol_hash.emplace("ctcwnd", field);
+
+  field = new LogField("client_tcp_retransmits", "ctretx", LogField::sINT, &LogAccess::marshal_client_tcp_retransmits,
+                       &LogAccess::unmarshal_int_to_str);
+  global_field_list.add(field, false);
+  field_symbol_hash.emplace("ctretx", field);
+
+  field = new LogField("client_tcp_delivery_rate", "ctrate", LogField::sINT, &LogAccess::marshal_client_tcp_delivery_rate,
+                       &LogAccess::unmarshal_int_to_str);
+  global_field_list.add(field, false);
+  field_symbol_hash.emplace("ctrate", field);
+
   field = new LogField("client_sec_protocol", "cqssv", LogField::STRING, &LogAccess::marshal_client_security_protocol,
                        reinterpret_cast<LogField::UnmarshalFunc>(&LogAccess::unmarshal_str));
   global_field_list.add(field, false);
@@ -527,6 +581,11 @@ Log::init_fields()
   global_field_list.add(field, false);
   field_symbol_hash.emplace("cqssu", field);
 
+  field = new LogField("client_ja3", "cqssj", LogField::STRING, &LogAccess::marshal_client_security_ja3,
+                       reinterpret_cast<LogField::UnmarshalFunc>(&LogAccess::unmarshal_str));
+  global_field_list.add(field, false);
+  field_symbol_hash.emplace("cqssj", field);
+
   Ptr<LogFieldAliasTable> finish_status_map = make_ptr(new LogFieldAliasTable);
   finish_status_map->init(N_LOG_FINISH_CODE_TYPES, LOG_FINISH_FIN, "FIN", LOG_FINISH_INTR, "INTR", LOG_FINISH_TIMEOUT, "TIMEOUT");
 
@@ -811,6 +870,26 @@ Log::init_fields()
   global_field_list.add(field, false);
   field_symbol_hash.emplace("sca", field);
 
+  field = new LogField("server_tcp_rtt", "strtt", LogField::sINT, &LogAccess::marshal_server_tcp_rtt,
+                       &LogAccess::unmarshal_int_to_str);
+  global_field_list.add(field, false);
+  field_symbol_hash.emplace("strtt", field);
+
+  field = new LogField("server_tcp_cwnd", "stcwnd", LogField::sINT, &LogAccess::marshal_server_tcp_cwnd,
+                       &LogAccess::unmarshal_int_to_str);
+  global_field_list.add(field, false);
+  field_symbol_hash.emplace("stcwnd", field);
+
+  field = new LogField("server_tcp_retransmits", "stretx", LogField::sINT, &LogAccess::marshal_server_tcp_retransmits,
+                       &LogAccess::unmarshal_int_to_str);
+  global_field_list.add(field, false);
+  field_symbol_hash.emplace("stretx", field);
+
+  field = new LogField("server_tcp_delivery_rate", "strate", LogField::sINT, &LogAccess::marshal_server_tcp_delivery_rate,
+                       &LogAccess::unmarshal_int_to_str);
+  global_field_list.add(field, false);
+  field_symbol_hash.emplace("strate", field);
+
   field = new LogField("origin_response_all_header_fields", "ssah", LogField::STRING,
                        &LogAccess::marshal_server_resp_all_header_fields, &LogUtils::unmarshalMimeHdr);
   global_field_list.add(field, false);
@@ -892,6 +971,43 @@ Log::init_fields()
   global_field_list.add(field, false);
   field_symbol_hash.emplace("fsiz", field);
 
+  // transaction profile fields, see proxy.config.http.profile.sample_rate
+
+  field = new LogField("profile_plugin_cpu_us", "tppc", LogField::sINT, &LogAccess::marshal_profile_plugin_cpu,
+                       &LogAccess::unmarshal_int_to_str);
+  global_field_list.add(field, false);
+  field_symbol_hash.emplace("tppc", field);
+
+  field = new LogField("profile_plugins", "tppl", LogField::STRING, &LogAccess::marshal_profile_plugins,
+                       reinterpret_cast<LogField::UnmarshalFunc>(&LogAccess::unmarshal_str));
+  global_field_list.add(field, false);
+  field_symbol_hash.emplace("tppl", field);
+
+  field = new LogField("profile_hooks", "tphk", LogField::STRING, &LogAccess::marshal_profile_hooks,
+                       reinterpret_cast<LogField::UnmarshalFunc>(&LogAccess::unmarshal_str));
+  global_field_list.add(field, false);
+  field_symbol_hash.emplace("tphk", field);
+
+  field = new LogField("profile_lock_retries", "tplr", LogField::sINT, &LogAccess::marshal_profile_lock_retries,
+                       &LogAccess::unmarshal_int_to_str);
+  global_field_list.add(field, false);
+  field_symbol_hash.emplace("tplr", field);
+
+  field = new LogField("profile_cache_wait_ms", "tpwc", LogField::sINT, &LogAccess::marshal_profile_cache_wait,
+                       &LogAccess::unmarshal_int_to_str);
+  global_field_list.add(field, false);
+  field_symbol_hash.emplace("tpwc", field);
+
+  field = new LogField("profile_dns_wait_ms", "tpwd", LogField::sINT, &LogAccess::marshal_profile_dns_wait,
+                       &LogAccess::unmarshal_int_to_str);
+  global_field_list.add(field, false);
+  field_symbol_hash.emplace("tpwd", field);
+
+  field = new LogField("profile_origin_wait_ms", "tpwo", LogField::sINT, &LogAccess::marshal_profile_origin_wait,
+                       &LogAccess::unmarshal_int_to_str);
+  global_field_list.add(field, false);
+  field_symbol_hash.emplace("tpwo", field);
+
   field = new LogField("client_connection_id", "ccid", LogField::sINT, &LogAccess::marshal_client_http_connection_id,
                        &LogAccess::unmarshal_int_to_str);
   global_field_list.add(field, false);
@@ -1325,8 +1441,10 @@ Log::flush_thread_main(void * /* args ATS_UNUSED */)
   LogBuffer *logbuffer;
   LogFlushData *fdata;
   ink_hrtime now, last_time = 0;
-  int len, total_bytes;
-  SLL<LogFlushData, LogFlushData::Link_link> link, invert_link;
+  int total_bytes;
+  SLL<LogFlushData, LogFlushData::Link_link> link, invert_link, written;
+  std::deque<std::string> columnar_blocks; // reused, one for each columnar buffer of a batch
+  LogFlushWriter writer;
   ProxyMutex *mutex = this_thread()->mutex.get();
 
   Log::flush_notify->lock();
@@ -1344,12 +1462,12 @@ Log::flush_thread_main(void * /* args ATS_UNUSED */)
       invert_link.push(fdata);
     }
 
-    // process each flush data
+    // process each flush data, they are all written before any is freed
     //
+    size_t n_columnar = 0;
     while ((fdata = invert_link.pop())) {
-      char *buf         = nullptr;
-      int bytes_written = 0;
-      LogFile *logfile  = fdata->m_logfile.get();
+      char *buf        = nullptr;
+      LogFile *logfile = fdata->m_logfile.get();
 
       if (logfile->m_file_format == LOG_FILE_BINARY) {
         logbuffer                      = static_cast<LogBuffer *>(fdata->m_data);
@@ -1362,6 +1480,15 @@ Log::flush_thread_main(void * /* args ATS_UNUSED */)
         buf         = static_cast<char *>(fdata->m_data);
         total_bytes = fdata->m_len;
 
+      } else if (logfile->m_file_format == LOG_FILE_COLUMNAR) {
+        if (n_columnar == columnar_blocks.size()) {
+          columnar_blocks.emplace_back();
+        }
+        std::string &block = columnar_blocks[n_columnar++];
+        logfile->m_columnar->pack({static_cast<char *>(fdata->m_data), static_cast<size_t>(fdata->m_len)}, block);
+        buf         = block.data();
+        total_bytes = block.size();
+
       } else {
         ink_release_assert(!"Unknown file format type!");
       }
@@ -1376,42 +1503,15 @@ Log::flush_thread_main(void * /* args ATS_UNUSED */)
         continue;
       }
 
-      int logfilefd = logfile->get_fd();
       // This should always be true because we just checked it.
-      ink_assert(logfilefd >= 0);
-
-      // write *all* data to target file as much as possible
-      //
-      while (total_bytes - bytes_written) {
-        if (Log::config->logging_space_exhausted) {
-          Debug("log", "logging space exhausted, failed to write file:%s, have dropped (%d) bytes.", logfile->get_name(),
-                (total_bytes - bytes_written));
-
-          RecIncrRawStat(log_rsb, mutex->thread_holding, log_stat_bytes_lost_before_written_to_disk_stat,
-                         total_bytes - bytes_written);
-          break;
-        }
-
-        len = ::write(logfilefd, &buf[bytes_written], total_bytes - bytes_written);
-
-        if (len < 0) {
-          Error("Failed to write log to %s: [tried %d, wrote %d, %s]", logfile->get_name(), total_bytes - bytes_written,
-                bytes_written, strerror(errno));
+      ink_assert(logfile->get_fd() >= 0);
 
-          RecIncrRawStat(log_rsb, mutex->thread_holding, log_stat_bytes_lost_before_written_to_disk_stat,
-                         total_bytes - bytes_written);
-          break;
-        }
-        Debug("log", "Successfully wrote some stuff to %s", logfile->get_name());
-        bytes_written += len;
-      }
-
-      RecIncrRawStat(log_rsb, mutex->thread_holding, log_stat_bytes_written_to_disk_stat, bytes_written);
-
-      if (logfile->m_log) {
-        ink_atomic_increment(&logfile->m_log->m_bytes_written, bytes_written);
-      }
+      writer.add(logfile, buf, total_bytes);
+      written.push(fdata);
+    }
 
+    writer.flush(mutex);
+    while ((fdata = written.pop())) {
       delete fdata;
     }
 
@@ -92,6 +92,7 @@ public:
       break;
     case LOG_FILE_ASCII:
     case LOG_FILE_PIPE:
+    case LOG_FILE_COLUMNAR:
       free(m_data);
       break;
     case N_LOGFILE_TYPES:
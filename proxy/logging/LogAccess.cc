@@ -1102,6 +1102,24 @@ resolve_logfield_string(LogAccess *context, const char *format_str)
     ats_free(fields_str);
     return nullptr;
   }
+
+  char *result = resolve_logfield_string(context, &fields, printf_str);
+
+  ats_free(printf_str);
+  ats_free(fields_str);
+
+  return result;
+}
+
+/*-------------------------------------------------------------------------
+  resolve_logfield_string
+
+  The same from a format string already divided by LogFormat, for strings
+  resolved over and over. The fields must not contain aggregates.
+  -------------------------------------------------------------------------*/
+char *
+resolve_logfield_string(LogAccess *context, LogFieldList *fields, char *printf_str)
+{
   //
   // Ok, now marshal the data out of the LogAccess object and into a
   // temporary storage buffer.  Make sure the LogAccess context is
@@ -1109,9 +1127,9 @@ resolve_logfield_string(LogAccess *context, const char *format_str)
   //
   Debug("log-resolve", "Marshaling data from LogAccess into buffer ...");
   context->init();
-  unsigned bytes_needed = fields.marshal_len(context);
+  unsigned bytes_needed = fields->marshal_len(context);
   char *buf             = static_cast<char *>(ats_malloc(bytes_needed));
-  unsigned bytes_used   = fields.marshal(context, buf);
+  unsigned bytes_used   = fields->marshal(context, buf);
 
   ink_assert(bytes_needed == bytes_used);
   Debug("log-resolve", "    %u bytes marshalled", bytes_used);
@@ -1124,7 +1142,7 @@ resolve_logfield_string(LogAccess *context, const char *format_str)
   //
   char *result = static_cast<char *>(ats_malloc(8192));
   unsigned bytes_resolved =
-    LogBuffer::resolve_custom_entry(&fields, printf_str, buf, result, 8191, LogUtils::timestamp(), 0, LOG_SEGMENT_VERSION);
+    LogBuffer::resolve_custom_entry(fields, printf_str, buf, result, 8191, LogUtils::timestamp(), 0, LOG_SEGMENT_VERSION);
   ink_assert(bytes_resolved < 8192);
 
   if (!bytes_resolved) {
@@ -1134,8 +1152,6 @@ resolve_logfield_string(LogAccess *context, const char *format_str)
     result[bytes_resolved] = 0; // NULL terminate
   }
 
-  ats_free(printf_str);
-  ats_free(fields_str);
   ats_free(buf);
 
   return result;
@@ -1881,6 +1897,53 @@ LogAccess::marshal_client_req_mptcp_state(char *buf)
   return INK_MIN_ALIGN;
 }
 
+/*-------------------------------------------------------------------------
+  -------------------------------------------------------------------------*/
+
+/*-------------------------------------------------------------------------
+  The TCP_INFO sampled at the end of the transaction, -1 when there is none.
+  -------------------------------------------------------------------------*/
+
+int
+LogAccess::marshal_client_tcp_rtt(char *buf)
+{
+  if (buf) {
+    const NetVCTcpInfo &info = m_http_sm->client_tcp_info;
+    marshal_int(buf, info.valid ? static_cast<int64_t>(info.rtt_us) : -1);
+  }
+  return INK_MIN_ALIGN;
+}
+
+int
+LogAccess::marshal_client_tcp_cwnd(char *buf)
+{
+  if (buf) {
+    const NetVCTcpInfo &info = m_http_sm->client_tcp_info;
+    marshal_int(buf, info.valid ? static_cast<int64_t>(info.cwnd) : -1);
+  }
+  return INK_MIN_ALIGN;
+}
+
+int
+LogAccess::marshal_client_tcp_retransmits(char *buf)
+{
+  if (buf) {
+    const NetVCTcpInfo &info = m_http_sm->client_tcp_info;
+    marshal_int(buf, info.valid ? static_cast<int64_t>(info.retransmits) : -1);
+  }
+  return INK_MIN_ALIGN;
+}
+
+int
+LogAccess::marshal_client_tcp_delivery_rate(char *buf)
+{
+  if (buf) {
+    const NetVCTcpInfo &info = m_http_sm->client_tcp_info;
+    marshal_int(buf, info.valid ? static_cast<int64_t>(info.delivery_rate) : -1);
+  }
+  return INK_MIN_ALIGN;
+}
+
 /*-------------------------------------------------------------------------
   -------------------------------------------------------------------------*/
 
@@ -2011,6 +2074,19 @@ LogAccess::marshal_client_security_curve(char *buf)
   return round_len;
 }
 
+int
+LogAccess::marshal_client_security_ja3(char *buf)
+{
+  const char *ja3 = m_http_sm->client_ja3_fingerprint;
+  int round_len   = LogAccess::strlen(ja3);
+
+  if (buf) {
+    marshal_str(buf, ja3, round_len);
+  }
+
+  return round_len;
+}
+
 /*-------------------------------------------------------------------------
   -------------------------------------------------------------------------*/
 
@@ -2461,6 +2537,49 @@ LogAccess::marshal_server_connect_attempts(char *buf)
   return INK_MIN_ALIGN;
 }
 
+/*-------------------------------------------------------------------------
+  -------------------------------------------------------------------------*/
+
+int
+LogAccess::marshal_server_tcp_rtt(char *buf)
+{
+  if (buf) {
+    const NetVCTcpInfo &info = m_http_sm->server_tcp_info;
+    marshal_int(buf, info.valid ? static_cast<int64_t>(info.rtt_us) : -1);
+  }
+  return INK_MIN_ALIGN;
+}
+
+int
+LogAccess::marshal_server_tcp_cwnd(char *buf)
+{
+  if (buf) {
+    const NetVCTcpInfo &info = m_http_sm->server_tcp_info;
+    marshal_int(buf, info.valid ? static_cast<int64_t>(info.cwnd) : -1);
+  }
+  return INK_MIN_ALIGN;
+}
+
+int
+LogAccess::marshal_server_tcp_retransmits(char *buf)
+{
+  if (buf) {
+    const NetVCTcpInfo &info = m_http_sm->server_tcp_info;
+    marshal_int(buf, info.valid ? static_cast<int64_t>(info.retransmits) : -1);
+  }
+  return INK_MIN_ALIGN;
+}
+
+int
+LogAccess::marshal_server_tcp_delivery_rate(char *buf)
+{
+  if (buf) {
+    const NetVCTcpInfo &info = m_http_sm->server_tcp_info;
+    marshal_int(buf, info.valid ? static_cast<int64_t>(info.delivery_rate) : -1);
+  }
+  return INK_MIN_ALIGN;
+}
+
 /*-------------------------------------------------------------------------
   -------------------------------------------------------------------------*/
 
@@ -2626,6 +2745,90 @@ LogAccess::marshal_transfer_time_s(char *buf)
   return INK_MIN_ALIGN;
 }
 
+/*-------------------------------------------------------------------------
+  The profile of a transaction, -1 or "-" for those that were not sampled.
+  -------------------------------------------------------------------------*/
+
+int
+LogAccess::marshal_profile_plugin_cpu(char *buf)
+{
+  if (buf) {
+    const HttpTxnProfile *profile = m_http_sm->profile;
+    marshal_int(buf, profile ? ink_hrtime_to_usec(profile->cpu) : -1);
+  }
+  return INK_MIN_ALIGN;
+}
+
+int
+LogAccess::marshal_profile_plugins(char *buf)
+{
+  char str[512] = "-";
+
+  if (m_http_sm->profile) {
+    m_http_sm->profile->print_plugins(str, sizeof(str));
+  }
+
+  int len = LogAccess::strlen(str);
+  if (buf) {
+    marshal_str(buf, str, len);
+  }
+  return len;
+}
+
+int
+LogAccess::marshal_profile_hooks(char *buf)
+{
+  char str[512] = "-";
+
+  if (m_http_sm->profile) {
+    m_http_sm->profile->print_hooks(str, sizeof(str));
+  }
+
+  int len = LogAccess::strlen(str);
+  if (buf) {
+    marshal_str(buf, str, len);
+  }
+  return len;
+}
+
+int
+LogAccess::marshal_profile_lock_retries(char *buf)
+{
+  if (buf) {
+    const HttpTxnProfile *profile = m_http_sm->profile;
+    marshal_int(buf, profile ? profile->lock_retries : -1);
+  }
+  return INK_MIN_ALIGN;
+}
+
+int
+LogAccess::marshal_profile_wait(int what, char *buf)
+{
+  if (buf) {
+    const HttpTxnProfile *profile = m_http_sm->profile;
+    marshal_int(buf, profile ? ink_hrtime_to_msec(profile->waits[what]) : -1);
+  }
+  return INK_MIN_ALIGN;
+}
+
+int
+LogAccess::marshal_profile_cache_wait(char *buf)
+{
+  return marshal_profile_wait(HTTP_TXN_WAIT_CACHE, buf);
+}
+
+int
+LogAccess::marshal_profile_dns_wait(char *buf)
+{
+  return marshal_profile_wait(HTTP_TXN_WAIT_DNS, buf);
+}
+
+int
+LogAccess::marshal_profile_origin_wait(char *buf)
+{
+  return marshal_profile_wait(HTTP_TXN_WAIT_ORIGIN, buf);
+}
+
 /*-------------------------------------------------------------------------
   Figure out the size of the object *on origin*. This is somewhat tricky
   since there are many variations on how this can be calculated.
@@ -151,9 +151,14 @@ public:
   inkcoreapi int marshal_client_req_ssl_reused(char *);         // INT
   inkcoreapi int marshal_client_req_is_internal(char *);        // INT
   inkcoreapi int marshal_client_req_mptcp_state(char *);        // INT
+  inkcoreapi int marshal_client_tcp_rtt(char *);                // INT
+  inkcoreapi int marshal_client_tcp_cwnd(char *);               // INT
+  inkcoreapi int marshal_client_tcp_retransmits(char *);        // INT
+  inkcoreapi int marshal_client_tcp_delivery_rate(char *);      // INT
   inkcoreapi int marshal_client_security_protocol(char *);      // STR
   inkcoreapi int marshal_client_security_cipher_suite(char *);  // STR
   inkcoreapi int marshal_client_security_curve(char *);         // STR
+  inkcoreapi int marshal_client_security_ja3(char *);           // STR
   inkcoreapi int marshal_client_finish_status_code(char *);     // INT
   inkcoreapi int marshal_client_req_id(char *);                 // INT
   inkcoreapi int marshal_client_req_uuid(char *);               // STR
@@ -207,6 +212,10 @@ public:
   inkcoreapi int marshal_server_resp_time_s(char *);            // INT
   inkcoreapi int marshal_server_transact_count(char *);         // INT
   inkcoreapi int marshal_server_connect_attempts(char *);       // INT
+  inkcoreapi int marshal_server_tcp_rtt(char *);                // INT
+  inkcoreapi int marshal_server_tcp_cwnd(char *);               // INT
+  inkcoreapi int marshal_server_tcp_retransmits(char *);        // INT
+  inkcoreapi int marshal_server_tcp_delivery_rate(char *);      // INT
   inkcoreapi int marshal_server_resp_all_header_fields(char *); // STR
 
   //
@@ -260,6 +269,13 @@ public:
   inkcoreapi int marshal_proxy_protocol_version(char *);                      // STR
   inkcoreapi int marshal_proxy_protocol_src_ip(char *);                       // STR
   inkcoreapi int marshal_proxy_protocol_dst_ip(char *);                       // STR
+  inkcoreapi int marshal_profile_plugin_cpu(char *);                          // INT
+  inkcoreapi int marshal_profile_plugins(char *);                             // STR
+  inkcoreapi int marshal_profile_hooks(char *);                               // STR
+  inkcoreapi int marshal_profile_lock_retries(char *);                        // INT
+  inkcoreapi int marshal_profile_cache_wait(char *);                          // INT
+  inkcoreapi int marshal_profile_dns_wait(char *);                            // INT
+  inkcoreapi int marshal_profile_origin_wait(char *);                         // INT
 
   // named fields from within a http header
   //
@@ -378,6 +394,8 @@ private:
   void validate_unmapped_url_path();
 
   void validate_lookup_url();
+
+  int marshal_profile_wait(int what, char *buf); // INT, what is an HttpTxnWait_t
 };
 
 inline int
@@ -418,3 +436,4 @@ LogAccess::marshal_int(char *dest, int64_t source)
   -------------------------------------------------------------------------*/
 
 char *resolve_logfield_string(LogAccess *context, const char *format_str);
+char *resolve_logfield_string(LogAccess *context, LogFieldList *fields, char *printf_str);
@@ -0,0 +1,341 @@
+/** @file
+
+  The columnar log file format.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "LogColumnar.h"
+#include "LogFormat.h"
+
+#include <cstring>
+#include <unordered_map>
+
+/*-------------------------------------------------------------------------
+  The uncompressed layout of a block is, with each number a varint and each
+  string a varint length followed by its bytes,
+
+    entry count, low timestamp, high timestamp, printf string, fieldlist,
+    column count, and for each column
+      COLUMN_PLAIN, then a string for each entry, or
+      COLUMN_DICTIONARY, the number of distinct values and each of them,
+        then the index of the value of each entry.
+  -------------------------------------------------------------------------*/
+
+namespace
+{
+enum ColumnCoding : uint8_t {
+  COLUMN_PLAIN      = 0,
+  COLUMN_DICTIONARY = 1,
+};
+
+// Blocks are made from a LogBuffer, this is far more than one can hold.
+constexpr uint32_t MAX_BLOCK_SIZE = 64 * 1024 * 1024;
+
+void
+put_varint(std::string &out, uint64_t v)
+{
+  while (v >= 0x80) {
+    out.push_back(static_cast<char>((v & 0x7f) | 0x80));
+    v >>= 7;
+  }
+  out.push_back(static_cast<char>(v));
+}
+
+void
+put_string(std::string &out, std::string_view s)
+{
+  put_varint(out, s.size());
+  out.append(s);
+}
+
+bool
+get_varint(std::string_view &in, uint64_t &v)
+{
+  v = 0;
+  for (unsigned shift = 0; shift < 64 && !in.empty(); shift += 7) {
+    uint8_t byte = static_cast<uint8_t>(in.front());
+    in.remove_prefix(1);
+    v |= static_cast<uint64_t>(byte & 0x7f) << shift;
+    if (!(byte & 0x80)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool
+get_string(std::string_view &in, std::string_view &s)
+{
+  uint64_t len;
+  if (!get_varint(in, len) || len > in.size()) {
+    return false;
+  }
+  s = in.substr(0, len);
+  in.remove_prefix(len);
+  return true;
+}
+} // namespace
+
+/*-------------------------------------------------------------------------
+  LogColumnarBlock
+  -------------------------------------------------------------------------*/
+
+void
+LogColumnarBlock::reset(std::string_view printf_str, std::string_view fieldlist, unsigned columns)
+{
+  _printf_str.assign(printf_str);
+  _fieldlist.assign(fieldlist);
+  _low_timestamp  = 0;
+  _high_timestamp = 0;
+  _entry_count    = 0;
+  _columns.clear();
+  _columns.resize(columns);
+}
+
+void
+LogColumnarBlock::add_entry(const std::string_view *values)
+{
+  for (auto &column : _columns) {
+    column.data.append(*values++);
+    column.ends.push_back(column.data.size());
+  }
+  ++_entry_count;
+}
+
+std::string_view
+LogColumnarBlock::value(size_t column, size_t entry) const
+{
+  Column const &c = _columns[column];
+  uint32_t start  = entry ? c.ends[entry - 1] : 0;
+  return std::string_view{c.data}.substr(start, c.ends[entry] - start);
+}
+
+void
+LogColumnarBlock::encode(std::string &raw) const
+{
+  put_varint(raw, _entry_count);
+  put_varint(raw, _low_timestamp);
+  put_varint(raw, _high_timestamp);
+  put_string(raw, _printf_str);
+  put_string(raw, _fieldlist);
+  put_varint(raw, _columns.size());
+
+  std::unordered_map<std::string_view, uint32_t> dictionary;
+  std::vector<std::string_view> distinct;
+  std::vector<uint32_t> indices;
+
+  for (size_t c = 0; c < _columns.size(); ++c) {
+    dictionary.clear();
+    distinct.clear();
+    indices.clear();
+
+    for (size_t e = 0; e < _entry_count; ++e) {
+      auto [spot, added] = dictionary.emplace(value(c, e), distinct.size());
+      if (added) {
+        distinct.push_back(spot->first);
+      }
+      indices.push_back(spot->second);
+    }
+
+    // An index is a byte or two, so it only pays if the values repeat.
+    if (distinct.size() * 2 <= _entry_count) {
+      raw.push_back(COLUMN_DICTIONARY);
+      put_varint(raw, distinct.size());
+      for (auto s : distinct) {
+        put_string(raw, s);
+      }
+      for (auto i : indices) {
+        put_varint(raw, i);
+      }
+    } else {
+      raw.push_back(COLUMN_PLAIN);
+      for (size_t e = 0; e < _entry_count; ++e) {
+        put_string(raw, value(c, e));
+      }
+    }
+  }
+}
+
+bool
+LogColumnarBlock::decode(std::string_view raw)
+{
+  uint64_t entries, low, high, columns;
+  std::string_view printf_str, fieldlist;
+
+  if (!get_varint(raw, entries) || !get_varint(raw, low) || !get_varint(raw, high) || !get_string(raw, printf_str) ||
+      !get_string(raw, fieldlist) || !get_varint(raw, columns)) {
+    return false;
+  }
+  // Each value takes at least a byte, which bounds the counts by the size of the block.
+  if (columns > raw.size() || (columns && entries > raw.size())) {
+    return false;
+  }
+
+  reset(printf_str, fieldlist, columns);
+  set_timestamps(low, high);
+
+  std::vector<std::string_view> distinct;
+  for (auto &column : _columns) {
+    if (raw.empty()) {
+      return false;
+    }
+    uint8_t coding = static_cast<uint8_t>(raw.front());
+    raw.remove_prefix(1);
+
+    std::string_view s;
+    if (coding == COLUMN_PLAIN) {
+      for (uint64_t e = 0; e < entries; ++e) {
+        if (!get_string(raw, s)) {
+          return false;
+        }
+        column.data.append(s);
+        column.ends.push_back(column.data.size());
+      }
+    } else if (coding == COLUMN_DICTIONARY) {
+      uint64_t n, i;
+      if (!get_varint(raw, n) || n > raw.size()) {
+        return false;
+      }
+      distinct.clear();
+      for (uint64_t d = 0; d < n; ++d) {
+        if (!get_string(raw, s)) {
+          return false;
+        }
+        distinct.push_back(s);
+      }
+      for (uint64_t e = 0; e < entries; ++e) {
+        if (!get_varint(raw, i) || i >= distinct.size()) {
+          return false;
+        }
+        column.data.append(distinct[i]);
+        column.ends.push_back(column.data.size());
+      }
+    } else {
+      return false;
+    }
+  }
+  _entry_count = _columns.empty() ? 0 : entries;
+
+  return raw.empty();
+}
+
+void
+LogColumnarBlock::to_ascii(std::string &text) const
+{
+  for (size_t e = 0; e < _entry_count; ++e) {
+    size_t c = 0;
+    for (char ch : _printf_str) {
+      if (ch != LOG_FIELD_MARKER) {
+        text.push_back(ch);
+      } else if (c < _columns.size()) {
+        text.append(value(c++, e));
+      }
+    }
+    text.push_back('\n');
+  }
+}
+
+/*-------------------------------------------------------------------------
+  LogColumnarWriter
+  -------------------------------------------------------------------------*/
+
+LogColumnarWriter::LogColumnarWriter(int level) : _level(level)
+{
+#ifdef HAVE_ZSTD_H
+  if (_level > 0) {
+    _cctx = ZSTD_createCCtx();
+  }
+#endif
+}
+
+LogColumnarWriter::~LogColumnarWriter()
+{
+#ifdef HAVE_ZSTD_H
+  ZSTD_freeCCtx(_cctx);
+#endif
+}
+
+void
+LogColumnarWriter::pack(std::string_view raw, std::string &block)
+{
+  LogColumnarHeader header{LOG_COLUMNAR_COOKIE, LOG_COLUMNAR_VERSION, LogColumnarHeader::COMPRESSION_NONE,
+                           static_cast<uint32_t>(raw.size()), static_cast<uint32_t>(raw.size())};
+
+  block.clear();
+#ifdef HAVE_ZSTD_H
+  if (_cctx) {
+    block.resize(sizeof(header) + ZSTD_compressBound(raw.size()));
+    size_t stored =
+      ZSTD_compressCCtx(_cctx, &block[sizeof(header)], block.size() - sizeof(header), raw.data(), raw.size(), _level);
+    if (!ZSTD_isError(stored) && stored < raw.size()) {
+      header.compression = LogColumnarHeader::COMPRESSION_ZSTD;
+      header.stored_size = stored;
+      block.resize(sizeof(header) + stored);
+      memcpy(&block[0], &header, sizeof(header));
+      return;
+    }
+    // The block did not get any smaller, it is stored as it is.
+    block.clear();
+  }
+#endif
+  block.append(reinterpret_cast<const char *>(&header), sizeof(header));
+  block.append(raw);
+}
+
+/*-------------------------------------------------------------------------
+  LogColumnarReader
+  -------------------------------------------------------------------------*/
+
+LogColumnarReader::~LogColumnarReader()
+{
+#ifdef HAVE_ZSTD_H
+  ZSTD_freeDCtx(_dctx);
+#endif
+}
+
+bool
+LogColumnarReader::unpack(const LogColumnarHeader &header, std::string_view stored, std::string &raw)
+{
+  if (header.cookie != LOG_COLUMNAR_COOKIE || header.version != LOG_COLUMNAR_VERSION || header.stored_size != stored.size() ||
+      header.raw_size > MAX_BLOCK_SIZE) {
+    return false;
+  }
+
+  switch (header.compression) {
+  case LogColumnarHeader::COMPRESSION_NONE:
+    if (header.raw_size != stored.size()) {
+      return false;
+    }
+    raw.assign(stored);
+    return true;
+#ifdef HAVE_ZSTD_H
+  case LogColumnarHeader::COMPRESSION_ZSTD: {
+    if (!_dctx) {
+      _dctx = ZSTD_createDCtx();
+    }
+    raw.resize(header.raw_size);
+    size_t n = ZSTD_decompressDCtx(_dctx, &raw[0], raw.size(), stored.data(), stored.size());
+    return !ZSTD_isError(n) && n == header.raw_size;
+  }
+#endif
+  default:
+    return false;
+  }
+}
@@ -0,0 +1,160 @@
+/** @file
+
+  The columnar log file format.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  @section details Details
+
+  A columnar log file is a sequence of blocks, one for each LogBuffer. A block stores the text of
+  each field of its entries together, field by field, and a field that has few distinct values
+  (a method, a status, a host) stores each of them once and then an index per entry. A block is
+  then compressed with zstd, if the server was built with it, in the flush thread. The fields
+  of an entry are adjacent to those of the entry before it, so they compress far better than
+  the lines of an ASCII log would.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "tscore/ink_config.h"
+
+#ifdef HAVE_ZSTD_H
+#include <zstd.h>
+#endif
+
+#define LOG_COLUMNAR_COOKIE 0xc0ffface
+#define LOG_COLUMNAR_VERSION 1
+
+/// What a block starts with in the file. The cookie and version are where they are in a LogBufferHeader.
+struct LogColumnarHeader {
+  enum Compression : uint32_t {
+    COMPRESSION_NONE = 0,
+    COMPRESSION_ZSTD = 1,
+  };
+
+  uint32_t cookie;
+  uint32_t version;
+  uint32_t compression;
+  uint32_t raw_size;    ///< Size of the block before compression.
+  uint32_t stored_size; ///< Size of the block that follows the header in the file.
+};
+
+/// The entries of a LogBuffer, column by column.
+class LogColumnarBlock
+{
+public:
+  /// Start over with no entries, for entries of @a columns fields put in place of the markers of @a printf_str.
+  void reset(std::string_view printf_str, std::string_view fieldlist, unsigned columns);
+
+  /// Add an entry, with a value for each column.
+  void add_entry(const std::string_view *values);
+
+  void
+  set_timestamps(uint32_t low, uint32_t high)
+  {
+    _low_timestamp  = low;
+    _high_timestamp = high;
+  }
+
+  size_t
+  entry_count() const
+  {
+    return _entry_count;
+  }
+
+  size_t
+  column_count() const
+  {
+    return _columns.size();
+  }
+
+  std::string_view value(size_t column, size_t entry) const;
+
+  /// Append the uncompressed layout of the block to @a raw.
+  void encode(std::string &raw) const;
+
+  /// Set the block from its uncompressed layout, @c false if @a raw is not a valid one.
+  bool decode(std::string_view raw);
+
+  /// Append the entries to @a text as lines, as they would be in an ASCII log.
+  void to_ascii(std::string &text) const;
+
+private:
+  struct Column {
+    std::string data;           ///< The values, one after another.
+    std::vector<uint32_t> ends; ///< Where each value ends in @a data.
+  };
+
+  std::string _printf_str;
+  std::string _fieldlist;
+  uint32_t _low_timestamp  = 0;
+  uint32_t _high_timestamp = 0;
+  size_t _entry_count      = 0;
+  std::vector<Column> _columns;
+};
+
+/// Compresses blocks for a columnar log file. It keeps its zstd context, so it must be used by one thread at a time.
+class LogColumnarWriter
+{
+public:
+  /// Compress at @a level, which is a zstd level, or not at all if it is 0.
+  explicit LogColumnarWriter(int level);
+  ~LogColumnarWriter();
+
+  /// Set @a block to what is written to the file for the uncompressed block @a raw.
+  void pack(std::string_view raw, std::string &block);
+
+  // noncopyable
+  LogColumnarWriter(const LogColumnarWriter &) = delete;
+  LogColumnarWriter &operator=(const LogColumnarWriter &) = delete;
+
+private:
+  int _level;
+#ifdef HAVE_ZSTD_H
+  ZSTD_CCtx *_cctx = nullptr;
+#endif
+};
+
+/// Reads back the blocks of a columnar log file.
+class LogColumnarReader
+{
+public:
+  LogColumnarReader() = default;
+  ~LogColumnarReader();
+
+  /** Set @a raw to the uncompressed block described by @a header, stored in @a stored.
+
+      @return @c false if the block can not be read, because it is corrupt or its compression is not supported.
+   */
+  bool unpack(const LogColumnarHeader &header, std::string_view stored, std::string &raw);
+
+  // noncopyable
+  LogColumnarReader(const LogColumnarReader &) = delete;
+  LogColumnarReader &operator=(const LogColumnarReader &) = delete;
+
+private:
+#ifdef HAVE_ZSTD_H
+  ZSTD_DCtx *_dctx = nullptr;
+#endif
+};
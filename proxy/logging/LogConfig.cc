@@ -28,6 +28,7 @@
 #include <sys/param.h>
 #endif
 
+#include <algorithm>
 #include <memory>
 
 #include "tscore/ink_platform.h"
@@ -74,12 +75,17 @@ LogConfig::setup_default_values()
   }
   hostname = ats_strdup(name);
 
-  log_buffer_size       = static_cast<int>(10 * LOG_KILOBYTE);
-  max_secs_per_buffer   = 5;
-  max_space_mb_for_logs = 100;
-  max_space_mb_headroom = 10;
-  logfile_perm          = 0644;
-  logfile_dir           = ats_strdup(".");
+  log_buffer_size            = static_cast<int>(10 * LOG_KILOBYTE);
+  max_secs_per_buffer        = 5;
+  log_buffer_shards          = 1;
+  log_buffer_merge_by_time   = false;
+  columnar_compression_level = 3;
+  collector_queue_size       = static_cast<int>(16 * LOG_MEGABYTE);
+  collector_timeout          = 10;
+  max_space_mb_for_logs      = 100;
+  max_space_mb_headroom      = 10;
+  logfile_perm               = 0644;
+  logfile_dir                = ats_strdup(".");
 
   preproc_threads = 1;
 
@@ -136,6 +142,29 @@ LogConfig::read_configuration_variables()
     max_secs_per_buffer = val;
   }
 
+  val = static_cast<int>(REC_ConfigReadInteger("proxy.config.log.log_buffer_shards"));
+  if (val > 0) {
+    log_buffer_shards = std::min(val, LogObject::MAX_BUFFER_SHARDS);
+  }
+
+  val                      = static_cast<int>(REC_ConfigReadInteger("proxy.config.log.log_buffer_merge_by_time"));
+  log_buffer_merge_by_time = (val > 0);
+
+  val = static_cast<int>(REC_ConfigReadInteger("proxy.config.log.columnar_compression_level"));
+  if (val >= 0) {
+    columnar_compression_level = val;
+  }
+
+  val = static_cast<int>(REC_ConfigReadInteger("proxy.config.log.collector_queue_size"));
+  if (val > 0) {
+    collector_queue_size = val;
+  }
+
+  val = static_cast<int>(REC_ConfigReadInteger("proxy.config.log.collector_timeout"));
+  if (val > 0) {
+    collector_timeout = val;
+  }
+
   val = static_cast<int>(REC_ConfigReadInteger("proxy.config.log.max_space_mb_for_logs"));
   if (val > 0) {
     max_space_mb_for_logs = val;
@@ -347,6 +376,11 @@ LogConfig::display(FILE *fd)
   fprintf(fd, "Config variables:\n");
   fprintf(fd, "   log_buffer_size = %d\n", log_buffer_size);
   fprintf(fd, "   max_secs_per_buffer = %d\n", max_secs_per_buffer);
+  fprintf(fd, "   log_buffer_shards = %d\n", log_buffer_shards);
+  fprintf(fd, "   log_buffer_merge_by_time = %d\n", log_buffer_merge_by_time);
+  fprintf(fd, "   columnar_compression_level = %d\n", columnar_compression_level);
+  fprintf(fd, "   collector_queue_size = %d\n", collector_queue_size);
+  fprintf(fd, "   collector_timeout = %d\n", collector_timeout);
   fprintf(fd, "   max_space_mb_for_logs = %d\n", max_space_mb_for_logs);
   fprintf(fd, "   max_space_mb_headroom = %d\n", max_space_mb_headroom);
   fprintf(fd, "   hostname = %s\n", hostname);
@@ -441,7 +475,8 @@ LogConfig::register_config_callbacks()
     "proxy.config.log.rolling_offset_hr",     "proxy.config.log.rolling_size_mb",     "proxy.config.log.auto_delete_rolled_files",
     "proxy.config.log.rolling_max_count",     "proxy.config.log.rolling_allow_empty", "proxy.config.log.config.filename",
     "proxy.config.log.sampling_frequency",    "proxy.config.log.file_stat_frequency", "proxy.config.log.space_used_frequency",
-    "proxy.config.log.io.max_buffer_index",
+    "proxy.config.log.io.max_buffer_index",   "proxy.config.log.log_buffer_shards",   "proxy.config.log.log_buffer_merge_by_time",
+    "proxy.config.log.columnar_compression_level", "proxy.config.log.collector_queue_size", "proxy.config.log.collector_timeout",
   };
 
   for (unsigned i = 0; i < countof(names); ++i) {
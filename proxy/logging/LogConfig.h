@@ -184,6 +184,11 @@ public:
 
   int log_buffer_size;
   int max_secs_per_buffer;
+  int log_buffer_shards;
+  bool log_buffer_merge_by_time;
+  int columnar_compression_level;
+  int collector_queue_size;
+  int collector_timeout;
   int max_space_mb_for_logs;
   int max_space_mb_headroom;
   int logfile_perm;
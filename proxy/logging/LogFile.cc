@@ -78,6 +78,10 @@ LogFile::LogFile(const char *name, const char *header, LogFileFormat format, uin
     m_log = nullptr;
   }
 
+  if (m_file_format == LOG_FILE_COLUMNAR) {
+    m_columnar = new LogColumnarWriter(Log::config ? Log::config->columnar_compression_level : 0);
+  }
+
   m_fd                = -1;
   m_ascii_buffer_size = (ascii_buffer_size < max_line_size ? max_line_size : ascii_buffer_size);
 
@@ -109,6 +113,10 @@ LogFile::LogFile(const LogFile &copy)
     m_log = nullptr;
   }
 
+  if (m_file_format == LOG_FILE_COLUMNAR) {
+    m_columnar = new LogColumnarWriter(Log::config ? Log::config->columnar_compression_level : 0);
+  }
+
   Debug("log-file", "exiting LogFile copy constructor, m_name=%s, this=%p", m_name, this);
 }
 /*-------------------------------------------------------------------------
@@ -125,6 +133,7 @@ LogFile::~LogFile()
   close_file();
 
   delete m_log;
+  delete m_columnar;
   ats_free(m_header);
   ats_free(m_name);
   Debug("log-file", "exiting LogFile destructor, this=%p", this);
@@ -235,7 +244,7 @@ LogFile::open_file()
   // file.
   //
   if (!file_exists) {
-    if (m_file_format != LOG_FILE_BINARY && m_header && m_log) {
+    if (m_file_format != LOG_FILE_BINARY && m_file_format != LOG_FILE_COLUMNAR && m_header && m_log) {
       Debug("log-file", "writing header to LogFile %s", m_name);
       writeln(m_header, strlen(m_header), fileno(m_log->m_fp), m_name);
     }
@@ -460,6 +469,9 @@ LogFile::preproc_and_try_delete(LogBuffer *lb)
   } else if (m_file_format == LOG_FILE_ASCII || m_file_format == LOG_FILE_PIPE) {
     write_ascii_logbuffer3(buffer_header);
     ret = 0;
+  } else if (m_file_format == LOG_FILE_COLUMNAR) {
+    write_columnar_logbuffer(buffer_header);
+    ret = 0;
   } else {
     Note("Cannot write LogBuffer to LogFile %s; invalid file format: %d", m_name, m_file_format);
   }
@@ -641,6 +653,109 @@ LogFile::write_ascii_logbuffer3(LogBufferHeader *buffer_header, const char *alt_
   return total_bytes;
 }
 
+/*-------------------------------------------------------------------------
+  LogFile::write_columnar_logbuffer
+
+  This routine takes the given LogBuffer and sends the text of the fields of
+  its entries, column by column, to the flush thread, which compresses and
+  writes them. The return value is the number of bytes sent.
+  -------------------------------------------------------------------------*/
+
+int
+LogFile::write_columnar_logbuffer(LogBufferHeader *buffer_header)
+{
+  ink_assert(buffer_header != nullptr);
+
+  if (buffer_header->version != LOG_SEGMENT_VERSION) {
+    Note("Invalid LogBuffer version %d in write_columnar_logbuffer; "
+         "current version is %d",
+         buffer_header->version, LOG_SEGMENT_VERSION);
+    return 0;
+  }
+
+  static const char text_printf_str[] = {LOG_FIELD_MARKER, '\0'};
+
+  ProxyMutex *mutex = this_thread()->mutex.get();
+  LogBufferIterator iter(buffer_header);
+  LogEntryHeader *entry_header;
+  LogFieldList fieldlist;
+  LogColumnarBlock block;
+  char fmt_line[LOG_MAX_FORMATTED_LINE];
+  int dropped_count = 0;
+  int dropped_bytes = 0;
+
+  bool is_text = static_cast<LogFormatType>(buffer_header->format_type) == LOG_FORMAT_TEXT;
+  if (is_text) {
+    block.reset(text_printf_str, "", 1);
+  } else {
+    bool contains_aggregates = false;
+    LogFormat::parse_symbol_string(buffer_header->fmt_fieldlist(), &fieldlist, &contains_aggregates);
+    block.reset(buffer_header->fmt_printf(), buffer_header->fmt_fieldlist(), fieldlist.count());
+  }
+  block.set_timestamps(buffer_header->low_timestamp, buffer_header->high_timestamp);
+
+  std::vector<std::string_view> values(block.column_count());
+
+  while ((entry_header = iter.next())) {
+    char *read_from = reinterpret_cast<char *>(entry_header) + sizeof(LogEntryHeader);
+
+    if (is_text) {
+      values[0] = {read_from, strnlen(read_from, entry_header->entry_len - sizeof(LogEntryHeader))};
+      block.add_entry(values.data());
+      continue;
+    }
+
+    int bytes = 0;
+    int i     = 0;
+    for (LogField *field = fieldlist.first(); field; field = fieldlist.next(field), ++i) {
+      int res = static_cast<int>(field->unmarshal(&read_from, &fmt_line[bytes], sizeof(fmt_line) - bytes));
+      if (res < 0 || bytes + res > static_cast<int>(sizeof(fmt_line))) {
+        bytes = -1;
+        break;
+      }
+      values[i] = {&fmt_line[bytes], static_cast<size_t>(res)};
+      bytes += res;
+    }
+
+    if (bytes < 0) {
+      ++dropped_count;
+      dropped_bytes += entry_header->entry_len;
+    } else {
+      block.add_entry(values.data());
+    }
+  }
+
+  if (dropped_count) {
+    Note("Failed to convert %d entries of a LogBuffer to columns, have dropped (%d) bytes.", dropped_count, dropped_bytes);
+
+    RecIncrRawStat(log_rsb, mutex->thread_holding, log_stat_num_lost_before_flush_to_disk_stat, dropped_count);
+
+    RecIncrRawStat(log_rsb, mutex->thread_holding, log_stat_bytes_lost_before_flush_to_disk_stat, dropped_bytes);
+  }
+  if (block.entry_count() == 0) {
+    return 0;
+  }
+
+  std::string raw;
+  block.encode(raw);
+  char *data = static_cast<char *>(ats_malloc(raw.size()));
+  memcpy(data, raw.data(), raw.size());
+
+  // send the block to flush thread, which compresses it
+  //
+  LogFlushData *flush_data = new LogFlushData(this, data, raw.size());
+
+  RecIncrRawStat(log_rsb, mutex->thread_holding, log_stat_num_flush_to_disk_stat, block.entry_count());
+
+  RecIncrRawStat(log_rsb, mutex->thread_holding, log_stat_bytes_flush_to_disk_stat, raw.size());
+
+  ink_atomiclist_push(Log::flush_data_list, flush_data);
+
+  Log::flush_notify->signal();
+
+  return raw.size();
+}
+
 bool
 LogFile::rolled_logfile(char *file)
 {
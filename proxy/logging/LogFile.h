@@ -28,6 +28,7 @@
 
 #include "tscore/ink_platform.h"
 #include "LogBufferSink.h"
+#include "LogColumnar.h"
 
 class LogBuffer;
 struct LogBufferHeader;
@@ -79,11 +80,14 @@ public:
   const char *
   get_format_name() const
   {
-    return (m_file_format == LOG_FILE_BINARY ? "binary" : (m_file_format == LOG_FILE_PIPE ? "ascii_pipe" : "ascii"));
+    return (m_file_format == LOG_FILE_BINARY ?
+              "binary" :
+              (m_file_format == LOG_FILE_PIPE ? "ascii_pipe" : (m_file_format == LOG_FILE_COLUMNAR ? "columnar" : "ascii")));
   }
 
   static int write_ascii_logbuffer(LogBufferHeader *buffer_header, int fd, const char *path, const char *alt_format = nullptr);
   int write_ascii_logbuffer3(LogBufferHeader *buffer_header, const char *alt_format = nullptr);
+  int write_columnar_logbuffer(LogBufferHeader *buffer_header);
   static bool rolled_logfile(char *file);
   static bool exists(const char *pathname);
 
@@ -123,6 +127,8 @@ public:
   int m_pipe_buffer_size;     // this is the size of the pipe buffer set by fcntl
   int m_fd;                   // this could back m_log or a pipe, depending on the situation
 
+  LogColumnarWriter *m_columnar = nullptr; // compresses the blocks of a columnar file, in the flush thread
+
 public:
   Link<LogFile> link;
   // noncopyable
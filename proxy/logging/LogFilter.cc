@@ -38,6 +38,9 @@
 #include "LogConfig.h"
 #include "Log.h"
 #include "tscore/SimpleTokenizer.h"
+#include "tscore/HashFNV.h"
+
+#include <algorithm>
 
 const char *LogFilter::OPERATOR_NAME[] = {"MATCH", "CASE_INSENSITIVE_MATCH", "CONTAIN", "CASE_INSENSITIVE_CONTAIN"};
 const char *LogFilter::ACTION_NAME[]   = {"REJECT", "ACCEPT", "WIPE_FIELD_VALUE"};
@@ -52,8 +55,10 @@ const char *LogFilter::ACTION_NAME[]   = {"REJECT", "ACCEPT", "WIPE_FIELD_VALUE"
 LogFilter::LogFilter(const char *name, LogField *field, LogFilter::Action action, LogFilter::Operator oper)
   : m_name(ats_strdup(name)), m_field(nullptr), m_action(action), m_operator(oper), m_type(INT_FILTER), m_num_values(0)
 {
-  m_field = new LogField(*field);
-  ink_assert(m_field);
+  // A rate filter is not about any field.
+  if (field) {
+    m_field = new LogField(*field);
+  }
 }
 
 /*-------------------------------------------------------------------------
@@ -73,14 +78,36 @@ LogFilter::parse(const char *name, Action action, const char *condition)
 
   ink_release_assert(action != N_ACTIONS);
 
-  if (tok.getNumTokensRemaining() < 3) {
+  if (tok.getNumTokensRemaining() < 2) {
     Error("Invalid condition syntax '%s'; cannot create filter '%s'", condition, name);
     return nullptr;
   }
 
   char *field_str = tok.getNext();
-  char *oper_str  = tok.getNext();
-  char *val_str   = tok.getRest();
+
+  // "RATE <entries>" is the only condition without a field.
+  if (strcasecmp(field_str, "RATE") == 0) {
+    char *rate_str = tok.getRest();
+    if (action == WIPE_FIELD_VALUE) {
+      Error("A rate filter can only accept or reject entries; cannot create filter '%s'", name);
+      return nullptr;
+    }
+    LogFilter *filter = new LogFilterRate(name, action, rate_str);
+    if (filter->get_num_values() == 0) {
+      Error("'%s' is not a valid rate; cannot create filter '%s'", rate_str, name);
+      delete filter;
+      return nullptr;
+    }
+    return filter;
+  }
+
+  if (tok.getNumTokensRemaining() < 2) {
+    Error("Invalid condition syntax '%s'; cannot create filter '%s'", condition, name);
+    return nullptr;
+  }
+
+  char *oper_str = tok.getNext();
+  char *val_str  = tok.getRest();
 
   // validate field symbol
   if (strlen(field_str) > 2 && field_str[0] == '%' && field_str[1] == '<') {
@@ -137,6 +164,25 @@ LogFilter::parse(const char *name, Action action, const char *condition)
     return nullptr;
   }
 
+  // a sample is of any type of field
+  if (strcasecmp(oper_str, "SAMPLE") == 0) {
+    if (action == WIPE_FIELD_VALUE) {
+      Error("A sample filter can only accept or reject entries; cannot create filter '%s'", name);
+      return nullptr;
+    }
+    if (logfield->type() == LogField::dINT) {
+      Error("Invalid field type (double int); cannot create filter '%s'", name);
+      return nullptr;
+    }
+    LogFilter *filter = new LogFilterSample(name, logfield, action, val_str);
+    if (filter->get_num_values() == 0) {
+      Error("'%s' is not a valid percentage; cannot create filter '%s'", val_str, name);
+      delete filter;
+      return nullptr;
+    }
+    return filter;
+  }
+
   // convert the operator string to an enum value and validate it
   LogFilter::Operator oper = LogFilter::N_OPERATORS;
   for (unsigned i = 0; i < LogFilter::N_OPERATORS; ++i) {
@@ -901,6 +947,212 @@ LogFilterIP::display(FILE *fd)
   }
 }
 
+/*-------------------------------------------------------------------------
+  LogFilterSample::LogFilterSample
+  -------------------------------------------------------------------------*/
+
+LogFilterSample::LogFilterSample(const char *name, LogField *field, LogFilter::Action action, const char *percent)
+  : LogFilter(name, field, action, MATCH)
+{
+  m_type = SAMPLE_FILTER;
+
+  // the percentage may be given with or without a '%', as "10%", "10" or "0.5%"
+  char *end;
+  double value = strtod(percent, &end);
+  if (*end == '%') {
+    ++end;
+  }
+  if (end != percent && *end == '\0' && value > 0 && value <= 100) {
+    m_threshold  = std::max<uint32_t>(1, value * (SAMPLE_SCALE / 100));
+    m_num_values = 1;
+  }
+}
+
+LogFilterSample::LogFilterSample(const LogFilterSample &rhs)
+  : LogFilter(rhs.m_name, rhs.m_field, rhs.m_action, rhs.m_operator), m_threshold(rhs.m_threshold)
+{
+  m_type       = SAMPLE_FILTER;
+  m_num_values = rhs.m_num_values;
+}
+
+bool
+LogFilterSample::operator==(LogFilterSample &rhs)
+{
+  return m_type == rhs.m_type && m_action == rhs.m_action && m_threshold == rhs.m_threshold &&
+         strcmp(m_field->symbol(), rhs.m_field->symbol()) == 0;
+}
+
+uint64_t
+LogFilterSample::_hash_field(LogAccess *lad)
+{
+  ATSHash64FNV1a hash;
+
+  switch (m_field->type()) {
+  case LogField::IP: {
+    LogFieldIpStorage value;
+    m_field->marshal(lad, reinterpret_cast<char *>(&value));
+    if (value._ip._family == AF_INET) {
+      hash.update(&value._ip4._addr, sizeof(value._ip4._addr));
+    } else if (value._ip._family == AF_INET6) {
+      hash.update(&value._ip6._addr, sizeof(value._ip6._addr));
+    }
+    break;
+  }
+  case LogField::STRING: {
+    static const unsigned BUFSIZE = 1024;
+    char small_buf[BUFSIZE];
+    char *buf        = small_buf;
+    size_t marsh_len = m_field->marshal_len(lad);
+
+    if (marsh_len > BUFSIZE) {
+      buf = static_cast<char *>(ats_malloc(marsh_len));
+    }
+    m_field->marshal(lad, buf);
+    hash.update(buf, strnlen(buf, marsh_len));
+    if (buf != small_buf) {
+      ats_free(buf);
+    }
+    break;
+  }
+  default: {
+    int64_t value;
+    m_field->marshal(lad, reinterpret_cast<char *>(&value));
+    hash.update(&value, sizeof(value));
+    break;
+  }
+  }
+
+  hash.final();
+  return hash.get();
+}
+
+/*-------------------------------------------------------------------------
+  LogFilterSample::toss_this_entry
+  -------------------------------------------------------------------------*/
+
+bool
+LogFilterSample::toss_this_entry(LogAccess *lad)
+{
+  if (m_num_values == 0 || m_field == nullptr || lad == nullptr) {
+    return false;
+  }
+
+  bool cond_satisfied = in_sample(_hash_field(lad));
+  return (m_action == REJECT && cond_satisfied) || (m_action == ACCEPT && !cond_satisfied);
+}
+
+bool
+LogFilterSample::wipe_this_entry(LogAccess *)
+{
+  return false;
+}
+
+void
+LogFilterSample::display(FILE *fd)
+{
+  ink_assert(fd != nullptr);
+  fprintf(fd, "Filter \"%s\" %sS %g%% of records by %s\n", m_name, ACTION_NAME[m_action], m_threshold * 100.0 / SAMPLE_SCALE,
+          m_field->symbol());
+}
+
+/*-------------------------------------------------------------------------
+  LogFilterRate::LogFilterRate
+  -------------------------------------------------------------------------*/
+
+LogFilterRate::LogFilterRate(const char *name, LogFilter::Action action, const char *rate) : LogFilter(name, nullptr, action, MATCH)
+{
+  char *end;
+  long long value = strtoll(rate, &end, 10);
+  if (end != rate && *end == '\0' && value > 0) {
+    m_rate = value;
+  }
+  _init();
+}
+
+LogFilterRate::LogFilterRate(const LogFilterRate &rhs)
+  : LogFilter(rhs.m_name, nullptr, rhs.m_action, rhs.m_operator), m_rate(rhs.m_rate)
+{
+  _init();
+}
+
+void
+LogFilterRate::_init()
+{
+  m_type = RATE_FILTER;
+  if (m_rate > 0) {
+    m_num_values    = 1;
+    m_refill_period = std::max<ink_hrtime>(1, HRTIME_SECOND / m_rate);
+    m_tokens        = m_rate;
+    m_last_refill   = ink_get_hrtime_internal();
+  }
+}
+
+bool
+LogFilterRate::operator==(LogFilterRate &rhs)
+{
+  return m_type == rhs.m_type && m_action == rhs.m_action && m_rate == rhs.m_rate;
+}
+
+/*-------------------------------------------------------------------------
+  LogFilterRate::_take_token
+
+  Entries are logged from every thread, so the bucket is kept without a
+  lock. The thread that moves the time of the last refill forward is the one
+  that adds the tokens for it, the others only take tokens.
+  -------------------------------------------------------------------------*/
+
+bool
+LogFilterRate::_take_token()
+{
+  ink_hrtime now  = ink_get_hrtime_internal();
+  ink_hrtime last = m_last_refill.load(std::memory_order_relaxed);
+
+  if (now - last >= m_refill_period) {
+    int64_t gained = (now - last) / m_refill_period;
+    if (m_last_refill.compare_exchange_strong(last, last + gained * m_refill_period)) {
+      int64_t tokens = m_tokens.load(std::memory_order_relaxed);
+      while (!m_tokens.compare_exchange_weak(tokens, std::min(tokens + gained, m_rate))) {
+      }
+    }
+  }
+
+  int64_t tokens = m_tokens.load(std::memory_order_relaxed);
+  while (tokens > 0) {
+    if (m_tokens.compare_exchange_weak(tokens, tokens - 1)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/*-------------------------------------------------------------------------
+  LogFilterRate::toss_this_entry
+  -------------------------------------------------------------------------*/
+
+bool
+LogFilterRate::toss_this_entry(LogAccess *)
+{
+  if (m_num_values == 0) {
+    return false;
+  }
+
+  bool cond_satisfied = _take_token();
+  return (m_action == REJECT && cond_satisfied) || (m_action == ACCEPT && !cond_satisfied);
+}
+
+bool
+LogFilterRate::wipe_this_entry(LogAccess *)
+{
+  return false;
+}
+
+void
+LogFilterRate::display(FILE *fd)
+{
+  ink_assert(fd != nullptr);
+  fprintf(fd, "Filter \"%s\" %sS up to %" PRId64 " records a second\n", m_name, ACTION_NAME[m_action], m_rate);
+}
+
 bool
 filters_are_equal(LogFilter *filt1, LogFilter *filt2)
 {
@@ -915,6 +1167,10 @@ filters_are_equal(LogFilter *filt1, LogFilter *filt2)
       ret = (*((LogFilterIP *)filt1) == *((LogFilterIP *)filt2));
     } else if (filt1->type() == LogFilter::STRING_FILTER) {
       ret = (*((LogFilterString *)filt1) == *((LogFilterString *)filt2));
+    } else if (filt1->type() == LogFilter::SAMPLE_FILTER) {
+      ret = (*((LogFilterSample *)filt1) == *((LogFilterSample *)filt2));
+    } else if (filt1->type() == LogFilter::RATE_FILTER) {
+      ret = (*((LogFilterRate *)filt1) == *((LogFilterRate *)filt2));
     } else {
       ink_assert(!"invalid filter type");
     }
@@ -996,6 +1252,13 @@ LogFilterList::add(LogFilter *filter, bool copy)
     } else if (filter->type() == LogFilter::IP_FILTER) {
       LogFilterIP *f = new LogFilterIP(*((LogFilterIP *)filter));
       m_filter_list.enqueue(f);
+    } else if (filter->type() == LogFilter::SAMPLE_FILTER) {
+      LogFilterSample *f = new LogFilterSample(*((LogFilterSample *)filter));
+      m_filter_list.enqueue(f);
+    } else if (filter->type() == LogFilter::RATE_FILTER) {
+      // each copy has a bucket of its own
+      LogFilterRate *f = new LogFilterRate(*((LogFilterRate *)filter));
+      m_filter_list.enqueue(f);
     } else {
       LogFilterString *f = new LogFilterString(*((LogFilterString *)filter));
       m_filter_list.enqueue(f);
@@ -1030,7 +1293,13 @@ LogFilterList::toss_this_entry(LogAccess *lad)
     // toss if any filter rejects the entry (all filters should accept)
     //
     for (LogFilter *f = first(); f; f = next(f)) {
-      if (f->toss_this_entry(lad)) {
+      if (f->type() != LogFilter::RATE_FILTER && f->toss_this_entry(lad)) {
+        return true;
+      }
+    }
+    // rate filters are last, so only the entries the others keep use up tokens
+    for (LogFilter *f = first(); f; f = next(f)) {
+      if (f->type() == LogFilter::RATE_FILTER && f->toss_this_entry(lad)) {
         return true;
       }
     }
@@ -1118,6 +1387,24 @@ REGRESSION_TEST(Log_FilterParse)(RegressionTest *t, int /* atype */, int *pstatu
 
   CHECK_FORMAT_PARSE("pssc MATCH 200");
   CHECK_FORMAT_PARSE("shn CASE_INSENSITIVE_CONTAIN unwanted.com");
+  CHECK_FORMAT_PARSE("cruuid SAMPLE 10%");
+  CHECK_FORMAT_PARSE("chi SAMPLE 0.5");
+  CHECK_FORMAT_PARSE("RATE 100");
+
+  retfilter = LogFilter::parse("t6", LogFilter::ACCEPT, "chi SAMPLE 101%");
+  box.check(retfilter == nullptr, "Sample above 100 percent");
+  delete retfilter;
+  retfilter = LogFilter::parse("t7", LogFilter::ACCEPT, "RATE many");
+  box.check(retfilter == nullptr, "Invalid rate");
+  delete retfilter;
+  retfilter = LogFilter::parse("t8", LogFilter::WIPE_FIELD_VALUE, "RATE 100");
+  box.check(retfilter == nullptr, "Rate filters do not wipe fields");
+  delete retfilter;
+
+  // a bucket of one entry a second takes one and then none
+  LogFilterRate rate("t9", LogFilter::ACCEPT, "1");
+  box.check(!rate.toss_this_entry(nullptr), "The first entry is in the rate");
+  box.check(rate.toss_this_entry(nullptr), "The second entry is over the rate");
 
 #undef CHECK_FORMAT_PARSE
 }
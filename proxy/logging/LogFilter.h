@@ -26,10 +26,13 @@
 #include "tscore/ink_platform.h"
 #include "tscore/IpMap.h"
 #include "tscore/Ptr.h"
+#include "tscore/ink_hrtime.h"
 #include "LogAccess.h"
 #include "LogField.h"
 #include "LogFormat.h"
 
+#include <atomic>
+
 /*-------------------------------------------------------------------------
   LogFilter
 
@@ -45,6 +48,8 @@ public:
     INT_FILTER = 0,
     STRING_FILTER,
     IP_FILTER,
+    SAMPLE_FILTER,
+    RATE_FILTER,
     N_TYPES,
   };
 
@@ -248,6 +253,85 @@ private:
   LogFilterIP();
 };
 
+/*-------------------------------------------------------------------------
+  LogFilterSample
+
+  Filter for a share of the entries, chosen by a hash of the value of a
+  field, as "<field> SAMPLE <percent>". The same values are always in the
+  sample, so all the entries of a request, or of a client, are logged or
+  none of them are, and in the logs of every server alike.
+  -------------------------------------------------------------------------*/
+class LogFilterSample : public LogFilter
+{
+public:
+  /// Parts per million of the hashes a sample is expressed in.
+  static constexpr uint32_t SAMPLE_SCALE = 1000000;
+
+  LogFilterSample(const char *name, LogField *field, Action a, const char *percent);
+  LogFilterSample(const LogFilterSample &rhs);
+  ~LogFilterSample() override = default;
+  bool operator==(LogFilterSample &rhs);
+
+  bool toss_this_entry(LogAccess *lad) override;
+  bool wipe_this_entry(LogAccess *lad) override;
+  void display(FILE *fd = stdout) override;
+
+  /// Whether the entry with a field of hash @a hash is in the sample.
+  bool
+  in_sample(uint64_t hash) const
+  {
+    return hash % SAMPLE_SCALE < m_threshold;
+  }
+
+  // noncopyable
+  LogFilterSample &operator=(LogFilterSample &rhs) = delete;
+
+private:
+  uint32_t m_threshold = 0; // parts per million in the sample
+
+  // The hash of the value of the field. Only the bytes of the value are hashed, not the padding.
+  uint64_t _hash_field(LogAccess *lad);
+
+  // -- member functions that are not allowed --
+  LogFilterSample();
+};
+
+/*-------------------------------------------------------------------------
+  LogFilterRate
+
+  Filter for at most a number of entries a second, as "RATE <entries>". It
+  is a token bucket which holds a second's worth of entries, and each
+  LogObject has its own copy of the filter, so each has its own bucket.
+  -------------------------------------------------------------------------*/
+class LogFilterRate : public LogFilter
+{
+public:
+  LogFilterRate(const char *name, Action a, const char *rate);
+  LogFilterRate(const LogFilterRate &rhs);
+  ~LogFilterRate() override = default;
+  bool operator==(LogFilterRate &rhs);
+
+  bool toss_this_entry(LogAccess *lad) override;
+  bool wipe_this_entry(LogAccess *lad) override;
+  void display(FILE *fd = stdout) override;
+
+  // noncopyable
+  LogFilterRate &operator=(LogFilterRate &rhs) = delete;
+
+private:
+  int64_t m_rate             = 0; // entries a second, and the size of the bucket
+  ink_hrtime m_refill_period = 0; // time it takes for the bucket to gain a token
+  std::atomic<int64_t> m_tokens{0};
+  std::atomic<ink_hrtime> m_last_refill{0};
+
+  void _init();
+  // Take a token from the bucket, false if it is empty.
+  bool _take_token();
+
+  // -- member functions that are not allowed --
+  LogFilterRate();
+};
+
 bool filters_are_equal(LogFilter *filt1, LogFilter *filt2);
 
 /*-------------------------------------------------------------------------
@@ -0,0 +1,167 @@
+/** @file
+
+  Writes of the log flush thread.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "LogFlushWriter.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+
+#include "LogConfig.h"
+#include "LogFile.h"
+#include "Log.h"
+
+LogFlushWriter::LogFlushWriter()
+{
+#if TS_USE_LINUX_IO_URING
+  int ret = io_uring_queue_init(RING_ENTRIES, &_ring, 0);
+  if (ret < 0) {
+    Warning("cannot set up io_uring for the log files, writing them with write(): %s (%d)", strerror(-ret), -ret);
+  } else {
+    _ring_set_up = true;
+    _use_ring    = true;
+  }
+#endif
+}
+
+LogFlushWriter::~LogFlushWriter()
+{
+#if TS_USE_LINUX_IO_URING
+  if (_ring_set_up) {
+    io_uring_queue_exit(&_ring);
+  }
+#endif
+}
+
+void
+LogFlushWriter::add(LogFile *logfile, const char *buf, int len)
+{
+  _writes.push_back({logfile, logfile->get_fd(), buf, len, 0});
+}
+
+void
+LogFlushWriter::flush(ProxyMutex *mutex)
+{
+#if TS_USE_LINUX_IO_URING
+  // Out of space, the blocking writes below drop the data and account for it.
+  if (_use_ring && !Log::config->logging_space_exhausted) {
+    // The writes of each file are made adjacent, still in the order they were added, so that they can be linked.
+    std::stable_sort(_writes.begin(), _writes.end(), [](const Write &lhs, const Write &rhs) { return lhs.fd < rhs.fd; });
+    for (size_t begin = 0; begin < _writes.size() && _use_ring; begin += RING_ENTRIES) {
+      _submit(begin, std::min<size_t>(begin + RING_ENTRIES, _writes.size()));
+    }
+  }
+#endif
+
+  for (Write &w : _writes) {
+    // whatever the ring did not write is written here, in order: once a write of a file fails or is short, the
+    // kernel cancels the writes linked after it
+    if (w.written < w.len) {
+      _write_sync(w, mutex);
+    }
+
+    RecIncrRawStat(log_rsb, mutex->thread_holding, log_stat_bytes_written_to_disk_stat, w.written);
+    if (w.logfile->m_log) {
+      ink_atomic_increment(&w.logfile->m_log->m_bytes_written, w.written);
+    }
+  }
+  _writes.clear();
+}
+
+void
+LogFlushWriter::_write_sync(Write &w, ProxyMutex *mutex)
+{
+  // write *all* data to target file as much as possible
+  //
+  while (w.written < w.len) {
+    if (Log::config->logging_space_exhausted) {
+      Debug("log", "logging space exhausted, failed to write file:%s, have dropped (%d) bytes.", w.logfile->get_name(),
+            w.len - w.written);
+
+      RecIncrRawStat(log_rsb, mutex->thread_holding, log_stat_bytes_lost_before_written_to_disk_stat, w.len - w.written);
+      break;
+    }
+
+    int len = ::write(w.fd, w.buf + w.written, w.len - w.written);
+
+    if (len < 0) {
+      Error("Failed to write log to %s: [tried %d, wrote %d, %s]", w.logfile->get_name(), w.len - w.written, w.written,
+            strerror(errno));
+
+      RecIncrRawStat(log_rsb, mutex->thread_holding, log_stat_bytes_lost_before_written_to_disk_stat, w.len - w.written);
+      break;
+    }
+    Debug("log", "Successfully wrote some stuff to %s", w.logfile->get_name());
+    w.written += len;
+  }
+}
+
+#if TS_USE_LINUX_IO_URING
+void
+LogFlushWriter::_submit(size_t begin, size_t end)
+{
+  for (size_t i = begin; i < end; ++i) {
+    Write &w = _writes[i];
+    // the ring is empty and has room for all of them
+    struct io_uring_sqe *sqe = io_uring_get_sqe(&_ring);
+
+    // Like write(), at the position of the file and moving it. The log files are opened to append and pipes have none.
+    io_uring_prep_write(sqe, w.fd, w.buf, w.len, -1);
+    io_uring_sqe_set_data(sqe, &w);
+    if (i + 1 < end && _writes[i + 1].fd == w.fd) {
+      sqe->flags |= IOSQE_IO_LINK;
+    }
+  }
+
+  int submitted = io_uring_submit_and_wait(&_ring, end - begin);
+  if (submitted < 0 || static_cast<size_t>(submitted) < end - begin) {
+    // What was not submitted stays in the ring, which is not used again, and is written with write().
+    Warning("io_uring_submit failed for the log files, writing them with write(): %s (%d)",
+            strerror(submitted < 0 ? -submitted : EAGAIN), submitted < 0 ? -submitted : EAGAIN);
+    _use_ring = false;
+    submitted = std::max(submitted, 0);
+  }
+
+  // The data must not be freed while the kernel may still write it, every completion is waited for.
+  for (int reaped = 0; reaped < submitted;) {
+    struct io_uring_cqe *cqe;
+    int ret = io_uring_wait_cqe(&_ring, &cqe);
+    if (ret == -EINTR) {
+      continue;
+    }
+    ink_release_assert(ret == 0);
+
+    Write *w = static_cast<Write *>(io_uring_cqe_get_data(cqe));
+    if (cqe->res > 0) {
+      w->written = cqe->res;
+    } else if (cqe->res == -EINVAL && _use_ring) {
+      // kernels before 5.6 can not write at the position of the file
+      Note("io_uring can not append to the log files, writing them with write()");
+      _use_ring = false;
+    }
+    io_uring_cqe_seen(&_ring, cqe);
+    ++reaped;
+  }
+}
+#endif
@@ -0,0 +1,84 @@
+/** @file
+
+  Writes of the log flush thread.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  @section details Details
+
+  The flush thread hands each batch of data it pops to a LogFlushWriter, which writes it all
+  before the batch is freed. With io_uring the writes of a batch are submitted together, those of
+  a file linked to each other so that the kernel does them in order, and the files are written in
+  parallel rather than one after another. Without it, or if the ring can not be set up, each write
+  is a blocking write() as before.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "tscore/ink_config.h"
+#include "I_EventSystem.h"
+
+#if TS_USE_LINUX_IO_URING
+#include <liburing.h>
+#endif
+
+class LogFile;
+
+class LogFlushWriter
+{
+public:
+  LogFlushWriter();
+  ~LogFlushWriter();
+
+  /// Add @a len bytes at @a buf to be written to @a logfile, which must be open. They must stay until @c flush returns.
+  void add(LogFile *logfile, const char *buf, int len);
+
+  /// Write all the data added, in the order it was added for each file, and account for it in the stats of @a mutex.
+  void flush(ProxyMutex *mutex);
+
+  // noncopyable
+  LogFlushWriter(const LogFlushWriter &) = delete;
+  LogFlushWriter &operator=(const LogFlushWriter &) = delete;
+
+private:
+  struct Write {
+    LogFile *logfile;
+    int fd;
+    const char *buf;
+    int len;
+    int written; ///< Bytes written so far.
+  };
+
+  /// Write what is left of @a w with blocking writes.
+  void _write_sync(Write &w, ProxyMutex *mutex);
+
+  std::vector<Write> _writes;
+
+#if TS_USE_LINUX_IO_URING
+  static constexpr unsigned RING_ENTRIES = 256;
+
+  void _submit(size_t begin, size_t end);
+
+  struct io_uring _ring;
+  bool _ring_set_up = false;
+  bool _use_ring    = false; ///< Turned off for good if the ring fails.
+#endif
+};
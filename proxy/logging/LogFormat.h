@@ -39,6 +39,7 @@ enum LogFileFormat {
   LOG_FILE_BINARY,
   LOG_FILE_ASCII,
   LOG_FILE_PIPE, // ie. ASCII pipe
+  LOG_FILE_COLUMNAR,
   N_LOGFILE_TYPES
 };
 
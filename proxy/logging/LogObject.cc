@@ -38,6 +38,7 @@
 #include "tscore/TestBox.h"
 
 #include <algorithm>
+#include <atomic>
 #include <vector>
 
 static bool
@@ -72,10 +73,21 @@ LogBufferManager::preproc_buffers(LogBufferSink *sink)
     }
   }
 
-  int prepared = 0;
+  // The buffers of a shard are queued in the order they were filled. Across shards, they can be put
+  // in the order they were started, which keeps a stable sort from reordering those of a shard.
+  std::vector<LogBuffer *> ready;
   while ((b = new_q.pop())) {
-    b->update_header_data();
-    sink->preproc_and_try_delete(b);
+    ready.push_back(b);
+  }
+  if (Log::config->log_buffer_merge_by_time && ready.size() > 1) {
+    std::stable_sort(ready.begin(), ready.end(),
+                     [](LogBuffer *lhs, LogBuffer *rhs) { return lhs->expiration_time() < rhs->expiration_time(); });
+  }
+
+  int prepared = 0;
+  for (LogBuffer *buffer : ready) {
+    buffer->update_header_data();
+    sink->preproc_and_try_delete(buffer);
     ink_atomic_increment(&_num_flush_buffers, -1);
     prepared++;
   }
@@ -88,6 +100,9 @@ LogBufferManager::preproc_buffers(LogBufferSink *sink)
   LogObject
   -------------------------------------------------------------------------*/
 
+// The objects take turns for the preproc thread of their first shard.
+static std::atomic<unsigned> next_preproc_home{0};
+
 LogObject::LogObject(const LogFormat *format, const char *log_dir, const char *basename, LogFileFormat file_format,
                      const char *header, Log::RollingEnabledValues rolling_enabled, int flush_threads, int rolling_interval_sec,
                      int rolling_offset_hr, int rolling_size_mb, bool auto_created, int rolling_max_count, int rolling_min_count,
@@ -103,7 +118,7 @@ LogObject::LogObject(const LogFormat *format, const char *log_dir, const char *b
     m_max_rolled(rolling_max_count),
     m_min_rolled(rolling_min_count),
     m_reopen_after_rolling(reopen_after_rolling),
-    m_buffer_manager_idx(0),
+    m_preproc_home(next_preproc_home++),
     m_pipe_buffer_size(pipe_buffer_size)
 {
   ink_release_assert(format);
@@ -114,6 +129,8 @@ LogObject::LogObject(const LogFormat *format, const char *log_dir, const char *b
     m_flags |= BINARY;
   } else if (file_format == LOG_FILE_PIPE) {
     m_flags |= WRITES_TO_PIPE;
+  } else if (file_format == LOG_FILE_COLUMNAR) {
+    m_flags |= COLUMNAR;
   }
 
   generate_filenames(log_dir, basename, file_format);
@@ -128,9 +145,12 @@ LogObject::LogObject(const LogFormat *format, const char *log_dir, const char *b
     m_logFile->open_file();
   }
 
-  LogBuffer *b = new LogBuffer(this, Log::config->log_buffer_size);
-  ink_assert(b);
-  SET_FREELIST_POINTER_VERSION(m_log_buffer, b, 0);
+  m_buffer_shards = Log::config->log_buffer_shards;
+  for (int shard = 0; shard < m_buffer_shards; ++shard) {
+    LogBuffer *b = new LogBuffer(this, Log::config->log_buffer_size);
+    ink_assert(b);
+    SET_FREELIST_POINTER_VERSION(m_log_buffer[shard], b, 0);
+  }
 
   _setup_rolling(rolling_enabled, rolling_interval_sec, rolling_offset_hr, rolling_size_mb);
 
@@ -153,7 +173,7 @@ LogObject::LogObject(LogObject &rhs)
     m_max_rolled(rhs.m_max_rolled),
     m_min_rolled(rhs.m_min_rolled),
     m_reopen_after_rolling(rhs.m_reopen_after_rolling),
-    m_buffer_manager_idx(rhs.m_buffer_manager_idx),
+    m_preproc_home(rhs.m_preproc_home),
     m_pipe_buffer_size(rhs.m_pipe_buffer_size)
 {
   m_format         = new LogFormat(*(rhs.m_format));
@@ -174,11 +194,18 @@ LogObject::LogObject(LogObject &rhs)
     add_filter(filter);
   }
 
-  // copy gets a fresh log buffer
+  if (rhs.m_stream) {
+    set_collector(rhs.m_stream->collector());
+  }
+
+  // copy gets fresh log buffers
   //
-  LogBuffer *b = new LogBuffer(this, Log::config->log_buffer_size);
-  ink_assert(b);
-  SET_FREELIST_POINTER_VERSION(m_log_buffer, b, 0);
+  m_buffer_shards = rhs.m_buffer_shards;
+  for (int shard = 0; shard < m_buffer_shards; ++shard) {
+    LogBuffer *b = new LogBuffer(this, Log::config->log_buffer_size);
+    ink_assert(b);
+    SET_FREELIST_POINTER_VERSION(m_log_buffer[shard], b, 0);
+  }
 
   Debug("log-config",
         "exiting LogObject copy constructor, "
@@ -191,12 +218,16 @@ LogObject::~LogObject()
   Debug("log-config", "entering LogObject destructor, this=%p", this);
 
   preproc_buffers();
+  // the buffers still queued for the collector are written to the file
+  m_stream.reset();
   ats_free(m_basename);
   ats_free(m_filename);
   ats_free(m_alt_filename);
   delete m_format;
   delete[] m_buffer_manager;
-  delete static_cast<LogBuffer *>(FREELIST_POINTER(m_log_buffer));
+  for (int shard = 0; shard < m_buffer_shards; ++shard) {
+    delete static_cast<LogBuffer *>(FREELIST_POINTER(m_log_buffer[shard]));
+  }
 }
 
 //-----------------------------------------------------------------------------
@@ -244,6 +275,10 @@ LogObject::generate_filenames(const char *log_dir, const char *basename, LogFile
       ext     = LOG_FILE_PIPE_OBJECT_FILENAME_EXTENSION;
       ext_len = 5;
       break;
+    case LOG_FILE_COLUMNAR:
+      ext     = LOG_FILE_COLUMNAR_OBJECT_FILENAME_EXTENSION;
+      ext_len = 5;
+      break;
     default:
       ink_assert(!"unknown file format");
     }
@@ -318,7 +353,10 @@ LogObject::compute_signature(LogFormat *format, char *filename, unsigned int fla
     char *buffer = static_cast<char *>(ats_malloc(buf_size));
 
     ink_string_concatenate_strings(buffer, fl, ps, filename,
-                                   flags & LogObject::BINARY ? "B" : (flags & LogObject::WRITES_TO_PIPE ? "P" : "A"), NULL);
+                                   flags & LogObject::BINARY ?
+                                     "B" :
+                                     (flags & LogObject::WRITES_TO_PIPE ? "P" : (flags & LogObject::COLUMNAR ? "C" : "A")),
+                                   NULL);
 
     CryptoHash hash;
     CryptoContext().hash_immediate(hash, buffer, buf_size - 1);
@@ -329,6 +367,15 @@ LogObject::compute_signature(LogFormat *format, char *filename, unsigned int fla
   return signature;
 }
 
+void
+LogObject::set_collector(const char *collector)
+{
+  ink_release_assert(m_logFile);
+  m_stream = std::make_unique<LogStream>(collector, m_logFile.get(), Log::config->collector_queue_size,
+                                         Log::config->collector_timeout);
+  Debug("log-config", "LogObject %s streams to %s", m_basename, collector);
+}
+
 void
 LogObject::display(FILE *fd)
 {
@@ -340,6 +387,9 @@ LogObject::display(FILE *fd)
           this, m_format->name(), m_format, m_basename, m_flags, m_signature);
 
   fprintf(fd, "full path = %s\n", get_full_filename());
+  if (m_stream) {
+    fprintf(fd, "collector = %s\n", m_stream->collector());
+  }
   m_filter_list.display(fd);
   fprintf(fd, "++++++++++++++++++++++++++++++++++++++++++++++++++++++++\n");
 }
@@ -367,8 +417,18 @@ write_pointer_version(head_p *dst, head_p old_h, void *ptr, head_p::version_type
   return ink_atomic_cas(&dst->data, old_h.data, tmp_h.data);
 }
 
+int
+LogObject::_shard_of_this_thread() const
+{
+  if (m_buffer_shards == 1) {
+    return 0;
+  }
+  EThread *t = this_ethread();
+  return (t && t->id >= 0) ? t->id % m_buffer_shards : 0;
+}
+
 LogBuffer *
-LogObject::_checkout_write(size_t *write_offset, size_t bytes_needed)
+LogObject::_checkout_write(size_t *write_offset, size_t bytes_needed, int shard)
 {
   LogBuffer::LB_ResultCode result_code;
   LogBuffer *buffer;
@@ -380,8 +440,8 @@ LogObject::_checkout_write(size_t *write_offset, size_t bytes_needed)
     // To avoid a race condition, we keep a count of held references in
     // the pointer itself and add this to m_outstanding_references.
 
-    // Increment the version of m_log_buffer, returning the previous version.
-    head_p h = increment_pointer_version(&m_log_buffer);
+    // Increment the version of the shard's buffer, returning the previous version.
+    head_p h = increment_pointer_version(&m_log_buffer[shard]);
 
     buffer           = static_cast<LogBuffer *>(FREELIST_POINTER(h));
     result_code      = buffer->checkout_write(write_offset, bytes_needed);
@@ -402,7 +462,7 @@ LogObject::_checkout_write(size_t *write_offset, size_t bytes_needed)
       INK_WRITE_MEMORY_BARRIER;
 
       do {
-        INK_QUEUE_LD(old_h, m_log_buffer);
+        INK_QUEUE_LD(old_h, m_log_buffer[shard]);
         // we may depend on comparing the old pointer to the new pointer to detect buffer swaps
         // without worrying about pointer collisions because we always allocate a new LogBuffer
         // before freeing the old one
@@ -415,12 +475,12 @@ LogObject::_checkout_write(size_t *write_offset, size_t bytes_needed)
           new_buffer = nullptr;
           break;
         }
-      } while (write_pointer_version(&m_log_buffer, old_h, new_buffer, 0) == false);
+      } while (write_pointer_version(&m_log_buffer[shard], old_h, new_buffer, 0) == false);
 
       if (FREELIST_POINTER(old_h) == FREELIST_POINTER(h)) {
         ink_atomic_increment(&buffer->m_references, FREELIST_VERSION(old_h) - 1);
 
-        int idx = m_buffer_manager_idx++ % m_flush_threads;
+        int idx = _preproc_thread_of(shard);
         Debug("log-logbuffer", "adding buffer %d to flush list after checkout", buffer->get_id());
         m_buffer_manager[idx].add_to_flush_queue(buffer);
         Log::preproc_notify[idx].signal();
@@ -449,13 +509,13 @@ LogObject::_checkout_write(size_t *write_offset, size_t bytes_needed)
       // The do-while loop protects us from races while we're examining ptr(old_h) and ptr(h)
       // (essentially an optimistic lock)
       do {
-        INK_QUEUE_LD(old_h, m_log_buffer);
+        INK_QUEUE_LD(old_h, m_log_buffer[shard]);
         if (FREELIST_POINTER(old_h) != FREELIST_POINTER(h)) {
           // Another thread's allocated a new LogBuffer, we don't need to do anything more
           break;
         }
 
-      } while (!write_pointer_version(&m_log_buffer, old_h, FREELIST_POINTER(h), FREELIST_VERSION(old_h) - 1));
+      } while (!write_pointer_version(&m_log_buffer[shard], old_h, FREELIST_POINTER(h), FREELIST_VERSION(old_h) - 1));
 
       if (FREELIST_POINTER(old_h) != FREELIST_POINTER(h)) {
         // Another thread's allocated a new LogBuffer, meaning this LogObject is no longer referencing the old LogBuffer
@@ -593,7 +653,7 @@ LogObject::log(LogAccess *lad, std::string_view text_entry)
   }
 
   // Now try to place this entry in the current LogBuffer.
-  buffer = _checkout_write(&offset, bytes_needed);
+  buffer = _checkout_write(&offset, bytes_needed, _shard_of_this_thread());
 
   if (!buffer) {
     Note("Skipping the current log entry for %s because its size (%zu) exceeds "
@@ -778,9 +838,11 @@ LogObject::_roll_files(long last_roll_time, long time_now)
 void
 LogObject::check_buffer_expiration(long time_now)
 {
-  LogBuffer *b = static_cast<LogBuffer *>(FREELIST_POINTER(m_log_buffer));
-  if (b && time_now > b->expiration_time()) {
-    force_new_buffer();
+  for (int shard = 0; shard < m_buffer_shards; ++shard) {
+    LogBuffer *b = static_cast<LogBuffer *>(FREELIST_POINTER(m_log_buffer[shard]));
+    if (b && time_now > b->expiration_time()) {
+      _checkout_write(nullptr, 0, shard);
+    }
   }
 }
 
@@ -31,6 +31,8 @@
 #include "LogBuffer.h"
 #include "LogAccess.h"
 #include "LogFilter.h"
+#include "LogStream.h"
+#include <memory>
 #include <vector>
 
 /*-------------------------------------------------------------------------
@@ -48,6 +50,7 @@
 #define LOG_FILE_ASCII_OBJECT_FILENAME_EXTENSION ".log"
 #define LOG_FILE_BINARY_OBJECT_FILENAME_EXTENSION ".blog"
 #define LOG_FILE_PIPE_OBJECT_FILENAME_EXTENSION ".pipe"
+#define LOG_FILE_COLUMNAR_OBJECT_FILENAME_EXTENSION ".clog"
 
 #define FLUSH_ARRAY_SIZE (512 * 4)
 
@@ -88,8 +91,12 @@ public:
     BINARY                   = 1,
     WRITES_TO_PIPE           = 4,
     LOG_OBJECT_FMT_TIMESTAMP = 8, // always format a timestamp into each log line (for raw text logs)
+    COLUMNAR                 = 16,
   };
 
+  // Upper bound of proxy.config.log.log_buffer_shards
+  static constexpr int MAX_BUFFER_SHARDS = 64;
+
   // BINARY: log is written in binary format (rather than ascii)
   // WRITES_TO_PIPE: object writes to a named pipe rather than to a file
 
@@ -128,24 +135,27 @@ public:
   inline int
   add_to_flush_queue(LogBuffer *buffer)
   {
-    int idx = m_buffer_manager_idx++ % m_flush_threads;
+    int idx = _preproc_thread_of(0);
 
     m_buffer_manager[idx].add_to_flush_queue(buffer);
 
     return idx;
   }
 
+  // Preprocess the buffers queued for preproc thread idx, or for all of them if idx is -1.
   inline size_t
   preproc_buffers(int idx = -1)
   {
-    size_t nfb;
+    size_t nfb = 0;
 
     if (idx == -1) {
-      idx = m_buffer_manager_idx++ % m_flush_threads;
+      for (int i = 0; i < m_flush_threads; ++i) {
+        nfb += m_buffer_manager[i].preproc_buffers(_sink());
+      }
+    } else {
+      nfb = m_buffer_manager[idx].preproc_buffers(_sink());
     }
 
-    nfb = m_buffer_manager[idx].preproc_buffers(m_logFile.get());
-
     return nfb;
   }
 
@@ -225,6 +235,15 @@ public:
     return (m_logFile && !(m_flags & WRITES_TO_PIPE) ? true : false);
   }
 
+  /// Stream the buffers to @a collector, as "host:port", the log file only gets those it can not keep up with.
+  void set_collector(const char *collector);
+
+  inline const char *
+  get_collector() const
+  {
+    return m_stream ? m_stream->collector() : "";
+  }
+
   inline unsigned int
   get_flags() const
   {
@@ -248,7 +267,9 @@ public:
   inline void
   force_new_buffer()
   {
-    _checkout_write(nullptr, 0);
+    for (int shard = 0; shard < m_buffer_shards; ++shard) {
+      _checkout_write(nullptr, 0, shard);
+    }
   }
 
   bool operator==(LogObject &rhs);
@@ -283,18 +304,39 @@ private:
   int m_min_rolled;            // minimum number of rolled logs to be kept, 0 no limit
   bool m_reopen_after_rolling; // reopen log file after rolling (normally it is just renamed and closed)
 
-  head_p m_log_buffer; // current work buffer
-  unsigned m_buffer_manager_idx;
+  // Current work buffer of each shard. Each event thread writes to one shard, so that the threads do not
+  // all contend for a single buffer pointer, and the shard's buffers are flushed by one thread in order.
+  head_p m_log_buffer[MAX_BUFFER_SHARDS];
+  int m_buffer_shards;
+  unsigned m_preproc_home; // preproc thread of the first shard, objects are spread over the threads
   LogBufferManager *m_buffer_manager;
 
   int m_pipe_buffer_size;
 
+  std::unique_ptr<LogStream> m_stream; // set if the buffers are streamed to a collector
+
+  // Where the buffers go once they are full.
+  LogBufferSink *
+  _sink() const
+  {
+    return m_stream ? static_cast<LogBufferSink *>(m_stream.get()) : m_logFile.get();
+  }
+
   void generate_filenames(const char *log_dir, const char *basename, LogFileFormat file_format);
   void _setup_rolling(Log::RollingEnabledValues rolling_enabled, int rolling_interval_sec, int rolling_offset_hr,
                       int rolling_size_mb);
   unsigned _roll_files(long interval_start, long interval_end);
 
-  LogBuffer *_checkout_write(size_t *write_offset, size_t write_size);
+  int _shard_of_this_thread() const;
+
+  // The preproc thread that formats the buffers of a shard. All the buffers of a shard go to one thread so that those of an
+  // object are written in order, and the shards of the objects are spread over the threads so that they format in parallel.
+  int
+  _preproc_thread_of(int shard) const
+  {
+    return (m_preproc_home + shard) % m_flush_threads;
+  }
+  LogBuffer *_checkout_write(size_t *write_offset, size_t write_size, int shard);
 
   // noncopyable
   LogObject(const LogObject &) = delete;
@@ -416,7 +458,8 @@ LogObject::operator==(LogObject &old)
           strcmp(m_logFile->get_name(), old.m_logFile->get_name()) == 0 && (m_filter_list == old.m_filter_list) &&
           (m_rolling_interval_sec == old.m_rolling_interval_sec && m_rolling_offset_hr == old.m_rolling_offset_hr &&
            m_rolling_size_mb == old.m_rolling_size_mb && m_reopen_after_rolling == old.m_reopen_after_rolling &&
-           m_max_rolled == old.m_max_rolled && m_min_rolled == old.m_min_rolled));
+           m_max_rolled == old.m_max_rolled && m_min_rolled == old.m_min_rolled) &&
+          strcmp(get_collector(), old.get_collector()) == 0);
 }
 
 inline off_t
@@ -0,0 +1,279 @@
+/** @file
+
+  Streaming of log buffers to a remote collector.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "LogStream.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#include <netdb.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "tscore/ink_hrtime.h"
+#include "tscore/Diags.h"
+#include "tscore/ParseRules.h"
+#include "LogBuffer.h"
+
+namespace
+{
+// The longest wait between attempts to reach a collector.
+constexpr ink_hrtime MAX_RETRY = HRTIME_SECONDS(30);
+} // namespace
+
+LogStream::LogStream(const char *collector, LogFile *spill, size_t queue_limit, int timeout_sec)
+  : m_collector(collector), m_spill(spill), m_queue_limit(queue_limit), m_timeout_sec(timeout_sec)
+{
+  ink_release_assert(parse_collector(collector, m_host, m_port));
+  ink_mutex_init(&m_mutex);
+  ink_cond_init(&m_cond);
+  ink_thread_create(&m_thread, &LogStream::sender_main, this, 0, 0, nullptr);
+}
+
+/*-------------------------------------------------------------------------
+  LogStream::~LogStream
+
+  Stop the thread of the stream, which finishes the buffer it is sending,
+  and write the buffers still queued to the spill file so that none is lost.
+  -------------------------------------------------------------------------*/
+LogStream::~LogStream()
+{
+  ink_mutex_acquire(&m_mutex);
+  m_shutdown = true;
+  ink_cond_signal(&m_cond);
+  ink_mutex_release(&m_mutex);
+  ink_thread_join(m_thread);
+
+  for (LogBuffer *buffer : m_queue) {
+    _spill(buffer);
+  }
+  m_queue.clear();
+  _disconnect();
+
+  ink_cond_destroy(&m_cond);
+  ink_mutex_destroy(&m_mutex);
+}
+
+bool
+LogStream::parse_collector(const char *collector, std::string &host, int &port)
+{
+  std::string_view text{collector ? collector : ""};
+  std::string_view name;
+
+  if (!text.empty() && text.front() == '[') {
+    auto close = text.find(']');
+    if (close == text.npos || text.substr(close + 1, 1) != ":") {
+      return false;
+    }
+    name = text.substr(1, close - 1);
+    text.remove_prefix(close + 2);
+  } else {
+    auto colon = text.rfind(':');
+    if (colon == text.npos) {
+      return false;
+    }
+    name = text.substr(0, colon);
+    text.remove_prefix(colon + 1);
+  }
+
+  if (name.empty() || text.empty() || text.size() > 5 || !std::all_of(text.begin(), text.end(), ParseRules::is_digit)) {
+    return false;
+  }
+  port = atoi(std::string{text}.c_str());
+  host.assign(name);
+  return port > 0 && port <= 65535;
+}
+
+int
+LogStream::preproc_and_try_delete(LogBuffer *lb)
+{
+  if (lb == nullptr) {
+    Note("Cannot send LogBuffer to log collector %s; LogBuffer is NULL", m_collector.c_str());
+    return -1;
+  }
+
+  LogBufferHeader *header = lb->header();
+  if (header == nullptr || header->entry_count == 0) {
+    // nothing to send, the log file reports and deletes it as usual
+    return m_spill->preproc_and_try_delete(lb);
+  }
+
+  ink_atomic_increment(&lb->m_references, 1);
+
+  ink_mutex_acquire(&m_mutex);
+  // Once it spills, the stream waits for the queue to drain to half before it queues again, so that
+  // a collector just keeping up does not switch between the two for each buffer.
+  size_t limit = m_spilling ? m_queue_limit / 2 : m_queue_limit;
+  bool queued  = !m_shutdown && m_queued_bytes + header->byte_count <= limit;
+  if (queued) {
+    m_queue.push_back(lb);
+    m_queued_bytes += header->byte_count;
+    ink_cond_signal(&m_cond);
+    if (m_spilling) {
+      Note("log collector %s caught up, no longer writing to %s", m_collector.c_str(), m_spill->get_name());
+      m_spilling = false;
+    }
+  } else if (!m_spilling) {
+    Warning("log collector %s is not keeping up, writing to %s instead", m_collector.c_str(), m_spill->get_name());
+    m_spilling = true;
+  }
+  ink_mutex_release(&m_mutex);
+
+  if (!queued) {
+    _spill(lb);
+  }
+  return 0;
+}
+
+void
+LogStream::_spill(LogBuffer *buffer)
+{
+  m_spill->preproc_and_try_delete(buffer);
+  LogBuffer::destroy(buffer);
+}
+
+void *
+LogStream::sender_main(void *arg)
+{
+  static_cast<LogStream *>(arg)->_run();
+  return nullptr;
+}
+
+/*-------------------------------------------------------------------------
+  LogStream::_run
+
+  Send the queued buffers in order on one connection, and make it again
+  when it fails, waiting longer each time the collector can not be reached.
+  A buffer stays queued until it has been sent in full, so the one that was
+  being sent when a connection failed is sent again on the next one.
+  -------------------------------------------------------------------------*/
+void
+LogStream::_run()
+{
+  ink_hrtime retry = HRTIME_SECOND;
+
+  ink_mutex_acquire(&m_mutex);
+  while (!m_shutdown) {
+    if (m_queue.empty()) {
+      ink_cond_wait(&m_cond, &m_mutex);
+      continue;
+    }
+
+    LogBuffer *buffer = m_queue.front();
+    uint32_t bytes    = buffer->header()->byte_count;
+    ink_mutex_release(&m_mutex);
+
+    bool sent = (m_fd >= 0 || _connect()) && _send(reinterpret_cast<char *>(buffer->header()), bytes);
+
+    ink_mutex_acquire(&m_mutex);
+    if (sent) {
+      m_queue.pop_front();
+      m_queued_bytes -= bytes;
+      LogBuffer::destroy(buffer);
+      retry = HRTIME_SECOND;
+    } else {
+      _disconnect();
+      Debug("log-stream", "log collector %s is unreachable, trying again in %" PRId64 "s", m_collector.c_str(),
+            static_cast<int64_t>(ink_hrtime_to_sec(retry)));
+      // Buffers keep being queued meanwhile, each of them wakes us up.
+      ink_hrtime until = ink_get_hrtime_internal() + retry;
+      while (!m_shutdown && ink_get_hrtime_internal() < until) {
+        timespec ts = ink_hrtime_to_timespec(until);
+        ink_cond_timedwait(&m_cond, &m_mutex, &ts);
+      }
+      retry = std::min(retry * 2, MAX_RETRY);
+    }
+  }
+  ink_mutex_release(&m_mutex);
+}
+
+bool
+LogStream::_connect()
+{
+  addrinfo hints;
+  addrinfo *addrs = nullptr;
+  char port[8];
+
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_family   = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  snprintf(port, sizeof(port), "%d", m_port);
+
+  if (int err = getaddrinfo(m_host.c_str(), port, &hints, &addrs); err != 0) {
+    Debug("log-stream", "cannot resolve log collector %s: %s", m_collector.c_str(), gai_strerror(err));
+    return false;
+  }
+
+  // A stalled collector must not hold up the thread forever, connecting and sending both time out.
+  timeval timeout = {m_timeout_sec, 0};
+  int on          = 1;
+
+  for (addrinfo *ai = addrs; ai && m_fd < 0; ai = ai->ai_next) {
+    int fd = socket(ai->ai_family, ai->ai_socktype | SOCK_CLOEXEC, ai->ai_protocol);
+    if (fd < 0) {
+      continue;
+    }
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+    setsockopt(fd, SOL_SOCKET, SO_KEEPALIVE, &on, sizeof(on));
+    if (connect(fd, ai->ai_addr, ai->ai_addrlen) == 0) {
+      m_fd = fd;
+    } else {
+      Debug("log-stream", "cannot connect to log collector %s: %s", m_collector.c_str(), strerror(errno));
+      close(fd);
+    }
+  }
+  freeaddrinfo(addrs);
+
+  if (m_fd >= 0) {
+    Note("connected to log collector %s", m_collector.c_str());
+  }
+  return m_fd >= 0;
+}
+
+bool
+LogStream::_send(const char *buf, size_t len)
+{
+  while (len > 0) {
+    ssize_t n = send(m_fd, buf, len, MSG_NOSIGNAL);
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      Warning("lost the connection to log collector %s: %s", m_collector.c_str(), strerror(errno));
+      return false;
+    }
+    buf += n;
+    len -= n;
+  }
+  return true;
+}
+
+void
+LogStream::_disconnect()
+{
+  if (m_fd >= 0) {
+    close(m_fd);
+    m_fd = -1;
+  }
+}
@@ -0,0 +1,97 @@
+/** @file
+
+  Streaming of log buffers to a remote collector.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  @section details Details
+
+  A LogStream sends the buffers of a LogObject, as they are flushed, over one TCP connection to a
+  collector. The buffers are sent as they are in a binary log file, each one a LogBufferHeader that
+  gives its size followed by its entries, one after another without waiting for a reply. What a
+  collector receives can be written to a file and read with traffic_logcat, whatever the format of
+  the local log is.
+
+  The buffers are queued for a thread of the stream, up to a number of bytes. A buffer that does not
+  fit, because the collector can not keep up or can not be reached, is written to the local log file
+  of the object instead, so the disk is only used while the collector stalls.
+ */
+
+#pragma once
+
+#include <deque>
+#include <string>
+
+#include "tscore/ink_thread.h"
+#include "tscore/Ptr.h"
+#include "LogBufferSink.h"
+#include "LogFile.h"
+
+class LogStream : public LogBufferSink
+{
+public:
+  /** Stream to @a collector, as "host:port", queueing up to @a queue_limit bytes.
+
+      Buffers that do not fit in the queue are passed to @a spill.
+   */
+  LogStream(const char *collector, LogFile *spill, size_t queue_limit, int timeout_sec);
+  ~LogStream() override;
+
+  /// Queue @a buffer to be sent, or pass it to the spill file if the queue is full.
+  int preproc_and_try_delete(LogBuffer *buffer) override;
+
+  const char *
+  collector() const
+  {
+    return m_collector.c_str();
+  }
+
+  /// Split @a collector into @a host and @a port, @c false if it is not "host:port" or "[address]:port".
+  static bool parse_collector(const char *collector, std::string &host, int &port);
+
+  // noncopyable
+  LogStream(const LogStream &) = delete;
+  LogStream &operator=(const LogStream &) = delete;
+
+private:
+  static void *sender_main(void *arg);
+
+  void _run();
+  bool _connect();
+  bool _send(const char *buf, size_t len);
+  void _disconnect();
+  void _spill(LogBuffer *buffer);
+
+  std::string m_collector;
+  std::string m_host;
+  int m_port = 0;
+  Ptr<LogFile> m_spill;
+  size_t m_queue_limit;
+  int m_timeout_sec;
+
+  ink_mutex m_mutex;
+  ink_cond m_cond;
+  std::deque<LogBuffer *> m_queue; // the buffer being sent stays at the front until it is sent
+  size_t m_queued_bytes = 0;
+  bool m_shutdown       = false;
+  bool m_spilling       = false; // whether the last buffer was spilled, to report when that starts and stops
+
+  int m_fd = -1;
+  ink_thread m_thread;
+};
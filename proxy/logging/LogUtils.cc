@@ -47,6 +47,10 @@
 #include <string_view>
 #include <cstdint>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 #include <sys/time.h>
 #include <sys/types.h>
 #include <sys/stat.h>
@@ -285,37 +289,81 @@ LogUtils::strip_trailing_newline(char *buf)
 
 namespace
 {
+// codes_to_escape is a bitmap encoding the codes that should be escaped.
+// These are all the codes defined in section 2.4.3 of RFC 2396
+// (control, space, delims, and unwise) plus the tilde. In RFC 2396
+// the tilde is an "unreserved" character, but we escape it because
+// historically this is what the traffic_server has done.
+// Note that we leave codes beyond 127 unmodified.
+//
+const unsigned char codes_to_escape[32] = {
+  0xFF, 0xFF, 0xFF,
+  0xFF,             // control
+  0xB4,             // space " # %
+  0x00, 0x00,       //
+  0x0A,             // < >
+  0x00, 0x00, 0x00, //
+  0x1E, 0x80,       // [ \ ] ^ `
+  0x00, 0x00,       //
+  0x1F,             // { | } ~ DEL
+  0x00, 0x00, 0x00,
+  0x00, // all non-ascii characters unmodified
+  0x00, 0x00, 0x00,
+  0x00, //               .
+  0x00, 0x00, 0x00,
+  0x00, //               .
+  0x00, 0x00, 0x00,
+  0x00 //               .
+};
+
+inline bool
+is_escaped(const unsigned char *map, unsigned char c)
+{
+  return map[c / 8] & (1 << (7 - c % 8));
+}
+
+#if defined(__SSE2__)
+// A bit for each of the 16 bytes at p that codes_to_escape has. Those with the top bit set, which
+// are negative as signed bytes, are never escaped.
+inline unsigned
+default_escapes(const char *p)
+{
+  __m128i v        = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+  __m128i control  = _mm_andnot_si128(_mm_cmplt_epi8(v, _mm_setzero_si128()), _mm_cmplt_epi8(v, _mm_set1_epi8(0x21)));
+  __m128i braces   = _mm_cmpgt_epi8(v, _mm_set1_epi8(0x7A)); // { | } ~ DEL
+  __m128i brackets = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8(0x5A)), _mm_cmplt_epi8(v, _mm_set1_epi8(0x5F)));
+  __m128i delims   = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('"')), _mm_cmpeq_epi8(v, _mm_set1_epi8('#'))),
+                                  _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('%')), _mm_cmpeq_epi8(v, _mm_set1_epi8('<'))));
+  __m128i unwise   = _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('>')), _mm_cmpeq_epi8(v, _mm_set1_epi8('`')));
+
+  return _mm_movemask_epi8(_mm_or_si128(_mm_or_si128(control, braces), _mm_or_si128(_mm_or_si128(brackets, delims), unwise)));
+}
+#endif
+
+// The first character in [p, end) that map has, or end. URLs rarely have any, so with the default
+// map the characters are checked 16 at a time.
+inline const char *
+find_escaped(const char *p, const char *end, const unsigned char *map)
+{
+#if defined(__SSE2__)
+  if (map == codes_to_escape) {
+    for (; end - p >= 16; p += 16) {
+      if (unsigned bits = default_escapes(p)) {
+        return p + __builtin_ctz(bits);
+      }
+    }
+  }
+#endif
+  while (p < end && !is_escaped(map, *p)) {
+    ++p;
+  }
+  return p;
+}
+
 char *
 escapify_url_common(Arena *arena, char *url, size_t len_in, int *len_out, char *dst, size_t dst_size, const unsigned char *map,
                     bool pure_escape)
 {
-  // codes_to_escape is a bitmap encoding the codes that should be escaped.
-  // These are all the codes defined in section 2.4.3 of RFC 2396
-  // (control, space, delims, and unwise) plus the tilde. In RFC 2396
-  // the tilde is an "unreserved" character, but we escape it because
-  // historically this is what the traffic_server has done.
-  // Note that we leave codes beyond 127 unmodified.
-  //
-  static const unsigned char codes_to_escape[32] = {
-    0xFF, 0xFF, 0xFF,
-    0xFF,             // control
-    0xB4,             // space " # %
-    0x00, 0x00,       //
-    0x0A,             // < >
-    0x00, 0x00, 0x00, //
-    0x1E, 0x80,       // [ \ ] ^ `
-    0x00, 0x00,       //
-    0x1F,             // { | } ~ DEL
-    0x00, 0x00, 0x00,
-    0x00, // all non-ascii characters unmodified
-    0x00, 0x00, 0x00,
-    0x00, //               .
-    0x00, 0x00, 0x00,
-    0x00, //               .
-    0x00, 0x00, 0x00,
-    0x00 //               .
-  };
-
   static char hex_digit[16] = {'0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'A', 'B', 'C', 'D', 'E', 'F'};
 
   if (!url || (dst && dst_size < len_in)) {
@@ -330,15 +378,10 @@ escapify_url_common(Arena *arena, char *url, size_t len_in, int *len_out, char *
   // Count specials in the url, assuming that there won't be any.
   //
   int count        = 0;
-  char *p          = url;
   char *in_url_end = url + len_in;
 
-  while (p < in_url_end) {
-    unsigned char c = *p;
-    if (map[c / 8] & (1 << (7 - c % 8))) {
-      ++count;
-    }
-    ++p;
+  for (const char *p = find_escaped(url, in_url_end, map); p < in_url_end; p = find_escaped(p + 1, in_url_end, map)) {
+    ++count;
   }
 
   if (!count) {
@@ -381,30 +424,35 @@ escapify_url_common(Arena *arena, char *url, size_t len_in, int *len_out, char *
   char *to   = new_url;
 
   while (from < in_url_end) {
+    // Copy up to the next special in one go.
+    const char *special = find_escaped(from, in_url_end, map);
+    memcpy(to, from, special - from);
+    to += special - from;
+    from = const_cast<char *>(special);
+    if (from == in_url_end) {
+      break;
+    }
+
     unsigned char c = *from;
-    if (map[c / 8] & (1 << (7 - c % 8))) {
-      /*
-       * If two characters following a '%' don't need to be encoded, then it must
-       * mean that the three character sequence is already encoded.  Just copy it over.
-       */
-      if (!pure_escape && (*from == '%') && ((from + 2) < in_url_end)) {
-        unsigned char c1   = *(from + 1);
-        unsigned char c2   = *(from + 2);
-        bool needsEncoding = ((map[c1 / 8] & (1 << (7 - c1 % 8))) || (map[c2 / 8] & (1 << (7 - c2 % 8))));
-        if (!needsEncoding) {
-          out_len -= 2;
-          Debug("log-utils", "character already encoded..skipping %c, %c, %c", *from, *(from + 1), *(from + 2));
-          *to++ = *from++;
-          continue;
-        }
+    /*
+     * If two characters following a '%' don't need to be encoded, then it must
+     * mean that the three character sequence is already encoded.  Just copy it over.
+     */
+    if (!pure_escape && (*from == '%') && ((from + 2) < in_url_end)) {
+      unsigned char c1   = *(from + 1);
+      unsigned char c2   = *(from + 2);
+      bool needsEncoding = is_escaped(map, c1) || is_escaped(map, c2);
+      if (!needsEncoding) {
+        out_len -= 2;
+        Debug("log-utils", "character already encoded..skipping %c, %c, %c", *from, *(from + 1), *(from + 2));
+        *to++ = *from++;
+        continue;
       }
-
-      *to++ = '%';
-      *to++ = hex_digit[c / 16];
-      *to++ = hex_digit[c % 16];
-    } else {
-      *to++ = *from;
     }
+
+    *to++ = '%';
+    *to++ = hex_digit[c / 16];
+    *to++ = hex_digit[c % 16];
     from++;
   }
   *to = '\0'; // null terminate string
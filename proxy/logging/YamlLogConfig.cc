@@ -121,7 +121,8 @@ std::set<std::string> valid_log_object_keys = {"filename",
                                                "rolling_min_count",
                                                "rolling_max_count",
                                                "rolling_allow_empty",
-                                               "pipe_buffer_size"};
+                                               "pipe_buffer_size",
+                                               "collector"};
 
 LogObject *
 YamlLogConfig::decodeLogObject(const YAML::Node &node)
@@ -161,6 +162,9 @@ YamlLogConfig::decodeLogObject(const YAML::Node &node)
     file_type        = (0 == strncasecmp(mode.c_str(), "bin", 3) || (1 == mode.size() && mode[0] == 'b') ?
                    LOG_FILE_BINARY :
                    (0 == strcasecmp(mode.c_str(), "ascii_pipe") ? LOG_FILE_PIPE : LOG_FILE_ASCII));
+    if (0 == strcasecmp(mode.c_str(), "columnar")) {
+      file_type = LOG_FILE_COLUMNAR;
+    }
   }
 
   int obj_rolling_enabled      = cfg->rolling_enabled;
@@ -222,6 +226,19 @@ YamlLogConfig::decodeLogObject(const YAML::Node &node)
                                  /* rolling_max_count */ obj_rolling_max_count, /* rolling_min_count */ obj_rolling_min_count,
                                  /* reopen_after_rolling */ obj_rolling_allow_empty > 0, pipe_buffer_size);
 
+  // stream to a collector, the file only gets what the collector can not keep up with
+  if (node["collector"]) {
+    std::string collector = node["collector"].as<std::string>();
+    std::string host;
+    int port;
+    if (LogStream::parse_collector(collector.c_str(), host, port)) {
+      logObject->set_collector(collector.c_str());
+    } else {
+      Warning("Invalid collector '%s' for log %s, it should be host:port; logging to the file only", collector.c_str(),
+              filename.c_str());
+    }
+  }
+
   // Generate LogDeletingInfo entry for later use
   std::string ext;
   switch (file_type) {
@@ -234,6 +251,9 @@ YamlLogConfig::decodeLogObject(const YAML::Node &node)
   case LOG_FILE_BINARY:
     ext = LOG_FILE_BINARY_OBJECT_FILENAME_EXTENSION;
     break;
+  case LOG_FILE_COLUMNAR:
+    ext = LOG_FILE_COLUMNAR_OBJECT_FILENAME_EXTENSION;
+    break;
   default:
     break;
   }
@@ -0,0 +1,136 @@
+/** @file
+
+  Unit tests for the columnar log file format.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "LogColumnar.h"
+#include "LogFormat.h"
+
+#include <cstring>
+#include <string>
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+namespace
+{
+// Two fields, "<method> <status>", as the printf string of a LogFormat has them.
+const std::string printf_str = std::string{LOG_FIELD_MARKER} + " " + LOG_FIELD_MARKER;
+
+void
+fill(LogColumnarBlock &block, int entries)
+{
+  block.reset(printf_str, "cqhm,pssc", 2);
+  block.set_timestamps(1000, 1005);
+  for (int i = 0; i < entries; ++i) {
+    std::string status         = std::to_string(200 + i % 3);
+    std::string_view values[2] = {i % 2 ? "GET" : "POST", status};
+    block.add_entry(values);
+  }
+}
+} // namespace
+
+TEST_CASE("LogColumnarBlock", "[logging][columnar]")
+{
+  LogColumnarBlock block;
+  fill(block, 100);
+  REQUIRE(block.entry_count() == 100);
+  CHECK(block.value(0, 1) == "GET");
+  CHECK(block.value(1, 5) == "202");
+
+  std::string raw;
+  block.encode(raw);
+  // Both columns repeat, they are stored with a dictionary, and an index of a byte per entry.
+  CHECK(raw.size() < 2 * 100 + 64);
+
+  LogColumnarBlock decoded;
+  REQUIRE(decoded.decode(raw));
+  CHECK(decoded.entry_count() == 100);
+  CHECK(decoded.column_count() == 2);
+
+  std::string text, expected;
+  decoded.to_ascii(text);
+  for (int i = 0; i < 100; ++i) {
+    expected += std::string{i % 2 ? "GET" : "POST"} + " " + std::to_string(200 + i % 3) + "\n";
+  }
+  CHECK(text == expected);
+
+  SECTION("distinct values are stored as they are")
+  {
+    LogColumnarBlock unique;
+    unique.reset(std::string{LOG_FIELD_MARKER}, "cqu", 1);
+    std::string urls;
+    for (int i = 0; i < 10; ++i) {
+      std::string url          = "/path/" + std::to_string(i);
+      std::string_view value[] = {url};
+      unique.add_entry(value);
+      urls += url + "\n";
+    }
+    std::string unique_raw, unique_text;
+    unique.encode(unique_raw);
+    REQUIRE(decoded.decode(unique_raw));
+    decoded.to_ascii(unique_text);
+    CHECK(unique_text == urls);
+  }
+
+  SECTION("corrupt blocks are rejected")
+  {
+    CHECK_FALSE(decoded.decode(std::string_view{raw}.substr(0, raw.size() - 1)));
+    CHECK_FALSE(decoded.decode(raw + "x"));
+    CHECK_FALSE(decoded.decode(""));
+  }
+}
+
+TEST_CASE("LogColumnarWriter", "[logging][columnar]")
+{
+  LogColumnarBlock block;
+  fill(block, 1000);
+  std::string raw;
+  block.encode(raw);
+
+  for (int level : {0, 3}) {
+    LogColumnarWriter writer(level);
+    LogColumnarReader reader;
+    std::string packed, unpacked;
+
+    writer.pack(raw, packed);
+    REQUIRE(packed.size() >= sizeof(LogColumnarHeader));
+
+    LogColumnarHeader header;
+    memcpy(&header, packed.data(), sizeof(header));
+    CHECK(header.cookie == LOG_COLUMNAR_COOKIE);
+    CHECK(header.version == LOG_COLUMNAR_VERSION);
+    CHECK(header.raw_size == raw.size());
+    REQUIRE(header.stored_size == packed.size() - sizeof(header));
+#ifdef HAVE_ZSTD_H
+    CHECK(header.compression == (level ? LogColumnarHeader::COMPRESSION_ZSTD : LogColumnarHeader::COMPRESSION_NONE));
+#else
+    CHECK(header.compression == LogColumnarHeader::COMPRESSION_NONE);
+#endif
+
+    std::string_view stored = std::string_view{packed}.substr(sizeof(header));
+    REQUIRE(reader.unpack(header, stored, unpacked));
+    CHECK(unpacked == raw);
+
+    header.stored_size += 1;
+    CHECK_FALSE(reader.unpack(header, stored, unpacked));
+  }
+}
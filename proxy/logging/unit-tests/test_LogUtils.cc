@@ -203,3 +203,25 @@ TEST_CASE("LogUtils escapify url", "[esc_url]")
     CHECK(std::string_view(output) == expected[i]);
   }
 }
+
+TEST_CASE("LogUtils escapify long url", "[esc_url]")
+{
+  // Each character, at each offset of a vector, with runs to skip over before and after it.
+  const std::string_view escaped{"\x01\x1f \"#%<>[\\]^`{|}~\x7f"};
+  char output[256];
+  int output_len;
+
+  for (int c = 1; c < 256; ++c) {
+    for (int offset = 0; offset < 20; ++offset) {
+      std::string url = std::string(offset, 'a') + static_cast<char>(c) + std::string(40, 'b');
+      std::string expected(url);
+      if (escaped.find(static_cast<char>(c)) != std::string_view::npos || c < 0x20) {
+        char hex[4];
+        snprintf(hex, sizeof(hex), "%%%02X", c);
+        expected.replace(offset, 1, hex);
+      }
+      LogUtils::pure_escapify_url(NULL, url.data(), url.size(), &output_len, output, sizeof(output));
+      REQUIRE(std::string_view(output, output_len) == expected);
+    }
+  }
+}
@@ -160,4 +160,7 @@ const std::unordered_map<std::string_view, std::tuple<const TSOverridableConfigK
      {"proxy.config.ssl.client.cert.path", {TS_CONFIG_SSL_CERT_FILEPATH, TS_RECORDDATATYPE_STRING}},
      {"proxy.config.ssl.client.private_key.filename", {TS_CONFIG_SSL_CLIENT_PRIVATE_KEY_FILENAME, TS_RECORDDATATYPE_STRING}},
      {"proxy.config.ssl.client.CA.cert.filename", {TS_CONFIG_SSL_CLIENT_CA_CERT_FILENAME, TS_RECORDDATATYPE_STRING}},
-     {"proxy.config.hostdb.ip_resolve", {TS_CONFIG_HTTP_HOST_RESOLUTION_PREFERENCE, TS_RECORDDATATYPE_STRING}}});
+     {"proxy.config.hostdb.ip_resolve", {TS_CONFIG_HTTP_HOST_RESOLUTION_PREFERENCE, TS_RECORDDATATYPE_STRING}},
+     {"proxy.config.net.pacing.rate", {TS_CONFIG_NET_PACING_RATE, TS_RECORDDATATYPE_INT}},
+     {"proxy.config.net.pacing.group", {TS_CONFIG_NET_PACING_GROUP, TS_RECORDDATATYPE_STRING}},
+     {"proxy.config.http.cache.vary_user_agent_class", {TS_CONFIG_HTTP_CACHE_VARY_USER_AGENT_CLASS, TS_RECORDDATATYPE_INT}}});
@@ -265,8 +265,7 @@ Stripe::validateMeta(StripeMeta const *meta)
 {
   // Need to be bit more robust at some point.
   return StripeMeta::MAGIC == meta->magic && meta->version._major <= ts::CACHE_DB_MAJOR_VERSION &&
-         meta->version._minor <= 2 // This may have always been zero, actually.
-    ;
+         meta->version._minor <= ts::CACHE_DB_MINOR_VERSION;
 }
 
 bool
@@ -418,13 +417,13 @@ dir_compare_tag(const CacheDirEntry *e, const CryptoHash *key)
 int
 vol_in_phase_valid(Stripe *d, CacheDirEntry *e)
 {
-  return (dir_offset(e) - 1 < ((d->_meta[0][0].write_pos + d->agg_buf_pos - d->_start) / CACHE_BLOCK_SIZE));
+  return (dir_offset(e) - 1 < ((d->_meta[0][0].write_pos + d->agg_buf_pos - d->_content) / CACHE_BLOCK_SIZE));
 }
 
 int
 vol_out_of_phase_valid(Stripe *d, CacheDirEntry *e)
 {
-  return (dir_offset(e) - 1 >= ((d->_meta[0][0].agg_pos - d->_start) / CACHE_BLOCK_SIZE));
+  return (dir_offset(e) - 1 >= ((d->_meta[0][0].agg_pos - d->_content) / CACHE_BLOCK_SIZE));
 }
 
 bool
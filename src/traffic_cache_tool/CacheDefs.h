@@ -70,7 +70,7 @@ namespace ts
   } while (0)
 
 constexpr static uint8_t CACHE_DB_MAJOR_VERSION = 24;
-constexpr static uint8_t CACHE_DB_MINOR_VERSION = 1;
+constexpr static uint8_t CACHE_DB_MINOR_VERSION = 3;
 /// Maximum allowed volume index.
 constexpr static int MAX_VOLUME_IDX          = 255;
 constexpr static int ENTRIES_PER_BUCKET      = 4;
@@ -162,6 +162,8 @@ public:
   uint16_t freelist[1];
 };
 
+constexpr uint32_t DOC_MAGIC = 0x5F129B13;
+
 struct Doc {
   uint32_t magic;     // DOC_MAGIC
   uint32_t len;       // length of this fragment (including hlen & sizeof(Doc), unrounded)
@@ -353,6 +355,7 @@ using ts::Errata;
 using ts::CacheDirEntry;
 using ts::MemSpan;
 using ts::Doc;
+using ts::DOC_MAGIC;
 
 constexpr int ESTIMATED_OBJECT_SIZE     = 8000;
 constexpr int DEFAULT_HW_SECTOR_SIZE    = 512;
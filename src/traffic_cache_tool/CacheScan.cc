@@ -27,51 +27,132 @@
 #include "../../proxy/hdrs/MIME.h"
 #include "../../proxy/hdrs/URL.h"
 
+#include <algorithm>
+#include <bitset>
+#include <vector>
+
 // using namespace ct;
 
 constexpr HdrHeapMarshalBlocks HTTP_ALT_MARSHAL_SIZE = ts::round_up(sizeof(HTTPCacheAlt));
 
 namespace ct
 {
-Errata
-CacheScan::Scan(bool search)
+namespace
 {
-  int64_t guessed_size = 1048576; // 1M
-  Errata zret;
+// The first read of a document, enough for the headers of most of them.
+constexpr int64_t DOC_READ_SIZE = 65536;
+// The output of a stripe is written once it is this large.
+constexpr size_t FLUSH_SIZE = 1 << 20;
+
+// The live entries of the directory of @a stripe, only the first fragments of the documents
+// with @a heads_only.
+std::vector<CacheDirEntry *>
+live_entries(Stripe *stripe, bool heads_only)
+{
+  std::vector<CacheDirEntry *> entries;
   std::bitset<65536> dir_bitset;
-  char *stripe_buff2 = static_cast<char *>(ats_memalign(ats_pagesize(), guessed_size));
-  for (int s = 0; s < this->stripe->_segments; s++) {
+  for (int s = 0; s < stripe->_segments; s++) {
     dir_bitset.reset();
-    for (int b = 0; b < this->stripe->_buckets; b++) {
-      CacheDirEntry *seg = this->stripe->dir_segment(s);
-      CacheDirEntry *e   = dir_bucket(b, seg);
+    CacheDirEntry *seg = stripe->dir_segment(s);
+    for (int b = 0; b < stripe->_buckets; b++) {
+      CacheDirEntry *e = dir_bucket(b, seg);
       if (dir_offset(e)) {
         do {
           // loop detected
           if (dir_bitset[dir_to_offset(e, seg)]) {
             break;
           }
-          int64_t size = dir_approx_size(e);
-          if (size > guessed_size) {
-            ats_free(stripe_buff2);
-            stripe_buff2 = static_cast<char *>(ats_memalign(ats_pagesize(), dir_approx_size(e)));
-          }
-          int fd         = this->stripe->_span->_fd;
-          int64_t offset = this->stripe->stripe_offset(e);
-          ssize_t n      = pread(fd, stripe_buff2, size, offset);
-          if (n < 0) {
-            std::cout << "Failed to read content from the Stripe.  " << strerror(errno) << std::endl;
-          } else {
-            Doc *doc = reinterpret_cast<Doc *>(stripe_buff2);
-            get_alternates(doc->hdr(), doc->hlen, search);
-          }
           dir_bitset[dir_to_offset(e, seg)] = true;
-          e                                 = next_dir(e, seg);
+          if ((!heads_only || dir_head(e)) && stripe->dir_valid(e)) {
+            entries.push_back(e);
+          }
+          e = next_dir(e, seg);
         } while (e);
       }
     }
   }
+  return entries;
+}
+} // namespace
+
+void
+ScanSink::write(std::string const &text)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  _out << text;
+}
+
+void
+CacheScan::flush(bool all)
+{
+  if (all || text.size() >= FLUSH_SIZE) {
+    sink->write(text);
+    text.clear();
+  }
+}
+
+Errata
+CacheScan::Scan(bool search)
+{
+  Errata zret;
+  int64_t buff_size  = DOC_READ_SIZE;
+  char *stripe_buff2 = static_cast<char *>(ats_memalign(ats_pagesize(), buff_size));
+  int fd             = this->stripe->_span->_fd;
+
+  // Read the documents in the order they are on disk, the reads are then close to sequential.
+  std::vector<CacheDirEntry *> entries = live_entries(this->stripe, true);
+  std::sort(entries.begin(), entries.end(), [](CacheDirEntry *a, CacheDirEntry *b) { return dir_offset(a) < dir_offset(b); });
+
+  for (auto e : entries) {
+    // Only the headers are needed, not the content of the first fragment.
+    int64_t size   = std::min<int64_t>(dir_approx_size(e), DOC_READ_SIZE);
+    int64_t offset = this->stripe->stripe_offset(e).count();
+    ssize_t n      = pread(fd, stripe_buff2, size, offset);
+    Doc *doc       = reinterpret_cast<Doc *>(stripe_buff2);
+    if (n >= static_cast<ssize_t>(sizeof(Doc)) && doc->magic == DOC_MAGIC && doc->prefix_len() > n &&
+        doc->prefix_len() <= dir_approx_size(e)) {
+      // Headers larger than the first read, read them all.
+      size = INK_ALIGN(doc->prefix_len(), CACHE_BLOCK_SIZE);
+      if (size > buff_size) {
+        ats_free(stripe_buff2);
+        buff_size    = size;
+        stripe_buff2 = static_cast<char *>(ats_memalign(ats_pagesize(), buff_size));
+      }
+      n   = pread(fd, stripe_buff2, size, offset);
+      doc = reinterpret_cast<Doc *>(stripe_buff2);
+    }
+    if (n < 0) {
+      std::cout << "Failed to read content from the Stripe.  " << strerror(errno) << std::endl;
+    } else if (n >= static_cast<ssize_t>(sizeof(Doc)) && doc->magic == DOC_MAGIC && doc->prefix_len() <= n) {
+      doc_offset = offset;
+      doc_size   = doc->total_len;
+      get_alternates(doc->hdr(), doc->hlen, search);
+    }
+  }
   ats_free(stripe_buff2);
+  flush(true);
+
+  return zret;
+}
+
+Errata
+CacheScan::ScanDir()
+{
+  Errata zret;
+  int64_t write_pos = this->stripe->_meta[0][0].write_pos;
+  int64_t content   = this->stripe->_content.count();
+  int64_t end       = (this->stripe->_start + Bytes(this->stripe->_len)).count();
+  std::string line;
+
+  for (auto e : live_entries(this->stripe, false)) {
+    int64_t offset = this->stripe->stripe_offset(e).count();
+    // How much the cache wrote since this fragment, it is evicted when that reaches the size of the stripe.
+    int64_t behind = offset < write_pos ? write_pos - offset : (end - offset) + (write_pos - content);
+    ts::bwprint(line, "{},{},{},{},{}\n", this->stripe->hashText, offset, dir_approx_size(e), dir_head(e), behind);
+    text += line;
+    flush(false);
+  }
+  flush(true);
 
   return zret;
 }
@@ -387,21 +468,36 @@ CacheScan::get_alternates(const char *buf, int length, bool search)
       if (check_url(doc_mem, url)) {
         std::string str;
 
-        if (search) {
+        if (search || inventory) {
           ts::bwprint(str, "{}://{}:{}/{};{}?{}", std::string_view(url->m_ptr_scheme, url->m_len_scheme),
                       std::string_view(url->m_ptr_host, url->m_len_host), std::string_view(url->m_ptr_port, url->m_len_port),
                       std::string_view(url->m_ptr_path, url->m_len_path), std::string_view(url->m_ptr_params, url->m_len_params),
                       std::string_view(url->m_ptr_query, url->m_len_query));
-          if (u_matcher->match(str.data())) {
-            str = this->stripe->hashText + " " + str;
-            std::cout << "match found " << str << std::endl;
+        }
+        if (!search || u_matcher->match(str.data())) {
+          if (inventory) {
+            // Quote the URL, doubling its quotes, it can have commas.
+            std::string quoted;
+            for (char c : str) {
+              quoted += c;
+              if (c == '"') {
+                quoted += c;
+              }
+            }
+            time_t age = a->m_response_received_time ? time(nullptr) - a->m_response_received_time : 0;
+            ts::bwprint(str, "{},{},{},{},\"{}\"\n", this->stripe->hashText, doc_offset, doc_size, age, quoted);
+            text += str;
+          } else if (search) {
+            text += "match found " + this->stripe->hashText + " " + str + "\n";
+          } else {
+            ts::bwprint(str, "stripe: {} : {}://{}:{}/{};{}?{}\n", std::string_view(this->stripe->hashText),
+                        std::string_view(url->m_ptr_scheme, url->m_len_scheme), std::string_view(url->m_ptr_host, url->m_len_host),
+                        std::string_view(url->m_ptr_port, url->m_len_port), std::string_view(url->m_ptr_path, url->m_len_path),
+                        std::string_view(url->m_ptr_params, url->m_len_params),
+                        std::string_view(url->m_ptr_query, url->m_len_query));
+            text += str;
           }
-        } else {
-          ts::bwprint(str, "stripe: {} : {}://{}:{}/{};{}?{}", std::string_view(this->stripe->hashText),
-                      std::string_view(url->m_ptr_scheme, url->m_len_scheme), std::string_view(url->m_ptr_host, url->m_len_host),
-                      std::string_view(url->m_ptr_port, url->m_len_port), std::string_view(url->m_ptr_path, url->m_len_path),
-                      std::string_view(url->m_ptr_params, url->m_len_params), std::string_view(url->m_ptr_query, url->m_len_query));
-          std::cout << str << std::endl;
+          flush(false);
         }
       } else {
         std::cerr << "The retrieved url object is invalid" << std::endl;
@@ -29,6 +29,8 @@
 
 #pragma once
 
+#include <mutex>
+#include <ostream>
 #include <thread>
 #include <unordered_map>
 #include "CacheDefs.h"
@@ -37,20 +39,43 @@
 // using namespace ct;
 namespace ct
 {
+/// Where the scans of the stripes write. The scans write whole lines, so the lines of the stripes
+/// scanned in parallel do not mix.
+class ScanSink
+{
+public:
+  explicit ScanSink(std::ostream &out) : _out(out) {}
+  void write(std::string const &text);
+
+private:
+  std::mutex _mutex;
+  std::ostream &_out;
+};
+
 class CacheScan
 {
   Stripe *stripe;
   url_matcher *u_matcher;
+  ScanSink *sink;
+  bool inventory = false; ///< Write CSV lines of stripe,offset,size,age,url instead of the listing.
+  std::string text;       ///< The output of the stripe not written to @a sink yet.
+  int64_t doc_offset = 0; ///< Offset in the span of the document being scanned.
+  uint64_t doc_size  = 0; ///< Total length of the document being scanned.
+
+  void flush(bool all);
 
 public:
-  CacheScan(Stripe *str, ts::file::path const &path) : stripe(str)
+  CacheScan(Stripe *str, ts::file::path const &path, ScanSink *out, bool csv = false) : stripe(str), sink(out), inventory(csv)
   {
     if (!path.empty()) {
       u_matcher = new url_matcher(path);
     }
   };
-  CacheScan(Stripe *str) : stripe(str) {}
+  CacheScan(Stripe *str, ScanSink *out, bool csv = false) : stripe(str), sink(out), inventory(csv) {}
   Errata Scan(bool search = false);
+  /// Write a CSV line of stripe,offset,approx_size,bytes_behind_write for each live entry of the
+  /// directory, without reading the documents.
+  Errata ScanDir();
   Errata get_alternates(const char *buf, int length, bool search);
   int unmarshal(HdrHeap *hh, int buf_length, int obj_type, HdrHeapObjImpl **found_obj, RefCountObj *block_ref);
   Errata unmarshal(char *buf, int len, RefCountObj *block_ref);
@@ -41,6 +41,9 @@
 #include "tscore/BufferWriter.h"
 #include "tscore/CryptoHash.h"
 #include "tscore/ArgParser.h"
+#include <algorithm>
+#include <atomic>
+#include <fstream>
 #include <thread>
 
 #include "CacheDefs.h"
@@ -1327,24 +1330,35 @@ Get_Response(ts::file::path const &input_file_path)
   }
 }
 
-void static scan_span(Span *span, ts::file::path const &regex_path)
+enum class ScanMode { LIST, INVENTORY, DIR };
+
+int scan_jobs = 0;
+ts::file::path scan_output;
+
+// Scans the stripes of @a stripes from @a next on until they run out, each scanning thread takes the next one.
+void static scan_stripes(std::vector<Stripe *> const &stripes, std::atomic<size_t> &next, ScanMode mode,
+                         ts::file::path const &regex_path, ScanSink &sink)
 {
-  for (auto strp : span->_stripes) {
+  for (size_t i = next++; i < stripes.size(); i = next++) {
+    Stripe *strp = stripes[i];
     strp->loadMeta();
     strp->loadDir();
 
-    if (!regex_path.empty()) {
-      CacheScan cs(strp, regex_path);
+    if (mode == ScanMode::DIR) {
+      CacheScan cs(strp, &sink, true);
+      cs.ScanDir();
+    } else if (!regex_path.empty()) {
+      CacheScan cs(strp, regex_path, &sink, mode == ScanMode::INVENTORY);
       cs.Scan(true);
     } else {
-      CacheScan cs(strp);
+      CacheScan cs(strp, &sink, mode == ScanMode::INVENTORY);
       cs.Scan(false);
     }
   }
 }
 
 void
-Scan_Cache(ts::file::path const &regex_path)
+Scan_Cache(ts::file::path const &regex_path, ScanMode mode)
 {
   Cache cache;
   std::vector<std::thread> threadPool;
@@ -1352,13 +1366,39 @@ Scan_Cache(ts::file::path const &regex_path)
     if (err.size()) {
       return;
     }
-    cache.dumpSpans(Cache::SpanDumpDepth::SPAN);
+    std::ofstream file;
+    if (!scan_output.empty()) {
+      file.open(scan_output.string());
+      if (!file) {
+        err.push(0, 1, "Cannot open ", scan_output.string(), " for writing the scan");
+        return;
+      }
+    } else {
+      cache.dumpSpans(Cache::SpanDumpDepth::SPAN);
+    }
+    std::ostream &out = scan_output.empty() ? std::cout : file;
+    if (mode == ScanMode::DIR) {
+      out << "stripe,offset,approx_size,head,bytes_behind_write\n";
+    } else if (mode == ScanMode::INVENTORY) {
+      out << "stripe,offset,size,age,url\n";
+    }
+
+    // The stripes of all the spans are scanned in parallel, not only the spans.
+    std::vector<Stripe *> stripes;
     for (auto sp : cache._spans) {
-      threadPool.emplace_back(scan_span, sp, regex_path);
+      stripes.insert(stripes.end(), sp->_stripes.begin(), sp->_stripes.end());
+    }
+    size_t jobs = scan_jobs > 0 ? scan_jobs : std::max(1U, std::thread::hardware_concurrency());
+    jobs        = std::min(jobs, stripes.size());
+    ScanSink sink(out);
+    std::atomic<size_t> next{0};
+    for (size_t i = 0; i < jobs; ++i) {
+      threadPool.emplace_back(scan_stripes, std::cref(stripes), std::ref(next), mode, std::cref(regex_path), std::ref(sink));
     }
     for (auto &th : threadPool) {
       th.join();
     }
+    out.flush();
   }
 }
 
@@ -1376,7 +1416,9 @@ main(int argc, const char *argv[])
     .add_option("--write", "-w", "")
     .add_option("--input", "-i", "", "", 1)
     .add_option("--device", "-d", "", "", 1)
-    .add_option("--aos", "-o", "", "", 1);
+    .add_option("--aos", "-o", "", "", 1)
+    .add_option("--jobs", "-j", "Threads scanning stripes, by default one per CPU", "", 1)
+    .add_option("--output", "-O", "File the scan writes to instead of the standard output", "", 1);
 
   parser.add_command("list", "List elements of the cache", []() { List_Stripes(Cache::SpanDumpDepth::SPAN); })
     .add_command("stripes", "List the stripes", []() { List_Stripes(Cache::SpanDumpDepth::STRIPE); });
@@ -1395,8 +1437,12 @@ main(int argc, const char *argv[])
   parser.add_command("clearspan", "clear specific span").add_command("span", "device path", [&]() { Clear_Span(inputFile); });
   parser.add_command("retrieve", " retrieve the response of the given list of URLs", [&]() { Get_Response(input_url_file); });
   parser.add_command("init", " Initializes uninitialized span", [&]() { Init_disk(input_url_file); });
-  parser.add_command("scan", " Scans the whole cache and lists the urls of the cached contents",
-                     [&]() { Scan_Cache(input_url_file); });
+  auto &scan = parser.add_command("scan", " Scans the whole cache and lists the urls of the cached contents",
+                                  [&]() { Scan_Cache(input_url_file, ScanMode::LIST); });
+  scan.add_command("inventory", "CSV of the stripe, offset, size, age and url of the cached contents",
+                   [&]() { Scan_Cache(input_url_file, ScanMode::INVENTORY); });
+  scan.add_command("dir", "CSV of the directory entries, reading only the directories",
+                   [&]() { Scan_Cache(input_url_file, ScanMode::DIR); });
 
   // parse the arguments
   auto arguments = parser.parse(argv);
@@ -1412,6 +1458,12 @@ main(int argc, const char *argv[])
   if (auto data = arguments.get("aos")) {
     cache_config_min_average_object_size = std::stoi(data.value());
   }
+  if (auto data = arguments.get("jobs")) {
+    scan_jobs = std::stoi(data.value());
+  }
+  if (auto data = arguments.get("output")) {
+    scan_output = data.value();
+  }
   if (auto data = arguments.get("device")) {
     inputFile = data.value();
   }
@@ -220,13 +220,16 @@ format_record(const CtrlMgmtRecord &record, bool recfmt)
 void
 CtrlEngine::config_get()
 {
-  for (const auto &it : arguments.get("get")) {
-    CtrlMgmtRecord record;
-    TSMgmtError error;
+  auto args = arguments.get("get");
+  CtrlMgmtRecordList reclist;
 
-    error = record.fetch(it.c_str());
-    if (error != TS_ERR_OKAY) {
-      CtrlMgmtError(error, "failed to fetch %s", it.c_str());
+  CTRL_MGMT_CHECK(reclist.fetch(std::vector<std::string>(args.begin(), args.end())));
+
+  while (!reclist.empty()) {
+    CtrlMgmtRecord record(reclist.next());
+
+    if (record.type() == TS_REC_UNDEFINED) {
+      CtrlMgmtError(TS_ERR_PARAMS, "failed to fetch %s", record.name());
       status_code = CTRL_EX_ERROR;
       return;
     }
@@ -23,17 +23,81 @@
 
 #include "traffic_ctl.h"
 #include "records/P_RecUtils.h"
+#include "records/I_RecProcess.h"
+#include "records/I_RecStatsShm.h"
+#include "tscore/I_Layout.h"
+#include "tscore/Regex.h"
+
+// The stats exported by traffic_server are not used once they have not been updated for this long.
+static const time_t SHM_MAX_AGE = 60;
+
+// Map the stats exported by traffic_server. @return false if they are not there or not current.
+static bool
+open_stats_shm(RecStatsShmReader &reader)
+{
+  ats_scoped_str rundir(RecConfigReadRuntimeDir());
+
+  return reader.open(Layout::relative_to(rundir.get(), REC_STATS_SHM_FILE).c_str()) &&
+         time(nullptr) - reader.updated() <= SHM_MAX_AGE;
+}
+
+// Print a stat the way CtrlMgmtRecordValue formats it.
+static void
+print_stat(const RecStatsShmReader::Stat &stat)
+{
+  std::cout << stat.name << ' ';
+  switch (stat.data_type) {
+  case RECD_INT:
+  case RECD_COUNTER:
+    std::cout << stat.data.rec_int;
+    break;
+  case RECD_FLOAT: {
+    char buf[64];
+    snprintf(buf, sizeof(buf), "%f", stat.data.rec_float);
+    std::cout << buf;
+    break;
+  }
+  case RECD_STRING:
+    std::cout << (stat.string_value.empty() ? "\"\"" : stat.string_value);
+    break;
+  default:
+    std::cout << "(invalid)";
+    break;
+  }
+  std::cout << std::endl;
+}
 
 void
 CtrlEngine::metric_get()
 {
-  for (const auto &it : arguments.get("get")) {
-    CtrlMgmtRecord record;
-    TSMgmtError error;
+  RecStatsShmReader reader;
+  bool shm  = open_stats_shm(reader);
+  auto args = arguments.get("get");
+  std::vector<RecStatsShmReader::Stat> stats(args.size());
+  std::vector<bool> in_shm(args.size());
+  std::vector<std::string> names;
+  CtrlMgmtRecordList reclist;
+
+  // Whatever the shared memory does not have is fetched in a single request.
+  for (unsigned i = 0; i < args.size(); ++i) {
+    in_shm[i] = shm && reader.find(args.at(i), stats[i]);
+    if (!in_shm[i]) {
+      names.push_back(args.at(i));
+    }
+  }
+  if (!names.empty()) {
+    CTRL_MGMT_CHECK(reclist.fetch(names));
+  }
 
-    error = record.fetch(it.c_str());
-    if (error != TS_ERR_OKAY) {
-      CtrlMgmtError(error, "failed to fetch %s", it.c_str());
+  for (unsigned i = 0; i < args.size(); ++i) {
+    if (in_shm[i]) {
+      print_stat(stats[i]);
+      continue;
+    }
+
+    CtrlMgmtRecord record(reclist.empty() ? TSRecordEleCreate() : reclist.next());
+    if (record.type() == TS_REC_UNDEFINED) {
+      CtrlMgmtError(TS_ERR_PARAMS, "failed to fetch %s", args.at(i).c_str());
       status_code = CTRL_EX_ERROR;
       return;
     }
@@ -47,6 +111,28 @@ CtrlEngine::metric_get()
 void
 CtrlEngine::metric_match()
 {
+  RecStatsShmReader reader;
+
+  if (open_stats_shm(reader)) {
+    for (const auto &it : arguments.get("match")) {
+      DFA regex;
+
+      // the same match as the records do for the management API
+      if (regex.compile(it, RE_CASE_INSENSITIVE | RE_UNANCHORED) == 0) {
+        fprintf(stderr, "%s: invalid regular expression %s\n", program_name, it.c_str());
+        status_code = CTRL_EX_ERROR;
+        return;
+      }
+      for (uint32_t idx = 0, count = reader.count(); idx < count; ++idx) {
+        RecStatsShmReader::Stat stat;
+        if (reader.read(idx, stat) && regex.match(stat.name) >= 0) {
+          print_stat(stat);
+        }
+      }
+    }
+    return;
+  }
+
   for (const auto &it : arguments.get("match")) {
     CtrlMgmtRecordList reclist;
     TSMgmtError error;
@@ -23,6 +23,10 @@
 
 #include "traffic_ctl.h"
 
+#include <algorithm>
+#include <iomanip>
+#include <vector>
+
 void
 CtrlEngine::server_restart()
 {
@@ -77,6 +81,33 @@ CtrlEngine::server_status()
     std::cout << "Proxy status undefined" << std::endl;
     break;
   }
+
+  // The startup milestones of traffic_server, in the order they were reached.
+  constexpr std::string_view prefix = "proxy.process.startup.";
+  constexpr std::string_view suffix = "_ms";
+  CtrlMgmtRecordList reclist;
+  std::vector<std::pair<int64_t, std::string>> milestones;
+
+  if (reclist.match("^proxy\\.process\\.startup\\.") != TS_ERR_OKAY) {
+    return;
+  }
+  while (!reclist.empty()) {
+    CtrlMgmtRecord record(reclist.next());
+    std::string_view name{record.name()};
+
+    if (name.size() > prefix.size() + suffix.size() && name.substr(name.size() - suffix.size()) == suffix) {
+      milestones.emplace_back(record.as_int(), name.substr(prefix.size(), name.size() - prefix.size() - suffix.size()));
+    }
+  }
+  if (milestones.empty()) {
+    return;
+  }
+
+  std::sort(milestones.begin(), milestones.end());
+  std::cout << "Startup:" << std::endl;
+  for (const auto &[ms, name] : milestones) {
+    std::cout << "  " << std::left << std::setw(16) << name << std::right << std::setw(8) << ms << " ms" << std::endl;
+  }
 }
 
 void
@@ -134,3 +165,38 @@ CtrlEngine::server_drain()
     return;
   }
 }
+
+void
+CtrlEngine::server_hugepages()
+{
+  struct {
+    const char *label;
+    const char *metric;
+    int64_t bytes;
+  } kinds[] = {
+    {"1GB pages", "proxy.process.allocator.hugepage_arena.1g_bytes", 0},
+    {"2MB pages", "proxy.process.allocator.hugepage_arena.2m_bytes", 0},
+    {"transparent", "proxy.process.allocator.hugepage_arena.transparent_bytes", 0},
+    {"normal pages", "proxy.process.allocator.hugepage_arena.normal_bytes", 0},
+  };
+  int64_t total = 0;
+
+  for (auto &kind : kinds) {
+    CtrlMgmtRecord record;
+    TSMgmtError error = record.fetch(kind.metric);
+    if (error != TS_ERR_OKAY) {
+      CtrlMgmtError(error, "failed to fetch %s", kind.metric);
+      status_code = CTRL_EX_ERROR;
+      return;
+    }
+    kind.bytes = record.as_int();
+    total += kind.bytes;
+  }
+
+  std::cout << "Huge page arenas: " << total << " bytes" << std::endl;
+  for (const auto &kind : kinds) {
+    double pct = total ? 100.0 * kind.bytes / total : 0.0;
+    std::cout << "  " << std::left << std::setw(14) << kind.label << std::right << std::setw(16) << kind.bytes << " bytes "
+              << std::fixed << std::setprecision(1) << std::setw(5) << pct << '%' << std::endl;
+  }
+}
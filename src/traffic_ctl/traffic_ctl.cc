@@ -71,6 +71,20 @@ CtrlMgmtRecordList::match(const char *name)
   return TSRecordGetMatchMlt(name, this->list);
 }
 
+TSMgmtError
+CtrlMgmtRecordList::fetch(const std::vector<std::string> &names)
+{
+  TSStringList patterns = TSStringListCreate();
+  TSMgmtError error;
+
+  for (const auto &name : names) {
+    TSStringListEnqueue(patterns, ats_strdup(name.c_str()));
+  }
+  error = TSRecordGetBatch(TS_RECORD_MATCH_NAME, patterns, this->list);
+  TSStringListDestroy(patterns);
+  return error;
+}
+
 CtrlMgmtRecordValue::CtrlMgmtRecordValue(const CtrlMgmtRecord &rec)
 {
   this->init(rec.ele->rec_type, rec.ele->valueT);
@@ -252,6 +266,8 @@ main(int argc, const char **argv)
     .add_example_usage("traffic_ctl server drain [OPTIONS]")
     .add_option("--no-new-connection", "-N", "Wait for new connections down to threshold before starting draining")
     .add_option("--undo", "-U", "Recover server from the drain mode");
+  server_command.add_command("hugepages", "Show how much of the huge page arena memory is on huge pages",
+                             [&]() { engine.server_hugepages(); });
 
   // storage commands
   storage_command
@@ -160,6 +160,8 @@ template <typename T> struct CtrlMgmtList {
 
 struct CtrlMgmtRecordList : CtrlMgmtList<RecordListPolicy> {
   TSMgmtError match(const char *);
+  // Fetch the named records in a single request, a name that is not a record comes back as a TS_REC_UNDEFINED record.
+  TSMgmtError fetch(const std::vector<std::string> &);
 };
 
 // this is a engine for traffic_ctl containing the ArgParser and all the methods
@@ -214,6 +216,7 @@ struct CtrlEngine {
   void server_stop();
   void server_start();
   void server_drain();
+  void server_hugepages();
 
   // storage methods
   void storage_offline();
@@ -42,6 +42,14 @@
 #include <brotli/encode.h>
 #endif
 
+#if HAVE_ZSTD_H
+#include <zstd.h>
+#endif
+
+#if HAVE_LZ4_H
+#include <lz4.h>
+#endif
+
 // Produce output about compile time features, useful for checking how things were built
 static void
 print_feature(std::string_view name, int value, bool json, bool last = false)
@@ -89,6 +97,16 @@ produce_features(bool json)
 #else
   print_feature("TS_HAS_BROTLI", 0, json);
 #endif
+#if HAVE_ZSTD_H
+  print_feature("TS_HAS_ZSTD", 1, json);
+#else
+  print_feature("TS_HAS_ZSTD", 0, json);
+#endif
+#if HAVE_LZ4_H
+  print_feature("TS_HAS_LZ4", 1, json);
+#else
+  print_feature("TS_HAS_LZ4", 0, json);
+#endif
 #ifdef F_GETPIPE_SZ
   print_feature("TS_HAS_PIPE_BUFFER_SIZE_CONFIG", 1, json);
 #else
@@ -112,6 +130,7 @@ produce_features(bool json)
   print_feature("TS_USE_SET_RBIO", TS_USE_SET_RBIO, json);
   print_feature("TS_USE_TLS13", TS_USE_TLS13, json);
   print_feature("TS_USE_LINUX_NATIVE_AIO", TS_USE_LINUX_NATIVE_AIO, json);
+  print_feature("TS_USE_LINUX_IO_URING", TS_USE_LINUX_IO_URING, json);
   print_feature("TS_HAS_SO_PEERCRED", TS_HAS_SO_PEERCRED, json);
   print_feature("TS_USE_REMOTE_UNWINDING", TS_USE_REMOTE_UNWINDING, json);
   print_feature("TS_USE_TLS_OCSP", TS_USE_TLS_OCSP, json);
@@ -208,6 +227,18 @@ produce_versions(bool json)
 #else
   print_var("brotli", undef, json);
 #endif
+#if HAVE_ZSTD_H
+  print_var("zstd", LBW().print("{}", ZSTD_VERSION_STRING).view(), json);
+  print_var("zstd.run", LBW().print("{}", ZSTD_versionString()).view(), json);
+#else
+  print_var("zstd", undef, json);
+#endif
+#if HAVE_LZ4_H
+  print_var("lz4", LBW().print("{}", LZ4_VERSION_STRING).view(), json);
+  print_var("lz4.run", LBW().print("{}", LZ4_versionString()).view(), json);
+#else
+  print_var("lz4", undef, json);
+#endif
 
   // This should always be last
   print_var("traffic-server", LBW().print(TS_VERSION_STRING).view(), json, true);
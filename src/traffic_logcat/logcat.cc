@@ -41,9 +41,12 @@
 #include "LogObject.h"
 #include "LogConfig.h"
 #include "LogBuffer.h"
+#include "LogColumnar.h"
 #include "LogUtils.h"
 #include "Log.h"
 
+#include <string>
+
 // logcat-specific command-line flags
 static int squid_flag              = 0;
 static int follow_flag             = 0;
@@ -114,6 +117,65 @@ follow_rotate(const char *input_file, ino_t old_inode_num)
   }
 }
 
+/*
+ * Reads exactly @a size bytes, waiting for them if following the file
+ *
+ * @returns false if the file ends first
+ */
+static bool
+read_fully(int in_fd, char *buf, size_t size)
+{
+  size_t nread = 0;
+  while (nread < size) {
+    ssize_t rc = read(in_fd, buf + nread, size - nread);
+
+    if (rc > 0) {
+      nread += rc;
+    } else if (!follow_flag) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/*
+ * Converts a block of a columnar log to ascii entries, once the first 8 bytes of its header are read
+ *
+ * @returns 0 on success, otherwise 1
+ */
+static int
+process_columnar_block(int in_fd, int out_fd, const char *first_bytes, unsigned first_read_size)
+{
+  static LogColumnarReader reader;
+  LogColumnarHeader header;
+  LogColumnarBlock block;
+  std::string stored, raw, text;
+
+  memcpy(&header, first_bytes, first_read_size);
+  if (!read_fully(in_fd, reinterpret_cast<char *>(&header) + first_read_size, sizeof(header) - first_read_size)) {
+    fprintf(stderr, "Bad columnar block header read!\n");
+    return 1;
+  }
+  if (header.stored_size > MAX_LOGBUFFER_SIZE * 1024) {
+    fprintf(stderr, "Columnar block too large!\n");
+    return 1;
+  }
+
+  stored.resize(header.stored_size);
+  if (!read_fully(in_fd, &stored[0], stored.size())) {
+    fprintf(stderr, "Bad columnar block read!\n");
+    return 1;
+  }
+  if (!reader.unpack(header, stored, raw) || !block.decode(raw)) {
+    fprintf(stderr, "Bad columnar block! (compression %u)\n", header.compression);
+    return 1;
+  }
+
+  block.to_ascii(text);
+  LogFile::writeln(&text[0], text.size(), out_fd, ".");
+  return 0;
+}
+
 static int
 process_file(int in_fd, int out_fd)
 {
@@ -139,6 +201,15 @@ process_file(int in_fd, int out_fd)
       return 0;
     }
 
+    // a columnar log has a header of its own, with the same first 8 bytes
+    //
+    if (nread == static_cast<int>(first_read_size) && header->cookie == LOG_COLUMNAR_COOKIE) {
+      if (process_columnar_block(in_fd, out_fd, buffer, first_read_size) != 0) {
+        return 1;
+      }
+      continue;
+    }
+
     // ensure that this is a valid logbuffer header
     //
     if (header->cookie != LOG_SEGMENT_COOKIE) {
@@ -294,8 +365,9 @@ main(int /* argc ATS_UNUSED */, const char *argv[])
   int error = NO_ERROR;
 
   if (n_file_arguments) {
-    int bin_ext_len   = strlen(LOG_FILE_BINARY_OBJECT_FILENAME_EXTENSION);
-    int ascii_ext_len = strlen(LOG_FILE_ASCII_OBJECT_FILENAME_EXTENSION);
+    int bin_ext_len      = strlen(LOG_FILE_BINARY_OBJECT_FILENAME_EXTENSION);
+    int columnar_ext_len = strlen(LOG_FILE_COLUMNAR_OBJECT_FILENAME_EXTENSION);
+    int ascii_ext_len    = strlen(LOG_FILE_ASCII_OBJECT_FILENAME_EXTENSION);
 
     for (unsigned i = 0; i < n_file_arguments; ++i) {
       int in_fd = open(file_arguments[i], O_RDONLY);
@@ -316,13 +388,17 @@ main(int /* argc ATS_UNUSED */, const char *argv[])
         posix_fadvise(in_fd, 0, 0, POSIX_FADV_SEQUENTIAL);
 #endif
         if (auto_filenames) {
-          // change .blog to .log
+          // change .blog or .clog to .log
           //
           int n = strlen(file_arguments[i]);
           int copy_len =
             (n >= bin_ext_len ?
                (strcmp(&file_arguments[i][n - bin_ext_len], LOG_FILE_BINARY_OBJECT_FILENAME_EXTENSION) == 0 ? n - bin_ext_len : n) :
                n);
+          if (copy_len == n && n >= columnar_ext_len &&
+              strcmp(&file_arguments[i][n - columnar_ext_len], LOG_FILE_COLUMNAR_OBJECT_FILENAME_EXTENSION) == 0) {
+            copy_len = n - columnar_ext_len;
+          }
 
           char *out_filename = (char *)ats_malloc(copy_len + ascii_ext_len + 1);
 
@@ -57,6 +57,11 @@
 #include <unordered_map>
 #include <unordered_set>
 #include <string_view>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <cstddef>
+#include <sys/mman.h>
 
 #ifndef _XOPEN_SOURCE
 #define _XOPEN_SOURCE 600
@@ -118,8 +123,21 @@ struct ElapsedStats {
   float stddev;
 };
 
+// Approximate latency percentiles: a histogram with buckets exact below 8ms, and 8 buckets per
+// power of two above, so any percentile is within 1/16 of the latency. Histograms add up, which
+// lets the threads of a parallel run merge theirs.
+const int LATENCY_SUB_BITS = 3;
+const int LATENCY_SUBS     = 1 << LATENCY_SUB_BITS;
+const int LATENCY_BUCKETS  = LATENCY_SUBS * (32 - LATENCY_SUB_BITS);
+
+struct LatencySketch {
+  int64_t hits[LATENCY_BUCKETS];
+  int64_t misses[LATENCY_BUCKETS];
+};
+
 struct OriginStats {
   const char *server;
+  LatencySketch *latency; // Only with --percentiles
   StatsCounter total;
 
   struct {
@@ -587,12 +605,13 @@ private:
 };
 
 ///////////////////////////////////////////////////////////////////////////////
-// Globals, holding the accumulated stats (ok, I'm lazy ...)
-static OriginStats totals;
-static OriginStorage origins;
+// Globals, holding the accumulated stats (ok, I'm lazy ...). The stats are per thread, the threads
+// of a parallel run merge theirs into those of the main thread when done.
+static thread_local OriginStats totals;
+static thread_local OriginStorage origins;
 static OriginSet *origin_set;
 static UrlLru *urls;
-static int parse_errors;
+static thread_local int parse_errors;
 
 // Command line arguments (parsing)
 struct CommandLineArgs {
@@ -615,6 +634,8 @@ struct CommandLineArgs {
   int concise         = 0; // Eliminate metrics that can be inferred by other values
   int report_per_user = 0; // A flag to aggregate and report stats per user instead of per host if 'true' (default 'false')
   int no_format_check = 0; // A flag to skip the log format check if any of the fields is not a standard squid log format field.
+  int threads         = 1; // Threads parsing the log file
+  int percentiles     = 0; // Show latency percentiles
 
   CommandLineArgs() : line_len(DEFAULT_LINE_LEN)
 
@@ -651,6 +672,8 @@ static ArgumentDescription argument_descriptions[] = {
   {"debug_tags", 'T', "Colon-Separated Debug Tags", "S1023", &error_tags, nullptr, nullptr},
   {"report_per_user", 'r', "Report stats per user instead of host", "T", &cl.report_per_user, nullptr, nullptr},
   {"no_format_check", 'n', "Don't validate the log format field names", "T", &cl.no_format_check, nullptr, nullptr},
+  {"threads", 'p', "Parse the log file with this many threads", "I", &cl.threads, nullptr, nullptr},
+  {"percentiles", 'P', "Show latency percentiles of hits and misses", "T", &cl.percentiles, nullptr, nullptr},
   HELP_ARGUMENT_DESCRIPTION(),
   VERSION_ARGUMENT_DESCRIPTION(),
   RUNROOT_ARGUMENT_DESCRIPTION()};
@@ -856,6 +879,99 @@ update_elapsed(ElapsedStats &stat, const int elapsed, const StatsCounter &counte
   stat.avg    = newavg;
 }
 
+// Adds the elapsed stats of @a other_count other requests to those of @a count requests. Like
+// update_elapsed(), the averages are over all the requests, the ones that took no time too.
+void
+merge_elapsed(ElapsedStats &stat, int64_t count, const ElapsedStats &other, int64_t other_count)
+{
+  int64_t newcount = count + other_count;
+
+  if (0 == newcount) {
+    return;
+  }
+  if (-1 != other.min) {
+    if (-1 == stat.min || stat.min > other.min) {
+      stat.min = other.min;
+    }
+    if (stat.max < other.max) {
+      stat.max = other.max;
+    }
+  }
+
+  // Combine the sums of squares of the two sets, around the new average.
+  float delta          = other.avg - stat.avg;
+  float newavg         = stat.avg + delta * other_count / newcount;
+  float sum_of_squares = stat.stddev * stat.stddev * count + other.stddev * other.stddev * other_count +
+                         delta * delta * count * other_count / newcount;
+
+  stat.stddev = sqrt(sum_of_squares / newcount);
+  stat.avg    = newavg;
+}
+
+// The histogram bucket of a latency, see LatencySketch.
+inline int
+latency_bucket(int elapsed)
+{
+  if (elapsed < LATENCY_SUBS) {
+    return elapsed;
+  }
+
+  int exp = 31 - __builtin_clz(elapsed);
+
+  return LATENCY_SUBS * (exp - LATENCY_SUB_BITS + 1) + ((elapsed >> (exp - LATENCY_SUB_BITS)) & (LATENCY_SUBS - 1));
+}
+
+// The latency in the middle of a histogram bucket.
+inline int64_t
+latency_of_bucket(int bucket)
+{
+  if (bucket < LATENCY_SUBS) {
+    return bucket;
+  }
+
+  int shift = bucket / LATENCY_SUBS - 1;
+
+  return (static_cast<int64_t>(LATENCY_SUBS + bucket % LATENCY_SUBS) << shift) + (static_cast<int64_t>(1) << shift) / 2;
+}
+
+inline void
+update_latency(LatencySketch *sketch, bool hit, int elapsed)
+{
+  // Skip the "0" values, like update_elapsed() does.
+  if (sketch && elapsed > 0) {
+    (hit ? sketch->hits : sketch->misses)[latency_bucket(elapsed)]++;
+  }
+}
+
+// The @a quantile (0 - 1) of the latencies in a histogram, -1 when it is empty.
+int64_t
+latency_percentile(const int64_t *buckets, double quantile)
+{
+  int64_t count = 0;
+
+  for (int i = 0; i < LATENCY_BUCKETS; ++i) {
+    count += buckets[i];
+  }
+  if (0 == count) {
+    return -1;
+  }
+
+  int64_t rank = std::max(static_cast<int64_t>(1), static_cast<int64_t>(ceil(quantile * count)));
+
+  for (int i = 0; i < LATENCY_BUCKETS; ++i) {
+    if ((rank -= buckets[i]) <= 0) {
+      return latency_of_bucket(i);
+    }
+  }
+  return latency_of_bucket(LATENCY_BUCKETS - 1);
+}
+
+inline LatencySketch *
+new_latency_sketch()
+{
+  return cl.percentiles ? static_cast<LatencySketch *>(ats_calloc(1, sizeof(LatencySketch))) : nullptr;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // Update the "result" and "elapsed" stats for a particular record
 inline void
@@ -867,42 +983,49 @@ update_results_elapsed(OriginStats *stat, int result, int elapsed, int size)
     update_counter(stat->results.hits.total, size);
     update_elapsed(stat->elapsed.hits.hit, elapsed, stat->results.hits.hit);
     update_elapsed(stat->elapsed.hits.total, elapsed, stat->results.hits.total);
+    update_latency(stat->latency, true, elapsed);
     break;
   case SQUID_LOG_TCP_MEM_HIT:
     update_counter(stat->results.hits.hit_ram, size);
     update_counter(stat->results.hits.total, size);
     update_elapsed(stat->elapsed.hits.hit_ram, elapsed, stat->results.hits.hit_ram);
     update_elapsed(stat->elapsed.hits.total, elapsed, stat->results.hits.total);
+    update_latency(stat->latency, true, elapsed);
     break;
   case SQUID_LOG_TCP_MISS:
     update_counter(stat->results.misses.miss, size);
     update_counter(stat->results.misses.total, size);
     update_elapsed(stat->elapsed.misses.miss, elapsed, stat->results.misses.miss);
     update_elapsed(stat->elapsed.misses.total, elapsed, stat->results.misses.total);
+    update_latency(stat->latency, false, elapsed);
     break;
   case SQUID_LOG_TCP_IMS_HIT:
     update_counter(stat->results.hits.ims, size);
     update_counter(stat->results.hits.total, size);
     update_elapsed(stat->elapsed.hits.ims, elapsed, stat->results.hits.ims);
     update_elapsed(stat->elapsed.hits.total, elapsed, stat->results.hits.total);
+    update_latency(stat->latency, true, elapsed);
     break;
   case SQUID_LOG_TCP_IMS_MISS:
     update_counter(stat->results.misses.ims, size);
     update_counter(stat->results.misses.total, size);
     update_elapsed(stat->elapsed.misses.ims, elapsed, stat->results.misses.ims);
     update_elapsed(stat->elapsed.misses.total, elapsed, stat->results.misses.total);
+    update_latency(stat->latency, false, elapsed);
     break;
   case SQUID_LOG_TCP_REFRESH_HIT:
     update_counter(stat->results.hits.refresh, size);
     update_counter(stat->results.hits.total, size);
     update_elapsed(stat->elapsed.hits.refresh, elapsed, stat->results.hits.refresh);
     update_elapsed(stat->elapsed.hits.total, elapsed, stat->results.hits.total);
+    update_latency(stat->latency, true, elapsed);
     break;
   case SQUID_LOG_TCP_REFRESH_MISS:
     update_counter(stat->results.misses.refresh, size);
     update_counter(stat->results.misses.total, size);
     update_elapsed(stat->elapsed.misses.refresh, elapsed, stat->results.misses.refresh);
     update_elapsed(stat->elapsed.misses.total, elapsed, stat->results.misses.total);
+    update_latency(stat->latency, false, elapsed);
     break;
   case SQUID_LOG_TCP_DISK_HIT:
   case SQUID_LOG_TCP_REF_FAIL_HIT:
@@ -913,6 +1036,7 @@ update_results_elapsed(OriginStats *stat, int result, int elapsed, int size)
     update_counter(stat->results.hits.total, size);
     update_elapsed(stat->elapsed.hits.other, elapsed, stat->results.hits.other);
     update_elapsed(stat->elapsed.hits.total, elapsed, stat->results.hits.total);
+    update_latency(stat->latency, true, elapsed);
     break;
   case SQUID_LOG_TCP_EXPIRED_MISS:
   case SQUID_LOG_TCP_WEBFETCH_MISS:
@@ -921,6 +1045,7 @@ update_results_elapsed(OriginStats *stat, int result, int elapsed, int size)
     update_counter(stat->results.misses.total, size);
     update_elapsed(stat->elapsed.misses.other, elapsed, stat->results.misses.other);
     update_elapsed(stat->elapsed.misses.total, elapsed, stat->results.misses.total);
+    update_latency(stat->latency, false, elapsed);
     break;
   case SQUID_LOG_ERR_CLIENT_ABORT:
     update_counter(stat->results.errors.client_abort, size);
@@ -1200,6 +1325,7 @@ find_or_create_stats(const char *key)
       o_stats = static_cast<OriginStats *>(ats_malloc(sizeof(OriginStats)));
       memset(o_stats, 0, sizeof(OriginStats));
       init_elapsed(o_stats);
+      o_stats->latency = new_latency_sketch();
       o_server = ats_strdup(key);
       if (o_server) {
         o_stats->server   = o_server;
@@ -1234,12 +1360,61 @@ update_stats(OriginStats *o_stats, const HTTPMethod method, URLScheme scheme, in
   }
 }
 
+///////////////////////////////////////////////////////////////////////////////
+// Add the stats of one thread to those of another
+void
+merge_stats(OriginStats *stat, const OriginStats *other)
+{
+  // The elapsed stats first, they need the counts from before the merge.
+  merge_elapsed(stat->elapsed.hits.hit, stat->results.hits.hit.count, other->elapsed.hits.hit, other->results.hits.hit.count);
+  merge_elapsed(stat->elapsed.hits.hit_ram, stat->results.hits.hit_ram.count, other->elapsed.hits.hit_ram,
+                other->results.hits.hit_ram.count);
+  merge_elapsed(stat->elapsed.hits.ims, stat->results.hits.ims.count, other->elapsed.hits.ims, other->results.hits.ims.count);
+  merge_elapsed(stat->elapsed.hits.refresh, stat->results.hits.refresh.count, other->elapsed.hits.refresh,
+                other->results.hits.refresh.count);
+  merge_elapsed(stat->elapsed.hits.other, stat->results.hits.other.count, other->elapsed.hits.other,
+                other->results.hits.other.count);
+  merge_elapsed(stat->elapsed.hits.total, stat->results.hits.total.count, other->elapsed.hits.total,
+                other->results.hits.total.count);
+  merge_elapsed(stat->elapsed.misses.miss, stat->results.misses.miss.count, other->elapsed.misses.miss,
+                other->results.misses.miss.count);
+  merge_elapsed(stat->elapsed.misses.ims, stat->results.misses.ims.count, other->elapsed.misses.ims,
+                other->results.misses.ims.count);
+  merge_elapsed(stat->elapsed.misses.refresh, stat->results.misses.refresh.count, other->elapsed.misses.refresh,
+                other->results.misses.refresh.count);
+  merge_elapsed(stat->elapsed.misses.other, stat->results.misses.other.count, other->elapsed.misses.other,
+                other->results.misses.other.count);
+  merge_elapsed(stat->elapsed.misses.total, stat->results.misses.total.count, other->elapsed.misses.total,
+                other->results.misses.total.count);
+
+  // Everything from the results on are counters.
+  static_assert((sizeof(OriginStats) - offsetof(OriginStats, results)) % sizeof(StatsCounter) == 0,
+                "OriginStats must end with StatsCounters");
+  StatsCounter *counter           = &stat->results.hits.hit;
+  const StatsCounter *from        = &other->results.hits.hit;
+  const StatsCounter *counter_end = reinterpret_cast<const StatsCounter *>(stat + 1);
+
+  for (; counter < counter_end; ++counter, ++from) {
+    counter->count += from->count;
+    counter->bytes += from->bytes;
+  }
+  stat->total.count += other->total.count;
+  stat->total.bytes += other->total.bytes;
+
+  if (stat->latency && other->latency) {
+    for (int i = 0; i < LATENCY_BUCKETS; ++i) {
+      stat->latency->hits[i] += other->latency->hits[i];
+      stat->latency->misses[i] += other->latency->misses[i];
+    }
+  }
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // Parse a log buffer
 int
 parse_log_buff(LogBufferHeader *buf_header, bool summary = false, bool aggregate_per_userid = false)
 {
-  static LogFieldList *fieldlist = nullptr;
+  static thread_local LogFieldList *fieldlist = nullptr;
 
   LogEntryHeader *entry;
   LogBufferIterator buf_iter(buf_header);
@@ -1872,6 +2047,123 @@ process_file(int in_fd, off_t offset, unsigned max_age)
   return 0;
 }
 
+///////////////////////////////////////////////////////////////////////////////
+// Process a file (FD) with several threads. The file is mapped, and the threads take turns at
+// parsing batches of its log buffers, each into its own stats. The stats of the threads are merged
+// into those of the main thread when they are done.
+int
+process_file_parallel(int in_fd, unsigned max_age, int threads)
+{
+  const size_t BATCH = 64; // Log buffers a thread takes at a time
+  struct stat stat_buf;
+  std::vector<LogBufferHeader *> buffers;
+  int res = 0;
+
+  if (fstat(in_fd, &stat_buf) < 0) {
+    return 1;
+  }
+  size_t size = stat_buf.st_size;
+  if (0 == size) {
+    return 0;
+  }
+
+  // The parser terminates strings in place, keep the changes private.
+  char *data = static_cast<char *>(mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, in_fd, 0));
+  if (MAP_FAILED == data) {
+    Debug("logstats", "Failed to map the log file, errno=%d", errno);
+    return 1;
+  }
+  madvise(data, size, MADV_WILLNEED);
+
+  // Find the log buffers, with the checks of process_file().
+  for (size_t offset = 0; offset < size;) {
+    LogBufferHeader *header = reinterpret_cast<LogBufferHeader *>(data + offset);
+
+    if (size - offset < sizeof(LogBufferHeader)) {
+      Debug("logstats", "Truncated log buffer header at offset %zu.", offset);
+      res = 1;
+      break;
+    }
+    if (!header->cookie) {
+      break;
+    }
+    if (header->cookie != LOG_SEGMENT_COOKIE || header->version != LOG_SEGMENT_VERSION) {
+      Debug("logstats", "Invalid segment cookie or version at offset %zu.", offset);
+      res = 1;
+      break;
+    }
+    if (header->byte_count > MAX_LOGBUFFER_SIZE || header->byte_count <= sizeof(LogBufferHeader) ||
+        header->byte_count > size - offset) {
+      Debug("logstats", "Header byte count [%d] at offset %zu is wrong.", header->byte_count, offset);
+      res = 1;
+      break;
+    }
+
+    // Possibly skip too old entries (the entire buffer is skipped)
+    if (header->high_timestamp >= max_age) {
+      buffers.push_back(header);
+    } else {
+      Debug("logstats", "Skipping old buffer (age=%d, max=%d)", header->high_timestamp, max_age);
+    }
+    offset += header->byte_count;
+  }
+  Debug("logstats", "Parsing %zu log buffers with %d threads.", buffers.size(), threads);
+
+  OriginStats *all_totals    = &totals;
+  OriginStorage *all_origins = &origins;
+  int *all_parse_errors      = &parse_errors;
+  std::atomic<size_t> next   = {0};
+  std::atomic<bool> failed   = {false};
+  std::mutex merge_mutex;
+  std::vector<std::thread> workers;
+
+  auto worker = [&]() {
+    memset(&totals, 0, sizeof(totals));
+    init_elapsed(&totals);
+    totals.latency = new_latency_sketch();
+    parse_errors   = 0;
+
+    for (size_t start; !failed && (start = next.fetch_add(BATCH)) < buffers.size();) {
+      for (size_t i = start; i < std::min(start + BATCH, buffers.size()); ++i) {
+        if (parse_log_buff(buffers[i], cl.summary != 0, cl.report_per_user != 0) != 0) {
+          Debug("logstats", "Failed to parse log buffer.");
+          failed = true;
+          break;
+        }
+      }
+    }
+
+    std::lock_guard<std::mutex> lock(merge_mutex);
+
+    merge_stats(all_totals, &totals);
+    ats_free(totals.latency);
+    for (auto &origin : origins) {
+      auto o_iter = all_origins->find(origin.first);
+
+      if (all_origins->end() == o_iter) {
+        (*all_origins)[origin.first] = origin.second;
+      } else {
+        merge_stats(o_iter->second, origin.second);
+        ats_free(const_cast<char *>(origin.second->server));
+        ats_free(origin.second->latency);
+        ats_free(origin.second);
+      }
+    }
+    origins.clear();
+    *all_parse_errors += parse_errors;
+  };
+
+  for (int i = 0; i < threads; ++i) {
+    workers.emplace_back(worker);
+  }
+  for (auto &thread : workers) {
+    thread.join();
+  }
+
+  munmap(data, size);
+  return (res || failed) ? 1 : 0;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // Determine if this "stat" (Origin Server) is worthwhile to produce a
 // report for.
@@ -1949,6 +2241,36 @@ format_elapsed_line(const char *desc, const ElapsedStats &stat, bool json, bool
   }
 }
 
+void
+format_percentile_header()
+{
+  std::cout << std::left << std::setw(24) << "Latency percentiles";
+  std::cout << std::right << std::setw(18) << "50%" << std::setw(18) << "90%" << std::setw(18) << "99%" << std::endl;
+  std::cout << std::setw(cl.line_len) << std::setfill('-') << '-' << std::setfill(' ') << std::endl;
+}
+
+void
+format_percentile_line(const char *desc, const int64_t *buckets, bool json)
+{
+  const double quantiles[] = {0.5, 0.9, 0.99};
+
+  if (json) {
+    std::cout << "    " << '"' << desc << "\" : "
+              << "{ ";
+    std::cout << "\"p50\": \"" << latency_percentile(buckets, quantiles[0]) << "\", ";
+    std::cout << "\"p90\": \"" << latency_percentile(buckets, quantiles[1]) << "\", ";
+    std::cout << "\"p99\": \"" << latency_percentile(buckets, quantiles[2]) << "\"";
+    std::cout << " }," << std::endl;
+  } else {
+    std::cout << std::left << std::setw(24) << desc;
+    for (double quantile : quantiles) {
+      std::cout << std::right << std::setw(18);
+      format_int(latency_percentile(buckets, quantile));
+    }
+    std::cout << std::endl;
+  }
+}
+
 void
 format_detail_header(const char *desc, bool concise = false)
 {
@@ -2256,6 +2578,15 @@ print_detail_stats(const OriginStats *stat, bool json, bool concise)
   format_elapsed_line(json ? "miss.other.latency" : "Cache miss other", stat->elapsed.misses.other, json, concise);
   format_elapsed_line(json ? "miss.total.latency" : "Cache miss total", stat->elapsed.misses.total, json, concise);
 
+  if (stat->latency) {
+    if (!json) {
+      std::cout << std::endl;
+      format_percentile_header();
+    }
+    format_percentile_line(json ? "hit.total.percentiles" : "Cache hit total", stat->latency->hits, json);
+    format_percentile_line(json ? "miss.total.percentiles" : "Cache miss total", stat->latency->misses, json);
+  }
+
   if (!json) {
     std::cout << std::endl;
     std::cout << std::setw(cl.line_len) << std::setfill('_') << '_' << std::setfill(' ') << std::endl;
@@ -2439,6 +2770,7 @@ main(int /* argc ATS_UNUSED */, const char *argv[])
 
   // Command line parsing
   cl.parse_arguments(argv);
+  totals.latency = new_latency_sketch();
 
   // Calculate the max age of acceptable log entries, if necessary
   if (cl.max_age > 0) {
@@ -2702,7 +3034,13 @@ main(int /* argc ATS_UNUSED */, const char *argv[])
       sleep(cl.tail);
     }
 
-    if (process_file(main_fd, 0, max_age) != 0) {
+    // The URL stats are an LRU, they need the log entries in order.
+    if (cl.threads > 1 && cl.tail <= 0 && !urls) {
+      res = process_file_parallel(main_fd, max_age, cl.threads);
+    } else {
+      res = process_file(main_fd, 0, max_age);
+    }
+    if (res != 0) {
       close(main_fd);
       exit_status.set(EXIT_CRITICAL, " can't parse log file ");
       exit_status.append(cl.log_file);
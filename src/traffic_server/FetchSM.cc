@@ -240,6 +240,51 @@ FetchSM::dechunk_body()
   return 0;
 }
 
+IOBufferReader *
+FetchSM::body_reader()
+{
+  if (check_chunked() && (fetch_flags & TS_FETCH_FLAGS_DECHUNK)) {
+    return chunked_handler.dechunked_reader;
+  }
+  return resp_reader;
+}
+
+//
+// Drop the body as it arrives, the plugin only hears when it is done.
+// The response still flows through the HttpSM, so a cacheable one is
+// written to the cache.
+//
+void
+FetchSM::skip_body(bool read_complete)
+{
+  bool done = read_complete;
+
+  if (check_chunked()) {
+    // TS_FETCH_FLAGS_SKIP_BODY implies TS_FETCH_FLAGS_DECHUNK, to find the end of the body
+    IOBufferReader *reader = chunked_handler.dechunked_reader;
+    do {
+      if (chunked_handler.state == ChunkedHandler::CHUNK_FLOW_CONTROL) {
+        chunked_handler.state = ChunkedHandler::CHUNK_READ_SIZE_START;
+      }
+      if (dechunk_body() == TS_FETCH_EVENT_EXT_BODY_DONE) {
+        done = true;
+      }
+      reader->consume(reader->read_avail());
+    } while (!done && chunked_handler.state == ChunkedHandler::CHUNK_FLOW_CONTROL);
+  } else {
+    int64_t avail = resp_reader->read_avail();
+    done          = done || check_body_done();
+    resp_reader->consume(avail);
+    resp_received_body_len += avail;
+  }
+
+  if (done) {
+    contp->handleEvent(TS_FETCH_EVENT_EXT_BODY_DONE, this);
+  } else {
+    read_vio->reenable();
+  }
+}
+
 void
 FetchSM::InvokePluginExt(int fetch_event)
 {
@@ -292,6 +337,11 @@ FetchSM::InvokePluginExt(int fetch_event)
     goto out;
   }
 
+  if (fetch_flags & TS_FETCH_FLAGS_SKIP_BODY) {
+    skip_body(read_complete_event);
+    goto out;
+  }
+
   Debug(DEBUG_TAG, "[%s] chunked:%d, content_len: %" PRId64 ", received_len: %" PRId64 ", avail: %" PRId64 "", __FUNCTION__,
         resp_is_chunked, resp_content_length, resp_received_body_len,
         resp_is_chunked > 0 ? chunked_handler.chunked_reader->read_avail() : resp_reader->read_avail());
@@ -602,6 +652,9 @@ FetchSM::ext_init(Continuation *cont, const char *method, const char *url, const
   // Enable stream IO automatically.
   //
   fetch_flags = (TS_FETCH_FLAGS_STREAM | flags);
+  if (fetch_flags & TS_FETCH_FLAGS_SKIP_BODY) {
+    fetch_flags |= TS_FETCH_FLAGS_DECHUNK;
+  }
   if (fetch_flags & TS_FETCH_FLAGS_NOT_INTERNAL_REQUEST) {
     set_internal_request(false);
   }
@@ -681,11 +734,7 @@ FetchSM::ext_read_data(char *buf, size_t len)
     return 0;
   }
 
-  if (check_chunked() && (fetch_flags & TS_FETCH_FLAGS_DECHUNK)) {
-    reader = (tsapi_bufferreader *)chunked_handler.dechunked_reader;
-  } else {
-    reader = (TSIOBufferReader)resp_reader;
-  }
+  reader = reinterpret_cast<TSIOBufferReader>(body_reader());
 
   already = 0;
   blk     = TSIOBufferReaderStart(reader);
@@ -715,6 +764,36 @@ FetchSM::ext_read_data(char *buf, size_t len)
   return already;
 }
 
+IOBufferReader *
+FetchSM::ext_resp_reader()
+{
+  if (!header_done) {
+    return nullptr;
+  }
+  return body_reader();
+}
+
+void
+FetchSM::ext_consume(int64_t nbytes)
+{
+  if (fetch_flags & TS_FETCH_FLAGS_NEWLOCK) {
+    MUTEX_TAKE_LOCK(mutex, this_ethread());
+  }
+
+  if (header_done) {
+    IOBufferReader *reader = body_reader();
+
+    nbytes = std::min(nbytes, reader->read_avail());
+    reader->consume(nbytes);
+    resp_received_body_len += nbytes;
+    read_vio->reenable();
+  }
+
+  if (fetch_flags & TS_FETCH_FLAGS_NEWLOCK) {
+    MUTEX_UNTAKE_LOCK(mutex, this_ethread());
+  }
+}
+
 void
 FetchSM::ext_destroy()
 {
@@ -79,6 +79,9 @@ public:
   set_fetch_flags(int flags)
   {
     fetch_flags = flags;
+    if (fetch_flags & TS_FETCH_FLAGS_SKIP_BODY) {
+      fetch_flags |= TS_FETCH_FLAGS_DECHUNK;
+    }
   }
 
   int fetch_handler(int event, void *data);
@@ -103,6 +106,8 @@ public:
   void ext_launch();
   void ext_destroy();
   ssize_t ext_read_data(char *buf, size_t len);
+  IOBufferReader *ext_resp_reader();
+  void ext_consume(int64_t nbytes);
   void ext_write_data(const void *data, size_t len);
   void ext_set_user_data(void *data);
   void *ext_get_user_data();
@@ -143,6 +148,8 @@ private:
   bool check_chunked();
   bool check_connection_close();
   int dechunk_body();
+  IOBufferReader *body_reader();
+  void skip_body(bool read_complete);
 
   int recursion               = 0;
   PluginVC *http_vc           = nullptr;
@@ -33,6 +33,7 @@
 #include "tscore/PluginUserArgs.h"
 #include "tscore/I_Layout.h"
 #include "tscore/I_Version.h"
+#include "tscore/memory_domain.h"
 
 #include "InkAPIInternal.h"
 #include "Log.h"
@@ -71,6 +72,7 @@
 #include "RecordsConfig.h"
 #include "records/I_RecDefs.h"
 #include "records/I_RecCore.h"
+#include "records/I_RecMetrics.h"
 #include "I_Machine.h"
 #include "HttpProxyServerMain.h"
 #include "shared/overridable_txn_vars.h"
@@ -1797,12 +1799,14 @@ api_init()
 void *
 _TSmalloc(size_t size, const char * /* path ATS_UNUSED */)
 {
+  MemoryDomainScope domain(MEMORY_DOMAIN_PLUGIN);
   return ats_malloc(size);
 }
 
 void *
 _TSrealloc(void *ptr, size_t size, const char * /* path ATS_UNUSED */)
 {
+  MemoryDomainScope domain(MEMORY_DOMAIN_PLUGIN);
   return ats_realloc(ptr, size);
 }
 
@@ -1810,6 +1814,7 @@ _TSrealloc(void *ptr, size_t size, const char * /* path ATS_UNUSED */)
 char *
 _TSstrdup(const char *str, int64_t length, const char *path)
 {
+  MemoryDomainScope domain(MEMORY_DOMAIN_PLUGIN);
   return _xstrdup(str, length, path);
 }
 
@@ -2266,6 +2271,22 @@ TSUrlStringGet(TSMBuffer bufp, TSMLoc obj, int *length)
   return url_string_get(url_impl, nullptr, length, nullptr);
 }
 
+const char *
+TSUrlStringViewGet(TSMBuffer bufp, TSMLoc obj, int *length)
+{
+  sdk_assert(sdk_sanity_check_mbuffer(bufp) == TS_SUCCESS);
+  sdk_assert(sdk_sanity_check_url_handle(obj) == TS_SUCCESS);
+  sdk_assert(sdk_sanity_check_null_ptr((void *)length) == TS_SUCCESS);
+
+  URLImpl *url_impl = (URLImpl *)obj;
+  // Printing the string allocates it in the heap, a read only buffer can only return one printed before.
+  if (!isWriteable(bufp) && !(url_impl->m_ptr_printed_string && url_impl->m_clean)) {
+    *length = 0;
+    return nullptr;
+  }
+  return url_string_get_ref(((HdrHeapSDKHandle *)bufp)->m_heap, url_impl, length);
+}
+
 using URLPartGetF = const char *(URL::*)(int *);
 using URLPartSetF = void (URL::*)(const char *, int);
 
@@ -2884,6 +2905,18 @@ TSMimeHdrFieldGet(TSMBuffer bufp, TSMLoc hdr_obj, int idx)
   return reinterpret_cast<TSMLoc>(h);
 }
 
+const char *
+TSMimeHdrStringToWKS(const char *str, int length)
+{
+  sdk_assert(sdk_sanity_check_null_ptr((void *)str) == TS_SUCCESS);
+
+  if (length < 0) {
+    return hdrtoken_string_to_wks(str);
+  } else {
+    return hdrtoken_string_to_wks(str, length);
+  }
+}
+
 TSMLoc
 TSMimeHdrFieldFind(TSMBuffer bufp, TSMLoc hdr_obj, const char *name, int length)
 {
@@ -3347,6 +3380,32 @@ TSMimeHdrFieldValueStringGet(TSMBuffer bufp, TSMLoc hdr, TSMLoc field, int idx,
   return TSMimeFieldValueGet(bufp, field, idx, value_len_ptr);
 }
 
+int
+TSMimeHdrFieldsValueGet(TSMBuffer bufp, TSMLoc hdr, TSMimeFieldValueView *fields, int count)
+{
+  sdk_assert(sdk_sanity_check_mbuffer(bufp) == TS_SUCCESS);
+  sdk_assert((sdk_sanity_check_mime_hdr_handle(hdr) == TS_SUCCESS) || (sdk_sanity_check_http_hdr_handle(hdr) == TS_SUCCESS));
+  sdk_assert(sdk_sanity_check_null_ptr((void *)fields) == TS_SUCCESS);
+
+  MIMEHdrImpl *mh = _hdr_mloc_to_mime_hdr_impl(hdr);
+  int found       = 0;
+
+  for (int i = 0; i < count; ++i) {
+    TSMimeFieldValueView &view = fields[i];
+    int name_len               = view.name_len < 0 ? strlen(view.name) : view.name_len;
+    MIMEField *f               = mime_hdr_field_find(mh, view.name, name_len);
+
+    if (f) {
+      view.value = f->value_get(&view.value_len);
+      ++found;
+    } else {
+      view.value     = nullptr;
+      view.value_len = 0;
+    }
+  }
+  return found;
+}
+
 time_t
 TSMimeHdrFieldValueDateGet(TSMBuffer bufp, TSMLoc hdr, TSMLoc field)
 {
@@ -4211,7 +4270,7 @@ TSCacheKeyDigestSet(TSCacheKey key, const char *input, int length)
     return TS_ERROR;
   }
 
-  CryptoContext().hash_immediate(ci->cache_key, input, length);
+  URLHashContext().hash_immediate(ci->cache_key, input, length);
   return TS_SUCCESS;
 }
 
@@ -6563,6 +6622,24 @@ TSVConnSslCurveGet(TSVConn sslp)
   return ssl_vc ? ssl_vc->getSSLCurve() : nullptr;
 }
 
+const char *
+TSVConnSslJa3Get(TSVConn sslp, const char **raw, int *raw_len)
+{
+  NetVConnection *vc        = reinterpret_cast<NetVConnection *>(sslp);
+  SSLNetVConnection *ssl_vc = dynamic_cast<SSLNetVConnection *>(vc);
+
+  if (ssl_vc == nullptr || ssl_vc->get_ja3_fingerprint() == nullptr) {
+    return nullptr;
+  }
+  if (raw) {
+    *raw = ssl_vc->get_ja3_string().data();
+  }
+  if (raw_len) {
+    *raw_len = static_cast<int>(ssl_vc->get_ja3_string().size());
+  }
+  return ssl_vc->get_ja3_fingerprint();
+}
+
 int
 TSHttpTxnPushedRespHdrBytesGet(TSHttpTxn txnp)
 {
@@ -7443,6 +7520,25 @@ TSStatIntSet(int id, TSMgmtInt value)
   RecSetGlobalRawStatSum(api_rsb, id, value);
 }
 
+int64_t
+TSStatPrometheusWrite(TSIOBuffer bufp)
+{
+  sdk_assert(sdk_sanity_check_iocore_structure(bufp) == TS_SUCCESS);
+
+  Ptr<IOBufferData> snapshot = RecMetricsSnapshot();
+  if (!snapshot) {
+    return 0;
+  }
+
+  // The snapshot is shared by every scrape, nothing may be written after it in its block.
+  int64_t size         = snapshot->block_size();
+  IOBufferBlock *block = new_IOBufferBlock(snapshot, size, 0);
+  block->_buf_end      = block->_end;
+  reinterpret_cast<MIOBuffer *>(bufp)->append_block(block);
+
+  return size;
+}
+
 TSReturnCode
 TSStatFindName(const char *name, int *idp)
 {
@@ -7975,6 +8071,23 @@ TSFetchReadData(TSFetchSM fetch_sm, void *buf, size_t len)
   return (reinterpret_cast<FetchSM *>(fetch_sm))->ext_read_data(static_cast<char *>(buf), len);
 }
 
+TSIOBufferReader
+TSFetchRespReaderGet(TSFetchSM fetch_sm)
+{
+  sdk_assert(sdk_sanity_check_fetch_sm(fetch_sm) == TS_SUCCESS);
+
+  return reinterpret_cast<TSIOBufferReader>((reinterpret_cast<FetchSM *>(fetch_sm))->ext_resp_reader());
+}
+
+void
+TSFetchRespConsume(TSFetchSM fetch_sm, int64_t nbytes)
+{
+  sdk_assert(sdk_sanity_check_fetch_sm(fetch_sm) == TS_SUCCESS);
+  sdk_assert(nbytes >= 0);
+
+  (reinterpret_cast<FetchSM *>(fetch_sm))->ext_consume(nbytes);
+}
+
 void
 TSFetchLaunch(TSFetchSM fetch_sm)
 {
@@ -8089,6 +8202,15 @@ TSHttpTxnServerPush(TSHttpTxn txnp, const char *url, int url_len)
   return TS_SUCCESS;
 }
 
+void *
+TSHttpTxnArenaAlloc(TSHttpTxn txnp, size_t size)
+{
+  sdk_assert(sdk_sanity_check_txn(txnp) == TS_SUCCESS);
+
+  HttpSM *sm = reinterpret_cast<HttpSM *>(txnp);
+  return sm->t_state.arena.alloc(size);
+}
+
 TSReturnCode
 TSAIORead(int fd, off_t offset, char *buf, size_t buffSize, TSCont contp)
 {
@@ -8158,7 +8280,7 @@ TSAIOWrite(int fd, off_t offset, char *buf, const size_t bufSize, TSCont contp)
 TSReturnCode
 TSAIOThreadNumSet(int thread_num)
 {
-#if AIO_MODE == AIO_MODE_NATIVE
+#if AIO_MODE == AIO_MODE_NATIVE || AIO_MODE == AIO_MODE_IO_URING
   (void)thread_num;
   return TS_SUCCESS;
 #else
@@ -8562,6 +8684,7 @@ _conf_to_memberp(TSOverridableConfigKey conf, OverridableHttpConfigParams *overr
   case TS_CONFIG_SSL_CERT_FILEPATH:
   case TS_CONFIG_SSL_CLIENT_PRIVATE_KEY_FILENAME:
   case TS_CONFIG_SSL_CLIENT_CA_CERT_FILENAME:
+  case TS_CONFIG_NET_PACING_GROUP:
     // String, must be handled elsewhere
     break;
   case TS_CONFIG_PARENT_FAILURES_UPDATE_HOSTDB:
@@ -8613,6 +8736,12 @@ _conf_to_memberp(TSOverridableConfigKey conf, OverridableHttpConfigParams *overr
     ret  = &overridableHttpConfig->host_res_data;
     conv = &HttpTransact::HOST_RES_CONV;
     break;
+  case TS_CONFIG_NET_PACING_RATE:
+    ret = _memberp_to_generic(&overridableHttpConfig->pacing_rate, conv);
+    break;
+  case TS_CONFIG_HTTP_CACHE_VARY_USER_AGENT_CLASS:
+    ret = _memberp_to_generic(&overridableHttpConfig->cache_vary_user_agent_class, conv);
+    break;
   // This helps avoiding compiler warnings, yet detect unhandled enum members.
   case TS_CONFIG_NULL:
   case TS_CONFIG_LAST_ENTRY:
@@ -8800,6 +8929,11 @@ TSHttpTxnConfigStringSet(TSHttpTxn txnp, TSOverridableConfigKey conf, const char
   case TS_CONFIG_SSL_CERT_FILEPATH:
     /* noop */
     break;
+  case TS_CONFIG_NET_PACING_GROUP:
+    if (value && length > 0) {
+      s->t_state.my_txn_conf().pacing_group = const_cast<char *>(value);
+    }
+    break;
   case TS_CONFIG_HTTP_HOST_RESOLUTION_PREFERENCE:
     if (value && length > 0) {
       s->t_state.my_txn_conf().host_res_data.conf_value = const_cast<char *>(value);
@@ -8846,6 +8980,10 @@ TSHttpTxnConfigStringGet(TSHttpTxn txnp, TSOverridableConfigKey conf, const char
     *value  = sm->t_state.txn_conf->server_session_sharing_match_str;
     *length = *value ? strlen(*value) : 0;
     break;
+  case TS_CONFIG_NET_PACING_GROUP:
+    *value  = sm->t_state.txn_conf->pacing_group;
+    *length = *value ? strlen(*value) : 0;
+    break;
   default: {
     MgmtConverter const *conv;
     const void *src = _conf_to_memberp(conf, sm->t_state.txn_conf, conv);
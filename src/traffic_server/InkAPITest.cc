@@ -3000,6 +3000,52 @@ REGRESSION_TEST(SDK_API_TSIOBufferBlockNext)(RegressionTest *test, int /* atype
   return;
 }
 
+//////////////////////////////////////////////////
+//       SDK_API_TSIOBuffer
+//
+// Unit Test for API: TSIOBufferBlockAppend
+//////////////////////////////////////////////////
+
+REGRESSION_TEST(SDK_API_TSIOBufferBlockAppend)(RegressionTest *test, int /* atype ATS_UNUSED */, int *pstatus)
+{
+  bool test_passed = false;
+  *pstatus         = REGRESSION_TEST_INPROGRESS;
+
+  TSIOBuffer bufp = TSIOBufferCreate();
+  TSIOBufferWrite(bufp, "pass through", 12);
+  TSIOBufferReader readerp = TSIOBufferReaderAlloc(bufp);
+  TSIOBufferBlock blockp   = TSIOBufferReaderStart(readerp);
+  int64_t avail;
+  const char *start = TSIOBufferBlockReadStart(blockp, readerp, &avail);
+
+  TSIOBuffer outp           = TSIOBufferCreate();
+  TSIOBufferReader out_rdrp = TSIOBufferReaderAlloc(outp);
+  int64_t appended          = TSIOBufferBlockAppend(outp, blockp, start + 5, 7);
+  // The bytes must be the ones of the input block, not a copy, and the range must be checked.
+  int64_t out_avail;
+  const char *out = TSIOBufferBlockReadStart(TSIOBufferReaderStart(out_rdrp), out_rdrp, &out_avail);
+
+  if (appended == 7 && out == start + 5 && out_avail == 7 && TSIOBufferBlockAppend(outp, blockp, start + 5, avail) == -1) {
+    SDK_RPRINT(test, "TSIOBufferBlockAppend", "TestCase1", TC_PASS, "ok");
+    test_passed = true;
+  } else {
+    SDK_RPRINT(test, "TSIOBufferBlockAppend", "TestCase1", TC_FAIL, "failed");
+  }
+
+  TSIOBufferReaderFree(out_rdrp);
+  TSIOBufferDestroy(outp);
+  TSIOBufferReaderFree(readerp);
+  TSIOBufferDestroy(bufp);
+
+  if (test_passed) {
+    *pstatus = REGRESSION_TEST_PASSED;
+  } else {
+    *pstatus = REGRESSION_TEST_FAILED;
+  }
+
+  return;
+}
+
 REGRESSION_TEST(SDK_API_TSContSchedule)(RegressionTest *test, int /* atype ATS_UNUSED */, int *pstatus)
 {
   *pstatus = REGRESSION_TEST_INPROGRESS;
@@ -3608,6 +3654,7 @@ EXCLUSIVE_REGRESSION_TEST(SDK_API_HttpHookAdd)(RegressionTest *test, int /* atyp
 //                    TSUrlCopy
 //                    TSUrlClone
 //                    TSUrlStringGet
+//                    TSUrlStringViewGet
 //                    TSUrlPrint
 //                    TSUrlLengthGet
 //                    TSUrlFtpTypeGet
@@ -3742,6 +3789,7 @@ REGRESSION_TEST(SDK_API_TSUrl)(RegressionTest *test, int /* atype ATS_UNUSED */,
   bool test_passed_clone    = false;
   bool test_passed_string1  = false;
   bool test_passed_string2  = false;
+  bool test_passed_view     = false;
   bool test_passed_print    = false;
   bool test_passed_length1  = false;
   bool test_passed_length2  = false;
@@ -3917,6 +3965,19 @@ REGRESSION_TEST(SDK_API_TSUrl)(RegressionTest *test, int /* atype ATS_UNUSED */,
     SDK_RPRINT(test, "TSUrlStringGet", "TestCase1", TC_FAIL, "Values don't match");
   }
 
+  // String view, printed once and kept in the buffer
+  {
+    int view_len          = 0;
+    const char *view      = TSUrlStringViewGet(bufp1, url_loc1, &view_len);
+    const char *view_next = TSUrlStringViewGet(bufp1, url_loc1, &tmp_len);
+    if (view && view_len == url_expected_length && memcmp(view, url_expected_string, view_len) == 0 && view_next == view) {
+      SDK_RPRINT(test, "TSUrlStringViewGet", "TestCase1", TC_PASS, "ok");
+      test_passed_view = true;
+    } else {
+      SDK_RPRINT(test, "TSUrlStringViewGet", "TestCase1", TC_FAIL, "Values don't match");
+    }
+  }
+
   // Copy
   bufp2 = TSMBufferCreate();
   if (TSUrlCreate(bufp2, &url_loc2) != TS_SUCCESS) {
@@ -4026,8 +4087,9 @@ print_results:
       (test_passed_password == false) || (test_passed_host == false) || (test_passed_port == false) ||
       (test_passed_path == false) || (test_passed_params == false) || (test_passed_query == false) ||
       (test_passed_fragment == false) || (test_passed_copy == false) || (test_passed_clone == false) ||
-      (test_passed_string1 == false) || (test_passed_string2 == false) || (test_passed_print == false) ||
-      (test_passed_length1 == false) || (test_passed_length2 == false) || (test_passed_type == false)) {
+      (test_passed_string1 == false) || (test_passed_string2 == false) || (test_passed_view == false) ||
+      (test_passed_print == false) || (test_passed_length1 == false) || (test_passed_length2 == false) ||
+      (test_passed_type == false)) {
     /*** Debugging the test itself....
     (test_passed_create == false)?printf("test_passed_create is false\n"):printf("");
     (test_passed_destroy == false)?printf("test_passed_destroy is false\n"):printf("");
@@ -5139,6 +5201,15 @@ REGRESSION_TEST(SDK_API_TSMimeHdrField)(RegressionTest *test, int /* atype ATS_U
         test_passed_Mime_Hdr_Field_Value_String_Insert = true;
         test_passed_Mime_Hdr_Field_Value_String_Get    = true;
 
+        TSMimeFieldValueView views[] = {{field1Name, -1, nullptr, 0}, {"field-missing", -1, nullptr, 0}};
+        if (TSMimeHdrFieldsValueGet(bufp1, mime_loc1, views, 2) == 1 && views[0].value == field1ValueAllGet &&
+            views[0].value_len == lengthField1ValueAll && views[1].value == nullptr) {
+          SDK_RPRINT(test, "TSMimeHdrFieldsValueGet", "TestCase1", TC_PASS, "ok");
+        } else {
+          SDK_RPRINT(test, "TSMimeHdrFieldsValueGet", "TestCase1", TC_FAIL, "Values don't match");
+          test_passed_Mime_Hdr_Field_Value_String_Get = false;
+        }
+
         if ((TSMimeHdrFieldValueStringSet(bufp1, mime_loc1, field_loc11, 3, field1ValueNew, -1)) == TS_ERROR) {
           SDK_RPRINT(test, "TSMimeHdrFieldValueStringSet", "TestCase1", TC_FAIL, "TSMimeHdrFieldValueStringSet returns TS_ERROR");
         } else {
@@ -8661,7 +8732,10 @@ std::array<std::string_view, TS_CONFIG_LAST_ENTRY> SDK_Overridable_Configs = {
    "proxy.config.ssl.client.sni_policy",
    "proxy.config.ssl.client.private_key.filename",
    "proxy.config.ssl.client.CA.cert.filename",
-   "proxy.config.hostdb.ip_resolve"}};
+   "proxy.config.hostdb.ip_resolve",
+   "proxy.config.net.pacing.rate",
+   "proxy.config.net.pacing.group",
+   "proxy.config.http.cache.vary_user_agent_class"}};
 
 REGRESSION_TEST(SDK_API_OVERRIDABLE_CONFIGS)(RegressionTest *test, int /* atype ATS_UNUSED */, int *pstatus)
 {
@@ -711,6 +711,24 @@ TSIOBufferBlockReadStart(TSIOBufferBlock blockp, TSIOBufferReader readerp, int64
   return (const char *)p;
 }
 
+int64_t
+TSIOBufferBlockAppend(TSIOBuffer bufp, TSIOBufferBlock blockp, const char *start, int64_t length)
+{
+  sdk_assert(sdk_sanity_check_iocore_structure(bufp) == TS_SUCCESS);
+  sdk_assert(sdk_sanity_check_iocore_structure(blockp) == TS_SUCCESS);
+  sdk_assert(sdk_sanity_check_null_ptr((void *)start) == TS_SUCCESS);
+  sdk_assert(length >= 0);
+
+  MIOBuffer *b       = (MIOBuffer *)bufp;
+  IOBufferBlock *blk = (IOBufferBlock *)blockp;
+  int64_t offset     = start - blk->start();
+
+  if (offset < 0 || offset + length > blk->read_avail()) {
+    return -1;
+  }
+  return b->write(blk, length, offset);
+}
+
 int64_t
 TSIOBufferBlockReadAvail(TSIOBufferBlock blockp, TSIOBufferReader readerp)
 {
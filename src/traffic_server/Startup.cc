@@ -0,0 +1,117 @@
+/** @file
+
+  Startup tasks and milestones of traffic_server.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "Startup.h"
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "tscore/ink_hrtime.h"
+#include "P_EventSystem.h"
+#include "records/I_RecProcess.h"
+
+namespace
+{
+// As close to the exec as we get, this is initialized before main().
+const ink_hrtime startup_begin = ink_get_hrtime_internal();
+} // namespace
+
+void
+startup_milestone(const char *name)
+{
+  int64_t ms       = ink_hrtime_to_msec(ink_get_hrtime_internal() - startup_begin);
+  std::string stat = std::string{STARTUP_MILESTONE_PREFIX} + name + "_ms";
+
+  RecRegisterStatInt(RECT_PROCESS, stat.c_str(), ms, RECP_NON_PERSISTENT);
+  Debug("startup", "%s at %" PRId64 " ms", name, ms);
+}
+
+void
+StartupTasks::add(const char *name, std::function<void()> &&fn, std::initializer_list<const char *> after)
+{
+  Task task{name, std::move(fn), {}};
+
+  for (const char *dep : after) {
+    size_t idx = 0;
+    while (idx < _tasks.size() && strcmp(_tasks[idx].name, dep) != 0) {
+      ++idx;
+    }
+    ink_release_assert(idx < _tasks.size());
+    task.after.push_back(idx);
+  }
+  _tasks.push_back(std::move(task));
+}
+
+void
+StartupTasks::run(bool parallel)
+{
+  if (!parallel) {
+    for (Task &task : _tasks) {
+      task.fn();
+      startup_milestone(task.name);
+    }
+    return;
+  }
+
+  std::mutex mutex;
+  std::condition_variable done_cv;
+  std::vector<bool> done(_tasks.size(), false);
+  std::vector<std::thread> threads;
+
+  threads.reserve(_tasks.size());
+  for (size_t idx = 0; idx < _tasks.size(); ++idx) {
+    threads.emplace_back([&, idx]() {
+      Task &task = _tasks[idx];
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        done_cv.wait(lock, [&]() {
+          for (size_t dep : task.after) {
+            if (!done[dep]) {
+              return false;
+            }
+          }
+          return true;
+        });
+      }
+
+      // Like the main thread, the task may need an EThread for this_ethread().
+      EThread *thread = new EThread;
+      thread->set_specific();
+      Debug("startup", "%s started", task.name);
+      task.fn();
+      startup_milestone(task.name);
+      delete thread;
+
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        done[idx] = true;
+      }
+      done_cv.notify_all();
+    });
+  }
+
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+}
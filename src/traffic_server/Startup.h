@@ -0,0 +1,63 @@
+/** @file
+
+  Startup tasks and milestones of traffic_server.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#pragma once
+
+#include <functional>
+#include <initializer_list>
+#include <string>
+#include <vector>
+
+/// The prefix of the stats of the startup milestones.
+#define STARTUP_MILESTONE_PREFIX "proxy.process.startup."
+
+/** Record that startup reached @a name.
+
+    The milestone is the stat proxy.process.startup.<name>_ms, the milliseconds from the start of
+    the process, so that `traffic_ctl server status` can show where the startup spent its time.
+ */
+void startup_milestone(const char *name);
+
+/** Startup tasks that may run concurrently.
+
+    Each task runs on a thread of its own once the tasks it runs after are done, and run() returns
+    when all of them are done. Each task is a milestone when it is done.
+ */
+class StartupTasks
+{
+public:
+  /// Add the task @a name, to run after the tasks @a after, which must have been added already.
+  void add(const char *name, std::function<void()> &&fn, std::initializer_list<const char *> after = {});
+
+  /// Run the tasks, one after another in the order they were added if @a parallel is @c false.
+  void run(bool parallel);
+
+private:
+  struct Task {
+    const char *name;
+    std::function<void()> fn;
+    std::vector<size_t> after;
+  };
+
+  std::vector<Task> _tasks;
+};
@@ -37,6 +37,9 @@
 #include "tscore/ink_stack_trace.h"
 #include "tscore/ink_syslog.h"
 #include "tscore/hugepages.h"
+#include "tscore/numa.h"
+#include "tscore/memory_domain.h"
+#include "tscore/memory_pressure.h"
 #include "tscore/runroot.h"
 #include "tscore/Filenames.h"
 #include "tscore/ts_file.h"
@@ -48,6 +51,7 @@
 #include <atomic>
 #include <list>
 #include <string>
+#include <thread>
 
 #if !defined(linux)
 #include <sys/lock.h>
@@ -77,6 +81,7 @@ extern "C" int plock(int);
 #include "I_Machine.h"
 #include "RecordsConfig.h"
 #include "records/I_RecProcess.h"
+#include "records/I_RecStatsShm.h"
 #include "Transform.h"
 #include "ProcessManager.h"
 #include "ProxyConfig.h"
@@ -90,6 +95,7 @@ extern "C" int plock(int);
 #include "HostStatus.h"
 #include "MgmtUtils.h"
 #include "StatPages.h"
+#include "Startup.h"
 #include "HTTP.h"
 #include "HuffmanCodec.h"
 #include "Plugin.h"
@@ -102,6 +108,7 @@ extern "C" int plock(int);
 #include "HTTP2.h"
 #include "tscore/ink_config.h"
 #include "P_SSLSNI.h"
+#include "P_SSLConfig.h"
 #include "P_SSLClientUtils.h"
 
 #if TS_USE_QUIC == 1
@@ -173,6 +180,7 @@ HttpBodyFactory *body_factory              = nullptr;
 static int accept_mss           = 0;
 static int poll_timeout         = -1; // No value set.
 static int cmd_disable_freelist = 0;
+static int handoff_flag         = 0;
 static bool signal_received[NSIG];
 
 // 1: the main thread delayed accepting, start accepting.
@@ -218,6 +226,7 @@ static ArgumentDescription argument_descriptions[] = {
   {"bind_stderr", '-', "Regular file to bind stderr to", "S512", &bind_stderr, "PROXY_BIND_STDERR", nullptr},
   {"accept_mss", '-', "MSS for client connections", "I", &accept_mss, nullptr, nullptr},
   {"poll_timeout", 't', "poll timeout in milliseconds", "I", &poll_timeout, nullptr, nullptr},
+  {"handoff", '-', "Take over the listen sockets of the running traffic_server", "F", &handoff_flag, "PROXY_HANDOFF", nullptr},
   HELP_ARGUMENT_DESCRIPTION(),
   VERSION_ARGUMENT_DESCRIPTION(),
   RUNROOT_ARGUMENT_DESCRIPTION(),
@@ -245,6 +254,28 @@ struct AutoStopCont : public Continuation {
   AutoStopCont() : Continuation(new_ProxyMutex()) { SET_HANDLER(&AutoStopCont::mainEvent); }
 };
 
+// Drain once a new traffic_server took over the listen sockets, as for SIGTERM.
+struct HandoffDrainCont : public Continuation {
+  int
+  mainEvent(int /* event */, Event * /* e */)
+  {
+    RecInt timeout = 0;
+    RecGetRecordInt("proxy.config.stop.shutdown_timeout", &timeout);
+
+    RecSetRecordInt("proxy.node.config.draining", 1, REC_SOURCE_DEFAULT);
+    TSSystemState::drain(true);
+    // The new traffic_server accepts on the same sockets, leave the new connections to it.
+    stop_HttpProxyServer();
+
+    Note("handed the listen sockets over, shutting down in %" PRId64 " secs", timeout);
+    eventProcessor.schedule_in(new AutoStopCont(), HRTIME_SECONDS(timeout));
+    delete this;
+    return EVENT_DONE;
+  }
+
+  HandoffDrainCont() : Continuation(new_ProxyMutex()) { SET_HANDLER(&HandoffDrainCont::mainEvent); }
+};
+
 class SignalContinuation : public Continuation
 {
 public:
@@ -454,6 +485,117 @@ private:
   struct rusage _usage;
 };
 
+// Sets the memory pressure level from the resident set size against proxy.config.memory.governor.limit,
+// or the limit of the cgroup, and sheds memory as the level goes up:
+//
+//   soft - the RAM cache is cut to proxy.config.memory.governor.ram_cache_percent of its size, half of the
+//          HostDB records and SSL sessions are dropped and the allocator hands its free memory back.
+//   hard - the RAM cache is cut to a quarter of that, new connections are capped and new HTTP/2 streams refused.
+//
+// A level is left once the usage is MEMORY_GOVERNOR_HYSTERESIS percent under its threshold.
+#define MEMORY_GOVERNOR_HYSTERESIS 5
+
+class MemoryGovernor : public Continuation
+{
+public:
+  MemoryGovernor() : Continuation(new_ProxyMutex())
+  {
+    SET_HANDLER(&MemoryGovernor::periodic);
+    for (const char *name : {LEVEL, USAGE, LIMIT, RAM_CACHE_SHRINKS, HOSTDB_TRIMS, SSL_SESSION_TRIMS, ALLOCATOR_TRIMS}) {
+      RecRegisterStatInt(RECT_PROCESS, name, static_cast<RecInt>(0), RECP_NON_PERSISTENT);
+    }
+  }
+
+  int
+  periodic(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
+  {
+    MemoryPressure level = MEMORY_PRESSURE_NONE;
+    int64_t limit        = 0;
+    int64_t usage        = 0;
+
+    if (REC_ConfigReadInteger("proxy.config.memory.governor.enabled")) {
+      limit = REC_ConfigReadInteger("proxy.config.memory.governor.limit");
+      if (limit <= 0) {
+        limit = ats_memory_cgroup_limit();
+      }
+      usage = ats_memory_rss();
+    }
+    if (limit > 0 && usage > 0) {
+      int64_t percent = usage * 100 / limit;
+      int64_t soft    = REC_ConfigReadInteger("proxy.config.memory.governor.soft_percent");
+      int64_t hard    = REC_ConfigReadInteger("proxy.config.memory.governor.hard_percent");
+      if (percent >= hard || (_level == MEMORY_PRESSURE_HARD && percent >= hard - MEMORY_GOVERNOR_HYSTERESIS)) {
+        level = MEMORY_PRESSURE_HARD;
+      } else if (percent >= soft || (_level != MEMORY_PRESSURE_NONE && percent >= soft - MEMORY_GOVERNOR_HYSTERESIS)) {
+        level = MEMORY_PRESSURE_SOFT;
+      }
+    }
+    RecSetRecordInt(USAGE, usage, REC_SOURCE_DEFAULT);
+    RecSetRecordInt(LIMIT, limit, REC_SOURCE_DEFAULT);
+
+    if (level != _level) {
+      if (level > _level) {
+        Warning("memory usage %" PRId64 " of limit %" PRId64 " bytes, memory pressure went up to %s", usage, limit, NAMES[level]);
+        shed(level);
+      } else {
+        Note("memory usage %" PRId64 " of limit %" PRId64 " bytes, memory pressure went down to %s", usage, limit, NAMES[level]);
+        set_ram_cache_limit(level);
+      }
+      _level              = level;
+      ats_memory_pressure = level;
+      RecSetRecordInt(LEVEL, level, REC_SOURCE_DEFAULT);
+    }
+    if (level != MEMORY_PRESSURE_NONE) {
+      ats_malloc_trim();
+      RecSetRecordInt(ALLOCATOR_TRIMS, ++_allocator_trims, REC_SOURCE_DEFAULT);
+    }
+    return EVENT_CONT;
+  }
+
+private:
+  static constexpr const char *LEVEL             = "proxy.process.memory.governor.level";
+  static constexpr const char *USAGE             = "proxy.process.memory.governor.usage_bytes";
+  static constexpr const char *LIMIT             = "proxy.process.memory.governor.limit_bytes";
+  static constexpr const char *RAM_CACHE_SHRINKS = "proxy.process.memory.governor.ram_cache_shrinks";
+  static constexpr const char *HOSTDB_TRIMS      = "proxy.process.memory.governor.hostdb_trims";
+  static constexpr const char *SSL_SESSION_TRIMS = "proxy.process.memory.governor.ssl_session_trims";
+  static constexpr const char *ALLOCATOR_TRIMS   = "proxy.process.memory.governor.allocator_trims";
+  static constexpr const char *NAMES[]           = {"none", "soft", "hard"};
+
+  // The caches only grow back with the traffic, what is dropped stays dropped.
+  void
+  shed(MemoryPressure level)
+  {
+    set_ram_cache_limit(level);
+    RecSetRecordInt(RAM_CACHE_SHRINKS, ++_ram_cache_shrinks, REC_SOURCE_DEFAULT);
+    if (hostDB.refcountcache && hostDB.refcountcache->trim(50) > 0) {
+      RecSetRecordInt(HOSTDB_TRIMS, ++_hostdb_trims, REC_SOURCE_DEFAULT);
+    }
+    if (session_cache && session_cache->trim(50) > 0) {
+      RecSetRecordInt(SSL_SESSION_TRIMS, ++_ssl_session_trims, REC_SOURCE_DEFAULT);
+    }
+  }
+
+  void
+  set_ram_cache_limit(MemoryPressure level)
+  {
+    int percent = 100;
+    if (level != MEMORY_PRESSURE_NONE) {
+      percent = std::clamp(static_cast<int>(REC_ConfigReadInteger("proxy.config.memory.governor.ram_cache_percent")), 1, 100);
+      if (level == MEMORY_PRESSURE_HARD) {
+        percent = std::max(percent / 4, 1);
+      }
+    }
+    ram_cache_set_limit_percent(percent);
+  }
+
+  MemoryPressure _level      = MEMORY_PRESSURE_NONE;
+  int64_t _ram_cache_shrinks = 0;
+  int64_t _hostdb_trims      = 0;
+  int64_t _ssl_session_trims = 0;
+  int64_t _allocator_trims   = 0;
+};
+
 /** Gate the emission of the "Traffic Server is fuly initialized" log message.
  *
  * This message is intended to be helpful to users who want to know that
@@ -618,6 +760,37 @@ check_lockfile()
   }
 }
 
+// With --handoff the lock is held by the traffic_server the listen sockets are taken from, take it once that one exits.
+static void
+wait_for_lockfile()
+{
+  std::string lockfile = Layout::relative_to(RecConfigReadRuntimeDir(), SERVER_LOCK);
+
+  std::thread([lockfile]() {
+    Lockfile server_lockfile(lockfile.c_str());
+    pid_t holding_pid;
+
+    while (server_lockfile.Get(&holding_pid) != 1) {
+      sleep(1);
+    }
+    Debug("server", "acquired the lockfile %s", lockfile.c_str());
+  }).detach();
+}
+
+// The ports are started, finish the handoff from the previous traffic_server and wait for the next one.
+static void
+handoff_ports_started()
+{
+  if (handoff_flag) {
+    handoff_ready_HttpProxyServer();
+    wait_for_lockfile();
+  }
+  if (REC_ConfigReadInteger("proxy.config.restart.handoff_enabled")) {
+    std::string path = Layout::relative_to(RecConfigReadRuntimeDir(), HTTP_PROXY_HANDOFF_SOCKET);
+    handoff_listen_HttpProxyServer(path.c_str(), new HandoffDrainCont());
+  }
+}
+
 static void
 check_config_directories()
 {
@@ -751,6 +924,11 @@ CB_After_Cache_Init()
   emit_fully_initialized_message();
 
 #if TS_ENABLE_FIPS == 0
+  // The cache knows the key hash of its stripes now.
+  if (cacheProcessor.key_hash == CACHE_KEY_HASH_MURMUR3) {
+    URLHashContext::Setting = URLHashContext::MURMUR3;
+  }
+
   // Check for cache BC after the cache is initialized and before listen, if possible.
   if (cacheProcessor.min_stripe_version._major < CACHE_DB_MAJOR_VERSION) {
     // Versions before 23 need the MMH hash.
@@ -768,8 +946,11 @@ CB_After_Cache_Init()
     // call accept on the ports now that the cache is initialized.
     Debug("http_listen", "Delayed listen enable, cache initialization finished");
     start_HttpProxyServer();
+    startup_milestone("listen");
+    handoff_ports_started();
     emit_fully_initialized_message();
   }
+  startup_milestone("cache");
 
   time_t cache_ready_at = time(nullptr);
   RecSetRecordInt("proxy.node.restarts.proxy.cache_ready_time", cache_ready_at, REC_SOURCE_DEFAULT);
@@ -1787,6 +1968,7 @@ main(int /* argc ATS_UNUSED */, const char **argv)
 
   // Local process manager
   initialize_process_manager();
+  startup_milestone("records");
 
   // Set the core limit for the process
   init_core_size();
@@ -1814,6 +1996,25 @@ main(int /* argc ATS_UNUSED */, const char **argv)
   Debug("hugepages", "ats_pagesize reporting %zu", ats_pagesize());
   Debug("hugepages", "ats_hugepage_size reporting %zu", ats_hugepage_size());
 
+  int hugepage_arenas = 0;
+  REC_ReadConfigInteger(hugepage_arenas, "proxy.config.allocator.hugepage_arenas");
+  ats_hugepage_arena_init(hugepage_arenas);
+
+  // init per thread freelist magazines
+  int magazine_size = 0;
+  REC_ReadConfigInteger(magazine_size, "proxy.config.allocator.magazine_size");
+  ink_freelist_init_magazines(magazine_size);
+
+  // init NUMA local allocation, before the first buffer allocator is set up
+  int numa = 0;
+  REC_ReadConfigInteger(numa, "proxy.config.allocator.numa");
+  ats_numa_init(numa);
+
+  // init the memory domain arenas, before anything allocates in them
+  int memory_domains = 0;
+  REC_ReadConfigInteger(memory_domains, "proxy.config.allocator.memory_domains");
+  ats_memory_domain_init(memory_domains);
+
   if (!num_accept_threads) {
     REC_ReadConfigInteger(num_accept_threads, "proxy.config.accept_threads");
   }
@@ -1852,7 +2053,7 @@ main(int /* argc ATS_UNUSED */, const char **argv)
 
   // Ensure only one copy of traffic server is running, unless it's a command
   // that doesn't require a lock.
-  if (!(command_valid && commands[command_index].no_process_lock)) {
+  if (!(command_valid && commands[command_index].no_process_lock) && !handoff_flag) {
     check_lockfile();
   }
 
@@ -1956,6 +2157,12 @@ main(int /* argc ATS_UNUSED */, const char **argv)
   // Initialize the stat pages manager
   statPagesManager.init();
 
+  // Export the stats for local tools such as traffic_top, they are written each time the raw stats are synced
+  if (REC_ConfigReadInteger("proxy.config.stats.shm_enabled")) {
+    std::string rundir(RecConfigReadRuntimeDir());
+    RecStatsShmInit(Layout::relative_to(rundir, REC_STATS_SHM_FILE).c_str());
+  }
+
   num_of_net_threads = adjust_num_of_net_threads(num_of_net_threads);
 
   size_t stacksize;
@@ -1976,6 +2183,14 @@ main(int /* argc ATS_UNUSED */, const char **argv)
 
   REC_ReadConfigInteger(thread_max_heartbeat_mseconds, "proxy.config.thread.max_heartbeat_mseconds");
 
+  if (REC_ConfigReadInteger("proxy.config.thread.tsc_clock")) {
+    if (ink_hrtime_tsc_init()) {
+      Note("reading the time from the invariant TSC");
+    } else {
+      Warning("proxy.config.thread.tsc_clock is enabled but the CPU has no usable invariant TSC, using clock_gettime");
+    }
+  }
+
   ink_event_system_init(ts::ModuleVersion(1, 0, ts::ModuleVersion::PRIVATE));
   ink_net_init(ts::ModuleVersion(1, 0, ts::ModuleVersion::PRIVATE));
   ink_aio_init(ts::ModuleVersion(1, 0, ts::ModuleVersion::PRIVATE));
@@ -2011,10 +2226,12 @@ main(int /* argc ATS_UNUSED */, const char **argv)
   // !! ET_NET threads start here !!
   // This means any spawn scheduling must be done before this point.
   eventProcessor.start(num_of_net_threads, stacksize);
+  startup_milestone("event_system");
 
   eventProcessor.schedule_every(new SignalContinuation, HRTIME_MSECOND * 500, ET_CALL);
   eventProcessor.schedule_every(new DiagsLogContinuation, HRTIME_SECOND, ET_TASK);
   eventProcessor.schedule_every(new MemoryLimit, HRTIME_SECOND * 10, ET_TASK);
+  eventProcessor.schedule_every(new MemoryGovernor, HRTIME_SECOND, ET_TASK);
   REC_RegisterConfigUpdateFunc("proxy.config.dump_mem_info_frequency", init_memory_tracker, nullptr);
   init_memory_tracker(nullptr, RECD_NULL, RecData(), nullptr);
 
@@ -2045,12 +2262,17 @@ main(int /* argc ATS_UNUSED */, const char **argv)
     }
   } else {
     RecProcessStart();
-    initCacheControl();
-    IpAllow::startup();
-    HostStatus::instance().loadHostStatusFromStats();
     netProcessor.init_socks();
-    ParentConfig::startup();
-    SplitDNSConfig::startup();
+    {
+      // These configs do not depend on one another, except as listed, load them concurrently.
+      StartupTasks configs;
+      configs.add("cache_control", [] { initCacheControl(); });
+      configs.add("ip_allow", [] { IpAllow::startup(); });
+      configs.add("host_status", [] { HostStatus::instance().loadHostStatusFromStats(); });
+      configs.add("parent", [] { ParentConfig::startup(); }, {"host_status"});
+      configs.add("split_dns", [] { SplitDNSConfig::startup(); });
+      configs.run(REC_ConfigReadInteger("proxy.config.startup.parallel_configs") != 0);
+    }
 
     // Initialize HTTP/2
     Http2::init();
@@ -2063,6 +2285,10 @@ main(int /* argc ATS_UNUSED */, const char **argv)
       HttpProxyPort::loadConfig();
     }
     HttpProxyPort::loadDefaultIfEmpty();
+    if (handoff_flag) {
+      std::string path = Layout::relative_to(RecConfigReadRuntimeDir(), HTTP_PROXY_HANDOFF_SOCKET);
+      handoff_receive_HttpProxyServer(path.c_str());
+    }
 
     dnsProcessor.start(0, stacksize);
     if (hostDBProcessor.start() < 0)
@@ -2070,15 +2296,18 @@ main(int /* argc ATS_UNUSED */, const char **argv)
 
     // initialize logging (after event and net processor)
     Log::init(remote_management_flag ? 0 : Log::NO_REMOTE_MANAGEMENT);
+    startup_milestone("logging");
 
     (void)parsePluginConfig();
 
     // Init plugins as soon as logging is ready.
     (void)plugin_init(); // plugin.config
+    startup_milestone("plugins");
 
     SSLConfigParams::init_ssl_ctx_cb  = init_ssl_ctx_callback;
     SSLConfigParams::load_ssl_file_cb = load_ssl_file_callback;
     sslNetProcessor.start(-1, stacksize);
+    startup_milestone("ssl");
 #if TS_USE_QUIC == 1
     quic_NetProcessor.start(-1, stacksize);
 #endif
@@ -2109,6 +2338,7 @@ main(int /* argc ATS_UNUSED */, const char **argv)
 
     init_accept_HttpProxyServer(num_accept_threads);
     transformProcessor.start();
+    startup_milestone("remap");
 
     int http_enabled = 1;
     REC_ReadConfigInteger(http_enabled, "proxy.config.http.enabled");
@@ -2144,6 +2374,8 @@ main(int /* argc ATS_UNUSED */, const char **argv)
         // In either case we should not delay to accept the ports.
         Debug("http_listen", "Not delaying listen");
         start_HttpProxyServer(); // PORTS_READY_HOOK called from in here
+        startup_milestone("listen");
+        handoff_ports_started();
         emit_fully_initialized_message();
       }
     }
@@ -2155,6 +2387,7 @@ main(int /* argc ATS_UNUSED */, const char **argv)
     // "Task" processor, possibly with its own set of task threads
     tasksProcessor.register_event_type();
     eventProcessor.thread_group[ET_TASK]._afterStartCallback = task_threads_started_callback;
+    eventProcessor.thread_group[ET_TASK]._work_stealing = REC_ConfigReadInteger("proxy.config.task_threads.work_stealing") != 0;
     tasksProcessor.start(num_task_threads, stacksize);
 
     if (netProcessor.socks_conf_stuff->accept_enabled) {
@@ -2242,6 +2475,11 @@ mgmt_lifecycle_msg_callback(ts::MemSpan<void> span)
 
   if (mgmt_message_parse(span.data(), span.size(), fields, countof(fields), &op, &tag, &payload) == -1) {
     Error("Plugin message - RPC parsing error - message discarded.");
+  } else if (tag && strcmp(tag, "traffic_server.profile.dump") == 0) {
+    std::string path = Layout::relative_to(RecConfigReadLogDir(), "eventloop_profile.folded");
+    if (HandlerProfile::dump_to_file(path.c_str())) {
+      Note("wrote the event loop profile to %s", path.c_str());
+    }
   } else {
     msg.tag       = tag;
     msg.data      = payload.ptr;
@@ -31,6 +31,7 @@
 #include <cinttypes>
 #include <sys/time.h>
 #include "mgmtapi.h"
+#include "records/I_RecStatsShm.h"
 
 struct LookupItem {
   LookupItem(const char *s, const char *n, const int t) : pretty(s), name(n), numerator(""), denominator(""), type(t) {}
@@ -51,6 +52,9 @@ extern std::string response;
 
 namespace constant
 {
+// The stats exported by traffic_server are not used once they have not been updated for this long.
+const time_t shm_max_age = 60;
+
 const char global[]    = "\"global\": {\n";
 const char start[]     = "\"proxy.process.";
 const char separator[] = "\": \"";
@@ -266,6 +270,13 @@ public:
     lookup_table.insert(make_pair("client_dyn_ka", LookupItem("Dynamic KA", "ka_total", "ka_count", 3)));
   }
 
+  // Read the stats from the export of traffic_server at @a path, rather than from traffic_manager, while it is current.
+  void
+  useShm(const string &path)
+  {
+    _shm.open(path.c_str());
+  }
+
   void
   getStats()
   {
@@ -281,10 +292,16 @@ public:
       gettimeofday(&_time, nullptr);
       double now = _time.tv_sec + (double)_time.tv_usec / 1000000;
 
+      // read the stats from the export of traffic_server when it is there, rather than calling traffic_manager for each
+      bool shm = _shm.refresh() && _time.tv_sec - _shm.updated() <= constant::shm_max_age;
+
       for (map<string, LookupItem>::const_iterator lookup_it = lookup_table.begin(); lookup_it != lookup_table.end(); ++lookup_it) {
         const LookupItem &item = lookup_it->second;
 
         if (item.type == 1 || item.type == 2 || item.type == 5 || item.type == 8) {
+          if (shm && getShmStat(item.name)) {
+            continue;
+          }
           if (strcmp(item.pretty, "Version") == 0) {
             // special case for Version information
             TSString strValue = nullptr;
@@ -382,7 +399,7 @@ public:
   getStat(const string &key, string &value)
   {
     map<string, LookupItem>::const_iterator lookup_it = lookup_table.find(key);
-    assert(lookup_it != lookup_table.end());
+    ink_assert(lookup_it != lookup_table.end());
     const LookupItem &item = lookup_it->second;
 
     map<string, string>::const_iterator stats_it = _stats->find(item.name);
@@ -400,7 +417,7 @@ public:
     value = 0;
 
     map<string, LookupItem>::const_iterator lookup_it = lookup_table.find(key);
-    assert(lookup_it != lookup_table.end());
+    ink_assert(lookup_it != lookup_table.end());
     const LookupItem &item = lookup_it->second;
     prettyName             = item.pretty;
     if (overrideType != 0) {
@@ -542,6 +559,30 @@ private:
     return std::make_pair(s, i);
   }
 
+  bool
+  getShmStat(const char *name)
+  {
+    RecStatsShmReader::Stat stat;
+    char buffer[32];
+
+    if (!_shm.find(name, stat)) {
+      return false;
+    }
+    switch (stat.data_type) {
+    case RECD_STRING:
+      (*_stats)[name] = stat.string_value;
+      return true;
+    case RECD_FLOAT:
+      snprintf(buffer, sizeof(buffer), "%" PRId64, static_cast<int64_t>(stat.data.rec_float));
+      break;
+    default:
+      snprintf(buffer, sizeof(buffer), "%" PRId64, stat.data.rec_int);
+      break;
+    }
+    (*_stats)[name] = buffer;
+    return true;
+  }
+
   map<string, string> *_stats;
   map<string, string> *_old_stats;
   map<string, LookupItem> lookup_table;
@@ -552,4 +593,5 @@ private:
   double _time_diff;
   struct timeval _time;
   bool _absolute;
+  RecStatsShmReader _shm;
 };
@@ -439,6 +439,10 @@ main(int argc, const char **argv)
   }
 
   Stats stats(url);
+  if (url.empty()) {
+    ats_scoped_str rundir(RecConfigReadRuntimeDir());
+    stats.useShm(Layout::relative_to(rundir.get(), REC_STATS_SHM_FILE));
+  }
   stats.getStats();
   const string &host = stats.getHost();
 
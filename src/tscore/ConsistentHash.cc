@@ -20,8 +20,11 @@
  */
 
 #include "tscore/ConsistentHash.h"
+#include "tscore/ink_atomic.h"
+#include <algorithm>
 #include <cstring>
 #include <string>
+#include <set>
 #include <sstream>
 #include <cmath>
 #include <climits>
@@ -55,6 +58,10 @@ ATSConsistentHash::insert(ATSConsistentHashNode *node, float weight, ATSHash64 *
   string_stream << *node;
   std_string = string_stream.str();
 
+  node->load        = 0;
+  node->load_weight = weight;
+  total_weight += weight;
+
   for (i = 0; i < static_cast<int>(roundf(replicas * weight)); i++) {
     snprintf(numstr, 256, "%d-", i);
     thash->update(numstr, strlen(numstr));
@@ -205,6 +212,121 @@ ATSConsistentHash::lookup_by_hashval(uint64_t hashval, ATSConsistentHashIter *i,
   return (*iter)->second;
 }
 
+ATSConsistentHashNode *
+ATSConsistentHash::lookup_bounded(uint64_t hashval, float epsilon, ATSConsistentHashIter *i, bool *w)
+{
+  ATSConsistentHashIter NodeMapIterUp, *iter = i ? i : &NodeMapIterUp;
+  ATSConsistentHashNode *node                = nullptr;
+
+  if (table.empty()) {
+    node = lookup_by_hashval(hashval, iter, w);
+  } else {
+    *iter = table[hashval % table.size()];
+    node  = (*iter)->second;
+  }
+
+  if (node == nullptr || epsilon <= 0) {
+    return node;
+  }
+
+  // Passing the end of the ring here is not a wrap, the caller has not tried the nodes walked past.
+  ATSConsistentHashIter first = *iter;
+  for (size_t steps = 1; overloaded(node, epsilon) && steps < NodeMap.size(); steps++) {
+    if (++(*iter) == NodeMap.end()) {
+      *iter = NodeMap.begin();
+    }
+    node = (*iter)->second;
+  }
+  if (overloaded(node, epsilon)) {
+    *iter = first;
+    node  = first->second;
+  }
+
+  return node;
+}
+
+bool
+ATSConsistentHash::overloaded(const ATSConsistentHashNode *node, float epsilon) const
+{
+  if (total_weight <= 0) {
+    return false;
+  }
+  // The bound counts the request being placed, so there is always a node under it.
+  double bound = std::ceil((1.0 + epsilon) * (total_load + 1) * node->load_weight / total_weight);
+  return node->load + 1 > bound;
+}
+
+void
+ATSConsistentHash::acquire(ATSConsistentHashNode *node)
+{
+  ink_atomic_increment(&node->load, 1);
+  ink_atomic_increment(&total_load, 1);
+}
+
+void
+ATSConsistentHash::release(ATSConsistentHashNode *node)
+{
+  ink_atomic_increment(&node->load, -1);
+  ink_atomic_increment(&total_load, -1);
+}
+
+void
+ATSConsistentHash::build_table()
+{
+  struct Entry {
+    ATSConsistentHashIter first; // the node's first point on the ring
+    uint64_t offset;
+    uint64_t skip;
+    uint64_t next;
+    float credit;
+  };
+  std::vector<Entry> entries;
+  std::set<ATSConsistentHashNode *> seen;
+  float max_weight = 0;
+
+  table.clear();
+  for (auto spot = NodeMap.begin(); spot != NodeMap.end(); ++spot) {
+    if (seen.insert(spot->second).second) {
+      entries.push_back({spot, 0, 0, 0, 0});
+      max_weight = std::max(max_weight, spot->second->load_weight);
+    }
+  }
+  if (entries.empty() || max_weight <= 0) {
+    return;
+  }
+
+  // About a hundred slots per node keeps their shares within a percent or so of their weights.
+  uint64_t size = entries.size() * 100 + 1;
+  for (bool prime = false; !prime; size += 2) {
+    prime = true;
+    for (uint64_t d = 3; d * d <= size && prime; d += 2) {
+      prime = size % d != 0;
+    }
+  }
+  size -= 2;
+
+  // Each node fills the slots in its own permutation of the table, from the hash of its first point on the ring.
+  for (auto &e : entries) {
+    uint64_t h = e.first->first;
+    e.offset   = h % size;
+    e.skip     = ((h >> 32) | (h << 32)) % (size - 1) + 1;
+  }
+
+  table.assign(size, NodeMap.end());
+  for (uint64_t filled = 0; filled < size;) {
+    for (auto &e : entries) {
+      for (e.credit += e.first->second->load_weight / max_weight; e.credit >= 1 && filled < size; e.credit -= 1) {
+        uint64_t slot;
+        do {
+          slot = (e.offset + e.next++ * e.skip) % size;
+        } while (table[slot] != NodeMap.end());
+        table[slot] = e.first;
+        ++filled;
+      }
+    }
+  }
+}
+
 ATSConsistentHash::~ATSConsistentHash()
 {
   if (hash) {
@@ -35,12 +35,18 @@ CryptoContext::HashType CryptoContext::Setting = CryptoContext::SHA256;
 #else
 #include "tscore/INK_MD5.h"
 #include "tscore/MMH.h"
+#include "tscore/MurmurHash3.h"
 CryptoContext::HashType CryptoContext::Setting = CryptoContext::MD5;
 #endif
 
-CryptoContext::CryptoContext()
+CryptoContext::CryptoContext() : CryptoContext(Setting) {}
+
+CryptoContext::CryptoContext(HashType type)
 {
-  switch (Setting) {
+  if (type == UNSPECIFIED) {
+    type = Setting;
+  }
+  switch (type) {
   case UNSPECIFIED:
 #if TS_ENABLE_FIPS == 0
   case MD5:
@@ -49,6 +55,9 @@ CryptoContext::CryptoContext()
   case MMH:
     new (_obj) MMHContext;
     break;
+  case MURMUR3:
+    new (_obj) MurmurHash3Context;
+    break;
 #else
   case SHA256:
     new (_obj) SHA256Context;
@@ -60,6 +69,7 @@ CryptoContext::CryptoContext()
 #if TS_ENABLE_FIPS == 0
   static_assert(CryptoContext::OBJ_SIZE >= sizeof(MD5Context), "bad OBJ_SIZE");
   static_assert(CryptoContext::OBJ_SIZE >= sizeof(MMHContext), "bad OBJ_SIZE");
+  static_assert(CryptoContext::OBJ_SIZE >= sizeof(MurmurHash3Context), "bad OBJ_SIZE");
 #else
   static_assert(CryptoContext::OBJ_SIZE >= sizeof(SHA256Context), "bad OBJ_SIZE");
 #endif
@@ -47,12 +47,18 @@
 #include "tscore/BufferWriter.h"
 #include "tscore/Diags.h"
 
+#include <vector>
+
 int diags_on_for_plugins         = 0;
 int DiagsConfigState::enabled[2] = {0, 0};
 
 // Global, used for all diagnostics
 inkcoreapi Diags *diags = nullptr;
 
+// The call sites of all the Diags, see DiagsTagSite. These outlive the Diags, as the sites do.
+static ink_mutex tag_sites_lock = PTHREAD_MUTEX_INITIALIZER;
+static std::vector<DiagsTagSite *> *tag_sites;
+
 static bool
 location(const SourceLocation *loc, DiagsShowLocation show, DiagsLevel level)
 {
@@ -182,6 +188,7 @@ Diags::~Diags()
 
   deactivate_all(DiagsTagType_Debug);
   deactivate_all(DiagsTagType_Action);
+  refresh_tag_sites(true);
 }
 
 //////////////////////////////////////////////////////////////////////////////
@@ -352,6 +359,73 @@ Diags::tag_activated(const char *tag, DiagsTagType mode) const
   return (activated);
 }
 
+//////////////////////////////////////////////////////////////////////////////
+//
+//      bool Diags::site_activated(DiagsTagSite &site, char *tag, bool constant)
+//
+//      This routine checks the <tag> of a call site the first time, or when
+//      the site was checked by another Diags, and caches its state in <site>
+//      if the <tag> is <constant>.  The sites are registered to have their
+//      state recomputed by refresh_tag_sites when the debug tags change.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+bool
+Diags::site_activated(DiagsTagSite &site, const char *tag, bool constant) const
+{
+  // Only literal tags are cached, and a site only caches the first tag it is checked with.
+  if (!constant || (site.owner.load(std::memory_order_acquire) != nullptr && site.tag != tag)) {
+    return tag_activated(tag);
+  }
+
+  ink_mutex_acquire(&tag_sites_lock);
+  if (!site.registered) {
+    if (!tag_sites) {
+      tag_sites = new std::vector<DiagsTagSite *>;
+    }
+    tag_sites->push_back(&site);
+    site.tag        = tag;
+    site.registered = true;
+  }
+  bool activated = tag_activated(tag);
+  if (site.tag == tag) {
+    site.enabled.store(activated, std::memory_order_relaxed);
+    site.owner.store(this, std::memory_order_release);
+  }
+  ink_mutex_release(&tag_sites_lock);
+
+  return activated;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//      void Diags::refresh_tag_sites(bool release)
+//
+//      This routine recomputes the state of the call sites checked by this
+//      Diags, after its debug tags changed.  With <release> the sites are
+//      detached from this Diags instead, as it is going away.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+void
+Diags::refresh_tag_sites(bool release) const
+{
+  ink_mutex_acquire(&tag_sites_lock);
+  if (tag_sites) {
+    for (DiagsTagSite *site : *tag_sites) {
+      if (site->owner.load(std::memory_order_relaxed) != this) {
+        continue;
+      }
+      if (release) {
+        site->owner.store(nullptr, std::memory_order_release);
+      } else {
+        site->enabled.store(tag_activated(site->tag), std::memory_order_relaxed);
+      }
+    }
+  }
+  ink_mutex_release(&tag_sites_lock);
+}
+
 //////////////////////////////////////////////////////////////////////////////
 //
 //      void Diags::activate_taglist(char * taglist, DiagsTagType mode)
@@ -374,6 +448,9 @@ Diags::activate_taglist(const char *taglist, DiagsTagType mode)
     activated_tags[mode] = new DFA;
     activated_tags[mode]->compile(taglist);
     unlock();
+    if (mode == DiagsTagType_Debug) {
+      refresh_tag_sites();
+    }
   }
 }
 
@@ -396,6 +473,9 @@ Diags::deactivate_all(DiagsTagType mode)
     activated_tags[mode] = nullptr;
   }
   unlock();
+  if (mode == DiagsTagType_Debug) {
+    refresh_tag_sites();
+  }
 }
 
 //////////////////////////////////////////////////////////////////////////////
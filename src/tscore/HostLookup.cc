@@ -34,6 +34,7 @@
 #include "tscpp/util/TextView.h"
 
 #include <string_view>
+#include <algorithm>
 #include <array>
 #include <memory>
 
@@ -180,6 +181,28 @@ static const unsigned char asciiToTable[256] = {
 // Number of legal characters in the asciiToTable array
 static const int numLegalChars = 38;
 
+static bool
+is_legal_key(string_view key)
+{
+  return std::none_of(key.begin(), key.end(), [](unsigned char c) { return asciiToTable[c] == 255; });
+}
+
+// The order of the labels of the children of a HOST_INDEX branch in the HostIndex, where like
+// in CharIndex a label matches regardless of case.
+static bool
+label_less_nocase(string_view lhs, string_view rhs)
+{
+  size_t n = std::min(lhs.size(), rhs.size());
+  for (size_t i = 0; i < n; ++i) {
+    int lc = tolower(static_cast<unsigned char>(lhs[i]));
+    int rc = tolower(static_cast<unsigned char>(rhs[i]));
+    if (lc != rc) {
+      return lc < rc;
+    }
+  }
+  return lhs.size() < rhs.size();
+}
+
 // struct CharIndexBlock
 //
 //   Used by class CharIndex.  Forms a single level in CharIndex tree
@@ -267,9 +290,17 @@ public:
   iterator begin();
   iterator end();
 
+  using Table = std::unordered_map<string_view, HostBranch *>;
+
+  /// The branches with keys that are not in @c asciiToTable, which the iterator does not visit.
+  Table *
+  illegal_keys()
+  {
+    return illegalKey.get();
+  }
+
 private:
   CharIndexBlock root;
-  using Table = std::unordered_map<string_view, HostBranch *>;
   std::unique_ptr<Table> illegalKey;
 };
 
@@ -595,7 +626,11 @@ HostLookup::Print()
 void
 HostLookup::Print(PrintFunc const &f)
 {
-  PrintHostBranch(&root, f);
+  if (!index.nodes.empty()) {
+    PrintIndexNode(0, f);
+  } else {
+    PrintHostBranch(&root, f);
+  }
 }
 
 //
@@ -821,12 +856,12 @@ HostLookup::TableInsert(string_view match_data, int index, bool domain_record)
 //
 
 bool
-HostLookup::MatchArray(HostLookupState *s, void **opaque_ptr, LeafIndices &array, bool host_done)
+HostLookup::MatchArray(HostLookupState *s, void **opaque_ptr, const int *leaves, size_t n_leaves, bool host_done)
 {
   size_t i;
 
-  for (i = s->array_index + 1; i < array.size(); ++i) {
-    auto &leaf{leaf_array[array[i]]};
+  for (i = s->array_index + 1; i < n_leaves; ++i) {
+    auto &leaf{leaf_array[leaves[i]]};
 
     switch (leaf.type) {
     case HostLeaf::HOST_PARTIAL:
@@ -874,6 +909,7 @@ bool
 HostLookup::MatchFirst(string_view host, HostLookupState *s, void **opaque_ptr)
 {
   s->cur           = &root;
+  s->node          = 0;
   s->table_level   = 0;
   s->array_index   = -1;
   s->hostname      = host;
@@ -896,9 +932,12 @@ HostLookup::MatchNext(HostLookupState *s, void **opaque_ptr)
   if (leaf_array.size() <= 0) {
     return false;
   }
+  if (!index.nodes.empty()) {
+    return MatchNextIndexed(s, opaque_ptr);
+  }
 
   while (s->table_level <= HOST_TABLE_DEPTH) {
-    if (MatchArray(s, opaque_ptr, cur->leaf_indices, s->hostname_stub.empty())) {
+    if (MatchArray(s, opaque_ptr, cur->leaf_indices.data(), cur->leaf_indices.size(), s->hostname_stub.empty())) {
       return true;
     }
     // Check to see if we run out of tokens in the hostname
@@ -943,6 +982,202 @@ HostLookup::AllocateSpace(int num_entries)
 void
 HostLookup::NewEntry(string_view match_data, bool domain_record, void *opaque_data_in)
 {
+  // The tree is gone once the index is built.
+  ink_release_assert(index.nodes.empty());
+
   leaf_array.emplace_back(match_data, opaque_data_in);
   TableInsert(match_data, leaf_array.size() - 1, domain_record);
 }
+
+// void HostLookup::BuildIndex()
+//
+//   Lay the tree out as a HostIndex, breadth first, then free it.
+//     The index takes a fraction of the memory of the tree, whose
+//     CharIndexBlocks and HostArrays are mostly empty, and a lookup
+//     walks a few contiguous nodes instead of a pointer per label
+//
+void
+HostLookup::BuildIndex()
+{
+  ink_assert(index.nodes.empty());
+
+  // Node i of the index is branches[i].
+  std::vector<HostBranch *> branches{&root};
+  std::vector<HostBranch *> children;
+  std::unordered_map<string_view, uint32_t> label_offsets;
+  HostIndex built;
+
+  for (size_t i = 0; i < branches.size(); ++i) {
+    HostBranch *hb = branches[i];
+    HostIndex::Node node;
+
+    children.clear();
+    switch (hb->type) {
+    case HostBranch::HOST_TERMINAL:
+      break;
+    case HostBranch::HOST_HASH:
+      for (auto &item : *(hb->next_level._table)) {
+        children.push_back(item.second);
+      }
+      break;
+    case HostBranch::HOST_INDEX:
+      for (auto &branch : *(hb->next_level._index)) {
+        children.push_back(&branch);
+      }
+      if (auto illegal = hb->next_level._index->illegal_keys()) {
+        for (auto &item : *illegal) {
+          children.push_back(item.second);
+        }
+      }
+      break;
+    case HostBranch::HOST_ARRAY:
+      for (auto &item : *(hb->next_level._array)) {
+        children.push_back(item.branch);
+      }
+      break;
+    }
+    if (hb->type == HostBranch::HOST_INDEX) {
+      std::sort(children.begin(), children.end(),
+                [](HostBranch *lhs, HostBranch *rhs) { return label_less_nocase(lhs->key, rhs->key); });
+    } else {
+      std::sort(children.begin(), children.end(), [](HostBranch *lhs, HostBranch *rhs) { return lhs->key < rhs->key; });
+    }
+
+    if (i > 0) {
+      if (hb->key.size() > UINT16_MAX) {
+        return; // Keep the tree, the index has no room for such a label.
+      }
+      auto spot = label_offsets.find(hb->key);
+      if (spot == label_offsets.end()) {
+        spot = label_offsets.emplace(hb->key, built.labels.size()).first;
+        built.labels.append(hb->key);
+      }
+      node.label     = spot->second;
+      node.label_len = hb->key.size();
+    }
+    node.type       = hb->type;
+    node.children   = branches.size();
+    node.n_children = children.size();
+    node.leaves     = built.leaf_indices.size();
+    node.n_leaves   = hb->leaf_indices.size();
+    built.leaf_indices.insert(built.leaf_indices.end(), hb->leaf_indices.begin(), hb->leaf_indices.end());
+    built.nodes.push_back(node);
+    branches.insert(branches.end(), children.begin(), children.end());
+  }
+
+  built.nodes.shrink_to_fit();
+  built.labels.shrink_to_fit();
+  built.leaf_indices.shrink_to_fit();
+  index = std::move(built);
+
+  // Move the tree out of root to free it.
+  HostBranch *tree = new HostBranch;
+  tree->type       = root.type;
+  tree->next_level = root.next_level;
+  delete tree;
+  root.type            = HostBranch::HOST_TERMINAL;
+  root.next_level._ptr = nullptr;
+  root.leaf_indices    = LeafIndices();
+}
+
+// uint32_t HostLookup::FindChild(HostIndex::Node const& from, string_view level_data)
+//
+//   FindNextLevel for the index, returns the index of the node for
+//     level_data below from, or 0 (the root) if there is none
+//
+uint32_t
+HostLookup::FindChild(HostIndex::Node const &from, string_view level_data) const
+{
+  auto begin = index.nodes.begin();
+  auto first = begin + from.children;
+  auto last  = first + from.n_children;
+
+  switch (from.type) {
+  case HostBranch::HOST_TERMINAL:
+    break;
+  case HostBranch::HOST_HASH: {
+    auto spot = std::lower_bound(first, last, level_data,
+                                 [this](HostIndex::Node const &node, string_view key) { return index.label(node) < key; });
+    if (spot != last && index.label(*spot) == level_data) {
+      return spot - begin;
+    }
+  } break;
+  case HostBranch::HOST_INDEX: {
+    // Like CharIndex, only keys of legal characters match regardless of case.
+    bool legal = is_legal_key(level_data);
+    auto spot  = std::lower_bound(first, last, level_data, [this](HostIndex::Node const &node, string_view key) {
+      return label_less_nocase(index.label(node), key);
+    });
+    for (; spot != last && !label_less_nocase(level_data, index.label(*spot)); ++spot) {
+      if (legal || index.label(*spot) == level_data) {
+        return spot - begin;
+      }
+    }
+  } break;
+  case HostBranch::HOST_ARRAY: {
+    // The same as HostArray::Lookup with bNotProcess.
+    uint32_t r = 0;
+    for (auto spot = first; spot != last; ++spot) {
+      string_view md = index.label(*spot);
+      if (!md.empty() && '!' == md.front()) {
+        md.remove_prefix(1);
+        if (!md.empty() && md == level_data) {
+          r = spot - begin;
+        }
+      } else if (md == level_data) {
+        return spot - begin;
+      }
+    }
+    return r;
+  }
+  }
+  return 0;
+}
+
+// bool HostLookup::MatchNextIndexed(HostLookupState* s, void** opaque_ptr)
+//
+//   MatchNext once the index is built
+//
+bool
+HostLookup::MatchNextIndexed(HostLookupState *s, void **opaque_ptr)
+{
+  while (s->table_level <= HOST_TABLE_DEPTH) {
+    HostIndex::Node const &node = index.nodes[s->node];
+
+    if (MatchArray(s, opaque_ptr, index.leaf_indices.data() + node.leaves, node.n_leaves, s->hostname_stub.empty())) {
+      return true;
+    }
+    // Check to see if we run out of tokens in the hostname or there are no lower levels
+    if (s->hostname_stub.empty() || node.n_children == 0) {
+      break;
+    }
+
+    string_view token{TextView{s->hostname_stub}.suffix('.')};
+    s->hostname_stub.remove_suffix(std::min(s->hostname_stub.size(), token.size() + 1));
+    uint32_t next = FindChild(node, token);
+
+    if (next == 0) {
+      break;
+    }
+    s->node        = next;
+    s->array_index = -1;
+    ++(s->table_level);
+  }
+
+  return false;
+}
+
+void
+HostLookup::PrintIndexNode(uint32_t node, PrintFunc const &f)
+{
+  HostIndex::Node const &n = index.nodes[node];
+
+  for (uint32_t i = 0; i < n.n_leaves; ++i) {
+    auto &leaf{leaf_array[index.leaf_indices[n.leaves + i]]};
+    printf("\t\t%s for %.*s\n", LeafTypeStr[leaf.type], static_cast<int>(leaf.match.size()), leaf.match.data());
+    f(leaf.opaque_data);
+  }
+  for (uint32_t i = 0; i < n.n_children; ++i) {
+    PrintIndexNode(n.children + i, f);
+  }
+}
@@ -47,6 +47,8 @@
 #include "tscore/ink_inet.h"
 #include "tscore/BufferWriter.h"
 
+#include <vector>
+
 namespace ts
 {
 namespace detail
@@ -1115,10 +1117,82 @@ bwformat(BufferWriter &w, BWFSpec const &spec, detail::IpMapBase<N> const &map)
 
 } // namespace ts
 //----------------------------------------------------------------------------
-IpMap::IpMap(IpMap::self_type &&that) noexcept : _m4(that._m4), _m6(that._m6)
+/* The frozen map keeps the ends of the ranges in sorted arrays, in host order. As the ranges are
+   disjoint, the range that can hold an address is the first one with a maximum not less than the
+   address, and it holds it if its minimum is not greater.
+ */
+struct IpMap::Frozen {
+  /// An IPv6 address as two host order words, compared without branches.
+  struct Ip6Key {
+    uint64_t hi;
+    uint64_t lo;
+
+    bool
+    operator<(Ip6Key const &that) const
+    {
+      return (hi < that.hi) | ((hi == that.hi) & (lo < that.lo));
+    }
+
+    static Ip6Key
+    make(sockaddr const *sa)
+    {
+      uint8_t const *b = ats_ip_addr8_cast(sa);
+      Ip6Key key{0, 0};
+      for (int i = 0; i < 8; ++i) {
+        key.hi = (key.hi << 8) | b[i];
+        key.lo = (key.lo << 8) | b[i + 8];
+      }
+      return key;
+    }
+  };
+
+  template <typename K> struct Ranges {
+    std::vector<K> max;
+    std::vector<K> min;
+    std::vector<void *> data;
+
+    void
+    add(K const &lo, K const &hi, void *d)
+    {
+      min.push_back(lo);
+      max.push_back(hi);
+      data.push_back(d);
+    }
+
+    bool
+    contains(K const &x, void **ptr) const
+    {
+      size_t n = max.size();
+      if (n == 0) {
+        return false;
+      }
+      // Halve the candidates with a conditional move rather than a branch.
+      K const *base = max.data();
+      while (n > 1) {
+        size_t half = n / 2;
+        base        = (base[half - 1] < x) ? base + half : base;
+        n -= half;
+      }
+      size_t idx = (base - max.data()) + (*base < x);
+      if (idx == max.size() || x < min[idx]) {
+        return false;
+      }
+      if (ptr) {
+        *ptr = data[idx];
+      }
+      return true;
+    }
+  };
+
+  Ranges<uint32_t> ip4;
+  Ranges<Ip6Key> ip6;
+};
+
+IpMap::IpMap(IpMap::self_type &&that) noexcept : _m4(that._m4), _m6(that._m6), _frozen(that._frozen)
 {
-  that._m4 = nullptr;
-  that._m6 = nullptr;
+  that._m4     = nullptr;
+  that._m6     = nullptr;
+  that._frozen = nullptr;
 }
 
 IpMap::self_type &
@@ -1128,6 +1202,7 @@ IpMap::operator=(IpMap::self_type &&that)
     this->clear();
     std::swap(_m4, that._m4);
     std::swap(_m6, that._m6);
+    std::swap(_frozen, that._frozen);
   }
   return *this;
 }
@@ -1136,6 +1211,14 @@ IpMap::~IpMap()
 {
   delete _m4;
   delete _m6;
+  delete _frozen;
+}
+
+void
+IpMap::thaw()
+{
+  delete _frozen;
+  _frozen = nullptr;
 }
 
 inline ts::detail::Ip4Map *
@@ -1160,7 +1243,13 @@ bool
 IpMap::contains(sockaddr const *target, void **ptr) const
 {
   bool zret = false;
-  if (AF_INET == target->sa_family) {
+  if (_frozen) {
+    if (AF_INET == target->sa_family) {
+      zret = _frozen->ip4.contains(ntohl(ats_ip4_addr_cast(target)), ptr);
+    } else if (AF_INET6 == target->sa_family) {
+      zret = _frozen->ip6.contains(Frozen::Ip6Key::make(target), ptr);
+    }
+  } else if (AF_INET == target->sa_family) {
     zret = _m4 && _m4->contains(ntohl(ats_ip4_addr_cast(target)), ptr);
   } else if (AF_INET6 == target->sa_family) {
     zret = _m6 && _m6->contains(ats_ip6_cast(target), ptr);
@@ -1171,12 +1260,16 @@ IpMap::contains(sockaddr const *target, void **ptr) const
 bool
 IpMap::contains(in_addr_t target, void **ptr) const
 {
+  if (_frozen) {
+    return _frozen->ip4.contains(ntohl(target), ptr);
+  }
   return _m4 && _m4->contains(ntohl(target), ptr);
 }
 
 IpMap &
 IpMap::mark(sockaddr const *min, sockaddr const *max, void *data)
 {
+  this->thaw();
   ink_assert(min->sa_family == max->sa_family);
   if (AF_INET == min->sa_family) {
     this->force4()->mark(ntohl(ats_ip4_addr_cast(min)), ntohl(ats_ip4_addr_cast(max)), data);
@@ -1189,6 +1282,7 @@ IpMap::mark(sockaddr const *min, sockaddr const *max, void *data)
 IpMap &
 IpMap::mark(in_addr_t min, in_addr_t max, void *data)
 {
+  this->thaw();
   this->force4()->mark(ntohl(min), ntohl(max), data);
   return *this;
 }
@@ -1196,6 +1290,7 @@ IpMap::mark(in_addr_t min, in_addr_t max, void *data)
 IpMap &
 IpMap::unmark(sockaddr const *min, sockaddr const *max)
 {
+  this->thaw();
   ink_assert(min->sa_family == max->sa_family);
   if (AF_INET == min->sa_family) {
     if (_m4) {
@@ -1212,6 +1307,7 @@ IpMap::unmark(sockaddr const *min, sockaddr const *max)
 IpMap &
 IpMap::unmark(in_addr_t min, in_addr_t max)
 {
+  this->thaw();
   if (_m4) {
     _m4->unmark(ntohl(min), ntohl(max));
   }
@@ -1221,6 +1317,7 @@ IpMap::unmark(in_addr_t min, in_addr_t max)
 IpMap &
 IpMap::fill(sockaddr const *min, sockaddr const *max, void *data)
 {
+  this->thaw();
   ink_assert(min->sa_family == max->sa_family);
   if (AF_INET == min->sa_family) {
     this->force4()->fill(ntohl(ats_ip4_addr_cast(min)), ntohl(ats_ip4_addr_cast(max)), data);
@@ -1233,6 +1330,7 @@ IpMap::fill(sockaddr const *min, sockaddr const *max, void *data)
 IpMap &
 IpMap::fill(in_addr_t min, in_addr_t max, void *data)
 {
+  this->thaw();
   this->force4()->fill(ntohl(min), ntohl(max), data);
   return *this;
 }
@@ -1253,6 +1351,7 @@ IpMap::count() const
 IpMap &
 IpMap::clear()
 {
+  this->thaw();
   if (_m4) {
     _m4->clear();
   }
@@ -1262,6 +1361,28 @@ IpMap::clear()
   return *this;
 }
 
+IpMap &
+IpMap::freeze()
+{
+  auto frozen = new Frozen;
+  for (auto &node : *this) {
+    if (AF_INET == node.min()->sa_family) {
+      frozen->ip4.add(ntohl(ats_ip4_addr_cast(node.min())), ntohl(ats_ip4_addr_cast(node.max())), node.data());
+    } else {
+      frozen->ip6.add(Frozen::Ip6Key::make(node.min()), Frozen::Ip6Key::make(node.max()), node.data());
+    }
+  }
+  this->thaw();
+  _frozen = frozen;
+  return *this;
+}
+
+bool
+IpMap::is_frozen() const
+{
+  return _frozen != nullptr;
+}
+
 IpMap::iterator
 IpMap::begin() const
 {
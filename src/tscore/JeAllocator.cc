@@ -17,6 +17,7 @@
 #include <unistd.h>
 #include <sys/types.h>
 #include <cstring>
+#include <array>
 #include <cstdlib>
 #include <iostream>
 #include "tscore/ink_memory.h"
@@ -24,18 +25,21 @@
 #include "tscore/ink_assert.h"
 #include "tscore/ink_align.h"
 #include "tscore/JeAllocator.h"
+#include "tscore/numa.h"
+#include "tscore/memory_domain.h"
 
 namespace jearena
 {
-JemallocNodumpAllocator::JemallocNodumpAllocator()
+JemallocNodumpAllocator::JemallocNodumpAllocator(int numa_node)
 {
-  extend_and_setup_arena();
+  extend_and_setup_arena(numa_node);
 }
 
 #ifdef JEMALLOC_NODUMP_ALLOCATOR_SUPPORTED
 
 extent_hooks_t JemallocNodumpAllocator::extent_hooks_;
 extent_alloc_t *JemallocNodumpAllocator::original_alloc_ = nullptr;
+int8_t JemallocNodumpAllocator::arena_node_[JemallocNodumpAllocator::MAX_ARENAS];
 
 void *
 JemallocNodumpAllocator::alloc(extent_hooks_t *extent, void *new_addr, size_t size, size_t alignment, bool *zero, bool *commit,
@@ -47,6 +51,9 @@ JemallocNodumpAllocator::alloc(extent_hooks_t *extent, void *new_addr, size_t si
     // Seems like we don't really care if the advice went through
     // in the original code, so just keeping it the same here.
     ats_madvise((caddr_t)result, size, MADV_DONTDUMP);
+    if (arena_ind < MAX_ARENAS && arena_node_[arena_ind] > 0) {
+      ats_numa_bind_area(result, size, arena_node_[arena_ind] - 1);
+    }
   }
 
   return result;
@@ -55,7 +62,7 @@ JemallocNodumpAllocator::alloc(extent_hooks_t *extent, void *new_addr, size_t si
 #endif /* JEMALLOC_NODUMP_ALLOCATOR_SUPPORTED */
 
 bool
-JemallocNodumpAllocator::extend_and_setup_arena()
+JemallocNodumpAllocator::extend_and_setup_arena(int numa_node)
 {
 #ifdef JEMALLOC_NODUMP_ALLOCATOR_SUPPORTED
   size_t arena_index_len_ = sizeof(arena_index_);
@@ -63,6 +70,12 @@ JemallocNodumpAllocator::extend_and_setup_arena()
     ink_abort("Unable to extend arena: %s", std::strerror(ret));
   }
   flags_ = MALLOCX_ARENA(arena_index_) | MALLOCX_TCACHE_NONE;
+  ats_memory_domain_attach_arena(MEMORY_DOMAIN_FREELIST, arena_index_);
+  // Stored off by one so the zero initialized entries mean no node. This is set before the hooks
+  // are, so the hook never sees it change.
+  if (arena_index_ < MAX_ARENAS) {
+    arena_node_[arena_index_] = numa_node + 1;
+  }
 
   // Read the existing hooks
   const auto key = "arena." + std::to_string(arena_index_) + ".extent_hooks";
@@ -87,6 +100,7 @@ JemallocNodumpAllocator::extend_and_setup_arena()
 
   return true;
 #else  /* JEMALLOC_NODUMP_ALLOCATOR_SUPPORTED */
+  (void)numa_node;
   return false;
 #endif /* JEMALLOC_NODUMP_ALLOCATOR_SUPPORTED */
 }
@@ -146,4 +160,21 @@ globalJemallocNodumpAllocator()
   static auto instance = new JemallocNodumpAllocator();
   return *instance;
 }
+
+JemallocNodumpAllocator &
+globalJemallocNodumpAllocator(int numa_node)
+{
+  if (numa_node < 0 || numa_node >= ats_numa_node_count()) {
+    return globalJemallocNodumpAllocator();
+  }
+  // All the arenas at once, so that they exist before any of their memory is used.
+  static auto instances = [] {
+    std::array<JemallocNodumpAllocator *, TS_MAX_NUMA_NODES> a{};
+    for (int i = 0; i < ats_numa_node_count(); ++i) {
+      a[i] = new JemallocNodumpAllocator(i);
+    }
+    return a;
+  }();
+  return *instances[numa_node];
+}
 } // namespace jearena
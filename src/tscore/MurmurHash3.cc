@@ -0,0 +1,161 @@
+/** @file
+
+  MurmurHash3, the 128 bit variant for 64 bit platforms, as a cache key hash.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  @section details Details
+
+  MurmurHash3 was written by Austin Appleby, who placed it in the public domain.
+ */
+
+#include <algorithm>
+#include <cstring>
+#include "tscore/MurmurHash3.h"
+
+namespace
+{
+constexpr uint64_t C1 = 0x87c37b91114253d5ULL;
+constexpr uint64_t C2 = 0x4cf5ad432745937fULL;
+
+inline uint64_t
+rotl64(uint64_t x, int r)
+{
+  return (x << r) | (x >> (64 - r));
+}
+
+inline uint64_t
+fmix64(uint64_t k)
+{
+  k ^= k >> 33;
+  k *= 0xff51afd7ed558ccdULL;
+  k ^= k >> 33;
+  k *= 0xc4ceb9fe1a85ec53ULL;
+  k ^= k >> 33;
+  return k;
+}
+
+inline uint64_t
+load64(const uint8_t *p)
+{
+  uint64_t v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+} // namespace
+
+MurmurHash3Context::MurmurHash3Context() {}
+
+inline void
+MurmurHash3Context::block(uint64_t k1, uint64_t k2)
+{
+  k1 *= C1;
+  k1 = rotl64(k1, 31);
+  k1 *= C2;
+  _h1 ^= k1;
+
+  _h1 = rotl64(_h1, 27);
+  _h1 += _h2;
+  _h1 = _h1 * 5 + 0x52dce729;
+
+  k2 *= C2;
+  k2 = rotl64(k2, 33);
+  k2 *= C1;
+  _h2 ^= k2;
+
+  _h2 = rotl64(_h2, 31);
+  _h2 += _h1;
+  _h2 = _h2 * 5 + 0x38495ab5;
+}
+
+bool
+MurmurHash3Context::update(void const *data, int length)
+{
+  const uint8_t *p = static_cast<const uint8_t *>(data);
+  const uint8_t *e = p + length;
+
+  if (length <= 0) {
+    return true;
+  }
+  _length += length;
+
+  if (_tail_size) {
+    int n = std::min<int>(16 - _tail_size, e - p);
+    memcpy(_tail + _tail_size, p, n);
+    _tail_size += n;
+    p += n;
+    if (_tail_size < 16) {
+      return true;
+    }
+    this->block(load64(_tail), load64(_tail + 8));
+    _tail_size = 0;
+  }
+
+  for (; e - p >= 16; p += 16) {
+    this->block(load64(p), load64(p + 8));
+  }
+
+  _tail_size = e - p;
+  memcpy(_tail, p, _tail_size);
+  return true;
+}
+
+bool
+MurmurHash3Context::finalize(CryptoHash &hash)
+{
+  uint64_t k1 = 0;
+  uint64_t k2 = 0;
+
+  // The last bytes go in low byte first, a partial block padded with zeros.
+  for (int i = _tail_size - 1; i >= 8; --i) {
+    k2 = (k2 << 8) | _tail[i];
+  }
+  for (int i = std::min(_tail_size, 8) - 1; i >= 0; --i) {
+    k1 = (k1 << 8) | _tail[i];
+  }
+  if (_tail_size > 8) {
+    k2 *= C2;
+    k2 = rotl64(k2, 33);
+    k2 *= C1;
+    _h2 ^= k2;
+  }
+  if (_tail_size > 0) {
+    k1 *= C1;
+    k1 = rotl64(k1, 31);
+    k1 *= C2;
+    _h1 ^= k1;
+  }
+
+  _h1 ^= _length;
+  _h2 ^= _length;
+
+  _h1 += _h2;
+  _h2 += _h1;
+
+  _h1 = fmix64(_h1);
+  _h2 = fmix64(_h2);
+
+  _h1 += _h2;
+  _h2 += _h1;
+
+  memset(&hash, 0, sizeof(hash));
+  hash.u64[0] = _h1;
+  hash.u64[1] = _h2;
+  return true;
+}
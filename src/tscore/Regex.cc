@@ -22,6 +22,8 @@
  */
 
 #include <array>
+#include <cstring>
+#include <string>
 
 #include "tscore/ink_platform.h"
 #include "tscore/ink_thread.h"
@@ -124,6 +126,31 @@ Regex::exec(std::string_view const &str, int *ovector, int ovecsize)
   return rv > 0;
 }
 
+bool
+Regex::exec(std::string_view const &str, const char *&mark)
+{
+  mark = nullptr;
+#ifdef PCRE_EXTRA_MARK
+  // The mark is returned through the extra data, which is shared by the threads.
+  pcre_extra extra;
+  if (regex_extra) {
+    extra = *regex_extra;
+  } else {
+    memset(&extra, 0, sizeof(extra));
+  }
+  unsigned char *name = nullptr;
+  extra.flags |= PCRE_EXTRA_MARK;
+  extra.mark = &name;
+
+  int ovector[3];
+  int rv = pcre_exec(regex, &extra, str.data(), int(str.size()), 0, 0, ovector, 3);
+  mark   = reinterpret_cast<const char *>(name);
+  return rv > 0;
+#else
+  return this->exec(str);
+#endif
+}
+
 Regex::~Regex()
 {
   if (regex_extra) {
@@ -153,15 +180,75 @@ DFA::build(std::string_view const &pattern, unsigned flags)
   if (!rxp.compile(string.c_str(), flags)) {
     return false;
   }
-  _patterns.emplace_back(std::move(rxp), std::move(string));
+  _patterns.emplace_back(std::move(rxp), std::move(string), flags);
   return true;
 }
 
+namespace
+{
+// Whether @a p means the same as an alternative of a larger pattern. Groups and recursion would
+// be numbered differently, and extended mode or a \Q quote could take in the text after @a p.
+bool
+is_combinable(Regex &rxp, std::string const &p)
+{
+  if (rxp.get_capture_count() != 0 || p.find("\\Q") != std::string::npos || p.find("(*") != std::string::npos ||
+      p.find("(?R") != std::string::npos || p.find("(?0") != std::string::npos) {
+    return false;
+  }
+  for (size_t pos = p.find("(?"); pos != std::string::npos; pos = p.find("(?", pos + 2)) {
+    for (size_t i = pos + 2; i < p.size() && (isalpha(p[i]) || p[i] == '-' || p[i] == '^'); ++i) {
+      if (p[i] == 'x') {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+} // namespace
+
+void
+DFA::combine()
+{
+  _combined.reset();
+#ifndef PCRE_EXTRA_MARK
+  // Marks came with PCRE 8.10.
+  return;
+#endif
+  if (_patterns.size() < 2) {
+    return;
+  }
+
+  unsigned flags = _patterns.front()._flags;
+  std::string text;
+  for (size_t i = 0; i < _patterns.size(); ++i) {
+    auto &pattern = _patterns[i];
+    // Unanchored patterns would match at the leftmost position rather than in order.
+    if (pattern._flags != flags || !(flags & RE_ANCHORED) || !is_combinable(pattern._re, pattern._p)) {
+      return;
+    }
+    if (i > 0) {
+      text += '|';
+    }
+    text += "(?:";
+    text += pattern._p;
+    text += ")(*MARK:";
+    text += std::to_string(i);
+    text += ')';
+  }
+
+  // This fails for a set too large for the pattern size limit, which matches one at a time.
+  auto rxp = std::make_unique<Regex>();
+  if (rxp->compile(text.c_str(), flags)) {
+    _combined = std::move(rxp);
+  }
+}
+
 int
 DFA::compile(std::string_view const &pattern, unsigned flags)
 {
   ink_assert(_patterns.empty());
   this->build(pattern, flags);
+  this->combine();
   return _patterns.size();
 }
 
@@ -172,6 +259,7 @@ DFA::compile(std::string_view *patterns, int npatterns, unsigned flags)
   for (int i = 0; i < npatterns; ++i) {
     this->build(patterns[i], flags);
   }
+  this->combine();
   return _patterns.size();
 }
 
@@ -182,12 +270,18 @@ DFA::compile(const char **patterns, int npatterns, unsigned flags)
   for (int i = 0; i < npatterns; ++i) {
     this->build(patterns[i], flags);
   }
+  this->combine();
   return _patterns.size();
 }
 
 int
 DFA::match(std::string_view const &str) const
 {
+  if (_combined) {
+    const char *mark = nullptr;
+    return (_combined->exec(str, mark) && mark) ? atoi(mark) : -1;
+  }
+
   // This is ugly, but the external interface needs to be @c const even though it's not really.
   // This handles making the iterator non-const.
   auto &pv{const_cast<decltype(_patterns) &>(_patterns)};
@@ -0,0 +1,143 @@
+/** @file
+
+  Cost of matching a set of patterns with a DFA.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+
+  @section details Details
+
+  Usage: benchmark_Regex [-p patterns] [-n iterations] [-j]
+
+  Compiles @a patterns anchored host name patterns into a @c DFA and matches names that match
+  patterns throughout the set and names that match none, with the @c DFA and with each pattern in
+  turn, as the @c DFA did before it combined its patterns. Both must find the same patterns. With
+  -j the results are JSON lines, for `make bench`.
+ */
+
+#include "tscore/ink_hrtime.h"
+#include "tscore/Regex.h"
+#include "bench_report.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+namespace
+{
+template <typename F>
+double
+time_names(std::vector<std::string> const &names, int iterations, F &&match)
+{
+  long found     = 0;
+  ink_hrtime now = ink_get_hrtime_internal();
+  for (int i = 0; i < iterations; ++i) {
+    for (auto const &name : names) {
+      found += match(name);
+    }
+  }
+  double seconds = static_cast<double>(ink_get_hrtime_internal() - now) / HRTIME_SECOND;
+  // Keep the matches from being optimized away.
+  if (found == -1) {
+    printf("%ld\n", found);
+  }
+  return seconds;
+}
+} // namespace
+
+int
+main(int argc, char *argv[])
+{
+  int n_patterns = 64;
+  int iterations = 100000;
+  bool json      = false;
+  int opt;
+  while ((opt = getopt(argc, argv, "p:n:j")) != -1) {
+    if (opt == 'p') {
+      n_patterns = atoi(optarg);
+    } else if (opt == 'n') {
+      iterations = atoi(optarg);
+    } else if (opt == 'j') {
+      json = true;
+    } else {
+      fprintf(stderr, "usage: %s [-p patterns] [-n iterations] [-j]\n", argv[0]);
+      return 1;
+    }
+  }
+  if (n_patterns <= 0 || iterations <= 0) {
+    fprintf(stderr, "%s: the counts must be positive\n", argv[0]);
+    return 1;
+  }
+
+  std::vector<std::string> texts;
+  std::vector<const char *> patterns;
+  std::vector<std::unique_ptr<Regex>> regexes;
+  char text[256];
+  for (int i = 0; i < n_patterns; ++i) {
+    snprintf(text, sizeof(text), i % 2 ? "[a-z]+\\.site%d\\.example\\.com" : "cdn%d-[0-9]+\\.example\\.net", i);
+    texts.emplace_back(text);
+  }
+  for (auto const &t : texts) {
+    patterns.push_back(t.c_str());
+    regexes.emplace_back(std::make_unique<Regex>());
+    if (!regexes.back()->compile(t.c_str(), RE_ANCHORED)) {
+      fprintf(stderr, "%s: failed to compile %s\n", argv[0], t.c_str());
+      return 1;
+    }
+  }
+  DFA dfa;
+  if (dfa.compile(patterns.data(), static_cast<int>(patterns.size())) != n_patterns) {
+    fprintf(stderr, "%s: failed to compile the DFA\n", argv[0]);
+    return 1;
+  }
+
+  std::vector<std::string> names;
+  for (int i = 0; i < 8; ++i) {
+    int pattern = n_patterns / 8 * i + n_patterns / 16;
+    snprintf(text, sizeof(text), pattern % 2 ? "www.site%d.example.com" : "cdn%d-17.example.net", pattern);
+    names.emplace_back(text);
+  }
+  names.emplace_back("www.nowhere.example.com");
+  names.emplace_back("cdn-17.example.net");
+
+  auto each = [&regexes](std::string const &name) -> int {
+    for (size_t i = 0; i < regexes.size(); ++i) {
+      if (regexes[i]->exec(name)) {
+        return i;
+      }
+    }
+    return -1;
+  };
+  auto combined = [&dfa](std::string const &name) -> int { return dfa.match(name); };
+
+  for (auto const &name : names) {
+    if (each(name) != combined(name)) {
+      fprintf(stderr, "%s: the matches found different patterns for %s\n", argv[0], name.c_str());
+      return 1;
+    }
+  }
+
+  int64_t matches = static_cast<int64_t>(names.size()) * iterations;
+  bench_report(json, "dfa_match_each_pattern", matches, time_names(names, iterations, each));
+  bench_report(json, "dfa_match", matches, time_names(names, iterations, combined));
+  return 0;
+}
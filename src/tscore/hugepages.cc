@@ -19,10 +19,14 @@
   limitations under the License.
  */
 
+#include <atomic>
 #include <cstdio>
+#include <mutex>
+#include <unordered_map>
 #include <sys/mman.h>
 #include "tscore/Diags.h"
 #include "tscore/ink_align.h"
+#include "tscore/hugepages.h"
 
 #define DEBUG_TAG "hugepages"
 
@@ -146,3 +150,135 @@ ats_free_hugepage(void *ptr, size_t s)
   return false;
 #endif
 }
+
+#ifndef MAP_HUGE_SHIFT
+#define MAP_HUGE_SHIFT 26
+#endif
+#ifndef MAP_HUGE_2MB
+#define MAP_HUGE_2MB (21 << MAP_HUGE_SHIFT)
+#endif
+#ifndef MAP_HUGE_1GB
+#define MAP_HUGE_1GB (30 << MAP_HUGE_SHIFT)
+#endif
+
+namespace
+{
+constexpr size_t HUGEPAGE_1G = static_cast<size_t>(1) << 30;
+
+struct ArenaEntry {
+  size_t size;
+  HugePageArenaKind kind;
+};
+
+int arena_mode = 0;
+std::mutex arena_mutex;
+std::unordered_map<void *, ArenaEntry> arenas;
+std::atomic<int64_t> arena_bytes[HUGEPAGE_ARENA_KINDS];
+
+#ifdef MAP_HUGETLB
+void *
+map_explicit(size_t size, int flags)
+{
+  void *mem = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | flags, -1, 0);
+  return mem == MAP_FAILED ? nullptr : mem;
+}
+#endif
+
+// Normal pages, but 2MB aligned so that the kernel can back all of it with transparent huge pages.
+void *
+map_aligned(size_t size)
+{
+  char *mem =
+    static_cast<char *>(mmap(nullptr, size + HUGEPAGE_ARENA_ALIGN, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+  if (mem == MAP_FAILED) {
+    return nullptr;
+  }
+  char *start = static_cast<char *>(align_pointer_forward(mem, HUGEPAGE_ARENA_ALIGN));
+  if (start > mem) {
+    munmap(mem, start - mem);
+  }
+  if (size_t tail = HUGEPAGE_ARENA_ALIGN - (start - mem)) {
+    munmap(start + size, tail);
+  }
+  return start;
+}
+} // namespace
+
+void
+ats_hugepage_arena_init(int mode)
+{
+  arena_mode = mode;
+  Debug(DEBUG_TAG "_init", "hugepage arenas %s",
+        mode == 0 ? "not enabled" : (mode == 1 ? "use 2MB pages" : "use 1GB and 2MB pages"));
+}
+
+bool
+ats_hugepage_arena_enabled()
+{
+  return arena_mode != 0;
+}
+
+void *
+ats_alloc_hugepage_arena(size_t s)
+{
+  if (arena_mode == 0 || s == 0) {
+    return nullptr;
+  }
+
+  void *mem              = nullptr;
+  size_t size            = INK_ALIGN(s, HUGEPAGE_ARENA_ALIGN);
+  HugePageArenaKind kind = HUGEPAGE_ARENA_NONE;
+
+#ifdef MAP_HUGETLB
+  // Only when rounding up to whole 1GB pages wastes less than an eighth.
+  size_t size_1g = INK_ALIGN(s, HUGEPAGE_1G);
+  if (arena_mode >= 2 && (size_1g - s) <= s / 8 && (mem = map_explicit(size_1g, MAP_HUGE_1GB)) != nullptr) {
+    size = size_1g;
+    kind = HUGEPAGE_ARENA_1G;
+  } else if ((mem = map_explicit(size, MAP_HUGE_2MB)) != nullptr) {
+    kind = HUGEPAGE_ARENA_2M;
+  }
+#endif
+  if (mem == nullptr) {
+    if ((mem = map_aligned(size)) == nullptr) {
+      Debug(DEBUG_TAG, "Could not allocate an arena of %zu bytes", size);
+      return nullptr;
+    }
+#ifdef MADV_HUGEPAGE
+    if (madvise(mem, size, MADV_HUGEPAGE) == 0) {
+      kind = HUGEPAGE_ARENA_THP;
+    }
+#endif
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(arena_mutex);
+    arenas[mem] = {size, kind};
+  }
+  arena_bytes[kind] += size;
+  Debug(DEBUG_TAG, "Arena request/allocation (%zu/%zu) kind %d {%p}", s, size, kind, mem);
+  return mem;
+}
+
+bool
+ats_free_hugepage_arena(void *ptr)
+{
+  ArenaEntry entry;
+  {
+    std::lock_guard<std::mutex> lock(arena_mutex);
+    auto spot = arenas.find(ptr);
+    if (spot == arenas.end()) {
+      return false;
+    }
+    entry = spot->second;
+    arenas.erase(spot);
+  }
+  arena_bytes[entry.kind] -= entry.size;
+  return munmap(ptr, entry.size) == 0;
+}
+
+int64_t
+ats_hugepage_arena_bytes(HugePageArenaKind kind)
+{
+  return arena_bytes[kind].load(std::memory_order_relaxed);
+}
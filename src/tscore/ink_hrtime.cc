@@ -41,6 +41,11 @@
 #endif
 #include <cstring>
 #include <sys/time.h>
+#if TS_HAS_TSC_CLOCK
+#include <cpuid.h>
+#endif
+
+InkTscClock ink_tsc_clock;
 
 char *
 int64_to_str(char *buf, unsigned int buf_size, int64_t val, unsigned int *total_chars, unsigned int req_width, char pad_char)
@@ -233,3 +238,95 @@ init_hrtime_basis()
   return b;
 }
 #endif
+
+#if TS_HAS_TSC_CLOCK && HAVE_CLOCK_GETTIME
+namespace
+{
+ink_hrtime
+system_clock(clockid_t id)
+{
+  timespec ts;
+  clock_gettime(id, &ts);
+  return ink_hrtime_from_timespec(&ts);
+}
+
+// The counter of an invariant TSC runs at a fixed rate in all power states.
+bool
+tsc_is_invariant()
+{
+  unsigned int eax, ebx, ecx, edx;
+  if (!__get_cpuid(0x80000000, &eax, &ebx, &ecx, &edx) || eax < 0x80000007) {
+    return false;
+  }
+  __get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx);
+  return (edx & (1 << 8)) != 0;
+}
+} // namespace
+
+bool
+ink_hrtime_tsc_init()
+{
+  if (ink_tsc_clock.enabled.load() || !tsc_is_invariant()) {
+    return ink_tsc_clock.enabled.load();
+  }
+
+  ink_hrtime start     = system_clock(CLOCK_MONOTONIC);
+  uint64_t start_tsc   = __builtin_ia32_rdtsc();
+  timespec calibration = {0, 20 * 1000 * 1000};
+  nanosleep(&calibration, nullptr);
+  ink_hrtime end   = system_clock(CLOCK_MONOTONIC);
+  uint64_t end_tsc = __builtin_ia32_rdtsc();
+  if (end_tsc <= start_tsc || end <= start) {
+    return false;
+  }
+
+  ink_tsc_clock.mult = (static_cast<unsigned __int128>(end - start) << InkTscClock::SHIFT) / (end_tsc - start_tsc);
+  if (ink_tsc_clock.mult == 0) {
+    return false;
+  }
+  ink_tsc_clock.base_tsc       = end_tsc;
+  ink_tsc_clock.base_time      = end;
+  ink_tsc_clock.last_tsc_time  = end;
+  ink_tsc_clock.last_mono_time = end;
+  ink_tsc_clock.realtime_offset.store(system_clock(CLOCK_REALTIME) - end);
+  ink_tsc_clock.next_check.store(end + InkTscClock::CHECK_INTERVAL);
+  ink_tsc_clock.enabled.store(true, std::memory_order_release);
+  return true;
+}
+
+void
+ink_hrtime_tsc_check(ink_hrtime now)
+{
+  ink_hrtime next = ink_tsc_clock.next_check.load();
+  // Another thread is checking, or has just checked.
+  if (now < next || !ink_tsc_clock.next_check.compare_exchange_strong(next, now + InkTscClock::CHECK_INTERVAL)) {
+    return;
+  }
+
+  ink_hrtime mono      = system_clock(CLOCK_MONOTONIC);
+  ink_hrtime real      = system_clock(CLOCK_REALTIME);
+  ink_hrtime tsc       = ink_get_hrtime_tsc();
+  ink_hrtime elapsed   = mono - ink_tsc_clock.last_mono_time;
+  ink_hrtime drift     = (tsc - ink_tsc_clock.last_tsc_time) - elapsed;
+  ink_hrtime max_drift = elapsed / 1000000 * InkTscClock::MAX_DRIFT_PPM + HRTIME_USECONDS(100);
+  if (drift > max_drift || drift < -max_drift) {
+    // The counter is not usable, e.g. after the VM migrated to another host.
+    ink_tsc_clock.enabled.store(false, std::memory_order_release);
+    return;
+  }
+  ink_tsc_clock.last_tsc_time  = tsc;
+  ink_tsc_clock.last_mono_time = mono;
+  ink_tsc_clock.realtime_offset.store(real - tsc, std::memory_order_relaxed);
+}
+#else
+bool
+ink_hrtime_tsc_init()
+{
+  return false;
+}
+
+void
+ink_hrtime_tsc_check(ink_hrtime /* now ATS_UNUSED */)
+{
+}
+#endif
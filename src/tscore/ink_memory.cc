@@ -26,12 +26,14 @@
 #include "tscore/ink_stack_trace.h"
 #include "tscore/Diags.h"
 #include "tscore/ink_atomic.h"
+#include "tscore/memory_domain.h"
 
 #if !defined(kfreebsd) && defined(freebsd)
 #include <malloc_np.h> // for malloc_usable_size
 #endif
 
 #include <cassert>
+#include <cstdint>
 #if defined(linux)
 // XXX: Shouldn't that be part of CPPFLAGS?
 #ifndef _XOPEN_SOURCE
@@ -56,7 +58,13 @@ ats_malloc(size_t size)
   // Useful for tracing bad mallocs
   // ink_stack_trace_dump();
   if (likely(size > 0)) {
-    if (unlikely((ptr = malloc(size)) == nullptr)) {
+#if TS_HAS_JEMALLOC
+    if (unlikely(ats_memory_domain_flags != 0)) {
+      ptr = mallocx(size, ats_memory_domain_flags);
+    } else
+#endif
+      ptr = malloc(size);
+    if (unlikely(ptr == nullptr)) {
       ink_abort("couldn't allocate %zu bytes", size);
     }
   }
@@ -66,7 +74,13 @@ ats_malloc(size_t size)
 void *
 ats_calloc(size_t nelem, size_t elsize)
 {
-  void *ptr = calloc(nelem, elsize);
+  void *ptr;
+#if TS_HAS_JEMALLOC
+  if (unlikely(ats_memory_domain_flags != 0) && nelem > 0 && elsize > 0 && nelem <= SIZE_MAX / elsize) {
+    ptr = mallocx(nelem * elsize, ats_memory_domain_flags | MALLOCX_ZERO);
+  } else
+#endif
+    ptr = calloc(nelem, elsize);
   if (unlikely(ptr == nullptr)) {
     ink_abort("couldn't allocate %zu %zu byte elements", nelem, elsize);
   }
@@ -76,7 +90,14 @@ ats_calloc(size_t nelem, size_t elsize)
 void *
 ats_realloc(void *ptr, size_t size)
 {
-  void *newptr = realloc(ptr, size);
+  void *newptr;
+#if TS_HAS_JEMALLOC
+  // Memory that has to move goes to the arena of the domain.
+  if (unlikely(ats_memory_domain_flags != 0) && size > 0) {
+    newptr = ptr ? rallocx(ptr, size, ats_memory_domain_flags) : mallocx(size, ats_memory_domain_flags);
+  } else
+#endif
+    newptr = realloc(ptr, size);
   if (unlikely(newptr == nullptr)) {
     ink_abort("couldn't reallocate %zu bytes", size);
   }
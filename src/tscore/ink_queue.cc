@@ -43,6 +43,7 @@
 #include <unistd.h>
 #include <sys/types.h>
 #include <sys/mman.h>
+#include <vector>
 #include "tscore/ink_atomic.h"
 #include "tscore/ink_queue.h"
 #include "tscore/ink_memory.h"
@@ -50,6 +51,7 @@
 #include "tscore/ink_assert.h"
 #include "tscore/ink_align.h"
 #include "tscore/hugepages.h"
+#include "tscore/numa.h"
 #include "tscore/Diags.h"
 #include "tscore/JeAllocator.h"
 
@@ -93,6 +95,60 @@ static const ink_freelist_ops *default_ops = &freelist_ops;
 
 static ink_freelist_list *freelists                = nullptr;
 static const ink_freelist_ops *freelist_global_ops = default_ops;
+static uint32_t freelist_count                     = 0;
+
+/*
+ * Magazines are small per thread stacks of free items in front of each
+ * freelist, as in Bonwick & Adams "Magazines and Vmem" (2001). A thread
+ * keeps a loaded and a previous magazine per freelist and only goes to the
+ * freelist's depot of full and empty magazines, one CAS for a whole
+ * magazine, when both are exhausted. The global freelist is only used when
+ * the depot has no full magazine either.
+ */
+struct ink_magazine {
+  ink_magazine *next; // depot link, must be first
+  uint32_t count;
+  void *rounds[1];
+};
+
+struct ink_magazine_cache {
+  InkFreeList *fl        = nullptr;
+  ink_magazine *loaded   = nullptr;
+  ink_magazine *previous = nullptr;
+  // Pending updates of the freelist counters, applied on depot trips.
+  int used        = 0;
+  uint64_t hits   = 0;
+  uint64_t misses = 0;
+};
+
+static void magazine_flush(ink_magazine_cache &c);
+
+struct ink_thread_magazines {
+  std::vector<ink_magazine_cache> caches;
+
+  ~ink_thread_magazines()
+  {
+    for (auto &c : caches) {
+      if (c.fl) {
+        magazine_flush(c);
+      }
+    }
+  }
+
+  ink_magazine_cache &
+  get(InkFreeList *f)
+  {
+    if (unlikely(f->mag_index >= caches.size())) {
+      caches.resize(freelist_count);
+    }
+    ink_magazine_cache &c = caches[f->mag_index];
+    c.fl                  = f;
+    return c;
+  }
+};
+
+static uint32_t magazine_size = 0;
+static thread_local ink_thread_magazines thread_magazines;
 
 const InkFreeListOps *
 ink_freelist_malloc_ops()
@@ -116,6 +172,17 @@ ink_freelist_init_ops(int nofl_class, int nofl_proxy)
   freelist_global_ops = (nofl_class || nofl_proxy) ? ink_freelist_malloc_ops() : ink_freelist_freelist_ops();
 }
 
+void
+ink_freelist_init_magazines(uint32_t size)
+{
+  // Items freed to malloc should go straight back to it, mostly to keep memory checkers useful.
+  if (freelist_global_ops == ink_freelist_malloc_ops()) {
+    size = 0;
+  }
+  magazine_size = size;
+  Debug(DEBUG_TAG "_init", "magazine size %" PRIu32, magazine_size);
+}
+
 void
 ink_freelist_init(InkFreeList **fl, const char *name, uint32_t type_size, uint32_t chunk_size, uint32_t alignment)
 {
@@ -132,7 +199,12 @@ ink_freelist_init(InkFreeList **fl, const char *name, uint32_t type_size, uint32
   fll->next = freelists;
   freelists = fll;
 
-  f->name = name;
+  f->name           = name;
+  f->numa_node      = -1;
+  f->hugepage_arena = false;
+  f->mag_index      = freelist_count++;
+  ink_atomiclist_init(&f->mag_full, name, 0);
+  ink_atomiclist_init(&f->mag_empty, name, 0);
   /* quick test for power of 2 */
   ink_assert(!(alignment & (alignment - 1)));
   // It is never useful to have alignment requirement looser than a page size
@@ -179,11 +251,129 @@ ink_freelist_create(const char *name, uint32_t type_size, uint32_t chunk_size, u
 int fake_global_for_ink_queue = 0;
 #endif
 
+static void
+magazine_sync(ink_magazine_cache &c)
+{
+  InkFreeList *f = c.fl;
+
+  if (c.used) {
+    ink_atomic_increment(reinterpret_cast<int *>(&f->used), c.used);
+    c.used = 0;
+  }
+  if (c.hits) {
+    ink_atomic_increment(&f->mag_hits, c.hits);
+    c.hits = 0;
+  }
+  if (c.misses) {
+    ink_atomic_increment(&f->mag_misses, c.misses);
+    c.misses = 0;
+  }
+}
+
+static ink_magazine *
+magazine_empty(InkFreeList *f)
+{
+  ink_magazine *m = static_cast<ink_magazine *>(ink_atomiclist_pop(&f->mag_empty));
+
+  if (m == nullptr) {
+    m = static_cast<ink_magazine *>(ats_malloc(sizeof(ink_magazine) + (magazine_size - 1) * sizeof(void *)));
+  }
+  m->next  = nullptr;
+  m->count = 0;
+  return m;
+}
+
+static void *
+magazine_new(InkFreeList *f)
+{
+  ink_magazine_cache &c = thread_magazines.get(f);
+
+  if (c.loaded == nullptr || c.loaded->count == 0) {
+    if (c.previous && c.previous->count) {
+      std::swap(c.loaded, c.previous);
+    } else {
+      ink_magazine *full = static_cast<ink_magazine *>(ink_atomiclist_pop(&f->mag_full));
+      if (full == nullptr) {
+        ++c.misses;
+        return nullptr;
+      }
+      if (c.previous) {
+        ink_atomiclist_push(&f->mag_empty, c.previous);
+      }
+      c.previous = c.loaded;
+      c.loaded   = full;
+      magazine_sync(c);
+    }
+  }
+  ++c.hits;
+  ++c.used;
+  return c.loaded->rounds[--c.loaded->count];
+}
+
+static void
+magazine_free(InkFreeList *f, void *item)
+{
+  ink_magazine_cache &c = thread_magazines.get(f);
+
+  if (c.loaded == nullptr) {
+    c.loaded = magazine_empty(f);
+  } else if (c.loaded->count == magazine_size) {
+    if (c.previous && c.previous->count == 0) {
+      std::swap(c.loaded, c.previous);
+    } else {
+      if (c.previous) {
+        ink_atomiclist_push(&f->mag_full, c.previous);
+      }
+      c.previous = c.loaded;
+      c.loaded   = magazine_empty(f);
+      magazine_sync(c);
+    }
+  }
+  --c.used;
+  c.loaded->rounds[c.loaded->count++] = item;
+}
+
+// Hand the magazines of an exiting thread back to the depot.
+static void
+magazine_flush(ink_magazine_cache &c)
+{
+  for (ink_magazine *m : {c.loaded, c.previous}) {
+    if (m == nullptr) {
+      continue;
+    }
+    if (m->count && m->count == magazine_size) {
+      ink_atomiclist_push(&c.fl->mag_full, m);
+    } else {
+      while (m->count) {
+        freelist_global_ops->fl_free(c.fl, m->rounds[--m->count]);
+      }
+      ink_atomiclist_push(&c.fl->mag_empty, m);
+    }
+  }
+  c.loaded = c.previous = nullptr;
+  magazine_sync(c);
+}
+
+void
+ink_freelist_use_hugepage_arena(InkFreeList *f)
+{
+  if (!ats_hugepage_arena_enabled()) {
+    return;
+  }
+  ink_release_assert(f->allocated == 0);
+  f->hugepage_arena = true;
+  f->chunk_size     = INK_ALIGN(static_cast<size_t>(f->chunk_size) * f->type_size, HUGEPAGE_ARENA_ALIGN) / f->type_size;
+  Debug(DEBUG_TAG "_init", "<%s> Chunk Size for hugepage arena (%" PRIu32 ")", f->name, f->chunk_size);
+}
+
 void *
 ink_freelist_new(InkFreeList *f)
 {
   void *ptr;
 
+  if (magazine_size && (ptr = magazine_new(f)) != nullptr) {
+    return ptr;
+  }
   if (likely(ptr = freelist_global_ops->fl_new(f))) {
     ink_atomic_increment(reinterpret_cast<int *>(&f->used), 1);
   }
@@ -206,7 +396,10 @@ freelist_new(InkFreeList *f)
       size_t alloc_size = f->chunk_size * f->type_size;
       size_t alignment  = 0;
 
-      if (ats_hugepage_enabled()) {
+      if (f->hugepage_arena) {
+        alignment = HUGEPAGE_ARENA_ALIGN;
+        newp      = ats_alloc_hugepage_arena(alloc_size);
+      } else if (ats_hugepage_enabled()) {
         alignment = ats_hugepage_size();
         newp      = ats_alloc_hugepage(alloc_size);
       }
@@ -219,6 +412,10 @@ freelist_new(InkFreeList *f)
       if (f->advice) {
         ats_madvise(static_cast<caddr_t>(newp), INK_ALIGN(alloc_size, alignment), f->advice);
       }
+      if (f->numa_node >= 0) {
+        // Before the items below touch the pages.
+        ats_numa_bind_area(newp, INK_ALIGN(alloc_size, alignment), f->numa_node);
+      }
       SET_FREELIST_POINTER_VERSION(item, newp, 0);
 
       ink_atomic_increment(reinterpret_cast<int *>(&f->allocated), f->chunk_size);
@@ -261,7 +458,7 @@ malloc_new(InkFreeList *f)
   void *newp = nullptr;
 
   if (f->alignment) {
-    newp = jna.allocate(f);
+    newp = (f->numa_node >= 0 ? jearena::globalJemallocNodumpAllocator(f->numa_node) : jna).allocate(f);
   } else {
     newp = ats_malloc(f->type_size);
   }
@@ -273,6 +470,10 @@ void
 ink_freelist_free(InkFreeList *f, void *item)
 {
   if (likely(item != nullptr)) {
+    if (magazine_size) {
+      magazine_free(f, item);
+      return;
+    }
     ink_assert(f->used != 0);
     freelist_global_ops->fl_free(f, item);
     ink_atomic_decrement(reinterpret_cast<int *>(&f->used), 1);
@@ -320,7 +521,7 @@ static void
 malloc_free(InkFreeList *f, void *item)
 {
   if (f->alignment) {
-    jna.deallocate(f, item);
+    (f->numa_node >= 0 ? jearena::globalJemallocNodumpAllocator(f->numa_node) : jna).deallocate(f, item);
   } else {
     ats_free(item);
   }
@@ -329,7 +530,8 @@ malloc_free(InkFreeList *f, void *item)
 void
 ink_freelist_free_bulk(InkFreeList *f, void *head, void *tail, size_t num_item)
 {
-  ink_assert(f->used >= num_item);
+  // With magazines the used count lags behind the threads, so it can not be checked here.
+  ink_assert(magazine_size || f->used >= num_item);
 
   freelist_global_ops->fl_bulkfree(f, head, tail, num_item);
   ink_atomic_decrement(reinterpret_cast<int *>(&f->used), num_item);
@@ -387,9 +589,10 @@ malloc_bulkfree(InkFreeList *f, void *head, void *tail, size_t num_item)
   (void)tail;
 
   if (f->alignment) {
+    auto &a = f->numa_node >= 0 ? jearena::globalJemallocNodumpAllocator(f->numa_node) : jna;
     for (size_t i = 0; i < num_item && item; ++i, item = next) {
       next = *static_cast<void **>(item); // find next item before freeing current item
-      jna.deallocate(f, item);
+      a.deallocate(f, item);
     }
   } else {
     for (size_t i = 0; i < num_item && item; ++i, item = next) {
@@ -445,17 +648,31 @@ ink_freelists_dump(FILE *f)
     f = stderr;
   }
 
-  fprintf(f, "     Allocated      |        In-Use      | Type Size  |   Free List Name\n");
-  fprintf(f, "--------------------|--------------------|------------|----------------------------------\n");
+  if (magazine_size) {
+    fprintf(f, "     Allocated      |        In-Use      | Type Size  |   Magazine Hits    |  Magazine Misses   |"
+               "   Free List Name\n");
+    fprintf(f, "--------------------|--------------------|------------|--------------------|--------------------|"
+               "----------------------------------\n");
+  } else {
+    fprintf(f, "     Allocated      |        In-Use      | Type Size  |   Free List Name\n");
+    fprintf(f, "--------------------|--------------------|------------|----------------------------------\n");
+  }
 
   uint64_t total_allocated = 0;
   uint64_t total_used      = 0;
   fll                      = freelists;
   while (fll) {
-    fprintf(f, " %18" PRIu64 " | %18" PRIu64 " | %10u | memory/%s\n",
-            static_cast<uint64_t>(fll->fl->allocated) * static_cast<uint64_t>(fll->fl->type_size),
-            static_cast<uint64_t>(fll->fl->used) * static_cast<uint64_t>(fll->fl->type_size), fll->fl->type_size,
-            fll->fl->name ? fll->fl->name : "<unknown>");
+    if (magazine_size) {
+      fprintf(f, " %18" PRIu64 " | %18" PRIu64 " | %10u | %18" PRIu64 " | %18" PRIu64 " | memory/%s\n",
+              static_cast<uint64_t>(fll->fl->allocated) * static_cast<uint64_t>(fll->fl->type_size),
+              static_cast<uint64_t>(fll->fl->used) * static_cast<uint64_t>(fll->fl->type_size), fll->fl->type_size,
+              fll->fl->mag_hits, fll->fl->mag_misses, fll->fl->name ? fll->fl->name : "<unknown>");
+    } else {
+      fprintf(f, " %18" PRIu64 " | %18" PRIu64 " | %10u | memory/%s\n",
+              static_cast<uint64_t>(fll->fl->allocated) * static_cast<uint64_t>(fll->fl->type_size),
+              static_cast<uint64_t>(fll->fl->used) * static_cast<uint64_t>(fll->fl->type_size), fll->fl->type_size,
+              fll->fl->name ? fll->fl->name : "<unknown>");
+    }
     total_allocated += static_cast<uint64_t>(fll->fl->allocated) * static_cast<uint64_t>(fll->fl->type_size);
     total_used += static_cast<uint64_t>(fll->fl->used) * static_cast<uint64_t>(fll->fl->type_size);
     fll = fll->next;
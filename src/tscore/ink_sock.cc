@@ -32,6 +32,8 @@
 #include "tscore/ink_string.h"
 #include "tscore/ink_inet.h"
 
+#include <algorithm>
+
 //
 // Compilation options
 //
@@ -313,3 +315,96 @@ fail:
   errno = errsav;
   return -1;
 }
+
+// The most descriptors sent or received in a message.
+static const int MAX_FDS = 64;
+
+#ifndef MSG_CMSG_CLOEXEC
+#define MSG_CMSG_CLOEXEC 0
+#endif
+
+int
+send_fds(int s, const int *fds, int nfds, const void *data, size_t len)
+{
+  struct msghdr msg;
+  struct iovec iov;
+  char control[CMSG_SPACE(sizeof(int) * MAX_FDS)];
+  int r;
+
+  if (nfds < 0 || nfds > MAX_FDS || len == 0) {
+    errno = EINVAL;
+    return -1;
+  }
+
+  ink_zero(msg);
+  iov.iov_base   = const_cast<void *>(data);
+  iov.iov_len    = len;
+  msg.msg_iov    = &iov;
+  msg.msg_iovlen = 1;
+
+  if (nfds > 0) {
+    memset(control, 0, sizeof(control));
+    msg.msg_control    = control;
+    msg.msg_controllen = CMSG_SPACE(sizeof(int) * nfds);
+
+    struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level     = SOL_SOCKET;
+    cmsg->cmsg_type      = SCM_RIGHTS;
+    cmsg->cmsg_len       = CMSG_LEN(sizeof(int) * nfds);
+    memcpy(CMSG_DATA(cmsg), fds, sizeof(int) * nfds);
+  }
+
+  do {
+    r = sendmsg(s, &msg, 0);
+  } while (r < 0 && errno == EINTR);
+
+  return r;
+}
+
+int
+recv_fds(int s, int *fds, int *nfds, void *data, size_t len)
+{
+  struct msghdr msg;
+  struct iovec iov;
+  char control[CMSG_SPACE(sizeof(int) * MAX_FDS)];
+  int max_fds = std::min(*nfds, MAX_FDS);
+  int r;
+
+  ink_zero(msg);
+  iov.iov_base       = data;
+  iov.iov_len        = len;
+  msg.msg_iov        = &iov;
+  msg.msg_iovlen     = 1;
+  msg.msg_control    = control;
+  msg.msg_controllen = sizeof(control);
+
+  *nfds = 0;
+  do {
+    r = recvmsg(s, &msg, MSG_CMSG_CLOEXEC);
+  } while (r < 0 && errno == EINTR);
+  if (r < 0) {
+    return r;
+  }
+
+  for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg); cmsg != nullptr; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+    if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS) {
+      continue;
+    }
+
+    int n         = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+    int *received = reinterpret_cast<int *>(CMSG_DATA(cmsg));
+    for (int i = 0; i < n; ++i) {
+      if (*nfds < max_fds) {
+        if (MSG_CMSG_CLOEXEC == 0) {
+          safe_fcntl(received[i], F_SETFD, FD_CLOEXEC);
+        }
+        fds[(*nfds)++] = received[i];
+      } else {
+        // no room for it, do not leak it
+        close(received[i]);
+      }
+    }
+  }
+
+  return r;
+}
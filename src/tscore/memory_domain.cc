@@ -0,0 +1,222 @@
+/** @file
+
+  Allocation accounting by subsystem, see memory_domain.h
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "tscore/ink_config.h"
+#include "tscore/memory_domain.h"
+#include "tscore/ink_hrtime.h"
+#include "tscore/ink_assert.h"
+#include "tscore/Diags.h"
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+
+#if TS_HAS_JEMALLOC
+#include <jemalloc/jemalloc.h>
+#if JEMALLOC_VERSION_MAJOR >= 5
+#define MEMORY_DOMAIN_ARENAS_SUPPORTED 1
+#endif
+#endif /* TS_HAS_JEMALLOC */
+
+thread_local int ats_memory_domain_flags = 0;
+
+namespace
+{
+const char *const domain_names[MEMORY_DOMAINS] = {"untagged", "hostdb", "hdr_heap", "ssl", "plugin", "freelist"};
+
+/// Arenas of a domain, the one of its own first if there is one.
+constexpr int MAX_DOMAIN_ARENAS = 64;
+
+struct Domain {
+  std::atomic<int> n_arenas{0};
+  unsigned arenas[MAX_DOMAIN_ARENAS];
+  std::atomic<int64_t> charged{0};
+  std::atomic<int64_t> arena_bytes{0}; ///< As of the last refresh.
+};
+
+Domain domains[MEMORY_DOMAINS];
+bool domains_enabled = false;
+
+#if MEMORY_DOMAIN_ARENAS_SUPPORTED
+/// A tcache of each domain for each thread, plus one, 0 until the thread first needs it.
+thread_local unsigned domain_tcaches[MEMORY_DOMAINS];
+
+std::atomic<ink_hrtime> last_refresh{0};
+std::atomic<int64_t> total_bytes{0};
+
+int64_t
+arena_allocated(unsigned arena)
+{
+  int64_t total = 0;
+  for (const char *kind : {"small", "large"}) {
+    char name[64];
+    size_t value;
+    size_t len = sizeof(value);
+    snprintf(name, sizeof(name), "stats.arenas.%u.%s.allocated", arena, kind);
+    if (mallctl(name, &value, &len, nullptr, 0) == 0) {
+      total += value;
+    }
+  }
+  return total;
+}
+
+// jemalloc sums up its statistics when the epoch is advanced, do it at most once a second for all
+// the domains.
+void
+refresh()
+{
+  ink_hrtime now  = ink_get_hrtime_internal();
+  ink_hrtime last = last_refresh.load(std::memory_order_relaxed);
+  if (now - last < HRTIME_SECOND || !last_refresh.compare_exchange_strong(last, now)) {
+    return;
+  }
+
+  uint64_t epoch = 1;
+  size_t len     = sizeof(epoch);
+  mallctl("epoch", &epoch, &len, &epoch, len);
+
+  size_t allocated = 0;
+  len              = sizeof(allocated);
+  if (mallctl("stats.allocated", &allocated, &len, nullptr, 0) == 0) {
+    total_bytes = allocated;
+  }
+  for (int d = MEMORY_DOMAIN_UNTAGGED + 1; d < MEMORY_DOMAINS; ++d) {
+    int64_t bytes = 0;
+    int n         = domains[d].n_arenas.load(std::memory_order_acquire);
+    for (int i = 0; i < n; ++i) {
+      bytes += arena_allocated(domains[d].arenas[i]);
+    }
+    domains[d].arena_bytes = bytes;
+  }
+}
+#endif /* MEMORY_DOMAIN_ARENAS_SUPPORTED */
+} // namespace
+
+const char *
+ats_memory_domain_name(MemoryDomain domain)
+{
+  return domain_names[domain];
+}
+
+void
+ats_memory_domain_attach_arena(MemoryDomain domain, unsigned arena)
+{
+  static std::mutex attach_mutex;
+  std::lock_guard<std::mutex> lock(attach_mutex);
+
+  Domain &d = domains[domain];
+  int n     = d.n_arenas.load(std::memory_order_relaxed);
+  if (n < MAX_DOMAIN_ARENAS) {
+    d.arenas[n] = arena;
+    d.n_arenas.store(n + 1, std::memory_order_release);
+  }
+}
+
+void
+ats_memory_domain_init(bool enable)
+{
+#if MEMORY_DOMAIN_ARENAS_SUPPORTED
+  if (!enable || domains_enabled) {
+    return;
+  }
+  // The freelist domain only has the arenas of JeAllocator.
+  for (int d = MEMORY_DOMAIN_UNTAGGED + 1; d < MEMORY_DOMAIN_FREELIST; ++d) {
+    unsigned arena;
+    size_t len = sizeof(arena);
+    if (auto ret = mallctl("arenas.create", &arena, &len, nullptr, 0)) {
+      Warning("unable to create a jemalloc arena for memory domain %s: %s", domain_names[d], strerror(ret));
+      return;
+    }
+    // The arena of the domain must come first, it is the one allocated from.
+    ink_release_assert(domains[d].n_arenas == 0);
+    ats_memory_domain_attach_arena(static_cast<MemoryDomain>(d), arena);
+  }
+  domains_enabled = true;
+#else
+  if (enable) {
+    Warning("memory domains need jemalloc 5 or later, only the charged bytes are counted");
+  }
+#endif
+}
+
+bool
+ats_memory_domain_enabled()
+{
+  return domains_enabled;
+}
+
+int
+ats_memory_domain_enter(MemoryDomain domain)
+{
+  int saved = ats_memory_domain_flags;
+
+#if MEMORY_DOMAIN_ARENAS_SUPPORTED
+  if (domains_enabled && domain > MEMORY_DOMAIN_UNTAGGED && domain < MEMORY_DOMAIN_FREELIST) {
+    // Without a tcache of its own for the domain, a thread's cache would hand out memory of
+    // other arenas.
+    unsigned &tcache = domain_tcaches[domain];
+    if (tcache == 0) {
+      unsigned id;
+      size_t len = sizeof(id);
+      tcache     = mallctl("tcache.create", &id, &len, nullptr, 0) == 0 ? id + 1 : UINT32_MAX;
+    }
+    ats_memory_domain_flags = MALLOCX_ARENA(domains[domain].arenas[0]) |
+                              (tcache == UINT32_MAX ? MALLOCX_TCACHE_NONE : MALLOCX_TCACHE(tcache - 1));
+  } else {
+    ats_memory_domain_flags = 0;
+  }
+#else
+  (void)domain;
+#endif
+
+  return saved;
+}
+
+void
+ats_memory_domain_charge(MemoryDomain domain, int64_t bytes)
+{
+  domains[domain].charged.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+int64_t
+ats_memory_domain_live_bytes(MemoryDomain domain)
+{
+  int64_t bytes = domains[domain].charged.load(std::memory_order_relaxed);
+
+#if MEMORY_DOMAIN_ARENAS_SUPPORTED
+  refresh();
+  if (domain == MEMORY_DOMAIN_UNTAGGED) {
+    // All that jemalloc has handed out, less what is in the arenas of the other domains.
+    bytes += total_bytes.load(std::memory_order_relaxed);
+    for (int d = MEMORY_DOMAIN_UNTAGGED + 1; d < MEMORY_DOMAINS; ++d) {
+      bytes -= domains[d].arena_bytes.load(std::memory_order_relaxed);
+    }
+  } else {
+    bytes += domains[domain].arena_bytes.load(std::memory_order_relaxed);
+  }
+#endif
+
+  return bytes;
+}
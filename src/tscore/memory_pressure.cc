@@ -0,0 +1,130 @@
+/** @file
+
+  Process memory usage and the memory pressure level, see memory_pressure.h
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "tscore/ink_config.h"
+#include "tscore/memory_pressure.h"
+#include "tscore/ink_memory.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <unistd.h>
+
+#if !TS_HAS_JEMALLOC && defined(__GLIBC__)
+#include <malloc.h> // malloc_trim
+#endif
+
+std::atomic<int> ats_memory_pressure{MEMORY_PRESSURE_NONE};
+
+namespace
+{
+// Above this a cgroup limit is "max", the kernel reports it as the largest page aligned value.
+constexpr int64_t CGROUP_NO_LIMIT = int64_t(1) << 60;
+
+int64_t
+read_limit(const std::string &path)
+{
+  FILE *fp = fopen(path.c_str(), "r");
+  if (fp == nullptr) {
+    return -1;
+  }
+  char buf[64] = {0};
+  bool got     = fgets(buf, sizeof(buf), fp) != nullptr;
+  fclose(fp);
+  if (!got) {
+    return -1;
+  }
+  if (strncmp(buf, "max", 3) == 0) {
+    return 0;
+  }
+  int64_t limit = strtoll(buf, nullptr, 10);
+  return limit <= 0 || limit >= CGROUP_NO_LIMIT ? 0 : limit;
+}
+} // namespace
+
+int64_t
+ats_memory_rss()
+{
+#if defined(linux)
+  FILE *fp = fopen("/proc/self/statm", "r");
+  if (fp == nullptr) {
+    return 0;
+  }
+  long size     = 0;
+  long resident = 0;
+  int n         = fscanf(fp, "%ld %ld", &size, &resident);
+  fclose(fp);
+  return n == 2 ? static_cast<int64_t>(resident) * sysconf(_SC_PAGESIZE) : 0;
+#else
+  return 0;
+#endif
+}
+
+int64_t
+ats_memory_cgroup_limit()
+{
+  // Our cgroup in the v2 hierarchy or the memory controller of v1, then the root of the hierarchy
+  // which is what a container sees.
+  std::string v2_path;
+  std::string v1_path;
+  if (FILE *fp = fopen("/proc/self/cgroup", "r"); fp != nullptr) {
+    char line[1024];
+    while (fgets(line, sizeof(line), fp) != nullptr) {
+      line[strcspn(line, "\n")] = '\0';
+      if (strncmp(line, "0::", 3) == 0) {
+        v2_path = line + 3;
+      } else if (const char *memory = strstr(line, ":memory:"); memory != nullptr) {
+        v1_path = memory + 8;
+      }
+    }
+    fclose(fp);
+  }
+
+  int64_t limit = -1;
+  if (!v2_path.empty() && v2_path != "/") {
+    limit = read_limit("/sys/fs/cgroup" + v2_path + "/memory.max");
+  }
+  if (limit < 0) {
+    limit = read_limit("/sys/fs/cgroup/memory.max");
+  }
+  if (limit < 0 && !v1_path.empty() && v1_path != "/") {
+    limit = read_limit("/sys/fs/cgroup/memory" + v1_path + "/memory.limit_in_bytes");
+  }
+  if (limit < 0) {
+    limit = read_limit("/sys/fs/cgroup/memory/memory.limit_in_bytes");
+  }
+  return limit < 0 ? 0 : limit;
+}
+
+void
+ats_malloc_trim()
+{
+#if TS_HAS_JEMALLOC && defined(MALLCTL_ARENAS_ALL)
+  char name[64];
+  snprintf(name, sizeof(name), "arena.%u.purge", static_cast<unsigned>(MALLCTL_ARENAS_ALL));
+  mallctl(name, nullptr, nullptr, nullptr, 0);
+#elif !TS_HAS_JEMALLOC && defined(__GLIBC__)
+  malloc_trim(0);
+#endif
+}
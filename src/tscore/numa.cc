@@ -0,0 +1,199 @@
+/** @file
+
+  NUMA node helpers
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include <cstdio>
+#include <sys/stat.h>
+#include "tscore/ink_defs.h"
+#include "tscore/Diags.h"
+#include "tscore/numa.h"
+
+#if TS_USE_HWLOC
+#include <hwloc.h>
+#endif
+#if defined(linux)
+#include <sys/sysmacros.h>
+#endif
+
+#define DEBUG_TAG "numa"
+
+static int numa_node_count               = 1;
+static bool numa_enabled                 = false;
+static thread_local int numa_thread_node = -1;
+
+#if TS_USE_HWLOC
+static hwloc_obj_t
+numa_node_obj(int node)
+{
+  return hwloc_get_obj_by_type(ink_get_topology(), HWLOC_OBJ_NODE, node);
+}
+#endif
+
+void
+ats_numa_init(int enabled)
+{
+#if TS_USE_HWLOC
+  int n = hwloc_get_nbobjs_by_type(ink_get_topology(), HWLOC_OBJ_NODE);
+
+  if (!enabled) {
+    Debug(DEBUG_TAG "_init", "NUMA local allocation not enabled");
+    return;
+  }
+  if (n <= 1) {
+    Debug(DEBUG_TAG "_init", "%d NUMA node, NUMA local allocation not needed", n);
+    return;
+  }
+  if (n > TS_MAX_NUMA_NODES) {
+    Warning("%d NUMA nodes found, only the first %d get local allocation", n, TS_MAX_NUMA_NODES);
+    n = TS_MAX_NUMA_NODES;
+  }
+  numa_node_count = n;
+  numa_enabled    = true;
+  Debug(DEBUG_TAG "_init", "NUMA local allocation enabled for %d nodes", numa_node_count);
+#else
+  if (enabled) {
+    Warning("NUMA local allocation needs hwloc, it is not enabled");
+  }
+#endif
+}
+
+bool
+ats_numa_enabled()
+{
+  return numa_enabled;
+}
+
+int
+ats_numa_node_count()
+{
+  return numa_node_count;
+}
+
+int
+ats_numa_thread_node()
+{
+  return numa_thread_node;
+}
+
+void
+ats_numa_set_thread_node(int node)
+{
+  numa_thread_node = (numa_enabled && node < numa_node_count) ? node : -1;
+}
+
+int
+ats_numa_node_of_thread_binding()
+{
+  int node = -1;
+#if TS_USE_HWLOC
+  if (numa_enabled) {
+    hwloc_cpuset_t set = hwloc_bitmap_alloc();
+    if (hwloc_get_cpubind(ink_get_topology(), set, HWLOC_CPUBIND_THREAD) == 0) {
+      for (int i = 0; i < numa_node_count; ++i) {
+        if (hwloc_bitmap_isincluded(set, numa_node_obj(i)->cpuset)) {
+          node = i;
+          break;
+        }
+      }
+    }
+    hwloc_bitmap_free(set);
+  }
+#endif
+  return node;
+}
+
+bool
+ats_numa_bind_thread(int node)
+{
+#if TS_USE_HWLOC
+  if (numa_enabled && node >= 0 && node < numa_node_count) {
+    if (hwloc_set_cpubind(ink_get_topology(), numa_node_obj(node)->cpuset, HWLOC_CPUBIND_THREAD) == 0) {
+      numa_thread_node = node;
+      return true;
+    }
+    Debug(DEBUG_TAG, "failed to bind thread to node %d: %s", node, strerror(errno));
+  }
+#endif
+  return false;
+}
+
+bool
+ats_numa_bind_area(void *addr, size_t len, int node)
+{
+#if TS_USE_HWLOC
+  if (numa_enabled && node >= 0 && node < numa_node_count && addr && len) {
+    hwloc_obj_t obj = numa_node_obj(node);
+#if HWLOC_API_VERSION >= 0x20000
+    int ret = hwloc_set_area_membind(ink_get_topology(), addr, len, obj->nodeset, HWLOC_MEMBIND_BIND, HWLOC_MEMBIND_BYNODESET);
+#else
+    int ret = hwloc_set_area_membind_nodeset(ink_get_topology(), addr, len, obj->nodeset, HWLOC_MEMBIND_BIND, 0);
+#endif
+    if (ret == 0) {
+      return true;
+    }
+    Debug(DEBUG_TAG, "failed to bind %zu bytes at %p to node %d: %s", len, addr, node, strerror(errno));
+  }
+#endif
+  return false;
+}
+
+int
+ats_numa_node_of_fd(int fd)
+{
+#if TS_USE_HWLOC && defined(linux)
+  struct stat st;
+
+  if (!numa_enabled || fstat(fd, &st) != 0) {
+    return -1;
+  }
+  // A raw device is its own block device, a file lives on the one holding its file system.
+  dev_t dev = S_ISBLK(st.st_mode) ? st.st_rdev : st.st_dev;
+  // The device itself, its controller (NVMe namespaces) and the same for the disk of a partition.
+  static const char *const candidates[] = {"device/numa_node", "device/device/numa_node", "../device/numa_node",
+                                           "../device/device/numa_node"};
+
+  for (const char *c : candidates) {
+    char path[PATH_NAME_MAX];
+    snprintf(path, sizeof(path), "/sys/dev/block/%u:%u/%s", major(dev), minor(dev), c);
+    FILE *fp = fopen(path, "r");
+    if (fp == nullptr) {
+      continue;
+    }
+    int os_index = -1;
+    int n        = fscanf(fp, "%d", &os_index);
+    fclose(fp);
+    if (n != 1 || os_index < 0) {
+      continue;
+    }
+    // sysfs gives the OS index, everything here uses the hwloc logical one.
+    for (int i = 0; i < numa_node_count; ++i) {
+      if (static_cast<int>(numa_node_obj(i)->os_index) == os_index) {
+        Debug(DEBUG_TAG, "fd %d (device %u:%u) is on node %d", fd, major(dev), minor(dev), i);
+        return i;
+      }
+    }
+  }
+#else
+  (void)fd;
+#endif
+  return -1;
+}
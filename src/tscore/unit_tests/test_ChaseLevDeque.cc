@@ -0,0 +1,119 @@
+/** @file
+
+    Unit tests for ChaseLevDeque.
+
+    @section license License
+
+    Licensed to the Apache Software Foundation (ASF) under one
+    or more contributor license agreements.  See the NOTICE file
+    distributed with this work for additional information
+    regarding copyright ownership.  The ASF licenses this file
+    to you under the Apache License, Version 2.0 (the
+    "License"); you may not use this file except in compliance
+    with the License.  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "tscore/ChaseLevDeque.h"
+#include "catch.hpp"
+
+TEST_CASE("ChaseLevDeque owner", "[libts][ChaseLevDeque]")
+{
+  ts::ChaseLevDeque<intptr_t> dq(5);
+  intptr_t v = 0;
+
+  REQUIRE(dq.capacity() == 8);
+  REQUIRE(dq.empty());
+  REQUIRE(!dq.pop(v));
+  REQUIRE(!dq.steal(v));
+
+  for (intptr_t i = 1; i <= 8; ++i) {
+    REQUIRE(dq.push(i));
+  }
+  REQUIRE(dq.size() == 8);
+  REQUIRE(!dq.push(9));
+
+  // bottom is LIFO, top is FIFO
+  REQUIRE(dq.pop(v));
+  REQUIRE(v == 8);
+  REQUIRE(dq.steal(v));
+  REQUIRE(v == 1);
+  REQUIRE(dq.size() == 6);
+
+  // the slot freed by steal can be reused
+  REQUIRE(dq.push(10));
+  REQUIRE(dq.push(11));
+  REQUIRE(!dq.push(12));
+
+  std::vector<intptr_t> order;
+  while (dq.steal(v)) {
+    order.push_back(v);
+  }
+  REQUIRE(order == std::vector<intptr_t>{2, 3, 4, 5, 6, 7, 10, 11});
+  REQUIRE(dq.empty());
+}
+
+TEST_CASE("ChaseLevDeque thieves", "[libts][ChaseLevDeque]")
+{
+  static constexpr int N_ITEMS   = 200000;
+  static constexpr int N_THIEVES = 4;
+
+  ts::ChaseLevDeque<intptr_t> dq(64);
+  std::vector<std::atomic<int>> seen(N_ITEMS);
+  std::atomic<bool> done{false};
+
+  for (auto &s : seen) {
+    s = 0;
+  }
+
+  std::vector<std::thread> thieves;
+  for (int i = 0; i < N_THIEVES; ++i) {
+    thieves.emplace_back([&]() {
+      intptr_t v;
+      while (!done.load() || !dq.empty()) {
+        if (dq.steal(v)) {
+          ++seen[v];
+        }
+      }
+    });
+  }
+
+  // Owner alternates pushing and popping so both ends are contended.
+  intptr_t v;
+  for (intptr_t i = 0; i < N_ITEMS; ++i) {
+    while (!dq.push(i)) {
+      if (dq.pop(v)) {
+        ++seen[v];
+      }
+    }
+    if (i % 3 == 0 && dq.pop(v)) {
+      ++seen[v];
+    }
+  }
+  while (dq.pop(v)) {
+    ++seen[v];
+  }
+  done = true;
+  for (auto &t : thieves) {
+    t.join();
+  }
+
+  int missing = 0, duplicated = 0;
+  for (auto &s : seen) {
+    missing += s.load() == 0;
+    duplicated += s.load() > 1;
+  }
+  REQUIRE(missing == 0);
+  REQUIRE(duplicated == 0);
+}
@@ -0,0 +1,111 @@
+/** @file
+
+    Unit tests for the consistent hash ring with bounded loads.
+
+    @section license License
+
+    Licensed to the Apache Software Foundation (ASF) under one
+    or more contributor license agreements.  See the NOTICE file
+    distributed with this work for additional information
+    regarding copyright ownership.  The ASF licenses this file
+    to you under the Apache License, Version 2.0 (the
+    "License"); you may not use this file except in compliance
+    with the License.  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "tscore/ConsistentHash.h"
+#include "tscore/HashSip.h"
+#include "catch.hpp"
+
+TEST_CASE("ConsistentHash bounded loads", "[libts][ConsistentHash]")
+{
+  ATSHash64Sip24 hash;
+  ATSConsistentHash ring;
+  ATSConsistentHashNode nodes[3];
+  char names[3][8] = {"one", "two", "three"};
+
+  for (int i = 0; i < 3; ++i) {
+    nodes[i].available = true;
+    nodes[i].name      = names[i];
+    ring.insert(&nodes[i], 1, &hash);
+  }
+
+  const uint64_t hashval      = 0x5bd1e995;
+  ATSConsistentHashNode *home = ring.lookup_by_hashval(hashval);
+
+  REQUIRE(home != nullptr);
+  CHECK(ring.lookup_bounded(hashval, 0.25) == home);
+  CHECK_FALSE(ring.overloaded(home, 0.25));
+
+  // With every request in flight on it, the node is over its share and the next one is used.
+  ring.acquire(home);
+  CHECK(ring.overloaded(home, 0.25));
+  ATSConsistentHashNode *next = ring.lookup_bounded(hashval, 0.25);
+  CHECK(next != home);
+  CHECK(ring.lookup_by_hashval(hashval) == home);
+  CHECK(ring.lookup_bounded(hashval, 0) == home);
+
+  // A larger epsilon allows more.
+  CHECK_FALSE(ring.overloaded(home, 2));
+
+  // Spread over the ring, no node is over its share.
+  ring.acquire(next);
+  for (auto &node : nodes) {
+    if (&node != home && &node != next) {
+      ring.acquire(&node);
+    }
+  }
+  CHECK(ring.lookup_bounded(hashval, 0.25) == home);
+
+  for (auto &node : nodes) {
+    ring.release(&node);
+  }
+  CHECK(ring.lookup_bounded(hashval, 0.25) == home);
+  CHECK(nodes[0].load == 0);
+}
+
+TEST_CASE("ConsistentHash Maglev table", "[libts][ConsistentHash]")
+{
+  ATSHash64Sip24 hash;
+  ATSConsistentHash ring;
+  ATSConsistentHashNode nodes[3];
+  char names[3][8] = {"one", "two", "three"};
+  float weights[3] = {1, 1, 2};
+
+  for (int i = 0; i < 3; ++i) {
+    nodes[i].available = true;
+    nodes[i].name      = names[i];
+    ring.insert(&nodes[i], weights[i], &hash);
+  }
+  ring.build_table();
+
+  int hits[3] = {0, 0, 0};
+  for (uint64_t key = 0; key < 40000; ++key) {
+    hash.update(&key, sizeof(key));
+    hash.final();
+    ATSConsistentHashIter iter;
+    ATSConsistentHashNode *node = ring.lookup_bounded(hash.get(), 0, &iter);
+    hash.clear();
+
+    REQUIRE(node != nullptr);
+    ++hits[node - nodes];
+    // The lookups after the first one go on around the ring.
+    CHECK(ring.lookup(nullptr, &iter, nullptr, &hash) != nullptr);
+  }
+
+  // The shares follow the weights.
+  CHECK(hits[0] > 9000);
+  CHECK(hits[0] < 11000);
+  CHECK(hits[1] > 9000);
+  CHECK(hits[1] < 11000);
+  CHECK(hits[2] > 19000);
+  CHECK(hits[2] < 21000);
+}
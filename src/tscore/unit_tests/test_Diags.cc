@@ -0,0 +1,85 @@
+/** @file
+
+    Unit tests for the cached debug tags of the call sites.
+
+    @section license License
+
+    Licensed to the Apache Software Foundation (ASF) under one
+    or more contributor license agreements.  See the NOTICE file
+    distributed with this work for additional information
+    regarding copyright ownership.  The ASF licenses this file
+    to you under the Apache License, Version 2.0 (the
+    "License"); you may not use this file except in compliance
+    with the License.  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "catch.hpp"
+
+#include <string>
+
+#include "tscore/Diags.h"
+
+namespace
+{
+bool
+literal_on()
+{
+  return is_debug_tag_set("test_diags.literal");
+}
+
+bool
+variable_on(const char *tag)
+{
+  return is_debug_tag_set(tag);
+}
+} // namespace
+
+TEST_CASE("Diags tag sites", "[libts][Diags]")
+{
+  Diags *saved = diags;
+
+  diags                                     = new Diags("test_diags", nullptr, nullptr, nullptr);
+  diags->config.enabled[DiagsTagType_Debug] = 1;
+
+  SECTION("a literal tag follows the tag list")
+  {
+    CHECK_FALSE(literal_on());
+    diags->activate_taglist("test_diags", DiagsTagType_Debug);
+    CHECK(literal_on());
+    diags->activate_taglist("other", DiagsTagType_Debug);
+    CHECK_FALSE(literal_on());
+    diags->deactivate_all(DiagsTagType_Debug);
+    CHECK_FALSE(literal_on());
+  }
+
+  SECTION("a site checks each of its tags")
+  {
+    diags->activate_taglist("test_diags.on", DiagsTagType_Debug);
+    std::string on("test_diags.on"), off("test_diags.off");
+    CHECK(variable_on(on.c_str()));
+    CHECK_FALSE(variable_on(off.c_str()));
+    CHECK(variable_on(on.c_str()));
+  }
+
+  SECTION("a new Diags does not see the state cached for the old one")
+  {
+    diags->activate_taglist("test_diags", DiagsTagType_Debug);
+    CHECK(literal_on());
+    delete diags;
+    diags                                     = new Diags("test_diags", nullptr, nullptr, nullptr);
+    diags->config.enabled[DiagsTagType_Debug] = 1;
+    CHECK_FALSE(literal_on());
+  }
+
+  diags->config.enabled[DiagsTagType_Debug] = 0;
+  delete diags;
+  diags = saved;
+}
@@ -0,0 +1,120 @@
+/** @file
+
+  Unit tests for HostLookup, the tree and the index built from it.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include <string>
+#include <vector>
+
+#include "tscore/HostLookup.h"
+#include "catch.hpp"
+
+namespace
+{
+struct Entry {
+  const char *match;
+  bool domain;
+};
+
+const Entry entries[] = {
+  {"com", true},
+  {"example.com", true},
+  {"www.example.com", false},
+  {"a.b.c.example.com", false},
+  {".d.c.example.com", true},
+  {"!bad.example.net", false},
+  {"EXAMPLE.org", false},
+  {"ex*mple.net", false},
+  {"under_score.jp", true},
+};
+
+// All the entries that match @a host, in the order they are found.
+std::vector<intptr_t>
+matches(HostLookup &lookup, std::string_view host)
+{
+  std::vector<intptr_t> found;
+  HostLookupState s;
+  void *opaque = nullptr;
+
+  for (bool r = lookup.MatchFirst(host, &s, &opaque); r; r = lookup.MatchNext(&s, &opaque)) {
+    found.push_back(reinterpret_cast<intptr_t>(opaque));
+  }
+  return found;
+}
+
+void
+fill(HostLookup &lookup)
+{
+  intptr_t n = 0;
+  for (auto const &e : entries) {
+    lookup.NewEntry(e.match, e.domain, reinterpret_cast<void *>(++n));
+  }
+  // Enough siblings that the tree moves them from an array to a hash table.
+  for (int i = 0; i < 20; ++i) {
+    std::string host = "host" + std::to_string(i) + ".example.com";
+    lookup.NewEntry(host, false, reinterpret_cast<void *>(++n));
+  }
+}
+} // namespace
+
+TEST_CASE("HostLookup", "[libts][HostLookup]")
+{
+  HostLookup tree("tree");
+  HostLookup indexed("indexed");
+  fill(tree);
+  fill(indexed);
+  indexed.BuildIndex();
+
+  const char *hosts[] = {"com",
+                         "www.example.com",
+                         "WWW.Example.COM",
+                         "example.com",
+                         "other.example.com",
+                         "a.b.c.example.com",
+                         "x.b.c.example.com",
+                         "e.d.c.example.com",
+                         "bad.example.net",
+                         "example.org",
+                         "EXAMPLE.org",
+                         "www.example.org",
+                         "ex*mple.net",
+                         "EX*MPLE.net",
+                         "under_score.jp",
+                         "x.under_score.jp",
+                         "host7.example.com",
+                         "host19.example.com.",
+                         "",
+                         ".",
+                         "nothere.edu"};
+
+  for (auto host : hosts) {
+    INFO(host);
+    CHECK(matches(indexed, host) == matches(tree, host));
+  }
+
+  CHECK(matches(indexed, "www.example.com") == std::vector<intptr_t>{1, 2, 3});
+  CHECK(matches(indexed, "WWW.EXAMPLE.COM") == std::vector<intptr_t>{1}); // Only the TLD matches regardless of case.
+  CHECK(matches(indexed, "bad.example.net") == std::vector<intptr_t>{6});
+  CHECK(matches(indexed, "e.d.c.example.com") == std::vector<intptr_t>{1, 2, 5});
+  CHECK(matches(indexed, "host12.example.com") == std::vector<intptr_t>{1, 2, 22});
+  CHECK(matches(indexed, "ex*mple.net") == std::vector<intptr_t>{8});
+  CHECK(matches(indexed, "nothere.edu").empty());
+}
@@ -23,6 +23,8 @@
 
 #include "tscore/IpMap.h"
 #include <sstream>
+#include <string_view>
+#include <vector>
 #include <catch.hpp>
 #include <tscore/BufferWriter.h>
 
@@ -631,3 +633,62 @@ TEST_CASE("IpMap CloseIntersection", "[libts][ipmap]")
   std::cout << w.print("{::x}", m2).view() << std::endl;
 #endif
 };
+
+TEST_CASE("IpMap Freeze", "[libts][ipmap]")
+{
+  auto addr = [](std::string_view text) -> IpAddr {
+    IpAddr zret;
+    zret.load(text);
+    return zret;
+  };
+  IpMap map;
+  void *const markA = reinterpret_cast<void *>(1);
+  void *const markB = reinterpret_cast<void *>(2);
+  void *const markC = reinterpret_cast<void *>(3);
+  IpEndpoint a;
+
+  map.mark(addr("10.0.0.0"), addr("10.0.0.255"), markA);
+  map.mark(addr("10.0.2.7"), addr("10.0.2.7"), markB);
+  map.mark(addr("192.168.0.0"), addr("192.168.255.255"), markC);
+  map.mark(addr("fe80::1"), addr("fe80::ff"), markA);
+  map.mark(addr("2001:db8::"), addr("2001:db8::ffff:ffff"), markB);
+
+  std::vector<std::string_view> probes = {
+    "9.255.255.255", "10.0.0.0", "10.0.0.255", "10.0.1.0", "10.0.2.7",  "10.0.2.8",      "192.168.4.4",    "255.255.255.255",
+    "0.0.0.0",       "fe80::",   "fe80::1",    "fe80::ff", "fe80::100", "2001:db8::1:0", "2001:db8:0:1::", "::"};
+  std::vector<std::pair<bool, void *>> expected;
+  for (auto probe : probes) {
+    IpEndpoint ep;
+    ats_ip_pton(probe, &ep);
+    void *data = nullptr;
+    bool found = map.contains(&ep, &data);
+    expected.emplace_back(found, data);
+  }
+
+  map.freeze();
+  REQUIRE(map.is_frozen());
+  for (size_t i = 0; i < probes.size(); ++i) {
+    IpEndpoint ep;
+    ats_ip_pton(probes[i], &ep);
+    void *data = nullptr;
+    INFO(probes[i]);
+    CHECK(map.contains(&ep, &data) == expected[i].first);
+    CHECK(data == expected[i].second);
+  }
+  CHECK(map.contains(htonl(0x0a000207)));
+
+  ats_ip_pton("172.16.0.1", &a);
+  CHECK_FALSE(map.contains(&a));
+  map.mark(&a, &a, markC);
+  CHECK_FALSE(map.is_frozen());
+  void *data = nullptr;
+  CHECK(map.contains(&a, &data));
+  CHECK(data == markC);
+
+  map.freeze();
+  map.clear();
+  CHECK_FALSE(map.is_frozen());
+  CHECK_FALSE(map.contains(&a));
+  map.freeze();
+  CHECK_FALSE(map.contains(&a));
+}
@@ -0,0 +1,71 @@
+/** @file
+
+    MurmurHash3 tests.
+
+    @section license License
+
+    Licensed to the Apache Software Foundation (ASF) under one
+    or more contributor license agreements.  See the NOTICE file
+    distributed with this work for additional information
+    regarding copyright ownership.  The ASF licenses this file
+    to you under the Apache License, Version 2.0 (the
+    "License"); you may not use this file except in compliance
+    with the License.  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "tscore/ink_config.h"
+#include "tscore/MurmurHash3.h"
+
+#include <string_view>
+
+#include <catch.hpp>
+
+namespace
+{
+CryptoHash
+murmur3(std::string_view data, size_t split = 0)
+{
+  CryptoHash hash;
+  MurmurHash3Context ctx;
+  ctx.update(data.data(), split);
+  ctx.update(data.data() + split, data.size() - split);
+  ctx.finalize(hash);
+  return hash;
+}
+} // namespace
+
+TEST_CASE("MurmurHash3", "[libts][murmur3]")
+{
+  // Values of the reference MurmurHash3_x64_128, seed 0.
+  CryptoHash hash = murmur3("");
+  CHECK(hash.u64[0] == 0);
+  CHECK(hash.u64[1] == 0);
+
+  std::string_view fox = "The quick brown fox jumps over the lazy dog";
+  hash                 = murmur3(fox);
+  CHECK(hash.u64[0] == 0xe34bbc7bbc071b6cULL);
+  CHECK(hash.u64[1] == 0x7a433ca9c49a9347ULL);
+
+  // The same wherever the data is split.
+  for (size_t split = 0; split <= fox.size(); ++split) {
+    INFO("split " << split);
+    CHECK(murmur3(fox, split) == hash);
+  }
+
+#if TS_ENABLE_FIPS == 0
+  // And through CryptoContext.
+  CryptoHash via;
+  CryptoContext ctx(CryptoContext::MURMUR3);
+  ctx.update(fox.data(), fox.size());
+  ctx.finalize(via);
+  CHECK(via == hash);
+#endif
+}
@@ -52,3 +52,45 @@ TEST_CASE("Regex", "[libts][Regex]")
     }
   }
 }
+
+TEST_CASE("DFA", "[libts][DFA]")
+{
+  SECTION("the first pattern that matches is found")
+  {
+    const char *patterns[] = {"foo", "foo.*", "bar", "b.*"};
+    DFA dfa;
+    REQUIRE(dfa.compile(patterns, 4) == 4);
+    CHECK(dfa.match("foobar") == 0);
+    CHECK(dfa.match("barn") == 2);
+    CHECK(dfa.match("baz") == 3);
+    CHECK(dfa.match("xfoo") == -1);
+    CHECK(dfa.match("qux") == -1);
+  }
+
+  SECTION("patterns with groups or options")
+  {
+    const char *patterns[] = {"(a)b\\1", "ab", "(?i)CD", "(?x) e f # comment"};
+    DFA dfa;
+    REQUIRE(dfa.compile(patterns, 4) == 4);
+    CHECK(dfa.match("aba") == 0);
+    CHECK(dfa.match("abb") == 1);
+    CHECK(dfa.match("cd") == 2);
+    CHECK(dfa.match("ef") == 3);
+    CHECK(dfa.match("e f") == -1);
+  }
+
+  SECTION("case insensitive and unanchored sets")
+  {
+    const char *patterns[] = {"Mon", "Tue", "Wed"};
+    DFA dfa;
+    REQUIRE(dfa.compile(patterns, 3, RE_CASE_INSENSITIVE) == 3);
+    CHECK(dfa.match("wed") == 2);
+    CHECK(dfa.match("xmon") == -1);
+
+    const char *unanchored[] = {"b", "a"};
+    DFA udfa;
+    REQUIRE(udfa.compile(unanchored, 2, RE_UNANCHORED) == 2);
+    CHECK(udfa.match("ab") == 0);
+    CHECK(udfa.match("xa") == 1);
+  }
+}
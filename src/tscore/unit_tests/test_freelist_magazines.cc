@@ -0,0 +1,118 @@
+/** @file
+
+    Unit tests for the per thread freelist magazines.
+
+    @section license License
+
+    Licensed to the Apache Software Foundation (ASF) under one
+    or more contributor license agreements.  See the NOTICE file
+    distributed with this work for additional information
+    regarding copyright ownership.  The ASF licenses this file
+    to you under the Apache License, Version 2.0 (the
+    "License"); you may not use this file except in compliance
+    with the License.  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include <atomic>
+#include <cstring>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "tscore/ink_queue.h"
+#include "tscore/Allocator.h"
+#include "catch.hpp"
+
+namespace
+{
+struct Thing {
+  int64_t id   = 0;
+  char pad[56] = {0};
+};
+} // namespace
+
+TEST_CASE("freelist magazines", "[libts][freelist]")
+{
+  static constexpr int N_THREADS = 4;
+  static constexpr int N_ITEMS   = 100;
+  static constexpr int N_ROUNDS  = 2000;
+
+  InkFreeList *fl = ink_freelist_create("test_magazine", 64, 32, 8);
+  ClassAllocator<Thing> things("test_magazine_things", 32);
+
+  ink_freelist_init_magazines(8);
+
+  SECTION("single thread reuse")
+  {
+    std::set<void *> seen;
+    std::vector<void *> items;
+
+    for (int i = 0; i < N_ITEMS; ++i) {
+      items.push_back(ink_freelist_new(fl));
+    }
+    seen.insert(items.begin(), items.end());
+    REQUIRE(seen.size() == N_ITEMS);
+    for (void *p : items) {
+      ink_freelist_free(fl, p);
+    }
+    // The same thread gets its freed items back from its magazines.
+    for (int i = 0; i < N_ITEMS; ++i) {
+      void *p = ink_freelist_new(fl);
+      REQUIRE(seen.count(p) == 1);
+      seen.erase(p);
+    }
+    REQUIRE(seen.empty());
+    REQUIRE(fl->mag_hits >= N_ITEMS - 16);
+  }
+
+  SECTION("threads exchange through the depot")
+  {
+    std::vector<std::thread> threads;
+    std::atomic<int> errors{0};
+
+    for (int t = 0; t < N_THREADS; ++t) {
+      threads.emplace_back([&, t]() {
+        std::vector<Thing *> mine;
+        for (int r = 0; r < N_ROUNDS; ++r) {
+          for (int i = 0; i < N_ITEMS; ++i) {
+            Thing *p = things.alloc();
+            if (p->id != 0) {
+              ++errors; // The prototype must be copied over whatever was there.
+            }
+            p->id = t + 1;
+            memset(p->pad, t + 1, sizeof(p->pad));
+            mine.push_back(p);
+          }
+          for (Thing *p : mine) {
+            if (p->id != t + 1 || p->pad[sizeof(p->pad) - 1] != t + 1) {
+              ++errors; // Somebody else has it too.
+            }
+          }
+          // Free half on this thread, leave the others for the next round so magazines fill and drain.
+          while (mine.size() > N_ITEMS / 2) {
+            things.free(mine.back());
+            mine.pop_back();
+          }
+        }
+        for (Thing *p : mine) {
+          things.free(p);
+        }
+      });
+    }
+    for (auto &t : threads) {
+      t.join();
+    }
+    REQUIRE(errors.load() == 0);
+  }
+
+  ink_freelists_dump(stdout);
+  ink_freelist_init_magazines(0);
+}
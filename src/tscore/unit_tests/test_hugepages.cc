@@ -0,0 +1,64 @@
+/** @file
+
+    Unit tests for the huge page arenas.
+
+    @section license License
+
+    Licensed to the Apache Software Foundation (ASF) under one
+    or more contributor license agreements.  See the NOTICE file
+    distributed with this work for additional information
+    regarding copyright ownership.  The ASF licenses this file
+    to you under the Apache License, Version 2.0 (the
+    "License"); you may not use this file except in compliance
+    with the License.  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include <cstring>
+
+#include "tscore/hugepages.h"
+#include "tscore/ink_align.h"
+#include "catch.hpp"
+
+namespace
+{
+int64_t
+arena_total()
+{
+  int64_t total = 0;
+  for (int kind = 0; kind < HUGEPAGE_ARENA_KINDS; ++kind) {
+    total += ats_hugepage_arena_bytes(static_cast<HugePageArenaKind>(kind));
+  }
+  return total;
+}
+} // namespace
+
+TEST_CASE("hugepage arenas", "[libts][hugepages]")
+{
+  ats_hugepage_arena_init(0);
+  REQUIRE(ats_alloc_hugepage_arena(HUGEPAGE_ARENA_ALIGN) == nullptr);
+
+  ats_hugepage_arena_init(2);
+  int64_t before = arena_total();
+  size_t size    = 3 * HUGEPAGE_ARENA_ALIGN + 12345;
+  char *mem      = static_cast<char *>(ats_alloc_hugepage_arena(size));
+
+  // Whatever pages are available, the memory is there and aligned for huge pages.
+  REQUIRE(mem != nullptr);
+  REQUIRE(reinterpret_cast<uintptr_t>(mem) % HUGEPAGE_ARENA_ALIGN == 0);
+  memset(mem, 0xa5, size);
+  REQUIRE(arena_total() - before >= static_cast<int64_t>(INK_ALIGN(size, HUGEPAGE_ARENA_ALIGN)));
+
+  int x = 0;
+  REQUIRE(!ats_free_hugepage_arena(&x));
+  REQUIRE(ats_free_hugepage_arena(mem));
+  REQUIRE(arena_total() == before);
+  ats_hugepage_arena_init(0);
+}
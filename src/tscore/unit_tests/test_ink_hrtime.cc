@@ -0,0 +1,71 @@
+/** @file
+
+    Unit tests for the TSC clock.
+
+    @section license License
+
+    Licensed to the Apache Software Foundation (ASF) under one
+    or more contributor license agreements.  See the NOTICE file
+    distributed with this work for additional information
+    regarding copyright ownership.  The ASF licenses this file
+    to you under the Apache License, Version 2.0 (the
+    "License"); you may not use this file except in compliance
+    with the License.  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "tscore/ink_hrtime.h"
+#include "catch.hpp"
+
+namespace
+{
+ink_hrtime
+system_clock(clockid_t id)
+{
+  timespec ts;
+  clock_gettime(id, &ts);
+  return ink_hrtime_from_timespec(&ts);
+}
+} // namespace
+
+TEST_CASE("TSC clock", "[libts][hrtime]")
+{
+  if (!ink_hrtime_tsc_init()) {
+    WARN("no invariant TSC, the clock stays on clock_gettime");
+    CHECK_FALSE(ink_tsc_clock.enabled.load());
+  }
+
+  ink_hrtime last = ink_get_hrtime_monotonic();
+  for (int i = 0; i < 100000; ++i) {
+    ink_hrtime now = ink_get_hrtime_monotonic();
+    REQUIRE(now >= last);
+    last = now;
+  }
+
+  CHECK(std::abs(ink_get_hrtime_internal() - system_clock(CLOCK_REALTIME)) < HRTIME_MSECONDS(10));
+  CHECK(std::abs(ink_get_hrtime_monotonic() - system_clock(CLOCK_MONOTONIC)) < HRTIME_MSECONDS(10));
+
+  if (ink_tsc_clock.enabled.load()) {
+    SECTION("the clock checks itself against the system clocks")
+    {
+      ink_tsc_clock.next_check.store(0);
+      ink_get_hrtime_internal();
+      CHECK(ink_tsc_clock.enabled.load());
+      CHECK(ink_tsc_clock.next_check.load() > ink_get_hrtime_monotonic());
+
+      // A counter that ran a second ahead of the monotonic clock is not usable.
+      ink_tsc_clock.last_tsc_time -= HRTIME_SECOND;
+      ink_tsc_clock.next_check.store(0);
+      ink_get_hrtime_internal();
+      CHECK_FALSE(ink_tsc_clock.enabled.load());
+      CHECK(std::abs(ink_get_hrtime_monotonic() - system_clock(CLOCK_MONOTONIC)) < HRTIME_MSECONDS(10));
+    }
+  }
+}
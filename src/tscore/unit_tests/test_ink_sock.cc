@@ -0,0 +1,100 @@
+/** @file
+
+    Unit tests for the socket utilities.
+
+    @section license License
+
+    Licensed to the Apache Software Foundation (ASF) under one
+    or more contributor license agreements.  See the NOTICE file
+    distributed with this work for additional information
+    regarding copyright ownership.  The ASF licenses this file
+    to you under the Apache License, Version 2.0 (the
+    "License"); you may not use this file except in compliance
+    with the License.  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "tscore/ink_sock.h"
+#include "catch.hpp"
+
+TEST_CASE("send_fds and recv_fds", "[libts][ink_sock]")
+{
+  int sv[2];
+  int pipe_fds[2];
+  char buf[16];
+
+  REQUIRE(socketpair(AF_UNIX, SOCK_STREAM, 0, sv) == 0);
+  REQUIRE(pipe(pipe_fds) == 0);
+
+  SECTION("descriptors arrive with the data")
+  {
+    int fds[2];
+    int nfds = 2;
+
+    REQUIRE(send_fds(sv[0], pipe_fds, 2, "ports", 5) == 5);
+    REQUIRE(recv_fds(sv[1], fds, &nfds, buf, sizeof(buf)) == 5);
+    CHECK(memcmp(buf, "ports", 5) == 0);
+    REQUIRE(nfds == 2);
+    CHECK(fds[0] != pipe_fds[0]);
+    CHECK((fcntl(fds[0], F_GETFD) & FD_CLOEXEC) != 0);
+
+    // the received descriptors are the same pipe
+    REQUIRE(write(fds[1], "x", 1) == 1);
+    REQUIRE(read(pipe_fds[0], buf, 1) == 1);
+    CHECK(buf[0] == 'x');
+    close(fds[0]);
+    close(fds[1]);
+  }
+
+  SECTION("data without descriptors")
+  {
+    int fds[1];
+    int nfds = 1;
+
+    REQUIRE(send_fds(sv[0], nullptr, 0, "ready", 5) == 5);
+    REQUIRE(recv_fds(sv[1], fds, &nfds, buf, sizeof(buf)) == 5);
+    CHECK(nfds == 0);
+  }
+
+  SECTION("descriptors beyond the room are closed")
+  {
+    int fds[1];
+    int nfds = 1;
+
+    REQUIRE(send_fds(sv[0], pipe_fds, 2, "p", 1) == 1);
+    REQUIRE(recv_fds(sv[1], fds, &nfds, buf, sizeof(buf)) == 1);
+    CHECK(nfds == 1);
+    close(fds[0]);
+  }
+
+  SECTION("the end of the stream")
+  {
+    int fds[1];
+    int nfds = 1;
+
+    close(sv[0]);
+    sv[0] = -1;
+    CHECK(recv_fds(sv[1], fds, &nfds, buf, sizeof(buf)) == 0);
+    CHECK(nfds == 0);
+  }
+
+  if (sv[0] >= 0) {
+    close(sv[0]);
+  }
+  close(sv[1]);
+  close(pipe_fds[0]);
+  close(pipe_fds[1]);
+}
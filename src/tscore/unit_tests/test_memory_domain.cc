@@ -0,0 +1,71 @@
+/** @file
+
+    Unit tests for the memory domains.
+
+    @section license License
+
+    Licensed to the Apache Software Foundation (ASF) under one
+    or more contributor license agreements.  See the NOTICE file
+    distributed with this work for additional information
+    regarding copyright ownership.  The ASF licenses this file
+    to you under the Apache License, Version 2.0 (the
+    "License"); you may not use this file except in compliance
+    with the License.  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include <cstring>
+
+#include "tscore/memory_domain.h"
+#include "tscore/ink_memory.h"
+#include "catch.hpp"
+
+TEST_CASE("memory domain charges", "[libts][memory_domain]")
+{
+  int64_t before = ats_memory_domain_live_bytes(MEMORY_DOMAIN_HOSTDB);
+
+  ats_memory_domain_charge(MEMORY_DOMAIN_HOSTDB, 4096);
+  REQUIRE(ats_memory_domain_live_bytes(MEMORY_DOMAIN_HOSTDB) == before + 4096);
+  ats_memory_domain_charge(MEMORY_DOMAIN_HOSTDB, -4096);
+  REQUIRE(ats_memory_domain_live_bytes(MEMORY_DOMAIN_HOSTDB) == before);
+  REQUIRE(strcmp(ats_memory_domain_name(MEMORY_DOMAIN_HDR_HEAP), "hdr_heap") == 0);
+}
+
+TEST_CASE("memory domain scopes", "[libts][memory_domain]")
+{
+  ats_memory_domain_init(true);
+
+  REQUIRE(ats_memory_domain_flags == 0);
+  {
+    MemoryDomainScope ssl(MEMORY_DOMAIN_SSL);
+    int ssl_flags = ats_memory_domain_flags;
+    REQUIRE((ssl_flags != 0) == ats_memory_domain_enabled());
+    {
+      MemoryDomainScope plugin(MEMORY_DOMAIN_PLUGIN);
+      REQUIRE((ats_memory_domain_flags != ssl_flags) == ats_memory_domain_enabled());
+      {
+        MemoryDomainScope untagged(MEMORY_DOMAIN_UNTAGGED);
+        REQUIRE(ats_memory_domain_flags == 0);
+      }
+    }
+    REQUIRE(ats_memory_domain_flags == ssl_flags);
+
+    // Memory of a domain is freed like any other.
+    char *mem = static_cast<char *>(ats_malloc(1000));
+    memset(mem, 0xa5, 1000);
+    mem = static_cast<char *>(ats_realloc(mem, 100000));
+    REQUIRE(static_cast<unsigned char>(mem[999]) == 0xa5);
+    ats_free(mem);
+    int *zeroed = static_cast<int *>(ats_calloc(16, sizeof(int)));
+    REQUIRE(zeroed[15] == 0);
+    ats_free(zeroed);
+  }
+  REQUIRE(ats_memory_domain_flags == 0);
+}
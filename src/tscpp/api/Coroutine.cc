@@ -0,0 +1,247 @@
+/**
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+/**
+ * @file Coroutine.cc
+ */
+#include "tscpp/api/Coroutine.h"
+#include "logging_internal.h"
+
+#include <cstring>
+#include <netinet/in.h>
+
+using namespace atscppapi::coro;
+
+namespace
+{
+// Event ids for the TSFetchUrl() callback.
+enum {
+  FETCH_SUCCESS = 60000,
+  FETCH_FAILURE,
+  FETCH_TIMEOUT,
+};
+} // namespace
+
+/**
+ * @private
+ *
+ * Shared by the operation and its continuation. Everything in here is protected by the mutex of
+ * the continuation. If the operation is destroyed while a callback it cannot cancel is still due,
+ * the state is orphaned and the callback frees it.
+ */
+struct atscppapi::coro::AwaitState : noncopyable {
+  TSCont cont_           = nullptr;
+  TSAction action_       = nullptr; ///< Pending operation or resume event, canceled with the operation.
+  TSEventThread origin_  = nullptr; ///< Thread to resume the coroutine on.
+  void (*resume_)(void *) = nullptr;
+  void *address_          = nullptr;
+  bool done_              = false;
+  bool orphaned_          = false;
+  bool cancelable_        = true; ///< false while a callback that cannot be canceled is due.
+
+  sockaddr_storage addr_;
+  bool found_    = false;
+  TSVConn vconn_ = nullptr;
+  std::string response_;
+
+  AwaitState();
+  void complete(TSEvent event, void *edata);
+  static int handle(TSCont cont, TSEvent event, void *edata);
+};
+
+AwaitState::AwaitState() : cont_(TSContCreate(handle, TSMutexCreate()))
+{
+  TSContDataSet(cont_, this);
+}
+
+void
+AwaitState::complete(TSEvent event, void *edata)
+{
+  switch (static_cast<int>(event)) {
+  case TS_EVENT_HOST_LOOKUP:
+    if (edata) {
+      sockaddr const *addr = TSHostLookupResultAddrGet(static_cast<TSHostLookupResult>(edata));
+      if (addr) {
+        memcpy(&addr_, addr, addr->sa_family == AF_INET6 ? sizeof(sockaddr_in6) : sizeof(sockaddr_in));
+        found_ = true;
+      }
+    }
+    break;
+  case TS_EVENT_CACHE_OPEN_READ:
+    vconn_ = static_cast<TSVConn>(edata);
+    break;
+  case FETCH_SUCCESS: {
+    int length       = 0;
+    const char *resp = TSFetchRespGet(static_cast<TSHttpTxn>(edata), &length);
+    if (resp && length > 0) {
+      response_.assign(resp, length);
+    }
+    break;
+  }
+  default: // Failures, timeouts and the Sleep timer carry no result.
+    break;
+  }
+  done_       = true;
+  cancelable_ = true;
+}
+
+int
+AwaitState::handle(TSCont cont, TSEvent event, void *edata)
+{
+  AwaitState *state = static_cast<AwaitState *>(TSContDataGet(cont));
+
+  state->action_ = nullptr;
+  if (!state->done_) {
+    state->complete(event, edata);
+    if (state->orphaned_) {
+      LOG_DEBUG("Operation completed after it was destroyed");
+      TSContDestroy(cont);
+      delete state;
+      return 0;
+    }
+    if (state->resume_ == nullptr) {
+      return 0; // Not awaited yet.
+    }
+    if (state->origin_ && state->origin_ != TSEventThreadSelf()) {
+      state->action_ = TSContScheduleOnThread(cont, 0, state->origin_);
+      return 0;
+    }
+  }
+
+  auto resume    = state->resume_;
+  state->resume_ = nullptr;
+  // The coroutine may destroy the operation, do not touch the state after this.
+  if (resume) {
+    resume(state->address_);
+  }
+  return 0;
+}
+
+Awaitable::Awaitable() : state_(new AwaitState) {}
+
+bool
+Awaitable::ready() const
+{
+  return state_->done_;
+}
+
+bool
+Awaitable::suspend(void (*resume)(void *), void *address)
+{
+  TSMutex mutex = TSContMutexGet(state_->cont_);
+  TSMutexLock(mutex);
+  bool waiting = !state_->done_;
+  if (waiting) {
+    state_->resume_  = resume;
+    state_->address_ = address;
+    state_->origin_  = TSEventThreadSelf();
+  }
+  TSMutexUnlock(mutex);
+  return waiting;
+}
+
+Awaitable::~Awaitable()
+{
+  TSCont cont   = state_->cont_;
+  TSMutex mutex = TSContMutexGet(cont);
+  TSMutexLock(mutex);
+  if (state_->action_) {
+    TSActionCancel(state_->action_);
+    state_->action_ = nullptr;
+  }
+  state_->resume_ = nullptr;
+  bool orphan     = !state_->done_ && !state_->cancelable_;
+  if (orphan) {
+    state_->orphaned_ = true;
+  }
+  TSMutexUnlock(mutex);
+
+  if (!orphan) {
+    TSContDestroy(cont);
+    delete state_;
+  }
+}
+
+HostLookup::HostLookup(std::string_view host)
+{
+  TSMutex mutex = TSContMutexGet(state_->cont_);
+  TSMutexLock(mutex);
+  // A lookup answered from HostDB calls back before this returns, with nothing to cancel.
+  TSAction action = TSHostLookup(state_->cont_, host.data(), host.size());
+  if (!state_->done_ && action && !TSActionDone(action)) {
+    state_->action_ = action;
+  }
+  TSMutexUnlock(mutex);
+}
+
+sockaddr const *
+HostLookup::result() const
+{
+  return state_->found_ ? reinterpret_cast<sockaddr const *>(&state_->addr_) : nullptr;
+}
+
+CacheRead::CacheRead(TSCacheKey key)
+{
+  TSMutex mutex = TSContMutexGet(state_->cont_);
+  TSMutexLock(mutex);
+  TSAction action = TSCacheRead(state_->cont_, key);
+  if (!state_->done_ && action && !TSActionDone(action)) {
+    state_->action_ = action;
+  }
+  TSMutexUnlock(mutex);
+}
+
+TSVConn
+CacheRead::result() const
+{
+  return state_->vconn_;
+}
+
+FetchUrl::FetchUrl(std::string_view request, sockaddr const *client_addr)
+{
+  TSFetchEvent events;
+  events.success_event_id = FETCH_SUCCESS;
+  events.failure_event_id = FETCH_FAILURE;
+  events.timeout_event_id = FETCH_TIMEOUT;
+
+  TSMutex mutex = TSContMutexGet(state_->cont_);
+  TSMutexLock(mutex);
+  // There is no way to cancel a fetch, the callback cleans up if the operation is gone by then.
+  state_->cancelable_ = false;
+  TSFetchUrl(request.data(), request.size(), client_addr, state_->cont_, AFTER_BODY, events);
+  TSMutexUnlock(mutex);
+}
+
+std::string_view
+FetchUrl::result() const
+{
+  return state_->response_;
+}
+
+Sleep::Sleep(TSHRTime timeout)
+{
+  TSMutex mutex        = TSContMutexGet(state_->cont_);
+  TSEventThread thread = TSEventThreadSelf();
+  TSMutexLock(mutex);
+  if (thread) {
+    state_->action_ = TSContScheduleOnThread(state_->cont_, timeout, thread);
+  } else {
+    state_->action_ = TSContScheduleOnPool(state_->cont_, timeout, TS_THREAD_POOL_NET);
+  }
+  TSMutexUnlock(mutex);
+}
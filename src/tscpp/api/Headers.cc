@@ -21,6 +21,7 @@
  */
 #include <memory>
 #include <string>
+#include <string_view>
 #include <cstring>
 #include <sstream>
 #include <cctype>
@@ -135,15 +136,21 @@ header_field_value_iterator::~header_field_value_iterator()
 
 std::string
 header_field_value_iterator::operator*()
+{
+  return std::string(view());
+}
+
+std::string_view
+header_field_value_iterator::view() const
 {
   if (state_->index_ >= 0) {
     int length      = 0;
     const char *str = TSMimeHdrFieldValueStringGet(state_->hdr_buf_, state_->hdr_loc_, state_->field_loc_, state_->index_, &length);
     if (length && str) {
-      return std::string(str, length);
+      return std::string_view(str, length);
     }
   }
-  return std::string();
+  return std::string_view();
 }
 
 header_field_value_iterator &
@@ -226,14 +233,32 @@ HeaderField::end()
 
 HeaderFieldName
 HeaderField::name() const
+{
+  return std::string(nameView());
+}
+
+std::string_view
+HeaderField::nameView() const
 {
   int length      = 0;
   const char *str = TSMimeHdrFieldNameGet(iter_.state_->mloc_container_->hdr_buf_, iter_.state_->mloc_container_->hdr_loc_,
                                           iter_.state_->mloc_container_->field_loc_, &length);
   if (str && length) {
-    return std::string(str, length);
+    return std::string_view(str, length);
   }
-  return std::string();
+  return std::string_view();
+}
+
+std::string_view
+HeaderField::valueView(const int index) const
+{
+  int length      = 0;
+  const char *str = TSMimeHdrFieldValueStringGet(iter_.state_->mloc_container_->hdr_buf_, iter_.state_->mloc_container_->hdr_loc_,
+                                                 iter_.state_->mloc_container_->field_loc_, index, &length);
+  if (str && length) {
+    return std::string_view(str, length);
+  }
+  return std::string_view();
 }
 
 std::string
@@ -424,8 +449,14 @@ advanceIterator(HeaderFieldIteratorState *state, TSMLoc (*getNextField)(TSMBuffe
     TSMBuffer hdr_buf     = state->mloc_container_->hdr_buf_;
     TSMLoc hdr_loc        = state->mloc_container_->hdr_loc_;
     TSMLoc next_field_loc = getNextField(hdr_buf, hdr_loc, state->mloc_container_->field_loc_);
-    delete state;
-    state = new HeaderFieldIteratorState(hdr_buf, hdr_loc, next_field_loc);
+    if (state->mloc_container_.use_count() == 1) {
+      // No HeaderField refers to the current field, step the handle in place instead of allocating.
+      TSHandleMLocRelease(hdr_buf, hdr_loc, state->mloc_container_->field_loc_);
+      state->mloc_container_->field_loc_ = next_field_loc;
+    } else {
+      delete state;
+      state = new HeaderFieldIteratorState(hdr_buf, hdr_loc, next_field_loc);
+    }
   }
   return state;
 }
@@ -476,18 +507,37 @@ header_field_iterator::operator*()
  * @private
  */
 struct HeadersState : noncopyable {
-  TSMBuffer hdr_buf_;
-  TSMLoc hdr_loc_;
-  bool self_created_structures_;
-  HeadersState()
+  TSMBuffer hdr_buf_            = nullptr;
+  TSMLoc hdr_loc_               = nullptr;
+  bool self_created_structures_ = false;
+  bool create_on_use_           = true; ///< Unbound, the own header is created when first used.
+  HeadersState()                = default;
+  void
+  create()
+  {
+    if (create_on_use_) {
+      create_on_use_           = false;
+      hdr_buf_                 = TSMBufferCreate();
+      hdr_loc_                 = TSHttpHdrCreate(hdr_buf_);
+      self_created_structures_ = true;
+    }
+  }
+  TSMBuffer
+  buf()
   {
-    hdr_buf_                 = TSMBufferCreate();
-    hdr_loc_                 = TSHttpHdrCreate(hdr_buf_);
-    self_created_structures_ = true;
+    create();
+    return hdr_buf_;
+  }
+  TSMLoc
+  loc()
+  {
+    create();
+    return hdr_loc_;
   }
   void
   reset(TSMBuffer bufp, TSMLoc hdr_loc)
   {
+    create_on_use_ = false;
     if (self_created_structures_) {
       TSHandleMLocRelease(hdr_buf_, TS_NULL_MLOC /* no parent */, hdr_loc_);
       TSMBufferDestroy(hdr_buf_);
@@ -524,7 +574,7 @@ Headers::~Headers()
 bool
 Headers::isInitialized() const
 {
-  return (state_->hdr_buf_ && state_->hdr_loc_);
+  return state_->create_on_use_ || (state_->hdr_buf_ && state_->hdr_loc_);
 }
 
 bool
@@ -536,31 +586,31 @@ Headers::empty()
 Headers::size_type
 Headers::size() const
 {
-  return TSMimeHdrFieldsCount(state_->hdr_buf_, state_->hdr_loc_);
+  return TSMimeHdrFieldsCount(state_->buf(), state_->loc());
 }
 
 Headers::size_type
 Headers::lengthBytes() const
 {
-  return TSMimeHdrLengthGet(state_->hdr_buf_, state_->hdr_loc_);
+  return TSMimeHdrLengthGet(state_->buf(), state_->loc());
 }
 
 header_field_iterator
 Headers::begin()
 {
-  return header_field_iterator(state_->hdr_buf_, state_->hdr_loc_, TSMimeHdrFieldGet(state_->hdr_buf_, state_->hdr_loc_, 0));
+  return header_field_iterator(state_->buf(), state_->loc(), TSMimeHdrFieldGet(state_->buf(), state_->loc(), 0));
 }
 
 header_field_iterator
 Headers::end()
 {
-  return header_field_iterator(state_->hdr_buf_, state_->hdr_loc_, TS_NULL_MLOC);
+  return header_field_iterator(state_->buf(), state_->loc(), TS_NULL_MLOC);
 }
 
 bool
 Headers::clear()
 {
-  return (TSMimeHdrFieldsClear(state_->hdr_buf_, state_->hdr_loc_) == TS_SUCCESS);
+  return (TSMimeHdrFieldsClear(state_->buf(), state_->loc()) == TS_SUCCESS);
 }
 
 bool
@@ -634,6 +684,16 @@ Headers::values(const std::string &key, const char join)
   return values(key, std::string().assign(1, join));
 }
 
+std::string_view
+Headers::valueView(std::string_view key)
+{
+  TSMimeFieldValueView field = {key.data(), static_cast<int>(key.size()), nullptr, 0};
+  if (TSMimeHdrFieldsValueGet(state_->buf(), state_->loc(), &field, 1) == 0) {
+    return std::string_view();
+  }
+  return std::string_view(field.value, field.value_len);
+}
+
 header_field_iterator
 Headers::find(const std::string &key)
 {
@@ -643,9 +703,9 @@ Headers::find(const std::string &key)
 header_field_iterator
 Headers::find(const char *key, int length)
 {
-  TSMLoc field_loc = TSMimeHdrFieldFind(state_->hdr_buf_, state_->hdr_loc_, key, length);
+  TSMLoc field_loc = TSMimeHdrFieldFind(state_->buf(), state_->loc(), key, length);
   if (field_loc != TS_NULL_MLOC) {
-    return header_field_iterator(state_->hdr_buf_, state_->hdr_loc_, field_loc);
+    return header_field_iterator(state_->buf(), state_->loc(), field_loc);
   }
 
   return end();
@@ -656,11 +716,11 @@ Headers::append(const std::string &key, const std::string &value)
 {
   TSMLoc field_loc = TS_NULL_MLOC;
 
-  if (TSMimeHdrFieldCreate(state_->hdr_buf_, state_->hdr_loc_, &field_loc) == TS_SUCCESS) {
-    TSMimeHdrFieldNameSet(state_->hdr_buf_, state_->hdr_loc_, field_loc, key.c_str(), key.length());
-    TSMimeHdrFieldAppend(state_->hdr_buf_, state_->hdr_loc_, field_loc);
-    TSMimeHdrFieldValueStringInsert(state_->hdr_buf_, state_->hdr_loc_, field_loc, 0, value.c_str(), value.length());
-    return header_field_iterator(state_->hdr_buf_, state_->hdr_loc_, field_loc);
+  if (TSMimeHdrFieldCreate(state_->buf(), state_->loc(), &field_loc) == TS_SUCCESS) {
+    TSMimeHdrFieldNameSet(state_->buf(), state_->loc(), field_loc, key.c_str(), key.length());
+    TSMimeHdrFieldAppend(state_->buf(), state_->loc(), field_loc);
+    TSMimeHdrFieldValueStringInsert(state_->buf(), state_->loc(), field_loc, 0, value.c_str(), value.length());
+    return header_field_iterator(state_->buf(), state_->loc(), field_loc);
   } else {
     return end();
   }
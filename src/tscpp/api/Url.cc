@@ -153,6 +153,49 @@ Url::getPort() const
   return ret_val;
 }
 
+namespace
+{
+using UrlPartGetF = const char *(*)(TSMBuffer, TSMLoc, int *);
+
+std::string_view
+getUrlPartView(UrlState const *state, UrlPartGetF url_f)
+{
+  int length         = 0;
+  const char *memptr = url_f(state->hdr_buf_, state->url_loc_, &length);
+  return memptr ? std::string_view(memptr, length) : std::string_view();
+}
+} // namespace
+
+std::string_view
+Url::getUrlStringView() const
+{
+  return isInitialized() ? getUrlPartView(state_, TSUrlStringViewGet) : std::string_view();
+}
+
+std::string_view
+Url::getPathView() const
+{
+  return isInitialized() ? getUrlPartView(state_, TSUrlPathGet) : std::string_view();
+}
+
+std::string_view
+Url::getQueryView() const
+{
+  return isInitialized() ? getUrlPartView(state_, TSUrlHttpQueryGet) : std::string_view();
+}
+
+std::string_view
+Url::getSchemeView() const
+{
+  return isInitialized() ? getUrlPartView(state_, TSUrlSchemeGet) : std::string_view();
+}
+
+std::string_view
+Url::getHostView() const
+{
+  return isInitialized() ? getUrlPartView(state_, TSUrlHostGet) : std::string_view();
+}
+
 void
 Url::setPath(const std::string &path)
 {
@@ -0,0 +1,44 @@
+/** @file
+
+  Reporting of the results of the benchmark programs.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#pragma once
+
+#include <cinttypes>
+#include <cstdio>
+
+/** Report that @a ops operations of the benchmark @a name took @a seconds.
+
+    With @a json this is a JSON object on a line of its own, which is what `make bench` collects
+    and tools/bench_compare.py compares to a baseline. Otherwise it is a line for humans.
+ */
+inline void
+bench_report(bool json, const char *name, int64_t ops, double seconds)
+{
+  double ns_per_op = ops > 0 ? seconds * 1e9 / ops : 0;
+
+  if (json) {
+    printf("{\"benchmark\":\"%s\",\"ops\":%" PRId64 ",\"seconds\":%.6f,\"ns_per_op\":%.3f}\n", name, ops, seconds, ns_per_op);
+  } else {
+    printf("%s: %" PRId64 " ops, %.3f s, %.1f ns/op\n", name, ops, seconds, ns_per_op);
+  }
+}
@@ -0,0 +1,100 @@
+#!/usr/bin/env python3
+'''
+Licensed to the Apache Software Foundation (ASF) under one
+or more contributor license agreements.  See the NOTICE file
+distributed with this work for additional information
+regarding copyright ownership.  The ASF licenses this file
+to you under the Apache License, Version 2.0 (the
+"License"); you may not use this file except in compliance
+with the License.  You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the License is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied.  See the License for the
+specific language governing permissions and limitations
+under the License.
+'''
+
+import argparse
+import json
+import sys
+
+description = '''
+Compare the results of `make bench` to those of an earlier run. Exits with 1
+when a benchmark takes more than the threshold longer per operation than in
+the baseline, so it can gate a change.
+'''
+
+
+def load_results(path):
+    """ Load the results of a run of the benchmarks.
+
+    Args:
+        path (string) The file of JSON lines the benchmarks wrote.
+
+    Return:
+        The nanoseconds per operation by benchmark name, the best of the
+        runs when the benchmarks were run more than once.
+    """
+    results = {}
+    with open(path) as f:
+        for line in f:
+            line = line.strip()
+            if not line:
+                continue
+            result = json.loads(line)
+            name = result['benchmark']
+            results[name] = min(results.get(name, result['ns_per_op']), result['ns_per_op'])
+    return results
+
+
+def parse_args():
+    ''' Parse the command line arguments.
+    '''
+    parser = argparse.ArgumentParser(description=description)
+
+    parser.add_argument("baseline", type=str,
+                        help="The results of the earlier run.")
+    parser.add_argument("results", type=str,
+                        help="The results of this run.")
+    parser.add_argument("-t", "--threshold", type=float, default=10.0,
+                        help="The slowdown in percent that is a regression, 10 by default.")
+    return parser.parse_args()
+
+
+def main():
+    args = parse_args()
+    try:
+        baseline = load_results(args.baseline)
+        results = load_results(args.results)
+    except (OSError, ValueError, KeyError) as e:
+        print("Cannot load the benchmark results: {}".format(e), file=sys.stderr)
+        return 2
+
+    regressions = 0
+    print("{:40} {:>14} {:>14} {:>8}".format("benchmark", "baseline ns", "ns", "change"))
+    for name, ns in sorted(results.items()):
+        if name not in baseline:
+            print("{:40} {:>14} {:>14.1f} {:>8}".format(name, "-", ns, "new"))
+            continue
+        base = baseline[name]
+        change = (ns - base) / base * 100 if base > 0 else 0.0
+        flag = ""
+        if change > args.threshold:
+            flag = "  REGRESSION"
+            regressions += 1
+        print("{:40} {:>14.1f} {:>14.1f} {:>+7.1f}%{}".format(name, base, ns, change, flag))
+    for name in sorted(set(baseline) - set(results)):
+        print("{:40} {:>14.1f} {:>14} {:>8}".format(name, baseline[name], "-", "missing"))
+
+    if regressions:
+        print("{} benchmarks are more than {}% slower than the baseline".format(regressions, args.threshold))
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
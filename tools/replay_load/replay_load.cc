@@ -0,0 +1,738 @@
+/** @file
+
+  Replay the sessions captured by traffic_dump against a proxy and report the throughput and latency.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <dirent.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <openssl/err.h>
+#include <openssl/ssl.h>
+#include <yaml-cpp/yaml.h>
+
+#include "tscore/ink_args.h"
+#include "tscore/I_Version.h"
+#include "tscpp/util/TextView.h"
+
+using Clock = std::chrono::steady_clock;
+
+static AppVersionInfo appVersionInfo;
+
+static char proxy_host[256] = "localhost";
+static int proxy_port       = 8080;
+static int tls_port         = 0;
+static int concurrency      = 100;
+static double speed         = 1.0;
+static int interval         = 1;
+static int timeout          = 10;
+static int verbose          = 0;
+
+static const ArgumentDescription argument_descriptions[] = {
+  {"proxy_host", 'P', "Proxy Host", "S255", proxy_host, "REPLAY_PROXY_HOST", nullptr},
+  {"proxy_port", 'p', "Proxy Port", "I", &proxy_port, "REPLAY_PROXY_PORT", nullptr},
+  {"tls_port", 'T', "Proxy Port for the TLS Sessions (0:proxy port)", "I", &tls_port, "REPLAY_TLS_PORT", nullptr},
+  {"concurrency", 'c', "Maximum Concurrent Sessions", "I", &concurrency, "REPLAY_CONCURRENCY", nullptr},
+  {"speed", 's', "Replay Speed (1:original timing, 0:as fast as possible)", "D", &speed, "REPLAY_SPEED", nullptr},
+  {"interval", 'i', "Reporting Interval (seconds, 0:none)", "I", &interval, "REPLAY_INTERVAL", nullptr},
+  {"timeout", 't', "Socket Timeout (seconds)", "I", &timeout, "REPLAY_TIMEOUT", nullptr},
+  {"verbose", 'v', "Verbose Flag", "F", &verbose, "REPLAY_VERBOSE", nullptr},
+  HELP_ARGUMENT_DESCRIPTION(),
+  VERSION_ARGUMENT_DESCRIPTION()};
+static const unsigned n_argument_descriptions = countof(argument_descriptions);
+
+namespace
+{
+struct Transaction {
+  int64_t offset_ns = 0;  ///< The start of the transaction from the start of its session.
+  std::string request;    ///< The request line and fields.
+  int64_t body_size   = 0;
+  bool head           = false;
+  int expected_status = 0; ///< The status of the proxy response in the dump, 0 if there was none.
+};
+
+struct Session {
+  int64_t start_ns = 0; ///< The connection time in the dump.
+  bool tls         = false;
+  bool h2          = false;
+  std::string sni;
+  std::vector<Transaction> transactions;
+};
+
+/** A log scaled latency histogram, in microseconds.
+ *
+ * Each power of two is split in sub_buckets buckets, which keeps the error of a percentile under 1/sub_buckets.
+ */
+class Histogram
+{
+public:
+  static constexpr int sub_bits    = 4;
+  static constexpr int sub_buckets = 1 << sub_bits;
+
+  void
+  record(int64_t us)
+  {
+    ++_counts[bucket(std::max<int64_t>(us, 0))];
+    ++_count;
+    _max = std::max(_max, us);
+  }
+
+  void
+  merge(const Histogram &that)
+  {
+    for (size_t i = 0; i < _counts.size(); ++i) {
+      _counts[i] += that._counts[i];
+    }
+    _count += that._count;
+    _max   = std::max(_max, that._max);
+  }
+
+  int64_t
+  count() const
+  {
+    return _count;
+  }
+
+  int64_t
+  max() const
+  {
+    return _max;
+  }
+
+  /// The upper bound of the bucket of the @a p percentile.
+  int64_t
+  percentile(double p) const
+  {
+    int64_t rank = std::max<int64_t>(1, static_cast<int64_t>(p / 100 * _count + 0.5));
+    int64_t seen = 0;
+    for (size_t i = 0; i < _counts.size(); ++i) {
+      seen += _counts[i];
+      if (seen >= rank) {
+        return std::min(_max, upper(i));
+      }
+    }
+    return _max;
+  }
+
+private:
+  static size_t
+  bucket(int64_t us)
+  {
+    if (us < sub_buckets) {
+      return us;
+    }
+    int msb = 63 - __builtin_clzll(us);
+    return (msb - sub_bits + 1) * sub_buckets + ((us >> (msb - sub_bits)) & (sub_buckets - 1));
+  }
+
+  static int64_t
+  upper(size_t idx)
+  {
+    if (idx < static_cast<size_t>(sub_buckets)) {
+      return idx;
+    }
+    int shift = idx / sub_buckets - 1;
+    return ((static_cast<int64_t>(sub_buckets + idx % sub_buckets + 1)) << shift) - 1;
+  }
+
+  std::vector<int64_t> _counts = std::vector<int64_t>((64 - sub_bits + 1) * sub_buckets, 0);
+  int64_t _count               = 0;
+  int64_t _max                 = 0;
+};
+
+/// The results of a worker, merged at the end.
+struct Results {
+  Histogram first_byte;
+  Histogram total;
+  int64_t status_classes[6] = {0};
+};
+
+std::vector<Session> sessions;
+std::atomic<size_t> next_session{0};
+std::atomic<int64_t> done_transactions{0};
+std::atomic<int64_t> done_sessions{0};
+std::atomic<int64_t> bytes_read{0};
+std::atomic<int64_t> errors{0};
+std::atomic<int64_t> late_sessions{0};
+std::atomic<int64_t> status_mismatches{0};
+std::atomic<bool> running{true};
+
+SSL_CTX *ssl_ctx         = nullptr;
+addrinfo *proxy_addr     = nullptr;
+addrinfo *proxy_tls_addr = nullptr;
+
+//
+// Loading the replay files.
+//
+
+int64_t
+node_time(const YAML::Node &node)
+{
+  if (node["connection-time"]) {
+    return node["connection-time"].as<int64_t>();
+  }
+  if (node["start-time"]) {
+    return node["start-time"].as<int64_t>();
+  }
+  return 0;
+}
+
+bool
+icase_equal(std::string_view lhs, std::string_view rhs)
+{
+  return lhs.size() == rhs.size() && strncasecmp(lhs.data(), rhs.data(), lhs.size()) == 0;
+}
+
+/// Build the HTTP/1.1 request of the client request @a node.
+bool
+build_request(const YAML::Node &node, Transaction &txn)
+{
+  if (!node["method"] || !node["url"]) {
+    return false;
+  }
+  std::string method = node["method"].as<std::string>();
+  std::string url    = node["url"].as<std::string>();
+  bool has_host      = false;
+
+  txn.head      = method == "HEAD";
+  txn.body_size = node["content"] && node["content"]["size"] ? node["content"]["size"].as<int64_t>() : 0;
+  txn.request   = method + " " + url + " HTTP/1.1\r\n";
+  for (const auto &field : node["headers"]["fields"]) {
+    std::string name  = field[0].as<std::string>();
+    std::string value = field[1].as<std::string>();
+    // The body is sent with a length, whatever the framing of the original one was. The pseudo fields of an HTTP/2
+    // request are not fields of an HTTP/1.1 one.
+    if (name.empty() || name[0] == ':' || icase_equal(name, "Content-Length") || icase_equal(name, "Transfer-Encoding")) {
+      if (name == ":authority" && !has_host) {
+        txn.request += "Host: " + value + "\r\n";
+        has_host    = true;
+      }
+      continue;
+    }
+    has_host    = has_host || icase_equal(name, "Host");
+    txn.request += name + ": " + value + "\r\n";
+  }
+  if (txn.body_size > 0) {
+    txn.request += "Content-Length: " + std::to_string(txn.body_size) + "\r\n";
+  }
+  txn.request += "\r\n";
+  return true;
+}
+
+void
+load_session(const YAML::Node &node)
+{
+  Session session;
+  session.start_ns = node_time(node);
+  for (const auto &protocol : node["protocol"]) {
+    std::string name = protocol["name"] ? protocol["name"].as<std::string>() : "";
+    if (name == "tls") {
+      session.tls = true;
+      if (protocol["sni"]) {
+        session.sni = protocol["sni"].as<std::string>();
+      }
+    } else if (name == "http" && protocol["version"] && protocol["version"].as<std::string>() == "2") {
+      session.h2 = true;
+    }
+  }
+  for (const auto &node_txn : node["transactions"]) {
+    Transaction txn;
+    if (!node_txn["client-request"] || !build_request(node_txn["client-request"], txn)) {
+      continue;
+    }
+    int64_t start = node_time(node_txn);
+    txn.offset_ns = session.start_ns && start > session.start_ns ? start - session.start_ns : 0;
+    if (node_txn["proxy-response"] && node_txn["proxy-response"]["status"]) {
+      txn.expected_status = node_txn["proxy-response"]["status"].as<int>();
+    }
+    session.transactions.push_back(std::move(txn));
+  }
+  if (!session.transactions.empty()) {
+    sessions.push_back(std::move(session));
+  }
+}
+
+void
+load_path(const std::string &path)
+{
+  struct stat st;
+  if (stat(path.c_str(), &st) < 0) {
+    fprintf(stderr, "cannot stat %s: %s\n", path.c_str(), strerror(errno));
+    return;
+  }
+  if (S_ISDIR(st.st_mode)) {
+    DIR *dir = opendir(path.c_str());
+    if (dir == nullptr) {
+      fprintf(stderr, "cannot open %s: %s\n", path.c_str(), strerror(errno));
+      return;
+    }
+    while (dirent *entry = readdir(dir)) {
+      if (entry->d_name[0] != '.') {
+        load_path(path + "/" + entry->d_name);
+      }
+    }
+    closedir(dir);
+    return;
+  }
+
+  // JSON is a subset of YAML, the replay files are read with the YAML parser the rest of the tree uses.
+  try {
+    YAML::Node root = YAML::LoadFile(path);
+    for (const auto &session : root["sessions"]) {
+      load_session(session);
+    }
+  } catch (const std::exception &e) {
+    fprintf(stderr, "cannot load %s: %s\n", path.c_str(), e.what());
+  }
+}
+
+//
+// Replaying the sessions.
+//
+
+/// A connection to the proxy, over TLS or not.
+class Connection
+{
+public:
+  ~Connection() { close(); }
+
+  bool
+  open(const Session &session)
+  {
+    addrinfo *addr = session.tls ? proxy_tls_addr : proxy_addr;
+    _fd            = socket(addr->ai_family, SOCK_STREAM, 0);
+    if (_fd < 0) {
+      return false;
+    }
+    timeval tv{timeout, 0};
+    int on = 1;
+    setsockopt(_fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    setsockopt(_fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+    setsockopt(_fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+    if (connect(_fd, addr->ai_addr, addr->ai_addrlen) < 0) {
+      close();
+      return false;
+    }
+    if (session.tls) {
+      _ssl = SSL_new(ssl_ctx);
+      SSL_set_fd(_ssl, _fd);
+      if (!session.sni.empty()) {
+        SSL_set_tlsext_host_name(_ssl, session.sni.c_str());
+      }
+      if (SSL_connect(_ssl) != 1) {
+        close();
+        return false;
+      }
+    }
+    _buffer.clear();
+    return true;
+  }
+
+  void
+  close()
+  {
+    if (_ssl) {
+      SSL_free(_ssl);
+      _ssl = nullptr;
+    }
+    if (_fd >= 0) {
+      ::close(_fd);
+      _fd = -1;
+    }
+  }
+
+  bool
+  is_open() const
+  {
+    return _fd >= 0;
+  }
+
+  bool
+  write(std::string_view data)
+  {
+    while (!data.empty()) {
+      ssize_t n = _ssl ? SSL_write(_ssl, data.data(), data.size()) : ::send(_fd, data.data(), data.size(), MSG_NOSIGNAL);
+      if (n <= 0) {
+        if (!_ssl && n < 0 && errno == EINTR) {
+          continue;
+        }
+        return false;
+      }
+      data.remove_prefix(n);
+    }
+    return true;
+  }
+
+  /// Read more bytes into the buffer, return @c false at the end of the stream or on error.
+  bool
+  fill()
+  {
+    char buf[16384];
+    ssize_t n = _ssl ? SSL_read(_ssl, buf, sizeof(buf)) : ::recv(_fd, buf, sizeof(buf), 0);
+    if (n <= 0) {
+      return false;
+    }
+    bytes_read += n;
+    _buffer.append(buf, n);
+    return true;
+  }
+
+  /// Read a line, without its CRLF.
+  bool
+  read_line(std::string &line)
+  {
+    size_t eol;
+    while ((eol = _buffer.find("\r\n")) == std::string::npos) {
+      if (!fill()) {
+        return false;
+      }
+    }
+    line.assign(_buffer, 0, eol);
+    _buffer.erase(0, eol + 2);
+    return true;
+  }
+
+  /// Read and discard @a size bytes.
+  bool
+  skip(int64_t size)
+  {
+    while (static_cast<int64_t>(_buffer.size()) < size) {
+      size -= _buffer.size();
+      _buffer.clear();
+      if (!fill()) {
+        return false;
+      }
+    }
+    _buffer.erase(0, size);
+    return true;
+  }
+
+  /// Read and discard everything until the end of the stream.
+  void
+  skip_all()
+  {
+    while (fill()) {
+      _buffer.clear();
+    }
+    _buffer.clear();
+  }
+
+  /// Whether there are bytes of a response not read yet.
+  bool
+  has_buffered() const
+  {
+    return !_buffer.empty();
+  }
+
+private:
+  int _fd   = -1;
+  SSL *_ssl = nullptr;
+  std::string _buffer;
+};
+
+/** Read a response, but for its body if @a head.
+ *
+ * @return The status, 0 on error. @a first_byte is set when the status line is read and @a keep_alive to whether the
+ * connection can be reused.
+ */
+int
+read_response(Connection &conn, bool head, Clock::time_point &first_byte, bool &keep_alive)
+{
+  std::string line;
+  int status = 0;
+
+  // Skip the interim responses.
+  do {
+    if (!conn.read_line(line)) {
+      return 0;
+    }
+    first_byte = Clock::now();
+    if (line.compare(0, 5, "HTTP/") != 0 || line.size() < 12) {
+      return 0;
+    }
+    status = atoi(line.c_str() + 9);
+
+    int64_t content_length = -1;
+    bool chunked           = false;
+    keep_alive             = line.compare(0, 8, "HTTP/1.0") != 0;
+    while (conn.read_line(line) && !line.empty()) {
+      ts::TextView value{line};
+      ts::TextView name = value.take_prefix_at(':');
+      value.trim_if(&isspace);
+      if (strcasecmp(std::string(name).c_str(), "Content-Length") == 0) {
+        content_length = ts::svtoi(value);
+      } else if (strcasecmp(std::string(name).c_str(), "Transfer-Encoding") == 0) {
+        chunked = strcasestr(std::string(value).c_str(), "chunked") != nullptr;
+      } else if (strcasecmp(std::string(name).c_str(), "Connection") == 0) {
+        keep_alive = strcasestr(std::string(value).c_str(), "close") == nullptr;
+      }
+    }
+    if (!line.empty()) {
+      return 0;
+    }
+    if (status >= 100 && status < 200) {
+      continue;
+    }
+    if (head || status == 204 || status == 304) {
+      break;
+    }
+    if (chunked) {
+      while (true) {
+        if (!conn.read_line(line)) {
+          return 0;
+        }
+        int64_t size = strtoll(line.c_str(), nullptr, 16);
+        if (size == 0) {
+          // The trailer fields, up to the empty line.
+          while (conn.read_line(line) && !line.empty()) {
+          }
+          break;
+        }
+        if (!conn.skip(size + 2)) {
+          return 0;
+        }
+      }
+    } else if (content_length >= 0) {
+      if (!conn.skip(content_length)) {
+        return 0;
+      }
+    } else {
+      conn.skip_all();
+      keep_alive = false;
+    }
+  } while (status >= 100 && status < 200);
+
+  return status;
+}
+
+int64_t
+to_us(Clock::duration d)
+{
+  return std::chrono::duration_cast<std::chrono::microseconds>(d).count();
+}
+
+Clock::time_point
+scaled(Clock::time_point base, int64_t offset_ns)
+{
+  if (speed <= 0) {
+    return base;
+  }
+  return base + std::chrono::nanoseconds(static_cast<int64_t>(offset_ns / speed));
+}
+
+void
+replay_session(const Session &session, Clock::time_point start, Results &results)
+{
+  Connection conn;
+  std::string body;
+
+  for (const Transaction &txn : session.transactions) {
+    if (!running) {
+      return;
+    }
+    std::this_thread::sleep_until(scaled(start, txn.offset_ns));
+    if (!conn.is_open() && !conn.open(session)) {
+      ++errors;
+      continue;
+    }
+
+    Clock::time_point sent = Clock::now();
+    Clock::time_point first_byte;
+    bool keep_alive = false;
+    bool ok         = conn.write(txn.request);
+    if (ok && txn.body_size > 0) {
+      body.assign(std::min<int64_t>(txn.body_size, 1 << 16), 'x');
+      for (int64_t left = txn.body_size; ok && left > 0; left -= body.size()) {
+        ok = conn.write(std::string_view{body.data(), static_cast<size_t>(std::min<int64_t>(left, body.size()))});
+      }
+    }
+    int status = ok ? read_response(conn, txn.head, first_byte, keep_alive) : 0;
+    if (status == 0) {
+      ++errors;
+      conn.close();
+      continue;
+    }
+
+    Clock::time_point done = Clock::now();
+    results.first_byte.record(to_us(first_byte - sent));
+    results.total.record(to_us(done - sent));
+    ++results.status_classes[std::min(status / 100, 5)];
+    if (txn.expected_status && txn.expected_status != status) {
+      ++status_mismatches;
+      if (verbose) {
+        printf("status %d instead of %d for %.*s\n", status, txn.expected_status,
+               static_cast<int>(txn.request.find("\r\n")), txn.request.data());
+      }
+    }
+    ++done_transactions;
+    if (!keep_alive || conn.has_buffered()) {
+      conn.close();
+    }
+  }
+}
+
+void
+worker(Clock::time_point start, int64_t first_ns, Results &results)
+{
+  size_t idx;
+  while (running && (idx = next_session++) < sessions.size()) {
+    const Session &session          = sessions[idx];
+    Clock::time_point session_start = scaled(start, session.start_ns - first_ns);
+    Clock::time_point now           = Clock::now();
+
+    if (now < session_start) {
+      std::this_thread::sleep_until(session_start);
+    } else if (speed > 0 && now - session_start > std::chrono::milliseconds(100)) {
+      // All the workers were busy, the session starts later than it did.
+      ++late_sessions;
+    }
+    replay_session(session, session_start, results);
+    ++done_sessions;
+  }
+}
+
+addrinfo *
+resolve(int port)
+{
+  addrinfo hints;
+  addrinfo *result = nullptr;
+
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_family   = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  int err           = getaddrinfo(proxy_host, std::to_string(port).c_str(), &hints, &result);
+  if (err != 0) {
+    fprintf(stderr, "cannot resolve %s: %s\n", proxy_host, gai_strerror(err));
+    exit(1);
+  }
+  return result;
+}
+
+void
+print_latency(const char *name, const Histogram &h)
+{
+  printf("%-12s p50 %8.3f  p90 %8.3f  p99 %8.3f  p99.9 %8.3f  max %8.3f ms\n", name, h.percentile(50) / 1000.0,
+         h.percentile(90) / 1000.0, h.percentile(99) / 1000.0, h.percentile(99.9) / 1000.0, h.max() / 1000.0);
+}
+} // namespace
+
+int
+main(int /* argc ATS_UNUSED */, const char *argv[])
+{
+  appVersionInfo.setup(PACKAGE_NAME, "replay_load", PACKAGE_VERSION, __DATE__, __TIME__, BUILD_MACHINE, BUILD_PERSON, "");
+  setvbuf(stdout, nullptr, _IOLBF, 0);
+  process_args(&appVersionInfo, argument_descriptions, n_argument_descriptions, argv);
+
+  if (n_file_arguments == 0) {
+    usage(argument_descriptions, n_argument_descriptions, "[replay files or directories ...]");
+  }
+  for (unsigned i = 0; i < n_file_arguments; ++i) {
+    load_path(file_arguments[i]);
+  }
+  if (sessions.empty()) {
+    fprintf(stderr, "no session to replay\n");
+    return 1;
+  }
+  std::sort(sessions.begin(), sessions.end(), [](const Session &a, const Session &b) { return a.start_ns < b.start_ns; });
+
+  size_t transactions = 0, h2_sessions = 0;
+  for (const Session &session : sessions) {
+    transactions += session.transactions.size();
+    h2_sessions  += session.h2;
+  }
+  printf("replaying %zu sessions and %zu transactions with up to %d concurrent sessions\n", sessions.size(), transactions,
+         concurrency);
+  if (h2_sessions) {
+    printf("%zu HTTP/2 sessions are replayed over HTTP/1.1\n", h2_sessions);
+  }
+
+  signal(SIGPIPE, SIG_IGN);
+  SSL_library_init();
+  SSL_load_error_strings();
+  ssl_ctx = SSL_CTX_new(SSLv23_client_method());
+  SSL_CTX_set_verify(ssl_ctx, SSL_VERIFY_NONE, nullptr);
+  proxy_addr     = resolve(proxy_port);
+  proxy_tls_addr = tls_port ? resolve(tls_port) : proxy_addr;
+
+  Clock::time_point start = Clock::now();
+  std::vector<Results> results(std::max(concurrency, 1));
+  std::vector<std::thread> workers;
+  for (Results &r : results) {
+    workers.emplace_back(worker, start, sessions.front().start_ns, std::ref(r));
+  }
+
+  int64_t reported = 0;
+  while (done_sessions < static_cast<int64_t>(sessions.size())) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    if (interval > 0 && Clock::now() - start >= std::chrono::seconds((reported + 1) * interval)) {
+      ++reported;
+      printf("%6" PRId64 "s  sessions %8" PRId64 "  transactions %10" PRId64 "  errors %6" PRId64 "  late %6" PRId64 "\n",
+             reported * interval, done_sessions.load(), done_transactions.load(), errors.load(), late_sessions.load());
+    }
+  }
+  for (std::thread &t : workers) {
+    t.join();
+  }
+
+  Results total;
+  for (const Results &r : results) {
+    total.first_byte.merge(r.first_byte);
+    total.total.merge(r.total);
+    for (int i = 0; i < 6; ++i) {
+      total.status_classes[i] += r.status_classes[i];
+    }
+  }
+
+  double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+  printf("\n%" PRId64 " transactions in %.3f s: %.1f transactions/s, %.1f KB/s\n", done_transactions.load(), seconds,
+         done_transactions / seconds, bytes_read / seconds / 1024);
+  printf("errors %" PRId64 ", status mismatches %" PRId64 ", late sessions %" PRId64 "\n", errors.load(),
+         status_mismatches.load(), late_sessions.load());
+  printf("status 1xx %" PRId64 ", 2xx %" PRId64 ", 3xx %" PRId64 ", 4xx %" PRId64 ", 5xx %" PRId64 "\n", total.status_classes[1],
+         total.status_classes[2], total.status_classes[3], total.status_classes[4], total.status_classes[5]);
+  if (total.total.count()) {
+    print_latency("first byte", total.first_byte);
+    print_latency("total", total.total);
+  }
+
+  freeaddrinfo(proxy_addr);
+  if (proxy_tls_addr != proxy_addr) {
+    freeaddrinfo(proxy_tls_addr);
+  }
+  SSL_CTX_free(ssl_ctx);
+  return errors ? 2 : 0;
+}